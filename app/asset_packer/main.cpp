@@ -0,0 +1,58 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Packs the files of a directory into a single pack file, see vkb::filesystem::write_pack().
+//
+// Usage: vkb__asset_packer [--store] <directory> <pack>
+// With --store, every file is stored uncompressed.
+
+#include <cstdlib>
+#include <cstring>
+
+#include "core/util/logging.hpp"
+#include "filesystem/filesystem.hpp"
+
+int main(int argc, char *argv[])
+{
+	bool compress = true;
+	int  first    = 1;
+	if (argc > 1 && std::strcmp(argv[1], "--store") == 0)
+	{
+		compress = false;
+		first    = 2;
+	}
+
+	if (argc - first != 2)
+	{
+		LOGE("Usage: {} [--store] <directory> <pack>", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		vkb::filesystem::write_pack(argv[first], argv[first + 1], compress);
+
+		LOGI("Wrote {}", argv[first + 1]);
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to build the asset pack: {}", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
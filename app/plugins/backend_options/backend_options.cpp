@@ -0,0 +1,68 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "backend_options.h"
+
+#include "core/backend.h"
+
+namespace plugins
+{
+BackendOptions::BackendOptions() :
+    BackendOptionsTags("Backend Options",
+                       "Switch the framework to an optional backend.",
+                       {},
+                       {},
+                       {{"descriptor-buffers", "Write the descriptors into descriptor buffers with VK_EXT_descriptor_buffer"},
+                        {"shader-objects", "Bind shader objects instead of pipelines with VK_EXT_shader_object"},
+                        {"dynamic-rendering", "Begin rendering instances instead of render passes with VK_KHR_dynamic_rendering"}})
+{
+}
+
+bool BackendOptions::handle_option(std::deque<std::string> &arguments)
+{
+	assert(!arguments.empty() && (arguments[0].substr(0, 2) == "--"));
+	std::string option = arguments[0].substr(2);
+	if (option == "descriptor-buffers")
+	{
+		auto settings               = vkb::backend::get_settings();
+		settings.descriptor_buffers = true;
+		vkb::backend::set_settings(settings);
+
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "shader-objects")
+	{
+		auto settings           = vkb::backend::get_settings();
+		settings.shader_objects = true;
+		vkb::backend::set_settings(settings);
+
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "dynamic-rendering")
+	{
+		auto settings              = vkb::backend::get_settings();
+		settings.dynamic_rendering = true;
+		vkb::backend::set_settings(settings);
+
+		arguments.pop_front();
+		return true;
+	}
+	return false;
+}
+}        // namespace plugins
@@ -0,0 +1,51 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "platform/plugins/plugin_base.h"
+
+namespace plugins
+{
+class BackendOptions;
+
+// Passive behaviour
+using BackendOptionsTags = vkb::PluginBase<BackendOptions, vkb::tags::Passive>;
+
+/**
+ * @brief Backend Options
+ *
+ * Switch the framework to an optional backend, see vkb::backend::Settings. The descriptors can be written into
+ * descriptor buffers instead of descriptor sets, the command buffers can bind shader objects instead of
+ * pipelines, and the render pipelines can begin dynamic rendering instances instead of render passes.
+ * The samples keep the default backend if the device doesn't support the one requested.
+ *
+ * Usage: vulkan_sample sample afbc --descriptor-buffers
+ *        vulkan_sample sample pipeline_cache --shader-objects
+ *        vulkan_sample sample subpasses --dynamic-rendering
+ *
+ */
+class BackendOptions : public BackendOptionsTags
+{
+  public:
+	BackendOptions();
+
+	virtual ~BackendOptions() = default;
+
+	bool handle_option(std::deque<std::string> &arguments) override;
+};
+}        // namespace plugins
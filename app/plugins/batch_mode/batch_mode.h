@@ -29,14 +29,19 @@ using namespace std::chrono_literals;
 
 namespace plugins
 {
-using BatchModeTags = vkb::PluginBase<vkb::tags::Entrypoint, vkb::tags::FullControl>;
+class BatchMode;
+
+using BatchModeTags = vkb::PluginBase<BatchMode, vkb::tags::Entrypoint, vkb::tags::FullControl>;
 
 /**
  * @brief Batch Mode
  *
  * Run a subset of samples. The next sample in the set will start after the current sample being executed has finished. Using --wrap-to-start will start again from the first sample after the last sample is executed.
  *
+ * Combined with --offscreen and --benchmark, the samples run without a display and the benchmark mode writes a report aggregating all of them.
+ *
  * Usage: vulkan_samples batch --duration 3 --category performance --tag arm
+ *        vulkan_samples batch --duration 10 --category performance --offscreen --benchmark
  *
  */
 class BatchMode : public BatchModeTags
@@ -18,16 +18,159 @@
 
 #include "benchmark_mode.h"
 
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <fmt/format.h>
+
+#include "batch_mode/batch_mode.h"
+#include "filesystem/filesystem.hpp"
+#include "filesystem/legacy.h"
 #include "platform/platform.h"
+#include "rendering/render_context.h"
 
 namespace plugins
 {
+namespace
+{
+/// Width of the buckets of the frame time histograms, in milliseconds
+constexpr float HistogramBucketSize = 1.0f;
+
+/// The last bucket of a histogram holds all the longer frames
+constexpr size_t HistogramBucketCount = 100;
+
+struct Summary
+{
+	size_t              count   = 0;
+	float               average = 0.0f;
+	float               p50     = 0.0f;
+	float               p95     = 0.0f;
+	float               p99     = 0.0f;
+	float               max     = 0.0f;
+	std::vector<size_t> histogram;
+};
+
+Summary summarize(std::vector<float> times)
+{
+	Summary summary;
+	summary.count = times.size();
+	if (times.empty())
+	{
+		return summary;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	// Nearest rank percentiles
+	auto percentile = [&times](float p) {
+		auto rank = static_cast<size_t>(std::ceil(p / 100.0f * times.size()));
+		return times[std::max<size_t>(rank, 1) - 1];
+	};
+
+	double total = 0.0;
+	for (float time : times)
+	{
+		total += time;
+
+		auto bucket = std::min(static_cast<size_t>(time / HistogramBucketSize), HistogramBucketCount - 1);
+		if (bucket >= summary.histogram.size())
+		{
+			summary.histogram.resize(bucket + 1, 0);
+		}
+		summary.histogram[bucket]++;
+	}
+
+	summary.average = static_cast<float>(total / times.size());
+	summary.p50     = percentile(50.0f);
+	summary.p95     = percentile(95.0f);
+	summary.p99     = percentile(99.0f);
+	summary.max     = times.back();
+
+	return summary;
+}
+
+std::string to_json(const Summary &summary)
+{
+	std::string histogram;
+	for (size_t i = 0; i < summary.histogram.size(); ++i)
+	{
+		histogram += fmt::format("{}{}", i == 0 ? "" : ", ", summary.histogram[i]);
+	}
+
+	return fmt::format("{{\"frames\": {}, \"average\": {:.3f}, \"p50\": {:.3f}, \"p95\": {:.3f}, \"p99\": {:.3f}, \"max\": {:.3f}, "
+	                   "\"histogram\": {{\"bucket_size\": {:.1f}, \"counts\": [{}]}}}}",
+	                   summary.count, summary.average, summary.p50, summary.p95, summary.p99, summary.max, HistogramBucketSize, histogram);
+}
+
+std::string escape_json(const std::string &text)
+{
+	std::string escaped;
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+std::string format_time(float time)
+{
+	return time < 0.0f ? "" : fmt::format("{:.3f}", time);
+}
+
+/// The frames of a pass, with the totals of its pipeline statistics over the frames they were counted in
+struct PassFrames
+{
+	std::string name;
+
+	std::vector<float> times;
+
+	vkb::GpuFrameTimer::PipelineStatistics statistics;
+
+	size_t statistics_count = 0;
+
+	void add_statistics(const vkb::GpuFrameTimer::PipelineStatistics &pass)
+	{
+		statistics.input_assembly_vertices += pass.input_assembly_vertices;
+		statistics.input_assembly_primitives += pass.input_assembly_primitives;
+		statistics.vertex_shader_invocations += pass.vertex_shader_invocations;
+		statistics.clipping_invocations += pass.clipping_invocations;
+		statistics.clipping_primitives += pass.clipping_primitives;
+		statistics.fragment_shader_invocations += pass.fragment_shader_invocations;
+		statistics.compute_shader_invocations += pass.compute_shader_invocations;
+		statistics_count++;
+	}
+
+	/// The averages per frame
+	std::string statistics_to_json() const
+	{
+		auto average = [this](uint64_t total) { return static_cast<double>(total) / statistics_count; };
+
+		return fmt::format("{{\"frames\": {}, \"input_assembly_vertices\": {:.1f}, \"input_assembly_primitives\": {:.1f}, \"vertex_shader_invocations\": {:.1f}, "
+		                   "\"clipping_invocations\": {:.1f}, \"clipping_primitives\": {:.1f}, \"fragment_shader_invocations\": {:.1f}, "
+		                   "\"compute_shader_invocations\": {:.1f}}}",
+		                   statistics_count, average(statistics.input_assembly_vertices), average(statistics.input_assembly_primitives),
+		                   average(statistics.vertex_shader_invocations), average(statistics.clipping_invocations), average(statistics.clipping_primitives),
+		                   average(statistics.fragment_shader_invocations), average(statistics.compute_shader_invocations));
+	}
+};
+}        // namespace
+
 BenchmarkMode::BenchmarkMode() :
     BenchmarkModeTags("Benchmark Mode",
                       "Log frame averages after running an app.",
-                      {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::OnAppClose},
+                      {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::OnAppClose, vkb::Hook::PostDraw},
                       {},
-                      {{"benchmark", "Enable benchmark mode"}})
+                      {{"benchmark", "Enable benchmark mode"},
+                       {"benchmark-warmup", "Number of frames excluded from the benchmark statistics"},
+                       {"benchmark-output", "Declare an output name for the benchmark report"},
+                       {"benchmark-baseline", "Compare the frames with the report of an earlier run"},
+                       {"benchmark-cached-gui", "Rebuild the GUI only on input and a few times per second"},
+                       {"benchmark-pipeline-statistics", "Count the primitives and shader invocations of each pass"}})
 {
 }
 
@@ -45,6 +188,61 @@ bool BenchmarkMode::handle_option(std::deque<std::string> &arguments)
 		arguments.pop_front();
 		return true;
 	}
+	else if (option == "benchmark-warmup")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"benchmark-warmup\" is missing the number of frames to exclude!");
+			return false;
+		}
+		warmup_frames = static_cast<uint32_t>(std::stoul(arguments[1]));
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "benchmark-output")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"benchmark-output\" is missing the name of the report!");
+			return false;
+		}
+		output_path     = arguments[1];
+		output_path_set = true;
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "benchmark-baseline")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"benchmark-baseline\" is missing the name of the baseline report!");
+			return false;
+		}
+		baseline_path = arguments[1];
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "benchmark-cached-gui")
+	{
+		// The overlay of an unattended run rarely changes, so most frames draw the last one again
+		platform->cache_gui(true);
+
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "benchmark-pipeline-statistics")
+	{
+		pipeline_statistics = true;
+
+		arguments.pop_front();
+		return true;
+	}
 	return false;
 }
 
@@ -52,17 +250,281 @@ void BenchmarkMode::on_update(float delta_time)
 {
 	elapsed_time += delta_time;
 	total_frames++;
+
+	// The delta time given to the plugins is the real one, the application is given the fixed simulation one
+	frames.push_back({delta_time * 1000.0f, -1.0f, -1.0f, {}});
+
+	update_timer.start();
 }
 
 void BenchmarkMode::on_app_start(const std::string &app_id)
 {
 	elapsed_time = 0;
 	total_frames = 0;
+	frames.clear();
+	gpu_timing_requested = false;
+	gpu_resolved_count   = 0;
 	LOGI("Starting Benchmark for {}", app_id);
 }
 
+void BenchmarkMode::on_post_draw(vkb::RenderContext &context)
+{
+	if (!frames.empty())
+	{
+		frames.back().cpu_time = static_cast<float>(update_timer.stop<vkb::Timer::Milliseconds>());
+	}
+
+	if (!gpu_timing_requested)
+	{
+		gpu_timing_requested = true;
+
+		auto &device     = context.get_device();
+		auto &properties = device.get_gpu().get_properties();
+		auto  driver     = device.get_driver_version();
+
+		device_name    = properties.deviceName;
+		vendor_id      = properties.vendorID;
+		device_id      = properties.deviceID;
+		api_version    = properties.apiVersion;
+		driver_version = fmt::format("{}.{}.{}", driver.major, driver.minor, driver.patch);
+
+		// The frame of this call was already submitted, the timer starts with the next one
+		if (context.enable_gpu_frame_timing() && pipeline_statistics && !context.get_gpu_frame_timer()->enable_pipeline_statistics())
+		{
+			LOGW("The device doesn't support pipeline statistics queries, the benchmark report won't count the shader invocations");
+		}
+		gpu_first_frame = frames.size();
+		return;
+	}
+
+	auto *gpu_frame_timer = context.get_gpu_frame_timer();
+	if (gpu_frame_timer && gpu_frame_timer->get_resolved_count() != gpu_resolved_count)
+	{
+		gpu_resolved_count = gpu_frame_timer->get_resolved_count();
+
+		auto frame = gpu_first_frame + gpu_frame_timer->get_frame_number();
+		if (frame < frames.size())
+		{
+			frames[frame].gpu_time = gpu_frame_timer->get_frame_time();
+			frames[frame].passes   = gpu_frame_timer->get_pass_times();
+		}
+	}
+}
+
 void BenchmarkMode::on_app_close(const std::string &app_id)
 {
+	// A sample which failed to prepare never ran a frame
+	if (frames.empty())
+	{
+		LOGW("Benchmark for {} ran no frame, no report is written", app_id);
+		return;
+	}
+
 	LOGI("Benchmark for {} completed in {} seconds (ran {} frames, averaged {} fps)", app_id, elapsed_time, total_frames, total_frames / elapsed_time);
+
+	try
+	{
+		write_report(app_id);
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to write the benchmark report of {}: {}", app_id, e.what());
+	}
+
+	frames.clear();
+}
+
+void BenchmarkMode::write_report(const std::string &app_id)
+{
+	std::vector<float> frame_times;
+	std::vector<float> cpu_times;
+	std::vector<float> gpu_times;
+
+	// The passes in the order they are first recorded
+	std::vector<PassFrames> pass_times;
+	for (size_t i = warmup_frames; i < frames.size(); ++i)
+	{
+		for (auto &pass : frames[i].passes)
+		{
+			auto it = std::find_if(pass_times.begin(), pass_times.end(), [&pass](const auto &times) { return times.name == pass.name; });
+			if (it == pass_times.end())
+			{
+				it       = pass_times.emplace(pass_times.end());
+				it->name = pass.name;
+			}
+			it->times.push_back(pass.time);
+
+			if (pass.has_statistics)
+			{
+				it->add_statistics(pass.statistics);
+			}
+		}
+
+		frame_times.push_back(frames[i].frame_time);
+		if (frames[i].cpu_time >= 0.0f)
+		{
+			cpu_times.push_back(frames[i].cpu_time);
+		}
+		if (frames[i].gpu_time >= 0.0f)
+		{
+			gpu_times.push_back(frames[i].gpu_time);
+		}
+	}
+
+	auto frame_summary = summarize(frame_times);
+	auto cpu_summary   = summarize(cpu_times);
+	auto gpu_summary   = summarize(gpu_times);
+
+	LOGI("Benchmark frame times after {} warm up frames: p50 {:.2f} ms, p95 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms",
+	     warmup_frames, frame_summary.p50, frame_summary.p95, frame_summary.p99, frame_summary.max);
+
+	std::string json = "{\n";
+	json += fmt::format("\t\"application\": \"{}\",\n", escape_json(app_id));
+	json += fmt::format("\t\"device\": {{\"name\": \"{}\", \"vendor_id\": {}, \"device_id\": {}, \"driver_version\": \"{}\", \"api_version\": \"{}.{}.{}\"}},\n",
+	                    escape_json(device_name), vendor_id, device_id, driver_version,
+	                    VK_API_VERSION_MAJOR(api_version), VK_API_VERSION_MINOR(api_version), VK_API_VERSION_PATCH(api_version));
+	json += fmt::format("\t\"warmup_frames\": {},\n", warmup_frames);
+	json += fmt::format("\t\"total_frames\": {},\n", frames.size());
+	json += fmt::format("\t\"frame_time\": {},\n", to_json(frame_summary));
+	json += fmt::format("\t\"cpu_time\": {},\n", to_json(cpu_summary));
+	json += fmt::format("\t\"gpu_time\": {},\n", to_json(gpu_summary));
+	json += "\t\"passes\": [";
+	for (size_t i = 0; i < pass_times.size(); ++i)
+	{
+		json += fmt::format("{}\n\t\t{{\"name\": \"{}\", \"gpu_time\": {}{}}}", i == 0 ? "" : ",", escape_json(pass_times[i].name), to_json(summarize(pass_times[i].times)),
+		                    pass_times[i].statistics_count == 0 ? "" : ", \"statistics\": " + pass_times[i].statistics_to_json());
+	}
+	json += pass_times.empty() ? "]\n" : "\n\t]\n";
+	json += "}\n";
+
+	std::string csv = "frame,warmup,frame_time_ms,cpu_time_ms,gpu_time_ms\n";
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		csv += fmt::format("{},{},{},{},{}\n", i, i < warmup_frames ? 1 : 0,
+		                   format_time(frames[i].frame_time), format_time(frames[i].cpu_time), format_time(frames[i].gpu_time));
+	}
+
+	bool batch = platform->using_plugin<BatchMode>();
+
+	std::string path;
+	if (batch)
+	{
+		path = (output_path_set ? output_path : vkb::fs::path::get(vkb::fs::path::Type::Logs) + "batch-benchmark") + "-" + app_id;
+	}
+	else
+	{
+		path = output_path_set ? output_path : vkb::fs::path::get(vkb::fs::path::Type::Logs) + app_id + "-benchmark";
+	}
+
+	auto fs = vkb::filesystem::get();
+	fs->write_file(path + ".json", json);
+	fs->write_file(path + ".csv", csv);
+
+	LOGI("Benchmark report written to {}.json and {}.csv", path, path);
+
+	if (!baseline_path.empty())
+	{
+		write_baseline_diff(path);
+	}
+
+	if (batch)
+	{
+		batch_json.push_back(fmt::format("{{\"application\": \"{}\", \"total_frames\": {}, \"frame_time\": {}, \"cpu_time\": {}, \"gpu_time\": {}}}",
+		                                 escape_json(app_id), frames.size(), to_json(frame_summary), to_json(cpu_summary), to_json(gpu_summary)));
+		batch_csv.push_back(fmt::format("{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}\n", app_id, frame_summary.count,
+		                                frame_summary.average, frame_summary.p50, frame_summary.p99, gpu_summary.average, gpu_summary.p50, gpu_summary.p99));
+
+		write_batch_report();
+	}
+}
+
+void BenchmarkMode::write_batch_report() const
+{
+	std::string json = "{\n";
+	json += fmt::format("\t\"device\": {{\"name\": \"{}\", \"vendor_id\": {}, \"device_id\": {}, \"driver_version\": \"{}\", \"api_version\": \"{}.{}.{}\"}},\n",
+	                    escape_json(device_name), vendor_id, device_id, driver_version,
+	                    VK_API_VERSION_MAJOR(api_version), VK_API_VERSION_MINOR(api_version), VK_API_VERSION_PATCH(api_version));
+	json += fmt::format("\t\"warmup_frames\": {},\n", warmup_frames);
+	json += "\t\"applications\": [";
+	for (size_t i = 0; i < batch_json.size(); ++i)
+	{
+		json += fmt::format("{}\n\t\t{}", i == 0 ? "" : ",", batch_json[i]);
+	}
+	json += batch_json.empty() ? "]\n" : "\n\t]\n";
+	json += "}\n";
+
+	std::string csv = "application,frames,frame_time_average_ms,frame_time_p50_ms,frame_time_p99_ms,gpu_time_average_ms,gpu_time_p50_ms,gpu_time_p99_ms\n";
+	for (auto &row : batch_csv)
+	{
+		csv += row;
+	}
+
+	std::string path = output_path_set ? output_path : vkb::fs::path::get(vkb::fs::path::Type::Logs) + "batch-benchmark";
+
+	auto fs = vkb::filesystem::get();
+	fs->write_file(path + ".json", json);
+	fs->write_file(path + ".csv", csv);
+
+	LOGI("Batch benchmark report of {} samples written to {}.json and {}.csv", batch_json.size(), path, path);
+}
+
+void BenchmarkMode::write_baseline_diff(const std::string &path) const
+{
+	// The columns of the CSV report, see write_report
+	std::vector<float> baseline_frame_times;
+	std::vector<float> baseline_gpu_times;
+
+	std::istringstream lines{vkb::filesystem::get()->read_file_string(baseline_path + ".csv")};
+	std::string        line;
+	std::getline(lines, line);
+	while (std::getline(lines, line))
+	{
+		std::vector<std::string> columns;
+		std::istringstream       fields{line};
+		std::string              field;
+		while (std::getline(fields, field, ','))
+		{
+			columns.push_back(field);
+		}
+		columns.resize(5);
+
+		baseline_frame_times.push_back(columns[2].empty() ? -1.0f : std::stof(columns[2]));
+		baseline_gpu_times.push_back(columns[4].empty() ? -1.0f : std::stof(columns[4]));
+	}
+
+	if (baseline_frame_times.size() != frames.size())
+	{
+		LOGW("The baseline {} has {} frames and the benchmark {}, only the first ones are compared", baseline_path, baseline_frame_times.size(), frames.size());
+	}
+
+	auto difference = [](float time, float baseline) {
+		return time < 0.0f || baseline < 0.0f ? "" : fmt::format("{:.3f}", time - baseline);
+	};
+
+	std::vector<float> gpu_differences;
+
+	std::string csv = "frame,warmup,frame_time_ms,baseline_frame_time_ms,frame_time_diff_ms,gpu_time_ms,baseline_gpu_time_ms,gpu_time_diff_ms\n";
+	for (size_t i = 0; i < std::min(frames.size(), baseline_frame_times.size()); ++i)
+	{
+		auto &frame = frames[i];
+		csv += fmt::format("{},{},{},{},{},{},{},{}\n", i, i < warmup_frames ? 1 : 0,
+		                   format_time(frame.frame_time), format_time(baseline_frame_times[i]), difference(frame.frame_time, baseline_frame_times[i]),
+		                   format_time(frame.gpu_time), format_time(baseline_gpu_times[i]), difference(frame.gpu_time, baseline_gpu_times[i]));
+
+		if (i >= warmup_frames && frame.gpu_time >= 0.0f && baseline_gpu_times[i] >= 0.0f)
+		{
+			gpu_differences.push_back(frame.gpu_time - baseline_gpu_times[i]);
+		}
+	}
+
+	vkb::filesystem::get()->write_file(path + "-diff.csv", csv);
+
+	if (!gpu_differences.empty())
+	{
+		std::sort(gpu_differences.begin(), gpu_differences.end());
+		LOGI("GPU time difference with the baseline {}: median {:.3f} ms over {} frames", baseline_path, gpu_differences[gpu_differences.size() / 2], gpu_differences.size());
+	}
+
+	LOGI("Comparison with the baseline written to {}-diff.csv", path);
 }
 }        // namespace plugins
@@ -18,7 +18,12 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "platform/plugins/plugin_base.h"
+#include "rendering/gpu_frame_timer.h"
+#include "timer.h"
 
 namespace plugins
 {
@@ -31,7 +36,24 @@ using BenchmarkModeTags = vkb::PluginBase<BenchmarkMode, vkb::tags::Passive>;
  *
  * When enabled frame time statistics of a samples run will be printed to the console when an application closes. The simulation frame time (delta time) is also locked to 60FPS so that statistics can be compared more accurately across different devices.
  *
- * Usage: vulkan_samples sample afbc --benchmark
+ * A report is also written when the application closes, as <name>.json with the device, the percentiles and a histogram of the frame times,
+ * and <name>.csv with the times of every frame. Each frame has its interval, the CPU time of its update and, for the samples submitting their
+ * frames through the render context, its GPU time measured with timestamps. The JSON report also summarizes the GPU time of each pass of the
+ * render and postprocessing pipelines. The first frames are excluded from the statistics as a warm up.
+ *
+ * With --benchmark-pipeline-statistics, the JSON report also averages the vertices, primitives and shader invocations of each pass
+ * per frame, counted with pipeline statistics queries, so that culling or LOD changes show in the work the GPU was given and not just in its time.
+ *
+ * With --benchmark-cached-gui, the GUI is only rebuilt after an input event and a few times per second for the statistics graphs,
+ * the frames in between draw its last geometry again, see vkb::Gui::set_cached().
+ *
+ * With --benchmark-baseline, the times of every frame are also compared with the CSV report of an earlier run, usually replaying
+ * the same recording (see plugins::Replay), in <name>-diff.csv.
+ *
+ * In batch mode the report of each sample is named <name>-<sample id>, and <name>.json and <name>.csv aggregate the summaries
+ * of all the samples run so far. They are rewritten after each sample, so an interrupted batch still leaves the complete ones.
+ *
+ * Usage: vulkan_samples sample afbc --benchmark --benchmark-warmup 30 --benchmark-output afbc-benchmark
  *
  */
 class BenchmarkMode : public BenchmarkModeTags
@@ -44,11 +66,65 @@ class BenchmarkMode : public BenchmarkModeTags
 	virtual void on_update(float delta_time) override;
 	virtual void on_app_start(const std::string &app_info) override;
 	virtual void on_app_close(const std::string &app_info) override;
+	virtual void on_post_draw(vkb::RenderContext &context) override;
 
 	bool handle_option(std::deque<std::string> &arguments) override;
 
   private:
+	/// Times of a frame in milliseconds, negative when not measured
+	struct FrameTimes
+	{
+		float frame_time;
+		float cpu_time;
+		float gpu_time;
+
+		/// GPU time of the passes of the render and postprocessing pipelines
+		std::vector<vkb::GpuFrameTimer::PassTime> passes;
+	};
+
+	void write_report(const std::string &app_id);
+
+	void write_batch_report() const;
+
+	/**
+	 * @brief Writes the differences of the frame and GPU times of each frame with the ones of the baseline report
+	 */
+	void write_baseline_diff(const std::string &path) const;
+
 	float    elapsed_time = 0.0f;
 	uint32_t total_frames = 0;
+
+	uint32_t warmup_frames = 10;
+
+	bool        output_path_set = false;
+	std::string output_path;
+
+	/// Name of the report the frames are compared with, without its extension
+	std::string baseline_path;
+
+	vkb::Timer update_timer;
+
+	std::vector<FrameTimes> frames;
+
+	/// Whether the render context was asked to time the frames on the GPU
+	bool gpu_timing_requested = false;
+
+	/// Whether the pipeline statistics of the passes are counted too
+	bool pipeline_statistics = false;
+
+	/// The frame the first GPU timed frame corresponds to
+	size_t gpu_first_frame = 0;
+
+	uint64_t gpu_resolved_count = 0;
+
+	std::string device_name;
+	uint32_t    vendor_id   = 0;
+	uint32_t    device_id   = 0;
+	uint32_t    api_version = 0;
+	std::string driver_version;
+
+	/// Summaries of the samples run in batch mode, as JSON objects and CSV rows
+	std::vector<std::string> batch_json;
+	std::vector<std::string> batch_csv;
 };
 }        // namespace plugins
\ No newline at end of file
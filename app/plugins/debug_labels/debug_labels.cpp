@@ -0,0 +1,69 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "debug_labels.h"
+
+#include "core/debug.h"
+
+namespace plugins
+{
+DebugLabels::DebugLabels() :
+    DebugLabelsTags("Debug Labels",
+                    "Choose when the debug labels and names are recorded.",
+                    {},
+                    {},
+                    {{"debug-labels", "Record the labels always, only in captured frames, or never [on|capture|off]"}})
+{
+}
+
+bool DebugLabels::handle_option(std::deque<std::string> &arguments)
+{
+	assert(!arguments.empty() && (arguments[0].substr(0, 2) == "--"));
+	std::string option = arguments[0].substr(2);
+	if (option == "debug-labels")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"debug-labels\" is missing the mode!");
+			return false;
+		}
+
+		if (arguments[1] == "on")
+		{
+			vkb::DebugLabels::set_mode(vkb::DebugLabelMode::Enabled);
+		}
+		else if (arguments[1] == "capture")
+		{
+			vkb::DebugLabels::set_mode(vkb::DebugLabelMode::Capture);
+		}
+		else if (arguments[1] == "off")
+		{
+			vkb::DebugLabels::set_mode(vkb::DebugLabelMode::Disabled);
+		}
+		else
+		{
+			LOGE("Option \"debug-labels\" needs on, capture or off!");
+			return false;
+		}
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	return false;
+}
+}        // namespace plugins
@@ -0,0 +1,47 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "platform/plugins/plugin_base.h"
+
+namespace plugins
+{
+class DebugLabels;
+
+// Passive behaviour
+using DebugLabelsTags = vkb::PluginBase<DebugLabels, vkb::tags::Passive>;
+
+/**
+ * @brief Debug Labels
+ *
+ * Choose when the command buffers are labelled and the Vulkan objects named, see vkb::DebugLabels.
+ * In capture mode, the labels are only recorded in the frames captured by RenderDoc.
+ *
+ * Usage: vulkan_sample sample afbc --debug-labels capture
+ *
+ */
+class DebugLabels : public DebugLabelsTags
+{
+  public:
+	DebugLabels();
+
+	virtual ~DebugLabels() = default;
+
+	bool handle_option(std::deque<std::string> &arguments) override;
+};
+}        // namespace plugins
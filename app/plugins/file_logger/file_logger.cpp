@@ -20,6 +20,7 @@
 #include "file_logger.h"
 
 #include "apps.h"
+#include "core/util/logging.hpp"
 
 #include <fmt/format.h>
 #include <spdlog/sinks/basic_file_sink.h>
@@ -45,7 +46,7 @@ bool FileLogger::handle_option(std::deque<std::string> &arguments)
 		}
 		std::string log_file = arguments[1];
 
-		spdlog::default_logger()->sinks().push_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_file, true));
+		vkb::logging::add_sink(std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_file, true));
 
 		arguments.pop_front();
 		arguments.pop_front();
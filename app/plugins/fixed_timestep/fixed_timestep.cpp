@@ -0,0 +1,59 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fixed_timestep.h"
+
+#include "platform/platform.h"
+
+namespace plugins
+{
+FixedTimestep::FixedTimestep() :
+    FixedTimestepTags("Fixed Timestep",
+                      "Simulate at a fixed tick rate on a separate thread, decoupled from the rendering rate.",
+                      {},
+                      {},
+                      {{"fixed-timestep", "Number of simulation ticks per second"}})
+{
+}
+
+bool FixedTimestep::handle_option(std::deque<std::string> &arguments)
+{
+	assert(!arguments.empty() && (arguments[0].substr(0, 2) == "--"));
+	std::string option = arguments[0].substr(2);
+	if (option == "fixed-timestep")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"fixed-timestep\" is missing the number of ticks per second!");
+			return false;
+		}
+
+		float tick_rate = std::stof(arguments[1]);
+		if (tick_rate <= 0.0f)
+		{
+			LOGE("Option \"fixed-timestep\" needs a positive number of ticks per second!");
+			return false;
+		}
+		platform->run_fixed_timestep(tick_rate);
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	return false;
+}
+}        // namespace plugins
@@ -0,0 +1,48 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "platform/plugins/plugin_base.h"
+
+namespace plugins
+{
+class FixedTimestep;
+
+// Passive behaviour
+using FixedTimestepTags = vkb::PluginBase<FixedTimestep, vkb::tags::Passive>;
+
+/**
+ * @brief Fixed Timestep
+ *
+ * Run the simulation of the samples supporting it at a fixed tick rate on a thread of its own.
+ * Rendering runs at its own rate and interpolates between the two latest simulation states,
+ * so slow frames don't slow the simulation down.
+ *
+ * Usage: vulkan_sample sample dynamic_uniform_buffers --fixed-timestep 30
+ *
+ */
+class FixedTimestep : public FixedTimestepTags
+{
+  public:
+	FixedTimestep();
+
+	virtual ~FixedTimestep() = default;
+
+	bool handle_option(std::deque<std::string> &arguments) override;
+};
+}        // namespace plugins
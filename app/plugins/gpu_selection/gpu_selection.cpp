@@ -30,7 +30,8 @@ GpuSelection::GpuSelection() :
                      "A collection of flags to select the GPU to run the samples on",
                      {},
                      {},
-                     {{"gpu", "Zero-based index of the GPU that the sample should use"}})
+                     {{"gpu", "Zero-based index of the GPU that the sample should use"},
+                      {"device-group", "Render alternate frames on all the GPUs of the device group of the selected GPU"}})
 {
 }
 
@@ -54,6 +55,14 @@ bool GpuSelection::handle_option(std::deque<std::string> &arguments)
 		arguments.pop_front();
 		return true;
 	}
+	else if (option == "device-group")
+	{
+		vkb::Instance::use_device_group          = true;
+		vkb::core::HPPInstance::use_device_group = true;
+
+		arguments.pop_front();
+		return true;
+	}
 	return false;
 }
 }        // namespace plugins
\ No newline at end of file
@@ -29,7 +29,9 @@ using GpuSelectionTags = vkb::PluginBase<GpuSelection, vkb::tags::Passive>;
 /**
  * @brief GPU selection options
  *
- * Explicitly select a GPU to run the samples on
+ * Explicitly select a GPU to run the samples on, or render alternate frames on all the GPUs of its device group
+ *
+ * Usage: vulkan_sample sample afbc --gpu 0 --device-group
  *
  */
 class GpuSelection : public GpuSelectionTags
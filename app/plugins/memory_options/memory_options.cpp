@@ -0,0 +1,87 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory_options.h"
+
+#include "core/allocated.h"
+
+namespace plugins
+{
+MemoryOptions::MemoryOptions() :
+    MemoryOptionsTags("Memory Options",
+                      "Choose how the device memory is allocated.",
+                      {},
+                      {},
+                      {{"memory-pools", "Allocate each class of resources from pools of its own"},
+                       {"memory-strategy", "Favour the allocation time or the memory usage [min-time|min-memory]"},
+                       {"memory-defragmentation", "Move the buffers to compact the memory when it gets fragmented"}})
+{
+}
+
+bool MemoryOptions::handle_option(std::deque<std::string> &arguments)
+{
+	assert(!arguments.empty() && (arguments[0].substr(0, 2) == "--"));
+	std::string option = arguments[0].substr(2);
+	if (option == "memory-pools")
+	{
+		auto settings      = vkb::allocated::get_settings();
+		settings.use_pools = true;
+		vkb::allocated::set_settings(settings);
+
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "memory-defragmentation")
+	{
+		auto settings            = vkb::allocated::get_settings();
+		settings.defragmentation = true;
+		vkb::allocated::set_settings(settings);
+
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "memory-strategy")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"memory-strategy\" is missing the strategy!");
+			return false;
+		}
+
+		auto settings = vkb::allocated::get_settings();
+		if (arguments[1] == "min-time")
+		{
+			settings.strategy = vkb::allocated::AllocationStrategy::MinTime;
+		}
+		else if (arguments[1] == "min-memory")
+		{
+			settings.strategy = vkb::allocated::AllocationStrategy::MinMemory;
+		}
+		else
+		{
+			LOGE("Option \"memory-strategy\" needs min-time or min-memory!");
+			return false;
+		}
+		vkb::allocated::set_settings(settings);
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	return false;
+}
+}        // namespace plugins
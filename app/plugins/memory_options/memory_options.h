@@ -0,0 +1,49 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "platform/plugins/plugin_base.h"
+
+namespace plugins
+{
+class MemoryOptions;
+
+// Passive behaviour
+using MemoryOptionsTags = vkb::PluginBase<MemoryOptions, vkb::tags::Passive>;
+
+/**
+ * @brief Memory Options
+ *
+ * Choose how the device memory is allocated, see vkb::allocated::Settings.
+ * The resources can be allocated from a pool per class of resources, and the allocator can favour the
+ * allocation time or the fragmentation of the memory. The memory can also be compacted when it gets
+ * fragmented, see vkb::Defragmenter.
+ *
+ * Usage: vulkan_sample sample afbc --memory-pools --memory-strategy min-time --memory-defragmentation
+ *
+ */
+class MemoryOptions : public MemoryOptionsTags
+{
+  public:
+	MemoryOptions();
+
+	virtual ~MemoryOptions() = default;
+
+	bool handle_option(std::deque<std::string> &arguments) override;
+};
+}        // namespace plugins
@@ -0,0 +1,97 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory_report.h"
+
+#include "core/allocated.h"
+#include "filesystem/legacy.h"
+
+namespace plugins
+{
+MemoryReport::MemoryReport() :
+    MemoryReportTags("Memory Report",
+                     "Write a report of the memory used at a specific frame",
+                     {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::PostDraw},
+                     {},
+                     {{"memory-report", "Write the memory report at a given frame"}, {"memory-report-output", "Declare an output name for the report"}})
+{
+}
+
+bool MemoryReport::handle_option(std::deque<std::string> &arguments)
+{
+	assert(!arguments.empty() && (arguments[0].substr(0, 2) == "--"));
+	std::string option = arguments[0].substr(2);
+	if (option == "memory-report")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"memory-report\" is missing the frame index to write the report at!");
+			return false;
+		}
+		frame_number = static_cast<uint32_t>(std::stoul(arguments[1]));
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "memory-report-output")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"memory-report-output\" is missing the filename to store the report!");
+			return false;
+		}
+		output_path     = arguments[1];
+		output_path_set = true;
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	return false;
+}
+
+void MemoryReport::on_update(float delta_time)
+{
+	current_frame++;
+}
+
+void MemoryReport::on_app_start(const std::string &app_id)
+{
+	current_app_id = app_id;
+	current_frame  = 0;
+}
+
+void MemoryReport::on_post_draw(vkb::RenderContext &context)
+{
+	if (current_frame != frame_number)
+	{
+		return;
+	}
+
+	std::string path = output_path_set ? output_path : vkb::fs::path::get(vkb::fs::path::Type::Logs) + current_app_id + "-memory";
+
+	try
+	{
+		vkb::allocated::write_memory_report(path + ".json");
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to write the memory report of {}: {}", current_app_id, e.what());
+	}
+}
+}        // namespace plugins
@@ -0,0 +1,58 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "platform/plugins/plugin_base.h"
+
+namespace plugins
+{
+class MemoryReport;
+
+using MemoryReportTags = vkb::PluginBase<MemoryReport, vkb::tags::Passive>;
+
+/**
+ * @brief Memory Report
+ *
+ * Write a JSON report of the device memory and the CPU heap allocations at a given frame, see vkb::allocated::write_memory_report.
+ * The report is written to the logs directory unless it is named.
+ *
+ * Usage: vulkan_sample sample afbc --memory-report 100 --memory-report-output afbc-memory
+ *
+ */
+class MemoryReport : public MemoryReportTags
+{
+  public:
+	MemoryReport();
+
+	virtual ~MemoryReport() = default;
+
+	void on_update(float delta_time) override;
+	void on_app_start(const std::string &app_id) override;
+	void on_post_draw(vkb::RenderContext &context) override;
+
+	bool handle_option(std::deque<std::string> &arguments) override;
+
+  private:
+	uint32_t    current_frame = 0;
+	uint32_t    frame_number  = 0;
+	std::string current_app_id;
+
+	bool        output_path_set = false;
+	std::string output_path;
+};
+}        // namespace plugins
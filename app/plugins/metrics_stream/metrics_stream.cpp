@@ -0,0 +1,417 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Winsock must be included before any header including windows.h
+#if defined(_WIN32)
+#	include <winsock2.h>
+#	include <ws2tcpip.h>
+#else
+#	include <fcntl.h>
+#	include <netdb.h>
+#	include <sys/socket.h>
+#	include <unistd.h>
+#endif
+
+#include "metrics_stream.h"
+
+#include <fmt/format.h>
+
+#include "core/allocated.h"
+#include "core/device.h"
+#include "rendering/render_context.h"
+#include "stats/stats.h"
+#include "vulkan_sample.h"
+
+namespace plugins
+{
+namespace
+{
+#if defined(_WIN32)
+using SocketHandle                   = SOCKET;
+constexpr SocketHandle InvalidSocket = INVALID_SOCKET;
+#else
+using SocketHandle                   = int;
+constexpr SocketHandle InvalidSocket = -1;
+#endif
+
+/**
+ * @brief A non-blocking UDP socket sending to a single address, closed when destroyed
+ */
+class UdpSocket
+{
+  public:
+	UdpSocket(const std::string &host, const std::string &port)
+	{
+#if defined(_WIN32)
+		WSADATA wsa_data;
+		if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0)
+		{
+			return;
+		}
+		wsa_started = true;
+#endif
+
+		addrinfo hints{};
+		hints.ai_family   = AF_UNSPEC;
+		hints.ai_socktype = SOCK_DGRAM;
+
+		addrinfo *addresses = nullptr;
+		if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0 || !addresses)
+		{
+			return;
+		}
+
+		handle = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+		if (handle != InvalidSocket && connect(handle, addresses->ai_addr, static_cast<int>(addresses->ai_addrlen)) != 0)
+		{
+			close();
+		}
+		freeaddrinfo(addresses);
+
+		// A full send buffer drops the datagram instead of blocking the thread
+		if (handle != InvalidSocket)
+		{
+#if defined(_WIN32)
+			u_long non_blocking = 1;
+			ioctlsocket(handle, FIONBIO, &non_blocking);
+#else
+			fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+		}
+	}
+
+	UdpSocket(const UdpSocket &) = delete;
+
+	UdpSocket(UdpSocket &&) = delete;
+
+	~UdpSocket()
+	{
+		close();
+
+#if defined(_WIN32)
+		if (wsa_started)
+		{
+			WSACleanup();
+		}
+#endif
+	}
+
+	UdpSocket &operator=(const UdpSocket &) = delete;
+
+	UdpSocket &operator=(UdpSocket &&) = delete;
+
+	bool is_open() const
+	{
+		return handle != InvalidSocket;
+	}
+
+	/**
+	 * @return Whether the datagram was sent, it isn't when the send buffer is full or the destination unreachable
+	 */
+	bool send(const std::string &datagram)
+	{
+		return ::send(handle, datagram.data(), static_cast<int>(datagram.size()), 0) == static_cast<int>(datagram.size());
+	}
+
+  private:
+	void close()
+	{
+		if (handle != InvalidSocket)
+		{
+#if defined(_WIN32)
+			closesocket(handle);
+#else
+			::close(handle);
+#endif
+			handle = InvalidSocket;
+		}
+	}
+
+	SocketHandle handle{InvalidSocket};
+
+#if defined(_WIN32)
+	bool wsa_started{false};
+#endif
+};
+
+std::string escape_json(const std::string &text)
+{
+	std::string escaped;
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+/**
+ * @return The stats of the app, nullptr if it isn't a Vulkan sample
+ */
+const vkb::Stats *get_stats(vkb::Application &app)
+{
+	if (auto *sample = dynamic_cast<vkb::VulkanSampleC *>(&app))
+	{
+		return &sample->get_stats();
+	}
+	else if (auto *sample = dynamic_cast<vkb::VulkanSampleCpp *>(&app))
+	{
+		return reinterpret_cast<const vkb::Stats *>(&sample->get_stats());
+	}
+	return nullptr;
+}
+}        // namespace
+
+MetricsStream::MetricsStream() :
+    MetricsStreamTags("Metrics Stream",
+                      "Stream the stats of a run over UDP.",
+                      {vkb::Hook::OnAppStart, vkb::Hook::PostDraw},
+                      {},
+                      {{"metrics-stream", "Send the stats as lines of JSON to a host:port over UDP"},
+                       {"metrics-stream-rate", "Number of samples sent per second"}})
+{
+}
+
+MetricsStream::~MetricsStream()
+{
+	if (sender.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock{mutex};
+			stopping = true;
+		}
+		condition.notify_one();
+		sender.join();
+	}
+}
+
+bool MetricsStream::handle_option(std::deque<std::string> &arguments)
+{
+	assert(!arguments.empty() && (arguments[0].substr(0, 2) == "--"));
+	std::string option = arguments[0].substr(2);
+	if (option == "metrics-stream")
+	{
+		// The last colon, the host may be an IPv6 address
+		auto separator = arguments.size() < 2 ? std::string::npos : arguments[1].rfind(':');
+		if (separator == std::string::npos || separator == 0 || separator + 1 == arguments[1].size())
+		{
+			LOGE("Option \"metrics-stream\" is missing the host:port to send the stats to!");
+			return false;
+		}
+		host = arguments[1].substr(0, separator);
+		port = arguments[1].substr(separator + 1);
+
+		// Brackets around an IPv6 address
+		if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+		{
+			host = host.substr(1, host.size() - 2);
+		}
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	else if (option == "metrics-stream-rate")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"metrics-stream-rate\" is missing the number of samples per second!");
+			return false;
+		}
+		rate = std::stof(arguments[1]);
+		if (rate <= 0.0f)
+		{
+			LOGE("Option \"metrics-stream-rate\" must be positive!");
+			return false;
+		}
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	return false;
+}
+
+void MetricsStream::on_app_start(const std::string &id)
+{
+	app_id              = id;
+	frame_count         = 0;
+	last_cache_counters = {};
+	timer.start();
+}
+
+void MetricsStream::on_post_draw(vkb::RenderContext &context)
+{
+	frame_count++;
+
+	if (host.empty() || timer.elapsed<vkb::Timer::Seconds>() < 1.0 / rate)
+	{
+		return;
+	}
+	timer.lap();
+
+	queue(take_sample(context));
+}
+
+std::string MetricsStream::take_sample(vkb::RenderContext &context)
+{
+	auto &device = context.get_device();
+
+	std::string sample = fmt::format("{{\"app\": \"{}\", \"device\": \"{}\", \"frame\": {}", escape_json(app_id),
+	                                 escape_json(device.get_gpu().get_properties().deviceName), frame_count);
+
+	// The newest value of every stat, unscaled
+	sample += ", \"stats\": {";
+	if (auto *stats = get_stats(platform->get_app()))
+	{
+		bool first = true;
+		for (auto index : stats->get_requested_stats())
+		{
+			if (!stats->is_available(index))
+			{
+				continue;
+			}
+
+			auto &history = stats->get_data(index);
+			auto &values  = history.get_values();
+			if (values.empty())
+			{
+				continue;
+			}
+
+			sample += fmt::format("{}\"{}\": {}", first ? "" : ", ", escape_json(stats->get_graph_data(index).name),
+			                      values[(history.get_head() + values.size() - 1) % values.size()]);
+			first = false;
+		}
+	}
+	sample += "}";
+
+	if (auto *gpu_frame_timer = context.get_gpu_frame_timer())
+	{
+		sample += fmt::format(", \"gpu_time\": {:.3f}, \"passes\": [", gpu_frame_timer->get_frame_time());
+
+		auto &pass_times = gpu_frame_timer->get_pass_times();
+		for (size_t i = 0; i < pass_times.size(); ++i)
+		{
+			sample += fmt::format("{}{{\"name\": \"{}\", \"gpu_time\": {:.3f}}}", i == 0 ? "" : ", ", escape_json(pass_times[i].name), pass_times[i].time);
+		}
+		sample += "]";
+	}
+
+	const VkPhysicalDeviceMemoryProperties *memory_properties{nullptr};
+	vmaGetMemoryProperties(vkb::allocated::get_memory_allocator(), &memory_properties);
+
+	VmaBudget heap_budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetHeapBudgets(vkb::allocated::get_memory_allocator(), heap_budgets);
+
+	sample += ", \"heaps\": [";
+	for (uint32_t heap = 0; heap < memory_properties->memoryHeapCount; ++heap)
+	{
+		sample += fmt::format("{}{{\"budget\": {}, \"usage\": {}}}", heap == 0 ? "" : ", ", heap_budgets[heap].budget, heap_budgets[heap].usage);
+	}
+	sample += "]";
+
+	auto cache_stats = device.get_resource_cache().GetStats();
+
+	vkb::ResourceCacheCounters all{};
+	for (auto *counters : {&cache_stats.shader_modules, &cache_stats.pipeline_layouts, &cache_stats.descriptor_set_layouts,
+	                       &cache_stats.render_passes, &cache_stats.graphics_pipelines, &cache_stats.graphics_pipeline_libraries,
+	                       &cache_stats.compute_pipelines, &cache_stats.shader_objects, &cache_stats.descriptor_sets, &cache_stats.framebuffers})
+	{
+		all.hits += counters->hits;
+		all.misses += counters->misses;
+		all.evictions += counters->evictions;
+	}
+
+	// The counters start again from zero after ResourceCache::ResetStats
+	if (all.hits < last_cache_counters.hits || all.misses < last_cache_counters.misses || all.evictions < last_cache_counters.evictions)
+	{
+		last_cache_counters = {};
+	}
+
+	uint64_t hits    = all.hits - last_cache_counters.hits;
+	uint64_t lookups = hits + all.misses - last_cache_counters.misses;
+	sample += fmt::format(", \"resource_cache\": {{\"lookups\": {}, \"hit_rate\": {}, \"evictions\": {}}}", lookups,
+	                      lookups == 0 ? "null" : fmt::format("{:.4f}", static_cast<double>(hits) / lookups), all.evictions - last_cache_counters.evictions);
+	last_cache_counters = all;
+
+	// Closed by the sending thread, which adds the samples dropped before it
+	return sample;
+}
+
+void MetricsStream::queue(std::string &&sample)
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+
+		if (!sender.joinable())
+		{
+			sender = std::thread{&MetricsStream::send_samples, this};
+		}
+
+		if (samples.size() == MaxQueuedSamples)
+		{
+			samples.pop_front();
+			dropped_samples++;
+		}
+		samples.push_back(std::move(sample));
+	}
+	condition.notify_one();
+}
+
+void MetricsStream::send_samples()
+{
+	UdpSocket socket{host, port};
+	if (!socket.is_open())
+	{
+		// The queue stays bounded, the samples are dropped from it
+		LOGE("Failed to open a UDP socket to {}:{}, the metrics aren't streamed", host, port);
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock{mutex};
+	while (true)
+	{
+		condition.wait(lock, [this]() { return stopping || !samples.empty(); });
+		if (stopping)
+		{
+			return;
+		}
+
+		auto sample  = std::move(samples.front());
+		auto dropped = dropped_samples;
+		samples.pop_front();
+		dropped_samples = 0;
+
+		lock.unlock();
+
+		sample += fmt::format(", \"dropped\": {}}}\n", dropped);
+		bool sent = socket.send(sample);
+
+		lock.lock();
+
+		// Counted with the samples the queue dropped, in the next sample sent
+		if (!sent)
+		{
+			dropped_samples += dropped + 1;
+		}
+	}
+}
+}        // namespace plugins
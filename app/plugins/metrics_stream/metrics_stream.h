@@ -0,0 +1,105 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ResourceCache.h"
+#include "platform/plugins/plugin_base.h"
+#include "timer.h"
+
+namespace plugins
+{
+class MetricsStream;
+
+using MetricsStreamTags = vkb::PluginBase<MetricsStream, vkb::tags::Passive>;
+
+/**
+ * @brief Metrics Stream
+ *
+ * Streams the metrics of a run over UDP, for devices where neither Tracy nor the overlay can be watched. Each sample is a
+ * datagram holding a single line of JSON with the latest value of every stat the app requested from vkb::Stats, the GPU
+ * time of the passes of the render and postprocessing pipelines, the budget and usage of each memory heap and the hit
+ * rates of the resource cache since the previous sample.
+ *
+ * The samples are taken after the frames at a fixed rate, then queued for a thread sending them, so the frames never wait
+ * on the network. The queue is bounded, when the thread falls behind the oldest samples are dropped and the next sample
+ * sent counts them. A dashboard can tell the devices apart by the source address or the device name in the samples.
+ *
+ * Usage: vulkan_samples sample afbc --metrics-stream 192.168.1.10:9000 --metrics-stream-rate 5
+ *
+ */
+class MetricsStream : public MetricsStreamTags
+{
+  public:
+	/// Samples waiting for the sending thread, the oldest ones are dropped beyond
+	static constexpr size_t MaxQueuedSamples = 64;
+
+	MetricsStream();
+
+	virtual ~MetricsStream();
+
+	void on_app_start(const std::string &app_id) override;
+	void on_post_draw(vkb::RenderContext &context) override;
+
+	bool handle_option(std::deque<std::string> &arguments) override;
+
+  private:
+	/**
+	 * @return A line of JSON with the metrics of the app and of the last frame of the render context
+	 */
+	std::string take_sample(vkb::RenderContext &context);
+
+	/**
+	 * @brief Queues a sample for the sending thread, started on the first one
+	 */
+	void queue(std::string &&sample);
+
+	/**
+	 * @brief Sends the queued samples until the plugin is destroyed
+	 */
+	void send_samples();
+
+	std::string host;
+	std::string port;
+
+	/// Samples taken per second
+	float rate = 10.0f;
+
+	std::string app_id;
+
+	uint64_t frame_count = 0;
+
+	/// Lapped on every sample
+	vkb::Timer timer;
+
+	/// Resource cache counters of the previous sample, the hit rates are the ones of the lookups done since
+	vkb::ResourceCacheCounters last_cache_counters{};
+
+	std::thread             sender;
+	std::mutex              mutex;
+	std::condition_variable condition;
+	std::deque<std::string> samples;
+	size_t                  dropped_samples = 0;
+	bool                    stopping        = false;
+};
+}        // namespace plugins
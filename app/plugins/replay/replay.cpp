@@ -0,0 +1,351 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "replay.h"
+
+#include <cmath>
+#include <sstream>
+
+#include <fmt/format.h>
+
+#include "filesystem/filesystem.hpp"
+#include "scene_graph/components/camera.h"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+#include "vulkan_sample.h"
+
+namespace plugins
+{
+namespace
+{
+/// Tolerance of the comparison of the replayed camera with the recorded one
+constexpr float CameraTolerance = 1e-3f;
+
+/**
+ * @return The node of the first camera of the scene of the app, nullptr if it has none
+ */
+vkb::sg::Node *get_camera_node(vkb::Application &app)
+{
+	vkb::sg::Scene *scene = nullptr;
+	if (auto *sample = dynamic_cast<vkb::VulkanSampleC *>(&app))
+	{
+		scene = sample->has_scene() ? &sample->get_scene() : nullptr;
+	}
+	else if (auto *sample = dynamic_cast<vkb::VulkanSampleCpp *>(&app))
+	{
+		scene = sample->has_scene() ? reinterpret_cast<vkb::sg::Scene *>(&sample->get_scene()) : nullptr;
+	}
+
+	if (!scene || !scene->has_component<vkb::sg::Camera>())
+	{
+		return nullptr;
+	}
+
+	return scene->get_components<vkb::sg::Camera>()[0]->get_node();
+}
+
+std::unique_ptr<vkb::InputEvent> copy_event(const vkb::InputEvent &input_event)
+{
+	switch (input_event.get_source())
+	{
+		case vkb::EventSource::Keyboard:
+			return std::make_unique<vkb::KeyInputEvent>(static_cast<const vkb::KeyInputEvent &>(input_event));
+		case vkb::EventSource::Mouse:
+			return std::make_unique<vkb::MouseButtonInputEvent>(static_cast<const vkb::MouseButtonInputEvent &>(input_event));
+		case vkb::EventSource::Touchscreen:
+			return std::make_unique<vkb::TouchInputEvent>(static_cast<const vkb::TouchInputEvent &>(input_event));
+		default:
+			return nullptr;
+	}
+}
+}        // namespace
+
+Replay::Replay() :
+    ReplayTags("Replay",
+               "Record the inputs and camera path of a run and replay them deterministically.",
+               {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::OnAppClose, vkb::Hook::PostDraw, vkb::Hook::OnInputEvent},
+               {},
+               {{"record", "Record the input events and the camera path to a file"},
+                {"replay", "Replay the input events and the camera path of a file"}})
+{
+}
+
+bool Replay::handle_option(std::deque<std::string> &arguments)
+{
+	assert(!arguments.empty() && (arguments[0].substr(0, 2) == "--"));
+	std::string option = arguments[0].substr(2);
+	if (option == "record" || option == "replay")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"{}\" is missing the path of the recording!", option);
+			return false;
+		}
+		if (recording || replaying)
+		{
+			LOGE("Options \"record\" and \"replay\" can't be combined!");
+			return false;
+		}
+		path      = arguments[1];
+		recording = option == "record";
+		replaying = option == "replay";
+
+		// Frames are only reproducible with the same simulation time
+		platform->force_simulation_fps(60.0f);
+		platform->force_render(true);
+		if (replaying)
+		{
+			platform->disable_input_processing();
+		}
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
+	return false;
+}
+
+void Replay::on_app_start(const std::string &app_id)
+{
+	current_app_id      = app_id;
+	current_frame       = 0;
+	divergence_reported = false;
+	frames.clear();
+
+	if (replaying)
+	{
+		load();
+	}
+}
+
+void Replay::on_app_close(const std::string &app_id)
+{
+	if (!recording)
+	{
+		return;
+	}
+
+	// The replay runs as many frames as the recording
+	get_frame(current_frame);
+
+	try
+	{
+		save();
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to write the recording of {} to {}: {}", app_id, path, e.what());
+	}
+}
+
+void Replay::on_update(float delta_time)
+{
+	++current_frame;
+
+	if (!replaying)
+	{
+		return;
+	}
+
+	if (current_frame >= frames.size())
+	{
+		LOGI("Replay of {} completed after {} frames", current_app_id, frames.size() - 1);
+		platform->close();
+		return;
+	}
+
+	for (auto &event : frames[current_frame].events)
+	{
+		platform->get_app().input_event(*event);
+	}
+}
+
+void Replay::on_input_event(const vkb::InputEvent &input_event)
+{
+	// Events passed to the app while replaying are the recorded ones
+	if (!recording)
+	{
+		return;
+	}
+
+	if (auto event = copy_event(input_event))
+	{
+		get_frame(current_frame + 1).events.push_back(std::move(event));
+	}
+}
+
+void Replay::on_post_draw(vkb::RenderContext &context)
+{
+	auto *node = get_camera_node(platform->get_app());
+	if (!node)
+	{
+		return;
+	}
+
+	auto &transform = node->get_transform();
+
+	if (recording)
+	{
+		auto &frame       = get_frame(current_frame);
+		frame.has_camera  = true;
+		frame.translation = transform.get_translation();
+		frame.rotation    = transform.get_rotation();
+		return;
+	}
+
+	if (!replaying || current_frame >= frames.size() || !frames[current_frame].has_camera)
+	{
+		return;
+	}
+
+	auto &frame = frames[current_frame];
+	if (!divergence_reported &&
+	    (glm::distance(transform.get_translation(), frame.translation) > CameraTolerance ||
+	     1.0f - std::abs(glm::dot(transform.get_rotation(), frame.rotation)) > CameraTolerance))
+	{
+		LOGW("Replay of {} diverged from the recording at frame {}, the camera follows the recorded path", current_app_id, current_frame);
+		divergence_reported = true;
+	}
+
+	// The next frame starts from the recorded camera, like the recorded run
+	transform.set_translation(frame.translation);
+	transform.set_rotation(frame.rotation);
+}
+
+Replay::Frame &Replay::get_frame(size_t index)
+{
+	if (index >= frames.size())
+	{
+		frames.resize(index + 1);
+	}
+	return frames[index];
+}
+
+void Replay::load()
+{
+	auto fs = vkb::filesystem::get();
+	if (!fs->is_file(path))
+	{
+		throw std::runtime_error{fmt::format("The recording {} doesn't exist", path)};
+	}
+
+	std::istringstream lines{fs->read_file_string(path)};
+	std::string        line;
+	while (std::getline(lines, line))
+	{
+		std::istringstream fields{line};
+		std::string        type;
+		size_t             index = 0;
+		fields >> type;
+
+		if (type == "app")
+		{
+			std::string app_id;
+			fields >> app_id;
+			if (app_id != current_app_id)
+			{
+				LOGW("Replaying the recording of {} with {}", app_id, current_app_id);
+			}
+			continue;
+		}
+
+		fields >> index;
+		if (type == "camera")
+		{
+			auto &frame      = get_frame(index);
+			frame.has_camera = true;
+			fields >> frame.translation.x >> frame.translation.y >> frame.translation.z >>
+			    frame.rotation.x >> frame.rotation.y >> frame.rotation.z >> frame.rotation.w;
+		}
+		else if (type == "key")
+		{
+			int code = 0, action = 0;
+			fields >> code >> action;
+			get_frame(index).events.push_back(std::make_unique<vkb::KeyInputEvent>(static_cast<vkb::KeyCode>(code), static_cast<vkb::KeyAction>(action)));
+		}
+		else if (type == "mouse")
+		{
+			int   button = 0, action = 0;
+			float x = 0.0f, y = 0.0f;
+			fields >> button >> action >> x >> y;
+			get_frame(index).events.push_back(
+			    std::make_unique<vkb::MouseButtonInputEvent>(static_cast<vkb::MouseButton>(button), static_cast<vkb::MouseAction>(action), x, y));
+		}
+		else if (type == "touch")
+		{
+			int32_t pointer_id = 0;
+			size_t  count      = 0;
+			int     action     = 0;
+			float   x = 0.0f, y = 0.0f;
+			fields >> pointer_id >> count >> action >> x >> y;
+			get_frame(index).events.push_back(
+			    std::make_unique<vkb::TouchInputEvent>(pointer_id, count, static_cast<vkb::TouchAction>(action), x, y));
+		}
+		else if (!type.empty())
+		{
+			LOGW("Ignoring the unknown entry \"{}\" of the recording {}", type, path);
+		}
+	}
+
+	LOGI("Replaying {} frames of {}", frames.empty() ? 0 : frames.size() - 1, path);
+}
+
+void Replay::save() const
+{
+	std::string data = fmt::format("app {}\n", current_app_id);
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		for (auto &event : frames[i].events)
+		{
+			switch (event->get_source())
+			{
+				case vkb::EventSource::Keyboard:
+				{
+					auto &key = static_cast<const vkb::KeyInputEvent &>(*event);
+					data += fmt::format("key {} {} {}\n", i, static_cast<int>(key.get_code()), static_cast<int>(key.get_action()));
+					break;
+				}
+				case vkb::EventSource::Mouse:
+				{
+					auto &mouse = static_cast<const vkb::MouseButtonInputEvent &>(*event);
+					data += fmt::format("mouse {} {} {} {} {}\n", i, static_cast<int>(mouse.get_button()), static_cast<int>(mouse.get_action()),
+					                    mouse.get_pos_x(), mouse.get_pos_y());
+					break;
+				}
+				case vkb::EventSource::Touchscreen:
+				{
+					auto &touch = static_cast<const vkb::TouchInputEvent &>(*event);
+					data += fmt::format("touch {} {} {} {} {} {}\n", i, touch.get_pointer_id(), touch.get_touch_points(), static_cast<int>(touch.get_action()),
+					                    touch.get_pos_x(), touch.get_pos_y());
+					break;
+				}
+			}
+		}
+
+		if (frames[i].has_camera)
+		{
+			auto &t = frames[i].translation;
+			auto &r = frames[i].rotation;
+			data += fmt::format("camera {} {} {} {} {} {} {} {}\n", i, t.x, t.y, t.z, r.x, r.y, r.z, r.w);
+		}
+	}
+
+	vkb::filesystem::get()->write_file(path, data);
+
+	LOGI("Recorded {} frames of {} to {}", frames.empty() ? 0 : frames.size() - 1, current_app_id, path);
+}
+}        // namespace plugins
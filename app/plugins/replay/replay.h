@@ -0,0 +1,96 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/glm_common.h"
+#include "platform/input_events.h"
+#include "platform/plugins/plugin_base.h"
+
+namespace plugins
+{
+class Replay;
+
+using ReplayTags = vkb::PluginBase<Replay, vkb::tags::Passive>;
+
+/**
+ * @brief Replay
+ *
+ * Record the input events and the camera path of a run, and replay them in a later run so both see the same frames.
+ * Both modes fix the simulation frame time to 60 FPS. The recording is a text file with the input events passed to the app
+ * before each frame and the transform of the camera after it.
+ *
+ * When replaying, the input events of the platform are ignored and the recorded ones are passed to the app instead. The camera is
+ * moved back to its recorded transform after each frame, so the path stays the same even if the sample reacts differently to the
+ * inputs, which is reported once. The application is closed after the last recorded frame. Combined with --benchmark the frames of two runs match, so their reports can be compared frame
+ * by frame, see --benchmark-baseline.
+ *
+ * Usage: vulkan_samples sample afbc --record afbc-path.txt
+ *        vulkan_samples sample afbc --replay afbc-path.txt --benchmark --benchmark-output afbc-after
+ *
+ */
+class Replay : public ReplayTags
+{
+  public:
+	Replay();
+
+	virtual ~Replay() = default;
+
+	void on_update(float delta_time) override;
+	void on_app_start(const std::string &app_id) override;
+	void on_app_close(const std::string &app_id) override;
+	void on_post_draw(vkb::RenderContext &context) override;
+	void on_input_event(const vkb::InputEvent &input_event) override;
+
+	bool handle_option(std::deque<std::string> &arguments) override;
+
+  private:
+	/// The input events passed to the app before a frame and the camera transform after it
+	struct Frame
+	{
+		std::vector<std::unique_ptr<vkb::InputEvent>> events;
+
+		bool      has_camera{false};
+		glm::vec3 translation{0.0f};
+		glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+	};
+
+	void load();
+
+	void save() const;
+
+	Frame &get_frame(size_t index);
+
+	bool recording = false;
+	bool replaying = false;
+
+	std::string path;
+
+	std::string current_app_id;
+
+	/// Index of the frame being updated, the events received after it are passed to the app before the next one
+	size_t current_frame = 0;
+
+	std::vector<Frame> frames;
+
+	bool divergence_reported = false;
+};
+}        // namespace plugins
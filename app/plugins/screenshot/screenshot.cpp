@@ -18,9 +18,12 @@
 
 #include "screenshot.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 
+#include <fmt/format.h>
+
 #include "rendering/render_context.h"
 
 namespace plugins
@@ -28,9 +31,11 @@ namespace plugins
 Screenshot::Screenshot() :
     ScreenshotTags("Screenshot",
                    "Save a screenshot of a specific frame",
-                   {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::PostDraw},
+                   {vkb::Hook::OnUpdate, vkb::Hook::OnAppStart, vkb::Hook::OnAppClose, vkb::Hook::PostDraw},
                    {},
-                   {{"screenshot", "Take a screenshot at a given frame"}, {"screenshot-output", "Declare an output name for the image"}})
+                   {{"screenshot", "Take a screenshot at a given frame"},
+                    {"screenshot-every", "Take a screenshot every n frames, without stalling the rendering"},
+                    {"screenshot-output", "Declare an output name for the image"}})
 {
 }
 
@@ -51,6 +56,19 @@ bool Screenshot::handle_option(std::deque<std::string> &arguments)
 		arguments.pop_front();
 		return true;
 	}
+	else if (option == "screenshot-every")
+	{
+		if (arguments.size() < 2)
+		{
+			LOGE("Option \"screenshot-every\" is missing the interval of the frames to take screenshots of!");
+			return false;
+		}
+		frame_interval = std::max(static_cast<uint32_t>(std::stoul(arguments[1])), 1u);
+
+		arguments.pop_front();
+		arguments.pop_front();
+		return true;
+	}
 	else if (option == "screenshot-output")
 	{
 		if (arguments.size() < 2)
@@ -79,8 +97,29 @@ void Screenshot::on_app_start(const std::string &name)
 	current_frame    = 0;
 }
 
+void Screenshot::on_app_close(const std::string &name)
+{
+	// The captures in flight are written before the device of the app is destroyed
+	readback.reset();
+}
+
 void Screenshot::on_post_draw(vkb::RenderContext &context)
 {
+	if (frame_interval > 0)
+	{
+		if (current_frame % frame_interval == 0)
+		{
+			if (!readback)
+			{
+				readback = std::make_unique<vkb::FrameReadback>(context.get_device());
+			}
+
+			auto name = output_path_set ? output_path : current_app_name;
+			readback->capture(context, fmt::format("{}-{:06}", name, current_frame));
+		}
+		return;
+	}
+
 	if (current_frame == frame_number)
 	{
 		if (!output_path_set)
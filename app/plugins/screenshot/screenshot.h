@@ -18,8 +18,11 @@
 
 #pragma once
 
+#include <memory>
+
 #include "filesystem/legacy.h"
 #include "platform/plugins/plugin_base.h"
+#include "rendering/frame_readback.h"
 
 namespace plugins
 {
@@ -32,7 +35,11 @@ using ScreenshotTags = vkb::PluginBase<Screenshot, vkb::tags::Passive>;
  *
  * Capture a screen shot of the last rendered image at a given frame. The output can also be named
  *
+ * With --screenshot-every, every n-th frame is captured to <name>-<frame>.png, for videos or golden image comparisons. The frames
+ * are read back and encoded asynchronously (see vkb::FrameReadback), so capturing them doesn't stall the rendering.
+ *
  * Usage: vulkan_sample sample afbc --screenshot 1 --screenshot-output afbc-screenshot
+ *        vulkan_sample sample afbc --screenshot-every 1 --screenshot-output afbc-frame --stop-after-frame 300
  *
  */
 class Screenshot : public ScreenshotTags
@@ -44,6 +51,7 @@ class Screenshot : public ScreenshotTags
 
 	void on_update(float delta_time) override;
 	void on_app_start(const std::string &app_info) override;
+	void on_app_close(const std::string &app_info) override;
 	void on_post_draw(vkb::RenderContext &context) override;
 
 	bool handle_option(std::deque<std::string> &arguments) override;
@@ -53,6 +61,11 @@ class Screenshot : public ScreenshotTags
 	uint32_t    frame_number;
 	std::string current_app_name;
 
+	/// Interval of the frames captured with the readback, zero if only frame_number is captured
+	uint32_t frame_interval = 0;
+
+	std::unique_ptr<vkb::FrameReadback> readback;
+
 	bool        output_path_set = false;
 	std::string output_path;
 };
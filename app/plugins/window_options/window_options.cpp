@@ -31,9 +31,11 @@ WindowOptions::WindowOptions() :
                       {},
                       {},
                       {{"borderless", "Run in borderless mode"},
+                       {"exclusive", "Run in exclusive fullscreen mode, the swapchain takes over the display (Windows only)"},
                        {"fullscreen", "Run in fullscreen mode"},
                        {"headless-surface", "Run in headless surface mode. A Surface and swap-chain is still created using VK_EXT_headless_surface."},
                        {"height", "Initial window height"},
+                       {"offscreen", "Run without a surface. The frames are rendered to offscreen images and never presented."},
                        {"stretch", "Stretch window to fullscreen (direct-to-display only)"},
                        {"vsync", "Force vsync {ON | OFF}. If not set samples decide how vsync is set"},
                        {"width", "Initial window width"}})
@@ -54,6 +56,14 @@ bool WindowOptions::handle_option(std::deque<std::string> &arguments)
 		arguments.pop_front();
 		return true;
 	}
+	else if (option == "exclusive")
+	{
+		properties.mode = vkb::Window::Mode::FullscreenExclusive;
+		platform->set_window_properties(properties);
+
+		arguments.pop_front();
+		return true;
+	}
 	else if (option == "fullscreen")
 	{
 		properties.mode = vkb::Window::Mode::Fullscreen;
@@ -90,6 +100,14 @@ bool WindowOptions::handle_option(std::deque<std::string> &arguments)
 		arguments.pop_front();
 		return true;
 	}
+	else if (option == "offscreen")
+	{
+		properties.mode = vkb::Window::Mode::Offscreen;
+		platform->set_window_properties(properties);
+
+		arguments.pop_front();
+		return true;
+	}
 	else if (option == "stretch")
 	{
 		properties.mode = vkb::Window::Mode::FullscreenStretch;
@@ -0,0 +1,236 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compiles the GLSL shaders of the shaders directory into a ShaderArchive:
+// the default variant of every shader, and the variants declared in the manifest.
+//
+// Usage: vkb__shader_archiver <manifest> <archive>
+// Paths are relative to the working directory, the root of the repository.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+#include "common/strings.h"
+#include "common/vk_common.h"
+#include "core/shader_module.h"
+#include "core/util/logging.hpp"
+#include "core/util/strings.hpp"
+#include "filesystem/filesystem.hpp"
+#include "filesystem/legacy.h"
+#include "glsl_compiler.h"
+#include "shader_archive.h"
+#include "spirv_reflection.h"
+
+namespace
+{
+std::string trim(const std::string &str)
+{
+	return vkb::trim_left(vkb::trim_right(str, " \t\r"), " \t");
+}
+
+struct ShaderVariantDeclaration
+{
+	std::string filename;
+
+	std::vector<std::string> definitions;
+};
+
+/**
+ * @brief Reads the variants of a manifest, one per line: the shader followed by its definitions, separated by semicolons
+ */
+std::vector<ShaderVariantDeclaration> read_manifest(const std::string &path)
+{
+	std::vector<ShaderVariantDeclaration> declarations;
+
+	std::istringstream manifest{vkb::filesystem::get()->read_file_string(path)};
+
+	std::string line;
+	while (std::getline(manifest, line))
+	{
+		line = trim(line);
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+
+		auto fields = vkb::split(line, ';');
+
+		ShaderVariantDeclaration declaration;
+		declaration.filename = trim(fields[0]);
+
+		for (size_t i = 1; i < fields.size(); ++i)
+		{
+			auto definition = trim(fields[i]);
+			if (!definition.empty())
+			{
+				declaration.definitions.push_back(definition);
+			}
+		}
+
+		declarations.push_back(std::move(declaration));
+	}
+
+	return declarations;
+}
+
+bool contains_include(const std::vector<uint8_t> &source)
+{
+	static const std::string include_directive = "#include";
+	return std::search(source.begin(), source.end(), include_directive.begin(), include_directive.end()) != source.end();
+}
+
+/**
+ * @brief Compiles a variant of a shader, adding its code and its reflected resources to the archive
+ */
+bool archive_variant(vkb::ShaderArchive &archive, VkShaderStageFlagBits stage, const std::vector<uint8_t> &source, const vkb::ShaderVariant &variant, std::string &info_log)
+{
+	vkb::GLSLCompiler compiler;
+
+	std::vector<uint32_t> spirv;
+	if (!compiler.compile_to_spirv(stage, source, "main", variant, spirv, info_log))
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> spirv_data(spirv.size() * sizeof(uint32_t));
+	std::memcpy(spirv_data.data(), spirv.data(), spirv_data.size());
+	archive.add(vkb::ShaderArchive::EntryType::Spirv, vkb::GLSLCompiler::get_spirv_key(stage, source, "main", variant), spirv_data);
+
+	vkb::SPIRVReflection             reflection;
+	std::vector<vkb::ShaderResource> resources;
+	if (!reflection.reflect_shader_resources(stage, spirv, resources, variant))
+	{
+		info_log += "Failed to reflect the shader resources.\n";
+		return false;
+	}
+
+	// The resource count, followed by the serialized resources
+	uint64_t resource_count = resources.size();
+
+	std::vector<uint8_t> resource_data(sizeof(resource_count));
+	std::memcpy(resource_data.data(), &resource_count, sizeof(resource_count));
+
+	auto serialized_resources = vkb::SPIRVReflection::serialize_resources(resources);
+	resource_data.insert(resource_data.end(), serialized_resources.begin(), serialized_resources.end());
+
+	archive.add(vkb::ShaderArchive::EntryType::Resources, vkb::SPIRVReflection::get_resources_key(stage, spirv, variant), resource_data);
+
+	return true;
+}
+
+/**
+ * @brief Archives a variant of a shader as a ShaderModule compiles it, and as vkb::load_shader() compiles the default variant
+ */
+bool archive_shader(vkb::ShaderArchive &archive, const std::string &filename, const vkb::ShaderVariant &variant, std::string &info_log)
+{
+	auto stage = vkb::find_shader_stage(filename.substr(filename.find_last_of('.') + 1));
+
+	vkb::ShaderSource source{filename};
+
+	auto expanded_source = source.get_expanded_source();
+	if (!archive_variant(archive, stage, expanded_source, variant, info_log))
+	{
+		return false;
+	}
+
+	// vkb::load_shader() compiles the file as it is, which only keys the same code if it has no includes
+	std::vector<uint8_t> file_source{source.get_source().begin(), source.get_source().end()};
+	if (variant.get_preamble().empty() && file_source != expanded_source && !contains_include(file_source))
+	{
+		return archive_variant(archive, stage, file_source, variant, info_log);
+	}
+
+	return true;
+}
+
+bool is_glsl_shader(const std::filesystem::path &path)
+{
+	static const std::vector<std::string> extensions = {".vert", ".frag", ".comp", ".geom", ".tesc", ".tese", ".rgen", ".rahit",
+	                                                    ".rchit", ".rmiss", ".rint", ".rcall", ".mesh", ".task"};
+	return std::find(extensions.begin(), extensions.end(), path.extension().string()) != extensions.end();
+}
+}        // namespace
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		LOGE("Usage: {} <manifest> <archive>", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	vkb::filesystem::init();
+
+	// Every shader is compiled from source, rather than taken from the previous archive or the caches
+	vkb::ShaderArchive::set_enabled(false);
+	vkb::GLSLCompiler::set_spirv_cache_enabled(false);
+	vkb::SPIRVReflection::set_cache_enabled(false);
+
+	vkb::ShaderArchive archive;
+
+	try
+	{
+		auto shaders_directory = std::filesystem::path{vkb::fs::path::get(vkb::fs::path::Type::Shaders)};
+
+		// The default variant of every shader, those which need definitions to compile are left to the manifest
+		size_t skipped_count = 0;
+		for (auto &entry : std::filesystem::recursive_directory_iterator{shaders_directory})
+		{
+			if (!entry.is_regular_file() || !is_glsl_shader(entry.path()))
+			{
+				continue;
+			}
+
+			auto filename = entry.path().lexically_relative(shaders_directory).generic_string();
+
+			std::string info_log;
+			if (!archive_shader(archive, filename, {}, info_log))
+			{
+				LOGD("Skipping the default variant of {}", filename);
+				++skipped_count;
+			}
+		}
+
+		for (auto &declaration : read_manifest(argv[1]))
+		{
+			vkb::ShaderVariant variant;
+			variant.add_definitions(declaration.definitions);
+
+			std::string info_log;
+			if (!archive_shader(archive, declaration.filename, variant, info_log))
+			{
+				LOGE("Failed to compile the variant of {} declared in {}", declaration.filename, argv[1]);
+				LOGE("{}", info_log);
+				return EXIT_FAILURE;
+			}
+		}
+
+		archive.write(argv[2]);
+
+		LOGI("Wrote {} entries to {}, skipped the default variant of {} shaders", archive.get_entry_count(), argv[2], skipped_count);
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to build the shader archive: {}", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace vkb
+{
+/**
+ * @brief Precedes the payload of the files the framework caches to disk
+ *        The checksum is the FNV-1a hash of the payload, detecting truncated or corrupted files.
+ */
+struct CacheFileHeader
+{
+	/// Identifies the kind of file, e.g. four characters
+	uint32_t magic;
+
+	/// Must be bumped whenever the layout of the payload changes
+	uint32_t version;
+
+	uint64_t payload_size;
+
+	uint64_t checksum;
+};
+
+/**
+ * @brief Builds a cache file from the values and bytes appended to its payload
+ */
+class CacheFileWriter
+{
+  public:
+	CacheFileWriter(uint32_t magic, uint32_t version);
+
+	void append(const void *data, size_t size);
+
+	/**
+	 * @brief Appends the bytes of a value, e.g. the fixed size header of the payload
+	 */
+	template <class T>
+	void append(const T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only the bytes of trivially copyable values can be cached");
+		append(&value, sizeof(T));
+	}
+
+	/**
+	 * @return The file, its header completed with the size and checksum of the payload
+	 */
+	std::vector<uint8_t> finish();
+
+  private:
+	std::vector<uint8_t> data;
+};
+
+/**
+ * @brief Validates the header of a cache file, then reads its payload in the order it was written
+ *        The reader doesn't copy the file, which must outlive it.
+ */
+class CacheFileReader
+{
+  public:
+	enum class Status
+	{
+		Valid,
+
+		/// Shorter than its header
+		Truncated,
+
+		/// Another kind of file, or another version of the payload
+		Unsupported,
+
+		/// The size or the checksum of the payload don't match the header
+		Corrupted
+	};
+
+	CacheFileReader(const uint8_t *data, size_t size, uint32_t magic, uint32_t version);
+
+	Status get_status() const;
+
+	bool is_valid() const;
+
+	/**
+	 * @brief Copies the next bytes of the payload
+	 * @return False if the payload ends before, nothing is read then
+	 */
+	bool read(void *data, size_t size);
+
+	template <class T>
+	bool read(T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only the bytes of trivially copyable values can be cached");
+		return read(&value, sizeof(T));
+	}
+
+	/**
+	 * @brief Skips the next bytes of the payload, e.g. after using them in place from get_data()
+	 * @return False if the payload ends before, nothing is skipped then
+	 */
+	bool skip(size_t size);
+
+	/**
+	 * @return The bytes of the payload not read yet
+	 */
+	const uint8_t *get_data() const;
+
+	size_t get_remaining_size() const;
+
+  private:
+	Status status{Status::Valid};
+
+	const uint8_t *payload{nullptr};
+
+	size_t remaining_size{0};
+};
+}        // namespace vkb
@@ -0,0 +1,230 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace vkb
+{
+/**
+ * @brief An ordered map stored in a sorted vector
+ *
+ * Meant for few, small keys such as descriptor bindings and array elements: lookups are binary
+ * searches over contiguous memory, and the whole map is a single allocation which is cheap to
+ * copy, iterate and hash. Elements are iterated in key order as std::pair<Key, Value>.
+ *
+ * Unlike std::map, inserting or erasing an element invalidates the iterators and references
+ * to the elements after it. Inserting keys in ascending order appends without moving elements.
+ */
+template <typename Key, typename Value>
+class FlatMap
+{
+  public:
+	using key_type       = Key;
+	using mapped_type    = Value;
+	using value_type     = std::pair<Key, Value>;
+	using iterator       = typename std::vector<value_type>::iterator;
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+
+	FlatMap() = default;
+
+	/**
+	 * @brief Like std::map, only the first element of duplicate keys is kept
+	 */
+	FlatMap(std::initializer_list<value_type> init)
+	{
+		for (auto &element : init)
+		{
+			insert(element);
+		}
+	}
+
+	iterator begin()
+	{
+		return elements.begin();
+	}
+
+	iterator end()
+	{
+		return elements.end();
+	}
+
+	const_iterator begin() const
+	{
+		return elements.begin();
+	}
+
+	const_iterator end() const
+	{
+		return elements.end();
+	}
+
+	bool empty() const
+	{
+		return elements.empty();
+	}
+
+	size_t size() const
+	{
+		return elements.size();
+	}
+
+	void clear()
+	{
+		elements.clear();
+	}
+
+	void reserve(size_t count)
+	{
+		elements.reserve(count);
+	}
+
+	iterator find(const Key &key)
+	{
+		auto it = lower_bound(key);
+		return it != elements.end() && it->first == key ? it : elements.end();
+	}
+
+	const_iterator find(const Key &key) const
+	{
+		auto it = lower_bound(key);
+		return it != elements.end() && it->first == key ? it : elements.end();
+	}
+
+	size_t count(const Key &key) const
+	{
+		return find(key) != elements.end() ? 1 : 0;
+	}
+
+	/**
+	 * @return The value of the key, inserted default constructed if it was missing
+	 */
+	Value &operator[](const Key &key)
+	{
+		return try_emplace(key).first->second;
+	}
+
+	/**
+	 * @throws std::out_of_range if the key is missing
+	 */
+	Value &at(const Key &key)
+	{
+		auto it = find(key);
+		if (it == elements.end())
+		{
+			throw std::out_of_range("FlatMap::at");
+		}
+		return it->second;
+	}
+
+	const Value &at(const Key &key) const
+	{
+		auto it = find(key);
+		if (it == elements.end())
+		{
+			throw std::out_of_range("FlatMap::at");
+		}
+		return it->second;
+	}
+
+	/**
+	 * @return The element of the key, and whether it was inserted or was already in the map
+	 */
+	std::pair<iterator, bool> insert(const value_type &element)
+	{
+		auto [it, inserted] = try_emplace(element.first);
+		if (inserted)
+		{
+			it->second = element.second;
+		}
+		return {it, inserted};
+	}
+
+	/**
+	 * @brief Constructs the value from the arguments if the key is missing, otherwise leaves the map untouched
+	 * @return The element of the key, and whether it was inserted
+	 */
+	template <typename... Args>
+	std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+	{
+		// Keys mostly come in ascending order, which appends without searching
+		if (elements.empty() || elements.back().first < key)
+		{
+			elements.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+			return {std::prev(elements.end()), true};
+		}
+
+		auto it = lower_bound(key);
+		if (it->first == key)
+		{
+			return {it, false};
+		}
+
+		it = elements.emplace(it, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+		return {it, true};
+	}
+
+	/**
+	 * @return The number of elements erased, 0 or 1
+	 */
+	size_t erase(const Key &key)
+	{
+		auto it = find(key);
+		if (it == elements.end())
+		{
+			return 0;
+		}
+		elements.erase(it);
+		return 1;
+	}
+
+	iterator erase(const_iterator position)
+	{
+		return elements.erase(position);
+	}
+
+	bool operator==(const FlatMap &other) const
+	{
+		return elements == other.elements;
+	}
+
+	bool operator!=(const FlatMap &other) const
+	{
+		return elements != other.elements;
+	}
+
+  private:
+	iterator lower_bound(const Key &key)
+	{
+		return std::lower_bound(elements.begin(), elements.end(), key, [](const value_type &element, const Key &value) { return element.first < value; });
+	}
+
+	const_iterator lower_bound(const Key &key) const
+	{
+		return std::lower_bound(elements.begin(), elements.end(), key, [](const value_type &element, const Key &value) { return element.first < value; });
+	}
+
+	std::vector<value_type> elements;
+};
+}        // namespace vkb
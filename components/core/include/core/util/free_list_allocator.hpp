@@ -0,0 +1,98 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace vkb
+{
+/**
+ * @brief Best-fit allocator of aligned ranges out of a fixed size, e.g. the memory of a buffer
+ *
+ * Only the offsets and sizes are managed, so the bookkeeping stays on the host whatever the memory.
+ * The free ranges are indexed both ways: by offset to coalesce neighbours on free, by size for
+ * best-fit lookups. The alignment padding in front of an allocation stays free.
+ */
+class FreeListAllocator
+{
+  public:
+	/// Returned by allocate() when no free range fits
+	static constexpr uint64_t InvalidOffset = ~uint64_t{0};
+
+	/**
+	 * @param size Size of the managed range, free as a whole
+	 * @param alignment Alignment of the offsets of the allocations
+	 */
+	explicit FreeListAllocator(uint64_t size = 0, uint64_t alignment = 1);
+
+	/**
+	 * @return The offset of the allocation, or InvalidOffset if no free range fits
+	 */
+	uint64_t allocate(uint64_t size);
+
+	/**
+	 * @brief Returns an allocation, which merges with the free ranges next to it
+	 * @param offset The offset returned by allocate()
+	 * @param size The size given to allocate()
+	 */
+	void free(uint64_t offset, uint64_t size);
+
+	bool can_allocate(uint64_t size) const;
+
+	/**
+	 * @brief Frees every allocation
+	 */
+	void reset();
+
+	uint64_t get_size() const;
+
+	/**
+	 * @return The number of bytes not allocated, including the alignment padding between allocations
+	 */
+	uint64_t get_free_size() const;
+
+	/**
+	 * @return The number of free ranges, one if nothing is allocated
+	 */
+	size_t get_free_range_count() const;
+
+  private:
+	uint64_t align(uint64_t value) const;
+
+	/**
+	 * @return The smallest free range which can hold an aligned allocation of size bytes, or the end of free_ranges_by_size
+	 */
+	std::multimap<uint64_t, uint64_t>::const_iterator find_free_range(uint64_t size) const;
+
+	void insert_free_range(uint64_t range_offset, uint64_t range_size);
+
+	void erase_free_range(uint64_t range_offset, uint64_t range_size);
+
+	uint64_t size{0};
+
+	uint64_t alignment{1};
+
+	uint64_t free_size{0};
+
+	std::map<uint64_t, uint64_t> free_ranges_by_offset;
+
+	std::multimap<uint64_t, uint64_t> free_ranges_by_size;
+};
+}        // namespace vkb
@@ -17,10 +17,29 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 
 namespace vkb
 {
+/// Offset basis of the 64-bit FNV-1a hash
+constexpr uint64_t fnv1a_offset_basis = 0xcbf29ce484222325ull;
+
+/**
+ * @brief Hashes bytes with the 64-bit FNV-1a hash, which unlike std::hash is the same on every run and platform,
+ *        e.g. for the names and checksums of the files cached to disk
+ * @param hash The hash of the bytes preceding these, to hash several ranges as one
+ */
+inline uint64_t fnv1a_hash(const uint8_t *data, size_t size, uint64_t hash = fnv1a_offset_basis)
+{
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
 inline void hash_combine(size_t &seed, size_t hash)
 {
 	hash += 0x9e3779b9 + (seed << 6) + (seed >> 2);
@@ -0,0 +1,335 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core/util/thread_role.hpp"
+
+namespace vkb
+{
+class JobSystem;
+
+/**
+ * @brief Counts the jobs of a group which didn't run yet
+ *
+ * Scheduling a job with a counter increments it, the counter is decremented once the job ran.
+ * Jobs scheduled after a counter are held by it until it drops to zero. A counter must outlive
+ * the jobs it counts, JobSystem::wait() returns once it is safe to destroy it.
+ * The first exception thrown by the jobs of a group is kept until JobSystem::wait() rethrows it.
+ */
+class JobCounter
+{
+  public:
+	JobCounter() = default;
+
+	JobCounter(const JobCounter &) = delete;
+
+	JobCounter(JobCounter &&) = delete;
+
+	~JobCounter() = default;
+
+	JobCounter &operator=(const JobCounter &) = delete;
+
+	JobCounter &operator=(JobCounter &&) = delete;
+
+	/**
+	 * @return Whether every job of the group ran
+	 */
+	bool is_done() const
+	{
+		return pending.load(std::memory_order_acquire) == 0;
+	}
+
+  private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> pending{0};
+
+	/// Held while the counter is decremented, so a waiter doesn't destroy it under the last job
+	std::mutex mutex;
+
+	/// Jobs scheduled once the counter drops to zero, with the counter of each
+	std::vector<std::pair<std::function<void()>, JobCounter *>> continuations;
+
+	/// First exception thrown by a job of the group, guarded by the mutex
+	std::exception_ptr exception;
+};
+
+/**
+ * @brief Runs the parallel work of the framework on a fixed set of worker threads
+ *
+ * Every worker owns a deque of jobs. A worker pushes and pops the jobs it schedules at the back
+ * of its own deque, and steals from the front of the others once it is empty. Jobs scheduled by
+ * other threads are spread across the deques.
+ *
+ * A thread waiting for a JobCounter runs the queued jobs in the meantime, so jobs can schedule
+ * and wait for jobs of their own without tying up a worker. Blocking on a future returned by
+ * async() doesn't run jobs, jobs should wait for a counter or use wait_for_future() instead.
+ *
+ * The workers of a system share a role, which places them on the cores suited to their work, see set_current_thread_role().
+ * The platform starts the systems shared by the framework once, see init(): get() runs the jobs the frames wait for, and
+ * get_background() the loads and decodes which may take several frames, so they don't delay the frames' own jobs.
+ */
+class JobSystem
+{
+  public:
+	using Job = std::function<void()>;
+
+	/**
+	 * @return One worker per hardware thread but the one of the caller, which takes part while waiting
+	 *         Only the hardware threads of the faster cores count when the workers are kept on them, see get_performance_thread_count().
+	 */
+	static uint32_t get_default_worker_count();
+
+	/**
+	 * @return A worker per four hardware threads, at least one
+	 */
+	static uint32_t get_default_background_worker_count();
+
+	/**
+	 * @brief Starts the systems shared by the framework, replacing the ones already started
+	 */
+	static void init(uint32_t worker_count = get_default_worker_count(), uint32_t background_worker_count = get_default_background_worker_count());
+
+	/**
+	 * @brief Runs the queued jobs and stops the shared systems
+	 */
+	static void terminate();
+
+	/**
+	 * @return The system shared by the framework, with worker threads, started with the default worker count on first use
+	 */
+	static JobSystem &get();
+
+	/**
+	 * @return The system shared by the framework for the background work, started with the default worker count on first use
+	 *         Its jobs may schedule jobs on get() and wait for them.
+	 */
+	static JobSystem &get_background();
+
+	/**
+	 * @param worker_count Number of worker threads
+	 * @param role Role of the worker threads, the threads waiting for jobs keep their own
+	 */
+	explicit JobSystem(uint32_t worker_count = get_default_worker_count(), ThreadRole role = ThreadRole::Worker);
+
+	JobSystem(const JobSystem &) = delete;
+
+	JobSystem(JobSystem &&) = delete;
+
+	/**
+	 * @brief Runs the queued jobs and joins the workers
+	 *        Jobs held by a counter which never drops to zero are dropped.
+	 */
+	~JobSystem();
+
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	JobSystem &operator=(JobSystem &&) = delete;
+
+	uint32_t get_worker_count() const;
+
+	ThreadRole get_role() const;
+
+	/**
+	 * @brief Queues a job
+	 * @param job Exceptions thrown by the job are kept by its counter, or logged and dropped without one
+	 * @param counter Optional counter the job is added to
+	 */
+	void schedule(Job job, JobCounter *counter = nullptr);
+
+	/**
+	 * @brief Queues a job once every job of a counter ran, without blocking the caller
+	 *        The job is queued right away if the counter is already done.
+	 * @param dependency The counter the job waits for
+	 * @param job Exceptions thrown by the job are kept by its counter, or logged and dropped without one
+	 * @param counter Optional counter the job is added to, from this call on
+	 */
+	void schedule_after(JobCounter &dependency, Job job, JobCounter *counter = nullptr);
+
+	/**
+	 * @brief Queues a function and returns its result
+	 * @param counter Optional counter the function is added to
+	 * @return The future of the result, holding the exception thrown by the function if any
+	 */
+	template <typename Function>
+	auto async(Function &&function, JobCounter *counter = nullptr) -> std::future<std::invoke_result_t<std::decay_t<Function>>>;
+
+	/**
+	 * @brief Runs queued jobs until every job of the counter ran
+	 *        Then rethrows the first exception thrown by them, if any, which the counter no longer keeps.
+	 */
+	void wait(JobCounter &counter);
+
+	/**
+	 * @brief Runs queued jobs until a future is ready
+	 *        Used for the futures of jobs the calling job may be queued ahead of.
+	 */
+	template <typename Future>
+	void wait_for_future(const Future &future);
+
+	/**
+	 * @brief Splits [0, count) into ranges, runs them on the workers and the calling thread, and waits for them
+	 * @param count Number of items
+	 * @param min_range_size Smallest number of items worth a job of their own, the range runs on the caller if there are fewer
+	 * @param function Called with the first and one past the last item of each range
+	 */
+	template <typename Function>
+	void parallel_for(size_t count, size_t min_range_size, Function &&function);
+
+  private:
+	/// Time a thread waiting for a future sleeps when no job is queued
+	static constexpr std::chrono::microseconds FuturePollInterval{100};
+
+	struct Task
+	{
+		Job job;
+
+		JobCounter *counter{nullptr};
+	};
+
+	struct Worker
+	{
+		std::mutex mutex;
+
+		std::deque<Task> tasks;
+
+		std::thread thread;
+	};
+
+	/**
+	 * @brief Pushes to the deque of the calling worker, or to the next deque for other threads
+	 */
+	void push(Task &&task);
+
+	/**
+	 * @brief Pops a task of the calling worker, or steals one from the other deques
+	 * @return Whether a task was found
+	 */
+	bool pop(Task &task);
+
+	/**
+	 * @brief Runs a task and decrements its counter, keeping the exception it throws in the counter
+	 */
+	void run(Task &task);
+
+	void worker_loop(uint32_t index);
+
+	ThreadRole role;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	/// Number of tasks in the deques
+	std::atomic<size_t> queued{0};
+
+	/// Deque the next task of a thread other than the workers is pushed to
+	std::atomic<uint32_t> next_worker{0};
+
+	/// Guards the sleep of the workers and waiters
+	std::mutex sleep_mutex;
+
+	/// Notified when a task is queued, and when a counter drops to zero
+	std::condition_variable sleep_condition;
+
+	bool stopping{false};
+};
+
+template <typename Function>
+auto JobSystem::async(Function &&function, JobCounter *counter) -> std::future<std::invoke_result_t<std::decay_t<Function>>>
+{
+	using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+	// std::function must be copyable, the task is not
+	auto task   = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+	auto future = task->get_future();
+
+	schedule([task]() { (*task)(); }, counter);
+
+	return future;
+}
+
+template <typename Future>
+void JobSystem::wait_for_future(const Future &future)
+{
+	while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		Task task;
+		if (pop(task))
+		{
+			run(task);
+		}
+		else
+		{
+			future.wait_for(FuturePollInterval);
+		}
+	}
+}
+
+template <typename Function>
+void JobSystem::parallel_for(size_t count, size_t min_range_size, Function &&function)
+{
+	min_range_size = std::max<size_t>(min_range_size, 1);
+
+	size_t range_count = std::min<size_t>(workers.size() + 1, count / min_range_size);
+	if (range_count <= 1)
+	{
+		if (count > 0)
+		{
+			function(size_t{0}, count);
+		}
+		return;
+	}
+
+	size_t range_size = (count + range_count - 1) / range_count;
+
+	JobCounter counter;
+	for (size_t first = range_size; first < count; first += range_size)
+	{
+		size_t last = std::min(first + range_size, count);
+		schedule([&function, first, last]() { function(first, last); }, &counter);
+	}
+
+	// The caller takes the first range rather than waiting idle, the jobs refer to the function until they ran
+	try
+	{
+		function(size_t{0}, range_size);
+	}
+	catch (...)
+	{
+		wait(counter);
+		throw;
+	}
+
+	wait(counter);
+}
+}        // namespace vkb
@@ -17,6 +17,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/spdlog.h>
 
@@ -28,10 +35,73 @@
 #define LOGE(...) spdlog::error("{}", fmt::format(__VA_ARGS__));
 #define LOGD(...) spdlog::debug(__VA_ARGS__);
 
+/**
+ * @brief Logs a warning at most once per throttle interval from this call site
+ *        Meant for warnings which can repeat every frame. The number of warnings dropped
+ *        in between is logged with the next one.
+ */
+#define LOGW_THROTTLED(...)                                                                                    \
+	do                                                                                                         \
+	{                                                                                                          \
+		static ::vkb::logging::Throttle vkb_log_throttle;                                                      \
+		uint32_t                        vkb_log_suppressed = 0;                                                \
+		if (vkb_log_throttle.allow(vkb_log_suppressed))                                                        \
+		{                                                                                                      \
+			spdlog::warn(__VA_ARGS__);                                                                         \
+			if (vkb_log_suppressed > 0)                                                                        \
+			{                                                                                                  \
+				spdlog::warn("The warning was dropped {} times since it was last logged", vkb_log_suppressed); \
+			}                                                                                                  \
+		}                                                                                                      \
+	} while (false)
+
 namespace vkb
 {
 namespace logging
 {
-void init();
-}
+/// Number of messages the queue of the logging thread holds, the oldest are dropped once it is full
+constexpr size_t QueueSize = 8192;
+
+/**
+ * @brief Creates the default logger
+ *        Messages are formatted on the calling thread and written to the sinks by a
+ *        background thread, so logging never waits for the console or a file.
+ * @param sinks The sinks the messages are written to, the console if empty
+ */
+void init(const std::vector<spdlog::sink_ptr> &sinks = {});
+
+/**
+ * @brief Adds a sink to the default logger
+ *        The logger is replaced by one writing to the new sink as well, as the sinks of
+ *        a logger can't be changed while the background thread writes to them.
+ */
+void add_sink(spdlog::sink_ptr sink);
+
+/**
+ * @brief Drops the repeats of a message within an interval
+ *        Safe to use from any thread.
+ */
+class Throttle
+{
+  public:
+	static constexpr std::chrono::milliseconds DefaultInterval{5000};
+
+	explicit Throttle(std::chrono::milliseconds interval = DefaultInterval);
+
+	/**
+	 * @brief Tests whether a message can be logged now
+	 * @param suppressed Set to the number of messages dropped since the last one allowed
+	 * @return Whether the message should be logged
+	 */
+	bool allow(uint32_t &suppressed);
+
+  private:
+	int64_t interval;
+
+	/// Time from which the next message is allowed, in nanoseconds of the steady clock
+	std::atomic<int64_t> next_allowed{std::numeric_limits<int64_t>::min()};
+
+	std::atomic<uint32_t> suppressed_count{0};
+};
+}        // namespace logging
 }        // namespace vkb
\ No newline at end of file
@@ -20,7 +20,9 @@
 #include <cstdint>
 #include <cstdio>
 
+#include <atomic>
 #include <unordered_map>
+#include <vector>
 
 #include "core/util/error.hpp"
 
@@ -28,19 +30,151 @@
 #	include <tracy/Tracy.hpp>
 #endif
 
-#ifdef TRACY_ENABLE
-// malloc and free are used by Tracy to provide memory profiling
+// The global operator new and delete are replaced to count the heap allocations, and report them to Tracy
 void *operator new(size_t count);
 void  operator delete(void *ptr) noexcept;
 
+namespace vkb
+{
+/**
+ * @brief Totals of the heap allocations made through the global operator new since the application started
+ *        Allocations with an extended alignment aren't counted.
+ */
+struct HeapAllocationCounters
+{
+	uint64_t allocations{0};
+
+	uint64_t bytes{0};
+};
+
+HeapAllocationCounters get_heap_allocation_counters();
+
+/**
+ * @brief Times the CPU scopes of every thread over the last frames, without an external profiler
+ *
+ * Each thread writes the scopes it closes to a ring of its own, which only the thread ending the
+ * frames reads, so recording a scope never takes a lock. A scope is dropped if the ring of its
+ * thread is full. Recording is disabled by default, a scope then only costs an atomic load.
+ */
+class CpuProfiler
+{
+  public:
+	/// Number of frames kept in the history
+	static constexpr size_t HistorySize = 120;
+
+	/// Capacity of the ring of each thread
+	static constexpr size_t MaxScopesPerThread = 4096;
+
+	struct Scope
+	{
+		/// Name with a static storage duration
+		const char *name;
+
+		/// Index of the thread, in the order the threads recorded their first scope
+		uint32_t thread;
+
+		/// Number of scopes of the same thread enclosing this one
+		uint32_t depth;
+
+		/// Times in nanoseconds, see now()
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	struct Frame
+	{
+		uint64_t begin;
+		uint64_t end;
+
+		/// Scopes closed during the frame, sorted by thread then begin time
+		std::vector<Scope> scopes;
+	};
+
+	/**
+	 * @brief Enables recording, clearing the history if it was disabled
+	 */
+	static void set_enabled(bool enabled);
+
+	static bool is_enabled()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @return Nanoseconds from a monotonic clock
+	 */
+	static uint64_t now();
+
+	/**
+	 * @brief Writes a closed scope to the ring of the calling thread
+	 */
+	static void record(const char *name, uint32_t depth, uint64_t begin, uint64_t end);
+
+	/**
+	 * @brief Moves the scopes closed since the previous call into a new frame of the history
+	 */
+	static void end_frame();
+
+	/**
+	 * @return A copy of the history, from the oldest frame to the latest one
+	 */
+	static std::vector<Frame> get_frames();
+
+  private:
+	static std::atomic<bool> enabled;
+};
+
+/**
+ * @brief Records the time between its construction and destruction to the CpuProfiler
+ */
+class CpuProfileScope
+{
+  public:
+	explicit CpuProfileScope(const char *name);
+
+	CpuProfileScope(const CpuProfileScope &) = delete;
+
+	CpuProfileScope(CpuProfileScope &&) = delete;
+
+	~CpuProfileScope();
+
+	CpuProfileScope &operator=(const CpuProfileScope &) = delete;
+
+	CpuProfileScope &operator=(CpuProfileScope &&) = delete;
+
+  private:
+	const char *name;
+
+	uint64_t begin{0};
+
+	bool active{false};
+};
+}        // namespace vkb
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Time a scope with the CpuProfiler, the name must have a static storage duration
+#define PROFILE_CPU_SCOPE(name) vkb::CpuProfileScope PROFILE_CONCAT(cpu_profile_scope_, __LINE__)(name)
+
+#ifdef TRACY_ENABLE
+
 // Tracy a scope
-#	define PROFILE_SCOPE(name) ZoneScopedN(name)
+#	define PROFILE_SCOPE(name) \
+		ZoneScopedN(name);      \
+		PROFILE_CPU_SCOPE(name)
 
-// Trace a function
+// Trace a function, only with Tracy as functions are too fine grained for the CpuProfiler
 #	define PROFILE_FUNCTION() ZoneScoped
+
+// Mark the end of a frame
+#	define PROFILE_FRAME() \
+		FrameMark;          \
+		vkb::CpuProfiler::end_frame()
 #else
-#	define PROFILE_SCOPE(name)
+#	define PROFILE_SCOPE(name) PROFILE_CPU_SCOPE(name)
 #	define PROFILE_FUNCTION()
+#	define PROFILE_FRAME() vkb::CpuProfiler::end_frame()
 #endif
 
 // The type of plot to use
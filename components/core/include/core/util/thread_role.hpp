@@ -0,0 +1,58 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace vkb
+{
+/**
+ * @brief The kind of work a thread does, which decides the cores and the priority the OS gives it
+ */
+enum class ThreadRole
+{
+	/// Records and submits the frames, or steps the simulation they show
+	Render,
+
+	/// Runs the jobs a frame waits for, such as the recording, the culling and the scene updates
+	Worker,
+
+	/// Loads, decodes and writes files, or samples counters, off the critical path of the frames
+	Background
+};
+
+/**
+ * @brief Hints the scheduler of the OS about the role of the calling thread
+ *
+ * On Linux and Android the cores are split by their capacity, read from /sys/devices/system/cpu. The render and worker
+ * threads are kept on the faster cores of heterogeneous CPUs, so the frames don't land on the efficiency cores, while
+ * the background threads may run on any core at a lower priority. On Apple platforms the roles map to QoS classes, which
+ * also decide the cores, and on Windows to thread priorities. CPUs whose cores are all alike only get the priorities.
+ *
+ * @return Whether a hint was applied, the calling thread keeps running where it was otherwise
+ */
+bool set_current_thread_role(ThreadRole role);
+
+/**
+ * @return The number of hardware threads the render and worker threads are placed on, every one of them unless
+ *         set_current_thread_role() keeps these threads on the faster cores
+ */
+uint32_t get_performance_thread_count();
+
+const char *to_string(ThreadRole role);
+}        // namespace vkb
@@ -0,0 +1,123 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/util/cache_file.hpp"
+
+#include "core/util/hash.hpp"
+
+namespace vkb
+{
+CacheFileWriter::CacheFileWriter(uint32_t magic, uint32_t version) :
+    data(sizeof(CacheFileHeader))
+{
+	CacheFileHeader header{};
+	header.magic   = magic;
+	header.version = version;
+	std::memcpy(data.data(), &header, sizeof(header));
+}
+
+void CacheFileWriter::append(const void *bytes, size_t size)
+{
+	auto begin = reinterpret_cast<const uint8_t *>(bytes);
+	data.insert(data.end(), begin, begin + size);
+}
+
+std::vector<uint8_t> CacheFileWriter::finish()
+{
+	CacheFileHeader header{};
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	header.payload_size = data.size() - sizeof(header);
+	header.checksum     = fnv1a_hash(data.data() + sizeof(header), data.size() - sizeof(header));
+	std::memcpy(data.data(), &header, sizeof(header));
+
+	auto file = std::move(data);
+	data.clear();
+	return file;
+}
+
+CacheFileReader::CacheFileReader(const uint8_t *data, size_t size, uint32_t magic, uint32_t version)
+{
+	CacheFileHeader header{};
+	if (size < sizeof(header))
+	{
+		status = Status::Truncated;
+		return;
+	}
+	std::memcpy(&header, data, sizeof(header));
+
+	if (header.magic != magic || header.version != version)
+	{
+		status = Status::Unsupported;
+		return;
+	}
+
+	payload        = data + sizeof(header);
+	remaining_size = size - sizeof(header);
+
+	if (header.payload_size != remaining_size || fnv1a_hash(payload, remaining_size) != header.checksum)
+	{
+		status         = Status::Corrupted;
+		payload        = nullptr;
+		remaining_size = 0;
+	}
+}
+
+CacheFileReader::Status CacheFileReader::get_status() const
+{
+	return status;
+}
+
+bool CacheFileReader::is_valid() const
+{
+	return status == Status::Valid;
+}
+
+bool CacheFileReader::read(void *data, size_t size)
+{
+	if (size > remaining_size)
+	{
+		return false;
+	}
+
+	std::memcpy(data, payload, size);
+	return skip(size);
+}
+
+bool CacheFileReader::skip(size_t size)
+{
+	if (size > remaining_size)
+	{
+		return false;
+	}
+
+	payload += size;
+	remaining_size -= size;
+
+	return true;
+}
+
+const uint8_t *CacheFileReader::get_data() const
+{
+	return payload;
+}
+
+size_t CacheFileReader::get_remaining_size() const
+{
+	return remaining_size;
+}
+}        // namespace vkb
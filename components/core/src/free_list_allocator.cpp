@@ -0,0 +1,160 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/util/free_list_allocator.hpp"
+
+#include <cassert>
+
+namespace vkb
+{
+FreeListAllocator::FreeListAllocator(uint64_t size, uint64_t alignment) :
+    size{size},
+    alignment{alignment > 0 ? alignment : 1}
+{
+	reset();
+}
+
+uint64_t FreeListAllocator::allocate(uint64_t allocation_size)
+{
+	assert(allocation_size > 0 && "Allocation size must be greater than zero");
+
+	auto range_it = find_free_range(allocation_size);
+	if (range_it == free_ranges_by_size.end())
+	{
+		return InvalidOffset;
+	}
+
+	// Carve the allocation out of the best fitting range, the alignment padding and the tail stay free
+	uint64_t range_size   = range_it->first;
+	uint64_t range_offset = range_it->second;
+	erase_free_range(range_offset, range_size);
+
+	uint64_t aligned = align(range_offset);
+	if (aligned > range_offset)
+	{
+		insert_free_range(range_offset, aligned - range_offset);
+	}
+	if (aligned + allocation_size < range_offset + range_size)
+	{
+		insert_free_range(aligned + allocation_size, range_offset + range_size - aligned - allocation_size);
+	}
+
+	return aligned;
+}
+
+void FreeListAllocator::free(uint64_t range_offset, uint64_t range_size)
+{
+	assert(range_offset + range_size <= size && "Range is out of the allocator");
+
+	// Merge with the following free range
+	auto next_it = free_ranges_by_offset.find(range_offset + range_size);
+	if (next_it != free_ranges_by_offset.end())
+	{
+		range_size += next_it->second;
+		erase_free_range(next_it->first, next_it->second);
+	}
+
+	// Merge with the preceding free range
+	auto prev_it = free_ranges_by_offset.lower_bound(range_offset);
+	if (prev_it != free_ranges_by_offset.begin())
+	{
+		--prev_it;
+		assert(prev_it->first + prev_it->second <= range_offset && "Range is already free");
+		if (prev_it->first + prev_it->second == range_offset)
+		{
+			range_offset = prev_it->first;
+			range_size += prev_it->second;
+			erase_free_range(prev_it->first, prev_it->second);
+		}
+	}
+
+	insert_free_range(range_offset, range_size);
+}
+
+bool FreeListAllocator::can_allocate(uint64_t allocation_size) const
+{
+	return find_free_range(allocation_size) != free_ranges_by_size.end();
+}
+
+void FreeListAllocator::reset()
+{
+	free_size = 0;
+	free_ranges_by_offset.clear();
+	free_ranges_by_size.clear();
+
+	if (size > 0)
+	{
+		insert_free_range(0, size);
+	}
+}
+
+uint64_t FreeListAllocator::get_size() const
+{
+	return size;
+}
+
+uint64_t FreeListAllocator::get_free_size() const
+{
+	return free_size;
+}
+
+size_t FreeListAllocator::get_free_range_count() const
+{
+	return free_ranges_by_offset.size();
+}
+
+uint64_t FreeListAllocator::align(uint64_t value) const
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+std::multimap<uint64_t, uint64_t>::const_iterator FreeListAllocator::find_free_range(uint64_t allocation_size) const
+{
+	// Ranges at least as large as the request, smallest first; only the alignment padding can make one of them unusable
+	for (auto it = free_ranges_by_size.lower_bound(allocation_size); it != free_ranges_by_size.end(); ++it)
+	{
+		if (align(it->second) + allocation_size <= it->second + it->first)
+		{
+			return it;
+		}
+	}
+	return free_ranges_by_size.end();
+}
+
+void FreeListAllocator::insert_free_range(uint64_t range_offset, uint64_t range_size)
+{
+	free_ranges_by_offset.emplace(range_offset, range_size);
+	free_ranges_by_size.emplace(range_size, range_offset);
+	free_size += range_size;
+}
+
+void FreeListAllocator::erase_free_range(uint64_t range_offset, uint64_t range_size)
+{
+	free_ranges_by_offset.erase(range_offset);
+	free_size -= range_size;
+
+	auto range = free_ranges_by_size.equal_range(range_size);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == range_offset)
+		{
+			free_ranges_by_size.erase(it);
+			break;
+		}
+	}
+}
+}        // namespace vkb
@@ -0,0 +1,373 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/util/job_system.hpp"
+
+#include <exception>
+
+#include "core/util/logging.hpp"
+
+namespace vkb
+{
+namespace
+{
+// The system the calling thread is a worker of, and its index in it
+thread_local JobSystem *current_system = nullptr;
+thread_local uint32_t   current_worker = 0;
+
+std::mutex                 shared_system_mutex;
+std::unique_ptr<JobSystem> shared_system;
+std::atomic<JobSystem *>   shared_system_pointer{nullptr};
+std::unique_ptr<JobSystem> background_system;
+std::atomic<JobSystem *>   background_system_pointer{nullptr};
+}        // namespace
+
+uint32_t JobSystem::get_default_worker_count()
+{
+	// The workers and the render thread share the faster cores when they are kept on them
+	auto thread_count = get_performance_thread_count();
+	return thread_count > 1 ? thread_count - 1 : 1;
+}
+
+uint32_t JobSystem::get_default_background_worker_count()
+{
+	return std::max(std::thread::hardware_concurrency() / 4, 1u);
+}
+
+void JobSystem::init(uint32_t worker_count, uint32_t background_worker_count)
+{
+	// The previous systems are joined once the lock is released, the background one first as its jobs may use the other
+	std::unique_ptr<JobSystem> previous;
+	std::unique_ptr<JobSystem> previous_background;
+	{
+		std::lock_guard<std::mutex> guard(shared_system_mutex);
+		previous      = std::move(shared_system);
+		shared_system = std::make_unique<JobSystem>(worker_count);
+		shared_system_pointer.store(shared_system.get(), std::memory_order_release);
+
+		previous_background = std::move(background_system);
+		background_system   = std::make_unique<JobSystem>(background_worker_count, ThreadRole::Background);
+		background_system_pointer.store(background_system.get(), std::memory_order_release);
+	}
+
+	LOGI("Job system started with {} workers and {} background workers", worker_count, background_worker_count);
+}
+
+void JobSystem::terminate()
+{
+	std::unique_ptr<JobSystem> previous_background;
+	std::unique_ptr<JobSystem> previous;
+	{
+		std::lock_guard<std::mutex> guard(shared_system_mutex);
+		background_system_pointer.store(nullptr, std::memory_order_release);
+		previous_background = std::move(background_system);
+		shared_system_pointer.store(nullptr, std::memory_order_release);
+		previous = std::move(shared_system);
+	}
+
+	// Joined outside of the lock, the remaining jobs may use the shared systems
+	previous_background.reset();
+	previous.reset();
+}
+
+JobSystem &JobSystem::get()
+{
+	if (auto system = shared_system_pointer.load(std::memory_order_acquire))
+	{
+		return *system;
+	}
+
+	std::lock_guard<std::mutex> guard(shared_system_mutex);
+	if (!shared_system)
+	{
+		shared_system = std::make_unique<JobSystem>();
+		shared_system_pointer.store(shared_system.get(), std::memory_order_release);
+	}
+	return *shared_system;
+}
+
+JobSystem &JobSystem::get_background()
+{
+	if (auto system = background_system_pointer.load(std::memory_order_acquire))
+	{
+		return *system;
+	}
+
+	std::lock_guard<std::mutex> guard(shared_system_mutex);
+	if (!background_system)
+	{
+		background_system = std::make_unique<JobSystem>(get_default_background_worker_count(), ThreadRole::Background);
+		background_system_pointer.store(background_system.get(), std::memory_order_release);
+	}
+	return *background_system;
+}
+
+JobSystem::JobSystem(uint32_t worker_count, ThreadRole role) :
+    role{role}
+{
+	worker_count = std::max(worker_count, 1u);
+
+	workers.reserve(worker_count);
+	for (uint32_t i = 0; i < worker_count; ++i)
+	{
+		workers.push_back(std::make_unique<Worker>());
+	}
+
+	// Started once every deque exists, as the workers steal from each other
+	for (uint32_t i = 0; i < worker_count; ++i)
+	{
+		workers[i]->thread = std::thread([this, i]() { worker_loop(i); });
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> guard(sleep_mutex);
+		stopping = true;
+	}
+	sleep_condition.notify_all();
+
+	for (auto &worker : workers)
+	{
+		worker->thread.join();
+	}
+}
+
+uint32_t JobSystem::get_worker_count() const
+{
+	return static_cast<uint32_t>(workers.size());
+}
+
+ThreadRole JobSystem::get_role() const
+{
+	return role;
+}
+
+void JobSystem::schedule(Job job, JobCounter *counter)
+{
+	if (counter)
+	{
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	push({std::move(job), counter});
+}
+
+void JobSystem::schedule_after(JobCounter &dependency, Job job, JobCounter *counter)
+{
+	if (counter)
+	{
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(dependency.mutex);
+		if (dependency.pending.load(std::memory_order_acquire) > 0)
+		{
+			dependency.continuations.emplace_back(std::move(job), counter);
+			return;
+		}
+	}
+
+	push({std::move(job), counter});
+}
+
+void JobSystem::wait(JobCounter &counter)
+{
+	while (!counter.is_done())
+	{
+		Task task;
+		if (pop(task))
+		{
+			run(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleep_condition.wait(lock, [this, &counter]() {
+			return counter.is_done() || queued.load(std::memory_order_acquire) > 0;
+		});
+	}
+
+	// The last job may still hold the mutex of the counter, which the caller may destroy once this returns
+	std::exception_ptr exception;
+	{
+		std::lock_guard<std::mutex> guard(counter.mutex);
+		exception.swap(counter.exception);
+	}
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+void JobSystem::push(Task &&task)
+{
+	uint32_t index = current_system == this ? current_worker : next_worker.fetch_add(1, std::memory_order_relaxed) % get_worker_count();
+
+	{
+		auto &worker = *workers[index];
+
+		std::lock_guard<std::mutex> guard(worker.mutex);
+		worker.tasks.push_back(std::move(task));
+	}
+
+	queued.fetch_add(1, std::memory_order_release);
+
+	// Taking the lock orders the push with a thread checking for tasks before it sleeps
+	{
+		std::lock_guard<std::mutex> guard(sleep_mutex);
+	}
+	sleep_condition.notify_one();
+}
+
+bool JobSystem::pop(Task &task)
+{
+	if (queued.load(std::memory_order_acquire) == 0)
+	{
+		return false;
+	}
+
+	uint32_t worker_count = get_worker_count();
+	uint32_t first        = current_system == this ? current_worker : 0;
+
+	// The own deque is popped from the back, where the latest tasks are still in the cache
+	if (current_system == this)
+	{
+		auto &worker = *workers[first];
+
+		std::lock_guard<std::mutex> guard(worker.mutex);
+		if (!worker.tasks.empty())
+		{
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+			queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// The others are stolen from the front, where the oldest and usually largest tasks are
+	for (uint32_t offset = current_system == this ? 1 : 0; offset < worker_count; ++offset)
+	{
+		auto &worker = *workers[(first + offset) % worker_count];
+
+		std::lock_guard<std::mutex> guard(worker.mutex);
+		if (!worker.tasks.empty())
+		{
+			task = std::move(worker.tasks.front());
+			worker.tasks.pop_front();
+			queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::run(Task &task)
+{
+	std::exception_ptr exception;
+	try
+	{
+		task.job();
+	}
+	catch (const std::exception &e)
+	{
+		if (!task.counter)
+		{
+			LOGE("Job failed: {}", e.what());
+		}
+		exception = std::current_exception();
+	}
+	catch (...)
+	{
+		if (!task.counter)
+		{
+			LOGE("Job failed with an unknown exception");
+		}
+		exception = std::current_exception();
+	}
+
+	// Released before the counter is decremented, as the job may refer to what the counter guards
+	task.job = nullptr;
+
+	auto counter = task.counter;
+	if (!counter)
+	{
+		return;
+	}
+
+	std::vector<std::pair<Job, JobCounter *>> continuations;
+	{
+		std::lock_guard<std::mutex> guard(counter->mutex);
+		if (exception && !counter->exception)
+		{
+			counter->exception = std::move(exception);
+		}
+
+		if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			continuations.swap(counter->continuations);
+		}
+		else
+		{
+			return;
+		}
+	}
+
+	for (auto &continuation : continuations)
+	{
+		push({std::move(continuation.first), continuation.second});
+	}
+
+	// Wakes the threads waiting for the counter
+	{
+		std::lock_guard<std::mutex> guard(sleep_mutex);
+	}
+	sleep_condition.notify_all();
+}
+
+void JobSystem::worker_loop(uint32_t index)
+{
+	current_system = this;
+	current_worker = index;
+
+	set_current_thread_role(role);
+
+	while (true)
+	{
+		Task task;
+		if (pop(task))
+		{
+			run(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleep_condition.wait(lock, [this]() {
+			return stopping || queued.load(std::memory_order_acquire) > 0;
+		});
+
+		if (stopping && queued.load(std::memory_order_acquire) == 0)
+		{
+			return;
+		}
+	}
+}
+}        // namespace vkb
@@ -17,6 +17,7 @@
 
 #include "core/util/logging.hpp"
 
+#include "spdlog/async.h"
 #include "spdlog/cfg/env.h"
 
 #ifdef PLATFORM__ANDROID
@@ -29,7 +30,24 @@ namespace vkb
 {
 namespace logging
 {
-void init()
+namespace
+{
+// All the loggers share the name "vkb", set_default_logger() replaces the previous one in the registry
+std::shared_ptr<spdlog::logger> create_logger(const std::vector<spdlog::sink_ptr> &sinks, spdlog::level::level_enum level)
+{
+	// Never block the caller when the queue is full, dropping the oldest messages instead
+	auto logger = std::make_shared<spdlog::async_logger>("vkb", sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+
+	logger->set_pattern(LOGGER_FORMAT);
+	logger->set_level(level);
+
+	// Flushing an async logger only queues a request, errors still reach the sinks promptly
+	logger->flush_on(spdlog::level::err);
+	return logger;
+}
+}        // namespace
+
+void init(const std::vector<spdlog::sink_ptr> &sinks)
 {
 	// Taken from "spdlog/cfg/env.h" and renamed SPDLOG_LEVEL to VKB_LOG_LEVEL
 	auto env_val = spdlog::details::os::getenv("VKB_LOG_LEVEL");
@@ -38,15 +56,56 @@ void init()
 		spdlog::cfg::helpers::load_levels(env_val);
 	}
 
+	// Loggers of a previous initialization keep writing to the pool while their messages are queued
+	if (!spdlog::thread_pool())
+	{
+		spdlog::init_thread_pool(QueueSize, 1);
+	}
+
+	if (sinks.empty())
+	{
 #ifdef PLATFORM__ANDROID
-	auto logger = spdlog::android_logger_mt("vkb", "VulkanSamples");
+		spdlog::set_default_logger(create_logger({std::make_shared<spdlog::sinks::android_sink_mt>(PROJECT_NAME)}, spdlog::level::trace));
 #else
-	auto logger = spdlog::stdout_color_mt("vkb");
+		spdlog::set_default_logger(create_logger({std::make_shared<spdlog::sinks::stdout_color_sink_mt>()}, spdlog::level::trace));
 #endif
+	}
+	else
+	{
+		spdlog::set_default_logger(create_logger(sinks, spdlog::level::trace));
+	}
+}
 
-	logger->set_pattern(LOGGER_FORMAT);
-	logger->set_level(spdlog::level::trace);
-	spdlog::set_default_logger(logger);
+void add_sink(spdlog::sink_ptr sink)
+{
+	auto previous = spdlog::default_logger();
+
+	auto sinks = previous->sinks();
+	sinks.push_back(sink);
+
+	// The messages queued by the previous logger keep it alive until they are written
+	spdlog::set_default_logger(create_logger(sinks, previous->level()));
+}
+
+Throttle::Throttle(std::chrono::milliseconds interval) :
+    interval{std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()}
+{
+}
+
+bool Throttle::allow(uint32_t &suppressed)
+{
+	int64_t now  = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64_t next = next_allowed.load(std::memory_order_relaxed);
+
+	// Only one of the threads racing past the end of the interval logs
+	if (now < next || !next_allowed.compare_exchange_strong(next, now + interval, std::memory_order_relaxed))
+	{
+		suppressed_count.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	suppressed = suppressed_count.exchange(0, std::memory_order_relaxed);
+	return true;
 }
 }        // namespace logging
 }        // namespace vkb
\ No newline at end of file
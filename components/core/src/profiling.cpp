@@ -17,19 +17,235 @@
 
 #include "core/util/profiling.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+
+namespace
+{
+// Constant-initialized, so they can be used by the allocations of static constructors
+std::atomic<uint64_t> heap_allocations{0};
+std::atomic<uint64_t> heap_allocation_bytes{0};
+}        // namespace
 
-#ifdef TRACY_ENABLE
 void *operator new(size_t count)
 {
-	auto ptr = malloc(count);
+	// malloc may return nullptr for zero bytes, operator new must not
+	auto ptr = malloc(count == 0 ? 1 : count);
+	if (!ptr)
+	{
+		throw std::bad_alloc{};
+	}
+
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	heap_allocation_bytes.fetch_add(count, std::memory_order_relaxed);
+
+#ifdef TRACY_ENABLE
 	TracyAlloc(ptr, count);
+#endif
 	return ptr;
 }
 
 void operator delete(void *ptr) noexcept
 {
+#ifdef TRACY_ENABLE
 	TracyFree(ptr);
+#endif
 	free(ptr);
 }
-#endif
+
+namespace vkb
+{
+HeapAllocationCounters get_heap_allocation_counters()
+{
+	HeapAllocationCounters counters;
+	counters.allocations = heap_allocations.load(std::memory_order_relaxed);
+	counters.bytes       = heap_allocation_bytes.load(std::memory_order_relaxed);
+	return counters;
+}
+
+namespace
+{
+/**
+ * @brief Single producer single consumer ring of the scopes of one thread
+ */
+struct ScopeRing
+{
+	uint32_t thread{0};
+
+	std::array<CpuProfiler::Scope, CpuProfiler::MaxScopesPerThread> scopes;
+
+	/// Written by the thread owning the ring
+	std::atomic<size_t> write_index{0};
+
+	/// Written by the thread ending the frames
+	std::atomic<size_t> read_index{0};
+
+	void push(const CpuProfiler::Scope &scope)
+	{
+		auto write = write_index.load(std::memory_order_relaxed);
+		if (write - read_index.load(std::memory_order_acquire) >= scopes.size())
+		{
+			return;
+		}
+
+		scopes[write % scopes.size()] = scope;
+		write_index.store(write + 1, std::memory_order_release);
+	}
+
+	template <typename Function>
+	void pop_all(Function &&function)
+	{
+		auto read  = read_index.load(std::memory_order_relaxed);
+		auto write = write_index.load(std::memory_order_acquire);
+		for (; read != write; ++read)
+		{
+			function(scopes[read % scopes.size()]);
+		}
+		read_index.store(read, std::memory_order_release);
+	}
+};
+
+struct CpuProfilerState
+{
+	/// Guards the list of rings, the history and the consumer side of the rings
+	std::mutex mutex;
+
+	/// Rings are never released, a thread may still write to its ring after it is drained
+	std::vector<std::unique_ptr<ScopeRing>> rings;
+
+	std::deque<CpuProfiler::Frame> history;
+
+	uint64_t frame_begin{0};
+};
+
+CpuProfilerState &get_cpu_profiler_state()
+{
+	static CpuProfilerState state;
+	return state;
+}
+
+thread_local ScopeRing *thread_ring{nullptr};
+
+thread_local uint32_t thread_depth{0};
+
+ScopeRing &get_thread_ring()
+{
+	if (!thread_ring)
+	{
+		auto &state = get_cpu_profiler_state();
+
+		std::lock_guard<std::mutex> guard(state.mutex);
+
+		auto ring    = std::make_unique<ScopeRing>();
+		ring->thread = static_cast<uint32_t>(state.rings.size());
+		thread_ring  = ring.get();
+		state.rings.push_back(std::move(ring));
+	}
+	return *thread_ring;
+}
+}        // namespace
+
+std::atomic<bool> CpuProfiler::enabled{false};
+
+void CpuProfiler::set_enabled(bool enable)
+{
+	if (enabled.exchange(enable) || !enable)
+	{
+		return;
+	}
+
+	// Drop what was recorded before the profiler was last disabled
+	auto &state = get_cpu_profiler_state();
+
+	std::lock_guard<std::mutex> guard(state.mutex);
+
+	for (auto &ring : state.rings)
+	{
+		ring->pop_all([](const Scope &) {});
+	}
+	state.history.clear();
+	state.frame_begin = now();
+}
+
+uint64_t CpuProfiler::now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void CpuProfiler::record(const char *name, uint32_t depth, uint64_t begin, uint64_t end)
+{
+	auto &ring = get_thread_ring();
+	ring.push({name, ring.thread, depth, begin, end});
+}
+
+void CpuProfiler::end_frame()
+{
+	if (!is_enabled())
+	{
+		return;
+	}
+
+	auto &state = get_cpu_profiler_state();
+
+	Frame frame;
+	frame.end = now();
+
+	std::lock_guard<std::mutex> guard(state.mutex);
+
+	frame.begin = state.frame_begin;
+	for (auto &ring : state.rings)
+	{
+		ring->pop_all([&frame](const Scope &scope) { frame.scopes.push_back(scope); });
+	}
+
+	// Threads close their scopes from the innermost one, so enclosing scopes are put back before them
+	std::sort(frame.scopes.begin(), frame.scopes.end(), [](const Scope &a, const Scope &b) {
+		return std::tie(a.thread, a.begin, a.depth) < std::tie(b.thread, b.begin, b.depth);
+	});
+
+	state.history.push_back(std::move(frame));
+	while (state.history.size() > HistorySize)
+	{
+		state.history.pop_front();
+	}
+
+	state.frame_begin = state.history.back().end;
+}
+
+std::vector<CpuProfiler::Frame> CpuProfiler::get_frames()
+{
+	auto &state = get_cpu_profiler_state();
+
+	std::lock_guard<std::mutex> guard(state.mutex);
+
+	return {state.history.begin(), state.history.end()};
+}
+
+CpuProfileScope::CpuProfileScope(const char *name) :
+    name{name}
+{
+	if (CpuProfiler::is_enabled())
+	{
+		active = true;
+		begin  = CpuProfiler::now();
+		++thread_depth;
+	}
+}
+
+CpuProfileScope::~CpuProfileScope()
+{
+	if (active)
+	{
+		--thread_depth;
+		CpuProfiler::record(name, thread_depth, begin, CpuProfiler::now());
+	}
+}
+}        // namespace vkb
@@ -0,0 +1,189 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/util/thread_role.hpp"
+
+#include <thread>
+
+#if defined(_WIN32)
+#	include <windows.h>
+#elif defined(__APPLE__)
+#	include <pthread/qos.h>
+#elif defined(__linux__)
+#	include <sched.h>
+#	include <sys/resource.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+
+#	include <algorithm>
+#	include <cstdint>
+#	include <fstream>
+#	include <string>
+#	include <vector>
+#endif
+
+namespace vkb
+{
+namespace
+{
+#if defined(__linux__)
+/// Nice value of the background threads, above the default of zero
+constexpr int BackgroundNice = 10;
+
+/**
+ * @brief The cores of the CPU, split by capacity
+ */
+struct CoreSets
+{
+	cpu_set_t performance;
+
+	cpu_set_t all;
+
+	/// Whether the cores have different capacities, only then are the threads placed
+	bool heterogeneous{false};
+};
+
+CoreSets read_core_sets()
+{
+	CoreSets sets{};
+	CPU_ZERO(&sets.performance);
+	CPU_ZERO(&sets.all);
+
+	// The capacity of the fastest core is 1024, the others are scaled to their performance
+	std::vector<std::pair<int, uint32_t>> capacities;
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+	{
+		std::ifstream file{"/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpu_capacity"};
+		uint32_t      capacity = 0;
+		if (!(file >> capacity))
+		{
+			break;
+		}
+		capacities.emplace_back(cpu, capacity);
+	}
+
+	if (capacities.empty())
+	{
+		return sets;
+	}
+
+	auto [min, max] = std::minmax_element(capacities.begin(), capacities.end(), [](const auto &lhs, const auto &rhs) { return lhs.second < rhs.second; });
+	if (min->second == max->second)
+	{
+		return sets;
+	}
+
+	// The cores above the middle, e.g. the big and mid cores of a three cluster CPU
+	uint32_t threshold = (min->second + max->second) / 2;
+	for (auto &[cpu, capacity] : capacities)
+	{
+		CPU_SET(cpu, &sets.all);
+		if (capacity > threshold)
+		{
+			CPU_SET(cpu, &sets.performance);
+		}
+	}
+	sets.heterogeneous = true;
+
+	return sets;
+}
+
+const CoreSets &get_core_sets()
+{
+	static const CoreSets sets = read_core_sets();
+	return sets;
+}
+#endif
+}        // namespace
+
+bool set_current_thread_role(ThreadRole role)
+{
+#if defined(_WIN32)
+	int priority = THREAD_PRIORITY_NORMAL;
+	switch (role)
+	{
+		case ThreadRole::Render:
+			priority = THREAD_PRIORITY_ABOVE_NORMAL;
+			break;
+		case ThreadRole::Worker:
+			priority = THREAD_PRIORITY_NORMAL;
+			break;
+		case ThreadRole::Background:
+			priority = THREAD_PRIORITY_BELOW_NORMAL;
+			break;
+	}
+	return SetThreadPriority(GetCurrentThread(), priority) != 0;
+#elif defined(__APPLE__)
+	qos_class_t qos_class = QOS_CLASS_DEFAULT;
+	switch (role)
+	{
+		case ThreadRole::Render:
+			qos_class = QOS_CLASS_USER_INTERACTIVE;
+			break;
+		case ThreadRole::Worker:
+			qos_class = QOS_CLASS_USER_INITIATED;
+			break;
+		case ThreadRole::Background:
+			qos_class = QOS_CLASS_UTILITY;
+			break;
+	}
+	return pthread_set_qos_class_self_np(qos_class, 0) == 0;
+#elif defined(__linux__)
+	// The priority of a thread is its own on Linux, even though setpriority() is about processes
+	bool applied = setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), role == ThreadRole::Background ? BackgroundNice : 0) == 0;
+
+	auto &sets = get_core_sets();
+	if (sets.heterogeneous)
+	{
+		// The threads inherit the affinity of the thread starting them, so the background ones get every core back
+		auto &cores = role == ThreadRole::Background ? sets.all : sets.performance;
+		applied     = sched_setaffinity(0, sizeof(cpu_set_t), &cores) == 0 && applied;
+	}
+
+	return applied;
+#else
+	(void) role;
+	return false;
+#endif
+}
+
+uint32_t get_performance_thread_count()
+{
+#if defined(__linux__)
+	auto &sets = get_core_sets();
+	if (sets.heterogeneous)
+	{
+		return static_cast<uint32_t>(CPU_COUNT(&sets.performance));
+	}
+#endif
+	return std::thread::hardware_concurrency();
+}
+
+const char *to_string(ThreadRole role)
+{
+	switch (role)
+	{
+		case ThreadRole::Render:
+			return "Render";
+		case ThreadRole::Worker:
+			return "Worker";
+		case ThreadRole::Background:
+			return "Background";
+	}
+	return "Unknown";
+}
+}        // namespace vkb
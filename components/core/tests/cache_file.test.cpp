@@ -0,0 +1,109 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <core/util/error.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <core/util/cache_file.hpp>
+#include <core/util/hash.hpp>
+
+#include <string>
+
+using namespace vkb;
+
+namespace
+{
+constexpr uint32_t TestMagic   = 0x54534554;        // "TEST"
+constexpr uint32_t TestVersion = 3;
+
+std::vector<uint8_t> write_test_file()
+{
+	CacheFileWriter writer{TestMagic, TestVersion};
+	writer.append(uint64_t{42});
+	writer.append("payload", 7);
+	return writer.finish();
+}
+}        // namespace
+
+TEST_CASE("vkb::fnv1a_hash matches the reference values", "[common]")
+{
+	const std::string text = "foobar";
+
+	REQUIRE(fnv1a_hash(nullptr, 0) == fnv1a_offset_basis);
+	REQUIRE(fnv1a_hash(reinterpret_cast<const uint8_t *>(text.data()), text.size()) == 0x85944171f73967e8ull);
+
+	// Hashing several ranges as one
+	auto hash = fnv1a_hash(reinterpret_cast<const uint8_t *>(text.data()), 3);
+	REQUIRE(fnv1a_hash(reinterpret_cast<const uint8_t *>(text.data()) + 3, 3, hash) == 0x85944171f73967e8ull);
+}
+
+TEST_CASE("vkb::CacheFileReader reads the payload in the order it was written", "[common]")
+{
+	auto file = write_test_file();
+	REQUIRE(file.size() == sizeof(CacheFileHeader) + sizeof(uint64_t) + 7);
+
+	CacheFileReader reader{file.data(), file.size(), TestMagic, TestVersion};
+	REQUIRE(reader.is_valid());
+	REQUIRE(reader.get_remaining_size() == sizeof(uint64_t) + 7);
+
+	uint64_t value{0};
+	REQUIRE(reader.read(value));
+	REQUIRE(value == 42);
+
+	REQUIRE(std::string{reinterpret_cast<const char *>(reader.get_data()), reader.get_remaining_size()} == "payload");
+	REQUIRE(reader.skip(7));
+	REQUIRE(reader.get_remaining_size() == 0);
+
+	REQUIRE_FALSE(reader.read(value));
+	REQUIRE_FALSE(reader.skip(1));
+}
+
+TEST_CASE("vkb::CacheFileReader rejects invalid files", "[common]")
+{
+	auto file = write_test_file();
+
+	SECTION("Truncated")
+	{
+		CacheFileReader reader{file.data(), sizeof(CacheFileHeader) - 1, TestMagic, TestVersion};
+		REQUIRE(reader.get_status() == CacheFileReader::Status::Truncated);
+	}
+
+	SECTION("Unsupported")
+	{
+		CacheFileReader other_magic{file.data(), file.size(), TestMagic + 1, TestVersion};
+		REQUIRE(other_magic.get_status() == CacheFileReader::Status::Unsupported);
+
+		CacheFileReader other_version{file.data(), file.size(), TestMagic, TestVersion + 1};
+		REQUIRE(other_version.get_status() == CacheFileReader::Status::Unsupported);
+	}
+
+	SECTION("Corrupted")
+	{
+		CacheFileReader shorter{file.data(), file.size() - 1, TestMagic, TestVersion};
+		REQUIRE(shorter.get_status() == CacheFileReader::Status::Corrupted);
+
+		file.back() ^= 1;
+		CacheFileReader modified{file.data(), file.size(), TestMagic, TestVersion};
+		REQUIRE(modified.get_status() == CacheFileReader::Status::Corrupted);
+
+		// Nothing of an invalid payload can be read
+		uint64_t value{0};
+		REQUIRE_FALSE(modified.read(value));
+		REQUIRE(modified.get_remaining_size() == 0);
+	}
+}
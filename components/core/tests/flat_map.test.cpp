@@ -0,0 +1,96 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <core/util/error.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <core/util/flat_map.hpp>
+
+#include <string>
+
+using namespace vkb;
+
+TEST_CASE("vkb::FlatMap keeps its elements sorted by key", "[common]")
+{
+	FlatMap<uint32_t, std::string> map;
+
+	map[3] = "three";
+	map[1] = "one";
+	map[2] = "two";
+	map[1] = "uno";
+
+	REQUIRE(map.size() == 3);
+
+	std::vector<uint32_t> keys;
+	for (auto &[key, value] : map)
+	{
+		keys.push_back(key);
+	}
+	REQUIRE(keys == std::vector<uint32_t>{1, 2, 3});
+	REQUIRE(map.at(1) == "uno");
+}
+
+TEST_CASE("vkb::FlatMap lookups", "[common]")
+{
+	const FlatMap<uint32_t, int> map{{4, 40}, {0, 0}, {2, 20}, {4, 41}};
+
+	REQUIRE(map.size() == 3);
+	REQUIRE(map.count(2) == 1);
+	REQUIRE(map.count(3) == 0);
+	REQUIRE(map.find(4)->second == 40);
+	REQUIRE(map.find(5) == map.end());
+	REQUIRE_THROWS_AS(map.at(1), std::out_of_range);
+}
+
+TEST_CASE("vkb::FlatMap insertion and erasure", "[common]")
+{
+	FlatMap<uint32_t, int> map;
+
+	REQUIRE(map.insert({1, 10}).second);
+	REQUIRE_FALSE(map.insert({1, 11}).second);
+	REQUIRE(map.try_emplace(0, 5).second);
+	REQUIRE(map.begin()->first == 0);
+
+	REQUIRE(map.erase(1) == 1);
+	REQUIRE(map.erase(1) == 0);
+	REQUIRE(map == FlatMap<uint32_t, int>{{0, 5}});
+}
+
+TEST_CASE("vkb::FlatMap nested like descriptor bindings", "[common]")
+{
+	FlatMap<uint32_t, FlatMap<uint32_t, int>> bindings;
+
+	bindings[1][2] = 12;
+	bindings[0][0] = 0;
+	bindings[1][0] = 10;
+
+	std::vector<int> values;
+	for (auto &binding : bindings)
+	{
+		for (auto &element : binding.second)
+		{
+			values.push_back(element.second);
+		}
+	}
+	REQUIRE(values == std::vector<int>{0, 10, 12});
+
+	auto copy = bindings;
+	REQUIRE(copy == bindings);
+	copy[1][2] = 13;
+	REQUIRE(copy != bindings);
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <core/util/error.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <core/util/free_list_allocator.hpp>
+
+using namespace vkb;
+
+TEST_CASE("vkb::FreeListAllocator allocates aligned ranges", "[common]")
+{
+	FreeListAllocator allocator{1024, 64};
+
+	REQUIRE(allocator.get_free_size() == 1024);
+	REQUIRE(allocator.get_free_range_count() == 1);
+
+	auto first  = allocator.allocate(100);
+	auto second = allocator.allocate(100);
+
+	REQUIRE(first == 0);
+	REQUIRE(second == 128);
+
+	// The padding between the allocations stays free
+	REQUIRE(allocator.get_free_size() == 1024 - 200);
+	REQUIRE(allocator.get_free_range_count() == 2);
+
+	REQUIRE_FALSE(allocator.can_allocate(1024));
+	REQUIRE(allocator.allocate(1024) == FreeListAllocator::InvalidOffset);
+}
+
+TEST_CASE("vkb::FreeListAllocator picks the smallest fitting range", "[common]")
+{
+	FreeListAllocator allocator{1024, 16};
+
+	auto a = allocator.allocate(256);
+	auto b = allocator.allocate(16);
+	auto c = allocator.allocate(64);
+	auto d = allocator.allocate(16);
+	REQUIRE(allocator.allocate(1024 - 352) == 352);
+
+	allocator.free(a, 256);
+	allocator.free(c, 64);
+
+	// Fits both holes, the smaller one is used
+	REQUIRE(allocator.allocate(48) == c);
+
+	allocator.free(b, 16);
+	allocator.free(d, 16);
+}
+
+TEST_CASE("vkb::FreeListAllocator coalesces freed ranges", "[common]")
+{
+	FreeListAllocator allocator{1024};
+
+	auto a = allocator.allocate(256);
+	auto b = allocator.allocate(256);
+	auto c = allocator.allocate(256);
+	auto d = allocator.allocate(256);
+	REQUIRE(allocator.get_free_size() == 0);
+	REQUIRE_FALSE(allocator.can_allocate(1));
+
+	// Merged with the following range, then with the preceding one
+	allocator.free(c, 256);
+	allocator.free(b, 256);
+	REQUIRE(allocator.get_free_range_count() == 1);
+	REQUIRE(allocator.allocate(512) == b);
+
+	allocator.free(a, 256);
+	allocator.free(d, 256);
+	allocator.free(b, 512);
+	REQUIRE(allocator.get_free_range_count() == 1);
+	REQUIRE(allocator.get_free_size() == 1024);
+
+	allocator.allocate(128);
+	allocator.reset();
+	REQUIRE(allocator.get_free_size() == 1024);
+	REQUIRE(allocator.allocate(1024) == 0);
+}
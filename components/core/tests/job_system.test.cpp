@@ -0,0 +1,194 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <core/util/job_system.hpp>
+
+using namespace vkb;
+
+TEST_CASE("vkb::JobSystem runs the jobs of a counter", "[common]")
+{
+	JobSystem jobs{3};
+
+	std::atomic<uint32_t> sum{0};
+	JobCounter            counter;
+	for (uint32_t i = 1; i <= 100; ++i)
+	{
+		jobs.schedule([&sum, i]() { sum += i; }, &counter);
+	}
+
+	jobs.wait(counter);
+
+	REQUIRE(counter.is_done());
+	REQUIRE(sum == 5050);
+}
+
+TEST_CASE("vkb::JobSystem rethrows the exception of a job from wait", "[common]")
+{
+	JobSystem jobs{2};
+
+	std::atomic<uint32_t> count{0};
+	JobCounter            counter;
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		jobs.schedule(
+		    [&count, i]() {
+			    ++count;
+			    if (i % 2 == 0)
+			    {
+				    throw std::runtime_error("failed");
+			    }
+		    },
+		    &counter);
+	}
+
+	// The other jobs still run
+	REQUIRE_THROWS_AS(jobs.wait(counter), std::runtime_error);
+	REQUIRE(counter.is_done());
+	REQUIRE(count == 8);
+
+	// Rethrown once
+	REQUIRE_NOTHROW(jobs.wait(counter));
+}
+
+TEST_CASE("vkb::JobSystem waits for nested jobs", "[common]")
+{
+	// A single worker has to run the nested jobs while its job waits for them
+	JobSystem jobs{1};
+
+	std::atomic<uint32_t> count{0};
+	JobCounter            outer;
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		jobs.schedule(
+		    [&jobs, &count]() {
+			    JobCounter inner;
+			    for (uint32_t j = 0; j < 8; ++j)
+			    {
+				    jobs.schedule([&count]() { ++count; }, &inner);
+			    }
+			    jobs.wait(inner);
+		    },
+		    &outer);
+	}
+
+	jobs.wait(outer);
+
+	REQUIRE(count == 32);
+}
+
+TEST_CASE("vkb::JobSystem::schedule_after", "[common]")
+{
+	JobSystem jobs{2};
+
+	std::atomic<uint32_t> produced{0};
+	uint32_t              consumed{0};
+
+	JobCounter producers;
+	JobCounter consumer;
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		jobs.schedule([&produced]() { ++produced; }, &producers);
+	}
+	jobs.schedule_after(producers, [&produced, &consumed]() { consumed = produced.load(); }, &consumer);
+
+	jobs.wait(consumer);
+	REQUIRE(consumed == 16);
+
+	// Queued right away once the dependency is done
+	JobCounter late;
+	jobs.schedule_after(producers, [&consumed]() { consumed = 0; }, &late);
+	jobs.wait(late);
+	REQUIRE(consumed == 0);
+}
+
+TEST_CASE("vkb::JobSystem::async", "[common]")
+{
+	JobSystem jobs{2};
+
+	auto value = jobs.async([]() { return 42; });
+	REQUIRE(value.get() == 42);
+
+	auto error = jobs.async([]() -> int { throw std::runtime_error("failed"); });
+	REQUIRE_THROWS_AS(error.get(), std::runtime_error);
+
+	// The nested future is queued behind its job on a single worker
+	JobSystem single{1};
+
+	auto outer = [&single]() {
+		auto inner = single.async([]() { return 1; });
+		single.wait_for_future(inner);
+		return inner.get() + 1;
+	};
+
+	auto nested = single.async(outer);
+	REQUIRE(nested.get() == 2);
+}
+
+TEST_CASE("vkb::JobSystem::parallel_for", "[common]")
+{
+	JobSystem jobs{3};
+
+	std::vector<uint32_t> values(10000, 0);
+	jobs.parallel_for(values.size(), 64, [&values](size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i)
+		{
+			values[i] += static_cast<uint32_t>(i);
+		}
+	});
+
+	std::vector<uint32_t> expected(values.size());
+	std::iota(expected.begin(), expected.end(), 0);
+	REQUIRE(values == expected);
+
+	// Fewer items than a range run on the caller only
+	size_t calls = 0;
+	jobs.parallel_for(10, 64, [&calls](size_t first, size_t last) {
+		REQUIRE(first == 0);
+		REQUIRE(last == 10);
+		++calls;
+	});
+	REQUIRE(calls == 1);
+}
+
+TEST_CASE("vkb::JobSystem with background workers", "[common]")
+{
+	JobSystem jobs{2};
+	JobSystem background{1, ThreadRole::Background};
+
+	REQUIRE(jobs.get_role() == ThreadRole::Worker);
+	REQUIRE(background.get_role() == ThreadRole::Background);
+
+	// A background job splitting its work over the other system, like a loader decoding its images
+	auto sum = background.async([&jobs]() {
+		std::atomic<uint64_t> total{0};
+		jobs.parallel_for(1000, 10, [&total](size_t first, size_t last) {
+			for (size_t i = first; i < last; ++i)
+			{
+				total += i;
+			}
+		});
+		return total.load();
+	});
+
+	REQUIRE(sum.get() == 499500);
+}
@@ -0,0 +1,51 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <core/util/logging.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+
+using namespace vkb;
+
+TEST_CASE("vkb::logging::Throttle drops repeats within the interval", "[common]")
+{
+	logging::Throttle throttle{std::chrono::hours(1)};
+
+	uint32_t suppressed = 0;
+	REQUIRE(throttle.allow(suppressed));
+	REQUIRE(suppressed == 0);
+
+	REQUIRE_FALSE(throttle.allow(suppressed));
+	REQUIRE_FALSE(throttle.allow(suppressed));
+}
+
+TEST_CASE("vkb::logging::Throttle reports the dropped repeats", "[common]")
+{
+	logging::Throttle throttle{std::chrono::milliseconds(10)};
+
+	uint32_t suppressed = 0;
+	REQUIRE(throttle.allow(suppressed));
+	REQUIRE_FALSE(throttle.allow(suppressed));
+	REQUIRE_FALSE(throttle.allow(suppressed));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	REQUIRE(throttle.allow(suppressed));
+	REQUIRE(suppressed == 2);
+}
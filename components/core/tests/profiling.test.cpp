@@ -0,0 +1,73 @@
+/* Copyright (c) 2024, Thomas Atkinson
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <core/util/error.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include <core/util/profiling.hpp>
+
+using namespace vkb;
+
+TEST_CASE("vkb::get_heap_allocation_counters", "[common]")
+{
+	auto before = get_heap_allocation_counters();
+
+	// Calling the function directly, new expressions may be optimized out
+	void *ptr = ::operator new(128);
+	REQUIRE(ptr != nullptr);
+
+	auto after = get_heap_allocation_counters();
+	::operator delete(ptr);
+
+	REQUIRE(after.allocations >= before.allocations + 1);
+	REQUIRE(after.bytes >= before.bytes + 128);
+}
+
+TEST_CASE("vkb::CpuProfiler", "[common]")
+{
+	CpuProfiler::set_enabled(true);
+
+	{
+		CpuProfileScope outer{"Outer"};
+		CpuProfileScope inner{"Inner"};
+	}
+
+	CpuProfiler::end_frame();
+
+	{
+		CpuProfileScope ignored{"Ignored"};
+		CpuProfiler::set_enabled(false);
+	}
+
+	CpuProfiler::end_frame();
+
+	auto frames = CpuProfiler::get_frames();
+	REQUIRE(frames.size() == 1);
+
+	auto &scopes = frames[0].scopes;
+	REQUIRE(scopes.size() == 2);
+	REQUIRE(std::string(scopes[0].name) == "Outer");
+	REQUIRE(scopes[0].depth == 0);
+	REQUIRE(std::string(scopes[1].name) == "Inner");
+	REQUIRE(scopes[1].depth == 1);
+	REQUIRE(scopes[0].begin <= scopes[1].begin);
+	REQUIRE(scopes[1].end <= scopes[0].end);
+	REQUIRE(frames[0].begin <= scopes[0].begin);
+	REQUIRE(scopes[0].end <= frames[0].end);
+}
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <filesystem>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -34,12 +35,32 @@ struct FileStat
 	bool   is_file;
 	bool   is_directory;
 	size_t size;
+
+	// Ticks of the file clock when the file was last written, 0 if unknown
+	uint64_t last_write_time;
 };
 
 using Path = std::filesystem::path;
 
+// A read-only view of the entire contents of a file, valid for the lifetime of the object
+class MappedFile
+{
+  public:
+	MappedFile()          = default;
+	virtual ~MappedFile() = default;
+
+	MappedFile(const MappedFile &)            = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	virtual const uint8_t *data() const = 0;
+	virtual size_t         size() const = 0;
+};
+
+using MappedFilePtr = std::unique_ptr<MappedFile>;
+
 // A thin filesystem wrapper
-class FileSystem
+// The asynchronous reads keep the file system alive until they complete, so it must be owned by a FileSystemPtr
+class FileSystem : public std::enable_shared_from_this<FileSystem>
 {
   public:
 	FileSystem()          = default;
@@ -54,6 +75,10 @@ class FileSystem
 	virtual void                 write_file(const Path &path, const std::vector<uint8_t> &data) = 0;
 	virtual void                 remove(const Path &path)                                       = 0;
 
+	// Move a file to a new path, replacing any file there
+	// On the same file system the destination never holds a partially written file
+	virtual void rename(const Path &from, const Path &to) = 0;
+
 	virtual void        set_external_storage_directory(const std::string &dir) = 0;
 	virtual const Path &external_storage_directory() const                     = 0;
 	virtual const Path &temp_directory() const                                 = 0;
@@ -65,6 +90,21 @@ class FileSystem
 
 	// Read the entire file into a vector of bytes
 	std::vector<uint8_t> read_file_binary(const Path &path);
+
+	// Map the entire file into memory for reading, without copying it where the platform supports it
+	// The default implementation reads the file into memory
+	virtual MappedFilePtr map_file(const Path &path);
+
+	// Read a chunk of the file on an I/O worker thread, many reads can be in flight at once
+	// Errors are rethrown by the future
+	std::future<std::vector<uint8_t>> read_chunk_async(const Path &path, size_t offset, size_t count);
+
+	// Read the entire file on an I/O worker thread
+	std::future<std::vector<uint8_t>> read_file_binary_async(const Path &path);
+
+	// Read several entire files, queued in a single batch
+	// The futures are in the order of the paths, the reads may complete in any order
+	std::vector<std::future<std::vector<uint8_t>>> read_files_binary_async(const std::vector<Path> &paths);
 };
 
 using FileSystemPtr = std::shared_ptr<FileSystem>;
@@ -77,6 +117,15 @@ void init_with_context(const PlatformContext &context);
 // Get the filesystem instance
 FileSystemPtr get();
 
+// Write the files under a directory into a single pack file, with a directory table sorted by their paths relative to it
+// With compress set, the files LZ4 shrinks by an eighth are stored compressed, the others are aligned to pages
+void write_pack(const Path &directory, const Path &pack_path, bool compress = true);
+
+// Wrap a file system so that the files under the mount directory are read from a pack file
+// Mapping an uncompressed file of the pack maps it in place, without opening a file of its own
+// Throws if the pack can't be read
+FileSystemPtr mount_pack(const FileSystemPtr &file_system, const Path &pack_path, const Path &mount_directory);
+
 namespace helpers
 {
 std::string filename(const std::string &path);
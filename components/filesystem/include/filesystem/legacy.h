@@ -21,6 +21,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sys/stat.h>
 #include <unordered_map>
@@ -28,6 +29,11 @@
 
 namespace vkb
 {
+namespace filesystem
+{
+class MappedFile;
+}        // namespace filesystem
+
 namespace fs
 {
 namespace path
@@ -95,6 +101,14 @@ void create_path(const std::string &root, const std::string &path);
  */
 std::vector<uint8_t> read_asset(const std::string &filename);
 
+/**
+ * @brief Helper to map an asset file into memory for reading, without copying it
+ *
+ * @param filename The path to the file (relative to the assets directory)
+ * @return A read-only view of the file contents
+ */
+std::unique_ptr<vkb::filesystem::MappedFile> map_asset(const std::string &filename);
+
 /**
  * @brief Helper to read a shader file into a single string
  *
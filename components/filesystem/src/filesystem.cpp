@@ -19,7 +19,10 @@
 
 #include "core/platform/context.hpp"
 #include "core/util/error.hpp"
+#include "core/util/logging.hpp"
 
+#include "io_worker_pool.hpp"
+#include "pack_filesystem.hpp"
 #include "std_filesystem.hpp"
 
 namespace vkb
@@ -28,9 +31,69 @@ namespace filesystem
 {
 static FileSystemPtr fs = nullptr;
 
+namespace
+{
+// Fallback for file systems that can't map files, owns a copy of the contents
+class BufferedFile final : public MappedFile
+{
+  public:
+	explicit BufferedFile(std::vector<uint8_t> &&contents) :
+	    contents{std::move(contents)}
+	{}
+
+	const uint8_t *data() const override
+	{
+		return contents.data();
+	}
+
+	size_t size() const override
+	{
+		return contents.size();
+	}
+
+  private:
+	std::vector<uint8_t> contents;
+};
+
+// Wraps a read into a job for the I/O workers, the file system is kept alive until it ran
+template <typename Read>
+std::function<void()> make_read_job(const std::shared_ptr<FileSystem> &file_system, Read &&read,
+                                    std::future<std::vector<uint8_t>> &future)
+{
+	// std::function must be copyable, the task is not
+	auto task = std::make_shared<std::packaged_task<std::vector<uint8_t>()>>(
+	    [file_system, read = std::forward<Read>(read)]() { return read(*file_system); });
+
+	future = task->get_future();
+
+	return [task]() { (*task)(); };
+}
+
+// Assets packed into assets.pack next to the assets directory are read from the pack
+void mount_asset_pack()
+{
+	auto pack_path = fs->external_storage_directory() / "assets.pack";
+	if (!fs->is_file(pack_path))
+	{
+		return;
+	}
+
+	try
+	{
+		fs = mount_pack(fs, pack_path, fs->external_storage_directory() / "assets");
+		LOGI("Mounted asset pack {}", pack_path.string());
+	}
+	catch (const std::exception &e)
+	{
+		LOGW("Ignoring asset pack: {}", e.what());
+	}
+}
+}        // namespace
+
 void init()
 {
 	fs = std::make_shared<StdFileSystem>();
+	mount_asset_pack();
 }
 
 void init_with_context(const PlatformContext &context)
@@ -38,6 +101,7 @@ void init_with_context(const PlatformContext &context)
 	fs = std::make_shared<StdFileSystem>(
 	    context.external_storage_directory(),
 	    context.temp_directory());
+	mount_asset_pack();
 }
 
 FileSystemPtr get()
@@ -63,5 +127,49 @@ std::vector<uint8_t> FileSystem::read_file_binary(const Path &path)
 	return read_chunk(path, 0, stat.size);
 }
 
+MappedFilePtr FileSystem::map_file(const Path &path)
+{
+	return std::make_unique<BufferedFile>(read_file_binary(path));
+}
+
+std::future<std::vector<uint8_t>> FileSystem::read_chunk_async(const Path &path, size_t offset, size_t count)
+{
+	std::future<std::vector<uint8_t>> future;
+
+	IoWorkerPool::get().push(make_read_job(
+	    shared_from_this(), [path, offset, count](FileSystem &file_system) { return file_system.read_chunk(path, offset, count); }, future));
+
+	return future;
+}
+
+std::future<std::vector<uint8_t>> FileSystem::read_file_binary_async(const Path &path)
+{
+	std::future<std::vector<uint8_t>> future;
+
+	IoWorkerPool::get().push(make_read_job(
+	    shared_from_this(), [path](FileSystem &file_system) { return file_system.read_file_binary(path); }, future));
+
+	return future;
+}
+
+std::vector<std::future<std::vector<uint8_t>>> FileSystem::read_files_binary_async(const std::vector<Path> &paths)
+{
+	auto self = shared_from_this();
+
+	std::vector<std::future<std::vector<uint8_t>>> futures(paths.size());
+	std::vector<std::function<void()>>             jobs;
+	jobs.reserve(paths.size());
+
+	for (size_t i = 0; i < paths.size(); ++i)
+	{
+		jobs.push_back(make_read_job(
+		    self, [path = paths[i]](FileSystem &file_system) { return file_system.read_file_binary(path); }, futures[i]));
+	}
+
+	IoWorkerPool::get().push(std::move(jobs));
+
+	return futures;
+}
+
 }        // namespace filesystem
 }        // namespace vkb
\ No newline at end of file
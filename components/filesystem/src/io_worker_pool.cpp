@@ -0,0 +1,103 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io_worker_pool.hpp"
+
+#include <algorithm>
+
+namespace vkb
+{
+namespace filesystem
+{
+// Enough reads in flight to keep the queue of a storage device busy, reads mostly wait on the device
+static constexpr size_t MAX_IO_THREADS = 8;
+
+IoWorkerPool::IoWorkerPool(size_t thread_count)
+{
+	_threads.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		_threads.emplace_back([this]() { run(); });
+	}
+}
+
+IoWorkerPool::~IoWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		_stopping = true;
+	}
+	_condition.notify_all();
+
+	// The queued jobs are completed before the workers exit
+	for (auto &thread : _threads)
+	{
+		thread.join();
+	}
+}
+
+void IoWorkerPool::push(std::function<void()> &&job)
+{
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		_jobs.push_back(std::move(job));
+	}
+	_condition.notify_one();
+}
+
+void IoWorkerPool::push(std::vector<std::function<void()>> &&jobs)
+{
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		for (auto &job : jobs)
+		{
+			_jobs.push_back(std::move(job));
+		}
+	}
+	_condition.notify_all();
+}
+
+IoWorkerPool &IoWorkerPool::get()
+{
+	static IoWorkerPool pool{std::clamp<size_t>(std::thread::hardware_concurrency(), 2, MAX_IO_THREADS)};
+	return pool;
+}
+
+void IoWorkerPool::run()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock{_mutex};
+			_condition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+
+			if (_jobs.empty())
+			{
+				return;
+			}
+
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		job();
+	}
+}
+}        // namespace filesystem
+}        // namespace vkb
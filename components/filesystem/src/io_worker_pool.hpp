@@ -0,0 +1,65 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkb
+{
+namespace filesystem
+{
+// Worker threads running blocking file reads, so several of them are in flight at once
+class IoWorkerPool
+{
+  public:
+	explicit IoWorkerPool(size_t thread_count);
+
+	~IoWorkerPool();
+
+	IoWorkerPool(const IoWorkerPool &)            = delete;
+	IoWorkerPool &operator=(const IoWorkerPool &) = delete;
+
+	// Queue a job, the jobs are started in submission order
+	void push(std::function<void()> &&job);
+
+	// Queue several jobs at once, waking as many workers
+	void push(std::vector<std::function<void()>> &&jobs);
+
+	// The pool shared by the file systems, created on first use
+	static IoWorkerPool &get();
+
+  private:
+	void run();
+
+	std::vector<std::thread> _threads;
+
+	std::deque<std::function<void()>> _jobs;
+
+	std::mutex _mutex;
+
+	std::condition_variable _condition;
+
+	bool _stopping{false};
+};
+}        // namespace filesystem
+}        // namespace vkb
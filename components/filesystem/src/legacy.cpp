@@ -109,6 +109,11 @@ std::vector<uint8_t> read_asset(const std::string &filename)
 	return vkb::filesystem::get()->read_file_binary(path::get(path::Type::Assets) + filename);
 }
 
+std::unique_ptr<vkb::filesystem::MappedFile> map_asset(const std::string &filename)
+{
+	return vkb::filesystem::get()->map_file(path::get(path::Type::Assets) + filename);
+}
+
 std::string read_shader(const std::string &filename)
 {
 	return vkb::filesystem::get()->read_file_string(path::get(path::Type::Shaders) + filename);
@@ -0,0 +1,220 @@
+/* Copyright (c) 2024, Thomas Atkinson
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lz4.hpp"
+
+#include <cstring>
+
+namespace vkb
+{
+namespace filesystem
+{
+namespace lz4
+{
+namespace
+{
+constexpr size_t MinMatch = 4;
+
+// The last match must start this many bytes before the end of the block
+constexpr size_t MatchLimit = 12;
+
+// The last bytes of the block are always literals
+constexpr size_t LastLiterals = 5;
+
+constexpr size_t MaxOffset = 65535;
+
+constexpr uint32_t HashBits = 16;
+
+uint32_t read_u32(const uint8_t *data)
+{
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+uint32_t hash(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - HashBits);
+}
+
+void write_length(std::vector<uint8_t> &block, size_t length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		block.push_back(255);
+	}
+	block.push_back(static_cast<uint8_t>(length));
+}
+
+void write_sequence(std::vector<uint8_t> &block, const uint8_t *literals, size_t literal_count, size_t offset, size_t match_length)
+{
+	size_t match_code = match_length >= MinMatch ? match_length - MinMatch : 0;
+
+	block.push_back(static_cast<uint8_t>((literal_count < 15 ? literal_count : 15) << 4 | (match_code < 15 ? match_code : 15)));
+
+	if (literal_count >= 15)
+	{
+		write_length(block, literal_count - 15);
+	}
+	block.insert(block.end(), literals, literals + literal_count);
+
+	// The last sequence has no match
+	if (match_length == 0)
+	{
+		return;
+	}
+
+	block.push_back(static_cast<uint8_t>(offset & 0xff));
+	block.push_back(static_cast<uint8_t>(offset >> 8));
+
+	if (match_code >= 15)
+	{
+		write_length(block, match_code - 15);
+	}
+}
+
+bool read_length(const uint8_t *&in, const uint8_t *in_end, size_t &length)
+{
+	uint8_t value;
+	do
+	{
+		if (in == in_end)
+		{
+			return false;
+		}
+		value = *in++;
+		length += value;
+	} while (value == 255);
+
+	return true;
+}
+}        // namespace
+
+std::vector<uint8_t> compress(const uint8_t *data, size_t size)
+{
+	std::vector<uint8_t> block;
+	block.reserve(size / 2 + 16);
+
+	// Positions of the last sequences seen with each hash, offset by one so that zero is empty
+	std::vector<uint32_t> table(size_t{1} << HashBits, 0);
+
+	size_t anchor = 0;
+	size_t pos    = 0;
+
+	while (pos + MatchLimit <= size)
+	{
+		uint32_t  sequence  = read_u32(data + pos);
+		uint32_t &entry     = table[hash(sequence)];
+		size_t    candidate = entry;
+		entry               = static_cast<uint32_t>(pos + 1);
+
+		if (candidate == 0 || pos + 1 - candidate > MaxOffset || read_u32(data + candidate - 1) != sequence)
+		{
+			++pos;
+			continue;
+		}
+		--candidate;
+
+		size_t length = MinMatch;
+		while (pos + length < size - LastLiterals && data[candidate + length] == data[pos + length])
+		{
+			++length;
+		}
+
+		write_sequence(block, data + anchor, pos - anchor, pos - candidate, length);
+
+		pos += length;
+		anchor = pos;
+	}
+
+	write_sequence(block, data + anchor, size - anchor, 0, 0);
+
+	return block;
+}
+
+bool decompress(const uint8_t *block, size_t block_size, uint8_t *data, size_t size)
+{
+	const uint8_t *in      = block;
+	const uint8_t *in_end  = block + block_size;
+	uint8_t       *out     = data;
+	uint8_t       *out_end = data + size;
+
+	while (in < in_end)
+	{
+		uint8_t token = *in++;
+
+		size_t literal_count = token >> 4;
+		if (literal_count == 15 && !read_length(in, in_end, literal_count))
+		{
+			return false;
+		}
+
+		if (static_cast<size_t>(in_end - in) < literal_count || static_cast<size_t>(out_end - out) < literal_count)
+		{
+			return false;
+		}
+		if (literal_count > 0)
+		{
+			std::memcpy(out, in, literal_count);
+			in += literal_count;
+			out += literal_count;
+		}
+
+		// The last sequence ends after its literals
+		if (in == in_end)
+		{
+			break;
+		}
+
+		if (in_end - in < 2)
+		{
+			return false;
+		}
+		size_t offset = in[0] | static_cast<size_t>(in[1]) << 8;
+		in += 2;
+
+		if (offset == 0 || offset > static_cast<size_t>(out - data))
+		{
+			return false;
+		}
+
+		size_t match_length = token & 15;
+		if (match_length == 15 && !read_length(in, in_end, match_length))
+		{
+			return false;
+		}
+		match_length += MinMatch;
+
+		if (static_cast<size_t>(out_end - out) < match_length)
+		{
+			return false;
+		}
+
+		// Byte by byte, the match may overlap the bytes it writes
+		const uint8_t *match = out - offset;
+		for (size_t i = 0; i < match_length; ++i)
+		{
+			out[i] = match[i];
+		}
+		out += match_length;
+	}
+
+	return out == out_end;
+}
+}        // namespace lz4
+}        // namespace filesystem
+}        // namespace vkb
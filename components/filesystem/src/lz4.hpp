@@ -0,0 +1,39 @@
+/* Copyright (c) 2024, Thomas Atkinson
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vkb
+{
+namespace filesystem
+{
+namespace lz4
+{
+// Compress data into a single LZ4 block, without the frame around it
+// The data must be smaller than 4 GiB
+std::vector<uint8_t> compress(const uint8_t *data, size_t size);
+
+// Decompress a single LZ4 block, which must decompress to exactly size bytes
+// Returns false if the block is malformed
+bool decompress(const uint8_t *block, size_t block_size, uint8_t *data, size_t size);
+}        // namespace lz4
+}        // namespace filesystem
+}        // namespace vkb
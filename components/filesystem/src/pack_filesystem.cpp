@@ -0,0 +1,437 @@
+/* Copyright (c) 2024, Thomas Atkinson
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pack_filesystem.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "lz4.hpp"
+
+namespace vkb
+{
+namespace filesystem
+{
+namespace
+{
+// A view of an uncompressed entry, keeps the mapping of the pack alive
+class PackMappedFile final : public MappedFile
+{
+  public:
+	PackMappedFile(std::shared_ptr<MappedFile> pack, const uint8_t *data, size_t size) :
+	    _pack{std::move(pack)},
+	    _data{data},
+	    _size{size}
+	{}
+
+	const uint8_t *data() const override
+	{
+		return _data;
+	}
+
+	size_t size() const override
+	{
+		return _size;
+	}
+
+  private:
+	std::shared_ptr<MappedFile> _pack;
+	const uint8_t              *_data;
+	size_t                      _size;
+};
+
+// Owns the decompressed contents of an entry
+class PackBufferedFile final : public MappedFile
+{
+  public:
+	explicit PackBufferedFile(std::vector<uint8_t> &&contents) :
+	    _contents{std::move(contents)}
+	{}
+
+	const uint8_t *data() const override
+	{
+		return _contents.data();
+	}
+
+	size_t size() const override
+	{
+		return _contents.size();
+	}
+
+  private:
+	std::vector<uint8_t> _contents;
+};
+
+void write_padding(std::ofstream &file, uint64_t alignment)
+{
+	static const std::vector<char> zeros(pack::Alignment, 0);
+
+	auto offset = static_cast<uint64_t>(file.tellp());
+	if (offset % alignment != 0)
+	{
+		file.write(zeros.data(), alignment - offset % alignment);
+	}
+}
+}        // namespace
+
+PackFileSystem::PackFileSystem(FileSystemPtr file_system, const Path &pack_path, const Path &mount_directory) :
+    _file_system{std::move(file_system)},
+    _mount_directory{mount_directory.lexically_normal()}
+{
+	_pack            = _file_system->map_file(pack_path);
+	_last_write_time = _file_system->stat_file(pack_path).last_write_time;
+
+	auto invalid = [&pack_path](const std::string &reason) {
+		return std::runtime_error("Invalid pack file at path: " + pack_path.string() + ", " + reason);
+	};
+
+	pack::Header header{};
+	if (_pack->size() < sizeof(header))
+	{
+		throw invalid("truncated header");
+	}
+	std::memcpy(&header, _pack->data(), sizeof(header));
+
+	if (header.magic != pack::Magic || header.version != pack::Version)
+	{
+		throw invalid("unsupported version");
+	}
+
+	if (header.entry_count > _pack->size() / sizeof(pack::Entry) ||
+	    header.table_offset + header.entry_count * sizeof(pack::Entry) > _pack->size() ||
+	    header.names_offset + header.names_size > _pack->size())
+	{
+		throw invalid("truncated directory table");
+	}
+
+	_entries.resize(header.entry_count);
+	std::memcpy(_entries.data(), _pack->data() + header.table_offset, _entries.size() * sizeof(pack::Entry));
+
+	for (auto &entry : _entries)
+	{
+		if (entry.name_offset + entry.name_size > header.names_size || entry.offset + entry.stored_size > _pack->size() ||
+		    (entry.compression == pack::Compression::None && entry.stored_size != entry.size) ||
+		    (entry.compression != pack::Compression::None && entry.compression != pack::Compression::LZ4))
+		{
+			throw invalid("corrupt entry");
+		}
+
+		// From the start of the pack, like the offsets of the data
+		entry.name_offset += header.names_offset;
+	}
+
+	if (!std::is_sorted(_entries.begin(), _entries.end(), [this](const pack::Entry &lhs, const pack::Entry &rhs) { return get_name(lhs) < get_name(rhs); }))
+	{
+		throw invalid("unsorted directory table");
+	}
+}
+
+FileStat PackFileSystem::stat_file(const Path &path)
+{
+	if (auto entry = find_entry(path))
+	{
+		return FileStat{
+		    true,
+		    false,
+		    static_cast<size_t>(entry->size),
+		    _last_write_time,
+		};
+	}
+
+	if (is_pack_directory(path))
+	{
+		return FileStat{
+		    false,
+		    true,
+		    0,
+		    _last_write_time,
+		};
+	}
+
+	return _file_system->stat_file(path);
+}
+
+bool PackFileSystem::is_file(const Path &path)
+{
+	auto stat = stat_file(path);
+	return stat.is_file;
+}
+
+bool PackFileSystem::is_directory(const Path &path)
+{
+	auto stat = stat_file(path);
+	return stat.is_directory;
+}
+
+bool PackFileSystem::exists(const Path &path)
+{
+	auto stat = stat_file(path);
+	return stat.is_file || stat.is_directory;
+}
+
+bool PackFileSystem::create_directory(const Path &path)
+{
+	return _file_system->create_directory(path);
+}
+
+std::vector<uint8_t> PackFileSystem::read_chunk(const Path &path, size_t offset, size_t count)
+{
+	auto entry = find_entry(path);
+	if (!entry)
+	{
+		return _file_system->read_chunk(path, offset, count);
+	}
+
+	if (offset + count > entry->size)
+	{
+		return {};
+	}
+
+	if (entry->compression == pack::Compression::None)
+	{
+		const uint8_t *data = _pack->data() + entry->offset + offset;
+		return {data, data + count};
+	}
+
+	auto contents = read_entry(*entry);
+	return {contents.begin() + offset, contents.begin() + offset + count};
+}
+
+void PackFileSystem::write_file(const Path &path, const std::vector<uint8_t> &data)
+{
+	_file_system->write_file(path, data);
+}
+
+MappedFilePtr PackFileSystem::map_file(const Path &path)
+{
+	auto entry = find_entry(path);
+	if (!entry)
+	{
+		return _file_system->map_file(path);
+	}
+
+	if (entry->compression == pack::Compression::None)
+	{
+		return std::make_unique<PackMappedFile>(_pack, _pack->data() + entry->offset, static_cast<size_t>(entry->size));
+	}
+
+	return std::make_unique<PackBufferedFile>(read_entry(*entry));
+}
+
+void PackFileSystem::remove(const Path &path)
+{
+	_file_system->remove(path);
+}
+
+void PackFileSystem::rename(const Path &from, const Path &to)
+{
+	_file_system->rename(from, to);
+}
+
+void PackFileSystem::set_external_storage_directory(const std::string &dir)
+{
+	_file_system->set_external_storage_directory(dir);
+}
+
+const Path &PackFileSystem::external_storage_directory() const
+{
+	return _file_system->external_storage_directory();
+}
+
+const Path &PackFileSystem::temp_directory() const
+{
+	return _file_system->temp_directory();
+}
+
+bool PackFileSystem::get_pack_name(const Path &path, std::string &name) const
+{
+	auto relative = path.lexically_normal().lexically_relative(_mount_directory);
+	if (relative.empty())
+	{
+		return false;
+	}
+
+	name = relative.generic_string();
+	if (name == ".")
+	{
+		name.clear();
+	}
+	else if (name.compare(0, 2, "..") == 0)
+	{
+		return false;
+	}
+
+	// Paths of directories may end with a separator
+	if (!name.empty() && name.back() == '/')
+	{
+		name.pop_back();
+	}
+
+	return true;
+}
+
+const pack::Entry *PackFileSystem::find_entry(const Path &path) const
+{
+	std::string name;
+	if (!get_pack_name(path, name) || name.empty())
+	{
+		return nullptr;
+	}
+
+	auto it = std::lower_bound(_entries.begin(), _entries.end(), name, [this](const pack::Entry &entry, const std::string &value) { return get_name(entry) < value; });
+	return it != _entries.end() && get_name(*it) == name ? &*it : nullptr;
+}
+
+bool PackFileSystem::is_pack_directory(const Path &path) const
+{
+	std::string name;
+	if (!get_pack_name(path, name))
+	{
+		return false;
+	}
+
+	// The mount directory, even if the pack is empty
+	if (name.empty())
+	{
+		return true;
+	}
+
+	// A directory is implied by the entries under it, the first of which sorts right after its prefix
+	name += '/';
+	auto it = std::lower_bound(_entries.begin(), _entries.end(), name, [this](const pack::Entry &entry, const std::string &value) { return get_name(entry) < value; });
+	return it != _entries.end() && get_name(*it).compare(0, name.size(), name) == 0;
+}
+
+std::string_view PackFileSystem::get_name(const pack::Entry &entry) const
+{
+	return {reinterpret_cast<const char *>(_pack->data() + entry.name_offset), entry.name_size};
+}
+
+std::vector<uint8_t> PackFileSystem::read_entry(const pack::Entry &entry) const
+{
+	const uint8_t *stored = _pack->data() + entry.offset;
+
+	if (entry.compression == pack::Compression::None)
+	{
+		return {stored, stored + entry.stored_size};
+	}
+
+	std::vector<uint8_t> contents(entry.size);
+	if (!lz4::decompress(stored, entry.stored_size, contents.data(), contents.size()))
+	{
+		throw std::runtime_error("Failed to decompress pack entry: " + std::string{get_name(entry)});
+	}
+
+	return contents;
+}
+
+void write_pack(const Path &directory, const Path &pack_path, bool compress)
+{
+	std::vector<std::string> names;
+	for (auto &file : std::filesystem::recursive_directory_iterator{directory})
+	{
+		if (file.is_regular_file())
+		{
+			names.push_back(file.path().lexically_relative(directory).generic_string());
+		}
+	}
+	std::sort(names.begin(), names.end());
+
+	std::ofstream pack_file{pack_path, std::ios::binary | std::ios::trunc};
+	if (!pack_file.is_open())
+	{
+		throw std::runtime_error("Failed to open pack file for writing at path: " + pack_path.string());
+	}
+
+	// Written again once the offsets of the table are known
+	pack::Header header{};
+	pack_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	std::vector<pack::Entry> entries;
+	std::string              name_block;
+
+	for (auto &name : names)
+	{
+		std::ifstream file{directory / name, std::ios::binary};
+		if (!file.is_open())
+		{
+			throw std::runtime_error("Failed to open file for reading at path: " + (directory / name).string());
+		}
+		std::vector<uint8_t> contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+		pack::Entry entry{};
+		entry.name_offset = name_block.size();
+		entry.name_size   = static_cast<uint32_t>(name.size());
+		entry.size        = contents.size();
+		name_block += name;
+
+		// Only kept if it saves an eighth, already compressed images and models are left mappable
+		std::vector<uint8_t> compressed;
+		if (compress && !contents.empty() && contents.size() < std::numeric_limits<uint32_t>::max())
+		{
+			compressed = lz4::compress(contents.data(), contents.size());
+		}
+
+		if (!compressed.empty() && compressed.size() < contents.size() - contents.size() / 8)
+		{
+			entry.compression = pack::Compression::LZ4;
+			entry.offset      = static_cast<uint64_t>(pack_file.tellp());
+			entry.stored_size = compressed.size();
+			pack_file.write(reinterpret_cast<const char *>(compressed.data()), compressed.size());
+		}
+		else
+		{
+			write_padding(pack_file, pack::Alignment);
+			entry.compression = pack::Compression::None;
+			entry.offset      = static_cast<uint64_t>(pack_file.tellp());
+			entry.stored_size = contents.size();
+			pack_file.write(reinterpret_cast<const char *>(contents.data()), contents.size());
+		}
+
+		entries.push_back(entry);
+	}
+
+	write_padding(pack_file, alignof(pack::Entry));
+
+	header.magic        = pack::Magic;
+	header.version      = pack::Version;
+	header.entry_count  = entries.size();
+	header.table_offset = static_cast<uint64_t>(pack_file.tellp());
+	pack_file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(pack::Entry));
+
+	header.names_offset = static_cast<uint64_t>(pack_file.tellp());
+	header.names_size   = name_block.size();
+	pack_file.write(name_block.data(), name_block.size());
+
+	pack_file.seekp(0);
+	pack_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	if (!pack_file)
+	{
+		throw std::runtime_error("Failed to write pack file at path: " + pack_path.string());
+	}
+}
+
+FileSystemPtr mount_pack(const FileSystemPtr &file_system, const Path &pack_path, const Path &mount_directory)
+{
+	return std::make_shared<PackFileSystem>(file_system, pack_path, mount_directory);
+}
+}        // namespace filesystem
+}        // namespace vkb
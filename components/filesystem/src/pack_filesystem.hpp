@@ -0,0 +1,132 @@
+/* Copyright (c) 2024, Thomas Atkinson
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "filesystem/filesystem.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vkb
+{
+namespace filesystem
+{
+// The contents of a pack file
+//
+// A pack starts with a header, followed by the entry data, the directory table sorted by path, and the paths.
+// Uncompressed entries start on an Alignment boundary, so a mapping of the pack maps them in place.
+namespace pack
+{
+constexpr uint32_t Magic   = 0x4b50564b;        // "KVPK"
+constexpr uint32_t Version = 1;
+
+// Matches the page size, so that the uncompressed entries can be mapped or imported directly
+constexpr uint64_t Alignment = 4096;
+
+enum class Compression : uint32_t
+{
+	None,
+	LZ4
+};
+
+struct Header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t entry_count;
+	uint64_t table_offset;
+	uint64_t names_offset;
+	uint64_t names_size;
+};
+
+struct Entry
+{
+	uint64_t    name_offset;
+	uint32_t    name_size;
+	Compression compression;
+	uint64_t    offset;
+	uint64_t    stored_size;
+	uint64_t    size;
+};
+}        // namespace pack
+
+// Reads the files under a mount directory from a pack, and forwards every other access to the file system it wraps
+// The pack is read-only, writes under the mount directory go to the wrapped file system but the pack is read first
+class PackFileSystem final : public FileSystem
+{
+  public:
+	PackFileSystem(FileSystemPtr file_system, const Path &pack_path, const Path &mount_directory);
+
+	virtual ~PackFileSystem() = default;
+
+	FileStat stat_file(const Path &path) override;
+
+	bool is_file(const Path &path) override;
+
+	bool is_directory(const Path &path) override;
+
+	bool exists(const Path &path) override;
+
+	bool create_directory(const Path &path) override;
+
+	std::vector<uint8_t> read_chunk(const Path &path, size_t offset, size_t count) override;
+
+	void write_file(const Path &path, const std::vector<uint8_t> &data) override;
+
+	MappedFilePtr map_file(const Path &path) override;
+
+	void remove(const Path &path) override;
+
+	void rename(const Path &from, const Path &to) override;
+
+	void set_external_storage_directory(const std::string &dir) override;
+
+	const Path &external_storage_directory() const override;
+
+	const Path &temp_directory() const override;
+
+  private:
+	// The path of a file or directory relative to the mount directory, false if it is outside of it
+	bool get_pack_name(const Path &path, std::string &name) const;
+
+	const pack::Entry *find_entry(const Path &path) const;
+
+	bool is_pack_directory(const Path &path) const;
+
+	std::string_view get_name(const pack::Entry &entry) const;
+
+	// The uncompressed contents of an entry
+	std::vector<uint8_t> read_entry(const pack::Entry &entry) const;
+
+	FileSystemPtr _file_system;
+
+	Path _mount_directory;
+
+	// Shared with the views of the entries mapped from it
+	std::shared_ptr<MappedFile> _pack;
+
+	// Sorted by path
+	std::vector<pack::Entry> _entries;
+
+	// The entries are only written with the pack, they take its time
+	uint64_t _last_write_time{0};
+};
+}        // namespace filesystem
+}        // namespace vkb
@@ -47,8 +47,12 @@ class StdFileSystem final : public FileSystem
 
 	void write_file(const Path &path, const std::vector<uint8_t> &data) override;
 
+	MappedFilePtr map_file(const Path &path) override;
+
 	virtual void remove(const Path &path) override;
 
+	void rename(const Path &from, const Path &to) override;
+
 	virtual void set_external_storage_directory(const std::string &dir) override;
 
 	const Path &external_storage_directory() const override;
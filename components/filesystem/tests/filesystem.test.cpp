@@ -70,6 +70,9 @@ TEST_CASE("File read and write", "[filesystem]")
 	const std::string test_data = "Hello, World!";
 
 	create_test_file(fs, test_file, test_data);
+	REQUIRE(fs->stat_file(test_file).size == test_data.size());
+	REQUIRE(fs->stat_file(test_file).last_write_time != 0);
+
 	delete_test_file(fs, test_file);
 	delete_test_directory(fs, test_dir);
 }
@@ -190,3 +193,222 @@ TEST_CASE("Create Directory", "[filesystem]")
 
 	delete_test_directory(fs, test_dir);
 }
+
+TEST_CASE("Rename file", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	const auto test_dir    = create_test_directory(fs, "rename_test");
+	const auto source_file = test_dir / "source.txt";
+	const auto target_file = test_dir / "target.txt";
+
+	create_test_file(fs, source_file, "New data");
+	create_test_file(fs, target_file, "Old data");
+
+	// The target is replaced
+	REQUIRE_NOTHROW(fs->rename(source_file, target_file));
+	REQUIRE_FALSE(fs->exists(source_file));
+	REQUIRE(fs->read_file_string(target_file) == "New data");
+
+	REQUIRE_THROWS(fs->rename(source_file, target_file));
+
+	delete_test_file(fs, target_file);
+	delete_test_directory(fs, test_dir);
+}
+
+TEST_CASE("Map file", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	const auto        test_dir  = create_test_directory(fs, "map_test");
+	const auto        test_file = test_dir / "map_test.txt";
+	const std::string test_data = "Hello, World!";
+
+	create_test_file(fs, test_file, test_data);
+
+	{
+		const auto mapped_file = fs->map_file(test_file);
+		REQUIRE(mapped_file);
+		REQUIRE(mapped_file->size() == test_data.size());
+
+		std::string mapped_str(reinterpret_cast<const char *>(mapped_file->data()), mapped_file->size());
+		REQUIRE(mapped_str == test_data);
+	}
+
+	delete_test_file(fs, test_file);
+	delete_test_directory(fs, test_dir);
+}
+
+TEST_CASE("Map empty file", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	const auto test_dir  = create_test_directory(fs, "map_empty_test");
+	const auto test_file = test_dir / "map_empty_test.txt";
+
+	REQUIRE_NOTHROW(fs->write_file(test_file, std::vector<uint8_t>{}));
+
+	{
+		const auto mapped_file = fs->map_file(test_file);
+		REQUIRE(mapped_file);
+		REQUIRE(mapped_file->size() == 0);
+	}
+
+	delete_test_file(fs, test_file);
+	delete_test_directory(fs, test_dir);
+}
+
+TEST_CASE("Map missing file", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	REQUIRE_THROWS(fs->map_file(fs->temp_directory() / "vulkan_samples_tests" / "missing_file.txt"));
+}
+
+TEST_CASE("Read file chunk asynchronously", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	const auto        test_dir  = create_test_directory(fs, "async_chunk_test");
+	const auto        test_file = test_dir / "async_chunk_test.txt";
+	const std::string test_data = "Hello, World!";
+
+	create_test_file(fs, test_file, test_data);
+
+	auto        chunk_future = fs->read_chunk_async(test_file, 7, 5);
+	const auto  chunk        = chunk_future.get();
+	std::string chunk_str(chunk.begin(), chunk.end());
+	REQUIRE(chunk_str == "World");
+
+	delete_test_file(fs, test_file);
+	delete_test_directory(fs, test_dir);
+}
+
+TEST_CASE("Read files asynchronously in a batch", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	const auto test_dir = create_test_directory(fs, "async_batch_test");
+
+	std::vector<Path> test_files;
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		test_files.push_back(test_dir / fmt::format("async_batch_test_{}.txt", i));
+		create_test_file(fs, test_files.back(), fmt::format("File {}", i));
+	}
+
+	auto futures = fs->read_files_binary_async(test_files);
+	REQUIRE(futures.size() == test_files.size());
+
+	for (uint32_t i = 0; i < futures.size(); ++i)
+	{
+		const auto  binary = futures[i].get();
+		std::string binary_str(binary.begin(), binary.end());
+		REQUIRE(binary_str == fmt::format("File {}", i));
+	}
+
+	for (auto &test_file : test_files)
+	{
+		delete_test_file(fs, test_file);
+	}
+	delete_test_directory(fs, test_dir);
+}
+
+TEST_CASE("Read missing file asynchronously", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	auto future = fs->read_chunk_async(fs->temp_directory() / "vulkan_samples_tests" / "missing_file.txt", 0, 1);
+	REQUIRE_THROWS(future.get());
+}
+
+TEST_CASE("Read files from a pack", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	const auto test_dir  = create_test_directory(fs, "pack_test");
+	const auto files_dir = test_dir / "files";
+	const auto pack_file = test_dir / "files.pack";
+
+	std::string compressible_data;
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		compressible_data += "Hello, World! ";
+	}
+
+	REQUIRE(fs->create_directory(files_dir / "nested"));
+	create_test_file(fs, files_dir / "compressible.txt", compressible_data);
+	create_test_file(fs, files_dir / "small.txt", "Hello, World!");
+	create_test_file(fs, files_dir / "nested" / "nested.txt", "Nested");
+	create_test_file(fs, test_dir / "outside.txt", "Outside");
+
+	REQUIRE_NOTHROW(write_pack(files_dir, pack_file));
+
+	// Read back from the pack alone
+	fs->remove(files_dir);
+
+	const auto mount_dir = test_dir / "mount";
+	const auto pack_fs   = mount_pack(fs, pack_file, mount_dir);
+
+	REQUIRE(pack_fs->read_file_string(mount_dir / "compressible.txt") == compressible_data);
+	REQUIRE(pack_fs->read_file_string(mount_dir / "small.txt") == "Hello, World!");
+	REQUIRE(pack_fs->read_file_string(mount_dir / "nested" / "nested.txt") == "Nested");
+
+	REQUIRE(pack_fs->stat_file(mount_dir / "compressible.txt").size == compressible_data.size());
+	REQUIRE(pack_fs->stat_file(mount_dir / "compressible.txt").last_write_time == fs->stat_file(pack_file).last_write_time);
+	REQUIRE(pack_fs->is_directory(mount_dir));
+	REQUIRE(pack_fs->is_directory(mount_dir / "nested"));
+	REQUIRE_FALSE(pack_fs->exists(mount_dir / "nest"));
+	REQUIRE_FALSE(pack_fs->exists(mount_dir / "missing.txt"));
+
+	const auto chunk = pack_fs->read_chunk(mount_dir / "small.txt", 7, 5);
+	REQUIRE(std::string(chunk.begin(), chunk.end()) == "World");
+
+	{
+		// Uncompressed entries are mapped in place, page aligned in the pack
+		const auto mapped_file = pack_fs->map_file(mount_dir / "small.txt");
+		REQUIRE(mapped_file->size() == 13);
+		REQUIRE(std::string(reinterpret_cast<const char *>(mapped_file->data()), mapped_file->size()) == "Hello, World!");
+
+		const auto mapped_pack = pack_fs->map_file(pack_file);
+		REQUIRE((mapped_file->data() - mapped_pack->data()) % 4096 == 0);
+	}
+
+	// Files outside of the mount directory come from the wrapped file system
+	REQUIRE(pack_fs->read_file_string(test_dir / "outside.txt") == "Outside");
+
+	delete_test_directory(fs, test_dir);
+}
+
+TEST_CASE("Mount invalid pack", "[filesystem]")
+{
+	vkb::filesystem::init();
+
+	auto fs = vkb::filesystem::get();
+
+	const auto test_dir  = create_test_directory(fs, "invalid_pack_test");
+	const auto pack_file = test_dir / "invalid.pack";
+
+	create_test_file(fs, pack_file, "Not a pack");
+
+	REQUIRE_THROWS(mount_pack(fs, pack_file, test_dir / "mount"));
+	REQUIRE_THROWS(mount_pack(fs, test_dir / "missing.pack", test_dir / "mount"));
+
+	delete_test_directory(fs, test_dir);
+}
@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2020, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -17,8 +17,15 @@
 
 #include "ResourceCache.h"
 
+#include <algorithm>
+#include <cstring>
+#include <set>
+
 #include "common/resource_caching.h"
 #include "core/device.h"
+#include "core/util/cache_file.hpp"
+#include "core/util/profiling.hpp"
+#include "deferred_destruction_queue.h"
 
 namespace vkb
 {
@@ -26,104 +33,1121 @@ namespace vkb
 namespace
 {
 
+/// Identifies a file written by ResourceCache::SaveToFile ("VKBC")
+constexpr uint32_t CACHE_FILE_MAGIC = 0x43424b56;
+
+/// Must be bumped whenever the header or the layout of the recorded resources changes
+constexpr uint32_t CACHE_FILE_VERSION = 3;
+
+/// Starts the payload of the file, followed by the pipeline cache data and the recorded resources
+struct ResourceCacheFileHeader
+{
+	uint32_t vendorId;
+	uint32_t deviceId;
+	uint32_t driverVersion;
+	uint8_t  pipelineCacheUuid[VK_UUID_SIZE];
+	uint64_t pipelineCacheSize;
+	uint64_t recordSize;
+};
+
+
+ResourceCacheFileHeader MakeCacheFileHeader(const VkPhysicalDeviceProperties& properties)
+{
+	ResourceCacheFileHeader header{};
+	header.vendorId      = properties.vendorID;
+	header.deviceId      = properties.deviceID;
+	header.driverVersion = properties.driverVersion;
+	std::memcpy(header.pipelineCacheUuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+	return header;
+}
+
+
+template <class T>
+T* FindResource(ResourceCacheLock& resourceLock, std::unordered_map<std::size_t, T>& resources, std::size_t hash)
+{
+	// Cache hits only need shared access, so parallel lookups do not serialize
+	std::shared_lock<std::shared_mutex> readGuard(resourceLock.mutex, std::try_to_lock);
+	if (!readGuard.owns_lock())
+	{
+		resourceLock.contentions.fetch_add(1, std::memory_order_relaxed);
+		readGuard.lock();
+	}
+
+	auto resIt = resources.find(hash);
+	if (resIt == resources.end())
+	{
+		return nullptr;
+	}
+
+	resourceLock.hits.fetch_add(1, std::memory_order_relaxed);
+	resourceLock.Touch(hash);
+	return &resIt->second;
+}
+
+
+std::unique_lock<std::shared_mutex> LockExclusive(ResourceCacheLock& resourceLock)
+{
+	std::unique_lock<std::shared_mutex> writeGuard(resourceLock.mutex, std::try_to_lock);
+	if (!writeGuard.owns_lock())
+	{
+		resourceLock.contentions.fetch_add(1, std::memory_order_relaxed);
+		writeGuard.lock();
+	}
+	return writeGuard;
+}
+
+
+/// Creates missing resources while holding the exclusive lock, for resources whose creation mutates shared state
 template <class T, class... A>
-T& RequestResource(Device& device, ResourceRecord& recorder, std::mutex& resourceMutex, std::unordered_map<std::size_t, T>& resources, A &... args)
+T& RequestResource(Device& device, ResourceRecord& recorder, ResourceCacheLock& resourceLock, std::unordered_map<std::size_t, T>& resources, A &... args)
 {
-	std::lock_guard<std::mutex> guard(resourceMutex);
+	std::size_t hash{ 0U };
+	hash_param(hash, args...);
+
+	if (T* res = FindResource(resourceLock, resources, hash))
+	{
+		return *res;
+	}
+
+	auto writeGuard = LockExclusive(resourceLock);
+
+	resourceLock.misses.fetch_add(1, std::memory_order_relaxed);
 
-	auto &res = request_resource(device, &recorder, resources, args...);
+	// Another thread may have created the resource in between, which is checked again with the same hash
+	auto &res = request_resource_with_hash(device, &recorder, resources, hash, args...);
+	resourceLock.Track(hash);
 
 	return res;
 }
 
+
+/// Creates missing resources without holding the lock, so that expensive objects like pipelines
+/// can be built by several threads at once. A missing object is only built by the first thread
+/// requesting it, the others wait for that build. Only the building thread gets created set to true.
+template <class T, class... A>
+T& BuildResourceTracked(Device& device, ResourceRecord& recorder, ResourceCacheLock& resourceLock, std::unordered_map<std::size_t, T>& resources, bool& created, A &... args)
+{
+	std::size_t hash{ 0U };
+	hash_param(hash, args...);
+
+	created = false;
+
+	if (T* res = FindResource(resourceLock, resources, hash))
+	{
+		return *res;
+	}
+
+	std::promise<void> built;
+	while (true)
+	{
+		auto writeGuard = LockExclusive(resourceLock);
+
+		auto resIt = resources.find(hash);
+		if (resIt != resources.end())
+		{
+			resourceLock.hits.fetch_add(1, std::memory_order_relaxed);
+			resourceLock.Touch(hash);
+			return resIt->second;
+		}
+
+		auto buildIt = resourceLock.builds.find(hash);
+		if (buildIt == resourceLock.builds.end())
+		{
+			resourceLock.builds.emplace(hash, built.get_future().share());
+			break;
+		}
+
+		// Checked again once the build is done, it is built here if it failed
+		auto pendingBuild = buildIt->second;
+		writeGuard.unlock();
+		pendingBuild.wait();
+	}
+
+	resourceLock.misses.fetch_add(1, std::memory_order_relaxed);
+
+	LOGD("Building cache object ({})", typeid(T).name());
+
+	// Readies the build in every case, the waiters find the object or build it themselves
+	auto finishBuild = [&resourceLock, &built, hash]() {
+		resourceLock.builds.erase(hash);
+		built.set_value();
+	};
+
+	try
+	{
+		T resource(device, args...);
+
+		auto writeGuard = LockExclusive(resourceLock);
+
+		auto resIt = resources.emplace(hash, std::move(resource)).first;
+		resourceLock.Track(hash);
+
+		RecordHelper<T, A...> recordHelper;
+
+		size_t index = recordHelper.record(recorder, args...);
+		recordHelper.index(recorder, index, resIt->second);
+
+		finishBuild();
+
+		created = true;
+
+		return resIt->second;
+	}
+	catch (...)
+	{
+		auto writeGuard = LockExclusive(resourceLock);
+		finishBuild();
+		throw;
+	}
+}
+
+
+template <class T, class... A>
+T& BuildResource(Device& device, ResourceRecord& recorder, ResourceCacheLock& resourceLock, std::unordered_map<std::size_t, T>& resources, A &... args)
+{
+	bool created;
+	return BuildResourceTracked(device, recorder, resourceLock, resources, created, args...);
+}
+
+
+/// Moves the evicted objects out of the cache, into the deferred destruction queue
+template <class T>
+void RetireResources(Device& device, const std::vector<std::size_t>& hashes, std::unordered_map<std::size_t, T>& resources)
+{
+	std::vector<T> retired;
+	for (auto hash : hashes)
+	{
+		auto resIt = resources.find(hash);
+		if (resIt != resources.end())
+		{
+			retired.push_back(std::move(resIt->second));
+			resources.erase(resIt);
+		}
+	}
+
+	if (!retired.empty())
+	{
+		device.get_deferred_destruction_queue().retire(std::move(retired));
+	}
+}
+
+
+/// Sets the budget of a resource type, the objects cached so far are aged from now on
+template <class T>
+void SetResourceBudget(ResourceCacheLock& resourceLock, size_t budget, std::initializer_list<std::unordered_map<std::size_t, T>*> resourceMaps)
+{
+	std::unique_lock<std::shared_mutex> guard(resourceLock.mutex);
+
+	resourceLock.budget = budget;
+	resourceLock.lastUses.clear();
+
+	for (auto* resources : resourceMaps)
+	{
+		for (auto& resIt : *resources)
+		{
+			resourceLock.Track(resIt.first);
+		}
+	}
+}
+
+
+/// Retired in place of evicted objects the cache releases itself, flags when the GPU is done with them
+struct ReleaseMarker
+{
+	explicit ReleaseMarker(std::shared_ptr<std::atomic<bool>> released) :
+	    released{ std::move(released) }
+	{}
+
+	ReleaseMarker(ReleaseMarker&&) = default;
+
+	~ReleaseMarker()
+	{
+		if (released)
+		{
+			released->store(true, std::memory_order_release);
+		}
+	}
+
+	std::shared_ptr<std::atomic<bool>> released;
+};
+
 }        // namespace
 
 
-ResourceCache::ResourceCache(Device& device) 
-	: m_device{ device }
+ResourceCacheCounters ResourceCacheLock::GetCounters() const
+{
+	ResourceCacheCounters counters;
+	counters.hits        = hits.load(std::memory_order_relaxed);
+	counters.misses      = misses.load(std::memory_order_relaxed);
+	counters.contentions = contentions.load(std::memory_order_relaxed);
+	counters.evictions   = evictions.load(std::memory_order_relaxed);
+	return counters;
+}
+
+
+void ResourceCacheLock::ResetCounters()
+{
+	hits.store(0, std::memory_order_relaxed);
+	misses.store(0, std::memory_order_relaxed);
+	contentions.store(0, std::memory_order_relaxed);
+	evictions.store(0, std::memory_order_relaxed);
+}
+
+
+void ResourceCacheLock::Touch(std::size_t hash)
+{
+	if (budget == 0)
+	{
+		return;
+	}
+
+	// Entries are only added with the lock held exclusively, stamping an existing one is safe in shared mode
+	auto lastUseIt = lastUses.find(hash);
+	if (lastUseIt != lastUses.end())
+	{
+		lastUseIt->second.store(frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+
+void ResourceCacheLock::Track(std::size_t hash)
+{
+	if (budget != 0)
+	{
+		lastUses[hash].store(frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+
+std::vector<std::size_t> ResourceCacheLock::CollectEvictions(uint32_t minUnusedFrames)
+{
+	std::vector<std::size_t> evicted;
+	if (budget == 0 || lastUses.size() <= budget)
+	{
+		return evicted;
+	}
+
+	uint64_t currentFrame = frame.load(std::memory_order_relaxed);
+
+	std::vector<std::pair<uint64_t, std::size_t>> candidates;
+	for (auto& [hash, lastUse] : lastUses)
+	{
+		uint64_t lastFrame = lastUse.load(std::memory_order_relaxed);
+		if (currentFrame - lastFrame >= minUnusedFrames)
+		{
+			candidates.emplace_back(lastFrame, hash);
+		}
+	}
+
+	size_t count = std::min(lastUses.size() - budget, candidates.size());
+	std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		evicted.push_back(candidates[i].second);
+		lastUses.erase(candidates[i].second);
+	}
+
+	evictions.fetch_add(count, std::memory_order_relaxed);
+
+	return evicted;
+}
+
+
+ResourceCache::ResourceCache(Device& device) 
+	: m_device{ device }
+{
+}
+
+
+ResourceCache::~ResourceCache()
+{
+	// The compiles insert into the cache state, they are done before it is destroyed
+	WaitForCompileJobs();
+}
+
+
+void ResourceCache::Warmup(const std::vector<uint8_t>& data)
+{
+	m_recorder.SetData(data);
+
+	m_replayer.play(*this, m_recorder, m_warmupThreadCount);
+}
+
+
+void ResourceCache::SetWarmupThreadCount(size_t threadCount)
+{
+	m_warmupThreadCount = std::max<size_t>(threadCount, 1);
+}
+
+
+const std::vector<ResourceReplayStage>& ResourceCache::GetWarmupTimings() const
+{
+	return m_replayer.get_stage_timings();
+}
+
+
+std::vector<uint8_t> ResourceCache::Serialize()
+{
+	return m_recorder.GetData();
+}
+
+
+bool ResourceCache::LoadFromFile(const filesystem::Path& path)
+{
+	auto fs = filesystem::get();
+
+	if (!fs->is_file(path))
+	{
+		LOGI("No resource cache file found at {}", path.string());
+		return false;
+	}
+
+	std::vector<uint8_t> fileData = fs->read_file_binary(path);
+
+	CacheFileReader reader{ fileData.data(), fileData.size(), CACHE_FILE_MAGIC, CACHE_FILE_VERSION };
+	ResourceCacheFileHeader header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		LOGW("Resource cache file {} is truncated, ignoring it", path.string());
+		return false;
+	}
+
+	if (reader.get_status() == CacheFileReader::Status::Unsupported)
+	{
+		LOGW("Resource cache file {} has an unsupported format version, ignoring it", path.string());
+		return false;
+	}
+
+	if (!reader.read(header) || reader.get_remaining_size() != header.pipelineCacheSize + header.recordSize)
+	{
+		LOGW("Resource cache file {} is corrupted, ignoring it", path.string());
+		return false;
+	}
+
+	const ResourceCacheFileHeader expected = MakeCacheFileHeader(m_device.get_gpu().get_properties());
+	if (header.vendorId != expected.vendorId ||
+	    header.deviceId != expected.deviceId ||
+	    header.driverVersion != expected.driverVersion ||
+	    std::memcmp(header.pipelineCacheUuid, expected.pipelineCacheUuid, VK_UUID_SIZE) != 0)
+	{
+		LOGW("Resource cache file {} was written by a different driver, ignoring it", path.string());
+		return false;
+	}
+
+	const uint8_t* payload = reader.get_data();
+
+	VkPipelineCacheCreateInfo createInfo{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	createInfo.initialDataSize = static_cast<size_t>(header.pipelineCacheSize);
+	createInfo.pInitialData    = payload;
+
+	if (m_pipelineCache == VK_NULL_HANDLE)
+	{
+		VK_CHECK(vkCreatePipelineCache(m_device.get_handle(), &createInfo, nullptr, &m_ownedPipelineCache));
+		m_pipelineCache = m_ownedPipelineCache;
+	}
+	else if (header.pipelineCacheSize > 0)
+	{
+		VkPipelineCache loadedCache{ VK_NULL_HANDLE };
+		VK_CHECK(vkCreatePipelineCache(m_device.get_handle(), &createInfo, nullptr, &loadedCache));
+		VK_CHECK(vkMergePipelineCaches(m_device.get_handle(), m_pipelineCache, 1, &loadedCache));
+		vkDestroyPipelineCache(m_device.get_handle(), loadedCache, nullptr);
+	}
+
+	const uint8_t* record = payload + header.pipelineCacheSize;
+	Warmup(std::vector<uint8_t>{ record, record + header.recordSize });
+
+	return true;
+}
+
+
+void ResourceCache::SaveToFile(const filesystem::Path& path)
+{
+	std::vector<uint8_t> pipelineCacheData;
+
+	if (m_pipelineCache != VK_NULL_HANDLE)
+	{
+		size_t size{};
+		VK_CHECK(vkGetPipelineCacheData(m_device.get_handle(), m_pipelineCache, &size, nullptr));
+
+		pipelineCacheData.resize(size);
+		VkResult result = vkGetPipelineCacheData(m_device.get_handle(), m_pipelineCache, &size, pipelineCacheData.data());
+		if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+		{
+			LOGE("Detected Vulkan error: {}, pipeline cache data not saved.", vkb::to_string(result));
+			size = 0;
+		}
+		pipelineCacheData.resize(size);
+	}
+
+	std::vector<uint8_t> recordData = m_recorder.GetData();
+
+	ResourceCacheFileHeader header = MakeCacheFileHeader(m_device.get_gpu().get_properties());
+	header.pipelineCacheSize       = pipelineCacheData.size();
+	header.recordSize              = recordData.size();
+
+	CacheFileWriter writer{ CACHE_FILE_MAGIC, CACHE_FILE_VERSION };
+	writer.append(header);
+	writer.append(pipelineCacheData.data(), pipelineCacheData.size());
+	writer.append(recordData.data(), recordData.size());
+
+	filesystem::get()->write_file(path, writer.finish());
+}
+
+
+void ResourceCache::SetPipelineCache(VkPipelineCache newPipelineCache)
+{
+	m_pipelineCache = newPipelineCache;
+}
+
+
+ShaderModule& ResourceCache::RequestShaderModule(VkShaderStageFlagBits stage, const ShaderSource& glslSource, const ShaderVariant& shaderVariant)
+{
+	PROFILE_FUNCTION();
+
+	if (auto redirect = FindShaderSourceRedirect(glslSource))
+	{
+		return BuildShaderModule(stage, *redirect, shaderVariant);
+	}
+
+	return BuildShaderModule(stage, glslSource, shaderVariant);
+}
+
+
+ShaderModule& ResourceCache::BuildShaderModule(VkShaderStageFlagBits stage, const ShaderSource& glslSource, const ShaderVariant& shaderVariant)
+{
+	std::string entryPoint{ "main" };
+
+	std::size_t hash{ 0U };
+	hash_param(hash, stage, glslSource, entryPoint, shaderVariant);
+
+	std::shared_future<void> pending;
+	{
+		std::lock_guard<std::mutex> guard(m_pendingShaderModulesMutex);
+
+		auto pendingIt = m_pendingShaderModules.find(hash);
+		if (pendingIt != m_pendingShaderModules.end())
+		{
+			pending = pendingIt->second;
+		}
+	}
+
+	// The module is cached once the compile in flight is complete, if it failed it is compiled again here to report the error.
+	// The compile may be queued behind the calling job, which then runs it.
+	if (pending.valid())
+	{
+		JobSystem::get().wait_for_future(pending);
+	}
+
+	bool created{ false };
+
+	auto& shaderModule = BuildResourceTracked(m_device, m_recorder, m_shaderModuleLock, m_state.shader_modules, created, stage, glslSource, entryPoint, shaderVariant);
+	if (created)
+	{
+		std::unique_lock<std::shared_mutex> guard(m_shaderSourcesMutex);
+		m_shaderModuleOrigins.emplace(hash, ShaderModuleOrigin{ stage, glslSource.get_filename(), glslSource.get_id(), shaderVariant });
+	}
+	return shaderModule;
+}
+
+
+std::shared_ptr<const ShaderSource> ResourceCache::FindShaderSourceRedirect(const ShaderSource& glslSource) const
+{
+	if (!m_hasShaderSourceRedirects.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+
+	std::shared_lock<std::shared_mutex> guard(m_shaderSourcesMutex);
+
+	auto redirectIt = m_shaderSourceRedirects.find(glslSource.get_id());
+	if (redirectIt == m_shaderSourceRedirects.end())
+	{
+		return nullptr;
+	}
+	return redirectIt->second;
+}
+
+
+void ResourceCache::CompileShaderModulesAsync(const std::vector<ShaderModuleRequest>& requests)
+{
+	std::string entryPoint{ "main" };
+
+	for (auto& originalRequest : requests)
+	{
+		ShaderModuleRequest request = originalRequest;
+		if (auto redirect = FindShaderSourceRedirect(request.source))
+		{
+			request.source = *redirect;
+		}
+
+		std::size_t hash{ 0U };
+		hash_param(hash, request.stage, request.source, entryPoint, request.variant);
+
+		if (FindResource(m_shaderModuleLock, m_state.shader_modules, hash))
+		{
+			continue;
+		}
+
+		std::lock_guard<std::mutex> guard(m_pendingShaderModulesMutex);
+
+		if (m_pendingShaderModules.count(hash) > 0)
+		{
+			continue;
+		}
+
+		std::future<void> compile = ScheduleCompile([this, request, hash]() {
+			std::string entryPoint{ "main" };
+			try
+			{
+				bool created{ false };
+				BuildResourceTracked(m_device, m_recorder, m_shaderModuleLock, m_state.shader_modules, created, request.stage, request.source, entryPoint, request.variant);
+				if (created)
+				{
+					std::unique_lock<std::shared_mutex> guard(m_shaderSourcesMutex);
+					m_shaderModuleOrigins.emplace(hash, ShaderModuleOrigin{ request.stage, request.source.get_filename(), request.source.get_id(), request.variant });
+				}
+			}
+			catch (const std::exception& e)
+			{
+				// Compiled again when requested, which raises the error on the requesting thread
+				LOGE("Failed to compile shader module {}: {}", request.source.get_filename(), e.what());
+			}
+
+			std::lock_guard<std::mutex> guard(m_pendingShaderModulesMutex);
+			m_pendingShaderModules.erase(hash);
+		});
+
+		m_pendingShaderModules.emplace(hash, compile.share());
+	}
+}
+
+
+void ResourceCache::ReloadShaders(const std::vector<std::string>& filenames)
+{
+	std::set<std::string> files{ filenames.begin(), filenames.end() };
+	if (files.empty())
+	{
+		std::shared_lock<std::shared_mutex> guard(m_shaderSourcesMutex);
+		for (auto& [hash, origin] : m_shaderModuleOrigins)
+		{
+			files.insert(origin.filename);
+		}
+	}
+
+	for (auto& filename : files)
+	{
+		ScheduleCompile([this, filename]() {
+			try
+			{
+				ReloadShaderFile(filename);
+			}
+			catch (const std::exception& e)
+			{
+				// The objects built from the previous source keep being used
+				LOGE("Failed to reload shader {}: {}", filename, e.what());
+			}
+		});
+	}
+}
+
+
+void ResourceCache::ReloadShaderFile(const std::string& filename)
+{
+	PROFILE_FUNCTION();
+
+	auto source = std::make_shared<const ShaderSource>(filename);
+
+	// Modules of the file compiled from another version of it
+	std::vector<std::pair<std::size_t, ShaderModuleOrigin>> staleModules;
+	{
+		std::shared_lock<std::shared_mutex> guard(m_shaderSourcesMutex);
+		for (auto& [hash, origin] : m_shaderModuleOrigins)
+		{
+			if (origin.filename == filename && origin.sourceId != source->get_id())
+			{
+				staleModules.emplace_back(hash, origin);
+			}
+		}
+	}
+
+	if (staleModules.empty())
+	{
+		return;
+	}
+
+	LOGI("Reloading shader {}", filename);
+
+	// A compile error throws before anything is swapped in
+	std::unordered_map<const ShaderModule*, ShaderModule*> replacements;
+	for (auto& [hash, origin] : staleModules)
+	{
+		if (ShaderModule* staleModule = FindResource(m_shaderModuleLock, m_state.shader_modules, hash))
+		{
+			replacements[staleModule] = &BuildShaderModule(origin.stage, *source, origin.variant);
+		}
+	}
+
+	// Points a pipeline state to the layout of the new modules, false if it doesn't use the file
+	auto replaceLayout = [this, &replacements](PipelineState& pipelineState) {
+		bool replaced{ false };
+
+		std::vector<ShaderModule*> shaderModules;
+		for (auto* shaderModule : pipelineState.get_pipeline_layout().get_shader_modules())
+		{
+			auto replacementIt = replacements.find(shaderModule);
+			if (replacementIt != replacements.end())
+			{
+				shaderModule = replacementIt->second;
+				replaced     = true;
+			}
+			shaderModules.push_back(shaderModule);
+		}
+
+		if (replaced)
+		{
+			pipelineState.set_pipeline_layout(RequestPipelineLayout(shaderModules));
+		}
+		return replaced;
+	};
+
+	std::vector<PipelineState> graphicsStates;
+	{
+		std::shared_lock<std::shared_mutex> guard(m_graphicsPipelineLock.mutex);
+		for (auto& [hash, pipeline] : m_state.graphics_pipelines)
+		{
+			graphicsStates.push_back(pipeline.get_state());
+		}
+	}
+
+	std::vector<PipelineState> computeStates;
+	{
+		std::shared_lock<std::shared_mutex> guard(m_computePipelineLock.mutex);
+		for (auto& [hash, pipeline] : m_state.compute_pipelines)
+		{
+			computeStates.push_back(pipeline.get_state());
+		}
+	}
+
+	// The replacements are cached under the keys the next requests of the pipelines compute
+	for (auto& pipelineState : graphicsStates)
+	{
+		if (replaceLayout(pipelineState))
+		{
+			RequestGraphicsPipeline(pipelineState);
+		}
+	}
+
+	for (auto& pipelineState : computeStates)
+	{
+		if (replaceLayout(pipelineState))
+		{
+			RequestComputePipeline(pipelineState);
+		}
+	}
+
+	{
+		std::unique_lock<std::shared_mutex> guard(m_shaderSourcesMutex);
+
+		for (auto& [hash, origin] : staleModules)
+		{
+			m_shaderSourceRedirects[origin.sourceId] = source;
+		}
+
+		// Sources which were redirected to a previous version of the file follow
+		for (auto& [sourceId, redirect] : m_shaderSourceRedirects)
+		{
+			if (redirect->get_filename() == filename)
+			{
+				redirect = source;
+			}
+		}
+	}
+
+	m_hasShaderSourceRedirects.store(true, std::memory_order_release);
+
+	// Command buffers recorded with the previous pipelines are recorded again
+	++m_generation;
+}
+
+
+std::future<void> ResourceCache::ScheduleCompile(std::function<void()> compile)
+{
+	return JobSystem::get().async(std::move(compile), &m_compileJobs);
+}
+
+
+void ResourceCache::WaitForCompileJobs()
+{
+	// Runs the queued compiles on the calling thread rather than blocking on them
+	JobSystem::get().wait(m_compileJobs);
+}
+
+
+void ResourceCache::WaitForShaderModules()
+{
+	std::vector<std::shared_future<void>> pending;
+	{
+		std::lock_guard<std::mutex> guard(m_pendingShaderModulesMutex);
+		for (auto& pendingIt : m_pendingShaderModules)
+		{
+			pending.push_back(pendingIt.second);
+		}
+	}
+
+	auto& jobs = JobSystem::get();
+	for (auto& compile : pending)
+	{
+		jobs.wait_for_future(compile);
+	}
+}
+
+
+PipelineLayout& ResourceCache::RequestPipelineLayout(const std::vector<ShaderModule*>& shaderModules)
+{
+	PROFILE_FUNCTION();
+
+	return BuildResource(m_device, m_recorder, m_pipelineLayoutLock, m_state.pipeline_layouts, shaderModules);
+}
+
+
+DescriptorSetLayout& ResourceCache::RequestDescriptorSetLayout(const uint32_t setIndex, const std::vector<ShaderModule*>& shaderModules, const std::vector<ShaderResource>& setResources)
+{
+	PROFILE_FUNCTION();
+
+	return BuildResource(m_device, m_recorder, m_descriptorSetLayoutLock, m_state.descriptor_set_layouts, setIndex, shaderModules, setResources);
+}
+
+
+GraphicsPipeline& ResourceCache::RequestGraphicsPipeline(PipelineState& pipelineState)
+{
+	PROFILE_FUNCTION();
+
+	std::size_t hash{ 0U };
+	bool        created{ false };
+
+	if (!m_device.uses_graphics_pipeline_libraries())
+	{
+		auto& pipeline = BuildResourceTracked(m_device, m_recorder, m_graphicsPipelineLock, m_state.graphics_pipelines, created, m_pipelineCache, pipelineState);
+		if (created)
+		{
+			hash_param(hash, m_pipelineCache, pipelineState);
+			RecordPipelineCreation(hash, "graphics", pipelineState, pipeline);
+		}
+		return pipeline;
+	}
+
+	hash_param(hash, m_pipelineCache, pipelineState);
+
+	if (GraphicsPipeline* optimized = FindResource(m_graphicsPipelineLock, m_state.optimized_graphics_pipelines, hash))
+	{
+		return *optimized;
+	}
+
+	if (GraphicsPipeline* linked = FindResource(m_graphicsPipelineLock, m_state.graphics_pipelines, hash))
+	{
+		return *linked;
+	}
+
+	m_graphicsPipelineLock.misses.fetch_add(1, std::memory_order_relaxed);
+
+	std::vector<const GraphicsPipelineLibrary*> libraries;
+	for (auto part : { VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+	                   VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT })
+	{
+		PipelineLibraryState libraryState{ part, pipelineState };
+		auto& library = BuildResourceTracked(m_device, m_recorder, m_graphicsPipelineLibraryLock, m_state.graphics_pipeline_libraries, created, m_pipelineCache, libraryState);
+		if (created)
+		{
+			std::size_t libraryHash{ 0U };
+			hash_param(libraryHash, m_pipelineCache, libraryState);
+			RecordPipelineCreation(libraryHash, "library", pipelineState, library);
+		}
+		libraries.push_back(&library);
+	}
+
+	LOGD("Linking cache object ({})", typeid(GraphicsPipeline).name());
+
+	GraphicsPipeline pipeline(m_device, m_pipelineCache, pipelineState, libraries, false);
+
+	auto writeGuard = LockExclusive(m_graphicsPipelineLock);
+
+	auto [resIt, inserted] = m_state.graphics_pipelines.emplace(hash, std::move(pipeline));
+	m_graphicsPipelineLock.Track(hash);
+
+	if (!inserted)
+	{
+		return resIt->second;
+	}
+
+	// Recorded like a monolithic pipeline, the replay requests it again
+	RecordHelper<GraphicsPipeline, VkPipelineCache, PipelineState> recordHelper;
+
+	size_t index = recordHelper.record(m_recorder, m_pipelineCache, pipelineState);
+	recordHelper.index(m_recorder, index, resIt->second);
+
+	RecordPipelineCreation(hash, "linked", pipelineState, resIt->second);
+
+	if (m_optimizeLinkedPipelines)
+	{
+		// The fast-linked pipeline stays in the cache, command buffers in flight may still use it
+		ScheduleCompile([this, pipelineState, libraries, hash]() mutable {
+			try
+			{
+				GraphicsPipeline optimized(m_device, m_pipelineCache, pipelineState, libraries, true);
+
+				auto writeGuard = LockExclusive(m_graphicsPipelineLock);
+
+				auto [optimizedIt, optimizedInserted] = m_state.optimized_graphics_pipelines.emplace(hash, std::move(optimized));
+				m_graphicsPipelineLock.Track(hash);
+				if (optimizedInserted)
+				{
+					RecordPipelineCreation(hash, "optimized", pipelineState, optimizedIt->second);
+				}
+			}
+			catch (const std::exception& e)
+			{
+				// The fast-linked pipeline keeps being used
+				LOGW("Failed to optimize a linked graphics pipeline: {}", e.what());
+			}
+		});
+	}
+
+	return resIt->second;
+}
+
+
+void ResourceCache::SetOptimizeLinkedPipelines(bool enabled)
+{
+	m_optimizeLinkedPipelines = enabled;
+}
+
+
+ComputePipeline& ResourceCache::RequestComputePipeline(PipelineState& pipelineState)
+{
+	PROFILE_FUNCTION();
+
+	bool created{ false };
+
+	auto& pipeline = BuildResourceTracked(m_device, m_recorder, m_computePipelineLock, m_state.compute_pipelines, created, m_pipelineCache, pipelineState);
+	if (created)
+	{
+		std::size_t hash{ 0U };
+		hash_param(hash, m_pipelineCache, pipelineState);
+		RecordPipelineCreation(hash, "compute", pipelineState, pipeline);
+	}
+
+	return pipeline;
+}
+
+
+ShaderObject& ResourceCache::RequestShaderObject(const ShaderModule& shaderModule, VkShaderStageFlags nextStages, const PipelineLayout& pipelineLayout, const SpecializationConstantState& specializationConstantState)
+{
+	PROFILE_FUNCTION();
+
+	return BuildResource(m_device, m_recorder, m_shaderObjectLock, m_state.shader_objects, shaderModule, nextStages, pipelineLayout, specializationConstantState);
+}
+
+
+DescriptorSet& ResourceCache::RequestDescriptorSet(DescriptorSetLayout& descriptorSetLayout, const BindingMap<VkDescriptorBufferInfo>& bufferInfos, const BindingMap<VkDescriptorImageInfo>& imageInfos)
+{
+	PROFILE_FUNCTION();
+
+	auto& descriptorPool = RequestDescriptorPool(descriptorSetLayout);
+
+	std::size_t key{ 0U };
+	hash_param(key, descriptorSetLayout, descriptorPool, bufferInfos, imageInfos);
+
+	if (DescriptorSet* descriptorSet = FindResource(m_descriptorSetLock, m_state.descriptor_sets, key))
+	{
+		return *descriptorSet;
+	}
+
+	auto& descriptorSet = RequestResource(m_device, m_recorder, m_descriptorSetLock, m_state.descriptor_sets, descriptorSetLayout, descriptorPool, bufferInfos, imageInfos);
+
+	// Only new sets are indexed, so hits don't take the lock exclusively
+	std::unique_lock<std::shared_mutex> guard(m_descriptorSetLock.mutex);
+	IndexImageViews(key, imageInfos);
+
+	// Sets are allocated from the pool under the lock
+	RecordDescriptorSetPeak(descriptorSetLayout, descriptorPool.GetPeakSetCount());
+
+	return descriptorSet;
+}
+
+
+DescriptorPool& ResourceCache::RequestDescriptorPool(const DescriptorSetLayout& descriptorSetLayout)
+{
+	std::size_t hash{ 0U };
+	hash_param(hash, descriptorSetLayout);
+
+	if (DescriptorPool* descriptorPool = FindResource(m_descriptorPoolLock, m_state.descriptor_pools, hash))
+	{
+		return *descriptorPool;
+	}
+
+	auto writeGuard = LockExclusive(m_descriptorPoolLock);
+
+	m_descriptorPoolLock.misses.fetch_add(1, std::memory_order_relaxed);
+
+	// Another thread may have created the pool in between
+	size_t poolCount     = m_state.descriptor_pools.size();
+	auto& descriptorPool = request_resource_with_hash(m_device, &m_recorder, m_state.descriptor_pools, hash, descriptorSetLayout);
+	m_descriptorPoolLock.Track(hash);
+
+	if (m_state.descriptor_pools.size() != poolCount)
+	{
+		descriptorPool.SetFreeDescriptorSets(m_budget.descriptor_sets > 0);
+		descriptorPool.Reserve(GetDescriptorSetPeak(descriptorSetLayout));
+	}
+
+	return descriptorPool;
+}
+
+
+void ResourceCache::RecordDescriptorSetPeak(const DescriptorSetLayout& descriptorSetLayout, uint32_t setCount)
 {
+	std::lock_guard<std::mutex> guard(m_descriptorSetPeaksMutex);
+
+	auto& peak = m_descriptorSetPeaks[&descriptorSetLayout];
+	if (setCount > peak)
+	{
+		peak = setCount;
+		m_recorder.RegisterDescriptorSetPeak(descriptorSetLayout, setCount);
+	}
 }
 
 
-void ResourceCache::Warmup(const std::vector<uint8_t>& data)
+uint32_t ResourceCache::GetDescriptorSetPeak(const DescriptorSetLayout& descriptorSetLayout) const
 {
-	m_recorder.SetData(data);
+	std::lock_guard<std::mutex> guard(m_descriptorSetPeaksMutex);
 
-	m_replayer.play(*this, m_recorder);
+	auto it = m_descriptorSetPeaks.find(&descriptorSetLayout);
+	return it != m_descriptorSetPeaks.end() ? it->second : 0;
 }
 
 
-std::vector<uint8_t> ResourceCache::Serialize()
+void ResourceCache::IndexImageViews(std::size_t key, const BindingMap<VkDescriptorImageInfo>& imageInfos)
 {
-	return m_recorder.GetData();
+	for (auto& [binding, array] : imageInfos)
+	{
+		for (auto& [arrayElement, imageInfo] : array)
+		{
+			if (imageInfo.imageView != VK_NULL_HANDLE)
+			{
+				m_imageViewDescriptorSets[imageInfo.imageView].insert(key);
+			}
+		}
+	}
 }
 
 
-void ResourceCache::SetPipelineCache(VkPipelineCache newPipelineCache)
+RenderPass& ResourceCache::RequestRenderPass(const std::vector<Attachment>& attachments, const std::vector<LoadStoreInfo>& loadStoreInfos, const std::vector<SubpassInfo> &subpasses)
 {
-	m_pipelineCache = newPipelineCache;
+	PROFILE_FUNCTION();
+
+	return BuildResource(m_device, m_recorder, m_renderPassLock, m_state.render_passes, attachments, loadStoreInfos, subpasses);
 }
 
 
-ShaderModule& ResourceCache::RequestShaderModule(VkShaderStageFlagBits stage, const ShaderSource& glslSource, const ShaderVariant& shaderVariant)
+Framebuffer& ResourceCache::RequestFramebuffer(const RenderTarget& renderTarget, const RenderPass& renderPass)
 {
-	std::string entryPoint{ "main" };
-	return RequestResource(m_device, m_recorder, m_shaderModuleMutex, m_state.shader_modules, stage, glslSource, entryPoint, shaderVariant);
+	PROFILE_FUNCTION();
+
+	return RequestResource(m_device, m_recorder, m_framebufferLock, m_state.framebuffers, renderTarget, renderPass);
 }
 
 
-PipelineLayout& ResourceCache::RequestPipelineLayout(const std::vector<ShaderModule*>& shaderModules)
+core::Sampler& ResourceCache::RequestSampler(const VkSamplerCreateInfo& info)
 {
-	return RequestResource(m_device, m_recorder, m_pipelineLayoutMutex, m_state.pipeline_layouts, shaderModules);
+	assert(info.pNext == nullptr && "Sampler create infos with a pNext chain can't be cached");
+
+	return RequestResource(m_device, m_recorder, m_samplerLock, m_state.samplers, info);
 }
 
 
-DescriptorSetLayout& ResourceCache::RequestDescriptorSetLayout(const uint32_t setIndex, const std::vector<ShaderModule*>& shaderModules, const std::vector<ShaderResource>& setResources)
+core::ImageView& ResourceCache::RequestImageView(core::Image& image, VkImageViewType viewType, VkFormat format,
+                                                 uint32_t baseMipLevel, uint32_t baseArrayLayer, uint32_t mipLevelCount, uint32_t arrayLayerCount)
 {
-	return RequestResource(m_device, m_recorder, m_descriptorSetLayoutMutex, m_state.descriptor_set_layouts, setIndex, shaderModules, setResources);
-}
+	std::size_t key{ 0U };
+	hash_param(key, image, viewType, format, baseMipLevel, baseArrayLayer, mipLevelCount, arrayLayerCount);
 
+	if (core::ImageView* imageView = FindResource(m_imageViewLock, m_state.image_views, key))
+	{
+		return *imageView;
+	}
 
-GraphicsPipeline& ResourceCache::RequestGraphicsPipeline(PipelineState& pipelineState)
-{
-	return RequestResource(m_device, m_recorder, m_graphicsPipelineMutex, m_state.graphics_pipelines, m_pipelineCache, pipelineState);
-}
+	auto writeGuard = LockExclusive(m_imageViewLock);
 
+	m_imageViewLock.misses.fetch_add(1, std::memory_order_relaxed);
 
-ComputePipeline& ResourceCache::RequestComputePipeline(PipelineState& pipelineState)
-{
-	return RequestResource(m_device, m_recorder, m_computePipelineMutex, m_state.compute_pipelines, m_pipelineCache, pipelineState);
-}
+	// Another thread may have created the view in between, views are built from their image rather than the device
+	auto [it, created] = m_state.image_views.try_emplace(key, image, viewType, format, baseMipLevel, baseArrayLayer, mipLevelCount, arrayLayerCount);
 
+	if (created)
+	{
+		m_imageViewLock.Track(key);
+		m_imageViewKeys[image.get_handle()].push_back(key);
+	}
 
-DescriptorSet& ResourceCache::RequestDescriptorSet(DescriptorSetLayout& descriptorSetLayout, const BindingMap<VkDescriptorBufferInfo>& bufferInfos, const BindingMap<VkDescriptorImageInfo>& imageInfos)
-{
-	auto& descriptorPool = RequestResource(m_device, m_recorder, m_descriptorSetMutex, m_state.descriptor_pools, descriptorSetLayout);
-	return RequestResource(m_device, m_recorder, m_descriptorSetMutex, m_state.descriptor_sets, descriptorSetLayout, descriptorPool, bufferInfos, imageInfos);
+	return it->second;
 }
 
 
-RenderPass& ResourceCache::RequestRenderPass(const std::vector<Attachment>& attachments, const std::vector<LoadStoreInfo>& loadStoreInfos, const std::vector<SubpassInfo> &subpasses)
+void ResourceCache::ReleaseImageViews(const core::Image& image)
 {
-	return RequestResource(m_device, m_recorder, m_renderPassMutex, m_state.render_passes, attachments, loadStoreInfos, subpasses);
-}
+	std::unique_lock<std::shared_mutex> guard(m_imageViewLock.mutex);
 
+	auto it = m_imageViewKeys.find(image.get_handle());
+	if (it == m_imageViewKeys.end())
+	{
+		return;
+	}
 
-Framebuffer& ResourceCache::RequestFramebuffer(const RenderTarget& renderTarget, const RenderPass& renderPass)
-{
-	return RequestResource(m_device, m_recorder, m_framebufferMutex, m_state.framebuffers, renderTarget, renderPass);
+	// The image is being destroyed, so the GPU is done with its views
+	for (std::size_t key : it->second)
+	{
+		m_state.image_views.erase(key);
+	}
+
+	m_imageViewKeys.erase(it);
 }
 
 
 void ResourceCache::ClearPipelines()
 {
-	m_state.graphics_pipelines.clear();
-	m_state.compute_pipelines.clear();
+	// Waits for the pipelines optimized in the background
+	WaitForCompileJobs();
+
+	{
+		std::unique_lock<std::shared_mutex> guard(m_graphicsPipelineLock.mutex);
+		m_state.optimized_graphics_pipelines.clear();
+		m_state.graphics_pipelines.clear();
+		m_graphicsPipelineLock.lastUses.clear();
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(m_graphicsPipelineLibraryLock.mutex);
+		m_state.graphics_pipeline_libraries.clear();
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(m_computePipelineLock.mutex);
+		m_state.compute_pipelines.clear();
+		m_computePipelineLock.lastUses.clear();
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(m_shaderObjectLock.mutex);
+		m_state.shader_objects.clear();
+	}
+
+	++m_generation;
 }
 
 
 void ResourceCache::UpdateDescriptorSets(const std::vector<core::ImageView>& oldViews, const std::vector<core::ImageView>& newViews)
 {
+	std::unique_lock<std::shared_mutex> guard(m_descriptorSetLock.mutex);
+
 	// Find descriptor sets referring to the old image view
 	std::vector<VkWriteDescriptorSet> setUpdates;
 	std::set<size_t> matches;
@@ -133,8 +1157,21 @@ void ResourceCache::UpdateDescriptorSets(const std::vector<core::ImageView>& old
 		auto& oldView = oldViews[i];
 		auto& newView = newViews[i];
 
-		for (auto& [key, descriptorSet] : m_state.descriptor_sets)
+		auto indexIt = m_imageViewDescriptorSets.find(oldView.get_handle());
+		if (indexIt == m_imageViewDescriptorSets.end())
 		{
+			continue;
+		}
+
+		for (auto key : indexIt->second)
+		{
+			auto setIt = m_state.descriptor_sets.find(key);
+			if (setIt == m_state.descriptor_sets.end())
+			{
+				continue;
+			}
+
+			auto& descriptorSet = setIt->second;
 			auto& imageInfos = descriptorSet.GetImageInfos();
 
 			for (auto& [binding, array] : imageInfos)
@@ -173,11 +1210,15 @@ void ResourceCache::UpdateDescriptorSets(const std::vector<core::ImageView>& old
 				}
 			}
 		}
+
+		// The sets referring to the old view refer to the new one now, they are indexed again below
+		m_imageViewDescriptorSets.erase(indexIt);
 	}
 
 	if (!setUpdates.empty())
 	{
 		vkUpdateDescriptorSets(m_device.get_handle(), to_u32(setUpdates.size()), setUpdates.data(), 0, nullptr);
+		++m_generation;
 	}
 
 	// Delete old entries (moved out descriptor sets)
@@ -193,26 +1234,285 @@ void ResourceCache::UpdateDescriptorSets(const std::vector<core::ImageView>& old
 		hash_param(newKey, descriptorSet.GetLayout(), descriptorSet.GetBufferInfos(), descriptorSet.GetImageInfos());
 
 		// Add (key, resource) to the cache
-		m_state.descriptor_sets.emplace(newKey, std::move(descriptorSet));
+		auto [newIt, inserted] = m_state.descriptor_sets.emplace(newKey, std::move(descriptorSet));
+		m_descriptorSetLock.lastUses.erase(match);
+		if (inserted)
+		{
+			IndexImageViews(newKey, newIt->second.GetImageInfos());
+			m_descriptorSetLock.Track(newKey);
+		}
+	}
+}
+
+
+void ResourceCache::UpdateDescriptorSets(const std::vector<VkBuffer>& oldBuffers, const std::vector<VkBuffer>& newBuffers)
+{
+	std::unique_lock<std::shared_mutex> guard(m_descriptorSetLock.mutex);
+
+	// Find descriptor sets referring to the old buffers
+	std::vector<VkWriteDescriptorSet> setUpdates;
+	std::set<size_t> matches;
+
+	for (size_t i = 0; i < oldBuffers.size(); ++i)
+	{
+		for (auto& [key, descriptorSet] : m_state.descriptor_sets)
+		{
+			auto& bufferInfos = descriptorSet.GetBufferInfos();
+
+			for (auto& [binding, array] : bufferInfos)
+			{
+				for (auto& [arrayElement, bufferInfo] : array)
+				{
+					if (bufferInfo.buffer == oldBuffers[i])
+					{
+						// Save key to remove old descriptor set
+						matches.insert(key);
+
+						// Update buffer info with new buffer
+						bufferInfo.buffer = newBuffers[i];
+
+						if (auto binding_info = descriptorSet.GetLayout().GetLayoutBinding(binding))
+						{
+							VkWriteDescriptorSet write_descriptor_set{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+							write_descriptor_set.dstBinding      = binding;
+							write_descriptor_set.descriptorType  = binding_info->descriptorType;
+							write_descriptor_set.pBufferInfo     = &bufferInfo;
+							write_descriptor_set.dstSet          = descriptorSet.GetHandle();
+							write_descriptor_set.dstArrayElement = arrayElement;
+							write_descriptor_set.descriptorCount = 1;
+
+							setUpdates.push_back(write_descriptor_set);
+						}
+						else
+						{
+							LOGE("Shader layout set does not use buffer binding at #{}", binding);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if (!setUpdates.empty())
+	{
+		vkUpdateDescriptorSets(m_device.get_handle(), to_u32(setUpdates.size()), setUpdates.data(), 0, nullptr);
+		++m_generation;
+	}
+
+	// Rehash the updated descriptor sets
+	for (auto& match : matches)
+	{
+		auto it = m_state.descriptor_sets.find(match);
+		auto descriptorSet = std::move(it->second);
+		m_state.descriptor_sets.erase(match);
+
+		size_t newKey = 0U;
+		hash_param(newKey, descriptorSet.GetLayout(), descriptorSet.GetBufferInfos(), descriptorSet.GetImageInfos());
+
+		auto [newIt, inserted] = m_state.descriptor_sets.emplace(newKey, std::move(descriptorSet));
+		m_descriptorSetLock.lastUses.erase(match);
+		if (inserted)
+		{
+			IndexImageViews(newKey, newIt->second.GetImageInfos());
+			m_descriptorSetLock.Track(newKey);
+		}
 	}
 }
 
 
 void ResourceCache::ClearFramebuffers()
 {
+	std::unique_lock<std::shared_mutex> guard(m_framebufferLock.mutex);
+
+	// Frames in flight may still use them
+	m_device.get_deferred_destruction_queue().retire(std::move(m_state.framebuffers));
 	m_state.framebuffers.clear();
+	m_framebufferLock.lastUses.clear();
+
+	++m_generation;
 }
 
 
 void ResourceCache::Clear()
 {
+	WaitForCompileJobs();
+
 	m_state.shader_modules.clear();
+	m_shaderModuleOrigins.clear();
 	m_state.pipeline_layouts.clear();
 	m_state.descriptor_sets.clear();
+	m_imageViewDescriptorSets.clear();
+	m_descriptorSetLock.lastUses.clear();
+	m_evictedDescriptorSets.clear();
 	m_state.descriptor_set_layouts.clear();
+	{
+		std::lock_guard<std::mutex> guard(m_descriptorSetPeaksMutex);
+		m_descriptorSetPeaks.clear();
+	}
 	m_state.render_passes.clear();
 	ClearPipelines();
 	ClearFramebuffers();
+	m_state.samplers.clear();
+	{
+		std::unique_lock<std::shared_mutex> guard(m_imageViewLock.mutex);
+
+		// The images outlive their cached views, which mustn't be updated when they move
+		for (auto& [key, imageView] : m_state.image_views)
+		{
+			const_cast<core::Image&>(imageView.get_image()).get_views().erase(&imageView);
+		}
+		m_state.image_views.clear();
+		m_imageViewKeys.clear();
+	}
+
+	// The owned pipeline cache has to go before the device, which destroys the resource cache after vkDestroyDevice
+	if (m_ownedPipelineCache != VK_NULL_HANDLE)
+	{
+		if (m_pipelineCache == m_ownedPipelineCache)
+		{
+			m_pipelineCache = VK_NULL_HANDLE;
+		}
+		vkDestroyPipelineCache(m_device.get_handle(), m_ownedPipelineCache, nullptr);
+		m_ownedPipelineCache = VK_NULL_HANDLE;
+	}
+}
+
+
+void ResourceCache::SetBudget(const ResourceCacheBudget& budget)
+{
+	SetResourceBudget(m_descriptorSetLock, budget.descriptor_sets, { &m_state.descriptor_sets });
+	SetResourceBudget(m_framebufferLock, budget.framebuffers, { &m_state.framebuffers });
+	SetResourceBudget(m_graphicsPipelineLock, budget.graphics_pipelines, { &m_state.graphics_pipelines, &m_state.optimized_graphics_pipelines });
+	SetResourceBudget(m_computePipelineLock, budget.compute_pipelines, { &m_state.compute_pipelines });
+
+	{
+		// Only the pools created from now on allow freeing their sets
+		auto writeGuard = LockExclusive(m_descriptorPoolLock);
+		for (auto& descriptorPoolIt : m_state.descriptor_pools)
+		{
+			descriptorPoolIt.second.SetFreeDescriptorSets(budget.descriptor_sets > 0);
+		}
+
+		m_budget = budget;
+	}
+}
+
+
+const ResourceCacheBudget& ResourceCache::GetBudget() const
+{
+	return m_budget;
+}
+
+
+void ResourceCache::Trim()
+{
+	PROFILE_FUNCTION();
+
+	bool evicted{ false };
+
+	{
+		std::unique_lock<std::shared_mutex> guard(m_descriptorSetLock.mutex);
+
+		ReleaseEvictedDescriptorSets();
+
+		auto hashes = m_descriptorSetLock.CollectEvictions(m_budget.min_unused_frames);
+		if (!hashes.empty())
+		{
+			// The handles go back to their pool once the submissions in flight are complete
+			EvictedDescriptorSets evictedSets;
+			evictedSets.released = std::make_shared<std::atomic<bool>>(false);
+
+			for (auto hash : hashes)
+			{
+				auto setIt = m_state.descriptor_sets.find(hash);
+				if (setIt == m_state.descriptor_sets.end())
+				{
+					continue;
+				}
+
+				for (auto& [binding, array] : setIt->second.GetImageInfos())
+				{
+					for (auto& [arrayElement, imageInfo] : array)
+					{
+						auto indexIt = m_imageViewDescriptorSets.find(imageInfo.imageView);
+						if (indexIt != m_imageViewDescriptorSets.end())
+						{
+							indexIt->second.erase(hash);
+							if (indexIt->second.empty())
+							{
+								m_imageViewDescriptorSets.erase(indexIt);
+							}
+						}
+					}
+				}
+
+				evictedSets.sets.push_back(std::move(setIt->second));
+				m_state.descriptor_sets.erase(setIt);
+			}
+
+			m_device.get_deferred_destruction_queue().retire(ReleaseMarker{ evictedSets.released });
+			m_evictedDescriptorSets.push_back(std::move(evictedSets));
+			evicted = true;
+		}
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(m_framebufferLock.mutex);
+
+		auto hashes = m_framebufferLock.CollectEvictions(m_budget.min_unused_frames);
+		RetireResources(m_device, hashes, m_state.framebuffers);
+		evicted |= !hashes.empty();
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(m_graphicsPipelineLock.mutex);
+
+		// A pipeline being optimized in the background is tracked again once inserted
+		auto hashes = m_graphicsPipelineLock.CollectEvictions(m_budget.min_unused_frames);
+		RetireResources(m_device, hashes, m_state.graphics_pipelines);
+		RetireResources(m_device, hashes, m_state.optimized_graphics_pipelines);
+		evicted |= !hashes.empty();
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(m_computePipelineLock.mutex);
+
+		auto hashes = m_computePipelineLock.CollectEvictions(m_budget.min_unused_frames);
+		RetireResources(m_device, hashes, m_state.compute_pipelines);
+		evicted |= !hashes.empty();
+	}
+
+	if (evicted)
+	{
+		++m_generation;
+	}
+
+	for (auto* resourceLock : { &m_descriptorSetLock, &m_framebufferLock, &m_graphicsPipelineLock, &m_computePipelineLock })
+	{
+		resourceLock->frame.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+
+void ResourceCache::ReleaseEvictedDescriptorSets()
+{
+	for (auto evictedIt = m_evictedDescriptorSets.begin(); evictedIt != m_evictedDescriptorSets.end();)
+	{
+		if (!evictedIt->released->load(std::memory_order_acquire))
+		{
+			++evictedIt;
+			continue;
+		}
+
+		for (auto& descriptorSet : evictedIt->sets)
+		{
+			descriptorSet.Free();
+		}
+		evictedIt = m_evictedDescriptorSets.erase(evictedIt);
+	}
+}
+
+
+uint64_t ResourceCache::GetGeneration() const
+{
+	return m_generation;
 }
 
 
@@ -221,4 +1521,129 @@ const ResourceCacheState& ResourceCache::GetInternalState() const
 	return m_state;
 }
 
+
+ResourceCacheStats ResourceCache::GetStats() const
+{
+	ResourceCacheStats stats;
+	stats.shader_modules              = m_shaderModuleLock.GetCounters();
+	stats.pipeline_layouts            = m_pipelineLayoutLock.GetCounters();
+	stats.descriptor_set_layouts      = m_descriptorSetLayoutLock.GetCounters();
+	stats.render_passes               = m_renderPassLock.GetCounters();
+	stats.graphics_pipelines          = m_graphicsPipelineLock.GetCounters();
+	stats.graphics_pipeline_libraries = m_graphicsPipelineLibraryLock.GetCounters();
+	stats.compute_pipelines           = m_computePipelineLock.GetCounters();
+	stats.shader_objects              = m_shaderObjectLock.GetCounters();
+	stats.descriptor_sets             = m_descriptorSetLock.GetCounters();
+	stats.framebuffers                = m_framebufferLock.GetCounters();
+	stats.samplers                    = m_samplerLock.GetCounters();
+	stats.image_views                 = m_imageViewLock.GetCounters();
+	return stats;
+}
+
+
+void ResourceCache::ResetStats()
+{
+	m_shaderModuleLock.ResetCounters();
+	m_pipelineLayoutLock.ResetCounters();
+	m_descriptorSetLayoutLock.ResetCounters();
+	m_renderPassLock.ResetCounters();
+	m_graphicsPipelineLock.ResetCounters();
+	m_graphicsPipelineLibraryLock.ResetCounters();
+	m_computePipelineLock.ResetCounters();
+	m_shaderObjectLock.ResetCounters();
+	m_descriptorSetLock.ResetCounters();
+	m_framebufferLock.ResetCounters();
+	m_samplerLock.ResetCounters();
+	m_imageViewLock.ResetCounters();
+}
+
+
+std::vector<PipelineCreationRecord> ResourceCache::GetPipelineCreations() const
+{
+	std::vector<PipelineCreationRecord> creations;
+	{
+		std::lock_guard<std::mutex> guard(m_pipelineCreationsMutex);
+		creations = m_pipelineCreations;
+	}
+
+	std::stable_sort(creations.begin(), creations.end(), [](const PipelineCreationRecord& a, const PipelineCreationRecord& b) {
+		return a.feedback.duration_ms > b.feedback.duration_ms;
+	});
+
+	return creations;
+}
+
+
+PipelineCreationTotals ResourceCache::GetPipelineCreationTotals() const
+{
+	std::lock_guard<std::mutex> guard(m_pipelineCreationsMutex);
+	return m_pipelineCreationTotals;
+}
+
+
+void ResourceCache::WritePipelineCreationReport(const filesystem::Path& path) const
+{
+	auto creations = GetPipelineCreations();
+	auto totals    = GetPipelineCreationTotals();
+
+	if (creations.empty())
+	{
+		return;
+	}
+
+	LOGI("Created {} pipelines in {:.2f} ms, {} found in the pipeline cache", totals.pipelines, totals.duration_ms, totals.cache_hits);
+
+	// The slowest ones are the likeliest to cause hitches
+	const size_t logCount = std::min<size_t>(creations.size(), 10);
+	for (size_t i = 0; i < logCount; ++i)
+	{
+		auto& creation = creations[i];
+		LOGI("  {:8.2f} ms {:9} {:016x} {}", creation.feedback.duration_ms, creation.kind, creation.hash, creation.shaders);
+	}
+
+	std::string report = "duration_ms,cache_hit,kind,hash,shaders\n";
+	for (auto& creation : creations)
+	{
+		// Without creation feedback the cache hits are unknown
+		const char* cacheHit = creation.feedback.reported ? (creation.feedback.cache_hit ? "yes" : "no") : "unknown";
+
+		report += fmt::format("{:.3f},{},{},{:016x},\"{}\"\n", creation.feedback.duration_ms, cacheHit, creation.kind, creation.hash, creation.shaders);
+	}
+
+	try
+	{
+		filesystem::get()->write_file(path, report);
+	}
+	catch (const std::exception& e)
+	{
+		LOGW("Failed to write the pipeline creation report {}: {}", path.string(), e.what());
+	}
+}
+
+
+void ResourceCache::RecordPipelineCreation(std::size_t hash, const char* kind, const PipelineState& pipelineState, const Pipeline& pipeline)
+{
+	PipelineCreationRecord creation;
+	creation.hash     = hash;
+	creation.kind     = kind;
+	creation.feedback = pipeline.get_creation_feedback();
+
+	for (auto* shaderModule : pipelineState.get_pipeline_layout().get_shader_modules())
+	{
+		if (!creation.shaders.empty())
+		{
+			creation.shaders += ' ';
+		}
+		creation.shaders += shaderModule->get_debug_name();
+	}
+
+	std::lock_guard<std::mutex> guard(m_pipelineCreationsMutex);
+
+	m_pipelineCreationTotals.pipelines++;
+	m_pipelineCreationTotals.cache_hits += creation.feedback.cache_hit ? 1 : 0;
+	m_pipelineCreationTotals.duration_ms += creation.feedback.duration_ms;
+
+	m_pipelineCreations.push_back(std::move(creation));
+}
+
 } // namespace vkb
\ No newline at end of file
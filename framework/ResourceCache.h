@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2020, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -17,8 +17,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common/helpers.h"
@@ -26,7 +32,12 @@
 #include "core/DescriptorSet.h"
 #include "core/DescriptorSetLayout.h"
 #include "core/framebuffer.h"
+#include "core/image_view.h"
 #include "core/pipeline.h"
+#include "core/sampler.h"
+#include "core/shader_object.h"
+#include "core/util/job_system.hpp"
+#include "filesystem/filesystem.hpp"
 #include "ResourceRecord.h"
 #include "resource_replay.h"
 
@@ -34,10 +45,6 @@ namespace vkb
 {
 class Device;
 
-namespace core
-{
-class ImageView;
-}
 
 /**
  * @brief Struct to hold the internal state of the Resource Cache
@@ -57,11 +64,182 @@ struct ResourceCacheState
 
 	std::unordered_map<std::size_t, GraphicsPipeline> graphics_pipelines;
 
+	std::unordered_map<std::size_t, GraphicsPipelineLibrary> graphics_pipeline_libraries;
+
+	/// Link time optimized pipelines, replacing the fast-linked ones of graphics_pipelines with the same hash
+	std::unordered_map<std::size_t, GraphicsPipeline> optimized_graphics_pipelines;
+
 	std::unordered_map<std::size_t, ComputePipeline> compute_pipelines;
 
+	std::unordered_map<std::size_t, ShaderObject> shader_objects;
+
 	std::unordered_map<std::size_t, DescriptorSet> descriptor_sets;
 
 	std::unordered_map<std::size_t, Framebuffer> framebuffers;
+
+	std::unordered_map<std::size_t, core::Sampler> samplers;
+
+	std::unordered_map<std::size_t, core::ImageView> image_views;
+};
+
+/**
+ * @brief Lookup counters of a single resource type in the Resource Cache
+ *
+ */
+struct ResourceCacheCounters
+{
+	uint64_t hits{ 0 };
+
+	uint64_t misses{ 0 };
+
+	/// Number of lookups which found the resource lock held by another thread and had to wait
+	uint64_t contentions{ 0 };
+
+	/// Number of objects destroyed by ResourceCache::Trim to stay within the budget of their type
+	uint64_t evictions{ 0 };
+};
+
+/**
+ * @brief Snapshot of the lookup counters of every resource type in the Resource Cache
+ *
+ */
+struct ResourceCacheStats
+{
+	ResourceCacheCounters shader_modules;
+
+	ResourceCacheCounters pipeline_layouts;
+
+	ResourceCacheCounters descriptor_set_layouts;
+
+	ResourceCacheCounters render_passes;
+
+	ResourceCacheCounters graphics_pipelines;
+
+	ResourceCacheCounters graphics_pipeline_libraries;
+
+	ResourceCacheCounters compute_pipelines;
+
+	ResourceCacheCounters shader_objects;
+
+	/// Also counts the descriptor pool lookup done for every descriptor set request
+	ResourceCacheCounters descriptor_sets;
+
+	ResourceCacheCounters framebuffers;
+
+	ResourceCacheCounters samplers;
+
+	ResourceCacheCounters image_views;
+};
+
+/**
+ * @brief A pipeline created by the Resource Cache, see ResourceCache::GetPipelineCreations
+ *
+ */
+struct PipelineCreationRecord
+{
+	/// Hash of the requested pipeline state
+	std::size_t hash{ 0 };
+
+	/// "graphics", "compute", "library", "linked" or "optimized"
+	const char* kind{ nullptr };
+
+	/// Debug names of the shader modules of the pipeline layout
+	std::string shaders;
+
+	PipelineCreationFeedback feedback;
+};
+
+/**
+ * @brief Totals of the pipelines created by the Resource Cache
+ *
+ */
+struct PipelineCreationTotals
+{
+	uint64_t pipelines{ 0 };
+
+	/// Pipelines the driver found in the VkPipelineCache, only known with VK_EXT_pipeline_creation_feedback
+	uint64_t cache_hits{ 0 };
+
+	double duration_ms{ 0.0 };
+};
+
+/**
+ * @brief A shader module to compile ahead of its first request, see ResourceCache::CompileShaderModulesAsync
+ *
+ */
+struct ShaderModuleRequest
+{
+	VkShaderStageFlagBits stage;
+
+	ShaderSource source;
+
+	ShaderVariant variant;
+};
+
+/**
+ * @brief Number of objects the Resource Cache keeps of the types which churn with the content of a scene
+ * A budget of 0 leaves the type unbounded, the default. See ResourceCache::Trim
+ */
+struct ResourceCacheBudget
+{
+	size_t descriptor_sets{ 0 };
+
+	size_t framebuffers{ 0 };
+
+	/// Counts a linked pipeline and the pipeline optimized from it once
+	size_t graphics_pipelines{ 0 };
+
+	size_t compute_pipelines{ 0 };
+
+	/// Frames an object stays cached after its last request, even above the budget of its type
+	uint32_t min_unused_frames{ 3 };
+};
+
+/**
+ * @brief Reader-writer lock guarding one resource type of the Resource Cache.
+ * Cache hits only take the lock in shared mode, so threads recording command buffers
+ * in parallel do not serialize on lookups. The lock is only taken exclusively when
+ * a resource has to be created.
+ */
+struct ResourceCacheLock
+{
+	std::shared_mutex mutex;
+
+	std::atomic<uint64_t> hits{ 0 };
+
+	std::atomic<uint64_t> misses{ 0 };
+
+	std::atomic<uint64_t> contentions{ 0 };
+
+	std::atomic<uint64_t> evictions{ 0 };
+
+	/// Maximum number of cached objects, 0 if the type is unbounded and its requests aren't aged
+	size_t budget{ 0 };
+
+	/// Frame the requests are stamped with, advanced by ResourceCache::Trim
+	std::atomic<uint64_t> frame{ 0 };
+
+	/// Frame of the last request of each cached object, only tracked with a budget
+	std::unordered_map<std::size_t, std::atomic<uint64_t>> lastUses;
+
+	/// Objects being built without the lock, ready once their build is inserted or failed
+	/// Other requests for them wait for the build rather than building a copy.
+	std::unordered_map<std::size_t, std::shared_future<void>> builds;
+
+	ResourceCacheCounters GetCounters() const;
+
+	void ResetCounters();
+
+	/// @brief Stamps a cached object with the current frame, with the lock held in any mode
+	void Touch(std::size_t hash);
+
+	/// @brief Starts aging a new cached object, with the lock held exclusively
+	void Track(std::size_t hash);
+
+	/// @brief Picks the least recently requested objects above the budget, which stop being aged
+	/// @note Objects requested in the last minUnusedFrames frames are never picked. Callers must hold the lock exclusively
+	/// @return The hashes of the objects to evict
+	std::vector<std::size_t> CollectEvictions(uint32_t minUnusedFrames);
 };
 
 /**
@@ -72,9 +250,13 @@ struct ResourceCacheState
  * Some objects may need building if they are not found in the cache.
  *
  * The resource cache is also linked with ResourceRecord and ResourceReplay. Replay can warm-up
- * the cache on app startup by creating all necessary objects.
+ * the cache on app startup by creating all necessary objects, optionally on several threads.
  * The cache holds pointers to objects and has a mapping from such pointers to hashes.
- * It can only be destroyed in bulk, single elements cannot be removed.
+ * It is destroyed in bulk, except for the descriptor sets, framebuffers and pipelines Trim evicts
+ * once their type is over budget.
+ *
+ * Requests are safe to issue from several threads. Lookups of an already cached object only
+ * take a shared lock on its resource type, see ResourceCacheLock.
  */
 class ResourceCache
 {
@@ -89,28 +271,124 @@ class ResourceCache
 
 	ResourceCache& operator=(ResourceCache&&) = delete;
 
+	~ResourceCache();
+
 	void Warmup(const std::vector<uint8_t>& data);
 
+	/**
+	 * @brief Sets the number of threads used by Warmup and LoadFromFile to create the recorded resources
+	 * @param threadCount Number of threads, 1 (the default) replays on the calling thread
+	 */
+	void SetWarmupThreadCount(size_t threadCount);
+
+	/// @brief Returns the per-stage timings of the last warmup
+	const std::vector<ResourceReplayStage>& GetWarmupTimings() const;
+
 	std::vector<uint8_t> Serialize();
 
+	/**
+	 * @brief Warms up the cache from a file written by SaveToFile
+	 *        The stored VkPipelineCache data is merged into the pipeline cache set with SetPipelineCache.
+	 *        If no pipeline cache is set, the resource cache creates one from that data and owns it.
+	 * @param path Path of the cache file, read through vkb::filesystem
+	 * @return False if the file is missing, corrupted, of an older format version or written by a different driver
+	 */
+	bool LoadFromFile(const filesystem::Path& path);
+
+	/**
+	 * @brief Writes the recorded resources and the data of the current pipeline cache to a versioned, checksummed file
+	 *        The file is keyed by the driver, see LoadFromFile.
+	 * @param path Path of the cache file, written through vkb::filesystem
+	 */
+	void SaveToFile(const filesystem::Path& path);
+
 	void SetPipelineCache(VkPipelineCache pipelineCache);
 
+	/**
+	 * @brief Returns a shader module, compiling it on the calling thread if it isn't cached
+	 *        If the module is being compiled by CompileShaderModulesAsync, waits for that compile instead.
+	 */
 	ShaderModule& RequestShaderModule(VkShaderStageFlagBits stage, const ShaderSource& glslSource, const ShaderVariant& shaderVariant = {});
 
+	/**
+	 * @brief Compiles shader modules in parallel on worker threads, and returns without waiting for them
+	 *        Declaring the variants up front, for instance when preparing the subpasses, avoids compiling them
+	 *        inline when they are first requested while recording a frame. The modules cached or already in flight are skipped.
+	 */
+	void CompileShaderModulesAsync(const std::vector<ShaderModuleRequest>& requests);
+
+	/**
+	 * @brief Waits for the compiles started by CompileShaderModulesAsync
+	 */
+	void WaitForShaderModules();
+
+	/**
+	 * @brief Recompiles on worker threads the shader modules of the files which changed, and the pipelines using them
+	 *        The cached objects keep being used until all the replacements of a file are built. From then on, requests
+	 *        with the previous sources of the file resolve to the new modules, layouts and pipelines, and GetGeneration
+	 *        is incremented. A file which fails to compile keeps its previous objects.
+	 * @param filenames The files to check, all the files the cache compiled shader modules from if empty
+	 */
+	void ReloadShaders(const std::vector<std::string>& filenames = {});
+
 	PipelineLayout& RequestPipelineLayout(const std::vector<ShaderModule*>& shaderModules);
 
 	DescriptorSetLayout& RequestDescriptorSetLayout(const uint32_t setIndex, const std::vector<ShaderModule*>& shaderModules, const std::vector<ShaderResource>& setResources);
 
+	/**
+	 * @brief Returns the graphics pipeline of a pipeline state
+	 *        When the device uses graphics pipeline libraries, a miss fast-links the libraries of the four parts of the
+	 *        state, which are cached separately and shared by the states with the same part. The link time optimized
+	 *        pipeline is then compiled in the background if enabled, and returned by the requests once it is ready.
+	 */
 	GraphicsPipeline& RequestGraphicsPipeline(PipelineState& pipelineState);
 
+	/**
+	 * @brief Sets whether fast-linked graphics pipelines are replaced by link time optimized ones compiled in the background, enabled by default
+	 */
+	void SetOptimizeLinkedPipelines(bool enabled);
+
 	ComputePipeline& RequestComputePipeline(PipelineState& pipelineState);
 
+	/**
+	 * @brief Returns the shader object of a shader module, for devices using VK_EXT_shader_object
+	 * @param nextStages The stages which may follow the shader
+	 */
+	ShaderObject& RequestShaderObject(const ShaderModule& shaderModule, VkShaderStageFlags nextStages, const PipelineLayout& pipelineLayout, const SpecializationConstantState& specializationConstantState);
+
 	DescriptorSet& RequestDescriptorSet(DescriptorSetLayout& descriptorSetLayout, const BindingMap<VkDescriptorBufferInfo>& bufferInfos, const BindingMap<VkDescriptorImageInfo>& imageInfos);
 
+	/**
+	 * @brief Records the most descriptor sets of a layout a pool allocated at once, the descriptor pools of the layout
+	 *        created from then on hold that many sets. Only increases are recorded, so that Warmup restores the peaks of the session.
+	 */
+	void RecordDescriptorSetPeak(const DescriptorSetLayout& descriptorSetLayout, uint32_t setCount);
+
+	/// @return The most descriptor sets of a layout a pool allocated at once, 0 if none was recorded
+	uint32_t GetDescriptorSetPeak(const DescriptorSetLayout& descriptorSetLayout) const;
+
 	RenderPass& RequestRenderPass(const std::vector<Attachment>& attachments, const std::vector<LoadStoreInfo>& loadStoreInfos, const std::vector<SubpassInfo>& subpasses);
 
 	Framebuffer& RequestFramebuffer(const RenderTarget& renderTarget, const RenderPass& renderPass);
 
+	/**
+	 * @brief Returns the sampler of a create info, shared by all the requests with an identical create info
+	 *        The samplers live until the cache is cleared. Create infos chaining structures through pNext aren't supported.
+	 */
+	core::Sampler& RequestSampler(const VkSamplerCreateInfo& info);
+
+	/**
+	 * @brief Returns a view of an image, shared by all the requests with identical parameters, see core::ImageView
+	 *        The views of an image are released when the image is destroyed, see ReleaseImageViews.
+	 */
+	core::ImageView& RequestImageView(core::Image& image, VkImageViewType viewType, VkFormat format = VK_FORMAT_UNDEFINED,
+	                                  uint32_t baseMipLevel = 0, uint32_t baseArrayLayer = 0, uint32_t mipLevelCount = 0, uint32_t arrayLayerCount = 0);
+
+	/**
+	 * @brief Destroys the cached views of an image, called by the image when it is destroyed
+	 */
+	void ReleaseImageViews(const core::Image& image);
+
 	void ClearPipelines();
 
 	/// @brief Update those descriptor sets referring to old views
@@ -118,37 +396,185 @@ class ResourceCache
 	/// @param new_views New image views to be referred
 	void UpdateDescriptorSets(const std::vector<core::ImageView>& oldViews, const std::vector<core::ImageView>& newViews);
 
+	/// @brief Update those descriptor sets referring to old buffers, e.g. buffers moved by the defragmentation
+	/// @param oldBuffers Old buffers referred by descriptor sets
+	/// @param newBuffers New buffers to be referred
+	void UpdateDescriptorSets(const std::vector<VkBuffer>& oldBuffers, const std::vector<VkBuffer>& newBuffers);
+
 	void ClearFramebuffers();
 
 	void Clear();
 
+	/// @brief Limits the number of cached objects of the types which churn with the content, unbounded by default
+	///        The descriptor sets are only freed from the pools created with a descriptor set budget, set it before rendering.
+	void SetBudget(const ResourceCacheBudget& budget);
+
+	const ResourceCacheBudget& GetBudget() const;
+
+	/// @brief Evicts the least recently requested objects of the types over budget, to be called once per frame
+	/// Evicted objects are retired to the deferred destruction queue of the device, as submissions in flight may use them.
+	/// References to them must not be kept across frames, GetGeneration tells when objects were evicted.
+	void Trim();
+
+	/// @brief Returns a counter incremented whenever cached pipelines, framebuffers or descriptor sets are destroyed, or cached descriptor sets rewritten,
+	///        which invalidates the command buffers recorded with them
+	uint64_t GetGeneration() const;
+
 	const ResourceCacheState& GetInternalState() const;
 
+	/// @brief Returns the hit, miss and lock contention counters of every resource type
+	ResourceCacheStats GetStats() const;
+
+	void ResetStats();
+
+	/// @brief Returns the pipelines created so far, including the cleared ones, slowest first
+	std::vector<PipelineCreationRecord> GetPipelineCreations() const;
+
+	PipelineCreationTotals GetPipelineCreationTotals() const;
+
+	/**
+	 * @brief Writes the pipelines created so far as CSV, slowest first, and logs the slowest ones
+	 *        The states at the top of the report are the ones causing hitches when first drawn.
+	 * @param path Path of the report, written through vkb::filesystem
+	 */
+	void WritePipelineCreationReport(const filesystem::Path& path) const;
+
   private:
+	/// @brief Queues a compile on the job system, counted by m_compileJobs
+	std::future<void> ScheduleCompile(std::function<void()> compile);
+
+	/// @brief Waits for the compiles in the background, which insert into the cache state
+	void WaitForCompileJobs();
+
+	/// @brief Builds a shader module from a source which isn't redirected, recording what it was compiled from
+	ShaderModule& BuildShaderModule(VkShaderStageFlagBits stage, const ShaderSource& glslSource, const ShaderVariant& shaderVariant);
+
+	/// @return The source which replaced a shader source on a reload, null if it wasn't replaced
+	std::shared_ptr<const ShaderSource> FindShaderSourceRedirect(const ShaderSource& glslSource) const;
+
+	/// @brief Rebuilds the shader modules of a file with its current source, then the pipelines using them, see ReloadShaders
+	void ReloadShaderFile(const std::string& filename);
+
+	/// @brief Frees the descriptor sets evicted by Trim which the GPU is done with
+	/// @note Callers must hold the descriptor set lock exclusively
+	void ReleaseEvictedDescriptorSets();
+
+	/// @brief Returns the descriptor pool of a layout, created at the recorded peak size of the layout if it isn't cached
+	DescriptorPool& RequestDescriptorPool(const DescriptorSetLayout& descriptorSetLayout);
+
+	/// @brief Adds the key of a cached descriptor set to the entries of the image views it refers to
+	/// @note Callers must hold the descriptor set lock exclusively
+	void IndexImageViews(std::size_t key, const BindingMap<VkDescriptorImageInfo>& imageInfos);
+
+	/// @brief Adds a pipeline created by the cache to the creation report
+	void RecordPipelineCreation(std::size_t hash, const char* kind, const PipelineState& pipelineState, const Pipeline& pipeline);
+
 	Device& m_device;
 
 	ResourceRecord m_recorder;
 
 	ResourceReplay m_replayer;
 
+	size_t m_warmupThreadCount{ 1 };
+
+	bool m_optimizeLinkedPipelines{ true };
+
 	VkPipelineCache m_pipelineCache{ VK_NULL_HANDLE };
 
+	/// Pipeline cache created by LoadFromFile, destroyed on Clear
+	VkPipelineCache m_ownedPipelineCache{ VK_NULL_HANDLE };
+
 	ResourceCacheState m_state;
 
-	std::mutex m_descriptorSetMutex;
+	ResourceCacheBudget m_budget;
+
+	/// Descriptor sets evicted by Trim, returned to their pool once the deferred destruction queue sets released
+	struct EvictedDescriptorSets
+	{
+		std::vector<DescriptorSet> sets;
+
+		std::shared_ptr<std::atomic<bool>> released;
+	};
+
+	ResourceCacheLock m_descriptorPoolLock;
+
+	/// Most descriptor sets allocated at once from a pool, by layout
+	std::unordered_map<const DescriptorSetLayout*, uint32_t> m_descriptorSetPeaks;
+
+	mutable std::mutex m_descriptorSetPeaksMutex;
+
+	ResourceCacheLock m_descriptorSetLock;
+
+	/// Guarded by m_descriptorSetLock
+	std::vector<EvictedDescriptorSets> m_evictedDescriptorSets;
+
+	/// Keys of the cached descriptor sets referring to each image view, guarded by m_descriptorSetLock.
+	/// Entries may name sets which were rehashed since, lookups check the set still exists.
+	std::unordered_map<VkImageView, std::unordered_set<std::size_t>> m_imageViewDescriptorSets;
+
+	ResourceCacheLock m_pipelineLayoutLock;
+
+	ResourceCacheLock m_shaderModuleLock;
+
+	ResourceCacheLock m_descriptorSetLayoutLock;
+
+	ResourceCacheLock m_graphicsPipelineLock;
+
+	ResourceCacheLock m_graphicsPipelineLibraryLock;
+
+	ResourceCacheLock m_renderPassLock;
+
+	ResourceCacheLock m_computePipelineLock;
+
+	ResourceCacheLock m_shaderObjectLock;
+
+	ResourceCacheLock m_framebufferLock;
+
+	ResourceCacheLock m_samplerLock;
+
+	ResourceCacheLock m_imageViewLock;
+
+	/// Keys of the cached views of each image, guarded by m_imageViewLock
+	std::unordered_map<VkImage, std::vector<std::size_t>> m_imageViewKeys;
+
+	/// Compiles in flight, by shader module hash
+	std::unordered_map<std::size_t, std::shared_future<void>> m_pendingShaderModules;
+
+	std::mutex m_pendingShaderModulesMutex;
+
+	/// What a cached shader module was compiled from, the modules of a file are rebuilt from it when the file is reloaded
+	struct ShaderModuleOrigin
+	{
+		VkShaderStageFlagBits stage;
+
+		std::string filename;
+
+		std::size_t sourceId;
+
+		ShaderVariant variant;
+	};
+
+	/// Origins of the cached shader modules, by module hash
+	std::unordered_map<std::size_t, ShaderModuleOrigin> m_shaderModuleOrigins;
+
+	/// Current source of the reloaded files, by id of the sources they replaced
+	std::unordered_map<std::size_t, std::shared_ptr<const ShaderSource>> m_shaderSourceRedirects;
 
-	std::mutex m_pipelineLayoutMutex;
+	/// Set once a file was reloaded, the requests of the other modules don't look up the redirects until then
+	std::atomic<bool> m_hasShaderSourceRedirects{ false };
 
-	std::mutex m_shaderModuleMutex;
+	/// Guards the origins and the redirects of the shader sources
+	mutable std::shared_mutex m_shaderSourcesMutex;
 
-	std::mutex m_descriptorSetLayoutMutex;
+	/// Compiles of the shader modules and the optimized pipelines queued on the job system
+	JobCounter m_compileJobs;
 
-	std::mutex m_graphicsPipelineMutex;
+	std::vector<PipelineCreationRecord> m_pipelineCreations;
 
-	std::mutex m_renderPassMutex;
+	PipelineCreationTotals m_pipelineCreationTotals;
 
-	std::mutex m_computePipelineMutex;
+	mutable std::mutex m_pipelineCreationsMutex;
 
-	std::mutex m_framebufferMutex;
+	std::atomic<uint64_t> m_generation{ 0 };
 };
 }        // namespace vkb
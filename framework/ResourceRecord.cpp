@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2020, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -40,6 +40,31 @@ inline void WriteSubpassInfo(std::ostringstream& os, const std::vector<SubpassIn
 }
 
 
+inline void WriteShaderResources(std::ostringstream& os, const std::vector<ShaderResource>& value)
+{
+	write(os, value.size());
+	for (const ShaderResource& item : value)
+	{
+		write(os,
+		      item.stages,
+		      item.type,
+		      item.mode,
+		      item.set,
+		      item.binding,
+		      item.location,
+		      item.input_attachment_index,
+		      item.vec_size,
+		      item.columns,
+		      item.array_size,
+		      item.offset,
+		      item.size,
+		      item.constant_id,
+		      item.qualifiers,
+		      item.name);
+	}
+}
+
+
 inline void WriteProcesses(std::ostringstream& os, const std::vector<std::string>& value)
 {
 	write(os, value.size());
@@ -54,12 +79,16 @@ inline void WriteProcesses(std::ostringstream& os, const std::vector<std::string
 
 void ResourceRecord::SetData(const std::vector<uint8_t>& data)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_stream.str(std::string{data.begin(), data.end()});
 }
 
 
 std::vector<uint8_t> ResourceRecord::GetData()
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	std::string str = m_stream.str();
 
 	return std::vector<uint8_t>{ str.begin(), str.end() };
@@ -74,6 +103,8 @@ const std::ostringstream &ResourceRecord::GetStream()
 
 size_t ResourceRecord::RegisterShaderModule(VkShaderStageFlagBits stage, const ShaderSource& glslSource, const std::string& entryPoint, const ShaderVariant& shaderVariant)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_shaderModuleIndices.push_back(m_shaderModuleIndices.size());
 
 	write(m_stream, ResourceType::ShaderModule, stage, glslSource.get_source(), entryPoint, shaderVariant.get_preamble());
@@ -86,6 +117,8 @@ size_t ResourceRecord::RegisterShaderModule(VkShaderStageFlagBits stage, const S
 
 size_t ResourceRecord::RegisterPipelineLayout(const std::vector<ShaderModule*>& shaderModules)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_pipelineLayoutIndices.push_back(m_pipelineLayoutIndices.size());
 
 	std::vector<size_t> shaderIndices(shaderModules.size());
@@ -100,6 +133,8 @@ size_t ResourceRecord::RegisterPipelineLayout(const std::vector<ShaderModule*>&
 
 size_t ResourceRecord::RegisterRenderPass(const std::vector<Attachment>& attachments, const std::vector<LoadStoreInfo>& loadStoreInfos, const std::vector<SubpassInfo>& subpasses)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_renderPassIndices.push_back(m_renderPassIndices.size());
 
 	write(m_stream, ResourceType::RenderPass, attachments, loadStoreInfos);
@@ -112,18 +147,26 @@ size_t ResourceRecord::RegisterRenderPass(const std::vector<Attachment>& attachm
 
 size_t ResourceRecord::RegisterGraphicsPipeline(VkPipelineCache /*pipeline_cache*/, PipelineState& pipelineState)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_graphicsPipelineIndices.push_back(m_graphicsPipelineIndices.size());
 
 	auto& pipelineLayout = pipelineState.get_pipeline_layout();
 	auto renderPass = pipelineState.get_render_pass();
 
+	// The replay creates the pipelines for render passes, the ones created for dynamic rendering aren't recorded
+	if (!renderPass)
+	{
+		return m_graphicsPipelineIndices.back();
+	}
+
 	write(m_stream,
 	      ResourceType::GraphicsPipeline,
 	      m_pipelineLayoutToIndex.at(&pipelineLayout),
 	      m_renderPassToIndex.at(renderPass),
 	      pipelineState.get_subpass_index());
 
-	auto& specializationConstantState = pipelineState.get_specialization_constant_state().get_specialization_constant_state();
+	auto specializationConstantState = pipelineState.get_specialization_constant_state().get_specialization_constant_state();
 
 	write(m_stream, specializationConstantState);
 
@@ -149,27 +192,104 @@ size_t ResourceRecord::RegisterGraphicsPipeline(VkPipelineCache /*pipeline_cache
 }
 
 
+size_t ResourceRecord::RegisterDescriptorSetLayout(const uint32_t setIndex, const std::vector<ShaderModule*>& shaderModules, const std::vector<ShaderResource>& setResources)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_descriptorSetLayoutIndices.push_back(m_descriptorSetLayoutIndices.size());
+
+	std::vector<size_t> shaderIndices(shaderModules.size());
+	std::transform(shaderModules.begin(), shaderModules.end(), shaderIndices.begin(),
+	               [this](ShaderModule* shaderModule) { return m_shaderModuleToIndex.at(shaderModule); });
+
+	write(m_stream, ResourceType::DescriptorSetLayout, setIndex, shaderIndices);
+
+	WriteShaderResources(m_stream, setResources);
+
+	return m_descriptorSetLayoutIndices.back();
+}
+
+
+size_t ResourceRecord::RegisterComputePipeline(VkPipelineCache /*pipeline_cache*/, PipelineState& pipelineState)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_computePipelineIndices.push_back(m_computePipelineIndices.size());
+
+	auto& pipelineLayout = pipelineState.get_pipeline_layout();
+
+	write(m_stream,
+	      ResourceType::ComputePipeline,
+	      m_pipelineLayoutToIndex.at(&pipelineLayout));
+
+	auto specializationConstantState = pipelineState.get_specialization_constant_state().get_specialization_constant_state();
+
+	write(m_stream, specializationConstantState);
+
+	return m_computePipelineIndices.back();
+}
+
+
+void ResourceRecord::RegisterDescriptorSetPeak(const DescriptorSetLayout& descriptorSetLayout, uint32_t setCount)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	auto it = m_descriptorSetLayoutToIndex.find(&descriptorSetLayout);
+	if (it == m_descriptorSetLayoutToIndex.end())
+	{
+		return;
+	}
+
+	// Later entries of a layout supersede the earlier ones when replayed
+	write(m_stream, ResourceType::DescriptorSetPeak, it->second, setCount);
+}
+
+
 void ResourceRecord::SetShaderModule(size_t index, const ShaderModule& shaderModule)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_shaderModuleToIndex[&shaderModule] = index;
 }
 
 
 void ResourceRecord::SetPipelineLayout(size_t index, const PipelineLayout& pipelineLayout)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_pipelineLayoutToIndex[&pipelineLayout] = index;
 }
 
 
 void ResourceRecord::SetRenderPass(size_t index, const RenderPass& renderPass)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_renderPassToIndex[&renderPass] = index;
 }
 
 
 void ResourceRecord::SetGraphicsPipeline(size_t index, const GraphicsPipeline& graphicsPipeline)
 {
+	std::lock_guard<std::mutex> guard(m_mutex);
+
 	m_graphicsPipelineToIndex[&graphicsPipeline] = index;
 }
 
+
+void ResourceRecord::SetDescriptorSetLayout(size_t index, const DescriptorSetLayout& descriptorSetLayout)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_descriptorSetLayoutToIndex[&descriptorSetLayout] = index;
+}
+
+
+void ResourceRecord::SetComputePipeline(size_t index, const ComputePipeline& computePipeline)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_computePipelineToIndex[&computePipeline] = index;
+}
+
 } // namespace vkb
\ No newline at end of file
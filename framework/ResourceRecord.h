@@ -17,12 +17,15 @@
 
 #pragma once
 
+#include <mutex>
 #include <vector>
 
 #include "rendering/pipeline_state.h"
 
 namespace vkb
 {
+class ComputePipeline;
+class DescriptorSetLayout;
 class GraphicsPipeline;
 class PipelineLayout;
 class RenderPass;
@@ -33,11 +36,15 @@ enum class ResourceType
 	ShaderModule,
 	PipelineLayout,
 	RenderPass,
-	GraphicsPipeline
+	GraphicsPipeline,
+	DescriptorSetLayout,
+	ComputePipeline,
+	DescriptorSetPeak
 };
 
 /**
  * @brief Writes Vulkan objects in a memory stream.
+ * Registration is thread-safe, resources of different types may be recorded concurrently.
  */
 class ResourceRecord
 {
@@ -56,6 +63,16 @@ class ResourceRecord
 
 	size_t RegisterGraphicsPipeline(VkPipelineCache pipelineCache, PipelineState& pipelineState);
 
+	size_t RegisterDescriptorSetLayout(const uint32_t setIndex, const std::vector<ShaderModule*>& shaderModules, const std::vector<ShaderResource>& setResources);
+
+	size_t RegisterComputePipeline(VkPipelineCache pipelineCache, PipelineState& pipelineState);
+
+	/**
+	 * @brief Records the most descriptor sets of a layout allocated at once from a pool, replayed after the layouts
+	 *        Layouts which weren't recorded, like the ones created outside of the resource cache, are skipped.
+	 */
+	void RegisterDescriptorSetPeak(const DescriptorSetLayout& descriptorSetLayout, uint32_t setCount);
+
 	void SetShaderModule(size_t index, const ShaderModule& shaderModule);
 
 	void SetPipelineLayout(size_t index, const PipelineLayout& pipelineLayout);
@@ -64,7 +81,13 @@ class ResourceRecord
 
 	void SetGraphicsPipeline(size_t index, const GraphicsPipeline& graphicsPipeline);
 
+	void SetDescriptorSetLayout(size_t index, const DescriptorSetLayout& descriptorSetLayout);
+
+	void SetComputePipeline(size_t index, const ComputePipeline& computePipeline);
+
   private:
+	std::mutex m_mutex;
+
 	std::ostringstream m_stream;
 
 	std::vector<size_t> m_shaderModuleIndices;
@@ -75,6 +98,10 @@ class ResourceRecord
 
 	std::vector<size_t> m_graphicsPipelineIndices;
 
+	std::vector<size_t> m_descriptorSetLayoutIndices;
+
+	std::vector<size_t> m_computePipelineIndices;
+
 	std::unordered_map<const ShaderModule*, size_t> m_shaderModuleToIndex;
 
 	std::unordered_map<const PipelineLayout*, size_t> m_pipelineLayoutToIndex;
@@ -82,6 +109,10 @@ class ResourceRecord
 	std::unordered_map<const RenderPass*, size_t> m_renderPassToIndex;
 
 	std::unordered_map<const GraphicsPipeline*, size_t> m_graphicsPipelineToIndex;
+
+	std::unordered_map<const DescriptorSetLayout*, size_t> m_descriptorSetLayoutToIndex;
+
+	std::unordered_map<const ComputePipeline*, size_t> m_computePipelineToIndex;
 };
 
 }        // namespace vkb
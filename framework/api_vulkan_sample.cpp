@@ -33,6 +33,13 @@ bool ApiVulkanSample::prepare(const vkb::ApplicationOptions &options)
 		return false;
 	}
 
+	// The API samples acquire and present the images of the swapchain themselves
+	if (!get_render_context().has_swapchain())
+	{
+		LOGE("{} renders to the swapchain, it can't run offscreen", get_name());
+		return false;
+	}
+
 	depth_format = vkb::get_suitable_depth_format(get_device().get_gpu().get_handle());
 
 	// Create synchronization objects
@@ -57,6 +64,8 @@ bool ApiVulkanSample::prepare(const vkb::ApplicationOptions &options)
 
 	queue = get_device().get_suitable_graphics_queue().get_handle();
 
+	upload_context = std::make_unique<vkb::UploadContext>(get_device(), get_device().get_suitable_graphics_queue());
+
 	create_swapchain_buffers();
 	create_command_pool();
 	create_command_buffers();
@@ -420,9 +429,11 @@ void ApiVulkanSample::recreate_current_command_buffer()
 
 void ApiVulkanSample::create_pipeline_cache()
 {
-	VkPipelineCacheCreateInfo pipeline_cache_create_info = {};
-	pipeline_cache_create_info.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-	VK_CHECK(vkCreatePipelineCache(get_device().get_handle(), &pipeline_cache_create_info, nullptr, &pipeline_cache));
+	// The pipelines of a sample don't depend on the others, so each one keeps a file of its own
+	auto path = vkb::filesystem::get()->temp_directory() / "pipeline_caches" / (get_name() + ".bin");
+
+	pipeline_cache_store = std::make_unique<vkb::PipelineCacheStore>(get_device(), path);
+	pipeline_cache       = pipeline_cache_store->get_handle();
 }
 
 VkPipelineShaderStageCreateInfo ApiVulkanSample::load_shader(const std::string &file, VkShaderStageFlagBits stage, vkb::ShaderSourceLanguage src_language)
@@ -479,6 +490,12 @@ void ApiVulkanSample::update_overlay(float delta_time, const std::function<void(
 			accumulated_time = 0.0f;
 		}
 
+		// A cached GUI keeps the buffers and the command buffers recorded with its last rebuild
+		if (!get_gui().needs_rebuild(delta_time))
+		{
+			return;
+		}
+
 		get_gui().show_simple_window(get_name(), fps, [this, additional_ui]() {
 			on_update_ui_overlay(get_gui().get_drawer());
 			additional_ui();
@@ -509,6 +526,9 @@ void ApiVulkanSample::draw_ui(const VkCommandBuffer command_buffer)
 
 void ApiVulkanSample::prepare_frame()
 {
+	// The uploads may be used on other queues, which aren't ordered after the batches
+	upload_context->wait_idle();
+
 	if (get_render_context().has_swapchain())
 	{
 		handle_surface_changes();
@@ -581,6 +601,12 @@ void ApiVulkanSample::submit_frame()
 	VK_CHECK(get_device().get_queue_by_present(0).wait_idle());
 }
 
+ApiVulkanSample::ApiVulkanSample()
+{
+	// The projections and framebuffers of these samples follow the orientation of the window
+	set_pre_rotation_enable(false);
+}
+
 ApiVulkanSample::~ApiVulkanSample()
 {
 	if (has_device())
@@ -615,7 +641,10 @@ ApiVulkanSample::~ApiVulkanSample()
 		vkDestroyImage(get_device().get_handle(), depth_stencil.image, nullptr);
 		vkFreeMemory(get_device().get_handle(), depth_stencil.mem, nullptr);
 
-		vkDestroyPipelineCache(get_device().get_handle(), pipeline_cache, nullptr);
+		// Writes the cache a last time before destroying it
+		pipeline_cache_store.reset();
+
+		upload_context.reset();
 
 		vkDestroyCommandPool(get_device().get_handle(), cmd_pool, nullptr);
 
@@ -1024,12 +1053,6 @@ Texture ApiVulkanSample::load_texture(const std::string &file, vkb::sg::Image::C
 	texture.image = vkb::sg::Image::load(file, file, content_type);
 	texture.image->create_vk_image(get_device());
 
-	const auto &queue = get_device().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
-
-	VkCommandBuffer command_buffer = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-	vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(get_device(), texture.image->get_data());
-
 	// Setup buffer copy regions for each mip level
 	std::vector<VkBufferImageCopy> bufferCopyRegions;
 
@@ -1056,31 +1079,17 @@ Texture ApiVulkanSample::load_texture(const std::string &file, vkb::sg::Image::C
 	subresource_range.levelCount              = vkb::to_u32(mipmaps.size());
 	subresource_range.layerCount              = 1;
 
-	// Image barrier for optimal image (target)
-	// Optimal image will be used as destination for the copy
-	vkb::image_layout_transition(command_buffer,
-	                             texture.image->get_vk_image().get_handle(),
-	                             VK_IMAGE_LAYOUT_UNDEFINED,
-	                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                             subresource_range);
-
-	// Copy mip levels from staging buffer
-	vkCmdCopyBufferToImage(
-	    command_buffer,
-	    stage_buffer.get_handle(),
-	    texture.image->get_vk_image().get_handle(),
-	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	    static_cast<uint32_t>(bufferCopyRegions.size()),
-	    bufferCopyRegions.data());
-
-	// Change texture image layout to shader read after all mip levels have been copied
-	vkb::image_layout_transition(command_buffer,
-	                             texture.image->get_vk_image().get_handle(),
-	                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-	                             subresource_range);
-
-	get_device().flush_command_buffer(command_buffer, queue.get_handle());
+	if (texture.image->has_host_copy())
+	{
+		// Written from the host, without staging memory or a submission
+		texture.image->copy_data_from_host();
+	}
+	else
+	{
+		// Submitted without waiting, prepare_frame() makes sure the copies are complete before the first frame
+		upload_context->upload_image(texture.image->get_vk_image().get_handle(), texture.image->get_data(), bufferCopyRegions, subresource_range);
+		upload_context->flush();
+	}
 
 	// Calculate valid filter and mipmap modes
 	VkFilter            filter      = VK_FILTER_LINEAR;
@@ -1120,12 +1129,6 @@ Texture ApiVulkanSample::load_texture_array(const std::string &file, vkb::sg::Im
 	texture.image = vkb::sg::Image::load(file, file, content_type);
 	texture.image->create_vk_image(get_device(), VK_IMAGE_VIEW_TYPE_2D_ARRAY);
 
-	const auto &queue = get_device().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
-
-	VkCommandBuffer command_buffer = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-	vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(get_device(), texture.image->get_data());
-
 	// Setup buffer copy regions for each mip level
 	std::vector<VkBufferImageCopy> buffer_copy_regions;
 
@@ -1158,31 +1161,17 @@ Texture ApiVulkanSample::load_texture_array(const std::string &file, vkb::sg::Im
 	subresource_range.levelCount              = vkb::to_u32(mipmaps.size());
 	subresource_range.layerCount              = layers;
 
-	// Image barrier for optimal image (target)
-	// Optimal image will be used as destination for the copy
-	vkb::image_layout_transition(command_buffer,
-	                             texture.image->get_vk_image().get_handle(),
-	                             VK_IMAGE_LAYOUT_UNDEFINED,
-	                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                             subresource_range);
-
-	// Copy mip levels from staging buffer
-	vkCmdCopyBufferToImage(
-	    command_buffer,
-	    stage_buffer.get_handle(),
-	    texture.image->get_vk_image().get_handle(),
-	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	    static_cast<uint32_t>(buffer_copy_regions.size()),
-	    buffer_copy_regions.data());
-
-	// Change texture image layout to shader read after all mip levels have been copied
-	vkb::image_layout_transition(command_buffer,
-	                             texture.image->get_vk_image().get_handle(),
-	                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-	                             subresource_range);
-
-	get_device().flush_command_buffer(command_buffer, queue.get_handle());
+	if (texture.image->has_host_copy())
+	{
+		// Written from the host, without staging memory or a submission
+		texture.image->copy_data_from_host();
+	}
+	else
+	{
+		// Submitted without waiting, prepare_frame() makes sure the copies are complete before the first frame
+		upload_context->upload_image(texture.image->get_vk_image().get_handle(), texture.image->get_data(), buffer_copy_regions, subresource_range);
+		upload_context->flush();
+	}
 
 	// Calculate valid filter and mipmap modes
 	VkFilter            filter      = VK_FILTER_LINEAR;
@@ -1219,12 +1208,6 @@ Texture ApiVulkanSample::load_texture_cubemap(const std::string &file, vkb::sg::
 	texture.image = vkb::sg::Image::load(file, file, content_type);
 	texture.image->create_vk_image(get_device(), VK_IMAGE_VIEW_TYPE_CUBE, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
 
-	const auto &queue = get_device().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
-
-	VkCommandBuffer command_buffer = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-	vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(get_device(), texture.image->get_data());
-
 	// Setup buffer copy regions for each mip level
 	std::vector<VkBufferImageCopy> buffer_copy_regions;
 
@@ -1257,31 +1240,17 @@ Texture ApiVulkanSample::load_texture_cubemap(const std::string &file, vkb::sg::
 	subresource_range.levelCount              = vkb::to_u32(mipmaps.size());
 	subresource_range.layerCount              = layers;
 
-	// Image barrier for optimal image (target)
-	// Optimal image will be used as destination for the copy
-	vkb::image_layout_transition(command_buffer,
-	                             texture.image->get_vk_image().get_handle(),
-	                             VK_IMAGE_LAYOUT_UNDEFINED,
-	                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                             subresource_range);
-
-	// Copy mip levels from staging buffer
-	vkCmdCopyBufferToImage(
-	    command_buffer,
-	    stage_buffer.get_handle(),
-	    texture.image->get_vk_image().get_handle(),
-	    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	    static_cast<uint32_t>(buffer_copy_regions.size()),
-	    buffer_copy_regions.data());
-
-	// Change texture image layout to shader read after all mip levels have been copied
-	vkb::image_layout_transition(command_buffer,
-	                             texture.image->get_vk_image().get_handle(),
-	                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-	                             subresource_range);
-
-	get_device().flush_command_buffer(command_buffer, queue.get_handle());
+	if (texture.image->has_host_copy())
+	{
+		// Written from the host, without staging memory or a submission
+		texture.image->copy_data_from_host();
+	}
+	else
+	{
+		// Submitted without waiting, prepare_frame() makes sure the copies are complete before the first frame
+		upload_context->upload_image(texture.image->get_vk_image().get_handle(), texture.image->get_data(), buffer_copy_regions, subresource_range);
+		upload_context->flush();
+	}
 
 	// Calculate valid filter and mipmap modes
 	VkFilter            filter      = VK_FILTER_LINEAR;
@@ -1352,6 +1321,8 @@ void ApiVulkanSample::with_vkb_command_buffer(const std::function<void(vkb::Comm
 	f(cmd);
 	cmd.end();
 	auto &queue = get_device().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
-	queue.submit(cmd, get_device().request_fence());
-	get_device().get_fence_pool().wait();
+	VkFence fence = get_device().request_fence();
+	queue.submit(cmd, fence);
+	VK_CHECK(get_device().get_fence_pool().wait(fence));
+	VK_CHECK(get_device().get_fence_pool().recycle(fence));
 }
@@ -34,6 +34,7 @@
 #include "common/vk_common.h"
 #include "common/vk_initializers.h"
 #include "core/buffer.h"
+#include "core/pipeline_cache_store.h"
 #include "core/swapchain.h"
 #include "gui.h"
 #include "platform/platform.h"
@@ -41,6 +42,7 @@
 #include "scene_graph/components/image.h"
 #include "scene_graph/components/sampler.h"
 #include "scene_graph/components/texture.h"
+#include "upload_context.h"
 #include "vulkan_sample.h"
 
 /**
@@ -103,7 +105,7 @@ struct Meshlet
 class ApiVulkanSample : public vkb::VulkanSampleC
 {
   public:
-	ApiVulkanSample() = default;
+	ApiVulkanSample();
 
 	virtual ~ApiVulkanSample();
 
@@ -161,9 +163,17 @@ class ApiVulkanSample : public vkb::VulkanSampleC
 	// List of shader modules created (stored for cleanup)
 	std::vector<VkShaderModule> shader_modules;
 
-	// Pipeline cache object
+	// Pipeline cache object, owned by pipeline_cache_store
 	VkPipelineCache pipeline_cache;
 
+	// Loads the pipeline cache from the previous runs and keeps the file up to date
+	// Threads creating pipelines in parallel can use pipeline_cache_store->get_thread_cache()
+	std::unique_ptr<vkb::PipelineCacheStore> pipeline_cache_store;
+
+	// Copies the data of the buffers and textures without waiting for each upload
+	// Call upload_context->flush() once a batch is enqueued, and wait() on its token before reading the data on the CPU
+	std::unique_ptr<vkb::UploadContext> upload_context;
+
 	// Synchronization semaphores
 	struct
 	{
@@ -338,7 +348,7 @@ class ApiVulkanSample : public vkb::VulkanSampleC
 	void recreate_current_command_buffer();
 
 	/**
-	 * @brief Create a cache pool for rendering pipelines
+	 * @brief Create a cache pool for rendering pipelines, loaded from the file written by the previous runs of the sample
 	 */
 	void create_pipeline_cache();
 
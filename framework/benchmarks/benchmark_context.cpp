@@ -0,0 +1,112 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark_context.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <thread>
+
+#include <filesystem/filesystem.hpp>
+
+#include "core/debug.h"
+#include "core/device.h"
+#include "core/instance.h"
+#include "core/util/logging.hpp"
+#include "platform/headless_window.h"
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+namespace benchmarks
+{
+namespace
+{
+/**
+ * @brief The objects shared by the benchmarks, destroyed at exit in the reverse order of their creation
+ */
+struct BenchmarkContext
+{
+	std::unique_ptr<Instance> instance;
+
+	std::unique_ptr<Device> device;
+
+	std::unique_ptr<HeadlessWindow> window;
+
+	std::unique_ptr<RenderContext> render_context;
+
+	BenchmarkContext()
+	{
+		// The shaders are read from the working directory, the root of the repository
+		filesystem::init();
+
+		if (volkInitialize() != VK_SUCCESS)
+		{
+			LOGW("Vulkan is not available, the benchmarks using a device are skipped");
+			return;
+		}
+
+		try
+		{
+			instance = std::make_unique<Instance>("Framework benchmarks");
+			device   = std::make_unique<Device>(instance->get_first_gpu(), VK_NULL_HANDLE, std::make_unique<DummyDebugUtils>());
+
+			Window::Properties properties;
+			properties.extent = {1920, 1080};
+			window            = std::make_unique<HeadlessWindow>(properties);
+
+			render_context = std::make_unique<RenderContext>(*device, VK_NULL_HANDLE, *window);
+			render_context->prepare(std::max(1u, std::thread::hardware_concurrency()));
+		}
+		catch (const std::exception &e)
+		{
+			LOGW("Failed to create a device, the benchmarks using it are skipped: {}", e.what());
+			render_context.reset();
+			window.reset();
+			device.reset();
+			instance.reset();
+		}
+	}
+
+	~BenchmarkContext()
+	{
+		if (device)
+		{
+			device->wait_idle();
+		}
+	}
+};
+
+BenchmarkContext &get_context()
+{
+	static BenchmarkContext context;
+	return context;
+}
+}        // namespace
+
+Device *get_device()
+{
+	return get_context().device.get();
+}
+
+RenderContext *get_render_context()
+{
+	return get_context().render_context.get();
+}
+}        // namespace benchmarks
+}        // namespace vkb
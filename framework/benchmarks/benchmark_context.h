@@ -0,0 +1,39 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+namespace vkb
+{
+class Device;
+class RenderContext;
+
+namespace benchmarks
+{
+/**
+ * @brief Returns a device on the first GPU, created by the first call and shared by the benchmarks
+ * @return Null if Vulkan or a GPU isn't available, the benchmarks needing it are then skipped
+ */
+Device *get_device();
+
+/**
+ * @brief Returns an offscreen render context of the shared device, with a frame of 1920x1080 and a thread per hardware thread
+ * @return Null without a device
+ */
+RenderContext *get_render_context();
+}        // namespace benchmarks
+}        // namespace vkb
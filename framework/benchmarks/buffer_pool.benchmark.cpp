@@ -0,0 +1,82 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include "benchmark_context.h"
+#include "buffer_pool.h"
+#include "core/device.h"
+
+using namespace vkb;
+
+namespace
+{
+/// The uniforms of a frame of a few thousand draws
+constexpr uint32_t AllocationCount = 4096;
+
+constexpr VkDeviceSize AllocationSize = 256;
+}        // namespace
+
+TEST_CASE("BufferBlock allocations", "[benchmark]")
+{
+	auto *device = benchmarks::get_device();
+	if (!device)
+	{
+		SKIP("No Vulkan device");
+	}
+
+	BufferBlockC linear_block{*device, AllocationCount * AllocationSize * 2, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU};
+
+	BENCHMARK("BufferBlock::allocate, linear, " + std::to_string(AllocationCount) + " allocations")
+	{
+		linear_block.reset();
+
+		VkDeviceSize offset_sum = 0;
+		for (uint32_t i = 0; i < AllocationCount; ++i)
+		{
+			offset_sum += linear_block.allocate(AllocationSize).get_offset();
+		}
+		return offset_sum;
+	};
+
+	BufferBlockC free_list_block{*device, AllocationCount * AllocationSize * 4, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+	                             BufferBlockStrategy::FreeList};
+
+	std::vector<BufferAllocationC> allocations(AllocationCount);
+
+	BENCHMARK("BufferBlock::allocate and free, free list, " + std::to_string(AllocationCount) + " allocations")
+	{
+		// Sizes varying from 1 to 4 times the base size, freed every other one first so that the free ranges coalesce
+		for (uint32_t i = 0; i < AllocationCount; ++i)
+		{
+			allocations[i] = free_list_block.allocate(AllocationSize * (1 + i % 4));
+		}
+		for (uint32_t i = 0; i < AllocationCount; i += 2)
+		{
+			free_list_block.free(allocations[i]);
+		}
+		for (uint32_t i = 1; i < AllocationCount; i += 2)
+		{
+			free_list_block.free(allocations[i]);
+		}
+		return allocations.size();
+	};
+}
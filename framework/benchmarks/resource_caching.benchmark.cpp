@@ -0,0 +1,216 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <core/util/job_system.hpp>
+
+#include "benchmark_context.h"
+#include "common/resource_caching.h"
+#include "core/device.h"
+#include "rendering/pipeline_state.h"
+#include "ResourceCache.h"
+
+using namespace vkb;
+
+namespace
+{
+/**
+ * @brief The pipeline state of an opaque draw of the base shaders into a color and a depth attachment
+ */
+PipelineState create_pipeline_state(PipelineLayout &pipeline_layout)
+{
+	PipelineState pipeline_state;
+	pipeline_state.set_pipeline_layout(pipeline_layout);
+
+	VertexInputState vertex_input_state;
+	vertex_input_state.bindings   = {{0, sizeof(float) * 3, VK_VERTEX_INPUT_RATE_VERTEX},
+	                                 {1, sizeof(float) * 2, VK_VERTEX_INPUT_RATE_VERTEX},
+	                                 {2, sizeof(float) * 3, VK_VERTEX_INPUT_RATE_VERTEX}};
+	vertex_input_state.attributes = {{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+	                                 {1, 1, VK_FORMAT_R32G32_SFLOAT, 0},
+	                                 {2, 2, VK_FORMAT_R32G32B32_SFLOAT, 0}};
+	pipeline_state.set_vertex_input_state(vertex_input_state);
+
+	ColorBlendState color_blend_state;
+	color_blend_state.attachments.resize(1);
+	pipeline_state.set_color_blend_state(color_blend_state);
+
+	RenderingState rendering_state;
+	rendering_state.color_attachment_formats = {VK_FORMAT_R8G8B8A8_SRGB};
+	rendering_state.depth_attachment_format  = VK_FORMAT_D32_SFLOAT;
+	pipeline_state.set_rendering_state(rendering_state);
+
+	pipeline_state.set_specialization_constant(0, to_bytes(1u));
+	pipeline_state.set_specialization_constant(1, to_bytes(4u));
+
+	return pipeline_state;
+}
+
+/**
+ * @brief The bindings of a draw of the base shaders, a few uniform buffers and textures in set 0
+ */
+void build_binding_maps(BindingMap<VkDescriptorBufferInfo> &buffer_infos, BindingMap<VkDescriptorImageInfo> &image_infos, uint64_t seed)
+{
+	buffer_infos.clear();
+	image_infos.clear();
+
+	for (uint32_t binding : {1u, 4u, 5u, 14u})
+	{
+		buffer_infos[binding][0] = {reinterpret_cast<VkBuffer>(seed + binding), 256 * binding, 256};
+	}
+
+	for (uint32_t binding : {0u, 2u, 3u})
+	{
+		image_infos[binding][0] = {reinterpret_cast<VkSampler>(seed), reinterpret_cast<VkImageView>(seed + binding), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+	}
+}
+}        // namespace
+
+TEST_CASE("Hashing of descriptor set bindings", "[benchmark]")
+{
+	BindingMap<VkDescriptorBufferInfo> buffer_infos;
+	BindingMap<VkDescriptorImageInfo>  image_infos;
+
+	BENCHMARK("BindingMap build")
+	{
+		build_binding_maps(buffer_infos, image_infos, 0x1000);
+		return buffer_infos.size() + image_infos.size();
+	};
+
+	BENCHMARK("BindingMap build and hash")
+	{
+		build_binding_maps(buffer_infos, image_infos, 0x1000);
+
+		size_t hash = 0;
+		hash_param(hash, buffer_infos, image_infos);
+		return hash;
+	};
+}
+
+TEST_CASE("Hashing of pipeline states", "[benchmark]")
+{
+	auto *device = benchmarks::get_device();
+	if (!device)
+	{
+		SKIP("No Vulkan device");
+	}
+
+	auto &resource_cache = device->get_resource_cache();
+
+	auto &vertex_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, ShaderSource{"base.vert"});
+	auto &fragment_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, ShaderSource{"base.frag"});
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&vertex_module, &fragment_module});
+
+	auto pipeline_state = create_pipeline_state(pipeline_layout);
+
+	// Alternating between two depth states invalidates the cached hash, like the draws changing their state
+	DepthStencilState depth_states[2];
+	depth_states[1].depth_write_enable = VK_FALSE;
+
+	std::hash<PipelineState> hasher;
+
+	BENCHMARK("PipelineState hash, cached")
+	{
+		return hasher(pipeline_state);
+	};
+
+	uint32_t draw = 0;
+
+	BENCHMARK("PipelineState hash, after a state change")
+	{
+		pipeline_state.set_depth_stencil_state(depth_states[++draw % 2]);
+		return hasher(pipeline_state);
+	};
+
+	BENCHMARK("PipelineLibraryState hash, fragment shader part")
+	{
+		pipeline_state.set_depth_stencil_state(depth_states[++draw % 2]);
+		return std::hash<PipelineLibraryState>{}(PipelineLibraryState{VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, pipeline_state});
+	};
+}
+
+TEST_CASE("ResourceCache lookups", "[benchmark]")
+{
+	auto *device = benchmarks::get_device();
+	if (!device)
+	{
+		SKIP("No Vulkan device");
+	}
+
+	auto &resource_cache = device->get_resource_cache();
+
+	auto &vertex_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, ShaderSource{"base.vert"});
+	auto &fragment_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, ShaderSource{"base.frag"});
+
+	const std::vector<ShaderModule *> shader_modules{&vertex_module, &fragment_module};
+	resource_cache.RequestPipelineLayout(shader_modules);
+
+	// Lookups of a frame, spread over the threads recording it
+	constexpr size_t LookupCount = 10000;
+
+	for (uint32_t thread_count : {1u, 2u, 4u, 8u})
+	{
+		JobSystem jobs{thread_count - 1};
+
+		BENCHMARK(std::to_string(LookupCount) + " pipeline layout hits, " + std::to_string(thread_count) + " threads")
+		{
+			std::atomic<size_t> found{0};
+			jobs.parallel_for(LookupCount, LookupCount / thread_count, [&](size_t first, size_t last) {
+				for (size_t i = first; i < last; ++i)
+				{
+					found += resource_cache.RequestPipelineLayout(shader_modules).get_handle() != VK_NULL_HANDLE;
+				}
+			});
+			return found.load();
+		};
+	}
+
+	// Every miss creates a descriptor set layout, with a binding no other one has
+	std::atomic<uint32_t> next_binding{0};
+
+	for (uint32_t thread_count : {1u, 4u})
+	{
+		JobSystem jobs{thread_count - 1};
+
+		constexpr size_t MissCount = 64;
+
+		BENCHMARK(std::to_string(MissCount) + " descriptor set layout misses, " + std::to_string(thread_count) + " threads")
+		{
+			jobs.parallel_for(MissCount, MissCount / thread_count, [&](size_t first, size_t last) {
+				for (size_t i = first; i < last; ++i)
+				{
+					ShaderResource resource{};
+					resource.stages     = VK_SHADER_STAGE_FRAGMENT_BIT;
+					resource.type       = ShaderResourceType::BufferUniform;
+					resource.mode       = ShaderResourceMode::Static;
+					resource.binding    = next_binding++;
+					resource.array_size = 1;
+					resource.name       = "benchmark_uniform";
+
+					resource_cache.RequestDescriptorSetLayout(0, shader_modules, {resource});
+				}
+			});
+			return next_binding.load();
+		};
+	}
+}
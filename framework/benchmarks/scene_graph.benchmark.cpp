@@ -0,0 +1,338 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <core/util/job_system.hpp>
+
+#include "benchmark_context.h"
+#include "common/glm_common.h"
+#include "geometry/aabb_batch.h"
+#include "geometry/frustum.h"
+#include "rendering/render_context.h"
+#include "rendering/subpasses/geometry_subpass.h"
+#include "scene_graph/components/aabb.h"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/pbr_material.h"
+#include "scene_graph/components/perspective_camera.h"
+#include "scene_graph/components/sub_mesh.h"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+using namespace vkb;
+
+namespace
+{
+/// Boxes of a large scene
+constexpr size_t BoxCount = 100000;
+
+/// Chains of nodes of a hierarchy, e.g. the bones of skinned characters
+constexpr size_t ChainCount = 1024;
+
+constexpr size_t ChainDepth = 8;
+
+glm::mat4 get_box_matrix(size_t index)
+{
+	float angle = static_cast<float>(index) * 0.01f;
+	return glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(index % 100), 0.0f, static_cast<float>(index / 100))),
+	                   angle, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+/**
+ * @brief A scene of chains of nodes under its root node
+ * @param nodes Set to the nodes of the chains
+ * @param leaves Set to the last node of every chain
+ */
+std::unique_ptr<sg::Scene> create_chain_scene(std::vector<sg::Node *> &nodes, std::vector<sg::Node *> &leaves)
+{
+	auto scene = std::make_unique<sg::Scene>("Chains");
+
+	auto root = std::make_unique<sg::Node>(0, "root");
+	scene->set_root_node(*root);
+	auto *root_node = root.get();
+	scene->add_node(std::move(root));
+
+	size_t id = 1;
+	for (size_t chain = 0; chain < ChainCount; ++chain)
+	{
+		sg::Node *parent = root_node;
+		for (size_t depth = 0; depth < ChainDepth; ++depth)
+		{
+			auto node = std::make_unique<sg::Node>(id, "node_" + std::to_string(id));
+			++id;
+
+			node->get_transform().set_translation(glm::vec3(0.0f, 1.0f, 0.0f));
+			node->get_transform().set_rotation(glm::angleAxis(0.1f, glm::vec3(0.0f, 0.0f, 1.0f)));
+			node->set_parent(*parent);
+			parent->add_child(*node);
+
+			parent = node.get();
+			nodes.push_back(node.get());
+			scene->add_node(std::move(node));
+		}
+		leaves.push_back(parent);
+	}
+
+	return scene;
+}
+
+/**
+ * @brief Exposes the sorting of the draws of a geometry subpass
+ */
+class SortingSubpass : public GeometrySubpass
+{
+  public:
+	using GeometrySubpass::GeometrySubpass;
+
+	size_t sort()
+	{
+		get_sorted_nodes(opaque_draws, transparent_draws);
+		return opaque_draws.size() + transparent_draws.size();
+	}
+
+  private:
+	std::vector<DrawPacket> opaque_draws;
+
+	std::vector<DrawPacket> transparent_draws;
+};
+
+/**
+ * @brief A scene of meshes of a sub mesh each, laid out on a grid in front of a camera
+ *        One in eight of the materials is transparent.
+ */
+std::unique_ptr<sg::Scene> create_mesh_scene(size_t sub_mesh_count, sg::PerspectiveCamera *&camera)
+{
+	constexpr size_t MaterialCount = 64;
+
+	auto scene = std::make_unique<sg::Scene>("Meshes");
+
+	auto root = std::make_unique<sg::Node>(0, "root");
+	scene->set_root_node(*root);
+	auto *root_node = root.get();
+	scene->add_node(std::move(root));
+
+	std::vector<sg::Material *> materials;
+	for (size_t i = 0; i < MaterialCount; ++i)
+	{
+		auto material        = std::make_unique<sg::PBRMaterial>("material_" + std::to_string(i));
+		material->alpha_mode = i % 8 == 0 ? sg::AlphaMode::Blend : sg::AlphaMode::Opaque;
+		materials.push_back(material.get());
+		scene->add_component(std::move(material));
+	}
+
+	size_t row_length = static_cast<size_t>(std::sqrt(static_cast<float>(sub_mesh_count))) + 1;
+
+	for (size_t i = 0; i < sub_mesh_count; ++i)
+	{
+		auto node = std::make_unique<sg::Node>(i + 1, "node_" + std::to_string(i));
+		node->get_transform().set_translation(glm::vec3(2.0f * static_cast<float>(i % row_length) - static_cast<float>(row_length),
+		                                                0.0f,
+		                                                -2.0f * static_cast<float>(i / row_length)));
+		node->set_parent(*root_node);
+		root_node->add_child(*node);
+
+		auto sub_mesh = std::make_unique<sg::SubMesh>("sub_mesh_" + std::to_string(i));
+		sub_mesh->set_material(*materials[i % MaterialCount]);
+
+		auto mesh = std::make_unique<sg::Mesh>("mesh_" + std::to_string(i));
+		mesh->update_bounds(sg::AABB{glm::vec3(-0.5f), glm::vec3(0.5f)});
+		mesh->add_submesh(*sub_mesh);
+		mesh->add_node(*node);
+		node->set_component(*mesh);
+
+		scene->add_component(std::move(sub_mesh));
+		scene->add_component(std::move(mesh));
+		scene->add_node(std::move(node));
+	}
+
+	// Looking down the grid, about half of it is in the frustum
+	auto camera_node = std::make_unique<sg::Node>(sub_mesh_count + 1, "camera");
+	camera_node->get_transform().set_translation(glm::vec3(0.0f, 10.0f, 10.0f));
+	camera_node->set_parent(*root_node);
+	root_node->add_child(*camera_node);
+
+	auto perspective_camera = std::make_unique<sg::PerspectiveCamera>("camera");
+	perspective_camera->set_aspect_ratio(16.0f / 9.0f);
+	perspective_camera->set_field_of_view(1.0f);
+	perspective_camera->set_near_plane(0.1f);
+	perspective_camera->set_far_plane(1000.0f);
+	perspective_camera->set_node(*camera_node);
+	camera = perspective_camera.get();
+
+	scene->add_component(std::move(perspective_camera), *camera_node);
+	scene->add_node(std::move(camera_node));
+
+	return scene;
+}
+}        // namespace
+
+TEST_CASE("AABB transforms", "[benchmark]")
+{
+	std::vector<glm::mat4> matrices(BoxCount);
+	for (size_t i = 0; i < BoxCount; ++i)
+	{
+		matrices[i] = get_box_matrix(i);
+	}
+
+	std::vector<sg::AABB> boxes(BoxCount, sg::AABB{glm::vec3(-0.5f), glm::vec3(0.5f)});
+
+	BENCHMARK("AABB::transform, " + std::to_string(BoxCount) + " boxes")
+	{
+		float sum = 0.0f;
+		for (size_t i = 0; i < BoxCount; ++i)
+		{
+			sg::AABB box = boxes[i];
+			box.transform(matrices[i]);
+			sum += box.get_max().x;
+		}
+		return sum;
+	};
+
+	AABBBatch batch;
+	for (size_t i = 0; i < BoxCount; ++i)
+	{
+		batch.add(glm::vec3(-0.5f), glm::vec3(0.5f));
+	}
+
+	uint32_t version = 0;
+
+	BENCHMARK("AABBBatch::update, " + std::to_string(BoxCount) + " boxes moved")
+	{
+		++version;
+		for (size_t i = 0; i < BoxCount; ++i)
+		{
+			batch.set_transform(i, version, matrices[i]);
+		}
+		batch.update();
+		return batch.get_max(BoxCount - 1).x;
+	};
+
+	BENCHMARK("AABBBatch::update, " + std::to_string(BoxCount) + " boxes static")
+	{
+		for (size_t i = 0; i < BoxCount; ++i)
+		{
+			batch.set_transform(i, version, matrices[i]);
+		}
+		batch.update();
+		return batch.get_max(BoxCount - 1).x;
+	};
+
+	Frustum frustum;
+	frustum.update(glm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 200.0f) *
+	               glm::lookAt(glm::vec3(50.0f, 10.0f, -10.0f), glm::vec3(50.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+	std::vector<uint8_t> visible;
+
+	BENCHMARK("AABBBatch::cull, " + std::to_string(BoxCount) + " boxes")
+	{
+		batch.cull(frustum, visible);
+		return visible.size();
+	};
+
+	BENCHMARK("AABBBatch::cull, " + std::to_string(BoxCount) + " boxes, job system")
+	{
+		batch.cull(frustum, visible, &JobSystem::get());
+		return visible.size();
+	};
+}
+
+TEST_CASE("Transform world matrix chains", "[benchmark]")
+{
+	const std::string suffix = std::to_string(ChainCount) + " chains of " + std::to_string(ChainDepth) + " nodes";
+
+	// The local transforms of the lazy path don't invalidate their children, each node of the chains is moved
+	std::vector<sg::Node *> lazy_nodes;
+	std::vector<sg::Node *> lazy_leaves;
+	auto                    lazy_scene = create_chain_scene(lazy_nodes, lazy_leaves);
+
+	BENCHMARK("Transform::get_world_matrix, lazy, " + suffix)
+	{
+		for (auto *node : lazy_nodes)
+		{
+			node->get_transform().set_translation(glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+
+		float sum = 0.0f;
+		for (auto *leaf : lazy_leaves)
+		{
+			sum += leaf->get_transform().get_world_matrix()[3].y;
+		}
+		return sum;
+	};
+
+	std::vector<sg::Node *> store_nodes;
+	std::vector<sg::Node *> store_leaves;
+	auto                    store_scene = create_chain_scene(store_nodes, store_leaves);
+	store_scene->update_transforms();
+
+	auto &store_root = store_scene->get_root_node();
+
+	BENCHMARK("Transform::get_world_matrix, transform store, " + suffix)
+	{
+		store_root.get_transform().set_translation(glm::vec3(0.0f, 1.0f, 0.0f));
+		store_scene->update_transforms();
+
+		float sum = 0.0f;
+		for (auto *leaf : store_leaves)
+		{
+			sum += leaf->get_transform().get_world_matrix()[3].y;
+		}
+		return sum;
+	};
+
+	BENCHMARK("Transform::get_world_matrix, transform store, job system, " + suffix)
+	{
+		store_root.get_transform().set_translation(glm::vec3(0.0f, 1.0f, 0.0f));
+		store_scene->update_transforms(&JobSystem::get());
+
+		float sum = 0.0f;
+		for (auto *leaf : store_leaves)
+		{
+			sum += leaf->get_transform().get_world_matrix()[3].y;
+		}
+		return sum;
+	};
+}
+
+TEST_CASE("GeometrySubpass draw sorting", "[benchmark]")
+{
+	auto *render_context = benchmarks::get_render_context();
+	if (!render_context)
+	{
+		SKIP("No Vulkan device");
+	}
+
+	for (size_t sub_mesh_count : {1000u, 10000u, 100000u})
+	{
+		sg::PerspectiveCamera *camera = nullptr;
+		auto                   scene  = create_mesh_scene(sub_mesh_count, camera);
+
+		SortingSubpass subpass{*render_context, ShaderSource{"base.vert"}, ShaderSource{"base.frag"}, *scene, *camera};
+
+		BENCHMARK("GeometrySubpass::get_sorted_nodes, " + std::to_string(sub_mesh_count) + " sub meshes")
+		{
+			return subpass.sort();
+		};
+	}
+}
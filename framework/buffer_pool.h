@@ -21,6 +21,7 @@
 #include "core/buffer.h"
 #include "core/device.h"
 #include "core/hpp_device.h"
+#include "core/util/free_list_allocator.hpp"
 
 namespace vkb
 {
@@ -48,9 +49,25 @@ class BufferAllocation
 	DeviceSizeType                  get_offset() const;
 	DeviceSizeType                  get_size() const;
 	void                            update(const std::vector<uint8_t> &data, uint32_t offset = 0);
+	void                            update(const void *data, size_t data_size, uint32_t offset = 0);
 	template <typename T>
 	void update(const T &value, uint32_t offset = 0);
 
+	/**
+	 * @brief Flushes the range of the allocation, needed after writing through map() if the memory is not coherent
+	 */
+	void flush();
+
+	/**
+	 * @brief Gives direct access to the mapped memory of the allocation, to write data in place without a staging copy.
+	 *        Call flush() once the writes are done.
+	 * @param offset Offset in bytes from the start of the allocation
+	 * @param count Number of elements of type T
+	 * @return A pointer to count objects of type T, or nullptr if they do not fit in the allocation
+	 */
+	template <typename T>
+	T *map(uint32_t offset = 0, size_t count = 1);
+
   private:
 	vkb::core::BufferCpp *buffer = nullptr;
 	vk::DeviceSize        offset = 0;
@@ -135,13 +152,66 @@ void BufferAllocation<bindingType>::update(const std::vector<uint8_t> &data, uin
 	}
 }
 
+template <vkb::BindingType bindingType>
+void BufferAllocation<bindingType>::update(const void *data, size_t data_size, uint32_t offset)
+{
+	assert(buffer && "Invalid buffer pointer");
+
+	if (offset + data_size <= size)
+	{
+		buffer->update(data, data_size, to_u32(this->offset) + offset);
+	}
+	else
+	{
+		LOGE("Ignore buffer allocation update");
+	}
+}
+
 template <vkb::BindingType bindingType>
 template <typename T>
 void BufferAllocation<bindingType>::update(const T &value, uint32_t offset)
 {
-	update(to_bytes(value), offset);
+	static_assert(std::is_trivially_copyable<T>::value, "Buffer data must be trivially copyable");
+	update(&value, sizeof(T), offset);
+}
+
+template <vkb::BindingType bindingType>
+void BufferAllocation<bindingType>::flush()
+{
+	assert(buffer && "Invalid buffer pointer");
+	buffer->flush(offset, size);
+}
+
+template <vkb::BindingType bindingType>
+template <typename T>
+T *BufferAllocation<bindingType>::map(uint32_t offset, size_t count)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Buffer data must be trivially copyable");
+	assert(buffer && "Invalid buffer pointer");
+
+	if (offset + count * sizeof(T) > size)
+	{
+		LOGE("Ignore buffer allocation map, range is out of bounds");
+		return nullptr;
+	}
+
+	uint8_t *data = buffer->map() + this->offset + offset;
+	assert(reinterpret_cast<uintptr_t>(data) % alignof(T) == 0 && "Mapped data is misaligned for this type");
+
+	return reinterpret_cast<T *>(data);
 }
 
+/**
+ * @brief How a BufferBlock hands out memory of its underlying Vulkan buffer
+ */
+enum class BufferBlockStrategy
+{
+	/// Bump allocator, memory is only reclaimed by reset(). Best suited for per-frame data
+	Linear,
+	/// Best-fit free list with coalescing, allocations can be returned individually with free()
+	FreeList
+};
+
 /**
  * @brief Helper class which handles multiple allocation from the same underlying Vulkan buffer.
  */
@@ -161,13 +231,27 @@ class BufferBlock
 	BufferBlock &operator=(BufferBlock const &rhs) = delete;
 	BufferBlock &operator=(BufferBlock &&rhs)      = default;
 
-	BufferBlock(DeviceType &device, DeviceSizeType size, BufferUsageFlagsType usage, VmaMemoryUsage memory_usage);
+	/**
+	 * @param memory_usage VMA_MEMORY_USAGE_CPU_TO_GPU places the block where vkb::allocated::get_per_frame_placement chooses
+	 */
+	BufferBlock(DeviceType &device, DeviceSizeType size, BufferUsageFlagsType usage, VmaMemoryUsage memory_usage, BufferBlockStrategy strategy = BufferBlockStrategy::Linear);
 
 	/**
 	 * @return An usable view on a portion of the underlying buffer
 	 */
 	BufferAllocation<bindingType> allocate(DeviceSizeType size);
 
+	/**
+	 * @brief Returns an allocation to the block, only supported by BufferBlockStrategy::FreeList
+	 * @param allocation An allocation made from this block, it is empty afterwards
+	 */
+	void free(BufferAllocation<bindingType> &allocation);
+
+	/**
+	 * @return \c true if \a allocation was made from this \c BufferBlock
+	 */
+	bool owns(BufferAllocation<bindingType> &allocation) const;
+
 	/**
 	 * @brief check if this BufferBlock can allocate a given amount of memory
 	 * @param size the number of bytes to check
@@ -175,39 +259,60 @@ class BufferBlock
 	 */
 	bool can_allocate(DeviceSizeType size) const;
 
-	DeviceSizeType get_size() const;
-	void           reset();
+	DeviceSizeType      get_size() const;
+	BufferBlockStrategy get_strategy() const;
+	void                reset();
+
+	/**
+	 * @return The number of bytes allocated from this \c BufferBlock, including the alignment padding between allocations
+	 */
+	DeviceSizeType get_used_size() const;
 
   private:
+	static vkb::core::BufferCpp create_buffer(DeviceType &device, vk::DeviceSize size, vk::BufferUsageFlags usage, VmaMemoryUsage memory_usage);
+
 	/**
 	 * @ brief Determine the current aligned offset.
 	 * @return The current aligned offset.
 	 */
 	vk::DeviceSize aligned_offset() const;
+	vk::DeviceSize align(vk::DeviceSize value) const;
 	vk::DeviceSize determine_alignment(vk::BufferUsageFlags usage, vk::PhysicalDeviceLimits const &limits) const;
 
   private:
 	vkb::core::BufferCpp buffer;
 	vk::DeviceSize       alignment = 0;        // Memory alignment, it may change according to the usage
 	vk::DeviceSize       offset    = 0;        // Current offset, it increases on every allocation
+	BufferBlockStrategy  strategy  = BufferBlockStrategy::Linear;
+
+	// Free ranges of a FreeList block
+	FreeListAllocator free_list;
 };
 
 using BufferBlockC   = BufferBlock<vkb::BindingType::C>;
 using BufferBlockCpp = BufferBlock<vkb::BindingType::Cpp>;
 
 template <vkb::BindingType bindingType>
-BufferBlock<bindingType>::BufferBlock(DeviceType &device, DeviceSizeType size, BufferUsageFlagsType usage, VmaMemoryUsage memory_usage) :
-    buffer{device, size, usage, memory_usage}
+BufferBlock<bindingType>::BufferBlock(DeviceType &device, DeviceSizeType size, BufferUsageFlagsType usage, VmaMemoryUsage memory_usage, BufferBlockStrategy strategy) :
+    buffer{create_buffer(device, size, usage, memory_usage)}, strategy{strategy}
 {
-	if constexpr (bindingType == BindingType::Cpp)
+	auto hpp_usage = static_cast<vk::BufferUsageFlags>(usage);
+
+	if (hpp_usage & (vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT | vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT))
+	{
+		// Descriptor sets written into a descriptor buffer are bound at offsets aligned for the device
+		alignment = device.get_descriptor_buffer_properties().descriptorBufferOffsetAlignment;
+	}
+	else if constexpr (bindingType == BindingType::Cpp)
 	{
 		alignment = determine_alignment(usage, device.get_gpu().get_properties().limits);
 	}
 	else
 	{
-		alignment =
-		    determine_alignment(static_cast<vk::BufferUsageFlags>(usage), static_cast<vk::PhysicalDeviceLimits>(device.get_gpu().get_properties().limits));
+		alignment = determine_alignment(hpp_usage, static_cast<vk::PhysicalDeviceLimits>(device.get_gpu().get_properties().limits));
 	}
+
+	reset();
 }
 
 template <vkb::BindingType bindingType>
@@ -215,9 +320,19 @@ BufferAllocation<bindingType> BufferBlock<bindingType>::allocate(DeviceSizeType
 {
 	if (can_allocate(size))
 	{
-		// Move the current offset and return an allocation
-		auto aligned = aligned_offset();
-		offset       = aligned + size;
+		vk::DeviceSize aligned = 0;
+
+		if (strategy == BufferBlockStrategy::Linear)
+		{
+			// Move the current offset and return an allocation
+			aligned = aligned_offset();
+			offset  = aligned + size;
+		}
+		else
+		{
+			aligned = free_list.allocate(size);
+		}
+
 		if constexpr (bindingType == vkb::BindingType::Cpp)
 		{
 			return BufferAllocationCpp{buffer, size, aligned};
@@ -232,11 +347,32 @@ BufferAllocation<bindingType> BufferBlock<bindingType>::allocate(DeviceSizeType
 	return BufferAllocation<bindingType>{};
 }
 
+template <vkb::BindingType bindingType>
+void BufferBlock<bindingType>::free(BufferAllocation<bindingType> &allocation)
+{
+	assert(strategy == BufferBlockStrategy::FreeList && "Only free-list buffer blocks support freeing single allocations");
+	assert(owns(allocation) && "Allocation does not belong to this buffer block");
+
+	free_list.free(allocation.get_offset(), allocation.get_size());
+
+	allocation = BufferAllocation<bindingType>{};
+}
+
+template <vkb::BindingType bindingType>
+bool BufferBlock<bindingType>::owns(BufferAllocation<bindingType> &allocation) const
+{
+	return !allocation.empty() && reinterpret_cast<const void *>(&allocation.get_buffer()) == reinterpret_cast<const void *>(&buffer);
+}
+
 template <vkb::BindingType bindingType>
 bool BufferBlock<bindingType>::can_allocate(DeviceSizeType size) const
 {
 	assert(size > 0 && "Allocation size must be greater than zero");
-	return (aligned_offset() + size <= buffer.get_size());
+	if (strategy == BufferBlockStrategy::Linear)
+	{
+		return (aligned_offset() + size <= buffer.get_size());
+	}
+	return free_list.can_allocate(size);
 }
 
 template <vkb::BindingType bindingType>
@@ -245,16 +381,56 @@ typename BufferBlock<bindingType>::DeviceSizeType BufferBlock<bindingType>::get_
 	return buffer.get_size();
 }
 
+template <vkb::BindingType bindingType>
+BufferBlockStrategy BufferBlock<bindingType>::get_strategy() const
+{
+	return strategy;
+}
+
+template <vkb::BindingType bindingType>
+typename BufferBlock<bindingType>::DeviceSizeType BufferBlock<bindingType>::get_used_size() const
+{
+	vk::DeviceSize used_size = offset;
+	if (strategy == BufferBlockStrategy::FreeList)
+	{
+		used_size = free_list.get_size() - free_list.get_free_size();
+	}
+	return used_size;
+}
+
 template <vkb::BindingType bindingType>
 void BufferBlock<bindingType>::reset()
 {
 	offset = 0;
+
+	if (strategy == BufferBlockStrategy::FreeList)
+	{
+		free_list = FreeListAllocator{buffer.get_size(), alignment};
+	}
+}
+
+template <vkb::BindingType bindingType>
+vkb::core::BufferCpp BufferBlock<bindingType>::create_buffer(DeviceType &device, vk::DeviceSize size, vk::BufferUsageFlags usage, VmaMemoryUsage memory_usage)
+{
+	if (memory_usage != VMA_MEMORY_USAGE_CPU_TO_GPU)
+	{
+		return vkb::core::BufferCpp{device, size, usage, memory_usage};
+	}
+
+	auto placement = vkb::allocated::get_per_frame_placement(size);
+	return vkb::core::BufferCpp{device, size, usage, placement.memory_usage, placement.flags};
 }
 
 template <vkb::BindingType bindingType>
 vk::DeviceSize BufferBlock<bindingType>::aligned_offset() const
 {
-	return (offset + alignment - 1) & ~(alignment - 1);
+	return align(offset);
+}
+
+template <vkb::BindingType bindingType>
+vk::DeviceSize BufferBlock<bindingType>::align(vk::DeviceSize value) const
+{
+	return (value + alignment - 1) & ~(alignment - 1);
 }
 
 template <vkb::BindingType bindingType>
@@ -297,6 +473,9 @@ vk::DeviceSize BufferBlock<bindingType>::determine_alignment(vk::BufferUsageFlag
  * overwritten. The minimum allocation size is 256 kb, if you ask for more you get a dedicated
  * buffer allocation.
  *
+ * A pool created with BufferBlockStrategy::FreeList serves long-lived allocations of varying
+ * lifetime instead: they are returned one by one with free(), reset() releases all of them.
+ *
  * We re-use descriptor sets: we only need one for the corresponding buffer infos (and we only
  * have one VkBuffer per BufferBlock), then it is bound and we use dynamic offsets.
  */
@@ -310,26 +489,53 @@ class BufferPool
 	using DeviceType = typename std::conditional<bindingType == vkb::BindingType::Cpp, vkb::core::HPPDevice, vkb::Device>::type;
 
   public:
-	BufferPool(DeviceType &device, DeviceSizeType block_size, BufferUsageFlagsType usage, VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU);
+	BufferPool(DeviceType          &device,
+	           DeviceSizeType       block_size,
+	           BufferUsageFlagsType usage,
+	           VmaMemoryUsage       memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU,
+	           BufferBlockStrategy  strategy     = BufferBlockStrategy::Linear);
 
 	BufferBlock<bindingType> &request_buffer_block(DeviceSizeType minimum_size, bool minimal = false);
 
+	/**
+	 * @brief Returns an allocation to the block it was made from, see BufferBlock::free
+	 */
+	void free(BufferAllocation<bindingType> &allocation);
+
 	void reset();
 
+	/**
+	 * @brief Destroys the blocks, so that the next ones are placed with the current allocation settings
+	 *        The GPU must be done with them, and nothing may refer to them anymore.
+	 */
+	void clear();
+
+	/**
+	 * @return The number of bytes allocated from the blocks of the pool
+	 */
+	DeviceSizeType get_used_size() const;
+
+	/**
+	 * @return The total size of the blocks of the pool
+	 */
+	DeviceSizeType get_size() const;
+
   private:
 	vkb::core::HPPDevice                        &device;
 	std::vector<std::unique_ptr<BufferBlockCpp>> buffer_blocks;         /// List of blocks requested (need to be pointers in order to keep their address constant on vector resizing)
 	vk::DeviceSize                               block_size = 0;        /// Minimum size of the blocks
 	vk::BufferUsageFlags                         usage;
 	VmaMemoryUsage                               memory_usage{};
+	BufferBlockStrategy                          strategy = BufferBlockStrategy::Linear;
 };
 
 using BufferPoolC   = BufferPool<vkb::BindingType::C>;
 using BufferPoolCpp = BufferPool<vkb::BindingType::Cpp>;
 
 template <vkb::BindingType bindingType>
-BufferPool<bindingType>::BufferPool(DeviceType &device, DeviceSizeType block_size, BufferUsageFlagsType usage, VmaMemoryUsage memory_usage) :
-    device{reinterpret_cast<vkb::core::HPPDevice &>(device)}, block_size{block_size}, usage{usage}, memory_usage{memory_usage}
+BufferPool<bindingType>::BufferPool(
+    DeviceType &device, DeviceSizeType block_size, BufferUsageFlagsType usage, VmaMemoryUsage memory_usage, BufferBlockStrategy strategy) :
+    device{reinterpret_cast<vkb::core::HPPDevice &>(device)}, block_size{block_size}, usage{usage}, memory_usage{memory_usage}, strategy{strategy}
 {
 }
 
@@ -351,7 +557,7 @@ BufferBlock<bindingType> &BufferPool<bindingType>::request_buffer_block(DeviceSi
 		vk::DeviceSize new_block_size = minimal ? minimum_size : std::max(block_size, minimum_size);
 
 		// Create a new block and get the iterator on it
-		it = buffer_blocks.emplace(buffer_blocks.end(), std::make_unique<BufferBlockCpp>(device, new_block_size, usage, memory_usage));
+		it = buffer_blocks.emplace(buffer_blocks.end(), std::make_unique<BufferBlockCpp>(device, new_block_size, usage, memory_usage, strategy));
 	}
 
 	if constexpr (bindingType == vkb::BindingType::Cpp)
@@ -364,6 +570,17 @@ BufferBlock<bindingType> &BufferPool<bindingType>::request_buffer_block(DeviceSi
 	}
 }
 
+template <vkb::BindingType bindingType>
+void BufferPool<bindingType>::free(BufferAllocation<bindingType> &allocation)
+{
+	auto it = std::find_if(buffer_blocks.begin(),
+	                       buffer_blocks.end(),
+	                       [&allocation](auto const &buffer_block) { return reinterpret_cast<BufferBlock<bindingType> &>(*buffer_block).owns(allocation); });
+
+	assert(it != buffer_blocks.end() && "Allocation does not belong to this buffer pool");
+	reinterpret_cast<BufferBlock<bindingType> &>(**it).free(allocation);
+}
+
 template <vkb::BindingType bindingType>
 void BufferPool<bindingType>::reset()
 {
@@ -376,4 +593,32 @@ void BufferPool<bindingType>::reset()
 	}
 }
 
+template <vkb::BindingType bindingType>
+void BufferPool<bindingType>::clear()
+{
+	buffer_blocks.clear();
+}
+
+template <vkb::BindingType bindingType>
+typename BufferPool<bindingType>::DeviceSizeType BufferPool<bindingType>::get_used_size() const
+{
+	vk::DeviceSize used_size = 0;
+	for (auto &buffer_block : buffer_blocks)
+	{
+		used_size += buffer_block->get_used_size();
+	}
+	return used_size;
+}
+
+template <vkb::BindingType bindingType>
+typename BufferPool<bindingType>::DeviceSizeType BufferPool<bindingType>::get_size() const
+{
+	vk::DeviceSize size = 0;
+	for (auto &buffer_block : buffer_blocks)
+	{
+		size += buffer_block->get_size();
+	}
+	return size;
+}
+
 }        // namespace vkb
@@ -0,0 +1,160 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "buffer_ring.h"
+
+#include "core/util/logging.hpp"
+
+namespace vkb
+{
+namespace
+{
+VkDeviceSize determine_alignment(VkBufferUsageFlags usage, const VkPhysicalDeviceLimits &limits)
+{
+	VkDeviceSize alignment = 16;
+
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+	{
+		alignment = std::max(alignment, limits.minUniformBufferOffsetAlignment);
+	}
+	if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+	{
+		alignment = std::max(alignment, limits.minStorageBufferOffsetAlignment);
+	}
+	if (usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
+	{
+		alignment = std::max(alignment, limits.minTexelBufferOffsetAlignment);
+	}
+
+	return alignment;
+}
+
+vkb::core::BufferC create_buffer(Device &device, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+	auto placement = allocated::get_per_frame_placement(size);
+	return vkb::core::BufferC{device, size, usage, placement.memory_usage, placement.flags};
+}
+}        // namespace
+
+BufferRing::BufferRing(Device &device, VkDeviceSize size, VkBufferUsageFlags usage) :
+    buffer{create_buffer(device, size, usage)},
+    alignment{determine_alignment(usage, device.get_gpu().get_properties().limits)}
+{
+}
+
+BufferAllocationC BufferRing::allocate(const void *owner, VkDeviceSize size)
+{
+	assert(size > 0 && "Allocation size must be greater than zero");
+
+	std::lock_guard<std::mutex> guard(mutex);
+
+	const VkDeviceSize ring_size = buffer.get_size();
+
+	VkDeviceSize offset = (head + alignment - 1) & ~(alignment - 1);
+	VkDeviceSize cost   = offset - head + size;
+
+	if (offset + size > ring_size)
+	{
+		// Skip the end of the ring and wrap around, the skipped bytes are accounted to this allocation
+		offset = 0;
+		cost   = ring_size - head + size;
+	}
+
+	if (used_size + cost > ring_size)
+	{
+		return BufferAllocationC{};
+	}
+
+	if (regions.empty() || regions.back().owner != owner || regions.back().released)
+	{
+		regions.push_back(Region{owner, 0, false});
+	}
+	regions.back().size += cost;
+
+	head = offset + size;
+	used_size += cost;
+
+	return BufferAllocationC{buffer, size, offset};
+}
+
+void BufferRing::release(const void *owner)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	for (auto &region : regions)
+	{
+		if (region.owner == owner)
+		{
+			region.released = true;
+		}
+	}
+
+	while (!regions.empty() && regions.front().released)
+	{
+		used_size -= regions.front().size;
+		regions.pop_front();
+	}
+
+	if (regions.empty())
+	{
+		// Nothing in flight, restart from the beginning to avoid wrapping early
+		head      = 0;
+		used_size = 0;
+	}
+}
+
+VkDeviceSize BufferRing::get_size() const
+{
+	return buffer.get_size();
+}
+
+VkDeviceSize BufferRing::get_used_size() const
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	return used_size;
+}
+
+BufferRingSet::BufferRingSet(Device &device, uint32_t size_multiplier) :
+    device{device},
+    size_multiplier{size_multiplier}
+{
+}
+
+BufferRing &BufferRingSet::get_ring(VkBufferUsageFlags usage, VkDeviceSize block_size)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	auto &ring = rings[usage];
+	if (!ring)
+	{
+		LOGD("Building buffer ring ({})", usage);
+		ring = std::make_unique<BufferRing>(device, block_size * size_multiplier, usage);
+	}
+
+	return *ring;
+}
+
+void BufferRingSet::release(const void *owner)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	for (auto &ring : rings)
+	{
+		ring.second->release(owner);
+	}
+}
+}        // namespace vkb
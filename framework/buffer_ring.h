@@ -0,0 +1,127 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "buffer_pool.h"
+
+namespace vkb
+{
+/**
+ * @brief A persistently mapped ring buffer shared by all the frames in flight.
+ *
+ * Each frame allocates from the head of the ring. Once the fence of a frame has been waited
+ * on, the frame returns its allocations with release(), and the tail of the ring moves past
+ * every region that is no longer used by the GPU. Frames do not need to complete in order:
+ * a region is only reclaimed after all the regions allocated before it.
+ */
+class BufferRing
+{
+  public:
+	BufferRing(Device &device, VkDeviceSize size, VkBufferUsageFlags usage);
+
+	BufferRing(const BufferRing &) = delete;
+
+	BufferRing(BufferRing &&) = delete;
+
+	BufferRing &operator=(const BufferRing &) = delete;
+
+	BufferRing &operator=(BufferRing &&) = delete;
+
+	/**
+	 * @param owner The frame the allocation is used by
+	 * @param size Amount of memory required
+	 * @return The requested allocation, empty if the ring is full
+	 */
+	BufferAllocationC allocate(const void *owner, VkDeviceSize size);
+
+	/**
+	 * @brief Returns all allocations of a frame, the GPU must not use them anymore
+	 * @param owner The frame passed to allocate()
+	 */
+	void release(const void *owner);
+
+	VkDeviceSize get_size() const;
+
+	/**
+	 * @return The amount of memory used by the frames in flight, including alignment padding
+	 */
+	VkDeviceSize get_used_size() const;
+
+  private:
+	struct Region
+	{
+		const void  *owner;
+		VkDeviceSize size;
+		bool         released;
+	};
+
+	core::BufferC buffer;
+
+	VkDeviceSize alignment{0};
+
+	/// Offset of the next allocation
+	VkDeviceSize head{0};
+
+	/// Bytes between the tail and the head of the ring
+	VkDeviceSize used_size{0};
+
+	/// Allocated regions, oldest first
+	std::deque<Region> regions;
+
+	mutable std::mutex mutex;
+};
+
+/**
+ * @brief The buffer rings of a RenderContext, one per buffer usage, created on first use
+ */
+class BufferRingSet
+{
+  public:
+	/**
+	 * @param device A valid device
+	 * @param size_multiplier Size of the rings, in blocks of RenderFrame::BUFFER_POOL_BLOCK_SIZE
+	 */
+	BufferRingSet(Device &device, uint32_t size_multiplier);
+
+	/**
+	 * @param usage Usage of the buffer
+	 * @param block_size Size of a buffer pool block for this usage
+	 * @return The ring of the given usage
+	 */
+	BufferRing &get_ring(VkBufferUsageFlags usage, VkDeviceSize block_size);
+
+	/**
+	 * @brief Returns the allocations of a frame to all rings
+	 */
+	void release(const void *owner);
+
+  private:
+	Device &device;
+
+	uint32_t size_multiplier;
+
+	std::mutex mutex;
+
+	std::map<VkBufferUsageFlags, std::unique_ptr<BufferRing>> rings;
+};
+}        // namespace vkb
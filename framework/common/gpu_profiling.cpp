@@ -0,0 +1,109 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/gpu_profiling.h"
+
+#include "core/device.h"
+
+namespace vkb
+{
+namespace gpu_profiling
+{
+#ifdef TRACY_ENABLE
+namespace
+{
+tracy::VkCtx *context{nullptr};
+}        // namespace
+
+void create_context(Device &device)
+{
+	assert(!context && "The GPU profiling context was already created");
+
+	// The graphics queue, or the compute queue of a device without graphics
+	auto &queue = device.get_compute_queue();
+	if (queue.get_properties().timestampValidBits == 0)
+	{
+		LOGW("The queue of the frames doesn't support timestamps, GPU zones won't be traced");
+		return;
+	}
+
+	// The context calibrates its timestamps with a command buffer it submits and waits for, only needed while it's created
+	VkCommandPoolCreateInfo pool_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+	pool_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	pool_info.queueFamilyIndex = queue.get_family_index();
+
+	VkCommandPool command_pool{VK_NULL_HANDLE};
+	VK_CHECK(vkCreateCommandPool(device.get_handle(), &pool_info, nullptr, &command_pool));
+
+	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocate_info.commandPool        = command_pool;
+	allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount = 1;
+
+	VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+	VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, &command_buffer));
+
+	// With calibrated timestamps the GPU zones are placed on the CPU clock exactly, and recalibrated as the clocks drift
+	if (device.is_enabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+	{
+		context = TracyVkContextCalibrated(device.get_gpu().get_handle(), device.get_handle(), queue.get_handle(), command_buffer,
+		                                   vkGetPhysicalDeviceCalibrateableTimeDomainsEXT, vkGetCalibratedTimestampsEXT);
+	}
+	else
+	{
+		context = TracyVkContext(device.get_gpu().get_handle(), device.get_handle(), queue.get_handle(), command_buffer);
+	}
+
+	const char name[] = "Graphics queue";
+	TracyVkContextName(context, name, static_cast<uint16_t>(sizeof(name) - 1));
+
+	vkDestroyCommandPool(device.get_handle(), command_pool, nullptr);
+}
+
+void destroy_context()
+{
+	if (context)
+	{
+		TracyVkDestroy(context);
+		context = nullptr;
+	}
+}
+
+void collect(VkCommandBuffer command_buffer)
+{
+	if (context)
+	{
+		TracyVkCollect(context, command_buffer);
+	}
+}
+
+tracy::VkCtx *get_context()
+{
+	return context;
+}
+#else
+void create_context(Device &)
+{}
+
+void destroy_context()
+{}
+
+void collect(VkCommandBuffer)
+{}
+#endif
+}        // namespace gpu_profiling
+}        // namespace vkb
@@ -0,0 +1,75 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <core/util/profiling.hpp>
+
+#include "common/vk_common.h"
+
+#ifdef TRACY_ENABLE
+#	include <tracy/TracyVulkan.hpp>
+#endif
+
+namespace vkb
+{
+class Device;
+
+/**
+ * @brief Tracy context of the GPU zones, recorded in the command buffers of the graphics queue
+ *
+ * The context is created once the device exists, the GPU zones recorded before aren't traced.
+ * Without TRACY_ENABLE the functions do nothing.
+ */
+namespace gpu_profiling
+{
+/**
+ * @brief Creates the context on the first graphics queue of the device, if its family supports timestamps
+ */
+void create_context(Device &device);
+
+void destroy_context();
+
+/**
+ * @brief Reads the timestamps of the completed zones, once per frame
+ * @param command_buffer Command buffer of the frame, recorded outside of a render pass before its zones
+ */
+void collect(VkCommandBuffer command_buffer);
+
+#ifdef TRACY_ENABLE
+/**
+ * @return The context, nullptr if it wasn't created
+ */
+tracy::VkCtx *get_context();
+#endif
+}        // namespace gpu_profiling
+}        // namespace vkb
+
+#ifdef TRACY_ENABLE
+// Trace a scope on the CPU, and the commands it records on the GPU under the same name
+#	define PROFILE_GPU_SCOPE(command_buffer, name) \
+		PROFILE_SCOPE(name);                        \
+		TracyVkNamedZone(vkb::gpu_profiling::get_context(), ___tracy_gpu_zone, command_buffer, name, vkb::gpu_profiling::get_context() != nullptr)
+
+// Same with a name only known at runtime, the GPU zone is skipped if active is false, e.g. in subpasses recorded in secondary command buffers
+#	define PROFILE_GPU_SCOPE_DYNAMIC(command_buffer, name, active)    \
+		ZoneTransientN(___tracy_scoped_zone, name, true);              \
+		TracyVkZoneTransient(vkb::gpu_profiling::get_context(), ___tracy_gpu_zone, command_buffer, name, (active) && vkb::gpu_profiling::get_context() != nullptr)
+#else
+#	define PROFILE_GPU_SCOPE(command_buffer, name)
+#	define PROFILE_GPU_SCOPE_DYNAMIC(command_buffer, name, active)
+#endif
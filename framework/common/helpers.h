@@ -21,6 +21,7 @@
 #include <array>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <iterator>
@@ -30,6 +31,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -173,6 +175,74 @@ inline void hash_combine(size_t &seed, const T &v)
 	glm::detail::hash_combine(seed, hasher(v));
 }
 
+/**
+ * @brief Hashes a run of bytes in a single pass, following the short input path of XXH64
+ *        Cheaper than hash_combine over each member of a plain struct, with a better distribution.
+ * @param seed The hash of the preceding data, to chain several runs
+ */
+inline size_t hash_bytes(const void *data, size_t size, uint64_t seed = 0)
+{
+	constexpr uint64_t prime_1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t prime_2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t prime_3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t prime_4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t prime_5 = 0x27D4EB2F165667C5ull;
+
+	auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+
+	auto     bytes = static_cast<const uint8_t *>(data);
+	uint64_t hash  = seed + prime_5 + size;
+
+	for (; size >= 8; size -= 8, bytes += 8)
+	{
+		uint64_t lane;
+		std::memcpy(&lane, bytes, sizeof(lane));
+		hash ^= rotl(lane * prime_2, 31) * prime_1;
+		hash = rotl(hash, 27) * prime_1 + prime_4;
+	}
+
+	if (size >= 4)
+	{
+		uint32_t lane;
+		std::memcpy(&lane, bytes, sizeof(lane));
+		hash ^= lane * prime_1;
+		hash = rotl(hash, 23) * prime_2 + prime_3;
+		size -= 4;
+		bytes += 4;
+	}
+
+	for (; size > 0; --size, ++bytes)
+	{
+		hash ^= *bytes * prime_5;
+		hash = rotl(hash, 11) * prime_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= prime_2;
+	hash ^= hash >> 29;
+	hash *= prime_3;
+	hash ^= hash >> 32;
+
+	return static_cast<size_t>(hash);
+}
+
+/**
+ * @brief Hashes an array of plain structs with hash_bytes
+ *        The structs can't have padding, as its bytes are undefined.
+ */
+template <class T>
+inline size_t hash_pod(const T *values, size_t count, uint64_t seed = 0)
+{
+	static_assert(std::has_unique_object_representations_v<T>, "T must be a plain struct without padding");
+	return hash_bytes(values, count * sizeof(T), seed);
+}
+
+template <class T>
+inline size_t hash_pod(const T &value, uint64_t seed = 0)
+{
+	return hash_pod(&value, 1, seed);
+}
+
 /**
  * @brief Helper function to convert a data type
  *        to string using output stream operator.
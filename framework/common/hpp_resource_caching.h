@@ -18,6 +18,7 @@
 #pragma once
 
 #include "resource_caching.h"
+#include <HppResourceRecord.h>
 #include <core/hpp_device.h>
 #include <vulkan/vulkan_hash.hpp>
 
@@ -39,6 +40,22 @@ struct hash<std::map<Key, Value>>
 	}
 };
 
+template <typename Key, typename Value>
+struct hash<vkb::FlatMap<Key, Value>>
+{
+	size_t operator()(vkb::FlatMap<Key, Value> const &bindings) const
+	{
+		size_t result = 0;
+		vkb::hash_combine(result, bindings.size());
+		for (auto const &binding : bindings)
+		{
+			vkb::hash_combine(result, binding.first);
+			vkb::hash_combine(result, binding.second);
+		}
+		return result;
+	}
+};
+
 template <typename T>
 struct hash<std::vector<T>>
 {
@@ -216,6 +233,9 @@ struct hash<vkb::core::HPPSubpassInfo>
 		vkb::hash_combine(result, subpass_info.depth_stencil_resolve_attachment);
 		vkb::hash_combine(result, subpass_info.depth_stencil_resolve_mode);
 		vkb::hash_combine(result, subpass_info.debug_name);
+		vkb::hash_combine(result, subpass_info.shading_rate_attachment);
+		vkb::hash_combine(result, subpass_info.shading_rate_texel_size.width);
+		vkb::hash_combine(result, subpass_info.shading_rate_texel_size.height);
 		return result;
 	}
 };
@@ -266,6 +286,10 @@ struct hash<vkb::rendering::HPPRenderTarget>
 		{
 			vkb::hash_combine(result, output);
 		}
+		if (auto shading_rate_view = render_target.get_shading_rate_view())
+		{
+			vkb::hash_combine(result, *shading_rate_view);
+		}
 		return result;
 	}
 };
@@ -1,4 +1,4 @@
-/* Copyright (c) 2018-2021, Arm Limited and Contributors
+/* Copyright (c) 2018-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -126,14 +126,7 @@ struct hash<vkb::Attachment>
 {
 	std::size_t operator()(const vkb::Attachment &attachment) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkFormat>::type>(attachment.format));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkSampleCountFlagBits>::type>(attachment.samples));
-		vkb::hash_combine(result, attachment.usage);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkImageLayout>::type>(attachment.initial_layout));
-
-		return result;
+		return vkb::hash_pod(attachment);
 	}
 };
 
@@ -142,12 +135,7 @@ struct hash<vkb::LoadStoreInfo>
 {
 	std::size_t operator()(const vkb::LoadStoreInfo &load_store_info) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkAttachmentLoadOp>::type>(load_store_info.load_op));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkAttachmentStoreOp>::type>(load_store_info.store_op));
-
-		return result;
+		return vkb::hash_pod(load_store_info);
 	}
 };
 
@@ -158,24 +146,21 @@ struct hash<vkb::SubpassInfo>
 	{
 		std::size_t result = 0;
 
-		for (uint32_t output_attachment : subpass_info.output_attachments)
-		{
-			vkb::hash_combine(result, output_attachment);
-		}
-
-		for (uint32_t input_attachment : subpass_info.input_attachments)
-		{
-			vkb::hash_combine(result, input_attachment);
-		}
+		// The sizes separate the attachment lists
+		vkb::hash_combine(result, subpass_info.output_attachments.size());
+		vkb::hash_combine(result, subpass_info.input_attachments.size());
+		vkb::hash_combine(result, subpass_info.color_resolve_attachments.size());
 
-		for (uint32_t resolve_attachment : subpass_info.color_resolve_attachments)
-		{
-			vkb::hash_combine(result, resolve_attachment);
-		}
+		result = vkb::hash_pod(subpass_info.output_attachments.data(), subpass_info.output_attachments.size(), result);
+		result = vkb::hash_pod(subpass_info.input_attachments.data(), subpass_info.input_attachments.size(), result);
+		result = vkb::hash_pod(subpass_info.color_resolve_attachments.data(), subpass_info.color_resolve_attachments.size(), result);
 
 		vkb::hash_combine(result, subpass_info.disable_depth_stencil_attachment);
 		vkb::hash_combine(result, subpass_info.depth_stencil_resolve_attachment);
 		vkb::hash_combine(result, subpass_info.depth_stencil_resolve_mode);
+		vkb::hash_combine(result, subpass_info.shading_rate_attachment);
+		vkb::hash_combine(result, subpass_info.shading_rate_texel_size.width);
+		vkb::hash_combine(result, subpass_info.shading_rate_texel_size.height);
 
 		return result;
 	}
@@ -186,18 +171,8 @@ struct hash<vkb::SpecializationConstantState>
 {
 	std::size_t operator()(const vkb::SpecializationConstantState &specialization_constant_state) const
 	{
-		std::size_t result = 0;
-
-		for (auto constants : specialization_constant_state.get_specialization_constant_state())
-		{
-			vkb::hash_combine(result, constants.first);
-			for (const auto data : constants.second)
-			{
-				vkb::hash_combine(result, data);
-			}
-		}
-
-		return result;
+		// Kept up to date by SpecializationConstantState as the constants change
+		return specialization_constant_state.get_hash();
 	}
 };
 
@@ -230,13 +205,7 @@ struct hash<VkDescriptorBufferInfo>
 {
 	std::size_t operator()(const VkDescriptorBufferInfo &descriptor_buffer_info) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, descriptor_buffer_info.buffer);
-		vkb::hash_combine(result, descriptor_buffer_info.range);
-		vkb::hash_combine(result, descriptor_buffer_info.offset);
-
-		return result;
+		return vkb::hash_pod(descriptor_buffer_info);
 	}
 };
 
@@ -245,13 +214,19 @@ struct hash<VkDescriptorImageInfo>
 {
 	std::size_t operator()(const VkDescriptorImageInfo &descriptor_image_info) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, descriptor_image_info.imageView);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkImageLayout>::type>(descriptor_image_info.imageLayout));
-		vkb::hash_combine(result, descriptor_image_info.sampler);
+		// Leaves out the padding after the layout
+		return vkb::hash_bytes(&descriptor_image_info, offsetof(VkDescriptorImageInfo, imageLayout) + sizeof(VkImageLayout));
+	}
+};
 
-		return result;
+template <>
+struct hash<VkSamplerCreateInfo>
+{
+	std::size_t operator()(const VkSamplerCreateInfo &sampler_create_info) const
+	{
+		// The members from flags to the end are contiguous, without padding, the pNext chain is left out
+		constexpr size_t state_offset = offsetof(VkSamplerCreateInfo, flags);
+		return vkb::hash_bytes(reinterpret_cast<const uint8_t *>(&sampler_create_info) + state_offset, sizeof(VkSamplerCreateInfo) - state_offset);
 	}
 };
 
@@ -260,13 +235,11 @@ struct hash<VkWriteDescriptorSet>
 {
 	std::size_t operator()(const VkWriteDescriptorSet &write_descriptor_set) const
 	{
-		std::size_t result = 0;
+		// The members from dstSet to descriptorType are contiguous, without padding
+		constexpr size_t header_offset = offsetof(VkWriteDescriptorSet, dstSet);
+		constexpr size_t header_size   = offsetof(VkWriteDescriptorSet, descriptorType) + sizeof(VkDescriptorType) - header_offset;
 
-		vkb::hash_combine(result, write_descriptor_set.dstSet);
-		vkb::hash_combine(result, write_descriptor_set.dstBinding);
-		vkb::hash_combine(result, write_descriptor_set.dstArrayElement);
-		vkb::hash_combine(result, write_descriptor_set.descriptorCount);
-		vkb::hash_combine(result, write_descriptor_set.descriptorType);
+		std::size_t result = vkb::hash_bytes(reinterpret_cast<const uint8_t *>(&write_descriptor_set) + header_offset, header_size);
 
 		switch (write_descriptor_set.descriptorType)
 		{
@@ -283,20 +256,14 @@ struct hash<VkWriteDescriptorSet>
 
 			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
 			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-				for (uint32_t i = 0; i < write_descriptor_set.descriptorCount; i++)
-				{
-					vkb::hash_combine(result, write_descriptor_set.pTexelBufferView[i]);
-				}
+				result = vkb::hash_pod(write_descriptor_set.pTexelBufferView, write_descriptor_set.descriptorCount, result);
 				break;
 
 			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
 			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
 			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
 			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-				for (uint32_t i = 0; i < write_descriptor_set.descriptorCount; i++)
-				{
-					vkb::hash_combine(result, write_descriptor_set.pBufferInfo[i]);
-				}
+				result = vkb::hash_pod(write_descriptor_set.pBufferInfo, write_descriptor_set.descriptorCount, result);
 				break;
 
 			default:
@@ -313,14 +280,7 @@ struct hash<VkVertexInputAttributeDescription>
 {
 	std::size_t operator()(const VkVertexInputAttributeDescription &vertex_attrib) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, vertex_attrib.binding);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkFormat>::type>(vertex_attrib.format));
-		vkb::hash_combine(result, vertex_attrib.location);
-		vkb::hash_combine(result, vertex_attrib.offset);
-
-		return result;
+		return vkb::hash_pod(vertex_attrib);
 	}
 };
 
@@ -329,13 +289,7 @@ struct hash<VkVertexInputBindingDescription>
 {
 	std::size_t operator()(const VkVertexInputBindingDescription &vertex_binding) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, vertex_binding.binding);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkVertexInputRate>::type>(vertex_binding.inputRate));
-		vkb::hash_combine(result, vertex_binding.stride);
-
-		return result;
+		return vkb::hash_pod(vertex_binding);
 	}
 };
 
@@ -344,14 +298,7 @@ struct hash<vkb::StencilOpState>
 {
 	std::size_t operator()(const vkb::StencilOpState &stencil) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkCompareOp>::type>(stencil.compare_op));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkStencilOp>::type>(stencil.depth_fail_op));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkStencilOp>::type>(stencil.fail_op));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkStencilOp>::type>(stencil.pass_op));
-
-		return result;
+		return vkb::hash_pod(stencil);
 	}
 };
 
@@ -360,12 +307,7 @@ struct hash<VkExtent2D>
 {
 	size_t operator()(const VkExtent2D &extent) const
 	{
-		size_t result = 0;
-
-		vkb::hash_combine(result, extent.width);
-		vkb::hash_combine(result, extent.height);
-
-		return result;
+		return vkb::hash_pod(extent);
 	}
 };
 
@@ -374,12 +316,7 @@ struct hash<VkOffset2D>
 {
 	size_t operator()(const VkOffset2D &offset) const
 	{
-		size_t result = 0;
-
-		vkb::hash_combine(result, offset.x);
-		vkb::hash_combine(result, offset.y);
-
-		return result;
+		return vkb::hash_pod(offset);
 	}
 };
 
@@ -388,12 +325,7 @@ struct hash<VkRect2D>
 {
 	size_t operator()(const VkRect2D &rect) const
 	{
-		size_t result = 0;
-
-		vkb::hash_combine(result, rect.extent);
-		vkb::hash_combine(result, rect.offset);
-
-		return result;
+		return vkb::hash_pod(rect);
 	}
 };
 
@@ -402,16 +334,8 @@ struct hash<VkViewport>
 {
 	size_t operator()(const VkViewport &viewport) const
 	{
-		size_t result = 0;
-
-		vkb::hash_combine(result, viewport.width);
-		vkb::hash_combine(result, viewport.height);
-		vkb::hash_combine(result, viewport.maxDepth);
-		vkb::hash_combine(result, viewport.minDepth);
-		vkb::hash_combine(result, viewport.x);
-		vkb::hash_combine(result, viewport.y);
-
-		return result;
+		// Floats don't have a unique representation, but the same viewport always has the same bytes
+		return vkb::hash_bytes(&viewport, sizeof(viewport));
 	}
 };
 
@@ -420,18 +344,7 @@ struct hash<vkb::ColorBlendAttachmentState>
 {
 	std::size_t operator()(const vkb::ColorBlendAttachmentState &color_blend_attachment) const
 	{
-		std::size_t result = 0;
-
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkBlendOp>::type>(color_blend_attachment.alpha_blend_op));
-		vkb::hash_combine(result, color_blend_attachment.blend_enable);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkBlendOp>::type>(color_blend_attachment.color_blend_op));
-		vkb::hash_combine(result, color_blend_attachment.color_write_mask);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(color_blend_attachment.dst_alpha_blend_factor));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(color_blend_attachment.dst_color_blend_factor));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(color_blend_attachment.src_alpha_blend_factor));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(color_blend_attachment.src_color_blend_factor));
-
-		return result;
+		return vkb::hash_pod(color_blend_attachment);
 	}
 };
 
@@ -448,10 +361,263 @@ struct hash<vkb::RenderTarget>
 			vkb::hash_combine(result, view.get_image().get_handle());
 		}
 
+		// The shading rate attachment is an attachment of the framebuffers too
+		if (auto shading_rate_view = render_target.get_shading_rate_view())
+		{
+			vkb::hash_combine(result, shading_rate_view->get_handle());
+		}
+
 		return result;
 	}
 };
 
+}        // namespace std
+
+namespace vkb
+{
+/**
+ * @brief Hashes of the groups of a pipeline state, leaving out its dynamic members
+ */
+namespace pipeline_state_hash
+{
+inline uint32_t get_topology_class(VkPrimitiveTopology topology)
+{
+	switch (topology)
+	{
+		case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+			return 0;
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+			return 1;
+		case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+			return 3;
+		default:
+			return 2;
+	}
+}
+
+inline void hash_vertex_input(std::size_t &result, const PipelineState &pipeline_state)
+{
+	auto dynamic_state = pipeline_state.get_dynamic_state();
+
+	// VkPipelineVertexInputStateCreateInfo
+	if (!(dynamic_state & DynamicPipelineState::VertexInput))
+	{
+		auto &vertex_input_state = pipeline_state.get_vertex_input_state();
+
+		hash_combine(result, vertex_input_state.attributes.size());
+		result = hash_pod(vertex_input_state.attributes.data(), vertex_input_state.attributes.size(), result);
+		result = hash_pod(vertex_input_state.bindings.data(), vertex_input_state.bindings.size(), result);
+	}
+
+	// VkPipelineInputAssemblyStateCreateInfo
+	if (!(dynamic_state & DynamicPipelineState::PrimitiveRestart))
+	{
+		hash_combine(result, pipeline_state.get_input_assembly_state().primitive_restart_enable);
+	}
+
+	auto topology = pipeline_state.get_input_assembly_state().topology;
+	if (dynamic_state & DynamicPipelineState::PrimitiveTopology)
+	{
+		hash_combine(result, get_topology_class(topology));
+	}
+	else
+	{
+		hash_combine(result, static_cast<std::underlying_type<VkPrimitiveTopology>::type>(topology));
+	}
+}
+
+inline void hash_pre_rasterization(std::size_t &result, const PipelineState &pipeline_state)
+{
+	auto dynamic_state = pipeline_state.get_dynamic_state();
+
+	//VkPipelineViewportStateCreateInfo
+	hash_combine(result, pipeline_state.get_viewport_state().viewport_count);
+	hash_combine(result, pipeline_state.get_viewport_state().scissor_count);
+
+	// VkPipelineRasterizationStateCreateInfo
+	auto &rasterization_state = pipeline_state.get_rasterization_state();
+
+	if (!(dynamic_state & DynamicPipelineState::CullMode))
+	{
+		hash_combine(result, rasterization_state.cull_mode);
+	}
+	if (!(dynamic_state & DynamicPipelineState::DepthBiasEnable))
+	{
+		hash_combine(result, rasterization_state.depth_bias_enable);
+	}
+	if (!(dynamic_state & DynamicPipelineState::DepthClamp))
+	{
+		hash_combine(result, rasterization_state.depth_clamp_enable);
+	}
+	if (!(dynamic_state & DynamicPipelineState::FrontFace))
+	{
+		hash_combine(result, static_cast<std::underlying_type<VkFrontFace>::type>(rasterization_state.front_face));
+	}
+	if (!(dynamic_state & DynamicPipelineState::PolygonMode))
+	{
+		hash_combine(result, static_cast<std::underlying_type<VkPolygonMode>::type>(rasterization_state.polygon_mode));
+	}
+	if (!(dynamic_state & DynamicPipelineState::RasterizerDiscard))
+	{
+		hash_combine(result, rasterization_state.rasterizer_discard_enable);
+	}
+}
+
+inline void hash_multisample(std::size_t &result, const PipelineState &pipeline_state)
+{
+	auto  dynamic_state     = pipeline_state.get_dynamic_state();
+	auto &multisample_state = pipeline_state.get_multisample_state();
+
+	// VkPipelineMultisampleStateCreateInfo
+	if (!(dynamic_state & DynamicPipelineState::AlphaToCoverage))
+	{
+		hash_combine(result, multisample_state.alpha_to_coverage_enable);
+	}
+	if (!(dynamic_state & DynamicPipelineState::AlphaToOne))
+	{
+		hash_combine(result, multisample_state.alpha_to_one_enable);
+	}
+	hash_combine(result, multisample_state.min_sample_shading);
+	if (!(dynamic_state & DynamicPipelineState::RasterizationSamples))
+	{
+		hash_combine(result, static_cast<std::underlying_type<VkSampleCountFlagBits>::type>(multisample_state.rasterization_samples));
+	}
+	hash_combine(result, multisample_state.sample_shading_enable);
+	if (!(dynamic_state & DynamicPipelineState::SampleMask))
+	{
+		hash_combine(result, multisample_state.sample_mask);
+	}
+}
+
+inline void hash_depth_stencil(std::size_t &result, const PipelineState &pipeline_state)
+{
+	// VkPipelineDepthStencilStateCreateInfo
+	if (pipeline_state.get_dynamic_state() & DynamicPipelineState::DepthStencil)
+	{
+		return;
+	}
+
+	auto &depth_stencil_state = pipeline_state.get_depth_stencil_state();
+
+	hash_combine(result, depth_stencil_state.back);
+	hash_combine(result, depth_stencil_state.depth_bounds_test_enable);
+	hash_combine(result, static_cast<std::underlying_type<VkCompareOp>::type>(depth_stencil_state.depth_compare_op));
+	hash_combine(result, depth_stencil_state.depth_test_enable);
+	hash_combine(result, depth_stencil_state.depth_write_enable);
+	hash_combine(result, depth_stencil_state.front);
+	hash_combine(result, depth_stencil_state.stencil_test_enable);
+}
+
+inline void hash_color_blend(std::size_t &result, const PipelineState &pipeline_state)
+{
+	auto  dynamic_state     = pipeline_state.get_dynamic_state();
+	auto &color_blend_state = pipeline_state.get_color_blend_state();
+
+	// VkPipelineColorBlendStateCreateInfo
+	if (!(dynamic_state & DynamicPipelineState::LogicOp))
+	{
+		hash_combine(result, static_cast<std::underlying_type<VkLogicOp>::type>(color_blend_state.logic_op));
+	}
+	if (!(dynamic_state & DynamicPipelineState::LogicOpEnable))
+	{
+		hash_combine(result, color_blend_state.logic_op_enable);
+	}
+
+	// The attachment count is part of the pipeline even when their state is dynamic
+	hash_combine(result, color_blend_state.attachments.size());
+
+	for (auto &attachment : color_blend_state.attachments)
+	{
+		if (!(dynamic_state & DynamicPipelineState::ColorBlendEnable))
+		{
+			hash_combine(result, attachment.blend_enable);
+		}
+		if (!(dynamic_state & DynamicPipelineState::ColorBlendEquation))
+		{
+			hash_combine(result, static_cast<std::underlying_type<VkBlendOp>::type>(attachment.alpha_blend_op));
+			hash_combine(result, static_cast<std::underlying_type<VkBlendOp>::type>(attachment.color_blend_op));
+			hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(attachment.dst_alpha_blend_factor));
+			hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(attachment.dst_color_blend_factor));
+			hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(attachment.src_alpha_blend_factor));
+			hash_combine(result, static_cast<std::underlying_type<VkBlendFactor>::type>(attachment.src_color_blend_factor));
+		}
+		if (!(dynamic_state & DynamicPipelineState::ColorWriteMask))
+		{
+			hash_combine(result, attachment.color_write_mask);
+		}
+	}
+}
+
+/**
+ * @brief Hashes the fragment shading rate, read by both the pre-rasterization and the fragment shader parts
+ */
+inline void hash_fragment_shading_rate(std::size_t &result, const PipelineState &pipeline_state)
+{
+	auto &fragment_shading_rate_state = pipeline_state.get_fragment_shading_rate_state();
+
+	hash_combine(result, fragment_shading_rate_state.fragment_size.width);
+	hash_combine(result, fragment_shading_rate_state.fragment_size.height);
+	for (auto combiner_op : fragment_shading_rate_state.combiner_ops)
+	{
+		hash_combine(result, static_cast<std::underlying_type<VkFragmentShadingRateCombinerOpKHR>::type>(combiner_op));
+	}
+}
+
+inline void hash_shader_stages(std::size_t &result, const PipelineState &pipeline_state, bool fragment)
+{
+	for (auto shader_module : pipeline_state.get_pipeline_layout().get_shader_modules())
+	{
+		if ((shader_module->get_stage() == VK_SHADER_STAGE_FRAGMENT_BIT) == fragment)
+		{
+			hash_combine(result, shader_module->get_id());
+		}
+	}
+}
+
+/**
+ * @brief Hashes the render pass and subpass a graphics pipeline is used in, or the attachments of its
+ *        dynamic rendering instance when there is no render pass
+ */
+inline void hash_render_pass(std::size_t &result, const PipelineState &pipeline_state)
+{
+	if (auto render_pass = pipeline_state.get_render_pass())
+	{
+		hash_combine(result, render_pass->get_handle());
+		hash_combine(result, pipeline_state.get_subpass_index());
+		return;
+	}
+
+	// The subpass index is left out, the subpasses rendering to the same attachments share their pipelines
+	auto &rendering_state = pipeline_state.get_rendering_state();
+
+	for (auto format : rendering_state.color_attachment_formats)
+	{
+		hash_combine(result, static_cast<std::underlying_type<VkFormat>::type>(format));
+	}
+	hash_combine(result, static_cast<std::underlying_type<VkFormat>::type>(rendering_state.depth_attachment_format));
+	hash_combine(result, static_cast<std::underlying_type<VkFormat>::type>(rendering_state.stencil_attachment_format));
+	hash_combine(result, rendering_state.local_read);
+
+	for (auto location : rendering_state.color_attachment_locations)
+	{
+		hash_combine(result, location);
+	}
+	for (auto index : rendering_state.color_attachment_input_indices)
+	{
+		hash_combine(result, index);
+	}
+	hash_combine(result, rendering_state.depth_input_attachment_index);
+	hash_combine(result, rendering_state.depth_stencil_disabled);
+	hash_combine(result, rendering_state.shading_rate_attachment);
+}
+}        // namespace pipeline_state_hash
+}        // namespace vkb
+
+namespace std
+{
 template <>
 struct hash<vkb::PipelineState>
 {
@@ -459,74 +625,89 @@ struct hash<vkb::PipelineState>
 	{
 		std::size_t result = 0;
 
-		vkb::hash_combine(result, pipeline_state.get_pipeline_layout().get_handle());
-
-		// For graphics only
-		if (auto render_pass = pipeline_state.get_render_pass())
+		if (pipeline_state.get_cached_hash(result))
 		{
-			vkb::hash_combine(result, render_pass->get_handle());
+			return result;
 		}
 
-		vkb::hash_combine(result, pipeline_state.get_specialization_constant_state());
+		vkb::hash_combine(result, pipeline_state.get_pipeline_layout().get_handle());
 
-		vkb::hash_combine(result, pipeline_state.get_subpass_index());
+		// For graphics only, compute pipelines have neither a render pass nor rendering attachments
+		vkb::pipeline_state_hash::hash_render_pass(result, pipeline_state);
+
+		vkb::hash_combine(result, pipeline_state.get_specialization_constant_state());
 
 		for (auto shader_module : pipeline_state.get_pipeline_layout().get_shader_modules())
 		{
 			vkb::hash_combine(result, shader_module->get_id());
 		}
 
-		// VkPipelineVertexInputStateCreateInfo
-		for (auto &attribute : pipeline_state.get_vertex_input_state().attributes)
-		{
-			vkb::hash_combine(result, attribute);
-		}
+		// The dynamic members are left out, the pipelines are created with their dynamic states enabled
+		vkb::hash_combine(result, pipeline_state.get_dynamic_state());
 
-		for (auto &binding : pipeline_state.get_vertex_input_state().bindings)
-		{
-			vkb::hash_combine(result, binding);
-		}
+		vkb::pipeline_state_hash::hash_vertex_input(result, pipeline_state);
+		vkb::pipeline_state_hash::hash_pre_rasterization(result, pipeline_state);
+		vkb::pipeline_state_hash::hash_multisample(result, pipeline_state);
+		vkb::pipeline_state_hash::hash_depth_stencil(result, pipeline_state);
+		vkb::pipeline_state_hash::hash_color_blend(result, pipeline_state);
+		vkb::pipeline_state_hash::hash_fragment_shading_rate(result, pipeline_state);
 
-		// VkPipelineInputAssemblyStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_input_assembly_state().primitive_restart_enable);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkPrimitiveTopology>::type>(pipeline_state.get_input_assembly_state().topology));
-
-		//VkPipelineViewportStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_viewport_state().viewport_count);
-		vkb::hash_combine(result, pipeline_state.get_viewport_state().scissor_count);
-
-		// VkPipelineRasterizationStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().cull_mode);
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().depth_bias_enable);
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().depth_clamp_enable);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkFrontFace>::type>(pipeline_state.get_rasterization_state().front_face));
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkPolygonMode>::type>(pipeline_state.get_rasterization_state().polygon_mode));
-		vkb::hash_combine(result, pipeline_state.get_rasterization_state().rasterizer_discard_enable);
-
-		// VkPipelineMultisampleStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().alpha_to_coverage_enable);
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().alpha_to_one_enable);
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().min_sample_shading);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkSampleCountFlagBits>::type>(pipeline_state.get_multisample_state().rasterization_samples));
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().sample_shading_enable);
-		vkb::hash_combine(result, pipeline_state.get_multisample_state().sample_mask);
-
-		// VkPipelineDepthStencilStateCreateInfo
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().back);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().depth_bounds_test_enable);
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkCompareOp>::type>(pipeline_state.get_depth_stencil_state().depth_compare_op));
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().depth_test_enable);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().depth_write_enable);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().front);
-		vkb::hash_combine(result, pipeline_state.get_depth_stencil_state().stencil_test_enable);
-
-		// VkPipelineColorBlendStateCreateInfo
-		vkb::hash_combine(result, static_cast<std::underlying_type<VkLogicOp>::type>(pipeline_state.get_color_blend_state().logic_op));
-		vkb::hash_combine(result, pipeline_state.get_color_blend_state().logic_op_enable);
-
-		for (auto &attachment : pipeline_state.get_color_blend_state().attachments)
+		pipeline_state.set_cached_hash(result);
+
+		return result;
+	}
+};
+
+template <>
+struct hash<vkb::PipelineLibraryState>
+{
+	std::size_t operator()(const vkb::PipelineLibraryState &library_state) const
+	{
+		std::size_t result = 0;
+
+		vkb::hash_combine(result, static_cast<uint32_t>(library_state.part));
+
+		auto &pipeline_state = library_state.pipeline_state;
+
+		vkb::hash_combine(result, pipeline_state.get_dynamic_state());
+
+		// Only the state read by the part, so that the library is shared by pipelines differing in the others
+		switch (library_state.part)
 		{
-			vkb::hash_combine(result, attachment);
+			case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+				vkb::pipeline_state_hash::hash_vertex_input(result, pipeline_state);
+				break;
+
+			case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+			case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+			{
+				vkb::hash_combine(result, pipeline_state.get_pipeline_layout().get_handle());
+				vkb::pipeline_state_hash::hash_render_pass(result, pipeline_state);
+				vkb::hash_combine(result, pipeline_state.get_specialization_constant_state());
+
+				bool fragment = library_state.part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+
+				vkb::pipeline_state_hash::hash_shader_stages(result, pipeline_state, fragment);
+				vkb::pipeline_state_hash::hash_fragment_shading_rate(result, pipeline_state);
+
+				if (fragment)
+				{
+					vkb::pipeline_state_hash::hash_depth_stencil(result, pipeline_state);
+					vkb::pipeline_state_hash::hash_multisample(result, pipeline_state);
+				}
+				else
+				{
+					vkb::pipeline_state_hash::hash_pre_rasterization(result, pipeline_state);
+				}
+				break;
+			}
+
+			default:
+				vkb::pipeline_state_hash::hash_render_pass(result, pipeline_state);
+
+				vkb::pipeline_state_hash::hash_multisample(result, pipeline_state);
+				vkb::pipeline_state_hash::hash_color_blend(result, pipeline_state);
+				break;
 		}
 
 		return result;
@@ -549,12 +730,20 @@ inline void hash_param(size_t & /*seed*/, const VkPipelineCache & /*value*/)
 {
 }
 
+template <>
+inline void hash_param<core::Image>(
+    size_t &           seed,
+    const core::Image &value)
+{
+	hash_combine(seed, value.get_handle());
+}
+
 template <>
 inline void hash_param<std::vector<uint8_t>>(
     size_t &                    seed,
     const std::vector<uint8_t> &value)
 {
-	hash_combine(seed, std::string{value.begin(), value.end()});
+	seed = hash_bytes(value.data(), value.size(), seed);
 }
 
 template <>
@@ -562,10 +751,7 @@ inline void hash_param<std::vector<Attachment>>(
     size_t &                       seed,
     const std::vector<Attachment> &value)
 {
-	for (auto &attachment : value)
-	{
-		hash_combine(seed, attachment);
-	}
+	seed = hash_pod(value.data(), value.size(), seed);
 }
 
 template <>
@@ -573,10 +759,7 @@ inline void hash_param<std::vector<LoadStoreInfo>>(
     size_t &                          seed,
     const std::vector<LoadStoreInfo> &value)
 {
-	for (auto &load_store_info : value)
-	{
-		hash_combine(seed, load_store_info);
-	}
+	seed = hash_pod(value.data(), value.size(), seed);
 }
 
 template <>
@@ -613,9 +796,9 @@ inline void hash_param<std::vector<ShaderResource>>(
 }
 
 template <>
-inline void hash_param<std::map<uint32_t, std::map<uint32_t, VkDescriptorBufferInfo>>>(
-    size_t &                                                              seed,
-    const std::map<uint32_t, std::map<uint32_t, VkDescriptorBufferInfo>> &value)
+inline void hash_param<BindingMap<VkDescriptorBufferInfo>>(
+    size_t &                                  seed,
+    const BindingMap<VkDescriptorBufferInfo> &value)
 {
 	for (auto &binding_set : value)
 	{
@@ -630,9 +813,9 @@ inline void hash_param<std::map<uint32_t, std::map<uint32_t, VkDescriptorBufferI
 }
 
 template <>
-inline void hash_param<std::map<uint32_t, std::map<uint32_t, VkDescriptorImageInfo>>>(
-    size_t &                                                             seed,
-    const std::map<uint32_t, std::map<uint32_t, VkDescriptorImageInfo>> &value)
+inline void hash_param<BindingMap<VkDescriptorImageInfo>>(
+    size_t &                                 seed,
+    const BindingMap<VkDescriptorImageInfo> &value)
 {
 	for (auto &binding_set : value)
 	{
@@ -722,16 +905,45 @@ struct RecordHelper<GraphicsPipeline, A...>
 		recorder.SetGraphicsPipeline(index, graphics_pipeline);
 	}
 };
+
+template <class... A>
+struct RecordHelper<DescriptorSetLayout, A...>
+{
+	size_t record(ResourceRecord &recorder, A &... args)
+	{
+		return recorder.RegisterDescriptorSetLayout(args...);
+	}
+
+	void index(ResourceRecord &recorder, size_t index, DescriptorSetLayout &descriptor_set_layout)
+	{
+		recorder.SetDescriptorSetLayout(index, descriptor_set_layout);
+	}
+};
+
+template <class... A>
+struct RecordHelper<ComputePipeline, A...>
+{
+	size_t record(ResourceRecord &recorder, A &... args)
+	{
+		return recorder.RegisterComputePipeline(args...);
+	}
+
+	void index(ResourceRecord &recorder, size_t index, ComputePipeline &compute_pipeline)
+	{
+		recorder.SetComputePipeline(index, compute_pipeline);
+	}
+};
 }        // namespace
 
+/**
+ * @brief Returns the resource cached for the arguments, or creates and caches it
+ * @param hash The hash of the arguments, computed by the caller which already looked the resource up
+ */
 template <class T, class... A>
-T &request_resource(Device &device, ResourceRecord *recorder, std::unordered_map<std::size_t, T> &resources, A &... args)
+T &request_resource_with_hash(Device &device, ResourceRecord *recorder, std::unordered_map<std::size_t, T> &resources, std::size_t hash, A &... args)
 {
 	RecordHelper<T, A...> record_helper;
 
-	std::size_t hash{0U};
-	hash_param(hash, args...);
-
 	auto res_it = resources.find(hash);
 
 	if (res_it != resources.end())
@@ -777,4 +989,13 @@ T &request_resource(Device &device, ResourceRecord *recorder, std::unordered_map
 
 	return res_it->second;
 }
+
+template <class T, class... A>
+T &request_resource(Device &device, ResourceRecord *recorder, std::unordered_map<std::size_t, T> &resources, A &... args)
+{
+	std::size_t hash{0U};
+	hash_param(hash, args...);
+
+	return request_resource_with_hash(device, recorder, resources, hash, args...);
+}
 }        // namespace vkb
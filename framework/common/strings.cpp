@@ -1451,6 +1451,36 @@ const std::string to_string(VkBlendOp operation)
 	return "Unkown";
 }
 
+const std::string to_string(VkAttachmentLoadOp load_op)
+{
+	if (load_op == VK_ATTACHMENT_LOAD_OP_LOAD)
+	{
+		return "LOAD";
+	}
+	if (load_op == VK_ATTACHMENT_LOAD_OP_CLEAR)
+	{
+		return "CLEAR";
+	}
+	if (load_op == VK_ATTACHMENT_LOAD_OP_DONT_CARE)
+	{
+		return "DONT_CARE";
+	}
+	return "Unknown";
+}
+
+const std::string to_string(VkAttachmentStoreOp store_op)
+{
+	if (store_op == VK_ATTACHMENT_STORE_OP_STORE)
+	{
+		return "STORE";
+	}
+	if (store_op == VK_ATTACHMENT_STORE_OP_DONT_CARE)
+	{
+		return "DONT_CARE";
+	}
+	return "Unknown";
+}
+
 const std::string to_string(sg::AlphaMode mode)
 {
 	if (mode == sg::AlphaMode::Blend)
@@ -191,6 +191,20 @@ const std::string to_string(VkLogicOp operation);
  */
 const std::string to_string(VkBlendOp operation);
 
+/**
+ * @brief Helper function to convert VkAttachmentLoadOp to a string
+ * @param load_op Vulkan VkAttachmentLoadOp to convert
+ * @return The string to return
+ */
+const std::string to_string(VkAttachmentLoadOp load_op);
+
+/**
+ * @brief Helper function to convert VkAttachmentStoreOp to a string
+ * @param store_op Vulkan VkAttachmentStoreOp to convert
+ * @return The string to return
+ */
+const std::string to_string(VkAttachmentStoreOp store_op);
+
 /**
  * @brief Helper function to convert AlphaMode to a string
  * @param mode Vulkan AlphaMode to convert
@@ -47,6 +47,7 @@ class CommandBuffer;
 
 /**
  * @brief Takes a screenshot of the app by writing the swapchain image to file (slow function)
+ *        Waits for the copy and the encoding of the image, see FrameReadback to capture frames while rendering.
  * @param render_context The RenderContext to use
  * @param filename The name of the file to save the output to
  */
@@ -66,8 +66,6 @@ std::ostream &operator<<(std::ostream &os, const VkResult result)
 
 namespace vkb
 {
-namespace
-{
 VkShaderStageFlagBits find_shader_stage(const std::string &ext)
 {
 	if (ext == "vert")
@@ -129,7 +127,6 @@ VkShaderStageFlagBits find_shader_stage(const std::string &ext)
 
 	throw std::runtime_error("File extension `" + ext + "` does not have a vulkan shader stage.");
 }
-}        // namespace
 
 bool is_depth_only_format(VkFormat format)
 {
@@ -667,6 +664,35 @@ VkImageCompressionPropertiesEXT query_applied_compression(VkDevice device, VkIma
 	return compression_properties;
 }
 
+const AttachmentCompression *select_attachment_compression(const ImageCompressionPolicy &policy, const VkImageCreateInfo &create_info)
+{
+	const AttachmentCompression *compression = nullptr;
+	if (create_info.usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+	{
+		compression = &policy.depth_stencil;
+	}
+	else if (create_info.usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
+	{
+		compression = &policy.color;
+	}
+
+	if (!compression || compression->flags == VK_IMAGE_COMPRESSION_DEFAULT_EXT)
+	{
+		return nullptr;
+	}
+
+	// The compression chosen by the creator of the image wins over the policy
+	for (auto next = static_cast<const VkBaseInStructure *>(create_info.pNext); next; next = next->pNext)
+	{
+		if (next->sType == VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT)
+		{
+			return nullptr;
+		}
+	}
+
+	return compression;
+}
+
 VkSurfaceFormatKHR select_surface_format(VkPhysicalDevice gpu, VkSurfaceKHR surface, std::vector<VkFormat> const &preferred_formats)
 {
 	uint32_t surface_format_count;
@@ -29,6 +29,8 @@
 #include <vk_mem_alloc.h>
 #include <volk.h>
 
+#include "core/util/flat_map.hpp"
+
 #define VK_FLAGS_NONE 0        // Custom define for better code readability
 
 #define DEFAULT_FENCE_TIMEOUT 100000000000        // Default fence timeout in nanoseconds
@@ -36,8 +38,9 @@
 template <class T>
 using ShaderStageMap = std::map<VkShaderStageFlagBits, T>;
 
+/// Descriptor infos by binding then by array element, both small and dense so kept in sorted vectors
 template <class T>
-using BindingMap = std::map<uint32_t, std::map<uint32_t, T>>;
+using BindingMap = vkb::FlatMap<uint32_t, vkb::FlatMap<uint32_t, T>>;
 
 namespace vkb
 {
@@ -134,6 +137,14 @@ enum class ShadingLanguage
 	HLSL,
 };
 
+/**
+ * @brief Helper function to determine the shader stage of a GLSL file
+ * @param ext The file extension, without the dot
+ * @throws std::runtime_error if the extension doesn't name a shader stage
+ * @return The shader stage of the file
+ */
+VkShaderStageFlagBits find_shader_stage(const std::string &ext);
+
 /**
  * @brief Helper function to create a VkShaderModule
  * @param filename The shader location
@@ -272,6 +283,35 @@ VkImageCompressionPropertiesEXT query_supported_fixed_rate_compression(VkPhysica
 
 VkImageCompressionPropertiesEXT query_applied_compression(VkDevice device, VkImage image);
 
+/**
+ * @brief Compression requested for the images of a class of attachments
+ */
+struct AttachmentCompression
+{
+	/// VK_IMAGE_COMPRESSION_DEFAULT_EXT leaves the compression to the implementation
+	VkImageCompressionFlagsEXT flags{VK_IMAGE_COMPRESSION_DEFAULT_EXT};
+
+	/// Bit rates the implementation picks from, with VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT
+	VkImageCompressionFixedRateFlagsEXT fixed_rate_flags{VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT};
+};
+
+/**
+ * @brief Compression of the attachment images created on a device, see Device::set_image_compression_policy
+ */
+struct ImageCompressionPolicy
+{
+	AttachmentCompression color;
+
+	AttachmentCompression depth_stencil;
+};
+
+/**
+ * @brief Selects the compression of an image from the class of attachment its usage belongs to
+ * @return The compression to chain to the create info, or nullptr if the image keeps the default compression
+ *         because it is no attachment, its class has no policy, or the create info already controls it
+ */
+const AttachmentCompression *select_attachment_compression(const ImageCompressionPolicy &policy, const VkImageCreateInfo &create_info);
+
 /**
  * @brief Load and store info for a render pass attachment.
  */
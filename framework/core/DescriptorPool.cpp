@@ -17,6 +17,8 @@
 
 #include "DescriptorPool.h"
 
+#include <algorithm>
+
 #include "DescriptorSetLayout.h"
 #include "device.h"
 
@@ -123,6 +125,8 @@ VkDescriptorSet DescriptorPool::AllocateDescriptorSet()
 	// Store mapping between the descriptor set and the pool
 	m_setPoolMapping.emplace(handle, m_poolIndex);
 
+	m_peakSetCount = std::max(m_peakSetCount, to_u32(m_setPoolMapping.size()));
+
 	return handle;
 }
 
@@ -139,12 +143,18 @@ VkResult DescriptorPool::FreeDescriptorSet(VkDescriptorSet descriptorSet)
 
 	auto descPoolIndex = it->second;
 
-	// Free descriptor set from the pool
-	vkFreeDescriptorSets(m_device.get_handle(), m_pools[descPoolIndex], 1, &descriptorSet);
-
 	// Remove descriptor set mapping to the pool
 	m_setPoolMapping.erase(it);
 
+	if (!m_poolFreeable[descPoolIndex])
+	{
+		// The set keeps its slot in the pool until the pool is reset
+		return VK_INCOMPLETE;
+	}
+
+	// Free descriptor set from the pool
+	vkFreeDescriptorSets(m_device.get_handle(), m_pools[descPoolIndex], 1, &descriptorSet);
+
 	// Decrement allocated set count for the pool
 	--m_poolSetsCount[descPoolIndex];
 
@@ -155,6 +165,44 @@ VkResult DescriptorPool::FreeDescriptorSet(VkDescriptorSet descriptorSet)
 }
 
 
+void DescriptorPool::Reserve(uint32_t setCount)
+{
+	// Grow the pools to hold all the sets in one, the pool sizes are a multiple of the sets per pool
+	if (m_pools.empty() && setCount > m_poolMaxSets && m_poolMaxSets > 0)
+	{
+		for (auto& poolSize : m_poolSizes)
+		{
+			poolSize.descriptorCount = poolSize.descriptorCount / m_poolMaxSets * setCount;
+		}
+
+		m_poolMaxSets = setCount;
+	}
+
+	while (to_u32(m_pools.size()) * m_poolMaxSets < setCount)
+	{
+		size_t poolCount = m_pools.size();
+		FindAvailablePool(to_u32(poolCount));
+
+		if (m_pools.size() == poolCount)
+		{
+			// Out of pool memory, the remaining pools are created when allocating
+			break;
+		}
+	}
+}
+
+
+uint32_t DescriptorPool::GetPeakSetCount() const
+{
+	return m_peakSetCount;
+}
+
+
+void DescriptorPool::SetFreeDescriptorSets(bool freeDescriptorSets)
+{
+	m_freeDescriptorSets = freeDescriptorSets;
+}
+
 std::uint32_t DescriptorPool::FindAvailablePool(std::uint32_t searchIndex)
 {
 	// Create a new pool
@@ -166,8 +214,11 @@ std::uint32_t DescriptorPool::FindAvailablePool(std::uint32_t searchIndex)
 		create_info.pPoolSizes    = m_poolSizes.data();
 		create_info.maxSets       = m_poolMaxSets;
 
-		// We do not set FREE_DESCRIPTOR_SET_BIT as we do not need to free individual descriptor sets
-		create_info.flags = 0;
+		// Only the caches with a budget free the descriptor sets they evict, see DescriptorSet::Free
+		if (m_freeDescriptorSets)
+		{
+			create_info.flags |= VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		}
 
 		// Check descriptor set layout and enable the required flags
 		auto& bindingFlags = m_descriptorSetLayout->GetBindingFlags();
@@ -194,6 +245,7 @@ std::uint32_t DescriptorPool::FindAvailablePool(std::uint32_t searchIndex)
 
 		// Add set count for the descriptor pool
 		m_poolSetsCount.push_back(0);
+		m_poolFreeable.push_back(m_freeDescriptorSets);
 
 		return searchIndex;
 	}
@@ -57,6 +57,22 @@ class DescriptorPool
 
 	VkResult FreeDescriptorSet(VkDescriptorSet descriptorSet);
 
+	/**
+	 * @brief Creates the pools holding setCount sets up front, so that allocating them creates no pool
+	 *        If no pool was created yet, a single pool of setCount sets is created instead of pools of the default size.
+	 */
+	void Reserve(uint32_t setCount);
+
+	/**
+	 * @brief Creates the pools created from now on with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+	 *        Only the sets of these pools go back to their pool when freed, the others keep their slot until Reset.
+	 *        Set it before the first allocation for the caches that free the sets they evict.
+	 */
+	void SetFreeDescriptorSets(bool freeDescriptorSets);
+
+	/// @return The most sets allocated at once since the pool was created
+	uint32_t GetPeakSetCount() const;
+
   private:
 	Device& m_device;
 
@@ -74,12 +90,21 @@ class DescriptorPool
 	// Count sets for each pool
 	std::vector<uint32_t> m_poolSetsCount;
 
+	// Whether each pool was created with the free descriptor set flag
+	std::vector<bool> m_poolFreeable;
+
+	// Create the new pools with the free descriptor set flag
+	bool m_freeDescriptorSets{ false };
+
 	// Current pool index to allocate descriptor set
 	uint32_t m_poolIndex{ 0 };
 
 	// Map between descriptor set and pool index
 	std::unordered_map<VkDescriptorSet, uint32_t> m_setPoolMapping;
 
+	// Most sets allocated at once
+	uint32_t m_peakSetCount{ 0 };
+
 	// Find next pool index or create new pool
 	uint32_t FindAvailablePool(uint32_t poolIndex);
 };
@@ -17,8 +17,11 @@
 
 #include "DescriptorSet.h"
 
+#include <cstring>
+
 #include "common/resource_caching.h"
 #include "core/util/logging.hpp"
+#include "core/util/profiling.hpp"
 #include "DescriptorPool.h"
 #include "DescriptorSetLayout.h"
 #include "device.h"
@@ -32,7 +35,7 @@ DescriptorSet::DescriptorSet(Device& device,
                              const BindingMap<VkDescriptorImageInfo>& imageInfos)
 	: m_device{ device }
 	, m_descriptorSetLayout{ descriptorSetLayout }
-	, m_descriptorPool{ descriptorPool }
+	, m_descriptorPool{ &descriptorPool }
 	, m_bufferInfos{ bufferInfos }
 	, m_imageInfos{ imageInfos }
 	, m_handle{ descriptorPool.AllocateDescriptorSet() }
@@ -41,6 +44,21 @@ DescriptorSet::DescriptorSet(Device& device,
 }
 
 
+DescriptorSet::DescriptorSet(Device& device,
+                             const DescriptorSetLayout& descriptorSetLayout,
+                             VkDescriptorSet handle,
+                             const BindingMap<VkDescriptorBufferInfo>& bufferInfos,
+                             const BindingMap<VkDescriptorImageInfo>& imageInfos)
+	: m_device{ device }
+	, m_descriptorSetLayout{ descriptorSetLayout }
+	, m_bufferInfos{ bufferInfos }
+	, m_imageInfos{ imageInfos }
+	, m_handle{ handle }
+{
+	Prepare();
+}
+
+
 void DescriptorSet::Reset(const BindingMap<VkDescriptorBufferInfo>& newBufferInfos, const BindingMap<VkDescriptorImageInfo>& newImageInfos)
 {
 	if (!newBufferInfos.empty() || !newImageInfos.empty())
@@ -55,6 +73,8 @@ void DescriptorSet::Reset(const BindingMap<VkDescriptorBufferInfo>& newBufferInf
 
 	m_writeDescriptorSets.clear();
 	m_updatedBindings.clear();
+	m_templateData.clear();
+	m_templateWritten = false;
 
 	Prepare();
 }
@@ -62,13 +82,21 @@ void DescriptorSet::Reset(const BindingMap<VkDescriptorBufferInfo>& newBufferInf
 
 void DescriptorSet::Prepare()
 {
+	PROFILE_FUNCTION();
+
 	// We don't want to prepare twice during the life cycle of a Descriptor Set
-	if (!m_writeDescriptorSets.empty())
+	if (!m_writeDescriptorSets.empty() || !m_templateData.empty())
 	{
 		LOGW("Trying to prepare a descriptor set that has already been prepared, skipping.");
 		return;
 	}
 
+	// The write operations are only needed if the set can't be written with the template
+	if (PrepareTemplateData())
+	{
+		return;
+	}
+
 	// Iterate over all buffer bindings
 	for (auto& bindingIt : m_bufferInfos)
 	{
@@ -82,24 +110,7 @@ void DescriptorSet::Prepare()
 			{
 				auto& bufferInfo = elementIt.second;
 
-				const size_t uniformBufferRangeLimit = m_device.get_gpu().get_properties().limits.maxUniformBufferRange;
-				const size_t storageBufferRangeLimit = m_device.get_gpu().get_properties().limits.maxStorageBufferRange;
-
-				size_t bufferRangeLimit = static_cast<size_t>(bufferInfo.range);
-
-				if ((bindingInfo->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || bindingInfo->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) && bufferRangeLimit > uniformBufferRangeLimit)
-				{
-					LOGE("Set {} binding {} cannot be updated: buffer size {} exceeds the uniform buffer range limit {}", m_descriptorSetLayout.GetIndex(), bindingIndex, bufferInfo.range, uniformBufferRangeLimit);
-					bufferRangeLimit = uniformBufferRangeLimit;
-				}
-				else if ((bindingInfo->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || bindingInfo->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) && bufferRangeLimit > storageBufferRangeLimit)
-				{
-					LOGE("Set {} binding {} cannot be updated: buffer size {} exceeds the storage buffer range limit {}", m_descriptorSetLayout.GetIndex(), bindingIndex, bufferInfo.range, storageBufferRangeLimit);
-					bufferRangeLimit = storageBufferRangeLimit;
-				}
-
-				// Clip the buffers range to the limit if one exists as otherwise we will receive a Vulkan validation error
-				bufferInfo.range = bufferRangeLimit;
+				ClampBufferRange(bindingIndex, bindingInfo->descriptorType, bufferInfo);
 
 				VkWriteDescriptorSet write_descriptor_set{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
 
@@ -151,8 +162,109 @@ void DescriptorSet::Prepare()
 	}
 }
 
+bool DescriptorSet::PrepareTemplateData()
+{
+	if (m_descriptorSetLayout.GetUpdateTemplate() == VK_NULL_HANDLE)
+	{
+		return false;
+	}
+
+	const auto& bindings = m_descriptorSetLayout.GetBindings();
+	const auto& offsets  = m_descriptorSetLayout.GetUpdateTemplateOffsets();
+
+	m_templateData.resize(m_descriptorSetLayout.GetUpdateTemplateSize());
+
+	for (size_t i = 0; i < bindings.size(); i++)
+	{
+		const auto& binding = bindings[i];
+		uint8_t*    data    = m_templateData.data() + offsets[i];
+
+		if (binding.descriptorCount == 0)
+		{
+			continue;
+		}
+
+		const bool isBuffer = is_buffer_descriptor_type(binding.descriptorType);
+
+		auto bufferBindingIt = m_bufferInfos.find(binding.binding);
+		auto imageBindingIt  = m_imageInfos.find(binding.binding);
+
+		if ((isBuffer && bufferBindingIt == m_bufferInfos.end()) || (!isBuffer && imageBindingIt == m_imageInfos.end()))
+		{
+			m_templateData.clear();
+			return false;
+		}
+
+		for (uint32_t element = 0; element < binding.descriptorCount; element++, data += DescriptorSetLayout::UpdateTemplateStride)
+		{
+			if (isBuffer)
+			{
+				auto elementIt = bufferBindingIt->second.find(element);
+				if (elementIt == bufferBindingIt->second.end())
+				{
+					m_templateData.clear();
+					return false;
+				}
+
+				ClampBufferRange(binding.binding, binding.descriptorType, elementIt->second);
+				std::memcpy(data, &elementIt->second, sizeof(VkDescriptorBufferInfo));
+			}
+			else
+			{
+				auto elementIt = imageBindingIt->second.find(element);
+				if (elementIt == imageBindingIt->second.end())
+				{
+					m_templateData.clear();
+					return false;
+				}
+
+				std::memcpy(data, &elementIt->second, sizeof(VkDescriptorImageInfo));
+			}
+		}
+	}
+
+	return true;
+}
+
+
+void DescriptorSet::ClampBufferRange(uint32_t bindingIndex, VkDescriptorType descriptorType, VkDescriptorBufferInfo& bufferInfo) const
+{
+	const size_t uniformBufferRangeLimit = m_device.get_gpu().get_properties().limits.maxUniformBufferRange;
+	const size_t storageBufferRangeLimit = m_device.get_gpu().get_properties().limits.maxStorageBufferRange;
+
+	size_t bufferRangeLimit = static_cast<size_t>(bufferInfo.range);
+
+	if ((descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) && bufferRangeLimit > uniformBufferRangeLimit)
+	{
+		LOGE("Set {} binding {} cannot be updated: buffer size {} exceeds the uniform buffer range limit {}", m_descriptorSetLayout.GetIndex(), bindingIndex, bufferInfo.range, uniformBufferRangeLimit);
+		bufferRangeLimit = uniformBufferRangeLimit;
+	}
+	else if ((descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) && bufferRangeLimit > storageBufferRangeLimit)
+	{
+		LOGE("Set {} binding {} cannot be updated: buffer size {} exceeds the storage buffer range limit {}", m_descriptorSetLayout.GetIndex(), bindingIndex, bufferInfo.range, storageBufferRangeLimit);
+		bufferRangeLimit = storageBufferRangeLimit;
+	}
+
+	// Clip the buffers range to the limit if one exists as otherwise we will receive a Vulkan validation error
+	bufferInfo.range = bufferRangeLimit;
+}
+
+
 void DescriptorSet::Update(const std::vector<uint32_t>& bindingsToUpdate)
 {
+	PROFILE_FUNCTION();
+
+	// The infos only change on reset, once the template data is written every binding is up to date
+	if (!m_templateData.empty())
+	{
+		if (!m_templateWritten)
+		{
+			ApplyWrites();
+			m_templateWritten = true;
+		}
+		return;
+	}
+
 	std::vector<VkWriteDescriptorSet> writeOperations;
 	std::vector<size_t> writeOperationHashes;
 
@@ -219,6 +331,14 @@ void DescriptorSet::Update(const std::vector<uint32_t>& bindingsToUpdate)
 
 void DescriptorSet::ApplyWrites() const
 {
+	PROFILE_FUNCTION();
+
+	if (!m_templateData.empty())
+	{
+		vkUpdateDescriptorSetWithTemplateKHR(m_device.get_handle(), m_handle, m_descriptorSetLayout.GetUpdateTemplate(), m_templateData.data());
+		return;
+	}
+
 	vkUpdateDescriptorSets(m_device.get_handle(),
 	                       to_u32(m_writeDescriptorSets.size()),
 	                       m_writeDescriptorSets.data(),
@@ -235,6 +355,8 @@ DescriptorSet::DescriptorSet(DescriptorSet&& other)
 	, m_handle{ other.m_handle }
 	, m_writeDescriptorSets{ std::move(other.m_writeDescriptorSets) }
 	, m_updatedBindings{ std::move(other.m_updatedBindings) }
+	, m_templateData{ std::move(other.m_templateData) }
+	, m_templateWritten{ other.m_templateWritten }
 {
 	other.m_handle = VK_NULL_HANDLE;
 }
@@ -263,4 +385,14 @@ BindingMap<VkDescriptorImageInfo>& DescriptorSet::GetImageInfos()
 	return m_imageInfos;
 }
 
+
+void DescriptorSet::Free()
+{
+	if (m_descriptorPool && m_handle != VK_NULL_HANDLE)
+	{
+		m_descriptorPool->FreeDescriptorSet(m_handle);
+		m_handle = VK_NULL_HANDLE;
+	}
+}
+
 }        // namespace vkb
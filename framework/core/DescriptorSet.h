@@ -31,6 +31,8 @@ class DescriptorPool;
  *        Destroying the handle has no effect, as the pool manages the lifecycle of its descriptor sets.
  *
  *        Keeps track of what bindings were written to prevent a double write.
+ *        If its layout has an update template and every descriptor of the layout is provided,
+ *        the infos are packed once and written with a single vkUpdateDescriptorSetWithTemplateKHR.
  */
 class DescriptorSet
 {
@@ -50,6 +52,21 @@ class DescriptorSet
 	              const BindingMap<VkDescriptorBufferInfo>& bufferInfos = {},
 	              const BindingMap<VkDescriptorImageInfo>& imageInfos  = {});
 
+	/**
+	 * @brief Constructs a descriptor set from a handle allocated by the caller, such as from a \ref LinearDescriptorPool
+	 *        Implicitly calls prepare()
+	 * @param device A valid Vulkan device
+	 * @param descriptor_set_layout The Vulkan descriptor set layout this descriptor set has
+	 * @param handle The descriptor set handle, allocated with descriptor_set_layout
+	 * @param buffer_infos The descriptors that describe buffer data
+	 * @param image_infos The descriptors that describe image data
+	 */
+	DescriptorSet(Device& device,
+	              const DescriptorSetLayout& descriptorSetLayout,
+	              VkDescriptorSet handle,
+	              const BindingMap<VkDescriptorBufferInfo>& bufferInfos = {},
+	              const BindingMap<VkDescriptorImageInfo>& imageInfos  = {});
+
 	DescriptorSet(const DescriptorSet&) = delete;
 
 	DescriptorSet(DescriptorSet&& other);
@@ -89,6 +106,12 @@ class DescriptorSet
 
 	BindingMap<VkDescriptorImageInfo>& GetImageInfos();
 
+	/**
+	 * @brief Returns the handle to the pool it was allocated from, e.g. when evicted from a cache
+	 *        The GPU must be done with the descriptor set, which can't be used afterwards.
+	 */
+	void Free();
+
   protected:
 	/**
 	 * @brief Prepares the descriptor set to have its contents updated by loading a vector of write operations
@@ -97,11 +120,23 @@ class DescriptorSet
 	void Prepare();
 
   private:
+	/**
+	 * @brief Packs the infos in the layout of the update template
+	 * @return False if there is no template or some descriptors of the layout are not provided
+	 */
+	bool PrepareTemplateData();
+
+	/**
+	 * @brief Clips the range of a buffer info to the limits of its descriptor type
+	 */
+	void ClampBufferRange(uint32_t bindingIndex, VkDescriptorType descriptorType, VkDescriptorBufferInfo& bufferInfo) const;
+
 	Device& m_device;
 
 	const DescriptorSetLayout& m_descriptorSetLayout;
 
-	DescriptorPool& m_descriptorPool;
+	// The pool the handle was allocated from, null if it was allocated by the caller
+	DescriptorPool* m_descriptorPool{ nullptr };
 
 	BindingMap<VkDescriptorBufferInfo> m_bufferInfos;
 
@@ -115,5 +150,11 @@ class DescriptorSet
 	// The bindings of the write descriptors that have had vkUpdateDescriptorSets since the last call to update().
 	// Each binding number is mapped to a hash of the binding description that it will be updated to.
 	std::unordered_map<uint32_t, size_t> m_updatedBindings;
+
+	// The infos packed for the update template of the layout, empty if the write operations are used instead
+	std::vector<uint8_t> m_templateData;
+
+	// Whether m_templateData was written to the descriptor set since the last reset
+	bool m_templateWritten{false};
 };
 }        // namespace vkb
@@ -19,6 +19,7 @@
 
 #include "device.h"
 #include "physical_device.h"
+#include "portability.h"
 #include "shader_module.h"
 
 namespace vkb
@@ -97,6 +98,81 @@ inline bool ValidateFlags(const PhysicalDevice& gpu, const std::vector<VkDescrip
 	return true;
 }
 
+
+inline size_t GetDescriptorSize(const VkPhysicalDeviceDescriptorBufferPropertiesEXT& properties, VkDescriptorType descriptorType)
+{
+	switch (descriptorType)
+	{
+		case VK_DESCRIPTOR_TYPE_SAMPLER:
+			return properties.samplerDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			return properties.combinedImageSamplerDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			return properties.sampledImageDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			return properties.storageImageDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+			return properties.inputAttachmentDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			return properties.uniformBufferDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			return properties.storageBufferDescriptorSize;
+		default:
+			throw std::runtime_error("Descriptor type not supported in a descriptor buffer.");
+	}
+}
+
+
+inline bool HasBinding(const ShaderResource& resource)
+{
+	return resource.type != ShaderResourceType::Input &&
+	       resource.type != ShaderResourceType::Output &&
+	       resource.type != ShaderResourceType::PushConstant &&
+	       resource.type != ShaderResourceType::SpecializationConstant;
+}
+
+
+/**
+ * @brief Whether the portability profile pushes a set instead of allocating it
+ *        Only the single set of a pipeline is pushed, since a pipeline layout has at most one push descriptor set.
+ */
+inline bool PrefersPushDescriptor(Device& device, const uint32_t setIndex, const std::vector<ShaderModule*>& shaderModules, const std::vector<ShaderResource>& resourceSet)
+{
+	if (!portability::get_settings().prefer_push_descriptors || !device.is_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+	{
+		return false;
+	}
+
+	for (auto* shaderModule : shaderModules)
+	{
+		for (auto& resource : shaderModule->get_resources())
+		{
+			if (HasBinding(resource) && resource.set != setIndex)
+			{
+				return false;
+			}
+		}
+	}
+
+	uint32_t descriptorCount = 0;
+	for (auto& resource : resourceSet)
+	{
+		if (!HasBinding(resource))
+		{
+			continue;
+		}
+
+		if (resource.mode == ShaderResourceMode::UpdateAfterBind || resource.mode == ShaderResourceMode::Bindless)
+		{
+			return false;
+		}
+
+		descriptorCount += resource.array_size;
+	}
+
+	return descriptorCount <= DescriptorSetLayout::MaxPushDescriptors;
+}
+
 } // anonymous namespace
 
 
@@ -109,24 +185,32 @@ DescriptorSetLayout::DescriptorSetLayout(Device& device, const uint32_t setIndex
 	//        This way, different pipelines (with different shaders / shader variants) will get
 	//        different descriptor set layouts (incl. appropriate name -> binding lookups)
 
+	// Descriptor buffers have no dynamic or update-after-bind descriptors: dynamic offsets are baked in the
+	// buffer infos and every binding is written when the set is flushed
+	m_descriptorBuffer = device.uses_descriptor_buffers();
+
+	// The portability profile pushes the whole set, its dynamic buffers are pushed with their offsets, as with descriptor buffers
+	bool preferPush = !m_descriptorBuffer && PrefersPushDescriptor(device, setIndex, shaderModules, resourceSet);
+
 	for (auto& resource : resourceSet)
 	{
 		// Skip shader resources whitout a binding point
-		if (resource.type == ShaderResourceType::Input ||
-		    resource.type == ShaderResourceType::Output ||
-		    resource.type == ShaderResourceType::PushConstant ||
-		    resource.type == ShaderResourceType::SpecializationConstant)
+		if (!HasBinding(resource))
 		{
 			continue;
 		}
 
 		// Convert from ShaderResourceType to VkDescriptorType.
-		auto descriptor_type = FindDescriptorType(resource.type, resource.mode == ShaderResourceMode::Dynamic);
+		auto descriptor_type = FindDescriptorType(resource.type, resource.mode == ShaderResourceMode::Dynamic && !m_descriptorBuffer && !preferPush);
 
-		if (resource.mode == ShaderResourceMode::UpdateAfterBind)
+		if (resource.mode == ShaderResourceMode::UpdateAfterBind && !m_descriptorBuffer)
 		{
 			m_bindingFlags.push_back(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT);
 		}
+		else if (resource.mode == ShaderResourceMode::Bindless && !m_descriptorBuffer)
+		{
+			m_bindingFlags.push_back(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT);
+		}
 		else
 		{
 			// When creating a descriptor set layout, if we give a structure to create_info.pNext, each binding needs to have a binding flag
@@ -143,6 +227,12 @@ DescriptorSetLayout::DescriptorSetLayout(Device& device, const uint32_t setIndex
 		layout_binding.descriptorType  = descriptor_type;
 		layout_binding.stageFlags      = static_cast<VkShaderStageFlags>(resource.stages);
 
+		// The bindless array is shared by every pipeline, its layout must not depend on the stages using it
+		if (resource.mode == ShaderResourceMode::Bindless)
+		{
+			layout_binding.stageFlags = VK_SHADER_STAGE_ALL;
+		}
+
 		m_bindings.push_back(layout_binding);
 
 		// Store mapping between binding and the binding point
@@ -160,8 +250,8 @@ DescriptorSetLayout::DescriptorSetLayout(Device& device, const uint32_t setIndex
 
 	// Handle update-after-bind extensions
 	VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_create_info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT};
-	if (std::find_if(resourceSet.begin(), resourceSet.end(),
-	                 [](const ShaderResource& shaderResource) { return shaderResource.mode == ShaderResourceMode::UpdateAfterBind; }) != resourceSet.end())
+	if (std::find_if(m_bindingFlags.begin(), m_bindingFlags.end(),
+	                 [](VkDescriptorBindingFlagsEXT flags) { return flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT; }) != m_bindingFlags.end())
 	{
 		// Spec states you can't have ANY dynamic resources if you have one of the bindings set to update-after-bind
 		if (std::find_if(resourceSet.begin(), resourceSet.end(),
@@ -179,7 +269,45 @@ DescriptorSetLayout::DescriptorSetLayout(Device& device, const uint32_t setIndex
 		binding_flags_create_info.pBindingFlags = m_bindingFlags.data();
 
 		create_info.pNext = &binding_flags_create_info;
-		create_info.flags |= std::find(m_bindingFlags.begin(), m_bindingFlags.end(), VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT) != m_bindingFlags.end() ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT : 0;
+		create_info.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+	}
+
+	if (preferPush)
+	{
+		m_pushDescriptor = true;
+		create_info.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+	}
+	// Sets with per-draw resources are pushed into the command buffer instead of being allocated and cached, if the device allows it
+	else if (device.is_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) && !m_descriptorBuffer &&
+	    std::find_if(resourceSet.begin(), resourceSet.end(),
+	                 [](const ShaderResource& shaderResource) { return shaderResource.mode == ShaderResourceMode::PerDraw; }) != resourceSet.end())
+	{
+		uint32_t descriptorCount = 0;
+		for (auto& binding : m_bindings)
+		{
+			descriptorCount += binding.descriptorCount;
+		}
+
+		// Push descriptor sets can't have dynamic or update-after-bind resources
+		m_pushDescriptor = descriptorCount <= MaxPushDescriptors &&
+		                   std::find_if(resourceSet.begin(), resourceSet.end(),
+		                                [](const ShaderResource& shaderResource) { return shaderResource.mode == ShaderResourceMode::Dynamic ||
+		                                                                                  shaderResource.mode == ShaderResourceMode::UpdateAfterBind ||
+		                                                                                  shaderResource.mode == ShaderResourceMode::Bindless; }) == resourceSet.end();
+
+		if (m_pushDescriptor)
+		{
+			create_info.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		}
+		else
+		{
+			LOGW("Set {} has per-draw resources but can't be pushed, it will be allocated instead", setIndex);
+		}
+	}
+
+	if (m_descriptorBuffer)
+	{
+		create_info.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
 	}
 
 	// Create the Vulkan descriptor set layout handle
@@ -189,6 +317,79 @@ DescriptorSetLayout::DescriptorSetLayout(Device& device, const uint32_t setIndex
 	{
 		throw VulkanException{result, "Cannot create DescriptorSetLayout"};
 	}
+
+	if (m_descriptorBuffer)
+	{
+		vkGetDescriptorSetLayoutSizeEXT(device.get_handle(), m_handle, &m_descriptorBufferSize);
+
+		m_descriptorBufferOffsets.reserve(m_bindings.size());
+		for (auto& binding : m_bindings)
+		{
+			VkDeviceSize offset = 0;
+			vkGetDescriptorSetLayoutBindingOffsetEXT(device.get_handle(), m_handle, binding.binding, &offset);
+			m_descriptorBufferOffsets.push_back(offset);
+		}
+	}
+
+	// Bindings updated after bind are written by the application, they can't be part of a template writing the whole set
+	if (device.is_enabled(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME) && !m_pushDescriptor && !m_descriptorBuffer &&
+	    std::find_if(m_bindingFlags.begin(), m_bindingFlags.end(),
+	                 [](VkDescriptorBindingFlagsEXT flags) { return flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT; }) == m_bindingFlags.end())
+	{
+		CreateUpdateTemplate();
+	}
+}
+
+
+void DescriptorSetLayout::CreateUpdateTemplate()
+{
+	std::vector<VkDescriptorUpdateTemplateEntryKHR> entries;
+	entries.reserve(m_bindings.size());
+
+	size_t offset = 0;
+
+	for (auto& binding : m_bindings)
+	{
+		m_updateTemplateOffsets.push_back(offset);
+
+		if (binding.descriptorCount == 0)
+		{
+			continue;
+		}
+
+		VkDescriptorUpdateTemplateEntryKHR entry{};
+		entry.dstBinding      = binding.binding;
+		entry.dstArrayElement = 0;
+		entry.descriptorCount = binding.descriptorCount;
+		entry.descriptorType  = binding.descriptorType;
+		entry.offset          = offset;
+		entry.stride          = UpdateTemplateStride;
+
+		entries.push_back(entry);
+
+		offset += binding.descriptorCount * UpdateTemplateStride;
+	}
+
+	if (entries.empty())
+	{
+		m_updateTemplateOffsets.clear();
+		return;
+	}
+
+	VkDescriptorUpdateTemplateCreateInfoKHR create_info{VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR};
+	create_info.descriptorUpdateEntryCount = to_u32(entries.size());
+	create_info.pDescriptorUpdateEntries   = entries.data();
+	create_info.templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+	create_info.descriptorSetLayout        = m_handle;
+
+	VkResult result = vkCreateDescriptorUpdateTemplateKHR(m_device.get_handle(), &create_info, nullptr, &m_updateTemplate);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException{result, "Cannot create DescriptorUpdateTemplate"};
+	}
+
+	m_updateTemplateSize = offset;
 }
 
 
@@ -202,13 +403,27 @@ DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayout&& other)
 	, m_bindingsLookup{ std::move(other.m_bindingsLookup) }
 	, m_bindingFlagsLookup{ std::move(other.m_bindingFlagsLookup) }
 	, m_resourcesLookup{ std::move(other.m_resourcesLookup) }
+	, m_updateTemplate{ other.m_updateTemplate }
+	, m_updateTemplateOffsets{ std::move(other.m_updateTemplateOffsets) }
+	, m_updateTemplateSize{ other.m_updateTemplateSize }
+	, m_pushDescriptor{ other.m_pushDescriptor }
+	, m_descriptorBuffer{ other.m_descriptorBuffer }
+	, m_descriptorBufferSize{ other.m_descriptorBufferSize }
+	, m_descriptorBufferOffsets{ std::move(other.m_descriptorBufferOffsets) }
+	, m_bindingTables{ std::move(other.m_bindingTables) }
 {
-	other.m_handle = VK_NULL_HANDLE;
+	other.m_handle         = VK_NULL_HANDLE;
+	other.m_updateTemplate = VK_NULL_HANDLE;
 }
 
 
 DescriptorSetLayout::~DescriptorSetLayout()
 {
+	if (m_updateTemplate != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorUpdateTemplateKHR(m_device.get_handle(), m_updateTemplate, nullptr);
+	}
+
 	// Destroy descriptor set layout
 	if (m_handle != VK_NULL_HANDLE)
 	{
@@ -266,6 +481,30 @@ std::unique_ptr<VkDescriptorSetLayoutBinding> DescriptorSetLayout::GetLayoutBind
 }
 
 
+const std::vector<uint32_t>& DescriptorSetLayout::GetBindingTable(const std::vector<std::string>& names) const
+{
+	std::lock_guard<std::mutex> guard(m_bindingTablesMutex);
+
+	auto it = m_bindingTables.find(&names);
+	if (it != m_bindingTables.end())
+	{
+		return it->second;
+	}
+
+	std::vector<uint32_t> bindings(names.size(), NoBinding);
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		auto resource = m_resourcesLookup.find(names[i]);
+		if (resource != m_resourcesLookup.end())
+		{
+			bindings[i] = resource->second;
+		}
+	}
+
+	return m_bindingTables.emplace(&names, std::move(bindings)).first->second;
+}
+
+
 VkDescriptorBindingFlagsEXT DescriptorSetLayout::GetLayoutBindingFlag(const uint32_t bindingIndex) const
 {
 	auto it = m_bindingFlagsLookup.find(bindingIndex);
@@ -284,4 +523,118 @@ const std::vector<ShaderModule*>& DescriptorSetLayout::GetShaderModules() const
 	return m_shaderModules;
 }
 
+
+VkDescriptorUpdateTemplateKHR DescriptorSetLayout::GetUpdateTemplate() const
+{
+	return m_updateTemplate;
+}
+
+
+const std::vector<size_t>& DescriptorSetLayout::GetUpdateTemplateOffsets() const
+{
+	return m_updateTemplateOffsets;
+}
+
+
+size_t DescriptorSetLayout::GetUpdateTemplateSize() const
+{
+	return m_updateTemplateSize;
+}
+
+
+bool DescriptorSetLayout::IsPushDescriptor() const
+{
+	return m_pushDescriptor;
+}
+
+
+bool DescriptorSetLayout::IsDescriptorBuffer() const
+{
+	return m_descriptorBuffer;
+}
+
+
+VkDeviceSize DescriptorSetLayout::GetDescriptorBufferSize() const
+{
+	return m_descriptorBufferSize;
+}
+
+
+const std::vector<VkDeviceSize>& DescriptorSetLayout::GetDescriptorBufferOffsets() const
+{
+	return m_descriptorBufferOffsets;
+}
+
+
+void DescriptorSetLayout::WriteDescriptorBuffer(const BindingMap<VkDescriptorBufferInfo>& bufferInfos, const BindingMap<VkDescriptorImageInfo>& imageInfos, uint8_t* data) const
+{
+	assert(m_descriptorBuffer && "The layout was not created for descriptor buffers");
+
+	const auto& properties = m_device.get_descriptor_buffer_properties();
+
+	for (size_t i = 0; i < m_bindings.size(); ++i)
+	{
+		auto& binding = m_bindings[i];
+
+		size_t descriptorSize = GetDescriptorSize(properties, binding.descriptorType);
+
+		uint8_t* bindingData = data + m_descriptorBufferOffsets[i];
+
+		VkDescriptorGetInfoEXT getInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT};
+		getInfo.type = binding.descriptorType;
+
+		if (is_buffer_descriptor_type(binding.descriptorType))
+		{
+			auto bindingIt = bufferInfos.find(binding.binding);
+			if (bindingIt == bufferInfos.end())
+			{
+				continue;
+			}
+
+			for (auto& elementIt : bindingIt->second)
+			{
+				auto& bufferInfo = elementIt.second;
+				assert(bufferInfo.range != VK_WHOLE_SIZE && "Descriptor buffers need the range of the buffers they reference");
+
+				VkBufferDeviceAddressInfoKHR addressInfo{VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR};
+				addressInfo.buffer = bufferInfo.buffer;
+
+				VkDescriptorAddressInfoEXT descriptorAddress{VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT};
+				descriptorAddress.address = vkGetBufferDeviceAddressKHR(m_device.get_handle(), &addressInfo) + bufferInfo.offset;
+				descriptorAddress.range   = bufferInfo.range;
+
+				// Uniform and storage buffer pointers share the same location in the union
+				getInfo.data.pUniformBuffer = &descriptorAddress;
+
+				vkGetDescriptorEXT(m_device.get_handle(), &getInfo, descriptorSize, bindingData + elementIt.first * descriptorSize);
+			}
+		}
+		else
+		{
+			auto bindingIt = imageInfos.find(binding.binding);
+			if (bindingIt == imageInfos.end())
+			{
+				continue;
+			}
+
+			for (auto& elementIt : bindingIt->second)
+			{
+				auto& imageInfo = elementIt.second;
+
+				if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER)
+				{
+					getInfo.data.pSampler = &imageInfo.sampler;
+				}
+				else
+				{
+					// All the image descriptor types point to a VkDescriptorImageInfo
+					getInfo.data.pCombinedImageSampler = &imageInfo;
+				}
+
+				vkGetDescriptorEXT(m_device.get_handle(), &getInfo, descriptorSize, bindingData + elementIt.first * descriptorSize);
+			}
+		}
+	}
+}
+
 }        // namespace vkb
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "common/helpers.h"
 #include "common/vk_common.h"
 
@@ -35,6 +37,15 @@ struct ShaderResource;
 class DescriptorSetLayout
 {
   public:
+	/// Size of each descriptor in the data of the update template, big enough for either buffer or image infos
+	static constexpr size_t UpdateTemplateStride = std::max(sizeof(VkDescriptorBufferInfo), sizeof(VkDescriptorImageInfo));
+
+	/// Descriptor count of a push descriptor set guaranteed by VK_KHR_push_descriptor
+	static constexpr uint32_t MaxPushDescriptors = 32;
+
+	/// Binding of the names GetBindingTable doesn't find in the layout
+	static constexpr uint32_t NoBinding = ~0U;
+
 	/**
 	 * @brief Creates a descriptor set layout from a set of resources
 	 * @param device A valid Vulkan device
@@ -67,13 +78,73 @@ class DescriptorSetLayout
 
 	std::unique_ptr<VkDescriptorSetLayoutBinding> GetLayoutBinding(const std::string& name) const;
 
+	/**
+	 * @brief Returns the binding of each name of a table, NoBinding for the ones the layout doesn't have,
+	 *        so resources known by name are bound without hashing their names, e.g. with sg::material_texture_names
+	 *        The table is resolved on the first call and cached by its address, it has to outlive the layout.
+	 */
+	const std::vector<uint32_t>& GetBindingTable(const std::vector<std::string>& names) const;
+
 	const std::vector<VkDescriptorBindingFlagsEXT>& GetBindingFlags() const;
 
 	VkDescriptorBindingFlagsEXT GetLayoutBindingFlag(const uint32_t bindingIndex) const;
 
 	const std::vector<ShaderModule*>& GetShaderModules() const;
 
+	/**
+	 * @brief Returns the template updating every binding of the layout from a packed payload,
+	 *        VK_NULL_HANDLE if VK_KHR_descriptor_update_template is not enabled or the layout
+	 *        has update-after-bind bindings
+	 */
+	VkDescriptorUpdateTemplateKHR GetUpdateTemplate() const;
+
+	/**
+	 * @return Offset in the template payload of the first descriptor of each binding, in the order of GetBindings()
+	 */
+	const std::vector<size_t>& GetUpdateTemplateOffsets() const;
+
+	/**
+	 * @return Size in bytes of the template payload
+	 */
+	size_t GetUpdateTemplateSize() const;
+
+	/**
+	 * @brief Returns true if the layout was created for push descriptors, which happens when
+	 *        VK_KHR_push_descriptor is enabled and the set has per-draw resources.
+	 *        Descriptor sets of such a layout are pushed by the command buffer instead of allocated.
+	 */
+	bool IsPushDescriptor() const;
+
+	/**
+	 * @brief Returns true if the layout was created for VK_EXT_descriptor_buffer, which happens when
+	 *        the device uses descriptor buffers. Descriptors of such a layout are written into a
+	 *        descriptor buffer with WriteDescriptorBuffer instead of a descriptor set.
+	 */
+	bool IsDescriptorBuffer() const;
+
+	/**
+	 * @return Size in bytes of the descriptors of the layout in a descriptor buffer
+	 */
+	VkDeviceSize GetDescriptorBufferSize() const;
+
+	/**
+	 * @return Offset in the descriptor buffer of the first descriptor of each binding, in the order of GetBindings()
+	 */
+	const std::vector<VkDeviceSize>& GetDescriptorBufferOffsets() const;
+
+	/**
+	 * @brief Writes the descriptors of the given buffer and image infos in descriptor buffer memory
+	 * @param bufferInfos The buffer infos of the set, their range must not be VK_WHOLE_SIZE
+	 * @param imageInfos The image infos of the set
+	 * @param data Mapped memory of at least GetDescriptorBufferSize() bytes
+	 */
+	void WriteDescriptorBuffer(const BindingMap<VkDescriptorBufferInfo>& bufferInfos,
+	                           const BindingMap<VkDescriptorImageInfo>& imageInfos,
+	                           uint8_t* data) const;
+
   private:
+	void CreateUpdateTemplate();
+
 	Device& m_device;
 
 	VkDescriptorSetLayout m_handle{VK_NULL_HANDLE};
@@ -91,5 +162,24 @@ class DescriptorSetLayout
 	std::unordered_map<std::string, uint32_t> m_resourcesLookup;
 
 	std::vector<ShaderModule*> m_shaderModules;
+
+	VkDescriptorUpdateTemplateKHR m_updateTemplate{VK_NULL_HANDLE};
+
+	std::vector<size_t> m_updateTemplateOffsets;
+
+	size_t m_updateTemplateSize{0};
+
+	bool m_pushDescriptor{false};
+
+	bool m_descriptorBuffer{false};
+
+	VkDeviceSize m_descriptorBufferSize{0};
+
+	std::vector<VkDeviceSize> m_descriptorBufferOffsets;
+
+	/// Tables of GetBindingTable by the address of their names
+	mutable std::unordered_map<const std::vector<std::string>*, std::vector<uint32_t>> m_bindingTables;
+
+	mutable std::mutex m_bindingTablesMutex;
 };
 }        // namespace vkb
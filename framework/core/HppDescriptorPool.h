@@ -34,7 +34,10 @@ class HPPDevice;
 class HPPDescriptorPool : private vkb::DescriptorPool
 {
   public:
+	using vkb::DescriptorPool::GetPeakSetCount;
+	using vkb::DescriptorPool::Reserve;
 	using vkb::DescriptorPool::Reset;
+	using vkb::DescriptorPool::SetFreeDescriptorSets;
 
 	HPPDescriptorPool(vkb::core::HPPDevice &device, const vkb::core::HPPDescriptorSetLayout &descriptor_set_layout, uint32_t pool_size = MAX_SETS_PER_POOL) :
 	    vkb::DescriptorPool(reinterpret_cast<vkb::Device &>(device), reinterpret_cast<vkb::DescriptorSetLayout const &>(descriptor_set_layout), pool_size)
@@ -34,6 +34,7 @@ class HPPDescriptorSet : private vkb::DescriptorSet
 {
   public:
 	using vkb::DescriptorSet::ApplyWrites;
+	using vkb::DescriptorSet::Free;
 	using vkb::DescriptorSet::Update;
 
 	HPPDescriptorSet(vkb::core::HPPDevice                       &device,
@@ -48,6 +49,18 @@ class HPPDescriptorSet : private vkb::DescriptorSet
 	                       reinterpret_cast<BindingMap<VkDescriptorImageInfo> const &>(image_infos))
 	{}
 
+	HPPDescriptorSet(vkb::core::HPPDevice                       &device,
+	                 const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
+	                 vk::DescriptorSet                           handle,
+	                 const BindingMap<vk::DescriptorBufferInfo> &buffer_infos = {},
+	                 const BindingMap<vk::DescriptorImageInfo>  &image_infos  = {}) :
+	    vkb::DescriptorSet(reinterpret_cast<vkb::Device &>(device),
+	                       reinterpret_cast<vkb::DescriptorSetLayout const &>(descriptor_set_layout),
+	                       static_cast<VkDescriptorSet>(handle),
+	                       reinterpret_cast<BindingMap<VkDescriptorBufferInfo> const &>(buffer_infos),
+	                       reinterpret_cast<BindingMap<VkDescriptorImageInfo> const &>(image_infos))
+	{}
+
 	BindingMap<vk::DescriptorBufferInfo>& GetBufferInfos()
 	{
 		return reinterpret_cast<BindingMap<vk::DescriptorBufferInfo> &>(vkb::DescriptorSet::GetBufferInfos());
@@ -36,7 +36,10 @@ struct HPPShaderResource;
 class HPPDescriptorSetLayout : private vkb::DescriptorSetLayout
 {
   public:
+	using vkb::DescriptorSetLayout::GetDescriptorBufferSize;
 	using vkb::DescriptorSetLayout::GetIndex;
+	using vkb::DescriptorSetLayout::IsDescriptorBuffer;
+	using vkb::DescriptorSetLayout::IsPushDescriptor;
 
   public:
 	HPPDescriptorSetLayout(vkb::core::HPPDevice                            &device,
@@ -64,6 +67,13 @@ class HPPDescriptorSetLayout : private vkb::DescriptorSetLayout
 	{
 		return static_cast<vk::DescriptorBindingFlagsEXT>(vkb::DescriptorSetLayout::GetLayoutBindingFlag(binding_index));
 	}
+
+	void WriteDescriptorBuffer(const BindingMap<vk::DescriptorBufferInfo> &buffer_infos, const BindingMap<vk::DescriptorImageInfo> &image_infos, uint8_t *data) const
+	{
+		vkb::DescriptorSetLayout::WriteDescriptorBuffer(reinterpret_cast<BindingMap<VkDescriptorBufferInfo> const &>(buffer_infos),
+		                                                reinterpret_cast<BindingMap<VkDescriptorImageInfo> const &>(image_infos),
+		                                                data);
+	}
 };
 }        // namespace core
 }        // namespace vkb
@@ -0,0 +1,50 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "LinearDescriptorPool.h"
+#include <core/HppDescriptorSetLayout.h>
+
+namespace vkb
+{
+namespace core
+{
+class HPPDevice;
+
+/**
+ * @brief facade class around vkb::LinearDescriptorPool, providing a vulkan.hpp-based interface
+ *
+ * See vkb::LinearDescriptorPool for documentation
+ */
+class HPPLinearDescriptorPool : private vkb::LinearDescriptorPool
+{
+  public:
+	using vkb::LinearDescriptorPool::GetStats;
+	using vkb::LinearDescriptorPool::Reset;
+
+	HPPLinearDescriptorPool(vkb::core::HPPDevice &device, uint32_t max_sets_per_pool = MaxSetsPerPool) :
+	    vkb::LinearDescriptorPool(reinterpret_cast<vkb::Device &>(device), max_sets_per_pool)
+	{}
+
+	vk::DescriptorSet Allocate(const vkb::core::HPPDescriptorSetLayout &descriptor_set_layout)
+	{
+		return static_cast<vk::DescriptorSet>(vkb::LinearDescriptorPool::Allocate(reinterpret_cast<vkb::DescriptorSetLayout const &>(descriptor_set_layout)));
+	}
+};
+}        // namespace core
+}        // namespace vkb
@@ -0,0 +1,189 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LinearDescriptorPool.h"
+
+#include <array>
+#include <map>
+
+#include "DescriptorSetLayout.h"
+#include "device.h"
+
+namespace vkb
+{
+
+namespace
+{
+
+// Descriptors of each type per set in a pool, the mix of the sets of the framework shaders
+constexpr std::array<std::pair<VkDescriptorType, uint32_t>, 9> DescriptorsPerSet = {{
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4},
+    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2},
+    {VK_DESCRIPTOR_TYPE_SAMPLER, 1},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1},
+    {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1}}};
+
+inline bool HasUpdateAfterBind(const DescriptorSetLayout& descriptorSetLayout)
+{
+	auto& bindingFlags = descriptorSetLayout.GetBindingFlags();
+	return std::find_if(bindingFlags.begin(), bindingFlags.end(),
+	                    [](VkDescriptorBindingFlagsEXT flags) { return flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT; }) != bindingFlags.end();
+}
+
+} // anonymous namespace
+
+
+LinearDescriptorPool::LinearDescriptorPool(Device& device, uint32_t maxSetsPerPool)
+	: m_device{ device }
+	, m_maxSetsPerPool{ maxSetsPerPool }
+{
+	m_updateAfterBindPools.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+}
+
+
+LinearDescriptorPool::~LinearDescriptorPool()
+{
+	for (auto* chain : {&m_pools, &m_updateAfterBindPools})
+	{
+		for (auto pool : chain->pools)
+		{
+			vkDestroyDescriptorPool(m_device.get_handle(), pool, nullptr);
+		}
+	}
+}
+
+
+VkDescriptorSet LinearDescriptorPool::Allocate(const DescriptorSetLayout& descriptorSetLayout)
+{
+	auto& chain = HasUpdateAfterBind(descriptorSetLayout) ? m_updateAfterBindPools : m_pools;
+
+	VkDescriptorSet handle = VK_NULL_HANDLE;
+
+	// Move to the next pool when the current one is full, the full pools wait for the next reset
+	while (chain.current < chain.pools.size())
+	{
+		auto result = TryAllocate(chain.pools[chain.current], descriptorSetLayout, handle);
+
+		if (result == VK_SUCCESS)
+		{
+			break;
+		}
+
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+		{
+			throw VulkanException{result, "Cannot allocate descriptor set"};
+		}
+
+		++chain.current;
+	}
+
+	if (handle == VK_NULL_HANDLE)
+	{
+		chain.pools.push_back(CreatePool(chain, descriptorSetLayout));
+		chain.current = chain.pools.size() - 1;
+		++m_stats.poolCount;
+
+		VK_CHECK(TryAllocate(chain.pools[chain.current], descriptorSetLayout, handle));
+	}
+
+	++m_stats.setCount;
+	m_stats.peakSetCount = std::max(m_stats.peakSetCount, m_stats.setCount);
+
+	return handle;
+}
+
+
+void LinearDescriptorPool::Reset()
+{
+	for (auto* chain : {&m_pools, &m_updateAfterBindPools})
+	{
+		// Only the pools up to the current one have been allocated from
+		for (size_t i = 0; i < chain->pools.size() && i <= chain->current; ++i)
+		{
+			vkResetDescriptorPool(m_device.get_handle(), chain->pools[i], 0);
+		}
+
+		chain->current = 0;
+	}
+
+	m_stats.setCount = 0;
+}
+
+
+const LinearDescriptorPoolStats& LinearDescriptorPool::GetStats() const
+{
+	return m_stats;
+}
+
+
+VkDescriptorPool LinearDescriptorPool::CreatePool(const PoolChain& chain, const DescriptorSetLayout& descriptorSetLayout)
+{
+	std::map<VkDescriptorType, uint32_t> descriptorTypeCounts;
+	for (auto& typeCount : DescriptorsPerSet)
+	{
+		descriptorTypeCounts[typeCount.first] = typeCount.second * m_maxSetsPerPool;
+	}
+
+	// Layouts with more descriptors than the usual mix still fit in at least one set
+	for (auto& binding : descriptorSetLayout.GetBindings())
+	{
+		auto& count = descriptorTypeCounts[binding.descriptorType];
+		count       = std::max(count, binding.descriptorCount);
+	}
+
+	std::vector<VkDescriptorPoolSize> poolSizes;
+	poolSizes.reserve(descriptorTypeCounts.size());
+	for (auto& it : descriptorTypeCounts)
+	{
+		poolSizes.push_back({it.first, it.second});
+	}
+
+	VkDescriptorPoolCreateInfo create_info{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+	create_info.flags         = chain.flags;
+	create_info.maxSets       = m_maxSetsPerPool;
+	create_info.poolSizeCount = to_u32(poolSizes.size());
+	create_info.pPoolSizes    = poolSizes.data();
+
+	VkDescriptorPool handle = VK_NULL_HANDLE;
+
+	auto result = vkCreateDescriptorPool(m_device.get_handle(), &create_info, nullptr, &handle);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException{result, "Cannot create linear descriptor pool"};
+	}
+
+	return handle;
+}
+
+
+VkResult LinearDescriptorPool::TryAllocate(VkDescriptorPool pool, const DescriptorSetLayout& descriptorSetLayout, VkDescriptorSet& handle)
+{
+	VkDescriptorSetLayout vkSetLayout = descriptorSetLayout.GetHandle();
+
+	VkDescriptorSetAllocateInfo alloc_info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+	alloc_info.descriptorPool     = pool;
+	alloc_info.descriptorSetCount = 1;
+	alloc_info.pSetLayouts        = &vkSetLayout;
+
+	return vkAllocateDescriptorSets(m_device.get_handle(), &alloc_info, &handle);
+}
+}        // namespace vkb
@@ -0,0 +1,119 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Device;
+class DescriptorSetLayout;
+
+/**
+ * @brief Allocation statistics of a LinearDescriptorPool
+ */
+struct LinearDescriptorPoolStats
+{
+	/// Vulkan descriptor pools created so far
+	uint32_t poolCount{0};
+
+	/// Descriptor sets allocated since the last reset
+	uint32_t setCount{0};
+
+	/// Largest number of descriptor sets allocated between two resets
+	uint32_t peakSetCount{0};
+};
+
+/**
+ * @brief Linear allocator of short lived descriptor sets
+ *
+ *        Descriptor sets of any layout are carved out of a few large pools sized for a mix of
+ *        descriptor types. A pool that runs out of memory is left behind until the next reset,
+ *        which resets every pool used so far with vkResetDescriptorPool, so there is no lookup
+ *        by layout and no descriptor set is freed individually.
+ *        Layouts with update-after-bind bindings are allocated from pools of their own.
+ */
+class LinearDescriptorPool
+{
+  public:
+	/// Descriptor sets of each pool
+	static constexpr uint32_t MaxSetsPerPool = 256;
+
+	/**
+	 * @param device A valid Vulkan device
+	 * @param maxSetsPerPool Descriptor sets of each pool, descriptor counts are scaled from it
+	 */
+	LinearDescriptorPool(Device& device, uint32_t maxSetsPerPool = MaxSetsPerPool);
+
+	LinearDescriptorPool(const LinearDescriptorPool&) = delete;
+
+	LinearDescriptorPool(LinearDescriptorPool&&) = delete;
+
+	~LinearDescriptorPool();
+
+	LinearDescriptorPool& operator=(const LinearDescriptorPool&) = delete;
+
+	LinearDescriptorPool& operator=(LinearDescriptorPool&&) = delete;
+
+	/**
+	 * @brief Allocates a descriptor set valid until the next call to Reset
+	 * @param descriptorSetLayout The layout of the descriptor set
+	 * @throws VulkanException if the set can't be allocated, even from a new pool
+	 */
+	VkDescriptorSet Allocate(const DescriptorSetLayout& descriptorSetLayout);
+
+	/**
+	 * @brief Resets the pools used since the last reset, the descriptor sets allocated from them become invalid
+	 */
+	void Reset();
+
+	const LinearDescriptorPoolStats& GetStats() const;
+
+  private:
+	/**
+	 * @brief A chain of pools sharing the same creation flags, allocated from front to back
+	 */
+	struct PoolChain
+	{
+		std::vector<VkDescriptorPool> pools;
+
+		/// Pool sets are currently allocated from, the pools before it are full
+		size_t current{0};
+
+		VkDescriptorPoolCreateFlags flags{0};
+	};
+
+	/**
+	 * @brief Creates a pool with room for at least the descriptors of the given layout
+	 */
+	VkDescriptorPool CreatePool(const PoolChain& chain, const DescriptorSetLayout& descriptorSetLayout);
+
+	VkResult TryAllocate(VkDescriptorPool pool, const DescriptorSetLayout& descriptorSetLayout, VkDescriptorSet& handle);
+
+	Device& m_device;
+
+	uint32_t m_maxSetsPerPool;
+
+	PoolChain m_pools;
+
+	PoolChain m_updateAfterBindPools;
+
+	LinearDescriptorPoolStats m_stats;
+};
+}        // namespace vkb
@@ -17,6 +17,8 @@
 
 #include "acceleration_structure.h"
 
+#include <utility>
+
 #include "device.h"
 
 namespace vkb
@@ -98,6 +100,14 @@ void AccelerationStructure::update_triangle_geometry(uint64_t
 	geometries[triangleUUID].updated                         = true;
 }
 
+void AccelerationStructure::set_triangle_vertices(uint64_t triangleUUID, uint64_t vertex_buffer_data_address, VkDeviceSize vertex_stride)
+{
+	auto &geometry                                                = geometries.at(triangleUUID);
+	geometry.geometry.geometry.triangles.vertexData.deviceAddress = vertex_buffer_data_address;
+	geometry.geometry.geometry.triangles.vertexStride             = vertex_stride;
+	geometry.updated                                              = true;
+}
+
 uint64_t AccelerationStructure::add_instance_geometry(std::unique_ptr<vkb::core::BufferC> &instance_buffer, uint32_t instance_count, uint32_t transform_offset, VkGeometryFlagsKHR flags)
 {
 	VkAccelerationStructureGeometryKHR geometry{};
@@ -131,31 +141,50 @@ void AccelerationStructure::update_instance_geometry(uint64_t
 }
 
 void AccelerationStructure::build(VkQueue queue, VkBuildAccelerationStructureFlagsKHR flags, VkBuildAccelerationStructureModeKHR mode)
+{
+	auto scratch_size = prepare_build(flags, mode);
+
+	// Create a scratch buffer as a temporary storage for the acceleration structure build
+	scratch_buffer = std::make_unique<vkb::core::BufferC>(
+	    device,
+	    scratch_size,
+	    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+	    VMA_MEMORY_USAGE_GPU_ONLY);
+
+	// Build the acceleration structure on the device via a one-time command buffer submission
+	VkCommandBuffer command_buffer = device.create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+	record_build(command_buffer, scratch_buffer->get_device_address());
+	device.flush_command_buffer(command_buffer, queue);
+	scratch_buffer.reset();
+}
+
+VkDeviceSize AccelerationStructure::prepare_build(VkBuildAccelerationStructureFlagsKHR flags, VkBuildAccelerationStructureModeKHR mode, const std::vector<uint32_t> &queue_families)
 {
 	assert(!geometries.empty());
 
-	std::vector<VkAccelerationStructureGeometryKHR>       acceleration_structure_geometries;
-	std::vector<VkAccelerationStructureBuildRangeInfoKHR> acceleration_structure_build_range_infos;
-	std::vector<uint32_t>                                 primitive_counts;
+	build_geometries.clear();
+	build_range_infos.clear();
+
+	std::vector<uint32_t> primitive_counts;
 	for (auto &geometry : geometries)
 	{
 		if (mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR && !geometry.second.updated)
 		{
 			continue;
 		}
-		acceleration_structure_geometries.push_back(geometry.second.geometry);
+		build_geometries.push_back(geometry.second.geometry);
 		// Infer build range info from geometry
 		VkAccelerationStructureBuildRangeInfoKHR build_range_info;
 		build_range_info.primitiveCount  = geometry.second.primitive_count;
 		build_range_info.primitiveOffset = 0;
 		build_range_info.firstVertex     = 0;
 		build_range_info.transformOffset = geometry.second.transform_offset;
-		acceleration_structure_build_range_infos.push_back(build_range_info);
+		build_range_infos.push_back(build_range_info);
 		primitive_counts.push_back(geometry.second.primitive_count);
 		geometry.second.updated = false;
 	}
 
-	VkAccelerationStructureBuildGeometryInfoKHR build_geometry_info{};
+	build_geometry_info       = {};
 	build_geometry_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
 	build_geometry_info.type  = type;
 	build_geometry_info.flags = flags;
@@ -165,8 +194,8 @@ void AccelerationStructure::build(VkQueue queue, VkBuildAccelerationStructureFla
 		build_geometry_info.srcAccelerationStructure = handle;
 		build_geometry_info.dstAccelerationStructure = handle;
 	}
-	build_geometry_info.geometryCount = static_cast<uint32_t>(acceleration_structure_geometries.size());
-	build_geometry_info.pGeometries   = acceleration_structure_geometries.data();
+	build_geometry_info.geometryCount = static_cast<uint32_t>(build_geometries.size());
+	build_geometry_info.pGeometries   = build_geometries.data();
 
 	// Get required build sizes
 	build_sizes_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
@@ -177,54 +206,85 @@ void AccelerationStructure::build(VkQueue queue, VkBuildAccelerationStructureFla
 	    primitive_counts.data(),
 	    &build_sizes_info);
 
-	// Create a buffer for the acceleration structure
-	if (!buffer || buffer->get_size() != build_sizes_info.accelerationStructureSize)
+	// Create a buffer for the acceleration structure, an update keeps the structure it refits
+	if (!buffer || (mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR && buffer->get_size() < build_sizes_info.accelerationStructureSize))
 	{
-		buffer = std::make_unique<vkb::core::BufferC>(
-		    device,
-		    build_sizes_info.accelerationStructureSize,
-		    VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-		    VMA_MEMORY_USAGE_GPU_ONLY);
-
-		VkAccelerationStructureCreateInfoKHR acceleration_structure_create_info{};
-		acceleration_structure_create_info.sType  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-		acceleration_structure_create_info.buffer = buffer->get_handle();
-		acceleration_structure_create_info.size   = build_sizes_info.accelerationStructureSize;
-		acceleration_structure_create_info.type   = type;
-		VkResult result                           = vkCreateAccelerationStructureKHR(device.get_handle(), &acceleration_structure_create_info, nullptr, &handle);
-
-		if (result != VK_SUCCESS)
-		{
-			throw VulkanException{result, "Could not create acceleration structure"};
-		}
+		create(build_sizes_info.accelerationStructureSize, queue_families);
 	}
 
-	// Get the acceleration structure's handle
-	VkAccelerationStructureDeviceAddressInfoKHR acceleration_device_address_info{};
-	acceleration_device_address_info.sType                 = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
-	acceleration_device_address_info.accelerationStructure = handle;
-	device_address                                         = vkGetAccelerationStructureDeviceAddressKHR(device.get_handle(), &acceleration_device_address_info);
+	build_geometry_info.dstAccelerationStructure = handle;
 
-	// Create a scratch buffer as a temporary storage for the acceleration structure build
-	scratch_buffer = std::make_unique<vkb::core::BufferC>(
-	    device,
-	    build_sizes_info.buildScratchSize,
-	    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-	    VMA_MEMORY_USAGE_GPU_ONLY);
+	return mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR ? build_sizes_info.updateScratchSize : build_sizes_info.buildScratchSize;
+}
 
-	build_geometry_info.scratchData.deviceAddress = scratch_buffer->get_device_address();
-	build_geometry_info.dstAccelerationStructure  = handle;
+void AccelerationStructure::record_build(VkCommandBuffer command_buffer, VkDeviceAddress scratch_address)
+{
+	build_geometry_info.scratchData.deviceAddress = scratch_address;
 
-	// Build the acceleration structure on the device via a one-time command buffer submission
-	VkCommandBuffer command_buffer       = device.create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-	auto            as_build_range_infos = &*acceleration_structure_build_range_infos.data();
+	auto as_build_range_infos = build_range_infos.data();
 	vkCmdBuildAccelerationStructuresKHR(
 	    command_buffer,
 	    1,
 	    &build_geometry_info,
 	    &as_build_range_infos);
-	device.flush_command_buffer(command_buffer, queue);
-	scratch_buffer.reset();
+}
+
+std::unique_ptr<AccelerationStructure> AccelerationStructure::compact(VkCommandBuffer command_buffer, VkDeviceSize compacted_size, const std::vector<uint32_t> &queue_families)
+{
+	// The original keeps its handle and buffer until it is destroyed
+	auto original            = std::make_unique<AccelerationStructure>(device, type);
+	original->handle         = std::exchange(handle, VK_NULL_HANDLE);
+	original->buffer         = std::move(buffer);
+	original->device_address = device_address;
+
+	create(compacted_size, queue_families);
+
+	VkCopyAccelerationStructureInfoKHR copy_info{VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR};
+	copy_info.src  = original->handle;
+	copy_info.dst  = handle;
+	copy_info.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+	vkCmdCopyAccelerationStructureKHR(command_buffer, &copy_info);
+
+	return original;
+}
+
+void AccelerationStructure::create(VkDeviceSize size, const std::vector<uint32_t> &queue_families)
+{
+	if (handle != VK_NULL_HANDLE)
+	{
+		vkDestroyAccelerationStructureKHR(device.get_handle(), handle, nullptr);
+		handle = VK_NULL_HANDLE;
+	}
+
+	buffer = vkb::core::BufferBuilderC(size)
+	             .with_usage(VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+	             .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY)
+	             .with_queue_families(queue_families)
+	             .with_implicit_sharing_mode()
+	             .build_unique(device);
+
+	VkAccelerationStructureCreateInfoKHR acceleration_structure_create_info{};
+	acceleration_structure_create_info.sType  = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+	acceleration_structure_create_info.buffer = buffer->get_handle();
+	acceleration_structure_create_info.size   = size;
+	acceleration_structure_create_info.type   = type;
+	VkResult result                           = vkCreateAccelerationStructureKHR(device.get_handle(), &acceleration_structure_create_info, nullptr, &handle);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException{result, "Could not create acceleration structure"};
+	}
+
+	// Get the acceleration structure's handle
+	VkAccelerationStructureDeviceAddressInfoKHR acceleration_device_address_info{};
+	acceleration_device_address_info.sType                 = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+	acceleration_device_address_info.accelerationStructure = handle;
+	device_address                                         = vkGetAccelerationStructureDeviceAddressKHR(device.get_handle(), &acceleration_device_address_info);
+}
+
+VkAccelerationStructureTypeKHR AccelerationStructure::get_type() const
+{
+	return type;
 }
 
 VkAccelerationStructureKHR AccelerationStructure::get_handle() const
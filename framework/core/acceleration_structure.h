@@ -87,6 +87,15 @@ class AccelerationStructure
 	                              uint64_t                             index_buffer_data_address     = 0,
 	                              uint64_t                             transform_buffer_data_address = 0);
 
+	/**
+	 * @brief Points a triangle geometry to other vertices and marks it for the next update, to refit the structure around
+	 *        vertices written on the device such as skinned ones. The format and count of the vertices must be unchanged.
+	 * @param triangleUUID The geometry returned by add_triangle_geometry()
+	 * @param vertex_buffer_data_address Device address of the first vertex
+	 * @param vertex_stride Stride of the vertices
+	 */
+	void set_triangle_vertices(uint64_t triangleUUID, uint64_t vertex_buffer_data_address, VkDeviceSize vertex_stride);
+
 	/**
 	 * @brief Adds instance geometry to the acceleration structure (only valid for top level)
 	 * @returns index of the instance geometry into the structure.
@@ -115,6 +124,36 @@ class AccelerationStructure
 	           VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
 	           VkBuildAccelerationStructureModeKHR  mode  = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR);
 
+	/**
+	 * @brief Gathers the geometries to build and creates the acceleration structure of the size they need, so that
+	 *        the build can be recorded with others by record_build(), see AccelerationStructureBuilder
+	 * @param flags Build flags
+	 * @param mode Build mode (build or update)
+	 * @param queue_families Families of the queues accessing the structure, its buffer is shared between them if there are several
+	 * @return The size of the scratch memory the build needs
+	 */
+	VkDeviceSize prepare_build(VkBuildAccelerationStructureFlagsKHR flags,
+	                           VkBuildAccelerationStructureModeKHR  mode,
+	                           const std::vector<uint32_t>         &queue_families = {});
+
+	/**
+	 * @brief Records the build last prepared
+	 * @param scratch_address Device address of the scratch memory of the build, aligned to minAccelerationStructureScratchOffsetAlignment
+	 */
+	void record_build(VkCommandBuffer command_buffer, VkDeviceAddress scratch_address);
+
+	/**
+	 * @brief Moves the structure into a buffer of its compacted size, which changes its device address
+	 *        The structure must have been built with VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR.
+	 * @param command_buffer Records the copy from the original structure
+	 * @param compacted_size Size written by vkCmdWriteAccelerationStructuresPropertiesKHR once the build completed
+	 * @param queue_families Families of the queues accessing the structure
+	 * @return The original structure, to be destroyed once the copy completed
+	 */
+	std::unique_ptr<AccelerationStructure> compact(VkCommandBuffer command_buffer, VkDeviceSize compacted_size, const std::vector<uint32_t> &queue_families = {});
+
+	VkAccelerationStructureTypeKHR get_type() const;
+
 	VkAccelerationStructureKHR get_handle() const;
 
 	const VkAccelerationStructureKHR *get() const;
@@ -132,6 +171,11 @@ class AccelerationStructure
 	}
 
   private:
+	/**
+	 * @brief Creates the buffer and the handle of a structure of a given size, destroying the previous handle
+	 */
+	void create(VkDeviceSize size, const std::vector<uint32_t> &queue_families);
+
 	Device &device;
 
 	VkAccelerationStructureKHR handle{VK_NULL_HANDLE};
@@ -152,6 +196,13 @@ class AccelerationStructure
 
 	std::unique_ptr<vkb::core::BufferC> scratch_buffer;
 
+	/// Prepared by prepare_build(), pointing to the geometries and ranges below
+	VkAccelerationStructureBuildGeometryInfoKHR build_geometry_info{};
+
+	std::vector<VkAccelerationStructureGeometryKHR> build_geometries;
+
+	std::vector<VkAccelerationStructureBuildRangeInfoKHR> build_range_infos;
+
 	std::map<uint64_t, Geometry> geometries{};
 
 	std::unique_ptr<vkb::core::BufferC> buffer{nullptr};
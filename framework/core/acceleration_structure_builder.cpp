@@ -0,0 +1,307 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/acceleration_structure_builder.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/device.h"
+#include "core/queue.h"
+
+namespace vkb
+{
+namespace core
+{
+namespace
+{
+VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+}        // namespace
+
+AccelerationStructureBuilder::AccelerationStructureBuilder(Device &device, const Queue &queue, const std::vector<uint32_t> &other_queue_families, VkDeviceSize scratch_arena_size) :
+    device{device},
+    queue{queue},
+    queue_families{queue.get_family_index()},
+    scratch_arena_size{scratch_arena_size}
+{
+	for (auto family : other_queue_families)
+	{
+		if (std::find(queue_families.begin(), queue_families.end(), family) == queue_families.end())
+		{
+			queue_families.push_back(family);
+		}
+	}
+
+	VkPhysicalDeviceAccelerationStructurePropertiesKHR acceleration_structure_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR};
+	VkPhysicalDeviceProperties2KHR                     properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &acceleration_structure_properties;
+	vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+	scratch_alignment = std::max<VkDeviceSize>(acceleration_structure_properties.minAccelerationStructureScratchOffsetAlignment, 1);
+
+	VkCommandPoolCreateInfo command_pool_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+	command_pool_info.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	command_pool_info.queueFamilyIndex = queue.get_family_index();
+	VK_CHECK(vkCreateCommandPool(device.get_handle(), &command_pool_info, nullptr, &command_pool));
+
+	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocate_info.commandPool        = command_pool;
+	allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount = 1;
+	VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, &command_buffer));
+
+	VkFenceCreateInfo fence_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+	VK_CHECK(vkCreateFence(device.get_handle(), &fence_info, nullptr, &fence));
+}
+
+AccelerationStructureBuilder::~AccelerationStructureBuilder()
+{
+	if (state != State::Idle)
+	{
+		vkWaitForFences(device.get_handle(), 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	}
+
+	originals.clear();
+
+	vkDestroyFence(device.get_handle(), fence, nullptr);
+	vkDestroyCommandPool(device.get_handle(), command_pool, nullptr);
+}
+
+void AccelerationStructureBuilder::add(AccelerationStructure &acceleration_structure, VkBuildAccelerationStructureFlagsKHR flags, bool compact)
+{
+	if (compact)
+	{
+		flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+	}
+
+	pending_builds.push_back({&acceleration_structure, flags, compact, 0});
+}
+
+void AccelerationStructureBuilder::submit()
+{
+	if (pending_builds.empty())
+	{
+		return;
+	}
+
+	wait();
+
+	builds = std::move(pending_builds);
+	pending_builds.clear();
+
+	// The top-level structures are built after the bottom-level structures they may reference
+	std::stable_partition(builds.begin(), builds.end(), [](const Build &build) {
+		return build.acceleration_structure->get_type() == VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+	});
+
+	stats                 = {};
+	stats.structure_count = to_u32(builds.size());
+
+	std::vector<VkDeviceSize>               scratch_sizes(builds.size());
+	std::vector<VkAccelerationStructureKHR> compacted_handles;
+	VkDeviceSize                            largest_scratch_size = 0;
+	for (size_t i = 0; i < builds.size(); ++i)
+	{
+		auto &build = builds[i];
+
+		scratch_sizes[i]     = align_up(build.acceleration_structure->prepare_build(build.flags, VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR, queue_families), scratch_alignment);
+		largest_scratch_size = std::max(largest_scratch_size, scratch_sizes[i]);
+
+		stats.build_size += build.acceleration_structure->get_buffer()->get_size();
+
+		if (build.compact)
+		{
+			build.query = to_u32(compacted_handles.size());
+			compacted_handles.push_back(build.acceleration_structure->get_handle());
+		}
+	}
+
+	// The arena is allocated with room for aligning its device address
+	VkDeviceSize arena_size = std::max(scratch_arena_size, largest_scratch_size);
+	if (!scratch_buffer || scratch_buffer->get_size() < arena_size + scratch_alignment)
+	{
+		scratch_buffer = std::make_unique<vkb::core::BufferC>(device,
+		                                                      arena_size + scratch_alignment,
+		                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+		                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+		scratch_buffer->set_debug_name("Acceleration structure builder: scratch arena");
+	}
+	VkDeviceAddress scratch_address = align_up(scratch_buffer->get_device_address(), scratch_alignment);
+
+	query_pool.reset();
+	if (!compacted_handles.empty())
+	{
+		VkQueryPoolCreateInfo query_pool_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+		query_pool_info.queryType  = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+		query_pool_info.queryCount = to_u32(compacted_handles.size());
+		query_pool                 = std::make_unique<QueryPool>(device, query_pool_info);
+	}
+
+	begin_command_buffer();
+
+	if (query_pool)
+	{
+		vkCmdResetQueryPool(command_buffer, query_pool->get_handle(), 0, to_u32(compacted_handles.size()));
+	}
+
+	// Orders the builds reusing the scratch memory, or reading the structures built before
+	VkMemoryBarrier build_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+	build_barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	build_barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+	VkDeviceSize scratch_offset = 0;
+	for (size_t i = 0; i < builds.size(); ++i)
+	{
+		auto &build = builds[i];
+
+		bool next_level = i > 0 && build.acceleration_structure->get_type() != builds[i - 1].acceleration_structure->get_type();
+		if (next_level || scratch_offset + scratch_sizes[i] > arena_size)
+		{
+			vkCmdPipelineBarrier(command_buffer,
+			                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+			                     0, 1, &build_barrier, 0, nullptr, 0, nullptr);
+			scratch_offset = 0;
+		}
+
+		build.acceleration_structure->record_build(command_buffer, scratch_address + scratch_offset);
+		scratch_offset += scratch_sizes[i];
+	}
+
+	if (!compacted_handles.empty())
+	{
+		vkCmdPipelineBarrier(command_buffer,
+		                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+		                     0, 1, &build_barrier, 0, nullptr, 0, nullptr);
+
+		vkCmdWriteAccelerationStructuresPropertiesKHR(command_buffer,
+		                                              to_u32(compacted_handles.size()),
+		                                              compacted_handles.data(),
+		                                              VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+		                                              query_pool->get_handle(),
+		                                              0);
+	}
+
+	submit_command_buffer();
+	state = State::Building;
+}
+
+bool AccelerationStructureBuilder::update()
+{
+	if (state == State::Idle)
+	{
+		return true;
+	}
+
+	if (!is_signaled())
+	{
+		return false;
+	}
+
+	if (state == State::Building)
+	{
+		compact();
+	}
+	else
+	{
+		originals.clear();
+		state = State::Idle;
+	}
+
+	return state == State::Idle;
+}
+
+void AccelerationStructureBuilder::wait()
+{
+	while (!update())
+	{
+		VK_CHECK(vkWaitForFences(device.get_handle(), 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()));
+	}
+}
+
+const AccelerationStructureBuilder::Stats &AccelerationStructureBuilder::get_stats() const
+{
+	return stats;
+}
+
+void AccelerationStructureBuilder::begin_command_buffer()
+{
+	VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VK_CHECK(vkBeginCommandBuffer(command_buffer, &begin_info));
+}
+
+void AccelerationStructureBuilder::submit_command_buffer()
+{
+	VK_CHECK(vkEndCommandBuffer(command_buffer));
+	VK_CHECK(vkResetFences(device.get_handle(), 1, &fence));
+
+	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers    = &command_buffer;
+	VK_CHECK(queue.submit({submit_info}, fence));
+}
+
+bool AccelerationStructureBuilder::is_signaled() const
+{
+	return vkGetFenceStatus(device.get_handle(), fence) == VK_SUCCESS;
+}
+
+void AccelerationStructureBuilder::compact()
+{
+	// The builds completed, the scratch memory is only kept for the next ones if it is the default size
+	if (scratch_buffer && scratch_buffer->get_size() > scratch_arena_size + scratch_alignment)
+	{
+		scratch_buffer.reset();
+	}
+
+	if (!query_pool)
+	{
+		stats.compacted_size = stats.build_size;
+		state                = State::Idle;
+		return;
+	}
+
+	auto query_count = to_u32(std::count_if(builds.begin(), builds.end(), [](const Build &build) { return build.compact; }));
+
+	std::vector<VkDeviceSize> compacted_sizes(query_count);
+	VK_CHECK(query_pool->get_results(0, query_count, compacted_sizes.size() * sizeof(VkDeviceSize), compacted_sizes.data(), sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT));
+
+	begin_command_buffer();
+
+	for (auto &build : builds)
+	{
+		if (!build.compact)
+		{
+			stats.compacted_size += build.acceleration_structure->get_buffer()->get_size();
+			continue;
+		}
+
+		originals.push_back(build.acceleration_structure->compact(command_buffer, compacted_sizes[build.query], queue_families));
+		stats.compacted_size += compacted_sizes[build.query];
+	}
+
+	submit_command_buffer();
+	state = State::Compacting;
+
+	LOGI("Compacting {} acceleration structures from {} to {} bytes", query_count, stats.build_size, stats.compacted_size);
+}
+}        // namespace core
+}        // namespace vkb
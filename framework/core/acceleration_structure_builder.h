@@ -0,0 +1,188 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/acceleration_structure.h"
+#include "core/buffer.h"
+#include "core/query_pool.h"
+
+namespace vkb
+{
+class Device;
+class Queue;
+
+namespace core
+{
+/**
+ * @brief Builds many acceleration structures at once without blocking, then compacts them
+ *
+ * The builds are recorded in a single command buffer, bottom-level structures first, and submitted to a queue,
+ * e.g. a compute queue, without waiting for them. They share a scratch arena: each build gets a range of it
+ * aligned as the device requires, and a barrier lets the builds which don't fit reuse it once the previous ones completed.
+ *
+ * Once the builds completed, the structures built for compaction are copied into buffers of their compacted size
+ * in a second submission, and the originals are destroyed when it completed. Compacting moves the structures, so
+ * a top-level structure must be built once the bottom-level structures it references were compacted, with their
+ * new device addresses. update() polls the submissions, the structures can be used once it returns true.
+ */
+class AccelerationStructureBuilder
+{
+  public:
+	/// Size of the scratch arena, a build needing more scratch memory gets a larger arena of its own
+	static constexpr VkDeviceSize DefaultScratchArenaSize = 64 * 1024 * 1024;
+
+	/**
+	 * @brief Sizes of the structures of the last builds
+	 */
+	struct Stats
+	{
+		uint32_t structure_count{0};
+
+		/// Sum of the sizes of the structures after their builds
+		VkDeviceSize build_size{0};
+
+		/// Sum of the sizes of the structures after compaction, the ones not compacted counting their build size
+		VkDeviceSize compacted_size{0};
+	};
+
+	/**
+	 * @param device A valid Vulkan device
+	 * @param queue Queue the builds are submitted to
+	 * @param queue_families Families of the other queues accessing the structures, their buffers are shared with them
+	 * @param scratch_arena_size Size of the scratch memory shared by the builds of a batch
+	 */
+	AccelerationStructureBuilder(Device &device, const Queue &queue, const std::vector<uint32_t> &queue_families = {},
+	                             VkDeviceSize scratch_arena_size = DefaultScratchArenaSize);
+
+	AccelerationStructureBuilder(const AccelerationStructureBuilder &) = delete;
+
+	AccelerationStructureBuilder(AccelerationStructureBuilder &&) = delete;
+
+	/**
+	 * @brief Waits for the submissions in flight
+	 */
+	~AccelerationStructureBuilder();
+
+	AccelerationStructureBuilder &operator=(const AccelerationStructureBuilder &) = delete;
+
+	AccelerationStructureBuilder &operator=(AccelerationStructureBuilder &&) = delete;
+
+	/**
+	 * @brief Queues the build of a structure, its geometries must be added and stay valid until the build completed
+	 * @param acceleration_structure The structure to build, must outlive the build
+	 * @param flags Build flags
+	 * @param compact Whether to compact the structure after its build, adding VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR to the flags
+	 */
+	void add(AccelerationStructure               &acceleration_structure,
+	         VkBuildAccelerationStructureFlagsKHR flags   = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
+	         bool                                 compact = true);
+
+	/**
+	 * @brief Records the queued builds and submits them without waiting
+	 *        Waits for the previous submissions if they are still in flight.
+	 */
+	void submit();
+
+	/**
+	 * @brief Submits the compaction of the structures once their builds completed, and releases the originals once it completed
+	 * @return Whether the builds and compactions submitted so far completed
+	 */
+	bool update();
+
+	/**
+	 * @brief Blocks until the builds and compactions submitted so far completed
+	 */
+	void wait();
+
+	const Stats &get_stats() const;
+
+  private:
+	struct Build
+	{
+		AccelerationStructure *acceleration_structure;
+
+		VkBuildAccelerationStructureFlagsKHR flags;
+
+		bool compact;
+
+		/// Query of the compacted size, if compacted
+		uint32_t query;
+	};
+
+	enum class State
+	{
+		Idle,
+		Building,
+		Compacting
+	};
+
+	void begin_command_buffer();
+
+	void submit_command_buffer();
+
+	/**
+	 * @return Whether the fence of the last submission is signaled
+	 */
+	bool is_signaled() const;
+
+	/**
+	 * @brief Reads the compacted sizes and submits the copies of the compacted structures
+	 */
+	void compact();
+
+	Device &device;
+
+	const Queue &queue;
+
+	/// Families of the queues accessing the structures, including the one of the builder queue
+	std::vector<uint32_t> queue_families;
+
+	VkDeviceSize scratch_arena_size;
+
+	VkDeviceSize scratch_alignment{1};
+
+	VkCommandPool command_pool{VK_NULL_HANDLE};
+
+	/// Records the builds, then the compaction copies once the builds completed
+	VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+
+	VkFence fence{VK_NULL_HANDLE};
+
+	State state{State::Idle};
+
+	std::vector<Build> pending_builds;
+
+	/// Builds of the last submission
+	std::vector<Build> builds;
+
+	std::unique_ptr<vkb::core::BufferC> scratch_buffer;
+
+	std::unique_ptr<QueryPool> query_pool;
+
+	/// Originals of the compacted structures, destroyed once the copies completed
+	std::vector<std::unique_ptr<AccelerationStructure>> originals;
+
+	Stats stats;
+};
+}        // namespace core
+}        // namespace vkb
@@ -17,6 +17,15 @@
  */
 
 #include "allocated.h"
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+
+#include <core/util/profiling.hpp>
+#include <fmt/format.h>
+
 #include "common/error.h"
 
 namespace vkb
@@ -25,6 +34,202 @@ namespace vkb
 namespace allocated
 {
 
+namespace
+{
+std::array<std::atomic<VkDeviceSize>, static_cast<size_t>(MemoryCategory::Count)> memory_usage{};
+
+const char *to_string(MemoryCategory category)
+{
+	switch (category)
+	{
+		case MemoryCategory::Buffers:
+			return "buffers";
+		case MemoryCategory::Images:
+			return "images";
+		case MemoryCategory::RenderTargets:
+			return "render_targets";
+		case MemoryCategory::Staging:
+			return "staging";
+		default:
+			return "unknown";
+	}
+}
+
+Settings settings;
+
+std::mutex pools_mutex;
+
+/// The pools of each class, per memory type
+std::map<std::pair<ResourceClass, uint32_t>, VmaPool> pools;
+
+/// A pool allocating exportable memory, its export info is chained to each of its memory allocations
+struct ExportPool
+{
+	VkExportMemoryAllocateInfo export_info{VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO};
+
+	VmaPool pool{VK_NULL_HANDLE};
+};
+
+/// The pools of each set of external handle types, per memory type
+std::map<std::pair<VkExternalMemoryHandleTypeFlags, uint32_t>, ExportPool> export_pools;
+
+bool is_host_written(const VmaAllocationCreateInfo &allocation_create_info)
+{
+	return allocation_create_info.usage == VMA_MEMORY_USAGE_CPU_TO_GPU || allocation_create_info.usage == VMA_MEMORY_USAGE_CPU_ONLY ||
+	       (allocation_create_info.flags & VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT) != 0 ||
+	       (allocation_create_info.requiredFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+VmaAllocationCreateFlags get_strategy_flags(AllocationStrategy strategy)
+{
+	switch (strategy)
+	{
+		case AllocationStrategy::MinTime:
+			return VMA_ALLOCATION_CREATE_STRATEGY_MIN_TIME_BIT;
+		case AllocationStrategy::MinMemory:
+			return VMA_ALLOCATION_CREATE_STRATEGY_MIN_MEMORY_BIT;
+		default:
+			return 0;
+	}
+}
+
+VmaPool get_pool(ResourceClass resource_class, uint32_t memory_type_index)
+{
+	std::lock_guard<std::mutex> guard{pools_mutex};
+
+	auto &pool = pools[{resource_class, memory_type_index}];
+	if (pool == VK_NULL_HANDLE)
+	{
+		VmaPoolCreateInfo pool_info{};
+		pool_info.memoryTypeIndex = memory_type_index;
+		pool_info.priority        = settings.priorities[static_cast<size_t>(resource_class)];
+
+		// The per-frame buffers are mostly freed in the order they were allocated
+		if (resource_class == ResourceClass::PerFrame)
+		{
+			pool_info.flags |= VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+		}
+
+		VkResult result = vmaCreatePool(get_memory_allocator(), &pool_info, &pool);
+		if (result != VK_SUCCESS)
+		{
+			throw VulkanException{result, "Cannot create memory pool"};
+		}
+	}
+	return pool;
+}
+
+VmaPool get_export_pool(VkExternalMemoryHandleTypeFlags handle_types, uint32_t memory_type_index)
+{
+	std::lock_guard<std::mutex> guard{pools_mutex};
+
+	auto &export_pool = export_pools[{handle_types, memory_type_index}];
+	if (export_pool.pool == VK_NULL_HANDLE)
+	{
+		export_pool.export_info.handleTypes = handle_types;
+
+		VmaPoolCreateInfo pool_info{};
+		pool_info.memoryTypeIndex     = memory_type_index;
+		pool_info.pMemoryAllocateNext = &export_pool.export_info;
+
+		VkResult result = vmaCreatePool(get_memory_allocator(), &pool_info, &export_pool.pool);
+		if (result != VK_SUCCESS)
+		{
+			throw VulkanException{result, "Cannot create export memory pool"};
+		}
+	}
+	return export_pool.pool;
+}
+
+/**
+ * @return The external handle types of a resource from the chain of its create info, 0 if its memory isn't exported
+ */
+template <typename ExternalMemoryCreateInfo>
+VkExternalMemoryHandleTypeFlags find_export_handle_types(const void *next, VkStructureType type)
+{
+	for (auto it = static_cast<const VkBaseInStructure *>(next); it; it = it->pNext)
+	{
+		if (it->sType == type)
+		{
+			return reinterpret_cast<const ExternalMemoryCreateInfo *>(it)->handleTypes;
+		}
+	}
+	return 0;
+}
+
+template <typename FindMemoryType>
+void apply_export_settings(VkExternalMemoryHandleTypeFlags handle_types, VmaAllocationCreateInfo &allocation_create_info, FindMemoryType find_memory_type)
+{
+	// Each exported resource has a memory object of its own, which the other API imports whole
+	allocation_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+	if (allocation_create_info.pool != VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	uint32_t memory_type_index{0};
+	if (find_memory_type(memory_type_index) != VK_SUCCESS)
+	{
+		return;
+	}
+
+	allocation_create_info.pool = get_export_pool(handle_types, memory_type_index);
+}
+
+template <typename FindMemoryType>
+void apply_class_settings(ResourceClass resource_class, VmaAllocationCreateInfo &allocation_create_info, FindMemoryType find_memory_type)
+{
+	if (!(allocation_create_info.flags & VMA_ALLOCATION_CREATE_STRATEGY_MASK))
+	{
+		allocation_create_info.flags |= get_strategy_flags(settings.strategy);
+	}
+
+	// Only used by the dedicated allocations, the others get the priority of their pool
+	if (allocation_create_info.priority == 0.0f)
+	{
+		allocation_create_info.priority = settings.priorities[static_cast<size_t>(resource_class)];
+	}
+
+	if (!settings.use_pools || allocation_create_info.pool != VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	uint32_t memory_type_index{0};
+	if (find_memory_type(memory_type_index) != VK_SUCCESS)
+	{
+		// The allocation fails the same way without a pool
+		return;
+	}
+
+	allocation_create_info.pool = get_pool(resource_class, memory_type_index);
+}
+
+/**
+ * @return The heap of the memory both device local and host visible, if the host can map all of it, ~0U otherwise
+ */
+uint32_t find_resizable_bar_heap(VmaAllocator allocator)
+{
+	// Without a resizable BAR, the host only sees a window of 256 MiB of the device memory
+	constexpr VkDeviceSize          bar_window_size = 256ull * 1024 * 1024;
+	constexpr VkMemoryPropertyFlags bar_flags       = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+	const VkPhysicalDeviceMemoryProperties *memory_properties{nullptr};
+	vmaGetMemoryProperties(allocator, &memory_properties);
+
+	for (uint32_t type = 0; type < memory_properties->memoryTypeCount; ++type)
+	{
+		auto &memory_type = memory_properties->memoryTypes[type];
+		if ((memory_type.propertyFlags & bar_flags) == bar_flags && memory_properties->memoryHeaps[memory_type.heapIndex].size > bar_window_size)
+		{
+			return memory_type.heapIndex;
+		}
+	}
+	return ~0U;
+}
+}        // namespace
+
 VmaAllocator &get_memory_allocator()
 {
 	static VmaAllocator memory_allocator = VK_NULL_HANDLE;
@@ -49,6 +254,21 @@ void shutdown()
 	auto &allocator = get_memory_allocator();
 	if (allocator != VK_NULL_HANDLE)
 	{
+		{
+			std::lock_guard<std::mutex> guard{pools_mutex};
+			for (auto &it : pools)
+			{
+				vmaDestroyPool(allocator, it.second);
+			}
+			pools.clear();
+
+			for (auto &it : export_pools)
+			{
+				vmaDestroyPool(allocator, it.second.pool);
+			}
+			export_pools.clear();
+		}
+
 		VmaTotalStatistics stats;
 		vmaCalculateStatistics(allocator, &stats);
 		LOGI("Total device memory leaked: {} bytes.", stats.total.statistics.allocationBytes);
@@ -57,5 +277,184 @@ void shutdown()
 	}
 }
 
+void set_settings(const Settings &settings_)
+{
+	settings = settings_;
+}
+
+const Settings &get_settings()
+{
+	return settings;
+}
+
+void apply_settings(const VkBufferCreateInfo &create_info, VmaAllocationCreateInfo &allocation_create_info)
+{
+	ResourceClass resource_class = ResourceClass::StaticGeometry;
+	if (create_info.usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+	{
+		resource_class = ResourceClass::Staging;
+	}
+	else if (is_host_written(allocation_create_info))
+	{
+		resource_class = ResourceClass::PerFrame;
+	}
+
+	auto find_memory_type = [&](uint32_t &memory_type_index) {
+		return vmaFindMemoryTypeIndexForBufferInfo(get_memory_allocator(), &create_info, &allocation_create_info, &memory_type_index);
+	};
+
+	auto handle_types = find_export_handle_types<VkExternalMemoryBufferCreateInfo>(create_info.pNext, VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO);
+	if (handle_types)
+	{
+		apply_export_settings(handle_types, allocation_create_info, find_memory_type);
+		return;
+	}
+
+	apply_class_settings(resource_class, allocation_create_info, find_memory_type);
+}
+
+void apply_settings(const VkImageCreateInfo &create_info, VmaAllocationCreateInfo &allocation_create_info)
+{
+	constexpr VkImageUsageFlags attachment_flags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+	                                               VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+	ResourceClass resource_class = create_info.usage & attachment_flags ? ResourceClass::RenderTargets : ResourceClass::Textures;
+
+	auto find_memory_type = [&](uint32_t &memory_type_index) {
+		return vmaFindMemoryTypeIndexForImageInfo(get_memory_allocator(), &create_info, &allocation_create_info, &memory_type_index);
+	};
+
+	auto handle_types = find_export_handle_types<VkExternalMemoryImageCreateInfo>(create_info.pNext, VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO);
+	if (handle_types)
+	{
+		apply_export_settings(handle_types, allocation_create_info, find_memory_type);
+		return;
+	}
+
+	apply_class_settings(resource_class, allocation_create_info, find_memory_type);
+}
+
+bool has_resizable_bar()
+{
+	auto &allocator = get_memory_allocator();
+	return allocator != VK_NULL_HANDLE && find_resizable_bar_heap(allocator) != ~0U;
+}
+
+Placement get_per_frame_placement(VkDeviceSize size)
+{
+	Placement placement{};
+
+	auto &allocator = get_memory_allocator();
+	if (!settings.per_frame_resizable_bar || allocator == VK_NULL_HANDLE)
+	{
+		return placement;
+	}
+
+	uint32_t heap = find_resizable_bar_heap(allocator);
+	if (heap == ~0U)
+	{
+		return placement;
+	}
+
+	VmaBudget heap_budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetHeapBudgets(allocator, heap_budgets);
+
+	// The heap also holds the resources only the device can place there, they must not be evicted for per-frame data
+	auto &budget = heap_budgets[heap];
+	if (budget.usage + size > budget.budget - budget.budget / 10)
+	{
+		LOGD("Device local heap {} is near its budget, placing a per-frame buffer of {} bytes in host memory", heap, size);
+		return placement;
+	}
+
+	placement.memory_usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+	placement.flags        = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+	return placement;
+}
+
+std::vector<VmaPool> get_defragmentable_pools()
+{
+	std::lock_guard<std::mutex> guard{pools_mutex};
+
+	std::vector<VmaPool> result;
+	for (auto &it : pools)
+	{
+		if (it.first.first != ResourceClass::PerFrame)
+		{
+			result.push_back(it.second);
+		}
+	}
+	return result;
+}
+
+VkDeviceSize get_memory_usage(MemoryCategory category)
+{
+	return memory_usage[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+}
+
+void add_memory_usage(MemoryCategory category, VkDeviceSize size)
+{
+	memory_usage[static_cast<size_t>(category)].fetch_add(size, std::memory_order_relaxed);
+}
+
+void remove_memory_usage(MemoryCategory category, VkDeviceSize size)
+{
+	memory_usage[static_cast<size_t>(category)].fetch_sub(size, std::memory_order_relaxed);
+}
+
+void write_memory_report(const filesystem::Path &path)
+{
+	auto &allocator = get_memory_allocator();
+	if (allocator == VK_NULL_HANDLE)
+	{
+		LOGW("No memory allocator, the memory report isn't written");
+		return;
+	}
+
+	std::string json = "{\n";
+
+	json += "\t\"categories\": {";
+	for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::Count); ++i)
+	{
+		auto category = static_cast<MemoryCategory>(i);
+		json += fmt::format("{}\"{}\": {}", i == 0 ? "" : ", ", to_string(category), get_memory_usage(category));
+	}
+	json += "},\n";
+
+	const VkPhysicalDeviceMemoryProperties *memory_properties{nullptr};
+	vmaGetMemoryProperties(allocator, &memory_properties);
+
+	VmaBudget heap_budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetHeapBudgets(allocator, heap_budgets);
+
+	json += "\t\"heaps\": [";
+	for (uint32_t heap = 0; heap < memory_properties->memoryHeapCount; ++heap)
+	{
+		json += fmt::format("{}\n\t\t{{\"size\": {}, \"device_local\": {}, \"budget\": {}, \"usage\": {}, \"allocations\": {}, \"allocation_bytes\": {}}}",
+		                    heap == 0 ? "" : ",",
+		                    memory_properties->memoryHeaps[heap].size,
+		                    (memory_properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0,
+		                    heap_budgets[heap].budget,
+		                    heap_budgets[heap].usage,
+		                    heap_budgets[heap].statistics.allocationCount,
+		                    heap_budgets[heap].statistics.allocationBytes);
+	}
+	json += "\n\t],\n";
+
+	auto heap_allocations = get_heap_allocation_counters();
+	json += fmt::format("\t\"cpu_heap\": {{\"allocations\": {}, \"bytes\": {}}},\n", heap_allocations.allocations, heap_allocations.bytes);
+
+	// Already JSON, with the detailed map of the blocks
+	char *vma_stats{nullptr};
+	vmaBuildStatsString(allocator, &vma_stats, VK_TRUE);
+	json += fmt::format("\t\"vma\": {}\n", vma_stats);
+	vmaFreeStatsString(allocator, vma_stats);
+
+	json += "}\n";
+
+	filesystem::get()->write_file(path, json);
+
+	LOGI("Memory report written to {}", path.string());
+}
+
 }        // namespace allocated
 }        // namespace vkb
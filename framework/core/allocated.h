@@ -18,8 +18,13 @@
 
 #pragma once
 
+#include <array>
+#include <utility>
+#include <vector>
+
 #include "common/error.h"
 #include "core/vulkan_resource.h"
+#include "filesystem/filesystem.hpp"
 
 namespace vkb
 {
@@ -102,6 +107,193 @@ void init(const DeviceType &device)
  */
 void shutdown();
 
+/**
+ * @brief The kinds of resources the memory allocated through the VMA is accounted to
+ */
+enum class MemoryCategory
+{
+	Buffers,
+
+	Images,
+
+	/// Images used as attachments
+	RenderTargets,
+
+	/// Buffers only used as the source of transfers
+	Staging,
+
+	Count
+};
+
+/**
+ * @return The number of bytes allocated for the living resources of a category
+ */
+VkDeviceSize get_memory_usage(MemoryCategory category);
+
+/**
+ * @brief Accounts the memory of a resource to a category, called by `Allocated` when the resource is created
+ */
+void add_memory_usage(MemoryCategory category, VkDeviceSize size);
+
+/**
+ * @brief Removes the memory of a resource from a category, called by `Allocated` when the resource is destroyed
+ */
+void remove_memory_usage(MemoryCategory category, VkDeviceSize size);
+
+/**
+ * @brief The classes of resources which are allocated from pools of their own, see `Settings::use_pools`
+ */
+enum class ResourceClass
+{
+	/// Images used as attachments
+	RenderTargets,
+
+	/// Buffers only accessed by the device, e.g. vertex and index buffers uploaded once
+	StaticGeometry,
+
+	/// Images not used as attachments
+	Textures,
+
+	/// Buffers written by the host, e.g. the blocks of the buffer pools rewritten every frame
+	PerFrame,
+
+	/// Buffers only used as the source of transfers
+	Staging,
+
+	Count
+};
+
+/**
+ * @brief What the VMA favours when placing an allocation in its memory blocks
+ */
+enum class AllocationStrategy
+{
+	/// The default strategy of the VMA, a balance of both
+	Default,
+
+	/// Takes the first free range that fits, the allocations are faster
+	MinTime,
+
+	/// Searches the free range that fits best, the memory is less fragmented
+	MinMemory
+};
+
+/**
+ * @brief How the resources are allocated, set before the device is created
+ */
+struct Settings
+{
+	/**
+	 * @brief Allocates each class of resources from a pool of its own, per memory type
+	 *        The resources which change every frame then don't fragment the blocks of the long-lived ones.
+	 *        The pool of the per-frame buffers uses the linear algorithm, the freed space is reused from the end
+	 *        of its blocks once the buffers after it were freed too.
+	 */
+	bool use_pools{false};
+
+	AllocationStrategy strategy{AllocationStrategy::Default};
+
+	/**
+	 * @brief Priority of the memory of each class, from 0 to 1
+	 *        Only used with VK_EXT_memory_priority, the driver evicts the memory of the lowest priority first when
+	 *        the device memory is oversubscribed. The default pools of the VMA have a priority of 0.5.
+	 */
+	std::array<float, static_cast<size_t>(ResourceClass::Count)> priorities{1.0f, 0.75f, 0.5f, 0.75f, 0.0f};
+
+	/// Moves the movable buffers to compact the memory blocks when they are fragmented, see vkb::Defragmenter
+	bool defragmentation{false};
+
+	/**
+	 * @brief Places the buffers the host rewrites every frame in device local memory, see `get_per_frame_placement`
+	 *        Only when the device exposes all of its memory to the host through a resizable BAR.
+	 */
+	bool per_frame_resizable_bar{true};
+};
+
+/**
+ * @brief Sets how the resources are allocated, not synchronized with the allocations
+ */
+void set_settings(const Settings &settings);
+
+const Settings &get_settings();
+
+/**
+ * @brief Where a buffer is allocated by the VMA
+ */
+struct Placement
+{
+	VmaMemoryUsage memory_usage{VMA_MEMORY_USAGE_CPU_TO_GPU};
+
+	VmaAllocationCreateFlags flags{VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT};
+};
+
+/**
+ * @return Whether the device has memory both device local and host visible in a heap larger than the
+ *         256 MiB BAR window, i.e. a resizable BAR, or memory shared with the host
+ */
+bool has_resizable_bar();
+
+/**
+ * @brief Chooses where a buffer the host rewrites every frame is placed, e.g. the blocks of the buffer pools
+ *        With a resizable BAR the GPU reads it from its own memory instead of the system memory across PCIe.
+ *        The host only writes it sequentially then, since reads from that memory are uncached.
+ *        Falls back to host memory if the heap doesn't have a tenth of its budget left once the buffer is placed.
+ * @param size Size of the buffer
+ */
+Placement get_per_frame_placement(VkDeviceSize size);
+
+/**
+ * @return The pools of the resource classes the defragmentation can compact, the ones not using the linear algorithm
+ */
+std::vector<VmaPool> get_defragmentable_pools();
+
+/**
+ * @brief A resource the defragmentation can move to another place of the memory, see vkb::Defragmenter
+ *        The resource is found from the user data of its allocation.
+ */
+class Movable
+{
+  public:
+	virtual ~Movable() = default;
+
+	/**
+	 * @brief Creates a handle bound to the memory of the new allocation, and records the copy of the contents to it
+	 * @return Whether the resource moves, it stays in place otherwise
+	 */
+	virtual bool begin_move(VkCommandBuffer command_buffer, VmaAllocation allocation) = 0;
+
+	/**
+	 * @brief Replaces the handle of the resource by the one created by begin_move and destroys the previous one
+	 *        The GPU must be done with the previous handle.
+	 * @return The previous and the new handle
+	 */
+	virtual std::pair<VkBuffer, VkBuffer> end_move() = 0;
+};
+
+/**
+ * @brief Completes the allocation info of a buffer with the settings, called by `Allocated` before creating it
+ *        Sets the pool of its class if the pools are used, the strategy and the priority unless they are already set.
+ *        Buffers with a `VkExternalMemoryBufferCreateInfo` in their chain get a dedicated allocation from a pool
+ *        exporting their handle types instead, whatever the settings.
+ */
+void apply_settings(const VkBufferCreateInfo &create_info, VmaAllocationCreateInfo &allocation_create_info);
+
+/**
+ * @brief Completes the allocation info of an image with the settings, called by `Allocated` before creating it
+ *        Images with a `VkExternalMemoryImageCreateInfo` in their chain are exported like buffers.
+ */
+void apply_settings(const VkImageCreateInfo &create_info, VmaAllocationCreateInfo &allocation_create_info);
+
+/**
+ * @brief Writes a JSON report of the memory used by the application
+ *
+ * The report holds the usage of each category, the budget and usage of each memory heap, the heap allocations
+ * made on the CPU, and the detailed statistics of the VMA with the map of its blocks.
+ * Building the statistics walks all the allocations, so this isn't meant to be called every frame.
+ * @param path Path of the report, written through vkb::filesystem
+ */
+void write_memory_report(const filesystem::Path &path);
+
 /**
  * @brief The `Allocated` class serves as a base class for wrappers around Vulkan that require memory allocation
  * (`VkImage` and `VkBuffer`).  This class mostly ensures proper behavior for a RAII pattern, preventing double-release by
@@ -180,6 +372,11 @@ class Allocated : public vkb::core::VulkanResource<bindingType, HandleType>
 	 */
 	DeviceMemoryType get_memory() const;
 
+	/**
+	 * @brief Retrieves the VMA allocation of the resource, null if the handle wasn't allocated by the wrapper
+	 */
+	VmaAllocation get_allocation() const;
+
 	/**
 	 * @brief Maps Vulkan memory if it isn't already mapped to a host visible address. Does nothing if the
 	 * allocation is already mapped (including persistently mapped allocations).
@@ -362,6 +559,9 @@ class Allocated : public vkb::core::VulkanResource<bindingType, HandleType>
 	 * allocation information from the VMA, since this property won't change for the lifetime of the allocation.
 	 */
 	bool persistent = false;
+
+	/// The category the memory of the allocation is accounted to, see `get_memory_usage`
+	MemoryCategory memory_category = MemoryCategory::Buffers;
 };
 
 template <vkb::BindingType bindingType, typename HandleType>
@@ -371,7 +571,8 @@ inline Allocated<bindingType, HandleType>::Allocated(Allocated &&other) noexcept
     allocation(std::exchange(other.allocation, {})),
     mapped_data(std::exchange(other.mapped_data, {})),
     coherent(std::exchange(other.coherent, {})),
-    persistent(std::exchange(other.persistent, {}))
+    persistent(std::exchange(other.persistent, {})),
+    memory_category(std::exchange(other.memory_category, {}))
 {
 }
 
@@ -420,6 +621,8 @@ inline vk::Buffer Allocated<bindingType, HandleType>::create_buffer_impl(vk::Buf
 	vk::Buffer        buffer = VK_NULL_HANDLE;
 	VmaAllocationInfo allocation_info{};
 
+	apply_settings(reinterpret_cast<VkBufferCreateInfo const &>(create_info), allocation_create_info);
+
 	auto result = vmaCreateBuffer(
 	    get_memory_allocator(),
 	    reinterpret_cast<VkBufferCreateInfo const *>(&create_info),
@@ -432,6 +635,10 @@ inline vk::Buffer Allocated<bindingType, HandleType>::create_buffer_impl(vk::Buf
 	{
 		throw VulkanException{result, "Cannot create Buffer"};
 	}
+
+	memory_category = create_info.usage == vk::BufferUsageFlagBits::eTransferSrc ? MemoryCategory::Staging : MemoryCategory::Buffers;
+	add_memory_usage(memory_category, allocation_info.size);
+
 	post_create(allocation_info);
 	return buffer;
 }
@@ -466,12 +673,15 @@ inline vk::Image Allocated<bindingType, HandleType>::create_image_impl(vk::Image
 	{
 		allocation_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
 	}
+#endif
 
+	// Transient attachments never leave the tile memory of tilers, which back them with lazily allocated memory
 	if (create_info.usage & vk::ImageUsageFlagBits::eTransientAttachment)
 	{
 		allocation_create_info.preferredFlags |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
 	}
-#endif
+
+	apply_settings(reinterpret_cast<VkImageCreateInfo const &>(create_info), allocation_create_info);
 
 	VkResult result = vmaCreateImage(get_memory_allocator(),
 	                                 reinterpret_cast<VkImageCreateInfo const *>(&create_info),
@@ -485,6 +695,11 @@ inline vk::Image Allocated<bindingType, HandleType>::create_image_impl(vk::Image
 		throw VulkanException{result, "Cannot create Image"};
 	}
 
+	constexpr vk::ImageUsageFlags attachment_flags = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment |
+	                                                 vk::ImageUsageFlagBits::eInputAttachment | vk::ImageUsageFlagBits::eTransientAttachment;
+	memory_category = create_info.usage & attachment_flags ? MemoryCategory::RenderTargets : MemoryCategory::Images;
+	add_memory_usage(memory_category, allocation_info.size);
+
 	post_create(allocation_info);
 	return image;
 }
@@ -495,6 +710,11 @@ inline void Allocated<bindingType, HandleType>::destroy_buffer(BufferType handle
 	if (handle != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE)
 	{
 		unmap();
+
+		VmaAllocationInfo allocation_info{};
+		vmaGetAllocationInfo(get_memory_allocator(), allocation, &allocation_info);
+		remove_memory_usage(memory_category, allocation_info.size);
+
 		if constexpr (bindingType == vkb::BindingType::Cpp)
 		{
 			vmaDestroyBuffer(get_memory_allocator(), static_cast<VkBuffer>(handle), allocation);
@@ -513,6 +733,11 @@ inline void Allocated<bindingType, HandleType>::destroy_image(ImageType image)
 	if (image != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE)
 	{
 		unmap();
+
+		VmaAllocationInfo allocation_info{};
+		vmaGetAllocationInfo(get_memory_allocator(), allocation, &allocation_info);
+		remove_memory_usage(memory_category, allocation_info.size);
+
 		if constexpr (bindingType == vkb::BindingType::Cpp)
 		{
 			vmaDestroyImage(get_memory_allocator(), static_cast<VkImage>(image), allocation);
@@ -562,6 +787,12 @@ inline typename Allocated<bindingType, HandleType>::DeviceMemoryType Allocated<b
 	}
 }
 
+template <vkb::BindingType bindingType, typename HandleType>
+inline VmaAllocation Allocated<bindingType, HandleType>::get_allocation() const
+{
+	return allocation;
+}
+
 template <vkb::BindingType bindingType, typename HandleType>
 inline uint8_t *Allocated<bindingType, HandleType>::map()
 {
@@ -0,0 +1,49 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+namespace vkb
+{
+namespace backend
+{
+/**
+ * @brief The optional backends of the framework a VulkanSample switches to if the device supports them
+ *
+ * Each one requests the extensions and features it needs before the device is created, then enables the backend
+ * on the device. The samples keep the default backend when the device lacks them.
+ */
+struct Settings
+{
+	/// Write the descriptors into per-frame descriptor buffers instead of allocating descriptor sets, see Device::enable_descriptor_buffers
+	bool descriptor_buffers{false};
+
+	/// Bind a shader object per stage instead of pipelines, see Device::enable_shader_objects
+	bool shader_objects{false};
+
+	/// Begin dynamic rendering instances instead of render passes, see Device::enable_dynamic_rendering
+	bool dynamic_rendering{false};
+};
+
+/**
+ * @brief Sets the backend settings, to be called before the sample is prepared
+ */
+void set_settings(const Settings &settings);
+
+const Settings &get_settings();
+}        // namespace backend
+}        // namespace vkb
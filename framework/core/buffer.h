@@ -21,6 +21,7 @@
 #include "builder_base.h"
 #include "common/vk_common.h"
 #include "core/allocated.h"
+#include "core/resource_state_tracker.h"
 
 namespace vkb
 {
@@ -42,6 +43,8 @@ struct BufferBuilder
 	using BufferCreateInfoType  = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::BufferCreateInfo, VkBufferCreateInfo>::type;
 	using BufferUsageFlagsType  = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::BufferUsageFlags, VkBufferUsageFlags>::type;
 	using DeviceSizeType        = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::DeviceSize, VkDeviceSize>::type;
+	using ExternalMemoryHandleTypeFlagsType =
+	    typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::ExternalMemoryHandleTypeFlags, VkExternalMemoryHandleTypeFlags>::type;
 	using SharingModeType       = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::SharingMode, VkSharingMode>::type;
 
 	using DeviceType = typename std::conditional<bindingType == vkb::BindingType::Cpp, vkb::core::HPPDevice, vkb::Device>::type;
@@ -56,6 +59,16 @@ struct BufferBuilder
 	BufferPtr<bindingType> build_unique(DeviceType &device) const;
 	BufferBuilder         &with_flags(BufferCreateFlagsType flags);
 	BufferBuilder         &with_usage(BufferUsageFlagsType usage);
+
+	/**
+	 * @brief Makes the memory of the buffer exportable with the given handle types
+	 *        The buffer gets a memory object of its own, from a pool exporting these handle types.
+	 *        The create info chains a struct of the builder, which must outlive the build.
+	 */
+	BufferBuilder &with_external_memory(ExternalMemoryHandleTypeFlagsType handle_types);
+
+  private:
+	VkExternalMemoryBufferCreateInfo external_memory_create_info{VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO};
 };
 
 using BufferBuilderC   = BufferBuilder<vkb::BindingType::C>;
@@ -98,11 +111,25 @@ inline BufferBuilder<bindingType> &BufferBuilder<bindingType>::with_usage(Buffer
 	return *this;
 }
 
+template <vkb::BindingType bindingType>
+inline BufferBuilder<bindingType> &BufferBuilder<bindingType>::with_external_memory(ExternalMemoryHandleTypeFlagsType handle_types)
+{
+	external_memory_create_info.handleTypes = static_cast<VkExternalMemoryHandleTypeFlags>(handle_types);
+
+	if (this->create_info.pNext != &external_memory_create_info)
+	{
+		external_memory_create_info.pNext = this->create_info.pNext;
+		this->create_info.pNext           = &external_memory_create_info;
+	}
+	return *this;
+}
+
 /*=========================================================*/
 
 template <vkb::BindingType bindingType>
 class Buffer
-    : public vkb::allocated::Allocated<bindingType, typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::Buffer, VkBuffer>::type>
+    : public vkb::allocated::Allocated<bindingType, typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::Buffer, VkBuffer>::type>,
+      public vkb::allocated::Movable
 {
   public:
 	using BufferType           = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::Buffer, VkBuffer>::type;
@@ -125,9 +152,9 @@ class Buffer
 
 	Buffer()                          = delete;
 	Buffer(const Buffer &)            = delete;
-	Buffer(Buffer &&other)            = default;
+	Buffer(Buffer &&other) noexcept;
 	Buffer &operator=(const Buffer &) = delete;
-	Buffer &operator=(Buffer &&)      = default;
+	Buffer &operator=(Buffer &&other) noexcept;
 
 	/**
 	 * @brief Creates a buffer using VMA
@@ -160,11 +187,46 @@ class Buffer
 	 */
 	DeviceSizeType get_size() const;
 
+	/**
+	 * @brief Lets the defragmentation move the buffer to another place of the memory, see vkb::Defragmenter
+	 *        Only for buffers whose handle is read from the wrapper whenever it is recorded, or only referenced
+	 *        by the descriptor sets of the resource cache. The buffer needs the transfer source and destination usages.
+	 *        Buffers with a device address or host visible memory never move, since the addresses would change.
+	 */
+	void set_movable(bool movable);
+
+	bool begin_move(VkCommandBuffer command_buffer, VmaAllocation allocation) override;
+
+	std::pair<VkBuffer, VkBuffer> end_move() override;
+
+	/**
+	 * @return The state of the buffer after the accesses recorded so far, see CommandBuffer::request_buffer_state
+	 */
+	vkb::core::BufferStateTracker &get_state_tracker() const;
+
   private:
 	static Buffer<vkb::BindingType::Cpp> create_staging_buffer_impl(vkb::core::HPPDevice &device, vk::DeviceSize size, const void *data);
 
+	/// Points the user data of the allocation to this buffer if it is movable
+	void update_user_data();
+
   private:
 	vk::DeviceSize size = 0;
+
+	/// The parameters of the buffer, a buffer created with them replaces it when it moves
+	vk::BufferCreateFlags create_flags;
+
+	vk::BufferUsageFlags usage;
+
+	std::vector<uint32_t> queue_family_indices;
+
+	bool movable = false;
+
+	/// The handle created by begin_move, bound to the new place of the memory
+	vk::Buffer moved_handle;
+
+	/// Recording accesses to a const buffer changes its synchronization state, not the buffer
+	mutable vkb::core::BufferStateTracker state_tracker;
 };
 
 using BufferC   = Buffer<vkb::BindingType::C>;
@@ -228,11 +290,69 @@ inline Buffer<bindingType>::Buffer(DeviceType                  &device,
                .with_implicit_sharing_mode())
 {}
 
+template <vkb::BindingType bindingType>
+inline Buffer<bindingType>::Buffer(Buffer &&other) noexcept :
+    ParentType{static_cast<ParentType &&>(other)},
+    size{std::exchange(other.size, {})},
+    create_flags{std::exchange(other.create_flags, {})},
+    usage{std::exchange(other.usage, {})},
+    queue_family_indices{std::move(other.queue_family_indices)},
+    movable{std::exchange(other.movable, false)},
+    moved_handle{std::exchange(other.moved_handle, {})},
+    state_tracker{std::exchange(other.state_tracker, {})}
+{
+	update_user_data();
+}
+
+template <vkb::BindingType bindingType>
+inline Buffer<bindingType> &Buffer<bindingType>::operator=(Buffer &&other) noexcept
+{
+	ParentType::operator=(static_cast<ParentType &&>(other));
+	size                 = std::exchange(other.size, {});
+	create_flags         = std::exchange(other.create_flags, {});
+	usage                = std::exchange(other.usage, {});
+	queue_family_indices = std::move(other.queue_family_indices);
+	movable              = std::exchange(other.movable, false);
+	moved_handle         = std::exchange(other.moved_handle, {});
+	state_tracker        = std::exchange(other.state_tracker, {});
+	update_user_data();
+	return *this;
+}
+
 template <vkb::BindingType bindingType>
 inline Buffer<bindingType>::Buffer(DeviceType &device, const BufferBuilder<bindingType> &builder) :
     ParentType(builder.get_allocation_create_info(), nullptr, &device), size(builder.get_create_info().size)
 {
-	this->set_handle(this->create_buffer(builder.get_create_info()));
+	auto create_info = builder.get_create_info();
+
+	// Descriptor buffers reference uniform and storage buffers by their device address
+	if (device.uses_descriptor_buffers())
+	{
+		if constexpr (bindingType == vkb::BindingType::Cpp)
+		{
+			if (create_info.usage & (vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer))
+			{
+				create_info.usage |= vk::BufferUsageFlagBits::eShaderDeviceAddress;
+			}
+		}
+		else
+		{
+			if (create_info.usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+			{
+				create_info.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+			}
+		}
+	}
+
+	auto &cpp_create_info = reinterpret_cast<vk::BufferCreateInfo const &>(create_info);
+	create_flags          = cpp_create_info.flags;
+	usage                 = cpp_create_info.usage;
+	if (cpp_create_info.sharingMode == vk::SharingMode::eConcurrent)
+	{
+		queue_family_indices.assign(cpp_create_info.pQueueFamilyIndices, cpp_create_info.pQueueFamilyIndices + cpp_create_info.queueFamilyIndexCount);
+	}
+
+	this->set_handle(this->create_buffer(create_info));
 	if (!builder.get_debug_name().empty())
 	{
 		this->set_debug_name(builder.get_debug_name());
@@ -271,5 +391,82 @@ inline typename Buffer<bindingType>::DeviceSizeType Buffer<bindingType>::get_siz
 	}
 }
 
+template <vkb::BindingType bindingType>
+inline vkb::core::BufferStateTracker &Buffer<bindingType>::get_state_tracker() const
+{
+	return state_tracker;
+}
+
+template <vkb::BindingType bindingType>
+inline void Buffer<bindingType>::set_movable(bool movable_)
+{
+	movable = movable_;
+	update_user_data();
+}
+
+template <vkb::BindingType bindingType>
+inline void Buffer<bindingType>::update_user_data()
+{
+	if (this->get_allocation() != VK_NULL_HANDLE)
+	{
+		vmaSetAllocationUserData(vkb::allocated::get_memory_allocator(), this->get_allocation(), movable ? static_cast<vkb::allocated::Movable *>(this) : nullptr);
+	}
+}
+
+template <vkb::BindingType bindingType>
+inline bool Buffer<bindingType>::begin_move(VkCommandBuffer command_buffer, VmaAllocation allocation)
+{
+	VkMemoryPropertyFlags memory_properties{};
+	vmaGetAllocationMemoryProperties(vkb::allocated::get_memory_allocator(), this->get_allocation(), &memory_properties);
+
+	// The contents are copied to the new buffer
+	auto const transfer_usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst;
+
+	// The device addresses and the host pointers to the buffer would change
+	if (!movable || ((usage & transfer_usage) != transfer_usage) || (usage & vk::BufferUsageFlagBits::eShaderDeviceAddress) ||
+	    (memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+	{
+		return false;
+	}
+
+	vk::BufferCreateInfo create_info{create_flags,
+	                                 size,
+	                                 usage,
+	                                 queue_family_indices.empty() ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent,
+	                                 queue_family_indices};
+
+	auto device  = static_cast<vk::Device>(this->get_device().get_handle());
+	moved_handle = device.createBuffer(create_info);
+
+	VkResult result = vmaBindBufferMemory(vkb::allocated::get_memory_allocator(), allocation, static_cast<VkBuffer>(moved_handle));
+	if (result != VK_SUCCESS)
+	{
+		device.destroyBuffer(moved_handle);
+		moved_handle = nullptr;
+		return false;
+	}
+
+	vk::CommandBuffer(command_buffer).copyBuffer(static_cast<vk::Buffer>(this->get_handle()), moved_handle, vk::BufferCopy{0, 0, size});
+	return true;
+}
+
+template <vkb::BindingType bindingType>
+inline std::pair<VkBuffer, VkBuffer> Buffer<bindingType>::end_move()
+{
+	auto previous_handle = static_cast<vk::Buffer>(this->get_handle());
+	auto new_handle      = std::exchange(moved_handle, {});
+
+	this->set_handle(static_cast<BufferType>(new_handle));
+	if (!this->get_debug_name().empty())
+	{
+		std::string debug_name = this->get_debug_name();
+		this->set_debug_name(debug_name);
+	}
+
+	static_cast<vk::Device>(this->get_device().get_handle()).destroyBuffer(previous_handle);
+
+	return {static_cast<VkBuffer>(previous_handle), static_cast<VkBuffer>(new_handle)};
+}
+
 }        // namespace core
 }        // namespace vkb
@@ -19,6 +19,7 @@
 
 #include "command_pool.h"
 #include "common/error.h"
+#include "core/util/profiling.hpp"
 #include "device.h"
 #include "rendering/RenderFrame.h"
 #include "rendering/subpass.h"
@@ -27,12 +28,200 @@
 
 namespace vkb
 {
+namespace
+{
+/**
+ * @brief Renders the outputs of a subpass into the multisampled attachments of the render target, resolved into them
+ *        Subpasses setting their own resolve attachments, or writing an attachment without a multisampled one, are left as is.
+ */
+void use_multisampled_attachments(const RenderTarget &render_target, SubpassInfo &subpass_info)
+{
+	bool multisampled = !subpass_info.output_attachments.empty() && subpass_info.color_resolve_attachments.empty() &&
+	                    std::all_of(subpass_info.output_attachments.begin(), subpass_info.output_attachments.end(), [&render_target](uint32_t attachment) {
+		                    return render_target.get_multisampled_attachment(attachment) != VK_ATTACHMENT_UNUSED;
+	                    });
+	if (multisampled)
+	{
+		subpass_info.color_resolve_attachments = subpass_info.output_attachments;
+		for (auto &attachment : subpass_info.output_attachments)
+		{
+			attachment = render_target.get_multisampled_attachment(attachment);
+		}
+	}
+
+	if (subpass_info.depth_stencil_resolve_mode == VK_RESOLVE_MODE_NONE && !subpass_info.disable_depth_stencil_attachment &&
+	    render_target.get_depth_stencil_resolve_attachment() != VK_ATTACHMENT_UNUSED)
+	{
+		subpass_info.depth_stencil_resolve_mode       = render_target.get_depth_stencil_resolve_mode();
+		subpass_info.depth_stencil_resolve_attachment = render_target.get_depth_stencil_resolve_attachment();
+	}
+}
+
+std::vector<SubpassInfo> get_subpass_infos(const RenderTarget &render_target, const std::vector<std::unique_ptr<vkb::rendering::SubpassC>> &subpasses)
+{
+	std::vector<SubpassInfo> subpass_infos(subpasses.size());
+	auto                     subpass_info_it = subpass_infos.begin();
+	for (auto &subpass : subpasses)
+	{
+		subpass_info_it->input_attachments                = subpass->get_input_attachments();
+		subpass_info_it->output_attachments               = subpass->get_output_attachments();
+		subpass_info_it->color_resolve_attachments        = subpass->get_color_resolve_attachments();
+		subpass_info_it->disable_depth_stencil_attachment = subpass->get_disable_depth_stencil_attachment();
+		subpass_info_it->depth_stencil_resolve_mode       = subpass->get_depth_stencil_resolve_mode();
+		subpass_info_it->depth_stencil_resolve_attachment = subpass->get_depth_stencil_resolve_attachment();
+		subpass_info_it->debug_name                       = subpass->get_debug_name();
+
+		if (subpass->get_use_shading_rate_attachment() && render_target.get_shading_rate_view())
+		{
+			subpass_info_it->shading_rate_attachment = render_target.get_shading_rate_attachment();
+			subpass_info_it->shading_rate_texel_size = render_target.get_shading_rate_texel_size();
+		}
+
+		use_multisampled_attachments(render_target, *subpass_info_it);
+
+		++subpass_info_it;
+	}
+	return subpass_infos;
+}
+
+uint32_t find_attachment(const std::vector<uint32_t> &attachments, uint32_t attachment)
+{
+	auto it = std::find(attachments.begin(), attachments.end(), attachment);
+	return it == attachments.end() ? VK_ATTACHMENT_UNUSED : to_u32(std::distance(attachments.begin(), it));
+}
+
+/**
+ * @brief Attachments of a dynamic rendering instance, the color ones in the order of the render target
+ */
+struct RenderingAttachments
+{
+	std::vector<uint32_t> color;
+
+	uint32_t depth_stencil{VK_ATTACHMENT_UNUSED};
+};
+
+/**
+ * @brief Gets the attachments of the instance of a subpass, or of the instance shared by all of them with local read
+ */
+RenderingAttachments get_rendering_attachments(const std::vector<Attachment> &attachments, const std::vector<SubpassInfo> &subpasses, const SubpassInfo *subpass)
+{
+	auto depth_it         = std::find_if(attachments.begin(), attachments.end(), [](const Attachment &attachment) { return is_depth_format(attachment.format); });
+	auto depth_attachment = depth_it == attachments.end() ? VK_ATTACHMENT_UNUSED : to_u32(std::distance(attachments.begin(), depth_it));
+
+	RenderingAttachments rendering_attachments;
+
+	for (uint32_t i = 0; i < to_u32(attachments.size()); ++i)
+	{
+		bool used = false;
+		for (auto &subpass_info : subpasses)
+		{
+			if (subpass && subpass != &subpass_info)
+			{
+				continue;
+			}
+
+			// Local read needs the attachments read as input to be attachments of the instance
+			bool output = find_attachment(subpass_info.output_attachments, i) != VK_ATTACHMENT_UNUSED;
+			bool input  = find_attachment(subpass_info.input_attachments, i) != VK_ATTACHMENT_UNUSED;
+			if (i == depth_attachment)
+			{
+				used |= !subpass_info.disable_depth_stencil_attachment || input;
+			}
+			else
+			{
+				used |= output || input;
+			}
+		}
+
+		if (!used)
+		{
+			continue;
+		}
+
+		if (i == depth_attachment)
+		{
+			rendering_attachments.depth_stencil = i;
+		}
+		else if (!is_depth_format(attachments[i].format))
+		{
+			rendering_attachments.color.push_back(i);
+		}
+	}
+
+	return rendering_attachments;
+}
+
+/**
+ * @brief Gets the subresources of a view a barrier applies to, with both aspects of depth stencil formats
+ */
+VkImageSubresourceRange get_barrier_range(const core::ImageView &image_view)
+{
+	auto subresource_range = image_view.get_subresource_range();
+	auto format            = image_view.get_format();
+	if (is_depth_only_format(format))
+	{
+		subresource_range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+	}
+	else if (is_depth_stencil_format(format))
+	{
+		subresource_range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+	return subresource_range;
+}
+
+/**
+ * @brief Gets the state the accesses of a render pass leave one of its attachments in
+ *        The attachments read as input attachments are read by the fragment shaders, the next write waits for them too.
+ */
+core::ResourceState get_attachment_state(const Attachment &attachment, VkImageLayout layout)
+{
+	if (attachment.usage & VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR)
+	{
+		return {layout, VK_PIPELINE_STAGE_2_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR, VK_ACCESS_2_NONE_KHR};
+	}
+	else if (is_depth_format(attachment.format))
+	{
+		// Depth resolves write in the color attachment output stage
+		return {layout,
+		        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR |
+		            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+		        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR};
+	}
+	return {layout,
+	        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+	        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR};
+}
+
+/**
+ * @brief Sets the tracked states of the attachments of a render target after a render pass
+ * @param final_layouts Layouts the render pass left the attachments in, empty if they kept their layout
+ */
+void set_attachment_states(const RenderTarget &render_target, const std::vector<VkImageLayout> &final_layouts)
+{
+	auto &attachments = render_target.get_attachments();
+	auto &views       = render_target.get_views();
+
+	for (size_t i = 0; i < views.size(); ++i)
+	{
+		auto  range         = get_barrier_range(views[i]);
+		auto &state_tracker = views[i].get_image().get_state_tracker();
+
+		VkImageLayout layout = i < final_layouts.size() ? final_layouts[i] : state_tracker.get_state(range.baseMipLevel, range.baseArrayLayer).layout;
+		state_tracker.set_state(range, get_attachment_state(attachments[i], layout));
+	}
+}
+}        // namespace
+
 CommandBuffer::CommandBuffer(CommandPool &command_pool, VkCommandBufferLevel level) :
     VulkanResource{VK_NULL_HANDLE, &command_pool.get_device()},
     command_pool{command_pool},
     max_push_constants_size{get_device().get_gpu().get_properties().limits.maxPushConstantsSize},
     level{level}
 {
+	auto synchronization2_features = get_device().get_gpu().get_requested_extension_features<VkPhysicalDeviceSynchronization2FeaturesKHR>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR);
+	synchronization2 = get_device().is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) && synchronization2_features && synchronization2_features->synchronization2;
+
 	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
 
 	allocate_info.commandPool        = command_pool.get_handle();
@@ -65,7 +254,13 @@ CommandBuffer::CommandBuffer(CommandBuffer &&other) :
     last_framebuffer_extent(std::exchange(other.last_framebuffer_extent, {})),
     last_render_area_extent(std::exchange(other.last_render_area_extent, {})),
     update_after_bind(std::exchange(other.update_after_bind, {})),
-    descriptor_set_layout_binding_state(std::exchange(other.descriptor_set_layout_binding_state, {}))
+    descriptor_set_layout_binding_state(std::exchange(other.descriptor_set_layout_binding_state, {})),
+    bound_descriptor_buffer(std::exchange(other.bound_descriptor_buffer, {})),
+    current_rendering(std::exchange(other.current_rendering, {})),
+    redundant_command_filter(std::exchange(other.redundant_command_filter, {})),
+    synchronization2(other.synchronization2),
+    pending_image_barriers(std::exchange(other.pending_image_barriers, {})),
+    pending_buffer_barriers(std::exchange(other.pending_buffer_barriers, {}))
 {}
 
 void CommandBuffer::clear(VkClearAttachment attachment, VkClearRect rect)
@@ -91,8 +286,11 @@ VkResult CommandBuffer::begin(VkCommandBufferUsageFlags flags, const RenderPass
 	// Reset state
 	pipeline_state.reset();
 	resource_binding_state.reset();
-	descriptor_set_layout_binding_state.clear();
+	descriptor_set_layout_binding_state.fill(nullptr);
 	stored_push_constants.clear();
+	bound_descriptor_buffer = VK_NULL_HANDLE;
+	redundant_command_filter.reset();
+	redundant_command_filter.reset_skipped_command_count();
 
 	VkCommandBufferBeginInfo       begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
 	VkCommandBufferInheritanceInfo inheritance = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
@@ -110,6 +308,13 @@ VkResult CommandBuffer::begin(VkCommandBufferUsageFlags flags, const RenderPass
 		inheritance.subpass     = subpass_index;
 
 		begin_info.pInheritanceInfo = &inheritance;
+
+		// Pipelines recorded here must match the subpass being continued
+		pipeline_state.set_subpass_index(subpass_index);
+
+		auto blend_state = pipeline_state.get_color_blend_state();
+		blend_state.attachments.resize(current_render_pass.render_pass->get_color_output_count(subpass_index));
+		pipeline_state.set_color_blend_state(blend_state);
 	}
 
 	return vkBeginCommandBuffer(get_handle(), &begin_info);
@@ -117,6 +322,8 @@ VkResult CommandBuffer::begin(VkCommandBufferUsageFlags flags, const RenderPass
 
 VkResult CommandBuffer::end()
 {
+	flush_barriers();
+
 	vkEndCommandBuffer(get_handle());
 
 	return VK_SUCCESS;
@@ -124,6 +331,8 @@ VkResult CommandBuffer::end()
 
 void CommandBuffer::flush(VkPipelineBindPoint pipeline_bind_point)
 {
+	PROFILE_FUNCTION();
+
 	flush_pipeline_state(pipeline_bind_point);
 
 	flush_push_constants();
@@ -140,7 +349,39 @@ void CommandBuffer::begin_render_pass(const RenderTarget
 	// Reset state
 	pipeline_state.reset();
 	resource_binding_state.reset();
-	descriptor_set_layout_binding_state.clear();
+	descriptor_set_layout_binding_state.fill(nullptr);
+
+	// Barriers can't be recorded in the render pass
+	flush_barriers();
+
+	if (get_device().uses_dynamic_rendering())
+	{
+		auto subpass_infos = get_subpass_infos(render_target, subpasses);
+
+		// Static subpasses replay secondary command buffers, which inherit a render pass
+		bool inline_contents = std::all_of(subpasses.begin(), subpasses.end(), [](const std::unique_ptr<vkb::rendering::SubpassC> &subpass) {
+			return subpass->get_subpass_contents() == VK_SUBPASS_CONTENTS_INLINE && !subpass->is_static();
+		});
+
+		if (inline_contents && can_render_dynamically(subpass_infos, contents))
+		{
+			// Subpasses without input attachments keep an instance each, so the storage they write is ordered between them
+			bool reads_input_attachments = std::any_of(subpass_infos.begin(), subpass_infos.end(), [](const SubpassInfo &subpass_info) {
+				return !subpass_info.input_attachments.empty();
+			});
+
+			current_render_pass = {};
+
+			current_rendering.render_target    = &render_target;
+			current_rendering.load_store_infos = load_store_infos;
+			current_rendering.clear_values     = clear_values;
+			current_rendering.subpasses        = std::move(subpass_infos);
+			current_rendering.local_read       = get_device().uses_dynamic_rendering_local_read() && reads_input_attachments;
+
+			begin_rendering();
+			return;
+		}
+	}
 
 	auto &render_pass = get_render_pass(render_target, load_store_infos, subpasses);
 	auto &framebuffer = get_device().get_resource_cache().RequestFramebuffer(render_target, render_pass);
@@ -150,8 +391,13 @@ void CommandBuffer::begin_render_pass(const RenderTarget
 
 void CommandBuffer::begin_render_pass(const RenderTarget &render_target, const RenderPass &render_pass, const Framebuffer &framebuffer, const std::vector<VkClearValue> &clear_values, VkSubpassContents contents)
 {
-	current_render_pass.render_pass = &render_pass;
-	current_render_pass.framebuffer = &framebuffer;
+	flush_barriers();
+
+	current_render_pass.render_pass   = &render_pass;
+	current_render_pass.framebuffer   = &framebuffer;
+	current_render_pass.render_target = &render_target;
+
+	current_rendering = {};
 
 	// Begin render pass
 	VkRenderPassBeginInfo begin_info{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
@@ -185,29 +431,63 @@ void CommandBuffer::begin_render_pass(const RenderTarget &render_target, const R
 	pipeline_state.set_color_blend_state(blend_state);
 }
 
-void CommandBuffer::next_subpass()
+void CommandBuffer::next_subpass(VkSubpassContents contents)
 {
 	// Increment subpass index
 	pipeline_state.set_subpass_index(pipeline_state.get_subpass_index() + 1);
 
-	// Update blend state attachments
-	auto blend_state = pipeline_state.get_color_blend_state();
-	blend_state.attachments.resize(current_render_pass.render_pass->get_color_output_count(pipeline_state.get_subpass_index()));
-	pipeline_state.set_color_blend_state(blend_state);
-
 	// Reset descriptor sets
 	resource_binding_state.reset();
-	descriptor_set_layout_binding_state.clear();
+	descriptor_set_layout_binding_state.fill(nullptr);
 
 	// Clear stored push constants
 	stored_push_constants.clear();
 
-	vkCmdNextSubpass(get_handle(), VK_SUBPASS_CONTENTS_INLINE);
+	if (current_rendering.render_target)
+	{
+		// Same dependency as the render passes between their subpasses, see get_subpass_dependencies
+		VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+		barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		                        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+		VkPipelineStageFlags src_stage_mask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+		// Barriers within a rendering instance only order the attachments, the storage writes are ordered between instances
+		if (!current_rendering.local_read)
+		{
+			vkCmdEndRenderingKHR(get_handle());
+
+			src_stage_mask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			barrier.srcAccessMask |= VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		}
+
+		vkCmdPipelineBarrier(get_handle(),
+		                     src_stage_mask,
+		                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+		                         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		                     VK_DEPENDENCY_BY_REGION_BIT, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		begin_rendering_subpass();
+		return;
+	}
+
+	// Update blend state attachments
+	auto blend_state = pipeline_state.get_color_blend_state();
+	blend_state.attachments.resize(current_render_pass.render_pass->get_color_output_count(pipeline_state.get_subpass_index()));
+	pipeline_state.set_color_blend_state(blend_state);
+
+	vkCmdNextSubpass(get_handle(), contents);
 }
 
 void CommandBuffer::execute_commands(CommandBuffer &secondary_command_buffer)
 {
 	vkCmdExecuteCommands(get_handle(), 1, &secondary_command_buffer.get_handle());
+
+	// The state is undefined after secondary command buffers
+	redundant_command_filter.reset();
+	redundant_command_filter.add_skipped_commands(secondary_command_buffer.get_redundant_command_count());
 }
 
 void CommandBuffer::execute_commands(std::vector<CommandBuffer *> &secondary_command_buffers)
@@ -216,11 +496,319 @@ void CommandBuffer::execute_commands(std::vector<CommandBuffer *> &secondary_com
 	std::transform(secondary_command_buffers.begin(), secondary_command_buffers.end(), sec_cmd_buf_handles.begin(),
 	               [](const vkb::CommandBuffer *sec_cmd_buf) { return sec_cmd_buf->get_handle(); });
 	vkCmdExecuteCommands(get_handle(), to_u32(sec_cmd_buf_handles.size()), sec_cmd_buf_handles.data());
+
+	// The state is undefined after secondary command buffers
+	redundant_command_filter.reset();
+	for (auto *secondary_command_buffer : secondary_command_buffers)
+	{
+		redundant_command_filter.add_skipped_commands(secondary_command_buffer->get_redundant_command_count());
+	}
 }
 
 void CommandBuffer::end_render_pass()
 {
+	if (current_rendering.render_target)
+	{
+		vkCmdEndRenderingKHR(get_handle());
+
+		// The rendering instances leave the attachments in their layout
+		set_attachment_states(*current_rendering.render_target, {});
+
+		current_rendering = {};
+		return;
+	}
+
 	vkCmdEndRenderPass(get_handle());
+
+	if (current_render_pass.render_target)
+	{
+		set_attachment_states(*current_render_pass.render_target, current_render_pass.render_pass->get_final_layouts());
+	}
+}
+
+bool CommandBuffer::can_render_dynamically(const std::vector<SubpassInfo> &subpass_infos, VkSubpassContents contents) const
+{
+	// The subpasses would need a rendering instance of their own each, only the render pass can continue in secondary command buffers
+	if (contents != VK_SUBPASS_CONTENTS_INLINE)
+	{
+		return false;
+	}
+
+	for (auto &subpass_info : subpass_infos)
+	{
+		// Resolves happen at the end of a rendering instance, and not at the end of a subpass
+		if (!subpass_info.color_resolve_attachments.empty() || subpass_info.depth_stencil_resolve_mode != VK_RESOLVE_MODE_NONE)
+		{
+			return false;
+		}
+
+		if (!subpass_info.input_attachments.empty() && !get_device().uses_dynamic_rendering_local_read())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CommandBuffer::begin_rendering()
+{
+	auto &render_target = *current_rendering.render_target;
+	auto &attachments   = render_target.get_attachments();
+	auto &views         = render_target.get_views();
+
+	// The render passes transition the attachments from their initial layout, the instances need them in their layout already
+	auto rendering_attachments = get_rendering_attachments(attachments, current_rendering.subpasses, nullptr);
+
+	std::vector<uint32_t> used_attachments = rendering_attachments.color;
+	if (rendering_attachments.depth_stencil != VK_ATTACHMENT_UNUSED)
+	{
+		used_attachments.push_back(rendering_attachments.depth_stencil);
+	}
+
+	for (auto attachment : used_attachments)
+	{
+		bool depth = attachment == rendering_attachments.depth_stencil;
+		bool input = false;
+		for (auto &subpass_info : current_rendering.subpasses)
+		{
+			input |= find_attachment(subpass_info.input_attachments, attachment) != VK_ATTACHMENT_UNUSED;
+		}
+
+		VkImageLayout layout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		if (input)
+		{
+			layout = VK_IMAGE_LAYOUT_RENDERING_LOCAL_READ_KHR;
+		}
+
+		if (render_target.get_layout(attachment) == layout)
+		{
+			continue;
+		}
+
+		// The attachments without load store info are loaded, as by the render passes
+		bool load = attachment >= current_rendering.load_store_infos.size() || current_rendering.load_store_infos[attachment].load_op == VK_ATTACHMENT_LOAD_OP_LOAD;
+
+		ImageMemoryBarrier barrier;
+		barrier.old_layout = load ? render_target.get_layout(attachment) : VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.new_layout = layout;
+
+		if (depth)
+		{
+			barrier.src_stage_mask  = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			barrier.dst_stage_mask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			barrier.src_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			barrier.dst_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		}
+		else
+		{
+			barrier.src_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			barrier.src_access_mask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			barrier.dst_access_mask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		}
+
+		if (input)
+		{
+			barrier.dst_stage_mask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			barrier.dst_access_mask |= VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+		}
+
+		image_memory_barrier(views[attachment], barrier);
+	}
+
+	begin_rendering_subpass();
+}
+
+void CommandBuffer::begin_rendering_subpass()
+{
+	auto &render_target = *current_rendering.render_target;
+	auto &attachments   = render_target.get_attachments();
+	auto &views         = render_target.get_views();
+	auto &subpasses     = current_rendering.subpasses;
+
+	auto  subpass_index = pipeline_state.get_subpass_index();
+	auto &subpass_info  = subpasses[subpass_index];
+
+	// With local read the instance is begun for the first subpass only, and holds the attachments of all of them
+	bool begin = !current_rendering.local_read || subpass_index == 0;
+
+	auto rendering_attachments = get_rendering_attachments(attachments, subpasses, current_rendering.local_read ? nullptr : &subpass_info);
+
+	// Fragment output locations of the subpass, the color outputs in their order as in its render pass
+	std::vector<uint32_t> color_outputs;
+	for (auto output : subpass_info.output_attachments)
+	{
+		if (!is_depth_format(attachments[output].format))
+		{
+			color_outputs.push_back(output);
+		}
+	}
+
+	RenderingState rendering_state;
+	rendering_state.local_read = current_rendering.local_read;
+
+	// With local read, the instance has the shading rate attachment if any of its subpasses uses it
+	auto uses_shading_rate = [](const SubpassInfo &info) { return info.shading_rate_attachment != VK_ATTACHMENT_UNUSED; };
+	rendering_state.shading_rate_attachment =
+	    current_rendering.local_read ? std::any_of(subpasses.begin(), subpasses.end(), uses_shading_rate) : uses_shading_rate(subpass_info);
+
+	for (auto attachment : rendering_attachments.color)
+	{
+		rendering_state.color_attachment_formats.push_back(attachments[attachment].format);
+
+		if (current_rendering.local_read)
+		{
+			rendering_state.color_attachment_locations.push_back(find_attachment(color_outputs, attachment));
+			rendering_state.color_attachment_input_indices.push_back(find_attachment(subpass_info.input_attachments, attachment));
+		}
+	}
+
+	if (rendering_attachments.depth_stencil != VK_ATTACHMENT_UNUSED)
+	{
+		auto format = attachments[rendering_attachments.depth_stencil].format;
+
+		rendering_state.depth_attachment_format = format;
+		if (is_depth_stencil_format(format))
+		{
+			rendering_state.stencil_attachment_format = format;
+		}
+
+		if (current_rendering.local_read)
+		{
+			rendering_state.depth_input_attachment_index = find_attachment(subpass_info.input_attachments, rendering_attachments.depth_stencil);
+			rendering_state.depth_stencil_disabled       = subpass_info.disable_depth_stencil_attachment;
+		}
+	}
+
+	pipeline_state.set_rendering_state(rendering_state);
+
+	// Update blend state attachments, indexed by fragment output location
+	auto blend_state = pipeline_state.get_color_blend_state();
+	blend_state.attachments.resize(color_outputs.size());
+	pipeline_state.set_color_blend_state(blend_state);
+
+	if (begin)
+	{
+		auto get_attachment_info = [&](uint32_t attachment, VkImageLayout layout) {
+			VkRenderingAttachmentInfoKHR attachment_info{VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR};
+			attachment_info.imageView   = views[attachment].get_handle();
+			attachment_info.imageLayout = layout;
+
+			// The first subpass rendering to an attachment loads it, and the last one stores it
+			VkAttachmentLoadOp  load_op  = VK_ATTACHMENT_LOAD_OP_LOAD;
+			VkAttachmentStoreOp store_op = VK_ATTACHMENT_STORE_OP_STORE;
+			if (attachment < current_rendering.load_store_infos.size())
+			{
+				load_op  = current_rendering.load_store_infos[attachment].load_op;
+				store_op = current_rendering.load_store_infos[attachment].store_op;
+			}
+
+			if (!current_rendering.local_read)
+			{
+				for (uint32_t i = 0; i < to_u32(subpasses.size()); ++i)
+				{
+					auto other = get_rendering_attachments(attachments, subpasses, &subpasses[i]);
+					bool used  = other.depth_stencil == attachment || find_attachment(other.color, attachment) != VK_ATTACHMENT_UNUSED;
+					if (used && i < subpass_index)
+					{
+						load_op = VK_ATTACHMENT_LOAD_OP_LOAD;
+					}
+					if (used && i > subpass_index)
+					{
+						store_op = VK_ATTACHMENT_STORE_OP_STORE;
+					}
+				}
+			}
+
+			attachment_info.loadOp  = load_op;
+			attachment_info.storeOp = store_op;
+
+			if (attachment < current_rendering.clear_values.size())
+			{
+				attachment_info.clearValue = current_rendering.clear_values[attachment];
+			}
+
+			return attachment_info;
+		};
+
+		auto get_layout = [&](uint32_t attachment, VkImageLayout attachment_layout) {
+			if (current_rendering.local_read)
+			{
+				for (auto &other : subpasses)
+				{
+					if (find_attachment(other.input_attachments, attachment) != VK_ATTACHMENT_UNUSED)
+					{
+						return VK_IMAGE_LAYOUT_RENDERING_LOCAL_READ_KHR;
+					}
+				}
+			}
+			return attachment_layout;
+		};
+
+		std::vector<VkRenderingAttachmentInfoKHR> color_attachment_infos;
+		for (auto attachment : rendering_attachments.color)
+		{
+			color_attachment_infos.push_back(get_attachment_info(attachment, get_layout(attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)));
+		}
+
+		VkRenderingAttachmentInfoKHR depth_attachment_info{VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR};
+		if (rendering_attachments.depth_stencil != VK_ATTACHMENT_UNUSED)
+		{
+			depth_attachment_info = get_attachment_info(rendering_attachments.depth_stencil,
+			                                            get_layout(rendering_attachments.depth_stencil, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL));
+		}
+
+		VkRenderingInfoKHR rendering_info{VK_STRUCTURE_TYPE_RENDERING_INFO_KHR};
+		rendering_info.renderArea.extent    = render_target.get_extent();
+		rendering_info.layerCount           = 1;
+		rendering_info.colorAttachmentCount = to_u32(color_attachment_infos.size());
+		rendering_info.pColorAttachments    = color_attachment_infos.data();
+
+		if (rendering_state.depth_attachment_format != VK_FORMAT_UNDEFINED)
+		{
+			rendering_info.pDepthAttachment = &depth_attachment_info;
+		}
+		if (rendering_state.stencil_attachment_format != VK_FORMAT_UNDEFINED)
+		{
+			rendering_info.pStencilAttachment = &depth_attachment_info;
+		}
+
+		VkRenderingFragmentShadingRateAttachmentInfoKHR shading_rate_info{VK_STRUCTURE_TYPE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR};
+		if (rendering_state.shading_rate_attachment)
+		{
+			shading_rate_info.imageView                      = render_target.get_shading_rate_view()->get_handle();
+			shading_rate_info.imageLayout                    = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+			shading_rate_info.shadingRateAttachmentTexelSize = render_target.get_shading_rate_texel_size();
+
+			rendering_info.pNext = &shading_rate_info;
+		}
+
+		vkCmdBeginRenderingKHR(get_handle(), &rendering_info);
+	}
+
+	if (!current_rendering.local_read)
+	{
+		return;
+	}
+
+	// Map the attachments of the instance to the outputs and inputs of the subpass, matching its pipelines
+	VkRenderingAttachmentLocationInfoKHR location_info{VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_LOCATION_INFO_KHR};
+	location_info.colorAttachmentCount      = to_u32(rendering_state.color_attachment_locations.size());
+	location_info.pColorAttachmentLocations = rendering_state.color_attachment_locations.data();
+
+	vkCmdSetRenderingAttachmentLocationsKHR(get_handle(), &location_info);
+
+	VkRenderingInputAttachmentIndexInfoKHR input_index_info{VK_STRUCTURE_TYPE_RENDERING_INPUT_ATTACHMENT_INDEX_INFO_KHR};
+	input_index_info.colorAttachmentCount         = to_u32(rendering_state.color_attachment_input_indices.size());
+	input_index_info.pColorAttachmentInputIndices = rendering_state.color_attachment_input_indices.data();
+	input_index_info.pDepthInputAttachmentIndex   = &rendering_state.depth_input_attachment_index;
+	if (rendering_state.stencil_attachment_format != VK_FORMAT_UNDEFINED)
+	{
+		input_index_info.pStencilInputAttachmentIndex = &rendering_state.depth_input_attachment_index;
+	}
+
+	vkCmdSetRenderingInputAttachmentIndicesKHR(get_handle(), &input_index_info);
 }
 
 void CommandBuffer::bind_pipeline_layout(PipelineLayout &pipeline_layout)
@@ -233,6 +821,11 @@ void CommandBuffer::set_specialization_constant(uint32_t constant_id, const std:
 	pipeline_state.set_specialization_constant(constant_id, data);
 }
 
+void CommandBuffer::set_specialization_constant(uint32_t constant_id, const uint8_t *data, size_t size)
+{
+	pipeline_state.set_specialization_constant(constant_id, data, size);
+}
+
 void CommandBuffer::push_constants(const std::vector<uint8_t> &values)
 {
 	uint32_t push_constant_size = to_u32(stored_push_constants.size() + values.size());
@@ -268,16 +861,35 @@ void CommandBuffer::bind_input(const core::ImageView &image_view, uint32_t set,
 	resource_binding_state.bind_input(image_view, set, binding, array_element);
 }
 
+void CommandBuffer::bind_resources(const CommandBuffer &command_buffer)
+{
+	resource_binding_state = command_buffer.resource_binding_state;
+
+	// The sets were flushed to the other command buffer only
+	resource_binding_state.mark_dirty(resource_binding_state.get_bound_sets());
+}
+
 void CommandBuffer::bind_vertex_buffers(uint32_t first_binding, const std::vector<std::reference_wrapper<const vkb::core::BufferC>> &buffers, const std::vector<VkDeviceSize> &offsets)
 {
 	std::vector<VkBuffer> buffer_handles(buffers.size(), VK_NULL_HANDLE);
 	std::transform(buffers.begin(), buffers.end(), buffer_handles.begin(),
 	               [](const vkb::core::BufferC &buffer) { return buffer.get_handle(); });
+
+	if (!redundant_command_filter.update_vertex_buffers(first_binding, to_u32(buffer_handles.size()), buffer_handles.data(), offsets.data()))
+	{
+		return;
+	}
+
 	vkCmdBindVertexBuffers(get_handle(), first_binding, to_u32(buffer_handles.size()), buffer_handles.data(), offsets.data());
 }
 
 void CommandBuffer::bind_index_buffer(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkIndexType index_type)
 {
+	if (!redundant_command_filter.update_index_buffer(buffer.get_handle(), offset, index_type))
+	{
+		return;
+	}
+
 	vkCmdBindIndexBuffer(get_handle(), buffer.get_handle(), offset, index_type);
 }
 
@@ -290,6 +902,11 @@ void CommandBuffer::bind_lighting(vkb::rendering::LightingStateC &lighting_state
 	set_specialization_constant(2, to_u32(lighting_state.spot_lights.size()));
 }
 
+void CommandBuffer::bind_descriptor_set(uint32_t set, VkDescriptorSet descriptor_set, VkPipelineBindPoint pipeline_bind_point)
+{
+	vkCmdBindDescriptorSets(get_handle(), pipeline_bind_point, pipeline_state.get_pipeline_layout().get_handle(), set, 1, &descriptor_set, 0, nullptr);
+}
+
 void CommandBuffer::set_viewport_state(const ViewportState &state_info)
 {
 	pipeline_state.set_viewport_state(state_info);
@@ -325,13 +942,45 @@ void CommandBuffer::set_color_blend_state(const ColorBlendState &state_info)
 	pipeline_state.set_color_blend_state(state_info);
 }
 
-void CommandBuffer::set_viewport(uint32_t first_viewport, const std::vector<VkViewport> &viewports)
-{
+void CommandBuffer::set_fragment_shading_rate_state(const FragmentShadingRateState &state_info)
+{
+	pipeline_state.set_fragment_shading_rate_state(state_info);
+}
+
+void CommandBuffer::set_viewport(uint32_t first_viewport, const std::vector<VkViewport> &viewports)
+{
+	bool with_count = get_device().uses_shader_objects();
+	if (!redundant_command_filter.update_viewports(first_viewport, to_u32(viewports.size()), viewports.data(), with_count))
+	{
+		return;
+	}
+
+	// Without a pipeline, the viewport count is dynamic too
+	if (with_count)
+	{
+		assert(first_viewport == 0 && "Shader objects set all the viewports at once");
+		vkCmdSetViewportWithCountEXT(get_handle(), to_u32(viewports.size()), viewports.data());
+		return;
+	}
+
 	vkCmdSetViewport(get_handle(), first_viewport, to_u32(viewports.size()), viewports.data());
 }
 
 void CommandBuffer::set_scissor(uint32_t first_scissor, const std::vector<VkRect2D> &scissors)
 {
+	bool with_count = get_device().uses_shader_objects();
+	if (!redundant_command_filter.update_scissors(first_scissor, to_u32(scissors.size()), scissors.data(), with_count))
+	{
+		return;
+	}
+
+	if (with_count)
+	{
+		assert(first_scissor == 0 && "Shader objects set all the scissors at once");
+		vkCmdSetScissorWithCountEXT(get_handle(), to_u32(scissors.size()), scissors.data());
+		return;
+	}
+
 	vkCmdSetScissor(get_handle(), first_scissor, to_u32(scissors.size()), scissors.data());
 }
 
@@ -376,8 +1025,24 @@ void CommandBuffer::draw_indexed_indirect(const vkb::core::BufferC &buffer, VkDe
 	vkCmdDrawIndexedIndirect(get_handle(), buffer.get_handle(), offset, draw_count, stride);
 }
 
+void CommandBuffer::draw_indexed_indirect_count(const vkb::core::BufferC &buffer, VkDeviceSize offset, const vkb::core::BufferC &count_buffer, VkDeviceSize count_offset, uint32_t max_draw_count, uint32_t stride)
+{
+	flush(VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+	vkCmdDrawIndexedIndirectCountKHR(get_handle(), buffer.get_handle(), offset, count_buffer.get_handle(), count_offset, max_draw_count, stride);
+}
+
+void CommandBuffer::draw_mesh_tasks(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+{
+	flush(VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+	vkCmdDrawMeshTasksEXT(get_handle(), group_count_x, group_count_y, group_count_z);
+}
+
 void CommandBuffer::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
 {
+	flush_barriers();
+
 	flush(VK_PIPELINE_BIND_POINT_COMPUTE);
 
 	vkCmdDispatch(get_handle(), group_count_x, group_count_y, group_count_z);
@@ -385,6 +1050,8 @@ void CommandBuffer::dispatch(uint32_t group_count_x, uint32_t group_count_y, uin
 
 void CommandBuffer::dispatch_indirect(const vkb::core::BufferC &buffer, VkDeviceSize offset)
 {
+	flush_barriers();
+
 	flush(VK_PIPELINE_BIND_POINT_COMPUTE);
 
 	vkCmdDispatchIndirect(get_handle(), buffer.get_handle(), offset);
@@ -392,11 +1059,15 @@ void CommandBuffer::dispatch_indirect(const vkb::core::BufferC &buffer, VkDevice
 
 void CommandBuffer::update_buffer(const vkb::core::BufferC &buffer, VkDeviceSize offset, const std::vector<uint8_t> &data)
 {
+	flush_barriers();
+
 	vkCmdUpdateBuffer(get_handle(), buffer.get_handle(), offset, data.size(), data.data());
 }
 
 void CommandBuffer::blit_image(const core::Image &src_img, const core::Image &dst_img, const std::vector<VkImageBlit> &regions)
 {
+	flush_barriers();
+
 	vkCmdBlitImage(get_handle(), src_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 	               dst_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	               to_u32(regions.size()), regions.data(), VK_FILTER_NEAREST);
@@ -404,6 +1075,8 @@ void CommandBuffer::blit_image(const core::Image &src_img, const core::Image &ds
 
 void CommandBuffer::resolve_image(const core::Image &src_img, const core::Image &dst_img, const std::vector<VkImageResolve> &regions)
 {
+	flush_barriers();
+
 	vkCmdResolveImage(get_handle(), src_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 	                  dst_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	                  to_u32(regions.size()), regions.data());
@@ -411,6 +1084,8 @@ void CommandBuffer::resolve_image(const core::Image &src_img, const core::Image
 
 void CommandBuffer::copy_buffer(const vkb::core::BufferC &src_buffer, const vkb::core::BufferC &dst_buffer, VkDeviceSize size)
 {
+	flush_barriers();
+
 	VkBufferCopy copy_region = {};
 	copy_region.size         = size;
 	vkCmdCopyBuffer(get_handle(), src_buffer.get_handle(), dst_buffer.get_handle(), 1, &copy_region);
@@ -418,6 +1093,8 @@ void CommandBuffer::copy_buffer(const vkb::core::BufferC &src_buffer, const vkb:
 
 void CommandBuffer::copy_image(const core::Image &src_img, const core::Image &dst_img, const std::vector<VkImageCopy> &regions)
 {
+	flush_barriers();
+
 	vkCmdCopyImage(get_handle(), src_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 	               dst_img.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	               to_u32(regions.size()), regions.data());
@@ -425,6 +1102,8 @@ void CommandBuffer::copy_image(const core::Image &src_img, const core::Image &ds
 
 void CommandBuffer::copy_buffer_to_image(const vkb::core::BufferC &buffer, const core::Image &image, const std::vector<VkBufferImageCopy> &regions)
 {
+	flush_barriers();
+
 	vkCmdCopyBufferToImage(get_handle(), buffer.get_handle(),
 	                       image.get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 	                       to_u32(regions.size()), regions.data());
@@ -432,37 +1111,37 @@ void CommandBuffer::copy_buffer_to_image(const vkb::core::BufferC &buffer, const
 
 void CommandBuffer::copy_image_to_buffer(const core::Image &image, VkImageLayout image_layout, const vkb::core::BufferC &buffer, const std::vector<VkBufferImageCopy> &regions)
 {
+	flush_barriers();
+
 	vkCmdCopyImageToBuffer(get_handle(), image.get_handle(), image_layout,
 	                       buffer.get_handle(), to_u32(regions.size()), regions.data());
 }
 
-void CommandBuffer::image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier) const
+void CommandBuffer::image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier)
 {
-	// Adjust barrier's subresource range for depth images
-	auto subresource_range = image_view.get_subresource_range();
-	auto format            = image_view.get_format();
-	if (is_depth_only_format(format))
-	{
-		subresource_range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-	}
-	else if (is_depth_stencil_format(format))
-	{
-		subresource_range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
-	}
+	flush_barriers();
+
+	auto subresource_range = get_barrier_range(image_view);
 
-	vkb::image_layout_transition(get_handle(),
-	                             image_view.get_image().get_handle(),
-	                             memory_barrier.src_stage_mask,
-	                             memory_barrier.dst_stage_mask,
-	                             memory_barrier.src_access_mask,
-	                             memory_barrier.dst_access_mask,
-	                             memory_barrier.old_layout,
-	                             memory_barrier.new_layout,
-	                             subresource_range);
+	VkImageMemoryBarrier image_memory_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+	image_memory_barrier.srcAccessMask       = memory_barrier.src_access_mask;
+	image_memory_barrier.dstAccessMask       = memory_barrier.dst_access_mask;
+	image_memory_barrier.oldLayout           = memory_barrier.old_layout;
+	image_memory_barrier.newLayout           = memory_barrier.new_layout;
+	image_memory_barrier.srcQueueFamilyIndex = memory_barrier.old_queue_family;
+	image_memory_barrier.dstQueueFamilyIndex = memory_barrier.new_queue_family;
+	image_memory_barrier.image               = image_view.get_image().get_handle();
+	image_memory_barrier.subresourceRange    = subresource_range;
+
+	vkCmdPipelineBarrier(get_handle(), memory_barrier.src_stage_mask, memory_barrier.dst_stage_mask, 0, 0, nullptr, 0, nullptr, 1, &image_memory_barrier);
+
+	image_view.get_image().get_state_tracker().set_state(subresource_range, {memory_barrier.new_layout, memory_barrier.dst_stage_mask, memory_barrier.dst_access_mask});
 }
 
 void CommandBuffer::buffer_memory_barrier(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkDeviceSize size, const BufferMemoryBarrier &memory_barrier)
 {
+	flush_barriers();
+
 	VkBufferMemoryBarrier buffer_memory_barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
 	buffer_memory_barrier.srcAccessMask = memory_barrier.src_access_mask;
 	buffer_memory_barrier.dstAccessMask = memory_barrier.dst_access_mask;
@@ -481,10 +1160,37 @@ void CommandBuffer::buffer_memory_barrier(const vkb::core::BufferC &buffer, VkDe
 	    0, nullptr,
 	    1, &buffer_memory_barrier,
 	    0, nullptr);
+
+	buffer.get_state_tracker().set_state({VK_IMAGE_LAYOUT_UNDEFINED, memory_barrier.dst_stage_mask, memory_barrier.dst_access_mask});
+}
+
+void CommandBuffer::request_image_state(const core::Image &image, const VkImageSubresourceRange &range, const core::ResourceState &state, bool discard)
+{
+	image.get_state_tracker().request(image.get_handle(), range, state, discard, pending_image_barriers);
+}
+
+void CommandBuffer::request_image_state(const core::ImageView &image_view, const core::ResourceState &state, bool discard)
+{
+	request_image_state(image_view.get_image(), get_barrier_range(image_view), state, discard);
+}
+
+void CommandBuffer::request_buffer_state(const vkb::core::BufferC &buffer, const core::ResourceState &state)
+{
+	buffer.get_state_tracker().request(buffer.get_handle(), state, pending_buffer_barriers);
+}
+
+void CommandBuffer::flush_barriers()
+{
+	core::record_pipeline_barrier(get_handle(), synchronization2, pending_image_barriers, pending_buffer_barriers);
+
+	pending_image_barriers.clear();
+	pending_buffer_barriers.clear();
 }
 
 void CommandBuffer::flush_pipeline_state(VkPipelineBindPoint pipeline_bind_point)
 {
+	PROFILE_FUNCTION();
+
 	// Create a new pipeline only if the graphics state changed
 	if (!pipeline_state.is_dirty())
 	{
@@ -493,15 +1199,34 @@ void CommandBuffer::flush_pipeline_state(VkPipelineBindPoint pipeline_bind_point
 
 	pipeline_state.clear_dirty();
 
+	redundant_command_filter.bind_pipeline_layout(pipeline_state.get_pipeline_layout().get_handle());
+
+	if (get_device().uses_shader_objects())
+	{
+		flush_shader_object_state(pipeline_bind_point);
+		return;
+	}
+
 	// Create and bind pipeline
 	if (pipeline_bind_point == VK_PIPELINE_BIND_POINT_GRAPHICS)
 	{
-		pipeline_state.set_render_pass(*current_render_pass.render_pass);
+		// With dynamic rendering, the pipeline is created from the rendering state set by begin_rendering_subpass
+		if (current_render_pass.render_pass)
+		{
+			pipeline_state.set_render_pass(*current_render_pass.render_pass);
+		}
+
+		// The dynamic members aren't part of the pipeline, which is shared by the states only differing in them
+		auto dynamic_state = get_device().get_dynamic_pipeline_state();
+		pipeline_state.set_dynamic_state(dynamic_state);
+
 		auto &pipeline = get_device().get_resource_cache().RequestGraphicsPipeline(pipeline_state);
 
 		vkCmdBindPipeline(get_handle(),
 		                  pipeline_bind_point,
 		                  pipeline.get_handle());
+
+		set_dynamic_pipeline_state(dynamic_state);
 	}
 	else if (pipeline_bind_point == VK_PIPELINE_BIND_POINT_COMPUTE)
 	{
@@ -517,63 +1242,302 @@ void CommandBuffer::flush_pipeline_state(VkPipelineBindPoint pipeline_bind_point
 	}
 }
 
-void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_point)
+void CommandBuffer::flush_shader_object_state(VkPipelineBindPoint pipeline_bind_point)
 {
-	assert(command_pool.get_render_frame() && "The command pool must be associated to a render frame");
+	PROFILE_FUNCTION();
 
-	const auto &pipeline_layout = pipeline_state.get_pipeline_layout();
+	auto &resource_cache  = get_device().get_resource_cache();
+	auto &pipeline_layout = pipeline_state.get_pipeline_layout();
+
+	VkShaderStageFlags layout_stages = 0;
+	for (auto *shader_module : pipeline_layout.get_shader_modules())
+	{
+		layout_stages |= shader_module->get_stage();
+	}
+
+	std::vector<VkShaderStageFlagBits> stages;
+	std::vector<VkShaderEXT>           shaders;
+
+	for (auto *shader_module : pipeline_layout.get_shader_modules())
+	{
+		// The graphics stage bits are in pipeline order, the next stages are the higher bits of the layout
+		VkShaderStageFlags next_stages = 0;
+		if (pipeline_bind_point == VK_PIPELINE_BIND_POINT_GRAPHICS)
+		{
+			next_stages = layout_stages & VK_SHADER_STAGE_ALL_GRAPHICS & ~((shader_module->get_stage() << 1) - 1);
+		}
+
+		auto &shader_object = resource_cache.RequestShaderObject(*shader_module, next_stages, pipeline_layout, pipeline_state.get_specialization_constant_state());
 
-	std::unordered_set<uint32_t> update_descriptor_sets;
+		stages.push_back(shader_object.get_stage());
+		shaders.push_back(shader_object.get_handle());
+	}
 
-	// Iterate over the shader sets to check if they have already been bound
-	// If they have, add the set so that the command buffer later updates it
-	for (auto &set_it : pipeline_layout.get_shader_sets())
+	if (pipeline_bind_point == VK_PIPELINE_BIND_POINT_GRAPHICS)
 	{
-		uint32_t descriptor_set_id = set_it.first;
+		// Unbinds the stages of a previous layout, the optional stages can only be named if their feature is enabled
+		auto &features = get_device().get_gpu().get_requested_features();
 
-		auto descriptor_set_layout_it = descriptor_set_layout_binding_state.find(descriptor_set_id);
+		std::vector<VkShaderStageFlagBits> graphics_stages{VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT};
+		if (features.tessellationShader)
+		{
+			graphics_stages.push_back(VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
+			graphics_stages.push_back(VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT);
+		}
+		if (features.geometryShader)
+		{
+			graphics_stages.push_back(VK_SHADER_STAGE_GEOMETRY_BIT);
+		}
 
-		if (descriptor_set_layout_it != descriptor_set_layout_binding_state.end())
+		for (auto stage : graphics_stages)
 		{
-			if (descriptor_set_layout_it->second->GetHandle() != pipeline_layout.get_descriptor_set_layout(descriptor_set_id).GetHandle())
+			if (!(layout_stages & stage))
 			{
-				update_descriptor_sets.emplace(descriptor_set_id);
+				stages.push_back(stage);
+				shaders.push_back(VK_NULL_HANDLE);
 			}
 		}
 	}
 
-	// Validate that the bound descriptor set layouts exist in the pipeline layout
-	for (auto set_it = descriptor_set_layout_binding_state.begin(); set_it != descriptor_set_layout_binding_state.end();)
+	vkCmdBindShadersEXT(get_handle(), to_u32(stages.size()), stages.data(), shaders.data());
+
+	if (pipeline_bind_point != VK_PIPELINE_BIND_POINT_GRAPHICS)
+	{
+		return;
+	}
+
+	set_dynamic_pipeline_state(DynamicPipelineState::All);
+
+	// The fragment shading rate has no pipeline to be part of either
+	if (get_device().is_enabled(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME))
+	{
+		auto &fragment_shading_rate_state = pipeline_state.get_fragment_shading_rate_state();
+
+		vkCmdSetFragmentShadingRateKHR(get_handle(), &fragment_shading_rate_state.fragment_size, fragment_shading_rate_state.combiner_ops.data());
+	}
+}
+
+void CommandBuffer::set_dynamic_pipeline_state(uint32_t dynamic_state)
+{
+	// Vertex input and input assembly
+	if (dynamic_state & DynamicPipelineState::VertexInput)
 	{
-		if (!pipeline_layout.has_descriptor_set_layout(set_it->first))
+		auto &vertex_input_state = pipeline_state.get_vertex_input_state();
+
+		std::vector<VkVertexInputBindingDescription2EXT> bindings;
+		for (auto &binding : vertex_input_state.bindings)
 		{
-			set_it = descriptor_set_layout_binding_state.erase(set_it);
+			VkVertexInputBindingDescription2EXT binding_description{VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT};
+			binding_description.binding   = binding.binding;
+			binding_description.stride    = binding.stride;
+			binding_description.inputRate = binding.inputRate;
+			binding_description.divisor   = 1;
+			bindings.push_back(binding_description);
 		}
-		else
+
+		std::vector<VkVertexInputAttributeDescription2EXT> attributes;
+		for (auto &attribute : vertex_input_state.attributes)
 		{
-			++set_it;
+			VkVertexInputAttributeDescription2EXT attribute_description{VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT};
+			attribute_description.location = attribute.location;
+			attribute_description.binding  = attribute.binding;
+			attribute_description.format   = attribute.format;
+			attribute_description.offset   = attribute.offset;
+			attributes.push_back(attribute_description);
 		}
+
+		vkCmdSetVertexInputEXT(get_handle(), to_u32(bindings.size()), bindings.data(), to_u32(attributes.size()), attributes.data());
 	}
 
-	// Check if a descriptor set needs to be created
-	if (resource_binding_state.is_dirty() || !update_descriptor_sets.empty())
+	if (dynamic_state & DynamicPipelineState::PrimitiveTopology)
 	{
-		resource_binding_state.clear_dirty();
+		vkCmdSetPrimitiveTopologyEXT(get_handle(), pipeline_state.get_input_assembly_state().topology);
+	}
+	if (dynamic_state & DynamicPipelineState::PrimitiveRestart)
+	{
+		vkCmdSetPrimitiveRestartEnableEXT(get_handle(), pipeline_state.get_input_assembly_state().primitive_restart_enable);
+	}
+
+	// Rasterization
+	auto &rasterization_state = pipeline_state.get_rasterization_state();
+
+	if (dynamic_state & DynamicPipelineState::RasterizerDiscard)
+	{
+		vkCmdSetRasterizerDiscardEnableEXT(get_handle(), rasterization_state.rasterizer_discard_enable);
+	}
+	if (dynamic_state & DynamicPipelineState::PolygonMode)
+	{
+		vkCmdSetPolygonModeEXT(get_handle(), rasterization_state.polygon_mode);
+	}
+	if (dynamic_state & DynamicPipelineState::CullMode)
+	{
+		vkCmdSetCullModeEXT(get_handle(), rasterization_state.cull_mode);
+	}
+	if (dynamic_state & DynamicPipelineState::FrontFace)
+	{
+		vkCmdSetFrontFaceEXT(get_handle(), rasterization_state.front_face);
+	}
+	if (dynamic_state & DynamicPipelineState::DepthBiasEnable)
+	{
+		vkCmdSetDepthBiasEnableEXT(get_handle(), rasterization_state.depth_bias_enable);
+	}
+	if (dynamic_state & DynamicPipelineState::DepthClamp)
+	{
+		vkCmdSetDepthClampEnableEXT(get_handle(), rasterization_state.depth_clamp_enable);
+	}
+
+	// Multisampling, sample shading has no dynamic state and is left to the shaders
+	auto &multisample_state = pipeline_state.get_multisample_state();
+
+	if (dynamic_state & DynamicPipelineState::RasterizationSamples)
+	{
+		vkCmdSetRasterizationSamplesEXT(get_handle(), multisample_state.rasterization_samples);
+	}
+	if (dynamic_state & DynamicPipelineState::SampleMask)
+	{
+		// A null sample mask in a pipeline enables all the samples
+		VkSampleMask sample_mask = multisample_state.sample_mask ? multisample_state.sample_mask : ~0U;
+
+		vkCmdSetSampleMaskEXT(get_handle(), multisample_state.rasterization_samples, &sample_mask);
+	}
+	if (dynamic_state & DynamicPipelineState::AlphaToCoverage)
+	{
+		vkCmdSetAlphaToCoverageEnableEXT(get_handle(), multisample_state.alpha_to_coverage_enable);
+	}
+	if (dynamic_state & DynamicPipelineState::AlphaToOne)
+	{
+		vkCmdSetAlphaToOneEnableEXT(get_handle(), multisample_state.alpha_to_one_enable);
+	}
+
+	// Depth and stencil
+	if (dynamic_state & DynamicPipelineState::DepthStencil)
+	{
+		auto depth_stencil_state = pipeline_state.get_depth_stencil_state();
+
+		// A subpass sharing the depth attachment of the rendering instance without using it
+		if (!current_render_pass.render_pass && pipeline_state.get_rendering_state().depth_stencil_disabled)
+		{
+			depth_stencil_state.depth_test_enable        = VK_FALSE;
+			depth_stencil_state.depth_write_enable       = VK_FALSE;
+			depth_stencil_state.depth_bounds_test_enable = VK_FALSE;
+			depth_stencil_state.stencil_test_enable      = VK_FALSE;
+		}
+
+		vkCmdSetDepthTestEnableEXT(get_handle(), depth_stencil_state.depth_test_enable);
+		vkCmdSetDepthWriteEnableEXT(get_handle(), depth_stencil_state.depth_write_enable);
+		vkCmdSetDepthCompareOpEXT(get_handle(), depth_stencil_state.depth_compare_op);
+		vkCmdSetDepthBoundsTestEnableEXT(get_handle(), depth_stencil_state.depth_bounds_test_enable);
+		vkCmdSetStencilTestEnableEXT(get_handle(), depth_stencil_state.stencil_test_enable);
+		vkCmdSetStencilOpEXT(get_handle(), VK_STENCIL_FACE_FRONT_BIT, depth_stencil_state.front.fail_op, depth_stencil_state.front.pass_op,
+		                     depth_stencil_state.front.depth_fail_op, depth_stencil_state.front.compare_op);
+		vkCmdSetStencilOpEXT(get_handle(), VK_STENCIL_FACE_BACK_BIT, depth_stencil_state.back.fail_op, depth_stencil_state.back.pass_op,
+		                     depth_stencil_state.back.depth_fail_op, depth_stencil_state.back.compare_op);
+	}
+
+	// Color blending
+	auto &color_blend_state = pipeline_state.get_color_blend_state();
+
+	if (dynamic_state & DynamicPipelineState::LogicOpEnable)
+	{
+		vkCmdSetLogicOpEnableEXT(get_handle(), color_blend_state.logic_op_enable);
+	}
+	if (dynamic_state & DynamicPipelineState::LogicOp)
+	{
+		vkCmdSetLogicOpEXT(get_handle(), color_blend_state.logic_op);
+	}
+
+	// Without a render pass, the blend states are those of the attachments of the rendering instance
+	auto blend_attachments = current_render_pass.render_pass ? color_blend_state.attachments : pipeline_state.get_rendering_color_blend_attachments();
+
+	if (blend_attachments.empty())
+	{
+		return;
+	}
+
+	if (dynamic_state & DynamicPipelineState::ColorBlendEnable)
+	{
+		std::vector<VkBool32> blend_enables;
+		for (auto &attachment : blend_attachments)
+		{
+			blend_enables.push_back(attachment.blend_enable);
+		}
+
+		vkCmdSetColorBlendEnableEXT(get_handle(), 0, to_u32(blend_enables.size()), blend_enables.data());
+	}
+	if (dynamic_state & DynamicPipelineState::ColorBlendEquation)
+	{
+		std::vector<VkColorBlendEquationEXT> blend_equations;
+		for (auto &attachment : blend_attachments)
+		{
+			blend_equations.push_back({attachment.src_color_blend_factor, attachment.dst_color_blend_factor, attachment.color_blend_op,
+			                           attachment.src_alpha_blend_factor, attachment.dst_alpha_blend_factor, attachment.alpha_blend_op});
+		}
+
+		vkCmdSetColorBlendEquationEXT(get_handle(), 0, to_u32(blend_equations.size()), blend_equations.data());
+	}
+	if (dynamic_state & DynamicPipelineState::ColorWriteMask)
+	{
+		std::vector<VkColorComponentFlags> write_masks;
+		for (auto &attachment : blend_attachments)
+		{
+			write_masks.push_back(attachment.color_write_mask);
+		}
+
+		vkCmdSetColorWriteMaskEXT(get_handle(), 0, to_u32(write_masks.size()), write_masks.data());
+	}
+}
+
+void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_point)
+{
+	PROFILE_FUNCTION();
+
+	assert(command_pool.get_render_frame() && "The command pool must be associated to a render frame");
+
+	auto &frame_arena = command_pool.get_render_frame()->GetFrameArena(command_pool.get_thread_index());
+
+	const auto &pipeline_layout = pipeline_state.get_pipeline_layout();
+
+	// Mask of the bound sets whose layout differs from the one of the pipeline layout
+	uint32_t layout_changed_sets = 0;
+
+	for (uint32_t descriptor_set_id = 0; descriptor_set_id < descriptor_set_layout_binding_state.size(); ++descriptor_set_id)
+	{
+		auto *bound_layout = descriptor_set_layout_binding_state[descriptor_set_id];
+
+		if (bound_layout == nullptr)
+		{
+			continue;
+		}
 
-		// Iterate over all of the resource sets bound by the command buffer
-		for (auto &resource_set_it : resource_binding_state.get_resource_sets())
+		// Validate that the bound descriptor set layouts exist in the pipeline layout
+		if (!pipeline_layout.has_descriptor_set_layout(descriptor_set_id))
 		{
-			uint32_t descriptor_set_id = resource_set_it.first;
-			auto    &resource_set      = resource_set_it.second;
+			descriptor_set_layout_binding_state[descriptor_set_id] = nullptr;
+		}
+		else if (bound_layout->GetHandle() != pipeline_layout.get_descriptor_set_layout(descriptor_set_id).GetHandle())
+		{
+			layout_changed_sets |= 1u << descriptor_set_id;
+		}
+	}
 
-			// Don't update resource set if it's not in the update list OR its state hasn't changed
-			if (!resource_set.is_dirty() && (update_descriptor_sets.find(descriptor_set_id) == update_descriptor_sets.end()))
+	// Only the sets with new resources or a new layout need a descriptor set
+	uint32_t update_sets = (resource_binding_state.get_dirty_sets() | layout_changed_sets) & resource_binding_state.get_bound_sets();
+
+	// Sets whose descriptors were in a descriptor buffer which got replaced
+	uint32_t stale_sets = 0;
+
+	if (update_sets != 0)
+	{
+		resource_binding_state.clear_dirty();
+
+		for (uint32_t descriptor_set_id = 0; update_sets != 0; ++descriptor_set_id, update_sets >>= 1)
+		{
+			if (!(update_sets & 1u))
 			{
 				continue;
 			}
 
-			// Clear dirty flag for resource set
-			resource_binding_state.clear_dirty(descriptor_set_id);
+			auto &resource_set = resource_binding_state.get_resource_set(descriptor_set_id);
 
 			// Skip resource set if a descriptor set layout doesn't exist for it
 			if (!pipeline_layout.has_descriptor_set_layout(descriptor_set_id))
@@ -589,7 +1553,7 @@ void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_poi
 			BindingMap<VkDescriptorBufferInfo> buffer_infos;
 			BindingMap<VkDescriptorImageInfo>  image_infos;
 
-			std::vector<uint32_t> dynamic_offsets;
+			std::pmr::vector<uint32_t> dynamic_offsets{&frame_arena};
 
 			// Iterate over all resource bindings
 			for (auto &binding_it : resource_set.get_resource_bindings())
@@ -675,6 +1639,37 @@ void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_poi
 				}
 			}
 
+			// Per-draw sets skip the descriptor pools and caches of the render frame
+			if (descriptor_set_layout.IsPushDescriptor())
+			{
+				push_descriptor_set(pipeline_bind_point, pipeline_layout, descriptor_set_layout, buffer_infos, image_infos);
+				continue;
+			}
+
+			// Descriptor buffer sets are written into the frame's descriptor buffer and bound with an offset
+			if (descriptor_set_layout.IsDescriptorBuffer())
+			{
+				auto allocation = command_pool.get_render_frame()->RequestDescriptorBuffer(descriptor_set_layout,
+				                                                                           buffer_infos,
+				                                                                           image_infos,
+				                                                                           command_pool.get_thread_index());
+
+				if (allocation.get_buffer().get_handle() != bound_descriptor_buffer)
+				{
+					bind_descriptor_buffer(allocation.get_buffer());
+
+					// Offsets set before now point into the new buffer
+					stale_sets = resource_binding_state.get_bound_sets();
+				}
+
+				uint32_t     buffer_index = 0;
+				VkDeviceSize offset       = allocation.get_offset();
+				vkCmdSetDescriptorBufferOffsetsEXT(get_handle(), pipeline_bind_point, pipeline_layout.get_handle(), descriptor_set_id, 1, &buffer_index, &offset);
+
+				stale_sets &= ~(1u << descriptor_set_id);
+				continue;
+			}
+
 			VkDescriptorSet descriptor_set_handle =
 			    command_pool.get_render_frame()->RequestDescriptorSet(descriptor_set_layout,
 			                                                            buffer_infos,
@@ -692,10 +1687,81 @@ void CommandBuffer::flush_descriptor_state(VkPipelineBindPoint pipeline_bind_poi
 			                        dynamic_offsets.data());
 		}
 	}
+
+	if (stale_sets != 0)
+	{
+		resource_binding_state.mark_dirty(stale_sets);
+		flush_descriptor_state(pipeline_bind_point);
+	}
+}
+
+void CommandBuffer::bind_descriptor_buffer(const vkb::core::BufferC &buffer)
+{
+	VkDescriptorBufferBindingInfoEXT binding_info{VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT};
+	binding_info.address = buffer.get_device_address();
+	binding_info.usage   = RenderFrame::DESCRIPTOR_BUFFER_USAGE;
+
+	vkCmdBindDescriptorBuffersEXT(get_handle(), 1, &binding_info);
+
+	bound_descriptor_buffer = buffer.get_handle();
+}
+
+void CommandBuffer::push_descriptor_set(VkPipelineBindPoint                       pipeline_bind_point,
+                                        const PipelineLayout                     &pipeline_layout,
+                                        const DescriptorSetLayout                &descriptor_set_layout,
+                                        const BindingMap<VkDescriptorBufferInfo> &buffer_infos,
+                                        const BindingMap<VkDescriptorImageInfo>  &image_infos)
+{
+	auto &frame_arena = command_pool.get_render_frame()->GetFrameArena(command_pool.get_thread_index());
+
+	std::pmr::vector<VkWriteDescriptorSet> write_descriptor_sets{&frame_arena};
+
+	for (auto &binding_it : buffer_infos)
+	{
+		auto binding_info = descriptor_set_layout.GetLayoutBinding(binding_it.first);
+
+		for (auto &element_it : binding_it.second)
+		{
+			VkWriteDescriptorSet write_descriptor_set{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+			write_descriptor_set.dstBinding      = binding_it.first;
+			write_descriptor_set.dstArrayElement = element_it.first;
+			write_descriptor_set.descriptorCount = 1;
+			write_descriptor_set.descriptorType  = binding_info->descriptorType;
+			write_descriptor_set.pBufferInfo     = &element_it.second;
+
+			write_descriptor_sets.push_back(write_descriptor_set);
+		}
+	}
+
+	for (auto &binding_it : image_infos)
+	{
+		auto binding_info = descriptor_set_layout.GetLayoutBinding(binding_it.first);
+
+		for (auto &element_it : binding_it.second)
+		{
+			VkWriteDescriptorSet write_descriptor_set{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+			write_descriptor_set.dstBinding      = binding_it.first;
+			write_descriptor_set.dstArrayElement = element_it.first;
+			write_descriptor_set.descriptorCount = 1;
+			write_descriptor_set.descriptorType  = binding_info->descriptorType;
+			write_descriptor_set.pImageInfo      = &element_it.second;
+
+			write_descriptor_sets.push_back(write_descriptor_set);
+		}
+	}
+
+	vkCmdPushDescriptorSetKHR(get_handle(),
+	                          pipeline_bind_point,
+	                          pipeline_layout.get_handle(),
+	                          descriptor_set_layout.GetIndex(),
+	                          to_u32(write_descriptor_sets.size()),
+	                          write_descriptor_sets.data());
 }
 
 void CommandBuffer::flush_push_constants()
 {
+	PROFILE_FUNCTION();
+
 	if (stored_push_constants.empty())
 	{
 		return;
@@ -705,13 +1771,13 @@ void CommandBuffer::flush_push_constants()
 
 	VkShaderStageFlags shader_stage = pipeline_layout.get_push_constant_range_stage(to_u32(stored_push_constants.size()));
 
-	if (shader_stage)
+	if (!shader_stage)
 	{
-		vkCmdPushConstants(get_handle(), pipeline_layout.get_handle(), shader_stage, 0, to_u32(stored_push_constants.size()), stored_push_constants.data());
+		LOGW_THROTTLED("Push constant range [{}, {}] not found", 0, stored_push_constants.size());
 	}
-	else
+	else if (redundant_command_filter.update_push_constants(pipeline_layout.get_handle(), shader_stage, stored_push_constants))
 	{
-		LOGW("Push constant range [{}, {}] not found", 0, stored_push_constants.size());
+		vkCmdPushConstants(get_handle(), pipeline_layout.get_handle(), shader_stage, 0, to_u32(stored_push_constants.size()), stored_push_constants.data());
 	}
 
 	stored_push_constants.clear();
@@ -762,12 +1828,30 @@ void CommandBuffer::write_timestamp(VkPipelineStageFlagBits pipeline_stage,
 	vkCmdWriteTimestamp(get_handle(), pipeline_stage, query_pool.get_handle(), query);
 }
 
+CommandBuffer::ResetMode CommandBuffer::get_reset_mode() const
+{
+	return command_pool.get_reset_mode();
+}
+
+uint32_t CommandBuffer::get_redundant_command_count() const
+{
+	return redundant_command_filter.get_skipped_command_count();
+}
+
+void CommandBuffer::reset_redundant_command_filter()
+{
+	redundant_command_filter.reset();
+}
+
 VkResult CommandBuffer::reset(ResetMode reset_mode)
 {
 	VkResult result = VK_SUCCESS;
 
 	assert(reset_mode == command_pool.get_reset_mode() && "Command buffer reset mode must match the one used by the pool to allocate it");
 
+	pending_image_barriers.clear();
+	pending_buffer_barriers.clear();
+
 	if (reset_mode == ResetMode::ResetIndividually)
 	{
 		result = vkResetCommandBuffer(get_handle(), VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
@@ -783,21 +1867,21 @@ RenderPass &CommandBuffer::get_render_pass(const vkb::RenderTarget
 	// Create render pass
 	assert(subpasses.size() > 0 && "Cannot create a render pass without any subpass");
 
-	std::vector<vkb::SubpassInfo> subpass_infos(subpasses.size());
-	auto                          subpass_info_it = subpass_infos.begin();
-	for (auto &subpass : subpasses)
-	{
-		subpass_info_it->input_attachments                = subpass->get_input_attachments();
-		subpass_info_it->output_attachments               = subpass->get_output_attachments();
-		subpass_info_it->color_resolve_attachments        = subpass->get_color_resolve_attachments();
-		subpass_info_it->disable_depth_stencil_attachment = subpass->get_disable_depth_stencil_attachment();
-		subpass_info_it->depth_stencil_resolve_mode       = subpass->get_depth_stencil_resolve_mode();
-		subpass_info_it->depth_stencil_resolve_attachment = subpass->get_depth_stencil_resolve_attachment();
-		subpass_info_it->debug_name                       = subpass->get_debug_name();
+	auto subpass_infos = get_subpass_infos(render_target, subpasses);
 
-		++subpass_info_it;
+	auto shading_rate_view = render_target.get_shading_rate_view();
+	if (!shading_rate_view)
+	{
+		return get_device().get_resource_cache().RequestRenderPass(render_target.get_attachments(), load_store_infos, subpass_infos);
 	}
 
-	return get_device().get_resource_cache().RequestRenderPass(render_target.get_attachments(), load_store_infos, subpass_infos);
+	// The shading rate attachment follows the attachments of the render target, as in its framebuffers
+	auto attachments = render_target.get_attachments();
+
+	Attachment shading_rate_attachment{shading_rate_view->get_format(), VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR};
+	shading_rate_attachment.initial_layout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+	attachments.push_back(shading_rate_attachment);
+
+	return get_device().get_resource_cache().RequestRenderPass(attachments, load_store_infos, subpass_infos);
 }
 }        // namespace vkb
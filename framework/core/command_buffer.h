@@ -25,6 +25,7 @@
 #include "core/image.h"
 #include "core/image_view.h"
 #include "core/query_pool.h"
+#include "core/redundant_command_filter.h"
 #include "core/sampler.h"
 #include "core/vulkan_resource.h"
 #include "rendering/pipeline_state.h"
@@ -75,6 +76,26 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 		const RenderPass *render_pass;
 
 		const Framebuffer *framebuffer;
+
+		/// Target of the render pass begun by the command buffer, its attachments are tracked to the final layouts at the end
+		const RenderTarget *render_target{nullptr};
+	};
+
+	/**
+	 * @brief Helper structure used to track the dynamic rendering instances begun instead of a render pass
+	 */
+	struct RenderingBinding
+	{
+		const RenderTarget *render_target{nullptr};
+
+		std::vector<LoadStoreInfo> load_store_infos;
+
+		std::vector<VkClearValue> clear_values;
+
+		std::vector<SubpassInfo> subpasses;
+
+		/// Whether the subpasses share a single instance, reading the attachments with local read
+		bool local_read{false};
 	};
 
 	CommandBuffer(CommandPool &command_pool, VkCommandBufferLevel level);
@@ -121,6 +142,13 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 
 	void clear(VkClearAttachment info, VkClearRect rect);
 
+	/**
+	 * @brief Begins a render pass for the subpasses, requested from the resource cache with its framebuffer
+	 *        When the device uses dynamic rendering, a rendering instance is begun from the views of the render target
+	 *        instead, see Device::enable_dynamic_rendering. The render pass is kept for the subpasses recorded
+	 *        in secondary command buffers or resolving attachments, and for those reading input attachments
+	 *        without local read.
+	 */
 	void begin_render_pass(const RenderTarget                                           &render_target,
 	                       const std::vector<LoadStoreInfo>                             &load_store_infos,
 	                       const std::vector<VkClearValue>                              &clear_values,
@@ -129,12 +157,15 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 
 	void begin_render_pass(const RenderTarget &render_target, const RenderPass &render_pass, const Framebuffer &framebuffer, const std::vector<VkClearValue> &clear_values, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 
-	void next_subpass();
+	void next_subpass(VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 
 	void execute_commands(CommandBuffer &secondary_command_buffer);
 
 	void execute_commands(std::vector<CommandBuffer *> &secondary_command_buffers);
 
+	/**
+	 * @brief Ends the render pass, the state trackers of the attachments then hold their final layouts and writes
+	 */
 	void end_render_pass();
 
 	void bind_pipeline_layout(PipelineLayout &pipeline_layout);
@@ -144,6 +175,8 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 
 	void set_specialization_constant(uint32_t constant_id, const std::vector<uint8_t> &data);
 
+	void set_specialization_constant(uint32_t constant_id, const uint8_t *data, size_t size);
+
 	/**
 	 * @brief Records byte data into the command buffer to be pushed as push constants to each draw call
 	 * @param values The byte data to store
@@ -153,9 +186,10 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 	template <typename T>
 	void push_constants(const T &value)
 	{
-		auto data = to_bytes(value);
+		// Copied in place, without going through a temporary vector of bytes
+		auto data = reinterpret_cast<const uint8_t *>(&value);
 
-		uint32_t size = to_u32(stored_push_constants.size() + data.size());
+		uint32_t size = to_u32(stored_push_constants.size() + sizeof(T));
 
 		if (size > max_push_constants_size)
 		{
@@ -163,7 +197,7 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 			throw std::runtime_error("Cannot overflow push constant limit");
 		}
 
-		stored_push_constants.insert(stored_push_constants.end(), data.begin(), data.end());
+		stored_push_constants.insert(stored_push_constants.end(), data, data + sizeof(T));
 	}
 
 	void bind_buffer(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t set, uint32_t binding, uint32_t array_element);
@@ -174,12 +208,24 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 
 	void bind_input(const core::ImageView &image_view, uint32_t set, uint32_t binding, uint32_t array_element);
 
+	/**
+	 * @brief Binds the resources bound to another command buffer, like a secondary command buffer recording draws
+	 *        for a primary one, which doesn't inherit its bindings
+	 */
+	void bind_resources(const CommandBuffer &command_buffer);
+
 	void bind_vertex_buffers(uint32_t first_binding, const std::vector<std::reference_wrapper<const vkb::core::BufferC>> &buffers, const std::vector<VkDeviceSize> &offsets);
 
 	void bind_index_buffer(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkIndexType index_type);
 
 	void bind_lighting(vkb::rendering::LightingStateC &lighting_state, uint32_t set, uint32_t binding);
 
+	/**
+	 * @brief Binds a descriptor set managed outside of the command buffer, such as the one of a BindlessRegistry,
+	 *        with the current pipeline layout. Must be called again after binding an incompatible pipeline layout.
+	 */
+	void bind_descriptor_set(uint32_t set, VkDescriptorSet descriptor_set, VkPipelineBindPoint pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
 	void set_viewport_state(const ViewportState &state_info);
 
 	void set_vertex_input_state(const VertexInputState &state_info);
@@ -194,6 +240,12 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 
 	void set_color_blend_state(const ColorBlendState &state_info);
 
+	/**
+	 * @brief Sets the fragment shading rate of the next draws
+	 *        The draws of a subpass using the shading rate attachment take its rates with the REPLACE combiner.
+	 */
+	void set_fragment_shading_rate_state(const FragmentShadingRateState &state_info);
+
 	void set_viewport(uint32_t first_viewport, const std::vector<VkViewport> &viewports);
 
 	void set_scissor(uint32_t first_scissor, const std::vector<VkRect2D> &scissors);
@@ -212,6 +264,16 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 
 	void draw_indexed_indirect(const vkb::core::BufferC &buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride);
 
+	/**
+	 * @brief Draws with the number of draws read from a buffer, requires VK_KHR_draw_indirect_count
+	 */
+	void draw_indexed_indirect_count(const vkb::core::BufferC &buffer, VkDeviceSize offset, const vkb::core::BufferC &count_buffer, VkDeviceSize count_offset, uint32_t max_draw_count, uint32_t stride);
+
+	/**
+	 * @brief Draws with the task and mesh shaders of the pipeline, as VK_EXT_mesh_shader
+	 */
+	void draw_mesh_tasks(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z);
+
 	void dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z);
 
 	void dispatch_indirect(const vkb::core::BufferC &buffer, VkDeviceSize offset);
@@ -230,10 +292,37 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 
 	void copy_image_to_buffer(const core::Image &image, VkImageLayout image_layout, const vkb::core::BufferC &buffer, const std::vector<VkBufferImageCopy> &regions);
 
-	void image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier) const;
+	/**
+	 * @brief Records a barrier for the subresources of the view, the state tracker of its image then holds the destination state
+	 */
+	void image_memory_barrier(const core::ImageView &image_view, const ImageMemoryBarrier &memory_barrier);
 
 	void buffer_memory_barrier(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkDeviceSize size, const BufferMemoryBarrier &memory_barrier);
 
+	/**
+	 * @brief Requests the state the next access to a range of subresources of an image needs
+	 *        The barrier needed from the tracked state of the image, if any, waits until flush_barriers(), so requests
+	 *        for the same subresources are separated by the access they are for.
+	 * @param discard Whether the access overwrites the previous contents, a layout transition then starts from undefined
+	 */
+	void request_image_state(const core::Image &image, const VkImageSubresourceRange &range, const core::ResourceState &state, bool discard = false);
+
+	/**
+	 * @brief Requests the state the next access to the subresources of an image view needs
+	 */
+	void request_image_state(const core::ImageView &image_view, const core::ResourceState &state, bool discard = false);
+
+	/**
+	 * @brief Requests the state the next access to a buffer needs
+	 */
+	void request_buffer_state(const vkb::core::BufferC &buffer, const core::ResourceState &state);
+
+	/**
+	 * @brief Records the barriers of the requested states in a single pipeline barrier, nothing if none is needed
+	 *        The commands recorded outside of a render pass, and beginning one, call it first.
+	 */
+	void flush_barriers();
+
 	void set_update_after_bind(bool update_after_bind_);
 
 	void reset_query_pool(const QueryPool &query_pool, uint32_t first_query, uint32_t query_count);
@@ -250,6 +339,30 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 	 */
 	VkResult reset(ResetMode reset_mode);
 
+	/**
+	 * @return Reset mode of the pool the command buffer was allocated from
+	 */
+	ResetMode get_reset_mode() const;
+
+	/**
+	 * @return The number of commands skipped since the command buffer began because they set the state already in place,
+	 *         including those of the secondary command buffers it executed
+	 */
+	uint32_t get_redundant_command_count() const;
+
+	/**
+	 * @brief Forgets the state recorded through the wrapper, to be called after recording commands on the handle directly
+	 */
+	void reset_redundant_command_filter();
+
+	/**
+	 * @return The render pass and framebuffer being recorded, or inherited by a secondary command buffer,
+	 *         null while dynamic rendering is used instead
+	 */
+	const RenderPassBinding &get_current_render_pass() const;
+
+	const uint32_t get_current_subpass_index() const;
+
 	RenderPass &get_render_pass(const vkb::RenderTarget                                      &render_target,
 	                            const std::vector<LoadStoreInfo>                             &load_store_infos,
 	                            const std::vector<std::unique_ptr<vkb::rendering::SubpassC>> &subpasses);
@@ -277,27 +390,78 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 	// that contain update after bind, as they wont be implicitly updated
 	bool update_after_bind{false};
 
-	std::unordered_map<uint32_t, DescriptorSetLayout *> descriptor_set_layout_binding_state;
+	std::array<DescriptorSetLayout *, ResourceBindingState::MAX_SETS> descriptor_set_layout_binding_state{};
 
-	const RenderPassBinding &get_current_render_pass() const;
+	// Descriptor buffer the descriptor buffer sets are bound from, there is only one at a time
+	VkBuffer bound_descriptor_buffer{VK_NULL_HANDLE};
 
-	const uint32_t get_current_subpass_index() const;
+	RenderingBinding current_rendering;
+
+	RedundantCommandFilter redundant_command_filter;
+
+	/// Whether the barriers are recorded with VK_KHR_synchronization2
+	bool synchronization2{false};
+
+	/// Barriers of the requested states, recorded at once by flush_barriers
+	std::vector<VkImageMemoryBarrier2KHR> pending_image_barriers;
+
+	std::vector<VkBufferMemoryBarrier2KHR> pending_buffer_barriers;
 
 	/**
 	 * @brief Check that the render area is an optimal size by comparing to the render area granularity
 	 */
 	const bool is_render_size_optimal(const VkExtent2D &extent, const VkRect2D &render_area);
 
+	/**
+	 * @brief Whether the subpasses can be recorded with dynamic rendering, see begin_render_pass
+	 */
+	bool can_render_dynamically(const std::vector<SubpassInfo> &subpass_infos, VkSubpassContents contents) const;
+
+	/**
+	 * @brief Transitions the attachments to their layout in the rendering instances, and begins the first one
+	 */
+	void begin_rendering();
+
+	/**
+	 * @brief Begins the rendering instance of the current subpass, or remaps the attachments of the shared instance to it with local read
+	 */
+	void begin_rendering_subpass();
+
 	/**
 	 * @brief Flush the pipeline state
 	 */
 	void flush_pipeline_state(VkPipelineBindPoint pipeline_bind_point);
 
+	/**
+	 * @brief Binds the shader objects of the pipeline layout, and sets the graphics state dynamically, when the device uses shader objects
+	 */
+	void flush_shader_object_state(VkPipelineBindPoint pipeline_bind_point);
+
+	/**
+	 * @brief Sets the members of the graphics state that are dynamic
+	 * @param dynamic_state The DynamicPipelineState flags of the members to set
+	 */
+	void set_dynamic_pipeline_state(uint32_t dynamic_state);
+
 	/**
 	 * @brief Flush the descriptor set state
 	 */
 	void flush_descriptor_state(VkPipelineBindPoint pipeline_bind_point);
 
+	/**
+	 * @brief Records the descriptors of a push descriptor set layout directly into the command buffer
+	 */
+	void push_descriptor_set(VkPipelineBindPoint                       pipeline_bind_point,
+	                         const PipelineLayout                     &pipeline_layout,
+	                         const DescriptorSetLayout                &descriptor_set_layout,
+	                         const BindingMap<VkDescriptorBufferInfo> &buffer_infos,
+	                         const BindingMap<VkDescriptorImageInfo>  &image_infos);
+
+	/**
+	 * @brief Binds the descriptor buffer the offsets of descriptor buffer sets refer to
+	 */
+	void bind_descriptor_buffer(const vkb::core::BufferC &buffer);
+
 	/**
 	 * @brief Flush the push constant state
 	 */
@@ -307,12 +471,13 @@ class CommandBuffer : public vkb::core::VulkanResourceC<VkCommandBuffer>
 template <class T>
 inline void CommandBuffer::set_specialization_constant(uint32_t constant_id, const T &data)
 {
-	set_specialization_constant(constant_id, to_bytes(data));
+	set_specialization_constant(constant_id, reinterpret_cast<const uint8_t *>(&data), sizeof(T));
 }
 
 template <>
 inline void CommandBuffer::set_specialization_constant<bool>(std::uint32_t constant_id, const bool &data)
 {
-	set_specialization_constant(constant_id, to_bytes(to_u32(data)));
+	auto value = to_u32(data);
+	set_specialization_constant(constant_id, reinterpret_cast<const uint8_t *>(&value), sizeof(value));
 }
 }        // namespace vkb
@@ -23,8 +23,112 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <unordered_map>
 
+#ifdef _WIN32
+#	include <windows.h>
+#else
+#	include <dlfcn.h>
+#endif
+
 namespace vkb
 {
+namespace
+{
+/**
+ * @brief Leading entries of RENDERDOC_API_1_1_2 in renderdoc_app.h, which later versions of the API only extend
+ */
+struct RenderDocApi
+{
+	/// GetAPIVersion to SetActiveWindow
+	void *unused[19];
+
+	void *start_frame_capture;
+
+	uint32_t (*is_frame_capturing)();
+};
+
+/// eRENDERDOC_API_Version_1_1_2
+constexpr int RenderDocApiVersion = 10102;
+
+/**
+ * @return The API of RenderDoc if it was loaded in the process, e.g. by launching the sample from it
+ */
+RenderDocApi *get_render_doc_api()
+{
+	using GetApi = int (*)(int, void **);
+
+	GetApi get_api{nullptr};
+#if defined(_WIN32)
+	if (HMODULE module = GetModuleHandleA("renderdoc.dll"))
+	{
+		get_api = reinterpret_cast<GetApi>(GetProcAddress(module, "RENDERDOC_GetAPI"));
+	}
+#elif defined(__APPLE__)
+	// RenderDoc doesn't support Vulkan on top of MoltenVK
+#elif defined(__ANDROID__)
+	// RenderDoc is injected as a layer on Android
+	if (void *library = dlopen("libVkLayer_GLES_RenderDoc.so", RTLD_NOW | RTLD_NOLOAD))
+	{
+		get_api = reinterpret_cast<GetApi>(dlsym(library, "RENDERDOC_GetAPI"));
+	}
+#else
+	// RTLD_NOLOAD only returns the library if it is already loaded
+	if (void *library = dlopen("librenderdoc.so", RTLD_NOW | RTLD_NOLOAD))
+	{
+		get_api = reinterpret_cast<GetApi>(dlsym(library, "RENDERDOC_GetAPI"));
+	}
+#endif
+
+	RenderDocApi *api{nullptr};
+	if (get_api && get_api(RenderDocApiVersion, reinterpret_cast<void **>(&api)) == 1)
+	{
+		return api;
+	}
+	return nullptr;
+}
+
+/// Debug builds label every frame, the others only the captured ones
+#ifdef VKB_DEBUG
+constexpr DebugLabelMode DefaultMode = DebugLabelMode::Enabled;
+#else
+constexpr DebugLabelMode DefaultMode = DebugLabelMode::Capture;
+#endif
+}        // namespace
+
+std::atomic<DebugLabelMode> DebugLabels::mode{DefaultMode};
+
+std::atomic<bool> DebugLabels::labels_enabled{DefaultMode == DebugLabelMode::Enabled};
+
+void DebugLabels::set_mode(DebugLabelMode new_mode)
+{
+	mode = new_mode;
+	update();
+}
+
+DebugLabelMode DebugLabels::get_mode()
+{
+	return mode;
+}
+
+void DebugLabels::update()
+{
+	switch (mode.load(std::memory_order_relaxed))
+	{
+		case DebugLabelMode::Disabled:
+			labels_enabled.store(false, std::memory_order_relaxed);
+			break;
+		case DebugLabelMode::Capture:
+		{
+			// Looked up once, RenderDoc is injected at startup or not at all
+			static RenderDocApi *render_doc_api = get_render_doc_api();
+			labels_enabled.store(render_doc_api && render_doc_api->is_frame_capturing(), std::memory_order_relaxed);
+			break;
+		}
+		case DebugLabelMode::Enabled:
+			labels_enabled.store(true, std::memory_order_relaxed);
+			break;
+	}
+}
+
 void DebugUtilsExtDebugUtils::set_debug_name(VkDevice device, VkObjectType object_type, uint64_t object_handle,
                                              const char *name) const
 {
@@ -177,12 +281,13 @@ void DebugMarkerExtDebugUtils::cmd_insert_label(VkCommandBuffer command_buffer,
 	vkCmdDebugMarkerInsertEXT(command_buffer, &marker_info);
 }
 
+#ifdef VKB_VULKAN_DEBUG
 ScopedDebugLabel::ScopedDebugLabel(const DebugUtils &debug_utils, VkCommandBuffer command_buffer,
                                    const char *name, glm::vec4 color) :
     debug_utils{&debug_utils},
     command_buffer{VK_NULL_HANDLE}
 {
-	if (name && *name != '\0')
+	if (DebugLabels::are_labels_enabled() && name && *name != '\0')
 	{
 		assert(command_buffer != VK_NULL_HANDLE);
 		this->command_buffer = command_buffer;
@@ -192,9 +297,16 @@ ScopedDebugLabel::ScopedDebugLabel(const DebugUtils &debug_utils, VkCommandBuffe
 }
 
 ScopedDebugLabel::ScopedDebugLabel(const CommandBuffer &command_buffer,
-                                   const char *name, glm::vec4 color) :
-    ScopedDebugLabel{command_buffer.get_device().get_debug_utils(), command_buffer.get_handle(), name, color}
+                                   const char *name, glm::vec4 color)
 {
+	// The command buffer and its device are only looked up for the labels which are recorded
+	if (DebugLabels::are_labels_enabled() && name && *name != '\0')
+	{
+		debug_utils          = &command_buffer.get_device().get_debug_utils();
+		this->command_buffer = command_buffer.get_handle();
+
+		debug_utils->cmd_begin_label(this->command_buffer, name, color);
+	}
 }
 
 ScopedDebugLabel::~ScopedDebugLabel()
@@ -204,5 +316,6 @@ ScopedDebugLabel::~ScopedDebugLabel()
 		debug_utils->cmd_end_label(command_buffer);
 	}
 }
+#endif
 
 }        // namespace vkb
\ No newline at end of file
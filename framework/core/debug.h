@@ -19,10 +19,70 @@
 
 #include "common/glm_common.h"
 #include "common/vk_common.h"
+#include <atomic>
 #include <cassert>
 
 namespace vkb
 {
+/**
+ * @brief When the debug labels are recorded and the objects named, for the whole process
+ */
+enum class DebugLabelMode
+{
+	/// Neither labels nor names
+	Disabled,
+
+	/// Labels only in the frames captured by a graphics debugger, names always
+	Capture,
+
+	Enabled
+};
+
+/**
+ * @brief Runtime switch of the debug labels, checked by ScopedDebugLabel and HPPScopedDebugLabel
+ *
+ * Labels are recorded on the hot paths, e.g. around each draw of a submesh, and cost a call through DebugUtils even
+ * without a debugger attached. In Capture mode, update() checks once per frame whether RenderDoc, loaded in the
+ * process, is capturing the frame, and the labels are only recorded then. Command buffers recorded before the
+ * capture keep their labels, or lack of them. The objects are always named in this mode, since they are named once
+ * at their creation, before any capture.
+ *
+ * The labels are compiled out without VKB_VULKAN_DEBUG, whatever the mode.
+ */
+class DebugLabels
+{
+  public:
+	static void set_mode(DebugLabelMode mode);
+
+	static DebugLabelMode get_mode();
+
+	/**
+	 * @brief Updates whether the labels are recorded for the next frame, called by the render context as a frame begins
+	 */
+	static void update();
+
+	/**
+	 * @return Whether the labels are recorded in the current frame
+	 */
+	static bool are_labels_enabled()
+	{
+		return labels_enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @return Whether the objects are given their debug names
+	 */
+	static bool are_names_enabled()
+	{
+		return mode.load(std::memory_order_relaxed) != DebugLabelMode::Disabled;
+	}
+
+  private:
+	static std::atomic<DebugLabelMode> mode;
+
+	static std::atomic<bool> labels_enabled;
+};
+
 /**
  * @brief An interface over platform-specific debug extensions.
  */
@@ -138,13 +198,15 @@ class CommandBuffer;
 
 /**
  * @brief A RAII debug label.
- *        If any of EXT_debug_utils or EXT_debug_marker is available, this:
+ *        If any of EXT_debug_utils or EXT_debug_marker is available, and DebugLabels enables the labels, this:
  *        - Begins a debug label / marker on construction
  *        - Ends it on destruction
+ *        Without VKB_VULKAN_DEBUG, it is empty and compiled out.
  */
 class ScopedDebugLabel final
 {
   public:
+#ifdef VKB_VULKAN_DEBUG
 	ScopedDebugLabel(const DebugUtils &debug_utils, VkCommandBuffer command_buffer,
 	                 const char *name, glm::vec4 color = {});
 
@@ -154,8 +216,15 @@ class ScopedDebugLabel final
 	~ScopedDebugLabel();
 
   private:
-	const DebugUtils *debug_utils;
-	VkCommandBuffer   command_buffer;
+	const DebugUtils *debug_utils{nullptr};
+	VkCommandBuffer   command_buffer{VK_NULL_HANDLE};
+#else
+	ScopedDebugLabel(const DebugUtils &, VkCommandBuffer, const char *, glm::vec4 = {})
+	{}
+
+	ScopedDebugLabel(const CommandBuffer &, const char *, glm::vec4 = {})
+	{}
+#endif
 };
 
 }        // namespace vkb
\ No newline at end of file
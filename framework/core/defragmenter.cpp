@@ -0,0 +1,250 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/defragmenter.h"
+
+#include <algorithm>
+
+#include "core/allocated.h"
+#include "core/device.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr VkDeviceSize MinBytesPerPass = 1024 * 1024;
+
+constexpr VkDeviceSize MaxBytesPerPass = 256 * 1024 * 1024;
+
+void record_barrier(VkCommandBuffer command_buffer, VkPipelineStageFlags src_stage, VkAccessFlags src_access, VkPipelineStageFlags dst_stage, VkAccessFlags dst_access)
+{
+	VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+	barrier.srcAccessMask = src_access;
+	barrier.dstAccessMask = dst_access;
+	vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+}        // namespace
+
+Defragmenter::Defragmenter(Device &device, std::chrono::microseconds budget) :
+    device{device},
+    queue{device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0)},
+    budget{budget}
+{
+	VkCommandPoolCreateInfo command_pool_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+	command_pool_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	command_pool_info.queueFamilyIndex = queue.get_family_index();
+	VK_CHECK(vkCreateCommandPool(device.get_handle(), &command_pool_info, nullptr, &command_pool));
+
+	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocate_info.commandPool        = command_pool;
+	allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount = 1;
+	VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, &command_buffer));
+}
+
+Defragmenter::~Defragmenter()
+{
+	// update() ends its passes, so no allocation is moving
+	if (context != VK_NULL_HANDLE)
+	{
+		end_defragmentation();
+	}
+
+	vkDestroyCommandPool(device.get_handle(), command_pool, nullptr);
+}
+
+void Defragmenter::update()
+{
+	if (context == VK_NULL_HANDLE)
+	{
+		if (++frames_since_check < CheckInterval)
+		{
+			return;
+		}
+		frames_since_check = 0;
+
+		if (!is_fragmented())
+		{
+			return;
+		}
+
+		// The default pools first
+		pools = allocated::get_defragmentable_pools();
+		pools.push_back(VK_NULL_HANDLE);
+
+		if (!begin_defragmentation())
+		{
+			return;
+		}
+		++stats.defragmentation_count;
+	}
+
+	run_pass();
+}
+
+const Defragmenter::Stats &Defragmenter::get_stats() const
+{
+	return stats;
+}
+
+bool Defragmenter::is_fragmented() const
+{
+	VmaTotalStatistics statistics{};
+	vmaCalculateStatistics(allocated::get_memory_allocator(), &statistics);
+
+	auto        &total  = statistics.total.statistics;
+	VkDeviceSize unused = total.blockBytes - total.allocationBytes;
+
+	return unused >= MinUnusedBytes && unused > FragmentationThreshold * total.blockBytes;
+}
+
+bool Defragmenter::begin_defragmentation()
+{
+	while (!pools.empty())
+	{
+		VmaDefragmentationInfo info{};
+		info.flags           = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+		info.pool            = pools.back();
+		info.maxBytesPerPass = max_bytes_per_pass;
+		pools.pop_back();
+
+		VkResult result = vmaBeginDefragmentation(allocated::get_memory_allocator(), &info, &context);
+		if (result == VK_SUCCESS)
+		{
+			return true;
+		}
+
+		LOGW("Cannot defragment a memory pool: {}", vkb::to_string(result));
+		context = VK_NULL_HANDLE;
+	}
+
+	return false;
+}
+
+void Defragmenter::end_defragmentation()
+{
+	VmaDefragmentationStats defragmentation_stats{};
+	vmaEndDefragmentation(allocated::get_memory_allocator(), context, &defragmentation_stats);
+	context = VK_NULL_HANDLE;
+
+	stats.bytes_moved += defragmentation_stats.bytesMoved;
+	stats.allocations_moved += defragmentation_stats.allocationsMoved;
+
+	if (defragmentation_stats.allocationsMoved > 0)
+	{
+		LOGI("Defragmentation moved {} allocations ({} bytes) and released {} bytes of memory",
+		     defragmentation_stats.allocationsMoved, defragmentation_stats.bytesMoved, defragmentation_stats.bytesFreed);
+	}
+}
+
+void Defragmenter::run_pass()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	auto &allocator = allocated::get_memory_allocator();
+
+	VmaDefragmentationPassMoveInfo pass{};
+	VkResult                       result = vmaBeginDefragmentationPass(allocator, context, &pass);
+	if (result != VK_INCOMPLETE)
+	{
+		// Nothing left to move in this pool, or the defragmentation failed
+		if (result != VK_SUCCESS)
+		{
+			LOGW("Defragmentation pass failed: {}", vkb::to_string(result));
+		}
+		end_defragmentation();
+		begin_defragmentation();
+		return;
+	}
+
+	VK_CHECK(vkResetCommandPool(device.get_handle(), command_pool, 0));
+
+	VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VK_CHECK(vkBeginCommandBuffer(command_buffer, &begin_info));
+
+	record_barrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+	std::vector<allocated::Movable *> moving;
+	for (uint32_t i = 0; i < pass.moveCount; ++i)
+	{
+		auto &move = pass.pMoves[i];
+
+		VmaAllocationInfo allocation_info{};
+		vmaGetAllocationInfo(allocator, move.srcAllocation, &allocation_info);
+
+		auto movable = static_cast<allocated::Movable *>(allocation_info.pUserData);
+		if (movable && movable->begin_move(command_buffer, move.dstTmpAllocation))
+		{
+			moving.push_back(movable);
+		}
+		else
+		{
+			move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		}
+	}
+
+	record_barrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+	               VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+
+	VK_CHECK(vkEndCommandBuffer(command_buffer));
+
+	if (!moving.empty())
+	{
+		VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+		submit_info.commandBufferCount = 1;
+		submit_info.pCommandBuffers    = &command_buffer;
+		VK_CHECK(queue.submit({submit_info}, VK_NULL_HANDLE));
+
+		// The frames in flight may still use the previous handles, and their descriptor sets are rewritten
+		VK_CHECK(device.wait_idle());
+
+		std::vector<VkBuffer> previous_buffers;
+		std::vector<VkBuffer> new_buffers;
+		for (auto movable : moving)
+		{
+			auto handles = movable->end_move();
+			previous_buffers.push_back(handles.first);
+			new_buffers.push_back(handles.second);
+		}
+
+		device.get_resource_cache().UpdateDescriptorSets(previous_buffers, new_buffers);
+	}
+
+	result = vmaEndDefragmentationPass(allocator, context, &pass);
+	++stats.pass_count;
+
+	if (result == VK_SUCCESS)
+	{
+		end_defragmentation();
+		begin_defragmentation();
+	}
+
+	if (!moving.empty())
+	{
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		if (elapsed > budget)
+		{
+			max_bytes_per_pass = std::max(max_bytes_per_pass / 2, MinBytesPerPass);
+		}
+		else if (elapsed < budget / 2)
+		{
+			max_bytes_per_pass = std::min(max_bytes_per_pass * 2, MaxBytesPerPass);
+		}
+	}
+}
+}        // namespace vkb
@@ -0,0 +1,129 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Device;
+class Queue;
+
+/**
+ * @brief Compacts the memory blocks of the VMA when they are fragmented
+ *
+ * Loading and unloading resources leaves holes in the memory blocks, which the VMA only releases once
+ * they are empty. Every CheckInterval frames, the defragmenter checks the unused part of the blocks,
+ * and if it is too large, moves the movable buffers (see vkb::core::Buffer::set_movable) to fewer blocks,
+ * in the default pools then in the pools of the resource classes, see vkb::allocated::Settings.
+ *
+ * The allocations are moved in passes, one per call to update(). A pass copies the buffers on the graphics
+ * queue, waits for the device to be idle, then replaces the handles of the buffers and updates the descriptor
+ * sets of the resource cache referencing them, so no frame in flight uses the previous ones.
+ * The number of bytes moved by a pass adapts so a pass takes about the time budget.
+ * Images never move, their layouts aren't tracked by the framework.
+ */
+class Defragmenter
+{
+  public:
+	/// Frames between two checks of the fragmentation
+	static constexpr uint32_t CheckInterval = 300;
+
+	/// Unused part of the memory blocks from which they are compacted
+	static constexpr float FragmentationThreshold = 0.25f;
+
+	/// Unused bytes below which the memory is never compacted
+	static constexpr VkDeviceSize MinUnusedBytes = 32 * 1024 * 1024;
+
+	static constexpr std::chrono::microseconds DefaultBudget{2000};
+
+	struct Stats
+	{
+		uint32_t defragmentation_count{0};
+
+		uint32_t pass_count{0};
+
+		VkDeviceSize bytes_moved{0};
+
+		uint32_t allocations_moved{0};
+	};
+
+	/**
+	 * @param device The device whose memory is compacted
+	 * @param budget Time a pass should take, including the wait for the device
+	 */
+	explicit Defragmenter(Device &device, std::chrono::microseconds budget = DefaultBudget);
+
+	Defragmenter(const Defragmenter &) = delete;
+
+	Defragmenter(Defragmenter &&) = delete;
+
+	/**
+	 * @brief Ends the defragmentation in progress, the allocations of the pass in progress stay in place
+	 */
+	~Defragmenter();
+
+	Defragmenter &operator=(const Defragmenter &) = delete;
+
+	Defragmenter &operator=(Defragmenter &&) = delete;
+
+	/**
+	 * @brief Checks the fragmentation or runs a pass of the defragmentation in progress
+	 *        Called once per frame, before recording it.
+	 */
+	void update();
+
+	const Stats &get_stats() const;
+
+  private:
+	bool is_fragmented() const;
+
+	/// Starts the defragmentation of the next pool, returns false if all were compacted
+	bool begin_defragmentation();
+
+	void end_defragmentation();
+
+	void run_pass();
+
+	Device &device;
+
+	const Queue &queue;
+
+	std::chrono::microseconds budget;
+
+	/// Bytes a pass moves at most, adapted to the budget
+	VkDeviceSize max_bytes_per_pass{16 * 1024 * 1024};
+
+	VkCommandPool command_pool{VK_NULL_HANDLE};
+
+	VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+
+	VmaDefragmentationContext context{VK_NULL_HANDLE};
+
+	/// The pools left to compact, the null pool stands for the default pools
+	std::vector<VmaPool> pools;
+
+	uint32_t frames_since_check{0};
+
+	Stats stats;
+};
+}        // namespace vkb
@@ -18,11 +18,55 @@
 
 #include "device.h"
 
+#include <algorithm>
+
+#include "common/strings.h"
+
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
 
 namespace vkb
 {
+namespace
+{
+/**
+ * @return The GPUs of the device group of a GPU, empty if device groups aren't used
+ */
+std::vector<VkPhysicalDevice> get_device_group(Instance &instance, VkPhysicalDevice gpu)
+{
+	if (!Instance::use_device_group || !instance.is_enabled(VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME))
+	{
+		return {};
+	}
+
+	uint32_t group_count{0};
+	VK_CHECK(vkEnumeratePhysicalDeviceGroupsKHR(instance.get_handle(), &group_count, nullptr));
+
+	std::vector<VkPhysicalDeviceGroupPropertiesKHR> groups(group_count, {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GROUP_PROPERTIES_KHR});
+	VK_CHECK(vkEnumeratePhysicalDeviceGroupsKHR(instance.get_handle(), &group_count, groups.data()));
+
+	for (auto &group : groups)
+	{
+		auto begin = group.physicalDevices;
+		auto end   = group.physicalDevices + group.physicalDeviceCount;
+		if (std::find(begin, end, gpu) != end)
+		{
+			return {begin, end};
+		}
+	}
+
+	return {};
+}
+
+/**
+ * @return Whether a queue family only runs transfers, e.g. the DMA engines of a discrete GPU
+ */
+bool is_transfer_only(VkQueueFlags queue_flags)
+{
+	return (queue_flags & VK_QUEUE_TRANSFER_BIT) && !(queue_flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+}
+}        // namespace
+
 Device::Device(PhysicalDevice                        &gpu,
                VkSurfaceKHR                           surface,
                std::unique_ptr<DebugUtils>          &&debug_utils,
@@ -43,6 +87,9 @@ Device::Device(PhysicalDevice                        &gpu,
 	{
 		const VkQueueFamilyProperties &queue_family_property = gpu.get_queue_family_properties()[queue_family_index];
 
+		// The uploads on a dedicated transfer family yield to the rendering and compute work
+		float priority = is_transfer_only(queue_family_property.queueFlags) ? TransferQueuePriority : DefaultQueuePriority;
+
 		if (gpu.has_high_priority_graphics_queue())
 		{
 			uint32_t graphics_queue_family = get_queue_family_index(VK_QUEUE_GRAPHICS_BIT);
@@ -52,17 +99,17 @@ Device::Device(PhysicalDevice                        &gpu,
 				queue_priorities[queue_family_index].push_back(1.0f);
 				for (uint32_t i = 1; i < queue_family_property.queueCount; i++)
 				{
-					queue_priorities[queue_family_index].push_back(0.5f);
+					queue_priorities[queue_family_index].push_back(priority);
 				}
 			}
 			else
 			{
-				queue_priorities[queue_family_index].resize(queue_family_property.queueCount, 0.5f);
+				queue_priorities[queue_family_index].resize(queue_family_property.queueCount, priority);
 			}
 		}
 		else
 		{
-			queue_priorities[queue_family_index].resize(queue_family_property.queueCount, 0.5f);
+			queue_priorities[queue_family_index].resize(queue_family_property.queueCount, priority);
 		}
 
 		VkDeviceQueueCreateInfo &queue_create_info = queue_create_infos[queue_family_index];
@@ -106,6 +153,16 @@ Device::Device(PhysicalDevice                        &gpu,
 		}
 	}
 
+	// The device spans the GPUs of the group, the render context can render alternate frames on them
+	std::vector<VkPhysicalDevice> group_gpus = get_device_group(gpu.get_instance(), gpu.get_handle());
+	if (group_gpus.size() > 1 && is_extension_supported(VK_KHR_DEVICE_GROUP_EXTENSION_NAME))
+	{
+		enabled_extensions.push_back(VK_KHR_DEVICE_GROUP_EXTENSION_NAME);
+		physical_device_count = to_u32(group_gpus.size());
+
+		LOGI("Device group of {} GPUs enabled", physical_device_count);
+	}
+
 	// Check that extensions are supported before trying to create the device
 	std::vector<const char *> unsupported_extensions{};
 	for (auto &extension : requested_extensions)
@@ -157,6 +214,15 @@ Device::Device(PhysicalDevice                        &gpu,
 	// Latest requested feature will have the pNext's all set up for device creation.
 	create_info.pNext = gpu.get_extension_feature_chain();
 
+	VkDeviceGroupDeviceCreateInfoKHR group_create_info{VK_STRUCTURE_TYPE_DEVICE_GROUP_DEVICE_CREATE_INFO_KHR};
+	if (physical_device_count > 1)
+	{
+		group_create_info.physicalDeviceCount = to_u32(group_gpus.size());
+		group_create_info.pPhysicalDevices    = group_gpus.data();
+		group_create_info.pNext               = create_info.pNext;
+		create_info.pNext                     = &group_create_info;
+	}
+
 	create_info.pQueueCreateInfos       = queue_create_infos.data();
 	create_info.queueCreateInfoCount    = to_u32(queue_create_infos.size());
 	create_info.enabledExtensionCount   = to_u32(enabled_extensions.size());
@@ -188,8 +254,10 @@ Device::Device(PhysicalDevice                        &gpu,
 
 	prepare_memory_allocator();
 
-	command_pool = std::make_unique<CommandPool>(*this, get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0).get_family_index());
+	command_pool = std::make_unique<CommandPool>(*this, get_compute_queue().get_family_index());
 	fence_pool   = std::make_unique<FencePool>(*this);
+
+	deferred_destruction_queue = std::make_unique<DeferredDestructionQueue>(get_handle());
 }
 
 Device::Device(PhysicalDevice &gpu, VkDevice &vulkan_device, VkSurfaceKHR surface) :
@@ -198,12 +266,17 @@ Device::Device(PhysicalDevice &gpu, VkDevice &vulkan_device, VkSurfaceKHR surfac
     resource_cache{*this}
 {
 	debug_utils = std::make_unique<DummyDebugUtils>();
+
+	deferred_destruction_queue = std::make_unique<DeferredDestructionQueue>(get_handle());
 }
 
 Device::~Device()
 {
 	resource_cache.Clear();
 
+	// Waits for the objects retired until then, including the framebuffers cleared from the resource cache
+	deferred_destruction_queue.reset();
+
 	command_pool.reset();
 	fence_pool.reset();
 
@@ -413,6 +486,62 @@ const Queue &Device::get_suitable_graphics_queue() const
 	return get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
 }
 
+const Queue &Device::get_transfer_queue() const
+{
+	for (uint32_t queue_family_index = 0U; queue_family_index < queues.size(); ++queue_family_index)
+	{
+		if (is_transfer_only(queues[queue_family_index][0].get_properties().queueFlags))
+		{
+			return queues[queue_family_index][0];
+		}
+	}
+
+	return get_compute_queue();
+}
+
+const Queue &Device::get_compute_queue() const
+{
+	// The command buffers of a graphics family can also be submitted to the graphics queue
+	if (has_graphics_queue())
+	{
+		return get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0);
+	}
+
+	return get_queue_by_flags(VK_QUEUE_COMPUTE_BIT, 0);
+}
+
+bool Device::has_graphics_queue() const
+{
+	return std::any_of(queues.begin(), queues.end(), [](const std::vector<Queue> &family) {
+		return !family.empty() && (family[0].get_properties().queueFlags & VK_QUEUE_GRAPHICS_BIT);
+	});
+}
+
+const Queue &Device::get_async_compute_queue() const
+{
+	const Queue &graphics_queue = get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+
+	// A family without graphics if there is one, another queue of the graphics family otherwise
+	for (uint32_t queue_family_index = 0U; queue_family_index < queues.size(); ++queue_family_index)
+	{
+		VkQueueFlags queue_flags = queues[queue_family_index][0].get_properties().queueFlags;
+		if ((queue_flags & VK_QUEUE_COMPUTE_BIT) && !(queue_flags & VK_QUEUE_GRAPHICS_BIT))
+		{
+			return queues[queue_family_index][0];
+		}
+	}
+
+	for (auto &queue : queues[graphics_queue.get_family_index()])
+	{
+		if (queue.get_handle() != graphics_queue.get_handle() && (queue.get_properties().queueFlags & VK_QUEUE_COMPUTE_BIT))
+		{
+			return queue;
+		}
+	}
+
+	return graphics_queue;
+}
+
 void Device::copy_buffer(vkb::core::BufferC &src, vkb::core::BufferC &dst, VkQueue queue, VkBufferCopy *copy_region)
 {
 	assert(dst.get_size() <= src.get_size());
@@ -498,7 +627,11 @@ void Device::flush_command_buffer(VkCommandBuffer command_buffer, VkQueue queue,
 	VK_CHECK(vkCreateFence(get_handle(), &fence_info, nullptr, &fence));
 
 	// Submit to the queue
-	VkResult result = vkQueueSubmit(queue, 1, &submit_info, fence);
+	VkResult result;
+	{
+		std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
+		result = vkQueueSubmit(queue, 1, &submit_info, fence);
+	}
 	// Wait for the fence to signal that command buffer has finished executing
 	VK_CHECK(vkWaitForFences(get_handle(), 1, &fence, VK_TRUE, DEFAULT_FENCE_TIMEOUT));
 
@@ -527,7 +660,7 @@ void Device::create_internal_fence_pool()
 
 void Device::create_internal_command_pool()
 {
-	command_pool = std::make_unique<CommandPool>(*this, get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0).get_family_index());
+	command_pool = std::make_unique<CommandPool>(*this, get_compute_queue().get_family_index());
 }
 
 void Device::prepare_memory_allocator()
@@ -547,6 +680,7 @@ VkFence Device::request_fence() const
 
 VkResult Device::wait_idle() const
 {
+	std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
 	return vkDeviceWaitIdle(get_handle());
 }
 
@@ -554,4 +688,237 @@ ResourceCache &Device::get_resource_cache()
 {
 	return resource_cache;
 }
+
+DeferredDestructionQueue &Device::get_deferred_destruction_queue()
+{
+	return *deferred_destruction_queue;
+}
+
+bool Device::enable_descriptor_buffers()
+{
+	if (!is_enabled(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) || !is_enabled(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME))
+	{
+		LOGW("Descriptor buffers need {} and {}, descriptor sets are allocated from pools", VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME, VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+		return false;
+	}
+
+	VkPhysicalDeviceProperties2KHR properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &descriptor_buffer_properties;
+	vkGetPhysicalDeviceProperties2KHR(gpu.get_handle(), &properties);
+	descriptor_buffer_properties.pNext = nullptr;
+
+	descriptor_buffers = true;
+
+	return true;
+}
+
+bool Device::uses_descriptor_buffers() const
+{
+	return descriptor_buffers;
+}
+
+const VkPhysicalDeviceDescriptorBufferPropertiesEXT &Device::get_descriptor_buffer_properties() const
+{
+	return descriptor_buffer_properties;
+}
+
+bool Device::enable_graphics_pipeline_libraries()
+{
+	if (!is_enabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) || !is_enabled(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME))
+	{
+		LOGW("Graphics pipeline libraries need {} and {}, pipelines are created monolithic", VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+		return false;
+	}
+
+	VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT library_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT};
+
+	VkPhysicalDeviceProperties2KHR properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &library_properties;
+	vkGetPhysicalDeviceProperties2KHR(gpu.get_handle(), &properties);
+
+	// Without fast linking, linking the libraries on a miss costs as much as creating the pipeline
+	if (!library_properties.graphicsPipelineLibraryFastLinking)
+	{
+		LOGW("The driver doesn't link graphics pipeline libraries fast, pipelines are created monolithic");
+		return false;
+	}
+
+	graphics_pipeline_libraries = true;
+
+	return true;
+}
+
+bool Device::uses_graphics_pipeline_libraries() const
+{
+	return graphics_pipeline_libraries;
+}
+
+bool Device::enable_shader_objects()
+{
+	if (!is_enabled(VK_EXT_SHADER_OBJECT_EXTENSION_NAME))
+	{
+		LOGW("Shader objects need {}, pipelines are bound", VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+		return false;
+	}
+
+	shader_objects = true;
+
+	return true;
+}
+
+bool Device::uses_shader_objects() const
+{
+	return shader_objects;
+}
+
+bool Device::enable_dynamic_rendering()
+{
+	if (!is_enabled(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+	{
+		LOGW("Dynamic rendering needs {}, render passes are used", VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+		return false;
+	}
+
+	dynamic_rendering = true;
+
+	// The feature is only enabled if it was requested before the device creation
+	if (is_enabled(VK_KHR_DYNAMIC_RENDERING_LOCAL_READ_EXTENSION_NAME))
+	{
+		auto features = gpu.get_requested_extension_features<VkPhysicalDeviceDynamicRenderingLocalReadFeaturesKHR>(
+		    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_LOCAL_READ_FEATURES_KHR);
+		dynamic_rendering_local_read = features && features->dynamicRenderingLocalRead;
+	}
+
+	if (!dynamic_rendering_local_read)
+	{
+		LOGW("Dynamic rendering can't read input attachments without {}, the render pipelines reading them keep a render pass",
+		     VK_KHR_DYNAMIC_RENDERING_LOCAL_READ_EXTENSION_NAME);
+	}
+
+	return true;
+}
+
+bool Device::uses_dynamic_rendering() const
+{
+	return dynamic_rendering;
+}
+
+bool Device::uses_dynamic_rendering_local_read() const
+{
+	return dynamic_rendering_local_read;
+}
+
+uint32_t Device::enable_extended_dynamic_state()
+{
+	dynamic_pipeline_state = DynamicPipelineState::None;
+
+	// The features are only enabled if they were requested before the device creation
+	if (is_enabled(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME))
+	{
+		auto features = gpu.get_requested_extension_features<VkPhysicalDeviceExtendedDynamicStateFeaturesEXT>(
+		    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT);
+		if (features && features->extendedDynamicState)
+		{
+			dynamic_pipeline_state |= DynamicPipelineState::PrimitiveTopology | DynamicPipelineState::CullMode |
+			                          DynamicPipelineState::FrontFace | DynamicPipelineState::DepthStencil;
+		}
+	}
+
+	if (is_enabled(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME))
+	{
+		auto features = gpu.get_requested_extension_features<VkPhysicalDeviceExtendedDynamicState2FeaturesEXT>(
+		    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT);
+		if (features && features->extendedDynamicState2)
+		{
+			dynamic_pipeline_state |= DynamicPipelineState::PrimitiveRestart | DynamicPipelineState::RasterizerDiscard |
+			                          DynamicPipelineState::DepthBiasEnable;
+		}
+		if (features && features->extendedDynamicState2LogicOp)
+		{
+			dynamic_pipeline_state |= DynamicPipelineState::LogicOp;
+		}
+	}
+
+	if (is_enabled(VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME))
+	{
+		auto features = gpu.get_requested_extension_features<VkPhysicalDeviceVertexInputDynamicStateFeaturesEXT>(
+		    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_INPUT_DYNAMIC_STATE_FEATURES_EXT);
+		if (features && features->vertexInputDynamicState)
+		{
+			dynamic_pipeline_state |= DynamicPipelineState::VertexInput;
+		}
+	}
+
+	if (is_enabled(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+	{
+		auto features = gpu.get_requested_extension_features<VkPhysicalDeviceExtendedDynamicState3FeaturesEXT>(
+		    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT);
+		if (features)
+		{
+			// The sample count stays in the pipeline, it has to match the attachments of the render pass anyway
+			const std::pair<VkBool32, uint32_t> states[] = {
+			    {features->extendedDynamicState3PolygonMode, DynamicPipelineState::PolygonMode},
+			    {features->extendedDynamicState3DepthClampEnable, DynamicPipelineState::DepthClamp},
+			    {features->extendedDynamicState3SampleMask, DynamicPipelineState::SampleMask},
+			    {features->extendedDynamicState3AlphaToCoverageEnable, DynamicPipelineState::AlphaToCoverage},
+			    {features->extendedDynamicState3AlphaToOneEnable, DynamicPipelineState::AlphaToOne},
+			    {features->extendedDynamicState3LogicOpEnable, DynamicPipelineState::LogicOpEnable},
+			    {features->extendedDynamicState3ColorBlendEnable, DynamicPipelineState::ColorBlendEnable},
+			    {features->extendedDynamicState3ColorBlendEquation, DynamicPipelineState::ColorBlendEquation},
+			    {features->extendedDynamicState3ColorWriteMask, DynamicPipelineState::ColorWriteMask}};
+
+			for (auto &state : states)
+			{
+				if (state.first)
+				{
+					dynamic_pipeline_state |= state.second;
+				}
+			}
+		}
+	}
+
+	if (dynamic_pipeline_state == DynamicPipelineState::None)
+	{
+		LOGW("Extended dynamic state needs {}, {}, {} or {} with their features, the pipeline state is static",
+		     VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME, VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME,
+		     VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME, VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME);
+	}
+
+	return dynamic_pipeline_state;
+}
+
+uint32_t Device::get_dynamic_pipeline_state() const
+{
+	return dynamic_pipeline_state;
+}
+
+bool Device::set_image_compression_policy(const ImageCompressionPolicy &policy)
+{
+	// The feature is only enabled if it was requested before the device creation
+	auto features = gpu.get_requested_extension_features<VkPhysicalDeviceImageCompressionControlFeaturesEXT>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_COMPRESSION_CONTROL_FEATURES_EXT);
+	if (!is_enabled(VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME) || !features || !features->imageCompressionControl)
+	{
+		LOGW("Controlling the compression of the attachments needs {}, they keep the default compression", VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME);
+		return false;
+	}
+
+	image_compression_policy = policy;
+
+	LOGI("Attachment compression: color {}, depth stencil {}",
+	     image_compression_flags_to_string(policy.color.flags),
+	     image_compression_flags_to_string(policy.depth_stencil.flags));
+
+	return true;
+}
+
+const ImageCompressionPolicy &Device::get_image_compression_policy() const
+{
+	return image_compression_policy;
+}
+
+uint32_t Device::get_physical_device_count() const
+{
+	return physical_device_count;
+}
 }        // namespace vkb
@@ -36,6 +36,7 @@
 #include "core/swapchain.h"
 #include "core/util/logging.hpp"
 #include "core/vulkan_resource.h"
+#include "deferred_destruction_queue.h"
 #include "fence_pool.h"
 #include "rendering/pipeline_state.h"
 #include "rendering/render_target.h"
@@ -53,6 +54,12 @@ struct DriverVersion
 class Device : public vkb::core::VulkanResourceC<VkDevice>
 {
   public:
+	/// Priority of the queues, but the first graphics queue when it has a high priority
+	static constexpr float DefaultQueuePriority = 0.5f;
+
+	/// Priority of the queues of transfer only families
+	static constexpr float TransferQueuePriority = 0.25f;
+
 	/**
 	 * @brief Device constructor
 	 * @param gpu A valid Vulkan physical device and the requested gpu features
@@ -126,6 +133,30 @@ class Device : public vkb::core::VulkanResourceC<VkDevice>
 	 */
 	const Queue &get_suitable_graphics_queue() const;
 
+	/**
+	 * @brief Finds the queue for uploads, so they don't take time from the graphics queue
+	 * @return The first queue of a transfer only family, otherwise the compute queue
+	 */
+	const Queue &get_transfer_queue() const;
+
+	/**
+	 * @brief Finds the queue for compute work, also on devices without graphics queues
+	 * @return The first queue of a family with graphics and compute, otherwise the first queue of a compute family
+	 */
+	const Queue &get_compute_queue() const;
+
+	/**
+	 * @return Whether the device has a queue family supporting graphics, compute-only accelerators don't
+	 */
+	bool has_graphics_queue() const;
+
+	/**
+	 * @brief Finds the queue for compute work running beside the graphics queue
+	 * @return The first queue of a compute family without graphics, otherwise another queue of the graphics family,
+	 *         otherwise the graphics queue
+	 */
+	const Queue &get_async_compute_queue() const;
+
 	bool is_extension_supported(const std::string &extension) const;
 
 	bool is_enabled(const char *extension) const;
@@ -172,6 +203,7 @@ class Device : public vkb::core::VulkanResourceC<VkDevice>
 
 	/**
 	 * @brief Submits and frees up a given command buffer
+	 *        Waits for the commands on the CPU, uploads of buffer and image data should go through an UploadContext instead.
 	 * @param command_buffer The command buffer
 	 * @param queue The queue to submit the work to
 	 * @param free Whether the command buffer should be implicitly freed up
@@ -212,6 +244,98 @@ class Device : public vkb::core::VulkanResourceC<VkDevice>
 
 	ResourceCache &get_resource_cache();
 
+	/**
+	 * @brief Resources replaced while frames are in flight are retired here instead of waiting for the device to be idle
+	 */
+	DeferredDestructionQueue &get_deferred_destruction_queue();
+
+	/**
+	 * @brief Switches the framework to VK_EXT_descriptor_buffer: descriptor set layouts and pipelines created
+	 *        afterwards use descriptor buffers, and render frames write descriptors into per-frame buffers
+	 *        instead of allocating descriptor sets. Must be called before the render context is created.
+	 *        VK_EXT_descriptor_buffer and VK_KHR_buffer_device_address need to be enabled, with their
+	 *        descriptorBuffer and bufferDeviceAddress features requested.
+	 * @return True if descriptor buffers are used, false if the extensions are not enabled
+	 */
+	bool enable_descriptor_buffers();
+
+	bool uses_descriptor_buffers() const;
+
+	const VkPhysicalDeviceDescriptorBufferPropertiesEXT &get_descriptor_buffer_properties() const;
+
+	/**
+	 * @brief Switches the resource cache to VK_EXT_graphics_pipeline_library: graphics pipelines are fast-linked from
+	 *        libraries cached per part of their state, see ResourceCache::RequestGraphicsPipeline.
+	 *        VK_EXT_graphics_pipeline_library and VK_KHR_pipeline_library need to be enabled, with the
+	 *        graphicsPipelineLibrary feature requested.
+	 * @return True if libraries are used, false if the extensions are not enabled or the driver can't link them fast
+	 */
+	bool enable_graphics_pipeline_libraries();
+
+	bool uses_graphics_pipeline_libraries() const;
+
+	/**
+	 * @brief Switches the command buffers to VK_EXT_shader_object: instead of pipelines, they bind a shader object per stage
+	 *        and set the whole tracked pipeline state dynamically, so that no pipeline is created when the state changes,
+	 *        see CommandBuffer::flush. VK_EXT_shader_object needs to be enabled with its shaderObject feature requested.
+	 * @return True if shader objects are used, false if the extension is not enabled
+	 */
+	bool enable_shader_objects();
+
+	bool uses_shader_objects() const;
+
+	/**
+	 * @brief Switches the render pipelines to VK_KHR_dynamic_rendering: CommandBuffer::begin_render_pass begins a rendering
+	 *        instance from the views of the render target instead of requesting a render pass and a framebuffer, and
+	 *        graphics pipelines are created from the attachment formats. With VK_KHR_dynamic_rendering_local_read, all
+	 *        the subpasses are recorded in a single instance and read the attachments written before as input attachments.
+	 *        Without it, each subpass gets its own instance, and the subpasses with input attachments keep a render pass.
+	 *        VK_KHR_dynamic_rendering needs to be enabled with its dynamicRendering feature requested, and
+	 *        VK_KHR_dynamic_rendering_local_read with its dynamicRenderingLocalRead feature to read the attachments.
+	 * @return True if dynamic rendering is used, false if the extension is not enabled
+	 */
+	bool enable_dynamic_rendering();
+
+	bool uses_dynamic_rendering() const;
+
+	/**
+	 * @return Whether the dynamic rendering instances support input attachments, see enable_dynamic_rendering
+	 */
+	bool uses_dynamic_rendering_local_read() const;
+
+	/**
+	 * @brief Makes the members of the pipeline state covered by VK_EXT_extended_dynamic_state, VK_EXT_extended_dynamic_state2,
+	 *        VK_EXT_extended_dynamic_state3 and VK_EXT_vertex_input_dynamic_state dynamic: graphics pipelines are created
+	 *        with these dynamic states enabled and left out of the pipeline hash, and the command buffers set them at flush time.
+	 *        Only the states whose feature was requested when the device was created are made dynamic.
+	 * @return The DynamicPipelineState flags of the members made dynamic, none if the extensions are not enabled
+	 */
+	uint32_t enable_extended_dynamic_state();
+
+	/**
+	 * @return The DynamicPipelineState flags of the members set dynamically on graphics pipelines
+	 */
+	uint32_t get_dynamic_pipeline_state() const;
+
+	/**
+	 * @brief Sets the compression of the color and depth stencil attachment images created from now on, like the images of
+	 *        the render targets. Images whose create info already chains a VkImageCompressionControlEXT keep it, and the
+	 *        swapchain images keep theirs. The render targets of a render context follow a new policy once it recreates them.
+	 *        Fixed-rate compression trades quality for bandwidth, whose effect StatIndex::gpu_ext_write_bytes shows.
+	 *        VK_EXT_image_compression_control needs to be enabled with its imageCompressionControl feature requested.
+	 * @return True if the policy is applied, false if the extension is not enabled
+	 */
+	bool set_image_compression_policy(const ImageCompressionPolicy &policy);
+
+	const ImageCompressionPolicy &get_image_compression_policy() const;
+
+	/**
+	 * @brief The device spans the GPUs of the device group of its GPU when Instance::use_device_group is set,
+	 *        and VK_KHR_device_group_creation and VK_KHR_device_group are available
+	 * @return The number of GPUs the device spans, their device indices go from 0 to the count - 1
+	 */
+	uint32_t get_physical_device_count() const;
+
   private:
 	const PhysicalDevice &gpu;
 
@@ -230,5 +354,25 @@ class Device : public vkb::core::VulkanResourceC<VkDevice>
 	std::unique_ptr<FencePool> fence_pool;
 
 	ResourceCache resource_cache;
+
+	bool descriptor_buffers{false};
+
+	VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT};
+
+	bool graphics_pipeline_libraries{false};
+
+	bool shader_objects{false};
+
+	uint32_t dynamic_pipeline_state{0};
+
+	bool dynamic_rendering{false};
+
+	bool dynamic_rendering_local_read{false};
+
+	ImageCompressionPolicy image_compression_policy{};
+
+	std::unique_ptr<DeferredDestructionQueue> deferred_destruction_queue;
+
+	uint32_t physical_device_count{1};
 };
 }        // namespace vkb
@@ -0,0 +1,209 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/dynamic_top_level_acceleration_structure.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#include "core/device.h"
+
+namespace vkb
+{
+namespace core
+{
+namespace
+{
+glm::vec3 get_position(const VkAccelerationStructureInstanceKHR &instance)
+{
+	return {instance.transform.matrix[0][3], instance.transform.matrix[1][3], instance.transform.matrix[2][3]};
+}
+
+/**
+ * @return Whether the fields of the instances other than their transforms are equal
+ */
+bool is_refittable(const VkAccelerationStructureInstanceKHR &lhs, const VkAccelerationStructureInstanceKHR &rhs)
+{
+	constexpr size_t offset = sizeof(VkTransformMatrixKHR);
+	return std::memcmp(reinterpret_cast<const uint8_t *>(&lhs) + offset,
+	                   reinterpret_cast<const uint8_t *>(&rhs) + offset,
+	                   sizeof(VkAccelerationStructureInstanceKHR) - offset) == 0;
+}
+}        // namespace
+
+DynamicTopLevelAccelerationStructure::DynamicTopLevelAccelerationStructure(Device                              &device,
+                                                                           uint32_t                             frames_in_flight,
+                                                                           VkBuildAccelerationStructureFlagsKHR flags,
+                                                                           uint32_t                             max_refit_count,
+                                                                           float                                max_displacement) :
+    device{device},
+    flags{flags | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR},
+    max_refit_count{max_refit_count},
+    max_displacement{max_displacement},
+    instance_buffers(frames_in_flight)
+{
+	VkPhysicalDeviceAccelerationStructurePropertiesKHR acceleration_structure_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR};
+	VkPhysicalDeviceProperties2KHR                     properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &acceleration_structure_properties;
+	vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+	scratch_alignment = std::max<VkDeviceSize>(acceleration_structure_properties.minAccelerationStructureScratchOffsetAlignment, 1);
+}
+
+bool DynamicTopLevelAccelerationStructure::update(VkCommandBuffer command_buffer, uint32_t frame_index, const std::vector<VkAccelerationStructureInstanceKHR> &instances)
+{
+	assert(frame_index < instance_buffers.size());
+
+	auto &deferred_destruction_queue = device.get_deferred_destruction_queue();
+
+	auto previous_handle = get_handle();
+	auto instance_count  = to_u32(instances.size());
+
+	// The buffer of the previous frame of this index is no longer read by the GPU
+	auto  instances_size  = std::max<VkDeviceSize>(instances.size() * sizeof(VkAccelerationStructureInstanceKHR), sizeof(VkAccelerationStructureInstanceKHR));
+	auto &instance_buffer = instance_buffers[frame_index];
+	if (!instance_buffer || instance_buffer->get_size() < instances_size)
+	{
+		if (instance_buffer)
+		{
+			deferred_destruction_queue.retire(std::move(instance_buffer));
+		}
+		instance_buffer = vkb::core::BufferBuilderC(instances_size)
+		                      .with_usage(VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+		                      .with_vma_usage(VMA_MEMORY_USAGE_CPU_TO_GPU)
+		                      .with_vma_flags(VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT)
+		                      .build_unique(device);
+		instance_buffer->set_debug_name("Dynamic TLAS: instances of frame " + std::to_string(frame_index));
+	}
+	instance_buffer->update(instances.data(), instances.size() * sizeof(VkAccelerationStructureInstanceKHR));
+
+	bool rebuild = !acceleration_structure || needs_rebuild(instances);
+
+	// The frames in flight may still trace the structure, it is only replaced when its buffer is too small
+	if (instance_count > capacity || !acceleration_structure)
+	{
+		if (acceleration_structure)
+		{
+			deferred_destruction_queue.retire(std::move(acceleration_structure));
+		}
+		acceleration_structure = std::make_unique<AccelerationStructure>(device, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR);
+		instance_geometry      = acceleration_structure->add_instance_geometry(instance_buffer, instance_count);
+		capacity               = instance_count;
+	}
+	else
+	{
+		acceleration_structure->update_instance_geometry(instance_geometry, instance_buffer, instance_count);
+	}
+
+	auto scratch_size = acceleration_structure->prepare_build(flags, rebuild ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR);
+
+	// The scratch buffer is shared by the frames, their builds are ordered by the barrier below
+	if (!scratch_buffer || scratch_buffer->get_size() < scratch_size + scratch_alignment)
+	{
+		if (scratch_buffer)
+		{
+			deferred_destruction_queue.retire(std::move(scratch_buffer));
+		}
+		scratch_buffer = std::make_unique<vkb::core::BufferC>(device,
+		                                                      scratch_size + scratch_alignment,
+		                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+		                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+		scratch_buffer->set_debug_name("Dynamic TLAS: scratch");
+	}
+	auto scratch_address = (scratch_buffer->get_device_address() + scratch_alignment - 1) / scratch_alignment * scratch_alignment;
+
+	// The structure and the scratch memory are written after the traces and the build of the previous frames
+	VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+	barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	vkCmdPipelineBarrier(command_buffer,
+	                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+	                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+	                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	acceleration_structure->record_build(command_buffer, scratch_address);
+
+	barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+	vkCmdPipelineBarrier(command_buffer,
+	                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+	                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+	                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	if (rebuild)
+	{
+		built_instances = instances;
+		refit_count     = 0;
+		stats.rebuild_count++;
+
+		glm::vec3 min{std::numeric_limits<float>::max()};
+		glm::vec3 max{std::numeric_limits<float>::lowest()};
+		for (auto &instance : instances)
+		{
+			min = glm::min(min, get_position(instance));
+			max = glm::max(max, get_position(instance));
+		}
+		built_extent = instances.empty() ? 0.0f : glm::length(max - min);
+	}
+	else
+	{
+		refit_count++;
+		stats.refit_count++;
+	}
+
+	return get_handle() != previous_handle;
+}
+
+VkAccelerationStructureKHR DynamicTopLevelAccelerationStructure::get_handle() const
+{
+	return acceleration_structure ? acceleration_structure->get_handle() : VK_NULL_HANDLE;
+}
+
+uint64_t DynamicTopLevelAccelerationStructure::get_device_address() const
+{
+	return acceleration_structure ? acceleration_structure->get_device_address() : 0;
+}
+
+const DynamicTopLevelAccelerationStructure::Stats &DynamicTopLevelAccelerationStructure::get_stats() const
+{
+	return stats;
+}
+
+bool DynamicTopLevelAccelerationStructure::needs_rebuild(const std::vector<VkAccelerationStructureInstanceKHR> &instances) const
+{
+	if (instances.size() != built_instances.size() || refit_count >= max_refit_count)
+	{
+		return true;
+	}
+
+	float displacement = 0.0f;
+	for (size_t i = 0; i < instances.size(); ++i)
+	{
+		if (!is_refittable(instances[i], built_instances[i]))
+		{
+			return true;
+		}
+		displacement += glm::length(get_position(instances[i]) - get_position(built_instances[i]));
+	}
+
+	// Instances spread over a point can't be compared to their extent, any motion degrades the structure
+	return !instances.empty() && displacement / instances.size() > max_displacement * std::max(built_extent, 1e-3f);
+}
+}        // namespace core
+}        // namespace vkb
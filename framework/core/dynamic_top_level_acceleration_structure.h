@@ -0,0 +1,139 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/acceleration_structure.h"
+#include "core/buffer.h"
+
+namespace vkb
+{
+class Device;
+
+namespace core
+{
+/**
+ * @brief A top-level acceleration structure whose instances are streamed every frame
+ *
+ * The instances are written to a persistently mapped buffer of the frame in flight, and the build is recorded
+ * into the command buffer of the frame, so updating the structure never waits for the queue.
+ *
+ * When only the transforms of the instances changed since the last full build, the structure is refitted in place.
+ * It is rebuilt when the instance count or any other field of an instance changed, or when the refits likely
+ * degraded its quality: after a number of refits, or once the instances moved far from where they were when it
+ * was built, relative to the extent of the instances then.
+ */
+class DynamicTopLevelAccelerationStructure
+{
+  public:
+	/// Refits after which the structure is rebuilt
+	static constexpr uint32_t DefaultMaxRefitCount = 120;
+
+	/// Mean displacement of the instances since the last build, relative to their extent then, after which the structure is rebuilt
+	static constexpr float DefaultMaxDisplacement = 0.1f;
+
+	struct Stats
+	{
+		uint32_t rebuild_count{0};
+
+		uint32_t refit_count{0};
+	};
+
+	/**
+	 * @param device A valid Vulkan device
+	 * @param frames_in_flight Number of frames which may be in flight, each getting an instance buffer of its own
+	 * @param flags Build flags, VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR is always added
+	 * @param max_refit_count Refits after which the structure is rebuilt
+	 * @param max_displacement Relative displacement of the instances after which the structure is rebuilt
+	 */
+	DynamicTopLevelAccelerationStructure(Device                              &device,
+	                                     uint32_t                             frames_in_flight,
+	                                     VkBuildAccelerationStructureFlagsKHR flags            = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
+	                                     uint32_t                             max_refit_count  = DefaultMaxRefitCount,
+	                                     float                                max_displacement = DefaultMaxDisplacement);
+
+	DynamicTopLevelAccelerationStructure(const DynamicTopLevelAccelerationStructure &) = delete;
+
+	DynamicTopLevelAccelerationStructure(DynamicTopLevelAccelerationStructure &&) = delete;
+
+	~DynamicTopLevelAccelerationStructure() = default;
+
+	DynamicTopLevelAccelerationStructure &operator=(const DynamicTopLevelAccelerationStructure &) = delete;
+
+	DynamicTopLevelAccelerationStructure &operator=(DynamicTopLevelAccelerationStructure &&) = delete;
+
+	/**
+	 * @brief Writes the instances of a frame and records the refit or the rebuild of the structure
+	 *        The build is followed by a barrier making the structure visible to the commands recorded after it.
+	 * @param command_buffer Command buffer of the frame
+	 * @param frame_index Index of the frame in flight, the submissions of the previous frame of that index must be complete
+	 * @param instances The instances of the frame
+	 * @return Whether the handle of the structure changed, the descriptors referencing it must then be rewritten
+	 */
+	bool update(VkCommandBuffer command_buffer, uint32_t frame_index, const std::vector<VkAccelerationStructureInstanceKHR> &instances);
+
+	VkAccelerationStructureKHR get_handle() const;
+
+	uint64_t get_device_address() const;
+
+	const Stats &get_stats() const;
+
+  private:
+	/**
+	 * @return Whether the instances can't be refitted from the ones of the last build, or the refit would degrade the structure too much
+	 */
+	bool needs_rebuild(const std::vector<VkAccelerationStructureInstanceKHR> &instances) const;
+
+	Device &device;
+
+	VkBuildAccelerationStructureFlagsKHR flags;
+
+	uint32_t max_refit_count;
+
+	float max_displacement;
+
+	VkDeviceSize scratch_alignment{1};
+
+	std::unique_ptr<AccelerationStructure> acceleration_structure;
+
+	uint64_t instance_geometry{0};
+
+	/// Instance count the buffer of the structure was sized for, the structure is replaced when it grows beyond it
+	uint32_t capacity{0};
+
+	/// Persistently mapped instances of each frame in flight
+	std::vector<std::unique_ptr<vkb::core::BufferC>> instance_buffers;
+
+	std::unique_ptr<vkb::core::BufferC> scratch_buffer;
+
+	/// Instances of the last full build
+	std::vector<VkAccelerationStructureInstanceKHR> built_instances;
+
+	/// Length of the diagonal of the bounds of the instance positions of the last full build
+	float built_extent{0.0f};
+
+	uint32_t refit_count{0};
+
+	Stats stats;
+};
+}        // namespace core
+}        // namespace vkb
@@ -42,6 +42,12 @@ Framebuffer::Framebuffer(Device &device, const RenderTarget &render_target, cons
 		attachments.emplace_back(view.get_handle());
 	}
 
+	// The render passes of the render target have the shading rate attachment after its own attachments
+	if (auto shading_rate_view = render_target.get_shading_rate_view())
+	{
+		attachments.emplace_back(shading_rate_view->get_handle());
+	}
+
 	VkFramebufferCreateInfo create_info{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
 
 	create_info.renderPass      = render_pass.get_handle();
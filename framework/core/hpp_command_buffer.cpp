@@ -20,18 +20,74 @@
 #include <core/hpp_command_pool.h>
 #include <core/hpp_device.h>
 #include <core/hpp_pipeline.h>
+#include <core/util/profiling.hpp>
 #include <rendering/hpp_render_frame.h>
 
 namespace vkb
 {
 namespace core
 {
+namespace
+{
+/**
+ * @brief Gets the subresources of a view a barrier applies to, with both aspects of depth stencil formats
+ */
+vk::ImageSubresourceRange get_barrier_range(const vkb::core::HPPImageView &image_view)
+{
+	auto subresource_range = image_view.get_subresource_range();
+	auto format            = image_view.get_format();
+	if (vkb::common::is_depth_only_format(format))
+	{
+		subresource_range.aspectMask = vk::ImageAspectFlagBits::eDepth;
+	}
+	else if (vkb::common::is_depth_stencil_format(format))
+	{
+		subresource_range.aspectMask = vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+	}
+	return subresource_range;
+}
+
+/**
+ * @brief Sets the tracked states of the attachments of a render target after a render pass, see vkb::CommandBuffer
+ */
+void set_attachment_states(const vkb::rendering::HPPRenderTarget &render_target, const std::vector<vk::ImageLayout> &final_layouts)
+{
+	auto &attachments = render_target.get_attachments();
+	auto &views       = render_target.get_views();
+
+	for (size_t i = 0; i < views.size(); ++i)
+	{
+		vkb::core::ResourceState state{static_cast<VkImageLayout>(final_layouts[i])};
+		if (attachments[i].usage & vk::ImageUsageFlagBits::eFragmentShadingRateAttachmentKHR)
+		{
+			state.stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+		}
+		else if (vkb::common::is_depth_format(attachments[i].format))
+		{
+			state.stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR |
+			               VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR;
+			state.access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR;
+		}
+		else
+		{
+			state.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR;
+			state.access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR;
+		}
+
+		views[i].get_image().get_state_tracker().set_state(static_cast<VkImageSubresourceRange>(get_barrier_range(views[i])), state);
+	}
+}
+}        // namespace
+
 HPPCommandBuffer::HPPCommandBuffer(vkb::core::HPPCommandPool &command_pool, vk::CommandBufferLevel level) :
     VulkanResource(nullptr, &command_pool.get_device()),
     level(level),
     command_pool(command_pool),
     max_push_constants_size(get_device().get_gpu().get_properties().limits.maxPushConstantsSize)
 {
+	auto synchronization2_features = get_device().get_gpu().get_requested_extension_features<vk::PhysicalDeviceSynchronization2FeaturesKHR>();
+	synchronization2 = get_device().is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) && synchronization2_features && synchronization2_features->synchronization2;
+
 	vk::CommandBufferAllocateInfo allocate_info(command_pool.get_handle(), level, 1);
 
 	set_handle(get_device().get_handle().allocateCommandBuffers(allocate_info).front());
@@ -49,7 +105,13 @@ HPPCommandBuffer::HPPCommandBuffer(HPPCommandBuffer &&other) :
     last_framebuffer_extent(std::exchange(other.last_framebuffer_extent, {})),
     last_render_area_extent(std::exchange(other.last_render_area_extent, {})),
     update_after_bind(std::exchange(other.update_after_bind, {})),
-    descriptor_set_layout_binding_state(std::exchange(other.descriptor_set_layout_binding_state, {}))
+    descriptor_set_layout_binding_state(std::exchange(other.descriptor_set_layout_binding_state, {})),
+    bound_descriptor_buffer(std::exchange(other.bound_descriptor_buffer, {})),
+    current_rendering(std::exchange(other.current_rendering, {})),
+    redundant_command_filter(std::exchange(other.redundant_command_filter, {})),
+    synchronization2(other.synchronization2),
+    pending_image_barriers(std::exchange(other.pending_image_barriers, {})),
+    pending_buffer_barriers(std::exchange(other.pending_buffer_barriers, {}))
 {
 }
 
@@ -80,8 +142,11 @@ vk::Result HPPCommandBuffer::begin(vk::CommandBufferUsageFlags flags, const vkb:
 	// Reset state
 	pipeline_state.reset();
 	resource_binding_state.reset();
-	descriptor_set_layout_binding_state.clear();
+	descriptor_set_layout_binding_state.fill(nullptr);
 	stored_push_constants.clear();
+	bound_descriptor_buffer = nullptr;
+	redundant_command_filter.reset();
+	redundant_command_filter.reset_skipped_command_count();
 
 	vk::CommandBufferBeginInfo       begin_info(flags);
 	vk::CommandBufferInheritanceInfo inheritance;
@@ -98,6 +163,13 @@ vk::Result HPPCommandBuffer::begin(vk::CommandBufferUsageFlags flags, const vkb:
 		inheritance.subpass     = subpass_index;
 
 		begin_info.pInheritanceInfo = &inheritance;
+
+		// Pipelines recorded here must match the subpass being continued
+		pipeline_state.set_subpass_index(subpass_index);
+
+		auto blend_state = pipeline_state.get_color_blend_state();
+		blend_state.attachments.resize(current_render_pass.render_pass->get_color_output_count(subpass_index));
+		pipeline_state.set_color_blend_state(blend_state);
 	}
 
 	get_handle().begin(begin_info);
@@ -118,7 +190,10 @@ void HPPCommandBuffer::begin_render_pass(const vkb::rendering::HPPRenderTarget
 	// Reset state
 	pipeline_state.reset();
 	resource_binding_state.reset();
-	descriptor_set_layout_binding_state.clear();
+	descriptor_set_layout_binding_state.fill(nullptr);
+
+	// Barriers can't be recorded in the render pass
+	flush_barriers();
 
 	auto &render_pass = get_render_pass(render_target, load_store_infos, subpasses);
 	auto &framebuffer = get_device().get_resource_cache().request_framebuffer(render_target, render_pass);
@@ -132,8 +207,11 @@ void HPPCommandBuffer::begin_render_pass(const vkb::rendering::HPPRenderTarget &
                                          const std::vector<vk::ClearValue>     &clear_values,
                                          vk::SubpassContents                    contents)
 {
-	current_render_pass.render_pass = &render_pass;
-	current_render_pass.framebuffer = &framebuffer;
+	flush_barriers();
+
+	current_render_pass.render_pass   = &render_pass;
+	current_render_pass.framebuffer   = &framebuffer;
+	current_render_pass.render_target = &render_target;
 
 	// Begin render pass
 	vk::RenderPassBeginInfo begin_info(
@@ -179,8 +257,18 @@ void HPPCommandBuffer::bind_image(const vkb::core::HPPImageView &image_view, uin
 	resource_binding_state.bind_image(image_view, set, binding, array_element);
 }
 
+void HPPCommandBuffer::bind_descriptor_set(uint32_t set, vk::DescriptorSet descriptor_set, vk::PipelineBindPoint pipeline_bind_point)
+{
+	get_handle().bindDescriptorSets(pipeline_bind_point, pipeline_state.get_pipeline_layout().get_handle(), set, descriptor_set, {});
+}
+
 void HPPCommandBuffer::bind_index_buffer(const vkb::core::BufferCpp &buffer, vk::DeviceSize offset, vk::IndexType index_type)
 {
+	if (!redundant_command_filter.update_index_buffer(static_cast<VkBuffer>(buffer.get_handle()), offset, static_cast<VkIndexType>(index_type)))
+	{
+		return;
+	}
+
 	get_handle().bindIndexBuffer(buffer.get_handle(), offset, index_type);
 }
 
@@ -209,11 +297,20 @@ void HPPCommandBuffer::bind_vertex_buffers(uint32_t
 {
 	std::vector<vk::Buffer> buffer_handles(buffers.size(), nullptr);
 	std::transform(buffers.begin(), buffers.end(), buffer_handles.begin(), [](const vkb::core::BufferCpp &buffer) { return buffer.get_handle(); });
+
+	if (!redundant_command_filter.update_vertex_buffers(
+	        first_binding, to_u32(buffer_handles.size()), reinterpret_cast<const VkBuffer *>(buffer_handles.data()), reinterpret_cast<const VkDeviceSize *>(offsets.data())))
+	{
+		return;
+	}
+
 	get_handle().bindVertexBuffers(first_binding, buffer_handles, offsets);
 }
 
 void HPPCommandBuffer::blit_image(const vkb::core::HPPImage &src_img, const vkb::core::HPPImage &dst_img, const std::vector<vk::ImageBlit> &regions)
 {
+	flush_barriers();
+
 	get_handle().blitImage(
 	    src_img.get_handle(), vk::ImageLayout::eTransferSrcOptimal, dst_img.get_handle(), vk::ImageLayout::eTransferDstOptimal, regions, vk::Filter::eNearest);
 }
@@ -223,12 +320,18 @@ void HPPCommandBuffer::buffer_memory_barrier(const vkb::core::BufferCpp
                                              vk::DeviceSize                             size,
                                              const vkb::common::HPPBufferMemoryBarrier &memory_barrier)
 {
+	flush_barriers();
+
 	vk::BufferMemoryBarrier buffer_memory_barrier(memory_barrier.src_access_mask, memory_barrier.dst_access_mask, {}, {}, buffer.get_handle(), offset, size);
 
 	vk::PipelineStageFlags src_stage_mask = memory_barrier.src_stage_mask;
 	vk::PipelineStageFlags dst_stage_mask = memory_barrier.dst_stage_mask;
 
 	get_handle().pipelineBarrier(src_stage_mask, dst_stage_mask, {}, {}, buffer_memory_barrier, {});
+
+	buffer.get_state_tracker().set_state({VK_IMAGE_LAYOUT_UNDEFINED,
+	                                      static_cast<VkPipelineStageFlags2KHR>(static_cast<VkPipelineStageFlags>(memory_barrier.dst_stage_mask)),
+	                                      static_cast<VkAccessFlags2KHR>(static_cast<VkAccessFlags>(memory_barrier.dst_access_mask))});
 }
 
 void HPPCommandBuffer::clear(vk::ClearAttachment attachment, vk::ClearRect rect)
@@ -238,6 +341,8 @@ void HPPCommandBuffer::clear(vk::ClearAttachment attachment, vk::ClearRect rect)
 
 void HPPCommandBuffer::copy_buffer(const vkb::core::BufferCpp &src_buffer, const vkb::core::BufferCpp &dst_buffer, vk::DeviceSize size)
 {
+	flush_barriers();
+
 	vk::BufferCopy copy_region({}, {}, size);
 	get_handle().copyBuffer(src_buffer.get_handle(), dst_buffer.get_handle(), copy_region);
 }
@@ -246,11 +351,15 @@ void HPPCommandBuffer::copy_buffer_to_image(const vkb::core::BufferCpp
                                             const vkb::core::HPPImage              &image,
                                             const std::vector<vk::BufferImageCopy> &regions)
 {
+	flush_barriers();
+
 	get_handle().copyBufferToImage(buffer.get_handle(), image.get_handle(), vk::ImageLayout::eTransferDstOptimal, regions);
 }
 
 void HPPCommandBuffer::copy_image(const vkb::core::HPPImage &src_img, const vkb::core::HPPImage &dst_img, const std::vector<vk::ImageCopy> &regions)
 {
+	flush_barriers();
+
 	get_handle().copyImage(src_img.get_handle(), vk::ImageLayout::eTransferSrcOptimal, dst_img.get_handle(), vk::ImageLayout::eTransferDstOptimal, regions);
 }
 
@@ -259,17 +368,21 @@ void HPPCommandBuffer::copy_image_to_buffer(const vkb::core::HPPImage
                                             const vkb::core::BufferCpp             &buffer,
                                             const std::vector<vk::BufferImageCopy> &regions)
 {
+	flush_barriers();
+
 	get_handle().copyImageToBuffer(image.get_handle(), image_layout, buffer.get_handle(), regions);
 }
 
 void HPPCommandBuffer::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
 {
+	flush_barriers();
 	flush(vk::PipelineBindPoint::eCompute);
 	get_handle().dispatch(group_count_x, group_count_y, group_count_z);
 }
 
 void HPPCommandBuffer::dispatch_indirect(const vkb::core::BufferCpp &buffer, vk::DeviceSize offset)
 {
+	flush_barriers();
 	flush(vk::PipelineBindPoint::eCompute);
 	get_handle().dispatchIndirect(buffer.get_handle(), offset);
 }
@@ -292,8 +405,27 @@ void HPPCommandBuffer::draw_indexed_indirect(const vkb::core::BufferCpp &buffer,
 	get_handle().drawIndexedIndirect(buffer.get_handle(), offset, draw_count, stride);
 }
 
+void HPPCommandBuffer::draw_indexed_indirect_count(const vkb::core::BufferCpp &buffer,
+                                                   vk::DeviceSize              offset,
+                                                   const vkb::core::BufferCpp &count_buffer,
+                                                   vk::DeviceSize              count_offset,
+                                                   uint32_t                    max_draw_count,
+                                                   uint32_t                    stride)
+{
+	flush(vk::PipelineBindPoint::eGraphics);
+	get_handle().drawIndexedIndirectCountKHR(buffer.get_handle(), offset, count_buffer.get_handle(), count_offset, max_draw_count, stride);
+}
+
+void HPPCommandBuffer::draw_mesh_tasks(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+{
+	flush(vk::PipelineBindPoint::eGraphics);
+	get_handle().drawMeshTasksEXT(group_count_x, group_count_y, group_count_z);
+}
+
 vk::Result HPPCommandBuffer::end()
 {
+	flush_barriers();
+
 	get_handle().end();
 
 	return vk::Result::eSuccess;
@@ -307,11 +439,20 @@ void HPPCommandBuffer::end_query(const vkb::core::HPPQueryPool &query_pool, uint
 void HPPCommandBuffer::end_render_pass()
 {
 	get_handle().endRenderPass();
+
+	if (current_render_pass.render_target)
+	{
+		set_attachment_states(*current_render_pass.render_target, current_render_pass.render_pass->get_final_layouts());
+	}
 }
 
 void HPPCommandBuffer::execute_commands(HPPCommandBuffer &secondary_command_buffer)
 {
 	get_handle().executeCommands(secondary_command_buffer.get_handle());
+
+	// The state is undefined after secondary command buffers
+	redundant_command_filter.reset();
+	redundant_command_filter.add_skipped_commands(secondary_command_buffer.get_redundant_command_count());
 }
 
 void HPPCommandBuffer::execute_commands(std::vector<HPPCommandBuffer *> &secondary_command_buffers)
@@ -322,6 +463,26 @@ void HPPCommandBuffer::execute_commands(std::vector<HPPCommandBuffer *> &seconda
 	               sec_cmd_buf_handles.begin(),
 	               [](const vkb::core::HPPCommandBuffer *sec_cmd_buf) { return sec_cmd_buf->get_handle(); });
 	get_handle().executeCommands(sec_cmd_buf_handles);
+
+	// The state is undefined after secondary command buffers
+	redundant_command_filter.reset();
+	for (auto *secondary_command_buffer : secondary_command_buffers)
+	{
+		redundant_command_filter.add_skipped_commands(secondary_command_buffer->get_redundant_command_count());
+	}
+}
+
+void HPPCommandBuffer::flush_barriers()
+{
+	vkb::core::record_pipeline_barrier(static_cast<VkCommandBuffer>(get_handle()), synchronization2, pending_image_barriers, pending_buffer_barriers);
+
+	pending_image_barriers.clear();
+	pending_buffer_barriers.clear();
+}
+
+uint32_t HPPCommandBuffer::get_redundant_command_count() const
+{
+	return redundant_command_filter.get_skipped_command_count();
 }
 
 vkb::core::HPPRenderPass &HPPCommandBuffer::get_render_pass(const vkb::rendering::HPPRenderTarget                          &render_target,
@@ -343,25 +504,58 @@ vkb::core::HPPRenderPass &HPPCommandBuffer::get_render_pass(const vkb::rendering
 		subpass_info_it->depth_stencil_resolve_attachment = subpass->get_depth_stencil_resolve_attachment();
 		subpass_info_it->debug_name                       = subpass->get_debug_name();
 
+		if (subpass->get_use_shading_rate_attachment() && render_target.get_shading_rate_view())
+		{
+			subpass_info_it->shading_rate_attachment = render_target.get_shading_rate_attachment();
+			subpass_info_it->shading_rate_texel_size = render_target.get_shading_rate_texel_size();
+		}
+
+		// Subpasses writing attachments rendered through multisampled ones resolve into them, see vkb::RenderTarget
+		auto &output_attachments = subpass_info_it->output_attachments;
+		bool  multisampled       = !output_attachments.empty() && subpass_info_it->color_resolve_attachments.empty() &&
+		                    std::all_of(output_attachments.begin(), output_attachments.end(), [&render_target](uint32_t attachment) {
+			                    return render_target.get_multisampled_attachment(attachment) != VK_ATTACHMENT_UNUSED;
+		                    });
+		if (multisampled)
+		{
+			subpass_info_it->color_resolve_attachments = output_attachments;
+			for (auto &attachment : output_attachments)
+			{
+				attachment = render_target.get_multisampled_attachment(attachment);
+			}
+		}
+
+		if (subpass_info_it->depth_stencil_resolve_mode == vk::ResolveModeFlagBits::eNone && !subpass_info_it->disable_depth_stencil_attachment &&
+		    render_target.get_depth_stencil_resolve_attachment() != VK_ATTACHMENT_UNUSED)
+		{
+			subpass_info_it->depth_stencil_resolve_mode       = render_target.get_depth_stencil_resolve_mode();
+			subpass_info_it->depth_stencil_resolve_attachment = render_target.get_depth_stencil_resolve_attachment();
+		}
+
 		++subpass_info_it;
 	}
 
-	return get_device().get_resource_cache().request_render_pass(render_target.get_attachments(), load_store_infos, subpass_infos);
+	auto shading_rate_view = render_target.get_shading_rate_view();
+	if (!shading_rate_view)
+	{
+		return get_device().get_resource_cache().request_render_pass(render_target.get_attachments(), load_store_infos, subpass_infos);
+	}
+
+	// The shading rate attachment follows the attachments of the render target, as in its framebuffers
+	auto attachments = render_target.get_attachments();
+
+	vkb::rendering::HPPAttachment shading_rate_attachment{shading_rate_view->get_format(), vk::SampleCountFlagBits::e1, vk::ImageUsageFlagBits::eFragmentShadingRateAttachmentKHR};
+	shading_rate_attachment.initial_layout = vk::ImageLayout::eFragmentShadingRateAttachmentOptimalKHR;
+	attachments.push_back(shading_rate_attachment);
+
+	return get_device().get_resource_cache().request_render_pass(attachments, load_store_infos, subpass_infos);
 }
 
-void HPPCommandBuffer::image_memory_barrier(const vkb::core::HPPImageView &image_view, const vkb::common::HPPImageMemoryBarrier &memory_barrier) const
+void HPPCommandBuffer::image_memory_barrier(const vkb::core::HPPImageView &image_view, const vkb::common::HPPImageMemoryBarrier &memory_barrier)
 {
-	// Adjust barrier's subresource range for depth images
-	auto subresource_range = image_view.get_subresource_range();
-	auto format            = image_view.get_format();
-	if (vkb::common::is_depth_only_format(format))
-	{
-		subresource_range.aspectMask = vk::ImageAspectFlagBits::eDepth;
-	}
-	else if (vkb::common::is_depth_stencil_format(format))
-	{
-		subresource_range.aspectMask = vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
-	}
+	flush_barriers();
+
+	auto subresource_range = get_barrier_range(image_view);
 
 	vk::ImageMemoryBarrier image_memory_barrier(memory_barrier.src_access_mask,
 	                                            memory_barrier.dst_access_mask,
@@ -376,9 +570,14 @@ void HPPCommandBuffer::image_memory_barrier(const vkb::core::HPPImageView &image
 	vk::PipelineStageFlags dst_stage_mask = memory_barrier.dst_stage_mask;
 
 	get_handle().pipelineBarrier(src_stage_mask, dst_stage_mask, {}, {}, {}, image_memory_barrier);
+
+	image_view.get_image().get_state_tracker().set_state(static_cast<VkImageSubresourceRange>(subresource_range),
+	                                                     {static_cast<VkImageLayout>(memory_barrier.new_layout),
+	                                                      static_cast<VkPipelineStageFlags2KHR>(static_cast<VkPipelineStageFlags>(memory_barrier.dst_stage_mask)),
+	                                                      static_cast<VkAccessFlags2KHR>(static_cast<VkAccessFlags>(memory_barrier.dst_access_mask))});
 }
 
-void HPPCommandBuffer::next_subpass()
+void HPPCommandBuffer::next_subpass(vk::SubpassContents contents)
 {
 	// Increment subpass index
 	pipeline_state.set_subpass_index(pipeline_state.get_subpass_index() + 1);
@@ -390,12 +589,12 @@ void HPPCommandBuffer::next_subpass()
 
 	// Reset descriptor sets
 	resource_binding_state.reset();
-	descriptor_set_layout_binding_state.clear();
+	descriptor_set_layout_binding_state.fill(nullptr);
 
 	// Clear stored push constants
 	stored_push_constants.clear();
 
-	get_handle().nextSubpass(vk::SubpassContents::eInline);
+	get_handle().nextSubpass(contents);
 }
 
 void HPPCommandBuffer::push_constants(const std::vector<uint8_t> &values)
@@ -413,10 +612,18 @@ void HPPCommandBuffer::push_constants(const std::vector<uint8_t> &values)
 	}
 }
 
+HPPCommandBuffer::ResetMode HPPCommandBuffer::get_reset_mode() const
+{
+	return command_pool.get_reset_mode();
+}
+
 vk::Result HPPCommandBuffer::reset(ResetMode reset_mode)
 {
 	assert(reset_mode == command_pool.get_reset_mode() && "Command buffer reset mode must match the one used by the pool to allocate it");
 
+	pending_image_barriers.clear();
+	pending_buffer_barriers.clear();
+
 	if (reset_mode == ResetMode::ResetIndividually)
 	{
 		get_handle().reset(vk::CommandBufferResetFlagBits::eReleaseResources);
@@ -430,8 +637,33 @@ void HPPCommandBuffer::reset_query_pool(const vkb::core::HPPQueryPool &query_poo
 	get_handle().resetQueryPool(query_pool.get_handle(), first_query, query_count);
 }
 
+void HPPCommandBuffer::reset_redundant_command_filter()
+{
+	redundant_command_filter.reset();
+}
+
+void HPPCommandBuffer::request_buffer_state(const vkb::core::BufferCpp &buffer, const vkb::core::ResourceState &state)
+{
+	buffer.get_state_tracker().request(static_cast<VkBuffer>(buffer.get_handle()), state, pending_buffer_barriers);
+}
+
+void HPPCommandBuffer::request_image_state(const vkb::core::HPPImage       &image,
+                                           const vk::ImageSubresourceRange &range,
+                                           const vkb::core::ResourceState  &state,
+                                           bool                             discard)
+{
+	image.get_state_tracker().request(static_cast<VkImage>(image.get_handle()), static_cast<VkImageSubresourceRange>(range), state, discard, pending_image_barriers);
+}
+
+void HPPCommandBuffer::request_image_state(const vkb::core::HPPImageView &image_view, const vkb::core::ResourceState &state, bool discard)
+{
+	request_image_state(image_view.get_image(), get_barrier_range(image_view), state, discard);
+}
+
 void HPPCommandBuffer::resolve_image(const vkb::core::HPPImage &src_img, const vkb::core::HPPImage &dst_img, const std::vector<vk::ImageResolve> &regions)
 {
+	flush_barriers();
+
 	get_handle().resolveImage(src_img.get_handle(), vk::ImageLayout::eTransferSrcOptimal, dst_img.get_handle(), vk::ImageLayout::eTransferDstOptimal, regions);
 }
 
@@ -482,6 +714,11 @@ void HPPCommandBuffer::set_rasterization_state(const vkb::rendering::HPPRasteriz
 
 void HPPCommandBuffer::set_scissor(uint32_t first_scissor, const std::vector<vk::Rect2D> &scissors)
 {
+	if (!redundant_command_filter.update_scissors(first_scissor, to_u32(scissors.size()), reinterpret_cast<const VkRect2D *>(scissors.data()), false))
+	{
+		return;
+	}
+
 	get_handle().setScissor(first_scissor, scissors);
 }
 
@@ -490,6 +727,11 @@ void HPPCommandBuffer::set_specialization_constant(uint32_t constant_id, const s
 	pipeline_state.set_specialization_constant(constant_id, data);
 }
 
+void HPPCommandBuffer::set_specialization_constant(uint32_t constant_id, const uint8_t *data, size_t size)
+{
+	pipeline_state.set_specialization_constant(constant_id, data, size);
+}
+
 void HPPCommandBuffer::set_update_after_bind(bool update_after_bind_)
 {
 	update_after_bind = update_after_bind_;
@@ -502,6 +744,11 @@ void HPPCommandBuffer::set_vertex_input_state(const vkb::rendering::HPPVertexInp
 
 void HPPCommandBuffer::set_viewport(uint32_t first_viewport, const std::vector<vk::Viewport> &viewports)
 {
+	if (!redundant_command_filter.update_viewports(first_viewport, to_u32(viewports.size()), reinterpret_cast<const VkViewport *>(viewports.data()), false))
+	{
+		return;
+	}
+
 	get_handle().setViewport(first_viewport, viewports);
 }
 
@@ -512,6 +759,8 @@ void HPPCommandBuffer::set_viewport_state(const vkb::rendering::HPPViewportState
 
 void HPPCommandBuffer::update_buffer(const vkb::core::BufferCpp &buffer, vk::DeviceSize offset, const std::vector<uint8_t> &data)
 {
+	flush_barriers();
+
 	get_handle().updateBuffer<uint8_t>(buffer.get_handle(), offset, data);
 }
 
@@ -522,6 +771,8 @@ void HPPCommandBuffer::write_timestamp(vk::PipelineStageFlagBits pipeline_stage,
 
 void HPPCommandBuffer::flush(vk::PipelineBindPoint pipeline_bind_point)
 {
+	PROFILE_FUNCTION();
+
 	flush_pipeline_state(pipeline_bind_point);
 	flush_push_constants();
 	flush_descriptor_state(pipeline_bind_point);
@@ -529,61 +780,55 @@ void HPPCommandBuffer::flush(vk::PipelineBindPoint pipeline_bind_point)
 
 void HPPCommandBuffer::flush_descriptor_state(vk::PipelineBindPoint pipeline_bind_point)
 {
+	PROFILE_FUNCTION();
+
 	assert(command_pool.get_render_frame() && "The command pool must be associated to a render frame");
 
+	auto &frame_arena = command_pool.get_render_frame()->get_frame_arena(command_pool.get_thread_index());
+
 	const auto &pipeline_layout = pipeline_state.get_pipeline_layout();
 
-	std::unordered_set<uint32_t> update_descriptor_sets;
+	// Mask of the bound sets whose layout differs from the one of the pipeline layout
+	uint32_t layout_changed_sets = 0;
 
-	// Iterate over the shader sets to check if they have already been bound
-	// If they have, add the set so that the command buffer later updates it
-	for (auto &set_it : pipeline_layout.get_shader_sets())
+	for (uint32_t descriptor_set_id = 0; descriptor_set_id < descriptor_set_layout_binding_state.size(); ++descriptor_set_id)
 	{
-		uint32_t descriptor_set_id = set_it.first;
-
-		auto descriptor_set_layout_it = descriptor_set_layout_binding_state.find(descriptor_set_id);
+		auto *bound_layout = descriptor_set_layout_binding_state[descriptor_set_id];
 
-		if (descriptor_set_layout_it != descriptor_set_layout_binding_state.end())
+		if (bound_layout == nullptr)
 		{
-			if (descriptor_set_layout_it->second->GetHandle() != pipeline_layout.get_descriptor_set_layout(descriptor_set_id).GetHandle())
-			{
-				update_descriptor_sets.emplace(descriptor_set_id);
-			}
+			continue;
 		}
-	}
 
-	// Validate that the bound descriptor set layouts exist in the pipeline layout
-	for (auto set_it = descriptor_set_layout_binding_state.begin(); set_it != descriptor_set_layout_binding_state.end();)
-	{
-		if (!pipeline_layout.has_descriptor_set_layout(set_it->first))
+		// Validate that the bound descriptor set layouts exist in the pipeline layout
+		if (!pipeline_layout.has_descriptor_set_layout(descriptor_set_id))
 		{
-			set_it = descriptor_set_layout_binding_state.erase(set_it);
+			descriptor_set_layout_binding_state[descriptor_set_id] = nullptr;
 		}
-		else
+		else if (bound_layout->GetHandle() != pipeline_layout.get_descriptor_set_layout(descriptor_set_id).GetHandle())
 		{
-			++set_it;
+			layout_changed_sets |= 1u << descriptor_set_id;
 		}
 	}
 
-	// Check if a descriptor set needs to be created
-	if (resource_binding_state.is_dirty() || !update_descriptor_sets.empty())
+	// Only the sets with new resources or a new layout need a descriptor set
+	uint32_t update_sets = (resource_binding_state.get_dirty_sets() | layout_changed_sets) & resource_binding_state.get_bound_sets();
+
+	// Sets whose descriptors were in a descriptor buffer which got replaced
+	uint32_t stale_sets = 0;
+
+	if (update_sets != 0)
 	{
 		resource_binding_state.clear_dirty();
 
-		// Iterate over all of the resource sets bound by the command buffer
-		for (auto &resource_set_it : resource_binding_state.get_resource_sets())
+		for (uint32_t descriptor_set_id = 0; update_sets != 0; ++descriptor_set_id, update_sets >>= 1)
 		{
-			uint32_t descriptor_set_id = resource_set_it.first;
-			auto    &resource_set      = resource_set_it.second;
-
-			// Don't update resource set if it's not in the update list OR its state hasn't changed
-			if (!resource_set.is_dirty() && (update_descriptor_sets.find(descriptor_set_id) == update_descriptor_sets.end()))
+			if (!(update_sets & 1u))
 			{
 				continue;
 			}
 
-			// Clear dirty flag for resource set
-			resource_binding_state.clear_dirty(descriptor_set_id);
+			auto &resource_set = resource_binding_state.get_resource_set(descriptor_set_id);
 
 			// Skip resource set if a descriptor set layout doesn't exist for it
 			if (!pipeline_layout.has_descriptor_set_layout(descriptor_set_id))
@@ -599,7 +844,7 @@ void HPPCommandBuffer::flush_descriptor_state(vk::PipelineBindPoint pipeline_bin
 			BindingMap<vk::DescriptorBufferInfo> buffer_infos;
 			BindingMap<vk::DescriptorImageInfo>  image_infos;
 
-			std::vector<uint32_t> dynamic_offsets;
+			std::pmr::vector<uint32_t> dynamic_offsets{&frame_arena};
 
 			// Iterate over all resource bindings
 			for (auto &binding_it : resource_set.get_resource_bindings())
@@ -671,17 +916,63 @@ void HPPCommandBuffer::flush_descriptor_state(vk::PipelineBindPoint pipeline_bin
 				}
 			}
 
+			// Per-draw sets skip the descriptor pools and caches of the render frame
+			if (descriptor_set_layout.IsPushDescriptor())
+			{
+				push_descriptor_set(pipeline_bind_point, pipeline_layout, descriptor_set_layout, buffer_infos, image_infos);
+				continue;
+			}
+
+			// Descriptor buffer sets are written into the frame's descriptor buffer and bound with an offset
+			if (descriptor_set_layout.IsDescriptorBuffer())
+			{
+				auto allocation = command_pool.get_render_frame()->request_descriptor_buffer(
+				    descriptor_set_layout, buffer_infos, image_infos, command_pool.get_thread_index());
+
+				if (allocation.get_buffer().get_handle() != bound_descriptor_buffer)
+				{
+					bind_descriptor_buffer(allocation.get_buffer());
+
+					// Offsets set before now point into the new buffer
+					stale_sets = resource_binding_state.get_bound_sets();
+				}
+
+				uint32_t       buffer_index = 0;
+				vk::DeviceSize offset       = allocation.get_offset();
+				get_handle().setDescriptorBufferOffsetsEXT(pipeline_bind_point, pipeline_layout.get_handle(), descriptor_set_id, buffer_index, offset);
+
+				stale_sets &= ~(1u << descriptor_set_id);
+				continue;
+			}
+
 			vk::DescriptorSet descriptor_set_handle = command_pool.get_render_frame()->request_descriptor_set(
 			    descriptor_set_layout, buffer_infos, image_infos, update_after_bind, command_pool.get_thread_index());
 
 			// Bind descriptor set
-			get_handle().bindDescriptorSets(pipeline_bind_point, pipeline_layout.get_handle(), descriptor_set_id, descriptor_set_handle, dynamic_offsets);
+			get_handle().bindDescriptorSets(pipeline_bind_point, pipeline_layout.get_handle(), descriptor_set_id, descriptor_set_handle, {to_u32(dynamic_offsets.size()), dynamic_offsets.data()});
 		}
 	}
+
+	if (stale_sets != 0)
+	{
+		resource_binding_state.mark_dirty(stale_sets);
+		flush_descriptor_state(pipeline_bind_point);
+	}
+}
+
+void HPPCommandBuffer::bind_descriptor_buffer(const vkb::core::BufferCpp &buffer)
+{
+	vk::DescriptorBufferBindingInfoEXT binding_info(buffer.get_device_address(), vkb::rendering::HPPRenderFrame::DESCRIPTOR_BUFFER_USAGE);
+
+	get_handle().bindDescriptorBuffersEXT(binding_info);
+
+	bound_descriptor_buffer = buffer.get_handle();
 }
 
 void HPPCommandBuffer::flush_pipeline_state(vk::PipelineBindPoint pipeline_bind_point)
 {
+	PROFILE_FUNCTION();
+
 	// Create a new pipeline only if the graphics state changed
 	if (!pipeline_state.is_dirty())
 	{
@@ -690,6 +981,8 @@ void HPPCommandBuffer::flush_pipeline_state(vk::PipelineBindPoint pipeline_bind_
 
 	pipeline_state.clear_dirty();
 
+	redundant_command_filter.bind_pipeline_layout(static_cast<VkPipelineLayout>(pipeline_state.get_pipeline_layout().get_handle()));
+
 	// Create and bind pipeline
 	if (pipeline_bind_point == vk::PipelineBindPoint::eGraphics)
 	{
@@ -710,8 +1003,44 @@ void HPPCommandBuffer::flush_pipeline_state(vk::PipelineBindPoint pipeline_bind_
 	}
 }
 
+void HPPCommandBuffer::push_descriptor_set(vk::PipelineBindPoint                       pipeline_bind_point,
+                                           const vkb::core::HPPPipelineLayout         &pipeline_layout,
+                                           const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
+                                           const BindingMap<vk::DescriptorBufferInfo> &buffer_infos,
+                                           const BindingMap<vk::DescriptorImageInfo>  &image_infos)
+{
+	auto &frame_arena = command_pool.get_render_frame()->get_frame_arena(command_pool.get_thread_index());
+
+	std::pmr::vector<vk::WriteDescriptorSet> write_descriptor_sets{&frame_arena};
+
+	for (auto &binding_it : buffer_infos)
+	{
+		auto binding_info = descriptor_set_layout.GetLayoutBinding(binding_it.first);
+
+		for (auto &element_it : binding_it.second)
+		{
+			write_descriptor_sets.push_back(
+			    vk::WriteDescriptorSet({}, binding_it.first, element_it.first, 1, binding_info->descriptorType, nullptr, &element_it.second));
+		}
+	}
+
+	for (auto &binding_it : image_infos)
+	{
+		auto binding_info = descriptor_set_layout.GetLayoutBinding(binding_it.first);
+
+		for (auto &element_it : binding_it.second)
+		{
+			write_descriptor_sets.push_back(vk::WriteDescriptorSet({}, binding_it.first, element_it.first, 1, binding_info->descriptorType, &element_it.second));
+		}
+	}
+
+	get_handle().pushDescriptorSetKHR(pipeline_bind_point, pipeline_layout.get_handle(), descriptor_set_layout.GetIndex(), {to_u32(write_descriptor_sets.size()), write_descriptor_sets.data()});
+}
+
 void HPPCommandBuffer::flush_push_constants()
 {
+	PROFILE_FUNCTION();
+
 	if (stored_push_constants.empty())
 	{
 		return;
@@ -721,13 +1050,15 @@ void HPPCommandBuffer::flush_push_constants()
 
 	vk::ShaderStageFlags shader_stage = pipeline_layout.get_push_constant_range_stage(to_u32(stored_push_constants.size()));
 
-	if (shader_stage)
+	if (!shader_stage)
 	{
-		get_handle().pushConstants<uint8_t>(pipeline_layout.get_handle(), shader_stage, 0, stored_push_constants);
+		LOGW_THROTTLED("Push constant range [{}, {}] not found", 0, stored_push_constants.size());
 	}
-	else
+	else if (redundant_command_filter.update_push_constants(static_cast<VkPipelineLayout>(pipeline_layout.get_handle()),
+	                                                        static_cast<VkShaderStageFlags>(shader_stage),
+	                                                        stored_push_constants))
 	{
-		LOGW("Push constant range [{}, {}] not found", 0, stored_push_constants.size());
+		get_handle().pushConstants<uint8_t>(pipeline_layout.get_handle(), shader_stage, 0, stored_push_constants);
 	}
 
 	stored_push_constants.clear();
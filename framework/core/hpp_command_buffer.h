@@ -20,6 +20,8 @@
 #include <common/hpp_vk_common.h>
 #include <core/hpp_framebuffer.h>
 #include <core/hpp_query_pool.h>
+#include <core/hpp_render_pass.h>
+#include <core/redundant_command_filter.h>
 #include <hpp_resource_binding_state.h>
 #include <rendering/hpp_pipeline_state.h>
 #include <rendering/hpp_render_target.h>
@@ -50,8 +52,19 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
   public:
 	struct RenderPassBinding
 	{
-		const vkb::core::HPPRenderPass  *render_pass;
-		const vkb::core::HPPFramebuffer *framebuffer;
+		const vkb::core::HPPRenderPass        *render_pass;
+		const vkb::core::HPPFramebuffer       *framebuffer;
+		const vkb::rendering::HPPRenderTarget *render_target = nullptr;
+	};
+
+	// Mirror vkb::CommandBuffer::RenderingBinding, set by its begin_render_pass when the device uses dynamic rendering
+	struct RenderingBinding
+	{
+		const vkb::rendering::HPPRenderTarget      *render_target = nullptr;
+		std::vector<vkb::common::HPPLoadStoreInfo> load_store_infos;
+		std::vector<vk::ClearValue>                clear_values;
+		std::vector<vkb::core::HPPSubpassInfo>     subpasses;
+		bool                                       local_read = false;
 	};
 
 	enum class ResetMode
@@ -104,6 +117,7 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 	                                            const std::vector<vk::ClearValue>     &clear_values,
 	                                            vk::SubpassContents                    contents = vk::SubpassContents::eInline);
 	void                      bind_buffer(const vkb::core::BufferCpp &buffer, vk::DeviceSize offset, vk::DeviceSize range, uint32_t set, uint32_t binding, uint32_t array_element);
+	void                      bind_descriptor_set(uint32_t set, vk::DescriptorSet descriptor_set, vk::PipelineBindPoint pipeline_bind_point = vk::PipelineBindPoint::eGraphics);
 	void                      bind_image(const vkb::core::HPPImageView &image_view, const vkb::core::HPPSampler &sampler, uint32_t set, uint32_t binding, uint32_t array_element);
 	void                      bind_image(const vkb::core::HPPImageView &image_view, uint32_t set, uint32_t binding, uint32_t array_element);
 	void                      bind_index_buffer(const vkb::core::BufferCpp &buffer, vk::DeviceSize offset, vk::IndexType index_type);
@@ -131,16 +145,36 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 	void                      draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance);
 	void                      draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance);
 	void                      draw_indexed_indirect(const vkb::core::BufferCpp &buffer, vk::DeviceSize offset, uint32_t draw_count, uint32_t stride);
+	void                      draw_indexed_indirect_count(const vkb::core::BufferCpp &buffer,
+	                                                      vk::DeviceSize              offset,
+	                                                      const vkb::core::BufferCpp &count_buffer,
+	                                                      vk::DeviceSize              count_offset,
+	                                                      uint32_t                    max_draw_count,
+	                                                      uint32_t                    stride);
+	void                      draw_mesh_tasks(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z);
 	vk::Result                end();
 	void                      end_query(const vkb::core::HPPQueryPool &query_pool, uint32_t query);
 	void                      end_render_pass();
 	void                      execute_commands(HPPCommandBuffer &secondary_command_buffer);
 	void                      execute_commands(std::vector<HPPCommandBuffer *> &secondary_command_buffers);
+
+	/**
+	 * @brief Records the barriers of the requested states in a single pipeline barrier, nothing if none is needed
+	 *        The commands recorded outside of a render pass, and beginning one, call it first.
+	 */
+	void flush_barriers();
+
+	/**
+	 * @return The number of commands skipped since the command buffer began because they set the state already in place,
+	 *         including those of the secondary command buffers it executed
+	 */
+	uint32_t get_redundant_command_count() const;
+
 	vkb::core::HPPRenderPass &get_render_pass(const vkb::rendering::HPPRenderTarget                          &render_target,
 	                                          const std::vector<vkb::common::HPPLoadStoreInfo>               &load_store_infos,
 	                                          const std::vector<std::unique_ptr<vkb::rendering::SubpassCpp>> &subpasses);
-	void                      image_memory_barrier(const vkb::core::HPPImageView &image_view, const vkb::common::HPPImageMemoryBarrier &memory_barrier) const;
-	void                      next_subpass();
+	void                      image_memory_barrier(const vkb::core::HPPImageView &image_view, const vkb::common::HPPImageMemoryBarrier &memory_barrier);
+	void                      next_subpass(vk::SubpassContents contents = vk::SubpassContents::eInline);
 
 	/**
 	 * @brief Records byte data into the command buffer to be pushed as push constants to each draw call
@@ -150,9 +184,10 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 	template <typename T>
 	void push_constants(const T &value)
 	{
-		auto data = to_bytes(value);
+		// Copied in place, without going through a temporary vector of bytes
+		auto data = reinterpret_cast<const uint8_t *>(&value);
 
-		uint32_t size = to_u32(stored_push_constants.size() + data.size());
+		uint32_t size = to_u32(stored_push_constants.size() + sizeof(T));
 
 		if (size > max_push_constants_size)
 		{
@@ -160,7 +195,7 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 			throw std::runtime_error("Cannot overflow push constant limit");
 		}
 
-		stored_push_constants.insert(stored_push_constants.end(), data.begin(), data.end());
+		stored_push_constants.insert(stored_push_constants.end(), data, data + sizeof(T));
 	}
 
 	/**
@@ -169,7 +204,29 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 	 */
 	vk::Result reset(ResetMode reset_mode);
 
+	/**
+	 * @return Reset mode of the pool the command buffer was allocated from
+	 */
+	ResetMode get_reset_mode() const;
+
 	void reset_query_pool(const vkb::core::HPPQueryPool &query_pool, uint32_t first_query, uint32_t query_count);
+
+	/**
+	 * @brief Requests the state the next access to a buffer needs, see vkb::CommandBuffer::request_buffer_state
+	 */
+	void request_buffer_state(const vkb::core::BufferCpp &buffer, const vkb::core::ResourceState &state);
+
+	/**
+	 * @brief Requests the state the next access to a range of subresources of an image needs, see vkb::CommandBuffer::request_image_state
+	 */
+	void request_image_state(const vkb::core::HPPImage &image, const vk::ImageSubresourceRange &range, const vkb::core::ResourceState &state, bool discard = false);
+	void request_image_state(const vkb::core::HPPImageView &image_view, const vkb::core::ResourceState &state, bool discard = false);
+
+	/**
+	 * @brief Forgets the state recorded through the wrapper, to be called after recording commands on the handle directly
+	 */
+	void reset_redundant_command_filter();
+
 	void resolve_image(const vkb::core::HPPImage &src_img, const vkb::core::HPPImage &dst_img, const std::vector<vk::ImageResolve> &regions);
 	void set_blend_constants(const std::array<float, 4> &blend_constants);
 	void set_color_blend_state(const vkb::rendering::HPPColorBlendState &state_info);
@@ -186,6 +243,7 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 	void set_specialization_constant(uint32_t constant_id, const T &data);
 
 	void set_specialization_constant(uint32_t constant_id, const std::vector<uint8_t> &data);
+	void set_specialization_constant(uint32_t constant_id, const uint8_t *data, size_t size);
 
 	void set_update_after_bind(bool update_after_bind_);
 	void set_vertex_input_state(const vkb::rendering::HPPVertexInputState &state_info);
@@ -206,6 +264,20 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 	 */
 	void flush_descriptor_state(vk::PipelineBindPoint pipeline_bind_point);
 
+	/**
+	 * @brief Records the descriptors of a push descriptor set layout directly into the command buffer
+	 */
+	void push_descriptor_set(vk::PipelineBindPoint                       pipeline_bind_point,
+	                         const vkb::core::HPPPipelineLayout         &pipeline_layout,
+	                         const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
+	                         const BindingMap<vk::DescriptorBufferInfo> &buffer_infos,
+	                         const BindingMap<vk::DescriptorImageInfo>  &image_infos);
+
+	/**
+	 * @brief Binds the descriptor buffer the offsets of descriptor buffer sets refer to
+	 */
+	void bind_descriptor_buffer(const vkb::core::BufferCpp &buffer);
+
 	/**
 	 * @brief Flush the pipeline state
 	 */
@@ -239,19 +311,32 @@ class HPPCommandBuffer : public vkb::core::VulkanResourceCpp<vk::CommandBuffer>
 	// that contain update after bind, as they wont be implicitly updated
 	bool update_after_bind = false;
 
-	std::unordered_map<uint32_t, vkb::core::HPPDescriptorSetLayout const *> descriptor_set_layout_binding_state;
+	std::array<vkb::core::HPPDescriptorSetLayout const *, vkb::HPPResourceBindingState::MAX_SETS> descriptor_set_layout_binding_state = {};
+
+	// Descriptor buffer the descriptor buffer sets are bound from, there is only one at a time
+	vk::Buffer bound_descriptor_buffer = nullptr;
+
+	RenderingBinding current_rendering = {};
+
+	vkb::RedundantCommandFilter redundant_command_filter = {};
+
+	bool synchronization2 = false;        // Mirror vkb::CommandBuffer, barriers recorded with VK_KHR_synchronization2
+
+	std::vector<VkImageMemoryBarrier2KHR>  pending_image_barriers  = {};
+	std::vector<VkBufferMemoryBarrier2KHR> pending_buffer_barriers = {};
 };
 
 template <class T>
 inline void HPPCommandBuffer::set_specialization_constant(uint32_t constant_id, const T &data)
 {
-	set_specialization_constant(constant_id, to_bytes(data));
+	set_specialization_constant(constant_id, reinterpret_cast<const uint8_t *>(&data), sizeof(T));
 }
 
 template <>
 inline void HPPCommandBuffer::set_specialization_constant<bool>(std::uint32_t constant_id, const bool &data)
 {
-	set_specialization_constant(constant_id, to_bytes(to_u32(data)));
+	auto value = to_u32(data);
+	set_specialization_constant(constant_id, reinterpret_cast<const uint8_t *>(&value), sizeof(value));
 }
 }        // namespace core
 }        // namespace vkb
@@ -83,13 +83,14 @@ void HPPDebugMarkerExtDebugUtils::cmd_insert_label(vk::CommandBuffer command_buf
 	command_buffer.debugMarkerInsertEXT(marker_info);
 }
 
+#ifdef VKB_VULKAN_DEBUG
 HPPScopedDebugLabel::HPPScopedDebugLabel(const HPPDebugUtils &debug_utils,
                                          vk::CommandBuffer    command_buffer,
                                          std::string const   &name,
                                          glm::vec4 const      color) :
     debug_utils{&debug_utils}, command_buffer{VK_NULL_HANDLE}
 {
-	if (!name.empty())
+	if (vkb::DebugLabels::are_labels_enabled() && !name.empty())
 	{
 		assert(command_buffer);
 		this->command_buffer = command_buffer;
@@ -98,9 +99,16 @@ HPPScopedDebugLabel::HPPScopedDebugLabel(const HPPDebugUtils &debug_utils,
 	}
 }
 
-HPPScopedDebugLabel::HPPScopedDebugLabel(const vkb::core::HPPCommandBuffer &command_buffer, std::string const &name, glm::vec4 const color) :
-    HPPScopedDebugLabel{command_buffer.get_device().get_debug_utils(), command_buffer.get_handle(), name, color}
+HPPScopedDebugLabel::HPPScopedDebugLabel(const vkb::core::HPPCommandBuffer &command_buffer, std::string const &name, glm::vec4 const color)
 {
+	// The command buffer and its device are only looked up for the labels which are recorded
+	if (vkb::DebugLabels::are_labels_enabled() && !name.empty())
+	{
+		debug_utils          = &command_buffer.get_device().get_debug_utils();
+		this->command_buffer = command_buffer.get_handle();
+
+		debug_utils->cmd_begin_label(this->command_buffer, name.c_str(), color);
+	}
 }
 
 HPPScopedDebugLabel::~HPPScopedDebugLabel()
@@ -110,6 +118,7 @@ HPPScopedDebugLabel::~HPPScopedDebugLabel()
 		debug_utils->cmd_end_label(command_buffer);
 	}
 }
+#endif
 
 }        // namespace core
 }        // namespace vkb
\ No newline at end of file
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <common/glm_common.h>
+#include <core/debug.h>
 #include <vulkan/vulkan.hpp>
 
 namespace vkb
@@ -127,13 +128,15 @@ class HPPDummyDebugUtils final : public vkb::core::HPPDebugUtils
 
 /**
  * @brief A RAII debug label.
- *        If any of EXT_debug_utils or EXT_debug_marker is available, this:
+ *        If any of EXT_debug_utils or EXT_debug_marker is available, and vkb::DebugLabels enables the labels, this:
  *        - Begins a debug label / marker on construction
  *        - Ends it on destruction
+ *        Without VKB_VULKAN_DEBUG, it is empty and compiled out.
  */
 class HPPScopedDebugLabel final
 {
   public:
+#ifdef VKB_VULKAN_DEBUG
 	HPPScopedDebugLabel(const vkb::core::HPPDebugUtils &debug_utils, vk::CommandBuffer command_buffer, std::string const &name, glm::vec4 const color = {});
 
 	HPPScopedDebugLabel(const vkb::core::HPPCommandBuffer &command_buffer, std::string const &name, glm::vec4 const color = {});
@@ -141,8 +144,15 @@ class HPPScopedDebugLabel final
 	~HPPScopedDebugLabel();
 
   private:
-	const vkb::core::HPPDebugUtils *debug_utils;
+	const vkb::core::HPPDebugUtils *debug_utils{nullptr};
 	vk::CommandBuffer               command_buffer;
+#else
+	HPPScopedDebugLabel(const vkb::core::HPPDebugUtils &, vk::CommandBuffer, std::string const &, glm::vec4 const = {})
+	{}
+
+	HPPScopedDebugLabel(const vkb::core::HPPCommandBuffer &, std::string const &, glm::vec4 const = {})
+	{}
+#endif
 };
 
 }        // namespace core
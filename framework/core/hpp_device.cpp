@@ -17,13 +17,48 @@
 
 #include <core/hpp_device.h>
 
+#include <algorithm>
+
 #include <common/hpp_error.h>
+#include <common/strings.h>
 #include <core/hpp_command_pool.h>
+#include <core/queue.h>
 
 namespace vkb
 {
 namespace core
 {
+namespace
+{
+/**
+ * @return The GPUs of the device group of a GPU, empty if device groups aren't used, see vkb::Device
+ */
+std::vector<vk::PhysicalDevice> get_device_group(vkb::core::HPPInstance &instance, vk::PhysicalDevice gpu)
+{
+	if (!HPPInstance::use_device_group || !instance.is_enabled(VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME))
+	{
+		return {};
+	}
+
+	for (auto &group : instance.get_handle().enumeratePhysicalDeviceGroupsKHR())
+	{
+		auto begin = group.physicalDevices.begin();
+		auto end   = group.physicalDevices.begin() + group.physicalDeviceCount;
+		if (std::find(begin, end, gpu) != end)
+		{
+			return {begin, end};
+		}
+	}
+
+	return {};
+}
+
+bool is_transfer_only(vk::QueueFlags queue_flags)
+{
+	return (queue_flags & vk::QueueFlagBits::eTransfer) && !(queue_flags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+}
+}        // namespace
+
 HPPDevice::HPPDevice(vkb::core::HPPPhysicalDevice               &gpu,
                      vk::SurfaceKHR                              surface,
                      std::unique_ptr<vkb::core::HPPDebugUtils> &&debug_utils,
@@ -44,6 +79,8 @@ HPPDevice::HPPDevice(vkb::core::HPPPhysicalDevice               &gpu,
 	{
 		vk::QueueFamilyProperties const &queue_family_property = queue_family_properties[queue_family_index];
 
+		float priority = is_transfer_only(queue_family_property.queueFlags) ? TransferQueuePriority : DefaultQueuePriority;
+
 		if (gpu.has_high_priority_graphics_queue())
 		{
 			uint32_t graphics_queue_family = get_queue_family_index(vk::QueueFlagBits::eGraphics);
@@ -53,17 +90,17 @@ HPPDevice::HPPDevice(vkb::core::HPPPhysicalDevice               &gpu,
 				queue_priorities[queue_family_index].push_back(1.0f);
 				for (uint32_t i = 1; i < queue_family_property.queueCount; i++)
 				{
-					queue_priorities[queue_family_index].push_back(0.5f);
+					queue_priorities[queue_family_index].push_back(priority);
 				}
 			}
 			else
 			{
-				queue_priorities[queue_family_index].resize(queue_family_property.queueCount, 0.5f);
+				queue_priorities[queue_family_index].resize(queue_family_property.queueCount, priority);
 			}
 		}
 		else
 		{
-			queue_priorities[queue_family_index].resize(queue_family_property.queueCount, 0.5f);
+			queue_priorities[queue_family_index].resize(queue_family_property.queueCount, priority);
 		}
 
 		vk::DeviceQueueCreateInfo &queue_create_info = queue_create_infos[queue_family_index];
@@ -102,6 +139,16 @@ HPPDevice::HPPDevice(vkb::core::HPPPhysicalDevice               &gpu,
 		}
 	}
 
+	// The device spans the GPUs of the group, the render context can render alternate frames on them
+	std::vector<vk::PhysicalDevice> group_gpus = get_device_group(gpu.get_instance(), gpu.get_handle());
+	if (group_gpus.size() > 1 && is_extension_supported(VK_KHR_DEVICE_GROUP_EXTENSION_NAME))
+	{
+		enabled_extensions.push_back(VK_KHR_DEVICE_GROUP_EXTENSION_NAME);
+		physical_device_count = static_cast<uint32_t>(group_gpus.size());
+
+		LOGI("Device group of {} GPUs enabled", physical_device_count);
+	}
+
 	// Check that extensions are supported before trying to create the device
 	std::vector<const char *> unsupported_extensions{};
 	for (auto &extension : requested_extensions)
@@ -153,6 +200,14 @@ HPPDevice::HPPDevice(vkb::core::HPPPhysicalDevice               &gpu,
 	// Latest requested feature will have the pNext's all set up for device creation.
 	create_info.pNext = gpu.get_extension_feature_chain();
 
+	vk::DeviceGroupDeviceCreateInfoKHR group_create_info;
+	if (physical_device_count > 1)
+	{
+		group_create_info.setPhysicalDevices(group_gpus);
+		group_create_info.pNext = create_info.pNext;
+		create_info.pNext       = &group_create_info;
+	}
+
 	set_handle(gpu.get_handle().createDevice(create_info));
 
 	queues.resize(queue_family_properties.size());
@@ -161,7 +216,7 @@ HPPDevice::HPPDevice(vkb::core::HPPPhysicalDevice               &gpu,
 	{
 		vk::QueueFamilyProperties const &queue_family_property = queue_family_properties[queue_family_index];
 
-		vk::Bool32 present_supported = gpu.get_handle().getSurfaceSupportKHR(queue_family_index, surface);
+		vk::Bool32 present_supported = surface ? gpu.get_handle().getSurfaceSupportKHR(queue_family_index, surface) : false;
 
 		for (uint32_t queue_index = 0U; queue_index < queue_family_property.queueCount; ++queue_index)
 		{
@@ -172,14 +227,19 @@ HPPDevice::HPPDevice(vkb::core::HPPPhysicalDevice               &gpu,
 	vkb::allocated::init(*this);
 
 	command_pool = std::make_unique<vkb::core::HPPCommandPool>(
-	    *this, get_queue_by_flags(vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute, 0).get_family_index());
+	    *this, get_compute_queue().get_family_index());
 	fence_pool = std::make_unique<vkb::HPPFencePool>(*this);
+
+	deferred_destruction_queue = std::make_unique<vkb::DeferredDestructionQueue>(static_cast<VkDevice>(get_handle()));
 }
 
 HPPDevice::~HPPDevice()
 {
 	resource_cache.clear();
 
+	// Waits for the objects retired until then, including the framebuffers cleared from the resource cache
+	deferred_destruction_queue.reset();
+
 	command_pool.reset();
 	fence_pool.reset();
 
@@ -317,6 +377,60 @@ vkb::core::HPPQueue const &HPPDevice::get_suitable_graphics_queue() const
 	return get_queue_by_flags(vk::QueueFlagBits::eGraphics, 0);
 }
 
+vkb::core::HPPQueue const &HPPDevice::get_transfer_queue() const
+{
+	for (size_t queue_family_index = 0U; queue_family_index < queues.size(); ++queue_family_index)
+	{
+		if (is_transfer_only(queues[queue_family_index][0].get_properties().queueFlags))
+		{
+			return queues[queue_family_index][0];
+		}
+	}
+
+	return get_compute_queue();
+}
+
+vkb::core::HPPQueue const &HPPDevice::get_compute_queue() const
+{
+	if (has_graphics_queue())
+	{
+		return get_queue_by_flags(vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute, 0);
+	}
+
+	return get_queue_by_flags(vk::QueueFlagBits::eCompute, 0);
+}
+
+bool HPPDevice::has_graphics_queue() const
+{
+	return std::any_of(queues.begin(), queues.end(), [](std::vector<vkb::core::HPPQueue> const &family) {
+		return !family.empty() && (family[0].get_properties().queueFlags & vk::QueueFlagBits::eGraphics);
+	});
+}
+
+vkb::core::HPPQueue const &HPPDevice::get_async_compute_queue() const
+{
+	vkb::core::HPPQueue const &graphics_queue = get_queue_by_flags(vk::QueueFlagBits::eGraphics, 0);
+
+	for (size_t queue_family_index = 0U; queue_family_index < queues.size(); ++queue_family_index)
+	{
+		vk::QueueFlags queue_flags = queues[queue_family_index][0].get_properties().queueFlags;
+		if ((queue_flags & vk::QueueFlagBits::eCompute) && !(queue_flags & vk::QueueFlagBits::eGraphics))
+		{
+			return queues[queue_family_index][0];
+		}
+	}
+
+	for (auto &queue : queues[graphics_queue.get_family_index()])
+	{
+		if (queue.get_handle() != graphics_queue.get_handle() && (queue.get_properties().queueFlags & vk::QueueFlagBits::eCompute))
+		{
+			return queue;
+		}
+	}
+
+	return graphics_queue;
+}
+
 std::pair<vk::Image, vk::DeviceMemory> HPPDevice::create_image(vk::Format format, vk::Extent2D const &extent, uint32_t mip_levels, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties) const
 {
 	vk::Device device = get_handle();
@@ -389,7 +503,10 @@ void HPPDevice::flush_command_buffer(vk::CommandBuffer command_buffer, vk::Queue
 	vk::Fence fence = get_handle().createFence({});
 
 	// Submit to the queue
-	queue.submit(submit_info, fence);
+	{
+		std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
+		queue.submit(submit_info, fence);
+	}
 
 	// Wait for the fence to signal that command buffer has finished executing
 	vk::Result result = get_handle().waitForFences(fence, true, DEFAULT_FENCE_TIMEOUT);
@@ -421,5 +538,65 @@ vkb::HPPResourceCache &HPPDevice::get_resource_cache()
 {
 	return resource_cache;
 }
+
+vkb::DeferredDestructionQueue &HPPDevice::get_deferred_destruction_queue()
+{
+	return *deferred_destruction_queue;
+}
+
+bool HPPDevice::enable_descriptor_buffers()
+{
+	if (!is_enabled(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) || !is_enabled(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME))
+	{
+		LOGW("Descriptor buffers need {} and {}, descriptor sets are allocated from pools", VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME, VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+		return false;
+	}
+
+	descriptor_buffer_properties =
+	    gpu.get_handle().getProperties2KHR<vk::PhysicalDeviceProperties2KHR, vk::PhysicalDeviceDescriptorBufferPropertiesEXT>().get<vk::PhysicalDeviceDescriptorBufferPropertiesEXT>();
+	descriptor_buffer_properties.pNext = nullptr;
+
+	descriptor_buffers = true;
+
+	return true;
+}
+
+bool HPPDevice::uses_descriptor_buffers() const
+{
+	return descriptor_buffers;
+}
+
+vk::PhysicalDeviceDescriptorBufferPropertiesEXT const &HPPDevice::get_descriptor_buffer_properties() const
+{
+	return descriptor_buffer_properties;
+}
+
+bool HPPDevice::set_image_compression_policy(const vkb::ImageCompressionPolicy &policy)
+{
+	auto features = gpu.get_requested_extension_features<vk::PhysicalDeviceImageCompressionControlFeaturesEXT>();
+	if (!is_enabled(VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME) || !features || !features->imageCompressionControl)
+	{
+		LOGW("Controlling the compression of the attachments needs {}, they keep the default compression", VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME);
+		return false;
+	}
+
+	image_compression_policy = policy;
+
+	LOGI("Attachment compression: color {}, depth stencil {}",
+	     vkb::image_compression_flags_to_string(policy.color.flags),
+	     vkb::image_compression_flags_to_string(policy.depth_stencil.flags));
+
+	return true;
+}
+
+const vkb::ImageCompressionPolicy &HPPDevice::get_image_compression_policy() const
+{
+	return image_compression_policy;
+}
+
+uint32_t HPPDevice::get_physical_device_count() const
+{
+	return physical_device_count;
+}
 }        // namespace core
 }        // namespace vkb
@@ -17,12 +17,14 @@
 
 #pragma once
 
+#include "common/vk_common.h"
 #include "core/vulkan_resource.h"
 #include <core/hpp_command_buffer.h>
 #include <core/hpp_command_pool.h>
 #include <core/hpp_debug.h>
 #include <core/hpp_physical_device.h>
 #include <core/hpp_queue.h>
+#include <deferred_destruction_queue.h>
 #include <hpp_fence_pool.h>
 #include <hpp_resource_cache.h>
 #include <vulkan/vulkan.hpp>
@@ -36,6 +38,10 @@ class HPPBuffer;
 class HPPDevice : public vkb::core::VulkanResourceCpp<vk::Device>
 {
   public:
+	static constexpr float DefaultQueuePriority = 0.5f;
+
+	static constexpr float TransferQueuePriority = 0.25f;
+
 	/**
 	 * @brief HPPDevice constructor
 	 * @param gpu A valid Vulkan physical device and the requested gpu features
@@ -77,6 +83,23 @@ class HPPDevice : public vkb::core::VulkanResourceCpp<vk::Device>
 	 */
 	vkb::core::HPPQueue const &get_suitable_graphics_queue() const;
 
+	/**
+	 * @brief Finds the queue for uploads, see vkb::Device::get_transfer_queue
+	 */
+	vkb::core::HPPQueue const &get_transfer_queue() const;
+
+	/**
+	 * @brief Finds the queue for compute work, also on devices without graphics queues, see vkb::Device::get_compute_queue
+	 */
+	vkb::core::HPPQueue const &get_compute_queue() const;
+
+	bool has_graphics_queue() const;
+
+	/**
+	 * @brief Finds the queue for compute work running beside the graphics queue, see vkb::Device::get_async_compute_queue
+	 */
+	vkb::core::HPPQueue const &get_async_compute_queue() const;
+
 	bool is_extension_supported(std::string const &extension) const;
 
 	bool is_enabled(std::string const &extension) const;
@@ -126,6 +149,32 @@ class HPPDevice : public vkb::core::VulkanResourceCpp<vk::Device>
 
 	vkb::HPPResourceCache &get_resource_cache();
 
+	/**
+	 * @brief Resources replaced while frames are in flight are retired here, see vkb::Device::get_deferred_destruction_queue
+	 */
+	vkb::DeferredDestructionQueue &get_deferred_destruction_queue();
+
+	/**
+	 * @brief Switches the framework to VK_EXT_descriptor_buffer, see vkb::Device::enable_descriptor_buffers
+	 */
+	bool enable_descriptor_buffers();
+
+	bool uses_descriptor_buffers() const;
+
+	vk::PhysicalDeviceDescriptorBufferPropertiesEXT const &get_descriptor_buffer_properties() const;
+
+	/**
+	 * @brief Sets the compression of the attachment images created from now on, see vkb::Device::set_image_compression_policy
+	 */
+	bool set_image_compression_policy(const vkb::ImageCompressionPolicy &policy);
+
+	const vkb::ImageCompressionPolicy &get_image_compression_policy() const;
+
+	/**
+	 * @brief The number of GPUs the device spans, see vkb::Device::get_physical_device_count
+	 */
+	uint32_t get_physical_device_count() const;
+
   private:
 	vkb::core::HPPPhysicalDevice const &gpu;
 
@@ -144,6 +193,24 @@ class HPPDevice : public vkb::core::VulkanResourceCpp<vk::Device>
 	std::unique_ptr<vkb::HPPFencePool> fence_pool;
 
 	vkb::HPPResourceCache resource_cache;
+
+	bool descriptor_buffers = false;
+
+	vk::PhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties;
+
+	// Mirror vkb::Device, set by its enable_graphics_pipeline_libraries, enable_shader_objects, enable_extended_dynamic_state
+	// and enable_dynamic_rendering
+	bool     graphics_pipeline_libraries  = false;
+	bool     shader_objects               = false;
+	uint32_t dynamic_pipeline_state       = 0;
+	bool     dynamic_rendering            = false;
+	bool     dynamic_rendering_local_read = false;
+
+	vkb::ImageCompressionPolicy image_compression_policy{};
+
+	std::unique_ptr<vkb::DeferredDestructionQueue> deferred_destruction_queue;
+
+	uint32_t physical_device_count = 1;
 };
 }        // namespace core
 }        // namespace vkb
@@ -19,6 +19,7 @@
 
 #include "builder_base.h"
 #include "core/allocated.h"
+#include "core/resource_state_tracker.h"
 #include "core/vulkan_resource.h"
 #include <unordered_set>
 
@@ -101,8 +102,28 @@ struct HPPImageBuilder : public vkb::allocated::BuilderBaseCpp<HPPImageBuilder,
 		return *this;
 	}
 
+	/**
+	 * @brief Makes the memory of the image exportable with the given handle types
+	 *        The image gets a memory object of its own, from a pool exporting these handle types.
+	 *        The create info chains a struct of the builder, which must outlive the build.
+	 */
+	HPPImageBuilder &with_external_memory(vk::ExternalMemoryHandleTypeFlags handle_types)
+	{
+		external_memory_create_info.handleTypes = handle_types;
+
+		if (create_info.pNext != &external_memory_create_info)
+		{
+			external_memory_create_info.pNext = create_info.pNext;
+			create_info.pNext                 = &external_memory_create_info;
+		}
+		return *this;
+	}
+
 	HPPImage    build(HPPDevice &device) const;
 	HPPImagePtr build_unique(HPPDevice &device) const;
+
+  private:
+	vk::ExternalMemoryImageCreateInfo external_memory_create_info;
 };
 
 class HPPImage : public vkb::allocated::AllocatedCpp<vk::Image>
@@ -157,11 +178,13 @@ class HPPImage : public vkb::allocated::AllocatedCpp<vk::Image>
 	vk::ImageSubresource                           get_subresource() const;
 	uint32_t                                       get_array_layer_count() const;
 	std::unordered_set<vkb::core::HPPImageView *> &get_views();
+	vkb::core::ImageStateTracker                  &get_state_tracker() const;
 
   private:
 	vk::ImageCreateInfo                           create_info;
 	vk::ImageSubresource                          subresource;
 	std::unordered_set<vkb::core::HPPImageView *> views;        /// HPPImage views referring to this image
+	mutable vkb::core::ImageStateTracker          state_tracker;
 };
 }        // namespace core
 }        // namespace vkb
@@ -81,7 +81,24 @@ HPPImage::HPPImage(HPPDevice              &device,
 HPPImage::HPPImage(HPPDevice &device, HPPImageBuilder const &builder) :
     vkb::allocated::AllocatedCpp<vk::Image>{builder.get_allocation_create_info(), nullptr, &device}, create_info{builder.get_create_info()}
 {
-	get_handle()           = create_image(create_info.operator const VkImageCreateInfo &());
+	// Attachments follow the compression policy of the device, see vkb::core::Image
+	VkImageCreateInfo                   image_create_info = create_info;
+	VkImageCompressionControlEXT        compression_control{VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT};
+	VkImageCompressionFixedRateFlagsEXT fixed_rate_flags{VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT};
+	if (auto compression = select_attachment_compression(device.get_image_compression_policy(), image_create_info))
+	{
+		compression_control.flags = compression->flags;
+		if (compression->flags == VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT)
+		{
+			fixed_rate_flags                                 = compression->fixed_rate_flags;
+			compression_control.compressionControlPlaneCount = 1;
+			compression_control.pFixedRateFlags              = &fixed_rate_flags;
+		}
+		compression_control.pNext = image_create_info.pNext;
+		image_create_info.pNext   = &compression_control;
+	}
+
+	get_handle()           = create_image(image_create_info);
 	subresource.arrayLayer = create_info.arrayLayers;
 	subresource.mipLevel   = create_info.mipLevels;
 	if (!builder.get_debug_name().empty())
@@ -112,7 +129,8 @@ HPPImage::HPPImage(HPPImage &&other) noexcept :
     vkb::allocated::AllocatedCpp<vk::Image>{std::move(other)},
     create_info(std::exchange(other.create_info, {})),
     subresource(std::exchange(other.subresource, {})),
-    views(std::exchange(other.views, {}))
+    views(std::exchange(other.views, {})),
+    state_tracker(std::exchange(other.state_tracker, {}))
 {
 	// Update image views references to this image to avoid dangling pointers
 	for (auto &view : views)
@@ -123,6 +141,12 @@ HPPImage::HPPImage(HPPImage &&other) noexcept :
 
 HPPImage::~HPPImage()
 {
+	if (get_handle() && has_device())
+	{
+		// The views shared through the resource cache go with the image
+		get_device().get_resource_cache().release_image_views(*this);
+	}
+
 	destroy_image(get_handle());
 }
 
@@ -180,5 +204,14 @@ std::unordered_set<vkb::core::HPPImageView *> &HPPImage::get_views()
 	return views;
 }
 
+vkb::core::ImageStateTracker &HPPImage::get_state_tracker() const
+{
+	if (!state_tracker.is_initialized())
+	{
+		state_tracker.reset(create_info.mipLevels, create_info.arrayLayers, static_cast<VkImageLayout>(create_info.initialLayout));
+	}
+	return state_tracker;
+}
+
 }        // namespace core
 }        // namespace vkb
@@ -105,6 +105,8 @@ namespace core
 {
 Optional<uint32_t> HPPInstance::selected_gpu_index;
 
+bool HPPInstance::use_device_group{false};
+
 namespace
 {
 bool enable_extension(const char                                 *requested_extension,
@@ -211,6 +213,12 @@ HPPInstance::HPPInstance(const std::string                            &applicati
 	// which will be used for stats gathering where available.
 	enable_extension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, available_instance_extensions, enabled_extensions);
 
+	// Enumerates the device groups whatever the API version of the instance
+	if (use_device_group)
+	{
+		enable_extension(VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME, available_instance_extensions, enabled_extensions);
+	}
+
 	for (auto requested_extension : requested_extensions)
 	{
 		auto const &extension_name        = requested_extension.first;
@@ -427,11 +435,11 @@ vkb::core::HPPPhysicalDevice &HPPInstance::get_suitable_gpu(vk::SurfaceKHR surfa
 	{
 		if (gpu->get_properties().deviceType == vk::PhysicalDeviceType::eDiscreteGpu)
 		{
-			// See if it work with the surface
+			// See if it work with the surface, any discrete GPU does without one
 			size_t queue_count = gpu->get_queue_family_properties().size();
 			for (uint32_t queue_idx = 0; static_cast<size_t>(queue_idx) < queue_count; queue_idx++)
 			{
-				if (gpu->get_handle().getSurfaceSupportKHR(queue_idx, surface))
+				if (!surface || gpu->get_handle().getSurfaceSupportKHR(queue_idx, surface))
 				{
 					return *gpu;
 				}
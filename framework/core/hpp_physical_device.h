@@ -149,6 +149,22 @@ class HPPPhysicalDevice
 		return *static_cast<HPPStructureType *>(it->second.get());
 	}
 
+	/**
+	 * @brief Get an extension features struct added to the structure chain used for device creation
+	 * @returns The struct holding the requested flags, or nullptr if the extension features weren't added
+	 */
+	template <typename HPPStructureType>
+	const HPPStructureType *get_requested_extension_features() const
+	{
+		auto it = extension_features.find(HPPStructureType::structureType);
+		if (it == extension_features.end())
+		{
+			return nullptr;
+		}
+
+		return static_cast<const HPPStructureType *>(it->second.get());
+	}
+
 	/**
 	 * @brief Request an optional features flag
 	 *
@@ -85,15 +85,21 @@ HPPPipelineLayout::HPPPipelineLayout(vkb::core::HPPDevice &device, const std::ve
 		    &device.get_resource_cache().request_descriptor_set_layout(shader_set_it.first, shader_modules, shader_set_it.second));
 	}
 
+	// Vulkan allows a single push descriptor set per pipeline layout
+	if (std::count_if(descriptor_set_layouts.begin(),
+	                  descriptor_set_layouts.end(),
+	                  [](vkb::core::HPPDescriptorSetLayout const *descriptor_set_layout) { return descriptor_set_layout && descriptor_set_layout->IsPushDescriptor(); }) > 1)
+	{
+		throw std::runtime_error("Cannot create pipeline layout, only one descriptor set can have per-draw resources.");
+	}
+
 	// Collect all the descriptor set layout handles, maintaining set order
-	std::vector<vk::DescriptorSetLayout> descriptor_set_layout_handles;
 	for (auto descriptor_set_layout : descriptor_set_layouts)
 	{
 		descriptor_set_layout_handles.push_back(descriptor_set_layout ? descriptor_set_layout->GetHandle() : nullptr);
 	}
 
 	// Collect all the push constant shader resources
-	std::vector<vk::PushConstantRange> push_constant_ranges;
 	for (auto &push_constant_resource : get_resources(vkb::core::HPPShaderResourceType::PushConstant))
 	{
 		push_constant_ranges.push_back({push_constant_resource.stages, push_constant_resource.offset, push_constant_resource.size});
@@ -111,7 +117,9 @@ HPPPipelineLayout::HPPPipelineLayout(HPPPipelineLayout &&other) :
     shader_modules{std::move(other.shader_modules)},
     shader_resources{std::move(other.shader_resources)},
     shader_sets{std::move(other.shader_sets)},
-    descriptor_set_layouts{std::move(other.descriptor_set_layouts)}
+    descriptor_set_layouts{std::move(other.descriptor_set_layouts)},
+    descriptor_set_layout_handles{std::move(other.descriptor_set_layout_handles)},
+    push_constant_ranges{std::move(other.push_constant_ranges)}
 {
 	other.handle = nullptr;
 }
@@ -55,10 +55,12 @@ class HPPPipelineLayout
   private:
 	vkb::core::HPPDevice                                                   &device;
 	vk::PipelineLayout                                                      handle;
-	std::vector<vkb::core::HPPShaderModule *>                               shader_modules;                // The shader modules that this pipeline layout uses
-	std::unordered_map<std::string, vkb::core::HPPShaderResource>           shader_resources;              // The shader resources that this pipeline layout uses, indexed by their name
-	std::unordered_map<uint32_t, std::vector<vkb::core::HPPShaderResource>> shader_sets;                   // A map of each set and the resources it owns used by the pipeline layout
-	std::vector<vkb::core::HPPDescriptorSetLayout *>                        descriptor_set_layouts;        // The different descriptor set layouts for this pipeline layout
+	std::vector<vkb::core::HPPShaderModule *>                               shader_modules;                       // The shader modules that this pipeline layout uses
+	std::unordered_map<std::string, vkb::core::HPPShaderResource>           shader_resources;                     // The shader resources that this pipeline layout uses, indexed by their name
+	std::unordered_map<uint32_t, std::vector<vkb::core::HPPShaderResource>> shader_sets;                          // A map of each set and the resources it owns used by the pipeline layout
+	std::vector<vkb::core::HPPDescriptorSetLayout *>                        descriptor_set_layouts;               // The different descriptor set layouts for this pipeline layout
+	std::vector<vk::DescriptorSetLayout>                                    descriptor_set_layout_handles;        // The handles the pipeline layout was created with, mirroring vkb::PipelineLayout
+	std::vector<vk::PushConstantRange>                                      push_constant_ranges;
 };
 }        // namespace core
 }        // namespace vkb
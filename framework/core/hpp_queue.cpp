@@ -19,6 +19,7 @@
 
 #include <core/hpp_command_buffer.h>
 #include <core/hpp_device.h>
+#include <core/queue.h>
 
 namespace vkb
 {
@@ -77,6 +78,8 @@ void HPPQueue::submit(const HPPCommandBuffer &command_buffer, vk::Fence fence) c
 {
 	vk::CommandBuffer commandBuffer = command_buffer.get_handle();
 	vk::SubmitInfo    submit_info({}, {}, commandBuffer);
+
+	std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
 	handle.submit(submit_info, fence);
 }
 
@@ -87,6 +90,7 @@ vk::Result HPPQueue::present(const vk::PresentInfoKHR &present_info) const
 		return vk::Result::eErrorIncompatibleDisplayKHR;
 	}
 
+	std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
 	return handle.presentKHR(present_info);
 }
 }        // namespace core
@@ -49,6 +49,8 @@ struct HPPSubpassInfo
 	uint32_t                depth_stencil_resolve_attachment;
 	vk::ResolveModeFlagBits depth_stencil_resolve_mode;
 	std::string             debug_name;
+	uint32_t                shading_rate_attachment = VK_ATTACHMENT_UNUSED;
+	vk::Extent2D            shading_rate_texel_size;
 };
 
 class HPPRenderPass : private vkb::RenderPass
@@ -72,6 +74,11 @@ class HPPRenderPass : private vkb::RenderPass
 		return static_cast<vk::RenderPass>(vkb::RenderPass::get_handle());
 	}
 
+	const std::vector<vk::ImageLayout> &get_final_layouts() const
+	{
+		return reinterpret_cast<std::vector<vk::ImageLayout> const &>(vkb::RenderPass::get_final_layouts());
+	}
+
 	const vk::Extent2D get_render_area_granularity() const
 	{
 		return static_cast<vk::Extent2D>(vkb::RenderPass::get_render_area_granularity());
@@ -53,7 +53,11 @@ enum class HPPShaderResourceMode
 {
 	Static,
 	Dynamic,
-	UpdateAfterBind
+	UpdateAfterBind,
+	/// Changes at every draw, the set is pushed with VK_KHR_push_descriptor when the device supports it
+	PerDraw,
+	/// Array of the BindlessRegistry, update-after-bind and partially bound, visible to all stages
+	Bindless
 };
 
 /// Store shader resource data.
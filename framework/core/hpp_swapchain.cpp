@@ -234,7 +234,8 @@ HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const vk::Extent2D &exte
                  old_swapchain.properties.image_count,
                  old_swapchain.properties.pre_transform,
                  old_swapchain.image_usage_flags,
-                 old_swapchain.get_handle()}
+                 old_swapchain.get_handle(),
+                 old_swapchain.full_screen_exclusive_monitor}
 {}
 
 HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const uint32_t image_count) :
@@ -247,7 +248,22 @@ HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const uint32_t image_cou
                  image_count,
                  old_swapchain.properties.pre_transform,
                  old_swapchain.image_usage_flags,
-                 old_swapchain.get_handle()}
+                 old_swapchain.get_handle(),
+                 old_swapchain.full_screen_exclusive_monitor}
+{}
+
+HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const uint32_t image_count, const vk::PresentModeKHR present_mode) :
+    HPPSwapchain{old_swapchain.device,
+                 old_swapchain.surface,
+                 present_mode,
+                 old_swapchain.present_mode_priority_list,
+                 old_swapchain.surface_format_priority_list,
+                 old_swapchain.properties.extent,
+                 image_count,
+                 old_swapchain.properties.pre_transform,
+                 old_swapchain.image_usage_flags,
+                 old_swapchain.get_handle(),
+                 old_swapchain.full_screen_exclusive_monitor}
 {}
 
 HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const std::set<vk::ImageUsageFlagBits> &image_usage_flags) :
@@ -260,7 +276,8 @@ HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const std::set<vk::Image
                  old_swapchain.properties.image_count,
                  old_swapchain.properties.pre_transform,
                  image_usage_flags,
-                 old_swapchain.get_handle()}
+                 old_swapchain.get_handle(),
+                 old_swapchain.full_screen_exclusive_monitor}
 {}
 
 HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const vk::Extent2D &extent, const vk::SurfaceTransformFlagBitsKHR transform) :
@@ -273,7 +290,8 @@ HPPSwapchain::HPPSwapchain(HPPSwapchain &old_swapchain, const vk::Extent2D &exte
                  old_swapchain.properties.image_count,
                  transform,
                  old_swapchain.image_usage_flags,
-                 old_swapchain.get_handle()}
+                 old_swapchain.get_handle(),
+                 old_swapchain.full_screen_exclusive_monitor}
 {}
 
 HPPSwapchain::HPPSwapchain(HPPDevice                               &device,
@@ -285,9 +303,11 @@ HPPSwapchain::HPPSwapchain(HPPDevice                               &device,
                            const uint32_t                           image_count,
                            const vk::SurfaceTransformFlagBitsKHR    transform,
                            const std::set<vk::ImageUsageFlagBits>  &image_usage_flags,
-                           vk::SwapchainKHR                         old_swapchain) :
+                           vk::SwapchainKHR                         old_swapchain,
+                           void                                    *full_screen_exclusive_monitor) :
     device{device},
-    surface{surface}
+    surface{surface},
+    full_screen_exclusive_monitor{full_screen_exclusive_monitor}
 {
 	this->present_mode_priority_list   = present_mode_priority_list;
 	this->surface_format_priority_list = surface_format_priority_list;
@@ -325,25 +345,50 @@ HPPSwapchain::HPPSwapchain(HPPDevice                               &device,
 	properties.composite_alpha = choose_composite_alpha(vk::CompositeAlphaFlagBitsKHR::eInherit, surface_capabilities.supportedCompositeAlpha);
 	properties.present_mode    = choose_present_mode(present_mode, present_modes, present_mode_priority_list);
 
-	vk::SwapchainCreateInfoKHR const create_info({},
-	                                             surface,
-	                                             properties.image_count,
-	                                             properties.surface_format.format,
-	                                             properties.surface_format.colorSpace,
-	                                             properties.extent,
-	                                             properties.array_layers,
-	                                             properties.image_usage,
-	                                             {},
-	                                             {},
-	                                             properties.pre_transform,
-	                                             properties.composite_alpha,
-	                                             properties.present_mode,
-	                                             {},
-	                                             properties.old_swapchain);
+	vk::SwapchainCreateInfoKHR create_info({},
+	                                       surface,
+	                                       properties.image_count,
+	                                       properties.surface_format.format,
+	                                       properties.surface_format.colorSpace,
+	                                       properties.extent,
+	                                       properties.array_layers,
+	                                       properties.image_usage,
+	                                       {},
+	                                       {},
+	                                       properties.pre_transform,
+	                                       properties.composite_alpha,
+	                                       properties.present_mode,
+	                                       {},
+	                                       properties.old_swapchain);
+
+#if defined(VK_NV_low_latency2)
+	// The latency sleeps of vkb::FramePacer need the swapchain to opt in at creation
+	vk::SwapchainLatencyCreateInfoNV latency_create_info(true);
+	if (device.is_enabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME))
+	{
+		create_info.pNext = &latency_create_info;
+	}
+#endif
+
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	// The application takes the exclusive ownership of the display itself, see acquire_full_screen_exclusive
+	vk::SurfaceFullScreenExclusiveWin32InfoEXT full_screen_exclusive_win32_info(static_cast<HMONITOR>(full_screen_exclusive_monitor));
+	vk::SurfaceFullScreenExclusiveInfoEXT      full_screen_exclusive_info(vk::FullScreenExclusiveEXT::eApplicationControlled, &full_screen_exclusive_win32_info);
+	if (is_full_screen_exclusive())
+	{
+		full_screen_exclusive_win32_info.pNext = create_info.pNext;
+		create_info.pNext                      = &full_screen_exclusive_info;
+	}
+#endif
 
 	handle = device.get_handle().createSwapchainKHR(create_info);
 
 	images = device.get_handle().getSwapchainImagesKHR(handle);
+
+	if (is_full_screen_exclusive())
+	{
+		acquire_full_screen_exclusive();
+	}
 }
 
 HPPSwapchain::~HPPSwapchain()
@@ -362,7 +407,8 @@ HPPSwapchain::HPPSwapchain(HPPSwapchain &&other) :
     properties{std::exchange(other.properties, {})},
     present_mode_priority_list{std::exchange(other.present_mode_priority_list, {})},
     surface_format_priority_list{std::exchange(other.surface_format_priority_list, {})},
-    image_usage_flags{std::move(other.image_usage_flags)}
+    image_usage_flags{std::move(other.image_usage_flags)},
+    full_screen_exclusive_monitor{other.full_screen_exclusive_monitor}
 {}
 
 bool HPPSwapchain::is_valid() const
@@ -380,9 +426,16 @@ vk::SwapchainKHR HPPSwapchain::get_handle() const
 	return handle;
 }
 
-std::pair<vk::Result, uint32_t> HPPSwapchain::acquire_next_image(vk::Semaphore image_acquired_semaphore, vk::Fence fence) const
+std::pair<vk::Result, uint32_t> HPPSwapchain::acquire_next_image(vk::Semaphore image_acquired_semaphore, vk::Fence fence, uint32_t device_mask) const
 {
-	vk::ResultValue<uint32_t> rv = device.get_handle().acquireNextImageKHR(handle, std::numeric_limits<uint64_t>::max(), image_acquired_semaphore, fence);
+	if (device_mask == 0)
+	{
+		vk::ResultValue<uint32_t> rv = device.get_handle().acquireNextImageKHR(handle, std::numeric_limits<uint64_t>::max(), image_acquired_semaphore, fence);
+		return std::make_pair(rv.result, rv.value);
+	}
+
+	vk::AcquireNextImageInfoKHR acquire_info(handle, std::numeric_limits<uint64_t>::max(), image_acquired_semaphore, fence, device_mask);
+	vk::ResultValue<uint32_t>   rv = device.get_handle().acquireNextImage2KHR(acquire_info);
 	return std::make_pair(rv.result, rv.value);
 }
 
@@ -420,5 +473,30 @@ vk::PresentModeKHR HPPSwapchain::get_present_mode() const
 {
 	return properties.present_mode;
 }
+
+bool HPPSwapchain::is_full_screen_exclusive() const
+{
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	return full_screen_exclusive_monitor != nullptr && device.is_enabled(VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME);
+#else
+	return false;
+#endif
+}
+
+bool HPPSwapchain::acquire_full_screen_exclusive()
+{
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	if (is_full_screen_exclusive())
+	{
+		VkResult result = vkAcquireFullScreenExclusiveModeEXT(static_cast<VkDevice>(device.get_handle()), static_cast<VkSwapchainKHR>(handle));
+		if (result != VK_SUCCESS)
+		{
+			LOGW("(HPPSwapchain) Cannot acquire the full-screen exclusive mode: {}", vk::to_string(static_cast<vk::Result>(result)));
+		}
+		return result == VK_SUCCESS;
+	}
+#endif
+	return false;
+}
 }        // namespace core
 }        // namespace vkb
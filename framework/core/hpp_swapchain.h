@@ -54,6 +54,12 @@ class HPPSwapchain
 	 */
 	HPPSwapchain(HPPSwapchain &old_swapchain, const uint32_t image_count);
 
+	/**
+	 * @brief Constructor to create a swapchain by changing the image count
+	 *        and present mode only and preserving the configuration from the old swapchain.
+	 */
+	HPPSwapchain(HPPSwapchain &old_swapchain, const uint32_t image_count, const vk::PresentModeKHR present_mode);
+
 	/**
 	 * @brief Constructor to create a swapchain by changing the image usage
 	 * only and preserving the configuration from the old swapchain.
@@ -68,6 +74,8 @@ class HPPSwapchain
 
 	/**
 	 * @brief Constructor to create a swapchain.
+	 * @param full_screen_exclusive_monitor The HMONITOR the swapchain takes exclusive ownership of with
+	 *        VK_EXT_full_screen_exclusive, see Window::get_full_screen_exclusive_monitor
 	 */
 	HPPSwapchain(HPPDevice                               &device,
 	             vk::SurfaceKHR                           surface,
@@ -79,7 +87,8 @@ class HPPSwapchain
 	             const uint32_t                           image_count                  = 3,
 	             const vk::SurfaceTransformFlagBitsKHR    transform                    = vk::SurfaceTransformFlagBitsKHR::eIdentity,
 	             const std::set<vk::ImageUsageFlagBits>  &image_usage_flags            = {vk::ImageUsageFlagBits::eColorAttachment, vk::ImageUsageFlagBits::eTransferSrc},
-	             vk::SwapchainKHR                         old_swapchain                = nullptr);
+	             vk::SwapchainKHR                         old_swapchain                = nullptr,
+	             void                                    *full_screen_exclusive_monitor = nullptr);
 
 	HPPSwapchain(const HPPSwapchain &) = delete;
 
@@ -97,7 +106,10 @@ class HPPSwapchain
 
 	vk::SwapchainKHR get_handle() const;
 
-	std::pair<vk::Result, uint32_t> acquire_next_image(vk::Semaphore image_acquired_semaphore, vk::Fence fence = nullptr) const;
+	/**
+	 * @param device_mask The GPUs of the device group the image is acquired for, the first one if 0
+	 */
+	std::pair<vk::Result, uint32_t> acquire_next_image(vk::Semaphore image_acquired_semaphore, vk::Fence fence = nullptr, uint32_t device_mask = 0) const;
 
 	const vk::Extent2D &get_extent() const;
 
@@ -113,6 +125,18 @@ class HPPSwapchain
 
 	vk::PresentModeKHR get_present_mode() const;
 
+	/**
+	 * @return Whether the application controls the full-screen exclusive mode of the swapchain
+	 */
+	bool is_full_screen_exclusive() const;
+
+	/**
+	 * @brief Takes the exclusive ownership of the display, done at creation and again after the mode got lost
+	 *        (vk::Result::eErrorFullScreenExclusiveModeLostEXT), e.g. when the window lost the focus
+	 * @return Whether the swapchain owns the display
+	 */
+	bool acquire_full_screen_exclusive();
+
   private:
 	HPPDevice &device;
 
@@ -131,6 +155,8 @@ class HPPSwapchain
 	std::vector<vk::SurfaceFormatKHR> surface_format_priority_list;
 
 	std::set<vk::ImageUsageFlagBits> image_usage_flags;
+
+	void *full_screen_exclusive_monitor{nullptr};
 };
 }        // namespace core
 }        // namespace vkb
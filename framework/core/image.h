@@ -23,6 +23,7 @@
 #include "common/helpers.h"
 #include "common/vk_common.h"
 #include "core/allocated.h"
+#include "core/resource_state_tracker.h"
 #include "core/vulkan_resource.h"
 
 namespace vkb
@@ -116,8 +117,27 @@ struct ImageBuilder : public vkb::allocated::BuilderBaseC<ImageBuilder, VkImageC
 		return *this;
 	}
 
+	/**
+	 * @brief Makes the memory of the image exportable with the given handle types
+	 *        The image gets a memory object of its own, from a pool exporting these handle types.
+	 *        The create info chains a struct of the builder, which must outlive the build.
+	 */
+	ImageBuilder &with_external_memory(VkExternalMemoryHandleTypeFlags handle_types)
+	{
+		external_memory_create_info.handleTypes = handle_types;
+
+		if (create_info.pNext != &external_memory_create_info)
+		{
+			with_extension(external_memory_create_info);
+		}
+		return *this;
+	}
+
 	Image    build(Device &device) const;
 	ImagePtr build_unique(Device &device) const;
+
+  private:
+	VkExternalMemoryImageCreateInfo external_memory_create_info{VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO};
 };
 
 class ImageView;
@@ -180,11 +200,20 @@ class Image : public vkb::allocated::AllocatedC<VkImage>
 
 	VkImageCompressionPropertiesEXT get_applied_compression() const;
 
+	/**
+	 * @return The state of the subresources after the accesses recorded so far, see CommandBuffer::request_image_state
+	 *         Starts with all subresources in the initial layout of the image.
+	 */
+	ImageStateTracker &get_state_tracker() const;
+
   private:
 	/// Image views referring to this image
 	VkImageCreateInfo               create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
 	VkImageSubresource              subresource{};
 	std::unordered_set<ImageView *> views;
+
+	/// Recording accesses to a const image changes its synchronization state, not the image
+	mutable ImageStateTracker state_tracker;
 };
 }        // namespace core
 }        // namespace vkb
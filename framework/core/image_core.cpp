@@ -110,7 +110,24 @@ Image::Image(vkb::Device          &device,
 Image::Image(vkb::Device &device, ImageBuilder const &builder) :
     vkb::allocated::AllocatedC<VkImage>{builder.get_allocation_create_info(), VK_NULL_HANDLE, &device}, create_info(builder.get_create_info())
 {
-	set_handle(create_image(create_info));
+	// Attachments follow the compression policy of the device
+	VkImageCreateInfo                   image_create_info = create_info;
+	VkImageCompressionControlEXT        compression_control{VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT};
+	VkImageCompressionFixedRateFlagsEXT fixed_rate_flags{VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT};
+	if (auto compression = select_attachment_compression(device.get_image_compression_policy(), create_info))
+	{
+		compression_control.flags = compression->flags;
+		if (compression->flags == VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT)
+		{
+			fixed_rate_flags                                 = compression->fixed_rate_flags;
+			compression_control.compressionControlPlaneCount = 1;
+			compression_control.pFixedRateFlags              = &fixed_rate_flags;
+		}
+		compression_control.pNext = image_create_info.pNext;
+		image_create_info.pNext   = &compression_control;
+	}
+
+	set_handle(create_image(image_create_info));
 	subresource.arrayLayer = create_info.arrayLayers;
 	subresource.mipLevel   = create_info.mipLevels;
 	if (!builder.get_debug_name().empty())
@@ -133,7 +150,7 @@ Image::Image(Device &device, VkImage handle, const VkExtent3D &extent, VkFormat
 
 Image::Image(Image &&other) noexcept
     :
-    vkb::allocated::AllocatedC<VkImage>{std::move(other)}, create_info{std::exchange(other.create_info, {})}, subresource{std::exchange(other.subresource, {})}, views(std::exchange(other.views, {}))
+    vkb::allocated::AllocatedC<VkImage>{std::move(other)}, create_info{std::exchange(other.create_info, {})}, subresource{std::exchange(other.subresource, {})}, views(std::exchange(other.views, {})), state_tracker{std::exchange(other.state_tracker, {})}
 {
 	// Update image views references to this image to avoid dangling pointers
 	for (auto &view : views)
@@ -144,6 +161,12 @@ Image::Image(Image &&other) noexcept
 
 Image::~Image()
 {
+	if (get_handle() != VK_NULL_HANDLE && has_device())
+	{
+		// The views shared through the resource cache go with the image
+		get_device().get_resource_cache().ReleaseImageViews(*this);
+	}
+
 	destroy_image(get_handle());
 }
 
@@ -205,5 +228,14 @@ VkImageCompressionPropertiesEXT Image::get_applied_compression() const
 {
 	return query_applied_compression(get_device().get_handle(), get_handle());
 }
+
+ImageStateTracker &Image::get_state_tracker() const
+{
+	if (!state_tracker.is_initialized())
+	{
+		state_tracker.reset(create_info.mipLevels, create_info.arrayLayers, create_info.initialLayout);
+	}
+	return state_tracker;
+}
 }        // namespace core
 }        // namespace vkb
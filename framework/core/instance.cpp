@@ -104,6 +104,8 @@ bool validate_layers(const std::vector<const char *>      &required,
 
 Optional<uint32_t> Instance::selected_gpu_index;
 
+bool Instance::use_device_group{false};
+
 namespace
 {
 bool enable_extension(const char                               *requested_extension,
@@ -219,6 +221,12 @@ Instance::Instance(const std::string                            &application_nam
 	// which will be used for stats gathering where available.
 	enable_extension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, available_instance_extensions, enabled_extensions);
 
+	// Enumerates the device groups whatever the API version of the instance
+	if (use_device_group)
+	{
+		enable_extension(VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME, available_instance_extensions, enabled_extensions);
+	}
+
 	for (auto requested_extension : requested_extensions)
 	{
 		auto const &extension_name        = requested_extension.first;
@@ -485,11 +493,11 @@ PhysicalDevice &Instance::get_suitable_gpu(VkSurfaceKHR surface, bool headless_s
 	{
 		if (gpu->get_properties().deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
 		{
-			// See if it work with the surface
+			// See if it work with the surface, any discrete GPU does without one
 			size_t queue_count = gpu->get_queue_family_properties().size();
 			for (uint32_t queue_idx = 0; static_cast<size_t>(queue_idx) < queue_count; queue_idx++)
 			{
-				if (gpu->is_present_supported(surface, queue_idx))
+				if (surface == VK_NULL_HANDLE || gpu->is_present_supported(surface, queue_idx))
 				{
 					return *gpu;
 				}
@@ -39,6 +39,12 @@ class Instance
 	 */
 	static Optional<uint32_t> selected_gpu_index;
 
+	/**
+	 * @brief Can be set from the GPU selection plugin to create the device over all the GPUs of the
+	 *        device group of the selected one, see vkb::Device::get_physical_device_count
+	 */
+	static bool use_device_group;
+
 	/**
 	 * @brief Initializes the connection to Vulkan
 	 * @param application_name The name of the application
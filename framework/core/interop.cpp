@@ -0,0 +1,184 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/interop.h"
+
+#include "core/device.h"
+
+namespace vkb
+{
+namespace core
+{
+VkExternalMemoryHandleTypeFlagBits get_external_memory_handle_type()
+{
+#ifdef _WIN32
+	return VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+#else
+	return VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+#endif
+}
+
+VkExternalSemaphoreHandleTypeFlagBits get_external_semaphore_handle_type()
+{
+#ifdef _WIN32
+	return VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+#else
+	return VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+#endif
+}
+
+std::vector<const char *> get_external_memory_instance_extensions()
+{
+	return {VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
+	        VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME,
+	        VK_KHR_EXTERNAL_SEMAPHORE_CAPABILITIES_EXTENSION_NAME};
+}
+
+std::vector<const char *> get_external_memory_device_extensions()
+{
+	return {VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME,
+	        VK_KHR_EXTERNAL_SEMAPHORE_EXTENSION_NAME,
+#ifdef _WIN32
+	        VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME,
+	        VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME
+#else
+	        VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME,
+	        VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME
+#endif
+	};
+}
+
+ExternalHandle export_memory(Device &device, VkDeviceMemory memory)
+{
+	ExternalHandle handle{};
+#ifdef _WIN32
+	VkMemoryGetWin32HandleInfoKHR handle_info{VK_STRUCTURE_TYPE_MEMORY_GET_WIN32_HANDLE_INFO_KHR};
+	handle_info.memory     = memory;
+	handle_info.handleType = get_external_memory_handle_type();
+	VK_CHECK(vkGetMemoryWin32HandleKHR(device.get_handle(), &handle_info, &handle));
+#else
+	VkMemoryGetFdInfoKHR handle_info{VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR};
+	handle_info.memory     = memory;
+	handle_info.handleType = get_external_memory_handle_type();
+	VK_CHECK(vkGetMemoryFdKHR(device.get_handle(), &handle_info, &handle));
+#endif
+	return handle;
+}
+
+ExternalSemaphore::ExternalSemaphore(Device &device, VkSemaphoreType type, uint64_t initial_value) :
+    device{device},
+    type{type}
+{
+	VkExportSemaphoreCreateInfo export_info{VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO};
+	export_info.handleTypes = get_external_semaphore_handle_type();
+
+	VkSemaphoreCreateInfo create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+	create_info.pNext = &export_info;
+
+	// The type is only chained for timelines, so binary semaphores don't need the timeline semaphore support
+	VkSemaphoreTypeCreateInfo type_info{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+	if (type == VK_SEMAPHORE_TYPE_TIMELINE)
+	{
+		type_info.pNext         = &export_info;
+		type_info.semaphoreType = type;
+		type_info.initialValue  = initial_value;
+		create_info.pNext       = &type_info;
+	}
+
+	VK_CHECK(vkCreateSemaphore(device.get_handle(), &create_info, nullptr, &handle));
+}
+
+ExternalSemaphore::ExternalSemaphore(ExternalSemaphore &&other) noexcept :
+    device{other.device},
+    handle{other.handle},
+    type{other.type}
+{
+	other.handle = VK_NULL_HANDLE;
+}
+
+ExternalSemaphore::~ExternalSemaphore()
+{
+	if (handle != VK_NULL_HANDLE)
+	{
+		vkDestroySemaphore(device.get_handle(), handle, nullptr);
+	}
+}
+
+VkSemaphore ExternalSemaphore::get_handle() const
+{
+	return handle;
+}
+
+VkSemaphoreType ExternalSemaphore::get_type() const
+{
+	return type;
+}
+
+ExternalHandle ExternalSemaphore::export_handle() const
+{
+	ExternalHandle external_handle{};
+#ifdef _WIN32
+	VkSemaphoreGetWin32HandleInfoKHR handle_info{VK_STRUCTURE_TYPE_SEMAPHORE_GET_WIN32_HANDLE_INFO_KHR};
+	handle_info.semaphore  = handle;
+	handle_info.handleType = get_external_semaphore_handle_type();
+	VK_CHECK(vkGetSemaphoreWin32HandleKHR(device.get_handle(), &handle_info, &external_handle));
+#else
+	VkSemaphoreGetFdInfoKHR handle_info{VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR};
+	handle_info.semaphore  = handle;
+	handle_info.handleType = get_external_semaphore_handle_type();
+	VK_CHECK(vkGetSemaphoreFdKHR(device.get_handle(), &handle_info, &external_handle));
+#endif
+	return external_handle;
+}
+
+uint64_t ExternalSemaphore::get_value() const
+{
+	assert(type == VK_SEMAPHORE_TYPE_TIMELINE);
+
+	uint64_t value{0};
+	VK_CHECK(vkGetSemaphoreCounterValueKHR(device.get_handle(), handle, &value));
+	return value;
+}
+
+bool ExternalSemaphore::wait(uint64_t value, uint64_t timeout) const
+{
+	assert(type == VK_SEMAPHORE_TYPE_TIMELINE);
+
+	VkSemaphoreWaitInfo wait_info{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+	wait_info.semaphoreCount = 1;
+	wait_info.pSemaphores    = &handle;
+	wait_info.pValues        = &value;
+	VkResult result = vkWaitSemaphoresKHR(device.get_handle(), &wait_info, timeout);
+	if (result == VK_TIMEOUT)
+	{
+		return false;
+	}
+	VK_CHECK(result);
+	return true;
+}
+
+void ExternalSemaphore::signal(uint64_t value)
+{
+	assert(type == VK_SEMAPHORE_TYPE_TIMELINE);
+
+	VkSemaphoreSignalInfo signal_info{VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO};
+	signal_info.semaphore = handle;
+	signal_info.value     = value;
+	VK_CHECK(vkSignalSemaphoreKHR(device.get_handle(), &signal_info));
+}
+}        // namespace core
+}        // namespace vkb
@@ -0,0 +1,131 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+
+#ifdef _WIN32
+#	include <windows.h>
+#endif
+
+namespace vkb
+{
+class Device;
+
+namespace core
+{
+/**
+ * @brief Sharing of Vulkan memory and semaphores with other APIs like OpenCL or OpenGL, without copies
+ *
+ * Buffers and images are made exportable by their builders, with_external_memory(get_external_memory_handle_type()).
+ * They get a memory object of their own, so the other API imports it whole at offset 0 from export_memory().
+ * The device needs the extensions of get_external_memory_device_extensions(), and the instance those of
+ * get_external_memory_instance_extensions().
+ */
+
+#ifdef _WIN32
+using ExternalHandle = HANDLE;
+#else
+using ExternalHandle = int;
+#endif
+
+/**
+ * @return The opaque memory handle type of the platform
+ */
+VkExternalMemoryHandleTypeFlagBits get_external_memory_handle_type();
+
+/**
+ * @return The opaque semaphore handle type of the platform
+ */
+VkExternalSemaphoreHandleTypeFlagBits get_external_semaphore_handle_type();
+
+/**
+ * @return The instance extensions the export of memory and semaphores needs
+ */
+std::vector<const char *> get_external_memory_instance_extensions();
+
+/**
+ * @return The device extensions the export of memory and semaphores of the platform needs
+ */
+std::vector<const char *> get_external_memory_device_extensions();
+
+/**
+ * @brief Exports a memory object allocated for an exportable resource
+ * @return A new handle to the memory, owned by the caller or the API importing it
+ */
+ExternalHandle export_memory(Device &device, VkDeviceMemory memory);
+
+/**
+ * @brief A semaphore shared with another API
+ *
+ * A timeline semaphore lets both APIs wait for and signal increasing values without a binary semaphore per direction,
+ * it needs the timelineSemaphore feature of the device. Binary semaphores remain available for APIs which don't import timelines.
+ */
+class ExternalSemaphore
+{
+  public:
+	ExternalSemaphore(Device &device, VkSemaphoreType type = VK_SEMAPHORE_TYPE_TIMELINE, uint64_t initial_value = 0);
+
+	ExternalSemaphore(const ExternalSemaphore &) = delete;
+
+	ExternalSemaphore(ExternalSemaphore &&other) noexcept;
+
+	~ExternalSemaphore();
+
+	ExternalSemaphore &operator=(const ExternalSemaphore &) = delete;
+
+	ExternalSemaphore &operator=(ExternalSemaphore &&) = delete;
+
+	VkSemaphore get_handle() const;
+
+	VkSemaphoreType get_type() const;
+
+	/**
+	 * @return A new handle to the semaphore, owned by the caller or the API importing it
+	 */
+	ExternalHandle export_handle() const;
+
+	/**
+	 * @return The current value of a timeline semaphore
+	 */
+	uint64_t get_value() const;
+
+	/**
+	 * @brief Waits on the host for a timeline semaphore to reach a value
+	 * @return False if the timeout elapsed first
+	 */
+	bool wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max()) const;
+
+	/**
+	 * @brief Signals a value of a timeline semaphore from the host
+	 */
+	void signal(uint64_t value);
+
+  private:
+	Device &device;
+
+	VkSemaphore handle{VK_NULL_HANDLE};
+
+	VkSemaphoreType type;
+};
+}        // namespace core
+}        // namespace vkb
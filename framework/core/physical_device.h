@@ -144,6 +144,23 @@ class PhysicalDevice
 		return *static_cast<T *>(it->second.get());
 	}
 
+	/**
+	 * @brief Get an extension features struct added to the structure chain used for device creation
+	 * @param type The VkStructureType for the extension
+	 * @returns The struct holding the requested flags, or nullptr if the extension features weren't added
+	 */
+	template <typename T>
+	const T *get_requested_extension_features(VkStructureType type) const
+	{
+		auto it = extension_features.find(type);
+		if (it == extension_features.end())
+		{
+			return nullptr;
+		}
+
+		return static_cast<const T *>(it->second.get());
+	}
+
 	/**
 	 * @brief Request an optional features flag
 	 *
@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2021, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -20,9 +20,47 @@
 #include "device.h"
 #include "pipeline_layout.h"
 #include "shader_module.h"
+#include "timer.h"
 
 namespace vkb
 {
+namespace
+{
+template <typename CreateInfo, typename CreateFunction>
+VkResult create_with_feedback(Device &device, CreateInfo &create_info, PipelineCreationFeedback &feedback, CreateFunction create)
+{
+	VkPipelineCreationFeedbackEXT pipeline_feedback{};
+
+	VkPipelineCreationFeedbackCreateInfoEXT feedback_info{VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT};
+	feedback_info.pPipelineCreationFeedback = &pipeline_feedback;
+
+	// Unchained after the creation, as the feedback lives on this stack frame
+	const void *next = create_info.pNext;
+	if (device.is_enabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME))
+	{
+		feedback_info.pNext = next;
+		create_info.pNext   = &feedback_info;
+	}
+
+	Timer timer;
+	timer.start();
+
+	VkResult result = create();
+
+	feedback.duration_ms = timer.stop<Timer::Milliseconds>();
+	create_info.pNext    = next;
+
+	if (pipeline_feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)
+	{
+		feedback.duration_ms = pipeline_feedback.duration * 1e-6;
+		feedback.cache_hit   = pipeline_feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT;
+		feedback.reported    = true;
+	}
+
+	return result;
+}
+}        // namespace
+
 Pipeline::Pipeline(Device &device) :
     device{device}
 {}
@@ -30,7 +68,8 @@ Pipeline::Pipeline(Device &device) :
 Pipeline::Pipeline(Pipeline &&other) :
     device{other.device},
     handle{other.handle},
-    state{other.state}
+    state{other.state},
+    creation_feedback{other.creation_feedback}
 {
 	other.handle = VK_NULL_HANDLE;
 }
@@ -54,6 +93,25 @@ const PipelineState &Pipeline::get_state() const
 	return state;
 }
 
+const PipelineCreationFeedback &Pipeline::get_creation_feedback() const
+{
+	return creation_feedback;
+}
+
+VkResult Pipeline::create_graphics_pipeline(VkPipelineCache pipeline_cache, VkGraphicsPipelineCreateInfo &create_info)
+{
+	return create_with_feedback(device, create_info, creation_feedback, [&]() {
+		return vkCreateGraphicsPipelines(device.get_handle(), pipeline_cache, 1, &create_info, nullptr, &handle);
+	});
+}
+
+VkResult Pipeline::create_compute_pipeline(VkPipelineCache pipeline_cache, VkComputePipelineCreateInfo &create_info)
+{
+	return create_with_feedback(device, create_info, creation_feedback, [&]() {
+		return vkCreateComputePipelines(device.get_handle(), pipeline_cache, 1, &create_info, nullptr, &handle);
+	});
+}
+
 ComputePipeline::ComputePipeline(Device &        device,
                                  VkPipelineCache pipeline_cache,
                                  PipelineState & pipeline_state) :
@@ -88,16 +146,10 @@ ComputePipeline::ComputePipeline(Device &        device,
 	                                        shader_module->get_debug_name().c_str());
 
 	// Create specialization info from tracked state.
-	std::vector<uint8_t>                  data{};
-	std::vector<VkSpecializationMapEntry> map_entries{};
+	const auto &specialization_constant_state = pipeline_state.get_specialization_constant_state();
 
-	const auto specialization_constant_state = pipeline_state.get_specialization_constant_state().get_specialization_constant_state();
-
-	for (const auto specialization_constant : specialization_constant_state)
-	{
-		map_entries.push_back({specialization_constant.first, to_u32(data.size()), specialization_constant.second.size()});
-		data.insert(data.end(), specialization_constant.second.begin(), specialization_constant.second.end());
-	}
+	const auto  map_entries = specialization_constant_state.get_map_entries();
+	const auto &data        = specialization_constant_state.get_data();
 
 	VkSpecializationInfo specialization_info{};
 	specialization_info.mapEntryCount = to_u32(map_entries.size());
@@ -112,7 +164,12 @@ ComputePipeline::ComputePipeline(Device &        device,
 	create_info.layout = pipeline_state.get_pipeline_layout().get_handle();
 	create_info.stage  = stage;
 
-	result = vkCreateComputePipelines(device.get_handle(), pipeline_cache, 1, &create_info, nullptr, &handle);
+	if (device.uses_descriptor_buffers())
+	{
+		create_info.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+	}
+
+	result = create_compute_pipeline(pipeline_cache, create_info);
 
 	if (result != VK_SUCCESS)
 	{
@@ -122,28 +179,95 @@ ComputePipeline::ComputePipeline(Device &        device,
 	vkDestroyShaderModule(device.get_handle(), stage.module, nullptr);
 }
 
-GraphicsPipeline::GraphicsPipeline(Device &        device,
-                                   VkPipelineCache pipeline_cache,
-                                   PipelineState & pipeline_state) :
-    Pipeline{device}
+namespace
 {
+constexpr VkGraphicsPipelineLibraryFlagsEXT all_library_parts = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+                                                                VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+                                                                VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+                                                                VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+/**
+ * @brief Builds the create info of the parts of a graphics pipeline, pointing into the pipeline state
+ *        All the parts make a monolithic pipeline, a single part a graphics pipeline library.
+ */
+class GraphicsPipelineBuilder
+{
+  public:
+	GraphicsPipelineBuilder(Device &device, const PipelineState &pipeline_state, VkGraphicsPipelineLibraryFlagsEXT parts);
+
+	GraphicsPipelineBuilder(const GraphicsPipelineBuilder &) = delete;
+
+	GraphicsPipelineBuilder(GraphicsPipelineBuilder &&) = delete;
+
+	~GraphicsPipelineBuilder();
+
+	GraphicsPipelineBuilder &operator=(const GraphicsPipelineBuilder &) = delete;
+
+	GraphicsPipelineBuilder &operator=(GraphicsPipelineBuilder &&) = delete;
+
+	VkGraphicsPipelineCreateInfo create_info{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+
+  private:
+	Device &device;
+
 	std::vector<VkShaderModule> shader_modules;
 
 	std::vector<VkPipelineShaderStageCreateInfo> stage_create_infos;
 
-	// Create specialization info from tracked state. This is shared by all shaders.
-	std::vector<uint8_t>                  data{};
-	std::vector<VkSpecializationMapEntry> map_entries{};
+	std::vector<uint8_t> data;
 
-	const auto specialization_constant_state = pipeline_state.get_specialization_constant_state().get_specialization_constant_state();
-
-	for (const auto specialization_constant : specialization_constant_state)
-	{
-		map_entries.push_back({specialization_constant.first, to_u32(data.size()), specialization_constant.second.size()});
-		data.insert(data.end(), specialization_constant.second.begin(), specialization_constant.second.end());
-	}
+	std::vector<VkSpecializationMapEntry> map_entries;
 
 	VkSpecializationInfo specialization_info{};
+
+	VkPipelineVertexInputStateCreateInfo vertex_input_state{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+
+	VkPipelineInputAssemblyStateCreateInfo input_assembly_state{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+
+	VkPipelineViewportStateCreateInfo viewport_state{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+
+	VkPipelineRasterizationStateCreateInfo rasterization_state{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+
+	VkPipelineMultisampleStateCreateInfo multisample_state{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+
+	VkPipelineDepthStencilStateCreateInfo depth_stencil_state{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+
+	VkPipelineColorBlendStateCreateInfo color_blend_state{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+
+	std::vector<ColorBlendAttachmentState> color_blend_attachments;
+
+	VkPipelineRenderingCreateInfoKHR rendering_info{VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR};
+
+	VkRenderingAttachmentLocationInfoKHR attachment_location_info{VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_LOCATION_INFO_KHR};
+
+	VkRenderingInputAttachmentIndexInfoKHR input_attachment_index_info{VK_STRUCTURE_TYPE_RENDERING_INPUT_ATTACHMENT_INDEX_INFO_KHR};
+
+	VkPipelineFragmentShadingRateStateCreateInfoKHR fragment_shading_rate_state{VK_STRUCTURE_TYPE_PIPELINE_FRAGMENT_SHADING_RATE_STATE_CREATE_INFO_KHR};
+
+	std::vector<VkDynamicState> dynamic_states{
+	    VK_DYNAMIC_STATE_VIEWPORT,
+	    VK_DYNAMIC_STATE_SCISSOR,
+	    VK_DYNAMIC_STATE_LINE_WIDTH,
+	    VK_DYNAMIC_STATE_DEPTH_BIAS,
+	    VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+	    VK_DYNAMIC_STATE_DEPTH_BOUNDS,
+	    VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK,
+	    VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
+	    VK_DYNAMIC_STATE_STENCIL_REFERENCE,
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamic_state{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+};
+
+GraphicsPipelineBuilder::GraphicsPipelineBuilder(Device &device, const PipelineState &pipeline_state, VkGraphicsPipelineLibraryFlagsEXT parts) :
+    device{device}
+{
+	// Create specialization info from tracked state. This is shared by all shaders.
+	const auto &specialization_constant_state = pipeline_state.get_specialization_constant_state();
+
+	map_entries = specialization_constant_state.get_map_entries();
+	data.assign(specialization_constant_state.get_data().begin(), specialization_constant_state.get_data().end());
+
 	specialization_info.mapEntryCount = to_u32(map_entries.size());
 	specialization_info.pMapEntries   = map_entries.data();
 	specialization_info.dataSize      = data.size();
@@ -151,6 +275,13 @@ GraphicsPipeline::GraphicsPipeline(Device &        device,
 
 	for (const ShaderModule *shader_module : pipeline_state.get_pipeline_layout().get_shader_modules())
 	{
+		// The fragment shader is the only stage of its part, the others are pre-rasterization shaders
+		auto part = shader_module->get_stage() == VK_SHADER_STAGE_FRAGMENT_BIT ? VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT : VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+		if (!(parts & part))
+		{
+			continue;
+		}
+
 		VkPipelineShaderStageCreateInfo stage_create_info{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
 
 		stage_create_info.stage = shader_module->get_stage();
@@ -178,31 +309,21 @@ GraphicsPipeline::GraphicsPipeline(Device &        device,
 		shader_modules.push_back(stage_create_info.module);
 	}
 
-	VkGraphicsPipelineCreateInfo create_info{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
-
 	create_info.stageCount = to_u32(stage_create_infos.size());
 	create_info.pStages    = stage_create_infos.data();
 
-	VkPipelineVertexInputStateCreateInfo vertex_input_state{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-
 	vertex_input_state.pVertexAttributeDescriptions    = pipeline_state.get_vertex_input_state().attributes.data();
 	vertex_input_state.vertexAttributeDescriptionCount = to_u32(pipeline_state.get_vertex_input_state().attributes.size());
 
 	vertex_input_state.pVertexBindingDescriptions    = pipeline_state.get_vertex_input_state().bindings.data();
 	vertex_input_state.vertexBindingDescriptionCount = to_u32(pipeline_state.get_vertex_input_state().bindings.size());
 
-	VkPipelineInputAssemblyStateCreateInfo input_assembly_state{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
-
 	input_assembly_state.topology               = pipeline_state.get_input_assembly_state().topology;
 	input_assembly_state.primitiveRestartEnable = pipeline_state.get_input_assembly_state().primitive_restart_enable;
 
-	VkPipelineViewportStateCreateInfo viewport_state{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
-
 	viewport_state.viewportCount = pipeline_state.get_viewport_state().viewport_count;
 	viewport_state.scissorCount  = pipeline_state.get_viewport_state().scissor_count;
 
-	VkPipelineRasterizationStateCreateInfo rasterization_state{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
-
 	rasterization_state.depthClampEnable        = pipeline_state.get_rasterization_state().depth_clamp_enable;
 	rasterization_state.rasterizerDiscardEnable = pipeline_state.get_rasterization_state().rasterizer_discard_enable;
 	rasterization_state.polygonMode             = pipeline_state.get_rasterization_state().polygon_mode;
@@ -213,8 +334,6 @@ GraphicsPipeline::GraphicsPipeline(Device &        device,
 	rasterization_state.depthBiasSlopeFactor    = 1.0f;
 	rasterization_state.lineWidth               = 1.0f;
 
-	VkPipelineMultisampleStateCreateInfo multisample_state{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
-
 	multisample_state.sampleShadingEnable   = pipeline_state.get_multisample_state().sample_shading_enable;
 	multisample_state.rasterizationSamples  = pipeline_state.get_multisample_state().rasterization_samples;
 	multisample_state.minSampleShading      = pipeline_state.get_multisample_state().min_sample_shading;
@@ -226,8 +345,6 @@ GraphicsPipeline::GraphicsPipeline(Device &        device,
 		multisample_state.pSampleMask = &pipeline_state.get_multisample_state().sample_mask;
 	}
 
-	VkPipelineDepthStencilStateCreateInfo depth_stencil_state{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
-
 	depth_stencil_state.depthTestEnable       = pipeline_state.get_depth_stencil_state().depth_test_enable;
 	depth_stencil_state.depthWriteEnable      = pipeline_state.get_depth_stencil_state().depth_write_enable;
 	depth_stencil_state.depthCompareOp        = pipeline_state.get_depth_stencil_state().depth_compare_op;
@@ -248,58 +365,249 @@ GraphicsPipeline::GraphicsPipeline(Device &        device,
 	depth_stencil_state.back.writeMask        = ~0U;
 	depth_stencil_state.back.reference        = ~0U;
 
-	VkPipelineColorBlendStateCreateInfo color_blend_state{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+	// A subpass sharing the depth attachment of the rendering instance without using it
+	if (!pipeline_state.get_render_pass() && pipeline_state.get_rendering_state().depth_stencil_disabled)
+	{
+		depth_stencil_state.depthTestEnable       = VK_FALSE;
+		depth_stencil_state.depthWriteEnable      = VK_FALSE;
+		depth_stencil_state.depthBoundsTestEnable = VK_FALSE;
+		depth_stencil_state.stencilTestEnable     = VK_FALSE;
+	}
+
+	// Without a render pass, the blend states are those of the attachments of the rendering instance
+	color_blend_attachments = pipeline_state.get_render_pass() ? pipeline_state.get_color_blend_state().attachments : pipeline_state.get_rendering_color_blend_attachments();
 
 	color_blend_state.logicOpEnable     = pipeline_state.get_color_blend_state().logic_op_enable;
 	color_blend_state.logicOp           = pipeline_state.get_color_blend_state().logic_op;
-	color_blend_state.attachmentCount   = to_u32(pipeline_state.get_color_blend_state().attachments.size());
-	color_blend_state.pAttachments      = reinterpret_cast<const VkPipelineColorBlendAttachmentState *>(pipeline_state.get_color_blend_state().attachments.data());
+	color_blend_state.attachmentCount   = to_u32(color_blend_attachments.size());
+	color_blend_state.pAttachments      = reinterpret_cast<const VkPipelineColorBlendAttachmentState *>(color_blend_attachments.data());
 	color_blend_state.blendConstants[0] = 1.0f;
 	color_blend_state.blendConstants[1] = 1.0f;
 	color_blend_state.blendConstants[2] = 1.0f;
 	color_blend_state.blendConstants[3] = 1.0f;
 
-	std::array<VkDynamicState, 9> dynamic_states{
-	    VK_DYNAMIC_STATE_VIEWPORT,
-	    VK_DYNAMIC_STATE_SCISSOR,
-	    VK_DYNAMIC_STATE_LINE_WIDTH,
-	    VK_DYNAMIC_STATE_DEPTH_BIAS,
-	    VK_DYNAMIC_STATE_BLEND_CONSTANTS,
-	    VK_DYNAMIC_STATE_DEPTH_BOUNDS,
-	    VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK,
-	    VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
-	    VK_DYNAMIC_STATE_STENCIL_REFERENCE,
-	};
-
-	VkPipelineDynamicStateCreateInfo dynamic_state{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+	// The members of the pipeline state left out of its hash are set by the command buffer
+	const std::pair<uint32_t, std::vector<VkDynamicState>> extended_dynamic_states[] = {
+	    {DynamicPipelineState::VertexInput, {VK_DYNAMIC_STATE_VERTEX_INPUT_EXT}},
+	    {DynamicPipelineState::PrimitiveTopology, {VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT}},
+	    {DynamicPipelineState::CullMode, {VK_DYNAMIC_STATE_CULL_MODE_EXT}},
+	    {DynamicPipelineState::FrontFace, {VK_DYNAMIC_STATE_FRONT_FACE_EXT}},
+	    {DynamicPipelineState::DepthStencil,
+	     {VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT,
+	      VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE_EXT, VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT, VK_DYNAMIC_STATE_STENCIL_OP_EXT}},
+	    {DynamicPipelineState::PrimitiveRestart, {VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT}},
+	    {DynamicPipelineState::RasterizerDiscard, {VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE_EXT}},
+	    {DynamicPipelineState::DepthBiasEnable, {VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT}},
+	    {DynamicPipelineState::LogicOp, {VK_DYNAMIC_STATE_LOGIC_OP_EXT}},
+	    {DynamicPipelineState::PolygonMode, {VK_DYNAMIC_STATE_POLYGON_MODE_EXT}},
+	    {DynamicPipelineState::DepthClamp, {VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT}},
+	    {DynamicPipelineState::RasterizationSamples, {VK_DYNAMIC_STATE_RASTERIZATION_SAMPLES_EXT}},
+	    {DynamicPipelineState::SampleMask, {VK_DYNAMIC_STATE_SAMPLE_MASK_EXT}},
+	    {DynamicPipelineState::AlphaToCoverage, {VK_DYNAMIC_STATE_ALPHA_TO_COVERAGE_ENABLE_EXT}},
+	    {DynamicPipelineState::AlphaToOne, {VK_DYNAMIC_STATE_ALPHA_TO_ONE_ENABLE_EXT}},
+	    {DynamicPipelineState::LogicOpEnable, {VK_DYNAMIC_STATE_LOGIC_OP_ENABLE_EXT}},
+	    {DynamicPipelineState::ColorBlendEnable, {VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT}},
+	    {DynamicPipelineState::ColorBlendEquation, {VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT}},
+	    {DynamicPipelineState::ColorWriteMask, {VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT}}};
+
+	for (auto &extended_dynamic_state : extended_dynamic_states)
+	{
+		if (pipeline_state.get_dynamic_state() & extended_dynamic_state.first)
+		{
+			dynamic_states.insert(dynamic_states.end(), extended_dynamic_state.second.begin(), extended_dynamic_state.second.end());
+		}
+	}
 
 	dynamic_state.pDynamicStates    = dynamic_states.data();
 	dynamic_state.dynamicStateCount = to_u32(dynamic_states.size());
 
-	create_info.pVertexInputState   = &vertex_input_state;
-	create_info.pInputAssemblyState = &input_assembly_state;
-	create_info.pViewportState      = &viewport_state;
-	create_info.pRasterizationState = &rasterization_state;
-	create_info.pMultisampleState   = &multisample_state;
-	create_info.pDepthStencilState  = &depth_stencil_state;
-	create_info.pColorBlendState    = &color_blend_state;
-	create_info.pDynamicState       = &dynamic_state;
+	// Each part only reads its own state
+	if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT)
+	{
+		create_info.pVertexInputState   = &vertex_input_state;
+		create_info.pInputAssemblyState = &input_assembly_state;
+	}
 
-	create_info.layout     = pipeline_state.get_pipeline_layout().get_handle();
-	create_info.renderPass = pipeline_state.get_render_pass()->get_handle();
-	create_info.subpass    = pipeline_state.get_subpass_index();
+	if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT)
+	{
+		create_info.pViewportState      = &viewport_state;
+		create_info.pRasterizationState = &rasterization_state;
+	}
 
-	auto result = vkCreateGraphicsPipelines(device.get_handle(), pipeline_cache, 1, &create_info, nullptr, &handle);
+	if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)
+	{
+		create_info.pDepthStencilState = &depth_stencil_state;
+	}
 
-	if (result != VK_SUCCESS)
+	if (parts & (VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT))
 	{
-		throw VulkanException{result, "Cannot create GraphicsPipelines"};
+		create_info.pMultisampleState = &multisample_state;
+	}
+
+	if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT)
+	{
+		create_info.pColorBlendState = &color_blend_state;
+	}
+
+	create_info.pDynamicState = &dynamic_state;
+
+	create_info.layout = pipeline_state.get_pipeline_layout().get_handle();
+
+	if (auto render_pass = pipeline_state.get_render_pass())
+	{
+		create_info.renderPass = render_pass->get_handle();
+		create_info.subpass    = pipeline_state.get_subpass_index();
+	}
+	else
+	{
+		// Dynamic rendering, the pipeline is created for the formats of the attachments instead
+		auto &rendering_state = pipeline_state.get_rendering_state();
+
+		rendering_info.colorAttachmentCount    = to_u32(rendering_state.color_attachment_formats.size());
+		rendering_info.pColorAttachmentFormats = rendering_state.color_attachment_formats.data();
+		rendering_info.depthAttachmentFormat   = rendering_state.depth_attachment_format;
+		rendering_info.stencilAttachmentFormat = rendering_state.stencil_attachment_format;
+
+		// With local read, the pipeline matches the mapping of the attachments set for its subpass
+		if (rendering_state.local_read)
+		{
+			attachment_location_info.colorAttachmentCount      = to_u32(rendering_state.color_attachment_locations.size());
+			attachment_location_info.pColorAttachmentLocations = rendering_state.color_attachment_locations.data();
+
+			input_attachment_index_info.colorAttachmentCount         = to_u32(rendering_state.color_attachment_input_indices.size());
+			input_attachment_index_info.pColorAttachmentInputIndices = rendering_state.color_attachment_input_indices.data();
+			input_attachment_index_info.pDepthInputAttachmentIndex   = &rendering_state.depth_input_attachment_index;
+
+			// The stencil aspect is read through the same input attachment as the depth, if any
+			if (rendering_state.stencil_attachment_format != VK_FORMAT_UNDEFINED)
+			{
+				input_attachment_index_info.pStencilInputAttachmentIndex = &rendering_state.depth_input_attachment_index;
+			}
+
+			attachment_location_info.pNext = &input_attachment_index_info;
+			rendering_info.pNext           = &attachment_location_info;
+		}
+
+		// The instances with a shading rate attachment need pipelines created for them
+		if (rendering_state.shading_rate_attachment)
+		{
+			create_info.flags |= VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+		}
+
+		create_info.pNext = &rendering_info;
+	}
+
+	// Only chained when it isn't the default, so the devices without VK_KHR_fragment_shading_rate never see it
+	auto &fragment_shading_rate = pipeline_state.get_fragment_shading_rate_state();
+	bool  default_shading_rate  = fragment_shading_rate.fragment_size.width == 1 && fragment_shading_rate.fragment_size.height == 1 &&
+	                            fragment_shading_rate.combiner_ops == FragmentShadingRateState{}.combiner_ops;
+	if ((parts & (VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)) && !default_shading_rate)
+	{
+		fragment_shading_rate_state.fragmentSize   = fragment_shading_rate.fragment_size;
+		fragment_shading_rate_state.combinerOps[0] = fragment_shading_rate.combiner_ops[0];
+		fragment_shading_rate_state.combinerOps[1] = fragment_shading_rate.combiner_ops[1];
+		fragment_shading_rate_state.pNext          = create_info.pNext;
+
+		create_info.pNext = &fragment_shading_rate_state;
+	}
+
+	// Descriptor buffer layouts can only be used by pipelines created for descriptor buffers
+	if (device.uses_descriptor_buffers())
+	{
+		create_info.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
 	}
+}
 
+GraphicsPipelineBuilder::~GraphicsPipelineBuilder()
+{
 	for (auto shader_module : shader_modules)
 	{
 		vkDestroyShaderModule(device.get_handle(), shader_module, nullptr);
 	}
+}
+}        // namespace
+
+GraphicsPipelineLibrary::GraphicsPipelineLibrary(Device               &device,
+                                                 VkPipelineCache       pipeline_cache,
+                                                 PipelineLibraryState &library_state) :
+    Pipeline{device}
+{
+	GraphicsPipelineBuilder builder{device, library_state.pipeline_state, library_state.part};
+
+	VkGraphicsPipelineLibraryCreateInfoEXT library_info{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT};
+	library_info.flags = library_state.part;
+	library_info.pNext = builder.create_info.pNext;
+
+	builder.create_info.pNext = &library_info;
+
+	// Keeps what the driver needs to optimize across the libraries when linking them
+	builder.create_info.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+	auto result = create_graphics_pipeline(pipeline_cache, builder.create_info);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException{result, "Cannot create GraphicsPipelineLibrary"};
+	}
+
+	state = library_state.pipeline_state;
+}
+
+GraphicsPipeline::GraphicsPipeline(Device &        device,
+                                   VkPipelineCache pipeline_cache,
+                                   PipelineState & pipeline_state) :
+    Pipeline{device}
+{
+	GraphicsPipelineBuilder builder{device, pipeline_state, all_library_parts};
+
+	auto result = create_graphics_pipeline(pipeline_cache, builder.create_info);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException{result, "Cannot create GraphicsPipelines"};
+	}
+
+	state = pipeline_state;
+}
+
+GraphicsPipeline::GraphicsPipeline(Device                                             &device,
+                                   VkPipelineCache                                     pipeline_cache,
+                                   PipelineState                                      &pipeline_state,
+                                   const std::vector<const GraphicsPipelineLibrary *> &libraries,
+                                   bool                                                link_time_optimization) :
+    Pipeline{device}
+{
+	std::vector<VkPipeline> library_handles;
+	for (auto library : libraries)
+	{
+		library_handles.push_back(library->get_handle());
+	}
+
+	VkPipelineLibraryCreateInfoKHR library_info{VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR};
+	library_info.libraryCount = to_u32(library_handles.size());
+	library_info.pLibraries   = library_handles.data();
+
+	// The libraries hold the state, the layout is the one they were created with
+	VkGraphicsPipelineCreateInfo create_info{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+	create_info.pNext  = &library_info;
+	create_info.layout = pipeline_state.get_pipeline_layout().get_handle();
+
+	if (link_time_optimization)
+	{
+		create_info.flags |= VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+	}
+
+	if (device.uses_descriptor_buffers())
+	{
+		create_info.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+	}
+
+	auto result = create_graphics_pipeline(pipeline_cache, create_info);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException{result, "Cannot link GraphicsPipelineLibraries"};
+	}
 
 	state = pipeline_state;
 }
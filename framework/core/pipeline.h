@@ -1,4 +1,4 @@
-/* Copyright (c) 2019, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -25,6 +25,21 @@ namespace vkb
 {
 class Device;
 
+/**
+ * @brief What creating a pipeline cost, reported by the driver when VK_EXT_pipeline_creation_feedback is enabled
+ */
+struct PipelineCreationFeedback
+{
+	/// Time spent creating the pipeline, measured on the host if the driver doesn't report it
+	double duration_ms{0.0};
+
+	/// Whether the driver found the pipeline in the VkPipelineCache, without compiling it
+	bool cache_hit{false};
+
+	/// Whether the driver reported the feedback, otherwise it can't tell cache hits
+	bool reported{false};
+};
+
 class Pipeline
 {
   public:
@@ -44,12 +59,26 @@ class Pipeline
 
 	const PipelineState &get_state() const;
 
+	const PipelineCreationFeedback &get_creation_feedback() const;
+
   protected:
+	/**
+	 * @brief Creates the handle, with the creation feedback chained to the create info
+	 */
+	VkResult create_graphics_pipeline(VkPipelineCache pipeline_cache, VkGraphicsPipelineCreateInfo &create_info);
+
+	/**
+	 * @brief Creates the handle, with the creation feedback chained to the create info
+	 */
+	VkResult create_compute_pipeline(VkPipelineCache pipeline_cache, VkComputePipelineCreateInfo &create_info);
+
 	Device &device;
 
 	VkPipeline handle = VK_NULL_HANDLE;
 
 	PipelineState state;
+
+	PipelineCreationFeedback creation_feedback;
 };
 
 class ComputePipeline : public Pipeline
@@ -64,6 +93,33 @@ class ComputePipeline : public Pipeline
 	                PipelineState & pipeline_state);
 };
 
+/**
+ * @brief A part of a pipeline state, from which a graphics pipeline library is created
+ */
+struct PipelineLibraryState
+{
+	/// A single part of VK_EXT_graphics_pipeline_library
+	VkGraphicsPipelineLibraryFlagBitsEXT part;
+
+	const PipelineState &pipeline_state;
+};
+
+/**
+ * @brief One part of a graphics pipeline, see VK_EXT_graphics_pipeline_library
+ *        Only the state of its part is used, so pipeline states which only differ in other parts share the library.
+ */
+class GraphicsPipelineLibrary : public Pipeline
+{
+  public:
+	GraphicsPipelineLibrary(GraphicsPipelineLibrary &&) = default;
+
+	virtual ~GraphicsPipelineLibrary() = default;
+
+	GraphicsPipelineLibrary(Device               &device,
+	                        VkPipelineCache       pipeline_cache,
+	                        PipelineLibraryState &library_state);
+};
+
 class GraphicsPipeline : public Pipeline
 {
   public:
@@ -74,5 +130,16 @@ class GraphicsPipeline : public Pipeline
 	GraphicsPipeline(Device &        device,
 	                 VkPipelineCache pipeline_cache,
 	                 PipelineState & pipeline_state);
+
+	/**
+	 * @brief Links the graphics pipeline libraries of every part of a pipeline state
+	 * @param link_time_optimization Whether the driver optimizes across the libraries, which is slower to create than
+	 *        a fast link and as fast to run as a monolithic pipeline
+	 */
+	GraphicsPipeline(Device                                            &device,
+	                 VkPipelineCache                                    pipeline_cache,
+	                 PipelineState                                     &pipeline_state,
+	                 const std::vector<const GraphicsPipelineLibrary *> &libraries,
+	                 bool                                               link_time_optimization);
 };
 }        // namespace vkb
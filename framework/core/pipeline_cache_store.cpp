@@ -0,0 +1,245 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/pipeline_cache_store.h"
+
+#include <cstring>
+
+#include "core/device.h"
+#include "core/util/cache_file.hpp"
+#include "core/util/hash.hpp"
+#include "core/util/thread_role.hpp"
+
+namespace vkb
+{
+
+PipelineCacheStore::PipelineCacheStore(Device &device, const filesystem::Path &path, std::chrono::milliseconds period) :
+    device{device},
+    path{path},
+    period{period}
+{
+	auto data = load();
+	loaded    = !data.empty();
+
+	handle       = create_cache(data);
+	merged_cache = create_cache(data);
+
+	written_checksum = fnv1a_hash(data.data(), data.size());
+
+	if (period.count() > 0)
+	{
+		stop_worker   = std::make_unique<std::promise<void>>();
+		worker_thread = std::thread([this] {
+			merge_worker(stop_worker->get_future());
+		});
+	}
+}
+
+PipelineCacheStore::~PipelineCacheStore()
+{
+	if (stop_worker)
+	{
+		stop_worker->set_value();
+	}
+
+	if (worker_thread.joinable())
+	{
+		worker_thread.join();
+	}
+
+	try
+	{
+		flush();
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to write the pipeline cache to {}: {}", path.string(), e.what());
+	}
+
+	for (auto &it : thread_caches)
+	{
+		vkDestroyPipelineCache(device.get_handle(), it.second, nullptr);
+	}
+
+	vkDestroyPipelineCache(device.get_handle(), merged_cache, nullptr);
+	vkDestroyPipelineCache(device.get_handle(), handle, nullptr);
+}
+
+VkPipelineCache PipelineCacheStore::get_handle() const
+{
+	return handle;
+}
+
+VkPipelineCache PipelineCacheStore::get_thread_cache()
+{
+	std::lock_guard<std::mutex> guard(thread_caches_mutex);
+
+	auto &cache = thread_caches[std::this_thread::get_id()];
+	if (cache == VK_NULL_HANDLE)
+	{
+		cache = create_cache({});
+	}
+	return cache;
+}
+
+bool PipelineCacheStore::is_loaded() const
+{
+	return loaded;
+}
+
+void PipelineCacheStore::flush()
+{
+	std::lock_guard<std::mutex> guard(flush_mutex);
+
+	// Only the merge destination needs external synchronization, the sources may be in use by other threads
+	std::vector<VkPipelineCache> sources{handle};
+	{
+		std::lock_guard<std::mutex> thread_caches_guard(thread_caches_mutex);
+		for (auto &it : thread_caches)
+		{
+			sources.push_back(it.second);
+		}
+	}
+
+	VK_CHECK(vkMergePipelineCaches(device.get_handle(), merged_cache, to_u32(sources.size()), sources.data()));
+
+	size_t size{};
+	VK_CHECK(vkGetPipelineCacheData(device.get_handle(), merged_cache, &size, nullptr));
+
+	std::vector<uint8_t> data(size);
+	VkResult             result = vkGetPipelineCacheData(device.get_handle(), merged_cache, &size, data.data());
+	if (result != VK_SUCCESS)
+	{
+		LOGE("Detected Vulkan error: {}, pipeline cache data not saved.", vkb::to_string(result));
+		return;
+	}
+
+	auto checksum = fnv1a_hash(data.data(), data.size());
+	if (checksum == written_checksum)
+	{
+		return;
+	}
+
+	write(data);
+	written_checksum = checksum;
+}
+
+PipelineCacheStore::FileHeader PipelineCacheStore::make_header(const std::vector<uint8_t> &data) const
+{
+	auto &properties = device.get_gpu().get_properties();
+
+	FileHeader header{};
+	header.vendor_id      = properties.vendorID;
+	header.device_id      = properties.deviceID;
+	header.driver_version = properties.driverVersion;
+	std::memcpy(header.pipeline_cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+	header.data_size = data.size();
+	return header;
+}
+
+std::vector<uint8_t> PipelineCacheStore::load() const
+{
+	auto fs = filesystem::get();
+
+	if (!fs->is_file(path))
+	{
+		LOGI("No pipeline cache found at {}", path.string());
+		return {};
+	}
+
+	auto file_data = fs->read_file_binary(path);
+
+	CacheFileReader reader{file_data.data(), file_data.size(), Magic, Version};
+	FileHeader      header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		LOGW("Pipeline cache {} is truncated, ignoring it", path.string());
+		return {};
+	}
+
+	if (reader.get_status() == CacheFileReader::Status::Unsupported)
+	{
+		LOGW("Pipeline cache {} has an unsupported format version, ignoring it", path.string());
+		return {};
+	}
+
+	if (!reader.read(header) || header.data_size != reader.get_remaining_size())
+	{
+		LOGW("Pipeline cache {} is corrupted, ignoring it", path.string());
+		return {};
+	}
+
+	std::vector<uint8_t> data{reader.get_data(), reader.get_data() + reader.get_remaining_size()};
+
+	auto expected = make_header(data);
+
+	if (header.vendor_id != expected.vendor_id ||
+	    header.device_id != expected.device_id ||
+	    header.driver_version != expected.driver_version ||
+	    std::memcmp(header.pipeline_cache_uuid, expected.pipeline_cache_uuid, VK_UUID_SIZE) != 0)
+	{
+		LOGW("Pipeline cache {} was written by a different driver, ignoring it", path.string());
+		return {};
+	}
+
+	LOGI("Loaded {} bytes of pipeline cache from {}", data.size(), path.string());
+
+	return data;
+}
+
+void PipelineCacheStore::write(const std::vector<uint8_t> &data)
+{
+	CacheFileWriter writer{Magic, Version};
+	writer.append(make_header(data));
+	writer.append(data.data(), data.size());
+
+	// Renaming a complete file over the previous one leaves either of them if the process stops in between
+	auto fs        = filesystem::get();
+	auto temp_path = filesystem::Path{path}.concat(".tmp");
+	fs->write_file(temp_path, writer.finish());
+	fs->rename(temp_path, path);
+}
+
+VkPipelineCache PipelineCacheStore::create_cache(const std::vector<uint8_t> &data) const
+{
+	VkPipelineCacheCreateInfo create_info{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+	create_info.initialDataSize = data.size();
+	create_info.pInitialData    = data.data();
+
+	VkPipelineCache cache{VK_NULL_HANDLE};
+	VK_CHECK(vkCreatePipelineCache(device.get_handle(), &create_info, nullptr, &cache));
+	return cache;
+}
+
+void PipelineCacheStore::merge_worker(std::future<void> should_terminate)
+{
+	set_current_thread_role(ThreadRole::Background);
+
+	while (should_terminate.wait_for(period) == std::future_status::timeout)
+	{
+		try
+		{
+			flush();
+		}
+		catch (const std::exception &e)
+		{
+			LOGE("Failed to write the pipeline cache to {}: {}", path.string(), e.what());
+		}
+	}
+}
+}        // namespace vkb
@@ -0,0 +1,152 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "filesystem/filesystem.hpp"
+
+namespace vkb
+{
+class Device;
+
+/**
+ * @brief Keeps a VkPipelineCache on disk across runs
+ *
+ * The cache is loaded when the store is created, if the file was written by the same driver
+ * on the same device. Otherwise the store starts from an empty cache.
+ *
+ * Threads creating pipelines in parallel can use a cache of their own from get_thread_cache(),
+ * so they don't contend on the lock of the main cache. A background thread periodically merges
+ * the main cache and the thread caches into a cache only it accesses, and writes its data when
+ * it changed. The file is written next to its destination then renamed, so a crash never leaves
+ * a truncated file behind and loses at most the pipelines of the last period.
+ */
+class PipelineCacheStore
+{
+  public:
+	/// Default time between two merges of the caches
+	static constexpr std::chrono::seconds DefaultPeriod{10};
+
+	/**
+	 * @param device The device the caches are created on
+	 * @param path The file the cache is loaded from and written to
+	 * @param period Time between two merges, the background thread isn't started if zero
+	 */
+	PipelineCacheStore(Device &device, const filesystem::Path &path, std::chrono::milliseconds period = DefaultPeriod);
+
+	PipelineCacheStore(const PipelineCacheStore &) = delete;
+
+	PipelineCacheStore(PipelineCacheStore &&) = delete;
+
+	/**
+	 * @brief Stops the background thread and writes the cache a last time
+	 */
+	~PipelineCacheStore();
+
+	PipelineCacheStore &operator=(const PipelineCacheStore &) = delete;
+
+	PipelineCacheStore &operator=(PipelineCacheStore &&) = delete;
+
+	/**
+	 * @return The main cache, holding the pipelines loaded from the file
+	 */
+	VkPipelineCache get_handle() const;
+
+	/**
+	 * @return The cache of the calling thread, created on its first call
+	 */
+	VkPipelineCache get_thread_cache();
+
+	/**
+	 * @brief Merges the caches and writes the file if its data changed
+	 *        Safe to call from any thread, concurrently with the background thread.
+	 */
+	void flush();
+
+	/**
+	 * @return Whether the main cache started from the data of the file
+	 */
+	bool is_loaded() const;
+
+  private:
+	/// Marks the files written by the store
+	static constexpr uint32_t Magic = 0x43504B56;        // "VKPC"
+
+	static constexpr uint32_t Version = 2;
+
+	/**
+	 * @brief Starts the payload of the file, followed by the data of the cache
+	 *        The cache is only loaded by the device and driver which wrote it.
+	 */
+	struct FileHeader
+	{
+		uint32_t vendor_id;
+		uint32_t device_id;
+		uint32_t driver_version;
+		uint8_t  pipeline_cache_uuid[VK_UUID_SIZE];
+		uint64_t data_size;
+	};
+
+	FileHeader make_header(const std::vector<uint8_t> &data) const;
+
+	/**
+	 * @return The data of the file, empty if it is missing or wasn't written for this device
+	 */
+	std::vector<uint8_t> load() const;
+
+	void write(const std::vector<uint8_t> &data);
+
+	VkPipelineCache create_cache(const std::vector<uint8_t> &data) const;
+
+	void merge_worker(std::future<void> should_terminate);
+
+	Device &device;
+
+	filesystem::Path path;
+
+	std::chrono::milliseconds period;
+
+	VkPipelineCache handle{VK_NULL_HANDLE};
+
+	bool loaded{false};
+
+	std::mutex thread_caches_mutex;
+
+	std::unordered_map<std::thread::id, VkPipelineCache> thread_caches;
+
+	/// Destination of the merges, only accessed with flush_mutex held
+	VkPipelineCache merged_cache{VK_NULL_HANDLE};
+
+	std::mutex flush_mutex;
+
+	/// Checksum of the data last written
+	uint64_t written_checksum{0};
+
+	std::thread worker_thread;
+
+	std::unique_ptr<std::promise<void>> stop_worker;
+};
+}        // namespace vkb
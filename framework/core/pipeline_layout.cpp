@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2020, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -84,8 +84,14 @@ PipelineLayout::PipelineLayout(Device &device, const std::vector<ShaderModule *>
 		descriptor_set_layouts.emplace_back(&device.get_resource_cache().RequestDescriptorSetLayout(shader_set_it.first, shader_modules, shader_set_it.second));
 	}
 
+	// Vulkan allows a single push descriptor set per pipeline layout
+	if (std::count_if(descriptor_set_layouts.begin(), descriptor_set_layouts.end(),
+	                  [](const DescriptorSetLayout *descriptor_set_layout) { return descriptor_set_layout && descriptor_set_layout->IsPushDescriptor(); }) > 1)
+	{
+		throw std::runtime_error("Cannot create pipeline layout, only one descriptor set can have per-draw resources.");
+	}
+
 	// Collect all the descriptor set layout handles, maintaining set order
-	std::vector<VkDescriptorSetLayout> descriptor_set_layout_handles;
 	for (uint32_t i = 0; i < descriptor_set_layouts.size(); ++i)
 	{
 		if (descriptor_set_layouts[i])
@@ -99,7 +105,6 @@ PipelineLayout::PipelineLayout(Device &device, const std::vector<ShaderModule *>
 	}
 
 	// Collect all the push constant shader resources
-	std::vector<VkPushConstantRange> push_constant_ranges;
 	for (auto &push_constant_resource : get_resources(ShaderResourceType::PushConstant))
 	{
 		push_constant_ranges.push_back({push_constant_resource.stages, push_constant_resource.offset, push_constant_resource.size});
@@ -127,7 +132,9 @@ PipelineLayout::PipelineLayout(PipelineLayout &&other) :
     shader_modules{std::move(other.shader_modules)},
     shader_resources{std::move(other.shader_resources)},
     shader_sets{std::move(other.shader_sets)},
-    descriptor_set_layouts{std::move(other.descriptor_set_layouts)}
+    descriptor_set_layouts{std::move(other.descriptor_set_layouts)},
+    descriptor_set_layout_handles{std::move(other.descriptor_set_layout_handles)},
+    push_constant_ranges{std::move(other.push_constant_ranges)}
 {
 	other.handle = VK_NULL_HANDLE;
 }
@@ -176,6 +183,16 @@ const std::unordered_map<uint32_t, std::vector<ShaderResource>> &PipelineLayout:
 	return shader_sets;
 }
 
+const std::vector<VkDescriptorSetLayout> &PipelineLayout::get_descriptor_set_layout_handles() const
+{
+	return descriptor_set_layout_handles;
+}
+
+const std::vector<VkPushConstantRange> &PipelineLayout::get_push_constant_ranges() const
+{
+	return push_constant_ranges;
+}
+
 bool PipelineLayout::has_descriptor_set_layout(const uint32_t set_index) const
 {
 	return set_index < descriptor_set_layouts.size();
@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2020, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -51,6 +51,13 @@ class PipelineLayout
 
 	const std::unordered_map<uint32_t, std::vector<ShaderResource>> &get_shader_sets() const;
 
+	/**
+	 * @return The handles of the descriptor set layouts the pipeline layout was created with, in the same order
+	 */
+	const std::vector<VkDescriptorSetLayout> &get_descriptor_set_layout_handles() const;
+
+	const std::vector<VkPushConstantRange> &get_push_constant_ranges() const;
+
 	bool has_descriptor_set_layout(const uint32_t set_index) const;
 
 	DescriptorSetLayout &get_descriptor_set_layout(const uint32_t set_index) const;
@@ -73,5 +80,10 @@ class PipelineLayout
 
 	// The different descriptor set layouts for this pipeline layout
 	std::vector<DescriptorSetLayout *> descriptor_set_layouts;
+
+	// The handles the Vulkan pipeline layout was created with, also used by the shader objects created from it
+	std::vector<VkDescriptorSetLayout> descriptor_set_layout_handles;
+
+	std::vector<VkPushConstantRange> push_constant_ranges;
 };
 }        // namespace vkb
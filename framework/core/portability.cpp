@@ -0,0 +1,66 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/portability.h"
+
+#include "core/physical_device.h"
+
+namespace vkb
+{
+namespace portability
+{
+namespace
+{
+Settings settings;
+}        // namespace
+
+void set_settings(const Settings &settings_)
+{
+	settings = settings_;
+}
+
+const Settings &get_settings()
+{
+	return settings;
+}
+
+bool is_molten_vk(const PhysicalDevice &gpu)
+{
+	// The driver id is core in Vulkan 1.2, and exposed by MoltenVK with VK_KHR_driver_properties before that
+	if (!gpu.get_instance().is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) ||
+	    (gpu.get_properties().apiVersion < VK_API_VERSION_1_2 && !gpu.is_extension_supported(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME)))
+	{
+		return false;
+	}
+
+	VkPhysicalDeviceDriverPropertiesKHR driver_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES_KHR};
+	VkPhysicalDeviceProperties2KHR      properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &driver_properties;
+	vkGetPhysicalDeviceProperties2KHR(gpu.get_handle(), &properties);
+
+	return driver_properties.driverID == VK_DRIVER_ID_MOLTENVK;
+}
+
+Settings get_molten_vk_settings()
+{
+	Settings molten_vk_settings;
+	molten_vk_settings.prefer_push_descriptors   = true;
+	molten_vk_settings.persistent_pipeline_cache = true;
+	return molten_vk_settings;
+}
+}        // namespace portability
+}        // namespace vkb
@@ -0,0 +1,61 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class PhysicalDevice;
+
+namespace portability
+{
+/**
+ * @brief Tuning of the framework for the implementations layered over another API, such as MoltenVK over Metal
+ *
+ * MoltenVK encodes each allocated descriptor set into a Metal argument buffer, and translates the shaders of each
+ * pipeline to MSL with SPIRV-Cross before Metal compiles them. Both are slow compared to a native driver.
+ */
+struct Settings
+{
+	/// Push the set of the pipelines with a single descriptor set, instead of allocating and caching it
+	bool prefer_push_descriptors{false};
+
+	/// Keep the pipeline cache of the resource cache on disk, which holds the MSL of the shaders with MoltenVK,
+	/// so the shaders translated at the first launch aren't translated again
+	bool persistent_pipeline_cache{false};
+};
+
+/**
+ * @brief Sets the portability settings, to be called before the device is created
+ */
+void set_settings(const Settings &settings);
+
+const Settings &get_settings();
+
+/**
+ * @return Whether the physical device is implemented by MoltenVK
+ */
+bool is_molten_vk(const PhysicalDevice &gpu);
+
+/**
+ * @return The settings tuned for MoltenVK
+ */
+Settings get_molten_vk_settings();
+}        // namespace portability
+}        // namespace vkb
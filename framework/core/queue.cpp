@@ -22,6 +22,12 @@
 
 namespace vkb
 {
+std::mutex &get_queue_submission_mutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
 Queue::Queue(Device &device, uint32_t family_index, VkQueueFamilyProperties properties, VkBool32 can_present, uint32_t index) :
     device{device},
     family_index{family_index},
@@ -79,6 +85,7 @@ VkBool32 Queue::support_present() const
 
 VkResult Queue::submit(const std::vector<VkSubmitInfo> &submit_infos, VkFence fence) const
 {
+	std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
 	return vkQueueSubmit(handle, to_u32(submit_infos.size()), submit_infos.data(), fence);
 }
 
@@ -98,11 +105,13 @@ VkResult Queue::present(const VkPresentInfoKHR &present_info) const
 		return VK_ERROR_INCOMPATIBLE_DISPLAY_KHR;
 	}
 
+	std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
 	return vkQueuePresentKHR(handle, &present_info);
 }        // namespace vkb
 
 VkResult Queue::wait_idle() const
 {
+	std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
 	return vkQueueWaitIdle(handle);
 }
 }        // namespace vkb
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "common/helpers.h"
 #include "common/vk_common.h"
 #include "core/swapchain.h"
@@ -26,6 +28,13 @@ namespace vkb
 class Device;
 class CommandBuffer;
 
+/**
+ * @brief Serializes the submissions, presents and waits on the queues, which Vulkan requires to be externally synchronized
+ *        Held by Queue, HPPQueue, SubmissionBuilder and the device, so that scenes can be loaded on worker threads
+ *        while the render context submits its frames.
+ */
+std::mutex &get_queue_submission_mutex();
+
 class Queue
 {
   public:
@@ -0,0 +1,153 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/redundant_command_filter.h"
+
+#include <cstring>
+
+namespace vkb
+{
+namespace
+{
+template <typename T>
+bool equals(const std::vector<T> &recorded, const T *values, uint32_t count)
+{
+	return recorded.size() == count && std::memcmp(recorded.data(), values, count * sizeof(T)) == 0;
+}
+}        // namespace
+
+void RedundantCommandFilter::reset()
+{
+	vertex_bindings.clear();
+	index_buffer_bound    = false;
+	viewports_set         = false;
+	scissors_set          = false;
+	push_constants_layout = VK_NULL_HANDLE;
+	push_constants.clear();
+}
+
+bool RedundantCommandFilter::update_vertex_buffers(uint32_t first_binding, uint32_t binding_count, const VkBuffer *buffers, const VkDeviceSize *offsets)
+{
+	if (vertex_bindings.size() < first_binding + binding_count)
+	{
+		vertex_bindings.resize(first_binding + binding_count);
+	}
+
+	bool changed = false;
+	for (uint32_t i = 0; i < binding_count; ++i)
+	{
+		auto &binding = vertex_bindings[first_binding + i];
+		if (!binding.bound || binding.buffer != buffers[i] || binding.offset != offsets[i])
+		{
+			binding = {true, buffers[i], offsets[i]};
+			changed = true;
+		}
+	}
+
+	return record(changed);
+}
+
+bool RedundantCommandFilter::update_index_buffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type)
+{
+	bool changed = !index_buffer_bound || index_buffer != buffer || index_offset != offset || index_type != type;
+
+	index_buffer_bound = true;
+	index_buffer       = buffer;
+	index_offset       = offset;
+	index_type         = type;
+
+	return record(changed);
+}
+
+bool RedundantCommandFilter::update_viewports(uint32_t first, uint32_t count, const VkViewport *values, bool with_count)
+{
+	bool changed = !viewports_set || viewports_with_count != with_count || first_viewport != first || !equals(viewports, values, count);
+
+	if (changed)
+	{
+		viewports_set        = true;
+		viewports_with_count = with_count;
+		first_viewport       = first;
+		viewports.assign(values, values + count);
+	}
+
+	return record(changed);
+}
+
+bool RedundantCommandFilter::update_scissors(uint32_t first, uint32_t count, const VkRect2D *values, bool with_count)
+{
+	bool changed = !scissors_set || scissors_with_count != with_count || first_scissor != first || !equals(scissors, values, count);
+
+	if (changed)
+	{
+		scissors_set        = true;
+		scissors_with_count = with_count;
+		first_scissor       = first;
+		scissors.assign(values, values + count);
+	}
+
+	return record(changed);
+}
+
+bool RedundantCommandFilter::update_push_constants(VkPipelineLayout pipeline_layout, VkShaderStageFlags stages, const std::vector<uint8_t> &data)
+{
+	bool changed = push_constants_layout != pipeline_layout || push_constants_stages != stages || push_constants != data;
+
+	if (changed)
+	{
+		push_constants_layout = pipeline_layout;
+		push_constants_stages = stages;
+		push_constants        = data;
+	}
+
+	return record(changed);
+}
+
+void RedundantCommandFilter::bind_pipeline_layout(VkPipelineLayout pipeline_layout)
+{
+	// Comparing the handles is stricter than the compatibility rules, but never keeps values which were disturbed
+	if (push_constants_layout != pipeline_layout)
+	{
+		push_constants_layout = VK_NULL_HANDLE;
+		push_constants.clear();
+	}
+}
+
+void RedundantCommandFilter::add_skipped_commands(uint32_t count)
+{
+	skipped_command_count += count;
+}
+
+uint32_t RedundantCommandFilter::get_skipped_command_count() const
+{
+	return skipped_command_count;
+}
+
+void RedundantCommandFilter::reset_skipped_command_count()
+{
+	skipped_command_count = 0;
+}
+
+bool RedundantCommandFilter::record(bool changed)
+{
+	if (!changed)
+	{
+		++skipped_command_count;
+	}
+	return changed;
+}
+}        // namespace vkb
@@ -0,0 +1,129 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "common/vk_common.h"
+
+namespace vkb
+{
+/**
+ * @brief Shadow of the state set by the commands a CommandBuffer records directly
+ *
+ * Vertex and index buffers, viewports, scissors and push constants are recorded whenever they are set,
+ * and the scene renderers set them for every draw. The filter remembers the last values recorded, so a
+ * command setting the values already in place is skipped and counted instead.
+ *
+ * The state is unknown after begin() and after executing secondary command buffers. Commands recorded on
+ * the handle of the command buffer bypass the filter, so a sample mixing them with the wrapper must call
+ * reset() after its own commands.
+ */
+class RedundantCommandFilter
+{
+  public:
+	/**
+	 * @brief Forgets the state, the next commands are all recorded
+	 */
+	void reset();
+
+	/**
+	 * @brief Updates the state with a command, each returns false if it doesn't change it so it can be skipped
+	 */
+	bool update_vertex_buffers(uint32_t first_binding, uint32_t binding_count, const VkBuffer *buffers, const VkDeviceSize *offsets);
+
+	bool update_index_buffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType index_type);
+
+	/**
+	 * @param with_count Whether the command also sets the viewport count, with shader objects
+	 */
+	bool update_viewports(uint32_t first_viewport, uint32_t viewport_count, const VkViewport *viewports, bool with_count);
+
+	bool update_scissors(uint32_t first_scissor, uint32_t scissor_count, const VkRect2D *scissors, bool with_count);
+
+	bool update_push_constants(VkPipelineLayout pipeline_layout, VkShaderStageFlags stages, const std::vector<uint8_t> &data);
+
+	/**
+	 * @brief Called when a pipeline is bound, the push constants are lost if its layout differs from the one they were pushed with
+	 */
+	void bind_pipeline_layout(VkPipelineLayout pipeline_layout);
+
+	/**
+	 * @brief Adds the commands skipped by another filter, such as the one of a secondary command buffer
+	 */
+	void add_skipped_commands(uint32_t count);
+
+	/**
+	 * @return The number of commands skipped since the command buffer began
+	 */
+	uint32_t get_skipped_command_count() const;
+
+	/**
+	 * @brief Clears the count of skipped commands, when the command buffer begins
+	 */
+	void reset_skipped_command_count();
+
+  private:
+	struct VertexBinding
+	{
+		bool bound{false};
+
+		VkBuffer buffer{VK_NULL_HANDLE};
+
+		VkDeviceSize offset{0};
+	};
+
+	/// Returns whether the command must be recorded, counting it otherwise
+	bool record(bool changed);
+
+	std::vector<VertexBinding> vertex_bindings;
+
+	bool index_buffer_bound{false};
+
+	VkBuffer index_buffer{VK_NULL_HANDLE};
+
+	VkDeviceSize index_offset{0};
+
+	VkIndexType index_type{VK_INDEX_TYPE_UINT16};
+
+	/// Viewports and scissors of the last command, compared as a whole
+	bool viewports_set{false};
+
+	bool viewports_with_count{false};
+
+	uint32_t first_viewport{0};
+
+	std::vector<VkViewport> viewports;
+
+	bool scissors_set{false};
+
+	bool scissors_with_count{false};
+
+	uint32_t first_scissor{0};
+
+	std::vector<VkRect2D> scissors;
+
+	VkPipelineLayout push_constants_layout{VK_NULL_HANDLE};
+
+	VkShaderStageFlags push_constants_stages{0};
+
+	std::vector<uint8_t> push_constants;
+
+	uint32_t skipped_command_count{0};
+};
+}        // namespace vkb
@@ -77,6 +77,18 @@ inline void set_pointer_next(VkSubpassDescription2KHR &subpass_description, VkSu
 	subpass_description.pNext                    = &depth_resolve;
 }
 
+inline void set_shading_rate_attachment(VkSubpassDescription &subpass_description, VkFragmentShadingRateAttachmentInfoKHR &shading_rate_info, VkAttachmentReference &shading_rate_attachment)
+{
+	// VkSubpassDescription cannot have pNext point to a VkFragmentShadingRateAttachmentInfoKHR containing a VkAttachmentReference
+}
+
+inline void set_shading_rate_attachment(VkSubpassDescription2KHR &subpass_description, VkFragmentShadingRateAttachmentInfoKHR &shading_rate_info, VkAttachmentReference2KHR &shading_rate_attachment)
+{
+	shading_rate_info.pFragmentShadingRateAttachment = &shading_rate_attachment;
+	shading_rate_info.pNext                          = subpass_description.pNext;
+	subpass_description.pNext                        = &shading_rate_info;
+}
+
 inline const VkAttachmentReference2KHR *get_depth_resolve_reference(const VkSubpassDescription &subpass_description)
 {
 	// VkSubpassDescription cannot have pNext point to a VkSubpassDescriptionDepthStencilResolveKHR containing a VkAttachmentReference2KHR
@@ -85,12 +97,17 @@ inline const VkAttachmentReference2KHR *get_depth_resolve_reference(const VkSubp
 
 inline const VkAttachmentReference2KHR *get_depth_resolve_reference(const VkSubpassDescription2KHR &subpass_description)
 {
-	auto description_depth_resolve = static_cast<const VkSubpassDescriptionDepthStencilResolveKHR *>(subpass_description.pNext);
+	// The depth stencil resolve may follow the shading rate attachment in the chain
+	auto next = static_cast<const VkBaseInStructure *>(subpass_description.pNext);
+	while (next && next->sType != VK_STRUCTURE_TYPE_SUBPASS_DESCRIPTION_DEPTH_STENCIL_RESOLVE_KHR)
+	{
+		next = next->pNext;
+	}
 
 	const VkAttachmentReference2KHR *depth_resolve_attachment = nullptr;
-	if (description_depth_resolve)
+	if (next)
 	{
-		depth_resolve_attachment = description_depth_resolve->pDepthStencilResolveAttachment;
+		depth_resolve_attachment = reinterpret_cast<const VkSubpassDescriptionDepthStencilResolveKHR *>(next)->pDepthStencilResolveAttachment;
 	}
 
 	return depth_resolve_attachment;
@@ -123,6 +140,12 @@ std::vector<T> get_attachment_descriptions(const std::vector<Attachment> &attach
 		attachment.finalLayout =
 		    vkb::is_depth_format(attachment.format) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+		// The shading rate attachment is only read, it stays in its layout
+		if (attachments[i].usage & VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR)
+		{
+			attachment.finalLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+		}
+
 		if (i < load_store_infos.size())
 		{
 			attachment.loadOp         = load_store_infos[i].load_op;
@@ -253,13 +276,18 @@ std::vector<T> get_subpass_dependencies(const size_t subpass_count)
 	{
 		for (uint32_t i = 0; i < to_u32(dependencies.size()); ++i)
 		{
-			// Transition input attachments from color attachment to shader read
-			dependencies[i].srcSubpass      = i;
-			dependencies[i].dstSubpass      = i + 1;
-			dependencies[i].srcStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependencies[i].dstStageMask    = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-			dependencies[i].srcAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			dependencies[i].dstAccessMask   = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+			// Transition input attachments from color or depth attachment to shader read,
+			// and order the attachments written again by the next subpass, as well as the
+			// storage written by the fragment shaders, e.g. an order-independent transparency k-buffer
+			dependencies[i].srcSubpass   = i;
+			dependencies[i].dstSubpass   = i + 1;
+			dependencies[i].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			dependencies[i].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+			                               VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			dependencies[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			dependencies[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
+			                                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+			                                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 			dependencies[i].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 		}
 	}
@@ -290,6 +318,7 @@ void RenderPass::create_renderpass(const std::vector<Attachment> &attachments, c
 	std::vector<std::vector<T_AttachmentReference>> depth_stencil_attachments{subpass_count};
 	std::vector<std::vector<T_AttachmentReference>> color_resolve_attachments{subpass_count};
 	std::vector<std::vector<T_AttachmentReference>> depth_resolve_attachments{subpass_count};
+	std::vector<std::vector<T_AttachmentReference>> shading_rate_attachments{subpass_count};
 
 	std::string new_debug_name{};
 	const bool  needs_debug_name = get_debug_name().empty();
@@ -355,6 +384,7 @@ void RenderPass::create_renderpass(const std::vector<Attachment> &attachments, c
 	std::vector<T_SubpassDescription> subpass_descriptions;
 	subpass_descriptions.reserve(subpass_count);
 	VkSubpassDescriptionDepthStencilResolveKHR depth_resolve{};
+	std::vector<VkFragmentShadingRateAttachmentInfoKHR> shading_rate_infos(subpass_count, {VK_STRUCTURE_TYPE_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR});
 	for (size_t i = 0; i < subpasses.size(); ++i)
 	{
 		auto &subpass = subpasses[i];
@@ -393,6 +423,12 @@ void RenderPass::create_renderpass(const std::vector<Attachment> &attachments, c
 			}
 		}
 
+		if (!shading_rate_attachments[i].empty())
+		{
+			shading_rate_infos[i].shadingRateAttachmentTexelSize = subpass.shading_rate_texel_size;
+			set_shading_rate_attachment(subpass_description, shading_rate_infos[i], shading_rate_attachments[i][0]);
+		}
+
 		subpass_descriptions.push_back(subpass_description);
 	}
 
@@ -415,6 +451,11 @@ void RenderPass::create_renderpass(const std::vector<Attachment> &attachments, c
 				continue;
 			}
 
+			if (attachments[k].usage & VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR)
+			{
+				continue;
+			}
+
 			color_attachments[0].push_back(get_attachment_reference<T_AttachmentReference>(k, VK_IMAGE_LAYOUT_GENERAL));
 		}
 
@@ -432,6 +473,12 @@ void RenderPass::create_renderpass(const std::vector<Attachment> &attachments, c
 
 	set_attachment_layouts<T_SubpassDescription, T_AttachmentDescription, T_AttachmentReference>(subpass_descriptions, attachment_descriptions);
 
+	final_layouts.reserve(attachment_descriptions.size());
+	for (auto &attachment_description : attachment_descriptions)
+	{
+		final_layouts.push_back(attachment_description.finalLayout);
+	}
+
 	color_output_count.reserve(subpass_count);
 	for (size_t i = 0; i < subpass_count; i++)
 	{
@@ -480,7 +527,8 @@ RenderPass::RenderPass(Device &device, const std::vector<Attachment> &attachment
 RenderPass::RenderPass(RenderPass &&other) :
     VulkanResource{std::move(other)},
     subpass_count{other.subpass_count},
-    color_output_count{other.color_output_count}
+    color_output_count{other.color_output_count},
+    final_layouts{other.final_layouts}
 {}
 
 RenderPass::~RenderPass()
@@ -497,6 +545,11 @@ const uint32_t RenderPass::get_color_output_count(uint32_t subpass_index) const
 	return color_output_count[subpass_index];
 }
 
+const std::vector<VkImageLayout> &RenderPass::get_final_layouts() const
+{
+	return final_layouts;
+}
+
 const VkExtent2D RenderPass::get_render_area_granularity() const
 {
 	VkExtent2D render_area_granularity = {};
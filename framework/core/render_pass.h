@@ -41,6 +41,12 @@ struct SubpassInfo
 	VkResolveModeFlagBits depth_stencil_resolve_mode;
 
 	std::string debug_name;
+
+	/// Attachment controlling the fragment shading rate of the subpass, needs VK_KHR_create_renderpass2
+	uint32_t shading_rate_attachment{VK_ATTACHMENT_UNUSED};
+
+	/// Size of the framebuffer region covered by a texel of the shading rate attachment
+	VkExtent2D shading_rate_texel_size{};
 };
 
 class RenderPass : public vkb::core::VulkanResourceC<VkRenderPass>
@@ -63,6 +69,11 @@ class RenderPass : public vkb::core::VulkanResourceC<VkRenderPass>
 
 	const uint32_t get_color_output_count(uint32_t subpass_index) const;
 
+	/**
+	 * @return The layouts the render pass leaves its attachments in, in the order of the attachments
+	 */
+	const std::vector<VkImageLayout> &get_final_layouts() const;
+
 	const VkExtent2D get_render_area_granularity() const;
 
   private:
@@ -72,5 +83,7 @@ class RenderPass : public vkb::core::VulkanResourceC<VkRenderPass>
 	void create_renderpass(const std::vector<Attachment> &attachments, const std::vector<LoadStoreInfo> &load_store_infos, const std::vector<SubpassInfo> &subpasses);
 
 	std::vector<uint32_t> color_output_count;
+
+	std::vector<VkImageLayout> final_layouts;
 };
 }        // namespace vkb
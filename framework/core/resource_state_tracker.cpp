@@ -0,0 +1,335 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/resource_state_tracker.h"
+
+#include <cassert>
+
+#include "common/helpers.h"
+
+namespace vkb
+{
+namespace core
+{
+namespace
+{
+constexpr VkAccessFlags2KHR write_access_mask = VK_ACCESS_2_SHADER_WRITE_BIT_KHR | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR |
+                                                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR |
+                                                VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR | VK_ACCESS_2_HOST_WRITE_BIT_KHR |
+                                                VK_ACCESS_2_MEMORY_WRITE_BIT_KHR | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+/**
+ * @brief Source scope and layouts of the barrier an access needs
+ */
+struct Transition
+{
+	VkPipelineStageFlags2KHR src_stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+	VkAccessFlags2KHR src_access{VK_ACCESS_2_NONE_KHR};
+
+	VkImageLayout old_layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+	VkImageLayout new_layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+	/// Whether the access needs a barrier at all
+	bool needed{false};
+
+	bool operator==(const Transition &other) const
+	{
+		return needed == other.needed && src_stages == other.src_stages && src_access == other.src_access &&
+		       old_layout == other.old_layout && new_layout == other.new_layout;
+	}
+};
+
+/**
+ * @brief Moves a subresource to the state of an access, returns the barrier the access needs
+ */
+Transition synchronize(SubresourceState &current, const ResourceState &state, bool discard)
+{
+	Transition transition{current.write_stages, current.write_access, current.layout, current.layout};
+
+	bool write          = (state.access & write_access_mask) != 0;
+	bool layout_changes = state.layout != VK_IMAGE_LAYOUT_UNDEFINED && state.layout != current.layout;
+
+	if (!write && !layout_changes)
+	{
+		// A read only waits for the last write, once per stage and access
+		bool visible = (state.stages & ~current.visible_stages) == 0 && (state.access & ~current.visible_access) == 0;
+
+		current.read_stages |= state.stages;
+		if (current.write_stages == VK_PIPELINE_STAGE_2_NONE_KHR || visible)
+		{
+			return transition;
+		}
+
+		current.visible_stages |= state.stages;
+		current.visible_access |= state.access;
+	}
+	else
+	{
+		// A write or a layout transition also waits for the reads since the last write
+		transition.src_stages |= current.read_stages;
+
+		current.write_stages   = state.stages;
+		current.write_access   = write ? state.access & write_access_mask : VK_ACCESS_2_NONE_KHR;
+		current.read_stages    = VK_PIPELINE_STAGE_2_NONE_KHR;
+		current.visible_stages = write ? VK_PIPELINE_STAGE_2_NONE_KHR : state.stages;
+		current.visible_access = write ? VK_ACCESS_2_NONE_KHR : state.access;
+
+		if (layout_changes)
+		{
+			current.layout        = state.layout;
+			transition.new_layout = state.layout;
+		}
+		else if (transition.src_stages == VK_PIPELINE_STAGE_2_NONE_KHR)
+		{
+			return transition;
+		}
+
+		if (discard)
+		{
+			transition.old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		}
+	}
+
+	transition.needed = true;
+	return transition;
+}
+}        // namespace
+
+bool SubresourceState::operator==(const SubresourceState &other) const
+{
+	return layout == other.layout && write_stages == other.write_stages && write_access == other.write_access &&
+	       read_stages == other.read_stages && visible_stages == other.visible_stages && visible_access == other.visible_access;
+}
+
+void ImageStateTracker::reset(uint32_t mip_levels_, uint32_t array_layers_, VkImageLayout layout)
+{
+	mip_levels   = mip_levels_;
+	array_layers = array_layers_;
+
+	SubresourceState initial_state{};
+	initial_state.layout = layout;
+	states.assign(mip_levels * array_layers, initial_state);
+}
+
+bool ImageStateTracker::is_initialized() const
+{
+	return !states.empty();
+}
+
+void ImageStateTracker::request(VkImage image, const VkImageSubresourceRange &range, const ResourceState &state, bool discard, std::vector<VkImageMemoryBarrier2KHR> &barriers)
+{
+	assert(is_initialized() && "Image state tracker used before being reset");
+
+	uint32_t level_count = range.levelCount == VK_REMAINING_MIP_LEVELS ? mip_levels - range.baseMipLevel : range.levelCount;
+	uint32_t layer_count = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? array_layers - range.baseArrayLayer : range.layerCount;
+	assert(range.baseMipLevel + level_count <= mip_levels && range.baseArrayLayer + layer_count <= array_layers);
+
+	size_t first_barrier = barriers.size();
+
+	// Appends the barrier of a run of layers, or extends the barrier of the same layers at the previous mip level
+	auto add_barrier = [&](const Transition &transition, uint32_t mip_level, uint32_t base_layer, uint32_t run_layers) {
+		for (size_t i = first_barrier; i < barriers.size(); ++i)
+		{
+			auto &barrier = barriers[i];
+			if (barrier.srcStageMask == transition.src_stages && barrier.srcAccessMask == transition.src_access &&
+			    barrier.oldLayout == transition.old_layout && barrier.newLayout == transition.new_layout &&
+			    barrier.subresourceRange.baseArrayLayer == base_layer && barrier.subresourceRange.layerCount == run_layers &&
+			    barrier.subresourceRange.baseMipLevel + barrier.subresourceRange.levelCount == mip_level)
+			{
+				++barrier.subresourceRange.levelCount;
+				return;
+			}
+		}
+
+		VkImageMemoryBarrier2KHR barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR};
+		barrier.srcStageMask        = transition.src_stages;
+		barrier.srcAccessMask       = transition.src_access;
+		barrier.dstStageMask        = state.stages;
+		barrier.dstAccessMask       = state.access;
+		barrier.oldLayout           = transition.old_layout;
+		barrier.newLayout           = transition.new_layout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image               = image;
+		barrier.subresourceRange    = {range.aspectMask, mip_level, 1, base_layer, run_layers};
+		barriers.push_back(barrier);
+	};
+
+	for (uint32_t mip_level = range.baseMipLevel; mip_level < range.baseMipLevel + level_count; ++mip_level)
+	{
+		Transition run_transition{};
+		uint32_t   run_base_layer = range.baseArrayLayer;
+
+		for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layer_count; ++layer)
+		{
+			auto transition = synchronize(states[mip_level * array_layers + layer], state, discard);
+			if (layer != run_base_layer && !(transition == run_transition))
+			{
+				if (run_transition.needed)
+				{
+					add_barrier(run_transition, mip_level, run_base_layer, layer - run_base_layer);
+				}
+				run_base_layer = layer;
+			}
+			run_transition = transition;
+		}
+
+		if (run_transition.needed)
+		{
+			add_barrier(run_transition, mip_level, run_base_layer, range.baseArrayLayer + layer_count - run_base_layer);
+		}
+	}
+}
+
+void ImageStateTracker::set_state(const VkImageSubresourceRange &range, const ResourceState &state)
+{
+	assert(is_initialized() && "Image state tracker used before being reset");
+
+	uint32_t level_count = range.levelCount == VK_REMAINING_MIP_LEVELS ? mip_levels - range.baseMipLevel : range.levelCount;
+	uint32_t layer_count = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? array_layers - range.baseArrayLayer : range.layerCount;
+
+	// The access is considered a write, so the next one waits for it
+	SubresourceState subresource_state{};
+	subresource_state.layout       = state.layout;
+	subresource_state.write_stages = state.stages;
+	subresource_state.write_access = state.access & write_access_mask;
+
+	for (uint32_t mip_level = range.baseMipLevel; mip_level < range.baseMipLevel + level_count; ++mip_level)
+	{
+		for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layer_count; ++layer)
+		{
+			states[mip_level * array_layers + layer] = subresource_state;
+		}
+	}
+}
+
+const SubresourceState &ImageStateTracker::get_state(uint32_t mip_level, uint32_t array_layer) const
+{
+	assert(mip_level < mip_levels && array_layer < array_layers);
+	return states[mip_level * array_layers + array_layer];
+}
+
+void BufferStateTracker::request(VkBuffer buffer, const ResourceState &state, std::vector<VkBufferMemoryBarrier2KHR> &barriers)
+{
+	// Buffers have no layout
+	ResourceState buffer_state = state;
+	buffer_state.layout        = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	auto transition = synchronize(this->state, buffer_state, false);
+	if (!transition.needed)
+	{
+		return;
+	}
+
+	VkBufferMemoryBarrier2KHR barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR};
+	barrier.srcStageMask        = transition.src_stages;
+	barrier.srcAccessMask       = transition.src_access;
+	barrier.dstStageMask        = state.stages;
+	barrier.dstAccessMask       = state.access;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer              = buffer;
+	barrier.offset              = 0;
+	barrier.size                = VK_WHOLE_SIZE;
+	barriers.push_back(barrier);
+}
+
+void BufferStateTracker::set_state(const ResourceState &state)
+{
+	this->state              = {};
+	this->state.write_stages = state.stages;
+	this->state.write_access = state.access & write_access_mask;
+}
+
+const SubresourceState &BufferStateTracker::get_state() const
+{
+	return state;
+}
+
+void record_pipeline_barrier(VkCommandBuffer                               command_buffer,
+                             bool                                          synchronization2,
+                             const std::vector<VkImageMemoryBarrier2KHR>  &image_barriers,
+                             const std::vector<VkBufferMemoryBarrier2KHR> &buffer_barriers)
+{
+	if (image_barriers.empty() && buffer_barriers.empty())
+	{
+		return;
+	}
+
+	if (synchronization2)
+	{
+		VkDependencyInfoKHR dependency_info{VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR};
+		dependency_info.bufferMemoryBarrierCount = to_u32(buffer_barriers.size());
+		dependency_info.pBufferMemoryBarriers    = buffer_barriers.data();
+		dependency_info.imageMemoryBarrierCount  = to_u32(image_barriers.size());
+		dependency_info.pImageMemoryBarriers     = image_barriers.data();
+		vkCmdPipelineBarrier2KHR(command_buffer, &dependency_info);
+		return;
+	}
+
+	// The stages and accesses of synchronization1 have the same values in synchronization2
+	VkPipelineStageFlags src_stages = 0;
+	VkPipelineStageFlags dst_stages = 0;
+
+	std::vector<VkBufferMemoryBarrier> buffer_barriers1;
+	buffer_barriers1.reserve(buffer_barriers.size());
+	for (auto &barrier : buffer_barriers)
+	{
+		VkBufferMemoryBarrier barrier1{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+		barrier1.srcAccessMask       = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+		barrier1.dstAccessMask       = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+		barrier1.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+		barrier1.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+		barrier1.buffer              = barrier.buffer;
+		barrier1.offset              = barrier.offset;
+		barrier1.size                = barrier.size;
+		buffer_barriers1.push_back(barrier1);
+
+		src_stages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+		dst_stages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+	}
+
+	std::vector<VkImageMemoryBarrier> image_barriers1;
+	image_barriers1.reserve(image_barriers.size());
+	for (auto &barrier : image_barriers)
+	{
+		VkImageMemoryBarrier barrier1{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+		barrier1.srcAccessMask       = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+		barrier1.dstAccessMask       = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+		barrier1.oldLayout           = barrier.oldLayout;
+		barrier1.newLayout           = barrier.newLayout;
+		barrier1.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+		barrier1.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+		barrier1.image               = barrier.image;
+		barrier1.subresourceRange    = barrier.subresourceRange;
+		image_barriers1.push_back(barrier1);
+
+		src_stages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+		dst_stages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+	}
+
+	vkCmdPipelineBarrier(command_buffer,
+	                     src_stages ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+	                     dst_stages ? dst_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+	                     0, 0, nullptr,
+	                     to_u32(buffer_barriers1.size()), buffer_barriers1.data(),
+	                     to_u32(image_barriers1.size()), image_barriers1.data());
+}
+}        // namespace core
+}        // namespace vkb
@@ -0,0 +1,141 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "common/vk_common.h"
+
+namespace vkb
+{
+namespace core
+{
+/**
+ * @brief State an access needs a resource in: the layout of an image and the stages and accesses using it
+ */
+struct ResourceState
+{
+	/// Layout the image is accessed in, undefined keeps the current layout. Ignored for buffers.
+	VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+	VkPipelineStageFlags2KHR stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+	VkAccessFlags2KHR access{VK_ACCESS_2_NONE_KHR};
+};
+
+/**
+ * @brief Synchronization state of a subresource between the accesses recorded to it
+ */
+struct SubresourceState
+{
+	VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+	/// Stages of the last write or layout transition, and the accesses it wrote with
+	VkPipelineStageFlags2KHR write_stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+	VkAccessFlags2KHR write_access{VK_ACCESS_2_NONE_KHR};
+
+	/// Stages reading the subresource since the last write, a later write waits for them
+	VkPipelineStageFlags2KHR read_stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+	/// Stages and accesses the last write was made visible to
+	VkPipelineStageFlags2KHR visible_stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+	VkAccessFlags2KHR visible_access{VK_ACCESS_2_NONE_KHR};
+
+	bool operator==(const SubresourceState &other) const;
+};
+
+/**
+ * @brief Tracks the state of each mip level and array layer of an image
+ *
+ * Requesting the state of the next access to a range of subresources moves them to it, and appends the
+ * barriers the access needs: none for a read after a read in the same layout, or after a write already made
+ * visible to it. Neighbouring subresources needing the same barrier share one.
+ *
+ * The state is that of the last access recorded, so command buffers using an image must be submitted in
+ * the order they were recorded in, and record it from a single thread at a time. Transitions recorded
+ * without the tracker are reported with set_state(), as CommandBuffer::end_render_pass() does for the
+ * final layouts of the attachments.
+ */
+class ImageStateTracker
+{
+  public:
+	/**
+	 * @brief Forgets the past accesses, all subresources start in the layout
+	 */
+	void reset(uint32_t mip_levels, uint32_t array_layers, VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+	/**
+	 * @return Whether the tracker was reset with the size of the image
+	 */
+	bool is_initialized() const;
+
+	/**
+	 * @brief Moves the subresources of the range to the state, appending the barriers needed to the list
+	 * @param discard Whether the access overwrites the previous contents, a layout transition then starts from undefined
+	 */
+	void request(VkImage image, const VkImageSubresourceRange &range, const ResourceState &state, bool discard, std::vector<VkImageMemoryBarrier2KHR> &barriers);
+
+	/**
+	 * @brief Sets the state of the subresources of the range after an access synchronized without the tracker
+	 */
+	void set_state(const VkImageSubresourceRange &range, const ResourceState &state);
+
+	const SubresourceState &get_state(uint32_t mip_level, uint32_t array_layer) const;
+
+  private:
+	uint32_t mip_levels{0};
+
+	uint32_t array_layers{0};
+
+	/// States of the subresources, the array layers of each mip level in a row
+	std::vector<SubresourceState> states;
+};
+
+/**
+ * @brief Tracks the state of a buffer, all its ranges being accessed alike
+ *        The same ordering rules as for an ImageStateTracker apply.
+ */
+class BufferStateTracker
+{
+  public:
+	/**
+	 * @brief Moves the buffer to the state, appending the barrier needed to the list
+	 */
+	void request(VkBuffer buffer, const ResourceState &state, std::vector<VkBufferMemoryBarrier2KHR> &barriers);
+
+	void set_state(const ResourceState &state);
+
+	const SubresourceState &get_state() const;
+
+  private:
+	SubresourceState state;
+};
+
+/**
+ * @brief Records the barriers in a single pipeline barrier
+ *        Without VK_KHR_synchronization2 the stages and accesses are recorded as their synchronization1 equivalent,
+ *        so they must only use the bits of synchronization1.
+ */
+void record_pipeline_barrier(VkCommandBuffer                               command_buffer,
+                             bool                                          synchronization2,
+                             const std::vector<VkImageMemoryBarrier2KHR>  &image_barriers,
+                             const std::vector<VkBufferMemoryBarrier2KHR> &buffer_barriers);
+}        // namespace core
+}        // namespace vkb
@@ -99,13 +99,10 @@ ShaderModule::ShaderModule(Device &device, VkShaderStageFlagBits stage, const Sh
 		throw VulkanException{VK_ERROR_INITIALIZATION_FAILED};
 	}
 
-	// Precompile source into the final spirv bytecode
-	auto glsl_final_source = precompile_shader(source);
-
-	// Compile the GLSL source
+	// Compile the GLSL source, the vkb__shader_archive target may have compiled it ahead of time
 	GLSLCompiler glsl_compiler;
 
-	if (!glsl_compiler.compile_to_spirv(stage, convert_to_bytes(glsl_final_source), entry_point, shader_variant, spirv, info_log))
+	if (!glsl_compiler.compile_to_spirv(stage, glsl_source.get_expanded_source(), entry_point, shader_variant, spirv, info_log))
 	{
 		LOGE("Shader compilation failed for shader \"{}\"", glsl_source.get_filename());
 		LOGE("{}", info_log);
@@ -319,4 +316,12 @@ const std::string &ShaderSource::get_source() const
 {
 	return source;
 }
+
+std::vector<uint8_t> ShaderSource::get_expanded_source() const
+{
+	// Precompile source into the final spirv bytecode
+	auto glsl_final_source = precompile_shader(source);
+
+	return convert_to_bytes(glsl_final_source);
+}
 }        // namespace vkb
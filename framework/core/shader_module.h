@@ -50,7 +50,11 @@ enum class ShaderResourceMode
 {
 	Static,
 	Dynamic,
-	UpdateAfterBind
+	UpdateAfterBind,
+	/// Changes at every draw, the set is pushed with VK_KHR_push_descriptor when the device supports it
+	PerDraw,
+	/// Array of the BindlessRegistry, update-after-bind and partially bound, visible to all stages
+	Bindless
 };
 
 /// A bitmask of qualifiers applied to a resource
@@ -175,6 +179,11 @@ class ShaderSource
 
 	const std::string &get_source() const;
 
+	/**
+	 * @brief Returns the source as it is compiled, with the include directives replaced by the included files
+	 */
+	std::vector<uint8_t> get_expanded_source() const;
+
   private:
 	size_t id;
 
@@ -0,0 +1,98 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/shader_object.h"
+
+#include "core/device.h"
+#include "core/pipeline_layout.h"
+#include "core/shader_module.h"
+#include "rendering/pipeline_state.h"
+
+namespace vkb
+{
+ShaderObject::ShaderObject(Device                            &device,
+                           const ShaderModule                &shader_module,
+                           VkShaderStageFlags                 next_stages,
+                           const PipelineLayout              &pipeline_layout,
+                           const SpecializationConstantState &specialization_constant_state) :
+    device{device},
+    stage{shader_module.get_stage()}
+{
+	// Create specialization info from tracked state, like the pipelines do
+	const auto  map_entries = specialization_constant_state.get_map_entries();
+	const auto &data        = specialization_constant_state.get_data();
+
+	VkSpecializationInfo specialization_info{};
+	specialization_info.mapEntryCount = to_u32(map_entries.size());
+	specialization_info.pMapEntries   = map_entries.data();
+	specialization_info.dataSize      = data.size();
+	specialization_info.pData         = data.data();
+
+	auto &set_layouts          = pipeline_layout.get_descriptor_set_layout_handles();
+	auto &push_constant_ranges = pipeline_layout.get_push_constant_ranges();
+
+	VkShaderCreateInfoEXT create_info{VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT};
+	create_info.stage                  = stage;
+	create_info.nextStage              = next_stages;
+	create_info.codeType               = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+	create_info.codeSize               = shader_module.get_binary().size() * sizeof(uint32_t);
+	create_info.pCode                  = shader_module.get_binary().data();
+	create_info.pName                  = shader_module.get_entry_point().c_str();
+	create_info.setLayoutCount         = to_u32(set_layouts.size());
+	create_info.pSetLayouts            = set_layouts.data();
+	create_info.pushConstantRangeCount = to_u32(push_constant_ranges.size());
+	create_info.pPushConstantRanges    = push_constant_ranges.data();
+	create_info.pSpecializationInfo    = &specialization_info;
+
+	auto result = vkCreateShadersEXT(device.get_handle(), 1, &create_info, nullptr, &handle);
+
+	if (result != VK_SUCCESS)
+	{
+		throw VulkanException{result, "Cannot create ShaderObject"};
+	}
+
+	device.get_debug_utils().set_debug_name(device.get_handle(),
+	                                        VK_OBJECT_TYPE_SHADER_EXT, reinterpret_cast<uint64_t>(handle),
+	                                        shader_module.get_debug_name().c_str());
+}
+
+ShaderObject::ShaderObject(ShaderObject &&other) :
+    device{other.device},
+    handle{other.handle},
+    stage{other.stage}
+{
+	other.handle = VK_NULL_HANDLE;
+}
+
+ShaderObject::~ShaderObject()
+{
+	if (handle != VK_NULL_HANDLE)
+	{
+		vkDestroyShaderEXT(device.get_handle(), handle, nullptr);
+	}
+}
+
+VkShaderEXT ShaderObject::get_handle() const
+{
+	return handle;
+}
+
+VkShaderStageFlagBits ShaderObject::get_stage() const
+{
+	return stage;
+}
+}        // namespace vkb
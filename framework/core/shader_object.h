@@ -0,0 +1,74 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Device;
+class PipelineLayout;
+class ShaderModule;
+class SpecializationConstantState;
+
+/**
+ * @brief A shader of a single stage, bound to a command buffer without a pipeline, see VK_EXT_shader_object
+ *
+ * The shader is created from the code of a shader module, with the descriptor set layouts and push
+ * constant ranges of the pipeline layout it is bound with, so that descriptors bound with that layout
+ * are compatible with it. The rest of the state is set dynamically by the command buffer.
+ */
+class ShaderObject
+{
+  public:
+	/**
+	 * @param device The device to create the shader on, with VK_EXT_shader_object enabled
+	 * @param shader_module The code and the stage of the shader
+	 * @param next_stages The stages which may follow the shader, none for the last stage and for compute shaders
+	 * @param pipeline_layout The pipeline layout the descriptors are bound with
+	 * @param specialization_constant_state The specialization constants of the shader
+	 */
+	ShaderObject(Device                            &device,
+	             const ShaderModule                &shader_module,
+	             VkShaderStageFlags                 next_stages,
+	             const PipelineLayout              &pipeline_layout,
+	             const SpecializationConstantState &specialization_constant_state);
+
+	ShaderObject(const ShaderObject &) = delete;
+
+	ShaderObject(ShaderObject &&other);
+
+	~ShaderObject();
+
+	ShaderObject &operator=(const ShaderObject &) = delete;
+
+	ShaderObject &operator=(ShaderObject &&) = delete;
+
+	VkShaderEXT get_handle() const;
+
+	VkShaderStageFlagBits get_stage() const;
+
+  private:
+	Device &device;
+
+	VkShaderEXT handle{VK_NULL_HANDLE};
+
+	VkShaderStageFlagBits stage;
+};
+}        // namespace vkb
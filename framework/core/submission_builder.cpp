@@ -0,0 +1,264 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/submission_builder.h"
+
+#include <algorithm>
+
+#include "common/helpers.h"
+#include "core/queue.h"
+
+namespace vkb
+{
+namespace
+{
+/**
+ * @return The index of the lowest GPU of a device mask
+ */
+uint32_t get_device_index(uint32_t device_mask)
+{
+	uint32_t device_index = 0;
+	while (device_mask > 1 && !(device_mask & 1))
+	{
+		device_mask >>= 1;
+		++device_index;
+	}
+	return device_index;
+}
+}        // namespace
+
+SubmissionBuilder::SubmissionBuilder(VkQueue queue, bool synchronization2) :
+    queue{queue},
+    synchronization2{synchronization2}
+{}
+
+SubmissionBuilder &SubmissionBuilder::wait(VkSemaphore semaphore, VkPipelineStageFlags2KHR stage_mask, uint64_t value)
+{
+	if (batches.empty() || batches.back().command_buffer_count > 0 || batches.back().signal_count > 0)
+	{
+		next_batch();
+	}
+
+	VkSemaphoreSubmitInfoKHR wait_info{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR};
+	wait_info.semaphore   = semaphore;
+	wait_info.value       = value;
+	wait_info.stageMask   = stage_mask;
+	wait_info.deviceIndex = get_device_index(device_mask);
+	waits.push_back(wait_info);
+
+	++batches.back().wait_count;
+
+	return *this;
+}
+
+SubmissionBuilder &SubmissionBuilder::add_command_buffer(VkCommandBuffer command_buffer)
+{
+	if (batches.empty() || batches.back().signal_count > 0)
+	{
+		next_batch();
+	}
+
+	VkCommandBufferSubmitInfoKHR command_buffer_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO_KHR};
+	command_buffer_info.commandBuffer = command_buffer;
+	command_buffer_info.deviceMask    = device_mask;
+	command_buffers.push_back(command_buffer_info);
+
+	++batches.back().command_buffer_count;
+
+	return *this;
+}
+
+SubmissionBuilder &SubmissionBuilder::set_device_mask(uint32_t device_mask_)
+{
+	device_mask = device_mask_;
+
+	return *this;
+}
+
+SubmissionBuilder &SubmissionBuilder::signal(VkSemaphore semaphore, VkPipelineStageFlags2KHR stage_mask, uint64_t value)
+{
+	if (batches.empty())
+	{
+		next_batch();
+	}
+
+	VkSemaphoreSubmitInfoKHR signal_info{VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR};
+	signal_info.semaphore   = semaphore;
+	signal_info.value       = value;
+	signal_info.stageMask   = stage_mask;
+	signal_info.deviceIndex = get_device_index(device_mask);
+	signals.push_back(signal_info);
+
+	++batches.back().signal_count;
+
+	return *this;
+}
+
+VkQueue SubmissionBuilder::get_queue() const
+{
+	return queue;
+}
+
+uint32_t SubmissionBuilder::get_batch_count() const
+{
+	return to_u32(batches.size());
+}
+
+bool SubmissionBuilder::empty() const
+{
+	return batches.empty();
+}
+
+VkResult SubmissionBuilder::submit(VkFence fence)
+{
+	VkResult result;
+
+	if (synchronization2)
+	{
+		// The arrays don't grow anymore, the batches can point into them
+		std::vector<VkSubmitInfo2KHR> submit_infos;
+		submit_infos.reserve(batches.size());
+		for (auto &batch : batches)
+		{
+			VkSubmitInfo2KHR submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO_2_KHR};
+			submit_info.waitSemaphoreInfoCount   = batch.wait_count;
+			submit_info.pWaitSemaphoreInfos      = waits.data() + batch.first_wait;
+			submit_info.commandBufferInfoCount   = batch.command_buffer_count;
+			submit_info.pCommandBufferInfos      = command_buffers.data() + batch.first_command_buffer;
+			submit_info.signalSemaphoreInfoCount = batch.signal_count;
+			submit_info.pSignalSemaphoreInfos    = signals.data() + batch.first_signal;
+			submit_infos.push_back(submit_info);
+		}
+
+		std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
+		result = vkQueueSubmit2KHR(queue, to_u32(submit_infos.size()), submit_infos.data(), fence);
+	}
+	else
+	{
+		result = submit_synchronization1(fence);
+	}
+
+	waits.clear();
+	command_buffers.clear();
+	signals.clear();
+	batches.clear();
+
+	return result;
+}
+
+SubmissionBuilder::Batch &SubmissionBuilder::next_batch()
+{
+	Batch batch;
+	batch.first_wait           = to_u32(waits.size());
+	batch.first_command_buffer = to_u32(command_buffers.size());
+	batch.first_signal         = to_u32(signals.size());
+	batches.push_back(batch);
+
+	return batches.back();
+}
+
+VkResult SubmissionBuilder::submit_synchronization1(VkFence fence)
+{
+	std::vector<VkSemaphore>          wait_semaphores;
+	std::vector<VkPipelineStageFlags> wait_stages;
+	std::vector<uint64_t>             wait_values;
+	std::vector<uint32_t>             wait_device_indices;
+	for (auto &wait_info : waits)
+	{
+		// The synchronization 2 stages below 32 bits are the synchronization 1 ones
+		assert((wait_info.stageMask >> 32) == 0 && "The stage has no synchronization 1 equivalent");
+		wait_semaphores.push_back(wait_info.semaphore);
+		wait_stages.push_back(static_cast<VkPipelineStageFlags>(wait_info.stageMask));
+		wait_values.push_back(wait_info.value);
+		wait_device_indices.push_back(wait_info.deviceIndex);
+	}
+
+	// Device groups are only chained when the batches don't run on all the GPUs
+	bool uses_device_masks = std::any_of(waits.begin(), waits.end(), [](const VkSemaphoreSubmitInfoKHR &info) { return info.deviceIndex != 0; });
+
+	std::vector<VkCommandBuffer> command_buffer_handles;
+	std::vector<uint32_t>        command_buffer_device_masks;
+	for (auto &command_buffer_info : command_buffers)
+	{
+		command_buffer_handles.push_back(command_buffer_info.commandBuffer);
+		command_buffer_device_masks.push_back(command_buffer_info.deviceMask);
+		uses_device_masks |= command_buffer_info.deviceMask != 0;
+	}
+
+	// Signals happen once all the commands of a batch complete, whatever their stage
+	std::vector<VkSemaphore> signal_semaphores;
+	std::vector<uint64_t>    signal_values;
+	std::vector<uint32_t>    signal_device_indices;
+	for (auto &signal_info : signals)
+	{
+		signal_semaphores.push_back(signal_info.semaphore);
+		signal_values.push_back(signal_info.value);
+		signal_device_indices.push_back(signal_info.deviceIndex);
+		uses_device_masks |= signal_info.deviceIndex != 0;
+	}
+
+	// Unlike synchronization 2, a mask of 0 doesn't stand for all the GPUs
+	assert((!uses_device_masks || std::none_of(command_buffer_device_masks.begin(), command_buffer_device_masks.end(), [](uint32_t mask) { return mask == 0; })) &&
+	       "The command buffers of a submission need a device mask if any of them has one");
+
+	std::vector<VkTimelineSemaphoreSubmitInfoKHR> timeline_infos(batches.size(), {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR});
+	std::vector<VkDeviceGroupSubmitInfoKHR>       device_group_infos(batches.size(), {VK_STRUCTURE_TYPE_DEVICE_GROUP_SUBMIT_INFO_KHR});
+	std::vector<VkSubmitInfo>                     submit_infos(batches.size(), {VK_STRUCTURE_TYPE_SUBMIT_INFO});
+	for (size_t i = 0; i < batches.size(); ++i)
+	{
+		auto &batch       = batches[i];
+		auto &submit_info = submit_infos[i];
+
+		submit_info.waitSemaphoreCount   = batch.wait_count;
+		submit_info.pWaitSemaphores      = wait_semaphores.data() + batch.first_wait;
+		submit_info.pWaitDstStageMask    = wait_stages.data() + batch.first_wait;
+		submit_info.commandBufferCount   = batch.command_buffer_count;
+		submit_info.pCommandBuffers      = command_buffer_handles.data() + batch.first_command_buffer;
+		submit_info.signalSemaphoreCount = batch.signal_count;
+		submit_info.pSignalSemaphores    = signal_semaphores.data() + batch.first_signal;
+
+		// Values are only chained when a batch has some, the timeline semaphores always do
+		auto has_value = [](const VkSemaphoreSubmitInfoKHR &info) { return info.value != 0; };
+		if (std::any_of(waits.begin() + batch.first_wait, waits.begin() + batch.first_wait + batch.wait_count, has_value) ||
+		    std::any_of(signals.begin() + batch.first_signal, signals.begin() + batch.first_signal + batch.signal_count, has_value))
+		{
+			auto &timeline_info                     = timeline_infos[i];
+			timeline_info.waitSemaphoreValueCount   = batch.wait_count;
+			timeline_info.pWaitSemaphoreValues      = wait_values.data() + batch.first_wait;
+			timeline_info.signalSemaphoreValueCount = batch.signal_count;
+			timeline_info.pSignalSemaphoreValues    = signal_values.data() + batch.first_signal;
+			submit_info.pNext                       = &timeline_info;
+		}
+
+		if (uses_device_masks)
+		{
+			auto &device_group_info                         = device_group_infos[i];
+			device_group_info.waitSemaphoreCount            = batch.wait_count;
+			device_group_info.pWaitSemaphoreDeviceIndices   = wait_device_indices.data() + batch.first_wait;
+			device_group_info.commandBufferCount            = batch.command_buffer_count;
+			device_group_info.pCommandBufferDeviceMasks     = command_buffer_device_masks.data() + batch.first_command_buffer;
+			device_group_info.signalSemaphoreCount          = batch.signal_count;
+			device_group_info.pSignalSemaphoreDeviceIndices = signal_device_indices.data() + batch.first_signal;
+			device_group_info.pNext                         = submit_info.pNext;
+			submit_info.pNext                               = &device_group_info;
+		}
+	}
+
+	std::lock_guard<std::mutex> guard{get_queue_submission_mutex()};
+	return vkQueueSubmit(queue, to_u32(submit_infos.size()), submit_infos.data(), fence);
+}
+}        // namespace vkb
@@ -0,0 +1,111 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "common/vk_common.h"
+
+namespace vkb
+{
+/**
+ * @brief Collects the command buffers and semaphores of several batches, submitted to a queue in one call
+ *
+ * The batches follow the order of the calls: a wait added after command buffers or signals starts a new
+ * batch, as does a command buffer added after signals. With VK_KHR_synchronization2 the batches are
+ * submitted with a single vkQueueSubmit2KHR, otherwise they are translated to a single vkQueueSubmit,
+ * with the stage masks narrowed to the synchronization 1 flags.
+ *
+ * On a device spanning a device group, the command buffers run on the GPUs of the device mask set when
+ * they were added, and the semaphores are waited for and signaled on the lowest of these GPUs.
+ */
+class SubmissionBuilder
+{
+  public:
+	/**
+	 * @param queue The queue the batches are submitted to
+	 * @param synchronization2 Whether VK_KHR_synchronization2 and its synchronization2 feature are enabled
+	 */
+	SubmissionBuilder(VkQueue queue, bool synchronization2);
+
+	/**
+	 * @brief Makes the next command buffers wait for a semaphore
+	 * @param value The value to wait for if it's a timeline semaphore, ignored otherwise
+	 */
+	SubmissionBuilder &wait(VkSemaphore semaphore, VkPipelineStageFlags2KHR stage_mask, uint64_t value = 0);
+
+	SubmissionBuilder &add_command_buffer(VkCommandBuffer command_buffer);
+
+	/**
+	 * @brief Sets the GPUs of the device group which run the next command buffers, and wait for and signal the next semaphores
+	 * @param device_mask The mask of the GPUs, 0 for all of them
+	 */
+	SubmissionBuilder &set_device_mask(uint32_t device_mask);
+
+	/**
+	 * @brief Signals a semaphore once the command buffers added so far complete
+	 * @param value The value to signal if it's a timeline semaphore, ignored otherwise
+	 */
+	SubmissionBuilder &signal(VkSemaphore semaphore, VkPipelineStageFlags2KHR stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR, uint64_t value = 0);
+
+	VkQueue get_queue() const;
+
+	/**
+	 * @return The number of batches submitted by the next call to submit
+	 */
+	uint32_t get_batch_count() const;
+
+	bool empty() const;
+
+	/**
+	 * @brief Submits all the batches in a single call and starts over
+	 * @param fence An optional fence signaled once all the batches complete
+	 */
+	VkResult submit(VkFence fence = VK_NULL_HANDLE);
+
+  private:
+	/// Ranges of the arrays below used by a batch
+	struct Batch
+	{
+		uint32_t first_wait{0};
+		uint32_t wait_count{0};
+		uint32_t first_command_buffer{0};
+		uint32_t command_buffer_count{0};
+		uint32_t first_signal{0};
+		uint32_t signal_count{0};
+	};
+
+	Batch &next_batch();
+
+	VkResult submit_synchronization1(VkFence fence);
+
+	VkQueue queue{VK_NULL_HANDLE};
+
+	bool synchronization2{false};
+
+	uint32_t device_mask{0};
+
+	std::vector<VkSemaphoreSubmitInfoKHR> waits;
+
+	std::vector<VkCommandBufferSubmitInfoKHR> command_buffers;
+
+	std::vector<VkSemaphoreSubmitInfoKHR> signals;
+
+	std::vector<Batch> batches;
+};
+}        // namespace vkb
@@ -289,7 +289,8 @@ Swapchain::Swapchain(Swapchain &old_swapchain, const VkExtent2D &extent) :
               old_swapchain.properties.pre_transform,
               old_swapchain.image_usage_flags,
               old_swapchain.requested_compression,
-              old_swapchain.requested_compression_fixed_rate}
+              old_swapchain.requested_compression_fixed_rate,
+              old_swapchain.full_screen_exclusive_monitor}
 {}
 
 Swapchain::Swapchain(Swapchain &old_swapchain, const uint32_t image_count) :
@@ -304,7 +305,24 @@ Swapchain::Swapchain(Swapchain &old_swapchain, const uint32_t image_count) :
               old_swapchain.properties.pre_transform,
               old_swapchain.image_usage_flags,
               old_swapchain.requested_compression,
-              old_swapchain.requested_compression_fixed_rate}
+              old_swapchain.requested_compression_fixed_rate,
+              old_swapchain.full_screen_exclusive_monitor}
+{}
+
+Swapchain::Swapchain(Swapchain &old_swapchain, const uint32_t image_count, const VkPresentModeKHR present_mode) :
+    Swapchain{old_swapchain,
+              old_swapchain.device,
+              old_swapchain.surface,
+              present_mode,
+              old_swapchain.present_mode_priority_list,
+              old_swapchain.surface_format_priority_list,
+              old_swapchain.properties.extent,
+              image_count,
+              old_swapchain.properties.pre_transform,
+              old_swapchain.image_usage_flags,
+              old_swapchain.requested_compression,
+              old_swapchain.requested_compression_fixed_rate,
+              old_swapchain.full_screen_exclusive_monitor}
 {}
 
 Swapchain::Swapchain(Swapchain &old_swapchain, const std::set<VkImageUsageFlagBits> &image_usage_flags) :
@@ -319,7 +337,8 @@ Swapchain::Swapchain(Swapchain &old_swapchain, const std::set<VkImageUsageFlagBi
               old_swapchain.properties.pre_transform,
               image_usage_flags,
               old_swapchain.requested_compression,
-              old_swapchain.requested_compression_fixed_rate}
+              old_swapchain.requested_compression_fixed_rate,
+              old_swapchain.full_screen_exclusive_monitor}
 {}
 
 Swapchain::Swapchain(Swapchain &old_swapchain, const VkExtent2D &extent, const VkSurfaceTransformFlagBitsKHR transform) :
@@ -334,7 +353,8 @@ Swapchain::Swapchain(Swapchain &old_swapchain, const VkExtent2D &extent, const V
               transform,
               old_swapchain.image_usage_flags,
               old_swapchain.requested_compression,
-              old_swapchain.requested_compression_fixed_rate}
+              old_swapchain.requested_compression_fixed_rate,
+              old_swapchain.full_screen_exclusive_monitor}
 {}
 
 Swapchain::Swapchain(Swapchain &old_swapchain, const VkImageCompressionFlagsEXT requested_compression, const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate) :
@@ -349,7 +369,8 @@ Swapchain::Swapchain(Swapchain &old_swapchain, const VkImageCompressionFlagsEXT
               old_swapchain.properties.pre_transform,
               old_swapchain.image_usage_flags,
               requested_compression,
-              requested_compression_fixed_rate}
+              requested_compression_fixed_rate,
+              old_swapchain.full_screen_exclusive_monitor}
 {}
 
 Swapchain::Swapchain(Device                                   &device,
@@ -362,8 +383,10 @@ Swapchain::Swapchain(Device                                   &device,
                      const VkSurfaceTransformFlagBitsKHR       transform,
                      const std::set<VkImageUsageFlagBits>     &image_usage_flags,
                      const VkImageCompressionFlagsEXT          requested_compression,
-                     const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate) :
-    Swapchain{*this, device, surface, present_mode, present_mode_priority_list, surface_format_priority_list, extent, image_count, transform, image_usage_flags}
+                     const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate,
+                     void                                     *full_screen_exclusive_monitor) :
+    Swapchain{*this, device, surface, present_mode, present_mode_priority_list, surface_format_priority_list, extent, image_count, transform, image_usage_flags,
+              requested_compression, requested_compression_fixed_rate, full_screen_exclusive_monitor}
 {
 }
 
@@ -378,9 +401,11 @@ Swapchain::Swapchain(Swapchain                                &old_swapchain,
                      const VkSurfaceTransformFlagBitsKHR       transform,
                      const std::set<VkImageUsageFlagBits>     &image_usage_flags,
                      const VkImageCompressionFlagsEXT          requested_compression,
-                     const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate) :
+                     const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate,
+                     void                                     *full_screen_exclusive_monitor) :
     device{device},
     surface{surface},
+    full_screen_exclusive_monitor{full_screen_exclusive_monitor},
     requested_compression{requested_compression},
     requested_compression_fixed_rate{requested_compression_fixed_rate}
 {
@@ -472,6 +497,31 @@ Swapchain::Swapchain(Swapchain                                &old_swapchain,
 		}
 	}
 
+#if defined(VK_NV_low_latency2)
+	// The latency sleeps of vkb::FramePacer need the swapchain to opt in at creation
+	VkSwapchainLatencyCreateInfoNV latency_create_info{VK_STRUCTURE_TYPE_SWAPCHAIN_LATENCY_CREATE_INFO_NV};
+	latency_create_info.latencyModeEnable = VK_TRUE;
+	if (device.is_enabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME))
+	{
+		latency_create_info.pNext = create_info.pNext;
+		create_info.pNext         = &latency_create_info;
+	}
+#endif
+
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	// The application takes the exclusive ownership of the display itself, see acquire_full_screen_exclusive
+	VkSurfaceFullScreenExclusiveWin32InfoEXT full_screen_exclusive_win32_info{VK_STRUCTURE_TYPE_SURFACE_FULL_SCREEN_EXCLUSIVE_WIN32_INFO_EXT};
+	full_screen_exclusive_win32_info.hmonitor = static_cast<HMONITOR>(full_screen_exclusive_monitor);
+	VkSurfaceFullScreenExclusiveInfoEXT full_screen_exclusive_info{VK_STRUCTURE_TYPE_SURFACE_FULL_SCREEN_EXCLUSIVE_INFO_EXT};
+	full_screen_exclusive_info.pNext               = &full_screen_exclusive_win32_info;
+	full_screen_exclusive_info.fullScreenExclusive = VK_FULL_SCREEN_EXCLUSIVE_APPLICATION_CONTROLLED_EXT;
+	if (is_full_screen_exclusive())
+	{
+		full_screen_exclusive_win32_info.pNext = create_info.pNext;
+		create_info.pNext                      = &full_screen_exclusive_info;
+	}
+#endif
+
 	VkResult result = vkCreateSwapchainKHR(device.get_handle(), &create_info, nullptr, &handle);
 
 	if (result != VK_SUCCESS)
@@ -486,6 +536,11 @@ Swapchain::Swapchain(Swapchain                                &old_swapchain,
 
 	VK_CHECK(vkGetSwapchainImagesKHR(device.get_handle(), handle, &image_available, images.data()));
 
+	if (is_full_screen_exclusive())
+	{
+		acquire_full_screen_exclusive();
+	}
+
 	if (device.is_enabled(VK_EXT_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN_EXTENSION_NAME) &&
 	    VK_IMAGE_COMPRESSION_FIXED_RATE_EXPLICIT_EXT == requested_compression)
 	{
@@ -529,7 +584,8 @@ Swapchain::Swapchain(Swapchain &&other) :
     properties{std::exchange(other.properties, {})},
     present_mode_priority_list{std::exchange(other.present_mode_priority_list, {})},
     surface_format_priority_list{std::exchange(other.surface_format_priority_list, {})},
-    image_usage_flags{std::move(other.image_usage_flags)}
+    image_usage_flags{std::move(other.image_usage_flags)},
+    full_screen_exclusive_monitor{other.full_screen_exclusive_monitor}
 {
 }
 
@@ -548,9 +604,20 @@ VkSwapchainKHR Swapchain::get_handle() const
 	return handle;
 }
 
-VkResult Swapchain::acquire_next_image(uint32_t &image_index, VkSemaphore image_acquired_semaphore, VkFence fence) const
+VkResult Swapchain::acquire_next_image(uint32_t &image_index, VkSemaphore image_acquired_semaphore, VkFence fence, uint32_t device_mask) const
 {
-	return vkAcquireNextImageKHR(device.get_handle(), handle, std::numeric_limits<uint64_t>::max(), image_acquired_semaphore, fence, &image_index);
+	if (device_mask == 0)
+	{
+		return vkAcquireNextImageKHR(device.get_handle(), handle, std::numeric_limits<uint64_t>::max(), image_acquired_semaphore, fence, &image_index);
+	}
+
+	VkAcquireNextImageInfoKHR acquire_info{VK_STRUCTURE_TYPE_ACQUIRE_NEXT_IMAGE_INFO_KHR};
+	acquire_info.swapchain  = handle;
+	acquire_info.timeout    = std::numeric_limits<uint64_t>::max();
+	acquire_info.semaphore  = image_acquired_semaphore;
+	acquire_info.fence      = fence;
+	acquire_info.deviceMask = device_mask;
+	return vkAcquireNextImage2KHR(device.get_handle(), &acquire_info, &image_index);
 }
 
 const VkExtent2D &Swapchain::get_extent() const
@@ -598,6 +665,31 @@ VkImageCompressionFlagsEXT Swapchain::get_applied_compression() const
 	return vkb::query_applied_compression(device.get_handle(), get_images()[0]).imageCompressionFlags;
 }
 
+bool Swapchain::is_full_screen_exclusive() const
+{
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	return full_screen_exclusive_monitor != nullptr && device.is_enabled(VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME);
+#else
+	return false;
+#endif
+}
+
+bool Swapchain::acquire_full_screen_exclusive()
+{
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	if (is_full_screen_exclusive())
+	{
+		VkResult result = vkAcquireFullScreenExclusiveModeEXT(device.get_handle(), handle);
+		if (result != VK_SUCCESS)
+		{
+			LOGW("(Swapchain) Cannot acquire the full-screen exclusive mode: {}", to_string(result));
+		}
+		return result == VK_SUCCESS;
+	}
+#endif
+	return false;
+}
+
 std::vector<Swapchain::SurfaceFormatCompression> Swapchain::query_supported_fixed_rate_compression(Device &device, const VkSurfaceKHR &surface)
 {
 	std::vector<SurfaceFormatCompression> surface_format_compression_list;
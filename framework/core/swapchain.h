@@ -58,6 +58,12 @@ class Swapchain
 	 */
 	Swapchain(Swapchain &old_swapchain, const uint32_t image_count);
 
+	/**
+	 * @brief Constructor to create a swapchain by changing the image count
+	 *        and present mode only and preserving the configuration from the old swapchain.
+	 */
+	Swapchain(Swapchain &old_swapchain, const uint32_t image_count, const VkPresentModeKHR present_mode);
+
 	/**
 	 * @brief Constructor to create a swapchain by changing the image usage
 	 *        only and preserving the configuration from the old swapchain.
@@ -78,6 +84,8 @@ class Swapchain
 
 	/**
 	 * @brief Constructor to create a swapchain.
+	 * @param full_screen_exclusive_monitor The HMONITOR the swapchain takes exclusive ownership of with
+	 *        VK_EXT_full_screen_exclusive, see Window::get_full_screen_exclusive_monitor
 	 */
 	Swapchain(Device                                   &device,
 	          VkSurfaceKHR                              surface,
@@ -91,7 +99,8 @@ class Swapchain
 	          const VkSurfaceTransformFlagBitsKHR       transform                        = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
 	          const std::set<VkImageUsageFlagBits>     &image_usage_flags                = {VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT},
 	          const VkImageCompressionFlagsEXT          requested_compression            = VK_IMAGE_COMPRESSION_DEFAULT_EXT,
-	          const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate = VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT);
+	          const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate = VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT,
+	          void                                     *full_screen_exclusive_monitor    = nullptr);
 
 	/**
 	 * @brief Constructor to create a swapchain from the old swapchain
@@ -109,7 +118,8 @@ class Swapchain
 	          const VkSurfaceTransformFlagBitsKHR       transform                        = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
 	          const std::set<VkImageUsageFlagBits>     &image_usage_flags                = {VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT},
 	          const VkImageCompressionFlagsEXT          requested_compression            = VK_IMAGE_COMPRESSION_DEFAULT_EXT,
-	          const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate = VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT);
+	          const VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate = VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT,
+	          void                                     *full_screen_exclusive_monitor    = nullptr);
 
 	Swapchain(const Swapchain &) = delete;
 
@@ -127,7 +137,10 @@ class Swapchain
 
 	VkSwapchainKHR get_handle() const;
 
-	VkResult acquire_next_image(uint32_t &image_index, VkSemaphore image_acquired_semaphore, VkFence fence = VK_NULL_HANDLE) const;
+	/**
+	 * @param device_mask The GPUs of the device group the image is acquired for, the first one if 0
+	 */
+	VkResult acquire_next_image(uint32_t &image_index, VkSemaphore image_acquired_semaphore, VkFence fence = VK_NULL_HANDLE, uint32_t device_mask = 0) const;
 
 	const VkExtent2D &get_extent() const;
 
@@ -147,6 +160,18 @@ class Swapchain
 
 	VkImageCompressionFlagsEXT get_applied_compression() const;
 
+	/**
+	 * @return Whether the application controls the full-screen exclusive mode of the swapchain
+	 */
+	bool is_full_screen_exclusive() const;
+
+	/**
+	 * @brief Takes the exclusive ownership of the display, done at creation and again after the mode got lost
+	 *        (VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT), e.g. when the window lost the focus
+	 * @return Whether the swapchain owns the display
+	 */
+	bool acquire_full_screen_exclusive();
+
 	/**
 	 * Helper functions for compression controls
 	 */
@@ -182,6 +207,8 @@ class Swapchain
 
 	std::set<VkImageUsageFlagBits> image_usage_flags;
 
+	void *full_screen_exclusive_monitor{nullptr};
+
 	VkImageCompressionFlagsEXT requested_compression{VK_IMAGE_COMPRESSION_DEFAULT_EXT};
 
 	VkImageCompressionFixedRateFlagsEXT requested_compression_fixed_rate{VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT};
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "common/vk_common.h"
+#include "core/debug.h"
 #include "vulkan_type_mapping.h"
 
 #include <utility>
@@ -205,7 +206,7 @@ inline void VulkanResource<bindingType, Handle>::set_debug_name(const std::strin
 {
 	debug_name = name;
 
-	if (device && !debug_name.empty())
+	if (device && !debug_name.empty() && vkb::DebugLabels::are_names_enabled())
 	{
 		get_device().get_debug_utils().set_debug_name(get_device().get_handle(), get_object_type(), get_handle_u64(), debug_name.c_str());
 	}
@@ -0,0 +1,142 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "deferred_destruction_queue.h"
+
+#include <algorithm>
+
+#include "common/helpers.h"
+
+namespace vkb
+{
+DeferredDestructionQueue::DeferredDestructionQueue(VkDevice device) :
+    device{device}
+{}
+
+DeferredDestructionQueue::~DeferredDestructionQueue()
+{
+	if (!retired.empty())
+	{
+		vkDeviceWaitIdle(device);
+	}
+
+	clear();
+}
+
+void DeferredDestructionQueue::track(const QueueTimeline &timeline)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	auto it = std::find_if(timelines.begin(), timelines.end(), [&timeline](const QueueTimeline &tracked) { return tracked.semaphore == timeline.semaphore; });
+	if (it == timelines.end())
+	{
+		timelines.push_back(timeline);
+	}
+	else
+	{
+		it->value = std::max(it->value, timeline.value);
+	}
+}
+
+void DeferredDestructionQueue::retire_object(std::shared_ptr<void> &&object, std::vector<VkFence> &&fences)
+{
+	std::unique_lock<std::mutex> guard(mutex);
+
+	if (timelines.empty() && fences.empty())
+	{
+		guard.unlock();
+
+		// Nothing tells when the GPU is done with the object
+		VK_CHECK(vkDeviceWaitIdle(device));
+		object.reset();
+		return;
+	}
+
+	retired.push_back({timelines, std::move(fences), std::move(object)});
+}
+
+void DeferredDestructionQueue::collect()
+{
+	// Destroyed once the lock is released
+	std::vector<std::shared_ptr<void>> completed;
+
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+
+		if (retired.empty())
+		{
+			return;
+		}
+
+		std::vector<uint64_t> reached(timelines.size());
+		for (size_t i = 0; i < timelines.size(); ++i)
+		{
+			VK_CHECK(vkGetSemaphoreCounterValueKHR(device, timelines[i].semaphore, &reached[i]));
+		}
+
+		auto is_complete = [&](const RetiredObject &retired_object) {
+			bool timelines_reached = std::all_of(retired_object.timelines.begin(), retired_object.timelines.end(), [&](const QueueTimeline &timeline) {
+				auto it = std::find_if(timelines.begin(), timelines.end(), [&timeline](const QueueTimeline &tracked) { return tracked.semaphore == timeline.semaphore; });
+				return timeline.value <= reached[std::distance(timelines.begin(), it)];
+			});
+			return timelines_reached && std::all_of(retired_object.fences.begin(), retired_object.fences.end(), [this](VkFence fence) { return vkGetFenceStatus(device, fence) == VK_SUCCESS; });
+		};
+
+		// Values only grow, an object can't complete before the ones retired earlier.
+		// Fences may signal out of order, the objects are still destroyed in the order they were retired.
+		while (!retired.empty() && is_complete(retired.front()))
+		{
+			destroy_fences(retired.front());
+			completed.push_back(std::move(retired.front().object));
+			retired.pop_front();
+		}
+	}
+}
+
+void DeferredDestructionQueue::clear()
+{
+	std::deque<RetiredObject> objects;
+
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+
+		objects.swap(retired);
+		timelines.clear();
+	}
+
+	for (auto &retired_object : objects)
+	{
+		destroy_fences(retired_object);
+	}
+}
+
+void DeferredDestructionQueue::destroy_fences(RetiredObject &retired_object)
+{
+	for (auto fence : retired_object.fences)
+	{
+		vkDestroyFence(device, fence, nullptr);
+	}
+	retired_object.fences.clear();
+}
+
+size_t DeferredDestructionQueue::get_retired_count() const
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	return retired.size();
+}
+}        // namespace vkb
@@ -0,0 +1,131 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "common/vk_common.h"
+#include "queue_timeline.h"
+
+namespace vkb
+{
+/**
+ * @brief Destroys objects once the GPU is done with the submissions made before they were retired
+ *
+ * The render context reports the values its submissions signal on the timeline of each queue,
+ * see RenderContext::enable_timeline_semaphores. A retired object is kept with the last value
+ * of each timeline, and destroyed by collect() once the GPU reached all of them, so replacing
+ * resources doesn't drain the GPU. Only the submissions of the render context are tracked.
+ * As long as none was, retiring an object waits for the device to be idle and destroys it,
+ * unless it is retired with fences telling when the GPU is done with it.
+ */
+class DeferredDestructionQueue
+{
+  public:
+	explicit DeferredDestructionQueue(VkDevice device);
+
+	DeferredDestructionQueue(const DeferredDestructionQueue &) = delete;
+
+	DeferredDestructionQueue(DeferredDestructionQueue &&) = delete;
+
+	/**
+	 * @brief Waits for the device to be idle and destroys the objects still retired
+	 */
+	~DeferredDestructionQueue();
+
+	DeferredDestructionQueue &operator=(const DeferredDestructionQueue &) = delete;
+
+	DeferredDestructionQueue &operator=(DeferredDestructionQueue &&) = delete;
+
+	/**
+	 * @brief Records the value a submission signals on the timeline of its queue
+	 */
+	void track(const QueueTimeline &timeline);
+
+	/**
+	 * @brief Keeps an object until the submissions tracked so far are complete
+	 * @param object The object to destroy, e.g. a std::unique_ptr to a wrapper or a container of wrappers
+	 */
+	template <typename T>
+	void retire(T &&object)
+	{
+		static_assert(!std::is_lvalue_reference<T>::value, "Retired objects are moved into the queue");
+		retire_object(std::make_shared<T>(std::move(object)), {});
+	}
+
+	/**
+	 * @brief Keeps an object until the fences are signaled and the submissions tracked so far are complete
+	 *        E.g. a swapchain with the fences of its presents from VK_EXT_swapchain_maintenance1.
+	 * @param object The object to destroy
+	 * @param fences Fences the queue takes ownership of, destroyed with the object
+	 */
+	template <typename T>
+	void retire(T &&object, std::vector<VkFence> &&fences)
+	{
+		static_assert(!std::is_lvalue_reference<T>::value, "Retired objects are moved into the queue");
+		retire_object(std::make_shared<T>(std::move(object)), std::move(fences));
+	}
+
+	/**
+	 * @brief Destroys the retired objects the GPU is done with, without waiting for it
+	 */
+	void collect();
+
+	/**
+	 * @brief Destroys all the retired objects and forgets the tracked timelines
+	 *        The device must be idle, called before the timeline semaphores are destroyed.
+	 */
+	void clear();
+
+	/**
+	 * @return The number of objects waiting for their submissions to complete
+	 */
+	size_t get_retired_count() const;
+
+  private:
+	struct RetiredObject
+	{
+		/// Value of each timeline when the object was retired
+		std::vector<QueueTimeline> timelines;
+
+		/// Signaled once the GPU is done with the object, outside of the tracked submissions
+		std::vector<VkFence> fences;
+
+		/// Owns the object, its deleter calls the destructor of the retired type
+		std::shared_ptr<void> object;
+	};
+
+	void retire_object(std::shared_ptr<void> &&object, std::vector<VkFence> &&fences);
+
+	void destroy_fences(RetiredObject &retired_object);
+
+	VkDevice device{VK_NULL_HANDLE};
+
+	mutable std::mutex mutex;
+
+	/// Last value tracked on each timeline
+	std::vector<QueueTimeline> timelines;
+
+	/// Retired objects, in the order of their values
+	std::deque<RetiredObject> retired;
+};
+}        // namespace vkb
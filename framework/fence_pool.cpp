@@ -17,6 +17,8 @@
 
 #include "fence_pool.h"
 
+#include <algorithm>
+
 #include "core/device.h"
 
 namespace vkb
@@ -42,10 +44,14 @@ FencePool::~FencePool()
 
 VkFence FencePool::request_fence()
 {
+	std::lock_guard<std::mutex> guard(mutex);
+
 	// Check if there is an available fence
-	if (active_fence_count < fences.size())
+	if (!free_fences.empty())
 	{
-		return fences[active_fence_count++];
+		active_fences.push_back(free_fences.back());
+		free_fences.pop_back();
+		return active_fences.back();
 	}
 
 	VkFence fence{VK_NULL_HANDLE};
@@ -61,37 +67,97 @@ VkFence FencePool::request_fence()
 
 	fences.push_back(fence);
 
-	active_fence_count++;
+	active_fences.push_back(fence);
 
-	return fences.back();
+	return fence;
 }
 
 VkResult FencePool::wait(uint32_t timeout) const
 {
-	if (active_fence_count < 1 || fences.empty())
+	std::vector<VkFence> waited;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		waited = active_fences;
+	}
+
+	if (waited.empty())
 	{
 		return VK_SUCCESS;
 	}
 
-	return vkWaitForFences(device.get_handle(), active_fence_count, fences.data(), true, timeout);
+	// Not holding the lock, the other threads can still request and recycle fences
+	return vkWaitForFences(device.get_handle(), to_u32(waited.size()), waited.data(), true, timeout);
+}
+
+VkResult FencePool::wait(VkFence fence, uint64_t timeout) const
+{
+	return vkWaitForFences(device.get_handle(), 1, &fence, true, timeout);
 }
 
 VkResult FencePool::reset()
 {
-	if (active_fence_count < 1 || fences.empty())
+	std::lock_guard<std::mutex> guard(mutex);
+
+	if (active_fences.empty())
 	{
 		return VK_SUCCESS;
 	}
 
-	VkResult result = vkResetFences(device.get_handle(), active_fence_count, fences.data());
+	VkResult result = vkResetFences(device.get_handle(), to_u32(active_fences.size()), active_fences.data());
+
+	if (result != VK_SUCCESS)
+	{
+		return result;
+	}
+
+	free_fences.insert(free_fences.end(), active_fences.begin(), active_fences.end());
+	active_fences.clear();
+
+	return VK_SUCCESS;
+}
+
+VkResult FencePool::recycle(VkFence fence)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	auto it = std::find(active_fences.begin(), active_fences.end(), fence);
+	if (it == active_fences.end())
+	{
+		throw std::runtime_error("Recycled fence isn't active in the pool.");
+	}
+
+	VkResult result = vkResetFences(device.get_handle(), 1, &fence);
 
 	if (result != VK_SUCCESS)
 	{
 		return result;
 	}
 
-	active_fence_count = 0;
+	active_fences.erase(it);
+	free_fences.push_back(fence);
 
 	return VK_SUCCESS;
 }
+
+size_t FencePool::recycle_signaled()
+{
+	std::lock_guard<std::mutex> guard(mutex);
+
+	auto signaled = std::partition(active_fences.begin(), active_fences.end(), [this](VkFence fence) {
+		return vkGetFenceStatus(device.get_handle(), fence) != VK_SUCCESS;
+	});
+
+	size_t count = std::distance(signaled, active_fences.end());
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	VK_CHECK(vkResetFences(device.get_handle(), to_u32(count), &*signaled));
+
+	free_fences.insert(free_fences.end(), signaled, active_fences.end());
+	active_fences.erase(signaled, active_fences.end());
+
+	return count;
+}
 }        // namespace vkb
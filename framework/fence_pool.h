@@ -17,12 +17,22 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "common/helpers.h"
 
 namespace vkb
 {
 class Device;
 
+/**
+ * @brief Recycles the fences of submissions
+ *
+ * The fences can be waited on and reset all together, e.g. by a render frame reusing its resources,
+ * or one at a time, so a slow submission doesn't prevent reusing the fences of the others.
+ * A fence requested from the pool is active until it is reset by reset() or recycle().
+ * The pool can be used from several threads.
+ */
 class FencePool
 {
   public:
@@ -40,15 +50,43 @@ class FencePool
 
 	VkFence request_fence();
 
+	/**
+	 * @brief Waits for all the active fences
+	 */
 	VkResult wait(uint32_t timeout = std::numeric_limits<uint32_t>::max()) const;
 
+	/**
+	 * @brief Waits for one active fence
+	 */
+	VkResult wait(VkFence fence, uint64_t timeout = std::numeric_limits<uint64_t>::max()) const;
+
+	/**
+	 * @brief Resets all the active fences, which must be signaled or unused
+	 */
 	VkResult reset();
 
+	/**
+	 * @brief Resets one active fence for reuse, it must be signaled or unused
+	 */
+	VkResult recycle(VkFence fence);
+
+	/**
+	 * @brief Resets the active fences which are already signaled, without waiting for the others
+	 * @return The number of fences recycled
+	 */
+	size_t recycle_signaled();
+
   private:
 	Device &device;
 
+	mutable std::mutex mutex;
+
+	/// All the fences created by the pool
 	std::vector<VkFence> fences;
 
-	uint32_t active_fence_count{0};
+	std::vector<VkFence> active_fences;
+
+	/// Fences reset and ready to be requested
+	std::vector<VkFence> free_fences;
 };
 }        // namespace vkb
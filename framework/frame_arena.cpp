@@ -0,0 +1,98 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_arena.h"
+
+#include <algorithm>
+
+namespace vkb
+{
+FrameArena::FrameArena(size_t block_size) :
+    block_size{block_size}
+{
+	add_block(block_size);
+}
+
+void FrameArena::reset()
+{
+	if (blocks.size() > 1)
+	{
+		// The last frame didn't fit in one block, the next ones get a block the size of all of them
+		size_t capacity = get_capacity();
+		blocks.clear();
+		add_block(capacity);
+	}
+
+	current_block    = 0;
+	offset           = 0;
+	full_blocks_size = 0;
+}
+
+size_t FrameArena::get_used_size() const
+{
+	return full_blocks_size + offset;
+}
+
+size_t FrameArena::get_capacity() const
+{
+	size_t capacity = 0;
+	for (auto &block : blocks)
+	{
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+	while (true)
+	{
+		auto &block = blocks[current_block];
+
+		void  *ptr   = block.data.get() + offset;
+		size_t space = block.size - offset;
+		if (std::align(alignment, bytes, ptr, space))
+		{
+			offset = block.size - space + bytes;
+			return ptr;
+		}
+
+		// The rest of the block is left unused
+		full_blocks_size += offset;
+		offset = 0;
+		if (++current_block == blocks.size())
+		{
+			add_block(std::max(block_size, bytes + alignment));
+		}
+	}
+}
+
+void FrameArena::do_deallocate(void *p, size_t bytes, size_t alignment)
+{
+	// The memory is reclaimed all at once by reset()
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+	return this == &other;
+}
+
+void FrameArena::add_block(size_t size)
+{
+	blocks.push_back({std::make_unique<uint8_t[]>(size), size});
+}
+}        // namespace vkb
@@ -0,0 +1,97 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace vkb
+{
+/**
+ * @brief A linear CPU allocator for the containers which only live during the recording of a frame.
+ *
+ * Allocations bump a pointer in the current block, deallocations are no-ops, and reset() rewinds
+ * the arena once the frame is done with them. When a frame needed more than one block, reset()
+ * replaces them with a single block of their total size, so the following frames of a similar
+ * size don't hit the global heap at all.
+ *
+ * The arena is not thread safe, each recording thread of a frame uses one of its own.
+ */
+class FrameArena : public std::pmr::memory_resource
+{
+  public:
+	/// Size of the first block, and minimum size of the blocks added when it is full
+	static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+	explicit FrameArena(size_t block_size = DefaultBlockSize);
+
+	FrameArena(const FrameArena &) = delete;
+
+	FrameArena(FrameArena &&) = delete;
+
+	FrameArena &operator=(const FrameArena &) = delete;
+
+	FrameArena &operator=(FrameArena &&) = delete;
+
+	/**
+	 * @brief Rewinds the arena, the memory of all previous allocations is reused
+	 */
+	void reset();
+
+	/**
+	 * @return The amount of memory allocated since the last reset, including alignment padding
+	 */
+	size_t get_used_size() const;
+
+	/**
+	 * @return The total size of the blocks owned by the arena
+	 */
+	size_t get_capacity() const;
+
+  private:
+	struct Block
+	{
+		std::unique_ptr<uint8_t[]> data;
+		size_t                     size;
+	};
+
+	void *do_allocate(size_t bytes, size_t alignment) override;
+
+	void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+	void add_block(size_t size);
+
+	size_t block_size;
+
+	std::vector<Block> blocks;
+
+	/// Index of the block allocations are taken from
+	size_t current_block{0};
+
+	/// Offset of the next allocation in the current block
+	size_t offset{0};
+
+	/// Size of the blocks before the current one, which are full
+	size_t full_blocks_size{0};
+};
+}        // namespace vkb
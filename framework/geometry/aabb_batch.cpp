@@ -0,0 +1,214 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "aabb_batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/util/job_system.hpp"
+#include "frustum.h"
+#include "simd_lanes.h"
+
+namespace vkb
+{
+using namespace simd;
+
+static_assert(AABBBatch::LANE_COUNT == simd::LANE_COUNT, "The boxes are processed a vector at a time");
+
+void AABBBatch::clear()
+{
+	count = 0;
+
+	for (auto *arrays : {&local_center, &local_extent, &world_center, &world_extent})
+	{
+		for (auto &values : *arrays)
+		{
+			values.clear();
+		}
+	}
+	for (auto &values : matrix)
+	{
+		values.clear();
+	}
+
+	versions.clear();
+	dirty_blocks.clear();
+}
+
+size_t AABBBatch::add(const glm::vec3 &min, const glm::vec3 &max)
+{
+	size_t index = count++;
+
+	// Keep the arrays padded to full blocks, so the kernels never read out of bounds
+	size_t padded_size = (count + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+	if (padded_size > versions.size())
+	{
+		for (auto *arrays : {&local_center, &local_extent, &world_center, &world_extent})
+		{
+			for (auto &values : *arrays)
+			{
+				values.resize(padded_size, 0.0f);
+			}
+		}
+		for (auto &values : matrix)
+		{
+			values.resize(padded_size, 0.0f);
+		}
+
+		versions.resize(padded_size, std::numeric_limits<uint32_t>::max());
+		dirty_blocks.resize(padded_size / LANE_COUNT, 0);
+	}
+
+	glm::vec3 center = (min + max) * 0.5f;
+	glm::vec3 extent = (max - min) * 0.5f;
+
+	for (glm::length_t i = 0; i < 3; ++i)
+	{
+		local_center[i][index] = center[i];
+		local_extent[i][index] = extent[i];
+		world_center[i][index] = center[i];
+		world_extent[i][index] = extent[i];
+	}
+
+	return index;
+}
+
+size_t AABBBatch::size() const
+{
+	return count;
+}
+
+void AABBBatch::set_transform(size_t index, uint32_t version, const glm::mat4 &world_matrix)
+{
+	assert(index < count && "Box index is out of bounds");
+
+	if (versions[index] == version)
+	{
+		return;
+	}
+
+	versions[index] = version;
+
+	for (glm::length_t row = 0; row < 3; ++row)
+	{
+		for (glm::length_t column = 0; column < 4; ++column)
+		{
+			// glm matrices are indexed by column first
+			matrix[row * 4 + column][index] = world_matrix[column][row];
+		}
+	}
+
+	dirty_blocks[index / LANE_COUNT] = 1;
+}
+
+void AABBBatch::update()
+{
+	for (size_t block = 0; block < dirty_blocks.size(); ++block)
+	{
+		if (!dirty_blocks[block])
+		{
+			continue;
+		}
+		dirty_blocks[block] = 0;
+
+		const size_t offset = block * LANE_COUNT;
+
+		Lanes center[3] = {load(&local_center[0][offset]), load(&local_center[1][offset]), load(&local_center[2][offset])};
+		Lanes extent[3] = {load(&local_extent[0][offset]), load(&local_extent[1][offset]), load(&local_extent[2][offset])};
+
+		for (size_t row = 0; row < 3; ++row)
+		{
+			Lanes m0 = load(&matrix[row * 4 + 0][offset]);
+			Lanes m1 = load(&matrix[row * 4 + 1][offset]);
+			Lanes m2 = load(&matrix[row * 4 + 2][offset]);
+			Lanes m3 = load(&matrix[row * 4 + 3][offset]);
+
+			// The center is transformed as a point, the extent by the absolute value of the linear part
+			Lanes transformed_center = add(add(mul(m0, center[0]), mul(m1, center[1])), add(mul(m2, center[2]), m3));
+			Lanes transformed_extent = add(add(mul(abs(m0), extent[0]), mul(abs(m1), extent[1])), mul(abs(m2), extent[2]));
+
+			store(&world_center[row][offset], transformed_center);
+			store(&world_extent[row][offset], transformed_extent);
+		}
+	}
+}
+
+void AABBBatch::cull(const Frustum &frustum, std::vector<uint8_t> &visible, JobSystem *jobs) const
+{
+	visible.resize(count);
+
+	size_t block_count = (count + LANE_COUNT - 1) / LANE_COUNT;
+
+	if (jobs)
+	{
+		// Ranges are split by block, so no two jobs write the results of the same block
+		jobs->parallel_for(block_count, ParallelThreshold / LANE_COUNT, [this, &frustum, &visible](size_t first_block, size_t last_block) {
+			cull_blocks(frustum, visible.data(), first_block, last_block);
+		});
+	}
+	else
+	{
+		cull_blocks(frustum, visible.data(), 0, block_count);
+	}
+}
+
+void AABBBatch::cull_blocks(const Frustum &frustum, uint8_t *visible, size_t first_block, size_t last_block) const
+{
+	const auto &planes = frustum.get_planes();
+
+	for (size_t offset = first_block * LANE_COUNT; offset < last_block * LANE_COUNT; offset += LANE_COUNT)
+	{
+		Lanes center[3] = {load(&world_center[0][offset]), load(&world_center[1][offset]), load(&world_center[2][offset])};
+		Lanes extent[3] = {load(&world_extent[0][offset]), load(&world_extent[1][offset]), load(&world_extent[2][offset])};
+
+		uint32_t outside = 0;
+		for (auto &plane : planes)
+		{
+			// Signed distance of the center plus the projected radius of the box on the plane normal
+			Lanes distance = add(add(mul(splat(plane.x), center[0]), mul(splat(plane.y), center[1])), add(mul(splat(plane.z), center[2]), splat(plane.w)));
+			Lanes radius   = add(add(mul(splat(std::abs(plane.x)), extent[0]), mul(splat(std::abs(plane.y)), extent[1])), mul(splat(std::abs(plane.z)), extent[2]));
+
+			outside |= negative_mask(add(distance, radius));
+		}
+
+		for (size_t lane = 0; lane < LANE_COUNT && offset + lane < count; ++lane)
+		{
+			visible[offset + lane] = (outside & (1u << lane)) ? 0 : 1;
+		}
+	}
+}
+
+glm::vec3 AABBBatch::get_center(size_t index) const
+{
+	assert(index < count && "Box index is out of bounds");
+	return {world_center[0][index], world_center[1][index], world_center[2][index]};
+}
+
+glm::vec3 AABBBatch::get_min(size_t index) const
+{
+	assert(index < count && "Box index is out of bounds");
+	return get_center(index) - glm::vec3{world_extent[0][index], world_extent[1][index], world_extent[2][index]};
+}
+
+glm::vec3 AABBBatch::get_max(size_t index) const
+{
+	assert(index < count && "Box index is out of bounds");
+	return get_center(index) + glm::vec3{world_extent[0][index], world_extent[1][index], world_extent[2][index]};
+}
+}        // namespace vkb
@@ -0,0 +1,112 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "common/error.h"
+
+#include "common/glm_common.h"
+
+namespace vkb
+{
+class Frustum;
+class JobSystem;
+
+/**
+ * @brief Structure-of-arrays store of axis-aligned bounding boxes
+ *
+ * Boxes are kept as a local-space center and half extent. The world-space boxes are computed
+ * in batches of LANE_COUNT boxes using SSE2 or NEON when available, and only for boxes whose
+ * transform version changed, so static geometry is transformed once. Large batches can be culled
+ * across the workers of a job system.
+ */
+class AABBBatch
+{
+  public:
+	/// Number of boxes processed at once by the kernels
+	static constexpr size_t LANE_COUNT = 4;
+
+	/// Smallest number of boxes worth a job of their own
+	static constexpr size_t ParallelThreshold = 4096;
+
+	void clear();
+
+	/**
+	 * @brief Adds a box in local space
+	 * @return The index of the box
+	 */
+	size_t add(const glm::vec3 &min, const glm::vec3 &max);
+
+	size_t size() const;
+
+	/**
+	 * @brief Sets the world matrix of a box
+	 * @param index The index of the box
+	 * @param version A value that changes whenever the matrix changes, the box is left untouched if it is equal to the last one
+	 * @param matrix The local to world matrix
+	 */
+	void set_transform(size_t index, uint32_t version, const glm::mat4 &matrix);
+
+	/**
+	 * @brief Computes the world-space boxes of all boxes whose transform changed
+	 */
+	void update();
+
+	/**
+	 * @brief Tests the world-space boxes against the planes of a frustum
+	 * @param frustum The frustum to test against
+	 * @param visible Set to 1 for each box inside or intersecting the frustum, 0 otherwise
+	 * @param jobs Optional job system the boxes are split across
+	 */
+	void cull(const Frustum &frustum, std::vector<uint8_t> &visible, JobSystem *jobs = nullptr) const;
+
+	glm::vec3 get_center(size_t index) const;
+
+	glm::vec3 get_min(size_t index) const;
+
+	glm::vec3 get_max(size_t index) const;
+
+  private:
+	/**
+	 * @brief Tests the blocks of boxes [first_block, last_block)
+	 */
+	void cull_blocks(const Frustum &frustum, uint8_t *visible, size_t first_block, size_t last_block) const;
+
+	size_t count{0};
+
+	/// Local-space center and half extent, padded to a multiple of LANE_COUNT
+	std::array<std::vector<float>, 3> local_center;
+
+	std::array<std::vector<float>, 3> local_extent;
+
+	/// Upper 3x4 part of the world matrices, row-major
+	std::array<std::vector<float>, 12> matrix;
+
+	/// World-space center and half extent
+	std::array<std::vector<float>, 3> world_center;
+
+	std::array<std::vector<float>, 3> world_extent;
+
+	std::vector<uint32_t> versions;
+
+	/// One flag per block of LANE_COUNT boxes
+	std::vector<uint8_t> dirty_blocks;
+};
+}        // namespace vkb
@@ -0,0 +1,167 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bounding_sphere_batch.h"
+
+#include <algorithm>
+
+#include "core/util/job_system.hpp"
+#include "frustum.h"
+#include "simd_lanes.h"
+
+namespace vkb
+{
+using namespace simd;
+
+static_assert(BoundingSphereBatch::LANE_COUNT == simd::LANE_COUNT, "The spheres are tested a vector at a time");
+
+void BoundingSphereBatch::clear()
+{
+	count = 0;
+
+	for (auto &values : centers)
+	{
+		values.clear();
+	}
+	radii.clear();
+}
+
+size_t BoundingSphereBatch::add(const glm::vec3 &center, float radius)
+{
+	size_t index = count++;
+
+	size_t padded_size = (count + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+	if (radii.size() < padded_size)
+	{
+		for (auto &values : centers)
+		{
+			values.resize(padded_size, 0.0f);
+		}
+		radii.resize(padded_size, 0.0f);
+	}
+
+	set(index, center, radius);
+
+	return index;
+}
+
+void BoundingSphereBatch::set(size_t index, const glm::vec3 &center, float radius)
+{
+	assert(index < count && "Sphere index is out of bounds");
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		centers[axis][index] = center[axis];
+	}
+	radii[index] = radius;
+}
+
+size_t BoundingSphereBatch::size() const
+{
+	return count;
+}
+
+uint32_t BoundingSphereBatch::cull_block(const glm::vec4 *planes, size_t plane_count, size_t offset) const
+{
+	Lanes center[3] = {load(&centers[0][offset]), load(&centers[1][offset]), load(&centers[2][offset])};
+	Lanes radius    = load(&radii[offset]);
+
+	uint32_t outside = 0;
+	for (size_t i = 0; i < plane_count; ++i)
+	{
+		const auto &plane = planes[i];
+
+		// Signed distance of the center plus the radius, negative if the sphere is entirely behind the plane
+		Lanes distance = add(add(mul(splat(plane.x), center[0]), mul(splat(plane.y), center[1])), add(mul(splat(plane.z), center[2]), splat(plane.w)));
+
+		outside |= negative_mask(add(distance, radius));
+	}
+
+	return outside;
+}
+
+template <typename Function>
+void BoundingSphereBatch::for_each_range(JobSystem *jobs, Function &&function) const
+{
+	if (jobs)
+	{
+		// Ranges are split by block, so no two jobs write the results of the same block
+		size_t block_count = (count + LANE_COUNT - 1) / LANE_COUNT;
+		jobs->parallel_for(block_count, ParallelThreshold / LANE_COUNT, [this, &function](size_t first_block, size_t last_block) {
+			function(first_block * LANE_COUNT, std::min(last_block * LANE_COUNT, count));
+		});
+	}
+	else
+	{
+		function(0, count);
+	}
+}
+
+void BoundingSphereBatch::cull(const glm::vec4 *planes, size_t plane_count, uint8_t *visible, JobSystem *jobs) const
+{
+	for_each_range(jobs, [&](size_t first, size_t last) {
+		for (size_t offset = first; offset < last; offset += LANE_COUNT)
+		{
+			uint32_t outside = cull_block(planes, plane_count, offset);
+
+			for (size_t lane = 0; lane < LANE_COUNT && offset + lane < last; ++lane)
+			{
+				visible[offset + lane] = (outside & (1u << lane)) ? 0 : 1;
+			}
+		}
+	});
+}
+
+void BoundingSphereBatch::cull(const Frustum &frustum, uint8_t *visible, JobSystem *jobs) const
+{
+	const auto &planes = frustum.get_planes();
+	cull(planes.data(), planes.size(), visible, jobs);
+}
+
+void BoundingSphereBatch::cull_draws(const glm::vec4 *planes, size_t plane_count, const VkDrawIndexedIndirectCommand *draws, VkDrawIndexedIndirectCommand *output,
+                                     JobSystem *jobs) const
+{
+	for_each_range(jobs, [&](size_t first, size_t last) {
+		for (size_t offset = first; offset < last; offset += LANE_COUNT)
+		{
+			uint32_t outside = cull_block(planes, plane_count, offset);
+
+			for (size_t lane = 0; lane < LANE_COUNT && offset + lane < last; ++lane)
+			{
+				VkDrawIndexedIndirectCommand draw = draws[offset + lane];
+				if (outside & (1u << lane))
+				{
+					draw.instanceCount = 0;
+				}
+				output[offset + lane] = draw;
+			}
+		}
+	});
+}
+
+glm::vec3 BoundingSphereBatch::get_center(size_t index) const
+{
+	assert(index < count && "Sphere index is out of bounds");
+	return {centers[0][index], centers[1][index], centers[2][index]};
+}
+
+float BoundingSphereBatch::get_radius(size_t index) const
+{
+	assert(index < count && "Sphere index is out of bounds");
+	return radii[index];
+}
+}        // namespace vkb
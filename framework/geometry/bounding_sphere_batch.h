@@ -0,0 +1,113 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "common/error.h"
+
+#include "common/glm_common.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Frustum;
+class JobSystem;
+
+/**
+ * @brief Structure-of-arrays store of bounding spheres, culled against planes in batches
+ *
+ * Spheres are tested LANE_COUNT at a time using SSE2 or NEON when available, and large batches can be
+ * split across the workers of a job system. The results can be written straight into indirect draw commands, so a
+ * CPU culling fallback fills a mapped indirect buffer without an intermediate copy.
+ */
+class BoundingSphereBatch
+{
+  public:
+	/// Number of spheres tested at once by the kernel
+	static constexpr size_t LANE_COUNT = 4;
+
+	/// Smallest number of spheres worth a job of their own
+	static constexpr size_t ParallelThreshold = 4096;
+
+	void clear();
+
+	/**
+	 * @brief Adds a sphere
+	 * @return The index of the sphere
+	 */
+	size_t add(const glm::vec3 &center, float radius);
+
+	/**
+	 * @brief Moves or resizes a sphere
+	 */
+	void set(size_t index, const glm::vec3 &center, float radius);
+
+	size_t size() const;
+
+	/**
+	 * @brief Tests the spheres against planes, a sphere is visible unless it is entirely behind one of them
+	 * @param planes Normalized planes, their normals pointing towards the visible side
+	 * @param plane_count Number of planes
+	 * @param visible Set to 1 for each visible sphere, 0 otherwise, must hold size() values
+	 * @param jobs Optional job system the spheres are split across
+	 */
+	void cull(const glm::vec4 *planes, size_t plane_count, uint8_t *visible, JobSystem *jobs = nullptr) const;
+
+	/**
+	 * @brief Tests the spheres against the six planes of a frustum
+	 */
+	void cull(const Frustum &frustum, uint8_t *visible, JobSystem *jobs = nullptr) const;
+
+	/**
+	 * @brief Writes the draws of the spheres, with an instance count of zero for the culled ones
+	 *        Every command is written whole and in order, so the output can be write-combined mapped memory.
+	 * @param planes Normalized planes, their normals pointing towards the visible side
+	 * @param plane_count Number of planes
+	 * @param draws One draw per sphere, copied as is if the sphere is visible
+	 * @param output Receives size() draws, typically the mapped memory of an indirect buffer
+	 * @param jobs Optional job system the spheres are split across
+	 */
+	void cull_draws(const glm::vec4 *planes, size_t plane_count, const VkDrawIndexedIndirectCommand *draws, VkDrawIndexedIndirectCommand *output,
+	                JobSystem *jobs = nullptr) const;
+
+	glm::vec3 get_center(size_t index) const;
+
+	float get_radius(size_t index) const;
+
+  private:
+	/**
+	 * @brief Returns a bit per sphere of the block starting at offset, set if the sphere is culled
+	 */
+	uint32_t cull_block(const glm::vec4 *planes, size_t plane_count, size_t offset) const;
+
+	/**
+	 * @brief Calls a function on the ranges of blocks [first, last), split across a job system if the batch is large enough
+	 */
+	template <typename Function>
+	void for_each_range(JobSystem *jobs, Function &&function) const;
+
+	size_t count{0};
+
+	/// Centers and radii, padded to a multiple of LANE_COUNT
+	std::array<std::vector<float>, 3> centers;
+
+	std::vector<float> radii;
+};
+}        // namespace vkb
@@ -69,6 +69,24 @@ bool Frustum::check_sphere(glm::vec3 pos, float radius)
 	}
 	return true;
 }
+
+bool Frustum::check_box(const glm::vec3 &min, const glm::vec3 &max) const
+{
+	for (auto &plane : planes)
+	{
+		// Test the corner of the box furthest along the plane normal
+		glm::vec3 corner{plane.x >= 0.0f ? max.x : min.x,
+		                 plane.y >= 0.0f ? max.y : min.y,
+		                 plane.z >= 0.0f ? max.z : min.z};
+
+		if ((plane.x * corner.x) + (plane.y * corner.y) + (plane.z * corner.z) + plane.w < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 const std::array<glm::vec4, 6> &Frustum::get_planes() const
 {
 	return planes;
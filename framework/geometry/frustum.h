@@ -55,6 +55,13 @@ class Frustum
 	 */
 	bool check_sphere(glm::vec3 pos, float radius);
 
+	/**
+	 * @brief Checks if an axis-aligned box is inside or intersects the Frustum
+	 * @param min The minimum corner of the box
+	 * @param max The maximum corner of the box
+	 */
+	bool check_box(const glm::vec3 &min, const glm::vec3 &max) const;
+
 	const std::array<glm::vec4, 6> &get_planes() const;
 
   private:
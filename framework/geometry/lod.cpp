@@ -0,0 +1,47 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "geometry/lod.h"
+
+#include <algorithm>
+
+namespace vkb
+{
+float get_lod_pixel_scale(const glm::mat4 &projection, float viewport_height)
+{
+	// The projection scales y by the cotangent of half the vertical field of view, which maps to half the viewport
+	return 0.5f * std::abs(projection[1][1]) * viewport_height;
+}
+
+uint32_t select_lod(const std::vector<LevelOfDetail> &lods, float distance, float object_scale, float pixel_scale, float threshold)
+{
+	// Inside the bounds any error can be seen
+	if (lods.empty() || distance <= 0.0f)
+	{
+		return 0;
+	}
+
+	float max_error = threshold * distance / (object_scale * pixel_scale);
+
+	uint32_t level = 0;
+	for (uint32_t i = 1; i < lods.size() && lods[i].error <= max_error; ++i)
+	{
+		level = i;
+	}
+	return level;
+}
+}        // namespace vkb
@@ -0,0 +1,59 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/glm_common.h"
+
+namespace vkb
+{
+/// Most levels of detail of a sub mesh, the full mesh included
+constexpr uint32_t MaxLodCount = 4;
+
+/**
+ * @brief A range of the index buffer of a sub mesh drawing a simplified version of its triangles
+ */
+struct LevelOfDetail
+{
+	/// First index of the range, counted from the index offset of the sub mesh
+	uint32_t first_index;
+
+	uint32_t index_count;
+
+	/// Farthest a vertex moved from the full mesh, in object space
+	float error;
+};
+
+/**
+ * @return Pixels covered by one unit of object space at a distance of one unit from a perspective camera
+ */
+float get_lod_pixel_scale(const glm::mat4 &projection, float viewport_height);
+
+/**
+ * @brief Selects the coarsest level whose error, projected on the screen, stays under a threshold
+ * @param lods The levels, from the full mesh to the coarsest
+ * @param distance Distance from the camera to the nearest point of the bounds, in world space
+ * @param object_scale Largest scale of the object space to the world space
+ * @param pixel_scale From get_lod_pixel_scale
+ * @param threshold Largest error allowed, in pixels
+ * @return Index of the level, 0 if there are none
+ */
+uint32_t select_lod(const std::vector<LevelOfDetail> &lods, float distance, float object_scale, float pixel_scale, float threshold);
+}        // namespace vkb
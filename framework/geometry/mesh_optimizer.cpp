@@ -0,0 +1,726 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "geometry/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+#include "common/glm_common.h"
+#include "common/helpers.h"
+#include <glm/gtc/packing.hpp>
+
+namespace vkb
+{
+namespace mesh_optimizer
+{
+namespace
+{
+constexpr uint32_t NotCached = std::numeric_limits<uint32_t>::max();
+
+float get_vertex_score(uint32_t cache_position, uint32_t live_triangles)
+{
+	if (live_triangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+
+	if (cache_position != NotCached)
+	{
+		// The vertices of the last triangle get a fixed score, so that the next triangle doesn't simply reuse its edge
+		if (cache_position < 3)
+		{
+			score = 0.75f;
+		}
+		else
+		{
+			score = std::pow(1.0f - static_cast<float>(cache_position - 3) / (CacheSize - 3), 1.5f);
+		}
+	}
+
+	// Favors the vertices with few triangles left, so they leave the cache quickly
+	return score + 2.0f / std::sqrt(static_cast<float>(live_triangles));
+}
+
+glm::vec3 get_position(const uint8_t *positions, size_t stride, uint32_t index)
+{
+	glm::vec3 position;
+	std::memcpy(&position, positions + index * stride, sizeof(position));
+	return position;
+}
+}        // namespace
+
+void optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count)
+{
+	const size_t triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+	{
+		return;
+	}
+
+	// Triangles of each vertex, the live ones first
+	std::vector<uint32_t> live_triangles(vertex_count, 0);
+	for (auto index : indices)
+	{
+		assert(index < vertex_count);
+		++live_triangles[index];
+	}
+
+	std::vector<uint32_t> first_triangle(vertex_count + 1, 0);
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		first_triangle[i + 1] = first_triangle[i] + live_triangles[i];
+	}
+
+	std::vector<uint32_t> vertex_triangles(indices.size());
+	{
+		std::vector<uint32_t> cursor(first_triangle.begin(), first_triangle.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			vertex_triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<uint32_t> cache_position(vertex_count, NotCached);
+
+	std::vector<float> vertex_score(vertex_count);
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		vertex_score[i] = get_vertex_score(NotCached, live_triangles[i]);
+	}
+
+	std::vector<float> triangle_score(triangle_count);
+	for (size_t i = 0; i < triangle_count; ++i)
+	{
+		triangle_score[i] = vertex_score[indices[i * 3]] + vertex_score[indices[i * 3 + 1]] + vertex_score[indices[i * 3 + 2]];
+	}
+
+	std::vector<uint8_t>  emitted(triangle_count, 0);
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	// The cache before and after a triangle, with room for the three vertices pushed
+	std::array<uint32_t, CacheSize + 3> cache{};
+	std::array<uint32_t, CacheSize + 3> new_cache{};
+	size_t                              cache_count = 0;
+
+	size_t input_cursor  = 0;
+	size_t best_triangle = std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin();
+
+	while (result.size() < indices.size())
+	{
+		if (best_triangle == triangle_count)
+		{
+			// No triangle left around the cache, starts again from the next one in the input
+			while (emitted[input_cursor])
+			{
+				++input_cursor;
+			}
+			best_triangle = input_cursor;
+		}
+
+		emitted[best_triangle] = 1;
+
+		const uint32_t *triangle = &indices[best_triangle * 3];
+
+		size_t new_cache_count = 0;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			auto vertex = triangle[i];
+			result.push_back(vertex);
+			new_cache[new_cache_count++] = vertex;
+
+			// Removes the triangle from the live ones of the vertex
+			auto *begin = &vertex_triangles[first_triangle[vertex]];
+			auto *end   = begin + live_triangles[vertex];
+			auto *it    = std::find(begin, end, static_cast<uint32_t>(best_triangle));
+			assert(it != end);
+			std::swap(*it, *(end - 1));
+			--live_triangles[vertex];
+		}
+
+		for (size_t i = 0; i < cache_count; ++i)
+		{
+			auto vertex = cache[i];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				new_cache[new_cache_count++] = vertex;
+			}
+		}
+
+		// Updates the scores of the vertices which moved in or out of the cache, then of their triangles
+		for (size_t i = 0; i < new_cache_count; ++i)
+		{
+			auto vertex            = new_cache[i];
+			cache_position[vertex] = i < CacheSize ? static_cast<uint32_t>(i) : NotCached;
+
+			float score          = get_vertex_score(cache_position[vertex], live_triangles[vertex]);
+			float delta          = score - vertex_score[vertex];
+			vertex_score[vertex] = score;
+
+			for (uint32_t j = 0; j < live_triangles[vertex]; ++j)
+			{
+				triangle_score[vertex_triangles[first_triangle[vertex] + j]] += delta;
+			}
+		}
+
+		cache_count = std::min(new_cache_count, CacheSize);
+		std::copy(new_cache.begin(), new_cache.begin() + cache_count, cache.begin());
+
+		// Picks the best triangle around the cache
+		best_triangle    = triangle_count;
+		float best_score = -std::numeric_limits<float>::max();
+
+		for (size_t i = 0; i < cache_count; ++i)
+		{
+			auto vertex = cache[i];
+			for (uint32_t j = 0; j < live_triangles[vertex]; ++j)
+			{
+				auto candidate = vertex_triangles[first_triangle[vertex] + j];
+				if (triangle_score[candidate] > best_score)
+				{
+					best_score    = triangle_score[candidate];
+					best_triangle = candidate;
+				}
+			}
+		}
+	}
+
+	indices = std::move(result);
+}
+
+void optimize_overdraw(std::vector<uint32_t> &indices, const uint8_t *positions, size_t position_stride, size_t vertex_count)
+{
+	const size_t triangle_count = indices.size() / 3;
+	if (triangle_count < 2)
+	{
+		return;
+	}
+
+	// Splits the triangles where all of their vertices miss the cache
+	std::vector<size_t>   cluster_starts;
+	std::vector<uint32_t> cache_timestamps(vertex_count, 0);
+	uint32_t              timestamp = CacheSize + 1;
+
+	for (size_t i = 0; i < triangle_count; ++i)
+	{
+		uint32_t misses = 0;
+		for (size_t j = 0; j < 3; ++j)
+		{
+			auto vertex = indices[i * 3 + j];
+			if (timestamp - cache_timestamps[vertex] > CacheSize)
+			{
+				cache_timestamps[vertex] = timestamp++;
+				++misses;
+			}
+		}
+
+		if (i == 0 || misses == 3)
+		{
+			cluster_starts.push_back(i);
+		}
+	}
+
+	cluster_starts.push_back(triangle_count);
+
+	const size_t cluster_count = cluster_starts.size() - 1;
+	if (cluster_count < 2)
+	{
+		return;
+	}
+
+	// Area weighted centers and normals
+	std::vector<glm::vec3> cluster_centers(cluster_count, glm::vec3(0.0f));
+	std::vector<glm::vec3> cluster_normals(cluster_count, glm::vec3(0.0f));
+	std::vector<float>     cluster_areas(cluster_count, 0.0f);
+
+	glm::vec3 mesh_center(0.0f);
+	float     mesh_area = 0.0f;
+
+	for (size_t cluster = 0; cluster < cluster_count; ++cluster)
+	{
+		for (size_t i = cluster_starts[cluster]; i < cluster_starts[cluster + 1]; ++i)
+		{
+			auto p0 = get_position(positions, position_stride, indices[i * 3]);
+			auto p1 = get_position(positions, position_stride, indices[i * 3 + 1]);
+			auto p2 = get_position(positions, position_stride, indices[i * 3 + 2]);
+
+			auto  normal = glm::cross(p1 - p0, p2 - p0);
+			float area   = glm::length(normal);
+
+			cluster_centers[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+			cluster_normals[cluster] += normal;
+			cluster_areas[cluster] += area;
+		}
+
+		mesh_center += cluster_centers[cluster];
+		mesh_area += cluster_areas[cluster];
+	}
+
+	if (mesh_area > 0.0f)
+	{
+		mesh_center /= mesh_area;
+	}
+
+	std::vector<float> sort_keys(cluster_count);
+	for (size_t cluster = 0; cluster < cluster_count; ++cluster)
+	{
+		auto center = cluster_areas[cluster] > 0.0f ? cluster_centers[cluster] / cluster_areas[cluster] : mesh_center;
+		auto length = glm::length(cluster_normals[cluster]);
+
+		sort_keys[cluster] = length > 0.0f ? glm::dot(center - mesh_center, cluster_normals[cluster] / length) : 0.0f;
+	}
+
+	std::vector<size_t> order(cluster_count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&sort_keys](size_t a, size_t b) { return sort_keys[a] > sort_keys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	for (auto cluster : order)
+	{
+		result.insert(result.end(), indices.begin() + cluster_starts[cluster] * 3, indices.begin() + cluster_starts[cluster + 1] * 3);
+	}
+
+	indices = std::move(result);
+}
+
+std::vector<uint32_t> optimize_vertex_fetch(std::vector<uint32_t> &indices, size_t vertex_count)
+{
+	std::vector<uint32_t> remap(vertex_count, NotCached);
+	uint32_t              next_index = 0;
+
+	for (auto &index : indices)
+	{
+		if (remap[index] == NotCached)
+		{
+			remap[index] = next_index++;
+		}
+		index = remap[index];
+	}
+
+	for (auto &new_index : remap)
+	{
+		if (new_index == NotCached)
+		{
+			new_index = next_index++;
+		}
+	}
+
+	return remap;
+}
+
+void remap_vertex_data(std::vector<uint8_t> &data, size_t stride, const std::vector<uint32_t> &remap)
+{
+	assert(data.size() >= remap.size() * stride);
+
+	std::vector<uint8_t> result(data.size());
+	for (size_t i = 0; i < remap.size(); ++i)
+	{
+		std::memcpy(result.data() + remap[i] * stride, data.data() + i * stride, stride);
+	}
+
+	data = std::move(result);
+}
+
+std::vector<uint8_t> quantize_to_half(const std::vector<uint8_t> &data, size_t stride)
+{
+	const size_t vertex_count = data.size() / stride;
+
+	std::vector<uint8_t> result(vertex_count * 4 * sizeof(uint16_t));
+	auto                *output = reinterpret_cast<uint16_t *>(result.data());
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		auto value = get_position(data.data(), stride, static_cast<uint32_t>(i));
+
+		output[i * 4]     = glm::packHalf1x16(value.x);
+		output[i * 4 + 1] = glm::packHalf1x16(value.y);
+		output[i * 4 + 2] = glm::packHalf1x16(value.z);
+		output[i * 4 + 3] = glm::packHalf1x16(1.0f);
+	}
+
+	return result;
+}
+
+std::vector<uint8_t> pack_positions(const std::vector<uint8_t> &data, size_t stride, glm::vec3 &offset, glm::vec3 &scale)
+{
+	const size_t vertex_count = data.size() / stride;
+
+	glm::vec3 min{std::numeric_limits<float>::max()};
+	glm::vec3 max{std::numeric_limits<float>::lowest()};
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		auto value = get_position(data.data(), stride, static_cast<uint32_t>(i));
+		min        = glm::min(min, value);
+		max        = glm::max(max, value);
+	}
+
+	if (vertex_count == 0)
+	{
+		min = max = glm::vec3{0.0f};
+	}
+
+	offset = min;
+	scale  = max - min;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (scale[axis] <= 0.0f)
+		{
+			scale[axis] = 1.0f;
+		}
+	}
+
+	std::vector<uint8_t> result(vertex_count * 4 * sizeof(uint16_t));
+	auto                *output = reinterpret_cast<uint16_t *>(result.data());
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		auto value = (get_position(data.data(), stride, static_cast<uint32_t>(i)) - offset) / scale;
+
+		output[i * 4]     = glm::packUnorm1x16(value.x);
+		output[i * 4 + 1] = glm::packUnorm1x16(value.y);
+		output[i * 4 + 2] = glm::packUnorm1x16(value.z);
+		output[i * 4 + 3] = glm::packUnorm1x16(1.0f);
+	}
+
+	return result;
+}
+
+std::vector<uint8_t> pack_normals(const std::vector<uint8_t> &data, size_t stride)
+{
+	const size_t vertex_count = data.size() / stride;
+
+	std::vector<uint8_t> result(vertex_count * sizeof(uint32_t));
+	auto                *output = reinterpret_cast<uint32_t *>(result.data());
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		auto normal = get_position(data.data(), stride, static_cast<uint32_t>(i));
+
+		float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (length == 0.0f)
+		{
+			output[i] = glm::packSnorm2x16(glm::vec2{0.0f, 0.0f});
+			continue;
+		}
+
+		// Projects the normal on the octahedron, folding the lower half over the upper one
+		glm::vec2 encoded = glm::vec2{normal.x, normal.y} / length;
+		if (normal.z < 0.0f)
+		{
+			encoded = (1.0f - glm::abs(glm::vec2{encoded.y, encoded.x})) *
+			          glm::vec2{encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f};
+		}
+
+		output[i] = glm::packSnorm2x16(encoded);
+	}
+
+	return result;
+}
+
+std::vector<uint8_t> pack_tangents(const std::vector<uint8_t> &data, size_t stride)
+{
+	const size_t vertex_count = data.size() / stride;
+
+	std::vector<uint8_t> result(vertex_count * sizeof(uint32_t));
+	auto                *output = reinterpret_cast<uint32_t *>(result.data());
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		glm::vec4 tangent;
+		std::memcpy(&tangent, data.data() + i * stride, sizeof(tangent));
+
+		// The red component is in the lowest bits of VK_FORMAT_A2B10G10R10_SNORM_PACK32, as glm packs it
+		output[i] = glm::packSnorm3x10_1x2(glm::vec4{glm::vec3{tangent}, tangent.w < 0.0f ? -1.0f : 1.0f});
+	}
+
+	return result;
+}
+
+std::vector<uint8_t> pack_to_half2(const std::vector<uint8_t> &data, size_t stride)
+{
+	const size_t vertex_count = data.size() / stride;
+
+	std::vector<uint8_t> result(vertex_count * 2 * sizeof(uint16_t));
+	auto                *output = reinterpret_cast<uint32_t *>(result.data());
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		glm::vec2 value;
+		std::memcpy(&value, data.data() + i * stride, sizeof(value));
+
+		output[i] = glm::packHalf2x16(value);
+	}
+
+	return result;
+}
+
+MeshletData build_meshlets(const std::vector<uint32_t> &indices, const uint8_t *positions, size_t position_stride, size_t vertex_count)
+{
+	MeshletData result;
+
+	// Meshlet vertex of every mesh vertex in the meshlet being built
+	std::vector<uint8_t> meshlet_vertex(vertex_count, 0xff);
+
+	Meshlet meshlet{};
+
+	auto finish_meshlet = [&]() {
+		if (meshlet.triangle_count == 0)
+		{
+			return;
+		}
+
+		glm::vec3 min{std::numeric_limits<float>::max()};
+		glm::vec3 max{std::numeric_limits<float>::lowest()};
+		for (uint32_t i = 0; i < meshlet.vertex_count; ++i)
+		{
+			auto position = get_position(positions, position_stride, result.vertices[meshlet.vertex_offset + i]);
+			min           = glm::min(min, position);
+			max           = glm::max(max, position);
+		}
+
+		meshlet.center = (min + max) * 0.5f;
+		meshlet.radius = 0.0f;
+		for (uint32_t i = 0; i < meshlet.vertex_count; ++i)
+		{
+			auto position  = get_position(positions, position_stride, result.vertices[meshlet.vertex_offset + i]);
+			meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, position));
+		}
+
+		std::vector<glm::vec3> normals;
+		normals.reserve(meshlet.triangle_count);
+		glm::vec3 axis{0.0f};
+		for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+		{
+			uint32_t triangle = result.triangles[meshlet.triangle_offset + i];
+
+			auto a = get_position(positions, position_stride, result.vertices[meshlet.vertex_offset + (triangle & 0xff)]);
+			auto b = get_position(positions, position_stride, result.vertices[meshlet.vertex_offset + ((triangle >> 8) & 0xff)]);
+			auto c = get_position(positions, position_stride, result.vertices[meshlet.vertex_offset + ((triangle >> 16) & 0xff)]);
+
+			auto  normal = glm::cross(b - a, c - a);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		float axis_length = glm::length(axis);
+		meshlet.cone_axis = axis_length > 0.0f ? axis / axis_length : glm::vec3{0.0f, 0.0f, 1.0f};
+
+		// The cone has to hold every normal, it can only backface the meshlet if all of them lean the same way
+		float min_dot = axis_length > 0.0f ? 1.0f : -1.0f;
+		for (auto &normal : normals)
+		{
+			min_dot = std::min(min_dot, glm::dot(normal, meshlet.cone_axis));
+		}
+		meshlet.cone_cutoff = min_dot > 0.0f ? std::sqrt(1.0f - min_dot * min_dot) : 1.0f;
+
+		for (uint32_t i = 0; i < meshlet.vertex_count; ++i)
+		{
+			meshlet_vertex[result.vertices[meshlet.vertex_offset + i]] = 0xff;
+		}
+
+		result.meshlets.push_back(meshlet);
+
+		meshlet                 = {};
+		meshlet.vertex_offset   = to_u32(result.vertices.size());
+		meshlet.triangle_offset = to_u32(result.triangles.size());
+	};
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		std::array<uint32_t, 3> triangle{indices[i], indices[i + 1], indices[i + 2]};
+
+		uint32_t new_vertices = 0;
+		for (size_t j = 0; j < 3; ++j)
+		{
+			bool repeated = std::find(triangle.begin(), triangle.begin() + j, triangle[j]) != triangle.begin() + j;
+			if (meshlet_vertex[triangle[j]] == 0xff && !repeated)
+			{
+				++new_vertices;
+			}
+		}
+
+		if (meshlet.vertex_count + new_vertices > MaxMeshletVertices || meshlet.triangle_count + 1 > MaxMeshletTriangles)
+		{
+			finish_meshlet();
+		}
+
+		uint32_t packed = 0;
+		for (size_t j = 0; j < 3; ++j)
+		{
+			auto &local = meshlet_vertex[triangle[j]];
+			if (local == 0xff)
+			{
+				local = static_cast<uint8_t>(meshlet.vertex_count++);
+				result.vertices.push_back(triangle[j]);
+			}
+			packed |= static_cast<uint32_t>(local) << (8 * j);
+		}
+
+		result.triangles.push_back(packed);
+		++meshlet.triangle_count;
+	}
+
+	finish_meshlet();
+
+	return result;
+}
+
+std::vector<uint32_t> simplify(const std::vector<uint32_t> &indices, const uint8_t *positions, size_t position_stride, size_t vertex_count, uint32_t grid_size, float &error)
+{
+	error = 0.0f;
+
+	glm::vec3 min{std::numeric_limits<float>::max()};
+	glm::vec3 max{std::numeric_limits<float>::lowest()};
+	for (auto index : indices)
+	{
+		auto position = get_position(positions, position_stride, index);
+		min           = glm::min(min, position);
+		max           = glm::max(max, position);
+	}
+
+	float extent = std::max(max.x - min.x, std::max(max.y - min.y, max.z - min.z));
+	if (indices.empty() || extent <= 0.0f || grid_size == 0)
+	{
+		return {};
+	}
+
+	// Cubic cells, so the error is the same along every axis
+	float cell_size = extent / grid_size;
+
+	auto get_cell = [&](uint32_t index) {
+		auto coordinates = glm::min(glm::uvec3((get_position(positions, position_stride, index) - min) / cell_size), glm::uvec3(grid_size - 1));
+		return (static_cast<uint64_t>(coordinates.x) * (grid_size + 1) + coordinates.y) * (grid_size + 1) + coordinates.z;
+	};
+
+	// Average of the vertices of every cell, then the vertex closest to it
+	struct Cell
+	{
+		glm::vec3 sum{0.0f};
+		uint32_t  count{0};
+		uint32_t  vertex{NotCached};
+		float     distance{std::numeric_limits<float>::max()};
+	};
+
+	std::unordered_map<uint64_t, Cell> cells;
+	std::vector<uint64_t>              vertex_cells(vertex_count, 0);
+	std::vector<uint8_t>               referenced(vertex_count, 0);
+
+	for (auto index : indices)
+	{
+		if (referenced[index])
+		{
+			continue;
+		}
+		referenced[index]   = 1;
+		vertex_cells[index] = get_cell(index);
+
+		auto &cell = cells[vertex_cells[index]];
+		cell.sum += get_position(positions, position_stride, index);
+		++cell.count;
+	}
+
+	for (uint32_t i = 0; i < vertex_count; ++i)
+	{
+		if (!referenced[i])
+		{
+			continue;
+		}
+
+		auto &cell     = cells[vertex_cells[i]];
+		float distance = glm::distance(cell.sum / static_cast<float>(cell.count), get_position(positions, position_stride, i));
+		if (distance < cell.distance)
+		{
+			cell.distance = distance;
+			cell.vertex   = i;
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	std::set<std::array<uint32_t, 3>> seen_triangles;
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		std::array<uint32_t, 3> triangle;
+		for (size_t j = 0; j < 3; ++j)
+		{
+			uint32_t index = indices[i + j];
+			triangle[j]    = cells[vertex_cells[index]].vertex;
+
+			error = std::max(error, glm::distance(get_position(positions, position_stride, index), get_position(positions, position_stride, triangle[j])));
+		}
+
+		if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0])
+		{
+			continue;
+		}
+
+		// Triangles collapsing onto the same vertices are kept once, with the same winding
+		auto first = static_cast<size_t>(std::min_element(triangle.begin(), triangle.end()) - triangle.begin());
+		if (!seen_triangles.insert({triangle[first], triangle[(first + 1) % 3], triangle[(first + 2) % 3]}).second)
+		{
+			continue;
+		}
+
+		result.insert(result.end(), triangle.begin(), triangle.end());
+	}
+
+	return result;
+}
+
+float compute_acmr(const std::vector<uint32_t> &indices, size_t vertex_count)
+{
+	const size_t triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+	{
+		return 0.0f;
+	}
+
+	std::vector<uint32_t> cache_timestamps(vertex_count, 0);
+	uint32_t              timestamp = CacheSize + 1;
+	size_t                misses    = 0;
+
+	for (auto index : indices)
+	{
+		if (timestamp - cache_timestamps[index] > CacheSize)
+		{
+			cache_timestamps[index] = timestamp++;
+			++misses;
+		}
+	}
+
+	return static_cast<float>(misses) / triangle_count;
+}
+}        // namespace mesh_optimizer
+}        // namespace vkb
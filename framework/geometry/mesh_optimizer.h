@@ -0,0 +1,163 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/glm_common.h"
+
+namespace vkb
+{
+/**
+ * @brief Load time optimizations of indexed triangle lists
+ *
+ * The passes are meant to run in order: optimize_vertex_cache, then optimize_overdraw, which
+ * keeps most of the cache locality, then optimize_vertex_fetch, whose remap table is applied
+ * to every vertex attribute with remap_vertex_data.
+ */
+namespace mesh_optimizer
+{
+/// Size of the post-transform vertex cache simulated, in vertices
+constexpr size_t CacheSize = 32;
+
+/**
+ * @brief Reorders the triangles so that consecutive triangles share vertices, following Forsyth's linear speed algorithm
+ */
+void optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count);
+
+/**
+ * @brief Reorders clusters of triangles so that the triangles facing away from the center of the mesh are drawn first,
+ *        which are the most likely to occlude the others from any view point
+ *        Clusters are split where the vertex cache restarts, so the cache locality is kept inside them.
+ * @param indices The triangles, optimized for the vertex cache
+ * @param positions The position of the first vertex, three floats
+ * @param position_stride Bytes between the positions of two vertices
+ */
+void optimize_overdraw(std::vector<uint32_t> &indices, const uint8_t *positions, size_t position_stride, size_t vertex_count);
+
+/**
+ * @brief Renumbers the vertices in the order the triangles first reference them, rewriting the indices
+ *        Vertices no triangle references are moved to the end.
+ * @return The new index of every vertex
+ */
+std::vector<uint32_t> optimize_vertex_fetch(std::vector<uint32_t> &indices, size_t vertex_count);
+
+/**
+ * @brief Moves the vertices of an attribute to their new index
+ */
+void remap_vertex_data(std::vector<uint8_t> &data, size_t stride, const std::vector<uint32_t> &remap);
+
+/**
+ * @brief Converts vertices of three floats to four half floats, the fourth one being 1.0
+ */
+std::vector<uint8_t> quantize_to_half(const std::vector<uint8_t> &data, size_t stride);
+
+/**
+ * @brief Normalizes positions of three floats in their bounds to four 16-bit unorms, the fourth one being 1.0
+ *        The shaders get the positions back as offset + value * scale.
+ * @param offset Set to the minimum of the bounds
+ * @param scale Set to the extent of the bounds, 1.0 on the axes where it is empty
+ */
+std::vector<uint8_t> pack_positions(const std::vector<uint8_t> &data, size_t stride, glm::vec3 &offset, glm::vec3 &scale);
+
+/**
+ * @brief Encodes normals of three floats as two 16-bit snorms of their octahedral mapping
+ */
+std::vector<uint8_t> pack_normals(const std::vector<uint8_t> &data, size_t stride);
+
+/**
+ * @brief Converts tangents of four floats to the snorms of VK_FORMAT_A2B10G10R10_SNORM_PACK32
+ *        The two bits of the fourth component keep the sign of the bitangent.
+ */
+std::vector<uint8_t> pack_tangents(const std::vector<uint8_t> &data, size_t stride);
+
+/**
+ * @brief Converts vertices of two floats to two half floats
+ */
+std::vector<uint8_t> pack_to_half2(const std::vector<uint8_t> &data, size_t stride);
+
+/// Most vertices a meshlet references, the output vertices of a mesh shader workgroup
+constexpr uint32_t MaxMeshletVertices = 64;
+
+/// Most triangles of a meshlet, the output primitives of a mesh shader workgroup
+constexpr uint32_t MaxMeshletTriangles = 124;
+
+/**
+ * @brief A cluster of triangles drawn by one mesh shader workgroup, laid out as the shaders read it
+ */
+struct alignas(16) Meshlet
+{
+	/// Bounding sphere of the triangles, in object space
+	glm::vec3 center;
+	float     radius;
+
+	/// Average direction of the triangle normals
+	glm::vec3 cone_axis;
+
+	/// Sine of the half angle of the normal cone, 1 when no direction backfaces all the triangles
+	float cone_cutoff;
+
+	uint32_t vertex_offset;
+	uint32_t triangle_offset;
+	uint32_t vertex_count;
+	uint32_t triangle_count;
+};
+
+/**
+ * @brief Meshlets of a mesh with the vertex and triangle lists they index into
+ */
+struct MeshletData
+{
+	std::vector<Meshlet> meshlets;
+
+	/// Index of the mesh vertex of every meshlet vertex
+	std::vector<uint32_t> vertices;
+
+	/// Meshlet vertices of every triangle, one per byte starting from the lowest
+	std::vector<uint32_t> triangles;
+};
+
+/**
+ * @brief Splits the triangles into meshlets of at most MaxMeshletVertices vertices and MaxMeshletTriangles triangles
+ *        The triangles are gathered in order, so a mesh optimized for the vertex cache gives compact meshlets.
+ * @param indices The triangles
+ * @param positions The position of the first vertex, three floats
+ * @param position_stride Bytes between the positions of two vertices
+ */
+MeshletData build_meshlets(const std::vector<uint32_t> &indices, const uint8_t *positions, size_t position_stride, size_t vertex_count);
+
+/**
+ * @brief Simplifies the triangles by clustering their vertices in a grid, each cell keeping the vertex closest to their average
+ *        The triangles left reference the vertices kept, so they draw from the same vertex buffers as the full mesh.
+ * @param indices The triangles
+ * @param positions The position of the first vertex, three floats
+ * @param position_stride Bytes between the positions of two vertices
+ * @param grid_size Number of cells along the largest side of the bounds
+ * @param error Set to the farthest distance between a vertex and the vertex replacing it
+ * @return The triangles whose vertices are in three different cells, empty if none are
+ */
+std::vector<uint32_t> simplify(const std::vector<uint32_t> &indices, const uint8_t *positions, size_t position_stride, size_t vertex_count, uint32_t grid_size, float &error);
+
+/**
+ * @return The average number of vertices transformed per triangle, with a FIFO cache of CacheSize vertices
+ */
+float compute_acmr(const std::vector<uint32_t> &indices, size_t vertex_count);
+}        // namespace mesh_optimizer
+}        // namespace vkb
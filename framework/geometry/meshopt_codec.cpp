@@ -0,0 +1,603 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "geometry/meshopt_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace vkb
+{
+namespace meshopt_codec
+{
+namespace
+{
+constexpr uint8_t VertexHeader   = 0xa0;
+constexpr uint8_t IndexHeader    = 0xe0;
+constexpr uint8_t SequenceHeader = 0xd0;
+
+/// Bytes of the vertices of a block, which are decoded together
+constexpr size_t VertexBlockSizeBytes = 8192;
+
+constexpr size_t VertexBlockMaxSize = 256;
+
+/// Bytes sharing the bit count stored in the header of a block
+constexpr size_t ByteGroupSize = 16;
+
+/// Most bytes a group takes, checked once instead of for every byte
+constexpr size_t ByteGroupDecodeLimit = 24;
+
+/// Size of the tail holding the first previous vertex, padded so the groups can be read without bounds checks
+constexpr size_t TailMaxSize = 32;
+
+size_t get_vertex_block_size(size_t vertex_size)
+{
+	size_t result = VertexBlockSizeBytes / vertex_size;
+	result &= ~(ByteGroupSize - 1);
+	return result < VertexBlockMaxSize ? result : VertexBlockMaxSize;
+}
+
+uint8_t unzigzag8(uint8_t value)
+{
+	return static_cast<uint8_t>(-(value & 1) ^ (value >> 1));
+}
+
+/**
+ * @brief Reads 16 values of 2 or 4 bits, the all ones values being followed by a byte of their own
+ */
+const uint8_t *decode_bytes_group_bits(const uint8_t *data, uint8_t *buffer, int bits)
+{
+	const uint8_t *data_var = data + ByteGroupSize * bits / 8;
+	const uint8_t  escape   = static_cast<uint8_t>((1 << bits) - 1);
+
+	for (size_t i = 0; i < ByteGroupSize; ++i)
+	{
+		uint8_t byte  = data[i * bits / 8];
+		uint8_t value = static_cast<uint8_t>(byte << ((i * bits) % 8)) >> (8 - bits);
+
+		if (value == escape)
+		{
+			value = *data_var++;
+		}
+		buffer[i] = value;
+	}
+
+	return data_var;
+}
+
+const uint8_t *decode_bytes_group(const uint8_t *data, uint8_t *buffer, int bitslog2)
+{
+	switch (bitslog2)
+	{
+		case 0:
+			std::memset(buffer, 0, ByteGroupSize);
+			return data;
+		case 1:
+			return decode_bytes_group_bits(data, buffer, 2);
+		case 2:
+			return decode_bytes_group_bits(data, buffer, 4);
+		default:
+			std::memcpy(buffer, data, ByteGroupSize);
+			return data + ByteGroupSize;
+	}
+}
+
+const uint8_t *decode_bytes(const uint8_t *data, const uint8_t *data_end, uint8_t *buffer, size_t buffer_size)
+{
+	const uint8_t *header = data;
+
+	// Two bits per group
+	size_t header_size = (buffer_size / ByteGroupSize + 3) / 4;
+	if (static_cast<size_t>(data_end - data) < header_size)
+	{
+		return nullptr;
+	}
+	data += header_size;
+
+	for (size_t i = 0; i < buffer_size; i += ByteGroupSize)
+	{
+		if (static_cast<size_t>(data_end - data) < ByteGroupDecodeLimit)
+		{
+			return nullptr;
+		}
+
+		size_t header_offset = i / ByteGroupSize;
+		int    bitslog2      = (header[header_offset / 4] >> ((header_offset % 4) * 2)) & 3;
+
+		data = decode_bytes_group(data, buffer + i, bitslog2);
+	}
+
+	return data;
+}
+
+/**
+ * @brief Decodes the vertices of a block, each of their bytes being stored as a delta to the previous vertex
+ */
+const uint8_t *decode_vertex_block(const uint8_t *data, const uint8_t *data_end, uint8_t *vertex_data, size_t vertex_count, size_t vertex_size, uint8_t *last_vertex)
+{
+	std::array<uint8_t, VertexBlockMaxSize> buffer;
+
+	size_t vertex_count_aligned = (vertex_count + ByteGroupSize - 1) & ~(ByteGroupSize - 1);
+
+	for (size_t k = 0; k < vertex_size; ++k)
+	{
+		data = decode_bytes(data, data_end, buffer.data(), vertex_count_aligned);
+		if (!data)
+		{
+			return nullptr;
+		}
+
+		uint8_t previous = last_vertex[k];
+		for (size_t i = 0; i < vertex_count; ++i)
+		{
+			uint8_t value                    = static_cast<uint8_t>(unzigzag8(buffer[i]) + previous);
+			vertex_data[i * vertex_size + k] = value;
+			previous                         = value;
+		}
+	}
+
+	std::memcpy(last_vertex, vertex_data + vertex_size * (vertex_count - 1), vertex_size);
+
+	return data;
+}
+
+bool decode_vertex_buffer(uint8_t *destination, size_t vertex_count, size_t vertex_size, const uint8_t *data, size_t size)
+{
+	if (vertex_size == 0 || vertex_size > VertexBlockMaxSize || vertex_size % 4 != 0)
+	{
+		return false;
+	}
+
+	const uint8_t *data_end = data + size;
+
+	if (size < 1 + vertex_size)
+	{
+		return false;
+	}
+
+	uint8_t header = *data++;
+	if ((header & 0xf0) != VertexHeader || (header & 0x0f) > 0)
+	{
+		return false;
+	}
+
+	std::array<uint8_t, VertexBlockMaxSize> last_vertex;
+	std::memcpy(last_vertex.data(), data_end - vertex_size, vertex_size);
+
+	size_t block_size = get_vertex_block_size(vertex_size);
+
+	for (size_t vertex_offset = 0; vertex_offset < vertex_count; vertex_offset += block_size)
+	{
+		size_t count = std::min(block_size, vertex_count - vertex_offset);
+
+		data = decode_vertex_block(data, data_end, destination + vertex_offset * vertex_size, count, vertex_size, last_vertex.data());
+		if (!data)
+		{
+			return false;
+		}
+	}
+
+	size_t tail_size = vertex_size < TailMaxSize ? TailMaxSize : vertex_size;
+	return static_cast<size_t>(data_end - data) == tail_size;
+}
+
+uint32_t decode_vbyte(const uint8_t *&data)
+{
+	uint8_t lead = *data++;
+	if (lead < 128)
+	{
+		return lead;
+	}
+
+	uint32_t result = lead & 127;
+	uint32_t shift  = 7;
+	for (int i = 0; i < 4; ++i)
+	{
+		uint8_t group = *data++;
+		result |= static_cast<uint32_t>(group & 127) << shift;
+		shift += 7;
+
+		if (group < 128)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
+uint32_t decode_index(const uint8_t *&data, uint32_t last)
+{
+	uint32_t value = decode_vbyte(data);
+	uint32_t delta = (value >> 1) ^ (0u - (value & 1));
+	return last + delta;
+}
+
+void write_index(uint8_t *destination, size_t offset, size_t index_size, uint32_t index)
+{
+	if (index_size == 2)
+	{
+		auto value = static_cast<uint16_t>(index);
+		std::memcpy(destination + offset * 2, &value, sizeof(value));
+	}
+	else
+	{
+		std::memcpy(destination + offset * 4, &index, sizeof(index));
+	}
+}
+
+/**
+ * @brief Decodes triangles coded against a fifo of the last edges and one of the last vertices
+ */
+bool decode_index_buffer(uint8_t *destination, size_t index_count, size_t index_size, const uint8_t *buffer, size_t size)
+{
+	if (index_count % 3 != 0 || (index_size != 2 && index_size != 4))
+	{
+		return false;
+	}
+
+	// The header, a code per triangle and the table of the auxiliary codes at the end
+	if (size < 1 + index_count / 3 + 16)
+	{
+		return false;
+	}
+
+	if ((buffer[0] & 0xf0) != IndexHeader)
+	{
+		return false;
+	}
+
+	int version = buffer[0] & 0x0f;
+	if (version > 1)
+	{
+		return false;
+	}
+
+	std::array<std::array<uint32_t, 2>, 16> edge_fifo;
+	std::array<uint32_t, 16>                vertex_fifo;
+	for (auto &edge : edge_fifo)
+	{
+		edge = {~0u, ~0u};
+	}
+	vertex_fifo.fill(~0u);
+
+	size_t edge_fifo_offset   = 0;
+	size_t vertex_fifo_offset = 0;
+
+	auto push_edge = [&](uint32_t a, uint32_t b) {
+		edge_fifo[edge_fifo_offset] = {a, b};
+		edge_fifo_offset            = (edge_fifo_offset + 1) & 15;
+	};
+
+	auto push_vertex = [&](uint32_t v, bool condition = true) {
+		vertex_fifo[vertex_fifo_offset] = v;
+		vertex_fifo_offset              = (vertex_fifo_offset + (condition ? 1 : 0)) & 15;
+	};
+
+	uint32_t next = 0;
+	uint32_t last = 0;
+
+	// Version 1 codes the vertices next to the last free index as 13 and 14
+	int fec_max = version >= 1 ? 13 : 15;
+
+	const uint8_t *code          = buffer + 1;
+	const uint8_t *data          = code + index_count / 3;
+	const uint8_t *data_safe_end = buffer + size - 16;
+	const uint8_t *codeaux_table = data_safe_end;
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		// A triangle reads at most 16 bytes, which the table at the end leaves room for
+		if (data > data_safe_end)
+		{
+			return false;
+		}
+
+		uint8_t codetri = *code++;
+
+		if (codetri < 0xf0)
+		{
+			// Triangle sharing an edge of the fifo
+			int  fe   = codetri >> 4;
+			auto edge = edge_fifo[(edge_fifo_offset - 1 - fe) & 15];
+			int  fec  = codetri & 15;
+
+			uint32_t c;
+			if (fec < fec_max)
+			{
+				c = fec == 0 ? next : vertex_fifo[(vertex_fifo_offset - 1 - fec) & 15];
+				next += fec == 0 ? 1 : 0;
+				push_vertex(c, fec == 0);
+			}
+			else
+			{
+				// 13 and 14 decode to -1 and 1, and free indices are deltas to the last one
+				last = c = fec != 15 ? last + (fec - (fec ^ 3)) : decode_index(data, last);
+				push_vertex(c);
+			}
+
+			write_index(destination, i, index_size, edge[0]);
+			write_index(destination, i + 1, index_size, edge[1]);
+			write_index(destination, i + 2, index_size, c);
+
+			push_edge(c, edge[1]);
+			push_edge(edge[0], c);
+		}
+		else
+		{
+			int      feb;
+			int      fec;
+			uint32_t a;
+			uint32_t b;
+			uint32_t c;
+
+			if (codetri < 0xfe)
+			{
+				// Triangle of new or recent vertices, coded in the table
+				uint8_t codeaux = codeaux_table[codetri & 15];
+				feb             = codeaux >> 4;
+				fec             = codeaux & 15;
+
+				a = next++;
+				b = feb == 0 ? next : vertex_fifo[(vertex_fifo_offset - feb) & 15];
+				next += feb == 0 ? 1 : 0;
+				c = fec == 0 ? next : vertex_fifo[(vertex_fifo_offset - fec) & 15];
+				next += fec == 0 ? 1 : 0;
+			}
+			else
+			{
+				// Same with the auxiliary code in the data, and free indices
+				uint8_t codeaux = *data++;
+				int     fea     = codetri == 0xfe ? 0 : 15;
+				feb             = codeaux >> 4;
+				fec             = codeaux & 15;
+
+				// A zero code not taken from the table restarts the numbering
+				if (codeaux == 0)
+				{
+					next = 0;
+				}
+
+				a = fea == 0 ? next++ : 0;
+				b = feb == 0 ? next++ : vertex_fifo[(vertex_fifo_offset - feb) & 15];
+				c = fec == 0 ? next++ : vertex_fifo[(vertex_fifo_offset - fec) & 15];
+
+				if (fea == 15)
+				{
+					last = a = decode_index(data, last);
+				}
+				if (feb == 15)
+				{
+					last = b = decode_index(data, last);
+				}
+				if (fec == 15)
+				{
+					last = c = decode_index(data, last);
+				}
+			}
+
+			write_index(destination, i, index_size, a);
+			write_index(destination, i + 1, index_size, b);
+			write_index(destination, i + 2, index_size, c);
+
+			push_vertex(a);
+			push_vertex(b, feb == 0 || feb == 15);
+			push_vertex(c, fec == 0 || fec == 15);
+
+			push_edge(b, a);
+			push_edge(c, b);
+			push_edge(a, c);
+		}
+	}
+
+	return data == data_safe_end;
+}
+
+/**
+ * @brief Decodes indices coded as deltas to either of the last two indices
+ */
+bool decode_index_sequence(uint8_t *destination, size_t index_count, size_t index_size, const uint8_t *buffer, size_t size)
+{
+	if (index_size != 2 && index_size != 4)
+	{
+		return false;
+	}
+
+	// The header, a byte per index at least and a tail of 4 bytes
+	if (size < 1 + index_count + 4)
+	{
+		return false;
+	}
+
+	if ((buffer[0] & 0xf0) != SequenceHeader || (buffer[0] & 0x0f) > 1)
+	{
+		return false;
+	}
+
+	const uint8_t *data          = buffer + 1;
+	const uint8_t *data_safe_end = buffer + size - 4;
+
+	std::array<uint32_t, 2> last{};
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		// An index reads at most 5 bytes, the tail leaves room for them
+		if (data >= data_safe_end)
+		{
+			return false;
+		}
+
+		uint32_t value    = decode_vbyte(data);
+		uint32_t baseline = value & 1;
+		value >>= 1;
+
+		uint32_t index = last[baseline] + ((value >> 1) ^ (0u - (value & 1)));
+		last[baseline] = index;
+
+		write_index(destination, i, index_size, index);
+	}
+
+	return data == data_safe_end;
+}
+
+int32_t round_to_int(float value)
+{
+	return static_cast<int32_t>(value + (value >= 0.0f ? 0.5f : -0.5f));
+}
+
+/**
+ * @brief Rebuilds unit vectors from their octahedral mapping, the third component holding the value of 1.0
+ */
+template <typename T>
+void decode_octahedral(uint8_t *data, size_t count)
+{
+	const float max = static_cast<float>((1 << (sizeof(T) * 8 - 1)) - 1);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::array<T, 4> value;
+		std::memcpy(value.data(), data + i * sizeof(value), sizeof(value));
+
+		float x = static_cast<float>(value[0]);
+		float y = static_cast<float>(value[1]);
+		float z = static_cast<float>(value[2]) - std::abs(x) - std::abs(y);
+
+		// Unfolds the lower half of the octahedron
+		float t = z >= 0.0f ? 0.0f : z;
+		x += x >= 0.0f ? t : -t;
+		y += y >= 0.0f ? t : -t;
+
+		float scale = max / std::sqrt(x * x + y * y + z * z);
+
+		value[0] = static_cast<T>(round_to_int(x * scale));
+		value[1] = static_cast<T>(round_to_int(y * scale));
+		value[2] = static_cast<T>(round_to_int(z * scale));
+
+		std::memcpy(data + i * sizeof(value), value.data(), sizeof(value));
+	}
+}
+
+/**
+ * @brief Rebuilds unit quaternions from three components, the fourth one holding the index of the largest component and the scale
+ */
+void decode_quaternion(uint8_t *data, size_t count)
+{
+	const float scale = 1.0f / std::sqrt(2.0f);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::array<int16_t, 4> value;
+		std::memcpy(value.data(), data + i * sizeof(value), sizeof(value));
+
+		int   sf = value[3] | 3;
+		float ss = scale / static_cast<float>(sf);
+
+		float x = static_cast<float>(value[0]) * ss;
+		float y = static_cast<float>(value[1]) * ss;
+		float z = static_cast<float>(value[2]) * ss;
+
+		float ww = 1.0f - x * x - y * y - z * z;
+		float w  = std::sqrt(ww >= 0.0f ? ww : 0.0f);
+
+		int qc = value[3] & 3;
+
+		std::array<int16_t, 4> result;
+		result[(qc + 1) & 3] = static_cast<int16_t>(round_to_int(x * 32767.0f));
+		result[(qc + 2) & 3] = static_cast<int16_t>(round_to_int(y * 32767.0f));
+		result[(qc + 3) & 3] = static_cast<int16_t>(round_to_int(z * 32767.0f));
+		result[qc]           = static_cast<int16_t>(round_to_int(w * 32767.0f));
+
+		std::memcpy(data + i * sizeof(result), result.data(), sizeof(result));
+	}
+}
+
+/**
+ * @brief Rebuilds floats from a 24-bit signed mantissa and an 8-bit signed exponent
+ */
+void decode_exponential(uint8_t *data, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t value;
+		std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+
+		int32_t mantissa = static_cast<int32_t>(value << 8) >> 8;
+		int32_t exponent = static_cast<int32_t>(value) >> 24;
+
+		float result = std::ldexp(static_cast<float>(mantissa), exponent);
+		std::memcpy(data + i * sizeof(result), &result, sizeof(result));
+	}
+}
+
+bool apply_filter(std::vector<uint8_t> &output, size_t count, size_t stride, Filter filter)
+{
+	switch (filter)
+	{
+		case Filter::None:
+			return true;
+		case Filter::Octahedral:
+			if (stride == 4)
+			{
+				decode_octahedral<int8_t>(output.data(), count);
+				return true;
+			}
+			if (stride == 8)
+			{
+				decode_octahedral<int16_t>(output.data(), count);
+				return true;
+			}
+			return false;
+		case Filter::Quaternion:
+			if (stride != 8)
+			{
+				return false;
+			}
+			decode_quaternion(output.data(), count);
+			return true;
+		case Filter::Exponential:
+			if (stride % 4 != 0)
+			{
+				return false;
+			}
+			decode_exponential(output.data(), count * stride / 4);
+			return true;
+	}
+
+	return false;
+}
+}        // namespace
+
+bool decode(std::vector<uint8_t> &output, const uint8_t *data, size_t size, size_t count, size_t stride, Mode mode, Filter filter)
+{
+	output.resize(count * stride);
+
+	switch (mode)
+	{
+		case Mode::Attributes:
+			return decode_vertex_buffer(output.data(), count, stride, data, size) && apply_filter(output, count, stride, filter);
+		case Mode::Triangles:
+			return filter == Filter::None && decode_index_buffer(output.data(), count, stride, data, size);
+		case Mode::Indices:
+			return filter == Filter::None && decode_index_sequence(output.data(), count, stride, data, size);
+	}
+
+	return false;
+}
+}        // namespace meshopt_codec
+}        // namespace vkb
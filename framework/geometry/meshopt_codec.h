@@ -0,0 +1,63 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vkb
+{
+/**
+ * @brief Decoders of the buffer views compressed with the glTF EXT_meshopt_compression extension
+ *
+ * The vertex and index codecs are the ones of meshoptimizer, in the versions the extension specifies.
+ * Attributes are delta coded bytes split in groups of 16 with 0, 2, 4 or 8 bits each, triangles are
+ * coded from the edges and vertices of small fifos, and index sequences as zigzag deltas.
+ */
+namespace meshopt_codec
+{
+/// How the data of a buffer view was encoded, the "mode" of the extension
+enum class Mode
+{
+	Attributes,
+	Triangles,
+	Indices
+};
+
+/// Transform applied to the decoded attributes, the "filter" of the extension
+enum class Filter
+{
+	None,
+	Octahedral,
+	Quaternion,
+	Exponential
+};
+
+/**
+ * @brief Decodes a compressed buffer view
+ * @param output Filled with count elements of stride bytes
+ * @param data The compressed bytes
+ * @param size Number of compressed bytes
+ * @param count Number of elements of the buffer view
+ * @param stride Size of an element, a multiple of 4 up to 256 for attributes, 2 or 4 for indices
+ * @return Whether the data was decoded, false if it is malformed or uses an unknown version
+ */
+bool decode(std::vector<uint8_t> &output, const uint8_t *data, size_t size, size_t count, size_t stride, Mode mode, Filter filter);
+}        // namespace meshopt_codec
+}        // namespace vkb
@@ -0,0 +1,224 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#	define VKB_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#	include <arm_neon.h>
+#	define VKB_SIMD_NEON
+#endif
+
+namespace vkb
+{
+/**
+ * @brief Minimal wrappers over the 4-wide float vectors of SSE2 or NEON, with a scalar fallback
+ *        Shared by the batched geometry kernels, see AABBBatch and BoundingSphereBatch, and the bounds of sg::AABB.
+ */
+namespace simd
+{
+/// Number of floats in Lanes
+constexpr size_t LANE_COUNT = 4;
+
+#if defined(VKB_SIMD_SSE2)
+using Lanes = __m128;
+
+inline Lanes load(const float *data)
+{
+	return _mm_loadu_ps(data);
+}
+
+inline void store(float *data, Lanes value)
+{
+	_mm_storeu_ps(data, value);
+}
+
+inline Lanes splat(float value)
+{
+	return _mm_set1_ps(value);
+}
+
+inline Lanes add(Lanes a, Lanes b)
+{
+	return _mm_add_ps(a, b);
+}
+
+inline Lanes mul(Lanes a, Lanes b)
+{
+	return _mm_mul_ps(a, b);
+}
+
+inline Lanes abs(Lanes a)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+}
+
+inline Lanes min(Lanes a, Lanes b)
+{
+	return _mm_min_ps(a, b);
+}
+
+inline Lanes max(Lanes a, Lanes b)
+{
+	return _mm_max_ps(a, b);
+}
+
+/// Returns a bit per lane, set if the lane is negative
+inline uint32_t negative_mask(Lanes a)
+{
+	return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps())));
+}
+#elif defined(VKB_SIMD_NEON)
+using Lanes = float32x4_t;
+
+inline Lanes load(const float *data)
+{
+	return vld1q_f32(data);
+}
+
+inline void store(float *data, Lanes value)
+{
+	vst1q_f32(data, value);
+}
+
+inline Lanes splat(float value)
+{
+	return vdupq_n_f32(value);
+}
+
+inline Lanes add(Lanes a, Lanes b)
+{
+	return vaddq_f32(a, b);
+}
+
+inline Lanes mul(Lanes a, Lanes b)
+{
+	return vmulq_f32(a, b);
+}
+
+inline Lanes abs(Lanes a)
+{
+	return vabsq_f32(a);
+}
+
+inline Lanes min(Lanes a, Lanes b)
+{
+	return vminq_f32(a, b);
+}
+
+inline Lanes max(Lanes a, Lanes b)
+{
+	return vmaxq_f32(a, b);
+}
+
+inline uint32_t negative_mask(Lanes a)
+{
+	uint32x4_t negative = vcltq_f32(a, vdupq_n_f32(0.0f));
+	return (vgetq_lane_u32(negative, 0) & 1u) |
+	       (vgetq_lane_u32(negative, 1) & 2u) |
+	       (vgetq_lane_u32(negative, 2) & 4u) |
+	       (vgetq_lane_u32(negative, 3) & 8u);
+}
+#else
+struct Lanes
+{
+	float values[LANE_COUNT];
+};
+
+inline Lanes load(const float *data)
+{
+	Lanes res;
+	std::copy(data, data + LANE_COUNT, res.values);
+	return res;
+}
+
+inline void store(float *data, Lanes value)
+{
+	std::copy(value.values, value.values + LANE_COUNT, data);
+}
+
+inline Lanes splat(float value)
+{
+	Lanes res;
+	std::fill(res.values, res.values + LANE_COUNT, value);
+	return res;
+}
+
+inline Lanes add(Lanes a, Lanes b)
+{
+	for (size_t i = 0; i < LANE_COUNT; ++i)
+	{
+		a.values[i] += b.values[i];
+	}
+	return a;
+}
+
+inline Lanes mul(Lanes a, Lanes b)
+{
+	for (size_t i = 0; i < LANE_COUNT; ++i)
+	{
+		a.values[i] *= b.values[i];
+	}
+	return a;
+}
+
+inline Lanes abs(Lanes a)
+{
+	for (size_t i = 0; i < LANE_COUNT; ++i)
+	{
+		a.values[i] = std::abs(a.values[i]);
+	}
+	return a;
+}
+
+inline Lanes min(Lanes a, Lanes b)
+{
+	for (size_t i = 0; i < LANE_COUNT; ++i)
+	{
+		a.values[i] = std::min(a.values[i], b.values[i]);
+	}
+	return a;
+}
+
+inline Lanes max(Lanes a, Lanes b)
+{
+	for (size_t i = 0; i < LANE_COUNT; ++i)
+	{
+		a.values[i] = std::max(a.values[i], b.values[i]);
+	}
+	return a;
+}
+
+inline uint32_t negative_mask(Lanes a)
+{
+	uint32_t mask = 0;
+	for (size_t i = 0; i < LANE_COUNT; ++i)
+	{
+		mask |= (a.values[i] < 0.0f ? 1u : 0u) << i;
+	}
+	return mask;
+}
+#endif
+}        // namespace simd
+}        // namespace vkb
@@ -24,6 +24,15 @@
 #include <glslang/OSDependent/osinclude.h>
 #include <glslang/Public/ResourceLimits.h>
 
+#include <algorithm>
+#include <cstring>
+
+#include "core/util/cache_file.hpp"
+#include "core/util/hash.hpp"
+#include "core/util/logging.hpp"
+#include "filesystem/filesystem.hpp"
+#include "shader_archive.h"
+
 namespace vkb
 {
 namespace
@@ -78,10 +87,57 @@ inline EShLanguage FindShaderLanguage(VkShaderStageFlagBits stage)
 			return EShLangVertex;
 	}
 }
+constexpr uint32_t SpirvCacheMagic   = 0x56505343;        // "CSPV"
+constexpr uint32_t SpirvCacheVersion = 2;
+
+/// Starts the payload of a cached module, followed by its key and its code
+struct SpirvCacheHeader
+{
+	uint64_t key_size;
+	uint64_t word_count;
+};
+
+/**
+ * @brief Serializes everything the generated code depends on
+ */
+std::vector<uint8_t> get_cache_key(VkShaderStageFlagBits stage, const std::vector<uint8_t> &glsl_source, const std::string &entry_point, const ShaderVariant &shader_variant,
+                                   glslang::EShTargetLanguage target_language, glslang::EShTargetLanguageVersion target_language_version)
+{
+	std::vector<uint8_t> key;
+
+	auto append = [&key](const void *bytes, size_t size) {
+		auto begin = reinterpret_cast<const uint8_t *>(bytes);
+		key.insert(key.end(), begin, begin + size);
+	};
+
+	auto append_string = [&append](const std::string &value) {
+		uint64_t size = value.size();
+		append(&size, sizeof(size));
+		append(value.data(), value.size());
+	};
+
+	uint32_t values[] = {static_cast<uint32_t>(stage), static_cast<uint32_t>(target_language), static_cast<uint32_t>(target_language_version)};
+	append(values, sizeof(values));
+
+	append_string(entry_point);
+	append_string(shader_variant.get_preamble());
+
+	for (auto &process : shader_variant.get_processes())
+	{
+		append_string(process);
+	}
+
+	uint64_t source_size = glsl_source.size();
+	append(&source_size, sizeof(source_size));
+	append(glsl_source.data(), glsl_source.size());
+
+	return key;
+}
 }        // namespace
 
 glslang::EShTargetLanguage        GLSLCompiler::env_target_language         = glslang::EShTargetLanguage::EShTargetNone;
 glslang::EShTargetLanguageVersion GLSLCompiler::env_target_language_version = static_cast<glslang::EShTargetLanguageVersion>(0);
+bool                              GLSLCompiler::spirv_cache_enabled         = true;
 
 void GLSLCompiler::set_target_environment(glslang::EShTargetLanguage target_language, glslang::EShTargetLanguageVersion target_language_version)
 {
@@ -95,6 +151,29 @@ void GLSLCompiler::reset_target_environment()
 	GLSLCompiler::env_target_language_version = static_cast<glslang::EShTargetLanguageVersion>(0);
 }
 
+glslang::EShTargetLanguage GLSLCompiler::get_target_language()
+{
+	return GLSLCompiler::env_target_language;
+}
+
+glslang::EShTargetLanguageVersion GLSLCompiler::get_target_language_version()
+{
+	return GLSLCompiler::env_target_language_version;
+}
+
+void GLSLCompiler::set_spirv_cache_enabled(bool enabled)
+{
+	GLSLCompiler::spirv_cache_enabled = enabled;
+}
+
+std::vector<uint8_t> GLSLCompiler::get_spirv_key(VkShaderStageFlagBits       stage,
+                                                 const std::vector<uint8_t> &glsl_source,
+                                                 const std::string          &entry_point,
+                                                 const ShaderVariant        &shader_variant)
+{
+	return get_cache_key(stage, glsl_source, entry_point, shader_variant, GLSLCompiler::env_target_language, GLSLCompiler::env_target_language_version);
+}
+
 bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits       stage,
                                     const std::vector<uint8_t> &glsl_source,
                                     const std::string          &entry_point,
@@ -102,6 +181,35 @@ bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits       stage,
                                     std::vector<std::uint32_t> &spirv,
                                     std::string                &info_log)
 {
+	// Sources with includes depend on files outside of the key, the ShaderModule expands them beforehand
+	static const std::string include_directive = "#include";
+
+	std::string          cache_path;
+	std::vector<uint8_t> cache_key;
+
+	if (std::search(glsl_source.begin(), glsl_source.end(), include_directive.begin(), include_directive.end()) == glsl_source.end())
+	{
+		cache_key = get_spirv_key(stage, glsl_source, entry_point, shader_variant);
+
+		// Variants built by the vkb__shader_archive target skip glslang altogether
+		if (auto archived_spirv = ShaderArchive::find_default(ShaderArchive::EntryType::Spirv, cache_key))
+		{
+			spirv.resize(archived_spirv->size() / sizeof(uint32_t));
+			std::memcpy(spirv.data(), archived_spirv->data(), spirv.size() * sizeof(uint32_t));
+			return true;
+		}
+
+		if (GLSLCompiler::spirv_cache_enabled)
+		{
+			cache_path = (vkb::filesystem::get()->temp_directory() / "spirv_cache" / fmt::format("{:016x}.spv", fnv1a_hash(cache_key.data(), cache_key.size()))).string();
+
+			if (load_cached_spirv(cache_path, cache_key, spirv))
+			{
+				return true;
+			}
+		}
+	}
+
 	// Initialize glslang library.
 	glslang::InitializeProcess();
 
@@ -173,6 +281,68 @@ bool GLSLCompiler::compile_to_spirv(VkShaderStageFlagBits       stage,
 	// Shutdown glslang library.
 	glslang::FinalizeProcess();
 
+	if (!cache_path.empty())
+	{
+		write_cached_spirv(cache_path, cache_key, spirv);
+	}
+
 	return true;
 }
+
+bool GLSLCompiler::load_cached_spirv(const std::string &cache_path, const std::vector<uint8_t> &cache_key, std::vector<std::uint32_t> &spirv)
+{
+	auto file_system = vkb::filesystem::get();
+
+	if (!file_system->is_file(cache_path))
+	{
+		return false;
+	}
+
+	auto file = file_system->map_file(cache_path);
+
+	CacheFileReader  reader{file->data(), file->size(), SpirvCacheMagic, SpirvCacheVersion};
+	SpirvCacheHeader header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		return false;
+	}
+
+	// The full key is compared, a hash collision can't return the code of another shader
+	if (!reader.read(header) || header.key_size != cache_key.size() ||
+	    reader.get_remaining_size() != header.key_size + header.word_count * sizeof(uint32_t) ||
+	    std::memcmp(reader.get_data(), cache_key.data(), cache_key.size()) != 0)
+	{
+		LOGW("Ignoring stale SPIR-V cache {}", cache_path);
+		return false;
+	}
+	reader.skip(header.key_size);
+
+	spirv.resize(header.word_count);
+	return reader.read(spirv.data(), header.word_count * sizeof(uint32_t));
+}
+
+void GLSLCompiler::write_cached_spirv(const std::string &cache_path, const std::vector<uint8_t> &cache_key, const std::vector<std::uint32_t> &spirv)
+{
+	SpirvCacheHeader header{};
+	header.key_size   = cache_key.size();
+	header.word_count = spirv.size();
+
+	CacheFileWriter writer{SpirvCacheMagic, SpirvCacheVersion};
+	writer.append(header);
+	writer.append(cache_key.data(), cache_key.size());
+	writer.append(spirv.data(), spirv.size() * sizeof(uint32_t));
+
+	try
+	{
+		auto file_system = vkb::filesystem::get();
+		file_system->create_directory(vkb::filesystem::Path{cache_path}.parent_path());
+		file_system->write_file(cache_path, writer.finish());
+	}
+	catch (const std::exception &e)
+	{
+		// The shader is compiled again next time
+		LOGW("Failed to write SPIR-V cache {}: {}", cache_path, e.what());
+	}
+}
 }        // namespace vkb
@@ -36,6 +36,14 @@ class GLSLCompiler
   private:
 	static glslang::EShTargetLanguage        env_target_language;
 	static glslang::EShTargetLanguageVersion env_target_language_version;
+	static bool                              spirv_cache_enabled;
+
+	/**
+	 * @brief Reads the code of a shader from the cache, if it was compiled with the same key before
+	 */
+	static bool load_cached_spirv(const std::string &cache_path, const std::vector<uint8_t> &cache_key, std::vector<std::uint32_t> &spirv);
+
+	static void write_cached_spirv(const std::string &cache_path, const std::vector<uint8_t> &cache_key, const std::vector<std::uint32_t> &spirv);
 
   public:
 	/**
@@ -51,6 +59,33 @@ class GLSLCompiler
 	 */
 	static void reset_target_environment();
 
+	/**
+	 * @brief Returns the language translated to, EShTargetNone if glslang picks it
+	 */
+	static glslang::EShTargetLanguage get_target_language();
+
+	/**
+	 * @brief Returns the version of the language translated to, 0 if glslang picks it
+	 */
+	static glslang::EShTargetLanguageVersion get_target_language_version();
+
+	/**
+	 * @brief Sets whether the generated SPIRV code is cached in the temporary directory, enabled by default
+	 *        The cache is keyed by the source, the shader variant, the stage, the entry point and the target environment,
+	 *        so later compiles of the same shader skip glslang. Sources with include directives are always compiled,
+	 *        the ShaderModule expands them beforehand.
+	 */
+	static void set_spirv_cache_enabled(bool enabled);
+
+	/**
+	 * @brief Serializes everything the SPIRV code of a shader depends on, with the current target environment
+	 *        It keys the code in the SPIRV cache and in the ShaderArchive, which compile_to_spirv looks up first.
+	 */
+	static std::vector<uint8_t> get_spirv_key(VkShaderStageFlagBits       stage,
+	                                          const std::vector<uint8_t> &glsl_source,
+	                                          const std::string          &entry_point,
+	                                          const ShaderVariant        &shader_variant);
+
 	/**
 	 * @brief Compiles GLSL to SPIRV code
 	 * @param stage The Vulkan shader stage flag
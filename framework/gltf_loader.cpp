@@ -19,8 +19,16 @@
 #define TINYGLTF_IMPLEMENTATION
 #include "gltf_loader.h"
 
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <future>
 #include <limits>
+#include <numeric>
 #include <queue>
+#include <thread>
+#include <tuple>
 
 #include "common/error.h"
 
@@ -34,16 +42,27 @@
 #include "common/vk_common.h"
 #include "core/device.h"
 #include "core/image.h"
+#include "core/util/cache_file.hpp"
+#include "core/util/hash.hpp"
+#include "core/util/job_system.hpp"
 #include "core/util/logging.hpp"
+#include "filesystem/filesystem.hpp"
 #include "filesystem/legacy.h"
+#include "geometry/mesh_optimizer.h"
+#include "geometry/meshopt_codec.h"
+#include "rendering/texture_residency_manager.h"
+#include "scene_graph/components/aabb.h"
 #include "scene_graph/components/camera.h"
 #include "scene_graph/components/image.h"
 #include "scene_graph/components/image/astc.h"
+#include "scene_graph/components/image/ktx_transcoder.h"
+#include "scene_graph/components/image/stb.h"
 #include "scene_graph/components/light.h"
 #include "scene_graph/components/mesh.h"
 #include "scene_graph/components/pbr_material.h"
 #include "scene_graph/components/perspective_camera.h"
 #include "scene_graph/components/sampler.h"
+#include "scene_graph/components/skin.h"
 #include "scene_graph/components/sub_mesh.h"
 #include "scene_graph/components/texture.h"
 #include "scene_graph/components/transform.h"
@@ -51,8 +70,6 @@
 #include "scene_graph/scene.h"
 #include "scene_graph/scripts/animation.h"
 
-#include <ctpl_stl.h>
-
 namespace vkb
 {
 namespace
@@ -133,6 +150,39 @@ inline std::vector<uint8_t> get_attribute_data(const tinygltf::Model *model, uin
 	return {buffer.data.begin() + startByte, buffer.data.begin() + endByte};
 };
 
+/**
+ * @brief Grows the bounds to contain the positions of an accessor
+ *        The exporters write the min and max of position accessors, as the specification requires.
+ *        Otherwise the float positions are reduced in place in the buffer, without a copy.
+ */
+inline void update_position_bounds(const tinygltf::Model *model, uint32_t accessorId, sg::AABB &bounds)
+{
+	assert(accessorId < model->accessors.size());
+	auto &accessor = model->accessors[accessorId];
+
+	// The min and max of normalized accessors are in the normalized range, not in the stored integers
+	if (accessor.minValues.size() == 3 && accessor.maxValues.size() == 3 && !accessor.normalized)
+	{
+		bounds.update(glm::vec3(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]));
+		bounds.update(glm::vec3(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2]));
+		return;
+	}
+
+	if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != TINYGLTF_TYPE_VEC3)
+	{
+		LOGW("Position accessor {} has no min and max, and no float positions to compute them", accessorId);
+		return;
+	}
+
+	assert(accessor.bufferView < model->bufferViews.size());
+	auto &bufferView = model->bufferViews[accessor.bufferView];
+	assert(bufferView.buffer < model->buffers.size());
+	auto &buffer = model->buffers[bufferView.buffer];
+
+	size_t startByte = accessor.byteOffset + bufferView.byteOffset;
+	bounds.update(buffer.data.data() + startByte, accessor.ByteStride(bufferView), accessor.count);
+};
+
 inline size_t get_attribute_size(const tinygltf::Model *model, uint32_t accessorId)
 {
 	assert(accessorId < model->accessors.size());
@@ -285,10 +335,183 @@ inline std::vector<uint8_t> convert_underlying_data_stride(const std::vector<uin
 	return result;
 }
 
-inline void upload_image_to_gpu(CommandBuffer &command_buffer, vkb::core::BufferC &staging_buffer, sg::Image &image)
+/**
+ * @brief Uploads the images of a scene while the others are still being decoded
+ *
+ * The images are copied into a ring of persistently mapped staging slots and submitted in
+ * batches, one per slot, on a dedicated transfer queue if the device has one. A slot is only
+ * waited for when the ring wraps around to it, so decoding, staging and transfers overlap.
+ * Images uploaded on a dedicated transfer queue are released to the graphics queue family,
+ * which acquires them in a submission waiting on the transfer one.
+ */
+class StreamingImageUploader
 {
-	// Clean up the image data, as they are copied in the staging buffer
-	image.clear_data();
+  public:
+	/// Staging slots in flight
+	static constexpr size_t SlotCount = 3;
+
+	/// Size of a staging slot, larger images get a staging buffer of their own
+	static constexpr VkDeviceSize SlotSize = 32 * 1024 * 1024;
+
+	/// Multiple of 4 and of every texel block size up to 32 bytes, 3 component formats included
+	static constexpr VkDeviceSize OffsetAlignment = 96;
+
+	explicit StreamingImageUploader(Device &device);
+
+	StreamingImageUploader(const StreamingImageUploader &) = delete;
+
+	StreamingImageUploader(StreamingImageUploader &&) = delete;
+
+	~StreamingImageUploader();
+
+	StreamingImageUploader &operator=(const StreamingImageUploader &) = delete;
+
+	StreamingImageUploader &operator=(StreamingImageUploader &&) = delete;
+
+	/**
+	 * @brief Records the upload of the resident levels of an image in the current batch, submitting the batch first if the image doesn't fit
+	 *        The image data is cleared once copied into the staging memory, unless it is kept to restore dropped levels later.
+	 */
+	void upload(sg::Image &image, bool keep_data = false);
+
+	/**
+	 * @brief Submits the current batch, if any
+	 */
+	void submit();
+
+	/**
+	 * @brief Submits the current batch and waits until every upload is complete
+	 */
+	void finish();
+
+  private:
+	struct Slot
+	{
+		std::unique_ptr<core::BufferC> staging_buffer;
+
+		/// Staging buffers of the images larger than a slot
+		std::vector<core::BufferC> oversized_buffers;
+
+		std::unique_ptr<CommandPool> transfer_command_pool;
+
+		/// Only created when the images change queue family
+		std::unique_ptr<CommandPool> graphics_command_pool;
+
+		CommandBuffer *command_buffer{nullptr};
+
+		std::vector<sg::Image *> released_images;
+
+		VkFence fence{VK_NULL_HANDLE};
+
+		VkSemaphore semaphore{VK_NULL_HANDLE};
+
+		VkDeviceSize offset{0};
+
+		bool recording{false};
+
+		bool in_flight{false};
+	};
+
+	void begin(Slot &slot);
+
+	void wait(Slot &slot);
+
+	Device &device;
+
+	const Queue &transfer_queue;
+
+	const Queue &graphics_queue;
+
+	bool ownership_transfer{false};
+
+	std::array<Slot, SlotCount> slots;
+
+	size_t current{0};
+};
+
+StreamingImageUploader::StreamingImageUploader(Device &device) :
+    device{device},
+    transfer_queue{device.get_transfer_queue()},
+    graphics_queue{device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0)}
+{
+	ownership_transfer = transfer_queue.get_family_index() != graphics_queue.get_family_index();
+
+	for (auto &slot : slots)
+	{
+		slot.transfer_command_pool = std::make_unique<CommandPool>(device, transfer_queue.get_family_index());
+
+		VkFenceCreateInfo fence_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+		VK_CHECK(vkCreateFence(device.get_handle(), &fence_info, nullptr, &slot.fence));
+
+		if (ownership_transfer)
+		{
+			slot.graphics_command_pool = std::make_unique<CommandPool>(device, graphics_queue.get_family_index());
+
+			VkSemaphoreCreateInfo semaphore_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+			VK_CHECK(vkCreateSemaphore(device.get_handle(), &semaphore_info, nullptr, &slot.semaphore));
+		}
+	}
+}
+
+StreamingImageUploader::~StreamingImageUploader()
+{
+	for (auto &slot : slots)
+	{
+		wait(slot);
+
+		vkDestroyFence(device.get_handle(), slot.fence, nullptr);
+
+		if (slot.semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(device.get_handle(), slot.semaphore, nullptr);
+		}
+	}
+}
+
+void StreamingImageUploader::upload(sg::Image &image, bool keep_data)
+{
+	// Only the levels from the resident base level are staged
+	auto &mipmaps    = image.get_mipmaps();
+	auto  base_level = image.get_resident_base_level();
+
+	auto          &data        = image.get_data();
+	VkDeviceSize   data_offset = base_level > 0 ? mipmaps[base_level].offset : 0;
+	const uint8_t *staged_data = data.data() + data_offset;
+	VkDeviceSize   size        = data.size() - data_offset;
+
+	Slot *slot = &slots[current];
+
+	VkDeviceSize offset = (slot->offset + OffsetAlignment - 1) / OffsetAlignment * OffsetAlignment;
+
+	if (slot->recording && size <= SlotSize && offset + size > SlotSize)
+	{
+		submit();
+		slot = &slots[current];
+	}
+
+	if (!slot->recording)
+	{
+		begin(*slot);
+		offset = 0;
+	}
+
+	const core::BufferC *staging_buffer = nullptr;
+	VkDeviceSize         buffer_offset  = 0;
+
+	if (size > SlotSize)
+	{
+		slot->oversized_buffers.push_back(vkb::core::BufferC::create_staging_buffer(device, size, staged_data));
+		staging_buffer = &slot->oversized_buffers.back();
+	}
+	else
+	{
+		slot->staging_buffer->update(staged_data, size, offset);
+		slot->offset   = offset + size;
+		staging_buffer = slot->staging_buffer.get();
+		buffer_offset  = offset;
+	}
+
+	auto &command_buffer = *slot->command_buffer;
 
 	{
 		ImageMemoryBarrier memory_barrier{};
@@ -302,36 +525,194 @@ inline void upload_image_to_gpu(CommandBuffer &command_buffer, vkb::core::Buffer
 		command_buffer.image_memory_barrier(image.get_vk_image_view(), memory_barrier);
 	}
 
-	// Create a buffer image copy for every mip level
-	auto &mipmaps = image.get_mipmaps();
+	// Create a buffer image copy for every resident mip level
+	std::vector<VkBufferImageCopy> buffer_copy_regions(mipmaps.size() - base_level);
 
-	std::vector<VkBufferImageCopy> buffer_copy_regions(mipmaps.size());
-
-	for (size_t i = 0; i < mipmaps.size(); ++i)
+	for (size_t i = base_level; i < mipmaps.size(); ++i)
 	{
 		auto &mipmap      = mipmaps[i];
-		auto &copy_region = buffer_copy_regions[i];
+		auto &copy_region = buffer_copy_regions[i - base_level];
 
-		copy_region.bufferOffset     = mipmap.offset;
+		copy_region.bufferOffset     = buffer_offset + mipmap.offset - data_offset;
 		copy_region.imageSubresource = image.get_vk_image_view().get_subresource_layers();
 		// Update miplevel
-		copy_region.imageSubresource.mipLevel = mipmap.level;
+		copy_region.imageSubresource.mipLevel = mipmap.level - base_level;
 		copy_region.imageExtent               = mipmap.extent;
 	}
 
-	command_buffer.copy_buffer_to_image(staging_buffer, image.get_vk_image(), buffer_copy_regions);
+	command_buffer.copy_buffer_to_image(*staging_buffer, image.get_vk_image(), buffer_copy_regions);
 
+	if (image.has_gpu_mipmaps() && !ownership_transfer)
+	{
+		// Only level 0 was copied, the mip chain is blitted from it
+		image.record_mipmap_generation(command_buffer);
+	}
+	else
 	{
 		ImageMemoryBarrier memory_barrier{};
 		memory_barrier.old_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 		memory_barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		memory_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		memory_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
 		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+		if (ownership_transfer)
+		{
+			// Release to the graphics queue family, which makes the image visible when acquiring it
+			// The mip chain needs blits, which the graphics queue records after acquiring the image
+			if (image.has_gpu_mipmaps())
+			{
+				memory_barrier.new_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			}
+			memory_barrier.dst_access_mask  = 0;
+			memory_barrier.dst_stage_mask   = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			memory_barrier.old_queue_family = transfer_queue.get_family_index();
+			memory_barrier.new_queue_family = graphics_queue.get_family_index();
+
+			slot->released_images.push_back(&image);
+		}
+		else
+		{
+			memory_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+			memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		}
 
 		command_buffer.image_memory_barrier(image.get_vk_image_view(), memory_barrier);
 	}
+
+	// Clean up the image data, as they are copied in the staging buffer
+	if (!keep_data)
+	{
+		image.clear_data();
+	}
+}
+
+void StreamingImageUploader::submit()
+{
+	auto &slot = slots[current];
+
+	if (!slot.recording)
+	{
+		return;
+	}
+
+	slot.command_buffer->end();
+
+	if (!ownership_transfer)
+	{
+		VK_CHECK(transfer_queue.submit(*slot.command_buffer, slot.fence));
+	}
+	else
+	{
+		auto &acquire_command_buffer = slot.graphics_command_pool->request_command_buffer();
+
+		acquire_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, 0);
+
+		for (auto image : slot.released_images)
+		{
+			ImageMemoryBarrier memory_barrier{};
+			memory_barrier.old_layout       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			memory_barrier.new_layout       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			memory_barrier.src_access_mask  = 0;
+			memory_barrier.dst_access_mask  = VK_ACCESS_SHADER_READ_BIT;
+			memory_barrier.src_stage_mask   = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			memory_barrier.dst_stage_mask   = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			memory_barrier.old_queue_family = transfer_queue.get_family_index();
+			memory_barrier.new_queue_family = graphics_queue.get_family_index();
+
+			if (image->has_gpu_mipmaps())
+			{
+				memory_barrier.new_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				memory_barrier.dst_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			}
+
+			acquire_command_buffer.image_memory_barrier(image->get_vk_image_view(), memory_barrier);
+
+			if (image->has_gpu_mipmaps())
+			{
+				image->record_mipmap_generation(acquire_command_buffer);
+			}
+		}
+
+		acquire_command_buffer.end();
+
+		VkCommandBuffer transfer_handle = slot.command_buffer->get_handle();
+
+		VkSubmitInfo transfer_submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+		transfer_submit_info.commandBufferCount   = 1;
+		transfer_submit_info.pCommandBuffers      = &transfer_handle;
+		transfer_submit_info.signalSemaphoreCount = 1;
+		transfer_submit_info.pSignalSemaphores    = &slot.semaphore;
+
+		VK_CHECK(transfer_queue.submit({transfer_submit_info}, VK_NULL_HANDLE));
+
+		VkCommandBuffer      acquire_handle = acquire_command_buffer.get_handle();
+		VkPipelineStageFlags wait_stage     = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		VkSubmitInfo acquire_submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+		acquire_submit_info.waitSemaphoreCount = 1;
+		acquire_submit_info.pWaitSemaphores    = &slot.semaphore;
+		acquire_submit_info.pWaitDstStageMask  = &wait_stage;
+		acquire_submit_info.commandBufferCount = 1;
+		acquire_submit_info.pCommandBuffers    = &acquire_handle;
+
+		// The fence of the acquire submission also covers the transfer one it waits for
+		VK_CHECK(graphics_queue.submit({acquire_submit_info}, slot.fence));
+	}
+
+	slot.recording = false;
+	slot.in_flight = true;
+
+	current = (current + 1) % SlotCount;
+}
+
+void StreamingImageUploader::finish()
+{
+	submit();
+
+	for (auto &slot : slots)
+	{
+		wait(slot);
+	}
+}
+
+void StreamingImageUploader::begin(Slot &slot)
+{
+	// Only waits when the ring wraps around to a batch still in flight
+	wait(slot);
+
+	slot.transfer_command_pool->reset_pool();
+	if (slot.graphics_command_pool)
+	{
+		slot.graphics_command_pool->reset_pool();
+	}
+
+	slot.oversized_buffers.clear();
+	slot.released_images.clear();
+	slot.offset = 0;
+
+	if (!slot.staging_buffer)
+	{
+		slot.staging_buffer = std::make_unique<core::BufferC>(vkb::core::BufferC::create_staging_buffer(device, SlotSize, nullptr));
+	}
+
+	slot.command_buffer = &slot.transfer_command_pool->request_command_buffer();
+	slot.command_buffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, 0);
+
+	slot.recording = true;
+}
+
+void StreamingImageUploader::wait(Slot &slot)
+{
+	if (!slot.in_flight)
+	{
+		return;
+	}
+
+	VK_CHECK(vkWaitForFences(device.get_handle(), 1, &slot.fence, VK_TRUE, std::numeric_limits<uint64_t>::max()));
+	VK_CHECK(vkResetFences(device.get_handle(), 1, &slot.fence));
+
+	slot.in_flight = false;
 }
 
 inline void prepare_meshlets(std::vector<Meshlet> &meshlets, std::unique_ptr<vkb::sg::SubMesh> &submesh, std::vector<unsigned char> &index_data)
@@ -398,104 +779,406 @@ static inline bool texture_needs_srgb_colorspace(const std::string &name)
 	return false;
 }
 
-}        // namespace
-
-std::unordered_map<std::string, bool> GLTFLoader::supported_extensions = {
-    {KHR_LIGHTS_PUNCTUAL_EXTENSION, false}};
-
-GLTFLoader::GLTFLoader(Device &device) :
-    device{device}
-{
-}
-
-std::unique_ptr<sg::Scene> GLTFLoader::read_scene_from_file(const std::string &file_name, int scene_index, VkBufferUsageFlags additional_buffer_usage_flags)
+/**
+ * @brief Reorders the triangles of a list for the vertex cache and the overdraw, then its vertices for the fetches
+ * @param indices The triangle list, rewritten with the new vertex indices
+ * @return The new index of every vertex
+ */
+std::vector<uint32_t> optimize_triangle_list(std::vector<uint32_t> &indices, const uint8_t *positions, size_t position_stride, size_t vertex_count)
 {
-	PROFILE_SCOPE("Load GLTF Scene");
-
-	std::string err;
-	std::string warn;
-
-	tinygltf::TinyGLTF gltf_loader;
+	float acmr = mesh_optimizer::compute_acmr(indices, vertex_count);
 
-	std::string gltf_file = vkb::fs::path::get(vkb::fs::path::Type::Assets) + file_name;
-
-	bool importResult = gltf_loader.LoadASCIIFromFile(&model, &err, &warn, gltf_file.c_str());
+	mesh_optimizer::optimize_vertex_cache(indices, vertex_count);
+	mesh_optimizer::optimize_overdraw(indices, positions, position_stride, vertex_count);
 
-	if (!importResult)
-	{
-		LOGE("Failed to load gltf file {}.", gltf_file.c_str());
+	LOGD("Optimized {} triangles, ACMR {:.2f} -> {:.2f}", indices.size() / 3, acmr, mesh_optimizer::compute_acmr(indices, vertex_count));
 
-		return nullptr;
-	}
+	return mesh_optimizer::optimize_vertex_fetch(indices, vertex_count);
+}
 
-	if (!err.empty())
+/**
+ * @brief Moves the vertices to their new index, in place so pointers to them stay valid
+ */
+template <typename T>
+void remap_vertices(std::vector<T> &vertices, const std::vector<uint32_t> &remap)
+{
+	std::vector<T> result(vertices.size());
+	for (size_t i = 0; i < remap.size(); ++i)
 	{
-		LOGE("Error loading gltf model: {}.", err.c_str());
-		return nullptr;
+		result[remap[i]] = vertices[i];
 	}
+	std::copy(result.begin(), result.end(), vertices.begin());
+}
 
-	if (!warn.empty())
+/**
+ * @return The indices of a primitive, widened to 32 bits
+ */
+std::vector<uint32_t> read_indices(const tinygltf::Model &model, uint32_t accessor)
+{
+	auto index_data = get_attribute_data(&model, accessor);
+	auto index_size = index_data.size() / get_attribute_size(&model, accessor);
+	if (index_size < 4)
 	{
-		LOGI("{}", warn.c_str());
+		index_data = convert_underlying_data_stride(index_data, to_u32(index_size), 4);
 	}
 
-	size_t pos = file_name.find_last_of('/');
-
-	model_path = file_name.substr(0, pos);
+	std::vector<uint32_t> indices(index_data.size() / 4);
+	std::memcpy(indices.data(), index_data.data(), index_data.size());
+	return indices;
+}
 
-	if (pos == std::string::npos)
+/**
+ * @return The positions of a primitive at the index of their vertex in the vertex buffers
+ */
+std::vector<uint8_t> read_positions(const tinygltf::Model &model, uint32_t accessor, const std::vector<uint32_t> &vertex_remap)
+{
+	auto positions = get_attribute_data(&model, accessor);
+	if (!vertex_remap.empty())
 	{
-		model_path.clear();
+		mesh_optimizer::remap_vertex_data(positions, get_attribute_stride(&model, accessor), vertex_remap);
 	}
-
-	return std::make_unique<sg::Scene>(load_scene(scene_index, additional_buffer_usage_flags));
+	return positions;
 }
 
-std::unique_ptr<sg::SubMesh> GLTFLoader::read_model_from_file(const std::string &file_name, uint32_t index, bool storage_buffer, VkBufferUsageFlags additional_buffer_usage_flags)
-{
-	PROFILE_SCOPE("Load GLTF Model");
+/// Cells along the largest side of the bounds for the first simplified level, each level halving them until it has enough fewer triangles
+constexpr uint32_t LodGridSize = 64;
 
-	std::string err;
-	std::string warn;
+/// Most indices a simplified level keeps from the previous level
+constexpr float LodReduction = 0.6f;
 
-	tinygltf::TinyGLTF gltf_loader;
+/**
+ * @brief Appends simplified levels of detail to a triangle list
+ * @param indices The full triangle list, followed by the triangles of the levels
+ * @return The levels, the full mesh first, empty if the mesh couldn't be simplified
+ */
+std::vector<LevelOfDetail> generate_lods(std::vector<uint32_t> &indices, const std::vector<uint8_t> &positions, size_t position_stride, uint32_t lod_count, bool optimize)
+{
+	size_t vertex_count = positions.size() / position_stride;
 
-	std::string gltf_file = vkb::fs::path::get(vkb::fs::path::Type::Assets) + file_name;
+	std::vector<LevelOfDetail> lods{{0, to_u32(indices.size()), 0.0f}};
 
-	bool importResult = gltf_loader.LoadASCIIFromFile(&model, &err, &warn, gltf_file.c_str());
+	// Every level is simplified from the full mesh, so its error is measured against it
+	const std::vector<uint32_t> full_indices{indices};
 
-	if (!importResult)
+	for (uint32_t grid_size = LodGridSize; grid_size >= 2 && lods.size() < lod_count; grid_size /= 2)
 	{
-		LOGE("Failed to load gltf file {}.", gltf_file.c_str());
+		float error = 0.0f;
+		auto  level = mesh_optimizer::simplify(full_indices, positions.data(), position_stride, vertex_count, grid_size, error);
+		if (level.empty())
+		{
+			break;
+		}
 
-		return nullptr;
-	}
+		if (level.size() > LodReduction * lods.back().index_count)
+		{
+			continue;
+		}
 
-	if (!err.empty())
-	{
-		LOGE("Error loading gltf model: {}.", err.c_str());
+		if (optimize)
+		{
+			mesh_optimizer::optimize_vertex_cache(level, vertex_count);
+		}
 
-		return nullptr;
+		lods.push_back({to_u32(indices.size()), to_u32(level.size()), error});
+		indices.insert(indices.end(), level.begin(), level.end());
 	}
 
-	if (!warn.empty())
+	if (lods.size() == 1)
 	{
-		LOGI("{}", warn.c_str());
+		return {};
 	}
 
-	size_t pos = file_name.find_last_of('/');
+	return lods;
+}
 
-	model_path = file_name.substr(0, pos);
+constexpr uint32_t ModelCacheMagic   = 0x4c444f4d;        // "MODL"
+constexpr uint32_t ModelCacheVersion = 4;
 
-	if (pos == std::string::npos)
+/// Starts the payload of a cached model, followed by the uris of its buffer files, its vertex data and its index data
+struct ModelCacheHeader
+{
+	uint64_t source_hash;
+	uint64_t buffers_stamp;
+	uint64_t buffer_uris_size;
+	uint32_t storage_buffer;
+	uint32_t vertices_count;
+	uint32_t vertex_indices;
+	uint32_t optimized;
+	uint64_t vertex_data_size;
+	uint64_t index_data_size;
+};
+
+/**
+ * @brief Hashes the sizes and write times of the buffer files, which the hash of the glTF file doesn't cover
+ * @param buffer_uris The uris of the files relative to the directory, each followed by a null character
+ */
+uint64_t get_buffers_stamp(const std::string &directory, const std::string &buffer_uris)
+{
+	auto file_system = vkb::filesystem::get();
+
+	uint64_t stamp = fnv1a_offset_basis;
+	for (size_t begin = 0, end; (end = buffer_uris.find('\0', begin)) != std::string::npos; begin = end + 1)
 	{
-		model_path.clear();
+		auto     stat     = file_system->stat_file(vkb::filesystem::Path{directory} / buffer_uris.substr(begin, end - begin));
+		uint64_t values[] = {stat.size, stat.last_write_time};
+		stamp             = fnv1a_hash(reinterpret_cast<const uint8_t *>(values), sizeof(values), stamp);
 	}
-
-	return std::move(load_model(index, storage_buffer, additional_buffer_usage_flags));
+	return stamp;
 }
 
-sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_buffer_usage_flags)
+constexpr uint32_t MeshletCacheMagic   = 0x4c48534d;        // "MSHL"
+constexpr uint32_t MeshletCacheVersion = 2;
+
+/// Starts the payload of cached meshlets, followed by the meshlets, their vertices and their triangles
+struct MeshletCacheHeader
+{
+	uint32_t max_vertices;
+	uint32_t max_triangles;
+	uint64_t meshlet_count;
+	uint64_t vertex_count;
+	uint64_t triangle_count;
+};
+
+bool load_cached_meshlets(const std::string &cache_path, mesh_optimizer::MeshletData &meshlets)
+{
+	auto file_system = vkb::filesystem::get();
+
+	if (!file_system->is_file(cache_path))
+	{
+		return false;
+	}
+
+	auto file = file_system->map_file(cache_path);
+
+	CacheFileReader    reader{file->data(), file->size(), MeshletCacheMagic, MeshletCacheVersion};
+	MeshletCacheHeader header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		LOGW("Ignoring truncated meshlet cache {}", cache_path);
+		return false;
+	}
+
+	if (!reader.read(header) ||
+	    header.max_vertices != mesh_optimizer::MaxMeshletVertices || header.max_triangles != mesh_optimizer::MaxMeshletTriangles || header.meshlet_count == 0 ||
+	    reader.get_remaining_size() != header.meshlet_count * sizeof(mesh_optimizer::Meshlet) + (header.vertex_count + header.triangle_count) * sizeof(uint32_t))
+	{
+		LOGW("Ignoring stale meshlet cache {}", cache_path);
+		return false;
+	}
+
+	meshlets.meshlets.resize(header.meshlet_count);
+	reader.read(meshlets.meshlets.data(), meshlets.meshlets.size() * sizeof(mesh_optimizer::Meshlet));
+	meshlets.vertices.resize(header.vertex_count);
+	reader.read(meshlets.vertices.data(), meshlets.vertices.size() * sizeof(uint32_t));
+	meshlets.triangles.resize(header.triangle_count);
+	reader.read(meshlets.triangles.data(), meshlets.triangles.size() * sizeof(uint32_t));
+
+	return true;
+}
+
+void write_cached_meshlets(const std::string &cache_path, const mesh_optimizer::MeshletData &meshlets)
+{
+	MeshletCacheHeader header{};
+	header.max_vertices   = mesh_optimizer::MaxMeshletVertices;
+	header.max_triangles  = mesh_optimizer::MaxMeshletTriangles;
+	header.meshlet_count  = meshlets.meshlets.size();
+	header.vertex_count   = meshlets.vertices.size();
+	header.triangle_count = meshlets.triangles.size();
+
+	CacheFileWriter writer{MeshletCacheMagic, MeshletCacheVersion};
+	writer.append(header);
+	writer.append(meshlets.meshlets.data(), meshlets.meshlets.size() * sizeof(mesh_optimizer::Meshlet));
+	writer.append(meshlets.vertices.data(), meshlets.vertices.size() * sizeof(uint32_t));
+	writer.append(meshlets.triangles.data(), meshlets.triangles.size() * sizeof(uint32_t));
+	auto file_data = writer.finish();
+
+	try
+	{
+		auto file_system = vkb::filesystem::get();
+		file_system->create_directory(vkb::filesystem::Path{cache_path}.parent_path());
+
+		// Primitives with the same geometry load in parallel, each writes a file of its own then renames it over the cache
+		auto temp_path = fmt::format("{}.{:x}.tmp", cache_path, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+		file_system->write_file(temp_path, file_data);
+		file_system->rename(temp_path, cache_path);
+	}
+	catch (const std::exception &e)
+	{
+		// The meshlets are built again next time
+		LOGW("Failed to write meshlet cache {}: {}", cache_path, e.what());
+	}
+}
+
+}        // namespace
+
+std::unordered_map<std::string, bool> GLTFLoader::supported_extensions = {
+    {KHR_LIGHTS_PUNCTUAL_EXTENSION, false},
+    {EXT_MESHOPT_COMPRESSION_EXTENSION, false},
+    {KHR_TEXTURE_BASISU_EXTENSION, false}};
+
+GLTFLoader::GLTFLoader(Device &device) :
+    device{device},
+    ktx_transcoder{std::make_unique<sg::KtxTranscoder>(device.get_gpu())}
+{
+}
+
+GLTFLoader::~GLTFLoader() = default;
+
+std::unique_ptr<sg::Scene> GLTFLoader::read_scene_from_file(const std::string &file_name, int scene_index, VkBufferUsageFlags additional_buffer_usage_flags)
+{
+	PROFILE_SCOPE("Load GLTF Scene");
+
+	std::string err;
+	std::string warn;
+
+	tinygltf::TinyGLTF gltf_loader;
+
+	std::string gltf_file = vkb::fs::path::get(vkb::fs::path::Type::Assets) + file_name;
+
+	bool importResult = gltf_loader.LoadASCIIFromFile(&model, &err, &warn, gltf_file.c_str());
+
+	if (!importResult)
+	{
+		LOGE("Failed to load gltf file {}.", gltf_file.c_str());
+
+		return nullptr;
+	}
+
+	if (!err.empty())
+	{
+		LOGE("Error loading gltf model: {}.", err.c_str());
+		return nullptr;
+	}
+
+	if (!warn.empty())
+	{
+		LOGI("{}", warn.c_str());
+	}
+
+	size_t pos = file_name.find_last_of('/');
+
+	model_path = file_name.substr(0, pos);
+
+	if (pos == std::string::npos)
+	{
+		model_path.clear();
+	}
+
+	return std::make_unique<sg::Scene>(load_scene(scene_index, additional_buffer_usage_flags));
+}
+
+std::unique_ptr<sg::SubMesh> GLTFLoader::read_model_from_file(const std::string &file_name, uint32_t index, bool storage_buffer, VkBufferUsageFlags additional_buffer_usage_flags)
+{
+	PROFILE_SCOPE("Load GLTF Model");
+
+	std::string err;
+	std::string warn;
+
+	tinygltf::TinyGLTF gltf_loader;
+
+	std::string gltf_file = vkb::fs::path::get(vkb::fs::path::Type::Assets) + file_name;
+
+	std::string cache_path;
+	uint64_t    source_hash = 0;
+
+	size_t pos = file_name.find_last_of('/');
+
+	// The buffer files of a cached model are found from it
+	model_path = file_name.substr(0, pos);
+
+	if (pos == std::string::npos)
+	{
+		model_path.clear();
+	}
+
+	auto file_system = vkb::filesystem::get();
+
+	if (model_cache_enabled && file_system->is_file(gltf_file))
+	{
+		// Keyed by the contents of the glTF file, the buffer files it references are checked when the cache is read
+		auto file   = file_system->map_file(gltf_file);
+		source_hash = fnv1a_hash(file->data(), file->size());
+		cache_path  = (file_system->temp_directory() / "gltf_cache" / fmt::format("{:016x}_{}{}{}.bin", source_hash, index, storage_buffer ? "_storage" : "", optimize_meshes ? "_optimized" : "")).string();
+
+		if (auto submesh = load_cached_model(cache_path, source_hash, storage_buffer))
+		{
+			return submesh;
+		}
+	}
+
+	bool importResult = gltf_loader.LoadASCIIFromFile(&model, &err, &warn, gltf_file.c_str());
+
+	if (!importResult)
+	{
+		LOGE("Failed to load gltf file {}.", gltf_file.c_str());
+
+		return nullptr;
+	}
+
+	if (!err.empty())
+	{
+		LOGE("Error loading gltf model: {}.", err.c_str());
+
+		return nullptr;
+	}
+
+	if (!warn.empty())
+	{
+		LOGI("{}", warn.c_str());
+	}
+
+	decode_compressed_buffer_views();
+
+	return std::move(load_model(index, storage_buffer, additional_buffer_usage_flags, cache_path, source_hash));
+}
+
+void GLTFLoader::set_generate_mipmaps_on_gpu(bool enabled)
+{
+	generate_mipmaps_on_gpu = enabled;
+}
+
+void GLTFLoader::set_texture_residency_manager(TextureResidencyManager *manager)
+{
+	texture_residency_manager = manager;
+}
+
+void GLTFLoader::set_model_cache_enabled(bool enabled)
+{
+	model_cache_enabled = enabled;
+}
+
+void GLTFLoader::set_optimize_meshes(bool enabled)
+{
+	optimize_meshes = enabled;
+}
+
+void GLTFLoader::set_default_camera_and_light(bool enabled)
+{
+	default_camera_and_light = enabled;
+}
+
+void GLTFLoader::set_quantize_vertices(bool enabled)
+{
+	quantize_vertices = enabled;
+}
+
+void GLTFLoader::set_pack_vertices(bool enabled)
+{
+	pack_vertices = enabled;
+}
+
+void GLTFLoader::set_build_meshlets(bool enabled)
+{
+	build_meshlets = enabled;
+}
+
+void GLTFLoader::set_lod_count(uint32_t count)
+{
+	lod_count = std::clamp(count, 1u, MaxLodCount);
+}
+
+sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_buffer_usage_flags)
 {
 	PROFILE_SCOPE("Process Scene");
 
@@ -530,6 +1213,8 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 		}
 	}
 
+	decode_compressed_buffer_views();
+
 	// Load lights
 	std::vector<std::unique_ptr<sg::Light>> light_components = parse_khr_lights_punctual();
 
@@ -551,82 +1236,120 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 	timer.start();
 
 	// Load images
-	auto thread_count = std::thread::hardware_concurrency();
-	thread_count      = thread_count == 0 ? 1 : thread_count;
-	ctpl::thread_pool thread_pool(thread_count);
+	auto &jobs = JobSystem::get();
+
+	// The fallbacks of the KHR_texture_basisu textures are skipped, unless another texture samples them
+	std::vector<bool> load_image(model.images.size(), true);
+	for (auto &gltf_texture : model.textures)
+	{
+		if (gltf_texture.source >= 0 && get_texture_source(gltf_texture) != gltf_texture.source)
+		{
+			load_image[gltf_texture.source] = false;
+		}
+	}
+	for (auto &gltf_texture : model.textures)
+	{
+		load_image[get_texture_source(gltf_texture)] = true;
+	}
+
+	// The glTF image of every loaded image, and the loaded image of every glTF image
+	std::vector<size_t>   image_sources;
+	std::vector<uint32_t> image_slots(model.images.size(), ~0u);
+	for (size_t source = 0; source < model.images.size(); source++)
+	{
+		if (load_image[source])
+		{
+			image_slots[source] = to_u32(image_sources.size());
+			image_sources.push_back(source);
+		}
+	}
+
+	auto image_count = to_u32(image_sources.size());
 
-	auto image_count = to_u32(model.images.size());
+	// The decodes refer to the loader, they are waited for if the upload fails
+	JobCounter image_jobs;
 
 	std::vector<std::future<std::unique_ptr<sg::Image>>> image_component_futures;
 	for (size_t image_index = 0; image_index < image_count; image_index++)
 	{
-		auto fut = thread_pool.push(
-		    [this, image_index](size_t) {
-			    auto image = parse_image(model.images[image_index]);
+		auto fut = jobs.async(
+		    [this, source = image_sources[image_index]]() {
+			    auto image = parse_image(model.images[source]);
 
-			    LOGI("Loaded gltf image #{} ({})", image_index, model.images[image_index].uri.c_str());
+			    LOGI("Loaded gltf image #{} ({})", source, model.images[source].uri.c_str());
 
 			    return image;
-		    });
+		    },
+		    &image_jobs);
 
 		image_component_futures.push_back(std::move(fut));
 	}
 
-	std::vector<std::unique_ptr<sg::Image>> image_components;
+	std::vector<std::unique_ptr<sg::Image>> image_components(image_count);
 
-	// Upload images to GPU. We do this in batches of 64MB of data to avoid needing
-	// double the amount of memory (all the images and all the corresponding buffers).
-	// This helps keep memory footprint lower which is helpful on smaller devices.
-	size_t image_index = 0;
-	while (image_index < image_count)
+	try
 	{
-		std::vector<vkb::core::BufferC> transient_buffers;
+		PROFILE_SCOPE("Upload Images");
 
-		auto &command_buffer = device.request_command_buffer();
+		StreamingImageUploader uploader{device};
 
-		command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, 0);
+		// Upload the images in the order they finish decoding, the staged batches are
+		// transferred while the remaining images decode
+		std::vector<size_t> pending_images(image_count);
+		std::iota(pending_images.begin(), pending_images.end(), 0);
 
-		size_t batch_size = 0;
-
-		// Deal with 64MB of image data at a time to keep memory footprint low
-		while (image_index < image_count && batch_size < 64 * 1024 * 1024)
+		while (!pending_images.empty())
 		{
-			// Wait for this image to complete loading, then stage for upload
-			image_components.push_back(image_component_futures[image_index].get());
-
-			auto &image = image_components[image_index];
+			auto ready_image = std::find_if(pending_images.begin(), pending_images.end(), [&image_component_futures](size_t index) {
+				return image_component_futures[index].wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+			});
 
-			core::Buffer stage_buffer = vkb::core::BufferC::create_staging_buffer(device, image->get_data());
-
-			batch_size += image->get_data().size();
-
-			upload_image_to_gpu(command_buffer, stage_buffer, *image);
+			if (ready_image == pending_images.end())
+			{
+				// Nothing decoded yet, transfer what has been staged in the meantime
+				uploader.submit();
+				image_component_futures[pending_images.front()].wait_for(std::chrono::milliseconds(1));
+				continue;
+			}
 
-			transient_buffers.push_back(std::move(stage_buffer));
+			size_t image_index            = *ready_image;
+			image_components[image_index] = image_component_futures[image_index].get();
 
-			image_index++;
-		}
+			auto &image = *image_components[image_index];
 
-		command_buffer.end();
+			// Streamed images keep their data, the dropped levels are restored from it
+			bool streamed = texture_residency_manager && texture_residency_manager->can_stream(image);
 
-		auto &queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+			if (!image.has_host_copy())
+			{
+				uploader.upload(image, streamed);
+			}
+			else if (!streamed)
+			{
+				image.clear_data();
+			}
 
-		queue.submit(command_buffer, device.request_fence());
+			if (streamed)
+			{
+				texture_residency_manager->register_image(image);
+			}
 
-		device.get_fence_pool().wait();
-		device.get_fence_pool().reset();
-		device.get_command_pool().reset_pool();
-		device.wait_idle();
+			pending_images.erase(ready_image);
+		}
 
-		// Remove the staging buffers for the batch we just processed
-		transient_buffers.clear();
+		uploader.finish();
+	}
+	catch (...)
+	{
+		jobs.wait(image_jobs);
+		throw;
 	}
 
 	scene.set_components(std::move(image_components));
 
 	auto elapsed_time = timer.stop();
 
-	LOGI("Time spent loading images: {} seconds across {} threads.", vkb::to_string(elapsed_time), thread_count);
+	LOGI("Time spent loading images: {} seconds across {} threads.", vkb::to_string(elapsed_time), jobs.get_worker_count());
 
 	// Load textures
 	auto images                  = scene.get_components<sg::Image>();
@@ -637,10 +1360,13 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 
 	for (auto &gltf_texture : model.textures)
 	{
+		PROFILE_SCOPE("Processing Texture");
+
 		auto texture = parse_texture(gltf_texture);
 
-		assert(gltf_texture.source < images.size());
-		texture->set_image(*images[gltf_texture.source]);
+		auto image_index = image_slots[get_texture_source(gltf_texture)];
+		assert(image_index < images.size());
+		texture->set_image(*images[image_index]);
 
 		if (gltf_texture.sampler >= 0 && gltf_texture.sampler < static_cast<int>(samplers.size()))
 		{
@@ -650,11 +1376,11 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 		{
 			if (gltf_texture.name.empty())
 			{
-				gltf_texture.name = images[gltf_texture.source]->get_name();
+				gltf_texture.name = images[image_index]->get_name();
 			}
 
 			// Get the properties for the image format. We'll need to check whether a linear sampler is valid.
-			const VkFormatProperties fmtProps = device.get_gpu().get_format_properties(images[gltf_texture.source]->get_format());
+			const VkFormatProperties fmtProps = device.get_gpu().get_format_properties(images[image_index]->get_format());
 
 			if (fmtProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
 			{
@@ -686,6 +1412,8 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 
 	for (auto &gltf_material : model.materials)
 	{
+		PROFILE_SCOPE("Processing Material");
+
 		auto material = parse_material(gltf_material);
 
 		for (auto &gltf_value : gltf_material.values)
@@ -702,7 +1430,7 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 					tex->get_image()->coerce_format_to_srgb();
 				}
 
-				material->textures[tex_name] = tex;
+				material->set_texture(tex_name, tex);
 			}
 		}
 
@@ -720,7 +1448,7 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 					tex->get_image()->coerce_format_to_srgb();
 				}
 
-				material->textures[tex_name] = tex;
+				material->set_texture(tex_name, tex);
 			}
 		}
 
@@ -732,88 +1460,62 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 	// Load meshes
 	auto materials = scene.get_components<sg::PBRMaterial>();
 
-	for (auto &gltf_mesh : model.meshes)
+	// The primitives load in parallel, then join their meshes and the scene in glTF order
+	std::vector<std::pair<size_t, size_t>> primitives;
+	for (size_t mesh_index = 0; mesh_index < model.meshes.size(); ++mesh_index)
 	{
-		PROFILE_SCOPE("Processing Mesh");
-
-		auto mesh = parse_mesh(gltf_mesh);
-
-		for (size_t i_primitive = 0; i_primitive < gltf_mesh.primitives.size(); i_primitive++)
+		for (size_t i_primitive = 0; i_primitive < model.meshes[mesh_index].primitives.size(); ++i_primitive)
 		{
-			const auto &gltf_primitive = gltf_mesh.primitives[i_primitive];
-
-			auto submesh_name = fmt::format("'{}' mesh, primitive #{}", gltf_mesh.name, i_primitive);
-			auto submesh      = std::make_unique<sg::SubMesh>(std::move(submesh_name));
-
-			for (auto &attribute : gltf_primitive.attributes)
-			{
-				std::string attrib_name = attribute.first;
-				std::transform(attrib_name.begin(), attrib_name.end(), attrib_name.begin(), ::tolower);
-
-				auto vertex_data = get_attribute_data(&model, attribute.second);
-
-				if (attrib_name == "position")
-				{
-					assert(attribute.second < model.accessors.size());
-					submesh->vertices_count = to_u32(model.accessors[attribute.second].count);
-				}
-
-				vkb::core::BufferC buffer{device,
-				                          vertex_data.size(),
-				                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | additional_buffer_usage_flags,
-				                          VMA_MEMORY_USAGE_CPU_TO_GPU};
-				buffer.update(vertex_data);
-				buffer.set_debug_name(fmt::format("'{}' mesh, primitive #{}: '{}' vertex buffer",
-				                                  gltf_mesh.name, i_primitive, attrib_name));
-
-				submesh->vertex_buffers.insert(std::make_pair(attrib_name, std::move(buffer)));
+			primitives.emplace_back(mesh_index, i_primitive);
+		}
+	}
 
-				sg::VertexAttribute attrib;
-				attrib.format = get_attribute_format(&model, attribute.second);
-				attrib.stride = to_u32(get_attribute_stride(&model, attribute.second));
+	std::vector<std::unique_ptr<sg::SubMesh>> submeshes(primitives.size());
+	std::vector<sg::AABB>                     primitive_bounds(primitives.size());
+	std::vector<std::exception_ptr>           primitive_errors(primitives.size());
 
-				submesh->set_attribute(attrib_name, attrib);
-			}
+	{
+		PROFILE_SCOPE("Load Primitives");
 
-			if (gltf_primitive.indices >= 0)
-			{
-				submesh->vertex_indices = to_u32(get_attribute_size(&model, gltf_primitive.indices));
+		JobCounter primitive_jobs;
+		for (size_t i = 0; i < primitives.size(); ++i)
+		{
+			jobs.schedule(
+			    [&, i]() {
+				    try
+				    {
+					    submeshes[i] = load_primitive(model.meshes[primitives[i].first], primitives[i].second, additional_buffer_usage_flags, primitive_bounds[i]);
+				    }
+				    catch (...)
+				    {
+					    primitive_errors[i] = std::current_exception();
+				    }
+			    },
+			    &primitive_jobs);
+		}
+		jobs.wait(primitive_jobs);
+	}
 
-				auto format = get_attribute_format(&model, gltf_primitive.indices);
+	for (auto &error : primitive_errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
 
-				auto index_data = get_attribute_data(&model, gltf_primitive.indices);
+	size_t next_submesh = 0;
+	for (auto &gltf_mesh : model.meshes)
+	{
+		PROFILE_SCOPE("Processing Mesh");
 
-				switch (format)
-				{
-					case VK_FORMAT_R8_UINT:
-						// Converts uint8 data into uint16 data, still represented by a uint8 vector
-						index_data          = convert_underlying_data_stride(index_data, 1, 2);
-						submesh->index_type = VK_INDEX_TYPE_UINT16;
-						break;
-					case VK_FORMAT_R16_UINT:
-						submesh->index_type = VK_INDEX_TYPE_UINT16;
-						break;
-					case VK_FORMAT_R32_UINT:
-						submesh->index_type = VK_INDEX_TYPE_UINT32;
-						break;
-					default:
-						LOGE("gltf primitive has invalid format type");
-						break;
-				}
+		auto mesh = parse_mesh(gltf_mesh);
 
-				submesh->index_buffer = std::make_unique<vkb::core::BufferC>(device,
-				                                                             index_data.size(),
-				                                                             VK_BUFFER_USAGE_INDEX_BUFFER_BIT | additional_buffer_usage_flags,
-				                                                             VMA_MEMORY_USAGE_GPU_TO_CPU);
-				submesh->index_buffer->set_debug_name(fmt::format("'{}' mesh, primitive #{}: index buffer",
-				                                                  gltf_mesh.name, i_primitive));
+		for (auto &gltf_primitive : gltf_mesh.primitives)
+		{
+			mesh->update_bounds(primitive_bounds[next_submesh]);
 
-				submesh->index_buffer->update(index_data);
-			}
-			else
-			{
-				submesh->vertices_count = to_u32(get_attribute_size(&model, gltf_primitive.attributes.at("POSITION")));
-			}
+			auto submesh = std::move(submeshes[next_submesh++]);
 
 			if (gltf_primitive.material < 0)
 			{
@@ -833,10 +1535,6 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 		scene.add_component(std::move(mesh));
 	}
 
-	device.get_fence_pool().wait();
-	device.get_fence_pool().reset();
-	device.get_command_pool().reset_pool();
-
 	scene.add_component(std::move(default_material));
 
 	// Load cameras
@@ -853,6 +1551,8 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 
 	for (size_t node_index = 0; node_index < model.nodes.size(); ++node_index)
 	{
+		PROFILE_SCOPE("Processing Node");
+
 		auto gltf_node = model.nodes[node_index];
 		auto node      = parse_node(gltf_node, node_index);
 
@@ -892,78 +1592,90 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 		nodes.push_back(std::move(node));
 	}
 
-	std::vector<std::unique_ptr<sg::Animation>> animations;
+	// Load skins, once their joints exist
+	std::vector<std::unique_ptr<sg::Skin>> skins;
 
-	// Load animations
-	for (size_t animation_index = 0; animation_index < model.animations.size(); ++animation_index)
+	for (auto &gltf_skin : model.skins)
 	{
-		auto &gltf_animation = model.animations[animation_index];
-
-		std::vector<sg::AnimationSampler> samplers;
+		auto skin = std::make_unique<sg::Skin>(gltf_skin.name);
 
-		for (size_t sampler_index = 0; sampler_index < gltf_animation.samplers.size(); ++sampler_index)
+		// The inverse bind matrices are optional, the joints are then bound with an identity
+		std::vector<uint8_t> inverse_bind_data;
+		if (gltf_skin.inverseBindMatrices >= 0)
 		{
-			auto gltf_sampler = gltf_animation.samplers[sampler_index];
+			inverse_bind_data = get_attribute_data(&model, gltf_skin.inverseBindMatrices);
+		}
 
-			sg::AnimationSampler sampler;
-			if (gltf_sampler.interpolation == "LINEAR")
-			{
-				sampler.type = sg::AnimationType::Linear;
-			}
-			else if (gltf_sampler.interpolation == "STEP")
-			{
-				sampler.type = sg::AnimationType::Step;
-			}
-			else if (gltf_sampler.interpolation == "CUBICSPLINE")
-			{
-				sampler.type = sg::AnimationType::CubicSpline;
-			}
-			else
+		for (size_t i = 0; i < gltf_skin.joints.size(); ++i)
+		{
+			glm::mat4 inverse_bind_matrix{1.0f};
+			if ((i + 1) * sizeof(glm::mat4) <= inverse_bind_data.size())
 			{
-				LOGW("Gltf animation sampler #{} has unknown interpolation value", sampler_index);
+				std::memcpy(&inverse_bind_matrix, inverse_bind_data.data() + i * sizeof(glm::mat4), sizeof(glm::mat4));
 			}
 
-			auto input_accessor      = model.accessors[gltf_sampler.input];
-			auto input_accessor_data = get_attribute_data(&model, gltf_sampler.input);
+			assert(gltf_skin.joints[i] < nodes.size());
+			skin->add_joint(*nodes[gltf_skin.joints[i]], inverse_bind_matrix);
+		}
 
-			const float *data = reinterpret_cast<const float *>(input_accessor_data.data());
-			for (size_t i = 0; i < input_accessor.count; ++i)
-			{
-				sampler.inputs.push_back(data[i]);
-			}
+		skins.push_back(std::move(skin));
+	}
 
-			auto output_accessor      = model.accessors[gltf_sampler.output];
-			auto output_accessor_data = get_attribute_data(&model, gltf_sampler.output);
+	for (size_t node_index = 0; node_index < model.nodes.size(); ++node_index)
+	{
+		auto skin_index = model.nodes[node_index].skin;
+		if (skin_index >= 0 && model.nodes[node_index].mesh >= 0)
+		{
+			assert(skin_index < skins.size());
+			nodes[node_index]->set_component(*skins[skin_index]);
+		}
+	}
 
-			switch (output_accessor.type)
-			{
-				case TINYGLTF_TYPE_VEC3:
-				{
-					const glm::vec3 *data = reinterpret_cast<const glm::vec3 *>(output_accessor_data.data());
-					for (size_t i = 0; i < output_accessor.count; ++i)
-					{
-						sampler.outputs.push_back(glm::vec4(data[i], 0.0f));
-					}
-					break;
-				}
-				case TINYGLTF_TYPE_VEC4:
-				{
-					const glm::vec4 *data = reinterpret_cast<const glm::vec4 *>(output_accessor_data.data());
-					for (size_t i = 0; i < output_accessor.count; ++i)
-					{
-						sampler.outputs.push_back(glm::vec4(data[i]));
-					}
-					break;
-				}
-				default:
-				{
-					LOGW("Gltf animation sampler #{} has unknown output data type", sampler_index);
-					continue;
-				}
-			}
+	scene.set_components(std::move(skins));
+
+	std::vector<std::unique_ptr<sg::Animation>> animations;
 
-			samplers.push_back(sampler);
+	// Load animations, their keyframes are read in parallel
+	std::vector<std::vector<sg::AnimationSampler>> animation_samplers(model.animations.size());
+	std::vector<std::exception_ptr>                animation_errors(model.animations.size());
+
+	{
+		PROFILE_SCOPE("Load Animation Samplers");
+
+		JobCounter animation_jobs;
+		for (size_t animation_index = 0; animation_index < model.animations.size(); ++animation_index)
+		{
+			jobs.schedule(
+			    [&, animation_index]() {
+				    try
+				    {
+					    animation_samplers[animation_index] = parse_animation_samplers(model.animations[animation_index]);
+				    }
+				    catch (...)
+				    {
+					    animation_errors[animation_index] = std::current_exception();
+				    }
+			    },
+			    &animation_jobs);
 		}
+		jobs.wait(animation_jobs);
+	}
+
+	for (auto &error : animation_errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	for (size_t animation_index = 0; animation_index < model.animations.size(); ++animation_index)
+	{
+		PROFILE_SCOPE("Processing Animation");
+
+		auto &gltf_animation = model.animations[animation_index];
+
+		auto &samplers = animation_samplers[animation_index];
 
 		auto animation = std::make_unique<sg::Animation>(gltf_animation.name);
 
@@ -1079,6 +1791,11 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 	// Store nodes into the scene
 	scene.set_nodes(std::move(nodes));
 
+	if (!default_camera_and_light)
+	{
+		return scene;
+	}
+
 	// Create node for the default camera
 	auto camera_node = std::make_unique<sg::Node>(-1, "default_camera");
 
@@ -1099,19 +1816,164 @@ sg::Scene GLTFLoader::load_scene(int scene_index, VkBufferUsageFlags additional_
 	return scene;
 }
 
-std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool storage_buffer, VkBufferUsageFlags additional_buffer_usage_flags)
+std::unique_ptr<sg::SubMesh> GLTFLoader::load_primitive(const tinygltf::Mesh &gltf_mesh, size_t i_primitive, VkBufferUsageFlags additional_buffer_usage_flags, sg::AABB &bounds) const
 {
-	PROFILE_SCOPE("Process Model");
+	PROFILE_SCOPE("Processing Primitive");
 
-	auto submesh = std::make_unique<sg::SubMesh>();
+	const auto &gltf_primitive = gltf_mesh.primitives[i_primitive];
 
-	std::vector<vkb::core::BufferC> transient_buffers;
+	auto submesh_name = fmt::format("'{}' mesh, primitive #{}", gltf_mesh.name, i_primitive);
+	auto submesh      = std::make_unique<sg::SubMesh>(std::move(submesh_name));
 
-	auto &queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+	// Optimized indices, and the new index of every vertex
+	std::vector<uint32_t> optimized_indices;
+	std::vector<uint32_t> vertex_remap;
 
-	auto &command_buffer = device.request_command_buffer();
+	auto position = gltf_primitive.attributes.find("POSITION");
 
-	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	bool float_triangles = gltf_primitive.indices >= 0 && gltf_primitive.mode == TINYGLTF_MODE_TRIANGLES &&
+	                       position != gltf_primitive.attributes.end() && get_attribute_format(&model, position->second) == VK_FORMAT_R32G32B32_SFLOAT;
+
+	if (optimize_meshes && float_triangles)
+	{
+		optimized_indices = read_indices(model, gltf_primitive.indices);
+
+		auto positions = get_attribute_data(&model, position->second);
+		vertex_remap   = optimize_triangle_list(optimized_indices, positions.data(), get_attribute_stride(&model, position->second),
+		                                        get_attribute_size(&model, position->second));
+	}
+
+	bool has_meshlets = build_meshlets && can_build_meshlets(gltf_primitive);
+
+	// The mesh shaders fetch the vertices themselves
+	VkBufferUsageFlags vertex_buffer_usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | additional_buffer_usage_flags;
+	if (has_meshlets)
+	{
+		vertex_buffer_usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	}
+
+	for (auto &attribute : gltf_primitive.attributes)
+	{
+		std::string attrib_name = attribute.first;
+		std::transform(attrib_name.begin(), attrib_name.end(), attrib_name.begin(), ::tolower);
+
+		auto vertex_data = get_attribute_data(&model, attribute.second);
+
+		if (attrib_name == "position")
+		{
+			assert(attribute.second < model.accessors.size());
+			submesh->vertices_count = to_u32(model.accessors[attribute.second].count);
+
+			update_position_bounds(&model, attribute.second, bounds);
+		}
+
+		sg::VertexAttribute attrib;
+		attrib.format = get_attribute_format(&model, attribute.second);
+		attrib.stride = to_u32(get_attribute_stride(&model, attribute.second));
+
+		if (!vertex_remap.empty())
+		{
+			mesh_optimizer::remap_vertex_data(vertex_data, attrib.stride, vertex_remap);
+		}
+
+		if (pack_vertices)
+		{
+			pack_vertex_attribute(attrib_name, vertex_data, attrib, *submesh);
+		}
+		else if (quantize_vertices && (attrib_name == "position" || attrib_name == "normal") && attrib.format == VK_FORMAT_R32G32B32_SFLOAT)
+		{
+			vertex_data   = mesh_optimizer::quantize_to_half(vertex_data, attrib.stride);
+			attrib.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+			attrib.stride = 4 * sizeof(uint16_t);
+		}
+
+		vkb::core::BufferC buffer{device,
+		                          vertex_data.size(),
+		                          vertex_buffer_usage,
+		                          VMA_MEMORY_USAGE_CPU_TO_GPU};
+		buffer.update(vertex_data);
+		buffer.set_debug_name(fmt::format("'{}' mesh, primitive #{}: '{}' vertex buffer",
+		                                  gltf_mesh.name, i_primitive, attrib_name));
+
+		submesh->vertex_buffers.insert(std::make_pair(attrib_name, std::move(buffer)));
+
+		submesh->set_attribute(attrib_name, attrib);
+	}
+
+	if (gltf_primitive.indices >= 0)
+	{
+		submesh->vertex_indices = to_u32(get_attribute_size(&model, gltf_primitive.indices));
+
+		auto format = get_attribute_format(&model, gltf_primitive.indices);
+
+		auto index_data = get_attribute_data(&model, gltf_primitive.indices);
+
+		switch (format)
+		{
+			case VK_FORMAT_R8_UINT:
+				// Converts uint8 data into uint16 data, still represented by a uint8 vector
+				index_data          = convert_underlying_data_stride(index_data, 1, 2);
+				submesh->index_type = VK_INDEX_TYPE_UINT16;
+				break;
+			case VK_FORMAT_R16_UINT:
+				submesh->index_type = VK_INDEX_TYPE_UINT16;
+				break;
+			case VK_FORMAT_R32_UINT:
+				submesh->index_type = VK_INDEX_TYPE_UINT32;
+				break;
+			default:
+				LOGE("gltf primitive has invalid format type");
+				break;
+		}
+
+		// The levels of detail follow the full mesh in the index buffer
+		std::vector<uint32_t> indices = optimized_indices;
+		if (lod_count > 1 && float_triangles)
+		{
+			if (indices.empty())
+			{
+				indices = read_indices(model, gltf_primitive.indices);
+			}
+
+			auto positions = read_positions(model, position->second, vertex_remap);
+			submesh->lods  = generate_lods(indices, positions, get_attribute_stride(&model, position->second), lod_count, optimize_meshes);
+		}
+
+		if (!optimized_indices.empty() || !submesh->lods.empty())
+		{
+			// The vertex count is unchanged, so the indices keep their size
+			index_data = convert_underlying_data_stride({reinterpret_cast<const uint8_t *>(indices.data()),
+			                                             reinterpret_cast<const uint8_t *>(indices.data() + indices.size())},
+			                                            4, submesh->index_type == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+		}
+
+		submesh->index_buffer = std::make_unique<vkb::core::BufferC>(device,
+		                                                             index_data.size(),
+		                                                             VK_BUFFER_USAGE_INDEX_BUFFER_BIT | additional_buffer_usage_flags,
+		                                                             VMA_MEMORY_USAGE_GPU_TO_CPU);
+		submesh->index_buffer->set_debug_name(fmt::format("'{}' mesh, primitive #{}: index buffer",
+		                                                  gltf_mesh.name, i_primitive));
+
+		submesh->index_buffer->update(index_data);
+	}
+	else
+	{
+		submesh->vertices_count = to_u32(get_attribute_size(&model, gltf_primitive.attributes.at("POSITION")));
+	}
+
+	if (has_meshlets)
+	{
+		load_meshlets(*submesh, gltf_primitive, optimized_indices, vertex_remap);
+	}
+
+	return submesh;
+}
+
+std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool storage_buffer, VkBufferUsageFlags additional_buffer_usage_flags, const std::string &cache_path, uint64_t source_hash)
+{
+	PROFILE_SCOPE("Process Model");
+
+	auto submesh = std::make_unique<sg::SubMesh>();
 
 	assert(index < model.meshes.size());
 	auto &gltf_mesh = model.meshes[index];
@@ -1178,6 +2040,13 @@ std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool storage
 
 	bool has_skin = (joints && weights);
 
+	// Data of the buffers, as uploaded and cached
+	ModelBlob vertices;
+	ModelBlob indices;
+
+	std::vector<uint8_t> index_data;
+	std::vector<Meshlet> meshlets;
+
 	if (storage_buffer)
 	{
 		for (size_t v = 0; v < vertex_count; v++)
@@ -1188,19 +2057,8 @@ std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool storage
 			aligned_vertex_data.push_back(vert);
 		}
 
-		vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(device, aligned_vertex_data);
-
-		vkb::core::BufferC buffer{device,
-		                          aligned_vertex_data.size() * sizeof(AlignedVertex),
-		                          VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-		                          VMA_MEMORY_USAGE_GPU_ONLY};
-
-		command_buffer.copy_buffer(stage_buffer, buffer, aligned_vertex_data.size() * sizeof(AlignedVertex));
-
-		auto pair = std::make_pair("vertex_buffer", std::move(buffer));
-		submesh->vertex_buffers.insert(std::move(pair));
-
-		transient_buffers.push_back(std::move(stage_buffer));
+		vertices.data = reinterpret_cast<const uint8_t *>(aligned_vertex_data.data());
+		vertices.size = aligned_vertex_data.size() * sizeof(AlignedVertex);
 	}
 	else
 	{
@@ -1231,27 +2089,16 @@ std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool storage
 			vertex_data.push_back(vert);
 		}
 
-		vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(device, vertex_data);
-
-		vkb::core::BufferC buffer{device,
-		                          vertex_data.size() * sizeof(Vertex),
-		                          VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-		                          VMA_MEMORY_USAGE_GPU_ONLY};
-
-		command_buffer.copy_buffer(stage_buffer, buffer, vertex_data.size() * sizeof(Vertex));
-
-		auto pair = std::make_pair("vertex_buffer", std::move(buffer));
-		submesh->vertex_buffers.insert(std::move(pair));
-
-		transient_buffers.push_back(std::move(stage_buffer));
+		vertices.data = reinterpret_cast<const uint8_t *>(vertex_data.data());
+		vertices.size = vertex_data.size() * sizeof(Vertex);
 	}
 
 	if (gltf_primitive.indices >= 0)
 	{
 		submesh->vertex_indices = to_u32(get_attribute_size(&model, gltf_primitive.indices));
 
-		auto format     = get_attribute_format(&model, gltf_primitive.indices);
-		auto index_data = get_attribute_data(&model, gltf_primitive.indices);
+		auto format = get_attribute_format(&model, gltf_primitive.indices);
+		index_data  = get_attribute_data(&model, gltf_primitive.indices);
 
 		switch (format)
 		{
@@ -1279,50 +2126,545 @@ std::unique_ptr<sg::SubMesh> GLTFLoader::load_model(uint32_t index, bool storage
 		// Always do uint32
 		submesh->index_type = VK_INDEX_TYPE_UINT32;
 
+		if (optimize_meshes && gltf_primitive.mode == TINYGLTF_MODE_TRIANGLES)
+		{
+			std::vector<uint32_t> optimized_indices(index_data.size() / 4);
+			std::memcpy(optimized_indices.data(), index_data.data(), index_data.size());
+
+			auto remap = optimize_triangle_list(optimized_indices, reinterpret_cast<const uint8_t *>(pos), 3 * sizeof(float), vertex_count);
+
+			std::memcpy(index_data.data(), optimized_indices.data(), index_data.size());
+
+			if (storage_buffer)
+			{
+				remap_vertices(aligned_vertex_data, remap);
+			}
+			else
+			{
+				remap_vertices(vertex_data, remap);
+			}
+		}
+
 		if (storage_buffer)
 		{
 			// prepare meshlets
-			std::vector<Meshlet> meshlets;
 			prepare_meshlets(meshlets, submesh, index_data);
 
 			// vertex_indices and index_buffer are used for meshlets now
 			submesh->vertex_indices = static_cast<uint32_t>(meshlets.size());
 
-			vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(device, meshlets);
+			indices.data = reinterpret_cast<const uint8_t *>(meshlets.data());
+			indices.size = meshlets.size() * sizeof(Meshlet);
+		}
+		else
+		{
+			indices.data = index_data.data();
+			indices.size = index_data.size();
+		}
+	}
+
+	if (!cache_path.empty())
+	{
+		write_cached_model(*submesh, vertices, indices, storage_buffer, cache_path, source_hash);
+	}
+
+	upload_model(*submesh, vertices, indices, storage_buffer);
+
+	return std::move(submesh);
+}
+
+void GLTFLoader::upload_model(sg::SubMesh &submesh, const ModelBlob &vertices, const ModelBlob &indices, bool storage_buffer)
+{
+	std::vector<vkb::core::BufferC> transient_buffers;
+
+	// Copied on a dedicated transfer queue if there is one, the buffers are then shared with the graphics queue family
+	auto &queue          = device.get_transfer_queue();
+	auto &graphics_queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+
+	std::vector<uint32_t> queue_families;
+	if (queue.get_family_index() != graphics_queue.get_family_index())
+	{
+		queue_families = {queue.get_family_index(), graphics_queue.get_family_index()};
+	}
+
+	CommandPool command_pool{device, queue.get_family_index()};
+
+	auto &command_buffer = command_pool.request_command_buffer();
+
+	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	{
+		vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(device, vertices.size, vertices.data);
+
+		vkb::core::BufferC buffer{device,
+		                          vertices.size,
+		                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | (storage_buffer ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+		                          VMA_MEMORY_USAGE_GPU_ONLY,
+		                          0,
+		                          queue_families};
+
+		// The submeshes read their buffers whenever they are drawn, so the defragmentation can move them
+		buffer.set_movable(true);
+
+		command_buffer.copy_buffer(stage_buffer, buffer, vertices.size);
+
+		auto pair = std::make_pair("vertex_buffer", std::move(buffer));
+		submesh.vertex_buffers.insert(std::move(pair));
+
+		transient_buffers.push_back(std::move(stage_buffer));
+	}
+
+	if (indices.size > 0)
+	{
+		vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(device, indices.size, indices.data);
+
+		submesh.index_buffer = std::make_unique<vkb::core::BufferC>(device,
+		                                                            indices.size,
+		                                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | (storage_buffer ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+		                                                            VMA_MEMORY_USAGE_GPU_ONLY,
+		                                                            0,
+		                                                            queue_families);
+		submesh.index_buffer->set_movable(true);
+
+		command_buffer.copy_buffer(stage_buffer, *submesh.index_buffer, indices.size);
+
+		transient_buffers.push_back(std::move(stage_buffer));
+	}
+
+	command_buffer.end();
+
+	VkFence fence = device.request_fence();
+	queue.submit(command_buffer, fence);
+
+	// Only this upload is waited for, the other fences of the pool stay in use
+	VK_CHECK(device.get_fence_pool().wait(fence));
+	VK_CHECK(device.get_fence_pool().recycle(fence));
+}
+
+std::unique_ptr<sg::SubMesh> GLTFLoader::load_cached_model(const std::string &cache_path, uint64_t source_hash, bool storage_buffer)
+{
+	auto file_system = vkb::filesystem::get();
+
+	if (!file_system->is_file(cache_path))
+	{
+		return nullptr;
+	}
+
+	auto file = file_system->map_file(cache_path);
+
+	CacheFileReader  reader{file->data(), file->size(), ModelCacheMagic, ModelCacheVersion};
+	ModelCacheHeader header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		LOGW("Ignoring truncated model cache {}", cache_path);
+		return nullptr;
+	}
+
+	if (!reader.read(header) || header.source_hash != source_hash ||
+	    header.storage_buffer != static_cast<uint32_t>(storage_buffer) || header.optimized != static_cast<uint32_t>(optimize_meshes) || header.vertex_data_size == 0 ||
+	    reader.get_remaining_size() != header.buffer_uris_size + header.vertex_data_size + header.index_data_size)
+	{
+		LOGW("Ignoring stale model cache {}", cache_path);
+		return nullptr;
+	}
+
+	// The buffers may be edited without the glTF file
+	std::string buffer_uris{reinterpret_cast<const char *>(reader.get_data()), static_cast<size_t>(header.buffer_uris_size)};
+	if (get_buffers_stamp(vkb::fs::path::get(vkb::fs::path::Type::Assets) + model_path, buffer_uris) != header.buffers_stamp)
+	{
+		LOGW("Ignoring stale model cache {}", cache_path);
+		return nullptr;
+	}
+	reader.skip(header.buffer_uris_size);
+
+	auto submesh = std::make_unique<sg::SubMesh>();
+
+	submesh->vertices_count = header.vertices_count;
+	submesh->vertex_indices = header.vertex_indices;
+	if (header.index_data_size > 0)
+	{
+		submesh->index_type = VK_INDEX_TYPE_UINT32;
+	}
+
+	// The mapped blobs are staged as they are
+	const uint8_t *payload = reader.get_data();
+	ModelBlob      vertices{payload, static_cast<size_t>(header.vertex_data_size)};
+	ModelBlob      indices{payload + vertices.size, static_cast<size_t>(header.index_data_size)};
+	upload_model(*submesh, vertices, indices, storage_buffer);
 
-			submesh->index_buffer = std::make_unique<vkb::core::BufferC>(device,
-			                                                             meshlets.size() * sizeof(Meshlet),
-			                                                             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-			                                                             VMA_MEMORY_USAGE_GPU_ONLY);
+	return submesh;
+}
+
+void GLTFLoader::write_cached_model(const sg::SubMesh &submesh, const ModelBlob &vertices, const ModelBlob &indices, bool storage_buffer, const std::string &cache_path, uint64_t source_hash) const
+{
+	// Embedded buffers are covered by the hash of the glTF file
+	std::string buffer_uris;
+	for (auto &buffer : model.buffers)
+	{
+		if (!buffer.uri.empty() && buffer.uri.rfind("data:", 0) != 0)
+		{
+			buffer_uris += buffer.uri;
+			buffer_uris += '\0';
+		}
+	}
 
-			command_buffer.copy_buffer(stage_buffer, *submesh->index_buffer, meshlets.size() * sizeof(Meshlet));
+	ModelCacheHeader header{};
+	header.source_hash      = source_hash;
+	header.buffers_stamp    = get_buffers_stamp(vkb::fs::path::get(vkb::fs::path::Type::Assets) + model_path, buffer_uris);
+	header.buffer_uris_size = buffer_uris.size();
+	header.storage_buffer   = static_cast<uint32_t>(storage_buffer);
+	header.vertices_count   = submesh.vertices_count;
+	header.vertex_indices   = submesh.vertex_indices;
+	header.optimized        = static_cast<uint32_t>(optimize_meshes);
+	header.vertex_data_size = vertices.size;
+	header.index_data_size  = indices.size;
+
+	CacheFileWriter writer{ModelCacheMagic, ModelCacheVersion};
+	writer.append(header);
+	writer.append(buffer_uris.data(), buffer_uris.size());
+	writer.append(vertices.data, vertices.size);
+	if (indices.size > 0)
+	{
+		writer.append(indices.data, indices.size);
+	}
+
+	try
+	{
+		auto file_system = vkb::filesystem::get();
+		file_system->create_directory(vkb::filesystem::Path{cache_path}.parent_path());
+		file_system->write_file(cache_path, writer.finish());
+	}
+	catch (const std::exception &e)
+	{
+		// The model is parsed again next time
+		LOGW("Failed to write model cache {}: {}", cache_path, e.what());
+	}
+}
+
+void GLTFLoader::decode_compressed_buffer_views()
+{
+	struct CompressedView
+	{
+		size_t                index;
+		const uint8_t        *data;
+		size_t                size;
+		size_t                count;
+		size_t                stride;
+		meshopt_codec::Mode   mode;
+		meshopt_codec::Filter filter;
+		std::vector<uint8_t>  decoded;
+		std::future<bool>     result;
+	};
+
+	std::vector<CompressedView> views;
+
+	for (size_t view_index = 0; view_index < model.bufferViews.size(); ++view_index)
+	{
+		auto extension = get_extension(model.bufferViews[view_index].extensions, EXT_MESHOPT_COMPRESSION_EXTENSION);
+		if (!extension)
+		{
+			continue;
+		}
+
+		auto buffer_index = extension->Get("buffer").GetNumberAsInt();
+		if (buffer_index < 0 || static_cast<size_t>(buffer_index) >= model.buffers.size())
+		{
+			throw std::runtime_error(fmt::format("Couldn't load glTF file, buffer view {} has an invalid EXT_meshopt_compression buffer", view_index));
+		}
+
+		CompressedView view{};
+		view.index  = view_index;
+		view.size   = static_cast<size_t>(extension->Get("byteLength").GetNumberAsInt());
+		view.count  = static_cast<size_t>(extension->Get("count").GetNumberAsInt());
+		view.stride = static_cast<size_t>(extension->Get("byteStride").GetNumberAsInt());
+
+		size_t offset = extension->Has("byteOffset") ? static_cast<size_t>(extension->Get("byteOffset").GetNumberAsInt()) : 0;
+
+		auto &buffer = model.buffers[buffer_index];
+		if (offset + view.size > buffer.data.size())
+		{
+			throw std::runtime_error(fmt::format("Couldn't load glTF file, the EXT_meshopt_compression data of buffer view {} is out of its buffer", view_index));
+		}
+		view.data = buffer.data.data() + offset;
+
+		auto &mode = extension->Get("mode").Get<std::string>();
+		if (mode == "ATTRIBUTES")
+		{
+			view.mode = meshopt_codec::Mode::Attributes;
+		}
+		else if (mode == "TRIANGLES")
+		{
+			view.mode = meshopt_codec::Mode::Triangles;
+		}
+		else if (mode == "INDICES")
+		{
+			view.mode = meshopt_codec::Mode::Indices;
+		}
+		else
+		{
+			throw std::runtime_error(fmt::format("Couldn't load glTF file, buffer view {} has an unknown EXT_meshopt_compression mode '{}'", view_index, mode));
+		}
 
-			transient_buffers.push_back(std::move(stage_buffer));
+		std::string filter = extension->Has("filter") ? extension->Get("filter").Get<std::string>() : "NONE";
+		if (filter == "NONE")
+		{
+			view.filter = meshopt_codec::Filter::None;
+		}
+		else if (filter == "OCTAHEDRAL")
+		{
+			view.filter = meshopt_codec::Filter::Octahedral;
+		}
+		else if (filter == "QUATERNION")
+		{
+			view.filter = meshopt_codec::Filter::Quaternion;
+		}
+		else if (filter == "EXPONENTIAL")
+		{
+			view.filter = meshopt_codec::Filter::Exponential;
 		}
 		else
 		{
-			vkb::core::BufferC stage_buffer = vkb::core::BufferC::create_staging_buffer(device, index_data);
+			throw std::runtime_error(fmt::format("Couldn't load glTF file, buffer view {} has an unknown EXT_meshopt_compression filter '{}'", view_index, filter));
+		}
+
+		views.push_back(std::move(view));
+	}
+
+	if (views.empty())
+	{
+		return;
+	}
 
-			submesh->index_buffer = std::make_unique<vkb::core::BufferC>(device,
-			                                                             index_data.size(),
-			                                                             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-			                                                             VMA_MEMORY_USAGE_GPU_ONLY);
+	PROFILE_SCOPE("Decode EXT_meshopt_compression");
 
-			command_buffer.copy_buffer(stage_buffer, *submesh->index_buffer, index_data.size());
+	auto      &jobs = JobSystem::get();
+	JobCounter decodes;
+	for (auto &view : views)
+	{
+		view.result = jobs.async(
+		    [&view]() {
+			    return meshopt_codec::decode(view.decoded, view.data, view.size, view.count, view.stride, view.mode, view.filter);
+		    },
+		    &decodes);
+	}
 
-			transient_buffers.push_back(std::move(stage_buffer));
+	// The buffers are only appended once every decode finished, as they hold the compressed data
+	jobs.wait(decodes);
+
+	for (auto &view : views)
+	{
+		if (!view.result.get())
+		{
+			throw std::runtime_error(fmt::format("Couldn't load glTF file, the EXT_meshopt_compression data of buffer view {} is invalid", view.index));
 		}
 	}
 
-	command_buffer.end();
+	for (auto &view : views)
+	{
+		auto &buffer_view = model.bufferViews[view.index];
 
-	queue.submit(command_buffer, device.request_fence());
+		tinygltf::Buffer buffer;
+		buffer.name = fmt::format("buffer view {} decoded", view.index);
+		buffer.data = std::move(view.decoded);
 
-	device.get_fence_pool().wait();
-	device.get_fence_pool().reset();
-	device.get_command_pool().reset_pool();
+		buffer_view.buffer     = static_cast<int>(model.buffers.size());
+		buffer_view.byteOffset = 0;
+		buffer_view.byteLength = buffer.data.size();
+		buffer_view.extensions.erase(EXT_MESHOPT_COMPRESSION_EXTENSION);
 
-	return std::move(submesh);
+		model.buffers.push_back(std::move(buffer));
+	}
+
+	LOGI("Decoded {} buffer views compressed with EXT_meshopt_compression", views.size());
+}
+
+void GLTFLoader::pack_vertex_attribute(const std::string &name, std::vector<uint8_t> &data, sg::VertexAttribute &attribute, sg::SubMesh &submesh) const
+{
+	auto can_fetch = [this](VkFormat format) {
+		return (device.get_gpu().get_format_properties(format).bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) != 0;
+	};
+
+	if (name == "position" && attribute.format == VK_FORMAT_R32G32B32_SFLOAT && can_fetch(VK_FORMAT_R16G16B16A16_UNORM))
+	{
+		data             = mesh_optimizer::pack_positions(data, attribute.stride, submesh.position_offset, submesh.position_scale);
+		attribute.format = VK_FORMAT_R16G16B16A16_UNORM;
+		attribute.stride = 4 * sizeof(uint16_t);
+	}
+	else if (name == "normal" && attribute.format == VK_FORMAT_R32G32B32_SFLOAT && can_fetch(VK_FORMAT_R16G16_SNORM))
+	{
+		data             = mesh_optimizer::pack_normals(data, attribute.stride);
+		attribute.format = VK_FORMAT_R16G16_SNORM;
+		attribute.stride = sizeof(uint32_t);
+	}
+	else if (name == "tangent" && attribute.format == VK_FORMAT_R32G32B32A32_SFLOAT && can_fetch(VK_FORMAT_A2B10G10R10_SNORM_PACK32))
+	{
+		data             = mesh_optimizer::pack_tangents(data, attribute.stride);
+		attribute.format = VK_FORMAT_A2B10G10R10_SNORM_PACK32;
+		attribute.stride = sizeof(uint32_t);
+	}
+	else if (name.rfind("texcoord_", 0) == 0 && attribute.format == VK_FORMAT_R32G32_SFLOAT && can_fetch(VK_FORMAT_R16G16_SFLOAT))
+	{
+		data             = mesh_optimizer::pack_to_half2(data, attribute.stride);
+		attribute.format = VK_FORMAT_R16G16_SFLOAT;
+		attribute.stride = 2 * sizeof(uint16_t);
+	}
+}
+
+bool GLTFLoader::can_build_meshlets(const tinygltf::Primitive &gltf_primitive) const
+{
+	if (gltf_primitive.indices < 0 || gltf_primitive.mode != TINYGLTF_MODE_TRIANGLES || quantize_vertices || pack_vertices)
+	{
+		LOGI("Skipping the meshlets of a primitive which isn't an indexed triangle list of float vertices");
+		return false;
+	}
+
+	// The mesh shaders read every attribute as tightly packed floats
+	const std::array<std::tuple<const char *, VkFormat, bool>, 3> attributes{{{"POSITION", VK_FORMAT_R32G32B32_SFLOAT, true},
+	                                                                          {"NORMAL", VK_FORMAT_R32G32B32_SFLOAT, false},
+	                                                                          {"TEXCOORD_0", VK_FORMAT_R32G32_SFLOAT, false}}};
+
+	for (auto &[name, format, required] : attributes)
+	{
+		auto it = gltf_primitive.attributes.find(name);
+		if (it == gltf_primitive.attributes.end())
+		{
+			if (required)
+			{
+				LOGI("Skipping the meshlets of a primitive without {}", name);
+				return false;
+			}
+			continue;
+		}
+
+		if (get_attribute_format(&model, it->second) != format || get_attribute_stride(&model, it->second) != vkb::get_bits_per_pixel(format) / 8)
+		{
+			LOGI("Skipping the meshlets of a primitive with an interleaved or quantized {}", name);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void GLTFLoader::load_meshlets(sg::SubMesh &submesh, const tinygltf::Primitive &gltf_primitive, const std::vector<uint32_t> &indices, const std::vector<uint32_t> &vertex_remap) const
+{
+	auto triangles = indices.empty() ? read_indices(model, gltf_primitive.indices) : indices;
+
+	auto position  = gltf_primitive.attributes.at("POSITION");
+	auto positions = read_positions(model, position, vertex_remap);
+	auto stride    = get_attribute_stride(&model, position);
+
+	mesh_optimizer::MeshletData meshlets;
+
+	// Keyed by the geometry itself, so every model shares the cache
+	std::string cache_path;
+	if (model_cache_enabled)
+	{
+		auto hash  = fnv1a_hash(reinterpret_cast<const uint8_t *>(triangles.data()), triangles.size() * sizeof(uint32_t));
+		hash       = fnv1a_hash(positions.data(), positions.size(), hash);
+		cache_path = (vkb::filesystem::get()->temp_directory() / "meshlet_cache" / fmt::format("{:016x}.bin", hash)).string();
+	}
+
+	if (cache_path.empty() || !load_cached_meshlets(cache_path, meshlets))
+	{
+		meshlets = mesh_optimizer::build_meshlets(triangles, positions.data(), stride, positions.size() / stride);
+
+		if (!cache_path.empty() && !meshlets.meshlets.empty())
+		{
+			write_cached_meshlets(cache_path, meshlets);
+		}
+	}
+
+	if (meshlets.meshlets.empty())
+	{
+		return;
+	}
+
+	LOGD("Built {} meshlets of {} triangles", meshlets.meshlets.size(), triangles.size() / 3);
+
+	auto create_buffer = [&](const auto &data, const char *name) {
+		auto buffer = std::make_unique<vkb::core::BufferC>(device,
+		                                                   data.size() * sizeof(data[0]),
+		                                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		                                                   VMA_MEMORY_USAGE_CPU_TO_GPU);
+		buffer->update(data);
+		buffer->set_debug_name(fmt::format("{}: {} buffer", submesh.get_name(), name));
+		return buffer;
+	};
+
+	submesh.meshlet_count           = to_u32(meshlets.meshlets.size());
+	submesh.meshlet_buffer          = create_buffer(meshlets.meshlets, "meshlet");
+	submesh.meshlet_vertex_buffer   = create_buffer(meshlets.vertices, "meshlet vertex");
+	submesh.meshlet_triangle_buffer = create_buffer(meshlets.triangles, "meshlet triangle");
+}
+
+std::vector<sg::AnimationSampler> GLTFLoader::parse_animation_samplers(const tinygltf::Animation &gltf_animation) const
+{
+	std::vector<sg::AnimationSampler> samplers;
+
+	for (size_t sampler_index = 0; sampler_index < gltf_animation.samplers.size(); ++sampler_index)
+	{
+		auto &gltf_sampler = gltf_animation.samplers[sampler_index];
+
+		sg::AnimationSampler sampler;
+		if (gltf_sampler.interpolation == "LINEAR")
+		{
+			sampler.type = sg::AnimationType::Linear;
+		}
+		else if (gltf_sampler.interpolation == "STEP")
+		{
+			sampler.type = sg::AnimationType::Step;
+		}
+		else if (gltf_sampler.interpolation == "CUBICSPLINE")
+		{
+			sampler.type = sg::AnimationType::CubicSpline;
+		}
+		else
+		{
+			LOGW("Gltf animation sampler #{} has unknown interpolation value", sampler_index);
+		}
+
+		auto &input_accessor      = model.accessors[gltf_sampler.input];
+		auto  input_accessor_data = get_attribute_data(&model, gltf_sampler.input);
+
+		const float *data = reinterpret_cast<const float *>(input_accessor_data.data());
+		sampler.inputs.assign(data, data + input_accessor.count);
+
+		auto &output_accessor      = model.accessors[gltf_sampler.output];
+		auto  output_accessor_data = get_attribute_data(&model, gltf_sampler.output);
+
+		switch (output_accessor.type)
+		{
+			case TINYGLTF_TYPE_VEC3:
+			{
+				const glm::vec3 *data = reinterpret_cast<const glm::vec3 *>(output_accessor_data.data());
+				for (size_t i = 0; i < output_accessor.count; ++i)
+				{
+					sampler.outputs.push_back(glm::vec4(data[i], 0.0f));
+				}
+				break;
+			}
+			case TINYGLTF_TYPE_VEC4:
+			{
+				const glm::vec4 *data = reinterpret_cast<const glm::vec4 *>(output_accessor_data.data());
+				for (size_t i = 0; i < output_accessor.count; ++i)
+				{
+					sampler.outputs.push_back(glm::vec4(data[i]));
+				}
+				break;
+			}
+			default:
+			{
+				LOGW("Gltf animation sampler #{} has unknown output data type", sampler_index);
+				continue;
+			}
+		}
+
+		samplers.push_back(std::move(sampler));
+	}
+
+	return samplers;
 }
 
 std::unique_ptr<sg::Node> GLTFLoader::parse_node(const tinygltf::Node &gltf_node, size_t index) const
@@ -1460,6 +2802,8 @@ std::unique_ptr<sg::PBRMaterial> GLTFLoader::parse_material(const tinygltf::Mate
 
 std::unique_ptr<sg::Image> GLTFLoader::parse_image(tinygltf::Image &gltf_image) const
 {
+	PROFILE_SCOPE("Decode Image");
+
 	std::unique_ptr<sg::Image> image{nullptr};
 
 	if (!gltf_image.image.empty())
@@ -1474,11 +2818,39 @@ std::unique_ptr<sg::Image> GLTFLoader::parse_image(tinygltf::Image &gltf_image)
 		std::vector<sg::Mipmap> mipmaps{mipmap};
 		image = std::make_unique<sg::Image>(gltf_image.name, std::move(gltf_image.image), std::move(mipmaps));
 	}
+	else if (gltf_image.bufferView >= 0)
+	{
+		// Image stored in a buffer of the glTF file, decoded from its mime type
+		assert(static_cast<size_t>(gltf_image.bufferView) < model.bufferViews.size());
+		auto &buffer_view = model.bufferViews[gltf_image.bufferView];
+		auto *data        = model.buffers[buffer_view.buffer].data.data() + buffer_view.byteOffset;
+
+		if (gltf_image.mimeType == "image/ktx2")
+		{
+			image = ktx_transcoder->load(gltf_image.name, data, buffer_view.byteLength, vkb::sg::Image::Unknown);
+		}
+		else if (gltf_image.mimeType == "image/png" || gltf_image.mimeType == "image/jpeg")
+		{
+			image = std::make_unique<sg::Stb>(gltf_image.name, data, buffer_view.byteLength, vkb::sg::Image::Unknown);
+		}
+		else
+		{
+			throw std::runtime_error(fmt::format("Couldn't load glTF image '{}' with the unsupported mime type '{}'", gltf_image.name, gltf_image.mimeType));
+		}
+	}
 	else
 	{
 		// Load image from uri
 		auto image_uri = model_path + "/" + gltf_image.uri;
-		image          = sg::Image::load(gltf_image.name, image_uri, vkb::sg::Image::Unknown);
+
+		if (get_extension(gltf_image.uri) == "ktx2" || gltf_image.mimeType == "image/ktx2")
+		{
+			image = ktx_transcoder->load(gltf_image.name, image_uri, vkb::sg::Image::Unknown);
+		}
+		else
+		{
+			image = sg::Image::load(gltf_image.name, image_uri, vkb::sg::Image::Unknown);
+		}
 	}
 
 	// Check whether the format is supported by the GPU
@@ -1487,13 +2859,39 @@ std::unique_ptr<sg::Image> GLTFLoader::parse_image(tinygltf::Image &gltf_image)
 		if (!device.is_image_format_supported(image->get_format()))
 		{
 			LOGW("ASTC not supported: decoding {}", image->get_name());
+			image->wait_for_levels(0);
 			image = std::make_unique<sg::Astc>(*image);
-			image->generate_mipmaps();
+
+			if (generate_mipmaps_on_gpu && sg::Image::supports_gpu_mipmaps(device, image->get_format()))
+			{
+				// Only level 0 is kept in host memory, the upload blits the mip chain from it
+				image->generate_mipmaps_on_gpu();
+			}
+			else
+			{
+				image->generate_mipmaps();
+			}
 		}
 	}
 
+	bool streamed = texture_residency_manager && texture_residency_manager->can_stream(*image);
+	if (streamed)
+	{
+		// Starts at a low resolution, the residency manager refines it as needed
+		image->set_resident_base_level(texture_residency_manager->get_initial_base_level(*image));
+	}
+
+	// The finer levels of streamed images may still be decoding, the residency manager only restores the loaded ones
+	image->wait_for_levels(streamed ? image->get_resident_base_level() : 0);
+
 	image->create_vk_image(device);
 
+	if (image->has_host_copy())
+	{
+		// Written from this worker thread, it doesn't go through the staging ring of the uploader
+		image->copy_data_from_host();
+	}
+
 	return image;
 }
 
@@ -1521,10 +2919,30 @@ std::unique_ptr<sg::Sampler> GLTFLoader::parse_sampler(const tinygltf::Sampler &
 	sampler_info.borderColor  = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 	sampler_info.maxLod       = std::numeric_limits<float>::max();
 
-	core::Sampler vk_sampler{device, sampler_info};
-	vk_sampler.set_debug_name(gltf_sampler.name);
+	// Shared by the samplers with the same state, across the scenes loaded on the device
+	auto &vk_sampler = device.get_resource_cache().RequestSampler(sampler_info);
+
+	return std::make_unique<sg::Sampler>(name, vk_sampler);
+}
+
+int GLTFLoader::get_texture_source(const tinygltf::Texture &gltf_texture) const
+{
+	auto extension = gltf_texture.extensions.find(KHR_TEXTURE_BASISU_EXTENSION);
+	if (extension != gltf_texture.extensions.end() && extension->second.Has("source"))
+	{
+		auto source = extension->second.Get("source").GetNumberAsInt();
+		if (source >= 0 && static_cast<size_t>(source) < model.images.size())
+		{
+			return source;
+		}
+	}
+
+	if (gltf_texture.source < 0 || static_cast<size_t>(gltf_texture.source) >= model.images.size())
+	{
+		throw std::runtime_error(fmt::format("Couldn't load glTF file, texture '{}' has no valid image", gltf_texture.name));
+	}
 
-	return std::make_unique<sg::Sampler>(name, std::move(vk_sampler));
+	return gltf_texture.source;
 }
 
 std::unique_ptr<sg::Texture> GLTFLoader::parse_texture(const tinygltf::Texture &gltf_texture) const
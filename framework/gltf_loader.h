@@ -31,15 +31,21 @@
 #include "vulkan/vulkan.h"
 
 #define KHR_LIGHTS_PUNCTUAL_EXTENSION "KHR_lights_punctual"
+#define EXT_MESHOPT_COMPRESSION_EXTENSION "EXT_meshopt_compression"
+#define KHR_TEXTURE_BASISU_EXTENSION "KHR_texture_basisu"
 
 namespace vkb
 {
 class Device;
+class TextureResidencyManager;
 
 namespace sg
 {
+class AABB;
+struct AnimationSampler;
 class Camera;
 class Image;
+class KtxTranscoder;
 class Light;
 class Mesh;
 class Node;
@@ -73,7 +79,7 @@ class GLTFLoader
   public:
 	GLTFLoader(Device &device);
 
-	virtual ~GLTFLoader() = default;
+	virtual ~GLTFLoader();
 
 	std::unique_ptr<sg::Scene> read_scene_from_file(const std::string &file_name, int scene_index = -1, VkBufferUsageFlags additional_buffer_usage_flags = 0);
 
@@ -83,6 +89,66 @@ class GLTFLoader
 	 */
 	std::unique_ptr<sg::SubMesh> read_model_from_file(const std::string &file_name, uint32_t index, bool storage_buffer = false, VkBufferUsageFlags additional_buffer_usage_flags = 0);
 
+	/**
+	 * @brief Sets whether the mip chains of the images decoded on the CPU are blitted on the GPU from level 0, which is the default
+	 *        When disabled, or when the format can't be blitted, the mip chain is downsampled on the CPU before the upload.
+	 */
+	void set_generate_mipmaps_on_gpu(bool enabled);
+
+	/**
+	 * @brief Streams the mip levels of the images with a mip chain through a residency manager
+	 *        The images are created at a low resolution and registered with the manager, which keeps their data.
+	 * @param manager The residency manager, must outlive the scene, or nullptr to load every level
+	 */
+	void set_texture_residency_manager(TextureResidencyManager *manager);
+
+	/**
+	 * @brief Sets whether read_model_from_file caches the buffers it builds in the temporary directory, disabled by default
+	 *        Later loads of the same model upload the cached buffers without parsing the glTF file.
+	 */
+	void set_model_cache_enabled(bool enabled);
+
+	/**
+	 * @brief Sets whether the triangle lists are reordered for the vertex cache, the overdraw and the vertex fetches, disabled by default
+	 *        The optimized buffers are the ones written to the model cache.
+	 */
+	void set_optimize_meshes(bool enabled);
+
+	/**
+	 * @brief Sets whether read_scene_from_file adds a default camera, and a directional light to scenes without lights, enabled by default
+	 *        Disabled for the scenes attached to another one, such as the cells of a SceneStreamer.
+	 */
+	void set_default_camera_and_light(bool enabled);
+
+	/**
+	 * @brief Sets whether read_scene_from_file stores the float positions and normals as half floats, disabled by default
+	 *        The attributes are set to VK_FORMAT_R16G16B16A16_SFLOAT, so pipelines must take their vertex input formats from the sub meshes.
+	 */
+	void set_quantize_vertices(bool enabled);
+
+	/**
+	 * @brief Sets whether read_scene_from_file packs the float vertex attributes, disabled by default, taking precedence over set_quantize_vertices
+	 *        Positions are normalized in the bounds of their sub mesh to 16-bit unorms, normals are octahedral 16-bit snorms,
+	 *        tangents are 10:10:10:2 snorms and texture coordinates are half floats. Formats the GPU can't fetch stay as floats.
+	 *        The sub meshes add the PACKED_POSITION and PACKED_NORMAL defines to their shader variants, and keep the position bounds for the shaders.
+	 */
+	void set_pack_vertices(bool enabled);
+
+	/**
+	 * @brief Sets whether read_scene_from_file splits the indexed triangle lists into meshlets for mesh shaders, disabled by default
+	 *        Only primitives with float positions, normals and texture coordinates, each in a buffer of their own, get meshlets.
+	 *        Their vertex buffers are also created as storage buffers, which the mesh shaders read.
+	 *        The meshlets are cached in the temporary directory if the model cache is enabled.
+	 */
+	void set_build_meshlets(bool enabled);
+
+	/**
+	 * @brief Sets how many levels of detail read_scene_from_file generates for the indexed triangle lists of float positions, 1 by default
+	 *        The simplified triangles are appended to the index buffer of the sub mesh and described by sg::SubMesh::lods.
+	 * @param count Number of levels, the full mesh included, at most MaxLodCount. Fewer are generated if the mesh can't be simplified.
+	 */
+	void set_lod_count(uint32_t count);
+
   protected:
 	virtual std::unique_ptr<sg::Node> parse_node(const tinygltf::Node &gltf_node, size_t index) const;
 
@@ -130,12 +196,97 @@ class GLTFLoader
 
 	std::string model_path;
 
+	bool generate_mipmaps_on_gpu{true};
+
+	/// Transcodes the Basis Universal KTX2 images, caching the results on disk
+	std::unique_ptr<sg::KtxTranscoder> ktx_transcoder;
+
+	TextureResidencyManager *texture_residency_manager{nullptr};
+
+	bool model_cache_enabled{false};
+
+	bool optimize_meshes{false};
+
+	bool default_camera_and_light{true};
+
+	bool quantize_vertices{false};
+
+	bool pack_vertices{false};
+
+	bool build_meshlets{false};
+
+	uint32_t lod_count{1};
+
 	/// The extensions that the GLTFLoader can load mapped to whether they should be enabled or not
 	static std::unordered_map<std::string, bool> supported_extensions;
 
   private:
+	/**
+	 * @brief Data of a buffer of a model, ready to be uploaded
+	 */
+	struct ModelBlob
+	{
+		const uint8_t *data{nullptr};
+
+		size_t size{0};
+	};
+
 	sg::Scene load_scene(int scene_index = -1, VkBufferUsageFlags additional_buffer_usage_flags = 0);
 
-	std::unique_ptr<sg::SubMesh> load_model(uint32_t index, bool storage_buffer = false, VkBufferUsageFlags additional_buffer_usage_flags = 0);
+	/**
+	 * @brief Builds the vertex and index buffers of a primitive, and its meshlets if enabled
+	 *        Safe to call from several threads, the material is set once the sub mesh joins the scene.
+	 * @param bounds Grown to contain the positions of the primitive, from the min and max of the accessor when present
+	 */
+	std::unique_ptr<sg::SubMesh> load_primitive(const tinygltf::Mesh &gltf_mesh, size_t i_primitive, VkBufferUsageFlags additional_buffer_usage_flags, sg::AABB &bounds) const;
+
+	/**
+	 * @brief Builds the buffers of a model, and writes them to a cache file if a path is given
+	 */
+	std::unique_ptr<sg::SubMesh> load_model(uint32_t index, bool storage_buffer = false, VkBufferUsageFlags additional_buffer_usage_flags = 0,
+	                                        const std::string &cache_path = "", uint64_t source_hash = 0);
+
+	void upload_model(sg::SubMesh &submesh, const ModelBlob &vertices, const ModelBlob &indices, bool storage_buffer);
+
+	/**
+	 * @return The model read from a cache file, or nullptr if the file is missing or stale
+	 */
+	std::unique_ptr<sg::SubMesh> load_cached_model(const std::string &cache_path, uint64_t source_hash, bool storage_buffer);
+
+	void write_cached_model(const sg::SubMesh &submesh, const ModelBlob &vertices, const ModelBlob &indices, bool storage_buffer, const std::string &cache_path, uint64_t source_hash) const;
+
+	/**
+	 * @brief Reads the keyframes of the samplers of an animation, skipping the samplers with unknown output types
+	 */
+	std::vector<sg::AnimationSampler> parse_animation_samplers(const tinygltf::Animation &gltf_animation) const;
+
+	/**
+	 * @return The image a texture samples, its KHR_texture_basisu image if it has one
+	 */
+	int get_texture_source(const tinygltf::Texture &gltf_texture) const;
+
+	/**
+	 * @brief Replaces the buffer views compressed with EXT_meshopt_compression by their decoded data, decoded in parallel
+	 *        The decoded data is appended to the buffers of the model, so the accessors read it as any other buffer view.
+	 */
+	void decode_compressed_buffer_views();
+
+	/**
+	 * @brief Converts a float vertex attribute to its packed format, see set_pack_vertices
+	 *        Attributes of other formats, or whose packed format the GPU can't fetch, are left unchanged.
+	 */
+	void pack_vertex_attribute(const std::string &name, std::vector<uint8_t> &data, sg::VertexAttribute &attribute, sg::SubMesh &submesh) const;
+
+	/**
+	 * @return Whether the mesh shaders can read the vertices of a primitive
+	 */
+	bool can_build_meshlets(const tinygltf::Primitive &gltf_primitive) const;
+
+	/**
+	 * @brief Builds the meshlets of a sub mesh, or reads them from the cache, and uploads them
+	 * @param indices The optimized triangles of the sub mesh, empty to read them from the primitive
+	 * @param vertex_remap The new index of every vertex, empty if the vertices weren't reordered
+	 */
+	void load_meshlets(sg::SubMesh &submesh, const tinygltf::Primitive &gltf_primitive, const std::vector<uint32_t> &indices, const std::vector<uint32_t> &vertex_remap) const;
 };
 }        // namespace vkb
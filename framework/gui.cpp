@@ -36,6 +36,7 @@
 #include "core/pipeline_layout.h"
 #include "core/shader_module.h"
 #include "core/util/logging.hpp"
+#include "core/util/profiling.hpp"
 #include "filesystem/legacy.h"
 #include "imgui_internal.h"
 #include "platform/window.h"
@@ -81,6 +82,8 @@ const float Gui::overlay_alpha = 0.3f;
 
 const std::string Gui::default_font = "Roboto-Regular";
 
+const float Gui::default_refresh_interval = 0.25f;
+
 const ImGuiWindowFlags Gui::common_flags = ImGuiWindowFlags_NoMove |
                                            ImGuiWindowFlags_NoScrollbar |
                                            ImGuiWindowFlags_NoTitleBar |
@@ -380,12 +383,53 @@ void Gui::update(const float delta_time)
 	ImGuiIO &io     = ImGui::GetIO();
 	auto     extent = sample.get_render_context().get_surface_extent();
 	resize(extent.width, extent.height);
-	io.DeltaTime = delta_time;
+
+	// A cached Gui is given the time since its last rebuild, so the ImGui timers keep their pace
+	io.DeltaTime       = cached ? std::max(time_since_rebuild, delta_time) : delta_time;
+	time_since_rebuild = 0.0f;
 
 	// Render to generate draw buffers
 	ImGui::Render();
 }
 
+void Gui::set_cached(bool enable, float refresh_interval)
+{
+	cached                 = enable;
+	this->refresh_interval = refresh_interval;
+	time_since_rebuild     = 0.0f;
+	pending_rebuilds       = REBUILD_FRAMES_AFTER_INPUT;
+}
+
+bool Gui::is_cached() const
+{
+	return cached;
+}
+
+bool Gui::needs_rebuild(const float delta_time)
+{
+	if (!cached)
+	{
+		return true;
+	}
+
+	time_since_rebuild += delta_time;
+
+	auto        extent  = sample.get_render_context().get_surface_extent();
+	const auto &io      = ImGui::GetIO();
+	bool        resized = (io.DisplaySize.x != static_cast<float>(extent.width)) || (io.DisplaySize.y != static_cast<float>(extent.height));
+
+	// Without draw data there is nothing to draw again, e.g. before the first rebuild
+	bool rebuild = (pending_rebuilds > 0) || resized || (visible != prev_visible) ||
+	               (time_since_rebuild >= refresh_interval) || (visible && !ImGui::GetDrawData());
+
+	if (pending_rebuilds > 0)
+	{
+		pending_rebuilds--;
+	}
+
+	return rebuild;
+}
+
 bool Gui::update_buffers()
 {
 	ImDrawData *draw_data = ImGui::GetDrawData();
@@ -404,25 +448,30 @@ bool Gui::update_buffers()
 		return false;
 	}
 
-	if ((vertex_buffer->get_handle() == VK_NULL_HANDLE) || (vertex_buffer_size != last_vertex_buffer_size))
+	// The draws recorded with the buffers change with the size of the draw data
+	if ((vertex_buffer_size != last_vertex_buffer_size) || (index_buffer_size != last_index_buffer_size))
 	{
 		last_vertex_buffer_size = vertex_buffer_size;
+		last_index_buffer_size  = index_buffer_size;
 		updated                 = true;
+	}
 
+	// The capacity grows geometrically, so the buffers are only reallocated when the draw data gets larger than it ever was
+	if ((vertex_buffer->get_handle() == VK_NULL_HANDLE) || (vertex_buffer_size > vertex_buffer->get_size()))
+	{
+		auto capacity = std::max<size_t>(vertex_buffer_size, 2 * vertex_buffer->get_size());
 		vertex_buffer.reset();
-		vertex_buffer = std::make_unique<vkb::core::BufferC>(sample.get_render_context().get_device(), vertex_buffer_size,
+		vertex_buffer = std::make_unique<vkb::core::BufferC>(sample.get_render_context().get_device(), capacity,
 		                                                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
 		                                                     VMA_MEMORY_USAGE_GPU_TO_CPU);
 		vertex_buffer->set_debug_name("GUI vertex buffer");
 	}
 
-	if ((index_buffer->get_handle() == VK_NULL_HANDLE) || (index_buffer_size != last_index_buffer_size))
+	if ((index_buffer->get_handle() == VK_NULL_HANDLE) || (index_buffer_size > index_buffer->get_size()))
 	{
-		last_index_buffer_size = index_buffer_size;
-		updated                = true;
-
+		auto capacity = std::max<size_t>(index_buffer_size, 2 * index_buffer->get_size());
 		index_buffer.reset();
-		index_buffer = std::make_unique<vkb::core::BufferC>(sample.get_render_context().get_device(), index_buffer_size,
+		index_buffer = std::make_unique<vkb::core::BufferC>(sample.get_render_context().get_device(), capacity,
 		                                                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
 		                                                    VMA_MEMORY_USAGE_GPU_TO_CPU);
 		index_buffer->set_debug_name("GUI index buffer");
@@ -457,14 +506,19 @@ BufferAllocationC Gui::update_buffers(CommandBuffer &command_buffer)
 		return BufferAllocationC{};
 	}
 
-	std::vector<uint8_t> vertex_data(vertex_buffer_size);
-	std::vector<uint8_t> index_data(index_buffer_size);
+	auto vertex_allocation = sample.get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertex_buffer_size);
+	auto index_allocation  = sample.get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, index_buffer_size);
 
-	upload_draw_data(draw_data, vertex_data.data(), index_data.data());
+	if (vertex_allocation.empty() || index_allocation.empty())
+	{
+		return BufferAllocationC{};
+	}
 
-	auto vertex_allocation = sample.get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertex_buffer_size);
+	// Write the draw data straight into the mapped allocations
+	upload_draw_data(draw_data, vertex_allocation.map<uint8_t>(0, vertex_buffer_size), index_allocation.map<uint8_t>(0, index_buffer_size));
 
-	vertex_allocation.update(vertex_data);
+	vertex_allocation.flush();
+	index_allocation.flush();
 
 	std::vector<std::reference_wrapper<const vkb::core::BufferC>> buffers;
 	buffers.emplace_back(std::ref(vertex_allocation.get_buffer()));
@@ -473,10 +527,6 @@ BufferAllocationC Gui::update_buffers(CommandBuffer &command_buffer)
 
 	command_buffer.bind_vertex_buffers(0, buffers, offsets);
 
-	auto index_allocation = sample.get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, index_buffer_size);
-
-	index_allocation.update(index_data);
-
 	command_buffer.bind_index_buffer(index_allocation.get_buffer(), index_allocation.get_offset(), VK_INDEX_TYPE_UINT16);
 
 	return vertex_allocation;
@@ -865,6 +915,13 @@ void Gui::show_top_window(const std::string &app_name, const Stats *stats, Debug
 	}
 
 	ImGui::End();
+
+	// The CPU scopes are only recorded while the debug view shows them
+	CpuProfiler::set_enabled(debug_view.active);
+	if (debug_view.active)
+	{
+		show_cpu_profiler_window(ImVec2{0.0f, ImGui::GetIO().DisplaySize.y});
+	}
 }
 
 void Gui::show_app_info(const std::string &app_name)
@@ -928,6 +985,124 @@ void Gui::show_debug_window(DebugInfo &debug_info, const ImVec2 &position)
 	ImGui::End();
 }
 
+void Gui::show_cpu_profiler_window(const ImVec2 &position)
+{
+	auto frames = CpuProfiler::get_frames();
+	if (frames.empty())
+	{
+		return;
+	}
+
+	ImGui::SetNextWindowBgAlpha(overlay_alpha);
+	ImGui::SetNextWindowSize(ImVec2{ImGui::GetIO().DisplaySize.x, 0.0f}, ImGuiCond_Always);
+	ImGui::SetNextWindowPos(position, ImGuiCond_Always, ImVec2{0.0f, 1.0f});
+
+	bool is_open = true;
+	ImGui::Begin("CPU Profiler", &is_open, common_flags);
+
+	auto to_ms = [](uint64_t ns) { return static_cast<float>(static_cast<double>(ns) / 1e6); };
+
+	uint64_t total_frame_time = 0;
+	for (auto &frame : frames)
+	{
+		total_frame_time += frame.end - frame.begin;
+	}
+	const float average_frame_ms = to_ms(total_frame_time / frames.size());
+
+	const auto &latest = frames.back();
+	ImGui::Text("CPU frame: %.2f ms (average of %zu frames: %.2f ms)", to_ms(latest.end - latest.begin), frames.size(), average_frame_ms);
+
+	// Flame graph of the latest frame, with a lane per thread and a row per depth in each lane
+	std::map<uint32_t, uint32_t> lane_rows;
+	for (auto &scope : latest.scopes)
+	{
+		auto &rows = lane_rows[scope.thread];
+		rows       = std::max(rows, scope.depth + 1);
+	}
+
+	std::map<uint32_t, uint32_t> lane_first_row;
+	uint32_t                     row_count = 0;
+	for (auto &lane : lane_rows)
+	{
+		lane_first_row[lane.first] = row_count;
+		row_count += lane.second;
+	}
+
+	const float  row_height = ImGui::GetTextLineHeight();
+	const float  width      = ImGui::GetContentRegionAvail().x;
+	const double duration   = static_cast<double>(std::max<uint64_t>(latest.end - latest.begin, 1));
+	const ImVec2 origin     = ImGui::GetCursorScreenPos();
+	auto        *draw_list  = ImGui::GetWindowDrawList();
+
+	for (auto &scope : latest.scopes)
+	{
+		// Scopes of other threads may have started during the previous frame
+		auto begin = std::max(scope.begin, latest.begin) - latest.begin;
+		auto end   = std::max(scope.end, latest.begin) - latest.begin;
+
+		ImVec2 min{origin.x + static_cast<float>(width * begin / duration), origin.y + row_height * (lane_first_row[scope.thread] + scope.depth)};
+		ImVec2 max{std::max(origin.x + static_cast<float>(width * end / duration), min.x + 1.0f), min.y + row_height - 1.0f};
+
+		// Names have a static storage, their address gives a color stable during the run
+		auto   hue   = static_cast<float>(std::hash<const void *>{}(scope.name) % 360) / 360.0f;
+		ImVec4 color = ImColor::HSV(hue, 0.5f, 0.7f);
+		draw_list->AddRectFilled(min, max, ImGui::GetColorU32(color));
+
+		draw_list->PushClipRect(min, max, true);
+		draw_list->AddText(ImVec2{min.x + 2.0f, min.y}, ImGui::GetColorU32(ImGuiCol_Text), scope.name);
+		draw_list->PopClipRect();
+	}
+	ImGui::Dummy(ImVec2{width, row_height * row_count});
+
+	// Average time of each scope over the history, in the order of the scopes of the latest frames
+	struct Average
+	{
+		const char *name;
+		uint32_t    thread;
+		uint32_t    depth;
+		uint64_t    total;
+	};
+
+	std::vector<Average> averages;
+	for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame)
+	{
+		for (auto &scope : frame->scopes)
+		{
+			auto it = std::find_if(averages.begin(), averages.end(), [&scope](const Average &average) {
+				return average.name == scope.name && average.thread == scope.thread && average.depth == scope.depth;
+			});
+			if (it == averages.end())
+			{
+				averages.push_back({scope.name, scope.thread, scope.depth, 0});
+				it = averages.end() - 1;
+			}
+			it->total += scope.end - scope.begin;
+		}
+	}
+
+	std::stable_sort(averages.begin(), averages.end(), [](const Average &a, const Average &b) { return a.thread < b.thread; });
+
+	const float label_width = ImGui::GetContentRegionAvail().x * 0.3f;
+	uint32_t    thread      = ~0u;
+	for (auto &average : averages)
+	{
+		if (average.thread != thread)
+		{
+			thread = average.thread;
+			ImGui::Text("Thread %u", thread);
+		}
+
+		const float average_ms = to_ms(average.total / frames.size());
+		ImGui::Text("%*s%s", static_cast<int>(2 * (average.depth + 1)), "", average.name);
+		ImGui::SameLine(label_width);
+		ImGui::ProgressBar(average_frame_ms > 0.0f ? average_ms / average_frame_ms : 0.0f,
+		                   ImVec2{-1.0f, 0.0f},
+		                   fmt::format("{:.2f} ms", average_ms).c_str());
+	}
+
+	ImGui::End();
+}
+
 void Gui::show_stats(const Stats &stats)
 {
 	for (const auto &stat_index : stats.get_requested_stats())
@@ -939,7 +1114,8 @@ void Gui::show_stats(const Stats &stats)
 
 		// Draw graph
 		auto       &graph_data     = pr->second;
-		const auto &graph_elements = stats.get_data(stat_index);
+		const auto &graph_history  = stats.get_data(stat_index);
+		const auto &graph_elements = graph_history.get_values();
 		float       graph_min      = 0.0f;
 		float      &graph_max      = graph_data.max_value;
 
@@ -964,7 +1140,9 @@ void Gui::show_stats(const Stats &stats)
 		{
 			graph_label << fmt::format(graph_data.name + ": " + graph_data.format, avg * graph_data.scale_factor);
 			ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
-			ImGui::PlotLines("", &graph_elements[0], static_cast<int>(graph_elements.size()), 0, graph_label.str().c_str(), graph_min, graph_max, graph_size);
+			// The ring is plotted in place from its oldest value
+			ImGui::PlotLines("", graph_elements.data(), static_cast<int>(graph_elements.size()), static_cast<int>(graph_history.get_head()),
+			                 graph_label.str().c_str(), graph_min, graph_max, graph_size);
 			ImGui::PopItemFlag();
 		}
 		else
@@ -1030,6 +1208,9 @@ bool Gui::input_event(const InputEvent &input_event)
 	auto &io                 = ImGui::GetIO();
 	auto  capture_move_event = false;
 
+	// ImGui only handles the event in the next frames
+	pending_rebuilds = REBUILD_FRAMES_AFTER_INPUT;
+
 	if (input_event.get_source() == EventSource::Keyboard)
 	{
 		const auto &key_event = static_cast<const KeyInputEvent &>(input_event);
@@ -140,6 +140,9 @@ class Gui
 	/// Used to show/hide the GUI
 	static bool visible;
 
+	/// Seconds between two rebuilds of a cached GUI receiving no input
+	static const float default_refresh_interval;
+
 	/**
 	 * @brief Initializes the Gui
 	 * @param sample A vulkan render context
@@ -178,6 +181,25 @@ class Gui
 
 	bool update_buffers();
 
+	/**
+	 * @brief Caches the Gui, so it is only rebuilt when it may have changed
+	 *        A cached Gui is rebuilt for a few frames after each input event, when it is resized or shown,
+	 *        and every refresh interval so the statistics graphs and the text of the sample keep moving.
+	 *        The frames in between draw the geometry of the last rebuild again.
+	 * @param enable Whether the Gui is cached
+	 * @param refresh_interval Seconds between two rebuilds without input
+	 */
+	void set_cached(bool enable, float refresh_interval = Gui::default_refresh_interval);
+
+	bool is_cached() const;
+
+	/**
+	 * @brief Tells whether the Gui must be rebuilt this frame, always true if it isn't cached
+	 *        If not, the caller skips new_frame(), the windows and update(), and draws the last Gui.
+	 * @param delta_time Time passed since last frame
+	 */
+	bool needs_rebuild(float delta_time);
+
 	/**
 	 * @brief Draws the Gui
 	 * @param command_buffer Command buffer to register draw-commands
@@ -225,6 +247,12 @@ class Gui
 	 */
 	void show_debug_window(DebugInfo &debug_info, const ImVec2 &position);
 
+	/**
+	 * @brief Shows the CPU scopes of the latest frame as a flame graph, and their average time over the last frames
+	 * @param position The absolute position of the bottom left corner of the window
+	 */
+	void show_cpu_profiler_window(const ImVec2 &position);
+
 	/**
 	 * @brief Shows a child with statistics
 	 * @param stats Statistics to show
@@ -284,6 +312,11 @@ class Gui
 
 	static const ImGuiWindowFlags info_flags;
 
+	/**
+	 * @brief Frames a cached Gui is rebuilt for after an input event, as ImGui reacts to some inputs a frame late
+	 */
+	static constexpr uint32_t REBUILD_FRAMES_AFTER_INPUT = 3;
+
 	VulkanSampleC &sample;
 
 	std::unique_ptr<vkb::core::BufferC> vertex_buffer;
@@ -336,6 +369,15 @@ class Gui
 	bool show_graph_file_output = false;
 
 	uint32_t subpass = 0;
+
+	bool cached = false;
+
+	float refresh_interval = 0.0f;
+
+	float time_since_rebuild = 0.0f;
+
+	/// Frames a cached Gui is still rebuilt for after an input event
+	uint32_t pending_rebuilds = 0;
 };
 
 void Gui::new_frame()
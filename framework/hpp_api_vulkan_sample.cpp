@@ -31,6 +31,13 @@ bool HPPApiVulkanSample::prepare(const vkb::ApplicationOptions &options)
 		return false;
 	}
 
+	// The API samples acquire and present the images of the swapchain themselves
+	if (!get_render_context().has_swapchain())
+	{
+		LOGE("{} renders to the swapchain, it can't run offscreen", get_name());
+		return false;
+	}
+
 	depth_format = vkb::common::get_suitable_depth_format(get_device().get_gpu().get_handle());
 
 	// Create synchronization objects
@@ -449,6 +456,12 @@ void HPPApiVulkanSample::update_overlay(float delta_time, const std::function<vo
 			accumulated_time = 0.0f;
 		}
 
+		// A cached GUI keeps the buffers and the command buffers recorded with its last rebuild
+		if (!get_gui().needs_rebuild(delta_time))
+		{
+			return;
+		}
+
 		get_gui().show_simple_window(get_name(), fps, [this, additional_ui]() { on_update_ui_overlay(get_gui().get_drawer()); });
 
 		get_gui().update(delta_time);
@@ -546,6 +559,12 @@ void HPPApiVulkanSample::submit_frame()
 	get_device().get_queue_by_present(0).get_handle().waitIdle();
 }
 
+HPPApiVulkanSample::HPPApiVulkanSample()
+{
+	// The projections and framebuffers of these samples follow the orientation of the window
+	set_pre_rotation_enable(false);
+}
+
 HPPApiVulkanSample::~HPPApiVulkanSample()
 {
 	if (has_device() && get_device().get_handle())
@@ -64,7 +64,7 @@ struct HPPVertex
 class HPPApiVulkanSample : public vkb::VulkanSampleCpp
 {
   public:
-	HPPApiVulkanSample() = default;
+	HPPApiVulkanSample();
 
 	virtual ~HPPApiVulkanSample();
 
@@ -35,6 +35,7 @@ class HPPDevice;
 class HPPFencePool : private vkb::FencePool
 {
   public:
+	using vkb::FencePool::recycle_signaled;
 	using vkb::FencePool::reset;
 	using vkb::FencePool::wait;
 
@@ -46,6 +47,16 @@ class HPPFencePool : private vkb::FencePool
 	{
 		return static_cast<vk::Fence>(vkb::FencePool::request_fence());
 	}
+
+	vk::Result wait(vk::Fence fence, uint64_t timeout = std::numeric_limits<uint64_t>::max()) const
+	{
+		return static_cast<vk::Result>(vkb::FencePool::wait(static_cast<VkFence>(fence), timeout));
+	}
+
+	vk::Result recycle(vk::Fence fence)
+	{
+		return static_cast<vk::Result>(vkb::FencePool::recycle(static_cast<VkFence>(fence)));
+	}
 };
 
 }        // namespace vkb
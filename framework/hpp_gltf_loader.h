@@ -44,9 +44,11 @@ class HPPGLTFLoader : private vkb::GLTFLoader
 		    vkb::GLTFLoader::read_model_from_file(file_name, index, storage_buffer, static_cast<VkBufferUsageFlags>(additional_buffer_usage_flags)).release()));
 	}
 
-	std::unique_ptr<vkb::scene_graph::HPPScene> read_scene_from_file(const std::string &file_name, int scene_index = -1)
+	std::unique_ptr<vkb::scene_graph::HPPScene>
+	    read_scene_from_file(const std::string &file_name, int scene_index = -1, vk::BufferUsageFlags additional_buffer_usage_flags = {})
 	{
-		return std::unique_ptr<vkb::scene_graph::HPPScene>(reinterpret_cast<vkb::scene_graph::HPPScene *>(vkb::GLTFLoader::read_scene_from_file(file_name, scene_index).release()));
+		return std::unique_ptr<vkb::scene_graph::HPPScene>(reinterpret_cast<vkb::scene_graph::HPPScene *>(
+		    vkb::GLTFLoader::read_scene_from_file(file_name, scene_index, static_cast<VkBufferUsageFlags>(additional_buffer_usage_flags)).release()));
 	}
 };
 }        // namespace vkb
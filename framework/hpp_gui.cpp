@@ -19,8 +19,10 @@
 #include "vulkan_sample.h"
 #include <common/hpp_utils.h>
 #include <core/hpp_command_pool.h>
+#include <core/util/profiling.hpp>
 #include <imgui_internal.h>
 
+#include <map>
 #include <numeric>
 
 namespace vkb
@@ -67,6 +69,8 @@ const ImGuiWindowFlags HPPGui::common_flags  = ImGuiWindowFlags_NoMove |
 const ImGuiWindowFlags HPPGui::options_flags = HPPGui::common_flags;
 const ImGuiWindowFlags HPPGui::info_flags    = HPPGui::common_flags | ImGuiWindowFlags_NoInputs;
 
+const float HPPGui::default_refresh_interval = 0.25f;
+
 HPPGui::HPPGui(VulkanSampleCpp &sample_, const vkb::Window &window, const vkb::stats::HPPStats *stats, float font_size, bool explicit_update) :
     sample{sample_}, content_scale_factor{window.get_content_scale_factor()}, dpi_factor{window.get_dpi_factor() * content_scale_factor}, explicit_update{explicit_update}, stats_view(stats)
 {
@@ -192,11 +196,12 @@ HPPGui::HPPGui(VulkanSampleCpp &sample_, const vkb::Window &window, const vkb::s
 
 		auto &queue = device.get_queue_by_flags(vk::QueueFlagBits::eGraphics, 0);
 
-		queue.submit(command_buffer, device.get_fence_pool().request_fence());
+		vk::Fence fence = device.get_fence_pool().request_fence();
+		queue.submit(command_buffer, fence);
 
 		// Wait for the command buffer to finish its work before destroying the staging buffer
-		device.get_fence_pool().wait();
-		device.get_fence_pool().reset();
+		device.get_fence_pool().wait(fence);
+		device.get_fence_pool().recycle(fence);
 		device.get_command_pool().reset_pool();
 	}
 
@@ -349,12 +354,53 @@ void HPPGui::update(const float delta_time)
 	ImGuiIO &io     = ImGui::GetIO();
 	auto     extent = sample.get_render_context().get_surface_extent();
 	resize(extent.width, extent.height);
-	io.DeltaTime = delta_time;
+
+	// A cached HPPGui is given the time since its last rebuild, so the ImGui timers keep their pace
+	io.DeltaTime       = cached ? std::max(time_since_rebuild, delta_time) : delta_time;
+	time_since_rebuild = 0.0f;
 
 	// Render to generate draw buffers
 	ImGui::Render();
 }
 
+void HPPGui::set_cached(bool enable, float refresh_interval)
+{
+	cached                 = enable;
+	this->refresh_interval = refresh_interval;
+	time_since_rebuild     = 0.0f;
+	pending_rebuilds       = REBUILD_FRAMES_AFTER_INPUT;
+}
+
+bool HPPGui::is_cached() const
+{
+	return cached;
+}
+
+bool HPPGui::needs_rebuild(const float delta_time)
+{
+	if (!cached)
+	{
+		return true;
+	}
+
+	time_since_rebuild += delta_time;
+
+	auto        extent  = sample.get_render_context().get_surface_extent();
+	const auto &io      = ImGui::GetIO();
+	bool        resized = (io.DisplaySize.x != static_cast<float>(extent.width)) || (io.DisplaySize.y != static_cast<float>(extent.height));
+
+	// Without draw data there is nothing to draw again, e.g. before the first rebuild
+	bool rebuild = (pending_rebuilds > 0) || resized || (visible != prev_visible) ||
+	               (time_since_rebuild >= refresh_interval) || (visible && !ImGui::GetDrawData());
+
+	if (pending_rebuilds > 0)
+	{
+		pending_rebuilds--;
+	}
+
+	return rebuild;
+}
+
 bool HPPGui::update_buffers()
 {
 	ImDrawData *draw_data = ImGui::GetDrawData();
@@ -373,23 +419,28 @@ bool HPPGui::update_buffers()
 		return false;
 	}
 
-	if ((!vertex_buffer->get_handle()) || (vertex_buffer_size != last_vertex_buffer_size))
+	// The draws recorded with the buffers change with the size of the draw data
+	if ((vertex_buffer_size != last_vertex_buffer_size) || (index_buffer_size != last_index_buffer_size))
 	{
 		last_vertex_buffer_size = vertex_buffer_size;
+		last_index_buffer_size  = index_buffer_size;
 		updated                 = true;
+	}
 
-		vertex_buffer = std::make_unique<vkb::core::BufferCpp>(sample.get_render_context().get_device(), vertex_buffer_size,
+	// The capacity grows geometrically, so the buffers are only reallocated when the draw data gets larger than it ever was
+	if ((!vertex_buffer->get_handle()) || (vertex_buffer_size > vertex_buffer->get_size()))
+	{
+		auto capacity = std::max<size_t>(vertex_buffer_size, 2 * vertex_buffer->get_size());
+		vertex_buffer = std::make_unique<vkb::core::BufferCpp>(sample.get_render_context().get_device(), capacity,
 		                                                       vk::BufferUsageFlagBits::eVertexBuffer,
 		                                                       VMA_MEMORY_USAGE_GPU_TO_CPU);
 		vertex_buffer->set_debug_name("GUI vertex buffer");
 	}
 
-	if ((!index_buffer->get_handle()) || (index_buffer_size != last_index_buffer_size))
+	if ((!index_buffer->get_handle()) || (index_buffer_size > index_buffer->get_size()))
 	{
-		last_index_buffer_size = index_buffer_size;
-		updated                = true;
-
-		index_buffer = std::make_unique<vkb::core::BufferCpp>(sample.get_render_context().get_device(), index_buffer_size,
+		auto capacity = std::max<size_t>(index_buffer_size, 2 * index_buffer->get_size());
+		index_buffer = std::make_unique<vkb::core::BufferCpp>(sample.get_render_context().get_device(), capacity,
 		                                                      vk::BufferUsageFlagBits::eIndexBuffer,
 		                                                      VMA_MEMORY_USAGE_GPU_TO_CPU);
 		index_buffer->set_debug_name("GUI index buffer");
@@ -799,6 +850,13 @@ void HPPGui::show_top_window(const std::string &app_name, const vkb::stats::HPPS
 	}
 
 	ImGui::End();
+
+	// The CPU scopes are only recorded while the debug view shows them
+	CpuProfiler::set_enabled(debug_view.active);
+	if (debug_view.active)
+	{
+		show_cpu_profiler_window(ImVec2{0.0f, ImGui::GetIO().DisplaySize.y});
+	}
 }
 
 void HPPGui::show_app_info(const std::string &app_name) const
@@ -862,6 +920,124 @@ void HPPGui::show_debug_window(const DebugInfo &debug_info, const ImVec2 &positi
 	ImGui::End();
 }
 
+void HPPGui::show_cpu_profiler_window(const ImVec2 &position)
+{
+	auto frames = CpuProfiler::get_frames();
+	if (frames.empty())
+	{
+		return;
+	}
+
+	ImGui::SetNextWindowBgAlpha(overlay_alpha);
+	ImGui::SetNextWindowSize(ImVec2{ImGui::GetIO().DisplaySize.x, 0.0f}, ImGuiCond_Always);
+	ImGui::SetNextWindowPos(position, ImGuiCond_Always, ImVec2{0.0f, 1.0f});
+
+	bool is_open = true;
+	ImGui::Begin("CPU Profiler", &is_open, common_flags);
+
+	auto to_ms = [](uint64_t ns) { return static_cast<float>(static_cast<double>(ns) / 1e6); };
+
+	uint64_t total_frame_time = 0;
+	for (auto &frame : frames)
+	{
+		total_frame_time += frame.end - frame.begin;
+	}
+	const float average_frame_ms = to_ms(total_frame_time / frames.size());
+
+	const auto &latest = frames.back();
+	ImGui::Text("CPU frame: %.2f ms (average of %zu frames: %.2f ms)", to_ms(latest.end - latest.begin), frames.size(), average_frame_ms);
+
+	// Flame graph of the latest frame, with a lane per thread and a row per depth in each lane
+	std::map<uint32_t, uint32_t> lane_rows;
+	for (auto &scope : latest.scopes)
+	{
+		auto &rows = lane_rows[scope.thread];
+		rows       = std::max(rows, scope.depth + 1);
+	}
+
+	std::map<uint32_t, uint32_t> lane_first_row;
+	uint32_t                     row_count = 0;
+	for (auto &lane : lane_rows)
+	{
+		lane_first_row[lane.first] = row_count;
+		row_count += lane.second;
+	}
+
+	const float  row_height = ImGui::GetTextLineHeight();
+	const float  width      = ImGui::GetContentRegionAvail().x;
+	const double duration   = static_cast<double>(std::max<uint64_t>(latest.end - latest.begin, 1));
+	const ImVec2 origin     = ImGui::GetCursorScreenPos();
+	auto        *draw_list  = ImGui::GetWindowDrawList();
+
+	for (auto &scope : latest.scopes)
+	{
+		// Scopes of other threads may have started during the previous frame
+		auto begin = std::max(scope.begin, latest.begin) - latest.begin;
+		auto end   = std::max(scope.end, latest.begin) - latest.begin;
+
+		ImVec2 min{origin.x + static_cast<float>(width * begin / duration), origin.y + row_height * (lane_first_row[scope.thread] + scope.depth)};
+		ImVec2 max{std::max(origin.x + static_cast<float>(width * end / duration), min.x + 1.0f), min.y + row_height - 1.0f};
+
+		// Names have a static storage, their address gives a color stable during the run
+		auto   hue   = static_cast<float>(std::hash<const void *>{}(scope.name) % 360) / 360.0f;
+		ImVec4 color = ImColor::HSV(hue, 0.5f, 0.7f);
+		draw_list->AddRectFilled(min, max, ImGui::GetColorU32(color));
+
+		draw_list->PushClipRect(min, max, true);
+		draw_list->AddText(ImVec2{min.x + 2.0f, min.y}, ImGui::GetColorU32(ImGuiCol_Text), scope.name);
+		draw_list->PopClipRect();
+	}
+	ImGui::Dummy(ImVec2{width, row_height * row_count});
+
+	// Average time of each scope over the history, in the order of the scopes of the latest frames
+	struct Average
+	{
+		const char *name;
+		uint32_t    thread;
+		uint32_t    depth;
+		uint64_t    total;
+	};
+
+	std::vector<Average> averages;
+	for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame)
+	{
+		for (auto &scope : frame->scopes)
+		{
+			auto it = std::find_if(averages.begin(), averages.end(), [&scope](const Average &average) {
+				return average.name == scope.name && average.thread == scope.thread && average.depth == scope.depth;
+			});
+			if (it == averages.end())
+			{
+				averages.push_back({scope.name, scope.thread, scope.depth, 0});
+				it = averages.end() - 1;
+			}
+			it->total += scope.end - scope.begin;
+		}
+	}
+
+	std::stable_sort(averages.begin(), averages.end(), [](const Average &a, const Average &b) { return a.thread < b.thread; });
+
+	const float label_width = ImGui::GetContentRegionAvail().x * 0.3f;
+	uint32_t    thread      = ~0u;
+	for (auto &average : averages)
+	{
+		if (average.thread != thread)
+		{
+			thread = average.thread;
+			ImGui::Text("Thread %u", thread);
+		}
+
+		const float average_ms = to_ms(average.total / frames.size());
+		ImGui::Text("%*s%s", static_cast<int>(2 * (average.depth + 1)), "", average.name);
+		ImGui::SameLine(label_width);
+		ImGui::ProgressBar(average_frame_ms > 0.0f ? average_ms / average_frame_ms : 0.0f,
+		                   ImVec2{-1.0f, 0.0f},
+		                   fmt::format("{:.2f} ms", average_ms).c_str());
+	}
+
+	ImGui::End();
+}
+
 void HPPGui::show_stats(const vkb::stats::HPPStats &stats)
 {
 	for (const auto &stat_index : stats.get_requested_stats())
@@ -873,7 +1049,8 @@ void HPPGui::show_stats(const vkb::stats::HPPStats &stats)
 
 		// Draw graph
 		auto       &graph_data     = pr->second;
-		const auto &graph_elements = stats.get_data(stat_index);
+		const auto &graph_history  = stats.get_data(stat_index);
+		const auto &graph_elements = graph_history.get_values();
 		float       graph_min      = 0.0f;
 		float      &graph_max      = graph_data.max_value;
 
@@ -898,7 +1075,9 @@ void HPPGui::show_stats(const vkb::stats::HPPStats &stats)
 		{
 			graph_label << fmt::format(graph_data.name + ": " + graph_data.format, avg * graph_data.scale_factor);
 			ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
-			ImGui::PlotLines("", &graph_elements[0], static_cast<int>(graph_elements.size()), 0, graph_label.str().c_str(), graph_min, graph_max, graph_size);
+			// The ring is plotted in place from its oldest value
+			ImGui::PlotLines("", graph_elements.data(), static_cast<int>(graph_elements.size()), static_cast<int>(graph_history.get_head()),
+			                 graph_label.str().c_str(), graph_min, graph_max, graph_size);
 			ImGui::PopItemFlag();
 		}
 		else
@@ -964,6 +1143,9 @@ bool HPPGui::input_event(const InputEvent &input_event)
 	auto &io                 = ImGui::GetIO();
 	auto  capture_move_event = false;
 
+	// ImGui only handles the event in the next frames
+	pending_rebuilds = REBUILD_FRAMES_AFTER_INPUT;
+
 	if (input_event.get_source() == EventSource::Keyboard)
 	{
 		const auto &key_event = static_cast<const KeyInputEvent &>(input_event);
@@ -108,6 +108,8 @@ class HPPGui
 	static const std::string default_font;
 	// Used to show/hide the GUI
 	static bool visible;
+	// Seconds between two rebuilds of a cached GUI receiving no input
+	static const float default_refresh_interval;
 
   public:
 	/**
@@ -152,6 +154,25 @@ class HPPGui
 
 	bool update_buffers();
 
+	/**
+	 * @brief Caches the HPPGui, so it is only rebuilt when it may have changed
+	 *        A cached HPPGui is rebuilt for a few frames after each input event, when it is resized or shown,
+	 *        and every refresh interval so the statistics graphs and the text of the sample keep moving.
+	 *        The frames in between draw the geometry of the last rebuild again.
+	 * @param enable Whether the HPPGui is cached
+	 * @param refresh_interval Seconds between two rebuilds without input
+	 */
+	void set_cached(bool enable, float refresh_interval = HPPGui::default_refresh_interval);
+
+	bool is_cached() const;
+
+	/**
+	 * @brief Tells whether the HPPGui must be rebuilt this frame, always true if it isn't cached
+	 *        If not, the caller skips new_frame(), the windows and update(), and draws the last HPPGui.
+	 * @param delta_time Time passed since last frame
+	 */
+	bool needs_rebuild(float delta_time);
+
 	/**
 	 * @brief Draws the HPPGui
 	 * @param command_buffer Command buffer to register draw-commands
@@ -190,6 +211,12 @@ class HPPGui
 	 */
 	void show_debug_window(const DebugInfo &debug_info, const ImVec2 &position);
 
+	/**
+	 * @brief Shows the CPU scopes of the latest frame as a flame graph, and their average time over the last frames
+	 * @param position The absolute position of the bottom left corner of the window
+	 */
+	void show_cpu_profiler_window(const ImVec2 &position);
+
 	/**
 	 * @brief Shows a child with statistics
 	 * @param stats Statistics to show
@@ -258,6 +285,11 @@ class HPPGui
 	static const ImGuiWindowFlags options_flags;
 	static const ImGuiWindowFlags info_flags;
 
+	/**
+	 * @brief Frames a cached HPPGui is rebuilt for after an input event, as ImGui reacts to some inputs a frame late
+	 */
+	static constexpr uint32_t REBUILD_FRAMES_AFTER_INPUT = 3;
+
   private:
 	PushConstBlock                           push_const_block;
 	VulkanSampleCpp                         &sample;
@@ -285,5 +317,9 @@ class HPPGui
 	bool                                     two_finger_tap         = false;        // Whether or not the GUI has detected a multi touch gesture
 	bool                                     show_graph_file_output = false;
 	uint32_t                                 subpass                = 0;
+	bool                                     cached                 = false;
+	float                                    refresh_interval       = 0.0f;
+	float                                    time_since_rebuild     = 0.0f;
+	uint32_t                                 pending_rebuilds       = 0;        // Frames a cached HPPGui is still rebuilt for after an input event
 };
 }        // namespace vkb
@@ -54,7 +54,11 @@ class HPPResourceBindingState : private vkb::ResourceBindingState
 {
   public:
 	using vkb::ResourceBindingState::clear_dirty;
+	using vkb::ResourceBindingState::get_bound_sets;
+	using vkb::ResourceBindingState::get_dirty_sets;
 	using vkb::ResourceBindingState::is_dirty;
+	using vkb::ResourceBindingState::mark_dirty;
+	using vkb::ResourceBindingState::MAX_SETS;
 	using vkb::ResourceBindingState::reset;
 
   public:
@@ -84,9 +88,9 @@ class HPPResourceBindingState : private vkb::ResourceBindingState
 		vkb::ResourceBindingState::bind_input(reinterpret_cast<vkb::core::ImageView const &>(image_view), set, binding, array_element);
 	}
 
-	const std::unordered_map<uint32_t, vkb::HPPResourceSet> &get_resource_sets()
+	const vkb::HPPResourceSet &get_resource_set(uint32_t set) const
 	{
-		return reinterpret_cast<std::unordered_map<uint32_t, vkb::HPPResourceSet> const &>(vkb::ResourceBindingState::get_resource_sets());
+		return reinterpret_cast<vkb::HPPResourceSet const &>(vkb::ResourceBindingState::get_resource_set(set));
 	}
 };
 }        // namespace vkb
@@ -21,8 +21,7 @@
 #include <core/hpp_framebuffer.h>
 #include <core/hpp_pipeline_layout.h>
 #include <core/hpp_render_pass.h>
-#include <HppResourceRecord.h>
-#include <hpp_resource_replay.h>
+#include <ResourceCache.h>
 #include <vulkan/vulkan.hpp>
 
 namespace vkb
@@ -31,7 +30,9 @@ namespace core
 {
 class HPPDescriptorPool;
 class HPPDescriptorSetLayout;
+class HPPImage;
 class HPPImageView;
+class HPPSampler;
 }        // namespace core
 
 namespace rendering
@@ -51,18 +52,41 @@ struct HPPResourceCacheState
 	std::unordered_map<std::size_t, vkb::core::HPPDescriptorPool>      descriptor_pools;
 	std::unordered_map<std::size_t, vkb::core::HPPRenderPass>          render_passes;
 	std::unordered_map<std::size_t, vkb::core::HPPGraphicsPipeline>    graphics_pipelines;
+	std::unordered_map<std::size_t, vkb::GraphicsPipelineLibrary>      graphics_pipeline_libraries;
+	std::unordered_map<std::size_t, vkb::core::HPPGraphicsPipeline>    optimized_graphics_pipelines;
 	std::unordered_map<std::size_t, vkb::core::HPPComputePipeline>     compute_pipelines;
+	std::unordered_map<std::size_t, vkb::ShaderObject>                 shader_objects;
 	std::unordered_map<std::size_t, vkb::core::HPPDescriptorSet>       descriptor_sets;
 	std::unordered_map<std::size_t, vkb::core::HPPFramebuffer>         framebuffers;
+	std::unordered_map<std::size_t, vkb::core::HPPSampler>             samplers;
+	std::unordered_map<std::size_t, vkb::core::HPPImageView>           image_views;
 };
 
 /**
- * @brief vulkan.hpp version of the vkb::ResourceCache class
+ * @brief facade class around vkb::ResourceCache, providing a vulkan.hpp-based interface
  *
- * See vkb::ResourceCache for documentation
+ * The resources requested through either interface are hashed, created, recorded and warmed up by the same
+ * vkb::ResourceCache, so the C and the C++ bindings share them. See vkb::ResourceCache for documentation
  */
-class HPPResourceCache
+class HPPResourceCache : private vkb::ResourceCache
 {
+  public:
+	using vkb::ResourceCache::GetBudget;
+	using vkb::ResourceCache::GetPipelineCreations;
+	using vkb::ResourceCache::GetPipelineCreationTotals;
+	using vkb::ResourceCache::GetStats;
+	using vkb::ResourceCache::GetWarmupTimings;
+	using vkb::ResourceCache::LoadFromFile;
+	using vkb::ResourceCache::ReloadShaders;
+	using vkb::ResourceCache::ResetStats;
+	using vkb::ResourceCache::SaveToFile;
+	using vkb::ResourceCache::SetBudget;
+	using vkb::ResourceCache::SetOptimizeLinkedPipelines;
+	using vkb::ResourceCache::SetWarmupThreadCount;
+	using vkb::ResourceCache::Trim;
+	using vkb::ResourceCache::WaitForShaderModules;
+	using vkb::ResourceCache::WritePipelineCreationReport;
+
   public:
 	HPPResourceCache(vkb::core::HPPDevice &device);
 
@@ -74,6 +98,8 @@ class HPPResourceCache
 	void                               clear();
 	void                               clear_framebuffers();
 	void                               clear_pipelines();
+	uint64_t                           get_generation() const;
+	uint32_t                           get_descriptor_set_peak(const vkb::core::HPPDescriptorSetLayout &descriptor_set_layout) const;
 	const HPPResourceCacheState       &get_internal_state() const;
 	vkb::core::HPPComputePipeline     &request_compute_pipeline(vkb::rendering::HPPPipelineState &pipeline_state);
 	vkb::core::HPPDescriptorSet       &request_descriptor_set(vkb::core::HPPDescriptorSetLayout          &descriptor_set_layout,
@@ -84,12 +110,22 @@ class HPPResourceCache
 	                                                                 const std::vector<vkb::core::HPPShaderResource> &set_resources);
 	vkb::core::HPPFramebuffer         &request_framebuffer(const vkb::rendering::HPPRenderTarget &render_target, const vkb::core::HPPRenderPass &render_pass);
 	vkb::core::HPPGraphicsPipeline    &request_graphics_pipeline(vkb::rendering::HPPPipelineState &pipeline_state);
+	vkb::core::HPPImageView           &request_image_view(vkb::core::HPPImage &image,
+	                                                      vk::ImageViewType    view_type,
+	                                                      vk::Format           format           = vk::Format::eUndefined,
+	                                                      uint32_t             base_mip_level   = 0,
+	                                                      uint32_t             base_array_layer = 0,
+	                                                      uint32_t             n_mip_levels     = 0,
+	                                                      uint32_t             n_array_layers   = 0);
 	vkb::core::HPPPipelineLayout      &request_pipeline_layout(const std::vector<vkb::core::HPPShaderModule *> &shader_modules);
 	vkb::core::HPPRenderPass          &request_render_pass(const std::vector<vkb::rendering::HPPAttachment> &attachments,
 	                                                       const std::vector<vkb::common::HPPLoadStoreInfo> &load_store_infos,
 	                                                       const std::vector<vkb::core::HPPSubpassInfo>     &subpasses);
+	vkb::core::HPPSampler             &request_sampler(const vk::SamplerCreateInfo &info);
 	vkb::core::HPPShaderModule        &request_shader_module(
 	           vk::ShaderStageFlagBits stage, const vkb::core::HPPShaderSource &glsl_source, const vkb::core::HPPShaderVariant &shader_variant = {});
+	void                 release_image_views(const vkb::core::HPPImage &image);
+	void                 record_descriptor_set_peak(const vkb::core::HPPDescriptorSetLayout &descriptor_set_layout, uint32_t set_count);
 	std::vector<uint8_t> serialize();
 	void                 set_pipeline_cache(vk::PipelineCache pipeline_cache);
 
@@ -98,21 +134,9 @@ class HPPResourceCache
 	/// @param new_views New image views to be referred
 	void update_descriptor_sets(const std::vector<vkb::core::HPPImageView> &old_views, const std::vector<vkb::core::HPPImageView> &new_views);
 
-	void warmup(const std::vector<uint8_t> &data);
+	/// @brief Update those descriptor sets referring to old buffers, see vkb::ResourceCache::UpdateDescriptorSets
+	void update_descriptor_sets(const std::vector<vk::Buffer> &old_buffers, const std::vector<vk::Buffer> &new_buffers);
 
-  private:
-	vkb::core::HPPDevice  &device;
-	vkb::HPPResourceRecord recorder                    = {};
-	vkb::HPPResourceReplay replayer                    = {};
-	vk::PipelineCache      pipeline_cache              = nullptr;
-	HPPResourceCacheState  state                       = {};
-	std::mutex             descriptor_set_mutex        = {};
-	std::mutex             pipeline_layout_mutex       = {};
-	std::mutex             shader_module_mutex         = {};
-	std::mutex             descriptor_set_layout_mutex = {};
-	std::mutex             graphics_pipeline_mutex     = {};
-	std::mutex             render_pass_mutex           = {};
-	std::mutex             compute_pipeline_mutex      = {};
-	std::mutex             framebuffer_mutex           = {};
+	void warmup(const std::vector<uint8_t> &data);
 };
 }        // namespace vkb
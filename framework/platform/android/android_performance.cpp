@@ -0,0 +1,167 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform/android/android_performance.h"
+
+#include <dlfcn.h>
+
+#include "core/util/logging.hpp"
+
+namespace vkb
+{
+template <typename T>
+void AndroidPerformance::load_symbol(T &function, const char *name)
+{
+	function = reinterpret_cast<T>(dlsym(library, name));
+}
+
+AndroidPerformance::AndroidPerformance()
+{
+	library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+	if (!library)
+	{
+		LOGW("Failed to load libandroid.so, performance hints are disabled");
+		return;
+	}
+
+	load_symbol(get_hint_manager, "APerformanceHint_getManager");
+	load_symbol(create_session, "APerformanceHint_createSession");
+	load_symbol(update_target_work_duration, "APerformanceHint_updateTargetWorkDuration");
+	load_symbol(report_actual_work_duration, "APerformanceHint_reportActualWorkDuration");
+	load_symbol(close_hint_session, "APerformanceHint_closeSession");
+
+	if (get_hint_manager && create_session && update_target_work_duration && report_actual_work_duration && close_hint_session)
+	{
+		hint_manager = get_hint_manager();
+	}
+
+	load_symbol(acquire_thermal_manager, "AThermal_acquireManager");
+	load_symbol(release_thermal_manager, "AThermal_releaseManager");
+	load_symbol(get_thermal_headroom, "AThermal_getThermalHeadroom");
+
+	if (acquire_thermal_manager && release_thermal_manager && get_thermal_headroom)
+	{
+		thermal_manager = acquire_thermal_manager();
+	}
+
+	LOGI("Performance hints {}, thermal headroom {}", hint_manager ? "supported" : "not supported", thermal_manager ? "supported" : "not supported");
+}
+
+AndroidPerformance::~AndroidPerformance()
+{
+	close_session();
+
+	if (thermal_manager)
+	{
+		release_thermal_manager(thermal_manager);
+	}
+
+	if (library)
+	{
+		dlclose(library);
+	}
+}
+
+bool AndroidPerformance::is_hint_supported() const
+{
+	return hint_manager != nullptr;
+}
+
+bool AndroidPerformance::is_thermal_supported() const
+{
+	return thermal_manager != nullptr;
+}
+
+void AndroidPerformance::update_session(const std::vector<pid_t> &thread_ids, std::chrono::nanoseconds target_duration)
+{
+	if (!hint_manager)
+	{
+		return;
+	}
+
+	if (session && thread_ids != session_thread_ids)
+	{
+		// The threads of a session can only be changed from API level 34, another session is created instead
+		close_session();
+	}
+
+	if (!session)
+	{
+		std::vector<int32_t> tids{thread_ids.begin(), thread_ids.end()};
+		session = create_session(hint_manager, tids.data(), tids.size(), target_duration.count());
+		if (!session)
+		{
+			LOGW_THROTTLED("Failed to create a performance hint session for {} threads", tids.size());
+			return;
+		}
+
+		session_thread_ids      = thread_ids;
+		session_target_duration = target_duration;
+	}
+
+	if (target_duration != session_target_duration)
+	{
+		update_target_work_duration(session, target_duration.count());
+		session_target_duration = target_duration;
+	}
+}
+
+void AndroidPerformance::report_work_duration(std::chrono::nanoseconds duration)
+{
+	// The OS rejects durations which aren't positive
+	if (session && duration.count() > 0)
+	{
+		report_actual_work_duration(session, duration.count());
+	}
+}
+
+bool AndroidPerformance::poll_thermal_headroom(float &headroom)
+{
+	if (!thermal_manager)
+	{
+		return false;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	if (now - last_thermal_poll < ThermalPollInterval)
+	{
+		return false;
+	}
+	last_thermal_poll = now;
+
+	// NaN when the headroom isn't available, e.g. just after the manager was acquired
+	float value = get_thermal_headroom(thermal_manager, ThermalForecast);
+	if (value != value)
+	{
+		return false;
+	}
+
+	headroom = value;
+	return true;
+}
+
+void AndroidPerformance::close_session()
+{
+	if (session)
+	{
+		close_hint_session(session);
+		session = nullptr;
+	}
+
+	session_thread_ids.clear();
+}
+}        // namespace vkb
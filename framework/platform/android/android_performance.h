@@ -0,0 +1,126 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <sys/types.h>
+
+struct APerformanceHintManager;
+struct APerformanceHintSession;
+struct AThermalManager;
+
+namespace vkb
+{
+/**
+ * @brief Reports the CPU work of the frames to the Android Dynamic Performance Framework, and queries the thermal
+ *        headroom of the device
+ *
+ * The performance hint session (API level 33) lets the OS raise or lower the clocks of the CPUs running the threads
+ * of the frames, so they meet their target duration without spending more power than needed. The thermal headroom
+ * (API level 31) forecasts how close the device is to being severely throttled.
+ *
+ * The functions are loaded from libandroid.so when the object is created, so the samples still run on the devices
+ * without them, only without hints.
+ */
+class AndroidPerformance
+{
+  public:
+	/// Minimum time between two queries of the thermal headroom, the OS rejects more frequent ones
+	static constexpr std::chrono::seconds ThermalPollInterval{1};
+
+	/// Seconds ahead the thermal headroom is forecast
+	static constexpr int ThermalForecast{10};
+
+	AndroidPerformance();
+
+	AndroidPerformance(const AndroidPerformance &) = delete;
+
+	AndroidPerformance(AndroidPerformance &&) = delete;
+
+	/**
+	 * @brief Closes the session and releases the thermal manager
+	 */
+	~AndroidPerformance();
+
+	AndroidPerformance &operator=(const AndroidPerformance &) = delete;
+
+	AndroidPerformance &operator=(AndroidPerformance &&) = delete;
+
+	bool is_hint_supported() const;
+
+	bool is_thermal_supported() const;
+
+	/**
+	 * @brief Creates the session for a set of threads, again when they changed, and updates its target
+	 * @param thread_ids The threads working on the frames, which must belong to the process
+	 * @param target_duration The CPU time each frame should take
+	 */
+	void update_session(const std::vector<pid_t> &thread_ids, std::chrono::nanoseconds target_duration);
+
+	/**
+	 * @brief Reports the CPU time a frame took, once per frame
+	 */
+	void report_work_duration(std::chrono::nanoseconds duration);
+
+	/**
+	 * @brief Queries the forecast thermal headroom, at most once per ThermalPollInterval
+	 * @param headroom Set to the headroom, 1 being the threshold of severe throttling
+	 * @return Whether the headroom was queried
+	 */
+	bool poll_thermal_headroom(float &headroom);
+
+  private:
+	void close_session();
+
+	template <typename T>
+	void load_symbol(T &function, const char *name);
+
+	void *library{nullptr};
+
+	APerformanceHintManager *(*get_hint_manager)(){nullptr};
+
+	APerformanceHintSession *(*create_session)(APerformanceHintManager *, const int32_t *, size_t, int64_t){nullptr};
+
+	int (*update_target_work_duration)(APerformanceHintSession *, int64_t){nullptr};
+
+	int (*report_actual_work_duration)(APerformanceHintSession *, int64_t){nullptr};
+
+	void (*close_hint_session)(APerformanceHintSession *){nullptr};
+
+	AThermalManager *(*acquire_thermal_manager)(){nullptr};
+
+	void (*release_thermal_manager)(AThermalManager *){nullptr};
+
+	float (*get_thermal_headroom)(AThermalManager *, int){nullptr};
+
+	APerformanceHintManager *hint_manager{nullptr};
+
+	APerformanceHintSession *session{nullptr};
+
+	/// Threads of the session
+	std::vector<pid_t> session_thread_ids;
+
+	std::chrono::nanoseconds session_target_duration{0};
+
+	AThermalManager *thermal_manager{nullptr};
+
+	std::chrono::steady_clock::time_point last_thermal_poll;
+};
+}        // namespace vkb
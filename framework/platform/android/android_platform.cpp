@@ -17,7 +17,10 @@
 
 #include "android_platform.h"
 
+#include <algorithm>
 #include <chrono>
+#include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 #include <unordered_map>
 
@@ -36,6 +39,8 @@
 #include "core/util/logging.hpp"
 #include "platform/android/android_window.h"
 #include "platform/input_events.h"
+#include "platform/simulation_thread.h"
+#include "rendering/render_context.h"
 
 extern "C"
 {
@@ -84,6 +89,13 @@ inline std::tm thread_safe_time(const std::time_t time)
 	return result;
 }
 
+std::chrono::nanoseconds get_thread_cpu_time()
+{
+	timespec time{};
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return std::chrono::seconds{time.tv_sec} + std::chrono::nanoseconds{time.tv_nsec};
+}
+
 inline KeyCode translate_key_code(int key)
 {
 	static const std::unordered_map<int, KeyCode> key_lookup =
@@ -357,6 +369,8 @@ ExitCode AndroidPlatform::initialize(const std::vector<Plugin *> &plugins)
 		return code;
 	}
 
+	performance = std::make_unique<AndroidPerformance>();
+
 	// Wait until the android window is loaded before allowing the app to continue
 	LOGI("Waiting on window surface to be ready");
 	do
@@ -438,6 +452,49 @@ void AndroidPlatform::process_android_input_events(void)
 	}
 }
 
+void AndroidPlatform::on_post_draw(RenderContext &context)
+{
+	Platform::on_post_draw(context);
+
+	if (performance)
+	{
+		update_performance(context.get_frame_pacer());
+	}
+}
+
+void AndroidPlatform::update_performance(FramePacer &frame_pacer)
+{
+	// The CPU time of the render thread leaves out its waits for the GPU and the presentation engine,
+	// which the OS must not compensate with higher clocks
+	auto cpu_time = get_thread_cpu_time();
+
+	if (performance->is_hint_supported())
+	{
+		std::vector<pid_t> thread_ids{gettid()};
+		if (simulation_thread)
+		{
+			thread_ids.push_back(pthread_gettid_np(simulation_thread->get_native_handle()));
+		}
+
+		// Throttled frames have more time, so the clocks of the CPUs can drop along with the frame rate
+		auto target_duration = frame_pacer.is_thermal_throttled() ? std::max(frame_pacer.get_throttled_frame_time(), FrameBudget) : FrameBudget;
+		performance->update_session(thread_ids, target_duration);
+
+		if (frame_cpu_time.count() > 0)
+		{
+			performance->report_work_duration(cpu_time - frame_cpu_time);
+		}
+	}
+
+	frame_cpu_time = cpu_time;
+
+	float headroom{0.0f};
+	if (performance->poll_thermal_headroom(headroom))
+	{
+		frame_pacer.set_thermal_headroom(headroom);
+	}
+}
+
 void AndroidPlatform::terminate(ExitCode code)
 {
 	switch (code)
@@ -461,6 +518,8 @@ void AndroidPlatform::terminate(ExitCode code)
 		// Process events until app->destroyRequested is set
 	}
 
+	performance.reset();
+
 	Platform::terminate(code);
 }
 
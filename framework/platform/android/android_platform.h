@@ -17,12 +17,17 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <game-activity/native_app_glue/android_native_app_glue.h>
 
+#include "platform/android/android_performance.h"
 #include "platform/platform.h"
 
 namespace vkb
 {
+class FramePacer;
+
 class AndroidPlatform : public Platform
 {
   public:
@@ -54,9 +59,20 @@ class AndroidPlatform : public Platform
 
 	void process_android_input_events(void);
 
+	/**
+	 * @brief Reports the CPU time of the frame to the performance hint session, and the thermal headroom of the
+	 *        device to the frame pacer of the render context
+	 */
+	virtual void on_post_draw(RenderContext &context) override;
+
   private:
+	/// CPU time per frame the performance hints target, the frame time of a 60 Hz display
+	static constexpr std::chrono::nanoseconds FrameBudget{16'666'667};
+
 	virtual void create_window(const Window::Properties &properties) override;
 
+	void update_performance(FramePacer &frame_pacer);
+
   private:
 	android_app *app{nullptr};
 
@@ -65,6 +81,11 @@ class AndroidPlatform : public Platform
 	virtual std::vector<spdlog::sink_ptr> get_platform_sinks() override;
 
 	bool surface_ready{false};
+
+	std::unique_ptr<AndroidPerformance> performance;
+
+	/// CPU time of the render thread at the end of the last frame
+	std::chrono::nanoseconds frame_cpu_time{0};
 };
 
 /**
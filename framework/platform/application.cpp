@@ -37,6 +37,7 @@ bool Application::prepare(const ApplicationOptions &options)
 
 	lock_simulation_speed = options.benchmark_enabled;
 	window                = options.window;
+	gui_cached            = options.gui_cached;
 
 	return true;
 }
@@ -69,6 +70,30 @@ void Application::update_overlay(float delta_time, const std::function<void()> &
 {
 }
 
+void Application::fixed_update(float tick)
+{
+}
+
+bool Application::supports_fixed_update() const
+{
+	return false;
+}
+
+void Application::set_fixed_update_enabled(bool enabled)
+{
+	fixed_update_enabled = enabled;
+}
+
+bool Application::is_fixed_update_enabled() const
+{
+	return fixed_update_enabled;
+}
+
+bool Application::is_gui_cached() const
+{
+	return gui_cached;
+}
+
 const std::string &Application::get_name() const
 {
 	return name;
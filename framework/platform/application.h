@@ -33,6 +33,7 @@ struct ApplicationOptions
 {
 	bool    benchmark_enabled{false};
 	Window *window{nullptr};
+	bool    gui_cached{false};
 };
 
 class Application
@@ -61,6 +62,36 @@ class Application
 	virtual void update_overlay(
 	    float delta_time, const std::function<void()> &additional_ui = []() {});
 
+	/**
+	 * @brief Advances the simulation of the application by a fixed tick
+	 *        Only called when the platform runs a fixed timestep, on the simulation thread, concurrently
+	 *        with update(). It must not touch the resources used for rendering, the state it reaches is
+	 *        handed over to update(), for example through an InterpolatedState.
+	 * @param tick The duration of a tick in seconds
+	 */
+	virtual void fixed_update(float tick);
+
+	/**
+	 * @return Whether the application simulates in fixed_update() when the platform runs a fixed timestep
+	 */
+	virtual bool supports_fixed_update() const;
+
+	/**
+	 * @brief Called by the platform before the simulation thread starts, or after it stopped
+	 * @param enabled Whether fixed_update() is called
+	 */
+	void set_fixed_update_enabled(bool enabled);
+
+	/**
+	 * @return Whether the simulation runs in fixed_update() rather than update()
+	 */
+	bool is_fixed_update_enabled() const;
+
+	/**
+	 * @return Whether the GUI of the application is only rebuilt when it may have changed, see Gui::set_cached()
+	 */
+	bool is_gui_cached() const;
+
 	/**
 	 * @brief Handles cleaning up the application
 	 */
@@ -157,6 +188,10 @@ class Application
 
 	bool requested_close{false};
 
+	bool fixed_update_enabled{false};
+
+	bool gui_cached{false};
+
 	/** @brief Used to select between different shader languages, static so it can be changed from a plugin */
 	inline static vkb::ShadingLanguage shading_language{vkb::ShadingLanguage::GLSL};
 };
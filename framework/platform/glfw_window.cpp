@@ -22,6 +22,9 @@
 #include "common/error.h"
 
 #define GLFW_INCLUDE_NONE
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+#	define GLFW_EXPOSE_NATIVE_WIN32
+#endif
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
 #include <fmt/format.h>
@@ -279,6 +282,7 @@ GlfwWindow::GlfwWindow(Platform *platform, const Window::Properties &properties)
 	switch (properties.mode)
 	{
 		case Window::Mode::Fullscreen:
+		case Window::Mode::FullscreenExclusive:
 		{
 			auto       *monitor = glfwGetPrimaryMonitor();
 			const auto *mode    = glfwGetVideoMode(monitor);
@@ -405,6 +409,17 @@ float GlfwWindow::get_content_scale_factor() const
 	return static_cast<float>(fb_width) / win_width;
 }
 
+void *GlfwWindow::get_full_screen_exclusive_monitor() const
+{
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	if (properties.mode == Window::Mode::FullscreenExclusive)
+	{
+		return MonitorFromWindow(glfwGetWin32Window(handle), MONITOR_DEFAULTTOPRIMARY);
+	}
+#endif
+	return nullptr;
+}
+
 std::vector<const char *> GlfwWindow::get_required_surface_extensions() const
 {
 	uint32_t     glfw_extension_count{0};
@@ -50,6 +50,8 @@ class GlfwWindow : public Window
 
 	float get_content_scale_factor() const override;
 
+	void *get_full_screen_exclusive_monitor() const override;
+
 	std::vector<const char *> get_required_surface_extensions() const override;
 
   private:
@@ -25,6 +25,10 @@ namespace vkb
  * @brief Surface-less implementation of a Window using VK_EXT_headless_surface.
  * A surface and swapchain are still created but the the present operation resolves to a no op.
  * Useful for testing and benchmarking in CI environments.
+ *
+ * In the Offscreen mode no surface is created at all, and the render context renders its frames
+ * to images of its own without presenting them. This doesn't need VK_EXT_headless_surface, so it
+ * runs on GPUs without a display or presentation support.
  */
 class HeadlessWindow : public Window
 {
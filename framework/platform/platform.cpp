@@ -25,11 +25,10 @@
 #include <vector>
 
 #include <fmt/format.h>
-#include <spdlog/async_logger.h>
-#include <spdlog/details/thread_pool.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include "core/util/job_system.hpp"
 #include "core/util/logging.hpp"
 #include "force_close/force_close.h"
 #include "glsl_compiler.h"
@@ -50,21 +49,22 @@ ExitCode Platform::initialize(const std::vector<Plugin *> &plugins_)
 {
 	plugins = plugins_;
 
-	auto sinks = get_platform_sinks();
-
-	auto logger = std::make_shared<spdlog::logger>("logger", sinks.begin(), sinks.end());
+	logging::init(get_platform_sinks());
 
 #ifdef VKB_DEBUG
-	logger->set_level(spdlog::level::debug);
+	spdlog::default_logger()->set_level(spdlog::level::debug);
 #else
-	logger->set_level(spdlog::level::info);
+	spdlog::default_logger()->set_level(spdlog::level::info);
 #endif
 
-	logger->set_pattern(LOGGER_FORMAT);
-	spdlog::set_default_logger(logger);
-
 	LOGI("Logger initialized");
 
+	// Started once, the loader, the scene updates, the recording and the compiles share its workers
+	JobSystem::init();
+
+	// The thread running the main loop records and submits the frames
+	set_current_thread_role(ThreadRole::Render);
+
 	// To get the error messages formatted as we like them to have, exit after initializing the logger, earliest
 	if (arguments.empty())
 	{
@@ -217,6 +217,7 @@ ExitCode Platform::main_loop_frame()
 		{
 			std::string id = active_app->get_name();
 			on_app_close(id);
+			stop_simulation();
 			active_app->finish();
 		}
 
@@ -229,6 +230,8 @@ ExitCode Platform::main_loop_frame()
 	}
 	catch (std::exception &e)
 	{
+		stop_simulation();
+
 		LOGE("Error Message: {}", e.what());
 		LOGE("Failed when running application {}", active_app->get_name());
 
@@ -263,6 +266,11 @@ void Platform::update()
 {
 	auto delta_time = static_cast<float>(timer.tick<Timer::Seconds>());
 
+	if (simulation_thread)
+	{
+		simulation_thread->check_error();
+	}
+
 	if (focused || always_render)
 	{
 		on_update(delta_time);
@@ -346,12 +354,15 @@ void Platform::terminate(ExitCode code)
 	{
 		std::string id = active_app->get_name();
 		on_app_close(id);
+		stop_simulation();
 		active_app->finish();
 	}
 
 	active_app.reset();
 	window.reset();
 
+	JobSystem::terminate();
+
 	spdlog::drop_all();
 
 	on_platform_close();
@@ -383,11 +394,51 @@ void Platform::force_simulation_fps(float fps)
 	simulation_frame_time = 1 / fps;
 }
 
+void Platform::run_fixed_timestep(float tick_rate)
+{
+	fixed_tick_rate = tick_rate;
+}
+
+void Platform::start_simulation()
+{
+	// A forced simulation fps makes runs reproducible, which a simulation following the real time isn't
+	if (fixed_tick_rate <= 0.0f || fixed_simulation_fps)
+	{
+		return;
+	}
+
+	if (!active_app->supports_fixed_update())
+	{
+		LOGI("{} doesn't support a fixed timestep, it is simulated at the rendering rate", active_app->get_name());
+		return;
+	}
+
+	LOGI("Simulating {} at {} ticks per second", active_app->get_name(), fixed_tick_rate);
+
+	auto *app = active_app.get();
+	app->set_fixed_update_enabled(true);
+	simulation_thread = std::make_unique<SimulationThread>(fixed_tick_rate, [app](float tick) { app->fixed_update(tick); });
+}
+
+void Platform::stop_simulation()
+{
+	if (simulation_thread)
+	{
+		simulation_thread.reset();
+		active_app->set_fixed_update_enabled(false);
+	}
+}
+
 void Platform::force_render(bool should_always_render)
 {
 	always_render = should_always_render;
 }
 
+void Platform::cache_gui(bool should_cache_gui)
+{
+	gui_cached = should_cache_gui;
+}
+
 void Platform::disable_input_processing()
 {
 	process_input_events = false;
@@ -464,7 +515,9 @@ bool Platform::start_app()
 		LOGI("Closing App (Runtime: {:.1f})", execution_time);
 
 		auto app_id = active_app->get_name();
+		on_app_close(app_id);
 
+		stop_simulation();
 		active_app->finish();
 	}
 
@@ -481,7 +534,7 @@ bool Platform::start_app()
 	auto sample_info = static_cast<const apps::SampleInfo *>(requested_app_info);
 	active_app->set_name(sample_info->name);
 
-	if (!active_app->prepare({false, window.get()}))
+	if (!active_app->prepare({false, window.get(), gui_cached}))
 	{
 		LOGE("Failed to prepare vulkan app.");
 		return false;
@@ -489,6 +542,8 @@ bool Platform::start_app()
 
 	on_app_start(requested_app_info->id);
 
+	start_simulation();
+
 	return true;
 }
 
@@ -497,6 +552,8 @@ void Platform::input_event(const InputEvent &input_event)
 	if (process_input_events && active_app)
 	{
 		active_app->input_event(input_event);
+
+		on_input_event(input_event);
 	}
 
 	if (input_event.get_source() == EventSource::Keyboard)
@@ -570,6 +627,11 @@ void Platform::on_update_ui_overlay(vkb::Drawer &drawer)
 	HOOK(Hook::OnUpdateUi, on_update_ui_overlay(drawer));
 }
 
+void Platform::on_input_event(const InputEvent &input_event)
+{
+	HOOK(Hook::OnInputEvent, on_input_event(input_event));
+}
+
 #undef HOOK
 
 }        // namespace vkb
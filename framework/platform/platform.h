@@ -31,6 +31,7 @@
 #include "common/vk_common.h"
 #include "platform/application.h"
 #include "platform/plugins/plugin.h"
+#include "platform/simulation_thread.h"
 #include "platform/window.h"
 #include "rendering/render_context.h"
 
@@ -123,14 +124,24 @@ class Platform
 
 	void force_simulation_fps(float fps);
 
+	/**
+	 * @brief Runs the simulation of the apps supporting it at a fixed tick rate on a thread of its own,
+	 *        decoupled from the rendering rate. Ignored while the simulation fps is forced.
+	 * @param tick_rate Ticks per second
+	 */
+	void run_fixed_timestep(float tick_rate);
+
 	// Force the application to always render even if it is not in focus
 	void force_render(bool should_always_render);
 
+	// Let the applications rebuild their GUI only when it may have changed, drawing the last one in between
+	void cache_gui(bool should_cache_gui);
+
 	void disable_input_processing();
 
 	void set_window_properties(const Window::OptionalProperties &properties);
 
-	void on_post_draw(RenderContext &context);
+	virtual void on_post_draw(RenderContext &context);
 
 	static const uint32_t MIN_WINDOW_WIDTH;
 	static const uint32_t MIN_WINDOW_HEIGHT;
@@ -161,6 +172,10 @@ class Platform
 	void on_app_close(const std::string &app_id);
 	void on_platform_close();
 	void on_update_ui_overlay(vkb::Drawer &drawer);
+	void on_input_event(const InputEvent &input_event);
+
+	void start_simulation();
+	void stop_simulation();
 
 	Window::Properties window_properties;              /* Source of truth for window state */
 	bool               fixed_simulation_fps{false};    /* Delta time should be fixed with a fabricated value */
@@ -169,6 +184,10 @@ class Platform
 	bool               process_input_events{true};     /* App should continue processing input events */
 	bool               focused{true};                  /* App is currently in focus at an operating system level */
 	bool               close_requested{false};         /* Close requested */
+	float              fixed_tick_rate{0.0f};          /* Ticks per second of the simulation thread, none if zero */
+	bool               gui_cached{false};              /* Apps rebuild their GUI only when it may have changed */
+
+	std::unique_ptr<SimulationThread> simulation_thread;
 
   private:
 	Timer timer;
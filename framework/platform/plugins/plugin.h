@@ -29,6 +29,7 @@
 
 namespace vkb
 {
+class InputEvent;
 class Platform;
 class RenderContext;
 class Plugin;
@@ -70,6 +71,7 @@ std::vector<Plugin *> associate_plugins(const std::vector<Plugin *> &plugins);
  * OnAppStart - Executed when an app starts
  * OnAppClose - Executed when an app closes
  * OnPlatformClose - Executed when the platform closes (End off the apps lifecycle)
+ * OnInputEvent - Executed for each input event processed by the app
  */
 enum class Hook
 {
@@ -79,7 +81,8 @@ enum class Hook
 	OnAppError,
 	OnPlatformClose,
 	PostDraw,
-	OnUpdateUi
+	OnUpdateUi,
+	OnInputEvent
 };
 
 /**
@@ -149,6 +152,13 @@ class Plugin
 	 */
 	virtual void on_update_ui_overlay(vkb::Drawer &drawer) = 0;
 
+	/**
+	 * @brief Called when an input event is passed to the app
+	 *
+	 * @param input_event The event of the platform
+	 */
+	virtual void on_input_event(const InputEvent &input_event) = 0;
+
 	const std::string &get_name() const;
 	const std::string &get_description() const;
 
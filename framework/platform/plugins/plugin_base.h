@@ -49,6 +49,7 @@ class PluginBase : public Plugin, public Tag<TAGS...>
 	void on_post_draw(RenderContext &context) override{};
 	void on_app_error(const std::string &app_id) override{};
 	void on_update_ui_overlay(vkb::Drawer &drawer) override{};
+	void on_input_event(const InputEvent &input_event) override{};
 
   private:
 	Tag<TAGS...> *tags = reinterpret_cast<Tag<TAGS...> *>(this);
@@ -0,0 +1,99 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform/simulation_thread.h"
+
+#include <cassert>
+#include <utility>
+
+#include "core/util/thread_role.hpp"
+
+namespace vkb
+{
+SimulationThread::SimulationThread(float tick_rate, std::function<void(float)> step) :
+    tick{1.0f / tick_rate},
+    step{std::move(step)}
+{
+	assert(tick_rate > 0.0f);
+
+	thread = std::thread([this] { run(); });
+}
+
+SimulationThread::~SimulationThread()
+{
+	stop_requested = true;
+
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+}
+
+float SimulationThread::get_tick() const
+{
+	return tick;
+}
+
+std::thread::native_handle_type SimulationThread::get_native_handle()
+{
+	return thread.native_handle();
+}
+
+void SimulationThread::check_error()
+{
+	std::lock_guard<std::mutex> guard(error_mutex);
+
+	if (error)
+	{
+		std::rethrow_exception(std::exchange(error, nullptr));
+	}
+}
+
+void SimulationThread::run()
+{
+	using Clock = std::chrono::steady_clock;
+
+	// The frames show its states, it is as critical as the render thread
+	set_current_thread_role(ThreadRole::Render);
+
+	auto tick_duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(tick));
+	auto next_tick     = Clock::now();
+
+	try
+	{
+		while (!stop_requested)
+		{
+			step(tick);
+			next_tick += tick_duration;
+
+			auto now = Clock::now();
+			if (now - next_tick > tick_duration * MaxCatchUpTicks)
+			{
+				// The simulation stalled, skip the ticks it can't catch up on
+				next_tick = now;
+			}
+
+			std::this_thread::sleep_until(next_tick);
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> guard(error_mutex);
+		error = std::current_exception();
+	}
+}
+}        // namespace vkb
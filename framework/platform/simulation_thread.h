@@ -0,0 +1,157 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace vkb
+{
+/**
+ * @brief Runs a simulation at a fixed tick rate on a thread of its own
+ *
+ * The step function is called once per tick, with the duration of a tick. When the thread falls
+ * behind, it runs the missed ticks back to back, up to MaxCatchUpTicks, then drops the rest so a
+ * stall doesn't make it spin. Rendering runs at its own rate and interpolates the states the
+ * simulation publishes (see InterpolatedState).
+ */
+class SimulationThread
+{
+  public:
+	/// Most ticks run back to back before the thread skips ahead
+	static constexpr uint32_t MaxCatchUpTicks = 5;
+
+	/**
+	 * @param tick_rate Ticks per second
+	 * @param step Advances the simulation by a tick, called on the simulation thread
+	 */
+	SimulationThread(float tick_rate, std::function<void(float)> step);
+
+	SimulationThread(const SimulationThread &) = delete;
+
+	SimulationThread(SimulationThread &&) = delete;
+
+	/**
+	 * @brief Stops the thread after its current tick
+	 */
+	~SimulationThread();
+
+	SimulationThread &operator=(const SimulationThread &) = delete;
+
+	SimulationThread &operator=(SimulationThread &&) = delete;
+
+	/**
+	 * @return The duration of a tick in seconds
+	 */
+	float get_tick() const;
+
+	/**
+	 * @return The native handle of the thread, e.g. to report it to the scheduler of the OS
+	 */
+	std::thread::native_handle_type get_native_handle();
+
+	/**
+	 * @brief Rethrows on the calling thread the exception which stopped the simulation, if any
+	 */
+	void check_error();
+
+  private:
+	void run();
+
+	float tick;
+
+	std::function<void(float)> step;
+
+	std::atomic<bool> stop_requested{false};
+
+	std::mutex error_mutex;
+
+	std::exception_ptr error;
+
+	std::thread thread;
+};
+
+/**
+ * @brief Hands the states of a fixed timestep simulation over to the render thread
+ *
+ * The simulation publishes a state after each tick. Rendering samples the state one tick in the
+ * past, between the two latest states, so the motion stays smooth whatever the two rates are.
+ * @tparam T Copyable state of the simulation
+ */
+template <typename T>
+class InterpolatedState
+{
+  public:
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Sets the state reached by the last tick, called by the simulation
+	 * @param state The state of the simulation
+	 * @param tick Duration of the tick in seconds
+	 */
+	void publish(const T &state, float tick)
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+
+		previous     = published ? current : state;
+		current      = state;
+		current_time = Clock::now();
+		current_tick = std::chrono::duration<float>(tick);
+		published    = true;
+	}
+
+	/**
+	 * @brief Interpolates the state rendered now from the two latest states
+	 * @param lerp Function blending two states, given a factor between 0 and 1
+	 * @param state Set to the interpolated state
+	 * @return Whether a state was published yet
+	 */
+	template <typename Lerp>
+	bool sample(Lerp &&lerp, T &state) const
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+
+		if (!published)
+		{
+			return false;
+		}
+
+		float alpha = std::chrono::duration<float>(Clock::now() - current_time) / current_tick;
+		state       = lerp(previous, current, std::min(alpha, 1.0f));
+		return true;
+	}
+
+  private:
+	mutable std::mutex mutex;
+
+	T previous{};
+
+	T current{};
+
+	Clock::time_point current_time;
+
+	std::chrono::duration<float> current_tick{0.0f};
+
+	bool published{false};
+};
+}        // namespace vkb
@@ -20,6 +20,7 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 
+#include "common/strings.h"
 #include "core/instance.h"
 
 #include "platform/headless_window.h"
@@ -341,7 +342,8 @@ static std::vector<Candidate> find_display_candidates(VkPhysicalDevice phys_dev,
 				}
 
 				if (window_mode == Window::Mode::Fullscreen ||
-				    window_mode == Window::Mode::FullscreenBorderless)
+				    window_mode == Window::Mode::FullscreenBorderless ||
+				    window_mode == Window::Mode::FullscreenExclusive)
 				{
 					// For full-screen modes (where the src image is the same size as the
 					// display) we must also check the src extents are valid.
@@ -403,15 +405,19 @@ VkSurfaceKHR DirectWindow::create_surface(VkInstance instance, VkPhysicalDevice
 
 	const Candidate &best = candidates[best_candidate];
 
+	display = best.display;
+
 	// Get the full display mode extent
 	full_extent.width  = best.mode.parameters.visibleRegion.width;
 	full_extent.height = best.mode.parameters.visibleRegion.height;
 
 	VkExtent2D image_extent;
 	if (properties.mode == Window::Mode::Fullscreen ||
-	    properties.mode == Window::Mode::FullscreenBorderless)
+	    properties.mode == Window::Mode::FullscreenBorderless ||
+	    properties.mode == Window::Mode::FullscreenExclusive)
 	{
-		// Fullscreen & Borderless options create a surface that matches the display size
+		// Fullscreen, Borderless & Exclusive options create a surface that matches the display size
+		// (the display plane is always owned exclusively, there is no compositor to bypass)
 		image_extent.width  = full_extent.width;
 		image_extent.height = full_extent.height;
 	}
@@ -511,6 +517,32 @@ bool DirectWindow::get_display_present_info(VkDisplayPresentInfoKHR *info,
 	return true;
 }
 
+bool DirectWindow::wait_for_vblank(VkDevice device)
+{
+	if (display == VK_NULL_HANDLE)
+	{
+		return false;
+	}
+
+	// The fence is signaled when the first pixel of the next refresh leaves the display engine
+	VkDisplayEventInfoEXT event_info{VK_STRUCTURE_TYPE_DISPLAY_EVENT_INFO_EXT};
+	event_info.displayEvent = VK_DISPLAY_EVENT_TYPE_FIRST_PIXEL_OUT_EXT;
+
+	VkFence  fence{VK_NULL_HANDLE};
+	VkResult result = vkRegisterDisplayEventEXT(device, display, &event_info, nullptr, &fence);
+	if (result != VK_SUCCESS)
+	{
+		LOGW("Direct-to-display: Cannot register a display event: {}", vkb::to_string(result));
+		display = VK_NULL_HANDLE;
+		return false;
+	}
+
+	result = vkWaitForFences(device, 1, &fence, VK_TRUE, vblank_timeout.count());
+	vkDestroyFence(device, fence, nullptr);
+
+	return result == VK_SUCCESS;
+}
+
 std::vector<const char *> DirectWindow::get_required_surface_extensions() const
 {
 	return {VK_KHR_DISPLAY_EXTENSION_NAME};
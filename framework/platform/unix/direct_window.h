@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <termios.h>
 #include <unistd.h>
 #include <vector>
@@ -52,6 +53,13 @@ class DirectWindow : public Window
 
 	float get_dpi_factor() const override;
 
+	/**
+	 * @brief Waits for the next vertical blanking of the display the surface was created on
+	 *        Registers a first-pixel-out display event with VK_EXT_display_control and waits for its fence.
+	 *        Stops waiting for good after the first failure to register the event.
+	 */
+	bool wait_for_vblank(VkDevice device) override;
+
 	std::vector<const char *> get_required_surface_extensions() const override;
 
   private:
@@ -66,5 +74,11 @@ class DirectWindow : public Window
 	struct termios termio_prev;
 	KeyCode        key_down = KeyCode::Unknown;
 	Extent         full_extent{};
+
+	/// The display the surface was created on, VK_NULL_HANDLE if it can't signal its refreshes
+	VkDisplayKHR display{VK_NULL_HANDLE};
+
+	/// Bounds the wait when the display stops refreshing, e.g. when it is turned off
+	static constexpr std::chrono::nanoseconds vblank_timeout{std::chrono::milliseconds{100}};
 };
 }        // namespace vkb
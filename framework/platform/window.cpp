@@ -62,4 +62,14 @@ bool Window::get_display_present_info(VkDisplayPresentInfoKHR *info,
 	// Default is to not use the extra present info
 	return false;
 }
+
+void *Window::get_full_screen_exclusive_monitor() const
+{
+	return nullptr;
+}
+
+bool Window::wait_for_vblank(VkDevice device)
+{
+	return false;
+}
 }        // namespace vkb
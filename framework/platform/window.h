@@ -44,9 +44,11 @@ class Window
 	enum class Mode
 	{
 		Headless,
+		Offscreen,
 		Fullscreen,
 		FullscreenBorderless,
 		FullscreenStretch,
+		FullscreenExclusive,
 		Default
 	};
 
@@ -143,6 +145,25 @@ class Window
 	virtual bool get_display_present_info(VkDisplayPresentInfoKHR *info,
 	                                      uint32_t src_width, uint32_t src_height) const;
 
+	/**
+	 * @brief Get the monitor a swapchain of the window takes exclusive ownership of
+	 *
+	 * The swapchain acquires the full-screen exclusive mode of VK_EXT_full_screen_exclusive on it,
+	 * bypassing the compositor.
+	 *
+	 * @return The HMONITOR of the window on Windows if it requested the FullscreenExclusive mode, nullptr otherwise
+	 */
+	virtual void *get_full_screen_exclusive_monitor() const;
+
+	/**
+	 * @brief Waits for the next vertical blanking of the display, for windows presenting directly to it
+	 *
+	 * @param device A device with VK_EXT_display_control enabled
+	 * @return true if the wait ended on the vertical blanking
+	 * @return false if the window can't tell when the display refreshes
+	 */
+	virtual bool wait_for_vblank(VkDevice device);
+
 	virtual std::vector<const char *> get_required_surface_extensions() const = 0;
 
 	const Extent &get_extent() const;
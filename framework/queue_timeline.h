@@ -1,4 +1,4 @@
-/* Copyright (c) 2023, NVIDIA CORPORATION. All rights reserved.
+/* Copyright (c) 2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -17,24 +17,23 @@
 
 #pragma once
 
-#include "resource_replay.h"
+#include "common/vk_common.h"
 
 namespace vkb
 {
-class HPPResourceCache;
-class HPPResourceRecord;
-
 /**
- * @brief facade class around vkb::ResourceReplay, providing a vulkan.hpp-based interface
+ * @brief A timeline semaphore signaled by the submissions to a queue
  *
- * See vkb::ResourceReplay for documentation
+ * Each submission signals the next value, so a single value tells whether all the work
+ * submitted to the queue up to that submission has completed.
  */
-class HPPResourceReplay : private vkb::ResourceReplay
+struct QueueTimeline
 {
-  public:
-	void play(vkb::HPPResourceCache &resource_cache, vkb::HPPResourceRecord &recorder)
-	{
-		vkb::ResourceReplay::play(reinterpret_cast<vkb::ResourceCache &>(resource_cache), reinterpret_cast<vkb::ResourceRecord &>(recorder));
-	}
+	VkQueue queue{VK_NULL_HANDLE};
+
+	VkSemaphore semaphore{VK_NULL_HANDLE};
+
+	/// Value signaled by the last submission
+	uint64_t value{0};
 };
 }        // namespace vkb
@@ -17,39 +17,52 @@
 
 #include "RenderFrame.h"
 
+#include <algorithm>
+
 #include "common/utils.h"
 #include "core/util/logging.hpp"
+#include "core/util/profiling.hpp"
 
 namespace vkb
 {
 
-RenderFrame::RenderFrame(Device& device, std::unique_ptr<RenderTarget>&& renderTarget, size_t threadCount) 
+RenderFrame::RenderFrame(Device& device, std::unique_ptr<RenderTarget>&& renderTarget, size_t threadCount, std::shared_ptr<BufferRingSet> bufferRings) 
 	: m_device{ device }
 	, m_fencePool{ device }
 	, m_semaphorePool{ device }
 	, m_swapchainRenderTarget{ std::move(renderTarget) }
 	, m_threadCount{ threadCount }
+	, m_bufferRings{ std::move(bufferRings) }
 {
-	for (auto& usageIt : supportedUsageMap)
+	m_bufferPools.reserve(SUPPORTED_USAGES.size() * threadCount);
+	for (auto& supportedUsage : SUPPORTED_USAGES)
 	{
-		std::vector<std::pair<BufferPoolC, BufferBlockC*>> usageBufferPools;
 		for (size_t i = 0; i < threadCount; ++i)
 		{
-			usageBufferPools.push_back(std::make_pair(BufferPoolC{ device, BUFFER_POOL_BLOCK_SIZE * 1024 * usageIt.second, usageIt.first }, nullptr));
+			m_bufferPools.push_back(std::make_pair(BufferPoolC{ device, BUFFER_POOL_BLOCK_SIZE * 1024 * supportedUsage.blockSizeMultiplier, supportedUsage.usage }, nullptr));
 		}
+	}
 
-		auto resInsIt = m_bufferPools.emplace(usageIt.first, std::move(usageBufferPools));
-
-		if (!resInsIt.second)
-		{
-			throw std::runtime_error("Failed to insert buffer pool");
-		}
+	// Every thread gets a pool per queue family up front, so requesting a command buffer is an index lookup
+	m_commandPools.resize(device.get_gpu().get_queue_family_properties().size());
+	for (uint32_t queueFamilyIndex = 0; queueFamilyIndex < m_commandPools.size(); ++queueFamilyIndex)
+	{
+		CreateCommandPools(queueFamilyIndex, CommandBuffer::ResetMode::ResetPool);
 	}
 
 	for (size_t i = 0; i < threadCount; ++i)
 	{
 		m_descriptorPools.push_back(std::make_unique<std::unordered_map<std::size_t, DescriptorPool>>());
 		m_descriptorSets.push_back(std::make_unique<std::unordered_map<std::size_t, DescriptorSet>>());
+		m_linearDescriptorPools.push_back(std::make_unique<LinearDescriptorPool>(device));
+		m_frameArenas.push_back(std::make_unique<FrameArena>());
+		m_descriptorSetAges.push_back(std::make_unique<FrameDescriptorSetAges>());
+	}
+
+	// Layouts created for descriptor buffers can't be allocated from descriptor pools
+	if (device.uses_descriptor_buffers())
+	{
+		m_descriptorManagementStrategy = DescriptorManagementStrategy::DescriptorBuffer;
 	}
 }
 
@@ -62,78 +75,130 @@ Device& RenderFrame::GetDevice()
 
 void RenderFrame::UpdateRenderTarget(std::unique_ptr<RenderTarget>&& renderTarget)
 {
+	if (m_swapchainRenderTarget)
+	{
+		m_device.get_deferred_destruction_queue().retire(std::move(m_swapchainRenderTarget));
+	}
 	m_swapchainRenderTarget = std::move(renderTarget);
 }
 
+std::unique_ptr<RenderTarget> RenderFrame::ReleaseRenderTarget()
+{
+	return std::move(m_swapchainRenderTarget);
+}
 
-void RenderFrame::Reset()
+
+void RenderFrame::Wait()
 {
 	VK_CHECK(m_fencePool.wait());
 
+	if (!m_timelineWaits.empty())
+	{
+		std::vector<VkSemaphore> semaphores;
+		std::vector<uint64_t> values;
+		for (auto& wait : m_timelineWaits)
+		{
+			semaphores.push_back(wait.semaphore);
+			values.push_back(wait.value);
+		}
+
+		VkSemaphoreWaitInfoKHR waitInfo{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR};
+		waitInfo.semaphoreCount = to_u32(semaphores.size());
+		waitInfo.pSemaphores = semaphores.data();
+		waitInfo.pValues = values.data();
+		VK_CHECK(vkWaitSemaphoresKHR(m_device.get_handle(), &waitInfo, std::numeric_limits<uint64_t>::max()));
+	}
+}
+
+void RenderFrame::Reset()
+{
+	Wait();
+
 	m_fencePool.reset();
 
+	m_timelineWaits.clear();
+
 	for (auto& commandPoolsPerQueue : m_commandPools)
 	{
-		for (auto& commandPool : commandPoolsPerQueue.second)
+		for (auto& commandPool : commandPoolsPerQueue)
 		{
 			commandPool->reset_pool();
 		}
 	}
 
-	for (auto& bufferPoolsPerUsage : m_bufferPools)
+	// Usage of the pools by the previous use of the frame, before they are reset
+	VkDeviceSize bufferPoolUsedSize{ 0 };
+	VkDeviceSize bufferPoolSize{ 0 };
+
+	for (auto& bufferPool : m_bufferPools)
 	{
-		for (auto& bufferPool : bufferPoolsPerUsage.second)
-		{
-			bufferPool.first.reset();
-			bufferPool.second = nullptr;
-		}
+		bufferPoolUsedSize += bufferPool.first.get_used_size();
+		bufferPoolSize += bufferPool.first.get_size();
+
+		bufferPool.first.reset();
+		bufferPool.second = nullptr;
+	}
+
+	Plot<int64_t, PlotType::Memory>::plot("Frame Buffer Pool Usage", static_cast<int64_t>(bufferPoolUsedSize));
+	Plot<int64_t, PlotType::Memory>::plot("Frame Buffer Pool Size", static_cast<int64_t>(bufferPoolSize));
+
+	if (m_bufferRings)
+	{
+		// The fence has been waited on, the GPU is done with the ring memory of this frame
+		m_bufferRings->release(this);
 	}
 
 	m_semaphorePool.reset();
 
+	size_t frameArenaUsedSize{ 0 };
+	for (auto& frameArena : m_frameArenas)
+	{
+		frameArenaUsedSize += frameArena->get_used_size();
+		frameArena->reset();
+	}
+
+	Plot<int64_t, PlotType::Memory>::plot("Frame Arena Usage", static_cast<int64_t>(frameArenaUsedSize));
+
 	if (m_descriptorManagementStrategy == vkb::DescriptorManagementStrategy::CreateDirectly)
 	{
 		ClearDescriptors();
 	}
+	else if (m_descriptorSetBudget > 0)
+	{
+		// The fence has been waited on, the GPU is done with the descriptor sets of the frame
+		TrimDescriptorSets();
+	}
+
+	++m_resetCount;
 }
 
 
-std::vector<std::unique_ptr<CommandPool>>& RenderFrame::GetCommandPools(const Queue& queue, CommandBuffer::ResetMode resetMode)
+void RenderFrame::CreateCommandPools(uint32_t queueFamilyIndex, CommandBuffer::ResetMode resetMode)
 {
-	auto commandPoolIt = m_commandPools.find(queue.get_family_index());
+	auto& queueCommandPools = m_commandPools[queueFamilyIndex];
 
-	if (commandPoolIt != m_commandPools.end())
-	{
-		assert(!commandPoolIt->second.empty());
-		if (commandPoolIt->second[0]->get_reset_mode() != resetMode)
-		{
-			m_device.wait_idle();
-
-			// Delete pools
-			m_commandPools.erase(commandPoolIt);
-		}
-		else
-		{
-			return commandPoolIt->second;
-		}
-	}
-
-	std::vector<std::unique_ptr<CommandPool>> queueCommandPools;
+	queueCommandPools.clear();
+	queueCommandPools.reserve(m_threadCount);
 	for (size_t i = 0; i < m_threadCount; i++)
 	{
-		queueCommandPools.push_back(std::make_unique<CommandPool>(m_device, queue.get_family_index(), this, i, resetMode));
+		queueCommandPools.push_back(std::make_unique<CommandPool>(m_device, queueFamilyIndex, this, i, resetMode));
 	}
+}
+
 
-	auto resInsIt = m_commandPools.emplace(queue.get_family_index(), std::move(queueCommandPools));
+std::vector<std::unique_ptr<CommandPool>>& RenderFrame::GetCommandPools(const Queue& queue, CommandBuffer::ResetMode resetMode)
+{
+	assert(queue.get_family_index() < m_commandPools.size());
+	auto& queueCommandPools = m_commandPools[queue.get_family_index()];
 
-	if (!resInsIt.second)
+	if (queueCommandPools[0]->get_reset_mode() != resetMode)
 	{
-		throw std::runtime_error("Failed to insert command pool");
-	}
+		m_device.wait_idle();
 
-	commandPoolIt = resInsIt.first;
+		CreateCommandPools(queue.get_family_index(), resetMode);
+	}
 
-	return commandPoolIt->second;
+	return queueCommandPools;
 }
 
 
@@ -173,6 +238,20 @@ VkFence RenderFrame::RequestFence()
 }
 
 
+void RenderFrame::AddTimelineWait(const QueueTimeline& timeline)
+{
+	auto it = std::find_if(m_timelineWaits.begin(), m_timelineWaits.end(), [&timeline](const QueueTimeline& wait) { return wait.semaphore == timeline.semaphore; });
+	if (it == m_timelineWaits.end())
+	{
+		m_timelineWaits.push_back(timeline);
+	}
+	else
+	{
+		it->value = std::max(it->value, timeline.value);
+	}
+}
+
+
 const SemaphorePool& RenderFrame::GetSemaphorePool() const
 {
 	return m_semaphorePool;
@@ -215,9 +294,8 @@ CommandBuffer& RenderFrame::RequestCommandBuffer(const Queue& queue, CommandBuff
 
 	auto& commandPools = GetCommandPools(queue, resetMode);
 
-	auto commandPoolIt = std::find_if(commandPools.begin(), commandPools.end(), [&threadIndex](std::unique_ptr<CommandPool>& cmdPool) { return cmdPool->get_thread_index() == threadIndex; });
-
-	return (*commandPoolIt)->request_command_buffer(level);
+	// Pools are stored in thread order, each thread only touches its own
+	return commandPools[threadIndex]->request_command_buffer(level);
 }
 
 
@@ -225,10 +303,21 @@ VkDescriptorSet RenderFrame::RequestDescriptorSet(const DescriptorSetLayout& des
 {
 	assert(threadIndex < m_threadCount && "Thread index is out of bounds");
 
-	assert(threadIndex < m_descriptorPools.size());
-	auto& descriptorPool = request_resource(m_device, nullptr, *m_descriptorPools[threadIndex], descriptorSetLayout);
 	if (m_descriptorManagementStrategy == DescriptorManagementStrategy::StoreInCache)
 	{
+		assert(threadIndex < m_descriptorPools.size());
+		auto& threadDescriptorPools = *m_descriptorPools[threadIndex];
+		auto& resourceCache         = m_device.get_resource_cache();
+
+		size_t poolCount     = threadDescriptorPools.size();
+		auto& descriptorPool = request_resource(m_device, nullptr, threadDescriptorPools, descriptorSetLayout);
+		if (threadDescriptorPools.size() != poolCount)
+		{
+			// Created at the size the layout peaked at, recorded earlier in the session or restored by the warmup
+			descriptorPool.SetFreeDescriptorSets(m_descriptorSetBudget > 0);
+			descriptorPool.Reserve(resourceCache.GetDescriptorSetPeak(descriptorSetLayout));
+		}
+
 		// The bindings we want to update before binding, if empty we update all bindings
 		std::vector<uint32_t> bindingsToUpdate;
 		// If update after bind is enabled, we store the binding index of each binding that need to be updated before being bound
@@ -239,20 +328,61 @@ VkDescriptorSet RenderFrame::RequestDescriptorSet(const DescriptorSetLayout& des
 
 		// Request a descriptor set from the render frame, and write the buffer infos and image infos of all the specified bindings
 		assert(threadIndex < m_descriptorSets.size());
-		auto& descriptorSet = request_resource(m_device, nullptr, *m_descriptorSets[threadIndex], descriptorSetLayout, descriptorPool, bufferInfos, imageInfos);
+		auto& threadDescriptorSets = *m_descriptorSets[threadIndex];
+		auto& threadAges           = *m_descriptorSetAges[threadIndex];
+
+		size_t cachedCount = threadDescriptorSets.size();
+		auto& descriptorSet = request_resource(m_device, nullptr, threadDescriptorSets, descriptorSetLayout, descriptorPool, bufferInfos, imageInfos);
+		if (threadDescriptorSets.size() == cachedCount)
+		{
+			++threadAges.counters.hits;
+		}
+		else
+		{
+			++threadAges.counters.misses;
+			resourceCache.RecordDescriptorSetPeak(descriptorSetLayout, descriptorPool.GetPeakSetCount());
+		}
+
+		if (m_descriptorSetBudget > 0)
+		{
+			std::size_t key{ 0U };
+			hash_param(key, descriptorSetLayout, descriptorPool, bufferInfos, imageInfos);
+			threadAges.lastUses[key] = m_resetCount;
+		}
+
 		descriptorSet.Update(bindingsToUpdate);
 		return descriptorSet.GetHandle();
 	}
 	else
 	{
-		// Request a descriptor pool, allocate a descriptor set, write buffer and image data to it
-		DescriptorSet descriptorSet{ m_device, descriptorSetLayout, descriptorPool, bufferInfos, imageInfos };
+		// Allocate a descriptor set from the linear pools of the thread, write buffer and image data to it
+		assert(threadIndex < m_linearDescriptorPools.size());
+		auto handle = m_linearDescriptorPools[threadIndex]->Allocate(descriptorSetLayout);
+
+		DescriptorSet descriptorSet{ m_device, descriptorSetLayout, handle, bufferInfos, imageInfos };
 		descriptorSet.ApplyWrites();
 		return descriptorSet.GetHandle();
 	}
 }
 
 
+BufferAllocationC RenderFrame::RequestDescriptorBuffer(const DescriptorSetLayout& descriptorSetLayout, const BindingMap<VkDescriptorBufferInfo>& bufferInfos, const BindingMap<VkDescriptorImageInfo>& imageInfos, size_t threadIndex)
+{
+	assert(m_descriptorManagementStrategy == DescriptorManagementStrategy::DescriptorBuffer && descriptorSetLayout.IsDescriptorBuffer());
+
+	// Descriptors are written in place, the memory is reclaimed with the buffer pools when the frame is reset
+	auto allocation = AllocateBuffer(DESCRIPTOR_BUFFER_USAGE, descriptorSetLayout.GetDescriptorBufferSize(), threadIndex);
+
+	if (auto data = allocation.map<uint8_t>(0, descriptorSetLayout.GetDescriptorBufferSize()))
+	{
+		descriptorSetLayout.WriteDescriptorBuffer(bufferInfos, imageInfos, data);
+		allocation.flush();
+	}
+
+	return allocation;
+}
+
+
 void RenderFrame::UpdateDescriptorSets(size_t threadIndex)
 {
 	assert(threadIndex < m_descriptorSets.size());
@@ -264,6 +394,13 @@ void RenderFrame::UpdateDescriptorSets(size_t threadIndex)
 }
 
 
+FrameArena& RenderFrame::GetFrameArena(size_t threadIndex)
+{
+	assert(threadIndex < m_frameArenas.size() && "Thread index is out of bounds");
+	return *m_frameArenas[threadIndex];
+}
+
+
 void RenderFrame::ClearDescriptors()
 {
 	for (auto& descSetsPerThread : m_descriptorSets)
@@ -278,6 +415,126 @@ void RenderFrame::ClearDescriptors()
 			descPool.second.Reset();
 		}
 	}
+
+	for (auto& linearDescPool : m_linearDescriptorPools)
+	{
+		linearDescPool->Reset();
+	}
+
+	for (auto& threadAges : m_descriptorSetAges)
+	{
+		threadAges->lastUses.clear();
+	}
+}
+
+
+void RenderFrame::ClearBufferPools()
+{
+	ClearDescriptors();
+
+	for (auto& bufferPool : m_bufferPools)
+	{
+		bufferPool.first.clear();
+		bufferPool.second = nullptr;
+	}
+}
+
+
+void RenderFrame::SetDescriptorSetBudget(size_t budget)
+{
+	m_descriptorSetBudget = budget;
+
+	// The sets cached so far are aged from now on
+	for (size_t threadIndex = 0; threadIndex < m_descriptorSets.size(); ++threadIndex)
+	{
+		// Only the pools created from now on allow freeing their sets
+		for (auto& descriptorPoolIt : *m_descriptorPools[threadIndex])
+		{
+			descriptorPoolIt.second.SetFreeDescriptorSets(budget > 0);
+		}
+
+		auto& lastUses = m_descriptorSetAges[threadIndex]->lastUses;
+		lastUses.clear();
+		if (budget > 0)
+		{
+			for (auto& descriptorSetIt : *m_descriptorSets[threadIndex])
+			{
+				lastUses[descriptorSetIt.first] = m_resetCount;
+			}
+		}
+	}
+}
+
+
+ResourceCacheCounters RenderFrame::GetDescriptorSetCounters() const
+{
+	ResourceCacheCounters counters;
+
+	for (auto& threadAges : m_descriptorSetAges)
+	{
+		counters.hits += threadAges->counters.hits;
+		counters.misses += threadAges->counters.misses;
+		counters.evictions += threadAges->counters.evictions;
+	}
+
+	return counters;
+}
+
+
+void RenderFrame::TrimDescriptorSets()
+{
+	for (size_t threadIndex = 0; threadIndex < m_descriptorSets.size(); ++threadIndex)
+	{
+		auto& threadDescriptorSets = *m_descriptorSets[threadIndex];
+		auto& threadAges           = *m_descriptorSetAges[threadIndex];
+
+		if (threadDescriptorSets.size() <= m_descriptorSetBudget)
+		{
+			continue;
+		}
+
+		// The sets requested by the previous use of the frame are likely requested again
+		std::vector<std::pair<uint64_t, std::size_t>> candidates;
+		for (auto& [key, lastUse] : threadAges.lastUses)
+		{
+			if (lastUse < m_resetCount)
+			{
+				candidates.emplace_back(lastUse, key);
+			}
+		}
+
+		size_t count = std::min(threadDescriptorSets.size() - m_descriptorSetBudget, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			auto descriptorSetIt = threadDescriptorSets.find(candidates[i].second);
+			if (descriptorSetIt != threadDescriptorSets.end())
+			{
+				descriptorSetIt->second.Free();
+				threadDescriptorSets.erase(descriptorSetIt);
+			}
+			threadAges.lastUses.erase(candidates[i].second);
+		}
+
+		threadAges.counters.evictions += count;
+	}
+}
+
+
+LinearDescriptorPoolStats RenderFrame::GetLinearDescriptorPoolStats() const
+{
+	LinearDescriptorPoolStats stats;
+
+	for (auto& linearDescPool : m_linearDescriptorPools)
+	{
+		auto& threadStats = linearDescPool->GetStats();
+		stats.poolCount += threadStats.poolCount;
+		stats.setCount += threadStats.setCount;
+		stats.peakSetCount += threadStats.peakSetCount;
+	}
+
+	return stats;
 }
 
 
@@ -289,25 +546,50 @@ void RenderFrame::SetBufferAllocationStrategy(BufferAllocationStrategy newStrate
 
 void RenderFrame::SetDescriptorManagementStrategy(DescriptorManagementStrategy newStrategy)
 {
+	if ((newStrategy == DescriptorManagementStrategy::DescriptorBuffer) != m_device.uses_descriptor_buffers())
+	{
+		throw std::runtime_error("The descriptor buffer strategy is required, and only allowed, when the device uses descriptor buffers");
+	}
+
 	m_descriptorManagementStrategy = newStrategy;
 }
 
 
+DescriptorManagementStrategy RenderFrame::GetDescriptorManagementStrategy() const
+{
+	return m_descriptorManagementStrategy;
+}
+
+
 BufferAllocationC RenderFrame::AllocateBuffer(const VkBufferUsageFlags usage, const VkDeviceSize size, size_t threadIndex)
 {
+	PROFILE_SCOPE("Allocate Buffer");
+
 	assert(threadIndex < m_threadCount && "Thread index is out of bounds");
 
 	// Find a pool for this usage
-	auto bufferPoolIt = m_bufferPools.find(usage);
-	if (bufferPoolIt == m_bufferPools.end())
+	auto usageIndex = GetUsageIndex(usage);
+	if (usageIndex == SUPPORTED_USAGES.size())
 	{
 		LOGE("No buffer pool for buffer usage {}", usage);
 		return BufferAllocationC{};
 	}
 
-	assert(threadIndex < bufferPoolIt->second.size());
-	auto& bufferPool  = bufferPoolIt->second[threadIndex].first;
-	auto& bufferBlock = bufferPoolIt->second[threadIndex].second;
+	// The rings don't know about the offset alignment of descriptor buffers, those always come from the frame pools
+	if (m_bufferAllocationStrategy == BufferAllocationStrategy::RingBuffer && m_bufferRings && usage != DESCRIPTOR_BUFFER_USAGE)
+	{
+		auto blockSize  = BUFFER_POOL_BLOCK_SIZE * 1024 * SUPPORTED_USAGES[usageIndex].blockSizeMultiplier;
+		auto allocation = m_bufferRings->get_ring(usage, blockSize).allocate(this, size);
+		if (!allocation.empty())
+		{
+			return allocation;
+		}
+
+		LOGW_THROTTLED("Buffer ring for usage {} is full, falling back to the frame buffer pool", usage);
+	}
+
+	auto& bufferPool  = m_bufferPools[usageIndex * m_threadCount + threadIndex].first;
+	auto& bufferBlock = m_bufferPools[usageIndex * m_threadCount + threadIndex].second;
 
 	bool wantMinimalBlock = m_bufferAllocationStrategy == BufferAllocationStrategy::OneAllocationPerBuffer;
 
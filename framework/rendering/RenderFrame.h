@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include <array>
+
 #include "buffer_pool.h"
+#include "buffer_ring.h"
 #include "common/helpers.h"
 #include "common/resource_caching.h"
 #include "common/vk_common.h"
@@ -25,10 +28,13 @@
 #include "core/command_buffer.h"
 #include "core/command_pool.h"
 #include "core/device.h"
+#include "core/LinearDescriptorPool.h"
 #include "core/image.h"
 #include "core/query_pool.h"
 #include "core/queue.h"
 #include "fence_pool.h"
+#include "frame_arena.h"
+#include "queue_timeline.h"
 #include "rendering/render_target.h"
 #include "semaphore_pool.h"
 
@@ -37,13 +43,29 @@ namespace vkb
 enum BufferAllocationStrategy
 {
 	OneAllocationPerBuffer,
-	MultipleAllocationsPerBuffer
+	MultipleAllocationsPerBuffer,
+	/// Sub-allocate from persistently mapped rings shared by all frames in flight
+	RingBuffer
 };
 
 enum DescriptorManagementStrategy
 {
 	StoreInCache,
-	CreateDirectly
+	/// Allocate new descriptor sets at every request from linear pools, reset when the frame is reset
+	CreateDirectly,
+	/// Write descriptors into per-frame descriptor buffers, used when the device uses descriptor buffers
+	DescriptorBuffer
+};
+
+/**
+ * @brief Ages and lookup counters of the descriptor sets a thread caches in a frame, see RenderFrame::SetDescriptorSetBudget
+ */
+struct FrameDescriptorSetAges
+{
+	/// Reset count of the frame at the last request of each set, only tracked with a budget
+	std::unordered_map<std::size_t, uint64_t> lastUses;
+
+	ResourceCacheCounters counters;
 };
 
 /**
@@ -67,14 +89,49 @@ class RenderFrame
 	 */
 	static constexpr uint32_t BUFFER_POOL_BLOCK_SIZE = 256;
 
-	// A map of the supported usages to a multiplier for the BUFFER_POOL_BLOCK_SIZE
-	const std::unordered_map<VkBufferUsageFlags, uint32_t> supportedUsageMap = {
+	/**
+	 * @brief Usage of the buffers descriptors are written into with DescriptorManagementStrategy::DescriptorBuffer
+	 */
+	static constexpr VkBufferUsageFlags DESCRIPTOR_BUFFER_USAGE =
+	    VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	/**
+	 * @brief A usage the frame keeps buffer pools for, with a multiplier for the BUFFER_POOL_BLOCK_SIZE
+	 */
+	struct SupportedUsage
+	{
+		VkBufferUsageFlags usage;
+		uint32_t           blockSizeMultiplier;
+	};
+
+	static constexpr std::array<SupportedUsage, 5> SUPPORTED_USAGES = {{
 	    {VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 1},
 	    {VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 2},        // x2 the size of BUFFER_POOL_BLOCK_SIZE since SSBOs are normally much larger than other types of buffers
 	    {VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 1},
-	    {VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 1}};
+	    {VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 1},
+	    {DESCRIPTOR_BUFFER_USAGE, 1}}};
+
+	/**
+	 * @brief Maps a usage to its dense index in SUPPORTED_USAGES, folded at compile time for constant usages
+	 * @return The index of the usage, SUPPORTED_USAGES.size() if the frame has no pools for it
+	 */
+	static constexpr size_t GetUsageIndex(VkBufferUsageFlags usage)
+	{
+		size_t index = 0;
+		while (index < SUPPORTED_USAGES.size() && SUPPORTED_USAGES[index].usage != usage)
+		{
+			++index;
+		}
+		return index;
+	}
 
-	RenderFrame(Device& device, std::unique_ptr<RenderTarget>&& renderTarget, size_t threadCount = 1);
+	/**
+	 * @param device A valid device
+	 * @param renderTarget The swapchain render target of the frame
+	 * @param threadCount The number of threads recording commands for this frame
+	 * @param bufferRings Buffer rings shared with the other frames, required by BufferAllocationStrategy::RingBuffer
+	 */
+	RenderFrame(Device& device, std::unique_ptr<RenderTarget>&& renderTarget, size_t threadCount = 1, std::shared_ptr<BufferRingSet> bufferRings = nullptr);
 
 	RenderFrame(const RenderFrame&) = delete;
 
@@ -84,6 +141,11 @@ class RenderFrame
 
 	RenderFrame& operator=(RenderFrame&&) = delete;
 
+	/**
+	 * @brief Waits for the submissions of the frame to finish, without resetting its resources
+	 */
+	void Wait();
+
 	void Reset();
 
 	Device& GetDevice();
@@ -92,6 +154,12 @@ class RenderFrame
 
 	VkFence RequestFence();
 
+	/**
+	 * @brief Makes the next reset wait for a value of a queue timeline, instead of a fence
+	 * @param timeline The timeline of the queue the frame submitted to, at the value of that submission
+	 */
+	void AddTimelineWait(const QueueTimeline& timeline);
+
 	const SemaphorePool& GetSemaphorePool() const;
 
 	VkSemaphore RequestSemaphore();
@@ -104,6 +172,12 @@ class RenderFrame
 	 */
 	void UpdateRenderTarget(std::unique_ptr<RenderTarget>&& renderTarget);
 
+	/**
+	 * @brief Gives up the render target, to destroy it with the swapchain images it views
+	 *        The frame can't be rendered to until UpdateRenderTarget is called.
+	 */
+	std::unique_ptr<RenderTarget> ReleaseRenderTarget();
+
 	RenderTarget& GetRenderTarget();
 
 	const RenderTarget& GetRenderTargetConst() const;
@@ -129,8 +203,47 @@ class RenderFrame
 	                                       bool updateAfterBind,
 	                                       size_t threadIndex = 0);
 
+	/**
+	 * @brief Writes the descriptors of a set into the descriptor buffer of the frame
+	 * @param descriptorSetLayout A layout created for descriptor buffers
+	 * @param bufferInfos The buffer infos of the set
+	 * @param imageInfos The image infos of the set
+	 * @param threadIndex Index of the buffer pool to be used by the current thread
+	 * @return The range of the descriptor buffer holding the set, to be bound with its offset
+	 */
+	BufferAllocationC RequestDescriptorBuffer(const DescriptorSetLayout& descriptorSetLayout,
+	                                          const BindingMap<VkDescriptorBufferInfo>& bufferInfos,
+	                                          const BindingMap<VkDescriptorImageInfo>& imageInfos,
+	                                          size_t threadIndex = 0);
+
 	void ClearDescriptors();
 
+	/**
+	 * @brief Destroys the blocks of the buffer pools and the descriptors referring to them
+	 *        The next blocks are placed with the current vkb::allocated::Settings. The GPU must be done with the frame.
+	 */
+	void ClearBufferPools();
+
+	/**
+	 * @return Allocation statistics of the linear descriptor pools of all threads,
+	 *         which hold the descriptor sets of DescriptorManagementStrategy::CreateDirectly
+	 */
+	LinearDescriptorPoolStats GetLinearDescriptorPoolStats() const;
+
+	/**
+	 * @brief Limits the number of descriptor sets each thread caches with DescriptorManagementStrategy::StoreInCache
+	 *        When the frame is reset, the least recently requested sets above the budget are freed,
+	 *        except for those requested by the previous use of the frame.
+	 *        Only the pools created with a budget allow freeing their sets, the others keep the slots until they are reset.
+	 * @param budget Maximum number of sets per thread, 0 for no limit
+	 */
+	void SetDescriptorSetBudget(size_t budget);
+
+	/**
+	 * @return Lookup and eviction counters of the cached descriptor sets of all threads
+	 */
+	ResourceCacheCounters GetDescriptorSetCounters() const;
+
 	/**
 	 * @brief Sets a new buffer allocation strategy
 	 * @param new_strategy The new buffer allocation strategy
@@ -139,10 +252,13 @@ class RenderFrame
 
 	/**
 	 * @brief Sets a new descriptor set management strategy
+	 *        DescriptorManagementStrategy::DescriptorBuffer is required, and only allowed, when the device uses descriptor buffers
 	 * @param new_strategy The new descriptor set management strategy
 	 */
 	void SetDescriptorManagementStrategy(DescriptorManagementStrategy newStrategy);
 
+	DescriptorManagementStrategy GetDescriptorManagementStrategy() const;
+
 	/**
 	 * @param usage Usage of the buffer
 	 * @param size Amount of memory required
@@ -156,6 +272,13 @@ class RenderFrame
 	 */
 	void UpdateDescriptorSets(size_t threadIndex = 0);
 
+	/**
+	 * @param threadIndex Index of the thread recording commands
+	 * @return The arena of the thread for allocations which don't outlive the recording of the frame,
+	 *         rewound when the frame is reset
+	 */
+	FrameArena& GetFrameArena(size_t threadIndex = 0);
+
   private:
 	Device& m_device;
 
@@ -168,8 +291,13 @@ class RenderFrame
 	 */
 	std::vector<std::unique_ptr<CommandPool>>& GetCommandPools(const Queue& queue, CommandBuffer::ResetMode resetMode);
 
-	/// Commands pools associated to the frame
-	std::map<uint32_t, std::vector<std::unique_ptr<CommandPool>>> m_commandPools;
+	/**
+	 * @brief (Re)creates the command pools of every thread for a queue family
+	 */
+	void CreateCommandPools(uint32_t queueFamilyIndex, CommandBuffer::ResetMode resetMode);
+
+	/// Commands pools associated to the frame, indexed by queue family then by thread
+	std::vector<std::vector<std::unique_ptr<CommandPool>>> m_commandPools;
 
 	/// Descriptor pools for the frame
 	std::vector<std::unique_ptr<std::unordered_map<std::size_t, DescriptorPool>>> m_descriptorPools;
@@ -188,7 +316,33 @@ class RenderFrame
 	BufferAllocationStrategy m_bufferAllocationStrategy{BufferAllocationStrategy::MultipleAllocationsPerBuffer};
 	DescriptorManagementStrategy m_descriptorManagementStrategy{DescriptorManagementStrategy::StoreInCache};
 
-	std::map<VkBufferUsageFlags, std::vector<std::pair<BufferPoolC, BufferBlockC*>>> m_bufferPools;
+	/// Buffer pools and their current block, indexed by usage index then by thread
+	std::vector<std::pair<BufferPoolC, BufferBlockC*>> m_bufferPools;
+
+	std::shared_ptr<BufferRingSet> m_bufferRings;
+
+	/// Descriptor sets of DescriptorManagementStrategy::CreateDirectly, carved out of a few pools per thread regardless of their layout
+	std::vector<std::unique_ptr<LinearDescriptorPool>> m_linearDescriptorPools;
+
+	/// Highest value of each queue timeline the frame signaled, waited on by the next reset
+	std::vector<QueueTimeline> m_timelineWaits;
+
+	/// CPU memory of the containers used while recording the frame, one arena per thread
+	std::vector<std::unique_ptr<FrameArena>> m_frameArenas;
+
+	/// Ages and counters of the descriptor sets of DescriptorManagementStrategy::StoreInCache, one per thread
+	std::vector<std::unique_ptr<FrameDescriptorSetAges>> m_descriptorSetAges;
+
+	/// Descriptor sets each thread keeps cached, 0 for no limit
+	size_t m_descriptorSetBudget{ 0 };
+
+	/// Number of times the frame was reset, the age of its descriptor sets is counted in
+	uint64_t m_resetCount{ 0 };
+
+	/**
+	 * @brief Frees the least recently requested descriptor sets of the threads above the budget
+	 */
+	void TrimDescriptorSets();
 
 	static std::vector<uint32_t> CollectBindingsToUpdate(const DescriptorSetLayout& descriptorSetLayout, const BindingMap<VkDescriptorBufferInfo>& bufferInfos, const BindingMap<VkDescriptorImageInfo>& imageInfos);
 };
@@ -0,0 +1,318 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/async_compute_scheduler.h"
+
+#include <algorithm>
+#include <array>
+
+#include "core/command_buffer.h"
+#include "core/device.h"
+#include "core/image.h"
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+AsyncComputeScheduler::AsyncComputeScheduler(RenderContext &render_context) :
+    render_context{render_context},
+    graphics_queue{render_context.get_device().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0)},
+    compute_queue{render_context.get_device().get_async_compute_queue()}
+{
+	Device &device = render_context.get_device();
+
+	transfer_ownership = compute_queue.get_family_index() != graphics_queue.get_family_index();
+
+	if (!is_async())
+	{
+		LOGW("No queue can run compute work besides the graphics queue, async compute passes run inline");
+		return;
+	}
+
+	if (compute_queue.get_properties().timestampValidBits == 0 || graphics_queue.get_properties().timestampValidBits == 0)
+	{
+		LOGI("Async compute passes aren't measured, the queues don't support timestamps");
+		return;
+	}
+
+	auto frame_count = to_u32(render_context.get_render_frames().size());
+
+	VkQueryPoolCreateInfo query_pool_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+	query_pool_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	query_pool_info.queryCount = frame_count * QueriesPerFrame;
+	timestamp_pool             = std::make_unique<QueryPool>(device, query_pool_info);
+
+	timestamp_period = device.get_gpu().get_properties().limits.timestampPeriod;
+
+	queries_written.resize(frame_count, false);
+}
+
+const Queue &AsyncComputeScheduler::get_graphics_queue() const
+{
+	return graphics_queue;
+}
+
+const Queue &AsyncComputeScheduler::get_compute_queue() const
+{
+	return compute_queue;
+}
+
+bool AsyncComputeScheduler::is_async() const
+{
+	return compute_queue.get_handle() != graphics_queue.get_handle();
+}
+
+const AsyncComputeScheduler::Timings &AsyncComputeScheduler::get_timings() const
+{
+	return timings;
+}
+
+void AsyncComputeScheduler::submit(const AsyncComputePass &pass)
+{
+	if (!is_async())
+	{
+		submit_inline(pass);
+		return;
+	}
+
+	RenderFrame &frame = render_context.get_active_frame();
+
+	uint32_t frame_index = render_context.get_active_frame_index();
+	bool     measure     = timestamp_pool && frame_index < queries_written.size() && read_timings(frame_index);
+	uint32_t first_query = frame_index * QueriesPerFrame;
+
+	// The stages the graphics work accesses the resources in, where it waits for the pass
+	VkPipelineStageFlags graphics_stages = 0;
+	for (auto &image : pass.images)
+	{
+		graphics_stages |= image.graphics_stages;
+	}
+	for (auto &buffer : pass.buffers)
+	{
+		graphics_stages |= buffer.graphics_stages;
+	}
+	if (graphics_stages == 0)
+	{
+		graphics_stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	}
+
+	// The graphics queue releases the resources once the work submitted so far is done with them
+	VkSemaphore released_semaphore = frame.RequestSemaphore();
+	{
+		auto submission = render_context.begin_submission(graphics_queue);
+		if (transfer_ownership)
+		{
+			auto &command_buffer = frame.RequestCommandBuffer(graphics_queue);
+			command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			record_handover(command_buffer, pass, Handover::ToCompute, Side::Release);
+			command_buffer.end();
+			submission.add_command_buffer(command_buffer.get_handle());
+		}
+		submission.signal(released_semaphore);
+		render_context.submit(submission);
+	}
+
+	VkSemaphore computed_semaphore = frame.RequestSemaphore();
+	{
+		auto &command_buffer = frame.RequestCommandBuffer(compute_queue);
+		command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		if (measure)
+		{
+			command_buffer.reset_query_pool(*timestamp_pool, first_query, 2);
+			command_buffer.write_timestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, *timestamp_pool, first_query);
+		}
+		record_handover(command_buffer, pass, Handover::ToCompute, Side::Acquire);
+		pass.record(command_buffer);
+		if (transfer_ownership)
+		{
+			record_handover(command_buffer, pass, Handover::ToGraphics, Side::Release);
+		}
+		if (measure)
+		{
+			command_buffer.write_timestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, *timestamp_pool, first_query + 1);
+		}
+		command_buffer.end();
+
+		auto submission = render_context.begin_submission(compute_queue);
+		submission.wait(released_semaphore, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		submission.add_command_buffer(command_buffer.get_handle());
+		submission.signal(computed_semaphore);
+		render_context.submit(submission);
+	}
+
+	// The graphics work submitted next waits for the pass, the stall is measured between the two batches
+	{
+		auto submission = render_context.begin_submission(graphics_queue);
+		if (measure)
+		{
+			auto &command_buffer = frame.RequestCommandBuffer(graphics_queue);
+			command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			command_buffer.reset_query_pool(*timestamp_pool, first_query + 2, 2);
+			command_buffer.write_timestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, *timestamp_pool, first_query + 2);
+			command_buffer.end();
+			submission.add_command_buffer(command_buffer.get_handle());
+		}
+
+		submission.wait(computed_semaphore, graphics_stages);
+
+		auto &command_buffer = frame.RequestCommandBuffer(graphics_queue);
+		command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		record_handover(command_buffer, pass, Handover::ToGraphics, Side::Acquire);
+		if (measure)
+		{
+			command_buffer.write_timestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, *timestamp_pool, first_query + 3);
+		}
+		command_buffer.end();
+		submission.add_command_buffer(command_buffer.get_handle());
+
+		render_context.submit(submission);
+	}
+
+	if (measure)
+	{
+		queries_written[frame_index] = true;
+	}
+}
+
+void AsyncComputeScheduler::submit_inline(const AsyncComputePass &pass)
+{
+	auto &command_buffer = render_context.get_active_frame().RequestCommandBuffer(graphics_queue);
+	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	record_handover(command_buffer, pass, Handover::ToCompute, Side::Both);
+	pass.record(command_buffer);
+	record_handover(command_buffer, pass, Handover::ToGraphics, Side::Both);
+	command_buffer.end();
+
+	render_context.submit(graphics_queue, {&command_buffer});
+}
+
+void AsyncComputeScheduler::record_handover(CommandBuffer &command_buffer, const AsyncComputePass &pass, Handover handover, Side side) const
+{
+	bool to_compute = handover == Handover::ToCompute;
+
+	// Without a transfer, the semaphore waited before the acquire already makes the writes visible
+	bool transfer   = transfer_ownership && side != Side::Both;
+	bool src_access = side != Side::Acquire;
+	bool dst_access = side != Side::Release;
+
+	uint32_t src_family = VK_QUEUE_FAMILY_IGNORED;
+	uint32_t dst_family = VK_QUEUE_FAMILY_IGNORED;
+	if (transfer)
+	{
+		src_family = to_compute ? graphics_queue.get_family_index() : compute_queue.get_family_index();
+		dst_family = to_compute ? compute_queue.get_family_index() : graphics_queue.get_family_index();
+	}
+
+	VkPipelineStageFlags src_stages = 0;
+	VkPipelineStageFlags dst_stages = 0;
+
+	std::vector<VkImageMemoryBarrier> image_barriers;
+	for (auto &access : pass.images)
+	{
+		VkImageLayout old_layout = to_compute ? access.graphics_layout : access.compute_layout;
+		VkImageLayout new_layout = to_compute ? access.compute_layout : access.graphics_layout;
+
+		if (!transfer && side == Side::Acquire && old_layout == new_layout)
+		{
+			continue;
+		}
+
+		VkPipelineStageFlags source_stages      = to_compute ? access.graphics_stages : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		VkPipelineStageFlags destination_stages = to_compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : access.graphics_stages;
+
+		VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+		barrier.srcAccessMask       = src_access ? (to_compute ? access.graphics_access : access.compute_access) : 0;
+		barrier.dstAccessMask       = dst_access ? (to_compute ? access.compute_access : access.graphics_access) : 0;
+		barrier.oldLayout           = old_layout;
+		barrier.newLayout           = new_layout;
+		barrier.srcQueueFamilyIndex = src_family;
+		barrier.dstQueueFamilyIndex = dst_family;
+		barrier.image               = access.image->get_handle();
+		barrier.subresourceRange    = access.subresource_range;
+		image_barriers.push_back(barrier);
+
+		// The acquire chains with the semaphore wait on the destination stages
+		src_stages |= src_access ? source_stages : destination_stages;
+		dst_stages |= dst_access ? destination_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	}
+
+	std::vector<VkBufferMemoryBarrier> buffer_barriers;
+	for (auto &access : pass.buffers)
+	{
+		if (!transfer && side == Side::Acquire)
+		{
+			continue;
+		}
+
+		VkPipelineStageFlags source_stages      = to_compute ? access.graphics_stages : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		VkPipelineStageFlags destination_stages = to_compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : access.graphics_stages;
+
+		VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+		barrier.srcAccessMask       = src_access ? (to_compute ? access.graphics_access : access.compute_access) : 0;
+		barrier.dstAccessMask       = dst_access ? (to_compute ? access.compute_access : access.graphics_access) : 0;
+		barrier.srcQueueFamilyIndex = src_family;
+		barrier.dstQueueFamilyIndex = dst_family;
+		barrier.buffer              = access.buffer->get_handle();
+		barrier.offset              = access.offset;
+		barrier.size                = access.size;
+		buffer_barriers.push_back(barrier);
+
+		src_stages |= src_access ? source_stages : destination_stages;
+		dst_stages |= dst_access ? destination_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	}
+
+	if (image_barriers.empty() && buffer_barriers.empty())
+	{
+		return;
+	}
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), src_stages, dst_stages, 0,
+	                     0, nullptr,
+	                     to_u32(buffer_barriers.size()), buffer_barriers.data(),
+	                     to_u32(image_barriers.size()), image_barriers.data());
+}
+
+bool AsyncComputeScheduler::read_timings(uint32_t frame_index)
+{
+	if (!queries_written[frame_index])
+	{
+		return true;
+	}
+
+	std::array<uint64_t, QueriesPerFrame> timestamps{};
+
+	VkResult result = timestamp_pool->get_results(frame_index * QueriesPerFrame, QueriesPerFrame,
+	                                              timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+	                                              VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS)
+	{
+		// An earlier pass of the same frame is still in flight, this one isn't measured
+		return false;
+	}
+
+	auto to_ms = [this](uint64_t begin, uint64_t end) {
+		return end > begin ? static_cast<float>(end - begin) * timestamp_period * 1e-6f : 0.0f;
+	};
+
+	timings.compute_ms        = to_ms(timestamps[0], timestamps[1]);
+	timings.graphics_stall_ms = to_ms(timestamps[2], timestamps[3]);
+	timings.overlap_ms        = std::max(timings.compute_ms - timings.graphics_stall_ms, 0.0f);
+
+	queries_written[frame_index] = false;
+
+	return true;
+}
+}        // namespace vkb
@@ -0,0 +1,207 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/buffer.h"
+#include "core/query_pool.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class Queue;
+class RenderContext;
+
+namespace core
+{
+class Image;
+}        // namespace core
+
+/**
+ * @brief Compute work declared to run asynchronously, concurrently with the graphics work of the frame
+ *
+ * The resources the pass shares with the graphics work are declared with how the graphics work
+ * accesses them before and after the pass, so that the scheduler can hand them over between the queues.
+ */
+struct AsyncComputePass
+{
+	struct ImageAccess
+	{
+		const core::Image *image{nullptr};
+
+		VkImageSubresourceRange subresource_range{VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+
+		/// Layout the graphics work leaves the image in, and expects it back in
+		VkImageLayout graphics_layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+		VkImageLayout compute_layout{VK_IMAGE_LAYOUT_GENERAL};
+
+		/// Stages and accesses of the graphics work before and after the pass
+		VkPipelineStageFlags graphics_stages{VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT};
+
+		VkAccessFlags graphics_access{0};
+
+		VkAccessFlags compute_access{VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+	};
+
+	struct BufferAccess
+	{
+		const core::BufferC *buffer{nullptr};
+
+		VkDeviceSize offset{0};
+
+		VkDeviceSize size{VK_WHOLE_SIZE};
+
+		VkPipelineStageFlags graphics_stages{VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT};
+
+		VkAccessFlags graphics_access{0};
+
+		VkAccessFlags compute_access{VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+	};
+
+	/// Records the dispatches, the resources are in their compute layout and owned by the compute queue
+	std::function<void(CommandBuffer &)> record;
+
+	std::vector<ImageAccess> images;
+
+	std::vector<BufferAccess> buffers;
+};
+
+/**
+ * @brief Runs compute passes on a dedicated compute queue while the graphics queue of a RenderContext keeps working
+ *
+ * The compute queue is a queue of a family without graphics if the device has one, another queue of the
+ * graphics family otherwise, and the graphics queue itself as a last resort, where the passes run inline.
+ *
+ * A pass is submitted in three steps: the graphics queue releases the resources after the work submitted
+ * before it, the compute queue acquires them, runs the pass and releases them, and the graphics queue
+ * acquires them back before the work submitted after it. Queue family ownership transfers are only
+ * recorded between different families, and the queues synchronize with semaphores of the active frame.
+ *
+ * Timestamps measure how long the pass ran, and how long the graphics queue stalled waiting for it.
+ * Timestamps of different queues can't be compared, so the overlap is derived from these two durations.
+ */
+class AsyncComputeScheduler
+{
+  public:
+	struct Timings
+	{
+		/// Time the compute queue spent on the pass
+		float compute_ms{0.0f};
+
+		/// Time the graphics queue waited for the pass once it ran out of work
+		float graphics_stall_ms{0.0f};
+
+		/// Part of the pass hidden behind the graphics work
+		float overlap_ms{0.0f};
+	};
+
+	explicit AsyncComputeScheduler(RenderContext &render_context);
+
+	AsyncComputeScheduler(const AsyncComputeScheduler &) = delete;
+
+	AsyncComputeScheduler(AsyncComputeScheduler &&) = delete;
+
+	~AsyncComputeScheduler() = default;
+
+	AsyncComputeScheduler &operator=(const AsyncComputeScheduler &) = delete;
+
+	AsyncComputeScheduler &operator=(AsyncComputeScheduler &&) = delete;
+
+	const Queue &get_graphics_queue() const;
+
+	const Queue &get_compute_queue() const;
+
+	/**
+	 * @return Whether the passes run on another queue than the graphics one
+	 */
+	bool is_async() const;
+
+	/**
+	 * @brief Runs a pass on the compute queue, between the graphics work submitted before and after the call
+	 *        A frame must be active.
+	 */
+	void submit(const AsyncComputePass &pass);
+
+	/**
+	 * @return The timings of the last measured pass, zero if timestamps aren't supported by both queues
+	 */
+	const Timings &get_timings() const;
+
+  private:
+	/// Queries written per frame: start and end of the pass, end of the graphics work before the acquire, end of the acquire
+	static constexpr uint32_t QueriesPerFrame = 4;
+
+	enum class Handover
+	{
+		/// From the graphics work to the compute pass
+		ToCompute,
+
+		/// From the compute pass back to the graphics work
+		ToGraphics
+	};
+
+	enum class Side
+	{
+		/// Recorded on the queue giving the resources up, only needed for an ownership transfer
+		Release,
+
+		/// Recorded on the queue receiving the resources, after waiting for the release
+		Acquire,
+
+		/// Both halves on the same queue, when the passes run inline
+		Both
+	};
+
+	/**
+	 * @brief Records the barriers handing the resources of a pass over
+	 */
+	void record_handover(CommandBuffer &command_buffer, const AsyncComputePass &pass, Handover handover, Side side) const;
+
+	/**
+	 * @brief Reads the timestamps of the pass last measured in the active frame, if they are available
+	 * @return Whether the queries of the frame can be written again
+	 */
+	bool read_timings(uint32_t frame_index);
+
+	void submit_inline(const AsyncComputePass &pass);
+
+	RenderContext &render_context;
+
+	const Queue &graphics_queue;
+
+	const Queue &compute_queue;
+
+	/// Whether the ownership of the resources is transferred between the queue families
+	bool transfer_ownership{false};
+
+	std::unique_ptr<QueryPool> timestamp_pool;
+
+	float timestamp_period{1.0f};
+
+	/// Whether the queries of each frame were written since they were last read
+	std::vector<bool> queries_written;
+
+	Timings timings;
+};
+}        // namespace vkb
@@ -0,0 +1,126 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/bindless_registry.h"
+
+#include "core/device.h"
+#include "core/image_view.h"
+#include "core/physical_device.h"
+#include "core/sampler.h"
+#include "core/shader_module.h"
+
+namespace vkb
+{
+BindlessRegistry::BindlessRegistry(Device &device) :
+    device{device}
+{
+	if (!device.is_enabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+	{
+		throw std::runtime_error("The bindless registry needs " VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+	}
+
+	if (device.uses_descriptor_buffers())
+	{
+		throw std::runtime_error("The bindless registry does not support descriptor buffers");
+	}
+
+	VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexing_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT};
+
+	VkPhysicalDeviceProperties2KHR properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &indexing_properties;
+	vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+
+	if (indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages < Capacity ||
+	    indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers < Capacity)
+	{
+		throw std::runtime_error("The device does not support " + std::to_string(Capacity) + " update-after-bind textures per stage");
+	}
+
+	// Layout identically defined to the one reflected from the shaders, so the set can be bound with their pipeline layouts
+	ShaderResource resource{};
+	resource.stages     = VK_SHADER_STAGE_ALL;
+	resource.type       = ShaderResourceType::ImageSampler;
+	resource.mode       = ShaderResourceMode::Bindless;
+	resource.set        = SetIndex;
+	resource.binding    = 0;
+	resource.array_size = Capacity;
+	resource.name       = ResourceName;
+
+	descriptor_set_layout = std::make_unique<DescriptorSetLayout>(device, SetIndex, std::vector<ShaderModule *>{}, std::vector<ShaderResource>{resource});
+
+	descriptor_pool = std::make_unique<DescriptorPool>(device, *descriptor_set_layout, 1);
+
+	descriptor_set = descriptor_pool->AllocateDescriptorSet();
+}
+
+uint32_t BindlessRegistry::register_texture(const core::ImageView &image_view, const core::Sampler &sampler)
+{
+	std::lock_guard<std::mutex> guard{texture_mutex};
+
+	auto key = std::make_pair(image_view.get_handle(), sampler.get_handle());
+
+	auto it = texture_indices.find(key);
+	if (it != texture_indices.end())
+	{
+		return it->second;
+	}
+
+	if (texture_indices.size() >= Capacity)
+	{
+		throw std::runtime_error("Bindless texture array is full (" + std::to_string(Capacity) + " textures)");
+	}
+
+	uint32_t index = to_u32(texture_indices.size());
+
+	VkDescriptorImageInfo image_info{};
+	image_info.sampler     = sampler.get_handle();
+	image_info.imageView   = image_view.get_handle();
+	image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+	write.dstSet          = descriptor_set;
+	write.dstBinding      = 0;
+	write.dstArrayElement = index;
+	write.descriptorCount = 1;
+	write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo      = &image_info;
+
+	// Update-after-bind: the element is not used by any recorded draw yet, so the set may be bound
+	vkUpdateDescriptorSets(device.get_handle(), 1, &write, 0, nullptr);
+
+	texture_indices.emplace(key, index);
+
+	return index;
+}
+
+const DescriptorSetLayout &BindlessRegistry::get_descriptor_set_layout() const
+{
+	return *descriptor_set_layout;
+}
+
+VkDescriptorSet BindlessRegistry::get_descriptor_set() const
+{
+	return descriptor_set;
+}
+
+uint32_t BindlessRegistry::get_texture_count() const
+{
+	std::lock_guard<std::mutex> guard{texture_mutex};
+
+	return to_u32(texture_indices.size());
+}
+}        // namespace vkb
@@ -0,0 +1,105 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/DescriptorPool.h"
+#include "core/DescriptorSetLayout.h"
+
+namespace vkb
+{
+class Device;
+
+namespace core
+{
+class ImageView;
+class Sampler;
+}        // namespace core
+
+/**
+ * @brief Global array of combined image samplers indexed by the shaders
+ *
+ * Every registered image view and sampler pair gets a stable index into a single descriptor set,
+ * written once when registered. Shaders declare the array as the "bindless_textures" resource
+ * of set SetIndex with Capacity elements and read the index from push constants, so draws
+ * using different textures share the same descriptor set.
+ *
+ * The array is update-after-bind and partially bound: the device must enable
+ * VK_EXT_descriptor_indexing with descriptorBindingSampledImageUpdateAfterBind and
+ * descriptorBindingPartiallyBound. Descriptor buffers are not supported.
+ */
+class BindlessRegistry
+{
+  public:
+	/// Descriptor set index of the bindless array in the shaders
+	static constexpr uint32_t SetIndex = 1;
+
+	/// Number of elements of the bindless array, defined as BINDLESS_TEXTURE_COUNT in the shaders
+	static constexpr uint32_t Capacity = 4096;
+
+	/// Name of the bindless array in the shaders
+	static constexpr const char *ResourceName = "bindless_textures";
+
+	BindlessRegistry(Device &device);
+
+	BindlessRegistry(const BindlessRegistry &) = delete;
+
+	BindlessRegistry(BindlessRegistry &&) = delete;
+
+	~BindlessRegistry() = default;
+
+	BindlessRegistry &operator=(const BindlessRegistry &) = delete;
+
+	BindlessRegistry &operator=(BindlessRegistry &&) = delete;
+
+	/**
+	 * @brief Returns the index of an image view and sampler pair in the array,
+	 *        writing its descriptor the first time the pair is registered.
+	 *        Thread safe, the descriptor can be written while the set is bound.
+	 * @throws std::runtime_error if the array is full
+	 */
+	uint32_t register_texture(const core::ImageView &image_view, const core::Sampler &sampler);
+
+	const DescriptorSetLayout &get_descriptor_set_layout() const;
+
+	VkDescriptorSet get_descriptor_set() const;
+
+	/**
+	 * @return Number of registered textures
+	 */
+	uint32_t get_texture_count() const;
+
+  private:
+	Device &device;
+
+	std::unique_ptr<DescriptorSetLayout> descriptor_set_layout;
+
+	std::unique_ptr<DescriptorPool> descriptor_pool;
+
+	VkDescriptorSet descriptor_set{VK_NULL_HANDLE};
+
+	std::map<std::pair<VkImageView, VkSampler>, uint32_t> texture_indices;
+
+	mutable std::mutex texture_mutex;
+};
+}        // namespace vkb
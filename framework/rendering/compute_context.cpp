@@ -0,0 +1,182 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/compute_context.h"
+
+#include "core/submission_builder.h"
+#include "core/util/logging.hpp"
+#include "core/util/profiling.hpp"
+
+namespace vkb
+{
+ComputeContext::ComputeContext(Device &device, uint32_t frame_count) :
+    device{device},
+    queue{device.get_compute_queue()}
+{
+	assert(frame_count > 0 && "A compute context needs at least one frame");
+
+	auto synchronization2_features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceSynchronization2FeaturesKHR>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR);
+	synchronization2 = device.is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) && synchronization2_features && synchronization2_features->synchronization2;
+
+	auto timeline_features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceTimelineSemaphoreFeaturesKHR>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR);
+	if (device.is_enabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) && timeline_features && timeline_features->timelineSemaphore)
+	{
+		VkSemaphoreTypeCreateInfoKHR type_info{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR};
+		type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+		type_info.initialValue  = 0;
+
+		VkSemaphoreCreateInfo create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+		create_info.pNext = &type_info;
+
+		timeline.queue = queue.get_handle();
+		VK_CHECK(vkCreateSemaphore(device.get_handle(), &create_info, nullptr, &timeline.semaphore));
+	}
+	else
+	{
+		LOGW("Timeline semaphores need {} and its timelineSemaphore feature, frames are tracked with fences", VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+	}
+
+	for (uint32_t i = 0; i < frame_count; ++i)
+	{
+		frames.emplace_back(std::make_unique<RenderFrame>(device, nullptr));
+	}
+
+	LOGI("Compute context: {} frames on the queue family {}", frame_count, queue.get_family_index());
+}
+
+ComputeContext::~ComputeContext()
+{
+	device.wait_idle();
+
+	if (timeline.semaphore != VK_NULL_HANDLE)
+	{
+		// The retired objects can't be collected once the timeline is gone
+		device.get_deferred_destruction_queue().clear();
+
+		vkDestroySemaphore(device.get_handle(), timeline.semaphore, nullptr);
+	}
+}
+
+CommandBuffer &ComputeContext::begin(CommandBuffer::ResetMode reset_mode)
+{
+	if (!frame_active)
+	{
+		PROFILE_SCOPE("Begin Frame");
+
+		device.get_deferred_destruction_queue().collect();
+		device.get_resource_cache().Trim();
+
+		// Waits for the dispatches submitted with this frame, frame count frames ago
+		get_active_frame().Reset();
+
+		frame_active = true;
+	}
+
+	return get_active_frame().RequestCommandBuffer(queue, reset_mode);
+}
+
+void ComputeContext::submit(CommandBuffer &command_buffer)
+{
+	submit(std::vector<CommandBuffer *>{&command_buffer});
+}
+
+void ComputeContext::submit(const std::vector<CommandBuffer *> &command_buffers)
+{
+	assert(frame_active && "ComputeContext is inactive, cannot submit command buffer. Please call begin()");
+
+	PROFILE_SCOPE("Submit");
+
+	RenderFrame &frame = get_active_frame();
+
+	SubmissionBuilder submission{queue.get_handle(), synchronization2};
+	for (auto *command_buffer : command_buffers)
+	{
+		submission.add_command_buffer(command_buffer->get_handle());
+	}
+
+	if (timeline.semaphore != VK_NULL_HANDLE)
+	{
+		++timeline.value;
+		submission.signal(timeline.semaphore, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR, timeline.value);
+
+		VK_CHECK(submission.submit());
+
+		frame.AddTimelineWait(timeline);
+		device.get_deferred_destruction_queue().track(timeline);
+	}
+	else
+	{
+		VK_CHECK(submission.submit(frame.RequestFence()));
+	}
+
+	++submit_count;
+
+	// The frames are used in turn, like the offscreen frames of a render context
+	frame_active       = false;
+	active_frame_index = (active_frame_index + 1) % to_u32(frames.size());
+}
+
+void ComputeContext::wait_idle()
+{
+	for (auto &frame : frames)
+	{
+		frame->Wait();
+	}
+}
+
+RenderFrame &ComputeContext::get_active_frame()
+{
+	return *frames[active_frame_index];
+}
+
+uint32_t ComputeContext::get_active_frame_index() const
+{
+	return active_frame_index;
+}
+
+uint32_t ComputeContext::get_frame_count() const
+{
+	return to_u32(frames.size());
+}
+
+bool ComputeContext::is_frame_active() const
+{
+	return frame_active;
+}
+
+const Queue &ComputeContext::get_queue() const
+{
+	return queue;
+}
+
+bool ComputeContext::uses_timeline_semaphores() const
+{
+	return timeline.semaphore != VK_NULL_HANDLE;
+}
+
+const QueueTimeline &ComputeContext::get_timeline() const
+{
+	return timeline;
+}
+
+uint64_t ComputeContext::get_submit_count() const
+{
+	return submit_count;
+}
+}        // namespace vkb
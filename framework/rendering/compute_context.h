@@ -0,0 +1,121 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "queue_timeline.h"
+#include "rendering/RenderFrame.h"
+
+namespace vkb
+{
+/**
+ * @brief Per-frame resources and paced submissions for the dispatch loops of compute-only samples
+ *
+ * A RenderContext without a surface, a swapchain or render targets. Each frame is a RenderFrame without a render target,
+ * whose buffer pools, descriptor sets and command pools are reset once the GPU is done with it. The command buffers go
+ * to the compute queue of the device, see Device::get_compute_queue(), so the context also runs on devices without
+ * graphics queues.
+ *
+ * Each submission signals the next value of a timeline semaphore, and a frame is reused once the value of its last
+ * submission is reached, so up to the frame count of dispatch loops are in flight without a fence per submission.
+ * Without VK_KHR_timeline_semaphore and its timelineSemaphore feature the frames are tracked with fences.
+ */
+class ComputeContext
+{
+  public:
+	static constexpr uint32_t DEFAULT_FRAME_COUNT = 3;
+
+	/**
+	 * @param device A valid device
+	 * @param frame_count The number of frames in flight
+	 */
+	ComputeContext(Device &device, uint32_t frame_count = DEFAULT_FRAME_COUNT);
+
+	ComputeContext(const ComputeContext &) = delete;
+
+	ComputeContext(ComputeContext &&) = delete;
+
+	/**
+	 * @brief Waits for the frames in flight
+	 */
+	~ComputeContext();
+
+	ComputeContext &operator=(const ComputeContext &) = delete;
+
+	ComputeContext &operator=(ComputeContext &&) = delete;
+
+	/**
+	 * @brief Waits for the previous submission of the next frame, resets its resources and makes it active
+	 * @return A command buffer of the compute queue from the active frame
+	 */
+	CommandBuffer &begin(CommandBuffer::ResetMode reset_mode = CommandBuffer::ResetMode::ResetPool);
+
+	/**
+	 * @brief Submits the command buffers of the active frame to the compute queue and ends the frame
+	 */
+	void submit(CommandBuffer &command_buffer);
+
+	void submit(const std::vector<CommandBuffer *> &command_buffers);
+
+	/**
+	 * @brief Waits for the submissions of all the frames, without resetting them
+	 */
+	void wait_idle();
+
+	RenderFrame &get_active_frame();
+
+	uint32_t get_active_frame_index() const;
+
+	uint32_t get_frame_count() const;
+
+	bool is_frame_active() const;
+
+	const Queue &get_queue() const;
+
+	bool uses_timeline_semaphores() const;
+
+	/**
+	 * @return The timeline signaled by the submissions, at the value of the last one, empty without timeline semaphores
+	 */
+	const QueueTimeline &get_timeline() const;
+
+	/**
+	 * @return The number of submissions since the context was created
+	 */
+	uint64_t get_submit_count() const;
+
+  private:
+	Device &device;
+
+	const Queue &queue;
+
+	std::vector<std::unique_ptr<RenderFrame>> frames;
+
+	uint32_t active_frame_index{0};
+
+	bool frame_active{false};
+
+	bool synchronization2{false};
+
+	QueueTimeline timeline;
+
+	uint64_t submit_count{0};
+};
+}        // namespace vkb
@@ -0,0 +1,55 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/constant_delivery.h"
+
+#include "core/physical_device.h"
+
+namespace vkb
+{
+ConstantDelivery select_constant_delivery(const PhysicalDevice &gpu, uint32_t size)
+{
+	auto &limits = gpu.get_properties().limits;
+
+	if (size <= limits.maxPushConstantsSize)
+	{
+		return ConstantDelivery::PushConstants;
+	}
+
+	if (limits.maxDescriptorSetUniformBuffersDynamic > 0)
+	{
+		return ConstantDelivery::DynamicUniformBuffer;
+	}
+
+	return ConstantDelivery::UniformBuffer;
+}
+
+std::string to_string(ConstantDelivery delivery)
+{
+	switch (delivery)
+	{
+		case ConstantDelivery::PushConstants:
+			return "push constants";
+		case ConstantDelivery::DynamicUniformBuffer:
+			return "dynamic uniform buffers";
+		case ConstantDelivery::UniformBuffer:
+			return "uniform buffers";
+	}
+
+	return "unknown";
+}
+}        // namespace vkb
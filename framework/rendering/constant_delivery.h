@@ -0,0 +1,50 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace vkb
+{
+class PhysicalDevice;
+
+/**
+ * @brief How the constants of a draw, like its world matrix, reach the shaders
+ */
+enum class ConstantDelivery
+{
+	/// Recorded with the draw, the cheapest when the constants fit in maxPushConstantsSize
+	PushConstants,
+
+	/// Written to the buffer pool of the frame and bound with a dynamic offset, so draws reuse the descriptor set
+	DynamicUniformBuffer,
+
+	/// Written to the buffer pool of the frame and bound with a descriptor set of its own
+	UniformBuffer
+};
+
+/**
+ * @brief Picks the cheapest delivery a device supports for the constants of a draw
+ * @param gpu The device the draws are recorded for
+ * @param size Bytes of constants per draw, the ones already pushed included
+ */
+ConstantDelivery select_constant_delivery(const PhysicalDevice &gpu, uint32_t size);
+
+std::string to_string(ConstantDelivery delivery);
+}        // namespace vkb
@@ -0,0 +1,330 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/allocated.h"
+#include "core/command_buffer.h"
+#include "core/device.h"
+#include "core/image.h"
+#include "core/util/profiling.hpp"
+#include "rendering/postprocessing_renderpass.h"
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+namespace
+{
+VkImageCreateInfo get_image_create_info(const Attachment &attachment, const VkExtent2D &extent)
+{
+	VkImageCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+	create_info.imageType     = VK_IMAGE_TYPE_2D;
+	create_info.format        = attachment.format;
+	create_info.extent        = {extent.width, extent.height, 1};
+	create_info.mipLevels     = 1;
+	create_info.arrayLayers   = 1;
+	create_info.samples       = attachment.samples;
+	create_info.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	create_info.usage         = attachment.usage;
+	create_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+	create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	return create_info;
+}
+}        // namespace
+
+DynamicResolution::DynamicResolution(RenderContext &render_context, std::vector<Attachment> &&attachments, const Config &config) :
+    render_context{render_context},
+    attachments{std::move(attachments)},
+    config{config},
+    scale{config.max_scale}
+{
+	assert(!this->attachments.empty() && "Should specify at least 1 attachment");
+
+	render_context.enable_gpu_frame_timing();
+
+	// Filters the scaled image when it is stretched over the surface
+	VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+	sampler_info.minFilter    = VK_FILTER_LINEAR;
+	sampler_info.magFilter    = VK_FILTER_LINEAR;
+	sampler_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.borderColor  = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+	sampler                   = std::make_unique<core::Sampler>(render_context.get_device(), sampler_info);
+
+	upscale_pipeline = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource{"postprocessing/postprocessing.vert"});
+	upscale_pipeline->add_pass().add_subpass(ShaderSource{"dynamic_resolution/upscale.frag"});
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	destroy_frames();
+}
+
+void DynamicResolution::set_config(const Config &new_config)
+{
+	config = new_config;
+}
+
+const DynamicResolution::Config &DynamicResolution::get_config() const
+{
+	return config;
+}
+
+float DynamicResolution::get_scale() const
+{
+	return frames.empty() ? scale : frames[render_context.get_active_frame_index()].scale;
+}
+
+RenderTarget &DynamicResolution::get_render_target()
+{
+	auto &frame = frames[render_context.get_active_frame_index()];
+	assert(frame.render_target && "The render target of the active frame is created by update()");
+	return *frame.render_target;
+}
+
+void DynamicResolution::update()
+{
+	PROFILE_SCOPE("Dynamic Resolution");
+
+	if (auto gpu_frame_timer = render_context.get_gpu_frame_timer())
+	{
+		// The timer resolves at most one frame per update, when its frame is reused
+		if (gpu_frame_timer->get_resolved_count() != resolved_count)
+		{
+			resolved_count = gpu_frame_timer->get_resolved_count();
+
+			if (skip_count > 0)
+			{
+				--skip_count;
+			}
+			else
+			{
+				time_sum += gpu_frame_timer->get_frame_time();
+				++sample_count;
+			}
+		}
+
+		if (sample_count >= std::max(config.adjust_interval, 1u))
+		{
+			auto new_scale = adjust_scale(time_sum / sample_count);
+			if (new_scale != scale)
+			{
+				LOGD("Dynamic resolution scale changed from {:.2f} to {:.2f}", scale, new_scale);
+
+				// The frames in flight were recorded at the previous scale, their times are resolved next
+				scale      = new_scale;
+				skip_count = to_u32(render_context.get_render_frames().size());
+			}
+
+			time_sum     = 0.0f;
+			sample_count = 0;
+		}
+	}
+
+	scale = std::clamp(scale, config.min_scale, get_max_scale());
+
+	auto &extent = render_context.get_surface_extent();
+	if (frames.size() != render_context.get_render_frames().size() || extent.width != surface_extent.width || extent.height != surface_extent.height)
+	{
+		allocate_frames();
+	}
+
+	// The fence of the active frame was waited for, the GPU is done with its images
+	auto &frame = frames[render_context.get_active_frame_index()];
+	if (frame.scale != scale)
+	{
+		create_target(frame, scale);
+	}
+}
+
+void DynamicResolution::upscale(CommandBuffer &command_buffer, RenderTarget &render_target, uint32_t color_attachment)
+{
+	auto &upscale_subpass = upscale_pipeline->get_pass(0).get_subpass(0);
+	upscale_subpass.bind_sampled_image("color_sampler", core::SampledImage{color_attachment, &get_render_target(), sampler.get()});
+
+	upscale_pipeline->draw(command_buffer, render_target);
+}
+
+float DynamicResolution::adjust_scale(float frame_time) const
+{
+	auto new_scale = scale;
+
+	// The time of the frames is roughly proportional to their pixels, the square of the scale
+	if (frame_time > config.target_frame_time)
+	{
+		new_scale = scale * std::sqrt(config.target_frame_time / frame_time);
+	}
+	else if (frame_time < config.target_frame_time * (1.0f - config.headroom))
+	{
+		new_scale = std::min(scale + config.scale_step, scale * std::sqrt(config.target_frame_time / std::max(frame_time, 0.001f)));
+	}
+
+	// Rounded down, so a frame over the target drops one step at least
+	if (config.scale_step > 0.0f)
+	{
+		new_scale = std::floor(new_scale / config.scale_step + 0.001f) * config.scale_step;
+	}
+
+	return std::clamp(new_scale, config.min_scale, get_max_scale());
+}
+
+float DynamicResolution::get_max_scale() const
+{
+	if (render_context.get_frame_pacer().is_thermal_throttled())
+	{
+		return std::max(std::min(config.max_scale, config.throttled_max_scale), config.min_scale);
+	}
+	return config.max_scale;
+}
+
+VkExtent2D DynamicResolution::get_scaled_extent(float target_scale) const
+{
+	return {std::max(1u, static_cast<uint32_t>(std::round(surface_extent.width * target_scale))),
+	        std::max(1u, static_cast<uint32_t>(std::round(surface_extent.height * target_scale)))};
+}
+
+void DynamicResolution::allocate_frames()
+{
+	auto &device = render_context.get_device();
+
+	// All the frames are replaced, the ones in flight may still render into their images
+	if (!frames.empty())
+	{
+		device.wait_idle();
+		destroy_frames();
+	}
+
+	surface_extent = render_context.get_surface_extent();
+
+	// The images at the maximum scale give the size of each attachment in the allocation
+	auto max_extent = get_scaled_extent(config.max_scale);
+
+	VkMemoryRequirements frame_requirements{};
+	frame_requirements.memoryTypeBits = ~0u;
+
+	std::vector<VkDeviceSize> offsets;
+	std::vector<VkDeviceSize> sizes;
+
+	for (auto &attachment : attachments)
+	{
+		auto create_info = get_image_create_info(attachment, max_extent);
+
+		VkImage handle{VK_NULL_HANDLE};
+		VK_CHECK(vkCreateImage(device.get_handle(), &create_info, nullptr, &handle));
+
+		VkMemoryRequirements requirements{};
+		vkGetImageMemoryRequirements(device.get_handle(), handle, &requirements);
+		vkDestroyImage(device.get_handle(), handle, nullptr);
+
+		auto offset = (frame_requirements.size + requirements.alignment - 1) / requirements.alignment * requirements.alignment;
+		offsets.push_back(offset);
+		sizes.push_back(requirements.size);
+
+		frame_requirements.size           = offset + requirements.size;
+		frame_requirements.alignment      = std::max(frame_requirements.alignment, requirements.alignment);
+		frame_requirements.memoryTypeBits &= requirements.memoryTypeBits;
+	}
+
+	if (frame_requirements.memoryTypeBits == 0)
+	{
+		throw std::runtime_error("The attachments of the dynamic resolution targets have no memory type in common");
+	}
+
+	VmaAllocationCreateInfo allocation_info{};
+	allocation_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	frames.resize(render_context.get_render_frames().size());
+	for (auto &frame : frames)
+	{
+		VK_CHECK(vmaAllocateMemory(allocated::get_memory_allocator(), &frame_requirements, &allocation_info, &frame.allocation, nullptr));
+		frame.offsets = offsets;
+		frame.sizes   = sizes;
+	}
+}
+
+void DynamicResolution::destroy_frames()
+{
+	for (auto &frame : frames)
+	{
+		destroy_target(frame);
+
+		if (frame.allocation != VK_NULL_HANDLE)
+		{
+			vmaFreeMemory(allocated::get_memory_allocator(), frame.allocation);
+		}
+	}
+
+	frames.clear();
+}
+
+void DynamicResolution::create_target(FrameTarget &frame, float target_scale)
+{
+	auto &device = render_context.get_device();
+
+	destroy_target(frame);
+
+	auto extent = get_scaled_extent(target_scale);
+
+	std::vector<core::Image> images;
+	for (size_t i = 0; i < attachments.size(); ++i)
+	{
+		auto create_info = get_image_create_info(attachments[i], extent);
+
+		VkImage handle{VK_NULL_HANDLE};
+		VK_CHECK(vkCreateImage(device.get_handle(), &create_info, nullptr, &handle));
+		frame.images.push_back(handle);
+
+		VkMemoryRequirements requirements{};
+		vkGetImageMemoryRequirements(device.get_handle(), handle, &requirements);
+		if (requirements.size > frame.sizes[i] || frame.offsets[i] % requirements.alignment != 0)
+		{
+			throw std::runtime_error("A dynamic resolution image doesn't fit the memory of its attachment at the maximum scale");
+		}
+
+		VK_CHECK(vmaBindImageMemory2(allocated::get_memory_allocator(), frame.allocation, frame.offsets[i], handle, nullptr));
+
+		images.emplace_back(device, handle, create_info.extent, create_info.format, create_info.usage, create_info.samples);
+		images.back().set_debug_name("Dynamic resolution: attachment " + std::to_string(i));
+	}
+
+	frame.render_target = std::make_unique<RenderTarget>(std::move(images));
+	frame.scale         = target_scale;
+
+	// Descriptor sets and framebuffers cached for the previous images could be matched by the handles of the new ones
+	render_context.get_active_frame().ClearDescriptors();
+	device.get_resource_cache().ClearFramebuffers();
+}
+
+void DynamicResolution::destroy_target(FrameTarget &frame)
+{
+	// The views of the render target go first, the images it wraps don't own their handles
+	frame.render_target.reset();
+
+	for (auto handle : frame.images)
+	{
+		vkDestroyImage(render_context.get_device().get_handle(), handle, nullptr);
+	}
+
+	frame.images.clear();
+	frame.scale = 0.0f;
+}
+}        // namespace vkb
@@ -0,0 +1,202 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "core/sampler.h"
+#include "rendering/postprocessing_pipeline.h"
+#include "rendering/render_target.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class RenderContext;
+
+/**
+ * @brief Scales the resolution the scene is rendered at to keep the GPU time of the frames under a target
+ *
+ * The scene is rendered into a render target of the active frame, at a scale of the surface extent, then upscaled
+ * to the swapchain image by a bilinear post processing pass. Every Config::adjust_interval frames timed by the
+ * GpuFrameTimer of the render context, the scale follows their average GPU time:
+ * - Over the target, the scale drops by the square root of the ratio, since the time of the frames mostly depends on
+ *   the number of pixels they shade.
+ * - Under the target by more than the headroom, the scale rises by one step, so it doesn't oscillate around the target.
+ * The scale is a multiple of Config::scale_step between the configured bounds. The frames are timed with the timestamps
+ * of RenderContext::enable_gpu_frame_timing(), the scale stays at the maximum if the queue doesn't support them.
+ * While the FramePacer of the render context is thermally throttled, the scale is also kept under
+ * Config::throttled_max_scale, which spares the GPU the most power.
+ *
+ * Each render frame owns one allocation, large enough for the attachments at the maximum scale. The images of a
+ * frame are created again, bound to the same memory, once the frame is active after the scale changed, so neither
+ * allocating them nor waiting for the other frames in flight is needed. The allocations are only made again when the
+ * surface extent changes.
+ */
+class DynamicResolution
+{
+  public:
+	struct Config
+	{
+		float min_scale{0.5f};
+
+		float max_scale{1.0f};
+
+		/// GPU time per frame to stay under, in milliseconds
+		float target_frame_time{1000.0f / 60.0f};
+
+		/// Fraction of the target time the frames have to be under before the scale rises
+		float headroom{0.15f};
+
+		/// Number of timed frames averaged between two adjustments
+		uint32_t adjust_interval{8};
+
+		float scale_step{0.05f};
+
+		/// Upper bound of the scale while the frame pacer is thermally throttled
+		float throttled_max_scale{0.75f};
+	};
+
+	/**
+	 * @param render_context Render context
+	 * @param attachments Attachments of the scaled render targets, sampled by the upscale pass
+	 * @param config Bounds and target of the scale
+	 */
+	DynamicResolution(RenderContext &render_context, std::vector<Attachment> &&attachments, const Config &config = {});
+
+	DynamicResolution(const DynamicResolution &) = delete;
+
+	DynamicResolution(DynamicResolution &&) = delete;
+
+	/**
+	 * @brief Destroys the render targets, then their images, then the memory they were bound to
+	 */
+	~DynamicResolution();
+
+	DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+	DynamicResolution &operator=(DynamicResolution &&) = delete;
+
+	/**
+	 * @brief Sets the bounds and target of the scale, which is clamped to the new bounds at the next update
+	 */
+	void set_config(const Config &config);
+
+	const Config &get_config() const;
+
+	/**
+	 * @brief Adjusts the scale from the times of the last frames and creates the render target of the active frame
+	 *        for it, to be called after RenderContext::begin_frame()
+	 */
+	void update();
+
+	/**
+	 * @return The scale of the render target of the active frame
+	 */
+	float get_scale() const;
+
+	/**
+	 * @return The render target of the active frame to render the scene into, the viewport and scissor must be set
+	 *         to its extent
+	 */
+	RenderTarget &get_render_target();
+
+	/**
+	 * @brief Upscales an attachment of the render target of the active frame to a render target of the surface extent
+	 *        The render pass is left open, e.g. to draw the GUI, and must be ended by the caller.
+	 * @param command_buffer The command buffer to record into
+	 * @param render_target The render target to draw to, usually the one of the swapchain image
+	 * @param color_attachment The attachment of the scaled render target to upscale
+	 */
+	void upscale(CommandBuffer &command_buffer, RenderTarget &render_target, uint32_t color_attachment = 0);
+
+  private:
+	/**
+	 * @brief Memory of a render frame, with the images bound to it for its current scale
+	 */
+	struct FrameTarget
+	{
+		VmaAllocation allocation{VK_NULL_HANDLE};
+
+		/// Offset of each attachment in the allocation
+		std::vector<VkDeviceSize> offsets;
+
+		/// Size of each attachment at the maximum scale, which the images can't exceed
+		std::vector<VkDeviceSize> sizes;
+
+		std::vector<VkImage> images;
+
+		std::unique_ptr<RenderTarget> render_target;
+
+		float scale{0.0f};
+	};
+
+	/**
+	 * @brief Allocates the memory of each render frame for the surface extent at the maximum scale
+	 */
+	void allocate_frames();
+
+	void destroy_frames();
+
+	/**
+	 * @brief Creates the images and render target of a frame for a scale
+	 */
+	void create_target(FrameTarget &frame, float target_scale);
+
+	void destroy_target(FrameTarget &frame);
+
+	/**
+	 * @return The quantized scale reaching the target time from the average time of the last frames
+	 */
+	float adjust_scale(float frame_time) const;
+
+	/**
+	 * @return The upper bound of the scale, lowered while the frames are thermally throttled
+	 */
+	float get_max_scale() const;
+
+	VkExtent2D get_scaled_extent(float target_scale) const;
+
+	RenderContext &render_context;
+
+	std::vector<Attachment> attachments;
+
+	Config config;
+
+	float scale{1.0f};
+
+	/// Surface extent the frames were allocated for
+	VkExtent2D surface_extent{};
+
+	std::vector<FrameTarget> frames;
+
+	/// Resolved count of the GPU frame timer at the last update
+	uint64_t resolved_count{0};
+
+	/// Timed frames still rendered at the previous scale, ignored after a change
+	uint32_t skip_count{0};
+
+	uint32_t sample_count{0};
+
+	float time_sum{0.0f};
+
+	std::unique_ptr<core::Sampler> sampler;
+
+	std::unique_ptr<PostProcessingPipeline> upscale_pipeline;
+};
+}        // namespace vkb
@@ -0,0 +1,341 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/frame_pacer.h"
+
+#include <limits>
+#include <thread>
+
+#include "core/device.h"
+
+namespace vkb
+{
+namespace
+{
+/// Bounds the wait for a present, which never completes while the window is hidden on some platforms
+constexpr uint64_t PresentTimeout = 1000000000;        // 1 s
+}        // namespace
+
+void FramePacer::request_features(PhysicalDevice &gpu)
+{
+	if (!gpu.get_instance().is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+	{
+		return;
+	}
+
+	if (gpu.is_extension_supported(VK_KHR_PRESENT_ID_EXTENSION_NAME))
+	{
+		REQUEST_OPTIONAL_FEATURE(gpu, VkPhysicalDevicePresentIdFeaturesKHR, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR, presentId);
+	}
+
+	if (gpu.is_extension_supported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+	{
+		REQUEST_OPTIONAL_FEATURE(gpu, VkPhysicalDevicePresentWaitFeaturesKHR, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR, presentWait);
+	}
+
+#if defined(VK_AMD_anti_lag)
+	if (gpu.is_extension_supported(VK_AMD_ANTI_LAG_EXTENSION_NAME))
+	{
+		REQUEST_OPTIONAL_FEATURE(gpu, VkPhysicalDeviceAntiLagFeaturesAMD, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ANTI_LAG_FEATURES_AMD, antiLag);
+	}
+#endif
+}
+
+FramePacer::FramePacer(Device &device) :
+    device{device}
+{
+	auto &gpu = device.get_gpu();
+
+	auto present_id_features = gpu.get_requested_extension_features<VkPhysicalDevicePresentIdFeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR);
+	present_ids              = device.is_enabled(VK_KHR_PRESENT_ID_EXTENSION_NAME) && present_id_features && present_id_features->presentId;
+
+	auto present_wait_features = gpu.get_requested_extension_features<VkPhysicalDevicePresentWaitFeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR);
+	present_wait               = present_ids && device.is_enabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME) && present_wait_features && present_wait_features->presentWait;
+
+#if defined(VK_NV_low_latency2)
+	if (device.is_enabled(VK_NV_LOW_LATENCY_2_EXTENSION_NAME))
+	{
+		auto timeline_features = gpu.get_requested_extension_features<VkPhysicalDeviceTimelineSemaphoreFeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR);
+		if (present_ids && timeline_features && timeline_features->timelineSemaphore)
+		{
+			VkSemaphoreTypeCreateInfoKHR type_info{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR};
+			type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+
+			VkSemaphoreCreateInfo create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+			create_info.pNext = &type_info;
+			VK_CHECK(vkCreateSemaphore(device.get_handle(), &create_info, nullptr, &sleep_semaphore));
+
+			low_latency = true;
+		}
+		else
+		{
+			LOGW("VK_NV_low_latency2 needs present ids and timeline semaphores, the low latency mode is disabled");
+		}
+	}
+#endif
+
+#if defined(VK_AMD_anti_lag)
+	auto anti_lag_features = gpu.get_requested_extension_features<VkPhysicalDeviceAntiLagFeaturesAMD>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ANTI_LAG_FEATURES_AMD);
+	anti_lag               = device.is_enabled(VK_AMD_ANTI_LAG_EXTENSION_NAME) && anti_lag_features && anti_lag_features->antiLag;
+#endif
+}
+
+FramePacer::~FramePacer()
+{
+	if (sleep_semaphore != VK_NULL_HANDLE)
+	{
+		vkDestroySemaphore(device.get_handle(), sleep_semaphore, nullptr);
+	}
+}
+
+void FramePacer::set_max_frames_in_flight(uint32_t count)
+{
+	max_frames_in_flight = count;
+}
+
+uint32_t FramePacer::get_max_frames_in_flight() const
+{
+	return max_frames_in_flight;
+}
+
+bool FramePacer::is_present_wait_enabled() const
+{
+	return present_wait;
+}
+
+void FramePacer::set_thermal_headroom(float headroom)
+{
+	thermal_headroom = headroom;
+
+	bool throttled = thermal_throttled ? headroom >= RecoveryHeadroom : headroom >= ThrottleHeadroom;
+	if (throttled != thermal_throttled)
+	{
+		LOGI("Thermal headroom at {:.2f}, frame throttling {}", headroom, throttled ? "enabled" : "disabled");
+		thermal_throttled = throttled;
+	}
+}
+
+float FramePacer::get_thermal_headroom() const
+{
+	return thermal_headroom;
+}
+
+bool FramePacer::is_thermal_throttled() const
+{
+	return thermal_throttled;
+}
+
+void FramePacer::set_throttled_frame_time(std::chrono::nanoseconds frame_time)
+{
+	throttled_frame_time = frame_time;
+}
+
+std::chrono::nanoseconds FramePacer::get_throttled_frame_time() const
+{
+	return throttled_frame_time;
+}
+
+void FramePacer::pace(VkSwapchainKHR swapchain)
+{
+	track_swapchain(swapchain);
+
+	if (present_wait && swapchain != VK_NULL_HANDLE)
+	{
+		// Leave at most max_frames_in_flight - 1 presents queued, the pending ones are all to this swapchain
+		if (max_frames_in_flight > 0 && present_id >= max_frames_in_flight)
+		{
+			uint64_t target = present_id - (max_frames_in_flight - 1);
+			if (!pending_presents.empty() && pending_presents.front().present_id <= target)
+			{
+				VkResult result = vkWaitForPresentKHR(device.get_handle(), swapchain, target, PresentTimeout);
+				if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR && result != VK_TIMEOUT)
+				{
+					LOGW_THROTTLED("Waiting for present {} failed: {}", target, vkb::to_string(result));
+				}
+			}
+		}
+
+		poll_presents(swapchain);
+	}
+
+	if (thermal_throttled && simulation_start.time_since_epoch().count() > 0)
+	{
+		// Sleeping before the input is sampled keeps the latency of the throttled frames as low as the others
+		std::this_thread::sleep_until(simulation_start + throttled_frame_time);
+	}
+
+#if defined(VK_NV_low_latency2)
+	if (low_latency && swapchain != VK_NULL_HANDLE)
+	{
+		if (low_latency_swapchain != swapchain)
+		{
+			VkLatencySleepModeInfoNV mode_info{VK_STRUCTURE_TYPE_LATENCY_SLEEP_MODE_INFO_NV};
+			mode_info.lowLatencyMode  = VK_TRUE;
+			mode_info.lowLatencyBoost = VK_TRUE;
+			VK_CHECK(vkSetLatencySleepModeNV(device.get_handle(), swapchain, &mode_info));
+
+			low_latency_swapchain = swapchain;
+		}
+
+		// The driver signals the semaphore when the frame should start to be presented on time
+		VkLatencySleepInfoNV sleep_info{VK_STRUCTURE_TYPE_LATENCY_SLEEP_INFO_NV};
+		sleep_info.signalSemaphore = sleep_semaphore;
+		sleep_info.value           = ++sleep_value;
+		VK_CHECK(vkLatencySleepNV(device.get_handle(), swapchain, &sleep_info));
+
+		VkSemaphoreWaitInfoKHR wait_info{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR};
+		wait_info.semaphoreCount = 1;
+		wait_info.pSemaphores    = &sleep_semaphore;
+		wait_info.pValues        = &sleep_value;
+		VK_CHECK(vkWaitSemaphoresKHR(device.get_handle(), &wait_info, std::numeric_limits<uint64_t>::max()));
+
+		set_latency_marker(swapchain, VK_LATENCY_MARKER_SIMULATION_START_NV, present_id + 1);
+	}
+#endif
+
+#if defined(VK_AMD_anti_lag)
+	if (anti_lag)
+	{
+		// Delays the input sampling of the frame, so the GPU doesn't queue it behind the previous ones
+		VkAntiLagPresentationInfoAMD presentation_info{VK_STRUCTURE_TYPE_ANTI_LAG_PRESENTATION_INFO_AMD};
+		presentation_info.stage      = VK_ANTI_LAG_STAGE_INPUT_AMD;
+		presentation_info.frameIndex = present_id + 1;
+
+		VkAntiLagDataAMD anti_lag_data{VK_STRUCTURE_TYPE_ANTI_LAG_DATA_AMD};
+		anti_lag_data.mode              = VK_ANTI_LAG_MODE_ON_AMD;
+		anti_lag_data.pPresentationInfo = &presentation_info;
+		vkAntiLagUpdateAMD(device.get_handle(), &anti_lag_data);
+	}
+#endif
+
+	simulation_start = std::chrono::steady_clock::now();
+}
+
+bool FramePacer::next_frame_to_wait(uint32_t &frame_index)
+{
+	if (max_frames_in_flight == 0 || submitted_frames.size() < max_frames_in_flight)
+	{
+		return false;
+	}
+
+	frame_index = submitted_frames.front();
+	submitted_frames.pop_front();
+	return true;
+}
+
+void FramePacer::begin_render(VkSwapchainKHR swapchain)
+{
+#if defined(VK_NV_low_latency2)
+	if (low_latency && swapchain != VK_NULL_HANDLE)
+	{
+		set_latency_marker(swapchain, VK_LATENCY_MARKER_SIMULATION_END_NV, present_id + 1);
+		set_latency_marker(swapchain, VK_LATENCY_MARKER_RENDERSUBMIT_START_NV, present_id + 1);
+	}
+#endif
+}
+
+const void *FramePacer::begin_present(VkSwapchainKHR swapchain, uint32_t frame_index, const void *next)
+{
+	track_swapchain(swapchain);
+
+	submitted_frames.push_back(frame_index);
+
+	if (!present_ids)
+	{
+		return next;
+	}
+
+	++present_id;
+
+#if defined(VK_NV_low_latency2)
+	if (low_latency)
+	{
+		set_latency_marker(swapchain, VK_LATENCY_MARKER_RENDERSUBMIT_END_NV, present_id);
+		set_latency_marker(swapchain, VK_LATENCY_MARKER_PRESENT_START_NV, present_id);
+	}
+#endif
+
+	if (present_wait)
+	{
+		pending_presents.push_back({present_id, simulation_start});
+	}
+
+	present_id_info.pNext          = next;
+	present_id_info.swapchainCount = 1;
+	present_id_info.pPresentIds    = &present_id;
+	return &present_id_info;
+}
+
+void FramePacer::end_present(VkSwapchainKHR swapchain)
+{
+#if defined(VK_NV_low_latency2)
+	if (low_latency)
+	{
+		set_latency_marker(swapchain, VK_LATENCY_MARKER_PRESENT_END_NV, present_id);
+	}
+#endif
+}
+
+void FramePacer::end_frame(uint32_t frame_index)
+{
+	submitted_frames.push_back(frame_index);
+}
+
+float FramePacer::get_latency() const
+{
+	return latency;
+}
+
+void FramePacer::poll_presents(VkSwapchainKHR swapchain)
+{
+	while (!pending_presents.empty())
+	{
+		VkResult result = vkWaitForPresentKHR(device.get_handle(), swapchain, pending_presents.front().present_id, 0);
+		if (result == VK_TIMEOUT)
+		{
+			break;
+		}
+
+		// A present observed late reports a higher latency, by at most the time to the next poll
+		if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+		{
+			latency = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - pending_presents.front().simulation_start).count();
+		}
+
+		pending_presents.pop_front();
+	}
+}
+
+void FramePacer::track_swapchain(VkSwapchainKHR swapchain)
+{
+	if (swapchain != this->swapchain)
+	{
+		pending_presents.clear();
+		this->swapchain = swapchain;
+	}
+}
+
+#if defined(VK_NV_low_latency2)
+void FramePacer::set_latency_marker(VkSwapchainKHR swapchain, VkLatencyMarkerNV marker, uint64_t frame_id)
+{
+	VkSetLatencyMarkerInfoNV marker_info{VK_STRUCTURE_TYPE_SET_LATENCY_MARKER_INFO_NV};
+	marker_info.presentID = frame_id;
+	marker_info.marker    = marker;
+	vkSetLatencyMarkerNV(device.get_handle(), swapchain, &marker_info);
+}
+#endif
+}        // namespace vkb
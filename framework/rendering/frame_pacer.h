@@ -0,0 +1,218 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Device;
+class PhysicalDevice;
+
+/**
+ * @brief Limits the frames queued ahead of the presentation engine, and measures their latency
+ *
+ * The render context calls pace() before the application samples its input and simulates a frame.
+ * It waits for older frames until at most max_frames_in_flight - 1 of them are still submitted, so
+ * the simulation starts as close as possible to the presentation of its frame.
+ *
+ * With VK_KHR_present_id and VK_KHR_present_wait, each present carries an id and pace() waits for
+ * the presentation of the older frames themselves. The latency, from the start of the simulation of a
+ * frame to its presentation, is only measured then. Without them, pace() only returns the frames whose
+ * rendering to wait for, which bounds the queue from the CPU side.
+ *
+ * The vendor low latency modes are used when their extension is enabled:
+ * VK_NV_low_latency2 sleeps in pace() and marks the stages of the frame, VK_AMD_anti_lag delays the
+ * input sampling in pace().
+ *
+ * The platform may report the thermal headroom of the device. Once it nears the severe throttling of the device,
+ * pace() spaces the frames by the throttled frame time, so the device cools down at a steady rate instead of
+ * collapsing when the OS throttles it. The frames are released once the headroom drops under RecoveryHeadroom.
+ */
+class FramePacer
+{
+  public:
+	/// Thermal headroom from which the frames are throttled, 1 being the threshold of severe throttling
+	static constexpr float ThrottleHeadroom = 0.9f;
+
+	/// Thermal headroom under which the frames are released, lower so the throttling doesn't toggle
+	static constexpr float RecoveryHeadroom = 0.75f;
+
+	/**
+	 * @brief Requests the optional features used by the pacer
+	 *        To be called from VulkanSample::request_gpu_features, the sample also adds the device extensions.
+	 */
+	static void request_features(PhysicalDevice &gpu);
+
+	explicit FramePacer(Device &device);
+
+	FramePacer(const FramePacer &) = delete;
+
+	FramePacer(FramePacer &&) = delete;
+
+	~FramePacer();
+
+	FramePacer &operator=(const FramePacer &) = delete;
+
+	FramePacer &operator=(FramePacer &&) = delete;
+
+	/**
+	 * @param count The number of frames submitted before the simulation of a new one waits, 0 to only be limited by the swapchain images
+	 */
+	void set_max_frames_in_flight(uint32_t count);
+
+	uint32_t get_max_frames_in_flight() const;
+
+	/**
+	 * @return Whether the presents are waited for with VK_KHR_present_wait, and their latency measured
+	 */
+	bool is_present_wait_enabled() const;
+
+	/**
+	 * @brief Sets the thermal headroom of the device, as reported by the platform
+	 * @param headroom 0 when the device is idle, 1 when it starts to be severely throttled
+	 */
+	void set_thermal_headroom(float headroom);
+
+	float get_thermal_headroom() const;
+
+	/**
+	 * @return Whether the frames are throttled for the thermal headroom
+	 */
+	bool is_thermal_throttled() const;
+
+	/**
+	 * @param frame_time The minimum time between the start of two frames while thermally throttled
+	 */
+	void set_throttled_frame_time(std::chrono::nanoseconds frame_time);
+
+	std::chrono::nanoseconds get_throttled_frame_time() const;
+
+	/**
+	 * @brief Waits for the presentation of older frames, then marks the start of the simulation of a frame
+	 * @param swapchain The swapchain the frames are presented to, may be null without presentation
+	 */
+	void pace(VkSwapchainKHR swapchain);
+
+	/**
+	 * @brief Pops the frames whose rendering must finish before the simulation starts
+	 *        To be called until it returns false, after pace().
+	 * @param frame_index Set to the index of the next render frame to wait for
+	 * @return Whether a frame has to be waited for
+	 */
+	bool next_frame_to_wait(uint32_t &frame_index);
+
+	/**
+	 * @brief Marks the end of the simulation, as the rendering of the frame starts
+	 */
+	void begin_render(VkSwapchainKHR swapchain);
+
+	/**
+	 * @brief Chains the id of the frame to a present, and marks the end of its rendering
+	 * @param next The pNext chain of the present info
+	 * @return The pNext chain to present with
+	 */
+	const void *begin_present(VkSwapchainKHR swapchain, uint32_t frame_index, const void *next);
+
+	void end_present(VkSwapchainKHR swapchain);
+
+	/**
+	 * @brief Records the frame as submitted without presenting it, for render contexts without swapchain
+	 */
+	void end_frame(uint32_t frame_index);
+
+	/**
+	 * @return The latency of the last frame whose presentation was observed, in milliseconds
+	 */
+	float get_latency() const;
+
+  private:
+	/// A presented frame whose presentation wasn't observed yet
+	struct PendingPresent
+	{
+		uint64_t present_id;
+
+		std::chrono::steady_clock::time_point simulation_start;
+	};
+
+	/**
+	 * @brief Measures the latency of the presents which completed, without waiting
+	 */
+	void poll_presents(VkSwapchainKHR swapchain);
+
+	/**
+	 * @brief Forgets the presents to a previous swapchain, whose ids start over
+	 */
+	void track_swapchain(VkSwapchainKHR swapchain);
+
+#if defined(VK_NV_low_latency2)
+	/**
+	 * @param frame_id The present id of the frame the marker belongs to
+	 */
+	void set_latency_marker(VkSwapchainKHR swapchain, VkLatencyMarkerNV marker, uint64_t frame_id);
+#endif
+
+	Device &device;
+
+	uint32_t max_frames_in_flight{0};
+
+	/// Whether the presents carry an id, with VK_KHR_present_id
+	bool present_ids{false};
+
+	bool present_wait{false};
+
+	bool low_latency{false};
+
+	bool anti_lag{false};
+
+	VkSwapchainKHR swapchain{VK_NULL_HANDLE};
+
+	/// Id of the last present, ids start from 1
+	uint64_t present_id{0};
+
+	VkPresentIdKHR present_id_info{VK_STRUCTURE_TYPE_PRESENT_ID_KHR};
+
+	std::deque<PendingPresent> pending_presents;
+
+	/// Render frames submitted, oldest first
+	std::deque<uint32_t> submitted_frames;
+
+	std::chrono::steady_clock::time_point simulation_start;
+
+	float latency{0.0f};
+
+	float thermal_headroom{0.0f};
+
+	bool thermal_throttled{false};
+
+	/// 30 frames per second by default
+	std::chrono::nanoseconds throttled_frame_time{33'333'333};
+
+	/// Signalled by the driver when a latency sleep ends
+	VkSemaphore sleep_semaphore{VK_NULL_HANDLE};
+
+	uint64_t sleep_value{0};
+
+	/// Swapchain the low latency mode was set on
+	VkSwapchainKHR low_latency_swapchain{VK_NULL_HANDLE};
+};
+}        // namespace vkb
@@ -0,0 +1,270 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/frame_readback.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <core/util/profiling.hpp>
+#include <core/util/thread_role.hpp>
+
+#include "core/device.h"
+#include "filesystem/legacy.h"
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+FrameReadback::FrameReadback(Device &device, uint32_t ring_size) :
+    device{device},
+    command_pool{device, device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0).get_family_index(), nullptr, 0, CommandBuffer::ResetMode::ResetIndividually},
+    slots(std::max(ring_size, 1u))
+{
+	for (auto &slot : slots)
+	{
+		slot.command_buffer = &command_pool.request_command_buffer();
+
+		VkFenceCreateInfo create_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+		VK_CHECK(vkCreateFence(device.get_handle(), &create_info, nullptr, &slot.fence));
+	}
+
+	worker_thread = std::thread(&FrameReadback::encode_worker, this);
+}
+
+FrameReadback::~FrameReadback()
+{
+	try
+	{
+		flush();
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to write the captured frames: {}", e.what());
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(images_mutex);
+		stop_worker = true;
+	}
+	images_condition.notify_all();
+	worker_thread.join();
+
+	for (auto &slot : slots)
+	{
+		vkDestroyFence(device.get_handle(), slot.fence, nullptr);
+	}
+}
+
+void FrameReadback::capture(RenderContext &render_context, const std::string &filename)
+{
+	PROFILE_FUNCTION();
+
+	assert(render_context.get_format() == VK_FORMAT_R8G8B8A8_UNORM ||
+	       render_context.get_format() == VK_FORMAT_B8G8R8A8_UNORM ||
+	       render_context.get_format() == VK_FORMAT_R8G8B8A8_SRGB ||
+	       render_context.get_format() == VK_FORMAT_B8G8R8A8_SRGB);
+
+	collect();
+
+	// Only waits when all the slots are in flight, for the oldest capture
+	auto &slot = slots[next_slot];
+	next_slot  = (next_slot + 1) % slots.size();
+	if (slot.pending)
+	{
+		VK_CHECK(vkWaitForFences(device.get_handle(), 1, &slot.fence, VK_TRUE, UINT64_MAX));
+		complete(slot);
+	}
+
+	// We want the last completed frame since we don't want to be reading from an incomplete framebuffer
+	auto &frame = render_context.get_last_rendered_frame();
+	assert(!frame.GetRenderTarget().get_views().empty());
+	auto &src_image_view = frame.GetRenderTarget().get_views()[0];
+
+	auto width    = render_context.get_surface_extent().width;
+	auto height   = render_context.get_surface_extent().height;
+	auto dst_size = width * height * 4;
+
+	// The buffer is kept across captures of the same size
+	if (!slot.buffer || slot.buffer->get_size() != dst_size)
+	{
+		slot.buffer = std::make_unique<core::BufferC>(device,
+		                                              dst_size,
+		                                              VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		                                              VMA_MEMORY_USAGE_GPU_TO_CPU,
+		                                              VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	}
+
+	// Check if framebuffer images are in a BGR format
+	auto bgr_formats = {VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_B8G8R8A8_SNORM};
+
+	slot.width    = width;
+	slot.height   = height;
+	slot.swizzle  = std::find(bgr_formats.begin(), bgr_formats.end(), src_image_view.get_format()) != bgr_formats.end();
+	slot.filename = filename;
+
+	auto &cmd_buf = *slot.command_buffer;
+	cmd_buf.reset(CommandBuffer::ResetMode::ResetIndividually);
+	cmd_buf.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	// Enable destination buffer to be written to
+	{
+		BufferMemoryBarrier memory_barrier{};
+		memory_barrier.src_access_mask = 0;
+		memory_barrier.dst_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+		cmd_buf.buffer_memory_barrier(*slot.buffer, 0, dst_size, memory_barrier);
+	}
+
+	// Enable framebuffer image view to be read from
+	{
+		ImageMemoryBarrier memory_barrier{};
+		memory_barrier.old_layout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		memory_barrier.new_layout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		memory_barrier.src_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		memory_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+		cmd_buf.image_memory_barrier(src_image_view, memory_barrier);
+	}
+
+	// Copy framebuffer image memory
+	VkBufferImageCopy image_copy_region{};
+	image_copy_region.bufferRowLength             = width;
+	image_copy_region.bufferImageHeight           = height;
+	image_copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	image_copy_region.imageSubresource.layerCount = 1;
+	image_copy_region.imageExtent.width           = width;
+	image_copy_region.imageExtent.height          = height;
+	image_copy_region.imageExtent.depth           = 1;
+
+	cmd_buf.copy_image_to_buffer(src_image_view.get_image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *slot.buffer, {image_copy_region});
+
+	// Enable destination buffer to map memory
+	{
+		BufferMemoryBarrier memory_barrier{};
+		memory_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memory_barrier.dst_access_mask = VK_ACCESS_HOST_READ_BIT;
+		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_HOST_BIT;
+
+		cmd_buf.buffer_memory_barrier(*slot.buffer, 0, dst_size, memory_barrier);
+	}
+
+	// Revert back the framebuffer image view from transfer to present
+	{
+		ImageMemoryBarrier memory_barrier{};
+		memory_barrier.old_layout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		memory_barrier.new_layout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		memory_barrier.src_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		memory_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+		cmd_buf.image_memory_barrier(src_image_view, memory_barrier);
+	}
+
+	cmd_buf.end();
+
+	VK_CHECK(vkResetFences(device.get_handle(), 1, &slot.fence));
+
+	const auto &queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+	VK_CHECK(queue.submit(cmd_buf, slot.fence));
+
+	slot.pending = true;
+}
+
+void FrameReadback::collect()
+{
+	for (auto &slot : slots)
+	{
+		if (slot.pending && vkGetFenceStatus(device.get_handle(), slot.fence) == VK_SUCCESS)
+		{
+			complete(slot);
+		}
+	}
+}
+
+void FrameReadback::flush()
+{
+	for (auto &slot : slots)
+	{
+		if (slot.pending)
+		{
+			VK_CHECK(vkWaitForFences(device.get_handle(), 1, &slot.fence, VK_TRUE, UINT64_MAX));
+			complete(slot);
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(images_mutex);
+	images_condition.wait(lock, [this] { return images.empty() && !encoding; });
+}
+
+void FrameReadback::complete(Slot &slot)
+{
+	// Copying the pixels frees the buffer for the next capture, the encoding takes much longer
+	Image image{std::vector<uint8_t>(slot.buffer->get_size()), slot.width, slot.height, slot.swizzle, std::move(slot.filename)};
+	std::memcpy(image.data.data(), slot.buffer->map(), image.data.size());
+	slot.buffer->unmap();
+	slot.pending = false;
+
+	{
+		std::lock_guard<std::mutex> guard(images_mutex);
+		images.push_back(std::move(image));
+	}
+	images_condition.notify_all();
+}
+
+void FrameReadback::encode_worker()
+{
+	set_current_thread_role(ThreadRole::Background);
+
+	while (true)
+	{
+		Image image;
+		{
+			std::unique_lock<std::mutex> lock(images_mutex);
+			encoding = false;
+			images_condition.notify_all();
+			images_condition.wait(lock, [this] { return stop_worker || !images.empty(); });
+			if (images.empty())
+			{
+				return;
+			}
+
+			image = std::move(images.front());
+			images.pop_front();
+			encoding = true;
+		}
+
+		// Replace the A component with 255 (remove transparency)
+		// If swapchain format is BGR, swapping the R and B components
+		uint8_t *data = image.data.data();
+		for (size_t i = 0; i < static_cast<size_t>(image.width) * image.height; ++i)
+		{
+			if (image.swizzle)
+			{
+				std::swap(data[0], data[2]);
+			}
+			data[3] = 255;
+
+			// Get next pixel
+			data += 4;
+		}
+
+		vkb::fs::write_image(image.data.data(), image.filename, image.width, image.height, 4, image.width * 4);
+	}
+}
+}        // namespace vkb
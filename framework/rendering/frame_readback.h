@@ -0,0 +1,147 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/buffer.h"
+#include "core/command_pool.h"
+
+namespace vkb
+{
+class Device;
+class RenderContext;
+
+/**
+ * @brief Reads back the rendered frames and writes them as PNG images without stalling the queue
+ *
+ * Each capture copies the last rendered frame into one of a ring of host visible buffers, in a command
+ * buffer submitted with a fence of its own. The captures are picked up a few frames later, once their
+ * fence is signaled, and their images are encoded on a background thread. The frame only waits on the
+ * GPU when all the buffers of the ring are still in use.
+ */
+class FrameReadback
+{
+  public:
+	/// Default number of captures in flight
+	static constexpr uint32_t DefaultRingSize = 3;
+
+	FrameReadback(Device &device, uint32_t ring_size = DefaultRingSize);
+
+	FrameReadback(const FrameReadback &) = delete;
+
+	FrameReadback(FrameReadback &&) = delete;
+
+	/**
+	 * @brief Waits for the captures in flight and writes their images
+	 */
+	~FrameReadback();
+
+	FrameReadback &operator=(const FrameReadback &) = delete;
+
+	FrameReadback &operator=(FrameReadback &&) = delete;
+
+	/**
+	 * @brief Copies the last rendered frame of a render context, to be written to the screenshots directory
+	 * @param render_context The render context, with a RGBA8 or BGRA8 format
+	 * @param filename The name of the image, without its extension
+	 */
+	void capture(RenderContext &render_context, const std::string &filename);
+
+	/**
+	 * @brief Hands the completed captures to the background thread, without waiting
+	 */
+	void collect();
+
+	/**
+	 * @brief Waits until all the captures are written
+	 */
+	void flush();
+
+  private:
+	struct Slot
+	{
+		std::unique_ptr<core::BufferC> buffer;
+
+		CommandBuffer *command_buffer{nullptr};
+
+		VkFence fence{VK_NULL_HANDLE};
+
+		bool pending{false};
+
+		uint32_t width{0};
+
+		uint32_t height{0};
+
+		bool swizzle{false};
+
+		std::string filename;
+	};
+
+	/// The pixels of a capture, ready to be encoded
+	struct Image
+	{
+		std::vector<uint8_t> data;
+
+		uint32_t width;
+
+		uint32_t height;
+
+		bool swizzle;
+
+		std::string filename;
+	};
+
+	/**
+	 * @brief Hands a capture whose fence is signaled to the background thread
+	 */
+	void complete(Slot &slot);
+
+	void encode_worker();
+
+	Device &device;
+
+	CommandPool command_pool;
+
+	std::vector<Slot> slots;
+
+	/// The slot of the next capture, the slots are used in turn
+	size_t next_slot{0};
+
+	std::mutex images_mutex;
+
+	std::condition_variable images_condition;
+
+	std::deque<Image> images;
+
+	/// Whether an image is being encoded, flush waits until it is written
+	bool encoding{false};
+
+	bool stop_worker{false};
+
+	std::thread worker_thread;
+};
+}        // namespace vkb
@@ -0,0 +1,354 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/gpu_frame_timer.h"
+
+#include "core/device.h"
+#include "core/submission_builder.h"
+
+namespace vkb
+{
+namespace
+{
+/// The frame timestamps, followed by a pair for each pass
+constexpr uint32_t QueryCount = 2 + 2 * GpuFrameTimer::MaxPasses;
+
+/// The counters of GpuFrameTimer::PipelineStatistics, their results are written in the order of the bits
+constexpr VkQueryPipelineStatisticFlags PipelineStatisticFlags =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+static_assert(sizeof(GpuFrameTimer::PipelineStatistics) == 7 * sizeof(uint64_t), "A counter per bit of the pipeline statistic flags");
+}        // namespace
+
+bool GpuFrameTimer::is_supported(Device &device, uint32_t queue_family_index)
+{
+	auto &queue_family_properties = device.get_gpu().get_queue_family_properties();
+	return queue_family_index < queue_family_properties.size() && queue_family_properties[queue_family_index].timestampValidBits > 0;
+}
+
+bool GpuFrameTimer::is_pipeline_statistics_supported(Device &device, uint32_t queue_family_index)
+{
+	auto &queue_family_properties = device.get_gpu().get_queue_family_properties();
+	return device.get_gpu().get_requested_features().pipelineStatisticsQuery && queue_family_index < queue_family_properties.size() &&
+	       (queue_family_properties[queue_family_index].queueFlags & VK_QUEUE_GRAPHICS_BIT);
+}
+
+GpuFrameTimer::GpuFrameTimer(Device &device, uint32_t queue_family_index) :
+    device{device},
+    queue_family_index{queue_family_index}
+{
+	assert(is_supported(device, queue_family_index) && "The queue family doesn't support timestamps");
+
+	timestamp_period = device.get_gpu().get_properties().limits.timestampPeriod;
+
+	uint32_t valid_bits = device.get_gpu().get_queue_family_properties()[queue_family_index].timestampValidBits;
+	if (valid_bits < 64)
+	{
+		timestamp_mask = (1ull << valid_bits) - 1;
+	}
+
+	if (TimestampCalibration::is_supported(device))
+	{
+		calibration = std::make_unique<TimestampCalibration>(device, queue_family_index);
+	}
+
+	// The command buffers are recorded once and submitted again every time their frame is used
+	VkCommandPoolCreateInfo create_info{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+	create_info.queueFamilyIndex = queue_family_index;
+	VK_CHECK(vkCreateCommandPool(device.get_handle(), &create_info, nullptr, &command_pool));
+}
+
+GpuFrameTimer::~GpuFrameTimer()
+{
+	for (auto &frame : frames)
+	{
+		if (frame.query_pool != VK_NULL_HANDLE)
+		{
+			vkDestroyQueryPool(device.get_handle(), frame.query_pool, nullptr);
+		}
+
+		if (frame.statistics_pool != VK_NULL_HANDLE)
+		{
+			vkDestroyQueryPool(device.get_handle(), frame.statistics_pool, nullptr);
+		}
+	}
+
+	// Frees the command buffers of the frames
+	vkDestroyCommandPool(device.get_handle(), command_pool, nullptr);
+}
+
+void GpuFrameTimer::begin(SubmissionBuilder &submission, uint32_t frame_index)
+{
+	auto &frame = get_frame(frame_index);
+	assert(!frame.pending && "The timestamps of the frame weren't resolved");
+
+	submission.add_command_buffer(frame.begin_commands);
+
+	if (statistics_enabled)
+	{
+		if (frame.statistics_pool == VK_NULL_HANDLE)
+		{
+			create_statistics_queries(frame);
+		}
+
+		submission.add_command_buffer(frame.statistics_reset_commands);
+	}
+	frame.statistics_active = statistics_enabled;
+}
+
+void GpuFrameTimer::end(SubmissionBuilder &submission, uint32_t frame_index)
+{
+	auto &frame = get_frame(frame_index);
+
+	submission.add_command_buffer(frame.end_commands);
+
+	frame.pending      = true;
+	frame.frame_number = ended_count++;
+	frame.submit_time  = Timer::Clock::now();
+}
+
+uint32_t GpuFrameTimer::begin_pass(VkCommandBuffer command_buffer, uint32_t frame_index, const std::string &name)
+{
+	auto &frame = get_frame(frame_index);
+
+	auto pass = to_u32(frame.pass_names.size());
+	if (pass == MaxPasses)
+	{
+		return MaxPasses;
+	}
+
+	frame.pass_names.push_back(name);
+	vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.query_pool, 2 + 2 * pass);
+
+	if (frame.statistics_active)
+	{
+		vkCmdBeginQuery(command_buffer, frame.statistics_pool, pass, 0);
+	}
+
+	return pass;
+}
+
+void GpuFrameTimer::end_pass(VkCommandBuffer command_buffer, uint32_t frame_index, uint32_t pass)
+{
+	if (pass < MaxPasses)
+	{
+		auto &frame = get_frame(frame_index);
+
+		if (frame.statistics_active)
+		{
+			vkCmdEndQuery(command_buffer, frame.statistics_pool, pass);
+		}
+
+		vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.query_pool, 2 + 2 * pass + 1);
+	}
+}
+
+bool GpuFrameTimer::enable_pipeline_statistics()
+{
+	if (!is_pipeline_statistics_supported(device, queue_family_index))
+	{
+		return false;
+	}
+
+	statistics_enabled = true;
+
+	return true;
+}
+
+bool GpuFrameTimer::is_pipeline_statistics_enabled() const
+{
+	return statistics_enabled;
+}
+
+void GpuFrameTimer::resolve(uint32_t frame_index)
+{
+	if (frame_index >= frames.size())
+	{
+		return;
+	}
+
+	auto &frame = frames[frame_index];
+
+	std::vector<std::string> pass_names;
+	std::swap(pass_names, frame.pass_names);
+
+	bool statistics_active  = frame.statistics_active;
+	frame.statistics_active = false;
+
+	if (!frame.pending)
+	{
+		return;
+	}
+
+	// The queries are reset by the next submission of the frame anyway
+	frame.pending = false;
+
+	uint32_t              query_count = 2 + 2 * to_u32(pass_names.size());
+	std::vector<uint64_t> timestamps(query_count);
+	VkResult              result = vkGetQueryPoolResults(device.get_handle(), frame.query_pool, 0, query_count, timestamps.size() * sizeof(uint64_t),
+	                                                     timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS)
+	{
+		return;
+	}
+
+	auto to_milliseconds = [this](uint64_t begin, uint64_t end) {
+		uint64_t ticks = (end - begin) & timestamp_mask;
+		return static_cast<float>(static_cast<double>(ticks) * timestamp_period / 1000000.0);
+	};
+
+	frame_time = to_milliseconds(timestamps[0], timestamps[1]);
+
+	pass_times.clear();
+	for (size_t i = 0; i < pass_names.size(); ++i)
+	{
+		pass_times.push_back({std::move(pass_names[i]), to_milliseconds(timestamps[2 + 2 * i], timestamps[2 + 2 * i + 1])});
+	}
+
+	if (statistics_active && !pass_times.empty())
+	{
+		std::vector<PipelineStatistics> statistics(pass_times.size());
+		result = vkGetQueryPoolResults(device.get_handle(), frame.statistics_pool, 0, to_u32(statistics.size()), statistics.size() * sizeof(PipelineStatistics),
+		                               statistics.data(), sizeof(PipelineStatistics), VK_QUERY_RESULT_64_BIT);
+		if (result == VK_SUCCESS)
+		{
+			for (size_t i = 0; i < pass_times.size(); ++i)
+			{
+				pass_times[i].has_statistics = true;
+				pass_times[i].statistics     = statistics[i];
+			}
+		}
+	}
+
+	if (calibration)
+	{
+		calibration->update();
+
+		frame_start = calibration->to_host_time(timestamps[0] & timestamp_mask);
+		for (size_t i = 0; i < pass_times.size(); ++i)
+		{
+			pass_times[i].start = calibration->to_host_time(timestamps[2 + 2 * i] & timestamp_mask);
+		}
+
+		submit_latency = std::chrono::duration<float, std::milli>(frame_start - frame.submit_time).count();
+	}
+
+	frame_number = frame.frame_number;
+	resolved_count++;
+}
+
+float GpuFrameTimer::get_frame_time() const
+{
+	return frame_time;
+}
+
+Timer::Clock::time_point GpuFrameTimer::get_frame_start() const
+{
+	return frame_start;
+}
+
+float GpuFrameTimer::get_submit_latency() const
+{
+	return submit_latency;
+}
+
+const TimestampCalibration *GpuFrameTimer::get_calibration() const
+{
+	return calibration.get();
+}
+
+uint64_t GpuFrameTimer::get_frame_number() const
+{
+	return frame_number;
+}
+
+uint64_t GpuFrameTimer::get_resolved_count() const
+{
+	return resolved_count;
+}
+
+const std::vector<GpuFrameTimer::PassTime> &GpuFrameTimer::get_pass_times() const
+{
+	return pass_times;
+}
+
+GpuFrameTimer::FrameQueries &GpuFrameTimer::get_frame(uint32_t frame_index)
+{
+	if (frame_index >= frames.size())
+	{
+		frames.resize(frame_index + 1);
+	}
+
+	auto &frame = frames[frame_index];
+	if (frame.query_pool != VK_NULL_HANDLE)
+	{
+		return frame;
+	}
+
+	VkQueryPoolCreateInfo query_pool_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+	query_pool_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	query_pool_info.queryCount = QueryCount;
+	VK_CHECK(vkCreateQueryPool(device.get_handle(), &query_pool_info, nullptr, &frame.query_pool));
+
+	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocate_info.commandPool        = command_pool;
+	allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount = 2;
+
+	VkCommandBuffer command_buffers[2];
+	VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, command_buffers));
+	frame.begin_commands = command_buffers[0];
+	frame.end_commands   = command_buffers[1];
+
+	VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+
+	VK_CHECK(vkBeginCommandBuffer(frame.begin_commands, &begin_info));
+	vkCmdResetQueryPool(frame.begin_commands, frame.query_pool, 0, QueryCount);
+	vkCmdWriteTimestamp(frame.begin_commands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.query_pool, 0);
+	VK_CHECK(vkEndCommandBuffer(frame.begin_commands));
+
+	VK_CHECK(vkBeginCommandBuffer(frame.end_commands, &begin_info));
+	vkCmdWriteTimestamp(frame.end_commands, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.query_pool, 1);
+	VK_CHECK(vkEndCommandBuffer(frame.end_commands));
+
+	return frame;
+}
+
+void GpuFrameTimer::create_statistics_queries(FrameQueries &frame)
+{
+	VkQueryPoolCreateInfo query_pool_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+	query_pool_info.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	query_pool_info.queryCount         = MaxPasses;
+	query_pool_info.pipelineStatistics = PipelineStatisticFlags;
+	VK_CHECK(vkCreateQueryPool(device.get_handle(), &query_pool_info, nullptr, &frame.statistics_pool));
+
+	VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+	allocate_info.commandPool        = command_pool;
+	allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount = 1;
+	VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, &frame.statistics_reset_commands));
+
+	// Separate from the command buffer starting the frame, which was recorded before the statistics were enabled
+	VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+	VK_CHECK(vkBeginCommandBuffer(frame.statistics_reset_commands, &begin_info));
+	vkCmdResetQueryPool(frame.statistics_reset_commands, frame.statistics_pool, 0, MaxPasses);
+	VK_CHECK(vkEndCommandBuffer(frame.statistics_reset_commands));
+}
+}        // namespace vkb
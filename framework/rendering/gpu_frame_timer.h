@@ -0,0 +1,250 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "rendering/timestamp_calibration.h"
+
+namespace vkb
+{
+class Device;
+class SubmissionBuilder;
+
+/**
+ * @brief Measures the GPU time of frames and of their passes with timestamp queries
+ *
+ * Each frame has a pair of timestamps, written by command buffers recorded once and added around the
+ * command buffers of its last submission. The timestamps are read when the frame is reused, after its
+ * fence or timeline was waited for, so reading them never stalls and the times lag a few frames behind.
+ *
+ * The render and postprocessing pipelines also bracket their passes with a pair of timestamps, which the
+ * command buffer starting the frame resets with the ones of the frame.
+ *
+ * If the device can calibrate its timestamps, the times are also placed on the clock of vkb::Timer, so they
+ * line up with the CPU scopes, and the time between the submission of a frame and the GPU starting it is measured.
+ *
+ * Optionally the passes are also bracketed with pipeline statistics queries, counting their vertices, primitives and
+ * shader invocations, see enable_pipeline_statistics(). They are read with the timestamps, so they don't stall either.
+ */
+class GpuFrameTimer
+{
+  public:
+	/// Number of passes timed per frame, the following ones aren't timed
+	static constexpr uint32_t MaxPasses = 8;
+
+	/// Counters of a pass, in the order of the bits of VkQueryPipelineStatisticFlagBits they are queried with
+	struct PipelineStatistics
+	{
+		uint64_t input_assembly_vertices{0};
+
+		uint64_t input_assembly_primitives{0};
+
+		uint64_t vertex_shader_invocations{0};
+
+		uint64_t clipping_invocations{0};
+
+		/// Primitives output by the clipping stage, i.e. the ones left after culling
+		uint64_t clipping_primitives{0};
+
+		uint64_t fragment_shader_invocations{0};
+
+		uint64_t compute_shader_invocations{0};
+	};
+
+	struct PassTime
+	{
+		std::string name;
+
+		/// GPU time in milliseconds
+		float time;
+
+		/// Host time the GPU started the pass at, only set with a calibration
+		Timer::Clock::time_point start{};
+
+		/// Whether the pipeline statistics of the pass were counted
+		bool has_statistics{false};
+
+		PipelineStatistics statistics{};
+	};
+
+	/**
+	 * @return Whether the queues of a family support timestamps
+	 */
+	static bool is_supported(Device &device, uint32_t queue_family_index);
+
+	/**
+	 * @return Whether the device can count the pipeline statistics of the passes on the queues of a family,
+	 *         which needs the pipelineStatisticsQuery feature to be requested and a graphics queue
+	 */
+	static bool is_pipeline_statistics_supported(Device &device, uint32_t queue_family_index);
+
+	GpuFrameTimer(Device &device, uint32_t queue_family_index);
+
+	GpuFrameTimer(const GpuFrameTimer &) = delete;
+
+	GpuFrameTimer(GpuFrameTimer &&) = delete;
+
+	~GpuFrameTimer();
+
+	GpuFrameTimer &operator=(const GpuFrameTimer &) = delete;
+
+	GpuFrameTimer &operator=(GpuFrameTimer &&) = delete;
+
+	/**
+	 * @brief Adds the command buffer writing the first timestamp of a frame, before any of its command buffers
+	 */
+	void begin(SubmissionBuilder &submission, uint32_t frame_index);
+
+	/**
+	 * @brief Adds the command buffer writing the last timestamp of a frame, after all of its command buffers
+	 */
+	void end(SubmissionBuilder &submission, uint32_t frame_index);
+
+	/**
+	 * @brief Writes the timestamp starting a pass, to be recorded in a command buffer of the active frame
+	 * @return The index to end the pass with, MaxPasses if the frame has no timestamps left for it
+	 */
+	uint32_t begin_pass(VkCommandBuffer command_buffer, uint32_t frame_index, const std::string &name);
+
+	void end_pass(VkCommandBuffer command_buffer, uint32_t frame_index, uint32_t pass);
+
+	/**
+	 * @brief Counts the pipeline statistics of the passes of the frames begun from now on
+	 *        Passes recorded in a multiview render pass take a query per view, so they can't be counted.
+	 * @return Whether the device supports them, see is_pipeline_statistics_supported()
+	 */
+	bool enable_pipeline_statistics();
+
+	bool is_pipeline_statistics_enabled() const;
+
+	/**
+	 * @brief Reads the timestamps of a frame, to be called once its submissions completed
+	 */
+	void resolve(uint32_t frame_index);
+
+	/**
+	 * @return The GPU time of the last resolved frame in milliseconds
+	 */
+	float get_frame_time() const;
+
+	/**
+	 * @return The host time the GPU started the last resolved frame at, only set with a calibration
+	 */
+	Timer::Clock::time_point get_frame_start() const;
+
+	/**
+	 * @return The time in milliseconds between the submission of the last resolved frame and the GPU starting it,
+	 *         zero without a calibration. Long latencies show the GPU idling while the CPU records the frames.
+	 */
+	float get_submit_latency() const;
+
+	/**
+	 * @return The calibration of the timestamps, nullptr if the device doesn't support it
+	 */
+	const TimestampCalibration *get_calibration() const;
+
+	/**
+	 * @return The number of the last resolved frame, counting the frames ended since the timer was created
+	 *         Only valid once get_resolved_count() is not zero.
+	 */
+	uint64_t get_frame_number() const;
+
+	/**
+	 * @return The number of frames resolved so far
+	 */
+	uint64_t get_resolved_count() const;
+
+	/**
+	 * @return The GPU time of the passes of the last resolved frame, in the order they were recorded
+	 */
+	const std::vector<PassTime> &get_pass_times() const;
+
+  private:
+	struct FrameQueries
+	{
+		VkQueryPool query_pool{VK_NULL_HANDLE};
+
+		VkCommandBuffer begin_commands{VK_NULL_HANDLE};
+
+		VkCommandBuffer end_commands{VK_NULL_HANDLE};
+
+		/// Whether the timestamps were submitted and not read yet
+		bool pending{false};
+
+		uint64_t frame_number{0};
+
+		/// Host time the frame was submitted at
+		Timer::Clock::time_point submit_time{};
+
+		/// Names of the passes recorded for the frame, their timestamps follow the ones of the frame
+		std::vector<std::string> pass_names;
+
+		/// A pipeline statistics query per pass, created once they are enabled
+		VkQueryPool statistics_pool{VK_NULL_HANDLE};
+
+		VkCommandBuffer statistics_reset_commands{VK_NULL_HANDLE};
+
+		/// Whether the passes of the frame count their pipeline statistics
+		bool statistics_active{false};
+	};
+
+	/**
+	 * @brief Creates the queries of a frame on its first use, the number of frames can grow with the swapchain
+	 */
+	FrameQueries &get_frame(uint32_t frame_index);
+
+	void create_statistics_queries(FrameQueries &frame);
+
+	Device &device;
+
+	uint32_t queue_family_index;
+
+	bool statistics_enabled{false};
+
+	VkCommandPool command_pool{VK_NULL_HANDLE};
+
+	/// Nanoseconds per timestamp tick
+	float timestamp_period{1.0f};
+
+	/// Masks the bits of the timestamps the queue doesn't write
+	uint64_t timestamp_mask{~0ull};
+
+	std::vector<FrameQueries> frames;
+
+	uint64_t ended_count{0};
+
+	uint64_t resolved_count{0};
+
+	uint64_t frame_number{0};
+
+	float frame_time{0.0f};
+
+	std::vector<PassTime> pass_times;
+
+	std::unique_ptr<TimestampCalibration> calibration;
+
+	Timer::Clock::time_point frame_start{};
+
+	float submit_latency{0.0f};
+};
+}        // namespace vkb
@@ -0,0 +1,139 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/gpu_scene.h"
+
+#include <algorithm>
+
+#include "common/helpers.h"
+#include "core/command_buffer.h"
+#include "core/device.h"
+#include "core/util/profiling.hpp"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+GpuScene::GpuScene(Device &device, sg::Scene &scene)
+{
+	for (auto mesh : scene.get_components<sg::Mesh>())
+	{
+		for (auto node : mesh->get_nodes())
+		{
+			if (node_indices.emplace(node, to_u32(nodes.size())).second)
+			{
+				nodes.push_back(node);
+			}
+		}
+	}
+
+	uploaded_versions.resize(nodes.size());
+
+	buffer = std::make_unique<vkb::core::BufferC>(device,
+	                                              std::max<size_t>(nodes.size(), 1) * sizeof(glm::mat4),
+	                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                              VMA_MEMORY_USAGE_GPU_ONLY);
+	buffer->set_debug_name("GPU scene: world matrices");
+}
+
+void GpuScene::update(CommandBuffer &command_buffer)
+{
+	PROFILE_SCOPE("Update GPU scene");
+
+	uploaded_count = 0;
+
+	upload_runs.clear();
+	upload_data.clear();
+
+	for (uint32_t i = 0; i < nodes.size(); ++i)
+	{
+		auto &transform = nodes[i]->get_transform();
+		auto  version   = transform.get_world_matrix_version();
+		if (!initial_upload && version == uploaded_versions[i])
+		{
+			continue;
+		}
+
+		uploaded_versions[i] = version;
+		upload_data.push_back(transform.get_world_matrix());
+
+		if (!upload_runs.empty() && upload_runs.back().first + upload_runs.back().second == i)
+		{
+			++upload_runs.back().second;
+		}
+		else
+		{
+			upload_runs.emplace_back(i, 1);
+		}
+	}
+
+	initial_upload = false;
+
+	if (upload_data.empty())
+	{
+		return;
+	}
+
+	ScopedDebugLabel debug_label{command_buffer, "Upload GPU scene"};
+
+	// The vertex shaders of the previous frame read the entries before they are written again
+	BufferMemoryBarrier reuse_barrier{};
+	reuse_barrier.src_stage_mask  = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+	reuse_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	reuse_barrier.dst_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*buffer, 0, VK_WHOLE_SIZE, reuse_barrier);
+
+	constexpr uint32_t max_run_entries = MaxUpdateSize / sizeof(glm::mat4);
+
+	const glm::mat4 *data = upload_data.data();
+	for (auto &run : upload_runs)
+	{
+		for (uint32_t first = 0; first < run.second; first += max_run_entries)
+		{
+			uint32_t count = std::min(run.second - first, max_run_entries);
+			vkCmdUpdateBuffer(command_buffer.get_handle(), buffer->get_handle(), (run.first + first) * sizeof(glm::mat4), count * sizeof(glm::mat4), data);
+			data += count;
+		}
+	}
+
+	uploaded_count = upload_data.size();
+
+	BufferMemoryBarrier upload_barrier{};
+	upload_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	upload_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+	upload_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	upload_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	command_buffer.buffer_memory_barrier(*buffer, 0, VK_WHOLE_SIZE, upload_barrier);
+}
+
+void GpuScene::bind(CommandBuffer &command_buffer)
+{
+	command_buffer.bind_buffer(*buffer, 0, buffer->get_size(), 0, Binding, 0);
+}
+
+uint32_t GpuScene::get_index(const sg::Node &node) const
+{
+	return node_indices.at(&node);
+}
+
+size_t GpuScene::get_uploaded_count() const
+{
+	return uploaded_count;
+}
+}        // namespace vkb
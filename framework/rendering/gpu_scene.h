@@ -0,0 +1,117 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/glm_common.h"
+#include "core/buffer.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class Device;
+
+namespace sg
+{
+class Node;
+class Scene;
+}        // namespace sg
+
+/**
+ * @brief World matrices of the mesh nodes of a scene, kept in a buffer on the GPU across frames
+ *
+ * Each node with a mesh owns an entry of the buffer. On update, the nodes whose transform was invalidated
+ * since the last upload are found from the versions of their world matrices, and only their entries are
+ * written, runs of consecutive entries being merged into a single vkCmdUpdateBuffer. The upload therefore
+ * scales with the number of moving nodes rather than with the size of the scene.
+ *
+ * Shaders built with the GPU_SCENE definition read the matrices at binding 8 of set 0, indexed by the
+ * instance index, so draws set their first instance to get_index() of their node.
+ */
+class GpuScene
+{
+  public:
+	/// Binding of the matrices in set 0
+	static constexpr uint32_t Binding = 8;
+
+	/// Largest size written by a single vkCmdUpdateBuffer
+	static constexpr size_t MaxUpdateSize = 65536;
+
+	/**
+	 * @param device Device the buffer is created on
+	 * @param scene Scene whose mesh nodes fill the buffer, the nodes can't change afterwards, a new GPU scene is built when they do
+	 */
+	GpuScene(Device &device, sg::Scene &scene);
+
+	GpuScene(const GpuScene &) = delete;
+
+	GpuScene(GpuScene &&) = delete;
+
+	~GpuScene() = default;
+
+	GpuScene &operator=(const GpuScene &) = delete;
+
+	GpuScene &operator=(GpuScene &&) = delete;
+
+	/**
+	 * @brief Writes the entries of the nodes which moved since the last update, then makes them visible to the vertex shaders
+	 *        Must be recorded outside of a render pass.
+	 */
+	void update(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Binds the buffer at Binding of set 0
+	 */
+	void bind(CommandBuffer &command_buffer);
+
+	/**
+	 * @return The index of the entry of a node, which must have a mesh
+	 */
+	uint32_t get_index(const sg::Node &node) const;
+
+	/**
+	 * @return Number of entries written by the last update
+	 */
+	size_t get_uploaded_count() const;
+
+  private:
+	std::vector<sg::Node *> nodes;
+
+	std::unordered_map<const sg::Node *, uint32_t> node_indices;
+
+	/// Version of the world matrix of each node when its entry was last written
+	std::vector<uint32_t> uploaded_versions;
+
+	/// Whether the entries were never written
+	bool initial_upload{true};
+
+	/// Scratch space of update(), reused across frames
+	std::vector<glm::mat4> upload_data;
+
+	/// Runs of consecutive moved nodes, as the index of their first entry and their number
+	std::vector<std::pair<uint32_t, uint32_t>> upload_runs;
+
+	size_t uploaded_count{0};
+
+	std::unique_ptr<vkb::core::BufferC> buffer;
+};
+}        // namespace vkb
@@ -18,7 +18,10 @@
 
 #include "hpp_render_context.h"
 
+#include <limits>
+
 #include <core/hpp_image.h>
+#include <core/util/profiling.hpp>
 
 namespace vkb
 {
@@ -31,29 +34,99 @@ HPPRenderContext::HPPRenderContext(vkb::core::HPPDevice                    &devi
                                    const vkb::Window                       &window,
                                    vk::PresentModeKHR                       present_mode,
                                    std::vector<vk::PresentModeKHR> const   &present_mode_priority_list,
-                                   std::vector<vk::SurfaceFormatKHR> const &surface_format_priority_list) :
-    device{device}, window{window}, queue{device.get_suitable_graphics_queue()}, surface_extent{window.get_extent().width, window.get_extent().height}
+                                   std::vector<vk::SurfaceFormatKHR> const &surface_format_priority_list,
+                                   bool                                     pre_rotation) :
+    device{device}, window{window}, queue{device.get_suitable_graphics_queue()}, surface_extent{window.get_extent().width, window.get_extent().height}, pre_rotation{pre_rotation}
 {
+	auto synchronization2_features = device.get_gpu().get_requested_extension_features<vk::PhysicalDeviceSynchronization2FeaturesKHR>();
+	synchronization2 = device.is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) && synchronization2_features && synchronization2_features->synchronization2;
+
+	auto swapchain_maintenance1_features = device.get_gpu().get_requested_extension_features<vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>();
+	swapchain_maintenance1 = device.is_enabled(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME) && swapchain_maintenance1_features &&
+	                         swapchain_maintenance1_features->swapchainMaintenance1;
+
+	frame_pacer = std::make_unique<vkb::FramePacer>(reinterpret_cast<vkb::Device &>(device));
+
 	if (surface)
 	{
 		vk::SurfaceCapabilitiesKHR surface_properties = device.get_gpu().get_handle().getSurfaceCapabilitiesKHR(surface);
 
+		vk::Extent2D                    extent;
+		vk::SurfaceTransformFlagBitsKHR transform = vk::SurfaceTransformFlagBitsKHR::eIdentity;
 		if (surface_properties.currentExtent.width == 0xFFFFFFFF)
 		{
-			swapchain =
-			    std::make_unique<vkb::core::HPPSwapchain>(device, surface, present_mode, present_mode_priority_list, surface_format_priority_list, surface_extent);
+			extent = surface_extent;
 		}
-		else
+		else if (pre_rotation)
+		{
+			extent = surface_properties.currentExtent;
+			if (surface_properties.currentTransform & (vk::SurfaceTransformFlagBitsKHR::eRotate90 | vk::SurfaceTransformFlagBitsKHR::eRotate270))
+			{
+				// Pre-rotation: always use native orientation i.e. if rotated, use width and height of identity transform
+				std::swap(extent.width, extent.height);
+			}
+			transform = surface_properties.currentTransform;
+		}
+
+		// The swapchain takes the ownership of the display if the window asked for the exclusive fullscreen mode
+		swapchain = std::make_unique<vkb::core::HPPSwapchain>(device,
+		                                                      surface,
+		                                                      present_mode,
+		                                                      present_mode_priority_list,
+		                                                      surface_format_priority_list,
+		                                                      extent,
+		                                                      3,
+		                                                      transform,
+		                                                      std::set<vk::ImageUsageFlagBits>{vk::ImageUsageFlagBits::eColorAttachment, vk::ImageUsageFlagBits::eTransferSrc},
+		                                                      nullptr,
+		                                                      window.get_full_screen_exclusive_monitor());
+
+		pre_transform = swapchain->get_transform();
+	}
+}
+
+HPPRenderContext::~HPPRenderContext()
+{
+	if (!queue_timelines.empty())
+	{
+		device.get_handle().waitIdle();
+
+		// The retired objects can't be collected once the timelines are gone
+		device.get_deferred_destruction_queue().clear();
+
+		for (auto &timeline : queue_timelines)
+		{
+			device.get_handle().destroySemaphore(vk::Semaphore(timeline.semaphore));
+		}
+	}
+
+	// The presents aren't waited for by the device going idle
+	if (!present_fences.empty())
+	{
+		vk::Result result = device.get_handle().waitForFences(present_fences, true, std::numeric_limits<uint64_t>::max());
+		if (result != vk::Result::eSuccess)
 		{
-			swapchain = std::make_unique<vkb::core::HPPSwapchain>(device, surface, present_mode, present_mode_priority_list, surface_format_priority_list);
+			LOGE("Detected Vulkan error: {}", vkb::to_string(result));
 		}
 	}
+
+	for (auto fence : present_fences)
+	{
+		device.get_handle().destroyFence(fence);
+	}
+
+	for (auto fence : free_present_fences)
+	{
+		device.get_handle().destroyFence(fence);
+	}
 }
 
 void HPPRenderContext::prepare(size_t thread_count, vkb::rendering::HPPRenderTarget::CreateFunc create_render_target_func)
 {
 	device.get_handle().waitIdle();
 
+	buffer_rings = std::make_shared<vkb::BufferRingSet>(reinterpret_cast<vkb::Device &>(device), swapchain ? to_u32(swapchain->get_images().size()) : OFFSCREEN_FRAME_COUNT);
+
 	if (swapchain)
 	{
 		surface_extent = swapchain->get_extent();
@@ -64,22 +137,25 @@ void HPPRenderContext::prepare(size_t thread_count, vkb::rendering::HPPRenderTar
 		{
 			auto swapchain_image = core::HPPImage{device, image_handle, extent, swapchain->get_format(), swapchain->get_usage()};
 			auto render_target   = create_render_target_func(std::move(swapchain_image));
-			frames.emplace_back(std::make_unique<vkb::rendering::HPPRenderFrame>(device, std::move(render_target), thread_count));
+			frames.emplace_back(std::make_unique<vkb::rendering::HPPRenderFrame>(device, std::move(render_target), thread_count, buffer_rings));
 		}
 	}
 	else
 	{
-		// Otherwise, create a single RenderFrame
+		// Otherwise, create the offscreen RenderFrames
 		swapchain = nullptr;
 
-		auto color_image = vkb::core::HPPImage{device,
-		                                       vk::Extent3D{surface_extent.width, surface_extent.height, 1},
-		                                       DEFAULT_VK_FORMAT,        // We can use any format here that we like
-		                                       vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
-		                                       VMA_MEMORY_USAGE_GPU_ONLY};
-
-		auto render_target = create_render_target_func(std::move(color_image));
-		frames.emplace_back(std::make_unique<vkb::rendering::HPPRenderFrame>(device, std::move(render_target), thread_count));
+		for (uint32_t i = 0; i < OFFSCREEN_FRAME_COUNT; ++i)
+		{
+			auto color_image = vkb::core::HPPImage{device,
+			                                       vk::Extent3D{surface_extent.width, surface_extent.height, 1},
+			                                       DEFAULT_VK_FORMAT,        // We can use any format here that we like
+			                                       vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+			                                       VMA_MEMORY_USAGE_GPU_ONLY};
+
+			auto render_target = create_render_target_func(std::move(color_image));
+			frames.emplace_back(std::make_unique<vkb::rendering::HPPRenderFrame>(device, std::move(render_target), thread_count, buffer_rings));
+		}
 	}
 
 	this->create_render_target_func = create_render_target_func;
@@ -102,7 +178,7 @@ void HPPRenderContext::update_swapchain(const vk::Extent2D &extent)
 
 	device.get_resource_cache().clear_framebuffers();
 
-	swapchain = std::make_unique<vkb::core::HPPSwapchain>(*swapchain, extent);
+	replace_swapchain(std::make_unique<vkb::core::HPPSwapchain>(*swapchain, extent));
 
 	recreate();
 }
@@ -117,9 +193,22 @@ void HPPRenderContext::update_swapchain(const uint32_t image_count)
 
 	device.get_resource_cache().clear_framebuffers();
 
-	device.get_handle().waitIdle();
+	replace_swapchain(std::make_unique<vkb::core::HPPSwapchain>(*swapchain, image_count));
+
+	recreate();
+}
+
+void HPPRenderContext::update_swapchain(const uint32_t image_count, const vk::PresentModeKHR present_mode)
+{
+	if (!swapchain)
+	{
+		LOGW("Can't update the swapchains image count and present mode. No swapchain, offscreen rendering detected, skipping.");
+		return;
+	}
+
+	device.get_resource_cache().clear_framebuffers();
 
-	swapchain = std::make_unique<vkb::core::HPPSwapchain>(*swapchain, image_count);
+	replace_swapchain(std::make_unique<vkb::core::HPPSwapchain>(*swapchain, image_count, present_mode));
 
 	recreate();
 }
@@ -134,7 +223,7 @@ void HPPRenderContext::update_swapchain(const std::set<vk::ImageUsageFlagBits> &
 
 	device.get_resource_cache().clear_framebuffers();
 
-	swapchain = std::make_unique<vkb::core::HPPSwapchain>(*swapchain, image_usage_flags);
+	replace_swapchain(std::make_unique<vkb::core::HPPSwapchain>(*swapchain, image_usage_flags));
 
 	recreate();
 }
@@ -157,7 +246,7 @@ void HPPRenderContext::update_swapchain(const vk::Extent2D &extent, const vk::Su
 		std::swap(width, height);
 	}
 
-	swapchain = std::make_unique<vkb::core::HPPSwapchain>(*swapchain, vk::Extent2D{width, height}, transform);
+	replace_swapchain(std::make_unique<vkb::core::HPPSwapchain>(*swapchain, vk::Extent2D{width, height}, transform));
 
 	// Save the preTransform attribute for future rotations
 	pre_transform = transform;
@@ -165,32 +254,64 @@ void HPPRenderContext::update_swapchain(const vk::Extent2D &extent, const vk::Su
 	recreate();
 }
 
-void HPPRenderContext::recreate()
+void HPPRenderContext::set_pre_rotation_enabled(bool enabled)
 {
-	LOGI("Recreated swapchain");
+	pre_rotation = enabled;
 
-	vk::Extent2D swapchain_extent = swapchain->get_extent();
-	vk::Extent3D extent{swapchain_extent.width, swapchain_extent.height, 1};
+	if (!swapchain)
+	{
+		LOGW("Can't update the swapchains surface transform. No swapchain, offscreen rendering detected, skipping.");
+		return;
+	}
+
+	vk::SurfaceCapabilitiesKHR surface_properties = device.get_gpu().get_handle().getSurfaceCapabilitiesKHR(swapchain->get_surface());
+
+	auto extent = surface_properties.currentExtent.width == 0xFFFFFFFF ? surface_extent : surface_properties.currentExtent;
+
+	update_swapchain(extent, enabled ? surface_properties.currentTransform : vk::SurfaceTransformFlagBitsKHR::eIdentity);
+}
+
+bool HPPRenderContext::is_pre_rotation_enabled() const
+{
+	return pre_rotation;
+}
+
+glm::mat4 HPPRenderContext::get_pre_rotation() const
+{
+	if (!swapchain)
+	{
+		return glm::mat4(1.0f);
+	}
 
-	auto frame_it = frames.begin();
+	const glm::vec3 rotation_axis{0.0f, 0.0f, 1.0f};
 
-	for (auto &image_handle : swapchain->get_images())
+	auto transform = swapchain->get_transform();
+	if (transform == vk::SurfaceTransformFlagBitsKHR::eRotate90)
+	{
+		return glm::rotate(glm::radians(90.0f), rotation_axis);
+	}
+	else if (transform == vk::SurfaceTransformFlagBitsKHR::eRotate270)
+	{
+		return glm::rotate(glm::radians(270.0f), rotation_axis);
+	}
+	else if (transform == vk::SurfaceTransformFlagBitsKHR::eRotate180)
 	{
-		vkb::core::HPPImage swapchain_image{device, image_handle, extent, swapchain->get_format(), swapchain->get_usage()};
+		return glm::rotate(glm::radians(180.0f), rotation_axis);
+	}
 
-		auto render_target = create_render_target_func(std::move(swapchain_image));
+	return glm::mat4(1.0f);
+}
 
-		if (frame_it != frames.end())
-		{
-			(*frame_it)->update_render_target(std::move(render_target));
-		}
-		else
-		{
-			// Create a new frame if the new swapchain has more images than current frames
-			frames.emplace_back(std::make_unique<vkb::rendering::HPPRenderFrame>(device, std::move(render_target), thread_count));
-		}
+void HPPRenderContext::recreate()
+{
+	LOGI("Recreated swapchain");
 
-		++frame_it;
+	// The render targets of the current frames are recreated when they are used next, instead of all at once
+	while (frames.size() < swapchain->get_images().size())
+	{
+		// Create a new frame if the new swapchain has more images than current frames
+		frames.emplace_back(std::make_unique<vkb::rendering::HPPRenderFrame>(device, create_swapchain_render_target(to_u32(frames.size())), thread_count, buffer_rings));
+		outdated_render_targets.push_back(false);
 	}
 
 	device.get_resource_cache().clear_framebuffers();
@@ -211,17 +332,20 @@ bool HPPRenderContext::handle_surface_changes(bool force_update)
 		return false;
 	}
 
-	// Only recreate the swapchain if the dimensions have changed;
+	// A pre-rotated swapchain follows the orientation of the display, which changes
+	// without a resize when it turns by 180 degrees
+	auto transform = pre_rotation ? surface_properties.currentTransform : pre_transform;
+
+	// Only recreate the swapchain if the dimensions or the orientation have changed;
 	// handle_surface_changes() is called on VK_SUBOPTIMAL_KHR,
 	// which might not be due to a surface resize
 	if (surface_properties.currentExtent.width != surface_extent.width ||
 	    surface_properties.currentExtent.height != surface_extent.height ||
+	    transform != pre_transform ||
 	    force_update)
 	{
-		// Recreate swapchain
-		device.get_handle().waitIdle();
-
-		update_swapchain(surface_properties.currentExtent, pre_transform);
+		// Recreate swapchain, the resources in use by frames in flight are retired to the deferred destruction queue
+		update_swapchain(surface_properties.currentExtent, transform);
 
 		surface_extent = surface_properties.currentExtent;
 
@@ -260,27 +384,74 @@ void HPPRenderContext::submit(const std::vector<vkb::core::HPPCommandBuffer *> &
 
 	vk::Semaphore render_semaphore;
 
+	if (!gpu_frame_timer)
+	{
+		if (swapchain)
+		{
+			assert(acquired_semaphore && "We do not have acquired_semaphore, it was probably consumed?\n");
+			render_semaphore = submit(queue, command_buffers, acquired_semaphore, vk::PipelineStageFlagBits::eColorAttachmentOutput);
+		}
+		else
+		{
+			submit(queue, command_buffers);
+		}
+
+		end_frame(render_semaphore);
+		return;
+	}
+
+	// The timestamps of the frame surround the command buffers of its last submission
+	vkb::SubmissionBuilder submission = begin_submission(queue);
+
 	if (swapchain)
 	{
 		assert(acquired_semaphore && "We do not have acquired_semaphore, it was probably consumed?\n");
-		render_semaphore = submit(queue, command_buffers, acquired_semaphore, vk::PipelineStageFlagBits::eColorAttachmentOutput);
+		submission.wait(static_cast<VkSemaphore>(acquired_semaphore), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
 	}
-	else
+
+	gpu_frame_timer->begin(submission, active_frame_index);
+	for (auto *command_buffer : command_buffers)
+	{
+		submission.add_command_buffer(static_cast<VkCommandBuffer>(command_buffer->get_handle()));
+		redundant_command_count.fetch_add(command_buffer->get_redundant_command_count(), std::memory_order_relaxed);
+	}
+	gpu_frame_timer->end(submission, active_frame_index);
+
+	if (swapchain)
 	{
-		submit(queue, command_buffers);
+		render_semaphore = get_active_frame().request_semaphore();
+		submission.signal(static_cast<VkSemaphore>(render_semaphore));
 	}
 
+	submit(submission);
+
 	end_frame(render_semaphore);
 }
 
 void HPPRenderContext::begin_frame()
 {
+	PROFILE_SCOPE("Begin Frame");
+
+	device.get_deferred_destruction_queue().collect();
+	device.get_resource_cache().Trim();
+
+	// A capture starts after the present of the previous frame, the labels of this one are recorded for it
+	vkb::DebugLabels::update();
+
 	// Only handle surface changes if a swapchain exists
 	if (swapchain)
 	{
 		handle_surface_changes();
 	}
 
+	if (swapchain_controller && swapchain_controller->begin_frame())
+	{
+		auto &configuration = swapchain_controller->get_configuration();
+		update_swapchain(configuration.image_count, static_cast<vk::PresentModeKHR>(configuration.present_mode));
+	}
+
+	frame_pacer->begin_render(swapchain ? static_cast<VkSwapchainKHR>(swapchain->get_handle()) : VK_NULL_HANDLE);
+
 	assert(!frame_active && "Frame is still active, please call end_frame");
 
 	auto &prev_frame = *frames[active_frame_index];
@@ -289,17 +460,41 @@ void HPPRenderContext::begin_frame()
 	// so we need to hold ownership.
 	acquired_semaphore = prev_frame.request_semaphore_with_ownership();
 
+	if (alternate_frame_rendering)
+	{
+		active_device_index = (active_device_index + 1) % device.get_physical_device_count();
+	}
+
 	if (swapchain)
 	{
+		// Direct-to-display windows start the frames on the vertical blanking with vsync,
+		// so each presented image is rendered from input sampled one refresh earlier at most
+		if (swapchain->get_present_mode() == vk::PresentModeKHR::eFifo && device.is_enabled(VK_EXT_DISPLAY_CONTROL_EXTENSION_NAME))
+		{
+			window.wait_for_vblank(static_cast<VkDevice>(device.get_handle()));
+		}
+
 		vk::Result result;
+		auto       acquire_start = std::chrono::steady_clock::now();
 		try
 		{
-			std::tie(result, active_frame_index) = swapchain->acquire_next_image(acquired_semaphore);
+			std::tie(result, active_frame_index) = swapchain->acquire_next_image(acquired_semaphore, nullptr, get_active_device_mask());
 		}
 		catch (vk::OutOfDateKHRError & /*err*/)
 		{
 			result = vk::Result::eErrorOutOfDateKHR;
 		}
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+		catch (vk::FullScreenExclusiveModeLostEXTError & /*err*/)
+		{
+			result = vk::Result::eErrorFullScreenExclusiveModeLostEXT;
+		}
+#endif
+
+		if (swapchain_controller)
+		{
+			swapchain_controller->record_acquire_wait(std::chrono::steady_clock::now() - acquire_start);
+		}
 
 		if (result == vk::Result::eSuboptimalKHR || result == vk::Result::eErrorOutOfDateKHR)
 		{
@@ -316,22 +511,40 @@ void HPPRenderContext::begin_frame()
 				// Need to destroy and reallocate acquired_semaphore since it may have already been signaled
 				device.get_handle().destroySemaphore(acquired_semaphore);
 				acquired_semaphore                   = prev_frame.request_semaphore_with_ownership();
-				std::tie(result, active_frame_index) = swapchain->acquire_next_image(acquired_semaphore);
+				std::tie(result, active_frame_index) = swapchain->acquire_next_image(acquired_semaphore, nullptr, get_active_device_mask());
 			}
 		}
 
+		if (result == vk::Result::eErrorFullScreenExclusiveModeLostEXT)
+		{
+			// The frame is skipped, rendering resumes once the window owns the display again
+			swapchain->acquire_full_screen_exclusive();
+		}
+
 		if (result != vk::Result::eSuccess)
 		{
 			prev_frame.reset();
 			return;
 		}
 	}
+	else
+	{
+		// The offscreen frames are rendered in turn, like the images of a swapchain
+		active_frame_index = (active_frame_index + 1) % to_u32(frames.size());
+	}
+
+	update_render_target(active_frame_index);
 
 	// Now the frame is active again
 	frame_active = true;
 
 	// Wait on all resource to be freed from the previous render to this frame
 	wait_frame();
+
+	if (gpu_frame_timer)
+	{
+		gpu_frame_timer->resolve(active_frame_index);
+	}
 }
 
 vk::Semaphore HPPRenderContext::submit(const vkb::core::HPPQueue                        &queue,
@@ -339,48 +552,200 @@ vk::Semaphore HPPRenderContext::submit(const vkb::core::HPPQueue
                                        vk::Semaphore                                     wait_semaphore,
                                        vk::PipelineStageFlags                            wait_pipeline_stage)
 {
-	std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
-	std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(), [](const vkb::core::HPPCommandBuffer *cmd_buf) { return cmd_buf->get_handle(); });
-
-	vkb::rendering::HPPRenderFrame &frame = get_active_frame();
+	vkb::SubmissionBuilder submission = begin_submission(queue);
 
-	vk::Semaphore signal_semaphore = frame.request_semaphore();
-
-	vk::SubmitInfo submit_info(nullptr, nullptr, cmd_buf_handles, signal_semaphore);
 	if (wait_semaphore)
 	{
-		submit_info.setWaitSemaphores(wait_semaphore);
-		submit_info.pWaitDstStageMask = &wait_pipeline_stage;
+		submission.wait(static_cast<VkSemaphore>(wait_semaphore), static_cast<VkPipelineStageFlags>(wait_pipeline_stage));
+	}
+
+	for (auto *command_buffer : command_buffers)
+	{
+		submission.add_command_buffer(static_cast<VkCommandBuffer>(command_buffer->get_handle()));
+		redundant_command_count.fetch_add(command_buffer->get_redundant_command_count(), std::memory_order_relaxed);
 	}
 
-	vk::Fence fence = frame.request_fence();
+	vk::Semaphore signal_semaphore = get_active_frame().request_semaphore();
+	submission.signal(static_cast<VkSemaphore>(signal_semaphore));
 
-	queue.get_handle().submit(submit_info, fence);
+	submit(submission);
 
 	return signal_semaphore;
 }
 
 void HPPRenderContext::submit(const vkb::core::HPPQueue &queue, const std::vector<vkb::core::HPPCommandBuffer *> &command_buffers)
 {
-	std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
-	std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(), [](const vkb::core::HPPCommandBuffer *cmd_buf) { return cmd_buf->get_handle(); });
+	vkb::SubmissionBuilder submission = begin_submission(queue);
+
+	for (auto *command_buffer : command_buffers)
+	{
+		submission.add_command_buffer(static_cast<VkCommandBuffer>(command_buffer->get_handle()));
+		redundant_command_count.fetch_add(command_buffer->get_redundant_command_count(), std::memory_order_relaxed);
+	}
+
+	submit(submission);
+}
+
+vkb::SubmissionBuilder HPPRenderContext::begin_submission(const vkb::core::HPPQueue &queue) const
+{
+	vkb::SubmissionBuilder submission{static_cast<VkQueue>(queue.get_handle()), synchronization2};
+	submission.set_device_mask(get_active_device_mask());
+	return submission;
+}
+
+void HPPRenderContext::submit(vkb::SubmissionBuilder &submission)
+{
+	PROFILE_SCOPE("Submit");
 
 	vkb::rendering::HPPRenderFrame &frame = get_active_frame();
 
-	vk::SubmitInfo submit_info(nullptr, nullptr, cmd_buf_handles);
+	if (!timeline_semaphores)
+	{
+		VK_CHECK(submission.submit(static_cast<VkFence>(frame.request_fence())));
+		submit_count.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// Signaled after the commands of all the batches, which were submitted before
+	const vkb::QueueTimeline &timeline = advance_timeline(vk::Queue(submission.get_queue()));
+	submission.signal(timeline.semaphore, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR, timeline.value);
+
+	VK_CHECK(submission.submit());
+	submit_count.fetch_add(1, std::memory_order_relaxed);
+
+	frame.add_timeline_wait(timeline);
+	device.get_deferred_destruction_queue().track(timeline);
+}
+
+bool HPPRenderContext::enable_timeline_semaphores()
+{
+	assert(!frame_active && "Timeline semaphores can't be enabled while a frame is active");
+
+	auto features = device.get_gpu().get_requested_extension_features<vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR>();
+	if (!device.is_enabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) || !features || !features->timelineSemaphore)
+	{
+		LOGW("Timeline semaphores need {} and its timelineSemaphore feature, frames are tracked with fences", VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		return false;
+	}
+
+	timeline_semaphores = true;
+
+	return true;
+}
+
+bool HPPRenderContext::uses_timeline_semaphores() const
+{
+	return timeline_semaphores;
+}
+
+void HPPRenderContext::replace_swapchain(std::unique_ptr<vkb::core::HPPSwapchain> &&new_swapchain)
+{
+	std::vector<std::unique_ptr<HPPRenderTarget>> render_targets;
+	for (auto &frame : frames)
+	{
+		render_targets.push_back(frame->release_render_target());
+	}
+	outdated_render_targets.assign(frames.size(), true);
+
+	// The render targets are destroyed before the swapchain owning their images
+	auto retired = std::make_pair(std::move(swapchain), std::move(render_targets));
+
+	if (swapchain_maintenance1)
+	{
+		// The presents waited for the frames rendering to the swapchain, their fences cover all its uses
+		std::vector<VkFence> fences(present_fences.begin(), present_fences.end());
+		device.get_deferred_destruction_queue().retire(std::move(retired), std::move(fences));
+		present_fences.clear();
+	}
+	else
+	{
+		device.get_deferred_destruction_queue().retire(std::move(retired));
+	}
+
+	swapchain = std::move(new_swapchain);
+}
+
+std::unique_ptr<HPPRenderTarget> HPPRenderContext::create_swapchain_render_target(uint32_t image_index)
+{
+	vk::Extent2D swapchain_extent = swapchain->get_extent();
+
+	vkb::core::HPPImage swapchain_image{device,
+	                                    swapchain->get_images()[image_index],
+	                                    vk::Extent3D{swapchain_extent.width, swapchain_extent.height, 1},
+	                                    swapchain->get_format(),
+	                                    swapchain->get_usage()};
+
+	return create_render_target_func(std::move(swapchain_image));
+}
+
+void HPPRenderContext::update_render_target(uint32_t frame_index)
+{
+	// Frames past the image count of the swapchain aren't rendered to anymore
+	if (swapchain && frame_index < outdated_render_targets.size() && outdated_render_targets[frame_index] &&
+	    frame_index < swapchain->get_images().size())
+	{
+		frames[frame_index]->update_render_target(create_swapchain_render_target(frame_index));
+		outdated_render_targets[frame_index] = false;
+	}
+}
+
+vk::Fence HPPRenderContext::request_present_fence()
+{
+	if (!free_present_fences.empty())
+	{
+		vk::Fence fence = free_present_fences.back();
+		free_present_fences.pop_back();
+		return fence;
+	}
+
+	return device.get_handle().createFence({});
+}
+
+void HPPRenderContext::recycle_present_fences()
+{
+	auto completed = std::find_if(present_fences.begin(), present_fences.end(), [this](vk::Fence fence) { return device.get_handle().getFenceStatus(fence) != vk::Result::eSuccess; });
+	if (completed == present_fences.begin())
+	{
+		return;
+	}
+
+	device.get_handle().resetFences(vk::ArrayProxy<const vk::Fence>(to_u32(std::distance(present_fences.begin(), completed)), present_fences.data()));
+
+	free_present_fences.insert(free_present_fences.end(), present_fences.begin(), completed);
+	present_fences.erase(present_fences.begin(), completed);
+}
+
+const vkb::QueueTimeline &HPPRenderContext::advance_timeline(vk::Queue queue)
+{
+	auto it = std::find_if(queue_timelines.begin(), queue_timelines.end(), [queue](const vkb::QueueTimeline &timeline) { return timeline.queue == static_cast<VkQueue>(queue); });
+	if (it == queue_timelines.end())
+	{
+		vk::SemaphoreTypeCreateInfoKHR type_info(vk::SemaphoreType::eTimeline, 0);
+		vk::SemaphoreCreateInfo        create_info({}, &type_info);
+
+		vkb::QueueTimeline timeline{static_cast<VkQueue>(queue)};
+		timeline.semaphore = static_cast<VkSemaphore>(device.get_handle().createSemaphore(create_info));
+
+		queue_timelines.push_back(timeline);
+		it = std::prev(queue_timelines.end());
+	}
 
-	vk::Fence fence = frame.request_fence();
+	++it->value;
 
-	queue.get_handle().submit(submit_info, fence);
+	return *it;
 }
 
 void HPPRenderContext::wait_frame()
 {
+	PROFILE_SCOPE("Wait Frame");
+
 	get_active_frame().reset();
 }
 
 void HPPRenderContext::end_frame(vk::Semaphore semaphore)
 {
+	PROFILE_SCOPE("Present");
+
 	assert(frame_active && "Frame is not active, please call begin_frame");
 
 	if (swapchain)
@@ -396,6 +761,32 @@ void HPPRenderContext::end_frame(vk::Semaphore semaphore)
 			present_info.pNext = &disp_present_info;
 		}
 
+		// Tells when the presentation engine is done with the swapchain, see replace_swapchain
+		vk::Fence                        present_fence;
+		vk::SwapchainPresentFenceInfoEXT present_fence_info;
+		if (swapchain_maintenance1)
+		{
+			recycle_present_fences();
+			present_fence = request_present_fence();
+
+			present_fence_info.pNext = present_info.pNext;
+			present_fence_info.setFences(present_fence);
+			present_info.pNext = &present_fence_info;
+		}
+
+		// Each GPU presents the images it renders
+		uint32_t                      device_mask = get_active_device_mask();
+		vk::DeviceGroupPresentInfoKHR device_group_present_info;
+		if (device_mask != 0)
+		{
+			device_group_present_info.setDeviceMasks(device_mask);
+			device_group_present_info.mode  = vk::DeviceGroupPresentModeFlagBitsKHR::eLocal;
+			device_group_present_info.pNext = present_info.pNext;
+			present_info.pNext              = &device_group_present_info;
+		}
+
+		present_info.pNext = frame_pacer->begin_present(static_cast<VkSwapchainKHR>(vk_swapchain), active_frame_index, present_info.pNext);
+
 		vk::Result result;
 		try
 		{
@@ -405,12 +796,30 @@ void HPPRenderContext::end_frame(vk::Semaphore semaphore)
 		{
 			result = vk::Result::eErrorOutOfDateKHR;
 		}
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+		catch (vk::FullScreenExclusiveModeLostEXTError & /*err*/)
+		{
+			swapchain->acquire_full_screen_exclusive();
+			result = vk::Result::eErrorFullScreenExclusiveModeLostEXT;
+		}
+#endif
+
+		frame_pacer->end_present(static_cast<VkSwapchainKHR>(vk_swapchain));
+
+		if (present_fence)
+		{
+			present_fences.push_back(present_fence);
+		}
 
 		if (result == vk::Result::eSuboptimalKHR || result == vk::Result::eErrorOutOfDateKHR)
 		{
 			handle_surface_changes();
 		}
 	}
+	else
+	{
+		frame_pacer->end_frame(active_frame_index);
+	}
 
 	// Frame is not active anymore
 	if (acquired_semaphore)
@@ -442,6 +851,7 @@ uint32_t HPPRenderContext::get_active_frame_index()
 vkb::rendering::HPPRenderFrame &HPPRenderContext::get_last_rendered_frame()
 {
 	assert(!frame_active && "Frame is still active, please call end_frame");
+	update_render_target(active_frame_index);
 	return *frames[active_frame_index];
 }
 
@@ -467,22 +877,14 @@ vkb::core::HPPDevice &HPPRenderContext::get_device()
 
 void HPPRenderContext::recreate_swapchain()
 {
-	device.get_handle().waitIdle();
 	device.get_resource_cache().clear_framebuffers();
 
-	vk::Extent2D swapchain_extent = swapchain->get_extent();
-	vk::Extent3D extent{swapchain_extent.width, swapchain_extent.height, 1};
-
-	auto frame_it = frames.begin();
-
-	for (auto &image_handle : swapchain->get_images())
+	for (uint32_t i = 0; i < to_u32(swapchain->get_images().size()); ++i)
 	{
-		vkb::core::HPPImage swapchain_image{device, image_handle, extent, swapchain->get_format(), swapchain->get_usage()};
-		auto                render_target = create_render_target_func(std::move(swapchain_image));
-		(*frame_it)->update_render_target(std::move(render_target));
-
-		++frame_it;
+		frames[i]->update_render_target(create_swapchain_render_target(i));
 	}
+
+	outdated_render_targets.assign(frames.size(), false);
 }
 
 bool HPPRenderContext::has_swapchain()
@@ -506,10 +908,149 @@ uint32_t HPPRenderContext::get_active_frame_index() const
 	return active_frame_index;
 }
 
+size_t HPPRenderContext::get_thread_count() const
+{
+	return thread_count;
+}
+
 std::vector<std::unique_ptr<vkb::rendering::HPPRenderFrame>> &HPPRenderContext::get_render_frames()
 {
+	// The caller may use the render target of any frame
+	for (uint32_t i = 0; i < to_u32(frames.size()); ++i)
+	{
+		update_render_target(i);
+	}
+
 	return frames;
 }
 
+void HPPRenderContext::pace_frame()
+{
+	PROFILE_SCOPE("Pace Frame");
+
+	assert(!frame_active && "Frame is still active, please call end_frame");
+
+	frame_pacer->pace(swapchain ? static_cast<VkSwapchainKHR>(swapchain->get_handle()) : VK_NULL_HANDLE);
+
+	uint32_t frame_index;
+	while (frame_pacer->next_frame_to_wait(frame_index))
+	{
+		// The frames may have been recreated with the swapchain since their submission
+		if (frame_index < frames.size())
+		{
+			frames[frame_index]->wait();
+		}
+	}
+}
+
+vkb::FramePacer &HPPRenderContext::get_frame_pacer()
+{
+	return *frame_pacer;
+}
+
+bool HPPRenderContext::enable_gpu_frame_timing()
+{
+	assert(!frame_active && "GPU frame timing can't be enabled while a frame is active");
+
+	if (gpu_frame_timer)
+	{
+		return true;
+	}
+
+	if (!vkb::GpuFrameTimer::is_supported(reinterpret_cast<vkb::Device &>(device), queue.get_family_index()))
+	{
+		LOGW("The queue family of the render context doesn't support timestamps, frames aren't timed on the GPU");
+		return false;
+	}
+
+	gpu_frame_timer = std::make_unique<vkb::GpuFrameTimer>(reinterpret_cast<vkb::Device &>(device), queue.get_family_index());
+
+	return true;
+}
+
+vkb::GpuFrameTimer *HPPRenderContext::get_gpu_frame_timer()
+{
+	return gpu_frame_timer.get();
+}
+
+bool HPPRenderContext::enable_adaptive_swapchain(std::chrono::duration<float> target_frame_time)
+{
+	assert(!frame_active && "The adaptive swapchain can't be enabled while a frame is active");
+
+	if (!swapchain)
+	{
+		LOGW("Can't adapt the swapchain. No swapchain, offscreen rendering detected, skipping.");
+		return false;
+	}
+
+	vk::SurfaceCapabilitiesKHR surface_properties = device.get_gpu().get_handle().getSurfaceCapabilitiesKHR(swapchain->get_surface());
+
+	std::vector<VkPresentModeKHR> present_modes;
+	for (auto present_mode : device.get_gpu().get_handle().getSurfacePresentModesKHR(swapchain->get_surface()))
+	{
+		present_modes.push_back(static_cast<VkPresentModeKHR>(present_mode));
+	}
+
+	bool allow_tearing = window.get_properties().vsync != vkb::Window::Vsync::ON;
+
+	vkb::SwapchainController::Configuration current{to_u32(swapchain->get_images().size()), static_cast<VkPresentModeKHR>(swapchain->get_present_mode())};
+
+	swapchain_controller = std::make_unique<vkb::SwapchainController>(target_frame_time, present_modes, surface_properties.minImageCount, allow_tearing, current);
+
+	auto &configuration = swapchain_controller->get_configuration();
+	if (configuration.image_count != current.image_count || configuration.present_mode != current.present_mode)
+	{
+		update_swapchain(configuration.image_count, static_cast<vk::PresentModeKHR>(configuration.present_mode));
+	}
+
+	return true;
+}
+
+void HPPRenderContext::disable_adaptive_swapchain()
+{
+	swapchain_controller.reset();
+}
+
+vkb::SwapchainController *HPPRenderContext::get_swapchain_controller()
+{
+	return swapchain_controller.get();
+}
+
+bool HPPRenderContext::enable_alternate_frame_rendering()
+{
+	assert(!frame_active && "Alternate frame rendering can't be enabled while a frame is active");
+
+	uint32_t device_count = device.get_physical_device_count();
+	if (device_count < 2)
+	{
+		return false;
+	}
+
+	if (swapchain)
+	{
+		vk::DeviceGroupPresentCapabilitiesKHR capabilities = device.get_handle().getGroupPresentCapabilitiesKHR();
+
+		for (uint32_t i = 0; i < device_count; ++i)
+		{
+			if (!(capabilities.modes & vk::DeviceGroupPresentModeFlagBitsKHR::eLocal) || !(capabilities.presentMask[i] & (1u << i)))
+			{
+				LOGW("GPU {} of the device group can't present its own images, the frames are rendered on all the GPUs", i);
+				return false;
+			}
+		}
+	}
+
+	alternate_frame_rendering = true;
+
+	LOGI("Rendering alternate frames on {} GPUs", device_count);
+
+	return true;
+}
+
+uint32_t HPPRenderContext::get_active_device_mask() const
+{
+	return alternate_frame_rendering ? 1u << active_device_index : 0;
+}
+
 }        // namespace rendering
 }        // namespace vkb
@@ -18,10 +18,19 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+
+#include <common/glm_common.h>
 #include <core/hpp_device.h>
 #include <core/hpp_swapchain.h>
+#include <core/submission_builder.h>
+#include <geometry/lod.h>
 #include <platform/window.h>
+#include <rendering/frame_pacer.h>
+#include <rendering/gpu_frame_timer.h>
 #include <rendering/hpp_render_frame.h>
+#include <rendering/swapchain_controller.h>
 
 namespace vkb
 {
@@ -38,6 +47,15 @@ class HPPRenderContext
 	// The format to use for the RenderTargets if a swapchain isn't created
 	static vk::Format DEFAULT_VK_FORMAT;
 
+	// The number of RenderFrames if a swapchain isn't created
+	static constexpr uint32_t OFFSCREEN_FRAME_COUNT = 3;
+
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+	static constexpr bool DEFAULT_PRE_ROTATION = true;
+#else
+	static constexpr bool DEFAULT_PRE_ROTATION = false;
+#endif
+
 	/**
 	 * @brief Constructor
 	 * @param device A valid device
@@ -46,6 +64,7 @@ class HPPRenderContext
 	 * @param present_mode Requests to set the present mode of the swapchain
 	 * @param present_mode_priority_list The order in which the swapchain prioritizes selecting its present mode
 	 * @param surface_format_priority_list The order in which the swapchain prioritizes selecting its surface format
+	 * @param pre_rotation Whether the swapchain follows the transform of the surface
 	 */
 	HPPRenderContext(vkb::core::HPPDevice                    &device,
 	                 vk::SurfaceKHR                           surface,
@@ -53,13 +72,14 @@ class HPPRenderContext
 	                 vk::PresentModeKHR                       present_mode                 = vk::PresentModeKHR::eFifo,
 	                 std::vector<vk::PresentModeKHR> const   &present_mode_priority_list   = {vk::PresentModeKHR::eFifo, vk::PresentModeKHR::eMailbox},
 	                 std::vector<vk::SurfaceFormatKHR> const &surface_format_priority_list = {
-	                     {vk::Format::eR8G8B8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear}, {vk::Format::eB8G8R8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear}});
+	                     {vk::Format::eR8G8B8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear}, {vk::Format::eB8G8R8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear}},
+	                 bool                                     pre_rotation                 = DEFAULT_PRE_ROTATION);
 
 	HPPRenderContext(const HPPRenderContext &) = delete;
 
 	HPPRenderContext(HPPRenderContext &&) = delete;
 
-	virtual ~HPPRenderContext() = default;
+	virtual ~HPPRenderContext();
 
 	HPPRenderContext &operator=(const HPPRenderContext &) = delete;
 
@@ -84,6 +104,13 @@ class HPPRenderContext
 	 */
 	void update_swapchain(const uint32_t image_count);
 
+	/**
+	 * @brief Updates the swapchains image count and present mode, if a swapchain exists
+	 * @param image_count The amount of images in the new swapchain
+	 * @param present_mode The present mode of the new swapchain
+	 */
+	void update_swapchain(const uint32_t image_count, const vk::PresentModeKHR present_mode);
+
 	/**
 	 * @brief Updates the swapchains image usage, if a swapchain exists
 	 * @param image_usage_flags The usage flags the new swapchain images will have
@@ -97,6 +124,12 @@ class HPPRenderContext
 	 */
 	void update_swapchain(const vk::Extent2D &extent, const vk::SurfaceTransformFlagBitsKHR transform);
 
+	void set_pre_rotation_enabled(bool enabled);
+
+	bool is_pre_rotation_enabled() const;
+
+	glm::mat4 get_pre_rotation() const;
+
 	/**
 	 * @returns True if a valid swapchain exists in the HPPRenderContext
 	 */
@@ -147,6 +180,16 @@ class HPPRenderContext
 	 */
 	void submit(const vkb::core::HPPQueue &queue, const std::vector<vkb::core::HPPCommandBuffer *> &command_buffers);
 
+	/**
+	 * @brief Starts collecting the batches of a frame for a queue, see vkb::RenderContext::begin_submission
+	 */
+	vkb::SubmissionBuilder begin_submission(const vkb::core::HPPQueue &queue) const;
+
+	/**
+	 * @brief Submits the collected batches, tracked with the active frame by a fence or a timeline signal
+	 */
+	void submit(vkb::SubmissionBuilder &submission);
+
 	/**
 	 * @brief Waits a frame to finish its rendering
 	 */
@@ -154,6 +197,13 @@ class HPPRenderContext
 
 	void end_frame(vk::Semaphore semaphore);
 
+	/**
+	 * @brief Tracks the submissions with a timeline semaphore per queue, see vkb::RenderContext::enable_timeline_semaphores
+	 */
+	bool enable_timeline_semaphores();
+
+	bool uses_timeline_semaphores() const;
+
 	/**
 	 * @brief An error should be raised if the frame is not active.
 	 *        A frame is active after @ref begin_frame has been called.
@@ -192,8 +242,43 @@ class HPPRenderContext
 
 	uint32_t get_active_frame_index() const;
 
+	/**
+	 * @return The number of threads the render frames allocate resource pools for
+	 */
+	size_t get_thread_count() const;
+
 	std::vector<std::unique_ptr<HPPRenderFrame>> &get_render_frames();
 
+	/**
+	 * @brief Waits for older frames as configured on the frame pacer, see vkb::RenderContext::pace_frame
+	 */
+	void pace_frame();
+
+	vkb::FramePacer &get_frame_pacer();
+
+	/**
+	 * @brief Times the frames on the GPU, see vkb::RenderContext::enable_gpu_frame_timing
+	 */
+	bool enable_gpu_frame_timing();
+
+	vkb::GpuFrameTimer *get_gpu_frame_timer();
+
+	/**
+	 * @brief Adapts the swapchain to the frame rate, see vkb::RenderContext::enable_adaptive_swapchain
+	 */
+	bool enable_adaptive_swapchain(std::chrono::duration<float> target_frame_time);
+
+	void disable_adaptive_swapchain();
+
+	vkb::SwapchainController *get_swapchain_controller();
+
+	/**
+	 * @brief Renders the frames in turn on the GPUs of the device group, see vkb::RenderContext::enable_alternate_frame_rendering
+	 */
+	bool enable_alternate_frame_rendering();
+
+	uint32_t get_active_device_mask() const;
+
 	/**
 	 * @brief Handles surface changes, only applicable if the render_context makes use of a swapchain
 	 */
@@ -209,6 +294,27 @@ class HPPRenderContext
 	vk::Extent2D surface_extent;
 
   private:
+	/**
+	 * @brief Moves the timeline of a queue to the value of a new submission, creating it on the first one
+	 */
+	const vkb::QueueTimeline &advance_timeline(vk::Queue queue);
+
+	/**
+	 * @brief Retires the current swapchain, which the frames in flight may still use
+	 */
+	void replace_swapchain(std::unique_ptr<vkb::core::HPPSwapchain> &&new_swapchain);
+
+	std::unique_ptr<HPPRenderTarget> create_swapchain_render_target(uint32_t image_index);
+
+	/**
+	 * @brief Recreates the render target of a frame if its image belonged to a replaced swapchain
+	 */
+	void update_render_target(uint32_t frame_index);
+
+	vk::Fence request_present_fence();
+
+	void recycle_present_fences();
+
 	vkb::core::HPPDevice &device;
 
 	const vkb::Window &window;
@@ -220,6 +326,8 @@ class HPPRenderContext
 
 	vkb::core::HPPSwapchainProperties swapchain_properties;
 
+	std::shared_ptr<vkb::BufferRingSet> buffer_rings;
+
 	std::vector<std::unique_ptr<HPPRenderFrame>> frames;
 
 	vk::Semaphore acquired_semaphore;
@@ -236,7 +344,49 @@ class HPPRenderContext
 
 	vk::SurfaceTransformFlagBitsKHR pre_transform{vk::SurfaceTransformFlagBitsKHR::eIdentity};
 
+	bool pre_rotation{false};
+
 	size_t thread_count{1};
+
+	/// Draw counters of vkb::RenderContext, kept here to share the same layout
+	std::atomic<uint64_t> visible_draw_count{0};
+
+	std::atomic<uint64_t> culled_draw_count{0};
+
+	std::atomic<uint64_t> occluded_draw_count{0};
+
+	std::array<std::atomic<uint64_t>, MaxLodCount> lod_draw_counts{};
+
+	bool timeline_semaphores{false};
+
+	/// Timelines of vkb::QueueTimeline, also created by vkb::RenderContext which shares the same layout
+	std::vector<vkb::QueueTimeline> queue_timelines;
+
+	bool synchronization2{false};
+
+	/// Read by vkb::RenderContext::reset_submit_count
+	std::atomic<uint64_t> submit_count{0};
+
+	/// Read by vkb::RenderContext::reset_redundant_command_count
+	std::atomic<uint64_t> redundant_command_count{0};
+
+	std::unique_ptr<vkb::FramePacer> frame_pacer;
+
+	bool swapchain_maintenance1{false};
+
+	std::vector<vk::Fence> present_fences;
+
+	std::vector<vk::Fence> free_present_fences;
+
+	std::vector<bool> outdated_render_targets;
+
+	std::unique_ptr<vkb::GpuFrameTimer> gpu_frame_timer;
+
+	std::unique_ptr<vkb::SwapchainController> swapchain_controller;
+
+	bool alternate_frame_rendering{false};
+
+	uint32_t active_device_index{0};
 };
 
 }        // namespace rendering
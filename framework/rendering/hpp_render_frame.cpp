@@ -17,7 +17,9 @@
 
 #include "hpp_render_frame.h"
 #include "buffer_pool.h"
+#include <algorithm>
 #include <common/hpp_resource_caching.h>
+#include <core/util/profiling.hpp>
 
 constexpr uint32_t BUFFER_POOL_BLOCK_SIZE = 256;
 
@@ -25,49 +27,91 @@ namespace vkb
 {
 namespace rendering
 {
-HPPRenderFrame::HPPRenderFrame(vkb::core::HPPDevice &device, std::unique_ptr<vkb::rendering::HPPRenderTarget> &&render_target, size_t thread_count) :
+HPPRenderFrame::HPPRenderFrame(vkb::core::HPPDevice                               &device,
+                               std::unique_ptr<vkb::rendering::HPPRenderTarget> &&render_target,
+                               size_t                                             thread_count,
+                               std::shared_ptr<vkb::BufferRingSet>                buffer_rings) :
     device{device},
     fence_pool{device},
     semaphore_pool{device},
     swapchain_render_target{std::move(render_target)},
-    thread_count{thread_count}
+    thread_count{thread_count},
+    buffer_rings{std::move(buffer_rings)}
 {
-	for (auto &usage_it : supported_usage_map)
+	buffer_pools.reserve(supported_usages.size() * thread_count);
+	for (auto &supported_usage : supported_usages)
 	{
-		auto [buffer_pools_it, inserted] = buffer_pools.emplace(usage_it.first, std::vector<std::pair<vkb::BufferPoolCpp, vkb::BufferBlockCpp *>>{});
-		if (!inserted)
-		{
-			throw std::runtime_error("Failed to insert buffer pool");
-		}
-
 		for (size_t i = 0; i < thread_count; ++i)
 		{
-			buffer_pools_it->second.push_back(std::make_pair(vkb::BufferPoolCpp{device, BUFFER_POOL_BLOCK_SIZE * 1024 * usage_it.second, usage_it.first}, nullptr));
+			buffer_pools.push_back(std::make_pair(vkb::BufferPoolCpp{device, BUFFER_POOL_BLOCK_SIZE * 1024 * supported_usage.block_size_multiplier, supported_usage.usage}, nullptr));
 		}
 	}
 
+	// Every thread gets a pool per queue family up front, so requesting a command buffer is an index lookup
+	command_pools.resize(device.get_gpu().get_queue_family_properties().size());
+	for (uint32_t queue_family_index = 0; queue_family_index < command_pools.size(); ++queue_family_index)
+	{
+		create_command_pools(queue_family_index, vkb::core::HPPCommandBuffer::ResetMode::ResetPool);
+	}
+
 	for (size_t i = 0; i < thread_count; ++i)
 	{
 		descriptor_pools.push_back(std::make_unique<std::unordered_map<std::size_t, vkb::core::HPPDescriptorPool>>());
 		descriptor_sets.push_back(std::make_unique<std::unordered_map<std::size_t, vkb::core::HPPDescriptorSet>>());
+		linear_descriptor_pools.push_back(std::make_unique<vkb::core::HPPLinearDescriptorPool>(device));
+		frame_arenas.push_back(std::make_unique<vkb::FrameArena>());
+		descriptor_set_ages.push_back(std::make_unique<vkb::FrameDescriptorSetAges>());
+	}
+
+	// Layouts created for descriptor buffers can't be allocated from descriptor pools
+	if (device.uses_descriptor_buffers())
+	{
+		descriptor_management_strategy = DescriptorManagementStrategy::DescriptorBuffer;
+	}
+}
+
+void HPPRenderFrame::add_timeline_wait(const vkb::QueueTimeline &timeline)
+{
+	auto it = std::find_if(timeline_waits.begin(), timeline_waits.end(), [&timeline](const vkb::QueueTimeline &wait) { return wait.semaphore == timeline.semaphore; });
+	if (it == timeline_waits.end())
+	{
+		timeline_waits.push_back(timeline);
+	}
+	else
+	{
+		it->value = std::max(it->value, timeline.value);
 	}
 }
 
 vkb::BufferAllocationCpp HPPRenderFrame::allocate_buffer(const vk::BufferUsageFlags usage, const vk::DeviceSize size, size_t thread_index)
 {
+	PROFILE_SCOPE("Allocate Buffer");
+
 	assert(thread_index < thread_count && "Thread index is out of bounds");
 
 	// Find a pool for this usage
-	auto buffer_pool_it = buffer_pools.find(usage);
-	if (buffer_pool_it == buffer_pools.end())
+	auto usage_index = get_usage_index(usage);
+	if (usage_index == supported_usages.size())
 	{
 		LOGE("No buffer pool for buffer usage " + vk::to_string(usage));
 		return vkb::BufferAllocationCpp{};
 	}
 
-	assert(thread_index < buffer_pool_it->second.size());
-	auto &buffer_pool  = buffer_pool_it->second[thread_index].first;
-	auto &buffer_block = buffer_pool_it->second[thread_index].second;
+	// The rings don't know about the offset alignment of descriptor buffers, those always come from the frame pools
+	if (buffer_allocation_strategy == BufferAllocationStrategy::RingBuffer && buffer_rings && usage != DESCRIPTOR_BUFFER_USAGE)
+	{
+		auto block_size = BUFFER_POOL_BLOCK_SIZE * 1024 * supported_usages[usage_index].block_size_multiplier;
+		auto allocation = buffer_rings->get_ring(static_cast<VkBufferUsageFlags>(usage), block_size).allocate(this, size);
+		if (!allocation.empty())
+		{
+			return std::move(reinterpret_cast<vkb::BufferAllocationCpp &>(allocation));
+		}
+
+		LOGW_THROTTLED("Buffer ring for usage {} is full, falling back to the frame buffer pool", vk::to_string(usage));
+	}
+
+	auto &buffer_pool  = buffer_pools[usage_index * thread_count + thread_index].first;
+	auto &buffer_block = buffer_pools[usage_index * thread_count + thread_index].second;
 
 	bool want_minimal_block = buffer_allocation_strategy == BufferAllocationStrategy::OneAllocationPerBuffer;
 
@@ -95,6 +139,27 @@ void HPPRenderFrame::clear_descriptors()
 			desc_pool.second.Reset();
 		}
 	}
+
+	for (auto &linear_desc_pool : linear_descriptor_pools)
+	{
+		linear_desc_pool->Reset();
+	}
+
+	for (auto &thread_ages : descriptor_set_ages)
+	{
+		thread_ages->lastUses.clear();
+	}
+}
+
+void HPPRenderFrame::clear_buffer_pools()
+{
+	clear_descriptors();
+
+	for (auto &buffer_pool : buffer_pools)
+	{
+		buffer_pool.first.clear();
+		buffer_pool.second = nullptr;
+	}
 }
 
 std::vector<uint32_t> HPPRenderFrame::collect_bindings_to_update(const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
@@ -118,40 +183,46 @@ std::vector<uint32_t> HPPRenderFrame::collect_bindings_to_update(const vkb::core
 	return {bindings_to_update.begin(), bindings_to_update.end()};
 }
 
+void HPPRenderFrame::create_command_pools(uint32_t queue_family_index, vkb::core::HPPCommandBuffer::ResetMode reset_mode)
+{
+	auto &queue_command_pools = command_pools[queue_family_index];
+
+	queue_command_pools.clear();
+	queue_command_pools.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; i++)
+	{
+		queue_command_pools.push_back(std::make_unique<vkb::core::HPPCommandPool>(device, queue_family_index, this, i, reset_mode));
+	}
+}
+
 std::vector<std::unique_ptr<vkb::core::HPPCommandPool>> &HPPRenderFrame::get_command_pools(const vkb::core::HPPQueue             &queue,
                                                                                            vkb::core::HPPCommandBuffer::ResetMode reset_mode)
 {
-	auto command_pool_it = command_pools.find(queue.get_family_index());
+	assert(queue.get_family_index() < command_pools.size());
+	auto &queue_command_pools = command_pools[queue.get_family_index()];
 
-	if (command_pool_it != command_pools.end())
+	if (queue_command_pools[0]->get_reset_mode() != reset_mode)
 	{
-		assert(!command_pool_it->second.empty());
-		if (command_pool_it->second[0]->get_reset_mode() != reset_mode)
-		{
-			device.get_handle().waitIdle();
+		device.get_handle().waitIdle();
 
-			// Delete pools
-			command_pools.erase(command_pool_it);
-		}
-		else
-		{
-			return command_pool_it->second;
-		}
+		create_command_pools(queue.get_family_index(), reset_mode);
 	}
 
-	bool inserted                       = false;
-	std::tie(command_pool_it, inserted) = command_pools.emplace(queue.get_family_index(), std::vector<std::unique_ptr<vkb::core::HPPCommandPool>>{});
-	if (!inserted)
-	{
-		throw std::runtime_error("Failed to insert command pool");
-	}
+	return queue_command_pools;
+}
 
-	for (size_t i = 0; i < thread_count; i++)
+vkb::ResourceCacheCounters HPPRenderFrame::get_descriptor_set_counters() const
+{
+	vkb::ResourceCacheCounters counters;
+
+	for (auto &thread_ages : descriptor_set_ages)
 	{
-		command_pool_it->second.push_back(std::make_unique<vkb::core::HPPCommandPool>(device, queue.get_family_index(), this, i, reset_mode));
+		counters.hits += thread_ages->counters.hits;
+		counters.misses += thread_ages->counters.misses;
+		counters.evictions += thread_ages->counters.evictions;
 	}
 
-	return command_pool_it->second;
+	return counters;
 }
 
 vkb::core::HPPDevice &HPPRenderFrame::get_device()
@@ -164,6 +235,27 @@ const vkb::HPPFencePool &HPPRenderFrame::get_fence_pool() const
 	return fence_pool;
 }
 
+vkb::FrameArena &HPPRenderFrame::get_frame_arena(size_t thread_index)
+{
+	assert(thread_index < frame_arenas.size() && "Thread index is out of bounds");
+	return *frame_arenas[thread_index];
+}
+
+vkb::LinearDescriptorPoolStats HPPRenderFrame::get_linear_descriptor_pool_stats() const
+{
+	vkb::LinearDescriptorPoolStats stats;
+
+	for (auto &linear_desc_pool : linear_descriptor_pools)
+	{
+		auto &thread_stats = linear_desc_pool->GetStats();
+		stats.poolCount += thread_stats.poolCount;
+		stats.setCount += thread_stats.setCount;
+		stats.peakSetCount += thread_stats.peakSetCount;
+	}
+
+	return stats;
+}
+
 vkb::rendering::HPPRenderTarget &HPPRenderFrame::get_render_target()
 {
 	return *swapchain_render_target;
@@ -193,13 +285,8 @@ vkb::core::HPPCommandBuffer &HPPRenderFrame::request_command_buffer(const vkb::c
 
 	auto &command_pools = get_command_pools(queue, reset_mode);
 
-	auto command_pool_it =
-	    std::find_if(command_pools.begin(),
-	                 command_pools.end(),
-	                 [&thread_index](std::unique_ptr<vkb::core::HPPCommandPool> &cmd_pool) { return cmd_pool->get_thread_index() == thread_index; });
-	assert(command_pool_it != command_pools.end());
-
-	return (*command_pool_it)->request_command_buffer(level);
+	// Pools are stored in thread order, each thread only touches its own
+	return command_pools[thread_index]->request_command_buffer(level);
 }
 
 vk::DescriptorSet HPPRenderFrame::request_descriptor_set(const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
@@ -210,10 +297,21 @@ vk::DescriptorSet HPPRenderFrame::request_descriptor_set(const vkb::core::HPPDes
 {
 	assert(thread_index < thread_count && "Thread index is out of bounds");
 
-	assert(thread_index < descriptor_pools.size());
-	auto &descriptor_pool = vkb::common::request_resource(device, nullptr, *descriptor_pools[thread_index], descriptor_set_layout);
 	if (descriptor_management_strategy == DescriptorManagementStrategy::StoreInCache)
 	{
+		assert(thread_index < descriptor_pools.size());
+		auto &thread_descriptor_pools = *descriptor_pools[thread_index];
+		auto &resource_cache          = device.get_resource_cache();
+
+		size_t pool_count      = thread_descriptor_pools.size();
+		auto  &descriptor_pool = vkb::common::request_resource(device, nullptr, thread_descriptor_pools, descriptor_set_layout);
+		if (thread_descriptor_pools.size() != pool_count)
+		{
+			// Created at the size the layout peaked at, recorded earlier in the session or restored by the warmup
+			descriptor_pool.SetFreeDescriptorSets(descriptor_set_budget > 0);
+			descriptor_pool.Reserve(resource_cache.get_descriptor_set_peak(descriptor_set_layout));
+		}
+
 		// The bindings we want to update before binding, if empty we update all bindings
 		std::vector<uint32_t> bindings_to_update;
 		// If update after bind is enabled, we store the binding index of each binding that need to be updated before being bound
@@ -224,20 +322,63 @@ vk::DescriptorSet HPPRenderFrame::request_descriptor_set(const vkb::core::HPPDes
 
 		// Request a descriptor set from the render frame, and write the buffer infos and image infos of all the specified bindings
 		assert(thread_index < descriptor_sets.size());
-		auto &descriptor_set =
-		    vkb::common::request_resource(device, nullptr, *descriptor_sets[thread_index], descriptor_set_layout, descriptor_pool, buffer_infos, image_infos);
+		auto &thread_descriptor_sets = *descriptor_sets[thread_index];
+		auto &thread_ages            = *descriptor_set_ages[thread_index];
+
+		size_t cached_count = thread_descriptor_sets.size();
+		auto  &descriptor_set =
+		    vkb::common::request_resource(device, nullptr, thread_descriptor_sets, descriptor_set_layout, descriptor_pool, buffer_infos, image_infos);
+		if (thread_descriptor_sets.size() == cached_count)
+		{
+			++thread_ages.counters.hits;
+		}
+		else
+		{
+			++thread_ages.counters.misses;
+			resource_cache.record_descriptor_set_peak(descriptor_set_layout, descriptor_pool.GetPeakSetCount());
+		}
+
+		if (descriptor_set_budget > 0)
+		{
+			size_t key{0U};
+			hash_param(key, descriptor_set_layout, descriptor_pool, buffer_infos, image_infos);
+			thread_ages.lastUses[key] = reset_count;
+		}
+
 		descriptor_set.Update(bindings_to_update);
 		return descriptor_set.GetHandle();
 	}
 	else
 	{
-		// Request a descriptor pool, allocate a descriptor set, write buffer and image data to it
-		vkb::core::HPPDescriptorSet descriptor_set{device, descriptor_set_layout, descriptor_pool, buffer_infos, image_infos};
+		// Allocate a descriptor set from the linear pools of the thread, write buffer and image data to it
+		assert(thread_index < linear_descriptor_pools.size());
+		auto handle = linear_descriptor_pools[thread_index]->Allocate(descriptor_set_layout);
+
+		vkb::core::HPPDescriptorSet descriptor_set{device, descriptor_set_layout, handle, buffer_infos, image_infos};
 		descriptor_set.ApplyWrites();
 		return descriptor_set.GetHandle();
 	}
 }
 
+vkb::BufferAllocationCpp HPPRenderFrame::request_descriptor_buffer(const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
+                                                                   const BindingMap<vk::DescriptorBufferInfo> &buffer_infos,
+                                                                   const BindingMap<vk::DescriptorImageInfo>  &image_infos,
+                                                                   size_t                                      thread_index)
+{
+	assert(descriptor_management_strategy == DescriptorManagementStrategy::DescriptorBuffer && descriptor_set_layout.IsDescriptorBuffer());
+
+	// Descriptors are written in place, the memory is reclaimed with the buffer pools when the frame is reset
+	auto allocation = allocate_buffer(DESCRIPTOR_BUFFER_USAGE, descriptor_set_layout.GetDescriptorBufferSize(), thread_index);
+
+	if (auto data = allocation.map<uint8_t>(0, descriptor_set_layout.GetDescriptorBufferSize()))
+	{
+		descriptor_set_layout.WriteDescriptorBuffer(buffer_infos, image_infos, data);
+		allocation.flush();
+	}
+
+	return allocation;
+}
+
 vk::Fence HPPRenderFrame::request_fence()
 {
 	return fence_pool.request_fence();
@@ -253,35 +394,89 @@ vk::Semaphore HPPRenderFrame::request_semaphore_with_ownership()
 	return semaphore_pool.request_semaphore_with_ownership();
 }
 
-void HPPRenderFrame::reset()
+void HPPRenderFrame::wait()
 {
 	VK_CHECK(fence_pool.wait());
 
+	if (!timeline_waits.empty())
+	{
+		std::vector<vk::Semaphore> semaphores;
+		std::vector<uint64_t>      values;
+		for (auto &wait : timeline_waits)
+		{
+			semaphores.emplace_back(wait.semaphore);
+			values.push_back(wait.value);
+		}
+
+		vk::SemaphoreWaitInfoKHR wait_info({}, semaphores, values);
+		vk::Result               result = device.get_handle().waitSemaphoresKHR(wait_info, std::numeric_limits<uint64_t>::max());
+		if (result != vk::Result::eSuccess)
+		{
+			LOGE("Detected Vulkan error: {}", vkb::to_string(result));
+			abort();
+		}
+	}
+}
+
+void HPPRenderFrame::reset()
+{
+	wait();
+
 	fence_pool.reset();
 
+	timeline_waits.clear();
+
 	for (auto &command_pools_per_queue : command_pools)
 	{
-		for (auto &command_pool : command_pools_per_queue.second)
+		for (auto &command_pool : command_pools_per_queue)
 		{
 			command_pool->reset_pool();
 		}
 	}
 
-	for (auto &buffer_pools_per_usage : buffer_pools)
+	// Usage of the pools by the previous use of the frame, before they are reset
+	vk::DeviceSize buffer_pool_used_size = 0;
+	vk::DeviceSize buffer_pool_size      = 0;
+
+	for (auto &buffer_pool : buffer_pools)
 	{
-		for (auto &buffer_pool : buffer_pools_per_usage.second)
-		{
-			buffer_pool.first.reset();
-			buffer_pool.second = nullptr;
-		}
+		buffer_pool_used_size += buffer_pool.first.get_used_size();
+		buffer_pool_size += buffer_pool.first.get_size();
+
+		buffer_pool.first.reset();
+		buffer_pool.second = nullptr;
+	}
+
+	Plot<int64_t, PlotType::Memory>::plot("Frame Buffer Pool Usage", static_cast<int64_t>(buffer_pool_used_size));
+	Plot<int64_t, PlotType::Memory>::plot("Frame Buffer Pool Size", static_cast<int64_t>(buffer_pool_size));
+
+	if (buffer_rings)
+	{
+		buffer_rings->release(this);
 	}
 
 	semaphore_pool.reset();
 
+	size_t frame_arena_used_size = 0;
+	for (auto &frame_arena : frame_arenas)
+	{
+		frame_arena_used_size += frame_arena->get_used_size();
+		frame_arena->reset();
+	}
+
+	Plot<int64_t, PlotType::Memory>::plot("Frame Arena Usage", static_cast<int64_t>(frame_arena_used_size));
+
 	if (descriptor_management_strategy == DescriptorManagementStrategy::CreateDirectly)
 	{
 		clear_descriptors();
 	}
+	else if (descriptor_set_budget > 0)
+	{
+		// The fence has been waited on, the GPU is done with the descriptor sets of the frame
+		trim_descriptor_sets();
+	}
+
+	++reset_count;
 }
 
 void HPPRenderFrame::set_buffer_allocation_strategy(BufferAllocationStrategy new_strategy)
@@ -291,9 +486,79 @@ void HPPRenderFrame::set_buffer_allocation_strategy(BufferAllocationStrategy new
 
 void HPPRenderFrame::set_descriptor_management_strategy(DescriptorManagementStrategy new_strategy)
 {
+	if ((new_strategy == DescriptorManagementStrategy::DescriptorBuffer) != device.uses_descriptor_buffers())
+	{
+		throw std::runtime_error("The descriptor buffer strategy is required, and only allowed, when the device uses descriptor buffers");
+	}
+
 	descriptor_management_strategy = new_strategy;
 }
 
+void HPPRenderFrame::set_descriptor_set_budget(size_t budget)
+{
+	descriptor_set_budget = budget;
+
+	// The sets cached so far are aged from now on
+	for (size_t thread_index = 0; thread_index < descriptor_sets.size(); ++thread_index)
+	{
+		// Only the pools created from now on allow freeing their sets
+		for (auto &descriptor_pool_it : *descriptor_pools[thread_index])
+		{
+			descriptor_pool_it.second.SetFreeDescriptorSets(budget > 0);
+		}
+
+		auto &last_uses = descriptor_set_ages[thread_index]->lastUses;
+		last_uses.clear();
+		if (budget > 0)
+		{
+			for (auto &descriptor_set_it : *descriptor_sets[thread_index])
+			{
+				last_uses[descriptor_set_it.first] = reset_count;
+			}
+		}
+	}
+}
+
+void HPPRenderFrame::trim_descriptor_sets()
+{
+	for (size_t thread_index = 0; thread_index < descriptor_sets.size(); ++thread_index)
+	{
+		auto &thread_descriptor_sets = *descriptor_sets[thread_index];
+		auto &thread_ages            = *descriptor_set_ages[thread_index];
+
+		if (thread_descriptor_sets.size() <= descriptor_set_budget)
+		{
+			continue;
+		}
+
+		// The sets requested by the previous use of the frame are likely requested again
+		std::vector<std::pair<uint64_t, size_t>> candidates;
+		for (auto &[key, last_use] : thread_ages.lastUses)
+		{
+			if (last_use < reset_count)
+			{
+				candidates.emplace_back(last_use, key);
+			}
+		}
+
+		size_t count = std::min(thread_descriptor_sets.size() - descriptor_set_budget, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			auto descriptor_set_it = thread_descriptor_sets.find(candidates[i].second);
+			if (descriptor_set_it != thread_descriptor_sets.end())
+			{
+				descriptor_set_it->second.Free();
+				thread_descriptor_sets.erase(descriptor_set_it);
+			}
+			thread_ages.lastUses.erase(candidates[i].second);
+		}
+
+		thread_ages.counters.evictions += count;
+	}
+}
+
 void HPPRenderFrame::update_descriptor_sets(size_t thread_index)
 {
 	assert(thread_index < descriptor_sets.size());
@@ -306,8 +571,17 @@ void HPPRenderFrame::update_descriptor_sets(size_t thread_index)
 
 void HPPRenderFrame::update_render_target(std::unique_ptr<vkb::rendering::HPPRenderTarget> &&render_target)
 {
+	if (swapchain_render_target)
+	{
+		device.get_deferred_destruction_queue().retire(std::move(swapchain_render_target));
+	}
 	swapchain_render_target = std::move(render_target);
 }
 
+std::unique_ptr<vkb::rendering::HPPRenderTarget> HPPRenderFrame::release_render_target()
+{
+	return std::move(swapchain_render_target);
+}
+
 }        // namespace rendering
 }        // namespace vkb
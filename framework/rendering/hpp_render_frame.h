@@ -17,7 +17,13 @@
 
 #pragma once
 
+#include <array>
+
 #include "buffer_pool.h"
+#include "buffer_ring.h"
+#include "frame_arena.h"
+#include "queue_timeline.h"
+#include <core/HppLinearDescriptorPool.h>
 #include <core/hpp_device.h>
 #include <hpp_semaphore_pool.h>
 #include <vulkan/vulkan_hash.hpp>
@@ -29,13 +35,15 @@ namespace rendering
 enum class BufferAllocationStrategy
 {
 	OneAllocationPerBuffer,
-	MultipleAllocationsPerBuffer
+	MultipleAllocationsPerBuffer,
+	RingBuffer
 };
 
 enum class DescriptorManagementStrategy
 {
 	StoreInCache,
-	CreateDirectly
+	CreateDirectly,
+	DescriptorBuffer
 };
 
 /**
@@ -59,16 +67,30 @@ enum class DescriptorManagementStrategy
 class HPPRenderFrame
 {
   public:
-	HPPRenderFrame(vkb::core::HPPDevice &device, std::unique_ptr<vkb::rendering::HPPRenderTarget> &&render_target, size_t thread_count = 1);
+	/**
+	 * @brief Usage of the buffers descriptors are written into with DescriptorManagementStrategy::DescriptorBuffer
+	 */
+	static constexpr vk::BufferUsageFlags DESCRIPTOR_BUFFER_USAGE =
+	    vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT | vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT | vk::BufferUsageFlagBits::eShaderDeviceAddress;
+
+	HPPRenderFrame(vkb::core::HPPDevice                               &device,
+	               std::unique_ptr<vkb::rendering::HPPRenderTarget> &&render_target,
+	               size_t                                             thread_count = 1,
+	               std::shared_ptr<vkb::BufferRingSet>                buffer_rings = nullptr);
 
 	HPPRenderFrame(const HPPRenderFrame &)            = delete;
 	HPPRenderFrame(HPPRenderFrame &&)                 = delete;
 	HPPRenderFrame &operator=(const HPPRenderFrame &) = delete;
 	HPPRenderFrame &operator=(HPPRenderFrame &&)      = delete;
 
+	void                                   add_timeline_wait(const vkb::QueueTimeline &timeline);
+	void                                   clear_buffer_pools();
 	void                                   clear_descriptors();
+	vkb::ResourceCacheCounters             get_descriptor_set_counters() const;
 	vkb::core::HPPDevice                  &get_device();
 	const vkb::HPPFencePool               &get_fence_pool() const;
+	vkb::FrameArena                       &get_frame_arena(size_t thread_index = 0);
+	vkb::LinearDescriptorPoolStats         get_linear_descriptor_pool_stats() const;
 	vkb::rendering::HPPRenderTarget       &get_render_target();
 	vkb::rendering::HPPRenderTarget const &get_render_target() const;
 	const vkb::HPPSemaphorePool           &get_semaphore_pool() const;
@@ -78,11 +100,20 @@ class HPPRenderFrame
 	                                                              const BindingMap<vk::DescriptorImageInfo>  &image_infos,
 	                                                              bool                                        update_after_bind,
 	                                                              size_t                                      thread_index = 0);
+	vkb::BufferAllocationCpp               request_descriptor_buffer(const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
+	                                                                 const BindingMap<vk::DescriptorBufferInfo> &buffer_infos,
+	                                                                 const BindingMap<vk::DescriptorImageInfo>  &image_infos,
+	                                                                 size_t                                      thread_index = 0);
 	vk::Fence                              request_fence();
 	vk::Semaphore                          request_semaphore();
 	vk::Semaphore                          request_semaphore_with_ownership();
 	void                                   reset();
 
+	/**
+	 * @brief Waits for the submissions of the frame to finish, without resetting its resources
+	 */
+	void wait();
+
 	/**
 	 * @param usage Usage of the buffer
 	 * @param size Amount of memory required
@@ -112,6 +143,12 @@ class HPPRenderFrame
 	 */
 	void set_buffer_allocation_strategy(BufferAllocationStrategy new_strategy);
 
+	/**
+	 * @brief Limits the number of descriptor sets each thread caches, see vkb::RenderFrame::SetDescriptorSetBudget
+	 * @param budget Maximum number of sets per thread, 0 for no limit
+	 */
+	void set_descriptor_set_budget(size_t budget);
+
 	/**
 	 * @brief Sets a new descriptor set management strategy
 	 * @param new_strategy The new descriptor set management strategy
@@ -124,6 +161,11 @@ class HPPRenderFrame
 	 */
 	void update_render_target(std::unique_ptr<vkb::rendering::HPPRenderTarget> &&render_target);
 
+	/**
+	 * @brief Gives up the render target, see vkb::RenderFrame::ReleaseRenderTarget
+	 */
+	std::unique_ptr<vkb::rendering::HPPRenderTarget> release_render_target();
+
 	/**
 	 * @brief Updates all the descriptor sets in the current frame at a specific thread index
 	 */
@@ -140,22 +182,55 @@ class HPPRenderFrame
 	std::vector<std::unique_ptr<vkb::core::HPPCommandPool>> &get_command_pools(const vkb::core::HPPQueue             &queue,
 	                                                                           vkb::core::HPPCommandBuffer::ResetMode reset_mode);
 
+	/**
+	 * @brief (Re)creates the command pools of every thread for a queue family
+	 */
+	void create_command_pools(uint32_t queue_family_index, vkb::core::HPPCommandBuffer::ResetMode reset_mode);
+
+	/**
+	 * @brief Frees the least recently requested descriptor sets of the threads above the budget
+	 */
+	void trim_descriptor_sets();
+
 	static std::vector<uint32_t> collect_bindings_to_update(const vkb::core::HPPDescriptorSetLayout    &descriptor_set_layout,
 	                                                        const BindingMap<vk::DescriptorBufferInfo> &buffer_infos,
 	                                                        const BindingMap<vk::DescriptorImageInfo>  &image_infos);
 
   private:
-	// A map of the supported usages to a multiplier for the BUFFER_POOL_BLOCK_SIZE
-	const std::unordered_map<vk::BufferUsageFlags, uint32_t> supported_usage_map = {
+	/**
+	 * @brief A usage the frame keeps buffer pools for, with a multiplier for the BUFFER_POOL_BLOCK_SIZE
+	 */
+	struct SupportedUsage
+	{
+		vk::BufferUsageFlags usage;
+		uint32_t             block_size_multiplier;
+	};
+
+	static constexpr std::array<SupportedUsage, 5> supported_usages = {{
 	    {vk::BufferUsageFlagBits::eUniformBuffer, 1},
 	    {vk::BufferUsageFlagBits::eStorageBuffer, 2},        // x2 the size of BUFFER_POOL_BLOCK_SIZE since SSBOs are normally much larger than other types of buffers
 	    {vk::BufferUsageFlagBits::eVertexBuffer, 1},
-	    {vk::BufferUsageFlagBits::eIndexBuffer, 1}};
+	    {vk::BufferUsageFlagBits::eIndexBuffer, 1},
+	    {DESCRIPTOR_BUFFER_USAGE, 1}}};
+
+	/**
+	 * @brief Maps a usage to its dense index in supported_usages, folded at compile time for constant usages
+	 * @return The index of the usage, supported_usages.size() if the frame has no pools for it
+	 */
+	static constexpr size_t get_usage_index(vk::BufferUsageFlags usage)
+	{
+		size_t index = 0;
+		while (index < supported_usages.size() && supported_usages[index].usage != usage)
+		{
+			++index;
+		}
+		return index;
+	}
 
 	vkb::core::HPPDevice &device;
 
-	/// Commands pools associated to the frame
-	std::map<uint32_t, std::vector<std::unique_ptr<vkb::core::HPPCommandPool>>> command_pools;
+	/// Commands pools associated to the frame, indexed by queue family then by thread
+	std::vector<std::vector<std::unique_ptr<vkb::core::HPPCommandPool>>> command_pools;
 
 	/// Descriptor pools for the frame
 	std::vector<std::unique_ptr<std::unordered_map<std::size_t, vkb::core::HPPDescriptorPool>>> descriptor_pools;
@@ -175,7 +250,28 @@ class HPPRenderFrame
 
 	DescriptorManagementStrategy descriptor_management_strategy{DescriptorManagementStrategy::StoreInCache};
 
-	std::map<vk::BufferUsageFlags, std::vector<std::pair<vkb::BufferPoolCpp, vkb::BufferBlockCpp *>>> buffer_pools;
+	/// Buffer pools and their current block, indexed by usage index then by thread
+	std::vector<std::pair<vkb::BufferPoolCpp, vkb::BufferBlockCpp *>> buffer_pools;
+
+	std::shared_ptr<vkb::BufferRingSet> buffer_rings;
+
+	/// Descriptor sets of DescriptorManagementStrategy::CreateDirectly, carved out of a few pools per thread regardless of their layout
+	std::vector<std::unique_ptr<vkb::core::HPPLinearDescriptorPool>> linear_descriptor_pools;
+
+	/// Highest value of each queue timeline the frame signaled, waited on by the next reset
+	std::vector<vkb::QueueTimeline> timeline_waits;
+
+	/// CPU memory of the containers used while recording the frame, one arena per thread
+	std::vector<std::unique_ptr<vkb::FrameArena>> frame_arenas;
+
+	/// Ages and counters of the descriptor sets of DescriptorManagementStrategy::StoreInCache, one per thread
+	std::vector<std::unique_ptr<vkb::FrameDescriptorSetAges>> descriptor_set_ages;
+
+	/// Descriptor sets each thread keeps cached, 0 for no limit
+	size_t descriptor_set_budget{0};
+
+	/// Number of times the frame was reset, the age of its descriptor sets is counted in
+	uint64_t reset_count{0};
 };
 }        // namespace rendering
 }        // namespace vkb
@@ -46,6 +46,16 @@ class HPPRenderPipeline : private vkb::RenderPipeline
 		                          reinterpret_cast<vkb::RenderTarget &>(render_target),
 		                          static_cast<VkSubpassContents>(contents));
 	}
+
+	vk::SubpassContents get_last_subpass_contents() const
+	{
+		return static_cast<vk::SubpassContents>(vkb::RenderPipeline::get_last_subpass_contents());
+	}
+
+	void invalidate_static_commands()
+	{
+		vkb::RenderPipeline::invalidate_static_commands();
+	}
 };
 }        // namespace rendering
 }        // namespace vkb
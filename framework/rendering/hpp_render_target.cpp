@@ -38,6 +38,54 @@ const HPPRenderTarget::CreateFunc HPPRenderTarget::DEFAULT_CREATE_FUNC = [](core
 	return std::make_unique<HPPRenderTarget>(std::move(images));
 };
 
+HPPRenderTarget::CreateFunc HPPRenderTarget::create_multisampled_func(vk::SampleCountFlagBits samples, bool resolve_depth)
+{
+	return [samples, resolve_depth](core::HPPImage &&swapchain_image) -> std::unique_ptr<HPPRenderTarget> {
+		auto &device = swapchain_image.get_device();
+
+		if (resolve_depth && !device.is_enabled(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME))
+		{
+			throw VulkanException{VK_ERROR_EXTENSION_NOT_PRESENT, "Resolving the depth in the render pass needs VK_KHR_depth_stencil_resolve"};
+		}
+
+		vk::Format depth_format = common::get_suitable_depth_format(device.get_gpu().get_handle());
+
+		core::HPPImage depth_image{device, swapchain_image.get_extent(),
+		                           depth_format,
+		                           vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransientAttachment,
+		                           VMA_MEMORY_USAGE_GPU_ONLY,
+		                           samples};
+
+		core::HPPImage color_image{device, swapchain_image.get_extent(),
+		                           swapchain_image.get_format(),
+		                           vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransientAttachment,
+		                           VMA_MEMORY_USAGE_GPU_ONLY,
+		                           samples};
+
+		std::vector<core::HPPImage> images;
+		images.push_back(std::move(swapchain_image));
+		images.push_back(std::move(depth_image));
+		images.push_back(std::move(color_image));
+
+		if (resolve_depth)
+		{
+			images.emplace_back(device, images[0].get_extent(),
+			                    depth_format,
+			                    vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled,
+			                    VMA_MEMORY_USAGE_GPU_ONLY);
+		}
+
+		auto render_target = std::make_unique<HPPRenderTarget>(std::move(images));
+		render_target->set_multisampled_attachment(0, 2);
+		if (resolve_depth)
+		{
+			render_target->set_depth_stencil_resolve(3, vk::ResolveModeFlagBits::eSampleZero);
+		}
+
+		return render_target;
+	};
+}
+
 HPPRenderTarget::HPPRenderTarget(std::vector<core::HPPImage> &&images_) :
     device{images_.back().get_device()},
     images{std::move(images_)}
@@ -145,5 +193,79 @@ vk::ImageLayout HPPRenderTarget::get_layout(uint32_t attachment) const
 	return attachments[attachment].initial_layout;
 }
 
+void HPPRenderTarget::set_shading_rate_view(const core::HPPImageView *view, const vk::Extent2D &texel_size)
+{
+	if (view && !device.is_enabled(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME))
+	{
+		throw VulkanException{VK_ERROR_EXTENSION_NOT_PRESENT, "A shading rate attachment needs VK_KHR_fragment_shading_rate"};
+	}
+
+	shading_rate_view       = view;
+	shading_rate_texel_size = view ? texel_size : vk::Extent2D{};
+}
+
+const core::HPPImageView *HPPRenderTarget::get_shading_rate_view() const
+{
+	return shading_rate_view;
+}
+
+const vk::Extent2D &HPPRenderTarget::get_shading_rate_texel_size() const
+{
+	return shading_rate_texel_size;
+}
+
+uint32_t HPPRenderTarget::get_shading_rate_attachment() const
+{
+	return shading_rate_view ? vkb::to_u32(views.size()) : VK_ATTACHMENT_UNUSED;
+}
+
+void HPPRenderTarget::set_multisampled_attachment(uint32_t attachment, uint32_t multisampled_attachment)
+{
+	assert(attachment < attachments.size() && "Attachment index out of range");
+	assert((multisampled_attachment == VK_ATTACHMENT_UNUSED || attachments[multisampled_attachment].samples != vk::SampleCountFlagBits::e1) &&
+	       "The attachment rendered instead must be multisampled");
+
+	multisampled_attachments.resize(attachments.size(), VK_ATTACHMENT_UNUSED);
+	multisampled_attachments[attachment] = multisampled_attachment;
+}
+
+uint32_t HPPRenderTarget::get_multisampled_attachment(uint32_t attachment) const
+{
+	return attachment < multisampled_attachments.size() ? multisampled_attachments[attachment] : VK_ATTACHMENT_UNUSED;
+}
+
+void HPPRenderTarget::set_depth_stencil_resolve(uint32_t attachment, vk::ResolveModeFlagBits mode)
+{
+	if (attachment != VK_ATTACHMENT_UNUSED && !device.is_enabled(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME))
+	{
+		throw VulkanException{VK_ERROR_EXTENSION_NOT_PRESENT, "Resolving the depth in the render pass needs VK_KHR_depth_stencil_resolve"};
+	}
+
+	depth_stencil_resolve_attachment = attachment;
+	depth_stencil_resolve_mode       = attachment == VK_ATTACHMENT_UNUSED ? vk::ResolveModeFlagBits::eNone : mode;
+}
+
+uint32_t HPPRenderTarget::get_depth_stencil_resolve_attachment() const
+{
+	return depth_stencil_resolve_attachment;
+}
+
+vk::ResolveModeFlagBits HPPRenderTarget::get_depth_stencil_resolve_mode() const
+{
+	return depth_stencil_resolve_mode;
+}
+
+vk::SampleCountFlagBits HPPRenderTarget::get_sample_count() const
+{
+	for (auto multisampled_attachment : multisampled_attachments)
+	{
+		if (multisampled_attachment != VK_ATTACHMENT_UNUSED)
+		{
+			return attachments[multisampled_attachment].samples;
+		}
+	}
+	return vk::SampleCountFlagBits::e1;
+}
+
 }        // namespace rendering
 }        // namespace vkb
@@ -62,6 +62,8 @@ class HPPRenderTarget
 
 	static const CreateFunc DEFAULT_CREATE_FUNC;
 
+	static CreateFunc create_multisampled_func(vk::SampleCountFlagBits samples, bool resolve_depth = false);
+
 	HPPRenderTarget(std::vector<core::HPPImage> &&images);
 
 	HPPRenderTarget(std::vector<core::HPPImageView> &&image_views);
@@ -95,6 +97,16 @@ class HPPRenderTarget
 	const std::vector<uint32_t> &get_output_attachments() const;
 	void                         set_layout(uint32_t attachment, vk::ImageLayout layout);
 	vk::ImageLayout              get_layout(uint32_t attachment) const;
+	void                         set_shading_rate_view(const core::HPPImageView *view, const vk::Extent2D &texel_size);
+	const core::HPPImageView    *get_shading_rate_view() const;
+	const vk::Extent2D          &get_shading_rate_texel_size() const;
+	uint32_t                     get_shading_rate_attachment() const;
+	void                         set_multisampled_attachment(uint32_t attachment, uint32_t multisampled_attachment);
+	uint32_t                     get_multisampled_attachment(uint32_t attachment) const;
+	void                         set_depth_stencil_resolve(uint32_t attachment, vk::ResolveModeFlagBits mode);
+	uint32_t                     get_depth_stencil_resolve_attachment() const;
+	vk::ResolveModeFlagBits      get_depth_stencil_resolve_mode() const;
+	vk::SampleCountFlagBits      get_sample_count() const;
 
   private:
 	core::HPPDevice const          &device;
@@ -104,6 +116,11 @@ class HPPRenderTarget
 	std::vector<HPPAttachment>      attachments;
 	std::vector<uint32_t>           input_attachments  = {};         // By default there are no input attachments
 	std::vector<uint32_t>           output_attachments = {0};        // By default the output attachments is attachment 0
+	const core::HPPImageView       *shading_rate_view  = nullptr;
+	vk::Extent2D                    shading_rate_texel_size;
+	std::vector<uint32_t>           multisampled_attachments;
+	uint32_t                        depth_stencil_resolve_attachment = VK_ATTACHMENT_UNUSED;
+	vk::ResolveModeFlagBits         depth_stencil_resolve_mode       = vk::ResolveModeFlagBits::eNone;
 };
 }        // namespace rendering
 }        // namespace vkb
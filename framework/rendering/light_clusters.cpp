@@ -0,0 +1,184 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/light_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/command_buffer.h"
+#include "core/util/profiling.hpp"
+#include "rendering/render_context.h"
+#include "scene_graph/components/light.h"
+#include "scene_graph/components/perspective_camera.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+namespace
+{
+/// Clusters assigned by each workgroup of the assignment shader
+constexpr uint32_t AssignGroupSize = 64;
+
+sg::PerspectiveCamera &as_perspective_camera(sg::Camera &camera)
+{
+	auto perspective_camera = dynamic_cast<sg::PerspectiveCamera *>(&camera);
+	if (!perspective_camera)
+	{
+		throw std::runtime_error("Light clusters need a perspective camera");
+	}
+	return *perspective_camera;
+}
+}        // namespace
+
+LightClusters::LightClusters(RenderContext &render_context, sg::Camera &camera, sg::Scene &scene) :
+    render_context{render_context},
+    camera{as_perspective_camera(camera)},
+    scene{scene},
+    assign_shader{"clustered/assign_lights.comp"}
+{
+	assign_variant.add_definitions(get_definitions());
+
+	cluster_buffer = std::make_unique<vkb::core::BufferC>(render_context.get_device(),
+	                                                      ClusterCount * (MaxLightsPerCluster + 1) * sizeof(uint32_t),
+	                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+	                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+	cluster_buffer->set_debug_name("Light clusters: light lists");
+}
+
+std::vector<std::string> LightClusters::get_definitions()
+{
+	return {"CLUSTERED_LIGHTING",
+	        "CLUSTER_GRID_WIDTH " + std::to_string(GridWidth),
+	        "CLUSTER_GRID_HEIGHT " + std::to_string(GridHeight),
+	        "CLUSTER_GRID_DEPTH " + std::to_string(GridDepth),
+	        "MAX_LIGHTS_PER_CLUSTER " + std::to_string(MaxLightsPerCluster)};
+}
+
+void LightClusters::prepare()
+{
+	render_context.get_device().get_resource_cache().CompileShaderModulesAsync({{VK_SHADER_STAGE_COMPUTE_BIT, assign_shader, assign_variant}});
+}
+
+uint32_t LightClusters::gather_lights(sg::Scene &scene, std::vector<vkb::rendering::Light> &lights, std::vector<glm::vec4> &light_bounds)
+{
+	lights.clear();
+	light_bounds.clear();
+
+	// Global lights come first, the bounded ones are gathered after them
+	std::vector<vkb::rendering::Light> bounded_lights;
+
+	for (auto &scene_light : scene.get_component_view<sg::Light>())
+	{
+		const auto &properties = scene_light->get_properties();
+		auto       &transform  = scene_light->get_node()->get_transform();
+
+		vkb::rendering::Light light{{transform.get_translation(), static_cast<float>(scene_light->get_light_type())},
+		                            {properties.color, properties.intensity},
+		                            {transform.get_rotation() * properties.direction, properties.range},
+		                            {properties.inner_cone_angle, properties.outer_cone_angle}};
+
+		float radius = properties.range;
+		if (scene_light->get_light_type() == sg::LightType::Point && radius <= 0.0f)
+		{
+			// Distance at which the attenuation of the shaders reaches the cutoff
+			radius = std::sqrt(properties.intensity / LightCutoff) / 0.005f;
+		}
+
+		if (scene_light->get_light_type() == sg::LightType::Directional || radius <= 0.0f)
+		{
+			lights.push_back(light);
+		}
+		else
+		{
+			bounded_lights.push_back(light);
+			light_bounds.emplace_back(transform.get_translation(), radius);
+		}
+	}
+
+	auto global_light_count = to_u32(lights.size());
+	lights.insert(lights.end(), bounded_lights.begin(), bounded_lights.end());
+
+	return global_light_count;
+}
+
+void LightClusters::update(CommandBuffer &command_buffer)
+{
+	PROFILE_SCOPE("Assign Lights");
+
+	auto global_light_count = gather_lights(scene, lights, light_bounds);
+
+	ClusterUniform uniform{};
+	uniform.view                  = camera.get_view();
+	uniform.projection_scale      = glm::vec2(camera.get_projection()[0][0], std::abs(camera.get_projection()[1][1]));
+	uniform.near_plane            = camera.get_near_plane();
+	uniform.slice_scale           = GridDepth / std::log(camera.get_far_plane() / camera.get_near_plane());
+	uniform.global_light_count    = global_light_count;
+	uniform.clustered_light_count = to_u32(light_bounds.size());
+
+	// Storage buffers can't be empty, an unused element is allocated without lights
+	auto &render_frame = render_context.get_active_frame();
+	light_allocation   = render_frame.AllocateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, std::max<size_t>(lights.size(), 1) * sizeof(vkb::rendering::Light));
+	if (!lights.empty())
+	{
+		light_allocation.update(lights.data(), lights.size() * sizeof(vkb::rendering::Light));
+	}
+
+	bounds_allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, std::max<size_t>(light_bounds.size(), 1) * sizeof(glm::vec4));
+	if (!light_bounds.empty())
+	{
+		bounds_allocation.update(light_bounds.data(), light_bounds.size() * sizeof(glm::vec4));
+	}
+
+	uniform_allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(ClusterUniform));
+	uniform_allocation.update(uniform);
+
+	ScopedDebugLabel debug_label{command_buffer, "Assign lights to clusters"};
+
+	// The fragments of the previous frame read the lists before they are written again
+	BufferMemoryBarrier reuse_barrier{};
+	reuse_barrier.src_stage_mask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	reuse_barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	command_buffer.buffer_memory_barrier(*cluster_buffer, 0, VK_WHOLE_SIZE, reuse_barrier);
+
+	auto &resource_cache  = command_buffer.get_device().get_resource_cache();
+	auto &assign_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, assign_shader, assign_variant);
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&assign_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.bind_buffer(bounds_allocation.get_buffer(), bounds_allocation.get_offset(), bounds_allocation.get_size(), 0, 1, 0);
+	command_buffer.bind_buffer(uniform_allocation.get_buffer(), uniform_allocation.get_offset(), uniform_allocation.get_size(), 0, 6, 0);
+	command_buffer.bind_buffer(*cluster_buffer, 0, cluster_buffer->get_size(), 0, 7, 0);
+
+	command_buffer.dispatch((ClusterCount + AssignGroupSize - 1) / AssignGroupSize, 1, 1);
+
+	BufferMemoryBarrier assign_barrier{};
+	assign_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	assign_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	assign_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	assign_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	command_buffer.buffer_memory_barrier(*cluster_buffer, 0, VK_WHOLE_SIZE, assign_barrier);
+}
+
+void LightClusters::bind(CommandBuffer &command_buffer)
+{
+	command_buffer.bind_buffer(light_allocation.get_buffer(), light_allocation.get_offset(), light_allocation.get_size(), 0, 4, 0);
+	command_buffer.bind_buffer(uniform_allocation.get_buffer(), uniform_allocation.get_offset(), uniform_allocation.get_size(), 0, 6, 0);
+	command_buffer.bind_buffer(*cluster_buffer, 0, cluster_buffer->get_size(), 0, 7, 0);
+}
+}        // namespace vkb
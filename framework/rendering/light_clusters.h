@@ -0,0 +1,172 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "common/glm_common.h"
+#include "core/buffer.h"
+#include "core/shader_module.h"
+#include "rendering/subpass.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class RenderContext;
+
+namespace sg
+{
+class Camera;
+class Light;
+class PerspectiveCamera;
+class Scene;
+}        // namespace sg
+
+/**
+ * @brief Parameters of the light clusters for a frame, laid out as in the shaders
+ */
+struct alignas(16) ClusterUniform
+{
+	glm::mat4 view;
+
+	/// Scale of the projection from view space to normalized device coordinates, in x and y
+	glm::vec2 projection_scale;
+
+	float near_plane;
+
+	/// Number of depth slices per unit of the logarithm of the view depth
+	float slice_scale;
+
+	/// Lights affecting every cluster, first in the light buffer
+	uint32_t global_light_count;
+
+	/// Lights assigned to the clusters they overlap, after the global lights
+	uint32_t clustered_light_count;
+};
+
+/**
+ * @brief Assigns the lights of a scene to the clusters of the view frustum they overlap
+ *
+ * The frustum of a perspective camera is split into GridWidth x GridHeight tiles on screen and GridDepth slices,
+ * spaced exponentially between the near and far planes. Before the render pass, a compute shader tests the bounding
+ * sphere of each point and spot light against the bounds of each cluster and writes the indices of the overlapping
+ * lights into a list per cluster. Fragments only loop over the lights of their cluster, so their cost depends on the
+ * light density instead of the number of lights in the scene, and the lights are read from a storage buffer without
+ * the limits of the uniform arrays.
+ *
+ * Directional lights and spot lights without a range affect every fragment, they are looped over by all of them.
+ * Point lights without a range are bounded where their attenuation goes below LightCutoff of their intensity.
+ * A cluster keeps at most MaxLightsPerCluster lights, the others are dropped.
+ *
+ * Shaders built with the CLUSTERED_LIGHTING definition read the lights at binding 4, the cluster uniform at
+ * binding 6 and the cluster lists at binding 7 of set 0, see shaders/clustered/clustered_lighting.h.
+ */
+class LightClusters
+{
+  public:
+	static constexpr uint32_t GridWidth = 16;
+
+	static constexpr uint32_t GridHeight = 9;
+
+	static constexpr uint32_t GridDepth = 24;
+
+	static constexpr uint32_t ClusterCount = GridWidth * GridHeight * GridDepth;
+
+	/// Defined as MAX_LIGHTS_PER_CLUSTER in the shaders
+	static constexpr uint32_t MaxLightsPerCluster = 128;
+
+	/// Fraction of the intensity of a point light under which it is ignored, if it has no range
+	static constexpr float LightCutoff = 1.0f / 256.0f;
+
+	/**
+	 * @param render_context Render context
+	 * @param camera Camera the clusters follow
+	 * @param scene Scene the lights are read from
+	 * @throws std::runtime_error if the camera is not a perspective camera
+	 */
+	LightClusters(RenderContext &render_context, sg::Camera &camera, sg::Scene &scene);
+
+	LightClusters(const LightClusters &) = delete;
+
+	LightClusters(LightClusters &&) = delete;
+
+	~LightClusters() = default;
+
+	LightClusters &operator=(const LightClusters &) = delete;
+
+	LightClusters &operator=(LightClusters &&) = delete;
+
+	/**
+	 * @return The definitions to add to the variants of the shaders reading the clusters
+	 */
+	static std::vector<std::string> get_definitions();
+
+	/**
+	 * @brief Converts the lights of a scene for the shaders, the lights affecting every fragment first
+	 * @param scene Scene the lights are read from
+	 * @param lights Filled with the global lights followed by the bounded lights
+	 * @param light_bounds Filled with the world position and radius of each bounded light
+	 * @return The number of global lights
+	 */
+	static uint32_t gather_lights(sg::Scene &scene, std::vector<vkb::rendering::Light> &lights, std::vector<glm::vec4> &light_bounds);
+
+	/**
+	 * @brief Compiles the assignment shader
+	 */
+	void prepare();
+
+	/**
+	 * @brief Uploads the lights of the frame and assigns them to the clusters, to be recorded before the render pass
+	 */
+	void update(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Binds the lights and clusters of the frame for the fragment shader
+	 */
+	void bind(CommandBuffer &command_buffer);
+
+  private:
+	RenderContext &render_context;
+
+	sg::PerspectiveCamera &camera;
+
+	sg::Scene &scene;
+
+	ShaderSource assign_shader;
+
+	ShaderVariant assign_variant;
+
+	/// Global lights followed by the clustered lights
+	std::vector<vkb::rendering::Light> lights;
+
+	/// World position and radius of each clustered light
+	std::vector<glm::vec4> light_bounds;
+
+	/// Light lists of the clusters, a count followed by MaxLightsPerCluster indices for each cluster
+	std::unique_ptr<vkb::core::BufferC> cluster_buffer;
+
+	/// Allocated from the active render frame
+	BufferAllocationC light_allocation;
+
+	BufferAllocationC bounds_allocation;
+
+	BufferAllocationC uniform_allocation;
+};
+}        // namespace vkb
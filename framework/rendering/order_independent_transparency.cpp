@@ -0,0 +1,186 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/order_independent_transparency.h"
+
+#include <cstring>
+
+#include "core/command_buffer.h"
+#include "core/util/profiling.hpp"
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+OrderIndependentTransparency::OrderIndependentTransparency(RenderContext &render_context, uint32_t fragment_count) :
+    render_context{render_context},
+    fragment_count{fragment_count}
+{
+	if (fragment_count == 0 || fragment_count > MaxFragmentCount)
+	{
+		throw std::runtime_error("The k-buffer stores between 1 and " + std::to_string(MaxFragmentCount) + " fragments per pixel");
+	}
+
+	stats_buffer = std::make_unique<vkb::core::BufferC>(render_context.get_device(),
+	                                                    sizeof(Stats),
+	                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                    VMA_MEMORY_USAGE_GPU_ONLY);
+	stats_buffer->set_debug_name("OIT: statistics");
+}
+
+std::vector<std::string> OrderIndependentTransparency::get_definitions() const
+{
+	return {"OIT_KBUFFER",
+	        "OIT_FRAGMENT_COUNT " + std::to_string(fragment_count)};
+}
+
+uint32_t OrderIndependentTransparency::get_fragment_count() const
+{
+	return fragment_count;
+}
+
+const OrderIndependentTransparency::Stats &OrderIndependentTransparency::get_stats() const
+{
+	return stats;
+}
+
+void OrderIndependentTransparency::resize(const VkExtent2D &new_extent)
+{
+	if (count_buffer && new_extent.width == extent.width && new_extent.height == extent.height)
+	{
+		return;
+	}
+
+	// The frames in flight may still access the arrays sized for the previous extent
+	if (count_buffer)
+	{
+		auto &deferred_destruction_queue = render_context.get_device().get_deferred_destruction_queue();
+		deferred_destruction_queue.retire(std::move(count_buffer));
+		deferred_destruction_queue.retire(std::move(fragment_buffer));
+	}
+
+	extent = new_extent;
+
+	VkDeviceSize pixel_count = static_cast<VkDeviceSize>(extent.width) * extent.height;
+
+	count_buffer = std::make_unique<vkb::core::BufferC>(render_context.get_device(),
+	                                                    pixel_count * sizeof(uint32_t),
+	                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                    VMA_MEMORY_USAGE_GPU_ONLY);
+	count_buffer->set_debug_name("OIT: fragment counts");
+
+	fragment_buffer = std::make_unique<vkb::core::BufferC>(render_context.get_device(),
+	                                                       pixel_count * fragment_count * sizeof(glm::uvec2),
+	                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+	                                                       VMA_MEMORY_USAGE_GPU_ONLY);
+	fragment_buffer->set_debug_name("OIT: fragments");
+}
+
+void OrderIndependentTransparency::read_stats(CommandBuffer &command_buffer)
+{
+	auto frame_index = render_context.get_active_frame_index();
+	if (stats_readbacks.size() <= frame_index)
+	{
+		stats_readbacks.resize(frame_index + 1);
+	}
+
+	// The fence of the frame was waited for, its copy is complete
+	auto &readback = stats_readbacks[frame_index];
+	if (readback.pending)
+	{
+		std::memcpy(&stats, readback.buffer->map(), sizeof(Stats));
+		readback.buffer->unmap();
+		readback.pending = false;
+	}
+
+	if (!stats_cleared)
+	{
+		return;
+	}
+
+	if (!readback.buffer)
+	{
+		readback.buffer = std::make_unique<vkb::core::BufferC>(render_context.get_device(), sizeof(Stats), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+		readback.buffer->set_debug_name("OIT: statistics readback");
+	}
+
+	// The composite of the previous frame wrote the statistics earlier on the queue
+	BufferMemoryBarrier copy_barrier{};
+	copy_barrier.src_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	copy_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	copy_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	copy_barrier.dst_access_mask = VK_ACCESS_TRANSFER_READ_BIT;
+	command_buffer.buffer_memory_barrier(*stats_buffer, 0, VK_WHOLE_SIZE, copy_barrier);
+
+	command_buffer.copy_buffer(*stats_buffer, *readback.buffer, sizeof(Stats));
+
+	BufferMemoryBarrier host_barrier{};
+	host_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	host_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_HOST_BIT;
+	host_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	host_barrier.dst_access_mask = VK_ACCESS_HOST_READ_BIT;
+	command_buffer.buffer_memory_barrier(*readback.buffer, 0, VK_WHOLE_SIZE, host_barrier);
+
+	readback.pending = true;
+}
+
+void OrderIndependentTransparency::begin(CommandBuffer &command_buffer)
+{
+	PROFILE_SCOPE("Clear OIT k-buffer");
+
+	auto &render_frame = render_context.get_active_frame();
+	resize(render_frame.GetRenderTarget().get_extent());
+
+	// Copies the statistics before they are cleared
+	read_stats(command_buffer);
+
+	OITUniform uniform{};
+	uniform.extent = glm::uvec2(extent.width, extent.height);
+
+	uniform_allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(OITUniform));
+	uniform_allocation.update(uniform);
+
+	ScopedDebugLabel debug_label{command_buffer, "Clear OIT k-buffer"};
+
+	// The fragments and the composite of the previous frame, and the statistics copy, access the counters before they are cleared
+	BufferMemoryBarrier reuse_barrier{};
+	reuse_barrier.src_stage_mask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+	reuse_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	command_buffer.buffer_memory_barrier(*count_buffer, 0, VK_WHOLE_SIZE, reuse_barrier);
+	command_buffer.buffer_memory_barrier(*stats_buffer, 0, VK_WHOLE_SIZE, reuse_barrier);
+
+	vkCmdFillBuffer(command_buffer.get_handle(), count_buffer->get_handle(), 0, VK_WHOLE_SIZE, 0);
+	vkCmdFillBuffer(command_buffer.get_handle(), stats_buffer->get_handle(), 0, VK_WHOLE_SIZE, 0);
+
+	BufferMemoryBarrier clear_barrier{};
+	clear_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	clear_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	clear_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	clear_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*count_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+	command_buffer.buffer_memory_barrier(*stats_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+
+	stats_cleared = true;
+}
+
+void OrderIndependentTransparency::bind(CommandBuffer &command_buffer)
+{
+	command_buffer.bind_buffer(uniform_allocation.get_buffer(), uniform_allocation.get_offset(), uniform_allocation.get_size(), 0, 15, 0);
+	command_buffer.bind_buffer(*count_buffer, 0, count_buffer->get_size(), 0, 16, 0);
+	command_buffer.bind_buffer(*fragment_buffer, 0, fragment_buffer->get_size(), 0, 17, 0);
+	command_buffer.bind_buffer(*stats_buffer, 0, stats_buffer->get_size(), 0, 18, 0);
+}
+}        // namespace vkb
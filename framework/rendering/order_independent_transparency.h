@@ -0,0 +1,167 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "common/glm_common.h"
+#include "core/buffer.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class RenderContext;
+
+/**
+ * @brief Extent of the per-pixel arrays of the k-buffer, laid out as in the shaders
+ */
+struct alignas(16) OITUniform
+{
+	glm::uvec2 extent;
+};
+
+/**
+ * @brief Order-independent transparency with a bounded array of fragments per pixel (k-buffer)
+ *
+ * The transparent fragments don't blend into the color attachment. Each one increments the counter of its
+ * pixel and is stored at the index the counter had, if it is lower than the fragment count of the k-buffer.
+ * A composite subpass then sorts the fragments of each pixel by depth and blends them over the opaque color,
+ * see OITCompositeSubpass. The memory of the k-buffer is bounded by the fragment count, unlike linked lists
+ * of fragments, and the geometry is drawn once, unlike depth peeling.
+ *
+ * Fragments beyond the fragment count of their pixel are dropped, and counted in the statistics. They are
+ * the last ones rasterized rather than the farthest, so the draws should still be sorted back-to-front if
+ * some pixels overflow. The color is stored with 8 bits per channel, so it is clamped to [0, 1].
+ *
+ * Shaders built with the definitions read the extent at binding 15, the counters at binding 16 and the
+ * fragments at binding 17 of set 0, and the composite writes the statistics at binding 18, see shaders/oit/kbuffer.h.
+ * The composite must be the next subpass of the render pass, or the subpass dependency doesn't order the
+ * storage writes. With VK_KHR_dynamic_rendering_local_read, the render pass must not have subpasses reading
+ * input attachments, as the barriers within a rendering instance can't order storage writes.
+ */
+class OrderIndependentTransparency
+{
+  public:
+	/// Number of fragments stored per pixel by default
+	static constexpr uint32_t DefaultFragmentCount = 4;
+
+	/// The composite sorts the fragments of a pixel in registers, so their number is kept small
+	static constexpr uint32_t MaxFragmentCount = 16;
+
+	/**
+	 * @brief Statistics of the transparent fragments of a frame
+	 */
+	struct Stats
+	{
+		/// Transparent fragments which passed the depth test
+		uint32_t fragment_count{0};
+
+		/// Fragments dropped because their pixel already stored the fragment count
+		uint32_t overflow_fragment_count{0};
+
+		/// Pixels which dropped fragments
+		uint32_t overflow_pixel_count{0};
+	};
+
+	/**
+	 * @param render_context Render context
+	 * @param fragment_count Number of fragments stored per pixel
+	 * @throws std::runtime_error if the fragment count is zero or greater than MaxFragmentCount
+	 */
+	OrderIndependentTransparency(RenderContext &render_context, uint32_t fragment_count = DefaultFragmentCount);
+
+	OrderIndependentTransparency(const OrderIndependentTransparency &) = delete;
+
+	OrderIndependentTransparency(OrderIndependentTransparency &&) = delete;
+
+	~OrderIndependentTransparency() = default;
+
+	OrderIndependentTransparency &operator=(const OrderIndependentTransparency &) = delete;
+
+	OrderIndependentTransparency &operator=(OrderIndependentTransparency &&) = delete;
+
+	/**
+	 * @return The definitions to add to the variants of the shaders storing or compositing the fragments
+	 */
+	std::vector<std::string> get_definitions() const;
+
+	uint32_t get_fragment_count() const;
+
+	/**
+	 * @brief Sizes the k-buffer for the render target of the active frame and clears its counters,
+	 *        to be recorded before the render pass
+	 */
+	void begin(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Binds the k-buffer of the frame for the fragment shaders
+	 */
+	void bind(CommandBuffer &command_buffer);
+
+	/**
+	 * @return The statistics of the last frame read back, a few frames behind the recorded one
+	 */
+	const Stats &get_stats() const;
+
+  private:
+	void resize(const VkExtent2D &extent);
+
+	/**
+	 * @brief Reads the statistics copied by the frame which last used the active frame,
+	 *        then copies the ones written since the previous begin() for the active frame
+	 */
+	void read_stats(CommandBuffer &command_buffer);
+
+	RenderContext &render_context;
+
+	uint32_t fragment_count;
+
+	VkExtent2D extent{};
+
+	/// Number of fragments of each pixel, including the dropped ones
+	std::unique_ptr<vkb::core::BufferC> count_buffer;
+
+	/// Packed color and depth of the fragments, fragment_count layers of one fragment per pixel
+	std::unique_ptr<vkb::core::BufferC> fragment_buffer;
+
+	/// Statistics written by the composite, a Stats
+	std::unique_ptr<vkb::core::BufferC> stats_buffer;
+
+	struct StatsReadback
+	{
+		std::unique_ptr<vkb::core::BufferC> buffer;
+
+		/// Whether a copy was recorded since the statistics were last read
+		bool pending{false};
+	};
+
+	/// Indexed by the render frames
+	std::vector<StatsReadback> stats_readbacks;
+
+	/// Whether a previous begin() cleared the statistics, so the composite may have written them since
+	bool stats_cleared{false};
+
+	Stats stats;
+
+	/// Allocated from the active render frame
+	BufferAllocationC uniform_allocation;
+};
+}        // namespace vkb
@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2021, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -17,6 +17,10 @@
 
 #include "pipeline_state.h"
 
+#include <cstring>
+
+#include "common/helpers.h"
+
 bool operator==(const VkVertexInputAttributeDescription &lhs, const VkVertexInputAttributeDescription &rhs)
 {
 	return std::tie(lhs.binding, lhs.format, lhs.location, lhs.offset) == std::tie(rhs.binding, rhs.format, rhs.location, rhs.offset);
@@ -82,13 +86,31 @@ bool operator!=(const vkb::ColorBlendState &lhs, const vkb::ColorBlendState &rhs
 	                   });
 }
 
+bool operator!=(const vkb::RenderingState &lhs, const vkb::RenderingState &rhs)
+{
+	return std::tie(lhs.color_attachment_formats, lhs.depth_attachment_format, lhs.stencil_attachment_format, lhs.local_read,
+	                lhs.color_attachment_locations, lhs.color_attachment_input_indices, lhs.depth_input_attachment_index, lhs.depth_stencil_disabled,
+	                lhs.shading_rate_attachment) !=
+	       std::tie(rhs.color_attachment_formats, rhs.depth_attachment_format, rhs.stencil_attachment_format, rhs.local_read,
+	                rhs.color_attachment_locations, rhs.color_attachment_input_indices, rhs.depth_input_attachment_index, rhs.depth_stencil_disabled,
+	                rhs.shading_rate_attachment);
+}
+
+bool operator!=(const vkb::FragmentShadingRateState &lhs, const vkb::FragmentShadingRateState &rhs)
+{
+	return std::tie(lhs.fragment_size.width, lhs.fragment_size.height, lhs.combiner_ops) != std::tie(rhs.fragment_size.width, rhs.fragment_size.height, rhs.combiner_ops);
+}
+
 namespace vkb
 {
 void SpecializationConstantState::reset()
 {
 	if (dirty)
 	{
-		specialization_constant_state.clear();
+		mask  = 0;
+		hash  = 0;
+		sizes = {};
+		data  = {};
 	}
 
 	dirty = false;
@@ -106,32 +128,107 @@ void SpecializationConstantState::clear_dirty()
 
 void SpecializationConstantState::set_constant(uint32_t constant_id, const std::vector<uint8_t> &value)
 {
-	auto data = specialization_constant_state.find(constant_id);
+	set_constant(constant_id, value.data(), value.size());
+}
 
-	if (data != specialization_constant_state.end() && data->second == value)
+void SpecializationConstantState::set_constant(uint32_t constant_id, const uint8_t *value, size_t size)
+{
+	if (constant_id >= MaxConstants || size > MaxConstantSize)
+	{
+		throw std::runtime_error("Specialization constant " + std::to_string(constant_id) + " of " + std::to_string(size) + " bytes is out of the supported range");
+	}
+
+	uint8_t   *slot = data.data() + constant_id * MaxConstantSize;
+	const bool set  = mask & (1u << constant_id);
+
+	if (set && sizes[constant_id] == size && std::memcmp(slot, value, size) == 0)
 	{
 		return;
 	}
 
 	dirty = true;
 
-	specialization_constant_state[constant_id] = value;
+	if (set)
+	{
+		hash ^= hash_constant(constant_id, slot, sizes[constant_id]);
+	}
+
+	std::memset(slot, 0, MaxConstantSize);
+	std::memcpy(slot, value, size);
+	sizes[constant_id] = static_cast<uint8_t>(size);
+	mask |= 1u << constant_id;
+
+	hash ^= hash_constant(constant_id, slot, size);
 }
 
 void SpecializationConstantState::set_specialization_constant_state(const std::map<uint32_t, std::vector<uint8_t>> &state)
 {
-	specialization_constant_state = state;
+	mask  = 0;
+	hash  = 0;
+	sizes = {};
+	data  = {};
+
+	for (auto &constant : state)
+	{
+		set_constant(constant.first, constant.second);
+	}
 }
 
-const std::map<uint32_t, std::vector<uint8_t>> &SpecializationConstantState::get_specialization_constant_state() const
+std::map<uint32_t, std::vector<uint8_t>> SpecializationConstantState::get_specialization_constant_state() const
 {
-	return specialization_constant_state;
+	std::map<uint32_t, std::vector<uint8_t>> state;
+
+	for (auto &entry : get_map_entries())
+	{
+		state[entry.constantID] = {data.begin() + entry.offset, data.begin() + entry.offset + entry.size};
+	}
+
+	return state;
+}
+
+std::vector<VkSpecializationMapEntry> SpecializationConstantState::get_map_entries() const
+{
+	std::vector<VkSpecializationMapEntry> map_entries;
+
+	for (uint32_t constant_id = 0; constant_id < MaxConstants; ++constant_id)
+	{
+		if (mask & (1u << constant_id))
+		{
+			map_entries.push_back({constant_id, constant_id * MaxConstantSize, sizes[constant_id]});
+		}
+	}
+
+	return map_entries;
+}
+
+const std::array<uint8_t, SpecializationConstantState::MaxConstants * SpecializationConstantState::MaxConstantSize> &SpecializationConstantState::get_data() const
+{
+	return data;
+}
+
+size_t SpecializationConstantState::get_hash() const
+{
+	return hash;
+}
+
+size_t SpecializationConstantState::hash_constant(uint32_t constant_id, const uint8_t *value, size_t size)
+{
+	uint64_t bits{0};
+	std::memcpy(&bits, value, size);
+
+	size_t result = 0;
+	hash_combine(result, constant_id);
+	hash_combine(result, size);
+	hash_combine(result, bits);
+	return result;
 }
 
 void PipelineState::reset()
 {
 	clear_dirty();
 
+	hash_valid = false;
+
 	pipeline_layout = nullptr;
 
 	render_pass = nullptr;
@@ -151,6 +248,10 @@ void PipelineState::reset()
 	color_blend_state = {};
 
 	subpass_index = {0U};
+
+	rendering_state = {};
+
+	fragment_shading_rate_state = {};
 }
 
 void PipelineState::set_pipeline_layout(PipelineLayout &new_pipeline_layout)
@@ -162,6 +263,8 @@ void PipelineState::set_pipeline_layout(PipelineLayout &new_pipeline_layout)
 			pipeline_layout = &new_pipeline_layout;
 
 			dirty = true;
+
+			hash_valid = false;
 		}
 	}
 	else
@@ -169,6 +272,8 @@ void PipelineState::set_pipeline_layout(PipelineLayout &new_pipeline_layout)
 		pipeline_layout = &new_pipeline_layout;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -181,6 +286,8 @@ void PipelineState::set_render_pass(const RenderPass &new_render_pass)
 			render_pass = &new_render_pass;
 
 			dirty = true;
+
+			hash_valid = false;
 		}
 	}
 	else
@@ -188,16 +295,25 @@ void PipelineState::set_render_pass(const RenderPass &new_render_pass)
 		render_pass = &new_render_pass;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
 void PipelineState::set_specialization_constant(uint32_t constant_id, const std::vector<uint8_t> &data)
 {
-	specialization_constant_state.set_constant(constant_id, data);
+	set_specialization_constant(constant_id, data.data(), data.size());
+}
+
+void PipelineState::set_specialization_constant(uint32_t constant_id, const uint8_t *data, size_t size)
+{
+	specialization_constant_state.set_constant(constant_id, data, size);
 
 	if (specialization_constant_state.is_dirty())
 	{
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -208,6 +324,8 @@ void PipelineState::set_vertex_input_state(const VertexInputState &new_vertex_in
 		vertex_input_state = new_vertex_input_state;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -218,6 +336,8 @@ void PipelineState::set_input_assembly_state(const InputAssemblyState &new_input
 		input_assembly_state = new_input_assembly_state;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -228,6 +348,8 @@ void PipelineState::set_rasterization_state(const RasterizationState &new_raster
 		rasterization_state = new_rasterization_state;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -238,6 +360,8 @@ void PipelineState::set_viewport_state(const ViewportState &new_viewport_state)
 		viewport_state = new_viewport_state;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -248,6 +372,8 @@ void PipelineState::set_multisample_state(const MultisampleState &new_multisampl
 		multisample_state = new_multisample_state;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -258,6 +384,8 @@ void PipelineState::set_depth_stencil_state(const DepthStencilState &new_depth_s
 		depth_stencil_state = new_depth_stencil_state;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -268,6 +396,8 @@ void PipelineState::set_color_blend_state(const ColorBlendState &new_color_blend
 		color_blend_state = new_color_blend_state;
 
 		dirty = true;
+
+		hash_valid = false;
 	}
 }
 
@@ -278,6 +408,42 @@ void PipelineState::set_subpass_index(uint32_t new_subpass_index)
 		subpass_index = new_subpass_index;
 
 		dirty = true;
+
+		hash_valid = false;
+	}
+}
+
+void PipelineState::set_rendering_state(const RenderingState &new_rendering_state)
+{
+	if (rendering_state != new_rendering_state)
+	{
+		rendering_state = new_rendering_state;
+
+		dirty = true;
+
+		hash_valid = false;
+	}
+}
+
+void PipelineState::set_fragment_shading_rate_state(const FragmentShadingRateState &new_fragment_shading_rate_state)
+{
+	if (fragment_shading_rate_state != new_fragment_shading_rate_state)
+	{
+		fragment_shading_rate_state = new_fragment_shading_rate_state;
+
+		dirty = true;
+
+		hash_valid = false;
+	}
+}
+
+void PipelineState::set_dynamic_state(uint32_t new_dynamic_state)
+{
+	if (dynamic_state != new_dynamic_state)
+	{
+		dynamic_state = new_dynamic_state;
+
+		hash_valid = false;
 	}
 }
 
@@ -337,6 +503,59 @@ uint32_t PipelineState::get_subpass_index() const
 	return subpass_index;
 }
 
+const RenderingState &PipelineState::get_rendering_state() const
+{
+	return rendering_state;
+}
+
+const FragmentShadingRateState &PipelineState::get_fragment_shading_rate_state() const
+{
+	return fragment_shading_rate_state;
+}
+
+std::vector<ColorBlendAttachmentState> PipelineState::get_rendering_color_blend_attachments() const
+{
+	if (!rendering_state.local_read)
+	{
+		return color_blend_state.attachments;
+	}
+
+	std::vector<ColorBlendAttachmentState> attachments(rendering_state.color_attachment_locations.size());
+	for (size_t i = 0; i < attachments.size(); ++i)
+	{
+		auto location = rendering_state.color_attachment_locations[i];
+		if (location < color_blend_state.attachments.size())
+		{
+			attachments[i] = color_blend_state.attachments[location];
+		}
+		else
+		{
+			attachments[i].color_write_mask = 0;
+		}
+	}
+	return attachments;
+}
+
+uint32_t PipelineState::get_dynamic_state() const
+{
+	return dynamic_state;
+}
+
+bool PipelineState::get_cached_hash(size_t &cached_hash) const
+{
+	if (hash_valid)
+	{
+		cached_hash = hash;
+	}
+	return hash_valid;
+}
+
+void PipelineState::set_cached_hash(size_t new_hash) const
+{
+	hash       = new_hash;
+	hash_valid = true;
+}
+
 bool PipelineState::is_dirty() const
 {
 	return dirty || specialization_constant_state.is_dirty();
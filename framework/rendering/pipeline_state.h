@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2023, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <array>
+#include <map>
 #include <vector>
 
 #include "common/vk_common.h"
@@ -133,10 +135,95 @@ struct ColorBlendState
 	std::vector<ColorBlendAttachmentState> attachments;
 };
 
+/// Attachments of the dynamic rendering instance a graphics pipeline is used in, which replace its render pass
+struct RenderingState
+{
+	std::vector<VkFormat> color_attachment_formats;
+
+	VkFormat depth_attachment_format{VK_FORMAT_UNDEFINED};
+
+	VkFormat stencil_attachment_format{VK_FORMAT_UNDEFINED};
+
+	/// Whether the subpasses share the instance and remap the attachments with VK_KHR_dynamic_rendering_local_read
+	VkBool32 local_read{VK_FALSE};
+
+	/// With local read, fragment output location of each color attachment, VK_ATTACHMENT_UNUSED if the subpass doesn't write it
+	std::vector<uint32_t> color_attachment_locations;
+
+	/// With local read, input attachment index of each color attachment, VK_ATTACHMENT_UNUSED if the subpass doesn't read it
+	std::vector<uint32_t> color_attachment_input_indices;
+
+	/// With local read, input attachment index of the depth attachment, VK_ATTACHMENT_UNUSED if the subpass doesn't read it
+	uint32_t depth_input_attachment_index{VK_ATTACHMENT_UNUSED};
+
+	/// With local read, whether the subpass disables its depth stencil attachment, the tests and writes to the one of the instance are off
+	VkBool32 depth_stencil_disabled{VK_FALSE};
+
+	/// Whether the instance has a fragment shading rate attachment
+	VkBool32 shading_rate_attachment{VK_FALSE};
+};
+
+/// Rate of the fragments of the draws, and how it combines with the rates of the primitives and of the shading rate attachment
+struct FragmentShadingRateState
+{
+	/// Rate of the pipeline, the first operand of the combiners
+	VkExtent2D fragment_size{1, 1};
+
+	/// Combine the rate with the one of the primitives, then the result with the one of the shading rate attachment
+	std::array<VkFragmentShadingRateCombinerOpKHR, 2> combiner_ops{VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR, VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR};
+};
+
+/// Members of the pipeline state which are set with dynamic state commands instead of being part of the pipelines
+/// The dynamic members are left out of the pipeline hash, so states only differing in them share a pipeline.
+struct DynamicPipelineState
+{
+	enum : uint32_t
+	{
+		None = 0,
+		/// VK_EXT_vertex_input_dynamic_state
+		VertexInput = 1 << 0,
+		/// VK_EXT_extended_dynamic_state, the topology class stays in the pipeline
+		PrimitiveTopology = 1 << 1,
+		CullMode          = 1 << 2,
+		FrontFace         = 1 << 3,
+		/// The enables, the compare operations and the stencil operations
+		DepthStencil = 1 << 4,
+		/// VK_EXT_extended_dynamic_state2
+		PrimitiveRestart  = 1 << 5,
+		RasterizerDiscard = 1 << 6,
+		DepthBiasEnable   = 1 << 7,
+		LogicOp           = 1 << 8,
+		/// VK_EXT_extended_dynamic_state3, with the feature of each member
+		PolygonMode          = 1 << 9,
+		DepthClamp           = 1 << 10,
+		RasterizationSamples = 1 << 11,
+		SampleMask           = 1 << 12,
+		AlphaToCoverage      = 1 << 13,
+		AlphaToOne           = 1 << 14,
+		LogicOpEnable        = 1 << 15,
+		ColorBlendEnable     = 1 << 16,
+		ColorBlendEquation   = 1 << 17,
+		ColorWriteMask       = 1 << 18,
+		All                  = (1 << 19) - 1
+	};
+};
+
 /// Helper class to create specialization constants for a Vulkan pipeline. The state tracks a pipeline globally, and not per shader. Two shaders using the same constant_id will have the same data.
+/**
+ * @brief Specialization constants of a pipeline, packed in a fixed size array
+ *
+ * Each constant id owns a slot of MaxConstantSize bytes, and a bitmask tracks the ids set.
+ * The hash is updated as constants change, so hashing the pipeline state doesn't visit them.
+ */
 class SpecializationConstantState
 {
   public:
+	/// Number of constant ids supported, from 0 to MaxConstants - 1
+	static constexpr uint32_t MaxConstants = 32;
+
+	/// Size of the largest constant type, a double
+	static constexpr uint32_t MaxConstantSize = 8;
+
 	void reset();
 
 	bool is_dirty() const;
@@ -148,26 +235,53 @@ class SpecializationConstantState
 
 	void set_constant(uint32_t constant_id, const std::vector<uint8_t> &data);
 
+	void set_constant(uint32_t constant_id, const uint8_t *data, size_t size);
+
 	void set_specialization_constant_state(const std::map<uint32_t, std::vector<uint8_t>> &state);
 
-	const std::map<uint32_t, std::vector<uint8_t>> &get_specialization_constant_state() const;
+	/**
+	 * @return A copy of the constants set, by constant id
+	 */
+	std::map<uint32_t, std::vector<uint8_t>> get_specialization_constant_state() const;
+
+	/**
+	 * @return The map entries of the constants set, in increasing constant id order
+	 *         Their offsets point into get_data().
+	 */
+	std::vector<VkSpecializationMapEntry> get_map_entries() const;
+
+	const std::array<uint8_t, MaxConstants * MaxConstantSize> &get_data() const;
+
+	size_t get_hash() const;
 
   private:
+	/// Hash of a single constant, combined with the others by XOR so it can be replaced in constant time
+	static size_t hash_constant(uint32_t constant_id, const uint8_t *data, size_t size);
+
 	bool dirty{false};
-	// Map tracking state of the Specialization Constants
-	std::map<uint32_t, std::vector<uint8_t>> specialization_constant_state;
+
+	/// Bit i is set when the constant i is set
+	uint32_t mask{0};
+
+	std::array<uint8_t, MaxConstants> sizes{};
+
+	std::array<uint8_t, MaxConstants * MaxConstantSize> data{};
+
+	size_t hash{0};
 };
 
 template <class T>
 inline void SpecializationConstantState::set_constant(std::uint32_t constant_id, const T &data)
 {
-	set_constant(constant_id, to_bytes(static_cast<std::uint32_t>(data)));
+	auto value = static_cast<std::uint32_t>(data);
+	set_constant(constant_id, reinterpret_cast<const uint8_t *>(&value), sizeof(value));
 }
 
 template <>
 inline void SpecializationConstantState::set_constant<bool>(std::uint32_t constant_id, const bool &data)
 {
-	set_constant(constant_id, to_bytes(static_cast<std::uint32_t>(data)));
+	auto value = static_cast<std::uint32_t>(data);
+	set_constant(constant_id, reinterpret_cast<const uint8_t *>(&value), sizeof(value));
 }
 
 class PipelineState
@@ -181,6 +295,8 @@ class PipelineState
 
 	void set_specialization_constant(uint32_t constant_id, const std::vector<uint8_t> &data);
 
+	void set_specialization_constant(uint32_t constant_id, const uint8_t *data, size_t size);
+
 	void set_vertex_input_state(const VertexInputState &vertex_input_state);
 
 	void set_input_assembly_state(const InputAssemblyState &input_assembly_state);
@@ -197,6 +313,22 @@ class PipelineState
 
 	void set_subpass_index(uint32_t subpass_index);
 
+	/**
+	 * @brief Sets the attachments of the dynamic rendering instance, used instead of the render pass when it isn't set
+	 */
+	void set_rendering_state(const RenderingState &rendering_state);
+
+	/**
+	 * @brief Sets the fragment shading rate, needs VK_KHR_fragment_shading_rate unless it is the default state
+	 */
+	void set_fragment_shading_rate_state(const FragmentShadingRateState &fragment_shading_rate_state);
+
+	/**
+	 * @brief Sets the members set dynamically, a mask of DynamicPipelineState
+	 *        It depends on the device and not on the draws, so it is kept by reset and doesn't dirty the state.
+	 */
+	void set_dynamic_state(uint32_t dynamic_state);
+
 	const PipelineLayout &get_pipeline_layout() const;
 
 	const RenderPass *get_render_pass() const;
@@ -219,6 +351,31 @@ class PipelineState
 
 	uint32_t get_subpass_index() const;
 
+	const RenderingState &get_rendering_state() const;
+
+	const FragmentShadingRateState &get_fragment_shading_rate_state() const;
+
+	/**
+	 * @brief Gets the blend states of the color attachments of the rendering instance
+	 *        The color blend state is indexed by fragment output location, with local read the blend state
+	 *        of each location is moved to the attachment it is remapped to, and the attachments not written are masked.
+	 */
+	std::vector<ColorBlendAttachmentState> get_rendering_color_blend_attachments() const;
+
+	uint32_t get_dynamic_state() const;
+
+	/**
+	 * @brief Gets the hash last computed by std::hash<PipelineState>, unless a setter changed the state since
+	 * @return Whether the cached hash is valid
+	 */
+	bool get_cached_hash(size_t &hash) const;
+
+	/**
+	 * @brief Caches the hash of the state until a setter changes it, so unchanged states aren't hashed again per draw
+	 *        As the lookups of a pipeline state are made by the thread recording it, the cache isn't synchronized.
+	 */
+	void set_cached_hash(size_t hash) const;
+
 	bool is_dirty() const;
 
 	void clear_dirty();
@@ -247,5 +404,15 @@ class PipelineState
 	ColorBlendState color_blend_state{};
 
 	uint32_t subpass_index{0U};
+
+	RenderingState rendering_state{};
+
+	FragmentShadingRateState fragment_shading_rate_state{};
+
+	uint32_t dynamic_state{DynamicPipelineState::None};
+
+	mutable size_t hash{0};
+
+	mutable bool hash_valid{false};
 };
 }        // namespace vkb
@@ -0,0 +1,300 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "postprocessing_autoexposurepass.h"
+
+#include <cmath>
+
+#include "common/glm_common.h"
+#include "glsl_compiler.h"
+#include "postprocessing_pipeline.h"
+
+namespace vkb
+{
+namespace
+{
+/**
+ * @brief Push constants of the histogram shader
+ */
+struct HistogramUniform
+{
+	glm::ivec2 source_size;
+	float      min_log_luminance;
+	float      inverse_log_luminance_range;
+};
+
+/**
+ * @brief Push constants of the average shader
+ */
+struct AverageUniform
+{
+	float    min_log_luminance;
+	float    log_luminance_range;
+	float    adaptation;
+	float    key_value;
+	uint32_t texel_count;
+};
+
+/// Width and height of the texels counted by a workgroup of the histogram shader
+constexpr uint32_t TileSize = 16;
+}        // namespace
+
+PostProcessingAutoExposurePass::PostProcessingAutoExposurePass(PostProcessingPipeline *parent, core::SampledImage &&source) :
+    PostProcessingPass{parent},
+    source{std::move(source)}
+{
+	auto &device = get_render_context().get_device();
+
+	// Subgroup operations need Vulkan 1.1 and SPIR-V 1.3, otherwise the threads only go through shared memory
+	if (device.get_gpu().get_properties().apiVersion >= VK_API_VERSION_1_1 &&
+	    GLSLCompiler::get_target_language() == glslang::EShTargetSpv &&
+	    GLSLCompiler::get_target_language_version() >= glslang::EShTargetSpv_1_3)
+	{
+		VkPhysicalDeviceSubgroupProperties subgroup_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+
+		VkPhysicalDeviceProperties2KHR properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+		properties.pNext = &subgroup_properties;
+		vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+
+		const VkSubgroupFeatureFlags required_operations =
+		    VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_VOTE_BIT | VK_SUBGROUP_FEATURE_BALLOT_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+
+		// The average shader keeps a partial sum per subgroup, for subgroups of at least 4 threads
+		if ((subgroup_properties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+		    (subgroup_properties.supportedOperations & required_operations) == required_operations &&
+		    subgroup_properties.subgroupSize >= 4)
+		{
+			variant.add_define("SUBGROUP");
+		}
+	}
+
+	// Texels are fetched, the sampler doesn't filter them
+	VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+	sampler_info.minFilter    = VK_FILTER_NEAREST;
+	sampler_info.magFilter    = VK_FILTER_NEAREST;
+	sampler_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.maxLod       = VK_LOD_CLAMP_NONE;
+	sampler_info.borderColor  = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	sampler = &device.get_resource_cache().RequestSampler(sampler_info);
+
+	histogram_buffer = std::make_unique<core::BufferC>(device, BinCount * sizeof(uint32_t),
+	                                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+	                                                   VMA_MEMORY_USAGE_GPU_ONLY);
+	histogram_buffer->set_debug_name("Auto-exposure pass: histogram");
+
+	exposure_buffer = std::make_unique<core::BufferC>(device, sizeof(Exposure),
+	                                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+	                                                  VMA_MEMORY_USAGE_GPU_ONLY);
+	exposure_buffer->set_debug_name("Auto-exposure pass: exposure");
+}
+
+PostProcessingAutoExposurePass &PostProcessingAutoExposurePass::set_source(core::SampledImage &&new_source)
+{
+	source = std::move(new_source);
+
+	return *this;
+}
+
+PostProcessingAutoExposurePass &PostProcessingAutoExposurePass::set_luminance_range(float new_min_log_luminance, float new_max_log_luminance)
+{
+	assert(new_min_log_luminance < new_max_log_luminance);
+	min_log_luminance = new_min_log_luminance;
+	max_log_luminance = new_max_log_luminance;
+
+	return *this;
+}
+
+PostProcessingAutoExposurePass &PostProcessingAutoExposurePass::set_adaptation_rate(float rate)
+{
+	adaptation_rate = rate;
+
+	return *this;
+}
+
+PostProcessingAutoExposurePass &PostProcessingAutoExposurePass::set_key_value(float new_key_value)
+{
+	key_value = new_key_value;
+
+	return *this;
+}
+
+PostProcessingAutoExposurePass &PostProcessingAutoExposurePass::set_delta_time(float new_delta_time)
+{
+	delta_time = new_delta_time;
+
+	return *this;
+}
+
+void PostProcessingAutoExposurePass::prepare(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	// Build the compute shaders upfront
+	auto &resource_cache = get_render_context().get_device().get_resource_cache();
+	resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, histogram_source, variant);
+	resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, average_source, variant);
+}
+
+void PostProcessingAutoExposurePass::transition_source(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	const uint32_t *attachment = source.get_target_attachment();
+	if (attachment == nullptr)
+	{
+		return;
+	}
+
+	auto &source_rt = source.get_render_target(default_render_target);
+	if (source_rt.get_layout(*attachment) == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+	{
+		// No-op
+		return;
+	}
+
+	BarrierInfo fallback_barrier_src{};
+	fallback_barrier_src.pipeline_stage     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	fallback_barrier_src.image_read_access  = 0;
+	fallback_barrier_src.image_write_access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	auto prev_pass_barrier_info             = get_predecessor_src_barrier_info(fallback_barrier_src);
+
+	vkb::ImageMemoryBarrier barrier;
+	barrier.old_layout      = source_rt.get_layout(*attachment);
+	barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.src_access_mask = prev_pass_barrier_info.image_write_access;
+	barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.src_stage_mask  = prev_pass_barrier_info.pipeline_stage;
+	barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	assert(*attachment < source_rt.get_views().size());
+	command_buffer.image_memory_barrier(source_rt.get_views()[*attachment], barrier);
+	source_rt.set_layout(*attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void PostProcessingAutoExposurePass::draw(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	transition_source(command_buffer, default_render_target);
+
+	const auto    &source_view  = source.get_image_view(default_render_target);
+	const uint32_t source_level = source_view.get_subresource_range().baseMipLevel;
+	const auto    &image_extent = source_view.get_image().get_extent();
+	const VkExtent2D extent{std::max(1u, image_extent.width >> source_level), std::max(1u, image_extent.height >> source_level)};
+
+	// The histogram is cleared before each frame, after the previous one is done with it
+	BufferMemoryBarrier reuse_barrier{};
+	reuse_barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+	reuse_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	command_buffer.buffer_memory_barrier(*histogram_buffer, 0, VK_WHOLE_SIZE, reuse_barrier);
+
+	vkCmdFillBuffer(command_buffer.get_handle(), histogram_buffer->get_handle(), 0, VK_WHOLE_SIZE, 0);
+
+	if (!exposure_cleared)
+	{
+		// A zero adapted luminance makes the first frame start from its average
+		vkCmdFillBuffer(command_buffer.get_handle(), exposure_buffer->get_handle(), 0, VK_WHOLE_SIZE, 0);
+		exposure_cleared = true;
+	}
+
+	BufferMemoryBarrier clear_barrier{};
+	clear_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	clear_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	clear_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	clear_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*histogram_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+	command_buffer.buffer_memory_barrier(*exposure_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+
+	auto &resource_cache = command_buffer.get_device().get_resource_cache();
+
+	// Histogram
+	{
+		auto &shader_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, histogram_source, variant);
+		auto &pipeline_layout = resource_cache.RequestPipelineLayout({&shader_module});
+		command_buffer.bind_pipeline_layout(pipeline_layout);
+
+		command_buffer.bind_image(source_view, *sampler, 0, 0, 0);
+		command_buffer.bind_buffer(*histogram_buffer, 0, histogram_buffer->get_size(), 0, 1, 0);
+
+		HistogramUniform uniform{};
+		uniform.source_size                 = glm::ivec2(extent.width, extent.height);
+		uniform.min_log_luminance           = min_log_luminance;
+		uniform.inverse_log_luminance_range = 1.0f / (max_log_luminance - min_log_luminance);
+		command_buffer.push_constants(uniform);
+
+		command_buffer.dispatch((extent.width + TileSize - 1) / TileSize, (extent.height + TileSize - 1) / TileSize, 1);
+	}
+
+	// The histogram is complete, and the previous frame is done reading the exposure
+	BufferMemoryBarrier histogram_barrier{};
+	histogram_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	histogram_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	histogram_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	histogram_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	command_buffer.buffer_memory_barrier(*histogram_buffer, 0, VK_WHOLE_SIZE, histogram_barrier);
+
+	BufferMemoryBarrier exposure_reuse_barrier{};
+	exposure_reuse_barrier.src_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	exposure_reuse_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	exposure_reuse_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*exposure_buffer, 0, VK_WHOLE_SIZE, exposure_reuse_barrier);
+
+	// Average and adaptation
+	{
+		auto &shader_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, average_source, variant);
+		auto &pipeline_layout = resource_cache.RequestPipelineLayout({&shader_module});
+		command_buffer.bind_pipeline_layout(pipeline_layout);
+
+		command_buffer.bind_buffer(*histogram_buffer, 0, histogram_buffer->get_size(), 0, 1, 0);
+		command_buffer.bind_buffer(*exposure_buffer, 0, exposure_buffer->get_size(), 0, 2, 0);
+
+		AverageUniform uniform{};
+		uniform.min_log_luminance   = min_log_luminance;
+		uniform.log_luminance_range = max_log_luminance - min_log_luminance;
+		uniform.adaptation          = 1.0f - std::exp(-delta_time * adaptation_rate);
+		uniform.key_value           = key_value;
+		uniform.texel_count         = extent.width * extent.height;
+		command_buffer.push_constants(uniform);
+
+		command_buffer.dispatch(1, 1, 1);
+	}
+
+	// The exposure is read by the following passes
+	BufferMemoryBarrier read_barrier{};
+	read_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	read_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	read_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	read_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+	command_buffer.buffer_memory_barrier(*exposure_buffer, 0, VK_WHOLE_SIZE, read_barrier);
+}
+
+PostProcessingAutoExposurePass::BarrierInfo PostProcessingAutoExposurePass::get_src_barrier_info() const
+{
+	BarrierInfo info{};
+	info.pipeline_stage     = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	info.image_read_access  = VK_ACCESS_SHADER_READ_BIT;
+	info.image_write_access = 0;
+	return info;
+}
+
+PostProcessingAutoExposurePass::BarrierInfo PostProcessingAutoExposurePass::get_dst_barrier_info() const
+{
+	BarrierInfo info{};
+	info.pipeline_stage     = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	info.image_read_access  = VK_ACCESS_SHADER_READ_BIT;
+	info.image_write_access = 0;
+	return info;
+}
+
+}        // namespace vkb
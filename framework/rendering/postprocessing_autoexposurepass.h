@@ -0,0 +1,153 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "core/sampled_image.h"
+#include "postprocessing_pass.h"
+
+namespace vkb
+{
+/**
+ * @brief A compute pass in a vkb::PostProcessingPipeline measuring the luminance of an image for auto-exposure.
+ *
+ * A first dispatch counts the texels of the source in BinCount bins of log2 luminance, the second one reduces the
+ * histogram to the average luminance of the non-black texels, moves the adapted luminance toward it and derives the
+ * exposure from it. Both results stay on the GPU: the passes that follow read them from get_exposure_buffer(), so the
+ * exposure of a frame is measured on the frame before it.
+ *
+ * Threads count into bins in shared memory, and when the device supports subgroup vote, ballot and arithmetic in
+ * compute, subgroups falling in a single bin are counted with one atomic and the reduction of the histogram uses
+ * subgroup adds. Counting a 4K source costs a read of every texel; measuring a level of a
+ * vkb::PostProcessingDownsamplePass instead, a quarter or a sixteenth of its size, keeps the pass well under 0.1 ms.
+ */
+class PostProcessingAutoExposurePass : public PostProcessingPass<PostProcessingAutoExposurePass>
+{
+  public:
+	/// Number of bins of the histogram, bin 0 counts the black texels
+	static constexpr uint32_t BinCount = 256;
+
+	/**
+	 * @brief Contents of get_exposure_buffer()
+	 */
+	struct Exposure
+	{
+		/// Luminance the exposure is computed from, following the average over time
+		float adapted_luminance;
+
+		/// Scale to apply to the color of the source before tonemapping
+		float exposure;
+
+		/// Average luminance of the last frame measured
+		float average_luminance;
+
+		float padding;
+	};
+
+	/**
+	 * @param parent The pipeline the pass belongs to
+	 * @param source The image to measure, a RenderTarget attachment or a user-created image
+	 */
+	PostProcessingAutoExposurePass(PostProcessingPipeline *parent, core::SampledImage &&source);
+
+	PostProcessingAutoExposurePass(const PostProcessingAutoExposurePass &to_copy)            = delete;
+	PostProcessingAutoExposurePass &operator=(const PostProcessingAutoExposurePass &to_copy) = delete;
+
+	PostProcessingAutoExposurePass(PostProcessingAutoExposurePass &&to_move)            = default;
+	PostProcessingAutoExposurePass &operator=(PostProcessingAutoExposurePass &&to_move) = default;
+
+	void prepare(CommandBuffer &command_buffer, RenderTarget &default_render_target) override;
+	void draw(CommandBuffer &command_buffer, RenderTarget &default_render_target) override;
+
+	/**
+	 * @brief Changes the image measured by this pass.
+	 * @remarks Images from RenderTarget attachments are automatically transitioned to SHADER_READ_ONLY_OPTIMAL layout if needed.
+	 *          If no RenderTarget is specifically set, the one passed to draw() is used.
+	 */
+	PostProcessingAutoExposurePass &set_source(core::SampledImage &&new_source);
+
+	/**
+	 * @brief Sets the range of log2 luminance covered by the bins, darker and brighter texels are clamped to it.
+	 */
+	PostProcessingAutoExposurePass &set_luminance_range(float min_log_luminance, float max_log_luminance);
+
+	/**
+	 * @brief Sets how fast the adapted luminance follows the average, as the inverse of its time constant in seconds.
+	 */
+	PostProcessingAutoExposurePass &set_adaptation_rate(float rate);
+
+	/**
+	 * @brief Sets the luminance the adapted luminance is exposed to, 0.18 for a middle grey.
+	 */
+	PostProcessingAutoExposurePass &set_key_value(float key_value);
+
+	/**
+	 * @brief Sets the time elapsed since the previous frame, which the adaptation of the next draw() covers.
+	 */
+	PostProcessingAutoExposurePass &set_delta_time(float delta_time);
+
+	/**
+	 * @brief Returns the histogram of the last frame, BinCount uint32_t.
+	 * @remarks It is cleared at the start of every draw().
+	 */
+	inline const core::BufferC &get_histogram_buffer() const
+	{
+		return *histogram_buffer;
+	}
+
+	/**
+	 * @brief Returns the buffer holding an Exposure, readable by the compute and fragment shaders of the passes that follow.
+	 */
+	inline const core::BufferC &get_exposure_buffer() const
+	{
+		return *exposure_buffer;
+	}
+
+  private:
+	/**
+	 * @brief Transitions the source to SHADER_READ_ONLY_OPTIMAL if it is a RenderTarget attachment.
+	 */
+	void transition_source(CommandBuffer &command_buffer, RenderTarget &default_render_target);
+
+	BarrierInfo get_src_barrier_info() const override;
+	BarrierInfo get_dst_barrier_info() const override;
+
+	ShaderSource  histogram_source{"postprocessing/luminance_histogram.comp"};
+	ShaderSource  average_source{"postprocessing/luminance_average.comp"};
+	ShaderVariant variant{};
+
+	core::SampledImage source;
+
+	float min_log_luminance{-10.0f};
+	float max_log_luminance{6.0f};
+	float adaptation_rate{1.5f};
+	float key_value{0.18f};
+	float delta_time{0.0f};
+
+	/// Owned by the resource cache
+	const core::Sampler *sampler{nullptr};
+
+	std::unique_ptr<core::BufferC> histogram_buffer{};
+
+	/// Persists across frames, the adaptation starts from its previous value
+	std::unique_ptr<core::BufferC> exposure_buffer{};
+
+	/// Whether the exposure buffer was cleared, before the first draw
+	bool exposure_cleared{false};
+};
+
+}        // namespace vkb
@@ -0,0 +1,347 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "postprocessing_downsamplepass.h"
+
+#include "common/glm_common.h"
+#include "common/strings.h"
+#include "glsl_compiler.h"
+#include "postprocessing_pipeline.h"
+
+namespace vkb
+{
+namespace
+{
+/**
+ * @brief Push constants of the downsample shader
+ */
+struct DownsampleUniform
+{
+	glm::ivec2 source_size;
+	uint32_t   level_count;
+};
+
+/// Width and height of the first level covered by a workgroup
+constexpr uint32_t TileSize = 32;
+
+/**
+ * @brief Returns the GLSL format qualifier of a storage image of the given format
+ */
+const char *get_format_qualifier(VkFormat format)
+{
+	switch (format)
+	{
+		case VK_FORMAT_R16_SFLOAT:
+			return "r16f";
+		case VK_FORMAT_R32_SFLOAT:
+			return "r32f";
+		case VK_FORMAT_R16G16_SFLOAT:
+			return "rg16f";
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+			return "r11f_g11f_b10f";
+		case VK_FORMAT_R8G8B8A8_UNORM:
+			return "rgba8";
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return "rgba16f";
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return "rgba32f";
+		default:
+			throw std::runtime_error("Unsupported format for the downsample pass: " + to_string(format));
+	}
+}
+
+VkExtent2D get_level_extent(const VkExtent2D &extent)
+{
+	return {std::max(1u, (extent.width + 1) / 2), std::max(1u, (extent.height + 1) / 2)};
+}
+
+VkExtent2D get_workgroup_count(const VkExtent2D &first_level_extent)
+{
+	return {(first_level_extent.width + TileSize - 1) / TileSize, (first_level_extent.height + TileSize - 1) / TileSize};
+}
+}        // namespace
+
+PostProcessingDownsamplePass::PostProcessingDownsamplePass(PostProcessingPipeline *parent, core::SampledImage &&source, VkFormat format, Reduction reduction) :
+    PostProcessingPass{parent},
+    source{std::move(source)},
+    format{format},
+    reduction{reduction}
+{
+	auto &device = get_render_context().get_device();
+
+	if (!(device.get_gpu().get_format_properties(format).optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+	{
+		throw std::runtime_error("The levels of the downsample pass can't be storage images of format " + to_string(format));
+	}
+
+	// Subgroup operations need Vulkan 1.1 and SPIR-V 1.3, otherwise the threads reduce through shared memory only
+	if (device.get_gpu().get_properties().apiVersion >= VK_API_VERSION_1_1 &&
+	    GLSLCompiler::get_target_language() == glslang::EShTargetSpv &&
+	    GLSLCompiler::get_target_language_version() >= glslang::EShTargetSpv_1_3)
+	{
+		VkPhysicalDeviceSubgroupProperties subgroup_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+
+		VkPhysicalDeviceProperties2KHR properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+		properties.pNext = &subgroup_properties;
+		vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+
+		// The quads must be made of consecutive threads of full subgroups
+		subgroup_quad = (subgroup_properties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+		                (subgroup_properties.supportedOperations & VK_SUBGROUP_FEATURE_QUAD_BIT) &&
+		                subgroup_properties.subgroupSize >= 4 && 256 % subgroup_properties.subgroupSize == 0;
+	}
+
+	// Texels are fetched, the sampler doesn't filter them
+	VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+	sampler_info.minFilter    = VK_FILTER_NEAREST;
+	sampler_info.magFilter    = VK_FILTER_NEAREST;
+	sampler_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.maxLod       = VK_LOD_CLAMP_NONE;
+	sampler_info.borderColor  = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	sampler = &device.get_resource_cache().RequestSampler(sampler_info);
+
+	counter_buffer = std::make_unique<core::BufferC>(device, sizeof(uint32_t),
+	                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                 VMA_MEMORY_USAGE_GPU_ONLY);
+	counter_buffer->set_debug_name("Downsample pass: finished workgroups");
+
+	update_variant();
+}
+
+PostProcessingDownsamplePass &PostProcessingDownsamplePass::set_source(core::SampledImage &&new_source)
+{
+	source = std::move(new_source);
+
+	return *this;
+}
+
+PostProcessingDownsamplePass &PostProcessingDownsamplePass::set_log_luminance(bool enable)
+{
+	log_luminance = enable;
+	update_variant();
+
+	return *this;
+}
+
+void PostProcessingDownsamplePass::update_variant()
+{
+	cs_variant = {};
+	cs_variant.add_define(std::string{"DESTINATION_FORMAT="} + get_format_qualifier(format));
+
+	if (reduction == Reduction::Minimum)
+	{
+		cs_variant.add_define("REDUCTION_MIN");
+	}
+	else if (reduction == Reduction::Maximum)
+	{
+		cs_variant.add_define("REDUCTION_MAX");
+	}
+
+	if (log_luminance)
+	{
+		cs_variant.add_define("LOG_LUMINANCE");
+	}
+
+	if (subgroup_quad)
+	{
+		cs_variant.add_define("SUBGROUP_QUAD");
+	}
+}
+
+void PostProcessingDownsamplePass::prepare(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	// Build the compute shader upfront
+	auto &resource_cache = get_render_context().get_device().get_resource_cache();
+	resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, cs_source, cs_variant);
+}
+
+void PostProcessingDownsamplePass::create_levels(const VkExtent2D &extent)
+{
+	auto &device = get_render_context().get_device();
+
+	auto first_extent = get_level_extent(extent);
+
+	uint32_t level_count = 1;
+	for (auto level_extent = first_extent; level_extent.width > 1 || level_extent.height > 1; level_extent = get_level_extent(level_extent))
+	{
+		++level_count;
+	}
+
+	// The last workgroup reduces the last level of the tiles, holding a texel per workgroup, as a tile of its own.
+	// Larger sources stop at the levels of the tiles.
+	const auto workgroup_count = get_workgroup_count(first_extent);
+	const bool single_tile     = workgroup_count.width <= 2 * TileSize && workgroup_count.height <= 2 * TileSize;
+	level_count                = std::min(level_count, single_tile ? MaxLevelCount : TileLevelCount);
+
+	level_views.clear();
+	view.reset();
+
+	image = std::make_unique<core::Image>(device, core::ImageBuilder(VkExtent3D{first_extent.width, first_extent.height, 1})
+	                                                  .with_format(format)
+	                                                  .with_usage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+	                                                  .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY)
+	                                                  .with_mip_levels(level_count)
+	                                                  .with_debug_name("Downsample pass: levels"));
+
+	view = std::make_unique<core::ImageView>(*image, VK_IMAGE_VIEW_TYPE_2D, format);
+	for (uint32_t level = 0; level < level_count; ++level)
+	{
+		level_views.push_back(std::make_unique<core::ImageView>(*image, VK_IMAGE_VIEW_TYPE_2D, format, level, 0, 1, 1));
+	}
+
+	source_extent = extent;
+}
+
+void PostProcessingDownsamplePass::transition_source(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	const uint32_t *attachment = source.get_target_attachment();
+	if (attachment == nullptr)
+	{
+		return;
+	}
+
+	auto &source_rt = source.get_render_target(default_render_target);
+	if (source_rt.get_layout(*attachment) == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+	{
+		// No-op
+		return;
+	}
+
+	BarrierInfo fallback_barrier_src{};
+	fallback_barrier_src.pipeline_stage     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	fallback_barrier_src.image_read_access  = 0;
+	fallback_barrier_src.image_write_access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	auto prev_pass_barrier_info             = get_predecessor_src_barrier_info(fallback_barrier_src);
+
+	vkb::ImageMemoryBarrier barrier;
+	barrier.old_layout      = source_rt.get_layout(*attachment);
+	barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.src_access_mask = prev_pass_barrier_info.image_write_access;
+	barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.src_stage_mask  = prev_pass_barrier_info.pipeline_stage;
+	barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	if (barrier.old_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+	{
+		barrier.src_stage_mask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		barrier.src_access_mask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	}
+
+	assert(*attachment < source_rt.get_views().size());
+	command_buffer.image_memory_barrier(source_rt.get_views()[*attachment], barrier);
+	source_rt.set_layout(*attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void PostProcessingDownsamplePass::draw(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	transition_source(command_buffer, default_render_target);
+
+	const auto    &source_view  = source.get_image_view(default_render_target);
+	const uint32_t source_level = source_view.get_subresource_range().baseMipLevel;
+	const auto    &image_extent = source_view.get_image().get_extent();
+	const VkExtent2D extent{std::max(1u, image_extent.width >> source_level), std::max(1u, image_extent.height >> source_level)};
+
+	if (!image || source_extent.width != extent.width || source_extent.height != extent.height)
+	{
+		create_levels(extent);
+	}
+
+	// The levels read by the previous frame are written again, their contents are discarded
+	vkb::ImageMemoryBarrier reuse_barrier;
+	reuse_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+	reuse_barrier.new_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	reuse_barrier.src_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	reuse_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	reuse_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.image_memory_barrier(*view, reuse_barrier);
+
+	// The counter is reset before each dispatch, after the previous one is done with it
+	BufferMemoryBarrier counter_reuse_barrier{};
+	counter_reuse_barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	counter_reuse_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	command_buffer.buffer_memory_barrier(*counter_buffer, 0, VK_WHOLE_SIZE, counter_reuse_barrier);
+
+	vkCmdFillBuffer(command_buffer.get_handle(), counter_buffer->get_handle(), 0, VK_WHOLE_SIZE, 0);
+
+	BufferMemoryBarrier counter_clear_barrier{};
+	counter_clear_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	counter_clear_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	counter_clear_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	counter_clear_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*counter_buffer, 0, VK_WHOLE_SIZE, counter_clear_barrier);
+
+	// Get compute shader from cache
+	auto &resource_cache = command_buffer.get_device().get_resource_cache();
+	auto &shader_module  = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, cs_source, cs_variant);
+
+	// Create pipeline layout and bind it
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	const uint32_t level_count = get_level_count();
+
+	command_buffer.bind_image(source_view, *sampler, 0, 0, 0);
+
+	// Every element of the array is bound, the ones past the last level are never written
+	for (uint32_t level = 0; level < MaxLevelCount; ++level)
+	{
+		command_buffer.bind_image(*level_views[std::min(level, level_count - 1)], 0, 1, level);
+	}
+	command_buffer.bind_image(*level_views[std::min(TileLevelCount, level_count) - 1], 0, 2, 0);
+	command_buffer.bind_buffer(*counter_buffer, 0, counter_buffer->get_size(), 0, 3, 0);
+
+	DownsampleUniform uniform{};
+	uniform.source_size = glm::ivec2(extent.width, extent.height);
+	uniform.level_count = level_count;
+	command_buffer.push_constants(uniform);
+
+	const auto workgroup_count = get_workgroup_count(get_level_extent(extent));
+	command_buffer.dispatch(workgroup_count.width, workgroup_count.height, 1);
+
+	// The levels are sampled by the following passes
+	vkb::ImageMemoryBarrier read_barrier;
+	read_barrier.old_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	read_barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	read_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	read_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	read_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	read_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	command_buffer.image_memory_barrier(*view, read_barrier);
+}
+
+PostProcessingDownsamplePass::BarrierInfo PostProcessingDownsamplePass::get_src_barrier_info() const
+{
+	BarrierInfo info{};
+	info.pipeline_stage     = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	info.image_read_access  = VK_ACCESS_SHADER_READ_BIT;
+	info.image_write_access = VK_ACCESS_SHADER_WRITE_BIT;
+	return info;
+}
+
+PostProcessingDownsamplePass::BarrierInfo PostProcessingDownsamplePass::get_dst_barrier_info() const
+{
+	BarrierInfo info{};
+	info.pipeline_stage     = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	info.image_read_access  = VK_ACCESS_SHADER_READ_BIT;
+	info.image_write_access = VK_ACCESS_SHADER_WRITE_BIT;
+	return info;
+}
+
+}        // namespace vkb
@@ -0,0 +1,151 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "core/sampled_image.h"
+#include "postprocessing_pass.h"
+
+namespace vkb
+{
+/**
+ * @brief A compute pass in a vkb::PostProcessingPipeline reducing an image to a chain of mip levels, in a single dispatch.
+ *
+ * Each workgroup reduces a 64x64 tile of the source to the first TileLevelCount levels, then the last workgroup to
+ * finish, found with an atomic counter, reduces the last of them to the remaining levels. The first level halves the
+ * source, the others halve the previous level, rounding up. Bloom mip chains, the luminance reduction of auto-exposure
+ * and Hi-Z pyramids can all be built with it, instead of one dispatch or renderpass per level.
+ */
+class PostProcessingDownsamplePass : public PostProcessingPass<PostProcessingDownsamplePass>
+{
+  public:
+	/**
+	 * @brief How the 2x2 texels of a level are reduced to a texel of the next one.
+	 */
+	enum class Reduction
+	{
+		Average,
+		Minimum,
+		Maximum
+	};
+
+	/// Levels written by every workgroup, before the last one reduces the rest
+	static constexpr uint32_t TileLevelCount = 6;
+
+	/// Most levels written by a dispatch, enough for a 4096x4096 source
+	static constexpr uint32_t MaxLevelCount = 12;
+
+	/**
+	 * @param parent The pipeline the pass belongs to
+	 * @param source The image to reduce, a RenderTarget attachment or a user-created image
+	 * @param format The format of the levels, it must support storage images
+	 * @param reduction How texels are reduced
+	 */
+	PostProcessingDownsamplePass(PostProcessingPipeline *parent, core::SampledImage &&source, VkFormat format, Reduction reduction = Reduction::Average);
+
+	PostProcessingDownsamplePass(const PostProcessingDownsamplePass &to_copy)            = delete;
+	PostProcessingDownsamplePass &operator=(const PostProcessingDownsamplePass &to_copy) = delete;
+
+	PostProcessingDownsamplePass(PostProcessingDownsamplePass &&to_move)            = default;
+	PostProcessingDownsamplePass &operator=(PostProcessingDownsamplePass &&to_move) = default;
+
+	void prepare(CommandBuffer &command_buffer, RenderTarget &default_render_target) override;
+	void draw(CommandBuffer &command_buffer, RenderTarget &default_render_target) override;
+
+	/**
+	 * @brief Changes the image reduced by this pass.
+	 * @remarks Images from RenderTarget attachments are automatically transitioned to SHADER_READ_ONLY_OPTIMAL layout if needed.
+	 *          If no RenderTarget is specifically set, the one passed to draw() is used.
+	 */
+	PostProcessingDownsamplePass &set_source(core::SampledImage &&new_source);
+
+	/**
+	 * @brief Sets whether the log2 of the luminance of the source is reduced instead of its color.
+	 *        With Reduction::Average, the last level then holds the log2 of the geometric mean luminance.
+	 */
+	PostProcessingDownsamplePass &set_log_luminance(bool enable);
+
+	/**
+	 * @brief Returns the number of levels written, 0 before the first draw().
+	 */
+	inline uint32_t get_level_count() const
+	{
+		return static_cast<uint32_t>(level_views.size());
+	}
+
+	/**
+	 * @brief Returns a view of all the levels, to sample them with mipmapping.
+	 * @remarks The levels are left in SHADER_READ_ONLY_OPTIMAL layout after draw().
+	 */
+	inline const core::ImageView &get_view() const
+	{
+		assert(view && "The levels are created by the first draw");
+		return *view;
+	}
+
+	/**
+	 * @brief Returns a view of a single level.
+	 */
+	inline const core::ImageView &get_level_view(uint32_t level) const
+	{
+		assert(level < level_views.size());
+		return *level_views[level];
+	}
+
+  private:
+	/**
+	 * @brief Creates the levels for a source of the given extent.
+	 */
+	void create_levels(const VkExtent2D &extent);
+
+	/**
+	 * @brief Transitions the source to SHADER_READ_ONLY_OPTIMAL if it is a RenderTarget attachment.
+	 */
+	void transition_source(CommandBuffer &command_buffer, RenderTarget &default_render_target);
+
+	/**
+	 * @brief Selects the shader variant matching the reduction, the format and the device.
+	 */
+	void update_variant();
+
+	BarrierInfo get_src_barrier_info() const override;
+	BarrierInfo get_dst_barrier_info() const override;
+
+	ShaderSource  cs_source{"postprocessing/downsample.comp"};
+	ShaderVariant cs_variant{};
+
+	core::SampledImage source;
+	VkFormat           format;
+	Reduction          reduction;
+	bool               log_luminance{false};
+
+	/// Whether the reductions across threads use subgroup quad operations
+	bool subgroup_quad{false};
+
+	/// Owned by the resource cache
+	const core::Sampler *sampler{nullptr};
+
+	VkExtent2D                                    source_extent{};
+	std::unique_ptr<core::Image>                  image{};
+	std::unique_ptr<core::ImageView>              view{};
+	std::vector<std::unique_ptr<core::ImageView>> level_views{};
+
+	/// Workgroups finished with their tile, reset before each dispatch
+	std::unique_ptr<core::BufferC> counter_buffer{};
+};
+
+}        // namespace vkb
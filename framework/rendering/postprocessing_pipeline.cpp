@@ -17,7 +17,9 @@
 
 #include "postprocessing_pipeline.h"
 
+#include "common/gpu_profiling.h"
 #include "common/utils.h"
+#include "postprocessing_renderpass.h"
 
 namespace vkb
 {
@@ -36,14 +38,34 @@ void PostProcessingPipeline::draw(CommandBuffer &command_buffer, RenderTarget &d
 		{
 			pass.debug_name = fmt::format("PPP pass #{}", current_pass_index);
 		}
-		ScopedDebugLabel marker{command_buffer, pass.debug_name.c_str()};
 
-		if (!pass.prepared)
+		// Merged passes read the outputs of their predecessors on-tile, instead of storing and loading them back
+		auto merged_passes = get_merged_passes(default_render_target);
+
+		std::string debug_name = pass.debug_name;
+		for (size_t i = 0; i < merged_passes.size(); ++i)
 		{
-			ScopedDebugLabel marker{command_buffer, "Prepare"};
+			auto &merged_pass = *merged_passes[i];
+			if (merged_pass.debug_name.empty())
+			{
+				merged_pass.debug_name = fmt::format("PPP pass #{}", current_pass_index + i + 1);
+			}
+			debug_name += " + " + merged_pass.debug_name;
+		}
 
-			pass.prepare(command_buffer, default_render_target);
-			pass.prepared = true;
+		ScopedDebugLabel marker{command_buffer, debug_name.c_str()};
+		PROFILE_GPU_SCOPE_DYNAMIC(command_buffer.get_handle(), debug_name.c_str(), true);
+
+		for (size_t i = 0; i <= merged_passes.size(); ++i)
+		{
+			auto &prepared_pass = *passes[current_pass_index + i];
+			if (!prepared_pass.prepared)
+			{
+				ScopedDebugLabel marker{command_buffer, "Prepare"};
+
+				prepared_pass.prepare(command_buffer, default_render_target);
+				prepared_pass.prepared = true;
+			}
 		}
 
 		if (pass.pre_draw)
@@ -53,17 +75,60 @@ void PostProcessingPipeline::draw(CommandBuffer &command_buffer, RenderTarget &d
 			pass.pre_draw();
 		}
 
-		pass.draw(command_buffer, default_render_target);
+		auto    *gpu_frame_timer = render_context->get_gpu_frame_timer();
+		uint32_t timed_pass      = GpuFrameTimer::MaxPasses;
+		if (gpu_frame_timer)
+		{
+			timed_pass = gpu_frame_timer->begin_pass(command_buffer.get_handle(), render_context->get_active_frame_index(), debug_name);
+		}
+
+		if (merged_passes.empty())
+		{
+			pass.draw(command_buffer, default_render_target);
+		}
+		else
+		{
+			get_pass<PostProcessingRenderPass>(current_pass_index).draw(command_buffer, default_render_target, merged_passes);
+		}
+
+		if (gpu_frame_timer)
+		{
+			gpu_frame_timer->end_pass(command_buffer.get_handle(), render_context->get_active_frame_index(), timed_pass);
+		}
 
-		if (pass.post_draw)
+		// Only the last merged pass may have a post-draw hook
+		auto &last_pass = *passes[current_pass_index + merged_passes.size()];
+		if (last_pass.post_draw)
 		{
 			ScopedDebugLabel marker{command_buffer, "Post-draw"};
 
-			pass.post_draw();
+			last_pass.post_draw();
 		}
+
+		current_pass_index += merged_passes.size();
 	}
 
 	current_pass_index = 0;
 }
 
+std::vector<PostProcessingRenderPass *> PostProcessingPipeline::get_merged_passes(const RenderTarget &default_render_target) const
+{
+	std::vector<PostProcessingRenderPass *> merged_passes;
+
+	auto *pass = dynamic_cast<PostProcessingRenderPass *>(passes[current_pass_index].get());
+	for (size_t i = current_pass_index + 1; pass && i < passes.size(); ++i)
+	{
+		auto *next = dynamic_cast<PostProcessingRenderPass *>(passes[i].get());
+		if (!next || !pass->can_merge_with(*next, default_render_target))
+		{
+			break;
+		}
+
+		merged_passes.push_back(next);
+		pass = next;
+	}
+
+	return merged_passes;
+}
+
 }        // namespace vkb
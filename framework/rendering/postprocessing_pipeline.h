@@ -48,6 +48,8 @@ class PostProcessingPipeline
 	 * @brief Runs all renderpasses in this pipeline, recording commands into the given command buffer.
 	 * @remarks vkb::PostProcessingRenderpass that do not explicitly have a vkb::RenderTarget set will render
 	 *          to default_render_target.
+	 *          Consecutive vkb::PostProcessingRenderPass that can be merged run as the subpasses of a single
+	 *          renderpass, see vkb::PostProcessingRenderPass::can_merge_with().
 	 */
 	void draw(CommandBuffer &command_buffer, RenderTarget &default_render_target);
 
@@ -96,6 +98,11 @@ class PostProcessingPipeline
 	}
 
   private:
+	/**
+	 * @brief Returns the render passes following the current pass that can run in its renderpass.
+	 */
+	std::vector<PostProcessingRenderPass *> get_merged_passes(const RenderTarget &default_render_target) const;
+
 	RenderContext *                                      render_context{nullptr};
 	ShaderSource                                         triangle_vs;
 	std::vector<std::unique_ptr<PostProcessingPassBase>> passes{};
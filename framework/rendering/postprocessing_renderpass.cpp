@@ -309,27 +309,6 @@ PostProcessingRenderPass::BarrierInfo PostProcessingRenderPass::get_dst_barrier_
 	return info;
 }
 
-// If the passed `src_access` is zero, guess it - and the corresponding source stage - from the src_access_mask
-// of the image
-static void ensure_src_access(uint32_t &src_access, uint32_t &src_stage, VkImageLayout layout)
-{
-	if (src_access == 0)
-	{
-		switch (layout)
-		{
-			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-				src_stage  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-				src_access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-				src_access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-				break;
-			default:
-				src_stage  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-				src_access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-				break;
-		}
-	}
-}
-
 void PostProcessingRenderPass::transition_attachments(
     const AttachmentSet        &input_attachments,
     const SampledAttachmentSet &sampled_attachments,
@@ -340,171 +319,166 @@ void PostProcessingRenderPass::transition_attachments(
 	auto       &render_target = this->render_target ? *this->render_target : fallback_render_target;
 	const auto &views         = render_target.get_views();
 
-	BarrierInfo fallback_barrier_src{};
-	fallback_barrier_src.pipeline_stage     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	fallback_barrier_src.image_read_access  = 0;        // For UNDEFINED -> COLOR_ATTACHMENT_OPTIMAL in first RP
-	fallback_barrier_src.image_write_access = 0;
-	auto prev_pass_barrier_info             = get_predecessor_src_barrier_info(fallback_barrier_src);
-
+	// The barriers are derived from the tracked states of the images, which hold the last writes of the previous
+	// passes, including the final layouts of their render passes, and are recorded at once when the pass begins
 	for (uint32_t input : input_attachments)
 	{
-		const VkImageLayout prev_layout = render_target.get_layout(input);
-		if (prev_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-		{
-			// No-op
-			continue;
-		}
-
-		ensure_src_access(prev_pass_barrier_info.image_write_access, prev_pass_barrier_info.pipeline_stage,
-		                  prev_layout);
-
-		vkb::ImageMemoryBarrier barrier;
-		barrier.old_layout      = render_target.get_layout(input);
-		barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		barrier.src_access_mask = prev_pass_barrier_info.image_write_access;
-		barrier.dst_access_mask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
-		barrier.src_stage_mask  = prev_pass_barrier_info.pipeline_stage;
-		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-
 		assert(input < views.size());
-		command_buffer.image_memory_barrier(views[input], barrier);
+		command_buffer.request_image_state(views[input], {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		                                                  VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+		                                                  VK_ACCESS_2_INPUT_ATTACHMENT_READ_BIT_KHR});
 		render_target.set_layout(input, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 	}
 
 	for (const auto &sampled : sampled_attachments)
 	{
-		auto *sampled_rt = sampled.first ? sampled.first : &render_target;
-
-		// unpack depth resolve flag and attachment
-		bool     is_depth_resolve = sampled.second & DEPTH_RESOLVE_BITMASK;
-		uint32_t attachment       = sampled.second & ATTACHMENT_BITMASK;
-
-		const auto prev_layout = sampled_rt->get_layout(attachment);
-
-		if (prev_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-		{
-			// No-op
-			continue;
-		}
-
-		if (prev_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-		{
-			// Synchronize with previous pass writes as barrier below might do image transition
-			prev_pass_barrier_info.pipeline_stage |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-			prev_pass_barrier_info.image_read_access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-			// The resolving depth occurs in the COLOR_ATTACHMENT_OUT stage, not in the EARLY\LATE_FRAGMENT_TESTS stage
-			// and the corresponding access mask is COLOR_ATTACHMENT_WRITE_BIT, not DEPTH_STENCIL_ATTACHMENT_WRITE_BIT.
-			if (is_depth_resolve)
-			{
-				prev_pass_barrier_info.pipeline_stage |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-				prev_pass_barrier_info.image_read_access |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			}
-		}
-		else
-		{
-			ensure_src_access(prev_pass_barrier_info.image_read_access, prev_pass_barrier_info.pipeline_stage,
-			                  prev_layout);
-		}
-
-		vkb::ImageMemoryBarrier barrier;
-		barrier.old_layout      = prev_layout;
-		barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		barrier.src_access_mask = prev_pass_barrier_info.image_read_access;
-		barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
-		barrier.src_stage_mask  = prev_pass_barrier_info.pipeline_stage;
-		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		auto    *sampled_rt = sampled.first ? sampled.first : &render_target;
+		uint32_t attachment = sampled.second & ATTACHMENT_BITMASK;
 
 		assert(attachment < sampled_rt->get_views().size());
-		command_buffer.image_memory_barrier(sampled_rt->get_views()[attachment], barrier);
+		command_buffer.request_image_state(sampled_rt->get_views()[attachment], {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		                                                                         VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+		                                                                         VK_ACCESS_2_SHADER_READ_BIT_KHR});
 		sampled_rt->set_layout(attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 	}
 
 	for (uint32_t output : output_attachments)
 	{
 		assert(output < views.size());
-		const VkFormat      attachment_format = views[output].get_format();
-		const bool          is_depth_stencil  = vkb::is_depth_format(attachment_format);
-		const VkImageLayout output_layout     = is_depth_stencil ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		if (render_target.get_layout(output) == output_layout)
-		{
-			// No-op
-			continue;
-		}
+		const VkFormat attachment_format = views[output].get_format();
+		const bool     is_depth_stencil  = vkb::is_depth_format(attachment_format);
 
-		vkb::ImageMemoryBarrier barrier;
-		barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;        // = don't care about previous contents
-		barrier.new_layout      = output_layout;
-		barrier.src_access_mask = 0;
+		core::ResourceState state;
 		if (is_depth_stencil)
 		{
-			barrier.dst_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			barrier.src_stage_mask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			barrier.dst_stage_mask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			state = {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			         VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR,
+			         VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT_KHR | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR};
 		}
 		else
 		{
-			barrier.dst_access_mask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			barrier.src_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			state = {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			         VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+			         VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR};
 		}
 
-		command_buffer.image_memory_barrier(views[output], barrier);
-		render_target.set_layout(output, output_layout);
+		// Transitioning an output discards its contents, it is only kept when already in the attachment layout
+		command_buffer.request_image_state(views[output], state, /*discard=*/true);
+		render_target.set_layout(output, state.layout);
 	}
 
 	// NOTE: Unused attachments might be carried over to other render passes,
 	//       so we don't want to transition them to UNDEFINED layout here
 }
 
-void PostProcessingRenderPass::prepare_draw(CommandBuffer &command_buffer, RenderTarget &fallback_render_target)
+bool PostProcessingRenderPass::reads_per_pixel_only(const RenderTarget &render_target)
 {
-	// Collect all input, output, and sampled-from attachments from all subpasses (steps)
-	AttachmentSet        input_attachments, output_attachments;
-	SampledAttachmentSet sampled_attachments;
-
 	for (auto &step_ptr : pipeline.get_subpasses())
 	{
 		auto &step = *dynamic_cast<PostProcessingSubpass *>(step_ptr.get());
 
-		for (auto &it : step.get_input_attachments())
+		if (!step.get_storage_images().empty())
 		{
-			input_attachments.insert(it.second);
+			return false;
 		}
 
 		for (auto &it : step.get_sampled_images())
 		{
-			if (const uint32_t *sampled_attachment = it.second.get_target_attachment())
+			// NOTE: if RT not set, default is the currently-active one
+			auto *sampled_rt = it.second.get_render_target();
+			if (it.second.get_target_attachment() && (!sampled_rt || sampled_rt == &render_target))
 			{
-				auto *image_rt                  = it.second.get_render_target();
-				auto  packed_sampled_attachment = *sampled_attachment;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool PostProcessingRenderPass::can_merge_with(PostProcessingRenderPass &next, const RenderTarget &default_render_target)
+{
+	const auto *target      = render_target ? render_target : &default_render_target;
+	const auto *next_target = next.render_target ? next.render_target : &default_render_target;
+
+	// Hooks may record commands which are not allowed within a renderpass
+	if (target != next_target || post_draw || next.pre_draw)
+	{
+		return false;
+	}
+
+	if (pipeline.get_subpasses().empty() || next.pipeline.get_subpasses().empty())
+	{
+		return false;
+	}
 
-				// pack sampled attachment
-				if (it.second.is_depth_resolve())
+	return reads_per_pixel_only(*target) && next.reads_per_pixel_only(*target);
+}
+
+void PostProcessingRenderPass::prepare_draw(CommandBuffer &command_buffer, RenderTarget &fallback_render_target, const std::vector<PostProcessingRenderPass *> &merged_passes)
+{
+	// Collect all input, output, and sampled-from attachments from all subpasses (steps)
+	AttachmentSet        input_attachments, output_attachments;
+	SampledAttachmentSet sampled_attachments;
+
+	std::vector<PostProcessingRenderPass *> run_passes{this};
+	run_passes.insert(run_passes.end(), merged_passes.begin(), merged_passes.end());
+
+	for (auto *pass : run_passes)
+	{
+		for (auto &step_ptr : pass->pipeline.get_subpasses())
+		{
+			auto &step = *dynamic_cast<PostProcessingSubpass *>(step_ptr.get());
+
+			for (auto &it : step.get_input_attachments())
+			{
+				input_attachments.insert(it.second);
+			}
+
+			for (auto &it : step.get_sampled_images())
+			{
+				if (const uint32_t *sampled_attachment = it.second.get_target_attachment())
 				{
-					packed_sampled_attachment |= DEPTH_RESOLVE_BITMASK;
+					auto *image_rt                  = it.second.get_render_target();
+					auto  packed_sampled_attachment = *sampled_attachment;
+
+					// pack sampled attachment
+					if (it.second.is_depth_resolve())
+					{
+						packed_sampled_attachment |= DEPTH_RESOLVE_BITMASK;
+					}
+
+					sampled_attachments.insert({image_rt, packed_sampled_attachment});
 				}
+			}
 
-				sampled_attachments.insert({image_rt, packed_sampled_attachment});
+			for (uint32_t it : step.get_output_attachments())
+			{
+				output_attachments.insert(it);
 			}
 		}
+	}
 
-		for (uint32_t it : step.get_output_attachments())
-		{
-			output_attachments.insert(it);
-		}
+	// The load/stores of a merged renderpass depend on the steps of the other passes, whose changes aren't tracked,
+	// and must be recomputed if this pass runs on its own again
+	if (!merged_passes.empty())
+	{
+		load_stores_dirty = true;
 	}
 
 	transition_attachments(input_attachments, sampled_attachments, output_attachments,
 	                       command_buffer, fallback_render_target);
 	update_load_stores(input_attachments, sampled_attachments, output_attachments,
 	                   fallback_render_target);
+
+	if (!merged_passes.empty())
+	{
+		load_stores_dirty = true;
+	}
 }
 
-void PostProcessingRenderPass::draw(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+void PostProcessingRenderPass::update_draw_state(RenderTarget &default_render_target)
 {
-	prepare_draw(command_buffer, default_render_target);
-
 	if (!uniform_data.empty())
 	{
 		// Allocate a buffer (using the buffer pool from the active frame to store uniform values) and bind it
@@ -515,6 +489,22 @@ void PostProcessingRenderPass::draw(CommandBuffer &command_buffer, RenderTarget
 
 	// Update render target for this draw
 	draw_render_target = render_target ? render_target : &default_render_target;
+}
+
+void PostProcessingRenderPass::draw(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	draw(command_buffer, default_render_target, {});
+}
+
+void PostProcessingRenderPass::draw(CommandBuffer &command_buffer, RenderTarget &default_render_target, const std::vector<PostProcessingRenderPass *> &merged_passes)
+{
+	prepare_draw(command_buffer, default_render_target, merged_passes);
+
+	update_draw_state(default_render_target);
+	for (auto *pass : merged_passes)
+	{
+		pass->update_draw_state(default_render_target);
+	}
 
 	// Set appropriate viewport & scissor for this RT
 	{
@@ -532,14 +522,35 @@ void PostProcessingRenderPass::draw(CommandBuffer &command_buffer, RenderTarget
 		command_buffer.set_scissor(0, {scissor});
 	}
 
+	// The steps of the merged passes are borrowed for the draw, so they follow the steps of this pass
+	auto        &subpasses     = pipeline.get_subpasses();
+	const size_t own_subpasses = subpasses.size();
+	for (auto *pass : merged_passes)
+	{
+		for (auto &step : pass->pipeline.get_subpasses())
+		{
+			subpasses.push_back(std::move(step));
+		}
+	}
+
 	// Finally draw all subpasses
 	pipeline.draw(command_buffer, *draw_render_target);
 
-	if (parent->get_current_pass_index() < (parent->get_passes().size() - 1))
+	auto borrowed = subpasses.begin() + own_subpasses;
+	for (auto *pass : merged_passes)
+	{
+		for (auto &step : pass->pipeline.get_subpasses())
+		{
+			step = std::move(*borrowed++);
+		}
+	}
+	subpasses.erase(subpasses.begin() + own_subpasses, subpasses.end());
+
+	if (parent->get_current_pass_index() + merged_passes.size() < (parent->get_passes().size() - 1))
 	{
 		// Leave the last renderpass open for user modification (e.g., drawing GUI)
 		command_buffer.end_render_pass();
 	}
 }
 
-}        // namespace vkb
\ No newline at end of file
+}        // namespace vkb
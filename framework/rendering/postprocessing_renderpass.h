@@ -231,6 +231,19 @@ class PostProcessingRenderPass : public PostProcessingPass<PostProcessingRenderP
 
 	void draw(CommandBuffer &command_buffer, RenderTarget &default_render_target) override;
 
+	/**
+	 * @brief Runs this pass and the steps of merged_passes as the subpasses of a single renderpass.
+	 * @remarks Every pass of merged_passes must be mergeable with its predecessor, see can_merge_with().
+	 */
+	void draw(CommandBuffer &command_buffer, RenderTarget &default_render_target, const std::vector<PostProcessingRenderPass *> &merged_passes);
+
+	/**
+	 * @brief Whether next can run as further subpasses of the renderpass of this pass, keeping its inputs on-tile.
+	 * @remarks Both passes must render to the same RenderTarget, without a hook between them, and
+	 *          only read its attachments per-pixel, as input attachments.
+	 */
+	bool can_merge_with(PostProcessingRenderPass &next, const RenderTarget &default_render_target);
+
 	/**
 	 * @brief Gets the step at the given index.
 	 */
@@ -284,6 +297,12 @@ class PostProcessingRenderPass : public PostProcessingPass<PostProcessingRenderP
 	// An attachment sampled from a rendertarget
 	using SampledAttachmentSet = std::unordered_set<std::pair<RenderTarget *, uint32_t>, PairHasher>;
 
+	/**
+	 * @brief Whether the steps only read the attachments of render_target as input attachments,
+	 *        neither sampling them nor accessing storage images.
+	 */
+	bool reads_per_pixel_only(const RenderTarget &render_target);
+
 	/**
 	 * @brief Transition input, sampled and output attachments as appropriate.
 	 * @remarks If a RenderTarget is not explicitly set for this pass, fallback_render_target is used.
@@ -307,8 +326,14 @@ class PostProcessingRenderPass : public PostProcessingPass<PostProcessingRenderP
 
 	/**
 	 * @brief Transition images and prepare load/stores before draw()ing.
+	 * @remarks The steps of merged_passes are accounted for, as they run in the same renderpass.
+	 */
+	void prepare_draw(CommandBuffer &command_buffer, RenderTarget &fallback_render_target, const std::vector<PostProcessingRenderPass *> &merged_passes);
+
+	/**
+	 * @brief Uploads the uniform data and selects the render target the steps draw to.
 	 */
-	void prepare_draw(CommandBuffer &command_buffer, RenderTarget &fallback_render_target);
+	void update_draw_state(RenderTarget &default_render_target);
 
 	BarrierInfo get_src_barrier_info() const override;
 	BarrierInfo get_dst_barrier_info() const override;
@@ -0,0 +1,317 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "postprocessing_temporalpass.h"
+
+#include <cmath>
+
+#include "postprocessing_pipeline.h"
+#include "scene_graph/components/perspective_camera.h"
+
+namespace vkb
+{
+namespace
+{
+/**
+ * @brief Push constants of the temporal resolve shader
+ */
+struct TemporalUniform
+{
+	glm::ivec2 input_size;
+	glm::ivec2 output_size;
+	glm::vec2  jitter;
+	float      blend_factor;
+	uint32_t   history_valid;
+};
+
+/// Width and height of the output texels covered by a workgroup
+constexpr uint32_t TileSize = 8;
+
+/// The history is read and written as storage images, with room for HDR colors
+constexpr VkFormat HistoryFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+/// Phases of the jitter without upscaling, each output texel is sampled at as many positions
+constexpr uint32_t BasePhaseCount = 8;
+
+/**
+ * @return The element of the Halton sequence of the given base, in [0, 1)
+ */
+float halton(uint32_t index, uint32_t base)
+{
+	float result   = 0.0f;
+	float fraction = 1.0f;
+
+	for (; index > 0; index /= base)
+	{
+		fraction /= static_cast<float>(base);
+		result += fraction * static_cast<float>(index % base);
+	}
+
+	return result;
+}
+
+VkExtent2D get_extent(const core::ImageView &view)
+{
+	const uint32_t level        = view.get_subresource_range().baseMipLevel;
+	const auto    &image_extent = view.get_image().get_extent();
+	return {std::max(1u, image_extent.width >> level), std::max(1u, image_extent.height >> level)};
+}
+
+VkSamplerCreateInfo get_sampler_info(VkFilter filter)
+{
+	VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+	sampler_info.minFilter    = filter;
+	sampler_info.magFilter    = filter;
+	sampler_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.maxLod       = VK_LOD_CLAMP_NONE;
+	sampler_info.borderColor  = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	return sampler_info;
+}
+}        // namespace
+
+PostProcessingTemporalPass::PostProcessingTemporalPass(PostProcessingPipeline *parent, core::SampledImage &&color, core::SampledImage &&motion, core::SampledImage &&depth) :
+    PostProcessingPass{parent},
+    color{std::move(color)},
+    motion{std::move(motion)},
+    depth{std::move(depth)}
+{
+	auto &device = get_render_context().get_device();
+
+	if (!(device.get_gpu().get_format_properties(HistoryFormat).optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+	{
+		throw std::runtime_error("The history of the temporal pass can't be filtered");
+	}
+
+	point_sampler  = &device.get_resource_cache().RequestSampler(get_sampler_info(VK_FILTER_NEAREST));
+	linear_sampler = &device.get_resource_cache().RequestSampler(get_sampler_info(VK_FILTER_LINEAR));
+}
+
+PostProcessingTemporalPass &PostProcessingTemporalPass::set_sources(core::SampledImage &&new_color, core::SampledImage &&new_motion, core::SampledImage &&new_depth)
+{
+	color  = std::move(new_color);
+	motion = std::move(new_motion);
+	depth  = std::move(new_depth);
+
+	return *this;
+}
+
+PostProcessingTemporalPass &PostProcessingTemporalPass::set_blend_factor(float new_blend_factor)
+{
+	assert(new_blend_factor > 0.0f && new_blend_factor <= 1.0f);
+	blend_factor = new_blend_factor;
+
+	return *this;
+}
+
+PostProcessingTemporalPass &PostProcessingTemporalPass::jitter_camera(sg::PerspectiveCamera &camera, const VkExtent2D &render_extent)
+{
+	// Upscaling spreads the samples of an input texel over several output texels, which take as many more phases to cover
+	uint32_t phase_count = BasePhaseCount;
+	if (output_extent.width > render_extent.width)
+	{
+		float ratio = static_cast<float>(output_extent.width) / static_cast<float>(render_extent.width);
+		phase_count = static_cast<uint32_t>(std::ceil(BasePhaseCount * ratio * ratio));
+	}
+
+	jitter_index = (jitter_index + 1) % phase_count;
+
+	// Skips the first element of the sequence, which is 0 in every base
+	jitter = glm::vec2(halton(jitter_index + 1, 2), halton(jitter_index + 1, 3)) - 0.5f;
+
+	camera.set_jitter(2.0f * jitter / glm::vec2(render_extent.width, render_extent.height));
+
+	return *this;
+}
+
+PostProcessingTemporalPass &PostProcessingTemporalPass::reset_history()
+{
+	history_valid = false;
+
+	return *this;
+}
+
+void PostProcessingTemporalPass::prepare(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	// Build the compute shader upfront
+	auto &resource_cache = get_render_context().get_device().get_resource_cache();
+	resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, cs_source, cs_variant);
+}
+
+void PostProcessingTemporalPass::create_history(const VkExtent2D &extent)
+{
+	auto &device = get_render_context().get_device();
+
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		history_views[i].reset();
+		history_images[i] = std::make_unique<core::Image>(device, core::ImageBuilder(VkExtent3D{extent.width, extent.height, 1})
+		                                                              .with_format(HistoryFormat)
+		                                                              .with_usage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+		                                                              .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY)
+		                                                              .with_debug_name("Temporal pass: history"));
+		history_views[i] = std::make_unique<core::ImageView>(*history_images[i], VK_IMAGE_VIEW_TYPE_2D, HistoryFormat);
+	}
+
+	output_extent = extent;
+	history_valid = false;
+}
+
+void PostProcessingTemporalPass::transition_input(CommandBuffer &command_buffer, RenderTarget &default_render_target, const core::SampledImage &input)
+{
+	const uint32_t *attachment = input.get_target_attachment();
+	if (attachment == nullptr)
+	{
+		return;
+	}
+
+	auto &input_rt = input.get_render_target(default_render_target);
+	if (input_rt.get_layout(*attachment) == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+	{
+		// No-op
+		return;
+	}
+
+	BarrierInfo fallback_barrier_src{};
+	fallback_barrier_src.pipeline_stage     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	fallback_barrier_src.image_read_access  = 0;
+	fallback_barrier_src.image_write_access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	auto prev_pass_barrier_info             = get_predecessor_src_barrier_info(fallback_barrier_src);
+
+	vkb::ImageMemoryBarrier barrier;
+	barrier.old_layout      = input_rt.get_layout(*attachment);
+	barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.src_access_mask = prev_pass_barrier_info.image_write_access;
+	barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.src_stage_mask  = prev_pass_barrier_info.pipeline_stage;
+	barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	if (barrier.old_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+	{
+		barrier.src_stage_mask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		barrier.src_access_mask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	}
+
+	assert(*attachment < input_rt.get_views().size());
+	command_buffer.image_memory_barrier(input_rt.get_views()[*attachment], barrier);
+	input_rt.set_layout(*attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void PostProcessingTemporalPass::draw(CommandBuffer &command_buffer, RenderTarget &default_render_target)
+{
+	transition_input(command_buffer, default_render_target, color);
+	transition_input(command_buffer, default_render_target, motion);
+	transition_input(command_buffer, default_render_target, depth);
+
+	const auto &color_view  = color.get_image_view(default_render_target);
+	const auto &motion_view = motion.get_image_view(default_render_target);
+	const auto &depth_view  = depth.get_image_view(default_render_target);
+
+	const auto input_extent = get_extent(color_view);
+
+	const auto &extent = default_render_target.get_extent();
+	if (!history_images[0] || output_extent.width != extent.width || output_extent.height != extent.height)
+	{
+		create_history(extent);
+	}
+
+	// The output of the previous frame is read, the other image is written again
+	const uint32_t previous_index = history_index;
+	history_index                 = 1 - history_index;
+
+	auto &history_view = *history_views[previous_index];
+	auto &output_view  = *history_views[history_index];
+
+	if (!history_valid)
+	{
+		// The history is bound even if it isn't read, its contents are discarded
+		vkb::ImageMemoryBarrier history_barrier;
+		history_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+		history_barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		history_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		history_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		history_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+		command_buffer.image_memory_barrier(history_view, history_barrier);
+	}
+
+	// The output read by the passes of the previous frame is written again
+	vkb::ImageMemoryBarrier reuse_barrier;
+	reuse_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+	reuse_barrier.new_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	reuse_barrier.src_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+	reuse_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	reuse_barrier.dst_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.image_memory_barrier(output_view, reuse_barrier);
+
+	// Get compute shader from cache
+	auto &resource_cache = command_buffer.get_device().get_resource_cache();
+	auto &shader_module  = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, cs_source, cs_variant);
+
+	// Create pipeline layout and bind it
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.bind_image(color_view, *point_sampler, 0, 0, 0);
+	command_buffer.bind_image(motion_view, *point_sampler, 0, 1, 0);
+	command_buffer.bind_image(depth_view, *point_sampler, 0, 2, 0);
+	command_buffer.bind_image(history_view, *linear_sampler, 0, 3, 0);
+	command_buffer.bind_image(output_view, 0, 4, 0);
+
+	TemporalUniform uniform{};
+	uniform.input_size    = glm::ivec2(input_extent.width, input_extent.height);
+	uniform.output_size   = glm::ivec2(extent.width, extent.height);
+	uniform.jitter        = jitter;
+	uniform.blend_factor  = blend_factor;
+	uniform.history_valid = history_valid ? 1 : 0;
+	command_buffer.push_constants(uniform);
+
+	command_buffer.dispatch((extent.width + TileSize - 1) / TileSize, (extent.height + TileSize - 1) / TileSize, 1);
+
+	// The output is sampled by the following passes, and by the next frame as its history
+	vkb::ImageMemoryBarrier read_barrier;
+	read_barrier.old_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	read_barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	read_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	read_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	read_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	read_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	command_buffer.image_memory_barrier(output_view, read_barrier);
+
+	history_valid = true;
+}
+
+PostProcessingTemporalPass::BarrierInfo PostProcessingTemporalPass::get_src_barrier_info() const
+{
+	BarrierInfo info{};
+	info.pipeline_stage     = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	info.image_read_access  = VK_ACCESS_SHADER_READ_BIT;
+	info.image_write_access = 0;
+	return info;
+}
+
+PostProcessingTemporalPass::BarrierInfo PostProcessingTemporalPass::get_dst_barrier_info() const
+{
+	BarrierInfo info{};
+	info.pipeline_stage     = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	info.image_read_access  = VK_ACCESS_SHADER_READ_BIT;
+	info.image_write_access = 0;
+	return info;
+}
+
+}        // namespace vkb
@@ -0,0 +1,156 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "common/glm_common.h"
+#include "core/sampled_image.h"
+#include "postprocessing_pass.h"
+
+namespace vkb
+{
+namespace sg
+{
+class PerspectiveCamera;
+}
+
+/**
+ * @brief A compute pass in a vkb::PostProcessingPipeline accumulating jittered frames into an anti-aliased, possibly upscaled image.
+ *
+ * Every frame, jitter_camera() offsets the projection of the camera by the next point of a Halton (2, 3) sequence within a
+ * pixel, so that the frames sample the scene at different positions. The pass then reconstructs each output texel from the
+ * 3x3 nearest texels of the jittered color, weighted by their distance to its center, and blends it with the history: the
+ * output of the previous frame, fetched where the motion of the texel points to. The history is clamped to the color
+ * range of the neighborhood first, which rejects the samples of surfaces disoccluded or changed since, and dropped where the
+ * motion leaves the screen.
+ *
+ * The output has the extent of the render target passed to draw(), so rendering the scene at 50-70% of it and letting
+ * this pass upscale it saves most of the shading, the phases of the jitter growing with the ratio so that every output
+ * texel is covered. The motion comes from a GeometrySubpass with motion vectors enabled, and the depth selects the motion of
+ * the nearest surface around each texel so that the edges of moving objects are not left behind.
+ */
+class PostProcessingTemporalPass : public PostProcessingPass<PostProcessingTemporalPass>
+{
+  public:
+	/**
+	 * @param parent The pipeline the pass belongs to
+	 * @param color The jittered color of the scene, a RenderTarget attachment or a user-created image
+	 * @param motion The motion written by GeometrySubpass::enable_motion_vectors(), at the extent of the color
+	 * @param depth The depth of the scene, at the extent of the color
+	 */
+	PostProcessingTemporalPass(PostProcessingPipeline *parent, core::SampledImage &&color, core::SampledImage &&motion, core::SampledImage &&depth);
+
+	PostProcessingTemporalPass(const PostProcessingTemporalPass &to_copy)            = delete;
+	PostProcessingTemporalPass &operator=(const PostProcessingTemporalPass &to_copy) = delete;
+
+	PostProcessingTemporalPass(PostProcessingTemporalPass &&to_move)            = default;
+	PostProcessingTemporalPass &operator=(PostProcessingTemporalPass &&to_move) = default;
+
+	void prepare(CommandBuffer &command_buffer, RenderTarget &default_render_target) override;
+	void draw(CommandBuffer &command_buffer, RenderTarget &default_render_target) override;
+
+	/**
+	 * @brief Changes the images read by this pass.
+	 * @remarks Images from RenderTarget attachments are automatically transitioned to SHADER_READ_ONLY_OPTIMAL layout if needed.
+	 *          If no RenderTarget is specifically set, the one passed to draw() is used.
+	 */
+	PostProcessingTemporalPass &set_sources(core::SampledImage &&new_color, core::SampledImage &&new_motion, core::SampledImage &&new_depth);
+
+	/**
+	 * @brief Sets the weight of the current frame in the output, 0.1 by default
+	 *        Lower weights are smoother but take longer to converge after a change.
+	 */
+	PostProcessingTemporalPass &set_blend_factor(float blend_factor);
+
+	/**
+	 * @brief Offsets the camera by the jitter of the next frame, to be called before the scene is drawn
+	 * @param camera The camera drawing the color read by this pass
+	 * @param render_extent The extent of the color
+	 */
+	PostProcessingTemporalPass &jitter_camera(sg::PerspectiveCamera &camera, const VkExtent2D &render_extent);
+
+	/**
+	 * @brief Drops the history, e.g. after a camera cut, the next frame starts from its own color
+	 */
+	PostProcessingTemporalPass &reset_history();
+
+	/**
+	 * @brief Returns the jitter of the current frame, in texels of the color
+	 */
+	inline const glm::vec2 &get_jitter() const
+	{
+		return jitter;
+	}
+
+	/**
+	 * @brief Returns a view of the output of the last draw(), which is also the history of the next one.
+	 * @remarks The output is left in SHADER_READ_ONLY_OPTIMAL layout after draw().
+	 */
+	inline const core::ImageView &get_output_view() const
+	{
+		assert(history_views[history_index] && "The output is created by the first draw");
+		return *history_views[history_index];
+	}
+
+  private:
+	/**
+	 * @brief Transitions an input to SHADER_READ_ONLY_OPTIMAL if it is a RenderTarget attachment.
+	 */
+	void transition_input(CommandBuffer &command_buffer, RenderTarget &default_render_target, const core::SampledImage &input);
+
+	/**
+	 * @brief Creates the history images at the extent of the output, the history is dropped.
+	 */
+	void create_history(const VkExtent2D &extent);
+
+	BarrierInfo get_src_barrier_info() const override;
+	BarrierInfo get_dst_barrier_info() const override;
+
+	ShaderSource  cs_source{"postprocessing/temporal_resolve.comp"};
+	ShaderVariant cs_variant{};
+
+	core::SampledImage color;
+	core::SampledImage motion;
+	core::SampledImage depth;
+
+	float blend_factor{0.1f};
+
+	/// Index of the jitter in the Halton sequence
+	uint32_t jitter_index{0};
+
+	glm::vec2 jitter{0.0f};
+
+	/// Fetches the inputs without filtering, owned by the resource cache
+	const core::Sampler *point_sampler{nullptr};
+
+	/// Filters the history at the positions the motion points to, owned by the resource cache
+	const core::Sampler *linear_sampler{nullptr};
+
+	/// The output of the previous frame and the output of this one, swapped every draw()
+	std::unique_ptr<core::Image> history_images[2]{};
+
+	std::unique_ptr<core::ImageView> history_views[2]{};
+
+	uint32_t history_index{0};
+
+	VkExtent2D output_extent{0, 0};
+
+	/// Whether the history holds the output of the previous frame
+	bool history_valid{false};
+};
+
+}        // namespace vkb
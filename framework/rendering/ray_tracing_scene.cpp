@@ -0,0 +1,298 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/ray_tracing_scene.h"
+
+#include <algorithm>
+
+#include "common/helpers.h"
+#include "core/acceleration_structure_builder.h"
+#include "core/command_buffer.h"
+#include "core/device.h"
+#include "core/util/profiling.hpp"
+#include "rendering/skinning_pass.h"
+#include "scene_graph/components/material.h"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/sub_mesh.h"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+namespace
+{
+VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+}        // namespace
+
+RayTracingScene::RayTracingScene(Device &device, sg::Scene &scene, uint32_t frames_in_flight, const SkinningPass *skinning_pass) :
+    device{device},
+    skinning_pass{skinning_pass}
+{
+	VkPhysicalDeviceAccelerationStructurePropertiesKHR acceleration_structure_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR};
+	VkPhysicalDeviceProperties2KHR                     properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &acceleration_structure_properties;
+	vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+	scratch_alignment = std::max<VkDeviceSize>(acceleration_structure_properties.minAccelerationStructureScratchOffsetAlignment, 1);
+
+	VkTransformMatrixKHR identity{{{1.0f, 0.0f, 0.0f, 0.0f},
+	                               {0.0f, 1.0f, 0.0f, 0.0f},
+	                               {0.0f, 0.0f, 1.0f, 0.0f}}};
+
+	transform_buffer = vkb::core::BufferBuilderC(sizeof(identity))
+	                       .with_usage(BufferUsage)
+	                       .with_vma_usage(VMA_MEMORY_USAGE_CPU_TO_GPU)
+	                       .build_unique(device);
+	transform_buffer->set_debug_name("Ray tracing scene: identity transform");
+	transform_buffer->convert_and_update(identity);
+
+	// The structures are built beside the queue rendering the frames if another queue of its family can, since the
+	// geometry buffers aren't shared with the other families
+	const Queue &graphics_queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0);
+	const Queue &compute_queue  = device.get_async_compute_queue();
+
+	core::AccelerationStructureBuilder builder{device, compute_queue.get_family_index() == graphics_queue.get_family_index() ? compute_queue : graphics_queue};
+
+	auto meshes = scene.get_components<sg::Mesh>();
+	for (auto mesh : meshes)
+	{
+		for (auto sub_mesh : mesh->get_submeshes())
+		{
+			if (sub_mesh_indices.count(sub_mesh))
+			{
+				continue;
+			}
+
+			sg::VertexAttribute position;
+			auto                vertex_buffer = sub_mesh->vertex_buffers.find("position");
+			if (!sub_mesh->index_buffer || vertex_buffer == sub_mesh->vertex_buffers.end() || !sub_mesh->get_attribute("position", position))
+			{
+				LOGW("Sub mesh '{}' has no indexed positions, it is not ray traced", sub_mesh->get_name());
+				continue;
+			}
+
+			// The structures can't rebuild positions packed in the bounds of their sub mesh
+			if (position.format == VK_FORMAT_R16G16B16A16_UNORM)
+			{
+				LOGW("Sub mesh '{}' has packed positions, it is not ray traced", sub_mesh->get_name());
+				continue;
+			}
+
+			// Masked and blended surfaces let the any-hit shaders and the ray queries discard their hits
+			auto               material = sub_mesh->get_material();
+			VkGeometryFlagsKHR flags    = !material || material->alpha_mode == sg::AlphaMode::Opaque ? VK_GEOMETRY_OPAQUE_BIT_KHR : 0;
+
+			auto structure = std::make_unique<core::AccelerationStructure>(device, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR);
+			auto geometry  = structure->add_triangle_geometry(vertex_buffer->second,
+			                                                  *sub_mesh->index_buffer,
+			                                                  *transform_buffer,
+			                                                  sub_mesh->vertex_indices / 3,
+			                                                  sub_mesh->vertices_count - 1,
+			                                                  position.stride,
+			                                                  0,
+			                                                  position.format,
+			                                                  sub_mesh->index_type,
+			                                                  flags,
+			                                                  vertex_buffer->second.get_device_address() + position.offset,
+			                                                  sub_mesh->index_buffer->get_device_address() + sub_mesh->index_offset);
+
+			// The skinned structures are built from the bind pose, which their refits start from, and aren't compacted
+			if (skinning_pass && skinning_pass->is_skinned(*sub_mesh))
+			{
+				builder.add(*structure, SkinnedBuildFlags, false);
+				skinned_structures.push_back({sub_mesh, to_u32(bottom_level_structures.size()), geometry});
+			}
+			else
+			{
+				builder.add(*structure);
+			}
+
+			sub_mesh_indices.emplace(sub_mesh, to_u32(bottom_level_structures.size()));
+			bottom_level_structures.push_back(std::move(structure));
+		}
+	}
+
+	// The instances reference the device addresses of the bottom-level structures once compacted
+	builder.submit();
+	builder.wait();
+
+	auto &stats = builder.get_stats();
+	LOGI("Built {} bottom-level acceleration structures, compacted from {} to {} bytes", stats.structure_count, stats.build_size, stats.compacted_size);
+
+	for (auto mesh : meshes)
+	{
+		for (auto node : mesh->get_nodes())
+		{
+			for (auto sub_mesh : mesh->get_submeshes())
+			{
+				auto it = sub_mesh_indices.find(sub_mesh);
+				if (it != sub_mesh_indices.end())
+				{
+					instances.push_back({node, sub_mesh, it->second});
+				}
+			}
+		}
+	}
+
+	instance_data.resize(instances.size());
+	updated_versions.resize(instances.size());
+
+	top_level_structure = std::make_unique<core::DynamicTopLevelAccelerationStructure>(device, frames_in_flight);
+}
+
+bool RayTracingScene::update(CommandBuffer &command_buffer, uint32_t frame_index)
+{
+	PROFILE_SCOPE("Update ray tracing scene");
+
+	bool refitted = refit_skinned_structures(command_buffer);
+
+	updated_count = 0;
+
+	for (size_t i = 0; i < instances.size(); ++i)
+	{
+		auto version = instances[i].node->get_transform().get_world_matrix_version();
+		if (!initial_update && version == updated_versions[i])
+		{
+			continue;
+		}
+
+		updated_versions[i] = version;
+		instance_data[i]    = get_instance_data(instances[i]);
+		++updated_count;
+	}
+
+	// The top-level structure is refitted around the bottom-level ones which changed
+	if (!initial_update && updated_count == 0 && !refitted)
+	{
+		return false;
+	}
+
+	initial_update = false;
+
+	ScopedDebugLabel debug_label{command_buffer, "Update ray tracing scene"};
+
+	return top_level_structure->update(command_buffer.get_handle(), frame_index, instance_data);
+}
+
+bool RayTracingScene::refit_skinned_structures(CommandBuffer &command_buffer)
+{
+	if (!skinning_pass || skinned_structures.empty() || skinning_pass->get_skinned_version() == refitted_version)
+	{
+		return false;
+	}
+
+	refitted_version = skinning_pass->get_skinned_version();
+
+	auto output_address = skinning_pass->get_output_buffer().get_device_address();
+
+	// Each refit has its own range of the scratch memory, so they are recorded without barriers between them
+	std::vector<VkDeviceSize> scratch_offsets(skinned_structures.size());
+	VkDeviceSize              scratch_size = 0;
+	for (size_t i = 0; i < skinned_structures.size(); ++i)
+	{
+		auto &skinned   = skinned_structures[i];
+		auto &structure = *bottom_level_structures[skinned.sub_mesh_index];
+
+		structure.set_triangle_vertices(skinned.geometry, output_address + skinning_pass->get_position_offset(*skinned.sub_mesh), SkinningPass::OutputStride);
+
+		scratch_offsets[i] = scratch_size;
+		scratch_size += align_up(structure.prepare_build(SkinnedBuildFlags, VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR), scratch_alignment);
+	}
+
+	if (!refit_scratch_buffer || refit_scratch_buffer->get_size() < scratch_size + scratch_alignment)
+	{
+		if (refit_scratch_buffer)
+		{
+			device.get_deferred_destruction_queue().retire(std::move(refit_scratch_buffer));
+		}
+		refit_scratch_buffer = std::make_unique<vkb::core::BufferC>(device,
+		                                                            scratch_size + scratch_alignment,
+		                                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+		                                                            VMA_MEMORY_USAGE_GPU_ONLY);
+		refit_scratch_buffer->set_debug_name("Ray tracing scene: refit scratch");
+	}
+	auto scratch_address = align_up(refit_scratch_buffer->get_device_address(), scratch_alignment);
+
+	ScopedDebugLabel debug_label{command_buffer, "Refit skinned structures"};
+
+	// The structures and the scratch memory are written after the traces and the refits of the previous frames
+	VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+	barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	vkCmdPipelineBarrier(command_buffer.get_handle(),
+	                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+	                     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+	                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	// The update of the top-level structure waits on the refits with its own barrier
+	for (size_t i = 0; i < skinned_structures.size(); ++i)
+	{
+		bottom_level_structures[skinned_structures[i].sub_mesh_index]->record_build(command_buffer.get_handle(), scratch_address + scratch_offsets[i]);
+	}
+
+	return true;
+}
+
+VkAccelerationStructureKHR RayTracingScene::get_handle() const
+{
+	return top_level_structure->get_handle();
+}
+
+uint64_t RayTracingScene::get_device_address() const
+{
+	return top_level_structure->get_device_address();
+}
+
+uint32_t RayTracingScene::get_sub_mesh_index(const sg::SubMesh &sub_mesh) const
+{
+	return sub_mesh_indices.at(&sub_mesh);
+}
+
+size_t RayTracingScene::get_updated_count() const
+{
+	return updated_count;
+}
+
+VkAccelerationStructureInstanceKHR RayTracingScene::get_instance_data(const Instance &instance)
+{
+	auto world_matrix = instance.node->get_transform().get_world_matrix();
+
+	VkAccelerationStructureInstanceKHR data{};
+	for (uint32_t row = 0; row < 3; ++row)
+	{
+		for (uint32_t column = 0; column < 4; ++column)
+		{
+			data.transform.matrix[row][column] = world_matrix[column][row];
+		}
+	}
+	data.instanceCustomIndex                    = instance.sub_mesh_index;
+	data.mask                                   = 0xFF;
+	data.instanceShaderBindingTableRecordOffset = 0;
+
+	auto material = instance.sub_mesh->get_material();
+	if (material && material->double_sided)
+	{
+		data.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+	}
+
+	data.accelerationStructureReference = bottom_level_structures[instance.sub_mesh_index]->get_device_address();
+	return data;
+}
+}        // namespace vkb
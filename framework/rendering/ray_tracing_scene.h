@@ -0,0 +1,180 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/vk_common.h"
+#include "core/acceleration_structure.h"
+#include "core/buffer.h"
+#include "core/dynamic_top_level_acceleration_structure.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class Device;
+class SkinningPass;
+
+namespace sg
+{
+class Node;
+class Scene;
+class SubMesh;
+}        // namespace sg
+
+/**
+ * @brief Acceleration structures of the meshes of a scene, to trace rays against it
+ *
+ * A bottom-level structure is built for each sub mesh, reading its position attribute and its indices in place
+ * through their device addresses, so the geometry isn't uploaded again. The scene must be loaded with BufferUsage
+ * added to the usage of its buffers. The structures are built at once, then compacted.
+ *
+ * The top-level structure has an instance for each sub mesh of each mesh node, with the world matrix of the node.
+ * On update, the instances of the nodes whose transform was invalidated since the last update are rewritten, and
+ * the structure is refitted or rebuilt, see core::DynamicTopLevelAccelerationStructure. Nothing is recorded while
+ * no node moved.
+ *
+ * With a SkinningPass, the structures of the skinned sub meshes are built from their bind pose then refitted around
+ * the skinned vertices whenever the pass skinned them, reading its output in place.
+ *
+ * The custom index of an instance is get_sub_mesh_index() of its sub mesh. Shaders using ray queries can construct
+ * the accelerationStructureEXT from get_device_address(), passed in a uniform or a push constant, so the pipelines
+ * don't need a descriptor for it.
+ */
+class RayTracingScene
+{
+  public:
+	/// Usage the vertex and index buffers of the scene need, see GLTFLoader::read_scene_from_file
+	static constexpr VkBufferUsageFlags BufferUsage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	/**
+	 * @param device Device with VK_KHR_acceleration_structure enabled
+	 * @param scene Scene whose mesh nodes are instanced, the nodes can't change afterwards
+	 * @param frames_in_flight Number of frames which may be in flight
+	 * @param skinning_pass Optional skinning pass of the scene, must outlive the ray tracing scene
+	 */
+	RayTracingScene(Device &device, sg::Scene &scene, uint32_t frames_in_flight, const SkinningPass *skinning_pass = nullptr);
+
+	RayTracingScene(const RayTracingScene &) = delete;
+
+	RayTracingScene(RayTracingScene &&) = delete;
+
+	~RayTracingScene() = default;
+
+	RayTracingScene &operator=(const RayTracingScene &) = delete;
+
+	RayTracingScene &operator=(RayTracingScene &&) = delete;
+
+	/**
+	 * @brief Refits the structures of the skinned sub meshes if they were skinned again, writes the instances of the nodes
+	 *        which moved since the last update and records the update of the top-level structure
+	 *        The skinning pass must be updated first.
+	 *        Must be recorded outside of a render pass, before the commands tracing rays.
+	 * @param command_buffer Command buffer of the frame
+	 * @param frame_index Index of the frame in flight
+	 * @return Whether the handle of the top-level structure changed
+	 */
+	bool update(CommandBuffer &command_buffer, uint32_t frame_index);
+
+	/**
+	 * @return The top-level structure, null until the first update
+	 */
+	VkAccelerationStructureKHR get_handle() const;
+
+	uint64_t get_device_address() const;
+
+	/**
+	 * @return The index of the bottom-level structure of a sub mesh, which must be indexed and have positions
+	 */
+	uint32_t get_sub_mesh_index(const sg::SubMesh &sub_mesh) const;
+
+	/**
+	 * @return Number of instances written by the last update
+	 */
+	size_t get_updated_count() const;
+
+  private:
+	struct Instance
+	{
+		sg::Node *node;
+
+		const sg::SubMesh *sub_mesh;
+
+		uint32_t sub_mesh_index;
+	};
+
+	/// A bottom-level structure refitted around the skinned vertices of its sub mesh
+	struct SkinnedStructure
+	{
+		const sg::SubMesh *sub_mesh;
+
+		uint32_t sub_mesh_index;
+
+		uint64_t geometry;
+	};
+
+	/// Build flags of the skinned structures, which their refits must repeat
+	static constexpr VkBuildAccelerationStructureFlagsKHR SkinnedBuildFlags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+	                                                                          VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+
+	VkAccelerationStructureInstanceKHR get_instance_data(const Instance &instance);
+
+	/**
+	 * @brief Records the refits of the skinned structures if the skinning pass skinned the vertices since the last ones
+	 * @return Whether the structures were refitted
+	 */
+	bool refit_skinned_structures(CommandBuffer &command_buffer);
+
+	Device &device;
+
+	const SkinningPass *skinning_pass;
+
+	std::vector<SkinnedStructure> skinned_structures;
+
+	/// Skinned version of the skinning pass when the structures were last refitted
+	uint64_t refitted_version{0};
+
+	/// Scratch memory of the refits, shared by the frames as their refits are ordered by a barrier
+	std::unique_ptr<vkb::core::BufferC> refit_scratch_buffer;
+
+	VkDeviceSize scratch_alignment{1};
+
+	std::unordered_map<const sg::SubMesh *, uint32_t> sub_mesh_indices;
+
+	std::vector<std::unique_ptr<core::AccelerationStructure>> bottom_level_structures;
+
+	/// Identity transform of the geometries, their vertices are in the space of their node
+	std::unique_ptr<vkb::core::BufferC> transform_buffer;
+
+	std::vector<Instance> instances;
+
+	std::vector<VkAccelerationStructureInstanceKHR> instance_data;
+
+	/// Version of the world matrix of the node of each instance when it was last written
+	std::vector<uint32_t> updated_versions;
+
+	/// Whether the instances were never written
+	bool initial_update{true};
+
+	size_t updated_count{0};
+
+	std::unique_ptr<core::DynamicTopLevelAccelerationStructure> top_level_structure;
+};
+}        // namespace vkb
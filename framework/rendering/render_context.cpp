@@ -17,6 +17,9 @@
 
 #include "render_context.h"
 
+#include <limits>
+
+#include "core/util/profiling.hpp"
 #include "platform/window.h"
 
 namespace vkb
@@ -28,9 +31,21 @@ RenderContext::RenderContext(Device                                &device,
                              const Window                          &window,
                              VkPresentModeKHR                       present_mode,
                              const std::vector<VkPresentModeKHR>   &present_mode_priority_list,
-                             const std::vector<VkSurfaceFormatKHR> &surface_format_priority_list) :
-    device{device}, window{window}, queue{device.get_suitable_graphics_queue()}, surface_extent{window.get_extent().width, window.get_extent().height}
+                             const std::vector<VkSurfaceFormatKHR> &surface_format_priority_list,
+                             bool                                   pre_rotation) :
+    device{device}, window{window}, queue{device.get_suitable_graphics_queue()}, surface_extent{window.get_extent().width, window.get_extent().height}, pre_rotation{pre_rotation}
 {
+	auto synchronization2_features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceSynchronization2FeaturesKHR>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR);
+	synchronization2 = device.is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) && synchronization2_features && synchronization2_features->synchronization2;
+
+	auto swapchain_maintenance1_features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT);
+	swapchain_maintenance1 = device.is_enabled(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME) && swapchain_maintenance1_features &&
+	                         swapchain_maintenance1_features->swapchainMaintenance1;
+
+	frame_pacer = std::make_unique<FramePacer>(device);
+
 	if (surface != VK_NULL_HANDLE)
 	{
 		VkSurfaceCapabilitiesKHR surface_properties;
@@ -38,14 +53,70 @@ RenderContext::RenderContext(Device                                &device,
 		                                                   surface,
 		                                                   &surface_properties));
 
+		VkExtent2D                    extent{};
+		VkSurfaceTransformFlagBitsKHR transform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 		if (surface_properties.currentExtent.width == 0xFFFFFFFF)
 		{
-			swapchain = std::make_unique<Swapchain>(device, surface, present_mode, present_mode_priority_list, surface_format_priority_list, surface_extent);
+			extent = surface_extent;
 		}
-		else
+		else if (pre_rotation)
 		{
-			swapchain = std::make_unique<Swapchain>(device, surface, present_mode, present_mode_priority_list, surface_format_priority_list);
+			extent = surface_properties.currentExtent;
+			if (surface_properties.currentTransform & (VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR | VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR))
+			{
+				// Pre-rotation: always use native orientation i.e. if rotated, use width and height of identity transform
+				std::swap(extent.width, extent.height);
+			}
+			transform = surface_properties.currentTransform;
 		}
+
+		// The swapchain takes the ownership of the display if the window asked for the exclusive fullscreen mode
+		swapchain = std::make_unique<Swapchain>(device,
+		                                        surface,
+		                                        present_mode,
+		                                        present_mode_priority_list,
+		                                        surface_format_priority_list,
+		                                        extent,
+		                                        3,
+		                                        transform,
+		                                        std::set<VkImageUsageFlagBits>{VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT},
+		                                        VK_IMAGE_COMPRESSION_DEFAULT_EXT,
+		                                        VK_IMAGE_COMPRESSION_FIXED_RATE_NONE_EXT,
+		                                        window.get_full_screen_exclusive_monitor());
+
+		pre_transform = swapchain->get_transform();
+	}
+}
+
+RenderContext::~RenderContext()
+{
+	if (!queue_timelines.empty())
+	{
+		device.wait_idle();
+
+		// The retired objects can't be collected once the timelines are gone
+		device.get_deferred_destruction_queue().clear();
+
+		for (auto &timeline : queue_timelines)
+		{
+			vkDestroySemaphore(device.get_handle(), timeline.semaphore, nullptr);
+		}
+	}
+
+	// The presents aren't waited for by the device going idle
+	if (!present_fences.empty())
+	{
+		VK_CHECK(vkWaitForFences(device.get_handle(), to_u32(present_fences.size()), present_fences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max()));
+	}
+
+	for (auto fence : present_fences)
+	{
+		vkDestroyFence(device.get_handle(), fence, nullptr);
+	}
+
+	for (auto fence : free_present_fences)
+	{
+		vkDestroyFence(device.get_handle(), fence, nullptr);
 	}
 }
 
@@ -53,6 +124,9 @@ void RenderContext::prepare(size_t thread_count, RenderTarget::CreateFunc create
 {
 	device.wait_idle();
 
+	// Rings are sized to hold a full buffer pool block for each frame in flight
+	buffer_rings = std::make_shared<BufferRingSet>(device, swapchain ? to_u32(swapchain->get_images().size()) : OFFSCREEN_FRAME_COUNT);
+
 	if (swapchain)
 	{
 		surface_extent = swapchain->get_extent();
@@ -67,22 +141,25 @@ void RenderContext::prepare(size_t thread_count, RenderTarget::CreateFunc create
 			    swapchain->get_format(),
 			    swapchain->get_usage()};
 			auto render_target = create_render_target_func(std::move(swapchain_image));
-			frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count));
+			frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count, buffer_rings));
 		}
 	}
 	else
 	{
-		// Otherwise, create a single RenderFrame
+		// Otherwise, create the offscreen RenderFrames
 		swapchain = nullptr;
 
-		auto color_image = core::Image{device,
-		                               VkExtent3D{surface_extent.width, surface_extent.height, 1},
-		                               DEFAULT_VK_FORMAT,        // We can use any format here that we like
-		                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-		                               VMA_MEMORY_USAGE_GPU_ONLY};
-
-		auto render_target = create_render_target_func(std::move(color_image));
-		frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count));
+		for (uint32_t i = 0; i < OFFSCREEN_FRAME_COUNT; ++i)
+		{
+			auto color_image = core::Image{device,
+			                               VkExtent3D{surface_extent.width, surface_extent.height, 1},
+			                               DEFAULT_VK_FORMAT,        // We can use any format here that we like
+			                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			                               VMA_MEMORY_USAGE_GPU_ONLY};
+
+			auto render_target = create_render_target_func(std::move(color_image));
+			frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count, buffer_rings));
+		}
 	}
 
 	this->create_render_target_func = create_render_target_func;
@@ -112,7 +189,7 @@ void RenderContext::update_swapchain(const VkExtent2D &extent)
 
 	device.get_resource_cache().ClearFramebuffers();
 
-	swapchain = std::make_unique<Swapchain>(*swapchain, extent);
+	replace_swapchain(std::make_unique<Swapchain>(*swapchain, extent));
 
 	recreate();
 }
@@ -127,9 +204,22 @@ void RenderContext::update_swapchain(const uint32_t image_count)
 
 	device.get_resource_cache().ClearFramebuffers();
 
-	device.wait_idle();
+	replace_swapchain(std::make_unique<Swapchain>(*swapchain, image_count));
+
+	recreate();
+}
+
+void RenderContext::update_swapchain(const uint32_t image_count, const VkPresentModeKHR present_mode)
+{
+	if (!swapchain)
+	{
+		LOGW("Can't update the swapchains image count and present mode. No swapchain, offscreen rendering detected, skipping.");
+		return;
+	}
+
+	device.get_resource_cache().ClearFramebuffers();
 
-	swapchain = std::make_unique<Swapchain>(*swapchain, image_count);
+	replace_swapchain(std::make_unique<Swapchain>(*swapchain, image_count, present_mode));
 
 	recreate();
 }
@@ -144,7 +234,7 @@ void RenderContext::update_swapchain(const std::set<VkImageUsageFlagBits> &image
 
 	device.get_resource_cache().ClearFramebuffers();
 
-	swapchain = std::make_unique<Swapchain>(*swapchain, image_usage_flags);
+	replace_swapchain(std::make_unique<Swapchain>(*swapchain, image_usage_flags));
 
 	recreate();
 }
@@ -167,7 +257,7 @@ void RenderContext::update_swapchain(const VkExtent2D &extent, const VkSurfaceTr
 		std::swap(width, height);
 	}
 
-	swapchain = std::make_unique<Swapchain>(*swapchain, VkExtent2D{width, height}, transform);
+	replace_swapchain(std::make_unique<Swapchain>(*swapchain, VkExtent2D{width, height}, transform));
 
 	// Save the preTransform attribute for future rotations
 	pre_transform = transform;
@@ -185,40 +275,72 @@ void RenderContext::update_swapchain(const VkImageCompressionFlagsEXT compressio
 
 	device.get_resource_cache().ClearFramebuffers();
 
-	swapchain = std::make_unique<Swapchain>(*swapchain, compression, compression_fixed_rate);
+	replace_swapchain(std::make_unique<Swapchain>(*swapchain, compression, compression_fixed_rate));
 
 	recreate();
 }
 
-void RenderContext::recreate()
+void RenderContext::set_pre_rotation_enabled(bool enabled)
 {
-	LOGI("Recreated swapchain");
+	pre_rotation = enabled;
 
-	VkExtent2D swapchain_extent = swapchain->get_extent();
-	VkExtent3D extent{swapchain_extent.width, swapchain_extent.height, 1};
+	if (!swapchain)
+	{
+		LOGW("Can't update the swapchains surface transform. No swapchain, offscreen rendering detected, skipping.");
+		return;
+	}
+
+	VkSurfaceCapabilitiesKHR surface_properties;
+	VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device.get_gpu().get_handle(),
+	                                                   swapchain->get_surface(),
+	                                                   &surface_properties));
+
+	auto extent = surface_properties.currentExtent.width == 0xFFFFFFFF ? surface_extent : surface_properties.currentExtent;
+
+	update_swapchain(extent, enabled ? surface_properties.currentTransform : VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR);
+}
+
+bool RenderContext::is_pre_rotation_enabled() const
+{
+	return pre_rotation;
+}
+
+glm::mat4 RenderContext::get_pre_rotation() const
+{
+	if (!swapchain)
+	{
+		return glm::mat4(1.0f);
+	}
 
-	auto frame_it = frames.begin();
+	const glm::vec3 rotation_axis{0.0f, 0.0f, 1.0f};
 
-	for (auto &image_handle : swapchain->get_images())
+	auto transform = swapchain->get_transform();
+	if (transform & VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR)
 	{
-		core::Image swapchain_image{device, image_handle,
-		                            extent,
-		                            swapchain->get_format(),
-		                            swapchain->get_usage()};
+		return glm::rotate(glm::radians(90.0f), rotation_axis);
+	}
+	else if (transform & VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR)
+	{
+		return glm::rotate(glm::radians(270.0f), rotation_axis);
+	}
+	else if (transform & VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR)
+	{
+		return glm::rotate(glm::radians(180.0f), rotation_axis);
+	}
 
-		auto render_target = create_render_target_func(std::move(swapchain_image));
+	return glm::mat4(1.0f);
+}
 
-		if (frame_it != frames.end())
-		{
-			(*frame_it)->UpdateRenderTarget(std::move(render_target));
-		}
-		else
-		{
-			// Create a new frame if the new swapchain has more images than current frames
-			frames.emplace_back(std::make_unique<RenderFrame>(device, std::move(render_target), thread_count));
-		}
+void RenderContext::recreate()
+{
+	LOGI("Recreated swapchain");
 
-		++frame_it;
+	// The render targets of the current frames are recreated when they are used next, instead of all at once
+	while (frames.size() < swapchain->get_images().size())
+	{
+		// Create a new frame if the new swapchain has more images than current frames
+		frames.emplace_back(std::make_unique<RenderFrame>(device, create_swapchain_render_target(to_u32(frames.size())), thread_count, buffer_rings));
+		outdated_render_targets.push_back(false);
 	}
 
 	device.get_resource_cache().ClearFramebuffers();
@@ -242,17 +364,20 @@ bool RenderContext::handle_surface_changes(bool force_update)
 		return false;
 	}
 
-	// Only recreate the swapchain if the dimensions have changed;
+	// A pre-rotated swapchain follows the orientation of the display, which changes
+	// without a resize when it turns by 180 degrees
+	auto transform = pre_rotation ? surface_properties.currentTransform : pre_transform;
+
+	// Only recreate the swapchain if the dimensions or the orientation have changed;
 	// handle_surface_changes() is called on VK_SUBOPTIMAL_KHR,
 	// which might not be due to a surface resize
 	if (surface_properties.currentExtent.width != surface_extent.width ||
 	    surface_properties.currentExtent.height != surface_extent.height ||
+	    transform != pre_transform ||
 	    force_update)
 	{
-		// Recreate swapchain
-		device.wait_idle();
-
-		update_swapchain(surface_properties.currentExtent, pre_transform);
+		// Recreate swapchain, the resources in use by frames in flight are retired to the deferred destruction queue
+		update_swapchain(surface_properties.currentExtent, transform);
 
 		surface_extent = surface_properties.currentExtent;
 
@@ -291,27 +416,74 @@ void RenderContext::submit(const std::vector<CommandBuffer *> &command_buffers)
 
 	VkSemaphore render_semaphore = VK_NULL_HANDLE;
 
+	if (!gpu_frame_timer)
+	{
+		if (swapchain)
+		{
+			assert(acquired_semaphore && "We do not have acquired_semaphore, it was probably consumed?\n");
+			render_semaphore = submit(queue, command_buffers, acquired_semaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		}
+		else
+		{
+			submit(queue, command_buffers);
+		}
+
+		end_frame(render_semaphore);
+		return;
+	}
+
+	// The timestamps of the frame surround the command buffers of its last submission
+	SubmissionBuilder submission = begin_submission(queue);
+
 	if (swapchain)
 	{
 		assert(acquired_semaphore && "We do not have acquired_semaphore, it was probably consumed?\n");
-		render_semaphore = submit(queue, command_buffers, acquired_semaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		submission.wait(acquired_semaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
 	}
-	else
+
+	gpu_frame_timer->begin(submission, active_frame_index);
+	for (auto *command_buffer : command_buffers)
+	{
+		submission.add_command_buffer(command_buffer->get_handle());
+		redundant_command_count.fetch_add(command_buffer->get_redundant_command_count(), std::memory_order_relaxed);
+	}
+	gpu_frame_timer->end(submission, active_frame_index);
+
+	if (swapchain)
 	{
-		submit(queue, command_buffers);
+		render_semaphore = get_active_frame().RequestSemaphore();
+		submission.signal(render_semaphore);
 	}
 
+	submit(submission);
+
 	end_frame(render_semaphore);
 }
 
 void RenderContext::begin_frame()
 {
+	PROFILE_SCOPE("Begin Frame");
+
+	device.get_deferred_destruction_queue().collect();
+	device.get_resource_cache().Trim();
+
+	// A capture starts after the present of the previous frame, the labels of this one are recorded for it
+	DebugLabels::update();
+
 	// Only handle surface changes if a swapchain exists
 	if (swapchain)
 	{
 		handle_surface_changes();
 	}
 
+	if (swapchain_controller && swapchain_controller->begin_frame())
+	{
+		auto &configuration = swapchain_controller->get_configuration();
+		update_swapchain(configuration.image_count, configuration.present_mode);
+	}
+
+	frame_pacer->begin_render(swapchain ? swapchain->get_handle() : VK_NULL_HANDLE);
+
 	assert(!frame_active && "Frame is still active, please call end_frame");
 
 	assert(active_frame_index < frames.size());
@@ -321,9 +493,27 @@ void RenderContext::begin_frame()
 	// so we need to hold ownership.
 	acquired_semaphore = prev_frame.RequestSemaphoreWithOwnership();
 
+	if (alternate_frame_rendering)
+	{
+		active_device_index = (active_device_index + 1) % device.get_physical_device_count();
+	}
+
 	if (swapchain)
 	{
-		auto result = swapchain->acquire_next_image(active_frame_index, acquired_semaphore, VK_NULL_HANDLE);
+		// Direct-to-display windows start the frames on the vertical blanking with vsync,
+		// so each presented image is rendered from input sampled one refresh earlier at most
+		if (swapchain->get_present_mode() == VK_PRESENT_MODE_FIFO_KHR && device.is_enabled(VK_EXT_DISPLAY_CONTROL_EXTENSION_NAME))
+		{
+			window.wait_for_vblank(device.get_handle());
+		}
+
+		auto acquire_start = std::chrono::steady_clock::now();
+		auto result        = swapchain->acquire_next_image(active_frame_index, acquired_semaphore, VK_NULL_HANDLE, get_active_device_mask());
+
+		if (swapchain_controller)
+		{
+			swapchain_controller->record_acquire_wait(std::chrono::steady_clock::now() - acquire_start);
+		}
 
 		if (result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
@@ -340,80 +530,246 @@ void RenderContext::begin_frame()
 				// Need to destroy and reallocate acquired_semaphore since it may have already been signaled
 				vkDestroySemaphore(device.get_handle(), acquired_semaphore, nullptr);
 				acquired_semaphore = prev_frame.RequestSemaphoreWithOwnership();
-				result             = swapchain->acquire_next_image(active_frame_index, acquired_semaphore, VK_NULL_HANDLE);
+				result             = swapchain->acquire_next_image(active_frame_index, acquired_semaphore, VK_NULL_HANDLE, get_active_device_mask());
 			}
 		}
 
+		if (result == VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT)
+		{
+			// The frame is skipped, rendering resumes once the window owns the display again
+			swapchain->acquire_full_screen_exclusive();
+		}
+
 		if (result != VK_SUCCESS)
 		{
 			prev_frame.Reset();
 			return;
 		}
 	}
+	else
+	{
+		// The offscreen frames are rendered in turn, like the images of a swapchain
+		active_frame_index = (active_frame_index + 1) % to_u32(frames.size());
+	}
+
+	update_render_target(active_frame_index);
 
 	// Now the frame is active again
 	frame_active = true;
 
 	// Wait on all resource to be freed from the previous render to this frame
 	wait_frame();
+
+	if (gpu_frame_timer)
+	{
+		gpu_frame_timer->resolve(active_frame_index);
+	}
 }
 
 VkSemaphore RenderContext::submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers, VkSemaphore wait_semaphore, VkPipelineStageFlags wait_pipeline_stage)
 {
-	std::vector<VkCommandBuffer> cmd_buf_handles(command_buffers.size(), VK_NULL_HANDLE);
-	std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(), [](const CommandBuffer *cmd_buf) { return cmd_buf->get_handle(); });
+	SubmissionBuilder submission = begin_submission(queue);
+
+	if (wait_semaphore != VK_NULL_HANDLE)
+	{
+		submission.wait(wait_semaphore, wait_pipeline_stage);
+	}
+
+	for (auto *command_buffer : command_buffers)
+	{
+		submission.add_command_buffer(command_buffer->get_handle());
+		redundant_command_count.fetch_add(command_buffer->get_redundant_command_count(), std::memory_order_relaxed);
+	}
+
+	VkSemaphore signal_semaphore = get_active_frame().RequestSemaphore();
+	submission.signal(signal_semaphore);
+
+	submit(submission);
+
+	return signal_semaphore;
+}
+
+void RenderContext::submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers)
+{
+	SubmissionBuilder submission = begin_submission(queue);
+
+	for (auto *command_buffer : command_buffers)
+	{
+		submission.add_command_buffer(command_buffer->get_handle());
+		redundant_command_count.fetch_add(command_buffer->get_redundant_command_count(), std::memory_order_relaxed);
+	}
+
+	submit(submission);
+}
+
+SubmissionBuilder RenderContext::begin_submission(const Queue &queue) const
+{
+	SubmissionBuilder submission{queue.get_handle(), synchronization2};
+	submission.set_device_mask(get_active_device_mask());
+	return submission;
+}
+
+void RenderContext::submit(SubmissionBuilder &submission)
+{
+	PROFILE_SCOPE("Submit");
 
 	RenderFrame &frame = get_active_frame();
 
-	VkSemaphore signal_semaphore = frame.RequestSemaphore();
+	if (!timeline_semaphores)
+	{
+		VK_CHECK(submission.submit(frame.RequestFence()));
+		submit_count.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
 
-	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	// Signaled after the commands of all the batches, which were submitted before
+	const QueueTimeline &timeline = advance_timeline(submission.get_queue());
+	submission.signal(timeline.semaphore, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR, timeline.value);
 
-	submit_info.commandBufferCount = to_u32(cmd_buf_handles.size());
-	submit_info.pCommandBuffers    = cmd_buf_handles.data();
+	VK_CHECK(submission.submit());
+	submit_count.fetch_add(1, std::memory_order_relaxed);
 
-	if (wait_semaphore != VK_NULL_HANDLE)
+	frame.AddTimelineWait(timeline);
+	device.get_deferred_destruction_queue().track(timeline);
+}
+
+bool RenderContext::enable_timeline_semaphores()
+{
+	assert(!frame_active && "Timeline semaphores can't be enabled while a frame is active");
+
+	auto features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceTimelineSemaphoreFeaturesKHR>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR);
+	if (!device.is_enabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) || !features || !features->timelineSemaphore)
 	{
-		submit_info.waitSemaphoreCount = 1;
-		submit_info.pWaitSemaphores    = &wait_semaphore;
-		submit_info.pWaitDstStageMask  = &wait_pipeline_stage;
+		LOGW("Timeline semaphores need {} and its timelineSemaphore feature, frames are tracked with fences", VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		return false;
 	}
 
-	submit_info.signalSemaphoreCount = 1;
-	submit_info.pSignalSemaphores    = &signal_semaphore;
+	timeline_semaphores = true;
 
-	VkFence fence = frame.RequestFence();
+	return true;
+}
 
-	VK_CHECK(queue.submit({submit_info}, fence));
+bool RenderContext::uses_timeline_semaphores() const
+{
+	return timeline_semaphores;
+}
 
-	return signal_semaphore;
+void RenderContext::replace_swapchain(std::unique_ptr<Swapchain> &&new_swapchain)
+{
+	std::vector<std::unique_ptr<RenderTarget>> render_targets;
+	for (auto &frame : frames)
+	{
+		render_targets.push_back(frame->ReleaseRenderTarget());
+	}
+	outdated_render_targets.assign(frames.size(), true);
+
+	// The render targets are destroyed before the swapchain owning their images
+	auto retired = std::make_pair(std::move(swapchain), std::move(render_targets));
+
+	if (swapchain_maintenance1)
+	{
+		// The presents waited for the frames rendering to the swapchain, their fences cover all its uses
+		device.get_deferred_destruction_queue().retire(std::move(retired), std::move(present_fences));
+		present_fences.clear();
+	}
+	else
+	{
+		device.get_deferred_destruction_queue().retire(std::move(retired));
+	}
+
+	swapchain = std::move(new_swapchain);
 }
 
-void RenderContext::submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers)
+std::unique_ptr<RenderTarget> RenderContext::create_swapchain_render_target(uint32_t image_index)
 {
-	std::vector<VkCommandBuffer> cmd_buf_handles(command_buffers.size(), VK_NULL_HANDLE);
-	std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(), [](const CommandBuffer *cmd_buf) { return cmd_buf->get_handle(); });
+	VkExtent2D swapchain_extent = swapchain->get_extent();
 
-	RenderFrame &frame = get_active_frame();
+	core::Image swapchain_image{device, swapchain->get_images()[image_index],
+	                            VkExtent3D{swapchain_extent.width, swapchain_extent.height, 1},
+	                            swapchain->get_format(),
+	                            swapchain->get_usage()};
+
+	return create_render_target_func(std::move(swapchain_image));
+}
+
+void RenderContext::update_render_target(uint32_t frame_index)
+{
+	// Frames past the image count of the swapchain aren't rendered to anymore
+	if (swapchain && frame_index < outdated_render_targets.size() && outdated_render_targets[frame_index] &&
+	    frame_index < swapchain->get_images().size())
+	{
+		frames[frame_index]->UpdateRenderTarget(create_swapchain_render_target(frame_index));
+		outdated_render_targets[frame_index] = false;
+	}
+}
+
+VkFence RenderContext::request_present_fence()
+{
+	if (!free_present_fences.empty())
+	{
+		VkFence fence = free_present_fences.back();
+		free_present_fences.pop_back();
+		return fence;
+	}
 
-	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	VkFenceCreateInfo create_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
 
-	submit_info.commandBufferCount = to_u32(cmd_buf_handles.size());
-	submit_info.pCommandBuffers    = cmd_buf_handles.data();
+	VkFence fence{VK_NULL_HANDLE};
+	VK_CHECK(vkCreateFence(device.get_handle(), &create_info, nullptr, &fence));
+	return fence;
+}
 
-	VkFence fence = frame.RequestFence();
+void RenderContext::recycle_present_fences()
+{
+	auto completed = std::find_if(present_fences.begin(), present_fences.end(), [this](VkFence fence) { return vkGetFenceStatus(device.get_handle(), fence) != VK_SUCCESS; });
+	if (completed == present_fences.begin())
+	{
+		return;
+	}
+
+	VK_CHECK(vkResetFences(device.get_handle(), to_u32(std::distance(present_fences.begin(), completed)), present_fences.data()));
 
-	VK_CHECK(queue.submit({submit_info}, fence));
+	free_present_fences.insert(free_present_fences.end(), present_fences.begin(), completed);
+	present_fences.erase(present_fences.begin(), completed);
+}
+
+const QueueTimeline &RenderContext::advance_timeline(VkQueue queue)
+{
+	auto it = std::find_if(queue_timelines.begin(), queue_timelines.end(), [queue](const QueueTimeline &timeline) { return timeline.queue == queue; });
+	if (it == queue_timelines.end())
+	{
+		VkSemaphoreTypeCreateInfoKHR type_info{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR};
+		type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+		type_info.initialValue  = 0;
+
+		VkSemaphoreCreateInfo create_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+		create_info.pNext = &type_info;
+
+		QueueTimeline timeline{queue};
+		VK_CHECK(vkCreateSemaphore(device.get_handle(), &create_info, nullptr, &timeline.semaphore));
+
+		queue_timelines.push_back(timeline);
+		it = std::prev(queue_timelines.end());
+	}
+
+	++it->value;
+
+	return *it;
 }
 
 void RenderContext::wait_frame()
 {
+	PROFILE_SCOPE("Wait Frame");
+
 	RenderFrame &frame = get_active_frame();
 	frame.Reset();
 }
 
 void RenderContext::end_frame(VkSemaphore semaphore)
 {
+	PROFILE_SCOPE("Present");
+
 	assert(frame_active && "Frame is not active, please call begin_frame");
 
 	if (swapchain)
@@ -436,12 +792,55 @@ void RenderContext::end_frame(VkSemaphore semaphore)
 			present_info.pNext = &disp_present_info;
 		}
 
+		// Tells when the presentation engine is done with the swapchain, see replace_swapchain
+		VkFence                        present_fence = VK_NULL_HANDLE;
+		VkSwapchainPresentFenceInfoEXT present_fence_info{VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT};
+		if (swapchain_maintenance1)
+		{
+			recycle_present_fences();
+			present_fence = request_present_fence();
+
+			present_fence_info.pNext          = present_info.pNext;
+			present_fence_info.swapchainCount = 1;
+			present_fence_info.pFences        = &present_fence;
+			present_info.pNext                = &present_fence_info;
+		}
+
+		// Each GPU presents the images it renders
+		uint32_t                    device_mask = get_active_device_mask();
+		VkDeviceGroupPresentInfoKHR device_group_present_info{VK_STRUCTURE_TYPE_DEVICE_GROUP_PRESENT_INFO_KHR};
+		if (device_mask != 0)
+		{
+			device_group_present_info.pNext          = present_info.pNext;
+			device_group_present_info.swapchainCount = 1;
+			device_group_present_info.pDeviceMasks   = &device_mask;
+			device_group_present_info.mode           = VK_DEVICE_GROUP_PRESENT_MODE_LOCAL_BIT_KHR;
+			present_info.pNext                       = &device_group_present_info;
+		}
+
+		present_info.pNext = frame_pacer->begin_present(vk_swapchain, active_frame_index, present_info.pNext);
+
 		VkResult result = queue.present(present_info);
 
+		frame_pacer->end_present(vk_swapchain);
+
+		if (present_fence != VK_NULL_HANDLE)
+		{
+			present_fences.push_back(present_fence);
+		}
+
 		if (result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
 			handle_surface_changes();
 		}
+		else if (result == VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT)
+		{
+			swapchain->acquire_full_screen_exclusive();
+		}
+	}
+	else
+	{
+		frame_pacer->end_frame(active_frame_index);
 	}
 
 	// Frame is not active anymore
@@ -478,6 +877,7 @@ RenderFrame &RenderContext::get_last_rendered_frame()
 {
 	assert(!frame_active && "Frame is still active, please call end_frame");
 	assert(active_frame_index < frames.size());
+	update_render_target(active_frame_index);
 	return *frames[active_frame_index];
 }
 
@@ -506,26 +906,14 @@ Device &RenderContext::get_device()
 
 void RenderContext::recreate_swapchain()
 {
-	device.wait_idle();
 	device.get_resource_cache().ClearFramebuffers();
 
-	VkExtent2D swapchain_extent = swapchain->get_extent();
-	VkExtent3D extent{swapchain_extent.width, swapchain_extent.height, 1};
-
-	auto frame_it = frames.begin();
-
-	for (auto &image_handle : swapchain->get_images())
+	for (uint32_t i = 0; i < to_u32(swapchain->get_images().size()); ++i)
 	{
-		core::Image swapchain_image{device, image_handle,
-		                            extent,
-		                            swapchain->get_format(),
-		                            swapchain->get_usage()};
-
-		auto render_target = create_render_target_func(std::move(swapchain_image));
-		(*frame_it)->UpdateRenderTarget(std::move(render_target));
-
-		++frame_it;
+		frames[i]->UpdateRenderTarget(create_swapchain_render_target(i));
 	}
+
+	outdated_render_targets.assign(frames.size(), false);
 }
 
 bool RenderContext::has_swapchain()
@@ -549,9 +937,188 @@ uint32_t RenderContext::get_active_frame_index() const
 	return active_frame_index;
 }
 
+size_t RenderContext::get_thread_count() const
+{
+	return thread_count;
+}
+
 std::vector<std::unique_ptr<RenderFrame>> &RenderContext::get_render_frames()
 {
+	// The caller may use the render target of any frame
+	for (uint32_t i = 0; i < to_u32(frames.size()); ++i)
+	{
+		update_render_target(i);
+	}
+
 	return frames;
 }
 
+void RenderContext::record_draws(uint64_t visible, uint64_t culled, uint64_t occluded)
+{
+	visible_draw_count.fetch_add(visible, std::memory_order_relaxed);
+	culled_draw_count.fetch_add(culled, std::memory_order_relaxed);
+	occluded_draw_count.fetch_add(occluded, std::memory_order_relaxed);
+}
+
+void RenderContext::record_lod_draws(const std::array<uint64_t, MaxLodCount> &counts)
+{
+	for (size_t i = 0; i < counts.size(); ++i)
+	{
+		lod_draw_counts[i].fetch_add(counts[i], std::memory_order_relaxed);
+	}
+}
+
+DrawCounts RenderContext::reset_draw_counts()
+{
+	DrawCounts counts{visible_draw_count.exchange(0, std::memory_order_relaxed),
+	                  culled_draw_count.exchange(0, std::memory_order_relaxed),
+	                  occluded_draw_count.exchange(0, std::memory_order_relaxed)};
+
+	for (size_t i = 0; i < counts.lods.size(); ++i)
+	{
+		counts.lods[i] = lod_draw_counts[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	return counts;
+}
+
+uint64_t RenderContext::reset_submit_count()
+{
+	return submit_count.exchange(0, std::memory_order_relaxed);
+}
+
+uint64_t RenderContext::reset_redundant_command_count()
+{
+	return redundant_command_count.exchange(0, std::memory_order_relaxed);
+}
+
+void RenderContext::pace_frame()
+{
+	PROFILE_SCOPE("Pace Frame");
+
+	assert(!frame_active && "Frame is still active, please call end_frame");
+
+	frame_pacer->pace(swapchain ? swapchain->get_handle() : VK_NULL_HANDLE);
+
+	uint32_t frame_index;
+	while (frame_pacer->next_frame_to_wait(frame_index))
+	{
+		// The frames may have been recreated with the swapchain since their submission
+		if (frame_index < frames.size())
+		{
+			frames[frame_index]->Wait();
+		}
+	}
+}
+
+FramePacer &RenderContext::get_frame_pacer()
+{
+	return *frame_pacer;
+}
+
+bool RenderContext::enable_gpu_frame_timing()
+{
+	assert(!frame_active && "GPU frame timing can't be enabled while a frame is active");
+
+	if (gpu_frame_timer)
+	{
+		return true;
+	}
+
+	if (!GpuFrameTimer::is_supported(device, queue.get_family_index()))
+	{
+		LOGW("The queue family of the render context doesn't support timestamps, frames aren't timed on the GPU");
+		return false;
+	}
+
+	gpu_frame_timer = std::make_unique<GpuFrameTimer>(device, queue.get_family_index());
+
+	return true;
+}
+
+GpuFrameTimer *RenderContext::get_gpu_frame_timer()
+{
+	return gpu_frame_timer.get();
+}
+
+bool RenderContext::enable_adaptive_swapchain(std::chrono::duration<float> target_frame_time)
+{
+	assert(!frame_active && "The adaptive swapchain can't be enabled while a frame is active");
+
+	if (!swapchain)
+	{
+		LOGW("Can't adapt the swapchain. No swapchain, offscreen rendering detected, skipping.");
+		return false;
+	}
+
+	VkSurfaceCapabilitiesKHR surface_properties;
+	VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device.get_gpu().get_handle(), swapchain->get_surface(), &surface_properties));
+
+	uint32_t present_mode_count{0};
+	VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(device.get_gpu().get_handle(), swapchain->get_surface(), &present_mode_count, nullptr));
+	std::vector<VkPresentModeKHR> present_modes(present_mode_count);
+	VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(device.get_gpu().get_handle(), swapchain->get_surface(), &present_mode_count, present_modes.data()));
+
+	bool allow_tearing = window.get_properties().vsync != Window::Vsync::ON;
+
+	SwapchainController::Configuration current{to_u32(swapchain->get_images().size()), swapchain->get_present_mode()};
+
+	swapchain_controller = std::make_unique<SwapchainController>(target_frame_time, present_modes, surface_properties.minImageCount, allow_tearing, current);
+
+	auto &configuration = swapchain_controller->get_configuration();
+	if (configuration.image_count != current.image_count || configuration.present_mode != current.present_mode)
+	{
+		update_swapchain(configuration.image_count, configuration.present_mode);
+	}
+
+	return true;
+}
+
+void RenderContext::disable_adaptive_swapchain()
+{
+	swapchain_controller.reset();
+}
+
+SwapchainController *RenderContext::get_swapchain_controller()
+{
+	return swapchain_controller.get();
+}
+
+bool RenderContext::enable_alternate_frame_rendering()
+{
+	assert(!frame_active && "Alternate frame rendering can't be enabled while a frame is active");
+
+	uint32_t device_count = device.get_physical_device_count();
+	if (device_count < 2)
+	{
+		return false;
+	}
+
+	if (swapchain)
+	{
+		VkDeviceGroupPresentCapabilitiesKHR capabilities{VK_STRUCTURE_TYPE_DEVICE_GROUP_PRESENT_CAPABILITIES_KHR};
+		VK_CHECK(vkGetDeviceGroupPresentCapabilitiesKHR(device.get_handle(), &capabilities));
+
+		for (uint32_t i = 0; i < device_count; ++i)
+		{
+			if (!(capabilities.modes & VK_DEVICE_GROUP_PRESENT_MODE_LOCAL_BIT_KHR) || !(capabilities.presentMask[i] & (1u << i)))
+			{
+				LOGW("GPU {} of the device group can't present its own images, the frames are rendered on all the GPUs", i);
+				return false;
+			}
+		}
+	}
+
+	alternate_frame_rendering = true;
+
+	LOGI("Rendering alternate frames on {} GPUs", device_count);
+
+	return true;
+}
+
+uint32_t RenderContext::get_active_device_mask() const
+{
+	return alternate_frame_rendering ? 1u << active_device_index : 0;
+}
+
 }        // namespace vkb
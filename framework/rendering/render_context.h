@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+
+#include "common/glm_common.h"
 #include "common/helpers.h"
 #include "common/vk_common.h"
 #include "core/command_buffer.h"
@@ -29,16 +33,37 @@
 #include "core/queue.h"
 #include "core/render_pass.h"
 #include "core/shader_module.h"
+#include "core/submission_builder.h"
 #include "core/swapchain.h"
+#include "geometry/lod.h"
+#include "rendering/frame_pacer.h"
+#include "rendering/gpu_frame_timer.h"
 #include "rendering/pipeline_state.h"
 #include "rendering/RenderFrame.h"
 #include "rendering/render_target.h"
+#include "rendering/swapchain_controller.h"
 #include "ResourceCache.h"
 
 namespace vkb
 {
 class Window;
 
+/**
+ * @brief Number of draws recorded and skipped by culling
+ */
+struct DrawCounts
+{
+	uint64_t visible{0};
+
+	uint64_t culled{0};
+
+	/// Draws inside the view but hidden by the depth of other objects, only counted by occlusion culling
+	uint64_t occluded{0};
+
+	/// Draws of sub meshes with levels of detail at each level, the others are not counted
+	std::array<uint64_t, MaxLodCount> lods{};
+};
+
 /**
  * @brief RenderContext acts as a frame manager for the sample, with a lifetime that is the
  * same as that of the Application itself. It acts as a container for RenderFrame objects,
@@ -52,7 +77,8 @@ class Window;
  * swapchain. A RenderFrame will then be created for each Swapchain image.
  *
  * For offscreen rendering (no swapchain), the RenderContext can be given a valid Device, and
- * a width and height. A single RenderFrame will then be created.
+ * a width and height. OFFSCREEN_FRAME_COUNT RenderFrames will then be created, each with an image
+ * of its own, and rendered in turn so the CPU records a frame while the GPU renders the previous ones.
  */
 class RenderContext
 {
@@ -60,6 +86,16 @@ class RenderContext
 	// The format to use for the RenderTargets if a swapchain isn't created
 	static VkFormat DEFAULT_VK_FORMAT;
 
+	// The number of RenderFrames if a swapchain isn't created
+	static constexpr uint32_t OFFSCREEN_FRAME_COUNT = 3;
+
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+	// Android rotates the images of swapchains that aren't pre-rotated with an extra composition pass
+	static constexpr bool DEFAULT_PRE_ROTATION = true;
+#else
+	static constexpr bool DEFAULT_PRE_ROTATION = false;
+#endif
+
 	/**
 	 * @brief Constructor
 	 * @param device A valid device
@@ -68,6 +104,7 @@ class RenderContext
 	 * @param present_mode Requests to set the present mode of the swapchain
 	 * @param present_mode_priority_list The order in which the swapchain prioritizes selecting its present mode
 	 * @param surface_format_priority_list The order in which the swapchain prioritizes selecting its surface format
+	 * @param pre_rotation Whether the swapchain follows the transform of the surface, see set_pre_rotation_enabled()
 	 */
 	RenderContext(Device                                &device,
 	              VkSurfaceKHR                           surface,
@@ -76,13 +113,14 @@ class RenderContext
 	              const std::vector<VkPresentModeKHR>   &present_mode_priority_list   = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR},
 	              const std::vector<VkSurfaceFormatKHR> &surface_format_priority_list = {
 	                  {VK_FORMAT_R8G8B8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
-	                  {VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}});
+	                  {VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}},
+	              bool                                   pre_rotation                 = DEFAULT_PRE_ROTATION);
 
 	RenderContext(const RenderContext &) = delete;
 
 	RenderContext(RenderContext &&) = delete;
 
-	virtual ~RenderContext() = default;
+	virtual ~RenderContext();
 
 	RenderContext &operator=(const RenderContext &) = delete;
 
@@ -107,6 +145,13 @@ class RenderContext
 	 */
 	void update_swapchain(const uint32_t image_count);
 
+	/**
+	 * @brief Updates the swapchains image count and present mode, if a swapchain exists
+	 * @param image_count The amount of images in the new swapchain
+	 * @param present_mode The present mode of the new swapchain, the priority list applies if it isn't supported
+	 */
+	void update_swapchain(const uint32_t image_count, const VkPresentModeKHR present_mode);
+
 	/**
 	 * @brief Updates the swapchains image usage, if a swapchain exists
 	 * @param image_usage_flags The usage flags the new swapchain images will have
@@ -127,6 +172,24 @@ class RenderContext
 	 */
 	void update_swapchain(const VkImageCompressionFlagsEXT compression, const VkImageCompressionFixedRateFlagsEXT compression_fixed_rate);
 
+	/**
+	 * @brief Sets whether the swapchain is pre-rotated, and recreates it with the matching transform
+	 *
+	 *        A pre-rotated swapchain takes the current transform of the surface, so the presentation
+	 *        engine displays its images as they are. Its images keep the native orientation of the
+	 *        display, the frame is rotated by the projection with get_pre_rotation() instead.
+	 *        Otherwise the swapchain uses the identity transform and the compositor rotates the images.
+	 *        Needs to be called after prepare(), the constructor takes the initial setting.
+	 */
+	void set_pre_rotation_enabled(bool enabled);
+
+	bool is_pre_rotation_enabled() const;
+
+	/**
+	 * @return The rotation to apply after the projection, matching the transform of the swapchain
+	 */
+	glm::mat4 get_pre_rotation() const;
+
 	/**
 	 * @returns True if a valid swapchain exists in the RenderContext
 	 */
@@ -174,6 +237,16 @@ class RenderContext
 	 */
 	void submit(const Queue &queue, const std::vector<CommandBuffer *> &command_buffers);
 
+	/**
+	 * @brief Starts collecting the batches of a frame for a queue, to submit them in a single call
+	 */
+	SubmissionBuilder begin_submission(const Queue &queue) const;
+
+	/**
+	 * @brief Submits the collected batches, tracked with the active frame by a fence or a timeline signal
+	 */
+	void submit(SubmissionBuilder &submission);
+
 	/**
 	 * @brief Waits a frame to finish its rendering
 	 */
@@ -181,6 +254,19 @@ class RenderContext
 
 	void end_frame(VkSemaphore semaphore);
 
+	/**
+	 * @brief Tracks the submissions with a timeline semaphore per queue instead of a fence per submission
+	 *
+	 *        Resetting a frame then waits for the value of its last submission to each queue.
+	 *        Needs VK_KHR_timeline_semaphore and VkPhysicalDeviceTimelineSemaphoreFeaturesKHR::timelineSemaphore
+	 *        requested in VulkanSample::request_gpu_features, and no active frame. VulkanSample requests them
+	 *        and enables this once it created the render context, when the device supports them.
+	 * @return Whether the submissions are tracked with timeline semaphores
+	 */
+	bool enable_timeline_semaphores();
+
+	bool uses_timeline_semaphores() const;
+
 	/**
 	 * @brief An error should be raised if the frame is not active.
 	 *        A frame is active after @ref begin_frame has been called.
@@ -219,8 +305,97 @@ class RenderContext
 
 	uint32_t get_active_frame_index() const;
 
+	/**
+	 * @return The number of threads the render frames allocate resource pools for
+	 */
+	size_t get_thread_count() const;
+
 	std::vector<std::unique_ptr<RenderFrame>> &get_render_frames();
 
+	/**
+	 * @brief Accumulates draw counts, can be called from any recording thread
+	 * @param visible Number of draws recorded
+	 * @param culled Number of draws skipped by culling
+	 * @param occluded Number of draws skipped by occlusion culling, not included in culled
+	 */
+	void record_draws(uint64_t visible, uint64_t culled, uint64_t occluded = 0);
+
+	/**
+	 * @brief Accumulates the number of draws at each level of detail, can be called from any recording thread
+	 */
+	void record_lod_draws(const std::array<uint64_t, MaxLodCount> &counts);
+
+	/**
+	 * @return The draw counts accumulated since the last call
+	 */
+	DrawCounts reset_draw_counts();
+
+	/**
+	 * @return The number of queue submissions made since the last call
+	 */
+	uint64_t reset_submit_count();
+
+	/**
+	 * @return The number of redundant commands the command buffers submitted skipped since the last call
+	 */
+	uint64_t reset_redundant_command_count();
+
+	/**
+	 * @brief Waits for older frames as configured on the frame pacer
+	 *        To be called before sampling the input and simulating a frame, with no active frame.
+	 */
+	void pace_frame();
+
+	FramePacer &get_frame_pacer();
+
+	/**
+	 * @brief Times the frames on the GPU, with timestamps around the command buffers ending each frame
+	 *        Needs no active frame. Only the frames submitted with submit(command_buffers) are timed, with the
+	 *        passes the render and postprocessing pipelines record in those command buffers.
+	 * @return Whether the queue of the render context supports timestamps
+	 */
+	bool enable_gpu_frame_timing();
+
+	/**
+	 * @return The GPU frame timer, nullptr if GPU frame timing isn't enabled
+	 */
+	GpuFrameTimer *get_gpu_frame_timer();
+
+	/**
+	 * @brief Adapts the image count and present mode of the swapchain to the frame rate, see SwapchainController
+	 *        Needs no active frame. The swapchain is recreated at the start of a frame, and the resources of the old
+	 *        one are retired to the deferred destruction queue, so the frames in flight aren't waited for.
+	 *        FIFO_RELAXED is only used if the window doesn't require vsync.
+	 * @param target_frame_time The interval between frames to hold
+	 * @return Whether a swapchain exists to adapt
+	 */
+	bool enable_adaptive_swapchain(std::chrono::duration<float> target_frame_time);
+
+	/**
+	 * @brief Keeps the current image count and present mode of the swapchain
+	 */
+	void disable_adaptive_swapchain();
+
+	/**
+	 * @return The controller adapting the swapchain, nullptr if the adaptive swapchain isn't enabled
+	 */
+	SwapchainController *get_swapchain_controller();
+
+	/**
+	 * @brief Renders the frames in turn on the GPUs of the device group, see Device::get_physical_device_count
+	 *        Needs no active frame. The batches of begin_submission run on the GPU of the active frame, which
+	 *        also acquires and presents its swapchain image. Each GPU has its own instance of the device local
+	 *        memory, so the resources a frame reads must be written by the same frame, or by commands run on
+	 *        all the GPUs, like the uploads submitted without a device mask.
+	 * @return Whether the device spans several GPUs which can each present their own images if there is a swapchain
+	 */
+	bool enable_alternate_frame_rendering();
+
+	/**
+	 * @return The device mask of the GPU rendering the active frame, 0 for all of them without alternate frame rendering
+	 */
+	uint32_t get_active_device_mask() const;
+
 	/**
 	 * @brief Handles surface changes, only applicable if the render_context makes use of a swapchain
 	 */
@@ -236,6 +411,31 @@ class RenderContext
 	VkExtent2D surface_extent;
 
   private:
+	/**
+	 * @brief Moves the timeline of a queue to the value of a new submission, creating it on the first one
+	 */
+	const QueueTimeline &advance_timeline(VkQueue queue);
+
+	/**
+	 * @brief Retires the current swapchain and the render targets viewing its images, which the frames in flight may still use
+	 *        With VK_EXT_swapchain_maintenance1, they are destroyed once the fences of their presents are signaled.
+	 */
+	void replace_swapchain(std::unique_ptr<Swapchain> &&new_swapchain);
+
+	std::unique_ptr<RenderTarget> create_swapchain_render_target(uint32_t image_index);
+
+	/**
+	 * @brief Recreates the render target of a frame if its image belonged to a replaced swapchain
+	 */
+	void update_render_target(uint32_t frame_index);
+
+	VkFence request_present_fence();
+
+	/**
+	 * @brief Recycles the fences of the presents which completed, oldest first
+	 */
+	void recycle_present_fences();
+
 	Device &device;
 
 	const Window &window;
@@ -247,6 +447,9 @@ class RenderContext
 
 	SwapchainProperties swapchain_properties;
 
+	/// Buffer rings shared by all the frames, used by BufferAllocationStrategy::RingBuffer
+	std::shared_ptr<BufferRingSet> buffer_rings;
+
 	std::vector<std::unique_ptr<RenderFrame>> frames;
 
 	VkSemaphore acquired_semaphore;
@@ -263,7 +466,51 @@ class RenderContext
 
 	VkSurfaceTransformFlagBitsKHR pre_transform{VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR};
 
+	/// Whether the swapchain follows the current transform of the surface
+	bool pre_rotation{false};
+
 	size_t thread_count{1};
+
+	std::atomic<uint64_t> visible_draw_count{0};
+
+	std::atomic<uint64_t> culled_draw_count{0};
+
+	std::atomic<uint64_t> occluded_draw_count{0};
+
+	std::array<std::atomic<uint64_t>, MaxLodCount> lod_draw_counts{};
+
+	bool timeline_semaphores{false};
+
+	std::vector<QueueTimeline> queue_timelines;
+
+	bool synchronization2{false};
+
+	std::atomic<uint64_t> submit_count{0};
+
+	/// Commands skipped by the command buffers submitted, see CommandBuffer::get_redundant_command_count()
+	std::atomic<uint64_t> redundant_command_count{0};
+
+	std::unique_ptr<FramePacer> frame_pacer;
+
+	/// Whether the presents signal a fence, with VK_EXT_swapchain_maintenance1
+	bool swapchain_maintenance1{false};
+
+	/// Fences of the presents to the current swapchain, retired with it
+	std::vector<VkFence> present_fences;
+
+	std::vector<VkFence> free_present_fences;
+
+	/// Frames whose render target was released with a replaced swapchain, recreated when they are used next
+	std::vector<bool> outdated_render_targets;
+
+	std::unique_ptr<GpuFrameTimer> gpu_frame_timer;
+
+	std::unique_ptr<SwapchainController> swapchain_controller;
+
+	bool alternate_frame_rendering{false};
+
+	/// GPU of the device group rendering the active frame, with alternate frame rendering
+	uint32_t active_device_index{0};
 };
 
 }        // namespace vkb
@@ -0,0 +1,1118 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/render_graph.h"
+
+#include <algorithm>
+
+#include "core/allocated.h"
+#include "core/command_buffer.h"
+#include "core/debug.h"
+#include "core/device.h"
+#include "core/framebuffer.h"
+#include "core/image.h"
+#include "core/image_view.h"
+#include "core/resource_state_tracker.h"
+#include "rendering/render_target.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr VkAccessFlags2KHR write_access_mask = VK_ACCESS_2_SHADER_WRITE_BIT_KHR | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR |
+                                                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR | VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR |
+                                                VK_ACCESS_2_HOST_WRITE_BIT_KHR | VK_ACCESS_2_MEMORY_WRITE_BIT_KHR;
+
+constexpr VkImageUsageFlags attachment_usage_mask = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                                    VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+/**
+ * @brief Synchronization scope of an access, only made of the stages and accesses of synchronization1
+ *        so that the barriers can be recorded without VK_KHR_synchronization2
+ */
+struct AccessScope
+{
+	VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+	VkPipelineStageFlags2KHR stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+	VkAccessFlags2KHR access{VK_ACCESS_2_NONE_KHR};
+
+	VkImageUsageFlags usage{0};
+};
+
+bool is_attachment(RenderGraphTextureUsage usage)
+{
+	return usage == RenderGraphTextureUsage::ColorAttachment ||
+	       usage == RenderGraphTextureUsage::DepthStencilAttachment ||
+	       usage == RenderGraphTextureUsage::InputAttachment;
+}
+
+VkPipelineStageFlags2KHR get_shader_stages(RenderGraphPassType type)
+{
+	switch (type)
+	{
+		case RenderGraphPassType::Compute:
+			return VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
+		case RenderGraphPassType::Transfer:
+			return VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR;
+		default:
+			return VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR;
+	}
+}
+
+AccessScope get_texture_scope(RenderGraphTextureUsage usage, bool write, VkAttachmentLoadOp load_op, RenderGraphPassType type, VkFormat format)
+{
+	bool depth = is_depth_format(format);
+
+	switch (usage)
+	{
+		case RenderGraphTextureUsage::ColorAttachment:
+			return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+			        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR | (load_op == VK_ATTACHMENT_LOAD_OP_LOAD ? VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT_KHR : 0),
+			        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+		case RenderGraphTextureUsage::DepthStencilAttachment:
+			return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT_KHR | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT_KHR,
+			        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT_KHR | (write ? VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR : 0),
+			        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+		case RenderGraphTextureUsage::InputAttachment:
+			return {depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+			        VK_ACCESS_2_INPUT_ATTACHMENT_READ_BIT_KHR,
+			        VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT};
+		case RenderGraphTextureUsage::Sampled:
+			return {depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			        get_shader_stages(type),
+			        VK_ACCESS_2_SHADER_READ_BIT_KHR,
+			        VK_IMAGE_USAGE_SAMPLED_BIT};
+		case RenderGraphTextureUsage::Storage:
+			return {VK_IMAGE_LAYOUT_GENERAL,
+			        get_shader_stages(type),
+			        VK_ACCESS_2_SHADER_READ_BIT_KHR | (write ? VK_ACCESS_2_SHADER_WRITE_BIT_KHR : 0),
+			        VK_IMAGE_USAGE_STORAGE_BIT};
+		case RenderGraphTextureUsage::TransferSrc:
+			return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			        VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+			        VK_ACCESS_2_TRANSFER_READ_BIT_KHR,
+			        VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+		case RenderGraphTextureUsage::TransferDst:
+			return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			        VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR,
+			        VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+			        VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+		default:
+			throw std::runtime_error("Unknown render graph texture usage");
+	}
+}
+
+AccessScope get_buffer_scope(RenderGraphBufferUsage usage, bool write, RenderGraphPassType type)
+{
+	switch (usage)
+	{
+		case RenderGraphBufferUsage::Vertex:
+			return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT_KHR, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT_KHR};
+		case RenderGraphBufferUsage::Index:
+			return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT_KHR, VK_ACCESS_2_INDEX_READ_BIT_KHR};
+		case RenderGraphBufferUsage::Indirect:
+			return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT_KHR, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT_KHR};
+		case RenderGraphBufferUsage::Uniform:
+			return {VK_IMAGE_LAYOUT_UNDEFINED, get_shader_stages(type), VK_ACCESS_2_UNIFORM_READ_BIT_KHR};
+		case RenderGraphBufferUsage::Storage:
+			return {VK_IMAGE_LAYOUT_UNDEFINED, get_shader_stages(type), VK_ACCESS_2_SHADER_READ_BIT_KHR | (write ? VK_ACCESS_2_SHADER_WRITE_BIT_KHR : 0)};
+		case RenderGraphBufferUsage::TransferSrc:
+			return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_READ_BIT_KHR};
+		case RenderGraphBufferUsage::TransferDst:
+			return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR};
+		default:
+			throw std::runtime_error("Unknown render graph buffer usage");
+	}
+}
+
+VkImageSubresourceRange get_barrier_range(const core::ImageView &view)
+{
+	auto range = view.get_subresource_range();
+
+	// Without separate depth stencil layouts, both aspects transition together
+	if (is_depth_stencil_format(view.get_format()))
+	{
+		range.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+
+	return range;
+}
+
+bool has_lazily_allocated_memory(Device &device)
+{
+	auto &memory_properties = device.get_gpu().get_memory_properties();
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+	{
+		if (memory_properties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+}        // namespace
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph &graph, uint32_t pass_index) :
+    graph{graph},
+    pass_index{pass_index}
+{}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::write_color(RenderGraphTexture texture, VkAttachmentLoadOp load_op, VkClearValue clear_value)
+{
+	return add_texture_access(texture, RenderGraphTextureUsage::ColorAttachment, true, load_op, clear_value);
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::write_depth_stencil(RenderGraphTexture texture, VkAttachmentLoadOp load_op, VkClearValue clear_value)
+{
+	return add_texture_access(texture, RenderGraphTextureUsage::DepthStencilAttachment, true, load_op, clear_value);
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::read_input_attachment(RenderGraphTexture texture)
+{
+	return add_texture_access(texture, RenderGraphTextureUsage::InputAttachment, false, VK_ATTACHMENT_LOAD_OP_LOAD, {});
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::read_texture(RenderGraphTexture texture, RenderGraphTextureUsage usage)
+{
+	return add_texture_access(texture, usage, false, VK_ATTACHMENT_LOAD_OP_LOAD, {});
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::write_texture(RenderGraphTexture texture, RenderGraphTextureUsage usage)
+{
+	// Writes outside of attachments may be partial, they keep the content before them
+	return add_texture_access(texture, usage, true, VK_ATTACHMENT_LOAD_OP_LOAD, {});
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::read_buffer(RenderGraphBuffer buffer, RenderGraphBufferUsage usage)
+{
+	assert(buffer.index < graph.buffers.size() && "Invalid render graph buffer");
+	graph.passes[pass_index].buffers.push_back({buffer.index, usage, false});
+	return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::write_buffer(RenderGraphBuffer buffer, RenderGraphBufferUsage usage)
+{
+	assert(buffer.index < graph.buffers.size() && "Invalid render graph buffer");
+	graph.passes[pass_index].buffers.push_back({buffer.index, usage, true});
+	return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::set_execute(ExecuteFunc &&execute)
+{
+	graph.passes[pass_index].execute = std::move(execute);
+	return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::set_side_effect()
+{
+	graph.passes[pass_index].side_effect = true;
+	return *this;
+}
+
+RenderGraph::PassBuilder &RenderGraph::PassBuilder::add_texture_access(RenderGraphTexture texture, RenderGraphTextureUsage usage, bool write, VkAttachmentLoadOp load_op, VkClearValue clear_value)
+{
+	assert(texture.index < graph.textures.size() && "Invalid render graph texture");
+
+	auto &pass = graph.passes[pass_index];
+	if (is_attachment(usage) && pass.type != RenderGraphPassType::Graphics)
+	{
+		throw std::runtime_error(fmt::format("Pass {} isn't a graphics pass, it can't use {} as an attachment", pass.name, graph.textures[texture.index].name));
+	}
+
+	pass.textures.push_back({texture.index, usage, write, load_op, clear_value});
+	return *this;
+}
+
+RenderGraph::MemoryBlock::MemoryBlock(Device &device) :
+    device{device}
+{}
+
+RenderGraph::MemoryBlock::~MemoryBlock()
+{
+	for (auto handle : images)
+	{
+		vkDestroyImage(device.get_handle(), handle, nullptr);
+	}
+
+	if (allocation != VK_NULL_HANDLE)
+	{
+		vmaFreeMemory(allocated::get_memory_allocator(), allocation);
+	}
+}
+
+RenderGraph::RenderGraph(Device &device) :
+    device{device}
+{
+	auto synchronization2_features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceSynchronization2FeaturesKHR>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR);
+	synchronization2 = device.is_enabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) && synchronization2_features && synchronization2_features->synchronization2;
+}
+
+RenderGraph::~RenderGraph()
+{
+	retire_resources();
+}
+
+RenderGraphTexture RenderGraph::create_texture(const std::string &name, const RenderGraphTextureDesc &desc)
+{
+	TextureResource texture{};
+	texture.name = name;
+	texture.desc = desc;
+	textures.push_back(std::move(texture));
+
+	return {to_u32(textures.size() - 1)};
+}
+
+RenderGraphTexture RenderGraph::import_texture(const std::string &name, const core::ImageView &view, const RenderGraphResourceState &initial_state, const RenderGraphResourceState &final_state)
+{
+	auto &image     = view.get_image();
+	auto  mip_level = view.get_subresource_range().baseMipLevel;
+
+	TextureResource texture{};
+	texture.name           = name;
+	texture.desc.extent    = {image.get_extent().width >> mip_level, image.get_extent().height >> mip_level};
+	texture.desc.format    = view.get_format();
+	texture.desc.samples   = image.get_sample_count();
+	texture.usage          = image.get_usage();
+	texture.imported_view  = &view;
+	texture.initial_state  = initial_state;
+	texture.final_state    = final_state;
+	textures.push_back(std::move(texture));
+
+	return {to_u32(textures.size() - 1)};
+}
+
+RenderGraphBuffer RenderGraph::import_buffer(const std::string &name, const core::BufferC &buffer, const RenderGraphResourceState &initial_state)
+{
+	buffers.push_back({name, &buffer, initial_state, {}});
+
+	return {to_u32(buffers.size() - 1)};
+}
+
+void RenderGraph::bind_texture(RenderGraphTexture texture, const core::ImageView &view)
+{
+	auto &resource = textures.at(texture.index);
+	assert(resource.imported_view && "Only imported textures can be bound to a view");
+	assert(view.get_format() == resource.desc.format && "The view must have the format the texture was imported with");
+
+	resource.imported_view = &view;
+}
+
+RenderGraph::PassBuilder RenderGraph::add_pass(const std::string &name, RenderGraphPassType type)
+{
+	Pass pass{};
+	pass.name = name;
+	pass.type = type;
+	passes.push_back(std::move(pass));
+
+	return PassBuilder{*this, to_u32(passes.size() - 1)};
+}
+
+void RenderGraph::compile()
+{
+	retire_resources();
+
+	std::vector<uint32_t> kept_passes;
+	cull_passes(kept_passes);
+	culled_pass_count = to_u32(passes.size() - kept_passes.size());
+
+	create_groups(kept_passes);
+	create_images();
+
+	for (uint32_t group_index = 0; group_index < to_u32(groups.size()); ++group_index)
+	{
+		init_group(groups[group_index], group_index);
+	}
+
+	LOGI("Render graph compiled: {} passes, {} culled, {} render passes, {} textures aliasing {} memory blocks of {} bytes",
+	     passes.size(), culled_pass_count, get_render_pass_count(), textures.size(), memory_blocks.size(), get_memory_size());
+}
+
+void RenderGraph::execute(CommandBuffer &command_buffer)
+{
+	barrier_count = 0;
+
+	for (auto &texture : textures)
+	{
+		if (texture.imported_view)
+		{
+			texture.state              = {};
+			texture.state.layout       = texture.initial_state.layout;
+			texture.state.write_stages = texture.initial_state.stages;
+			texture.state.write_access = texture.initial_state.access;
+		}
+	}
+
+	for (auto &buffer : buffers)
+	{
+		buffer.state              = {};
+		buffer.state.write_stages = buffer.initial_state.stages;
+		buffer.state.write_access = buffer.initial_state.access;
+	}
+
+	for (auto &group : groups)
+	{
+		for (auto &access : group.accesses)
+		{
+			synchronize(access.texture, access.index, access.layout, access.stages, access.access, access.write, access.discard);
+		}
+		flush_barriers(command_buffer);
+
+		if (!group.render_pass)
+		{
+			auto            &pass = passes[group.passes.front()];
+			ScopedDebugLabel debug_label{command_buffer, pass.name.c_str()};
+			if (pass.execute)
+			{
+				pass.execute(command_buffer);
+			}
+			continue;
+		}
+
+		auto &framebuffer = get_framebuffer(group);
+		command_buffer.begin_render_pass(*framebuffer.render_target, *framebuffer.render_pass, *framebuffer.framebuffer, group.clear_values);
+
+		for (size_t i = 0; i < group.passes.size(); ++i)
+		{
+			if (i > 0)
+			{
+				command_buffer.next_subpass();
+			}
+
+			auto            &pass = passes[group.passes[i]];
+			ScopedDebugLabel debug_label{command_buffer, pass.name.c_str()};
+			if (pass.execute)
+			{
+				pass.execute(command_buffer);
+			}
+		}
+
+		command_buffer.end_render_pass();
+
+		// The render pass transitions the attachments to the layout of their last subpass
+		for (auto &access : group.accesses)
+		{
+			auto &state = get_state(access.texture, access.index);
+			if (access.write || state.layout != access.final_layout)
+			{
+				state.write_stages   = access.stages;
+				state.write_access   = access.access & write_access_mask;
+				state.read_stages    = VK_PIPELINE_STAGE_2_NONE_KHR;
+				state.visible_stages = VK_PIPELINE_STAGE_2_NONE_KHR;
+				state.visible_access = VK_ACCESS_2_NONE_KHR;
+			}
+			if (access.texture)
+			{
+				state.layout = access.final_layout;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < to_u32(textures.size()); ++i)
+	{
+		auto &final_state = textures[i].final_state;
+		if (textures[i].imported_view && final_state.layout != VK_IMAGE_LAYOUT_UNDEFINED)
+		{
+			synchronize(true, i, final_state.layout, final_state.stages, final_state.access, false, false);
+		}
+	}
+	flush_barriers(command_buffer);
+}
+
+const core::ImageView &RenderGraph::get_view(RenderGraphTexture texture) const
+{
+	auto &resource = textures.at(texture.index);
+	if (resource.imported_view)
+	{
+		return *resource.imported_view;
+	}
+
+	if (resource.image == ~0U)
+	{
+		throw std::runtime_error(fmt::format("Render graph texture {} isn't accessed by the passes kept", resource.name));
+	}
+
+	return *images[resource.image].view;
+}
+
+uint32_t RenderGraph::get_culled_pass_count() const
+{
+	return culled_pass_count;
+}
+
+uint32_t RenderGraph::get_render_pass_count() const
+{
+	return to_u32(std::count_if(groups.begin(), groups.end(), [](const Group &group) { return group.render_pass; }));
+}
+
+VkDeviceSize RenderGraph::get_memory_size() const
+{
+	VkDeviceSize size = 0;
+	for (auto &block : memory_blocks)
+	{
+		size += block->requirements.size;
+	}
+	return size;
+}
+
+uint32_t RenderGraph::get_barrier_count() const
+{
+	return barrier_count;
+}
+
+bool RenderGraph::can_merge(const Group &group, const Pass &pass) const
+{
+	if (!group.render_pass || pass.type != RenderGraphPassType::Graphics)
+	{
+		return false;
+	}
+
+	const VkExtent2D *group_extent = nullptr;
+	uint32_t          group_depth  = ~0U;
+	for (auto pass_index : group.passes)
+	{
+		for (auto &access : passes[pass_index].textures)
+		{
+			if (is_attachment(access.usage) && !group_extent)
+			{
+				group_extent = &get_extent(access.texture);
+			}
+			if (access.usage == RenderGraphTextureUsage::DepthStencilAttachment)
+			{
+				group_depth = access.texture;
+			}
+		}
+	}
+
+	for (auto &access : pass.textures)
+	{
+		bool attachment = is_attachment(access.usage);
+		if (attachment)
+		{
+			auto &extent = get_extent(access.texture);
+			if (extent.width != group_extent->width || extent.height != group_extent->height)
+			{
+				return false;
+			}
+		}
+
+		// A render pass has a single depth stencil attachment
+		if (access.usage == RenderGraphTextureUsage::DepthStencilAttachment && group_depth != ~0U && group_depth != access.texture)
+		{
+			return false;
+		}
+
+		bool accessed         = false;
+		bool prior_attachment = true;
+		bool prior_read_only  = true;
+		bool same_usage       = true;
+		for (auto pass_index : group.passes)
+		{
+			for (auto &prior : passes[pass_index].textures)
+			{
+				if (prior.texture == access.texture)
+				{
+					accessed = true;
+					prior_attachment &= is_attachment(prior.usage);
+					prior_read_only &= !prior.write;
+					same_usage &= prior.usage == access.usage;
+				}
+			}
+		}
+
+		if (!accessed)
+		{
+			continue;
+		}
+
+		// The dependencies between the subpasses of a RenderPass cover attachments read as input attachments,
+		// and attachments accessed again the same way
+		if (attachment && prior_attachment && (access.usage == RenderGraphTextureUsage::InputAttachment || same_usage))
+		{
+			continue;
+		}
+
+		if (!attachment && !prior_attachment && prior_read_only && !access.write)
+		{
+			continue;
+		}
+
+		return false;
+	}
+
+	for (auto &access : pass.buffers)
+	{
+		for (auto pass_index : group.passes)
+		{
+			for (auto &prior : passes[pass_index].buffers)
+			{
+				if (prior.buffer == access.buffer && (prior.write || access.write))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+void RenderGraph::cull_passes(std::vector<uint32_t> &kept_passes) const
+{
+	// Whether the content of each resource is read later, the imported ones are read outside of the graph
+	std::vector<bool> needed_textures(textures.size());
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		needed_textures[i] = textures[i].imported_view != nullptr;
+	}
+
+	kept_passes.clear();
+
+	for (auto i = to_u32(passes.size()); i-- > 0;)
+	{
+		auto &pass = passes[i];
+
+		// Buffers are all imported, writing one is always needed
+		bool keep = pass.side_effect || std::any_of(pass.buffers.begin(), pass.buffers.end(), [](const BufferAccess &access) { return access.write; });
+		for (auto &access : pass.textures)
+		{
+			keep |= access.write && needed_textures[access.texture];
+		}
+
+		if (!keep)
+		{
+			continue;
+		}
+
+		kept_passes.push_back(i);
+
+		// An attachment which isn't loaded replaces the content written before it
+		for (auto &access : pass.textures)
+		{
+			if (access.write && access.load_op != VK_ATTACHMENT_LOAD_OP_LOAD)
+			{
+				needed_textures[access.texture] = false;
+			}
+		}
+
+		for (auto &access : pass.textures)
+		{
+			if (access.load_op == VK_ATTACHMENT_LOAD_OP_LOAD)
+			{
+				needed_textures[access.texture] = true;
+			}
+		}
+	}
+
+	std::reverse(kept_passes.begin(), kept_passes.end());
+}
+
+void RenderGraph::create_groups(const std::vector<uint32_t> &kept_passes)
+{
+	for (auto pass_index : kept_passes)
+	{
+		auto &pass = passes[pass_index];
+
+		if (pass.type == RenderGraphPassType::Graphics &&
+		    std::none_of(pass.textures.begin(), pass.textures.end(), [](const TextureAccess &access) { return is_attachment(access.usage); }))
+		{
+			throw std::runtime_error(fmt::format("Graphics pass {} has no attachment", pass.name));
+		}
+
+		if (!groups.empty() && can_merge(groups.back(), pass))
+		{
+			groups.back().passes.push_back(pass_index);
+			continue;
+		}
+
+		Group group{};
+		group.passes.push_back(pass_index);
+		group.render_pass = pass.type == RenderGraphPassType::Graphics;
+		groups.push_back(std::move(group));
+	}
+}
+
+void RenderGraph::create_images()
+{
+	for (auto &texture : textures)
+	{
+		texture.first_group = ~0U;
+		texture.last_group  = 0;
+		texture.image       = ~0U;
+		texture.transient   = false;
+		if (!texture.imported_view)
+		{
+			texture.usage = 0;
+		}
+	}
+
+	for (uint32_t group_index = 0; group_index < to_u32(groups.size()); ++group_index)
+	{
+		for (auto pass_index : groups[group_index].passes)
+		{
+			auto &pass = passes[pass_index];
+			for (auto &access : pass.textures)
+			{
+				auto &texture       = textures[access.texture];
+				texture.first_group = std::min(texture.first_group, group_index);
+				texture.last_group  = std::max(texture.last_group, group_index);
+				if (!texture.imported_view)
+				{
+					texture.usage |= get_texture_scope(access.usage, access.write, access.load_op, pass.type, texture.desc.format).usage;
+				}
+			}
+		}
+	}
+
+	bool lazily_allocated = has_lazily_allocated_memory(device);
+
+	std::vector<uint32_t> aliased_textures;
+	for (uint32_t i = 0; i < to_u32(textures.size()); ++i)
+	{
+		auto &texture = textures[i];
+		if (texture.imported_view || texture.first_group == ~0U)
+		{
+			continue;
+		}
+
+		texture.transient = texture.first_group == texture.last_group && (texture.usage & ~attachment_usage_mask) == 0;
+		if (texture.transient)
+		{
+			texture.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		}
+
+		texture.image = to_u32(images.size());
+		images.emplace_back();
+
+		if (texture.transient && lazily_allocated)
+		{
+			// Tilers keep the attachment in tile memory, its allocation is only committed if the tile memory isn't enough
+			auto &image = images.back();
+			image.image = std::make_unique<core::Image>(device, VkExtent3D{texture.desc.extent.width, texture.desc.extent.height, 1},
+			                                            texture.desc.format, texture.usage, VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED, texture.desc.samples);
+			image.image->set_debug_name(texture.name);
+			image.view = std::make_unique<core::ImageView>(*image.image, VK_IMAGE_VIEW_TYPE_2D);
+		}
+		else
+		{
+			aliased_textures.push_back(i);
+		}
+	}
+
+	alias_images(aliased_textures);
+}
+
+void RenderGraph::alias_images(const std::vector<uint32_t> &aliased_textures)
+{
+	std::vector<uint32_t> sorted_textures = aliased_textures;
+	std::stable_sort(sorted_textures.begin(), sorted_textures.end(),
+	                 [this](uint32_t lhs, uint32_t rhs) { return textures[lhs].first_group < textures[rhs].first_group; });
+
+	for (auto texture_index : sorted_textures)
+	{
+		auto &texture = textures[texture_index];
+
+		VkImageCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+		create_info.imageType     = VK_IMAGE_TYPE_2D;
+		create_info.format        = texture.desc.format;
+		create_info.extent        = {texture.desc.extent.width, texture.desc.extent.height, 1};
+		create_info.mipLevels     = 1;
+		create_info.arrayLayers   = 1;
+		create_info.samples       = texture.desc.samples;
+		create_info.tiling        = VK_IMAGE_TILING_OPTIMAL;
+		create_info.usage         = texture.usage;
+		create_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+		create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		VkImage handle{VK_NULL_HANDLE};
+		VK_CHECK(vkCreateImage(device.get_handle(), &create_info, nullptr, &handle));
+
+		VkMemoryRequirements requirements{};
+		vkGetImageMemoryRequirements(device.get_handle(), handle, &requirements);
+
+		// The first block released by the textures before this one, and of a compatible memory type
+		auto it = std::find_if(memory_blocks.begin(), memory_blocks.end(), [&](const std::unique_ptr<MemoryBlock> &block) {
+			return block->last_group < texture.first_group && (block->requirements.memoryTypeBits & requirements.memoryTypeBits) != 0;
+		});
+		if (it == memory_blocks.end())
+		{
+			memory_blocks.push_back(std::make_unique<MemoryBlock>(device));
+			it = memory_blocks.end() - 1;
+
+			(*it)->requirements = requirements;
+		}
+
+		auto &block = **it;
+		block.requirements.size = std::max(block.requirements.size, requirements.size);
+		block.requirements.alignment = std::max(block.requirements.alignment, requirements.alignment);
+		block.requirements.memoryTypeBits &= requirements.memoryTypeBits;
+		block.last_group = texture.last_group;
+		block.images.push_back(handle);
+
+		auto &image  = images[texture.image];
+		image.memory = to_u32(std::distance(memory_blocks.begin(), it));
+		image.image  = std::make_unique<core::Image>(device, handle, create_info.extent, texture.desc.format, texture.usage, texture.desc.samples);
+		image.image->set_debug_name(texture.name);
+	}
+
+	VmaAllocationCreateInfo allocation_info{};
+	allocation_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	for (auto &block : memory_blocks)
+	{
+		VK_CHECK(vmaAllocateMemory(allocated::get_memory_allocator(), &block->requirements, &allocation_info, &block->allocation, nullptr));
+
+		for (auto handle : block->images)
+		{
+			VK_CHECK(vmaBindImageMemory(allocated::get_memory_allocator(), block->allocation, handle));
+		}
+	}
+
+	// Views can only be created once the images are bound
+	for (auto texture_index : sorted_textures)
+	{
+		auto &image = images[textures[texture_index].image];
+		image.view  = std::make_unique<core::ImageView>(*image.image, VK_IMAGE_VIEW_TYPE_2D);
+	}
+}
+
+void RenderGraph::init_group(Group &group, uint32_t group_index)
+{
+	auto get_access = [&group](bool texture, uint32_t index) -> GroupAccess * {
+		auto it = std::find_if(group.accesses.begin(), group.accesses.end(),
+		                       [texture, index](const GroupAccess &access) { return access.texture == texture && access.index == index; });
+		return it == group.accesses.end() ? nullptr : &*it;
+	};
+
+	for (auto pass_index : group.passes)
+	{
+		auto &pass = passes[pass_index];
+
+		SubpassInfo subpass{};
+		subpass.disable_depth_stencil_attachment = true;
+		subpass.depth_stencil_resolve_mode       = VK_RESOLVE_MODE_NONE;
+		subpass.debug_name                       = pass.name;
+
+		for (auto &access : pass.textures)
+		{
+			auto &texture = textures[access.texture];
+			auto  scope   = get_texture_scope(access.usage, access.write, access.load_op, pass.type, texture.desc.format);
+
+			if (is_attachment(access.usage))
+			{
+				auto it         = std::find(group.attachments.begin(), group.attachments.end(), access.texture);
+				auto attachment = to_u32(std::distance(group.attachments.begin(), it));
+				if (it == group.attachments.end())
+				{
+					// Attachments are only stored if a later pass or the owner of an imported texture reads them
+					LoadStoreInfo load_store{};
+					load_store.load_op  = access.write ? access.load_op : VK_ATTACHMENT_LOAD_OP_LOAD;
+					load_store.store_op = texture.imported_view || texture.last_group > group_index ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+					group.attachments.push_back(access.texture);
+					group.load_store.push_back(load_store);
+					group.clear_values.push_back(access.clear_value);
+				}
+
+				switch (access.usage)
+				{
+					case RenderGraphTextureUsage::ColorAttachment:
+						subpass.output_attachments.push_back(attachment);
+						break;
+					case RenderGraphTextureUsage::DepthStencilAttachment:
+						subpass.disable_depth_stencil_attachment = false;
+						break;
+					default:
+						subpass.input_attachments.push_back(attachment);
+						break;
+				}
+			}
+
+			if (auto *group_access = get_access(true, access.texture))
+			{
+				// The render pass transitions attachments between subpasses, other textures keep a single layout
+				if (!is_attachment(access.usage) && group_access->layout != scope.layout)
+				{
+					throw std::runtime_error(fmt::format("Pass {} accesses {} in two layouts", pass.name, texture.name));
+				}
+				group_access->stages |= scope.stages;
+				group_access->access |= scope.access;
+				group_access->write |= access.write;
+				continue;
+			}
+
+			GroupAccess group_access{};
+			group_access.texture      = true;
+			group_access.index        = access.texture;
+			group_access.layout       = scope.layout;
+			group_access.stages       = scope.stages;
+			group_access.access       = scope.access;
+			group_access.write        = access.write;
+			group_access.discard      = !texture.imported_view && texture.first_group == group_index;
+			group_access.final_layout = scope.layout;
+			group.accesses.push_back(group_access);
+		}
+
+		for (auto &access : pass.buffers)
+		{
+			auto scope = get_buffer_scope(access.usage, access.write, pass.type);
+
+			if (auto *group_access = get_access(false, access.buffer))
+			{
+				group_access->stages |= scope.stages;
+				group_access->access |= scope.access;
+				group_access->write |= access.write;
+				continue;
+			}
+
+			GroupAccess group_access{};
+			group_access.texture      = false;
+			group_access.index        = access.buffer;
+			group_access.layout       = VK_IMAGE_LAYOUT_UNDEFINED;
+			group_access.stages       = scope.stages;
+			group_access.access       = scope.access;
+			group_access.write        = access.write;
+			group_access.discard      = false;
+			group_access.final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			group.accesses.push_back(group_access);
+		}
+
+		if (group.render_pass)
+		{
+			group.subpasses.push_back(std::move(subpass));
+		}
+	}
+
+	if (!group.render_pass)
+	{
+		return;
+	}
+
+	// As RenderPass does, attachments end in the layout of the last subpass referencing them, an input attachment
+	// taking precedence, and in their attachment layout otherwise
+	auto &last_pass = passes[group.passes.back()];
+	for (auto texture_index : group.attachments)
+	{
+		auto &texture = textures[texture_index];
+		auto &access  = *get_access(true, texture_index);
+
+		access.final_layout = is_depth_format(texture.desc.format) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		for (auto &last_access : last_pass.textures)
+		{
+			if (last_access.texture == texture_index && last_access.usage == RenderGraphTextureUsage::InputAttachment)
+			{
+				access.final_layout = get_texture_scope(last_access.usage, false, last_access.load_op, last_pass.type, texture.desc.format).layout;
+			}
+		}
+	}
+}
+
+void RenderGraph::retire_resources()
+{
+	if (groups.empty() && images.empty() && memory_blocks.empty())
+	{
+		return;
+	}
+
+	// The framebuffers are destroyed before the views they reference, and the views before the memory of the images
+	auto &deferred_destruction_queue = device.get_deferred_destruction_queue();
+	deferred_destruction_queue.retire(std::move(groups));
+	deferred_destruction_queue.retire(std::move(images));
+	deferred_destruction_queue.retire(std::move(memory_blocks));
+
+	groups.clear();
+	images.clear();
+	memory_blocks.clear();
+}
+
+RenderGraph::GroupFramebuffer &RenderGraph::get_framebuffer(Group &group)
+{
+	size_t key = 0;
+	for (auto texture_index : group.attachments)
+	{
+		hash_combine(key, get_view({texture_index}).get_handle());
+	}
+
+	auto it = group.framebuffers.find(key);
+	if (it != group.framebuffers.end())
+	{
+		return it->second;
+	}
+
+	// A render target owns its views, they are created over the images the passes access
+	std::vector<core::ImageView> views;
+	views.reserve(group.attachments.size());
+	for (auto texture_index : group.attachments)
+	{
+		auto &view  = get_view({texture_index});
+		auto  range = view.get_subresource_range();
+		views.emplace_back(const_cast<core::Image &>(view.get_image()), VK_IMAGE_VIEW_TYPE_2D, view.get_format(),
+		                   range.baseMipLevel, range.baseArrayLayer, range.levelCount, range.layerCount);
+	}
+
+	GroupFramebuffer framebuffer{};
+	framebuffer.render_target = std::make_unique<RenderTarget>(std::move(views));
+	framebuffer.render_pass   = &device.get_resource_cache().RequestRenderPass(framebuffer.render_target->get_attachments(), group.load_store, group.subpasses);
+	framebuffer.framebuffer   = std::make_unique<Framebuffer>(device, *framebuffer.render_target, *framebuffer.render_pass);
+
+	return group.framebuffers.emplace(key, std::move(framebuffer)).first->second;
+}
+
+void RenderGraph::wait_for_previous_occupant(uint32_t texture_index, ResourceState &state)
+{
+	auto memory = images[textures[texture_index].image].memory;
+	if (memory == ~0U)
+	{
+		return;
+	}
+
+	auto &block = *memory_blocks[memory];
+	if (block.occupant != ~0U && block.occupant != texture_index)
+	{
+		// The image of the previous texture overwrote the memory, this image waits for it and restarts undefined
+		auto &previous = get_state(true, block.occupant);
+
+		state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		state.write_stages |= previous.write_stages | previous.read_stages;
+		state.write_access |= previous.write_access;
+	}
+	block.occupant = texture_index;
+}
+
+RenderGraph::ResourceState &RenderGraph::get_state(bool texture, uint32_t index)
+{
+	if (!texture)
+	{
+		return buffers[index].state;
+	}
+
+	auto &resource = textures[index];
+	return resource.imported_view ? resource.state : images[resource.image].state;
+}
+
+void RenderGraph::synchronize(bool texture, uint32_t index, VkImageLayout layout, VkPipelineStageFlags2KHR stages, VkAccessFlags2KHR access, bool write, bool discard)
+{
+	auto &state = get_state(texture, index);
+
+	if (texture && discard)
+	{
+		wait_for_previous_occupant(index, state);
+	}
+
+	VkImageLayout old_layout = state.layout;
+	bool          transition = texture && layout != old_layout;
+
+	VkPipelineStageFlags2KHR src_stages = state.write_stages;
+	VkAccessFlags2KHR        src_access = state.write_access;
+
+	if (!write && !transition)
+	{
+		// A read only waits for the last write, once per stage and access
+		bool visible = (stages & ~state.visible_stages) == 0 && (access & ~state.visible_access) == 0;
+
+		state.read_stages |= stages;
+		if (state.write_stages == VK_PIPELINE_STAGE_2_NONE_KHR || visible)
+		{
+			return;
+		}
+
+		state.visible_stages |= stages;
+		state.visible_access |= access;
+	}
+	else
+	{
+		// A write or a layout transition also waits for the reads since the last write
+		src_stages |= state.read_stages;
+
+		state.write_stages   = stages;
+		state.write_access   = write ? access & write_access_mask : VK_ACCESS_2_NONE_KHR;
+		state.read_stages    = VK_PIPELINE_STAGE_2_NONE_KHR;
+		state.visible_stages = write ? VK_PIPELINE_STAGE_2_NONE_KHR : stages;
+		state.visible_access = write ? VK_ACCESS_2_NONE_KHR : access;
+
+		if (transition)
+		{
+			state.layout = layout;
+		}
+		else if (src_stages == VK_PIPELINE_STAGE_2_NONE_KHR)
+		{
+			return;
+		}
+
+		if (discard)
+		{
+			old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		}
+	}
+
+	if (!texture)
+	{
+		VkBufferMemoryBarrier2KHR barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR};
+		barrier.srcStageMask        = src_stages;
+		barrier.srcAccessMask       = src_access;
+		barrier.dstStageMask        = stages;
+		barrier.dstAccessMask       = access;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer              = buffers[index].buffer->get_handle();
+		barrier.offset              = 0;
+		barrier.size                = VK_WHOLE_SIZE;
+		buffer_barriers.push_back(barrier);
+		return;
+	}
+
+	auto &view = get_view({index});
+
+	VkImageMemoryBarrier2KHR barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR};
+	barrier.srcStageMask        = src_stages;
+	barrier.srcAccessMask       = src_access;
+	barrier.dstStageMask        = stages;
+	barrier.dstAccessMask       = access;
+	barrier.oldLayout           = old_layout;
+	barrier.newLayout           = state.layout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image               = view.get_image().get_handle();
+	barrier.subresourceRange    = get_barrier_range(view);
+	image_barriers.push_back(barrier);
+}
+
+void RenderGraph::flush_barriers(CommandBuffer &command_buffer)
+{
+	if (image_barriers.empty() && buffer_barriers.empty())
+	{
+		return;
+	}
+
+	// The graph only uses stages and accesses of synchronization1, so they can be recorded without synchronization2
+	core::record_pipeline_barrier(command_buffer.get_handle(), synchronization2, image_barriers, buffer_barriers);
+
+	++barrier_count;
+	image_barriers.clear();
+	buffer_barriers.clear();
+}
+
+const VkExtent2D &RenderGraph::get_extent(uint32_t texture) const
+{
+	return textures[texture].desc.extent;
+}
+}        // namespace vkb
@@ -0,0 +1,545 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/buffer.h"
+#include "core/render_pass.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class Device;
+class Framebuffer;
+class RenderTarget;
+
+namespace core
+{
+class Image;
+class ImageView;
+}        // namespace core
+
+/// Handle to a texture declared in a RenderGraph
+struct RenderGraphTexture
+{
+	uint32_t index{~0U};
+
+	bool is_valid() const
+	{
+		return index != ~0U;
+	}
+};
+
+/// Handle to a buffer imported in a RenderGraph
+struct RenderGraphBuffer
+{
+	uint32_t index{~0U};
+
+	bool is_valid() const
+	{
+		return index != ~0U;
+	}
+};
+
+enum class RenderGraphPassType
+{
+	/// Draws into its attachments in a render pass begun by the graph, consecutive passes can become subpasses of one render pass
+	Graphics,
+
+	/// Records dispatches outside of render passes
+	Compute,
+
+	/// Records copies, blits and clears outside of render passes
+	Transfer,
+
+	/// Records render passes of its own, e.g. by drawing a RenderPipeline or a PostProcessingPipeline
+	External
+};
+
+enum class RenderGraphTextureUsage
+{
+	ColorAttachment,
+	DepthStencilAttachment,
+	InputAttachment,
+	Sampled,
+	Storage,
+	TransferSrc,
+	TransferDst
+};
+
+enum class RenderGraphBufferUsage
+{
+	Vertex,
+	Index,
+	Indirect,
+	Uniform,
+	Storage,
+	TransferSrc,
+	TransferDst
+};
+
+/**
+ * @brief How a resource is used outside of the graph, before or after its passes
+ */
+struct RenderGraphResourceState
+{
+	VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+	VkPipelineStageFlags2KHR stages{VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR};
+
+	VkAccessFlags2KHR access{VK_ACCESS_2_MEMORY_WRITE_BIT_KHR};
+};
+
+/**
+ * @brief Description of a texture created by the graph
+ */
+struct RenderGraphTextureDesc
+{
+	VkExtent2D extent{};
+
+	VkFormat format{VK_FORMAT_UNDEFINED};
+
+	VkSampleCountFlagBits samples{VK_SAMPLE_COUNT_1_BIT};
+};
+
+/**
+ * @brief Schedules the passes of a frame from the resources they declare to read and write
+ *
+ * Passes are declared in submission order, with the textures and buffers they access and how.
+ * On compile() the graph:
+ * - culls the passes whose writes are never read, by the passes kept or outside of the graph
+ * - merges consecutive graphics passes into subpasses of one render pass, when each of them
+ *   only depends on the previous ones through their attachments
+ * - makes the attachments living in a single render pass transient, backed by lazily allocated
+ *   memory on tilers, and binds the images of the other textures created by the graph to shared
+ *   memory blocks when their lifetimes don't overlap
+ * - stores the attachments at the end of a render pass only if they are read afterwards
+ *
+ * On execute() it records the passes, preceding each render pass or pass outside of one by a single
+ * pipeline barrier holding every transition its resources need. The state of each image is tracked
+ * across passes and frames, so a barrier is only recorded when an access needs one.
+ *
+ * A graph records to a single queue. Imported resources are in their initial state when execute()
+ * is called and are left in their final state. The Render graph technique of the Subpasses sample
+ * draws its deferred renderer through a graph.
+ */
+class RenderGraph
+{
+  public:
+	using ExecuteFunc = std::function<void(CommandBuffer &command_buffer)>;
+
+	/**
+	 * @brief Declares the accesses of a pass
+	 */
+	class PassBuilder
+	{
+	  public:
+		/**
+		 * @param load_op How the attachment starts, VK_ATTACHMENT_LOAD_OP_LOAD reads the writes of the previous passes
+		 */
+		PassBuilder &write_color(RenderGraphTexture texture, VkAttachmentLoadOp load_op = VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearValue clear_value = {});
+
+		/**
+		 * @param clear_value Defaults to a depth of 0, as the framework renders with a reversed depth
+		 */
+		PassBuilder &write_depth_stencil(RenderGraphTexture texture, VkAttachmentLoadOp load_op = VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearValue clear_value = {});
+
+		/**
+		 * @brief Reads the texture at the same pixel as the previous pass wrote it, the passes can then be merged
+		 */
+		PassBuilder &read_input_attachment(RenderGraphTexture texture);
+
+		PassBuilder &read_texture(RenderGraphTexture texture, RenderGraphTextureUsage usage = RenderGraphTextureUsage::Sampled);
+
+		PassBuilder &write_texture(RenderGraphTexture texture, RenderGraphTextureUsage usage = RenderGraphTextureUsage::Storage);
+
+		PassBuilder &read_buffer(RenderGraphBuffer buffer, RenderGraphBufferUsage usage);
+
+		PassBuilder &write_buffer(RenderGraphBuffer buffer, RenderGraphBufferUsage usage = RenderGraphBufferUsage::Storage);
+
+		/**
+		 * @brief Sets the function recording the commands of the pass
+		 *        Graphics passes record into the subpass the graph has begun.
+		 */
+		PassBuilder &set_execute(ExecuteFunc &&execute);
+
+		/**
+		 * @brief Keeps the pass even if nothing reads its writes, e.g. a pass reading back to the host
+		 */
+		PassBuilder &set_side_effect();
+
+	  private:
+		friend class RenderGraph;
+
+		PassBuilder(RenderGraph &graph, uint32_t pass_index);
+
+		PassBuilder &add_texture_access(RenderGraphTexture texture, RenderGraphTextureUsage usage, bool write, VkAttachmentLoadOp load_op, VkClearValue clear_value);
+
+		RenderGraph &graph;
+
+		uint32_t pass_index;
+	};
+
+	explicit RenderGraph(Device &device);
+
+	RenderGraph(const RenderGraph &) = delete;
+
+	RenderGraph(RenderGraph &&) = delete;
+
+	/**
+	 * @brief Retires the resources created by the graph to the deferred destruction queue of the device
+	 */
+	~RenderGraph();
+
+	RenderGraph &operator=(const RenderGraph &) = delete;
+
+	RenderGraph &operator=(RenderGraph &&) = delete;
+
+	/**
+	 * @brief Declares a texture created by the graph, its content doesn't outlive a frame
+	 */
+	RenderGraphTexture create_texture(const std::string &name, const RenderGraphTextureDesc &desc);
+
+	/**
+	 * @brief Declares a texture owned outside of the graph
+	 * @param view The view the passes access, can be changed for each frame with bind_texture()
+	 * @param initial_state State of the texture when the graph is executed
+	 * @param final_state State the graph leaves the texture in, its layout is kept if undefined
+	 */
+	RenderGraphTexture import_texture(const std::string &name, const core::ImageView &view,
+	                                  const RenderGraphResourceState &initial_state = {},
+	                                  const RenderGraphResourceState &final_state   = {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE_KHR, VK_ACCESS_2_NONE_KHR});
+
+	RenderGraphBuffer import_buffer(const std::string &name, const core::BufferC &buffer, const RenderGraphResourceState &initial_state = {});
+
+	/**
+	 * @brief Changes the view of an imported texture, e.g. to the swapchain image of the frame
+	 *        The view must have the extent and format of the one it was imported with.
+	 */
+	void bind_texture(RenderGraphTexture texture, const core::ImageView &view);
+
+	PassBuilder add_pass(const std::string &name, RenderGraphPassType type = RenderGraphPassType::Graphics);
+
+	/**
+	 * @brief Culls and merges the passes, and creates the textures of the graph
+	 *        The previous resources are retired, so the graph can be compiled again while frames are in flight.
+	 */
+	void compile();
+
+	/**
+	 * @brief Records the passes kept by the last compile()
+	 */
+	void execute(CommandBuffer &command_buffer);
+
+	/**
+	 * @return The view a pass accesses a texture through
+	 */
+	const core::ImageView &get_view(RenderGraphTexture texture) const;
+
+	/**
+	 * @return Number of passes culled by the last compile()
+	 */
+	uint32_t get_culled_pass_count() const;
+
+	/**
+	 * @return Number of render passes the graphics passes were merged into by the last compile()
+	 */
+	uint32_t get_render_pass_count() const;
+
+	/**
+	 * @return Size of the memory the images of the textures created by the graph alias,
+	 *         the transient attachments backed by lazily allocated memory aren't included
+	 */
+	VkDeviceSize get_memory_size() const;
+
+	/**
+	 * @return Number of pipeline barriers recorded by the last execute()
+	 */
+	uint32_t get_barrier_count() const;
+
+  private:
+	struct TextureAccess
+	{
+		uint32_t texture;
+
+		RenderGraphTextureUsage usage;
+
+		bool write;
+
+		VkAttachmentLoadOp load_op;
+
+		VkClearValue clear_value;
+	};
+
+	struct BufferAccess
+	{
+		uint32_t buffer;
+
+		RenderGraphBufferUsage usage;
+
+		bool write;
+	};
+
+	struct Pass
+	{
+		std::string name;
+
+		RenderGraphPassType type;
+
+		std::vector<TextureAccess> textures;
+
+		std::vector<BufferAccess> buffers;
+
+		ExecuteFunc execute;
+
+		bool side_effect{false};
+	};
+
+	/**
+	 * @brief Synchronization state of a resource between the accesses of the passes
+	 */
+	struct ResourceState
+	{
+		VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+
+		/// Stages of the last write or layout transition, and the accesses it wrote with
+		VkPipelineStageFlags2KHR write_stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+		VkAccessFlags2KHR write_access{VK_ACCESS_2_NONE_KHR};
+
+		/// Stages reading the resource since the last write, a later write waits for them
+		VkPipelineStageFlags2KHR read_stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+		/// Stages and accesses the last write was made visible to
+		VkPipelineStageFlags2KHR visible_stages{VK_PIPELINE_STAGE_2_NONE_KHR};
+
+		VkAccessFlags2KHR visible_access{VK_ACCESS_2_NONE_KHR};
+	};
+
+	struct TextureResource
+	{
+		std::string name;
+
+		RenderGraphTextureDesc desc;
+
+		VkImageUsageFlags usage{0};
+
+		/// The view of an imported texture, null for the textures created by the graph
+		const core::ImageView *imported_view{nullptr};
+
+		RenderGraphResourceState initial_state;
+
+		RenderGraphResourceState final_state;
+
+		/// Index of the image of a texture created by the graph
+		uint32_t image{~0U};
+
+		/// Whether the texture only lives in the attachments of a render pass, and never needs memory
+		bool transient{false};
+
+		uint32_t first_group{~0U};
+
+		uint32_t last_group{0};
+
+		ResourceState state;
+	};
+
+	struct BufferResource
+	{
+		std::string name;
+
+		const core::BufferC *buffer;
+
+		RenderGraphResourceState initial_state;
+
+		ResourceState state;
+	};
+
+	/**
+	 * @brief The image of a texture created by the graph
+	 */
+	struct GraphImage
+	{
+		std::unique_ptr<core::Image> image;
+
+		std::unique_ptr<core::ImageView> view;
+
+		/// The memory block the image is bound to, the image has its own allocation if none
+		uint32_t memory{~0U};
+
+		ResourceState state;
+	};
+
+	/**
+	 * @brief Memory shared by the images of the textures whose lifetimes don't overlap
+	 */
+	struct MemoryBlock
+	{
+		MemoryBlock(Device &device);
+
+		MemoryBlock(const MemoryBlock &) = delete;
+
+		/**
+		 * @brief Destroys the images bound to the block, then frees it
+		 */
+		~MemoryBlock();
+
+		MemoryBlock &operator=(const MemoryBlock &) = delete;
+
+		Device &device;
+
+		VkMemoryRequirements requirements{};
+
+		VmaAllocation allocation{VK_NULL_HANDLE};
+
+		std::vector<VkImage> images;
+
+		/// Last group the textures assigned so far access the block in
+		uint32_t last_group{0};
+
+		/// Texture whose image last accessed the block, the next image waits for it
+		uint32_t occupant{~0U};
+	};
+
+	/**
+	 * @brief Access of a group to a resource, synchronized before the group is recorded
+	 */
+	struct GroupAccess
+	{
+		bool texture;
+
+		uint32_t index;
+
+		VkImageLayout layout;
+
+		VkPipelineStageFlags2KHR stages;
+
+		VkAccessFlags2KHR access;
+
+		bool write;
+
+		/// Whether the content of the texture is undefined before the access
+		bool discard;
+
+		/// Layout the render pass leaves an attachment in
+		VkImageLayout final_layout;
+	};
+
+	struct GroupFramebuffer
+	{
+		std::unique_ptr<RenderTarget> render_target;
+
+		RenderPass *render_pass{nullptr};
+
+		std::unique_ptr<Framebuffer> framebuffer;
+	};
+
+	/**
+	 * @brief Passes recorded behind the same barrier, the subpasses of a render pass or a single pass outside of one
+	 */
+	struct Group
+	{
+		std::vector<uint32_t> passes;
+
+		bool render_pass{false};
+
+		std::vector<GroupAccess> accesses;
+
+		/// Textures attached to the render pass, in the order of the attachments
+		std::vector<uint32_t> attachments;
+
+		std::vector<LoadStoreInfo> load_store;
+
+		std::vector<VkClearValue> clear_values;
+
+		std::vector<SubpassInfo> subpasses;
+
+		/// Framebuffers of the views the attachments were bound to, the imported views can change for each frame
+		std::unordered_map<size_t, GroupFramebuffer> framebuffers;
+	};
+
+	/**
+	 * @return Whether a pass can become the next subpass of the render pass of a group
+	 */
+	bool can_merge(const Group &group, const Pass &pass) const;
+
+	void cull_passes(std::vector<uint32_t> &kept_passes) const;
+
+	void create_groups(const std::vector<uint32_t> &kept_passes);
+
+	void create_images();
+
+	/**
+	 * @brief Binds the images of the textures to memory blocks, the textures alive at the same time to different blocks
+	 */
+	void alias_images(const std::vector<uint32_t> &aliased_textures);
+
+	void init_group(Group &group, uint32_t group_index);
+
+	void retire_resources();
+
+	GroupFramebuffer &get_framebuffer(Group &group);
+
+	ResourceState &get_state(bool texture, uint32_t index);
+
+	/**
+	 * @brief Makes the first access of a texture in a frame wait for the image which used its memory before
+	 */
+	void wait_for_previous_occupant(uint32_t texture_index, ResourceState &state);
+
+	/**
+	 * @brief Updates the state of a resource for an access, adding the barrier it needs
+	 */
+	void synchronize(bool texture, uint32_t index, VkImageLayout layout, VkPipelineStageFlags2KHR stages, VkAccessFlags2KHR access, bool write, bool discard);
+
+	void flush_barriers(CommandBuffer &command_buffer);
+
+	const VkExtent2D &get_extent(uint32_t texture) const;
+
+	Device &device;
+
+	bool synchronization2{false};
+
+	std::vector<TextureResource> textures;
+
+	std::vector<BufferResource> buffers;
+
+	std::vector<Pass> passes;
+
+	std::vector<GraphImage> images;
+
+	std::vector<std::unique_ptr<MemoryBlock>> memory_blocks;
+
+	std::vector<Group> groups;
+
+	uint32_t culled_pass_count{0};
+
+	uint32_t barrier_count{0};
+
+	std::vector<VkImageMemoryBarrier2KHR> image_barriers;
+
+	std::vector<VkBufferMemoryBarrier2KHR> buffer_barriers;
+};
+}        // namespace vkb
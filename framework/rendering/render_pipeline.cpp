@@ -17,6 +17,11 @@
 
 #include "render_pipeline.h"
 
+#include "common/gpu_profiling.h"
+#include "common/strings.h"
+#include "core/device.h"
+#include "rendering/render_context.h"
+
 #include "scene_graph/components/camera.h"
 #include "scene_graph/components/image.h"
 #include "scene_graph/components/material.h"
@@ -47,8 +52,15 @@ RenderPipeline::RenderPipeline(std::vector<std::unique_ptr<vkb::rendering::Subpa
 	clear_value[1].depthStencil = {0.0f, ~0U};
 }
 
+RenderPipeline::~RenderPipeline()
+{
+	invalidate_static_commands();
+}
+
 void RenderPipeline::prepare()
 {
+	invalidate_static_commands();
+
 	for (auto &subpass : subpasses)
 	{
 		subpass->prepare();
@@ -73,7 +85,97 @@ const std::vector<LoadStoreInfo> &RenderPipeline::get_load_store() const
 
 void RenderPipeline::set_load_store(const std::vector<LoadStoreInfo> &ls)
 {
-	load_store = ls;
+	load_store          = ls;
+	explicit_load_store = true;
+	load_store_checked  = false;
+}
+
+void RenderPipeline::reset_load_store()
+{
+	explicit_load_store = false;
+}
+
+std::vector<LoadStoreInfo> RenderPipeline::infer_load_store(const RenderTarget &render_target) const
+{
+	auto &attachments = render_target.get_attachments();
+
+	// Attachments no subpass uses are left untouched
+	std::vector<LoadStoreInfo> load_stores(attachments.size(), {VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE});
+	std::vector<bool>          used(attachments.size(), false);
+
+	auto depth_it         = std::find_if(attachments.begin(), attachments.end(), [](const Attachment &attachment) { return is_depth_format(attachment.format); });
+	auto depth_attachment = depth_it == attachments.end() ? VK_ATTACHMENT_UNUSED : to_u32(std::distance(attachments.begin(), depth_it));
+
+	// The content of previous passes is only needed by the attachments read before they are written
+	auto use = [&](uint32_t attachment, VkAttachmentLoadOp load_op) {
+		if (attachment < attachments.size() && !used[attachment])
+		{
+			used[attachment]                = true;
+			load_stores[attachment].load_op = load_op;
+		}
+	};
+
+	for (auto &subpass : subpasses)
+	{
+		for (auto attachment : subpass->get_input_attachments())
+		{
+			use(attachment, VK_ATTACHMENT_LOAD_OP_LOAD);
+		}
+
+		for (auto attachment : subpass->get_output_attachments())
+		{
+			use(attachment, VK_ATTACHMENT_LOAD_OP_CLEAR);
+		}
+
+		// Resolves overwrite their attachments
+		for (auto attachment : subpass->get_color_resolve_attachments())
+		{
+			use(attachment, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+		}
+
+		if (!subpass->get_disable_depth_stencil_attachment())
+		{
+			use(depth_attachment, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+			if (subpass->get_depth_stencil_resolve_mode() != VK_RESOLVE_MODE_NONE)
+			{
+				use(subpass->get_depth_stencil_resolve_attachment(), VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+			}
+		}
+	}
+
+	// Transient attachments can't be consumed after the render pass, the others may be presented or read by the next passes
+	for (size_t i = 0; i < attachments.size(); ++i)
+	{
+		if (used[i] && !(attachments[i].usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT))
+		{
+			load_stores[i].store_op = VK_ATTACHMENT_STORE_OP_STORE;
+		}
+	}
+
+	return load_stores;
+}
+
+void RenderPipeline::check_load_store(const std::vector<LoadStoreInfo> &inferred_load_store)
+{
+	load_store_checked = true;
+
+	for (size_t i = 0; i < std::min(load_store.size(), inferred_load_store.size()); ++i)
+	{
+		auto &explicit_ops = load_store[i];
+		auto &inferred_ops = inferred_load_store[i];
+
+		// Loading what is overwritten or cleared, or storing what nothing consumes, costs bandwidth
+		if (explicit_ops.load_op == VK_ATTACHMENT_LOAD_OP_LOAD && inferred_ops.load_op != VK_ATTACHMENT_LOAD_OP_LOAD)
+		{
+			LOGW("Render pipeline loads attachment {} which its subpasses write first, {} would avoid reading it", i, to_string(inferred_ops.load_op));
+		}
+
+		if (explicit_ops.store_op == VK_ATTACHMENT_STORE_OP_STORE && inferred_ops.store_op == VK_ATTACHMENT_STORE_OP_DONT_CARE)
+		{
+			LOGW("Render pipeline stores attachment {} which can't be consumed after the render pass, {} would avoid writing it", i, to_string(inferred_ops.store_op));
+		}
+	}
 }
 
 const std::vector<VkClearValue> &RenderPipeline::get_clear_value() const
@@ -96,30 +198,121 @@ void RenderPipeline::draw(CommandBuffer &command_buffer, RenderTarget &render_ta
 		clear_value.push_back({0.0f, 0.0f, 0.0f, 1.0f});
 	}
 
+	auto load_stores = explicit_load_store ? load_store : infer_load_store(render_target);
+
+#ifdef VKB_DEBUG
+	if (explicit_load_store && !load_store_checked)
+	{
+		check_load_store(infer_load_store(render_target));
+	}
+#endif
+
+	// The multisampled attachments are cleared as the attachments they are resolved into, which the resolves overwrite
+	auto sample_count = render_target.get_sample_count();
+	auto clear_values = clear_value;
+	if (sample_count != VK_SAMPLE_COUNT_1_BIT)
+	{
+		load_stores.resize(render_target.get_attachments().size());
+		for (uint32_t i = 0; i < load_stores.size(); ++i)
+		{
+			auto multisampled_attachment = render_target.get_multisampled_attachment(i);
+			if (multisampled_attachment != VK_ATTACHMENT_UNUSED)
+			{
+				load_stores[multisampled_attachment].load_op  = load_stores[i].load_op;
+				load_stores[multisampled_attachment].store_op = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				clear_values[multisampled_attachment]         = clear_value[i];
+				load_stores[i].load_op                        = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			}
+		}
+
+		auto depth_stencil_resolve_attachment = render_target.get_depth_stencil_resolve_attachment();
+		if (depth_stencil_resolve_attachment != VK_ATTACHMENT_UNUSED)
+		{
+			load_stores[depth_stencil_resolve_attachment].load_op  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			load_stores[depth_stencil_resolve_attachment].store_op = VK_ATTACHMENT_STORE_OP_STORE;
+		}
+
+		// The subpasses rasterize at the sample count of the attachments they render into
+		for (auto &subpass : subpasses)
+		{
+			subpass->set_sample_count(sample_count);
+		}
+	}
+
+	for (auto &subpass : subpasses)
+	{
+		subpass->draw_before_render_pass(command_buffer);
+	}
+
 	for (size_t i = 0; i < subpasses.size(); ++i)
 	{
 		active_subpass_index = i;
 
-		auto &subpass = subpasses[i];
+		auto &subpass        = subpasses[i];
+		auto &render_context = subpass->get_render_context();
 
 		subpass->update_render_target_attachments(render_target);
 
+		// The descriptor sets of the other strategies don't outlive the frame, static subpasses are then recorded every frame
+		bool static_contents = subpass->is_static() &&
+		                       render_context.get_active_frame().GetDescriptorManagementStrategy() == DescriptorManagementStrategy::StoreInCache;
+
+		VkSubpassContents subpass_contents = contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS || static_contents ?
+		                                         VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS :
+		                                         subpass->get_subpass_contents();
+
 		if (i == 0)
 		{
-			command_buffer.begin_render_pass(render_target, load_store, clear_value, subpasses, contents);
+			command_buffer.begin_render_pass(render_target, load_stores, clear_values, subpasses, subpass_contents);
 		}
 		else
 		{
-			command_buffer.next_subpass();
+			command_buffer.next_subpass(subpass_contents);
+		}
+
+		// The subpasses using the shading rate attachment take its rates instead of the one of their pipelines
+		FragmentShadingRateState fragment_shading_rate_state{};
+		if (render_target.get_shading_rate_view())
+		{
+			if (subpass->get_use_shading_rate_attachment())
+			{
+				fragment_shading_rate_state.combiner_ops[1] = VK_FRAGMENT_SHADING_RATE_COMBINER_OP_REPLACE_KHR;
+			}
+			command_buffer.set_fragment_shading_rate_state(fragment_shading_rate_state);
 		}
 
+		last_subpass_contents = subpass_contents;
+
 		if (subpass->get_debug_name().empty())
 		{
 			subpass->set_debug_name(fmt::format("RP subpass #{}", i));
 		}
 		ScopedDebugLabel subpass_debug_label{command_buffer, subpass->get_debug_name().c_str()};
 
-		subpass->draw(command_buffer);
+		// Timestamps can only be written in the subpasses recorded inline
+		bool inline_contents = subpass_contents == VK_SUBPASS_CONTENTS_INLINE;
+		PROFILE_GPU_SCOPE_DYNAMIC(command_buffer.get_handle(), subpass->get_debug_name().c_str(), inline_contents);
+
+		auto    *gpu_frame_timer = inline_contents ? render_context.get_gpu_frame_timer() : nullptr;
+		uint32_t timed_pass      = GpuFrameTimer::MaxPasses;
+		if (gpu_frame_timer)
+		{
+			timed_pass = gpu_frame_timer->begin_pass(command_buffer.get_handle(), render_context.get_active_frame_index(), subpass->get_debug_name());
+		}
+
+		if (static_contents)
+		{
+			command_buffer.execute_commands(request_static_commands(command_buffer, *subpass, render_target.get_shading_rate_view() ? &fragment_shading_rate_state : nullptr));
+		}
+		else
+		{
+			subpass->draw(command_buffer);
+		}
+
+		if (gpu_frame_timer)
+		{
+			gpu_frame_timer->end_pass(command_buffer.get_handle(), render_context.get_active_frame_index(), timed_pass);
+		}
 	}
 
 	active_subpass_index = 0;
@@ -129,4 +322,82 @@ std::unique_ptr<vkb::rendering::SubpassC> &RenderPipeline::get_active_subpass()
 {
 	return subpasses[active_subpass_index];
 }
+
+VkSubpassContents RenderPipeline::get_last_subpass_contents() const
+{
+	return last_subpass_contents;
+}
+
+void RenderPipeline::invalidate_static_commands()
+{
+	static_commands.clear();
+
+	for (auto &command_pool : static_command_pools)
+	{
+		if (command_pool)
+		{
+			// Frames in flight may still execute the commands
+			auto &deferred_destruction_queue = command_pool->get_device().get_deferred_destruction_queue();
+			deferred_destruction_queue.retire(std::move(command_pool));
+		}
+	}
+	static_command_pools.clear();
+}
+
+CommandBuffer &RenderPipeline::request_static_commands(CommandBuffer &primary_command_buffer, vkb::rendering::SubpassC &subpass, const FragmentShadingRateState *fragment_shading_rate_state)
+{
+	auto &device         = primary_command_buffer.get_device();
+	auto &render_context = subpass.get_render_context();
+
+	// The pipelines, framebuffers or descriptor sets the commands use may be gone
+	auto generation = device.get_resource_cache().GetGeneration();
+	if (generation != static_commands_generation)
+	{
+		invalidate_static_commands();
+		static_commands_generation = generation;
+	}
+
+	auto &render_pass_binding = primary_command_buffer.get_current_render_pass();
+	assert(render_pass_binding.render_pass && "Static subpasses must be recorded in a render pass");
+
+	uint32_t frame_index = render_context.get_active_frame_index();
+
+	auto it = std::find_if(static_commands.begin(), static_commands.end(), [&](const StaticCommands &commands) {
+		return commands.subpass == &subpass && commands.render_pass == render_pass_binding.render_pass &&
+		       commands.framebuffer == render_pass_binding.framebuffer && commands.frame_index == frame_index;
+	});
+	if (it != static_commands.end())
+	{
+		return *it->command_buffer;
+	}
+
+	if (static_command_pools.size() <= frame_index)
+	{
+		static_command_pools.resize(frame_index + 1);
+	}
+
+	// The descriptor sets are requested from the pools of the frame, the command buffers are only reset with their pool
+	auto &command_pool = static_command_pools[frame_index];
+	if (!command_pool)
+	{
+		auto &queue  = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+		command_pool = std::make_unique<CommandPool>(device, queue.get_family_index(), &render_context.get_active_frame(), 0, CommandBuffer::ResetMode::ResetIndividually);
+	}
+
+	auto &secondary_command_buffer = command_pool->request_command_buffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+	secondary_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &primary_command_buffer);
+
+	if (fragment_shading_rate_state)
+	{
+		secondary_command_buffer.set_fragment_shading_rate_state(*fragment_shading_rate_state);
+	}
+
+	subpass.draw(secondary_command_buffer);
+
+	secondary_command_buffer.end();
+
+	static_commands.push_back({&subpass, render_pass_binding.render_pass, render_pass_binding.framebuffer, frame_index, &secondary_command_buffer});
+
+	return secondary_command_buffer;
+}
 }        // namespace vkb
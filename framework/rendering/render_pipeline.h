@@ -20,6 +20,7 @@
 #include "common/helpers.h"
 #include "common/utils.h"
 #include "core/buffer.h"
+#include "core/command_pool.h"
 #include "rendering/RenderFrame.h"
 #include "rendering/subpass.h"
 
@@ -45,27 +46,48 @@ class RenderPipeline
 
 	RenderPipeline(RenderPipeline &&) = default;
 
-	virtual ~RenderPipeline() = default;
+	/**
+	 * @brief Retires the static commands, which frames in flight may still execute
+	 */
+	virtual ~RenderPipeline();
 
 	RenderPipeline &operator=(const RenderPipeline &) = delete;
 
 	RenderPipeline &operator=(RenderPipeline &&) = default;
 
 	/**
-	 * @brief Prepares the subpasses
+	 * @brief Prepares the subpasses, and drops the commands recorded for the static ones
 	 */
 	void prepare();
 
 	/**
-	 * @return Load store info
+	 * @return Load store info set with set_load_store(), the defaults of the swapchain and depth otherwise
 	 */
 	const std::vector<LoadStoreInfo> &get_load_store() const;
 
 	/**
+	 * @brief Sets the load store info of the attachments instead of inferring it
+	 *        Debug builds warn once when an attachment is loaded or stored where the inferred operations wouldn't.
 	 * @param load_store Load store info to set
 	 */
 	void set_load_store(const std::vector<LoadStoreInfo> &load_store);
 
+	/**
+	 * @brief Infers the load store info of the attachments again, as if set_load_store() wasn't called
+	 */
+	void reset_load_store();
+
+	/**
+	 * @brief Infers the load store info of the attachments of a render target from their use by the subpasses
+	 *
+	 * An attachment is cleared if a subpass writes it before any reads it as an input attachment, loaded otherwise,
+	 * and isn't loaded if it is first written by a resolve. It is stored if it isn't transient, so it may be presented
+	 * or read after the render pass, and the attachments no subpass uses are neither loaded nor stored.
+	 * Pipelines drawing over the content a previous render pass left in their attachments set their load ops with
+	 * set_load_store().
+	 */
+	std::vector<LoadStoreInfo> infer_load_store(const RenderTarget &render_target) const;
+
 	/**
 	 * @return Clear values
 	 */
@@ -86,6 +108,8 @@ class RenderPipeline
 
 	/**
 	 * @brief Record draw commands for each Subpass
+	 *        Each subpass begins with the contents it asks for, unless secondary
+	 *        command buffers are requested for the whole pipeline.
 	 */
 	void draw(CommandBuffer &command_buffer, RenderTarget &render_target, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 
@@ -95,15 +119,69 @@ class RenderPipeline
 	 */
 	std::unique_ptr<vkb::rendering::SubpassC> &get_active_subpass();
 
+	/**
+	 * @return Contents the last subpass was begun with by the latest draw,
+	 *         commands recorded after draw in the same subpass have to match them
+	 */
+	VkSubpassContents get_last_subpass_contents() const;
+
+	/**
+	 * @brief Drops the commands recorded for the static subpasses, see Subpass::set_static
+	 *        They are recorded again on their next draw, to be called when what they draw changes.
+	 */
+	void invalidate_static_commands();
+
   private:
+	/**
+	 * @brief Secondary command buffer a static subpass was recorded into
+	 */
+	struct StaticCommands
+	{
+		const vkb::rendering::SubpassC *subpass;
+
+		const RenderPass *render_pass;
+
+		const Framebuffer *framebuffer;
+
+		uint32_t frame_index;
+
+		CommandBuffer *command_buffer;
+	};
+
+	/**
+	 * @return The commands of a static subpass for the render pass and the frame being recorded, recorded on the first request
+	 */
+	CommandBuffer &request_static_commands(CommandBuffer &primary_command_buffer, vkb::rendering::SubpassC &subpass, const FragmentShadingRateState *fragment_shading_rate_state);
+
 	std::vector<std::unique_ptr<vkb::rendering::SubpassC>> subpasses;
 
+	/**
+	 * @brief Warns about the attachments the explicit load store info loads or stores needlessly
+	 */
+	void check_load_store(const std::vector<LoadStoreInfo> &inferred_load_store);
+
 	/// Default to two load store
 	std::vector<LoadStoreInfo> load_store = std::vector<LoadStoreInfo>(2);
 
+	/// Whether load_store was set explicitly, otherwise it is inferred for each render target drawn to
+	bool explicit_load_store{false};
+
+	/// Whether the explicit load_store was checked against the inferred one
+	bool load_store_checked{false};
+
 	/// Default to two clear values
 	std::vector<VkClearValue> clear_value = std::vector<VkClearValue>(2);
 
 	size_t active_subpass_index{0};
+
+	VkSubpassContents last_subpass_contents{VK_SUBPASS_CONTENTS_INLINE};
+
+	/// Pools the static commands are allocated from, by render frame, never reset while the commands are valid
+	std::vector<std::unique_ptr<CommandPool>> static_command_pools;
+
+	std::vector<StaticCommands> static_commands;
+
+	/// Generation of the resource cache the static commands were recorded at
+	uint64_t static_commands_generation{0};
 };
 }        // namespace vkb
@@ -53,6 +53,55 @@ const RenderTarget::CreateFunc RenderTarget::DEFAULT_CREATE_FUNC = [](core::Imag
 	return std::make_unique<RenderTarget>(std::move(images));
 };
 
+RenderTarget::CreateFunc RenderTarget::create_multisampled_func(VkSampleCountFlagBits samples, bool resolve_depth)
+{
+	return [samples, resolve_depth](core::Image &&swapchain_image) -> std::unique_ptr<RenderTarget> {
+		auto &device = swapchain_image.get_device();
+
+		if (resolve_depth && !device.is_enabled(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME))
+		{
+			throw VulkanException{VK_ERROR_EXTENSION_NOT_PRESENT, "Resolving the depth in the render pass needs VK_KHR_depth_stencil_resolve"};
+		}
+
+		VkFormat depth_format = get_suitable_depth_format(device.get_gpu().get_handle());
+
+		// Tilers resolve the samples from the tile memory, the multisampled attachments are never stored
+		core::Image depth_image{device, swapchain_image.get_extent(),
+		                        depth_format,
+		                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+		                        VMA_MEMORY_USAGE_GPU_ONLY,
+		                        samples};
+
+		core::Image color_image{device, swapchain_image.get_extent(),
+		                        swapchain_image.get_format(),
+		                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+		                        VMA_MEMORY_USAGE_GPU_ONLY,
+		                        samples};
+
+		std::vector<core::Image> images;
+		images.push_back(std::move(swapchain_image));
+		images.push_back(std::move(depth_image));
+		images.push_back(std::move(color_image));
+
+		if (resolve_depth)
+		{
+			images.emplace_back(device, images[0].get_extent(),
+			                    depth_format,
+			                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			                    VMA_MEMORY_USAGE_GPU_ONLY);
+		}
+
+		auto render_target = std::make_unique<RenderTarget>(std::move(images));
+		render_target->set_multisampled_attachment(0, 2);
+		if (resolve_depth)
+		{
+			render_target->set_depth_stencil_resolve(3, VK_RESOLVE_MODE_SAMPLE_ZERO_BIT);
+		}
+
+		return render_target;
+	};
+}
+
 vkb::RenderTarget::RenderTarget(std::vector<core::Image> &&images) :
     device{images.back().get_device()},
     images{std::move(images)}
@@ -165,4 +214,78 @@ VkImageLayout RenderTarget::get_layout(uint32_t attachment) const
 	return attachments[attachment].initial_layout;
 }
 
+void RenderTarget::set_shading_rate_view(const core::ImageView *view, const VkExtent2D &texel_size)
+{
+	if (view && !device.is_enabled(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME))
+	{
+		throw VulkanException{VK_ERROR_EXTENSION_NOT_PRESENT, "A shading rate attachment needs VK_KHR_fragment_shading_rate"};
+	}
+
+	shading_rate_view       = view;
+	shading_rate_texel_size = view ? texel_size : VkExtent2D{};
+}
+
+const core::ImageView *RenderTarget::get_shading_rate_view() const
+{
+	return shading_rate_view;
+}
+
+const VkExtent2D &RenderTarget::get_shading_rate_texel_size() const
+{
+	return shading_rate_texel_size;
+}
+
+uint32_t RenderTarget::get_shading_rate_attachment() const
+{
+	return shading_rate_view ? to_u32(views.size()) : VK_ATTACHMENT_UNUSED;
+}
+
+void RenderTarget::set_multisampled_attachment(uint32_t attachment, uint32_t multisampled_attachment)
+{
+	assert(attachment < attachments.size() && "Attachment index out of range");
+	assert((multisampled_attachment == VK_ATTACHMENT_UNUSED || attachments[multisampled_attachment].samples != VK_SAMPLE_COUNT_1_BIT) &&
+	       "The attachment rendered instead must be multisampled");
+
+	multisampled_attachments.resize(attachments.size(), VK_ATTACHMENT_UNUSED);
+	multisampled_attachments[attachment] = multisampled_attachment;
+}
+
+uint32_t RenderTarget::get_multisampled_attachment(uint32_t attachment) const
+{
+	return attachment < multisampled_attachments.size() ? multisampled_attachments[attachment] : VK_ATTACHMENT_UNUSED;
+}
+
+void RenderTarget::set_depth_stencil_resolve(uint32_t attachment, VkResolveModeFlagBits mode)
+{
+	if (attachment != VK_ATTACHMENT_UNUSED && !device.is_enabled(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME))
+	{
+		throw VulkanException{VK_ERROR_EXTENSION_NOT_PRESENT, "Resolving the depth in the render pass needs VK_KHR_depth_stencil_resolve"};
+	}
+
+	depth_stencil_resolve_attachment = attachment;
+	depth_stencil_resolve_mode       = attachment == VK_ATTACHMENT_UNUSED ? VK_RESOLVE_MODE_NONE : mode;
+}
+
+uint32_t RenderTarget::get_depth_stencil_resolve_attachment() const
+{
+	return depth_stencil_resolve_attachment;
+}
+
+VkResolveModeFlagBits RenderTarget::get_depth_stencil_resolve_mode() const
+{
+	return depth_stencil_resolve_mode;
+}
+
+VkSampleCountFlagBits RenderTarget::get_sample_count() const
+{
+	for (auto multisampled_attachment : multisampled_attachments)
+	{
+		if (multisampled_attachment != VK_ATTACHMENT_UNUSED)
+		{
+			return attachments[multisampled_attachment].samples;
+		}
+	}
+	return VK_SAMPLE_COUNT_1_BIT;
+}
+
 }        // namespace vkb
@@ -61,6 +61,18 @@ class RenderTarget
 
 	static const CreateFunc DEFAULT_CREATE_FUNC;
 
+	/**
+	 * @brief Creates render targets rendering into multisampled attachments, resolved in the render pass
+	 *
+	 * The render targets keep the swapchain image at 0 and a multisampled depth at 1, followed by the multisampled
+	 * color attachment rendered instead of the swapchain image, and the depth it is resolved to with the sample zero
+	 * mode if resolve_depth is set. The multisampled attachments are transient, lazily allocated on tilers which never
+	 * write them to memory.
+	 * @param samples Sample count of the multisampled attachments, supported for color and depth framebuffers
+	 * @param resolve_depth Whether to resolve the depth into a sampled attachment, needs VK_KHR_depth_stencil_resolve
+	 */
+	static CreateFunc create_multisampled_func(VkSampleCountFlagBits samples, bool resolve_depth = false);
+
 	RenderTarget(std::vector<core::Image> &&images);
 
 	RenderTarget(std::vector<core::ImageView> &&image_views);
@@ -101,6 +113,56 @@ class RenderTarget
 
 	VkImageLayout get_layout(uint32_t attachment) const;
 
+	/**
+	 * @brief Sets the image controlling the fragment shading rate of the subpasses using it
+	 *        The view is appended to the attachments of the render passes and framebuffers, after those of the render target.
+	 *        It must stay alive while the render target is used, and be in the fragment shading rate attachment layout
+	 *        when a render pass begins. Needs VK_KHR_fragment_shading_rate.
+	 * @param view The R8_UINT image of the rates, nullptr to stop using one
+	 * @param texel_size Size of the framebuffer region covered by a texel of the image
+	 */
+	void set_shading_rate_view(const core::ImageView *view, const VkExtent2D &texel_size);
+
+	const core::ImageView *get_shading_rate_view() const;
+
+	const VkExtent2D &get_shading_rate_texel_size() const;
+
+	/**
+	 * @return Index of the shading rate attachment in the render passes, VK_ATTACHMENT_UNUSED without one
+	 */
+	uint32_t get_shading_rate_attachment() const;
+
+	/**
+	 * @brief Renders an attachment through a multisampled one, resolved into it at the end of each subpass
+	 *        The subpasses writing the attachment write the multisampled one instead, unless they set their own color
+	 *        resolve attachments, and the render pipeline never stores the multisampled one.
+	 * @param attachment The attachment the subpasses write to
+	 * @param multisampled_attachment The attachment rendered instead, VK_ATTACHMENT_UNUSED to render the attachment again
+	 */
+	void set_multisampled_attachment(uint32_t attachment, uint32_t multisampled_attachment);
+
+	/**
+	 * @return The attachment resolved into an attachment, VK_ATTACHMENT_UNUSED if it is rendered directly
+	 */
+	uint32_t get_multisampled_attachment(uint32_t attachment) const;
+
+	/**
+	 * @brief Resolves the depth stencil attachment at the end of each subpass not setting its own resolve mode
+	 *        Needs VK_KHR_depth_stencil_resolve, the render passes are then created with VK_KHR_create_renderpass2.
+	 * @param attachment The attachment the depth stencil is resolved to, VK_ATTACHMENT_UNUSED to stop resolving it
+	 * @param mode The resolve mode, supported by the device for the format of the attachment
+	 */
+	void set_depth_stencil_resolve(uint32_t attachment, VkResolveModeFlagBits mode);
+
+	uint32_t get_depth_stencil_resolve_attachment() const;
+
+	VkResolveModeFlagBits get_depth_stencil_resolve_mode() const;
+
+	/**
+	 * @return The sample count of the multisampled attachments, VK_SAMPLE_COUNT_1_BIT if none is set
+	 */
+	VkSampleCountFlagBits get_sample_count() const;
+
   private:
 	Device const &device;
 
@@ -117,5 +179,16 @@ class RenderTarget
 
 	/// By default the output attachments is attachment 0
 	std::vector<uint32_t> output_attachments = {0};
+
+	const core::ImageView *shading_rate_view{nullptr};
+
+	VkExtent2D shading_rate_texel_size{};
+
+	/// Attachment rendered instead of each attachment, VK_ATTACHMENT_UNUSED for the ones rendered directly
+	std::vector<uint32_t> multisampled_attachments;
+
+	uint32_t depth_stencil_resolve_attachment{VK_ATTACHMENT_UNUSED};
+
+	VkResolveModeFlagBits depth_stencil_resolve_mode{VK_RESOLVE_MODE_NONE};
 };
 }        // namespace vkb
@@ -0,0 +1,52 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/shader_precision.h"
+
+#include "core/device.h"
+
+namespace vkb
+{
+ShaderPrecision select_shader_precision(const Device &device)
+{
+	if (!device.is_enabled(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME))
+	{
+		return ShaderPrecision::Full;
+	}
+
+	auto *float16_features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceFloat16Int8FeaturesKHR>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FLOAT16_INT8_FEATURES_KHR);
+	if (!float16_features || !float16_features->shaderFloat16)
+	{
+		return ShaderPrecision::Full;
+	}
+
+	return ShaderPrecision::Half;
+}
+
+std::string to_string(ShaderPrecision precision)
+{
+	switch (precision)
+	{
+		case ShaderPrecision::Full:
+			return "full precision";
+		case ShaderPrecision::Half:
+			return "half precision";
+	}
+
+	return "unknown";
+}
+}        // namespace vkb
@@ -0,0 +1,45 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace vkb
+{
+class Device;
+
+/**
+ * @brief Precision of the lighting math of the framework shaders, see shaders/lighting.h
+ */
+enum class ShaderPrecision
+{
+	/// 32-bit floats throughout
+	Full,
+
+	/// 16-bit floats for the directions, cosines and colors of the lights, with the HALF_PRECISION definition.
+	/// The positions, distances and intensities stay in 32-bit floats, as they exceed the range of 16 bits.
+	Half
+};
+
+/**
+ * @brief Picks half precision if the shaderFloat16 feature of VK_KHR_shader_float16_int8 is enabled on a device, full precision otherwise
+ */
+ShaderPrecision select_shader_precision(const Device &device);
+
+std::string to_string(ShaderPrecision precision);
+}        // namespace vkb
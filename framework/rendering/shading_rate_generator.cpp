@@ -0,0 +1,251 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/shading_rate_generator.h"
+
+#include <algorithm>
+
+#include "common/glm_common.h"
+#include "core/command_buffer.h"
+#include "core/physical_device.h"
+#include "core/util/profiling.hpp"
+#include "rendering/render_context.h"
+#include "rendering/render_target.h"
+#include "scene_graph/components/perspective_camera.h"
+
+namespace vkb
+{
+namespace
+{
+/**
+ * @brief Push constants of the generation shader
+ */
+struct ShadingRateUniform
+{
+	glm::uvec2 source_size;
+
+	glm::uvec2 texel_size;
+
+	/// log2 of the largest fragment width and height
+	glm::uvec2 max_rate;
+
+	float contrast_threshold;
+
+	float near_plane;
+
+	float far_plane;
+
+	float coarse_distance;
+};
+
+/// Rate texels written by each workgroup of the generation shader, in x and y
+constexpr uint32_t GenerateGroupSize = 8;
+
+uint32_t get_size_log2(uint32_t value)
+{
+	uint32_t result = 0;
+	while (value > 1)
+	{
+		value >>= 1;
+		++result;
+	}
+	return result;
+}
+
+sg::PerspectiveCamera *as_perspective_camera(ShadingRateGenerator::Source source, sg::Camera *camera)
+{
+	if (source != ShadingRateGenerator::Source::Depth)
+	{
+		return nullptr;
+	}
+
+	auto perspective_camera = dynamic_cast<sg::PerspectiveCamera *>(camera);
+	if (!perspective_camera)
+	{
+		throw std::runtime_error("Shading rates generated from the depth need a perspective camera");
+	}
+	return perspective_camera;
+}
+}        // namespace
+
+void ShadingRateGenerator::request_features(PhysicalDevice &gpu)
+{
+	REQUEST_REQUIRED_FEATURE(gpu, VkPhysicalDeviceFragmentShadingRateFeaturesKHR, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR, attachmentFragmentShadingRate);
+}
+
+ShadingRateGenerator::ShadingRateGenerator(RenderContext &render_context, Source source, sg::Camera *camera) :
+    render_context{render_context},
+    source{source},
+    camera{as_perspective_camera(source, camera)},
+    generate_shader{"shading_rate/generate_rates.comp"}
+{
+	auto &device = render_context.get_device();
+
+	auto features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceFragmentShadingRateFeaturesKHR>(
+	    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR);
+	if (!device.is_enabled(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME) || !features || !features->attachmentFragmentShadingRate)
+	{
+		throw std::runtime_error("Shading rate attachments need VK_KHR_fragment_shading_rate and its attachmentFragmentShadingRate feature");
+	}
+
+	auto format_features = device.get_gpu().get_format_properties(VK_FORMAT_R8_UINT).optimalTilingFeatures;
+	if (!(format_features & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) || !(format_features & VK_FORMAT_FEATURE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR))
+	{
+		throw std::runtime_error("Shading rate attachments of format VK_FORMAT_R8_UINT can't be written as storage images");
+	}
+
+	VkPhysicalDeviceFragmentShadingRatePropertiesKHR shading_rate_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR};
+
+	VkPhysicalDeviceProperties2KHR properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+	properties.pNext = &shading_rate_properties;
+	vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+
+	// The limits are powers of two, so is the clamped size
+	auto &min_texel_size = shading_rate_properties.minFragmentShadingRateAttachmentTexelSize;
+	auto &max_texel_size = shading_rate_properties.maxFragmentShadingRateAttachmentTexelSize;
+	texel_size           = {std::clamp(TexelSize, min_texel_size.width, max_texel_size.width),
+	                        std::clamp(TexelSize, min_texel_size.height, max_texel_size.height)};
+
+	// Rates unsupported at some sample counts are clamped by the implementation to supported ones
+	max_fragment_size = {std::min(4u, shading_rate_properties.maxFragmentSize.width), std::min(4u, shading_rate_properties.maxFragmentSize.height)};
+
+	if (source == Source::Depth)
+	{
+		generate_variant.add_define("DEPTH_SOURCE");
+	}
+
+	// Texels are fetched, the sampler doesn't filter them
+	VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+	sampler_info.minFilter    = VK_FILTER_NEAREST;
+	sampler_info.magFilter    = VK_FILTER_NEAREST;
+	sampler_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.borderColor  = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	sampler                   = &device.get_resource_cache().RequestSampler(sampler_info);
+}
+
+void ShadingRateGenerator::set_contrast_threshold(float threshold)
+{
+	contrast_threshold = threshold;
+}
+
+void ShadingRateGenerator::set_coarse_distance(float distance)
+{
+	coarse_distance = distance;
+}
+
+void ShadingRateGenerator::prepare()
+{
+	render_context.get_device().get_resource_cache().CompileShaderModulesAsync({{VK_SHADER_STAGE_COMPUTE_BIT, generate_shader, generate_variant}});
+}
+
+void ShadingRateGenerator::create_attachment(const VkExtent2D &extent)
+{
+	// The attachment covers the framebuffer, a texel for each region touched by it
+	VkExtent3D attachment_extent{(extent.width + texel_size.width - 1) / texel_size.width, (extent.height + texel_size.height - 1) / texel_size.height, 1};
+
+	view.reset();
+	image = std::make_unique<core::Image>(render_context.get_device(), core::ImageBuilder(attachment_extent)
+	                                                                       .with_format(VK_FORMAT_R8_UINT)
+	                                                                       .with_usage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR)
+	                                                                       .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY)
+	                                                                       .with_debug_name("Shading rate generator: rates"));
+	view = std::make_unique<core::ImageView>(*image, VK_IMAGE_VIEW_TYPE_2D);
+
+	source_extent = extent;
+}
+
+void ShadingRateGenerator::generate(CommandBuffer &command_buffer, const core::ImageView &source_view)
+{
+	PROFILE_SCOPE("Generate Shading Rates");
+
+	const uint32_t source_level = source_view.get_subresource_range().baseMipLevel;
+	const auto    &image_extent = source_view.get_image().get_extent();
+	const VkExtent2D extent{std::max(1u, image_extent.width >> source_level), std::max(1u, image_extent.height >> source_level)};
+
+	if (!image || source_extent.width != extent.width || source_extent.height != extent.height)
+	{
+		create_attachment(extent);
+	}
+
+	ScopedDebugLabel debug_label{command_buffer, "Generate shading rates"};
+
+	// The rates read by the previous frame are written again, their contents are discarded
+	vkb::ImageMemoryBarrier reuse_barrier;
+	reuse_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+	reuse_barrier.new_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	reuse_barrier.src_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+	reuse_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	reuse_barrier.dst_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.image_memory_barrier(*view, reuse_barrier);
+
+	auto &resource_cache  = command_buffer.get_device().get_resource_cache();
+	auto &shader_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, generate_shader, generate_variant);
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.bind_image(source_view, *sampler, 0, 0, 0);
+	command_buffer.bind_image(*view, 0, 1, 0);
+
+	ShadingRateUniform uniform{};
+	uniform.source_size        = glm::uvec2(extent.width, extent.height);
+	uniform.texel_size         = glm::uvec2(texel_size.width, texel_size.height);
+	uniform.max_rate           = glm::uvec2(get_size_log2(max_fragment_size.width), get_size_log2(max_fragment_size.height));
+	uniform.contrast_threshold = contrast_threshold;
+	uniform.coarse_distance    = coarse_distance;
+	if (camera)
+	{
+		uniform.near_plane = camera->get_near_plane();
+		uniform.far_plane  = camera->get_far_plane();
+	}
+	command_buffer.push_constants(uniform);
+
+	auto &attachment_extent = image->get_extent();
+	command_buffer.dispatch((attachment_extent.width + GenerateGroupSize - 1) / GenerateGroupSize,
+	                        (attachment_extent.height + GenerateGroupSize - 1) / GenerateGroupSize,
+	                        1);
+
+	// The rates are read by the render passes, in the layout they expect them in
+	vkb::ImageMemoryBarrier read_barrier;
+	read_barrier.old_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	read_barrier.new_layout      = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+	read_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	read_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+	read_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	read_barrier.dst_access_mask = VK_ACCESS_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR;
+	command_buffer.image_memory_barrier(*view, read_barrier);
+}
+
+void ShadingRateGenerator::attach(RenderTarget &render_target) const
+{
+	assert(view && "The attachment is created by the first generate");
+	render_target.set_shading_rate_view(view.get(), texel_size);
+}
+
+const core::ImageView &ShadingRateGenerator::get_view() const
+{
+	assert(view && "The attachment is created by the first generate");
+	return *view;
+}
+
+const VkExtent2D &ShadingRateGenerator::get_texel_size() const
+{
+	return texel_size;
+}
+}        // namespace vkb
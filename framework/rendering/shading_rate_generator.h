@@ -0,0 +1,162 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "core/image.h"
+#include "core/image_view.h"
+#include "core/sampler.h"
+#include "core/shader_module.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class PhysicalDevice;
+class RenderContext;
+class RenderTarget;
+
+namespace sg
+{
+class Camera;
+class PerspectiveCamera;
+}        // namespace sg
+
+/**
+ * @brief Generates a fragment shading rate attachment from the content of the previous frame
+ *
+ * A compute shader reads an image rendered by the previous frame and writes a rate for each texel of the attachment,
+ * which covers a TexelSize region of the framebuffer if the device allows it:
+ * - From the luminance of a color image, the rate is halved along an axis when the contrast between the neighbouring
+ *   pixels along it stays under the threshold everywhere in the region, and halved again under a quarter of it.
+ * - From a depth image, of the reversed depth of sg::PerspectiveCamera, the regions crossed by depth edges keep the
+ *   full rate, and the others are shaded coarser farther than the coarse distance, twice as coarse past twice of it.
+ *
+ * The attachment is set to a render target with attach(), the subpasses opting in with
+ * Subpass::set_use_shading_rate_attachment() are then shaded at its rates.
+ *
+ * Needs VK_KHR_fragment_shading_rate with its attachmentFragmentShadingRate feature, see request_features(),
+ * and VK_KHR_create_renderpass2 for the subpasses rendered with render passes.
+ */
+class ShadingRateGenerator
+{
+  public:
+	/**
+	 * @brief The content the rates are generated from
+	 */
+	enum class Source
+	{
+		Luminance,
+		Depth
+	};
+
+	/// Preferred size of the region covered by a texel of the attachment, clamped to the limits of the device
+	static constexpr uint32_t TexelSize = 16;
+
+	/**
+	 * @brief Requests the features needed by the generator, to be called from VulkanSample::request_gpu_features()
+	 */
+	static void request_features(PhysicalDevice &gpu);
+
+	/**
+	 * @param render_context Render context
+	 * @param source The content the rates are generated from
+	 * @param camera The camera the depth is rendered with, needed by Source::Depth only
+	 * @throws std::runtime_error if the device can't use a shading rate attachment, or the depth has no perspective camera
+	 */
+	ShadingRateGenerator(RenderContext &render_context, Source source, sg::Camera *camera = nullptr);
+
+	ShadingRateGenerator(const ShadingRateGenerator &) = delete;
+
+	ShadingRateGenerator(ShadingRateGenerator &&) = delete;
+
+	~ShadingRateGenerator() = default;
+
+	ShadingRateGenerator &operator=(const ShadingRateGenerator &) = delete;
+
+	ShadingRateGenerator &operator=(ShadingRateGenerator &&) = delete;
+
+	/**
+	 * @brief Sets the contrast between neighbouring pixels under which the luminance source halves the rate
+	 */
+	void set_contrast_threshold(float threshold);
+
+	/**
+	 * @brief Sets the view depth from which the depth source coarsens the rate
+	 */
+	void set_coarse_distance(float distance);
+
+	/**
+	 * @brief Compiles the shader
+	 */
+	void prepare();
+
+	/**
+	 * @brief Writes the rates from the content of the previous frame, to be recorded before the render pass
+	 *        The attachment is created, or created again, for the extent of the source.
+	 * @param command_buffer The command buffer to record into
+	 * @param source_view The image of the previous frame, in the SHADER_READ_ONLY_OPTIMAL layout, the depth aspect only for Source::Depth
+	 */
+	void generate(CommandBuffer &command_buffer, const core::ImageView &source_view);
+
+	/**
+	 * @brief Sets the attachment as the shading rate attachment of a render target
+	 *        It must be called after generate(), which may recreate the attachment.
+	 */
+	void attach(RenderTarget &render_target) const;
+
+	const core::ImageView &get_view() const;
+
+	/**
+	 * @return Size of the framebuffer region covered by a texel of the attachment
+	 */
+	const VkExtent2D &get_texel_size() const;
+
+  private:
+	void create_attachment(const VkExtent2D &extent);
+
+	RenderContext &render_context;
+
+	Source source;
+
+	sg::PerspectiveCamera *camera{nullptr};
+
+	float contrast_threshold{0.05f};
+
+	float coarse_distance{50.0f};
+
+	VkExtent2D texel_size{};
+
+	/// Largest fragment size written, at most 4x4
+	VkExtent2D max_fragment_size{};
+
+	ShaderSource generate_shader;
+
+	ShaderVariant generate_variant;
+
+	/// Owned by the resource cache
+	const core::Sampler *sampler{nullptr};
+
+	/// Extent of the source the attachment was created for
+	VkExtent2D source_extent{};
+
+	std::unique_ptr<core::Image> image;
+
+	std::unique_ptr<core::ImageView> view;
+};
+}        // namespace vkb
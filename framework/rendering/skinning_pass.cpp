@@ -0,0 +1,334 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/skinning_pass.h"
+
+#include <algorithm>
+
+#include "common/helpers.h"
+#include "core/command_buffer.h"
+#include "core/device.h"
+#include "core/util/profiling.hpp"
+#include "rendering/render_context.h"
+#include "rendering/subpasses/geometry_subpass.h"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/skin.h"
+#include "scene_graph/components/sub_mesh.h"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr uint32_t NoNormal = ~0u;
+
+/**
+ * @brief Fills the device address and stride of an attribute of a sub mesh
+ * @return The format of the attribute, VK_FORMAT_UNDEFINED if the sub mesh has none
+ */
+VkFormat get_attribute_stream(const sg::SubMesh &sub_mesh, const std::string &name, glm::uvec2 &address, uint32_t &stride)
+{
+	sg::VertexAttribute attribute;
+	auto                buffer = sub_mesh.vertex_buffers.find(name);
+	if (!sub_mesh.get_attribute(name, attribute) || buffer == sub_mesh.vertex_buffers.end())
+	{
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	uint64_t device_address = buffer->second.get_device_address() + attribute.offset;
+
+	address = glm::uvec2(static_cast<uint32_t>(device_address), static_cast<uint32_t>(device_address >> 32));
+	stride  = attribute.stride;
+	return attribute.format;
+}
+
+/**
+ * @brief Fills the uniform of a sub mesh with the attributes the skinning shader can decode
+ * @return Whether the sub mesh can be skinned
+ */
+bool get_skinned_sub_mesh(const sg::SubMesh &sub_mesh, SkinnedSubMeshUniform &uniform)
+{
+	if (get_attribute_stream(sub_mesh, "position", uniform.position_address, uniform.position_stride) != VK_FORMAT_R32G32B32_SFLOAT)
+	{
+		return false;
+	}
+
+	switch (get_attribute_stream(sub_mesh, "joints_0", uniform.joints_address, uniform.joints_stride))
+	{
+		case VK_FORMAT_R8G8B8A8_UINT:
+			uniform.joints_format = 0;
+			break;
+		case VK_FORMAT_R16G16B16A16_UINT:
+			uniform.joints_format = 1;
+			break;
+		default:
+			return false;
+	}
+
+	switch (get_attribute_stream(sub_mesh, "weights_0", uniform.weights_address, uniform.weights_stride))
+	{
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			uniform.weights_format = 0;
+			break;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+			uniform.weights_format = 1;
+			break;
+		case VK_FORMAT_R16G16B16A16_UNORM:
+			uniform.weights_format = 2;
+			break;
+		default:
+			return false;
+	}
+
+	// Normals in other formats keep their bind pose
+	switch (get_attribute_stream(sub_mesh, "normal", uniform.normal_address, uniform.normal_stride))
+	{
+		case VK_FORMAT_R32G32B32_SFLOAT:
+			uniform.normal_format = static_cast<uint32_t>(VertexPullingFormat::Float);
+			break;
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			uniform.normal_format = static_cast<uint32_t>(VertexPullingFormat::Half);
+			break;
+		default:
+			uniform.normal_address = glm::uvec2(0);
+			uniform.normal_stride  = 0;
+			break;
+	}
+
+	uniform.vertex_count = sub_mesh.vertices_count;
+	return true;
+}
+}        // namespace
+
+SkinningPass::SkinningPass(RenderContext &render_context, sg::Scene &scene) :
+    render_context{render_context},
+    skinning_shader{"skinning/skinning.comp"}
+{
+	std::vector<SkinnedSubMeshUniform> uniforms;
+	uint32_t                           output_float_count = 0;
+
+	for (auto mesh : scene.get_components<sg::Mesh>())
+	{
+		for (auto node : mesh->get_nodes())
+		{
+			if (!node->has_component<sg::Skin>())
+			{
+				continue;
+			}
+
+			auto &skin = node->get_component<sg::Skin>();
+
+			// The output holds a single skinned copy of each sub mesh
+			std::vector<sg::SubMesh *> skinned_sub_meshes;
+			for (auto sub_mesh : mesh->get_submeshes())
+			{
+				SkinnedSubMeshUniform uniform{};
+				if (sub_meshes.count(sub_mesh))
+				{
+					LOGW("Sub mesh '{}' is skinned by several nodes, only the first one moves it", sub_mesh->get_name());
+					continue;
+				}
+
+				if (!get_skinned_sub_mesh(*sub_mesh, uniform))
+				{
+					LOGW("Sub mesh '{}' has no float positions with joints and weights, it is not skinned", sub_mesh->get_name());
+					continue;
+				}
+
+				uniform.first_joint    = joint_count;
+				uniform.first_position = output_float_count;
+				output_float_count += 3 * uniform.vertex_count;
+
+				uniform.first_normal = NoNormal;
+				if (uniform.normal_stride != 0)
+				{
+					uniform.first_normal = output_float_count;
+					output_float_count += 3 * uniform.vertex_count;
+				}
+
+				max_vertex_count = std::max(max_vertex_count, uniform.vertex_count);
+
+				sub_meshes.emplace(sub_mesh, uniform);
+				uniforms.push_back(uniform);
+				skinned_sub_meshes.push_back(sub_mesh);
+			}
+
+			if (skinned_sub_meshes.empty())
+			{
+				continue;
+			}
+
+			skin_instances.push_back({node, &skin, joint_count});
+			joint_count += to_u32(skin.get_joints().size());
+
+			tracked_nodes.push_back(node);
+		}
+	}
+
+	for (auto &instance : skin_instances)
+	{
+		tracked_nodes.insert(tracked_nodes.end(), instance.skin->get_joints().begin(), instance.skin->get_joints().end());
+	}
+	skinned_versions.resize(tracked_nodes.size());
+
+	auto &device = render_context.get_device();
+
+	// Storage buffers can't be empty, an unused element is allocated without skinned sub meshes
+	sub_mesh_buffer = vkb::core::BufferBuilderC(std::max<size_t>(uniforms.size(), 1) * sizeof(SkinnedSubMeshUniform))
+	                      .with_usage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+	                      .with_vma_usage(VMA_MEMORY_USAGE_CPU_TO_GPU)
+	                      .build_unique(device);
+	sub_mesh_buffer->set_debug_name("Skinning pass: sub meshes");
+	if (!uniforms.empty())
+	{
+		sub_mesh_buffer->update(uniforms.data(), uniforms.size() * sizeof(SkinnedSubMeshUniform));
+	}
+
+	VkBufferUsageFlags output_usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+	if (device.is_enabled(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME))
+	{
+		output_usage |= VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+	}
+
+	output_buffer = vkb::core::BufferBuilderC(std::max<VkDeviceSize>(output_float_count, 1) * sizeof(float))
+	                    .with_usage(output_usage)
+	                    .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY)
+	                    .build_unique(device);
+	output_buffer->set_debug_name("Skinning pass: skinned vertices");
+
+	joint_matrices.resize(joint_count);
+
+	LOGI("Skinning {} sub meshes with {} joints", sub_meshes.size(), joint_count);
+}
+
+void SkinningPass::prepare()
+{
+	render_context.get_device().get_resource_cache().CompileShaderModulesAsync({{VK_SHADER_STAGE_COMPUTE_BIT, skinning_shader, skinning_variant}});
+}
+
+bool SkinningPass::update(CommandBuffer &command_buffer)
+{
+	PROFILE_SCOPE("Skin Vertices");
+
+	std::lock_guard<std::mutex> guard(update_mutex);
+
+	if (sub_meshes.empty())
+	{
+		return false;
+	}
+
+	bool moved = initial_update;
+	for (size_t i = 0; i < tracked_nodes.size(); ++i)
+	{
+		auto version = tracked_nodes[i]->get_transform().get_world_matrix_version();
+		if (version != skinned_versions[i])
+		{
+			skinned_versions[i] = version;
+			moved               = true;
+		}
+	}
+
+	if (!moved)
+	{
+		return false;
+	}
+
+	initial_update = false;
+	++skinned_version;
+
+	// The skinned vertices stay in the space of their mesh node, which the draws transform to world space
+	for (auto &instance : skin_instances)
+	{
+		auto  world_to_mesh         = glm::inverse(instance.node->get_transform().get_world_matrix());
+		auto &joints                = instance.skin->get_joints();
+		auto &inverse_bind_matrices = instance.skin->get_inverse_bind_matrices();
+
+		for (size_t i = 0; i < joints.size(); ++i)
+		{
+			joint_matrices[instance.first_joint + i] = world_to_mesh * joints[i]->get_transform().get_world_matrix() * inverse_bind_matrices[i];
+		}
+	}
+
+	auto joint_allocation = render_context.get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, std::max<size_t>(joint_matrices.size(), 1) * sizeof(glm::mat4));
+	if (!joint_matrices.empty())
+	{
+		joint_allocation.update(joint_matrices.data(), joint_matrices.size() * sizeof(glm::mat4));
+	}
+
+	ScopedDebugLabel debug_label{command_buffer, "Skin vertices"};
+
+	VkPipelineStageFlags2KHR consumer_stages = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT_KHR | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT_KHR;
+	if (command_buffer.get_device().is_enabled(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME))
+	{
+		consumer_stages |= VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+	}
+
+	// The tracked state of the buffer holds the draws and refits of the previous frames, which read the vertices
+	// before they are written again, the barrier is recorded by the dispatch
+	command_buffer.request_buffer_state(*output_buffer, {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_WRITE_BIT_KHR});
+
+	auto &resource_cache  = command_buffer.get_device().get_resource_cache();
+	auto &skinning_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, skinning_shader, skinning_variant);
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&skinning_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.bind_buffer(*sub_mesh_buffer, 0, sub_mesh_buffer->get_size(), 0, 0, 0);
+	command_buffer.bind_buffer(joint_allocation.get_buffer(), joint_allocation.get_offset(), joint_allocation.get_size(), 0, 1, 0);
+	command_buffer.bind_buffer(*output_buffer, 0, output_buffer->get_size(), 0, 2, 0);
+
+	// A row of workgroups per sub mesh, the ones past its vertices return at once
+	command_buffer.dispatch((max_vertex_count + GroupSize - 1) / GroupSize, to_u32(sub_meshes.size()), 1);
+
+	command_buffer.request_buffer_state(*output_buffer, {VK_IMAGE_LAYOUT_UNDEFINED, consumer_stages, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT_KHR | VK_ACCESS_2_SHADER_READ_BIT_KHR});
+	command_buffer.flush_barriers();
+
+	return true;
+}
+
+bool SkinningPass::is_skinned(const sg::SubMesh &sub_mesh) const
+{
+	return sub_meshes.count(&sub_mesh) != 0;
+}
+
+const vkb::core::BufferC &SkinningPass::get_output_buffer() const
+{
+	return *output_buffer;
+}
+
+VkDeviceSize SkinningPass::get_position_offset(const sg::SubMesh &sub_mesh) const
+{
+	return sub_meshes.at(&sub_mesh).first_position * sizeof(float);
+}
+
+VkDeviceSize SkinningPass::get_normal_offset(const sg::SubMesh &sub_mesh) const
+{
+	auto first_normal = sub_meshes.at(&sub_mesh).first_normal;
+	return first_normal == NoNormal ? VK_WHOLE_SIZE : first_normal * sizeof(float);
+}
+
+uint64_t SkinningPass::get_skinned_version() const
+{
+	return skinned_version;
+}
+
+size_t SkinningPass::get_sub_mesh_count() const
+{
+	return sub_meshes.size();
+}
+}        // namespace vkb
@@ -0,0 +1,221 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "common/glm_common.h"
+#include "core/buffer.h"
+#include "core/shader_module.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class RenderContext;
+
+namespace sg
+{
+class Node;
+class Scene;
+class Skin;
+class SubMesh;
+}        // namespace sg
+
+/**
+ * @brief Source attributes and output ranges of a skinned sub mesh, laid out as in shaders/skinning/skinning.comp
+ *        The output offsets are in floats, from the start of the output buffer.
+ */
+struct alignas(16) SkinnedSubMeshUniform
+{
+	glm::uvec2 position_address;
+
+	/// Zero if the normals aren't skinned
+	glm::uvec2 normal_address;
+
+	glm::uvec2 joints_address;
+
+	glm::uvec2 weights_address;
+
+	uint32_t position_stride;
+
+	uint32_t normal_stride;
+
+	uint32_t joints_stride;
+
+	uint32_t weights_stride;
+
+	/// VertexPullingFormat of the normals
+	uint32_t normal_format;
+
+	/// 0 for 8-bit joint indices, 1 for 16-bit
+	uint32_t joints_format;
+
+	/// 0 for 32-bit float weights, 1 for 8-bit normalized, 2 for 16-bit normalized
+	uint32_t weights_format;
+
+	uint32_t vertex_count;
+
+	uint32_t first_position;
+
+	uint32_t first_normal;
+
+	/// First matrix of the skin in the joint matrices
+	uint32_t first_joint;
+
+	uint32_t padding;
+};
+
+/**
+ * @brief Skins the vertices of the skinned meshes of a scene with a compute shader, once per frame for every pass
+ *
+ * Each sub mesh of a mesh node with a sg::Skin, and with float positions, joints and weights, owns a range of a
+ * shared output buffer holding its skinned positions and normals, as tightly packed floats. On update, the joint
+ * matrices of the skins are read from the world matrices of their nodes, kept by the sg::TransformStore, and a
+ * single dispatch skins every sub mesh at once. Nothing is recorded while no joint or mesh node moved, so the
+ * subpasses of a frame share the output without skinning again.
+ *
+ * The skinned vertices stay in the space of the mesh node, so the draws and the ray tracing instances keep the
+ * world matrix of their node. The source attributes are fetched through their buffer device addresses, so the
+ * scene must be loaded with BufferUsage added to the usage of its buffers and the bufferDeviceAddress feature
+ * must be enabled.
+ *
+ * Consumers bind the output with get_output_buffer() and get_position_offset() and get_normal_offset() of their
+ * sub mesh, see GeometrySubpass::set_skinning_pass() and RayTracingScene. The bounds of the skinned meshes are
+ * those of their bind pose, so GeometrySubpass never culls them.
+ */
+class SkinningPass
+{
+  public:
+	/// Usage the vertex buffers of the scene need, see GLTFLoader::read_scene_from_file
+	static constexpr VkBufferUsageFlags BufferUsage = VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	/// Size of the skinned positions and normals of a vertex in the output buffer
+	static constexpr VkDeviceSize OutputStride = 3 * sizeof(float);
+
+	/// Vertices skinned by each workgroup of the skinning shader
+	static constexpr uint32_t GroupSize = 64;
+
+	/**
+	 * @param render_context Render context, its frames allocate the joint matrices
+	 * @param scene Scene whose skinned mesh nodes are skinned, the nodes can't change afterwards
+	 */
+	SkinningPass(RenderContext &render_context, sg::Scene &scene);
+
+	SkinningPass(const SkinningPass &) = delete;
+
+	SkinningPass(SkinningPass &&) = delete;
+
+	~SkinningPass() = default;
+
+	SkinningPass &operator=(const SkinningPass &) = delete;
+
+	SkinningPass &operator=(SkinningPass &&) = delete;
+
+	/**
+	 * @brief Compiles the skinning shader
+	 */
+	void prepare();
+
+	/**
+	 * @brief Skins the vertices if a joint or a skinned mesh node moved since the last update
+	 *        Must be recorded outside of a render pass, before the commands reading the output. Safe to call from
+	 *        several subpasses of a frame, the first call records the dispatch they all wait on, so the command
+	 *        buffers of the frame must be submitted in the order they were recorded.
+	 * @return Whether the vertices were skinned
+	 */
+	bool update(CommandBuffer &command_buffer);
+
+	/**
+	 * @return Whether a sub mesh is skinned by the pass
+	 */
+	bool is_skinned(const sg::SubMesh &sub_mesh) const;
+
+	/**
+	 * @return The buffer holding the skinned vertices, usable as a vertex buffer and as a ray tracing build input
+	 */
+	const vkb::core::BufferC &get_output_buffer() const;
+
+	/**
+	 * @return The offset in bytes of the skinned positions of a sub mesh in the output buffer, which must be skinned
+	 */
+	VkDeviceSize get_position_offset(const sg::SubMesh &sub_mesh) const;
+
+	/**
+	 * @return The offset in bytes of the skinned normals of a sub mesh, or VK_WHOLE_SIZE if its normals aren't skinned
+	 */
+	VkDeviceSize get_normal_offset(const sg::SubMesh &sub_mesh) const;
+
+	/**
+	 * @return Number of updates which skinned the vertices, compared by the consumers refitting their own structures
+	 */
+	uint64_t get_skinned_version() const;
+
+	/**
+	 * @return Number of sub meshes skinned by the pass
+	 */
+	size_t get_sub_mesh_count() const;
+
+  private:
+	/// A mesh node with a skin, its joint matrices are contiguous
+	struct SkinInstance
+	{
+		sg::Node *node;
+
+		sg::Skin *skin;
+
+		uint32_t first_joint;
+	};
+
+	RenderContext &render_context;
+
+	ShaderSource skinning_shader;
+
+	ShaderVariant skinning_variant;
+
+	std::vector<SkinInstance> skin_instances;
+
+	/// Mesh nodes then joint nodes, the vertices are skinned again when the version of one of their world matrices changed
+	std::vector<sg::Node *> tracked_nodes;
+
+	std::vector<uint32_t> skinned_versions;
+
+	bool initial_update{true};
+
+	uint64_t skinned_version{0};
+
+	uint32_t joint_count{0};
+
+	/// Largest number of vertices of a skinned sub mesh, the width of the dispatch
+	uint32_t max_vertex_count{0};
+
+	std::unordered_map<const sg::SubMesh *, SkinnedSubMeshUniform> sub_meshes;
+
+	/// Scratch space of update(), reused across frames
+	std::vector<glm::mat4> joint_matrices;
+
+	std::unique_ptr<vkb::core::BufferC> sub_mesh_buffer;
+
+	std::unique_ptr<vkb::core::BufferC> output_buffer;
+
+	std::mutex update_mutex;
+};
+}        // namespace vkb
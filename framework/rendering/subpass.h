@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <tuple>
+
 #include "buffer_pool.h"
 #include "rendering/hpp_pipeline_state.h"
 #include "rendering/hpp_render_target.h"
@@ -83,6 +85,7 @@ class Subpass
 {
 	using ResolveModeFlagBitsType = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::ResolveModeFlagBits, VkResolveModeFlagBits>::type;
 	using SampleCountflagBitsType = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::SampleCountFlagBits, VkSampleCountFlagBits>::type;
+	using SubpassContentsType     = typename std::conditional<bindingType == vkb::BindingType::Cpp, vk::SubpassContents, VkSubpassContents>::type;
 
 	using CommandBufferType = typename std::conditional<bindingType == vkb::BindingType::Cpp, vkb::core::HPPCommandBuffer, vkb::CommandBuffer>::type;
 	using DepthStencilStateType =
@@ -105,21 +108,39 @@ class Subpass
 	 */
 	virtual void draw(CommandBufferType &command_buffer) = 0;
 
+	/**
+	 * @brief Records the commands which are not allowed in a render pass, like compute dispatches.
+	 *        Called by the RenderPipeline for every subpass before it begins the render pass. Does nothing by default.
+	 * @param command_buffer Command buffer the render pass is recorded to
+	 */
+	virtual void draw_before_render_pass(CommandBufferType &command_buffer);
+
 	/**
 	 * @brief Prepares the shaders and shader variants for a subpass
 	 */
 	virtual void prepare() = 0;
 
+	/**
+	 * @brief Returns how the draw commands of this subpass are provided, the RenderPipeline
+	 *        begins the subpass with these contents. Defaults to inline.
+	 *        Subpasses returning secondary command buffers have to record all their draws
+	 *        into secondary command buffers and execute them from draw.
+	 */
+	virtual SubpassContentsType get_subpass_contents();
+
 	/**
 	 * @brief Prepares the lighting state to have its lights
+	 *        The lights are written into a persistent uniform buffer of each render frame, which is only written again
+	 *        when a light was added or removed, or its properties or the world matrix of its node changed.
 	 *
 	 * @tparam A light structure that has 'directional_lights', 'point_lights' and 'spot_light' array fields defined.
+	 * @tparam LightRange A range of sg::Light pointers, like a vector or a sg::ComponentView
 	 * @param scene_lights All of the light components from the scene graph
 	 * @param max_lights_per_type The maximum amount of lights allowed for any given type of light.
 	 */
-	template <typename T>
-	void allocate_lights(const std::vector<sg::Light *> &scene_lights,
-	                     size_t                          max_lights_per_type);
+	template <typename T, typename LightRange = std::vector<sg::Light *>>
+	void allocate_lights(const LightRange &scene_lights,
+	                     size_t            max_lights_per_type);
 
 	const std::vector<uint32_t>                               &get_color_resolve_attachments() const;
 	const std::string                                         &get_debug_name() const;
@@ -135,6 +156,7 @@ class Subpass
 	std::unordered_map<std::string, ShaderResourceMode> const &get_resource_mode_map() const;
 	SampleCountflagBitsType                                    get_sample_count() const;
 	const ShaderSource                                        &get_vertex_shader() const;
+	bool                                                       get_use_shading_rate_attachment() const;
 	void                                                       set_color_resolve_attachments(std::vector<uint32_t> const &color_resolve);
 	void                                                       set_debug_name(const std::string &name);
 	void                                                       set_disable_depth_stencil_attachment(bool disable_depth_stencil);
@@ -143,6 +165,24 @@ class Subpass
 	void                                                       set_input_attachments(std::vector<uint32_t> const &input);
 	void                                                       set_output_attachments(std::vector<uint32_t> const &output);
 	void                                                       set_sample_count(SampleCountflagBitsType sample_count);
+	void                                                       set_use_shading_rate_attachment(bool use_shading_rate_attachment);
+
+	/**
+	 * @return Whether the draw commands of the subpass are recorded once and replayed, see set_static
+	 */
+	bool is_static() const;
+
+	/**
+	 * @brief Marks the draw commands of the subpass as static, the RenderPipeline then records them once for each
+	 *        render frame and framebuffer into a secondary command buffer, which it executes on the following draws.
+	 *        The recordings are dropped when the resource cache clears its pipelines or framebuffers, on resizes,
+	 *        and by RenderPipeline::invalidate_static_commands, e.g. after the scene changes.
+	 *        The commands may only use descriptor sets cached by the frame, with DescriptorManagementStrategy::StoreInCache,
+	 *        and resources living as long as the recording, not the buffers the frame allocates and resets every frame.
+	 *        The subpass is drawn inline as usual when the frame manages its descriptors differently.
+	 *        Its draw must record its commands inline into the command buffer it is given.
+	 */
+	void set_static(bool static_contents);
 
 	/**
 	 * @brief Updates the render target attachments with the ones stored in this subpass
@@ -175,9 +215,32 @@ class Subpass
 	/// Default to no depth stencil resolve attachment
 	uint32_t depth_stencil_resolve_attachment{VK_ATTACHMENT_UNUSED};
 
+	/**
+	 * @brief When the render target has a shading rate attachment, its rates replace the one of the
+	 *        pipelines of the subpass, which is then rendered with a render pass
+	 */
+	bool use_shading_rate_attachment{false};
+
+	/// Whether the RenderPipeline replays a recording of the draw commands, see set_static
+	bool static_contents{false};
+
 	/// The structure containing all the requested render-ready lights for the scene
 	LightingStateCpp lighting_state{};
 
+	/**
+	 * @brief Persistent light buffer of a render frame, see allocate_lights
+	 */
+	struct LightUpload
+	{
+		std::unique_ptr<vkb::core::BufferCpp> buffer;
+
+		/// Each light the buffer was written with, with its version and the world matrix version of its node
+		std::vector<std::tuple<const sg::Light *, uint32_t, uint32_t>> versions;
+	};
+
+	/// Light buffers by render frame index
+	std::vector<LightUpload> light_uploads;
+
 	ShaderSource fragment_shader;
 
 	/// Default to no input attachments
@@ -223,6 +286,11 @@ inline Subpass<bindingType>::Subpass(RenderContextType &render_context, ShaderSo
 {
 }
 
+template <vkb::BindingType bindingType>
+inline void Subpass<bindingType>::draw_before_render_pass(CommandBufferType &command_buffer)
+{
+}
+
 template <vkb::BindingType bindingType>
 inline const std::vector<uint32_t> &Subpass<bindingType>::get_input_attachments() const
 {
@@ -280,6 +348,19 @@ inline typename Subpass<bindingType>::SampleCountflagBitsType Subpass<bindingTyp
 	}
 }
 
+template <vkb::BindingType bindingType>
+inline typename Subpass<bindingType>::SubpassContentsType Subpass<bindingType>::get_subpass_contents()
+{
+	if constexpr (bindingType == vkb::BindingType::Cpp)
+	{
+		return vk::SubpassContents::eInline;
+	}
+	else
+	{
+		return VK_SUBPASS_CONTENTS_INLINE;
+	}
+}
+
 template <vkb::BindingType bindingType>
 inline const ShaderSource &Subpass<bindingType>::get_vertex_shader() const
 {
@@ -287,10 +368,42 @@ inline const ShaderSource &Subpass<bindingType>::get_vertex_shader() const
 }
 
 template <vkb::BindingType bindingType>
-template <typename T>
-void Subpass<bindingType>::allocate_lights(const std::vector<sg::Light *> &scene_lights,
-                                           size_t                          max_lights_per_type)
+inline bool Subpass<bindingType>::get_use_shading_rate_attachment() const
 {
+	return use_shading_rate_attachment;
+}
+
+template <vkb::BindingType bindingType>
+inline bool Subpass<bindingType>::is_static() const
+{
+	return static_contents;
+}
+
+template <vkb::BindingType bindingType>
+template <typename T, typename LightRange>
+void Subpass<bindingType>::allocate_lights(const LightRange &scene_lights,
+                                           size_t            max_lights_per_type)
+{
+	auto frame_index = render_context.get_active_frame_index();
+	if (light_uploads.size() <= frame_index)
+	{
+		light_uploads.resize(frame_index + 1);
+	}
+	auto &light_upload = light_uploads[frame_index];
+
+	std::vector<std::tuple<const sg::Light *, uint32_t, uint32_t>> versions;
+	for (auto &scene_light : scene_lights)
+	{
+		versions.emplace_back(scene_light, scene_light->get_version(), scene_light->get_node()->get_transform().get_world_matrix_version());
+	}
+
+	// Versions only grow, the lights built last are then the ones the buffer of the frame holds
+	if (light_upload.buffer && light_upload.buffer->get_size() == sizeof(T) && versions == light_upload.versions)
+	{
+		lighting_state.light_buffer = BufferAllocationCpp{*light_upload.buffer, sizeof(T), 0};
+		return;
+	}
+
 	lighting_state.directional_lights.clear();
 	lighting_state.point_lights.clear();
 	lighting_state.spot_lights.clear();
@@ -355,8 +468,17 @@ void Subpass<bindingType>::allocate_lights(const std::vector<sg::Light *> &scene
 	std::copy(lighting_state.point_lights.begin(), lighting_state.point_lights.end(), light_info.point_lights);
 	std::copy(lighting_state.spot_lights.begin(), lighting_state.spot_lights.end(), light_info.spot_lights);
 
-	auto &render_frame          = render_context.get_active_frame();
-	lighting_state.light_buffer = render_frame.allocate_buffer(vk::BufferUsageFlagBits::eUniformBuffer, sizeof(T));
+	if (!light_upload.buffer || light_upload.buffer->get_size() != sizeof(T))
+	{
+		light_upload.buffer = vkb::core::BufferBuilderCpp(sizeof(T))
+		                          .with_usage(vk::BufferUsageFlagBits::eUniformBuffer)
+		                          .with_vma_usage(VMA_MEMORY_USAGE_CPU_TO_GPU)
+		                          .with_debug_name("Subpass lights")
+		                          .build_unique(render_context.get_device());
+	}
+	light_upload.versions = std::move(versions);
+
+	lighting_state.light_buffer = BufferAllocationCpp{*light_upload.buffer, sizeof(T), 0};
 	lighting_state.light_buffer.update(light_info);
 }
 
@@ -478,6 +600,18 @@ inline void Subpass<bindingType>::set_sample_count(SampleCountflagBitsType sampl
 	}
 }
 
+template <vkb::BindingType bindingType>
+inline void Subpass<bindingType>::set_use_shading_rate_attachment(bool use_shading_rate_attachment_)
+{
+	use_shading_rate_attachment = use_shading_rate_attachment_;
+}
+
+template <vkb::BindingType bindingType>
+inline void Subpass<bindingType>::set_static(bool static_contents_)
+{
+	static_contents = static_contents_;
+}
+
 template <vkb::BindingType bindingType>
 inline void Subpass<bindingType>::update_render_target_attachments(RenderTargetType &render_target)
 {
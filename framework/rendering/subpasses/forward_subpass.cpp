@@ -37,9 +37,16 @@ ForwardSubpass::ForwardSubpass(RenderContext &render_context, ShaderSource &&ver
 {
 }
 
+void ForwardSubpass::enable_light_clusters()
+{
+	light_clusters = std::make_unique<LightClusters>(get_render_context(), camera, scene);
+}
+
 void ForwardSubpass::prepare()
 {
-	auto &device = get_render_context().get_device();
+	clear_render_proxies();
+
+	std::vector<ShaderModuleRequest> requests;
 	for (auto &mesh : meshes)
 	{
 		for (auto &sub_mesh : mesh->get_submeshes())
@@ -51,16 +58,45 @@ void ForwardSubpass::prepare()
 
 			variant.add_definitions(vkb::rendering::light_type_definitions);
 
-			auto &vert_module = device.get_resource_cache().RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant);
-			auto &frag_module = device.get_resource_cache().RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), variant);
+			if (light_clusters)
+			{
+				variant.add_definitions(LightClusters::get_definitions());
+			}
+
+			requests.push_back({VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant});
+			requests.push_back({VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), variant});
 		}
 	}
+
+	get_render_context().get_device().get_resource_cache().CompileShaderModulesAsync(requests);
+
+	if (light_clusters)
+	{
+		light_clusters->prepare();
+	}
+}
+
+void ForwardSubpass::draw_before_render_pass(CommandBuffer &command_buffer)
+{
+	GeometrySubpass::draw_before_render_pass(command_buffer);
+
+	if (light_clusters)
+	{
+		light_clusters->update(command_buffer);
+	}
 }
 
 void ForwardSubpass::draw(CommandBuffer &command_buffer)
 {
-	allocate_lights<ForwardLights>(scene.get_components<sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
-	command_buffer.bind_lighting(get_lighting_state(), 0, 4);
+	if (light_clusters)
+	{
+		light_clusters->bind(command_buffer);
+	}
+	else
+	{
+		allocate_lights<ForwardLights>(scene.get_component_view<sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
+		command_buffer.bind_lighting(get_lighting_state(), 0, 4);
+	}
 
 	GeometrySubpass::draw(command_buffer);
 }
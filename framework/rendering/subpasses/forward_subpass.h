@@ -18,6 +18,7 @@
 #pragma once
 
 #include "buffer_pool.h"
+#include "rendering/light_clusters.h"
 #include "rendering/subpasses/geometry_subpass.h"
 
 // This value is per type of light that we feed into the shader
@@ -59,12 +60,28 @@ class ForwardSubpass : public GeometrySubpass
 
 	virtual ~ForwardSubpass() = default;
 
+	/**
+	 * @brief Assigns the lights to clusters of the view frustum with a compute pass, instead of looping over
+	 *        MAX_FORWARD_LIGHT_COUNT lights of each type in every fragment. Adds the CLUSTERED_LIGHTING definitions
+	 *        to the sub mesh variants in prepare(), so it must be called before. Only the base shader supports it.
+	 * @throws std::runtime_error if the camera is not a perspective camera
+	 */
+	void enable_light_clusters();
+
 	virtual void prepare() override;
 
+	/**
+	 * @brief Assigns the lights to the clusters, if they are enabled
+	 */
+	virtual void draw_before_render_pass(CommandBuffer &command_buffer) override;
+
 	/**
 	 * @brief Record draw commands
 	 */
 	virtual void draw(CommandBuffer &command_buffer) override;
+
+  private:
+	std::unique_ptr<LightClusters> light_clusters;
 };
 
 }        // namespace vkb
@@ -16,14 +16,30 @@
  */
 
 #include "rendering/subpasses/geometry_subpass.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <unordered_set>
+
+#include "common/helpers.h"
 #include "common/utils.h"
 #include "common/vk_common.h"
+#include "core/util/job_system.hpp"
+#include "core/util/profiling.hpp"
+#include "geometry/lod.h"
+#include "rendering/bindless_registry.h"
+#include "rendering/order_independent_transparency.h"
 #include "rendering/render_context.h"
+#include "rendering/skinning_pass.h"
+#include "rendering/texture_residency_manager.h"
 #include "scene_graph/components/camera.h"
 #include "scene_graph/components/image.h"
 #include "scene_graph/components/material.h"
 #include "scene_graph/components/mesh.h"
 #include "scene_graph/components/pbr_material.h"
+#include "scene_graph/components/perspective_camera.h"
+#include "scene_graph/components/sub_mesh.h"
 #include "scene_graph/components/texture.h"
 #include "scene_graph/node.h"
 #include "scene_graph/scene.h"
@@ -34,284 +50,1658 @@ GeometrySubpass::GeometrySubpass(RenderContext &render_context, ShaderSource &&v
     Subpass{render_context, std::move(vertex_source), std::move(fragment_source)},
     meshes{scene_.get_components<sg::Mesh>()},
     camera{camera},
-    scene{scene_}
+    scene{scene_},
+    scene_version{scene_.get_version()},
+    visibility_vertex_shader{"visibility_query.vert"},
+    visibility_fragment_shader{"visibility_query.frag"}
 {
+	// Room for the largest material, so the choice doesn't depend on a bindless registry set later
+	auto size = to_u32(sizeof(GlobalUniform) + sizeof(BindlessMaterialUniform));
+	set_constant_delivery(select_constant_delivery(render_context.get_device().get_gpu(), size));
+
+	LOGD("Delivering the global uniform of the draws with {}", to_string(constant_delivery));
+
+	set_shader_precision(select_shader_precision(render_context.get_device()));
 }
 
 void GeometrySubpass::prepare()
 {
-	// Build all shader variance upfront
-	auto &device = get_render_context().get_device();
+	// The variants and resource modes may have changed since the proxies were baked
+	clear_render_proxies();
+
+	// Build all shader variance upfront, in parallel
+	std::vector<ShaderModuleRequest> requests;
 	for (auto &mesh : meshes)
 	{
 		for (auto &sub_mesh : mesh->get_submeshes())
 		{
-			auto &variant     = sub_mesh->get_shader_variant();
-			auto &vert_module = device.get_resource_cache().RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant);
-			auto &frag_module = device.get_resource_cache().RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), variant);
+			auto &variant = sub_mesh->get_shader_variant();
+			requests.push_back({VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant});
+			requests.push_back({VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), variant});
 		}
 	}
+
+	get_render_context().get_device().get_resource_cache().CompileShaderModulesAsync(requests);
 }
 
-void GeometrySubpass::get_sorted_nodes(std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &opaque_nodes, std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &transparent_nodes)
+void GeometrySubpass::draw_before_render_pass(CommandBuffer &command_buffer)
 {
-	auto camera_transform = camera.get_node()->get_transform().get_world_matrix();
+	refresh_meshes();
 
-	for (auto &mesh : meshes)
+	if (skinning_pass)
 	{
-		for (auto &node : mesh->get_nodes())
-		{
-			auto node_transform = node->get_transform().get_world_matrix();
-
-			const sg::AABB &mesh_bounds = mesh->get_bounds();
+		skinning_pass->update(command_buffer);
+	}
 
-			sg::AABB world_bounds{mesh_bounds.get_min(), mesh_bounds.get_max()};
-			world_bounds.transform(node_transform);
+	if (gpu_scene)
+	{
+		gpu_scene->update(command_buffer);
+	}
 
-			float distance = glm::length(glm::vec3(camera_transform[3]) - world_bounds.get_center());
+	if (visibility_queries)
+	{
+		update_visibility_predicates(command_buffer);
+	}
 
-			for (auto &sub_mesh : mesh->get_submeshes())
-			{
-				if (sub_mesh->get_material()->alpha_mode == sg::AlphaMode::Blend)
-				{
-					transparent_nodes.emplace(distance, std::make_pair(node, sub_mesh));
-				}
-				else
-				{
-					opaque_nodes.emplace(distance, std::make_pair(node, sub_mesh));
-				}
-			}
-		}
+	if (order_independent_transparency)
+	{
+		order_independent_transparency->begin(command_buffer);
 	}
 }
 
-void GeometrySubpass::draw(CommandBuffer &command_buffer)
+namespace
 {
-	std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> opaque_nodes;
-	std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> transparent_nodes;
+/// Binding of the VertexStreamUniform in set 0, see shaders/vertex_pulling.h
+constexpr uint32_t VertexStreamBinding = 14;
 
-	get_sorted_nodes(opaque_nodes, transparent_nodes);
+/// Binding of the MotionUniform in set 0, see shaders/base.vert
+constexpr uint32_t MotionBinding = 19;
 
-	// Draw opaque objects in front-to-back order
+/**
+ * @brief Matrices a draw measures the motion of its fragments with, see shaders/base.vert
+ */
+struct MotionUniform
+{
+	glm::mat4 view_proj;
+
+	glm::mat4 previous_view_proj;
+
+	/// Moves a world position of this frame to where it was in the previous one
+	glm::mat4 world_motion;
+};
+
+/**
+ * @brief Push constants of the bounds drawn by the occlusion queries, see shaders/visibility_query.vert
+ */
+struct VisibilityQueryUniform
+{
+	glm::mat4 view_proj;
+
+	glm::vec4 bounds_min;
+
+	glm::vec4 bounds_max;
+};
+
+bool has_address(const glm::uvec2 &address)
+{
+	return address.x != 0 || address.y != 0;
+}
+
+/**
+ * @brief Fills the device address and stride of an attribute of a sub mesh, left at zero if the sub mesh has none
+ * @param format Filled with the VertexPullingFormat of the attribute, only 32-bit float pairs are accepted if null
+ * @return Whether the vertex pulling shaders can decode the attribute
+ */
+bool get_vertex_stream(const sg::SubMesh &sub_mesh, const std::string &name, glm::uvec2 &address, uint32_t &stride, uint32_t *format)
+{
+	sg::VertexAttribute attribute;
+	auto                buffer = sub_mesh.vertex_buffers.find(name);
+	if (!sub_mesh.get_attribute(name, attribute) || buffer == sub_mesh.vertex_buffers.end())
 	{
-		ScopedDebugLabel opaque_debug_label{command_buffer, "Opaque objects"};
+		return true;
+	}
 
-		for (auto node_it = opaque_nodes.begin(); node_it != opaque_nodes.end(); node_it++)
+	if (format)
+	{
+		if (attribute.format == VK_FORMAT_R32G32B32_SFLOAT)
+		{
+			*format = static_cast<uint32_t>(VertexPullingFormat::Float);
+		}
+		else if (attribute.format == VK_FORMAT_R16G16B16A16_SFLOAT)
+		{
+			*format = static_cast<uint32_t>(VertexPullingFormat::Half);
+		}
+		else
 		{
-			update_uniform(command_buffer, *node_it->second.first, thread_index);
+			return false;
+		}
+	}
+	else if (attribute.format != VK_FORMAT_R32G32_SFLOAT)
+	{
+		return false;
+	}
 
-			// Invert the front face if the mesh was flipped
-			const auto &scale      = node_it->second.first->get_transform().get_scale();
-			bool        flipped    = scale.x * scale.y * scale.z < 0;
-			VkFrontFace front_face = flipped ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	uint64_t device_address = buffer->second.get_device_address() + attribute.offset;
 
-			draw_submesh(command_buffer, *node_it->second.second, front_face);
-		}
+	address = glm::uvec2(static_cast<uint32_t>(device_address), static_cast<uint32_t>(device_address >> 32));
+	stride  = attribute.stride;
+	return true;
+}
+
+/**
+ * @brief Points the position and normal streams of a skinned sub mesh to its skinned vertices
+ */
+void set_skinned_streams(const SkinningPass &skinning_pass, const sg::SubMesh &sub_mesh, VertexStreamUniform &stream)
+{
+	uint64_t output_address = skinning_pass.get_output_buffer().get_device_address();
+
+	uint64_t position_address = output_address + skinning_pass.get_position_offset(sub_mesh);
+	stream.position_address   = glm::uvec2(static_cast<uint32_t>(position_address), static_cast<uint32_t>(position_address >> 32));
+	stream.position_stride    = to_u32(SkinningPass::OutputStride);
+	stream.position_format    = static_cast<uint32_t>(VertexPullingFormat::Float);
+
+	auto normal_offset = skinning_pass.get_normal_offset(sub_mesh);
+	if (normal_offset != VK_WHOLE_SIZE)
+	{
+		uint64_t normal_address = output_address + normal_offset;
+		stream.normal_address   = glm::uvec2(static_cast<uint32_t>(normal_address), static_cast<uint32_t>(normal_address >> 32));
+		stream.normal_stride    = to_u32(SkinningPass::OutputStride);
+		stream.normal_format    = static_cast<uint32_t>(VertexPullingFormat::Float);
 	}
+}
 
-	// Enable alpha blending
-	ColorBlendAttachmentState color_blend_attachment{};
-	color_blend_attachment.blend_enable           = VK_TRUE;
-	color_blend_attachment.src_color_blend_factor = VK_BLEND_FACTOR_SRC_ALPHA;
-	color_blend_attachment.dst_color_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-	color_blend_attachment.src_alpha_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+/**
+ * @brief Maps a non-negative distance to an integer with the same ordering
+ */
+uint32_t distance_to_key(float distance)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &distance, sizeof(bits));
 
-	ColorBlendState color_blend_state{};
-	color_blend_state.attachments.resize(get_output_attachments().size());
-	for (auto &it : color_blend_state.attachments)
+	// Positive floats compare like their bit patterns, clamp the rest to zero
+	return (bits & 0x80000000u) ? 0 : bits;
+}
+
+/**
+ * @brief Stable LSD radix sort of draw packets by their key, one byte per pass
+ *        Passes where all keys share the same byte are skipped.
+ */
+void radix_sort(std::vector<DrawPacket> &draws, std::vector<DrawPacket> &scratch)
+{
+	const size_t count = draws.size();
+	if (count < 2)
 	{
-		it = color_blend_attachment;
+		return;
 	}
-	command_buffer.set_color_blend_state(color_blend_state);
 
-	command_buffer.set_depth_stencil_state(get_depth_stencil_state());
+	scratch.resize(count);
 
-	// Draw transparent objects in back-to-front order
+	for (uint32_t shift = 0; shift < 64; shift += 8)
 	{
-		ScopedDebugLabel transparent_debug_label{command_buffer, "Transparent objects"};
+		std::array<size_t, 256> offsets{};
+		for (auto &draw : draws)
+		{
+			offsets[(draw.sort_key >> shift) & 0xFF]++;
+		}
+
+		if (offsets[(draws[0].sort_key >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
 
-		for (auto node_it = transparent_nodes.rbegin(); node_it != transparent_nodes.rend(); node_it++)
+		size_t sum = 0;
+		for (auto &offset : offsets)
 		{
-			update_uniform(command_buffer, *node_it->second.first, thread_index);
+			size_t bucket_count = offset;
+			offset              = sum;
+			sum += bucket_count;
+		}
 
-			draw_submesh(command_buffer, *node_it->second.second);
+		for (auto &draw : draws)
+		{
+			scratch[offsets[(draw.sort_key >> shift) & 0xFF]++] = draw;
 		}
+
+		draws.swap(scratch);
 	}
 }
+}        // namespace
 
-void GeometrySubpass::update_uniform(CommandBuffer &command_buffer, sg::Node &node, size_t thread_index)
+void GeometrySubpass::update_instance_bounds()
 {
-	GlobalUniform global_uniform;
+	size_t instance_count = 0;
+	for (auto &mesh : meshes)
+	{
+		instance_count += mesh->get_nodes().size();
+	}
 
-	global_uniform.camera_view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+	// Rebuild the store if nodes were added or removed since the last frame
+	if (instance_count != mesh_instances.size())
+	{
+		instance_bounds.clear();
+		mesh_instances.clear();
+		skinned_instances.clear();
 
-	auto &render_frame = get_render_context().get_active_frame();
+		for (auto &mesh : meshes)
+		{
+			bool skinned = skinning_pass && std::any_of(mesh->get_submeshes().begin(), mesh->get_submeshes().end(),
+			                                            [this](const sg::SubMesh *sub_mesh) { return skinning_pass->is_skinned(*sub_mesh); });
 
-	auto &transform = node.get_transform();
+			for (auto &node : mesh->get_nodes())
+			{
+				instance_bounds.add(mesh->get_bounds().get_min(), mesh->get_bounds().get_max());
+				mesh_instances.emplace_back(mesh, node);
+				skinned_instances.push_back(skinned);
+			}
+		}
 
-	auto allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(GlobalUniform), thread_index);
+		// The nodes may have moved to other indices, they start without motion
+		world_matrices.clear();
+	}
 
-	global_uniform.model = transform.get_world_matrix();
+	if (motion_vectors)
+	{
+		// Kept before recording, the threads recording in parallel only read them
+		bool rebuilt = world_matrices.size() != mesh_instances.size();
+		world_matrices.swap(previous_world_matrices);
+		world_matrices.resize(mesh_instances.size());
 
-	global_uniform.camera_position = glm::vec3(glm::inverse(camera.get_view())[3]);
+		for (size_t i = 0; i < mesh_instances.size(); ++i)
+		{
+			world_matrices[i] = mesh_instances[i].second->get_transform().get_world_matrix();
+		}
 
-	allocation.update(global_uniform);
+		if (rebuilt)
+		{
+			previous_world_matrices = world_matrices;
+		}
+	}
 
-	command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, 1, 0);
+	// Only boxes whose world matrix changed are transformed again
+	for (size_t i = 0; i < mesh_instances.size(); ++i)
+	{
+		auto &transform = mesh_instances[i].second->get_transform();
+		instance_bounds.set_transform(i, transform.get_world_matrix_version(), transform.get_world_matrix());
+	}
+
+	instance_bounds.update();
 }
 
-void GeometrySubpass::draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh, VkFrontFace front_face)
+void GeometrySubpass::refresh_meshes()
 {
-	auto &device = command_buffer.get_device();
+	if (scene.get_version() == scene_version)
+	{
+		return;
+	}
 
-	ScopedDebugLabel submesh_debug_label{command_buffer, sub_mesh.get_name().c_str()};
+	scene_version = scene.get_version();
 
-	prepare_pipeline_state(command_buffer, front_face, sub_mesh.get_material()->double_sided);
+	assert(!bindless_registry && "The bindless registry can't release the textures of the detached scenes");
 
-	MultisampleState multisample_state{};
-	multisample_state.rasterization_samples = get_sample_count();
-	command_buffer.set_multisample_state(multisample_state);
+	std::unordered_set<const sg::Mesh *> known_meshes{meshes.begin(), meshes.end()};
+
+	meshes = scene.get_components<sg::Mesh>();
 
-	auto &vert_shader_module = device.get_resource_cache().RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), sub_mesh.get_shader_variant());
-	auto &frag_shader_module = device.get_resource_cache().RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), sub_mesh.get_shader_variant());
+	std::unordered_set<const sg::SubMesh *> sub_meshes;
+	uint32_t                                instance_count = 0;
 
-	std::vector<ShaderModule *> shader_modules{&vert_shader_module, &frag_shader_module};
+	for (auto &mesh : meshes)
+	{
+		instance_count += to_u32(mesh->get_nodes().size());
+
+		bool known = known_meshes.count(mesh) > 0;
+
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			sub_meshes.insert(sub_mesh);
+
+			if (known)
+			{
+				continue;
+			}
 
-	auto &pipeline_layout = prepare_pipeline_layout(command_buffer, shader_modules);
+			auto &variant = sub_mesh->get_mut_shader_variant();
+			if (instancing)
+			{
+				variant.add_define("INSTANCING");
+			}
+			if (gpu_scene)
+			{
+				variant.add_define("GPU_SCENE");
+			}
+			if (global_push_constants_defined)
+			{
+				variant.add_define("GLOBAL_PUSH_CONSTANTS");
+			}
+			if (shader_precision == ShaderPrecision::Half)
+			{
+				variant.add_define("HALF_PRECISION");
+			}
+			if (order_independent_transparency && sub_mesh->get_material()->alpha_mode == sg::AlphaMode::Blend)
+			{
+				variant.add_definitions(order_independent_transparency->get_definitions());
+			}
+			if (motion_vectors && sub_mesh->get_material()->alpha_mode != sg::AlphaMode::Blend)
+			{
+				variant.add_define("MOTION_VECTORS");
+			}
+		}
+	}
 
-	command_buffer.bind_pipeline_layout(pipeline_layout);
+	// The sub meshes of the detached scenes may be destroyed, and their addresses reused by new ones
+	clear_render_proxies();
 
-	if (pipeline_layout.get_push_constant_range_stage(sizeof(PBRMaterialUniform)) != 0)
+	for (auto it = vertex_stream_offsets.begin(); it != vertex_stream_offsets.end();)
 	{
-		prepare_push_constants(command_buffer, sub_mesh);
+		it = sub_meshes.count(it->first) ? std::next(it) : vertex_stream_offsets.erase(it);
 	}
 
-	DescriptorSetLayout &descriptor_set_layout = pipeline_layout.get_descriptor_set_layout(0);
+	// Rebuilt on the next update, the instances of the detached nodes are gone
+	instance_bounds.clear();
+	mesh_instances.clear();
+	skinned_instances.clear();
 
-	for (auto &texture : sub_mesh.get_material()->textures)
+	auto &device = get_render_context().get_device();
+
+	if (gpu_scene)
+	{
+		device.get_deferred_destruction_queue().retire(std::move(gpu_scene));
+		gpu_scene = std::make_unique<GpuScene>(device, scene);
+	}
+
+	if (visibility_queries)
 	{
-		if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(texture.first))
+		if (instance_count > issued_visibility_queries.size())
+		{
+			device.get_deferred_destruction_queue().retire(std::move(visibility_queries));
+			device.get_deferred_destruction_queue().retire(std::move(visibility_predicates));
+			create_visibility_queries(instance_count);
+		}
+		else
 		{
-			command_buffer.bind_image(texture.second->get_image()->get_vk_image_view(),
-			                          texture.second->get_sampler()->vk_sampler,
-			                          0, layout_binding->binding, 0);
+			// The results of the previous frame are for the nodes at their old indices, every node is drawn once
+			std::fill(issued_visibility_queries.begin(), issued_visibility_queries.end(), 0);
 		}
 	}
 
-	auto vertex_input_resources = pipeline_layout.get_resources(ShaderResourceType::Input, VK_SHADER_STAGE_VERTEX_BIT);
+	LOGD("Refreshed the geometry subpass with {} meshes", meshes.size());
+}
+
+void GeometrySubpass::get_sorted_nodes(std::vector<DrawPacket> &opaque_nodes, std::vector<DrawPacket> &transparent_nodes)
+{
+	PROFILE_SCOPE("Sort Draws");
+
+	opaque_nodes.clear();
+	transparent_nodes.clear();
+
+	auto camera_transform = camera.get_node()->get_transform().get_world_matrix();
 
-	VertexInputState vertex_input_state;
+	update_instance_bounds();
 
-	for (auto &input_resource : vertex_input_resources)
+	if (frustum_culling)
 	{
-		sg::VertexAttribute attribute;
+		frustum.update(camera.get_projection() * camera.get_view());
+		instance_bounds.cull(frustum, instance_visibility, &JobSystem::get());
+	}
+
+	uint64_t culled_count = 0;
 
-		if (!sub_mesh.get_attribute(input_resource.name, attribute))
+	std::array<uint64_t, MaxLodCount> lod_counts{};
+
+	float lod_pixel_scale = get_lod_pixel_scale(camera.get_projection(), static_cast<float>(get_render_context().get_surface_extent().height));
+
+	for (size_t i = 0; i < mesh_instances.size(); ++i)
+	{
+		auto *mesh = mesh_instances[i].first;
+		auto *node = mesh_instances[i].second;
+
+		if (frustum_culling && !instance_visibility[i] && !skinned_instances[i])
 		{
+			culled_count += mesh->get_submeshes().size();
 			continue;
 		}
 
-		VkVertexInputAttributeDescription vertex_attribute{};
-		vertex_attribute.binding  = input_resource.location;
-		vertex_attribute.format   = attribute.format;
-		vertex_attribute.location = input_resource.location;
-		vertex_attribute.offset   = attribute.offset;
+		float    distance = glm::length(glm::vec3(camera_transform[3]) - instance_bounds.get_center(i));
+		uint32_t depth    = distance_to_key(distance);
+
+		if (texture_residency_manager)
+		{
+			// Projected radius of the bounds, assuming the textures cover the mesh once
+			float radius      = 0.5f * glm::length(instance_bounds.get_max(i) - instance_bounds.get_min(i));
+			float screen_size = radius / std::max(distance, radius) * camera.get_projection()[1][1] * get_render_context().get_surface_extent().height;
+
+			for (auto &sub_mesh : mesh->get_submeshes())
+			{
+				for (auto &texture : sub_mesh->get_material()->textures)
+				{
+					texture_residency_manager->request(*texture.second->get_image(), screen_size);
+				}
+			}
+		}
+
+		// Distance to the nearest point of the bounds, so the error never grows past the threshold inside them
+		const auto &world_matrix = node->get_transform().get_world_matrix();
+		float       lod_distance = distance - 0.5f * glm::length(instance_bounds.get_max(i) - instance_bounds.get_min(i));
+		float       object_scale = std::max({glm::length(glm::vec3(world_matrix[0])),
+		                                     glm::length(glm::vec3(world_matrix[1])),
+		                                     glm::length(glm::vec3(world_matrix[2]))});
 
-		vertex_input_state.attributes.push_back(vertex_attribute);
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			uint32_t lod = select_lod(sub_mesh->lods, lod_distance, object_scale, lod_pixel_scale, lod_threshold);
+			if (!sub_mesh->lods.empty())
+			{
+				++lod_counts[lod];
+			}
 
-		VkVertexInputBindingDescription vertex_binding{};
-		vertex_binding.binding = input_resource.location;
-		vertex_binding.stride  = attribute.stride;
+			// Group draws at the same depth by shader variant, then by material
+			uint64_t state_key = ((sub_mesh->get_shader_variant().get_id() & 0xFFFF) << 16) |
+			                     (std::hash<const sg::Material *>{}(sub_mesh->get_material()) & 0xFFFF);
 
-		vertex_input_state.bindings.push_back(vertex_binding);
+			if (sub_mesh->get_material()->alpha_mode == sg::AlphaMode::Blend)
+			{
+				transparent_nodes.push_back({(static_cast<uint64_t>(~depth) << 32) | state_key, node, sub_mesh, lod, 0, 1, to_u32(i)});
+			}
+			else
+			{
+				opaque_nodes.push_back({(static_cast<uint64_t>(depth) << 32) | state_key, node, sub_mesh, lod, 0, 1, to_u32(i)});
+			}
+		}
 	}
 
-	command_buffer.set_vertex_input_state(vertex_input_state);
+	radix_sort(opaque_nodes, sort_scratch);
+	radix_sort(transparent_nodes, sort_scratch);
+
+	get_render_context().record_draws(opaque_nodes.size() + transparent_nodes.size(), culled_count);
+	get_render_context().record_lod_draws(lod_counts);
+}
+
+size_t GeometrySubpass::InstanceBatchKeyHash::operator()(const InstanceBatchKey &key) const
+{
+	size_t seed = 0;
+	hash_combine(seed, key.first);
+	hash_combine(seed, key.second);
+	return seed;
+}
 
-	// Find submesh vertex buffers matching the shader input attribute names
-	for (auto &input_resource : vertex_input_resources)
+void GeometrySubpass::batch_instances(std::vector<DrawPacket> &opaque_nodes, std::vector<DrawPacket> &transparent_nodes)
+{
+	PROFILE_SCOPE("Batch Instances");
+
+	instance_batch_indices.clear();
+	instance_batches.resize(opaque_nodes.size());
+
+	// Batches are created in the order of their nearest draw, so they stay sorted front-to-back
+	sort_scratch.clear();
+	for (size_t i = 0; i < opaque_nodes.size(); ++i)
 	{
-		const auto &buffer_iter = sub_mesh.vertex_buffers.find(input_resource.name);
+		auto &draw = opaque_nodes[i];
 
-		if (buffer_iter != sub_mesh.vertex_buffers.end())
-		{
-			std::vector<std::reference_wrapper<const vkb::core::BufferC>> buffers;
-			buffers.emplace_back(std::ref(buffer_iter->second));
+		// Draws of a batch share the front face, which is inverted if the mesh was flipped
+		const auto &scale   = draw.node->get_transform().get_scale();
+		uint32_t    flipped = scale.x * scale.y * scale.z < 0 ? 1 : 0;
 
-			// Bind vertex buffers only for the attribute locations defined
-			command_buffer.bind_vertex_buffers(input_resource.location, std::move(buffers), {0});
+		auto it = instance_batch_indices.emplace(InstanceBatchKey{draw.sub_mesh, (draw.lod << 1) | flipped}, to_u32(sort_scratch.size()));
+		if (it.second)
+		{
+			sort_scratch.push_back(draw);
+			sort_scratch.back().instance_count = 0;
 		}
+
+		instance_batches[i] = it.first->second;
+		sort_scratch[it.first->second].instance_count++;
 	}
 
-	draw_submesh_command(command_buffer, sub_mesh);
-}
+	uint32_t instance_count = 0;
+	for (auto &batch : sort_scratch)
+	{
+		batch.first_instance = instance_count;
+		instance_count += batch.instance_count;
+		batch.instance_count = 0;
+	}
 
-void GeometrySubpass::prepare_pipeline_state(CommandBuffer &command_buffer, VkFrontFace front_face, bool double_sided_material)
-{
-	RasterizationState rasterization_state = base_rasterization_state;
-	rasterization_state.front_face         = front_face;
+	instance_transforms.resize(opaque_nodes.size() + transparent_nodes.size());
 
-	if (double_sided_material)
+	for (size_t i = 0; i < opaque_nodes.size(); ++i)
 	{
-		rasterization_state.cull_mode = VK_CULL_MODE_NONE;
+		auto &batch = sort_scratch[instance_batches[i]];
+		instance_transforms[batch.first_instance + batch.instance_count++] = opaque_nodes[i].node->get_transform().get_world_matrix();
 	}
 
-	command_buffer.set_rasterization_state(rasterization_state);
+	// Transparent draws depend on their order, they are never merged
+	for (auto &draw : transparent_nodes)
+	{
+		draw.first_instance                   = instance_count;
+		instance_transforms[instance_count++] = draw.node->get_transform().get_world_matrix();
+	}
 
-	MultisampleState multisample_state{};
-	multisample_state.rasterization_samples = get_sample_count();
-	command_buffer.set_multisample_state(multisample_state);
+	opaque_nodes.swap(sort_scratch);
 }
 
-PipelineLayout &GeometrySubpass::prepare_pipeline_layout(CommandBuffer &command_buffer, const std::vector<ShaderModule *> &shader_modules)
+void GeometrySubpass::bind_instances(CommandBuffer &command_buffer)
 {
-	// Sets any specified resource modes
-	for (auto &shader_module : shader_modules)
+	command_buffer.bind_buffer(instance_allocation.get_buffer(), instance_allocation.get_offset(), instance_allocation.get_size(), 0, 5, 0);
+}
+
+void GeometrySubpass::draw(CommandBuffer &command_buffer)
+{
+	get_sorted_nodes(opaque_draws, transparent_draws);
+
+	if (motion_vectors)
 	{
-		for (auto &resource_mode : get_resource_mode_map())
+		// The jitter moves every sample, the motion is measured without it
+		auto *perspective_camera = dynamic_cast<sg::PerspectiveCamera *>(&camera);
+		auto  projection         = perspective_camera ? perspective_camera->get_unjittered_projection() : camera.get_projection();
+
+		previous_motion_view_proj = motion_view_proj;
+		motion_view_proj          = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(projection) * camera.get_view();
+
+		if (!motion_view_proj_valid)
 		{
-			shader_module->set_resource_mode(resource_mode.first, resource_mode.second);
+			previous_motion_view_proj = motion_view_proj;
+			motion_view_proj_valid    = true;
 		}
 	}
 
-	return command_buffer.get_device().get_resource_cache().RequestPipelineLayout(shader_modules);
-}
+	if (instancing)
+	{
+		batch_instances(opaque_draws, transparent_draws);
 
-void GeometrySubpass::prepare_push_constants(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh)
-{
-	auto pbr_material = dynamic_cast<const sg::PBRMaterial *>(sub_mesh.get_material());
+		if (instance_transforms.empty())
+		{
+			return;
+		}
 
-	PBRMaterialUniform pbr_material_uniform{};
-	pbr_material_uniform.base_color_factor = pbr_material->base_color_factor;
-	pbr_material_uniform.metallic_factor   = pbr_material->metallic_factor;
-	pbr_material_uniform.roughness_factor  = pbr_material->roughness_factor;
+		// Shared by the draws of every thread, so it is written before any draw is recorded
+		auto size           = instance_transforms.size() * sizeof(glm::mat4);
+		instance_allocation = get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, size, thread_index);
+		instance_allocation.update(instance_transforms.data(), size);
+	}
+
+	if (gpu_scene)
+	{
+		// The draws select the world matrix of their node with their first instance
+		for (auto draws : {&opaque_draws, &transparent_draws})
+		{
+			for (auto &draw : *draws)
+			{
+				draw.first_instance = gpu_scene->get_index(*draw.node);
+			}
+		}
 
-	auto data = to_bytes(pbr_material_uniform);
+		GlobalUniform global_uniform{};
+		global_uniform.model            = glm::mat4(1.0f);
+		global_uniform.camera_view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+		global_uniform.camera_position  = glm::vec3(glm::inverse(camera.get_view())[3]);
+
+		frame_uniform_allocation = get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(GlobalUniform), thread_index);
+		frame_uniform_allocation.update(global_uniform);
+	}
 
-	if (!data.empty())
+	// Nested secondary command buffers are not allowed, record inline if called from one
+	if (command_buffer.level == VK_COMMAND_BUFFER_LEVEL_PRIMARY && get_subpass_contents() == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
 	{
-		command_buffer.push_constants(data);
+		draw_parallel(command_buffer);
+		return;
 	}
-}
 
-void GeometrySubpass::draw_submesh_command(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh)
-{
-	// Draw submesh indexed if indices exists
-	if (sub_mesh.vertex_indices != 0)
+	// Draw opaque objects in front-to-back order
 	{
-		// Bind index buffer of submesh
-		command_buffer.bind_index_buffer(*sub_mesh.index_buffer, sub_mesh.index_offset, sub_mesh.index_type);
+		ScopedDebugLabel opaque_debug_label{command_buffer, "Opaque objects"};
 
-		// Draw submesh using indexed data
-		command_buffer.draw_indexed(sub_mesh.vertex_indices, 1, 0, 0, 0);
+		draw_opaque(command_buffer, 0, opaque_draws.size(), thread_index);
 	}
-	else
+
+	if (visibility_queries)
+	{
+		draw_visibility_queries(command_buffer);
+	}
+
+	// Draw transparent objects in back-to-front order
+	{
+		ScopedDebugLabel transparent_debug_label{command_buffer, "Transparent objects"};
+
+		draw_transparent(command_buffer, thread_index);
+	}
+}
+
+void GeometrySubpass::draw_opaque(CommandBuffer &command_buffer, size_t first, size_t last, size_t thread_index)
+{
+	for (size_t i = first; i < last; ++i)
+	{
+		auto &draw = opaque_draws[i];
+
+		update_uniform(command_buffer, *draw.node, *draw.sub_mesh, thread_index);
+
+		if (instancing)
+		{
+			bind_instances(command_buffer);
+		}
+
+		if (motion_vectors)
+		{
+			bind_motion_uniform(command_buffer, draw, thread_index);
+		}
+
+		// Invert the front face if the mesh was flipped
+		const auto &scale      = draw.node->get_transform().get_scale();
+		bool        flipped    = scale.x * scale.y * scale.z < 0;
+		VkFrontFace front_face = flipped ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+		// Nodes added since enable_conditional_rendering() have no query, they are always drawn
+		bool conditional = visibility_queries && draw.instance_index < issued_visibility_queries.size() &&
+	                   !(draw.instance_index < skinned_instances.size() && skinned_instances[draw.instance_index]);
+		if (conditional)
+		{
+			VkConditionalRenderingBeginInfoEXT conditional_rendering_info{VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT};
+			conditional_rendering_info.buffer = visibility_predicates->get_handle();
+			conditional_rendering_info.offset = draw.instance_index * sizeof(uint32_t);
+			vkCmdBeginConditionalRenderingEXT(command_buffer.get_handle(), &conditional_rendering_info);
+		}
+
+		draw_submesh(command_buffer, *draw.sub_mesh, front_face, draw.lod, draw.first_instance, draw.instance_count);
+
+		if (conditional)
+		{
+			vkCmdEndConditionalRenderingEXT(command_buffer.get_handle());
+		}
+	}
+}
+
+void GeometrySubpass::draw_transparent(CommandBuffer &command_buffer, size_t thread_index)
+{
+	ColorBlendAttachmentState color_blend_attachment{};
+	auto                      depth_stencil_state = get_depth_stencil_state();
+
+	if (order_independent_transparency)
+	{
+		// The fragments are stored in the k-buffer, and tested against the opaque depth without writing it
+		color_blend_attachment.color_write_mask = 0;
+		depth_stencil_state.depth_write_enable  = VK_FALSE;
+
+		order_independent_transparency->bind(command_buffer);
+	}
+	else
+	{
+		// Enable alpha blending
+		color_blend_attachment.blend_enable           = VK_TRUE;
+		color_blend_attachment.src_color_blend_factor = VK_BLEND_FACTOR_SRC_ALPHA;
+		color_blend_attachment.dst_color_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		color_blend_attachment.src_alpha_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	}
+
+	ColorBlendState color_blend_state{};
+	color_blend_state.attachments.resize(get_output_attachments().size());
+	for (auto &it : color_blend_state.attachments)
+	{
+		it = color_blend_attachment;
+	}
+
+	// The transparent fragments don't write motion, the motion of the opaque ones behind them is kept
+	if (motion_vectors && color_blend_state.attachments.size() > 1)
+	{
+		color_blend_state.attachments[1].color_write_mask = 0;
+	}
+
+	command_buffer.set_color_blend_state(color_blend_state);
+
+	command_buffer.set_depth_stencil_state(depth_stencil_state);
+
+	for (auto &draw : transparent_draws)
+	{
+		update_uniform(command_buffer, *draw.node, *draw.sub_mesh, thread_index);
+
+		if (instancing)
+		{
+			bind_instances(command_buffer);
+		}
+
+		draw_submesh(command_buffer, *draw.sub_mesh, VK_FRONT_FACE_COUNTER_CLOCKWISE, draw.lod, draw.first_instance, draw.instance_count);
+	}
+}
+
+void GeometrySubpass::draw_parallel(CommandBuffer &primary_command_buffer)
+{
+	auto &render_context = get_render_context();
+	auto &render_frame   = render_context.get_active_frame();
+
+	// The calling thread records the transparent draws with the resources of the last thread,
+	// the workers record the opaque draws with the resources of the others
+	const auto worker_count = render_context.get_thread_count() - 1;
+
+	const size_t chunk_count = std::max<size_t>(std::min(worker_count, opaque_draws.size()), 1);
+	const size_t chunk_size  = (opaque_draws.size() + chunk_count - 1) / chunk_count;
+
+	// Secondary command buffers are requested up front, the frame's command pools are not thread safe
+	const auto &queue = render_context.get_device().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+
+	std::vector<CommandBuffer *> secondary_command_buffers(chunk_count + 1);
+	for (size_t i = 0; i < secondary_command_buffers.size(); ++i)
+	{
+		secondary_command_buffers[i] = &render_frame.RequestCommandBuffer(queue, primary_command_buffer.get_reset_mode(), VK_COMMAND_BUFFER_LEVEL_SECONDARY, std::min(i, worker_count));
+	}
+
+	const auto &extent = render_frame.get_render_target().get_extent();
+
+	auto begin_secondary = [&](CommandBuffer &command_buffer) {
+		command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &primary_command_buffer);
+
+		// Such as the lights and the textures bound by the derived subpasses before drawing
+		command_buffer.bind_resources(primary_command_buffer);
+
+		// Viewport and scissor are not inherited from the primary command buffer
+		VkViewport viewport{};
+		viewport.width    = static_cast<float>(extent.width);
+		viewport.height   = static_cast<float>(extent.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		command_buffer.set_viewport(0, {viewport});
+
+		VkRect2D scissor{};
+		scissor.extent = extent;
+		command_buffer.set_scissor(0, {scissor});
+	};
+
+	auto &jobs = JobSystem::get();
+
+	JobCounter recording;
+	for (size_t i = 0; i < chunk_count; ++i)
+	{
+		const size_t first = i * chunk_size;
+		const size_t last  = std::min(first + chunk_size, opaque_draws.size());
+
+		// Chunk i uses the resources of thread i, whichever worker picks it up
+		jobs.schedule(
+		    [this, &begin_secondary, &secondary_command_buffers, i, first, last]() {
+			    PROFILE_SCOPE("Record Opaque");
+
+			    auto &command_buffer = *secondary_command_buffers[i];
+
+			    begin_secondary(command_buffer);
+			    draw_opaque(command_buffer, first, last, i);
+			    command_buffer.end();
+		    },
+		    &recording);
+	}
+
+	// Transparent draws depend on their order, they are recorded on a single thread
+	{
+		PROFILE_SCOPE("Record Transparent");
+
+		auto &transparent_command_buffer = *secondary_command_buffers.back();
+
+		begin_secondary(transparent_command_buffer);
+
+		// Executed after the opaque draws, so the bounds are tested against their depth
+		if (visibility_queries)
+		{
+			draw_visibility_queries(transparent_command_buffer);
+		}
+
+		draw_transparent(transparent_command_buffer, worker_count);
+		transparent_command_buffer.end();
+	}
+
+	jobs.wait(recording);
+
+	primary_command_buffer.execute_commands(secondary_command_buffers);
+}
+
+void GeometrySubpass::update_uniform(CommandBuffer &command_buffer, sg::Node &node, sg::SubMesh &sub_mesh, size_t thread_index)
+{
+	if (get_render_proxy(command_buffer, sub_mesh).global_push_constants)
+	{
+		GlobalUniform global_uniform;
+		global_uniform.model            = node.get_transform().get_world_matrix();
+		global_uniform.camera_view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+		global_uniform.camera_position  = glm::vec3(glm::inverse(camera.get_view())[3]);
+		global_uniform.position_offset  = sub_mesh.position_offset;
+		global_uniform.position_scale   = sub_mesh.position_scale;
+
+		// bind_material() pushes the material right after it
+		command_buffer.push_constants(global_uniform);
+
+		if (gpu_scene)
+		{
+			gpu_scene->bind(command_buffer);
+		}
+		return;
+	}
+
+	if (gpu_scene)
+	{
+		gpu_scene->bind(command_buffer);
+
+		// Packed positions need the bounds of their sub mesh, so those draws get a uniform of their own
+		sg::VertexAttribute position;
+		if (!sub_mesh.get_attribute("position", position) || position.format != VK_FORMAT_R16G16B16A16_UNORM)
+		{
+			command_buffer.bind_buffer(frame_uniform_allocation.get_buffer(), frame_uniform_allocation.get_offset(), frame_uniform_allocation.get_size(), 0, 1, 0);
+			return;
+		}
+	}
+
+	GlobalUniform global_uniform;
+
+	global_uniform.camera_view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+
+	auto &render_frame = get_render_context().get_active_frame();
+
+	auto &transform = node.get_transform();
+
+	auto allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(GlobalUniform), thread_index);
+
+	global_uniform.model = transform.get_world_matrix();
+
+	global_uniform.camera_position = glm::vec3(glm::inverse(camera.get_view())[3]);
+
+	global_uniform.position_offset = sub_mesh.position_offset;
+
+	global_uniform.position_scale = sub_mesh.position_scale;
+
+	allocation.update(global_uniform);
+
+	command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, 1, 0);
+}
+
+void GeometrySubpass::bind_motion_uniform(CommandBuffer &command_buffer, const DrawPacket &draw, size_t thread_index)
+{
+	MotionUniform uniform;
+	uniform.view_proj          = motion_view_proj;
+	uniform.previous_view_proj = previous_motion_view_proj;
+	uniform.world_motion       = glm::mat4(1.0f);
+
+	// The world matrices of instanced draws and draws with a GPU scene are read on the GPU, only the camera moves them
+	if (!instancing && !gpu_scene && draw.instance_index < world_matrices.size())
+	{
+		const auto &world_matrix          = world_matrices[draw.instance_index];
+		const auto &previous_world_matrix = previous_world_matrices[draw.instance_index];
+		if (world_matrix != previous_world_matrix)
+		{
+			uniform.world_motion = previous_world_matrix * glm::inverse(world_matrix);
+		}
+	}
+
+	auto allocation = get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(MotionUniform), thread_index);
+	allocation.update(uniform);
+
+	command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, MotionBinding, 0);
+}
+
+void GeometrySubpass::draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh, VkFrontFace front_face, uint32_t lod, uint32_t first_instance, uint32_t instance_count)
+{
+	ScopedDebugLabel submesh_debug_label{command_buffer, sub_mesh.get_name().c_str()};
+
+	prepare_pipeline_state(command_buffer, front_face, sub_mesh.get_material()->double_sided);
+
+	auto &proxy = get_render_proxy(command_buffer, sub_mesh);
+
+	command_buffer.bind_pipeline_layout(*proxy.pipeline_layout);
+
+	bind_material(command_buffer, proxy, sub_mesh);
+
+	// The vertex pulling variants have no vertex inputs, so no vertex buffers are bound below
+	if (proxy.vertex_pulling)
+	{
+		command_buffer.bind_buffer(*vertex_stream_buffer, proxy.vertex_stream_offset, sizeof(VertexStreamUniform), 0, VertexStreamBinding, 0);
+	}
+
+	command_buffer.set_vertex_input_state(proxy.vertex_input_state);
+
+	for (auto &[binding, buffer, offset] : proxy.vertex_buffers)
+	{
+		// Bind vertex buffers only for the attribute locations defined
+		command_buffer.bind_vertex_buffers(binding, {std::cref(*buffer)}, {offset});
+	}
+
+	if (instancing || gpu_scene || (lod > 0 && lod < sub_mesh.lods.size()))
+	{
+		if (sub_mesh.vertex_indices == 0)
+		{
+			command_buffer.draw(sub_mesh.vertices_count, instance_count, 0, first_instance);
+			return;
+		}
+
+		// The levels share the vertices of the full mesh
+		uint32_t first_index = 0;
+		uint32_t index_count = sub_mesh.vertex_indices;
+		if (lod > 0 && lod < sub_mesh.lods.size())
+		{
+			first_index = sub_mesh.lods[lod].first_index;
+			index_count = sub_mesh.lods[lod].index_count;
+		}
+
+		command_buffer.bind_index_buffer(*sub_mesh.index_buffer, sub_mesh.index_offset, sub_mesh.index_type);
+		command_buffer.draw_indexed(index_count, instance_count, first_index, 0, first_instance);
+		return;
+	}
+
+	draw_submesh_command(command_buffer, sub_mesh);
+}
+
+const GeometrySubpass::RenderProxy &GeometrySubpass::get_render_proxy(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh)
+{
+	// The workers recording in parallel may draw the same sub mesh, the first one bakes its proxy
+	std::lock_guard<std::mutex> guard(render_proxies_mutex);
+
+	auto it = render_proxies.find(&sub_mesh);
+	if (it == render_proxies.end())
+	{
+		it = render_proxies.emplace(&sub_mesh, bake_render_proxy(command_buffer, sub_mesh)).first;
+	}
+
+	// Inserting doesn't move the other elements, the reference stays valid until clear_render_proxies()
+	return it->second;
+}
+
+GeometrySubpass::RenderProxy GeometrySubpass::bake_render_proxy(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh)
+{
+	auto &resource_cache = command_buffer.get_device().get_resource_cache();
+
+	auto &vert_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), sub_mesh.get_shader_variant());
+	auto &frag_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), sub_mesh.get_shader_variant());
+
+	RenderProxy proxy;
+	proxy.pipeline_layout = &prepare_pipeline_layout(command_buffer, {&vert_shader_module, &frag_shader_module});
+
+	auto push_constants_size = bindless_registry ? sizeof(BindlessMaterialUniform) : sizeof(PBRMaterialUniform);
+	proxy.push_constants     = proxy.pipeline_layout->get_push_constant_range_stage(to_u32(push_constants_size)) != 0;
+
+	// Set by the GLOBAL_PUSH_CONSTANTS variants, the shaders without it keep the global uniform buffer
+	proxy.global_push_constants = proxy.pipeline_layout->get_push_constant_range_stage(to_u32(sizeof(GlobalUniform) + push_constants_size)) != 0;
+
+	// Textures are indexed through the push constants with a bindless registry
+	if (!bindless_registry)
+	{
+		DescriptorSetLayout &descriptor_set_layout = proxy.pipeline_layout->get_descriptor_set_layout(0);
+
+		auto *material = sub_mesh.get_material();
+		auto &bindings = descriptor_set_layout.GetBindingTable(sg::material_texture_names);
+		for (uint32_t i = 0; i < sg::MaterialTextureCount; ++i)
+		{
+			if (material->get_texture_slots()[i] && bindings[i] != DescriptorSetLayout::NoBinding)
+			{
+				proxy.textures.emplace_back(bindings[i], material->get_texture_slots()[i]);
+			}
+		}
+
+		for (auto &texture : material->get_other_textures())
+		{
+			if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(texture.first))
+			{
+				proxy.textures.emplace_back(layout_binding->binding, texture.second);
+			}
+		}
+	}
+
+	auto stream_offset = vertex_stream_offsets.find(&sub_mesh);
+	if (stream_offset != vertex_stream_offsets.end())
+	{
+		proxy.vertex_pulling       = true;
+		proxy.vertex_stream_offset = stream_offset->second;
+	}
+
+	bool skinned = skinning_pass && skinning_pass->is_skinned(sub_mesh);
+
+	// Find submesh vertex attributes and buffers matching the shader input attribute names
+	for (auto &input_resource : proxy.pipeline_layout->get_resources(ShaderResourceType::Input, VK_SHADER_STAGE_VERTEX_BIT))
+	{
+		sg::VertexAttribute attribute;
+
+		// The skinned positions and normals are tightly packed floats in the output of the skinning pass
+		VkDeviceSize skinned_offset = VK_WHOLE_SIZE;
+		if (skinned && input_resource.name == "position")
+		{
+			skinned_offset = skinning_pass->get_position_offset(sub_mesh);
+		}
+		else if (skinned && input_resource.name == "normal")
+		{
+			skinned_offset = skinning_pass->get_normal_offset(sub_mesh);
+		}
+
+		if (skinned_offset != VK_WHOLE_SIZE)
+		{
+			VkVertexInputAttributeDescription vertex_attribute{};
+			vertex_attribute.binding  = input_resource.location;
+			vertex_attribute.format   = VK_FORMAT_R32G32B32_SFLOAT;
+			vertex_attribute.location = input_resource.location;
+
+			proxy.vertex_input_state.attributes.push_back(vertex_attribute);
+
+			VkVertexInputBindingDescription vertex_binding{};
+			vertex_binding.binding = input_resource.location;
+			vertex_binding.stride  = to_u32(SkinningPass::OutputStride);
+
+			proxy.vertex_input_state.bindings.push_back(vertex_binding);
+
+			proxy.vertex_buffers.emplace_back(input_resource.location, &skinning_pass->get_output_buffer(), skinned_offset);
+			continue;
+		}
+
+		if (sub_mesh.get_attribute(input_resource.name, attribute))
+		{
+			VkVertexInputAttributeDescription vertex_attribute{};
+			vertex_attribute.binding  = input_resource.location;
+			vertex_attribute.format   = attribute.format;
+			vertex_attribute.location = input_resource.location;
+			vertex_attribute.offset   = attribute.offset;
+
+			proxy.vertex_input_state.attributes.push_back(vertex_attribute);
+
+			VkVertexInputBindingDescription vertex_binding{};
+			vertex_binding.binding = input_resource.location;
+			vertex_binding.stride  = attribute.stride;
+
+			proxy.vertex_input_state.bindings.push_back(vertex_binding);
+		}
+
+		auto buffer_iter = sub_mesh.vertex_buffers.find(input_resource.name);
+		if (buffer_iter != sub_mesh.vertex_buffers.end())
+		{
+			proxy.vertex_buffers.emplace_back(input_resource.location, &buffer_iter->second, 0);
+		}
+	}
+
+	return proxy;
+}
+
+void GeometrySubpass::clear_render_proxies()
+{
+	std::lock_guard<std::mutex> guard(render_proxies_mutex);
+	render_proxies.clear();
+}
+
+void GeometrySubpass::bind_material(CommandBuffer &command_buffer, const RenderProxy &proxy, sg::SubMesh &sub_mesh)
+{
+	if (bindless_registry)
+	{
+		// Textures are indexed through the push constants, the array is the same for every draw
+		command_buffer.bind_descriptor_set(BindlessRegistry::SetIndex, bindless_registry->get_descriptor_set());
+	}
+
+	if (proxy.push_constants)
+	{
+		prepare_push_constants(command_buffer, sub_mesh);
+	}
+
+	for (auto &texture : proxy.textures)
+	{
+		command_buffer.bind_image(texture.second->get_image()->get_vk_image_view(), texture.second->get_sampler()->vk_sampler, 0, texture.first, 0);
+	}
+}
+
+void GeometrySubpass::bind_material(CommandBuffer &command_buffer, PipelineLayout &pipeline_layout, sg::SubMesh &sub_mesh)
+{
+	if (bindless_registry)
+	{
+		// Textures are indexed through the push constants, the array is the same for every draw
+		command_buffer.bind_descriptor_set(BindlessRegistry::SetIndex, bindless_registry->get_descriptor_set());
+
+		if (pipeline_layout.get_push_constant_range_stage(sizeof(BindlessMaterialUniform)) != 0)
+		{
+			prepare_push_constants(command_buffer, sub_mesh);
+		}
+	}
+	else
+	{
+		if (pipeline_layout.get_push_constant_range_stage(sizeof(PBRMaterialUniform)) != 0)
+		{
+			prepare_push_constants(command_buffer, sub_mesh);
+		}
+
+		DescriptorSetLayout &descriptor_set_layout = pipeline_layout.get_descriptor_set_layout(0);
+
+		auto *material = sub_mesh.get_material();
+		auto &bindings = descriptor_set_layout.GetBindingTable(sg::material_texture_names);
+		for (uint32_t i = 0; i < sg::MaterialTextureCount; ++i)
+		{
+			auto *texture = material->get_texture_slots()[i];
+			if (texture && bindings[i] != DescriptorSetLayout::NoBinding)
+			{
+				command_buffer.bind_image(texture->get_image()->get_vk_image_view(), texture->get_sampler()->vk_sampler, 0, bindings[i], 0);
+			}
+		}
+
+		for (auto &texture : material->get_other_textures())
+		{
+			if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(texture.first))
+			{
+				command_buffer.bind_image(texture.second->get_image()->get_vk_image_view(),
+				                          texture.second->get_sampler()->vk_sampler,
+				                          0, layout_binding->binding, 0);
+			}
+		}
+	}
+}
+
+void GeometrySubpass::prepare_pipeline_state(CommandBuffer &command_buffer, VkFrontFace front_face, bool double_sided_material)
+{
+	RasterizationState rasterization_state = base_rasterization_state;
+	rasterization_state.front_face         = front_face;
+
+	if (double_sided_material)
+	{
+		rasterization_state.cull_mode = VK_CULL_MODE_NONE;
+	}
+
+	command_buffer.set_rasterization_state(rasterization_state);
+
+	MultisampleState multisample_state{};
+	multisample_state.rasterization_samples = get_sample_count();
+	command_buffer.set_multisample_state(multisample_state);
+}
+
+PipelineLayout &GeometrySubpass::prepare_pipeline_layout(CommandBuffer &command_buffer, const std::vector<ShaderModule *> &shader_modules)
+{
+	// The material textures change at every draw, so their set is pushed rather than allocated if the device allows it,
+	// which it doesn't with the dynamic global uniform in the same set
+	bool push_material = constant_delivery != ConstantDelivery::DynamicUniformBuffer &&
+	                     command_buffer.get_device().is_enabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+
+	// Sets any specified resource modes
+	for (auto &shader_module : shader_modules)
+	{
+		if (constant_delivery == ConstantDelivery::DynamicUniformBuffer)
+		{
+			shader_module->set_resource_mode("GlobalUniform", ShaderResourceMode::Dynamic);
+		}
+
+		if (push_material)
+		{
+			for (auto &resource : shader_module->get_resources())
+			{
+				if (resource.set == 0 && resource.type == ShaderResourceType::ImageSampler &&
+				    std::find(sg::material_texture_names.begin(), sg::material_texture_names.end(), resource.name) != sg::material_texture_names.end())
+				{
+					shader_module->set_resource_mode(resource.name, ShaderResourceMode::PerDraw);
+				}
+			}
+		}
+
+		for (auto &resource_mode : get_resource_mode_map())
+		{
+			shader_module->set_resource_mode(resource_mode.first, resource_mode.second);
+		}
+
+		if (bindless_registry)
+		{
+			auto &resources = shader_module->get_resources();
+			if (std::find_if(resources.begin(), resources.end(), [](const ShaderResource &resource) { return resource.name == BindlessRegistry::ResourceName; }) != resources.end())
+			{
+				shader_module->set_resource_mode(BindlessRegistry::ResourceName, ShaderResourceMode::Bindless);
+			}
+		}
+	}
+
+	return command_buffer.get_device().get_resource_cache().RequestPipelineLayout(shader_modules);
+}
+
+void GeometrySubpass::prepare_push_constants(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh)
+{
+	auto pbr_material = dynamic_cast<const sg::PBRMaterial *>(sub_mesh.get_material());
+
+	if (bindless_registry)
+	{
+		BindlessMaterialUniform bindless_material_uniform{};
+		bindless_material_uniform.base_color_factor        = pbr_material->base_color_factor;
+		bindless_material_uniform.metallic_factor          = pbr_material->metallic_factor;
+		bindless_material_uniform.roughness_factor         = pbr_material->roughness_factor;
+		bindless_material_uniform.base_color_texture_index = bindless_base_color_indices.at(sub_mesh.get_material());
+
+		command_buffer.push_constants(bindless_material_uniform);
+		return;
+	}
+
+	PBRMaterialUniform pbr_material_uniform{};
+	pbr_material_uniform.base_color_factor = pbr_material->base_color_factor;
+	pbr_material_uniform.metallic_factor   = pbr_material->metallic_factor;
+	pbr_material_uniform.roughness_factor  = pbr_material->roughness_factor;
+
+	command_buffer.push_constants(pbr_material_uniform);
+}
+
+void GeometrySubpass::draw_submesh_command(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh)
+{
+	// Draw submesh indexed if indices exists
+	if (sub_mesh.vertex_indices != 0)
+	{
+		// Bind index buffer of submesh
+		command_buffer.bind_index_buffer(*sub_mesh.index_buffer, sub_mesh.index_offset, sub_mesh.index_type);
+
+		// Draw submesh using indexed data
+		command_buffer.draw_indexed(sub_mesh.vertex_indices, 1, 0, 0, 0);
+	}
+	else
 	{
 		// Draw submesh using vertices only
 		command_buffer.draw(sub_mesh.vertices_count, 1, 0, 0);
 	}
 }
 
+void GeometrySubpass::update_visibility_predicates(CommandBuffer &command_buffer)
+{
+	// The draws of the previous frame read the predicates before they are written again
+	BufferMemoryBarrier reuse_barrier{};
+	reuse_barrier.src_stage_mask  = VK_PIPELINE_STAGE_CONDITIONAL_RENDERING_BIT_EXT;
+	reuse_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	reuse_barrier.dst_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*visibility_predicates, 0, VK_WHOLE_SIZE, reuse_barrier);
+
+	// Any non-zero predicate draws, so the nodes without a result stay visible
+	vkCmdFillBuffer(command_buffer.get_handle(), visibility_predicates->get_handle(), 0, VK_WHOLE_SIZE, 1);
+
+	BufferMemoryBarrier fill_barrier{};
+	fill_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	fill_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	fill_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	fill_barrier.dst_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*visibility_predicates, 0, VK_WHOLE_SIZE, fill_barrier);
+
+	// The results are waited for on the GPU, only the ranges of queries issued are copied as the others never become available
+	auto query_count = to_u32(issued_visibility_queries.size());
+	for (uint32_t first = 0; first < query_count;)
+	{
+		if (!issued_visibility_queries[first])
+		{
+			++first;
+			continue;
+		}
+
+		uint32_t last = first;
+		while (last < query_count && issued_visibility_queries[last])
+		{
+			++last;
+		}
+
+		vkCmdCopyQueryPoolResults(command_buffer.get_handle(), visibility_queries->get_handle(), first, last - first,
+		                          visibility_predicates->get_handle(), first * sizeof(uint32_t), sizeof(uint32_t), VK_QUERY_RESULT_WAIT_BIT);
+		first = last;
+	}
+
+	BufferMemoryBarrier predicate_barrier{};
+	predicate_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	predicate_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_CONDITIONAL_RENDERING_BIT_EXT;
+	predicate_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	predicate_barrier.dst_access_mask = VK_ACCESS_CONDITIONAL_RENDERING_READ_BIT_EXT;
+	command_buffer.buffer_memory_barrier(*visibility_predicates, 0, VK_WHOLE_SIZE, predicate_barrier);
+
+	command_buffer.reset_query_pool(*visibility_queries, 0, query_count);
+	std::fill(issued_visibility_queries.begin(), issued_visibility_queries.end(), 0);
+}
+
+void GeometrySubpass::draw_visibility_queries(CommandBuffer &command_buffer)
+{
+	ScopedDebugLabel debug_label{command_buffer, "Visibility queries"};
+
+	auto &resource_cache  = command_buffer.get_device().get_resource_cache();
+	auto &vertex_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, visibility_vertex_shader, {});
+	auto &fragment_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, visibility_fragment_shader, {});
+	command_buffer.bind_pipeline_layout(resource_cache.RequestPipelineLayout({&vertex_module, &fragment_module}));
+
+	// The corners of the bounds are generated from the vertex index
+	command_buffer.set_vertex_input_state({});
+
+	// Both faces are drawn, so the winding of the box doesn't matter
+	RasterizationState rasterization_state{};
+	rasterization_state.cull_mode = VK_CULL_MODE_NONE;
+	command_buffer.set_rasterization_state(rasterization_state);
+
+	ColorBlendState color_blend_state{};
+	color_blend_state.attachments.resize(get_output_attachments().size());
+	for (auto &attachment : color_blend_state.attachments)
+	{
+		attachment.color_write_mask = 0;
+	}
+	command_buffer.set_color_blend_state(color_blend_state);
+
+	auto depth_stencil_state               = get_depth_stencil_state();
+	depth_stencil_state.depth_write_enable = VK_FALSE;
+	command_buffer.set_depth_stencil_state(depth_stencil_state);
+
+	VisibilityQueryUniform uniform{};
+	uniform.view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+
+	auto camera_position = glm::vec3(glm::inverse(camera.get_view())[3]);
+
+	auto query_count = std::min(mesh_instances.size(), issued_visibility_queries.size());
+	for (size_t i = 0; i < query_count; ++i)
+	{
+		// The skinned nodes are never occluded, their bind pose bounds may not hold them
+		if ((frustum_culling && !instance_visibility[i]) || skinned_instances[i])
+		{
+			continue;
+		}
+
+		// The faces of bounds around the camera are clipped, the node is kept visible
+		auto bounds_min = instance_bounds.get_min(i);
+		auto bounds_max = instance_bounds.get_max(i);
+		if (glm::all(glm::greaterThanEqual(camera_position, bounds_min)) && glm::all(glm::lessThanEqual(camera_position, bounds_max)))
+		{
+			continue;
+		}
+
+		uniform.bounds_min = glm::vec4(bounds_min, 1.0f);
+		uniform.bounds_max = glm::vec4(bounds_max, 1.0f);
+		command_buffer.push_constants(uniform);
+
+		command_buffer.begin_query(*visibility_queries, to_u32(i), 0);
+		command_buffer.draw(36, 1, 0, 0);
+		command_buffer.end_query(*visibility_queries, to_u32(i));
+
+		issued_visibility_queries[i] = 1;
+	}
+}
+
+void GeometrySubpass::set_texture_residency_manager(TextureResidencyManager &manager)
+{
+	assert(!bindless_registry && "The bindless registry would keep the replaced image views");
+	texture_residency_manager = &manager;
+}
+
+void GeometrySubpass::set_bindless_registry(BindlessRegistry &registry)
+{
+	bindless_registry = &registry;
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			auto &variant = sub_mesh->get_mut_shader_variant();
+			variant.add_definitions({"BINDLESS", "BINDLESS_TEXTURE_COUNT " + std::to_string(BindlessRegistry::Capacity)});
+
+			auto material = sub_mesh->get_material();
+
+			uint32_t base_color_index = 0;
+
+			if (auto *texture = material->get_texture(sg::MaterialTexture::BaseColor))
+			{
+				base_color_index = registry.register_texture(texture->get_image()->get_vk_image_view(), texture->get_sampler()->vk_sampler);
+			}
+
+			bindless_base_color_indices[material] = base_color_index;
+		}
+	}
+}
+
+void GeometrySubpass::set_constant_delivery(ConstantDelivery delivery)
+{
+	constant_delivery = delivery;
+
+	bool push_constants = delivery == ConstantDelivery::PushConstants;
+	if (push_constants == global_push_constants_defined)
+	{
+		return;
+	}
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			auto &variant = sub_mesh->get_mut_shader_variant();
+			if (push_constants)
+			{
+				variant.add_define("GLOBAL_PUSH_CONSTANTS");
+			}
+			else
+			{
+				variant.add_undefine("GLOBAL_PUSH_CONSTANTS");
+			}
+		}
+	}
+
+	global_push_constants_defined = push_constants;
+}
+
+ConstantDelivery GeometrySubpass::get_constant_delivery() const
+{
+	return constant_delivery;
+}
+
+void GeometrySubpass::set_shader_precision(ShaderPrecision precision)
+{
+	if (precision == shader_precision)
+	{
+		return;
+	}
+
+	shader_precision = precision;
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			auto &variant = sub_mesh->get_mut_shader_variant();
+			if (precision == ShaderPrecision::Half)
+			{
+				variant.add_define("HALF_PRECISION");
+			}
+			else
+			{
+				variant.add_undefine("HALF_PRECISION");
+			}
+		}
+	}
+
+	LOGD("Lighting the draws in {}", to_string(shader_precision));
+}
+
+ShaderPrecision GeometrySubpass::get_shader_precision() const
+{
+	return shader_precision;
+}
+
+void GeometrySubpass::set_order_independent_transparency(OrderIndependentTransparency &oit)
+{
+	order_independent_transparency = &oit;
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			if (sub_mesh->get_material()->alpha_mode == sg::AlphaMode::Blend)
+			{
+				sub_mesh->get_mut_shader_variant().add_definitions(oit.get_definitions());
+			}
+		}
+	}
+}
+
+void GeometrySubpass::set_skinning_pass(SkinningPass &skinning)
+{
+	skinning_pass = &skinning;
+
+	// Rebuilt on the next update, to find the skinned instances
+	instance_bounds.clear();
+	mesh_instances.clear();
+	skinned_instances.clear();
+}
+
+void GeometrySubpass::set_frustum_culling(bool enable)
+{
+	frustum_culling = enable;
+}
+
+void GeometrySubpass::enable_instancing()
+{
+	assert(!gpu_scene && "Instancing and the GPU scene both select the world matrix with the instance index");
+
+	if (instancing)
+	{
+		return;
+	}
+
+	instancing = true;
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			sub_mesh->get_mut_shader_variant().add_define("INSTANCING");
+		}
+	}
+}
+
+void GeometrySubpass::enable_conditional_rendering()
+{
+	assert(!instancing && "Conditional rendering predicates the draws of single nodes");
+
+	auto &device = get_render_context().get_device();
+	if (visibility_queries)
+	{
+		return;
+	}
+
+	if (!device.is_enabled(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME))
+	{
+		LOGW("{} is not enabled, the draws are not predicated", VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME);
+		return;
+	}
+
+	uint32_t instance_count = 0;
+	for (auto &mesh : meshes)
+	{
+		instance_count += to_u32(mesh->get_nodes().size());
+	}
+
+	if (instance_count == 0)
+	{
+		return;
+	}
+
+	create_visibility_queries(instance_count);
+}
+
+void GeometrySubpass::enable_motion_vectors()
+{
+	if (motion_vectors)
+	{
+		return;
+	}
+
+	motion_vectors = true;
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			if (sub_mesh->get_material()->alpha_mode != sg::AlphaMode::Blend)
+			{
+				sub_mesh->get_mut_shader_variant().add_define("MOTION_VECTORS");
+			}
+		}
+	}
+}
+
+void GeometrySubpass::create_visibility_queries(uint32_t instance_count)
+{
+	auto &device = get_render_context().get_device();
+
+	VkQueryPoolCreateInfo query_pool_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+	query_pool_info.queryType  = VK_QUERY_TYPE_OCCLUSION;
+	query_pool_info.queryCount = instance_count;
+	visibility_queries         = std::make_unique<QueryPool>(device, query_pool_info);
+
+	visibility_predicates = std::make_unique<vkb::core::BufferC>(device,
+	                                                             instance_count * sizeof(uint32_t),
+	                                                             VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                             VMA_MEMORY_USAGE_GPU_ONLY);
+	visibility_predicates->set_debug_name("Geometry subpass: visibility predicates");
+
+	// The first frame has no results, it resets the queries before they are issued
+	issued_visibility_queries.assign(instance_count, 0);
+}
+
+void GeometrySubpass::enable_gpu_scene()
+{
+	assert(!instancing && "Instancing and the GPU scene both select the world matrix with the instance index");
+
+	if (gpu_scene)
+	{
+		return;
+	}
+
+	gpu_scene = std::make_unique<GpuScene>(get_render_context().get_device(), scene);
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			sub_mesh->get_mut_shader_variant().add_define("GPU_SCENE");
+		}
+	}
+}
+
+void GeometrySubpass::enable_vertex_pulling()
+{
+	if (vertex_stream_buffer)
+	{
+		return;
+	}
+
+	std::vector<std::pair<sg::SubMesh *, VertexStreamUniform>> streams;
+
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			VertexStreamUniform stream{};
+			if (get_vertex_stream(*sub_mesh, "position", stream.position_address, stream.position_stride, &stream.position_format) &&
+			    has_address(stream.position_address) &&
+			    get_vertex_stream(*sub_mesh, "normal", stream.normal_address, stream.normal_stride, &stream.normal_format) &&
+			    get_vertex_stream(*sub_mesh, "texcoord_0", stream.texcoord_address, stream.texcoord_stride, nullptr))
+			{
+				if (skinning_pass && skinning_pass->is_skinned(*sub_mesh))
+				{
+					set_skinned_streams(*skinning_pass, *sub_mesh, stream);
+				}
+
+				streams.emplace_back(sub_mesh, stream);
+			}
+		}
+	}
+
+	auto &device = get_render_context().get_device();
+
+	auto         alignment = device.get_gpu().get_properties().limits.minUniformBufferOffsetAlignment;
+	VkDeviceSize stride    = (sizeof(VertexStreamUniform) + alignment - 1) / alignment * alignment;
+
+	vertex_stream_buffer = std::make_unique<vkb::core::BufferC>(device,
+	                                                            std::max<size_t>(streams.size(), 1) * stride,
+	                                                            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+	                                                            VMA_MEMORY_USAGE_CPU_TO_GPU);
+	vertex_stream_buffer->set_debug_name("Geometry subpass: vertex streams");
+
+	for (size_t i = 0; i < streams.size(); ++i)
+	{
+		vertex_stream_buffer->convert_and_update(streams[i].second, i * stride);
+		vertex_stream_offsets[streams[i].first] = i * stride;
+
+		streams[i].first->get_mut_shader_variant().add_define("VERTEX_PULLING");
+	}
+
+	LOGI("Vertex pulling enabled for {} of the sub meshes", streams.size());
+}
+
+void GeometrySubpass::set_lod_threshold(float pixels)
+{
+	lod_threshold = pixels;
+}
+
+void GeometrySubpass::set_parallel_recording(bool enable)
+{
+	parallel_recording = enable;
+}
+
+VkSubpassContents GeometrySubpass::get_subpass_contents()
+{
+	if (parallel_recording && get_render_context().get_thread_count() > 1)
+	{
+		return VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS;
+	}
+
+	return VK_SUBPASS_CONTENTS_INLINE;
+}
+
 void GeometrySubpass::set_thread_index(uint32_t index)
 {
 	thread_index = index;
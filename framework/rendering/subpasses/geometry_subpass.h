@@ -17,14 +17,28 @@
 
 #pragma once
 
+#include <mutex>
+#include <tuple>
+
 #include "common/error.h"
 
 #include "common/glm_common.h"
 
+#include "core/query_pool.h"
+#include "geometry/aabb_batch.h"
+#include "geometry/frustum.h"
+#include "rendering/constant_delivery.h"
+#include "rendering/gpu_scene.h"
+#include "rendering/shader_precision.h"
 #include "rendering/subpass.h"
 
 namespace vkb
 {
+class BindlessRegistry;
+class OrderIndependentTransparency;
+class SkinningPass;
+class TextureResidencyManager;
+
 namespace sg
 {
 class Scene;
@@ -32,6 +46,8 @@ class Node;
 class Mesh;
 class SubMesh;
 class Camera;
+class Material;
+class Texture;
 }        // namespace sg
 
 /**
@@ -44,6 +60,11 @@ struct alignas(16) GlobalUniform
 	glm::mat4 camera_view_proj;
 
 	glm::vec3 camera_position;
+
+	/// Bounds of the positions of the sub mesh, read by the PACKED_POSITION variants
+	alignas(16) glm::vec3 position_offset;
+
+	alignas(16) glm::vec3 position_scale{1.0f};
 };
 
 /**
@@ -58,6 +79,81 @@ struct PBRMaterialUniform
 	float roughness_factor;
 };
 
+/**
+ * @brief PBR material uniform for base shader when textures are read from a BindlessRegistry
+ */
+struct BindlessMaterialUniform
+{
+	glm::vec4 base_color_factor;
+
+	float metallic_factor;
+
+	float roughness_factor;
+
+	uint32_t base_color_texture_index;
+};
+
+/**
+ * @brief Formats of the vertex attributes the vertex pulling shaders decode
+ */
+enum class VertexPullingFormat : uint32_t
+{
+	/// Three 32-bit floats, or two for texture coordinates
+	Float = 0,
+
+	/// Four 16-bit floats, the last one ignored, as written by mesh_optimizer::quantize_to_half()
+	Half = 1
+};
+
+/**
+ * @brief Device addresses and layouts of the vertex attributes of a sub mesh for the vertex pulling shaders
+ *        A zero address marks a missing attribute.
+ */
+struct alignas(16) VertexStreamUniform
+{
+	glm::uvec2 position_address;
+
+	glm::uvec2 normal_address;
+
+	glm::uvec2 texcoord_address;
+
+	uint32_t position_stride;
+
+	uint32_t normal_stride;
+
+	uint32_t texcoord_stride;
+
+	uint32_t position_format;
+
+	uint32_t normal_format;
+};
+
+/**
+ * @brief A submesh to draw and the key it is sorted by
+ *
+ * The upper 32 bits of the key hold the distance to the camera, the lower bits group
+ * draws sharing the same shader variant and material.
+ */
+struct DrawPacket
+{
+	uint64_t sort_key;
+
+	sg::Node *node;
+
+	sg::SubMesh *sub_mesh;
+
+	/// Level of detail of the sub mesh to draw, see select_lod()
+	uint32_t lod;
+
+	/// Range of the instance transforms drawn with instancing, the entry of the node with a GPU scene
+	uint32_t first_instance;
+
+	uint32_t instance_count;
+
+	/// Index of the node in the occlusion queries, see GeometrySubpass::enable_conditional_rendering()
+	uint32_t instance_index;
+};
+
 /**
  * @brief This subpass is responsible for rendering a Scene
  */
@@ -78,6 +174,13 @@ class GeometrySubpass : public vkb::rendering::SubpassC
 
 	virtual void prepare() override;
 
+	/**
+	 * @brief Uploads the world matrices of the nodes which moved, if a GPU scene is enabled,
+	 *        and copies the occlusion results of the previous frame with conditional rendering
+	 *        Refreshes the meshes first if scenes were attached to or detached from the scene, see refresh_meshes().
+	 */
+	virtual void draw_before_render_pass(CommandBuffer &command_buffer) override;
+
 	/**
 	 * @brief Record draw commands
 	 */
@@ -88,25 +191,270 @@ class GeometrySubpass : public vkb::rendering::SubpassC
 	 */
 	void set_thread_index(uint32_t index);
 
+	/**
+	 * @brief Enables or disables culling of the nodes outside of the camera frustum, disabled by default
+	 */
+	void set_frustum_culling(bool enable);
+
+	/**
+	 * @brief Sets the largest error on screen of the levels of detail drawn, 1 pixel by default
+	 *        Only the sub meshes loaded with levels of detail are affected, see GLTFLoader::set_lod_count().
+	 */
+	void set_lod_threshold(float pixels);
+
+	/**
+	 * @brief Draws the opaque nodes sharing a sub mesh with a single instanced draw, disabled by default
+	 *        The world matrices are read from a storage buffer at binding 5 instead of the global uniform,
+	 *        like the INSTANCING variant of the base vertex shader. Adds the INSTANCING definition to the
+	 *        sub mesh variants, so it must be called before prepare().
+	 */
+	void enable_instancing();
+
+	/**
+	 * @brief Keeps the world matrices of the nodes in a GpuScene instead of writing a uniform per draw, disabled by default
+	 *        Only the nodes which moved are uploaded every frame, and the draws share a single global uniform.
+	 *        Adds the GPU_SCENE definition to the sub mesh variants, so it must be called before prepare().
+	 *        Only the base and deferred geometry vertex shaders support it. Not compatible with instancing, as both select the world matrix with the instance index.
+	 */
+	void enable_gpu_scene();
+
+	/**
+	 * @brief Fetches the vertex attributes in the vertex shader through their buffer device addresses, disabled by default
+	 *        The sub meshes then share an empty vertex input state, so their vertex layouts no longer multiply the pipelines.
+	 *        The bufferDeviceAddress feature must be enabled and the vertex buffers created with
+	 *        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, see GLTFLoader::read_scene_from_file(). Sub meshes with
+	 *        attributes in other formats than VertexPullingFormat keep the vertex input state. Adds the VERTEX_PULLING
+	 *        definition to the variants of the others, so it must be called before prepare(). Only the base and
+	 *        deferred geometry vertex shaders support it.
+	 */
+	void enable_vertex_pulling();
+
+	/**
+	 * @brief Skips the opaque draws of the nodes whose bounds were hidden in the previous frame, disabled by default
+	 *        The bounds of the nodes in view are drawn after the opaque draws with an occlusion query each, without writing
+	 *        color or depth. The results are copied on the GPU into the predicates of VK_EXT_conditional_rendering read
+	 *        by the draws of the next frame, so the CPU never waits for them, and a node uncovered by a moving occluder
+	 *        appears a frame late. The VK_EXT_conditional_rendering extension and its conditionalRendering feature must
+	 *        be enabled, it is ignored otherwise. Not compatible with instancing, as a batched draw covers several nodes.
+	 */
+	void enable_conditional_rendering();
+
+	/**
+	 * @brief Writes the motion of the opaque fragments since the previous frame to the second color output, disabled by default
+	 *        The motion is the offset in texture coordinates from a fragment to where it was in the previous frame, measured
+	 *        without the jitter of a sg::PerspectiveCamera, for a PostProcessingTemporalPass reading it. Instanced draws and
+	 *        draws with a GPU scene only carry the motion of the camera. Adds the MOTION_VECTORS definition to the variants
+	 *        of the opaque sub meshes, so it must be called before prepare(). Only the base shader supports it.
+	 */
+	void enable_motion_vectors();
+
+	/**
+	 * @brief Sets how the global uniform of every draw reaches the shaders, selected from the device limits by default
+	 *        With push constants, the global uniform and the material share one range of GlobalUniform then BindlessMaterialUniform
+	 *        or PBRMaterialUniform bytes, and the GLOBAL_PUSH_CONSTANTS definition is added to the sub mesh variants, so it must be
+	 *        called before prepare(). Only the base and deferred geometry shaders support it, the others keep the uniform buffer.
+	 */
+	void set_constant_delivery(ConstantDelivery delivery);
+
+	ConstantDelivery get_constant_delivery() const;
+
+	/**
+	 * @brief Sets the precision of the lighting math of the fragment shaders, selected from the enabled device features by default
+	 *        Half precision adds the HALF_PRECISION definition to the sub mesh variants, so it must be called before prepare().
+	 *        Samples override it to compare the precisions or to keep the fp32 results. Only the shaders lighting with
+	 *        shaders/lighting.h are affected, see ShaderPrecision.
+	 */
+	void set_shader_precision(ShaderPrecision precision);
+
+	ShaderPrecision get_shader_precision() const;
+
+	/**
+	 * @brief Enables or disables recording the draws of this subpass into secondary command
+	 *        buffers in parallel, one per thread the render context was prepared with.
+	 *        Has no effect if the render context uses a single thread.
+	 */
+	void set_parallel_recording(bool enable);
+
+	/**
+	 * @brief Reads the material textures from the array of a bindless registry instead of binding them at every draw.
+	 *        Registers the textures of the scene and adds the BINDLESS definitions to the sub mesh variants,
+	 *        so it must be called before prepare(). Only the base shader supports it.
+	 * @param registry The bindless registry, must outlive the subpass
+	 */
+	void set_bindless_registry(BindlessRegistry &registry);
+
+	/**
+	 * @brief Requests the textures of the visible sub meshes from a residency manager, with an estimate of their size on screen.
+	 *        Not compatible with a bindless registry, as the residency manager replaces the image views.
+	 * @param manager The residency manager, must outlive the subpass
+	 */
+	void set_texture_residency_manager(TextureResidencyManager &manager);
+
+	/**
+	 * @brief Stores the transparent fragments in the k-buffer of an OrderIndependentTransparency instead of blending them,
+	 *        to be composited by an OITCompositeSubpass following this subpass. Adds its definitions to the variants of the
+	 *        sub meshes with blending, so it must be called before prepare(). Only the base shader supports it.
+	 * @param order_independent_transparency The k-buffer, must outlive the subpass
+	 */
+	void set_order_independent_transparency(OrderIndependentTransparency &order_independent_transparency);
+
+	/**
+	 * @brief Draws the sub meshes skinned by a SkinningPass with its skinned positions and normals
+	 *        The pass is updated before the render pass, and skins the vertices only once for all the subpasses sharing it,
+	 *        such as a shadow subpass deriving from this one. Must be called before enable_vertex_pulling() and prepare().
+	 * @param skinning_pass The skinning pass, must outlive the subpass
+	 */
+	void set_skinning_pass(SkinningPass &skinning_pass);
+
+	/**
+	 * @return Secondary command buffers if parallel recording is in use, inline otherwise
+	 */
+	virtual VkSubpassContents get_subpass_contents() override;
+
   protected:
-	virtual void update_uniform(CommandBuffer &command_buffer, sg::Node &node, size_t thread_index);
+	/**
+	 * @brief Draw state of a sub mesh for this subpass, resolved the first time it is drawn
+	 *
+	 * Holds what draw_submesh() would otherwise look up at every draw: the shader modules and pipeline layout
+	 * of the shader variant, the bindings of the material textures and the vertex input state. Handles which
+	 * can change are read at draw time, so the proxy keeps the textures and buffers rather than their views.
+	 */
+	struct RenderProxy
+	{
+		PipelineLayout *pipeline_layout{nullptr};
+
+		/// Whether the pipeline layout has the push constants range of the material
+		bool push_constants{false};
+
+		/// Whether the global uniform is pushed ahead of the material, see set_constant_delivery()
+		bool global_push_constants{false};
 
-	void draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh, VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE);
+		/// Material textures with their binding in set 0
+		std::vector<std::pair<uint32_t, const sg::Texture *>> textures;
+
+		/// Whether the vertex attributes are fetched from the vertex streams at vertex_stream_offset
+		bool vertex_pulling{false};
+
+		VkDeviceSize vertex_stream_offset{0};
+
+		VertexInputState vertex_input_state;
+
+		/// Vertex buffers with their binding and offset, the skinned attributes being read from the skinning pass
+		std::vector<std::tuple<uint32_t, const vkb::core::BufferC *, VkDeviceSize>> vertex_buffers;
+	};
+
+	/**
+	 * @brief Returns the render proxy of a sub mesh, baking it on the first call
+	 *        Safe to call from the threads recording in parallel.
+	 */
+	const RenderProxy &get_render_proxy(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh);
+
+	/**
+	 * @brief Drops the render proxies, so they are baked again with the current variants and resource modes
+	 *        Called by prepare(). Must not be called while draws are recorded.
+	 */
+	void clear_render_proxies();
+
+	virtual void update_uniform(CommandBuffer &command_buffer, sg::Node &node, sg::SubMesh &sub_mesh, size_t thread_index);
+
+	/**
+	 * @param lod Level of detail of the sub mesh, the full mesh being 0
+	 * @param first_instance Index of the first transform in the instance buffer
+	 * @param instance_count Number of instances to draw
+	 */
+	virtual void draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh, VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE, uint32_t lod = 0,
+	                          uint32_t first_instance = 0, uint32_t instance_count = 1);
+
+	/**
+	 * @brief Binds the push constants and textures of the material of a sub mesh, or the bindless array
+	 */
+	void bind_material(CommandBuffer &command_buffer, PipelineLayout &pipeline_layout, sg::SubMesh &sub_mesh);
+
+	void bind_material(CommandBuffer &command_buffer, const RenderProxy &proxy, sg::SubMesh &sub_mesh);
 
 	virtual void prepare_pipeline_state(CommandBuffer &command_buffer, VkFrontFace front_face, bool double_sided_material);
 
+	/**
+	 * @brief Sets the resource modes of the shader modules and requests their pipeline layout
+	 *        The material textures are marked ShaderResourceMode::PerDraw, so their set is pushed with
+	 *        VK_KHR_push_descriptor when it is enabled, unless the global uniform of the set is dynamic.
+	 */
 	virtual PipelineLayout &prepare_pipeline_layout(CommandBuffer &command_buffer, const std::vector<ShaderModule *> &shader_modules);
 
 	virtual void prepare_push_constants(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh);
 
 	virtual void draw_submesh_command(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh);
 
+	/**
+	 * @brief Copies the occlusion results of the previous frame into the predicates and resets the queries
+	 *        The nodes which weren't queried, because they were outside of the frustum, are predicated visible.
+	 */
+	void update_visibility_predicates(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Draws the bounds of the nodes in view with an occlusion query each, tested against the opaque depth
+	 */
+	void draw_visibility_queries(CommandBuffer &command_buffer);
+
 	/**
 	 * @brief Sorts objects based on distance from camera and classifies them
 	 *        into opaque and transparent in the arrays provided
+	 *        Nodes whose bounds are outside of the camera frustum are skipped if culling is enabled.
+	 *        Opaque draws are sorted front-to-back, transparent draws back-to-front.
+	 *        The arrays are cleared first, so they can be reused every frame without allocating.
+	 */
+	void get_sorted_nodes(std::vector<DrawPacket> &opaque_nodes, std::vector<DrawPacket> &transparent_nodes);
+
+	/**
+	 * @brief Merges the opaque draws of the same sub mesh, level of detail and winding into instanced draws
+	 *        A batch keeps the position of its nearest draw. Fills the instance transforms, transparent
+	 *        draws keeping one instance each so their order is preserved.
+	 */
+	void batch_instances(std::vector<DrawPacket> &opaque_nodes, std::vector<DrawPacket> &transparent_nodes);
+
+	/**
+	 * @brief Binds the instance transforms of the frame, the draws select theirs with their first instance
+	 */
+	void bind_instances(CommandBuffer &command_buffer);
+
+	/**
+	 * @brief Binds the matrices of the current and previous frames a draw measures its motion with
+	 */
+	void bind_motion_uniform(CommandBuffer &command_buffer, const DrawPacket &draw, size_t thread_index);
+
+	/**
+	 * @brief Records a range of the opaque draws
+	 */
+	void draw_opaque(CommandBuffer &command_buffer, size_t first, size_t last, size_t thread_index);
+
+	/**
+	 * @brief Enables alpha blending, or the k-buffer of the order-independent transparency, and records the transparent draws
+	 */
+	void draw_transparent(CommandBuffer &command_buffer, size_t thread_index);
+
+	/**
+	 * @brief Splits the draws in chunks recorded into secondary command buffers by the worker
+	 *        threads, then executes them from the primary command buffer
+	 */
+	void draw_parallel(CommandBuffer &primary_command_buffer);
+
+	/**
+	 * @brief Updates the world-space bounds of every mesh instance of the scene
+	 */
+	void update_instance_bounds();
+
+	/**
+	 * @brief Fetches the meshes of the scene again if its version changed, after scenes were attached or detached
+	 *        Adds the definitions of the enabled modes to the variants of the new sub meshes, and rebuilds the GPU scene
+	 *        and the occlusion queries, the replaced ones being retired. The new sub meshes keep the vertex input state
+	 *        with vertex pulling and are not skinned. Not compatible with a bindless registry, which keeps the textures.
+	 */
+	void refresh_meshes();
+
+	/**
+	 * @brief Creates an occlusion query and a predicate per node
 	 */
-	void get_sorted_nodes(std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &opaque_nodes,
-	                      std::multimap<float, std::pair<sg::Node *, sg::SubMesh *>> &transparent_nodes);
+	void create_visibility_queries(uint32_t instance_count);
 
 	sg::Camera &camera;
 
@@ -114,9 +462,121 @@ class GeometrySubpass : public vkb::rendering::SubpassC
 
 	sg::Scene &scene;
 
+	/// Version of the scene when the meshes were fetched
+	uint64_t scene_version{0};
+
 	uint32_t thread_index{0};
 
 	vkb::RasterizationState base_rasterization_state{};
+
+	bool frustum_culling{false};
+
+	Frustum frustum;
+
+	float lod_threshold{1.0f};
+
+	ConstantDelivery constant_delivery{ConstantDelivery::UniformBuffer};
+
+	/// Whether the GLOBAL_PUSH_CONSTANTS definition was added to the sub mesh variants
+	bool global_push_constants_defined{false};
+
+	ShaderPrecision shader_precision{ShaderPrecision::Full};
+
+	bool instancing{false};
+
+	/// World matrices of the instances of every draw, each draw owning a contiguous range
+	std::vector<glm::mat4> instance_transforms;
+
+	/// Instance transforms of the frame, shared by the draws of every thread
+	BufferAllocationC instance_allocation;
+
+	/// Sub mesh, then level of detail and winding of an instanced draw
+	using InstanceBatchKey = std::pair<const sg::SubMesh *, uint32_t>;
+
+	struct InstanceBatchKeyHash
+	{
+		size_t operator()(const InstanceBatchKey &key) const;
+	};
+
+	/// Scratch space of batch_instances(), reused across frames
+	std::unordered_map<InstanceBatchKey, uint32_t, InstanceBatchKeyHash> instance_batch_indices;
+
+	std::vector<uint32_t> instance_batches;
+
+	std::unique_ptr<GpuScene> gpu_scene;
+
+	/// Global uniform of the frame shared by the draws with a GPU scene
+	BufferAllocationC frame_uniform_allocation;
+
+	/// Vertex streams of the sub meshes drawn with vertex pulling, each at an offset aligned for uniform buffers
+	std::unique_ptr<vkb::core::BufferC> vertex_stream_buffer;
+
+	std::unordered_map<const sg::SubMesh *, VkDeviceSize> vertex_stream_offsets;
+
+	bool parallel_recording{false};
+
+	/// Mesh and node of each box in instance_bounds
+	std::vector<std::pair<sg::Mesh *, sg::Node *>> mesh_instances;
+
+	AABBBatch instance_bounds;
+
+	/// Whether the node of each instance is skinned, its bounds are those of the bind pose so it is never culled
+	std::vector<uint8_t> skinned_instances;
+
+	std::vector<uint8_t> instance_visibility;
+
+	/// An occlusion query per node, indexed like mesh_instances
+	std::unique_ptr<QueryPool> visibility_queries;
+
+	/// Predicate of each node copied from its occlusion query, read by the conditional rendering of its draws
+	std::unique_ptr<vkb::core::BufferC> visibility_predicates;
+
+	/// Whether the query of each node was issued in the previous frame
+	std::vector<uint8_t> issued_visibility_queries;
+
+	bool motion_vectors{false};
+
+	/// World matrices of the nodes in this frame and the previous one, indexed like mesh_instances
+	std::vector<glm::mat4> world_matrices;
+
+	std::vector<glm::mat4> previous_world_matrices;
+
+	/// Unjittered view projections of this frame and the previous one, the same in the first frame
+	glm::mat4 motion_view_proj{1.0f};
+
+	glm::mat4 previous_motion_view_proj{1.0f};
+
+	bool motion_view_proj_valid{false};
+
+	ShaderSource visibility_vertex_shader;
+
+	ShaderSource visibility_fragment_shader;
+
+	/// Draw lists reused across frames
+	std::vector<DrawPacket> opaque_draws;
+
+	std::vector<DrawPacket> transparent_draws;
+
+	/// Scratch space of the radix sort
+	std::vector<DrawPacket> sort_scratch;
+
+	BindlessRegistry *bindless_registry{nullptr};
+
+	/// Index of the base color texture of each material in the bindless array
+	std::unordered_map<const sg::Material *, uint32_t> bindless_base_color_indices;
+
+	TextureResidencyManager *texture_residency_manager{nullptr};
+
+	OrderIndependentTransparency *order_independent_transparency{nullptr};
+
+	SkinningPass *skinning_pass{nullptr};
+
+  private:
+	RenderProxy bake_render_proxy(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh);
+
+	std::mutex render_proxies_mutex;
+
+	std::unordered_map<const sg::SubMesh *, RenderProxy> render_proxies;
 };
 
 }        // namespace vkb
@@ -0,0 +1,764 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpasses/gpu_driven_subpass.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "common/utils.h"
+#include "common/vk_common.h"
+#include "core/physical_device.h"
+#include "core/util/profiling.hpp"
+#include "rendering/bindless_registry.h"
+#include "rendering/render_context.h"
+#include "rendering/subpasses/forward_subpass.h"
+#include "scene_graph/components/camera.h"
+#include "scene_graph/components/image.h"
+#include "scene_graph/components/material.h"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/pbr_material.h"
+#include "scene_graph/components/sampler.h"
+#include "scene_graph/components/sub_mesh.h"
+#include "scene_graph/components/texture.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+namespace
+{
+/// Push constants of the culling shader
+struct CullingUniform
+{
+	std::array<glm::vec4, 6> frustum_planes;
+
+	glm::vec3 camera_position;
+
+	/// Pixels covered by one unit at a distance of one unit, divided by the level of detail threshold
+	float lod_pixel_scale;
+
+	uint32_t draw_count;
+};
+
+/// Local size of the culling shader
+constexpr uint32_t CullingGroupSize = 64;
+
+/// Counters of the culling shader: the commands of each draw group, the occluded draws and the draws at each level of detail
+constexpr uint32_t CountBufferSize = GpuDrivenSubpass::DrawGroupCount + 1 + MaxLodCount;
+
+/// Uniform of the culling shader when the occlusion culling is enabled
+struct OcclusionUniform
+{
+	glm::mat4 previous_view_proj;
+
+	glm::ivec2 depth_size;
+
+	uint32_t pyramid_valid;
+};
+
+/// Push constants of the pyramid shader
+struct PyramidUniform
+{
+	glm::ivec2 source_size;
+
+	glm::ivec2 destination_size;
+};
+
+/// Local size of the pyramid shader, in both dimensions
+constexpr uint32_t PyramidGroupSize = 8;
+
+VkExtent2D get_pyramid_level_extent(const VkExtent2D &extent)
+{
+	// Rounded up, so every texel of the level above is covered
+	return {std::max(1u, (extent.width + 1) / 2), std::max(1u, (extent.height + 1) / 2)};
+}
+
+/**
+ * @brief Vertices and indices of the whole scene, in the layout of the base shader
+ */
+struct PackedGeometry
+{
+	std::vector<glm::vec3> positions;
+
+	std::vector<glm::vec2> texcoords;
+
+	std::vector<glm::vec3> normals;
+
+	std::vector<uint32_t> indices;
+
+	std::vector<GpuDrivenLod> lods;
+};
+
+/**
+ * @brief Place of a sub mesh in the packed geometry
+ */
+struct GeometryRange
+{
+	uint32_t first_index;
+
+	uint32_t index_count;
+
+	int32_t vertex_offset;
+
+	/// Simplified levels in the packed geometry
+	uint32_t first_lod;
+
+	uint32_t lod_count;
+};
+
+/**
+ * @brief Appends the elements of a vertex attribute to a packed stream, zeros if the sub mesh doesn't have it
+ * @return False if the attribute doesn't have the expected format
+ */
+template <typename T>
+bool pack_attribute(sg::SubMesh &sub_mesh, const std::string &name, VkFormat format, std::vector<T> &stream)
+{
+	auto first = stream.size();
+	stream.resize(first + sub_mesh.vertices_count, T{0.0f});
+
+	sg::VertexAttribute attribute;
+	auto                buffer = sub_mesh.vertex_buffers.find(name);
+	if (!sub_mesh.get_attribute(name, attribute) || buffer == sub_mesh.vertex_buffers.end())
+	{
+		return name != "position";
+	}
+
+	if (attribute.format != format)
+	{
+		return false;
+	}
+
+	// The loader keeps the vertex buffers host visible
+	const uint8_t *data = buffer->second.map();
+	for (uint32_t i = 0; i < sub_mesh.vertices_count; ++i)
+	{
+		std::memcpy(&stream[first + i], data + attribute.offset + i * attribute.stride, sizeof(T));
+	}
+	buffer->second.unmap();
+
+	return true;
+}
+
+bool pack_geometry(sg::SubMesh &sub_mesh, PackedGeometry &geometry, GeometryRange &range)
+{
+	range.first_index   = to_u32(geometry.indices.size());
+	range.vertex_offset = static_cast<int32_t>(geometry.positions.size());
+
+	if (!pack_attribute(sub_mesh, "position", VK_FORMAT_R32G32B32_SFLOAT, geometry.positions) ||
+	    !pack_attribute(sub_mesh, "texcoord_0", VK_FORMAT_R32G32_SFLOAT, geometry.texcoords) ||
+	    !pack_attribute(sub_mesh, "normal", VK_FORMAT_R32G32B32_SFLOAT, geometry.normals))
+	{
+		geometry.positions.resize(range.vertex_offset);
+		geometry.texcoords.resize(range.vertex_offset);
+		geometry.normals.resize(range.vertex_offset);
+		return false;
+	}
+
+	if (sub_mesh.vertex_indices != 0 && sub_mesh.index_buffer)
+	{
+		const uint8_t *data       = sub_mesh.index_buffer->map() + sub_mesh.index_offset;
+		size_t         index_size = sub_mesh.index_type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+		auto append_indices = [&](uint32_t first, uint32_t count) {
+			for (uint32_t i = first; i < first + count; ++i)
+			{
+				if (sub_mesh.index_type == VK_INDEX_TYPE_UINT16)
+				{
+					uint16_t index;
+					std::memcpy(&index, data + i * index_size, sizeof(index));
+					geometry.indices.push_back(index);
+				}
+				else
+				{
+					uint32_t index;
+					std::memcpy(&index, data + i * index_size, sizeof(index));
+					geometry.indices.push_back(index);
+				}
+			}
+		};
+
+		append_indices(0, sub_mesh.vertex_indices);
+		range.index_count = sub_mesh.vertex_indices;
+
+		// The simplified levels follow the full mesh, they share its vertex offset
+		range.first_lod = to_u32(geometry.lods.size());
+		range.lod_count = sub_mesh.lods.empty() ? 0 : to_u32(sub_mesh.lods.size()) - 1;
+		for (uint32_t level = 1; level < sub_mesh.lods.size(); ++level)
+		{
+			auto &lod = sub_mesh.lods[level];
+			geometry.lods.push_back({to_u32(geometry.indices.size()), lod.index_count, lod.error});
+			append_indices(lod.first_index, lod.index_count);
+		}
+
+		sub_mesh.index_buffer->unmap();
+	}
+	else
+	{
+		for (uint32_t i = 0; i < sub_mesh.vertices_count; ++i)
+		{
+			geometry.indices.push_back(i);
+		}
+		range.index_count = sub_mesh.vertices_count;
+	}
+
+	return true;
+}
+}        // namespace
+
+GpuDrivenSubpass::GpuDrivenSubpass(RenderContext    &render_context,
+                                   ShaderSource    &&vertex_source,
+                                   ShaderSource    &&fragment_source,
+                                   sg::Scene        &scene_,
+                                   sg::Camera       &camera,
+                                   BindlessRegistry &bindless_registry) :
+    Subpass{render_context, std::move(vertex_source), std::move(fragment_source)},
+    scene{scene_},
+    camera{camera},
+    bindless_registry{bindless_registry},
+    cull_shader{"gpu_driven/cull.comp"},
+    pyramid_shader{"gpu_driven/hiz.comp"}
+{
+	shader_variant.add_definitions({"BINDLESS_TEXTURE_COUNT " + std::to_string(BindlessRegistry::Capacity),
+	                                "MAX_LIGHT_COUNT " + std::to_string(MAX_FORWARD_LIGHT_COUNT)});
+	shader_variant.add_definitions(vkb::rendering::light_type_definitions);
+}
+
+void GpuDrivenSubpass::request_gpu_features(PhysicalDevice &gpu)
+{
+	if (!gpu.get_features().multiDrawIndirect || !gpu.get_features().drawIndirectFirstInstance)
+	{
+		throw std::runtime_error("The GPU driven subpass requires the multiDrawIndirect and drawIndirectFirstInstance features");
+	}
+
+	gpu.get_mutable_requested_features().multiDrawIndirect         = VK_TRUE;
+	gpu.get_mutable_requested_features().drawIndirectFirstInstance = VK_TRUE;
+}
+
+void GpuDrivenSubpass::set_occlusion_culling(uint32_t depth_attachment)
+{
+	occlusion_depth_attachment = depth_attachment;
+	cull_variant.add_define("OCCLUSION_CULLING");
+}
+
+void GpuDrivenSubpass::set_lod_threshold(float pixels)
+{
+	lod_threshold = pixels;
+}
+
+void GpuDrivenSubpass::prepare()
+{
+	auto &device = get_render_context().get_device();
+
+	PackedGeometry                                       geometry;
+	std::unordered_map<const sg::SubMesh *, GeometryRange> ranges;
+	std::unordered_map<const sg::Node *, uint32_t>       transform_indices;
+
+	size_t skipped_count = 0;
+
+	draws.clear();
+	transform_nodes.clear();
+
+	for (auto mesh : scene.get_components<sg::Mesh>())
+	{
+		for (auto sub_mesh : mesh->get_submeshes())
+		{
+			auto material = dynamic_cast<const sg::PBRMaterial *>(sub_mesh->get_material());
+			if (!material || material->alpha_mode == sg::AlphaMode::Blend)
+			{
+				skipped_count += mesh->get_nodes().size();
+				continue;
+			}
+
+			auto range = ranges.find(sub_mesh);
+			if (range == ranges.end())
+			{
+				GeometryRange packed_range{};
+				if (!pack_geometry(*sub_mesh, geometry, packed_range))
+				{
+					skipped_count += mesh->get_nodes().size();
+					continue;
+				}
+				range = ranges.emplace(sub_mesh, packed_range).first;
+			}
+
+			// Textures get their index in the bindless array once, whichever sub mesh uses them first
+			uint32_t base_color_texture_index = NoTexture;
+
+			if (auto *texture = material->get_texture(sg::MaterialTexture::BaseColor))
+			{
+				base_color_texture_index = bindless_registry.register_texture(texture->get_image()->get_vk_image_view(), texture->get_sampler()->vk_sampler);
+			}
+
+			for (auto node : mesh->get_nodes())
+			{
+				auto transform_index = transform_indices.emplace(node, to_u32(transform_nodes.size()));
+				if (transform_index.second)
+				{
+					transform_nodes.push_back(node);
+				}
+
+				GpuDrivenDraw draw{};
+				draw.base_color_factor        = material->base_color_factor;
+				draw.bounds_min               = mesh->get_bounds().get_min();
+				draw.first_index              = range->second.first_index;
+				draw.bounds_max               = mesh->get_bounds().get_max();
+				draw.index_count              = range->second.index_count;
+				draw.vertex_offset            = range->second.vertex_offset;
+				draw.transform_index          = transform_index.first->second;
+				draw.base_color_texture_index = base_color_texture_index;
+				draw.group                    = material->double_sided ? DoubleSided : SingleSided;
+				draw.first_lod                = range->second.first_lod;
+				draw.lod_count                = range->second.lod_count;
+				draws.push_back(draw);
+			}
+		}
+	}
+
+	if (skipped_count > 0)
+	{
+		LOGW_THROTTLED("GPU driven subpass: {} sub mesh instances are transparent or don't have the vertex formats of the base shader, they are not drawn", skipped_count);
+	}
+
+	if (draws.empty())
+	{
+		return;
+	}
+
+	position_buffer = create_buffer(geometry.positions.data(), geometry.positions.size() * sizeof(glm::vec3), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "positions");
+	texcoord_buffer = create_buffer(geometry.texcoords.data(), geometry.texcoords.size() * sizeof(glm::vec2), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "texture coordinates");
+	normal_buffer   = create_buffer(geometry.normals.data(), geometry.normals.size() * sizeof(glm::vec3), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "normals");
+	index_buffer    = create_buffer(geometry.indices.data(), geometry.indices.size() * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "indices");
+	draw_buffer     = create_buffer(draws.data(), draws.size() * sizeof(GpuDrivenDraw), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "draws");
+
+	// Never empty, so the culling shader can always bind it
+	geometry.lods.resize(std::max<size_t>(geometry.lods.size(), 1));
+	lod_buffer = create_buffer(geometry.lods.data(), geometry.lods.size() * sizeof(GpuDrivenLod), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "levels of detail");
+
+	// Only written and read by the GPU
+	indirect_buffer = std::make_unique<vkb::core::BufferC>(device,
+	                                                       DrawGroupCount * draws.size() * sizeof(VkDrawIndexedIndirectCommand),
+	                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+	                                                       VMA_MEMORY_USAGE_GPU_ONLY);
+	indirect_buffer->set_debug_name("GPU driven subpass: indirect commands");
+
+	count_buffer = std::make_unique<vkb::core::BufferC>(device,
+	                                                    CountBufferSize * sizeof(uint32_t),
+	                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+	                                                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                    VMA_MEMORY_USAGE_GPU_ONLY);
+	count_buffer->set_debug_name("GPU driven subpass: draw counts");
+
+	if (occlusion_depth_attachment != VK_ATTACHMENT_UNUSED)
+	{
+		visibility_buffer = std::make_unique<vkb::core::BufferC>(device, draws.size() * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		visibility_buffer->set_debug_name("GPU driven subpass: visibility");
+
+		// The shaders fetch the texels, filtering isn't used
+		VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+		sampler_info.magFilter    = VK_FILTER_NEAREST;
+		sampler_info.minFilter    = VK_FILTER_NEAREST;
+		sampler_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		sampler_info.maxLod       = VK_LOD_CLAMP_NONE;
+		depth_pyramid_sampler     = std::make_unique<core::Sampler>(device, sampler_info);
+	}
+
+	LOGI("GPU driven subpass: {} draws of {} vertices and {} indices", draws.size(), geometry.positions.size(), geometry.indices.size());
+
+	std::vector<ShaderModuleRequest> requests{{VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), shader_variant},
+	                                          {VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), shader_variant},
+	                                          {VK_SHADER_STAGE_COMPUTE_BIT, cull_shader, cull_variant}};
+	if (occlusion_depth_attachment != VK_ATTACHMENT_UNUSED)
+	{
+		requests.push_back({VK_SHADER_STAGE_COMPUTE_BIT, pyramid_shader, ShaderVariant{}});
+	}
+	device.get_resource_cache().CompileShaderModulesAsync(requests);
+}
+
+std::unique_ptr<vkb::core::BufferC> GpuDrivenSubpass::create_buffer(const void *data, size_t size, VkBufferUsageFlags usage, const std::string &name)
+{
+	// Host visible, like the buffers of the sub meshes they are packed from
+	auto buffer = std::make_unique<vkb::core::BufferC>(get_render_context().get_device(), size, usage, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	buffer->update(data, size);
+	buffer->set_debug_name("GPU driven subpass: " + name);
+	return buffer;
+}
+
+uint32_t GpuDrivenSubpass::get_draw_count() const
+{
+	return to_u32(draws.size());
+}
+
+void GpuDrivenSubpass::read_draw_counts(uint32_t frame_index)
+{
+	// The fence of the frame was waited for, its copy is complete
+	if (frame_index >= count_readbacks.size() || !count_readbacks[frame_index].pending)
+	{
+		return;
+	}
+
+	auto &readback = count_readbacks[frame_index];
+
+	std::array<uint32_t, CountBufferSize> counts{};
+	std::memcpy(counts.data(), readback.buffer->map(), sizeof(counts));
+	readback.buffer->unmap();
+	readback.pending = false;
+
+	uint64_t visible = 0;
+	for (uint32_t group = 0; group < DrawGroupCount; ++group)
+	{
+		visible += counts[group];
+	}
+	uint64_t occluded = counts[DrawGroupCount];
+
+	get_render_context().record_draws(visible, draws.size() - visible - occluded, occluded);
+
+	std::array<uint64_t, MaxLodCount> lod_counts{};
+	std::copy(counts.begin() + DrawGroupCount + 1, counts.end(), lod_counts.begin());
+	get_render_context().record_lod_draws(lod_counts);
+}
+
+void GpuDrivenSubpass::create_depth_pyramid(const VkExtent2D &depth_extent)
+{
+	auto &device = get_render_context().get_device();
+
+	// The first level is half the depth, the others halve it again down to a single texel
+	auto     extent      = get_pyramid_level_extent(depth_extent);
+	uint32_t level_count = 1;
+	for (auto level_extent = extent; level_extent.width > 1 || level_extent.height > 1; level_extent = get_pyramid_level_extent(level_extent))
+	{
+		++level_count;
+	}
+
+	depth_pyramid_levels.clear();
+	depth_pyramid_view.reset();
+
+	depth_pyramid = std::make_unique<core::Image>(device, core::ImageBuilder(VkExtent3D{extent.width, extent.height, 1})
+	                                                          .with_format(VK_FORMAT_R32_SFLOAT)
+	                                                          .with_usage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+	                                                          .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY)
+	                                                          .with_mip_levels(level_count)
+	                                                          .with_debug_name("GPU driven subpass: depth pyramid"));
+
+	depth_pyramid_view = std::make_unique<core::ImageView>(*depth_pyramid, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R32_SFLOAT);
+	for (uint32_t level = 0; level < level_count; ++level)
+	{
+		depth_pyramid_levels.push_back(std::make_unique<core::ImageView>(*depth_pyramid, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R32_SFLOAT, level, 0, 1, 1));
+	}
+
+	depth_pyramid_extent = depth_extent;
+}
+
+bool GpuDrivenSubpass::build_depth_pyramid(CommandBuffer &command_buffer)
+{
+	PROFILE_SCOPE("Build Depth Pyramid");
+
+	auto &render_context = get_render_context();
+	auto &render_frames  = render_context.get_render_frames();
+	auto  frame_index    = render_context.get_active_frame_index();
+
+	auto &render_target = render_frames[frame_index]->GetRenderTarget();
+	auto &depth_extent  = render_target.get_extent();
+
+	// The render target of the previous frame is recreated with the swapchain, its depth is then lost
+	const core::ImageView *previous_depth = nullptr;
+	if (previous_frame_index < render_frames.size())
+	{
+		auto &previous_target = render_frames[previous_frame_index]->GetRenderTarget();
+		auto &view            = previous_target.get_views().at(occlusion_depth_attachment);
+		if (view.get_image().get_handle() == previous_depth_image &&
+		    previous_target.get_extent().width == depth_extent.width && previous_target.get_extent().height == depth_extent.height)
+		{
+			previous_depth = &view;
+		}
+	}
+
+	// The depth this frame renders is reduced by the next one
+	previous_frame_index = frame_index;
+	previous_depth_image = render_target.get_views().at(occlusion_depth_attachment).get_image().get_handle();
+
+	bool created = false;
+	if (!depth_pyramid || depth_pyramid_extent.width != depth_extent.width || depth_pyramid_extent.height != depth_extent.height)
+	{
+		create_depth_pyramid(depth_extent);
+		created = true;
+	}
+
+	// The culling of the previous frame read the pyramid before it is written again.
+	// Without depth to reduce, the pyramid is left for the culling shader to bind, which doesn't read it.
+	ImageMemoryBarrier reuse_barrier{};
+	reuse_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	reuse_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	reuse_barrier.dst_access_mask = previous_depth ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+	reuse_barrier.old_layout      = created ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	reuse_barrier.new_layout      = previous_depth ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	command_buffer.image_memory_barrier(*depth_pyramid_view, reuse_barrier);
+
+	if (!previous_depth)
+	{
+		return false;
+	}
+
+	ImageMemoryBarrier depth_read_barrier{};
+	depth_read_barrier.src_stage_mask  = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	depth_read_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	depth_read_barrier.src_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depth_read_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	depth_read_barrier.old_layout      = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depth_read_barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	command_buffer.image_memory_barrier(*previous_depth, depth_read_barrier);
+
+	auto &resource_cache  = command_buffer.get_device().get_resource_cache();
+	auto &pyramid_module  = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, pyramid_shader);
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&pyramid_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	auto source_extent = depth_extent;
+	for (size_t level = 0; level < depth_pyramid_levels.size(); ++level)
+	{
+		auto &source             = level == 0 ? *previous_depth : *depth_pyramid_levels[level - 1];
+		auto &destination        = *depth_pyramid_levels[level];
+		auto  destination_extent = get_pyramid_level_extent(source_extent);
+
+		command_buffer.bind_image(source, *depth_pyramid_sampler, 0, 0, 0);
+		command_buffer.bind_image(destination, 0, 1, 0);
+
+		PyramidUniform pyramid_uniform{};
+		pyramid_uniform.source_size      = glm::ivec2(source_extent.width, source_extent.height);
+		pyramid_uniform.destination_size = glm::ivec2(destination_extent.width, destination_extent.height);
+		command_buffer.push_constants(pyramid_uniform);
+
+		command_buffer.dispatch((destination_extent.width + PyramidGroupSize - 1) / PyramidGroupSize,
+		                        (destination_extent.height + PyramidGroupSize - 1) / PyramidGroupSize,
+		                        1);
+
+		// The next level and the culling read this one
+		ImageMemoryBarrier level_barrier{};
+		level_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		level_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		level_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+		level_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+		level_barrier.old_layout      = VK_IMAGE_LAYOUT_GENERAL;
+		level_barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		command_buffer.image_memory_barrier(destination, level_barrier);
+
+		source_extent = destination_extent;
+	}
+
+	// The render pass of the frame using that render target again expects its depth as an attachment
+	ImageMemoryBarrier depth_write_barrier{};
+	depth_write_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	depth_write_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	depth_write_barrier.dst_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depth_write_barrier.old_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	depth_write_barrier.new_layout      = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	command_buffer.image_memory_barrier(*previous_depth, depth_write_barrier);
+
+	return true;
+}
+
+void GpuDrivenSubpass::draw_before_render_pass(CommandBuffer &command_buffer)
+{
+	if (draws.empty())
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("Cull Draws");
+
+	auto frame_index = get_render_context().get_active_frame_index();
+	read_draw_counts(frame_index);
+
+	// World matrices of the frame, read by the culling and vertex shaders
+	auto &render_frame = get_render_context().get_active_frame();
+	transforms         = render_frame.AllocateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, transform_nodes.size() * sizeof(glm::mat4));
+	if (auto matrices = transforms.map<glm::mat4>(0, transform_nodes.size()))
+	{
+		for (size_t i = 0; i < transform_nodes.size(); ++i)
+		{
+			matrices[i] = transform_nodes[i]->get_transform().get_world_matrix();
+		}
+		transforms.flush();
+	}
+
+	// The draws and the count copy of the previous frame read the commands and counts before they are written again
+	BufferMemoryBarrier reuse_barrier{};
+	reuse_barrier.src_stage_mask = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+	reuse_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	command_buffer.buffer_memory_barrier(*count_buffer, 0, VK_WHOLE_SIZE, reuse_barrier);
+
+	vkCmdFillBuffer(command_buffer.get_handle(), count_buffer->get_handle(), 0, VK_WHOLE_SIZE, 0);
+
+	BufferMemoryBarrier clear_barrier{};
+	clear_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	clear_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	clear_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	clear_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.buffer_memory_barrier(*count_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+
+	bool occlusion_culling = occlusion_depth_attachment != VK_ATTACHMENT_UNUSED;
+	bool pyramid_valid     = occlusion_culling && build_depth_pyramid(command_buffer);
+
+	auto &resource_cache  = command_buffer.get_device().get_resource_cache();
+	auto &cull_module     = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, cull_shader, cull_variant);
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&cull_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.bind_buffer(*draw_buffer, 0, draw_buffer->get_size(), 0, 1, 0);
+	command_buffer.bind_buffer(transforms.get_buffer(), transforms.get_offset(), transforms.get_size(), 0, 2, 0);
+	command_buffer.bind_buffer(*indirect_buffer, 0, indirect_buffer->get_size(), 0, 3, 0);
+	command_buffer.bind_buffer(*count_buffer, 0, count_buffer->get_size(), 0, 4, 0);
+	command_buffer.bind_buffer(*lod_buffer, 0, lod_buffer->get_size(), 0, 8, 0);
+
+	frustum.update(camera.get_projection() * camera.get_view());
+
+	CullingUniform culling_uniform{};
+	std::copy(frustum.get_planes().begin(), frustum.get_planes().end(), culling_uniform.frustum_planes.begin());
+	culling_uniform.camera_position = glm::vec3(glm::inverse(camera.get_view())[3]);
+	culling_uniform.lod_pixel_scale = get_lod_pixel_scale(camera.get_projection(), static_cast<float>(get_render_context().get_surface_extent().height)) / lod_threshold;
+	culling_uniform.draw_count      = get_draw_count();
+	command_buffer.push_constants(culling_uniform);
+
+	if (occlusion_culling)
+	{
+		OcclusionUniform occlusion_uniform{};
+		occlusion_uniform.previous_view_proj = previous_view_proj;
+		occlusion_uniform.depth_size         = glm::ivec2(depth_pyramid_extent.width, depth_pyramid_extent.height);
+		occlusion_uniform.pyramid_valid      = pyramid_valid ? 1 : 0;
+
+		auto allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(OcclusionUniform));
+		allocation.update(occlusion_uniform);
+
+		command_buffer.bind_buffer(*visibility_buffer, 0, visibility_buffer->get_size(), 0, 5, 0);
+		command_buffer.bind_image(*depth_pyramid_view, *depth_pyramid_sampler, 0, 6, 0);
+		command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, 7, 0);
+
+		// The depth of this frame is rendered with the same matrix as the vertex shader
+		previous_view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+	}
+
+	command_buffer.dispatch((get_draw_count() + CullingGroupSize - 1) / CullingGroupSize, 1, 1);
+
+	BufferMemoryBarrier cull_barrier{};
+	cull_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	cull_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+	cull_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	cull_barrier.dst_access_mask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	command_buffer.buffer_memory_barrier(*indirect_buffer, 0, VK_WHOLE_SIZE, cull_barrier);
+	command_buffer.buffer_memory_barrier(*count_buffer, 0, VK_WHOLE_SIZE, cull_barrier);
+
+	// The counts are copied to a buffer of the frame, read once it is complete
+	if (count_readbacks.size() <= frame_index)
+	{
+		count_readbacks.resize(frame_index + 1);
+	}
+
+	auto &readback = count_readbacks[frame_index];
+	if (!readback.buffer)
+	{
+		readback.buffer = std::make_unique<vkb::core::BufferC>(get_render_context().get_device(), count_buffer->get_size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+		readback.buffer->set_debug_name("GPU driven subpass: draw count readback");
+	}
+
+	BufferMemoryBarrier copy_barrier{};
+	copy_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	copy_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	copy_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	copy_barrier.dst_access_mask = VK_ACCESS_TRANSFER_READ_BIT;
+	command_buffer.buffer_memory_barrier(*count_buffer, 0, VK_WHOLE_SIZE, copy_barrier);
+
+	command_buffer.copy_buffer(*count_buffer, *readback.buffer, count_buffer->get_size());
+
+	BufferMemoryBarrier host_barrier{};
+	host_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	host_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_HOST_BIT;
+	host_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	host_barrier.dst_access_mask = VK_ACCESS_HOST_READ_BIT;
+	command_buffer.buffer_memory_barrier(*readback.buffer, 0, VK_WHOLE_SIZE, host_barrier);
+
+	readback.pending = true;
+}
+
+void GpuDrivenSubpass::draw(CommandBuffer &command_buffer)
+{
+	if (draws.empty())
+	{
+		return;
+	}
+
+	allocate_lights<ForwardLights>(scene.get_component_view<sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
+	command_buffer.bind_lighting(get_lighting_state(), 0, 4);
+
+	auto &resource_cache     = command_buffer.get_device().get_resource_cache();
+	auto &vert_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), shader_variant);
+	auto &frag_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), shader_variant);
+	frag_shader_module.set_resource_mode(BindlessRegistry::ResourceName, ShaderResourceMode::Bindless);
+
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&vert_shader_module, &frag_shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.bind_descriptor_set(BindlessRegistry::SetIndex, bindless_registry.get_descriptor_set());
+
+	GlobalUniform global_uniform{};
+	global_uniform.camera_view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+	global_uniform.camera_position  = glm::vec3(glm::inverse(camera.get_view())[3]);
+
+	auto &render_frame = get_render_context().get_active_frame();
+	auto  allocation   = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(GlobalUniform));
+	allocation.update(global_uniform);
+
+	command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, 0, 0);
+	command_buffer.bind_buffer(*draw_buffer, 0, draw_buffer->get_size(), 0, 1, 0);
+	command_buffer.bind_buffer(transforms.get_buffer(), transforms.get_offset(), transforms.get_size(), 0, 2, 0);
+
+	// Same layout as the base shader, with every attribute in its own buffer
+	VertexInputState vertex_input_state;
+	vertex_input_state.bindings   = {{0, sizeof(glm::vec3), VK_VERTEX_INPUT_RATE_VERTEX},
+	                                 {1, sizeof(glm::vec2), VK_VERTEX_INPUT_RATE_VERTEX},
+	                                 {2, sizeof(glm::vec3), VK_VERTEX_INPUT_RATE_VERTEX}};
+	vertex_input_state.attributes = {{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+	                                 {1, 1, VK_FORMAT_R32G32_SFLOAT, 0},
+	                                 {2, 2, VK_FORMAT_R32G32B32_SFLOAT, 0}};
+	command_buffer.set_vertex_input_state(vertex_input_state);
+
+	command_buffer.bind_vertex_buffers(0, {std::cref(*position_buffer), std::cref(*texcoord_buffer), std::cref(*normal_buffer)}, {0, 0, 0});
+	command_buffer.bind_index_buffer(*index_buffer, 0, VK_INDEX_TYPE_UINT32);
+
+	MultisampleState multisample_state{};
+	multisample_state.rasterization_samples = get_sample_count();
+	command_buffer.set_multisample_state(multisample_state);
+
+	for (uint32_t group = 0; group < DrawGroupCount; ++group)
+	{
+		RasterizationState rasterization_state{};
+		rasterization_state.front_face = group == SingleSidedFlipped ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterization_state.cull_mode  = group == DoubleSided ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
+		command_buffer.set_rasterization_state(rasterization_state);
+
+		command_buffer.draw_indexed_indirect_count(*indirect_buffer,
+		                                           group * draws.size() * sizeof(VkDrawIndexedIndirectCommand),
+		                                           *count_buffer,
+		                                           group * sizeof(uint32_t),
+		                                           get_draw_count(),
+		                                           sizeof(VkDrawIndexedIndirectCommand));
+	}
+}
+}        // namespace vkb
@@ -0,0 +1,295 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "common/glm_common.h"
+#include "core/buffer.h"
+#include "core/image.h"
+#include "core/image_view.h"
+#include "core/sampler.h"
+#include "geometry/frustum.h"
+#include "geometry/lod.h"
+#include "rendering/subpass.h"
+
+namespace vkb
+{
+class BindlessRegistry;
+class PhysicalDevice;
+
+namespace sg
+{
+class Scene;
+class Node;
+class Camera;
+}        // namespace sg
+
+/**
+ * @brief A sub mesh instance in the draw table of the GpuDrivenSubpass, laid out as in the shaders
+ */
+struct alignas(16) GpuDrivenDraw
+{
+	glm::vec4 base_color_factor;
+
+	/// Bounds of the mesh in its local space
+	glm::vec3 bounds_min;
+
+	uint32_t first_index;
+
+	glm::vec3 bounds_max;
+
+	uint32_t index_count;
+
+	int32_t vertex_offset;
+
+	/// Index of the world matrix of the node in the transform table
+	uint32_t transform_index;
+
+	/// Index in the bindless array, NoTexture if the material has no base color texture
+	uint32_t base_color_texture_index;
+
+	/// Draw group of the material, see GpuDrivenSubpass::DrawGroup
+	uint32_t group;
+
+	/// Simplified levels of the sub mesh in the level table, after the full mesh described above
+	uint32_t first_lod;
+
+	uint32_t lod_count;
+
+	uint32_t padding[2];
+};
+
+/**
+ * @brief A simplified level of a sub mesh in the level table of the GpuDrivenSubpass, laid out as in the shaders
+ */
+struct GpuDrivenLod
+{
+	uint32_t first_index;
+
+	uint32_t index_count;
+
+	/// Farthest a vertex moved from the full mesh, in object space
+	float error;
+};
+
+/**
+ * @brief Renders the opaque sub meshes of a scene with a few indirect draws, culled on the GPU
+ *
+ * At prepare, the vertices and indices of every sub mesh are copied into buffers shared by the whole scene,
+ * and a draw table records the geometry, bounds and material of each sub mesh instance. Every frame, the
+ * world matrices of the nodes are written to a transform table, then a compute shader tests each draw against
+ * the camera frustum and appends the visible ones to an indirect buffer, before the render pass begins.
+ * The subpass draws them with one vkCmdDrawIndexedIndirectCount per draw group, so its CPU cost is the same
+ * for any number of visible objects.
+ *
+ * With set_occlusion_culling(), the draws are also tested against a hierarchical depth pyramid: a compute pass reduces
+ * the depth of the previous frame to the farthest depth of each 2x2 texels, level after level, then the culling shader
+ * projects the bounds of each draw with the camera of that frame and compares their nearest depth with the level
+ * covering them with 2x2 texels. A visibility buffer keeps the result of each draw for the next frame: the draws
+ * visible in the previous frame are always drawn, and the others only once the pyramid doesn't hide them.
+ * The occluded and visible counts are read back a few frames later and recorded to the render context.
+ *
+ * The sub meshes loaded with levels of detail have their simplified index ranges packed too. The culling shader selects the
+ * coarsest level whose error stays under set_lod_threshold() on screen, as GeometrySubpass does, and counts the draws at each level.
+ *
+ * Textures are read from a BindlessRegistry. Only the attributes of the base shader are packed: positions and
+ * normals as R32G32B32_SFLOAT and texture coordinates as R32G32_SFLOAT, so the scene must be loaded without
+ * vertex quantization. Transparent materials are not drawn, they need a sorted draw order.
+ *
+ * The device must enable VK_KHR_draw_indirect_count, see request_gpu_features() for the core features.
+ */
+class GpuDrivenSubpass : public vkb::rendering::SubpassC
+{
+  public:
+	/// Marks the draws without a base color texture
+	static constexpr uint32_t NoTexture = ~0u;
+
+	/// Draws sharing a rasterization state, each group has its own range of indirect commands and its count
+	enum DrawGroup : uint32_t
+	{
+		SingleSided,
+
+		/// Single sided draws of nodes with a negative scale, decided by the culling shader
+		SingleSidedFlipped,
+
+		DoubleSided,
+
+		DrawGroupCount
+	};
+
+	/**
+	 * @param render_context Render context
+	 * @param vertex_shader Vertex shader source, reading the draw table
+	 * @param fragment_shader Fragment shader source, reading the draw table
+	 * @param scene Scene to render on this subpass
+	 * @param camera Camera used to look at the scene
+	 * @param bindless_registry Registry the textures of the scene are added to, must outlive the subpass
+	 */
+	GpuDrivenSubpass(RenderContext    &render_context,
+	                 ShaderSource    &&vertex_shader,
+	                 ShaderSource    &&fragment_shader,
+	                 sg::Scene        &scene,
+	                 sg::Camera       &camera,
+	                 BindlessRegistry &bindless_registry);
+
+	virtual ~GpuDrivenSubpass() = default;
+
+	/**
+	 * @brief Requests the features of the indirect draws, to be called from VulkanSample::request_gpu_features
+	 * @throws std::runtime_error if the device doesn't support them
+	 */
+	static void request_gpu_features(PhysicalDevice &gpu);
+
+	/**
+	 * @brief Enables the occlusion culling against the depth of the previous frame, to be called before prepare()
+	 * @param depth_attachment Index of the depth attachment in the render targets. It must be single sampled,
+	 *        created with VK_IMAGE_USAGE_SAMPLED_BIT and stored at the end of the render pass.
+	 */
+	void set_occlusion_culling(uint32_t depth_attachment);
+
+	/**
+	 * @brief Sets the largest error on screen of the levels of detail drawn, 1 pixel by default
+	 */
+	void set_lod_threshold(float pixels);
+
+	/**
+	 * @brief Packs the geometry of the scene and builds the draw table
+	 */
+	virtual void prepare() override;
+
+	/**
+	 * @brief Uploads the transforms and culls the draws into the indirect buffer
+	 */
+	virtual void draw_before_render_pass(CommandBuffer &command_buffer) override;
+
+	/**
+	 * @brief Records the indirect draws
+	 */
+	virtual void draw(CommandBuffer &command_buffer) override;
+
+	/**
+	 * @return Number of sub mesh instances in the draw table
+	 */
+	uint32_t get_draw_count() const;
+
+  private:
+	/**
+	 * @brief Counts of a frame, copied to a host visible buffer after the culling
+	 */
+	struct CountReadback
+	{
+		std::unique_ptr<vkb::core::BufferC> buffer;
+
+		/// Whether a copy was recorded since the counts were last read
+		bool pending{false};
+	};
+
+	std::unique_ptr<vkb::core::BufferC> create_buffer(const void *data, size_t size, VkBufferUsageFlags usage, const std::string &name);
+
+	/**
+	 * @brief Records the counts of the last culling of a frame, once the frame is complete
+	 */
+	void read_draw_counts(uint32_t frame_index);
+
+	void create_depth_pyramid(const VkExtent2D &depth_extent);
+
+	/**
+	 * @brief Reduces the depth of the previous frame into the depth pyramid
+	 * @return Whether the pyramid holds the depth of the previous frame, which isn't available after a resize
+	 */
+	bool build_depth_pyramid(CommandBuffer &command_buffer);
+
+	sg::Scene &scene;
+
+	sg::Camera &camera;
+
+	BindlessRegistry &bindless_registry;
+
+	ShaderSource cull_shader;
+
+	ShaderSource pyramid_shader;
+
+	ShaderVariant shader_variant;
+
+	ShaderVariant cull_variant;
+
+	std::unique_ptr<vkb::core::BufferC> position_buffer;
+
+	std::unique_ptr<vkb::core::BufferC> texcoord_buffer;
+
+	std::unique_ptr<vkb::core::BufferC> normal_buffer;
+
+	std::unique_ptr<vkb::core::BufferC> index_buffer;
+
+	std::vector<GpuDrivenDraw> draws;
+
+	std::unique_ptr<vkb::core::BufferC> draw_buffer;
+
+	/// Simplified levels of detail of the sub meshes, indexed by the draws
+	std::unique_ptr<vkb::core::BufferC> lod_buffer;
+
+	float lod_threshold{1.0f};
+
+	/// Nodes whose world matrices fill the transform table
+	std::vector<sg::Node *> transform_nodes;
+
+	/// Transform table of the frame, allocated from the active render frame
+	BufferAllocationC transforms;
+
+	/// Indirect commands of the visible draws, DrawGroupCount ranges of one command per draw
+	std::unique_ptr<vkb::core::BufferC> indirect_buffer;
+
+	/// Number of commands in each range of indirect_buffer, followed by the number of occluded draws and the number of draws at each level of detail
+	std::unique_ptr<vkb::core::BufferC> count_buffer;
+
+	/// Indexed by the render frames
+	std::vector<CountReadback> count_readbacks;
+
+	Frustum frustum;
+
+	/// Index of the depth attachment the occlusion culling reads, VK_ATTACHMENT_UNUSED if it is disabled
+	uint32_t occlusion_depth_attachment{VK_ATTACHMENT_UNUSED};
+
+	/// Whether each draw was visible at the last culling
+	std::unique_ptr<vkb::core::BufferC> visibility_buffer;
+
+	std::unique_ptr<core::Image> depth_pyramid;
+
+	/// View of all the levels, read by the culling shader
+	std::unique_ptr<core::ImageView> depth_pyramid_view;
+
+	/// View of each level, written by the pyramid shader
+	std::vector<std::unique_ptr<core::ImageView>> depth_pyramid_levels;
+
+	std::unique_ptr<core::Sampler> depth_pyramid_sampler;
+
+	/// Extent of the depth the pyramid was created for
+	VkExtent2D depth_pyramid_extent{};
+
+	/// Render frame and depth image of the last culling, to find the depth of the previous frame
+	uint32_t previous_frame_index{~0u};
+
+	VkImage previous_depth_image{VK_NULL_HANDLE};
+
+	/// Camera the previous frame was rendered with
+	glm::mat4 previous_view_proj{1.0f};
+};
+}        // namespace vkb
@@ -27,25 +27,83 @@ namespace vkb
 LightingSubpass::LightingSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader, sg::Camera &cam, sg::Scene &scene_) :
     Subpass{render_context, std::move(vertex_shader), std::move(fragment_shader)},
     camera{cam},
-    scene{scene_}
+    scene{scene_},
+    shader_precision{select_shader_precision(render_context.get_device())}
 {
 }
 
+void LightingSubpass::enable_light_clusters()
+{
+	light_clusters = std::make_unique<LightClusters>(get_render_context(), camera, scene);
+}
+
+void LightingSubpass::set_occlusion_attachment(uint32_t attachment)
+{
+	occlusion_attachment = attachment;
+}
+
+void LightingSubpass::set_gbuffer_views(const core::ImageView &depth, const core::ImageView &albedo, const core::ImageView &normal)
+{
+	gbuffer_views = {&depth, &albedo, &normal};
+}
+
+void LightingSubpass::set_shader_precision(ShaderPrecision precision)
+{
+	shader_precision = precision;
+}
+
+ShaderPrecision LightingSubpass::get_shader_precision() const
+{
+	return shader_precision;
+}
+
 void LightingSubpass::prepare()
 {
 	lighting_variant.add_definitions({"MAX_LIGHT_COUNT " + std::to_string(MAX_DEFERRED_LIGHT_COUNT)});
 
 	lighting_variant.add_definitions(vkb::rendering::light_type_definitions);
+
+	if (light_clusters)
+	{
+		lighting_variant.add_definitions(LightClusters::get_definitions());
+		light_clusters->prepare();
+	}
+
+	if (occlusion_attachment)
+	{
+		lighting_variant.add_definitions({"RAY_QUERY_OCCLUSION"});
+	}
+
+	if (shader_precision == ShaderPrecision::Half)
+	{
+		lighting_variant.add_definitions({"HALF_PRECISION"});
+	}
+
 	// Build all shaders upfront
 	auto &resource_cache = get_render_context().get_device().get_resource_cache();
-	resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), lighting_variant);
-	resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), lighting_variant);
+	resource_cache.CompileShaderModulesAsync({{VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), lighting_variant},
+	                                          {VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), lighting_variant}});
+}
+
+void LightingSubpass::draw_before_render_pass(CommandBuffer &command_buffer)
+{
+	if (light_clusters)
+	{
+		light_clusters->update(command_buffer);
+	}
 }
 
 void LightingSubpass::draw(CommandBuffer &command_buffer)
 {
-	allocate_lights<DeferredLights>(scene.get_components<sg::Light>(), MAX_DEFERRED_LIGHT_COUNT);
-	command_buffer.bind_lighting(get_lighting_state(), 0, 4);
+	if (light_clusters)
+	{
+		light_clusters->bind(command_buffer);
+	}
+	else
+	{
+		allocate_lights<DeferredLights>(scene.get_component_view<sg::Light>(), MAX_DEFERRED_LIGHT_COUNT);
+		command_buffer.bind_lighting(get_lighting_state(), 0, 4);
+	}
 
 	// Get shaders from cache
 	auto &resource_cache     = command_buffer.get_device().get_resource_cache();
@@ -68,15 +126,20 @@ void LightingSubpass::draw(CommandBuffer &command_buffer)
 	assert(3 < target_views.size());
 
 	// Bind depth, albedo, and normal as input attachments
-	auto &depth_view = target_views[1];
+	auto &depth_view = gbuffer_views[0] ? *gbuffer_views[0] : target_views[1];
 	command_buffer.bind_input(depth_view, 0, 0, 0);
 
-	auto &albedo_view = target_views[2];
+	auto &albedo_view = gbuffer_views[1] ? *gbuffer_views[1] : target_views[2];
 	command_buffer.bind_input(albedo_view, 0, 1, 0);
 
-	auto &normal_view = target_views[3];
+	auto &normal_view = gbuffer_views[2] ? *gbuffer_views[2] : target_views[3];
 	command_buffer.bind_input(normal_view, 0, 2, 0);
 
+	if (occlusion_attachment)
+	{
+		command_buffer.bind_input(target_views[*occlusion_attachment], 0, 19, 0);
+	}
+
 	// Set cull mode to front as full screen triangle is clock-wise
 	RasterizationState rasterization_state;
 	rasterization_state.cull_mode = VK_CULL_MODE_FRONT_BIT;
@@ -90,7 +153,7 @@ void LightingSubpass::draw(CommandBuffer &command_buffer)
 	light_uniform.inv_resolution.y = 1.0f / render_target.get_extent().height;
 
 	// Inverse view projection
-	light_uniform.inv_view_proj = glm::inverse(vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view());
+	light_uniform.inv_view_proj = glm::inverse(camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view());
 
 	// Allocate a buffer using the buffer pool from the active frame to store uniform values and bind it
 	auto &render_frame = get_render_context().get_active_frame();
@@ -17,7 +17,12 @@
 
 #pragma once
 
+#include <array>
+#include <optional>
+
 #include "buffer_pool.h"
+#include "rendering/light_clusters.h"
+#include "rendering/shader_precision.h"
 #include "rendering/subpass.h"
 
 #include "common/glm_common.h"
@@ -27,6 +32,11 @@
 
 namespace vkb
 {
+namespace core
+{
+class ImageView;
+}        // namespace core
+
 namespace sg
 {
 class Camera;
@@ -60,8 +70,43 @@ class LightingSubpass : public vkb::rendering::SubpassC
   public:
 	LightingSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader, sg::Camera &camera, sg::Scene &scene);
 
+	/**
+	 * @brief Assigns the lights to clusters of the view frustum with a compute pass, instead of looping over
+	 *        MAX_DEFERRED_LIGHT_COUNT lights of each type in every fragment. Must be called before prepare().
+	 * @throws std::runtime_error if the camera is not a perspective camera
+	 */
+	void enable_light_clusters();
+
+	/**
+	 * @brief Applies the visibility traced by a RayQueryShadowSubpass and a RayQueryAmbientOcclusionSubpass, read from the
+	 *        red and green channels of an attachment, to the first directional light and the ambient lighting.
+	 *        The attachment must be the fourth input attachment of the subpass. Must be called before prepare().
+	 * @param attachment Index of the occlusion attachment in the render target
+	 */
+	void set_occlusion_attachment(uint32_t attachment);
+
+	/**
+	 * @brief Reads the G-buffer from views of its own instead of the attachments 1 to 3 of the render target of the frame,
+	 *        such as the textures of a RenderGraph, whose render passes have render targets of their own
+	 * @param depth, albedo, normal The views, must stay valid while the subpass draws
+	 */
+	void set_gbuffer_views(const core::ImageView &depth, const core::ImageView &albedo, const core::ImageView &normal);
+
+	/**
+	 * @brief Sets the precision of the lighting math, selected from the enabled device features by default
+	 *        Half precision adds the HALF_PRECISION definition to the lighting variant. Must be called before prepare().
+	 */
+	void set_shader_precision(ShaderPrecision precision);
+
+	ShaderPrecision get_shader_precision() const;
+
 	virtual void prepare() override;
 
+	/**
+	 * @brief Assigns the lights to the clusters, if they are enabled
+	 */
+	void draw_before_render_pass(CommandBuffer &command_buffer) override;
+
 	void draw(CommandBuffer &command_buffer) override;
 
   private:
@@ -70,6 +115,15 @@ class LightingSubpass : public vkb::rendering::SubpassC
 	sg::Scene &scene;
 
 	ShaderVariant lighting_variant;
+
+	std::unique_ptr<LightClusters> light_clusters;
+
+	std::optional<uint32_t> occlusion_attachment;
+
+	/// Depth, albedo and normal views, the render target of the frame is read if unset
+	std::array<const core::ImageView *, 3> gbuffer_views{};
+
+	ShaderPrecision shader_precision;
 };
 
 }        // namespace vkb
@@ -0,0 +1,153 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpasses/meshlet_subpass.h"
+
+#include <algorithm>
+
+#include "common/utils.h"
+#include "common/vk_common.h"
+#include "core/physical_device.h"
+#include "rendering/render_context.h"
+#include "scene_graph/components/camera.h"
+#include "scene_graph/components/material.h"
+#include "scene_graph/components/mesh.h"
+#include "scene_graph/components/sub_mesh.h"
+
+namespace vkb
+{
+namespace
+{
+/// Uniform of the task shader
+struct alignas(16) MeshletUniform
+{
+	std::array<glm::vec4, 6> frustum_planes;
+
+	uint32_t cone_culling;
+};
+}        // namespace
+
+MeshletSubpass::MeshletSubpass(RenderContext &render_context,
+                               ShaderSource &&task_source,
+                               ShaderSource &&mesh_source,
+                               ShaderSource &&vertex_source,
+                               ShaderSource &&fragment_source,
+                               sg::Scene     &scene_,
+                               sg::Camera    &camera) :
+    ForwardSubpass{render_context, std::move(vertex_source), std::move(fragment_source), scene_, camera},
+    task_shader{std::move(task_source)},
+    mesh_shader{std::move(mesh_source)}
+{
+}
+
+void MeshletSubpass::request_gpu_features(PhysicalDevice &gpu)
+{
+	REQUEST_REQUIRED_FEATURE(gpu, VkPhysicalDeviceMeshShaderFeaturesEXT, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT, taskShader);
+	REQUEST_REQUIRED_FEATURE(gpu, VkPhysicalDeviceMeshShaderFeaturesEXT, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT, meshShader);
+}
+
+void MeshletSubpass::prepare()
+{
+	// Adds the lighting definitions to the variants and compiles the vertex and fragment shaders
+	ForwardSubpass::prepare();
+
+	std::vector<ShaderModuleRequest> requests;
+	for (auto &mesh : meshes)
+	{
+		for (auto &sub_mesh : mesh->get_submeshes())
+		{
+			if (sub_mesh->meshlet_count == 0)
+			{
+				continue;
+			}
+
+			requests.push_back({VK_SHADER_STAGE_TASK_BIT_EXT, task_shader, sub_mesh->get_shader_variant()});
+			requests.push_back({VK_SHADER_STAGE_MESH_BIT_EXT, mesh_shader, sub_mesh->get_shader_variant()});
+		}
+	}
+
+	get_render_context().get_device().get_resource_cache().CompileShaderModulesAsync(requests);
+}
+
+void MeshletSubpass::draw(CommandBuffer &command_buffer)
+{
+	frustum.update(camera.get_projection() * camera.get_view());
+
+	// Shared by the draws of every thread, so they are written before any draw is recorded
+	auto &render_frame = get_render_context().get_active_frame();
+	for (uint32_t cone_culling = 0; cone_culling < 2; ++cone_culling)
+	{
+		MeshletUniform uniform{};
+		std::copy(frustum.get_planes().begin(), frustum.get_planes().end(), uniform.frustum_planes.begin());
+		uniform.cone_culling = cone_culling;
+
+		culling_uniforms[cone_culling] = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(MeshletUniform), thread_index);
+		culling_uniforms[cone_culling].update(uniform);
+	}
+
+	ForwardSubpass::draw(command_buffer);
+}
+
+void MeshletSubpass::draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh, VkFrontFace front_face, uint32_t lod, uint32_t first_instance, uint32_t instance_count)
+{
+	// The mesh shader reads the world matrix from the global uniform, one instance at a time
+	if (sub_mesh.meshlet_count == 0 || lod > 0 || instancing || gpu_scene)
+	{
+		GeometrySubpass::draw_submesh(command_buffer, sub_mesh, front_face, lod, first_instance, instance_count);
+		return;
+	}
+
+	auto &resource_cache = command_buffer.get_device().get_resource_cache();
+
+	ScopedDebugLabel submesh_debug_label{command_buffer, sub_mesh.get_name().c_str()};
+
+	bool double_sided = sub_mesh.get_material()->double_sided;
+
+	prepare_pipeline_state(command_buffer, front_face, double_sided);
+
+	auto &task_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_TASK_BIT_EXT, task_shader, sub_mesh.get_shader_variant());
+	auto &mesh_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_MESH_BIT_EXT, mesh_shader, sub_mesh.get_shader_variant());
+	auto &frag_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), sub_mesh.get_shader_variant());
+
+	auto &pipeline_layout = prepare_pipeline_layout(command_buffer, {&task_shader_module, &mesh_shader_module, &frag_shader_module});
+
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	bind_material(command_buffer, pipeline_layout, sub_mesh);
+
+	// Back facing meshlets of double sided materials are still visible
+	auto &culling_uniform = culling_uniforms[double_sided ? 0 : 1];
+	command_buffer.bind_buffer(culling_uniform.get_buffer(), culling_uniform.get_offset(), culling_uniform.get_size(), 0, 7, 0);
+
+	command_buffer.bind_buffer(*sub_mesh.meshlet_buffer, 0, sub_mesh.meshlet_buffer->get_size(), 0, 8, 0);
+	command_buffer.bind_buffer(*sub_mesh.meshlet_vertex_buffer, 0, sub_mesh.meshlet_vertex_buffer->get_size(), 0, 9, 0);
+	command_buffer.bind_buffer(*sub_mesh.meshlet_triangle_buffer, 0, sub_mesh.meshlet_triangle_buffer->get_size(), 0, 10, 0);
+
+	// The attributes the shader variant doesn't define are left unbound
+	const std::array<std::pair<const char *, uint32_t>, 3> attributes{{{"position", 11}, {"normal", 12}, {"texcoord_0", 13}}};
+	for (auto &[name, binding] : attributes)
+	{
+		auto it = sub_mesh.vertex_buffers.find(name);
+		if (it != sub_mesh.vertex_buffers.end())
+		{
+			command_buffer.bind_buffer(it->second, 0, it->second.get_size(), 0, binding, 0);
+		}
+	}
+
+	command_buffer.draw_mesh_tasks((sub_mesh.meshlet_count + TaskGroupSize - 1) / TaskGroupSize, 1, 1);
+}
+}        // namespace vkb
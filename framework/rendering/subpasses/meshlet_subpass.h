@@ -0,0 +1,93 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "buffer_pool.h"
+#include "rendering/subpasses/forward_subpass.h"
+
+namespace vkb
+{
+class PhysicalDevice;
+
+/**
+ * @brief Renders a scene with task and mesh shaders, culling its meshlets on the GPU
+ *
+ * The sub meshes must have been loaded with GLTFLoader::set_build_meshlets(). Each task shader workgroup
+ * tests TaskGroupSize meshlets of a sub mesh against the camera frustum, with their bounding sphere, and
+ * against the camera position, with their normal cone, then launches a mesh shader workgroup per meshlet
+ * left. The mesh shader fetches the vertices from the vertex buffers of the sub mesh and outputs the inputs
+ * of the forward fragment shader, so the lighting is the same as the ForwardSubpass.
+ *
+ * The cone test is skipped for double sided materials and for nodes with a non-uniform scale, which bends
+ * the normals. The sub meshes without meshlets, and the simplified levels of detail, are drawn with the vertex shader.
+ */
+class MeshletSubpass : public ForwardSubpass
+{
+  public:
+	/// Meshlets tested by a task shader workgroup
+	static constexpr uint32_t TaskGroupSize = 32;
+
+	/**
+	 * @param render_context Render context
+	 * @param task_shader Task shader source, culling the meshlets
+	 * @param mesh_shader Mesh shader source, outputting the triangles of a meshlet
+	 * @param vertex_shader Vertex shader source, drawing the sub meshes without meshlets
+	 * @param fragment_shader Fragment shader source
+	 * @param scene Scene to render on this subpass
+	 * @param camera Camera used to look at the scene
+	 */
+	MeshletSubpass(RenderContext &render_context,
+	               ShaderSource &&task_shader,
+	               ShaderSource &&mesh_shader,
+	               ShaderSource &&vertex_shader,
+	               ShaderSource &&fragment_shader,
+	               sg::Scene     &scene,
+	               sg::Camera    &camera);
+
+	virtual ~MeshletSubpass() = default;
+
+	/**
+	 * @brief Requests the task and mesh shader features, to be called from VulkanSample::request_gpu_features
+	 *        The device must also enable VK_EXT_mesh_shader.
+	 * @throws std::runtime_error if the device doesn't support them
+	 */
+	static void request_gpu_features(PhysicalDevice &gpu);
+
+	virtual void prepare() override;
+
+	virtual void draw(CommandBuffer &command_buffer) override;
+
+  protected:
+	/**
+	 * @brief Draws the meshlets of the sub mesh, which are built from its full mesh, or a simplified level with the vertex shader
+	 *        Instanced draws also use the vertex shader.
+	 */
+	virtual void draw_submesh(CommandBuffer &command_buffer, sg::SubMesh &sub_mesh, VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE, uint32_t lod = 0,
+	                          uint32_t first_instance = 0, uint32_t instance_count = 1) override;
+
+  private:
+	ShaderSource task_shader;
+
+	ShaderSource mesh_shader;
+
+	/// Culling parameters of the task shader for the frame, without and with the cone test
+	std::array<BufferAllocationC, 2> culling_uniforms;
+};
+}        // namespace vkb
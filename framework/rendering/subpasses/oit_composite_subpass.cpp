@@ -0,0 +1,78 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpasses/oit_composite_subpass.h"
+
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+OITCompositeSubpass::OITCompositeSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader,
+                                         OrderIndependentTransparency &order_independent_transparency) :
+    Subpass{render_context, std::move(vertex_shader), std::move(fragment_shader)},
+    order_independent_transparency{order_independent_transparency}
+{
+	set_disable_depth_stencil_attachment(true);
+}
+
+void OITCompositeSubpass::prepare()
+{
+	composite_variant.add_definitions(order_independent_transparency.get_definitions());
+
+	auto &resource_cache = get_render_context().get_device().get_resource_cache();
+	resource_cache.CompileShaderModulesAsync({{VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), composite_variant},
+	                                          {VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), composite_variant}});
+}
+
+void OITCompositeSubpass::draw(CommandBuffer &command_buffer)
+{
+	auto &resource_cache     = command_buffer.get_device().get_resource_cache();
+	auto &vert_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), composite_variant);
+	auto &frag_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), composite_variant);
+
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&vert_shader_module, &frag_shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.set_vertex_input_state({});
+
+	// Set cull mode to front as full screen triangle is clock-wise
+	RasterizationState rasterization_state;
+	rasterization_state.cull_mode = VK_CULL_MODE_FRONT_BIT;
+	command_buffer.set_rasterization_state(rasterization_state);
+
+	DepthStencilState depth_stencil_state{};
+	depth_stencil_state.depth_test_enable  = VK_FALSE;
+	depth_stencil_state.depth_write_enable = VK_FALSE;
+	command_buffer.set_depth_stencil_state(depth_stencil_state);
+
+	// The composite outputs the premultiplied color of the fragments and their coverage, the alpha of the color is kept
+	ColorBlendAttachmentState color_blend_attachment{};
+	color_blend_attachment.blend_enable           = VK_TRUE;
+	color_blend_attachment.src_color_blend_factor = VK_BLEND_FACTOR_ONE;
+	color_blend_attachment.dst_color_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	color_blend_attachment.src_alpha_blend_factor = VK_BLEND_FACTOR_ZERO;
+	color_blend_attachment.dst_alpha_blend_factor = VK_BLEND_FACTOR_ONE;
+
+	ColorBlendState color_blend_state{};
+	color_blend_state.attachments.resize(get_output_attachments().size(), color_blend_attachment);
+	command_buffer.set_color_blend_state(color_blend_state);
+
+	order_independent_transparency.bind(command_buffer);
+
+	command_buffer.draw(3, 1, 0, 0);
+}
+}        // namespace vkb
@@ -0,0 +1,52 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "rendering/order_independent_transparency.h"
+#include "rendering/subpass.h"
+
+namespace vkb
+{
+/**
+ * @brief Sorts the transparent fragments stored in the k-buffer of each pixel and blends them over the color
+ *
+ * Must be the subpass following the GeometrySubpass storing the fragments, see
+ * GeometrySubpass::set_order_independent_transparency(). Draws a full screen triangle without depth attachment,
+ * with a vertex shader like postprocessing/postprocessing.vert and a fragment shader like oit/composite.frag.
+ */
+class OITCompositeSubpass : public vkb::rendering::SubpassC
+{
+  public:
+	/**
+	 * @param render_context Render context
+	 * @param vertex_shader Vertex shader source of the full screen triangle
+	 * @param fragment_shader Fragment shader source of the composite
+	 * @param order_independent_transparency The k-buffer to composite, must outlive the subpass
+	 */
+	OITCompositeSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader, OrderIndependentTransparency &order_independent_transparency);
+
+	virtual void prepare() override;
+
+	void draw(CommandBuffer &command_buffer) override;
+
+  private:
+	OrderIndependentTransparency &order_independent_transparency;
+
+	ShaderVariant composite_variant;
+};
+}        // namespace vkb
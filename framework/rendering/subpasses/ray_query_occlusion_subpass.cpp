@@ -0,0 +1,188 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpasses/ray_query_occlusion_subpass.h"
+
+#include "rendering/ray_tracing_scene.h"
+#include "rendering/render_context.h"
+#include "scene_graph/components/camera.h"
+#include "scene_graph/components/light.h"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+RayQueryOcclusionSubpass::RayQueryOcclusionSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader,
+                                                   sg::Camera &camera, RayTracingScene &ray_tracing_scene,
+                                                   const std::string &definition, VkColorComponentFlags channel, uint32_t rays_per_pixel, float ray_length) :
+    Subpass{render_context, std::move(vertex_shader), std::move(fragment_shader)},
+    camera{camera},
+    ray_tracing_scene{ray_tracing_scene},
+    channel{channel},
+    rays_per_pixel{rays_per_pixel},
+    ray_length{ray_length}
+{
+	set_disable_depth_stencil_attachment(true);
+
+	occlusion_variant.add_definitions({definition});
+}
+
+void RayQueryOcclusionSubpass::set_rays_per_pixel(uint32_t rays_per_pixel_)
+{
+	rays_per_pixel = std::max(rays_per_pixel_, 1u);
+}
+
+void RayQueryOcclusionSubpass::set_half_resolution(bool half_resolution_)
+{
+	half_resolution = half_resolution_;
+}
+
+void RayQueryOcclusionSubpass::set_ray_length(float ray_length_)
+{
+	ray_length = ray_length_;
+}
+
+void RayQueryOcclusionSubpass::prepare()
+{
+	auto &device = get_render_context().get_device();
+
+	if (half_resolution)
+	{
+		VkPhysicalDeviceSubgroupProperties subgroup_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+
+		VkPhysicalDeviceProperties2KHR properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR};
+		properties.pNext = &subgroup_properties;
+		vkGetPhysicalDeviceProperties2KHR(device.get_gpu().get_handle(), &properties);
+
+		if ((subgroup_properties.supportedStages & VK_SHADER_STAGE_FRAGMENT_BIT) && (subgroup_properties.supportedOperations & VK_SUBGROUP_FEATURE_QUAD_BIT))
+		{
+			occlusion_variant.add_definitions({"HALF_RESOLUTION"});
+		}
+		else
+		{
+			LOGW("Subgroup quad operations are not supported in fragment shaders, the occlusion rays are traced at full resolution");
+		}
+	}
+
+	auto &resource_cache = device.get_resource_cache();
+	resource_cache.CompileShaderModulesAsync({{VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), occlusion_variant},
+	                                          {VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), occlusion_variant}});
+}
+
+void RayQueryOcclusionSubpass::draw_before_render_pass(CommandBuffer &command_buffer)
+{
+	// Only records the update once per frame, when both the shadows and the ambient occlusion are traced
+	ray_tracing_scene.update(command_buffer, get_render_context().get_active_frame_index());
+}
+
+void RayQueryOcclusionSubpass::draw(CommandBuffer &command_buffer)
+{
+	auto &resource_cache     = command_buffer.get_device().get_resource_cache();
+	auto &vert_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), occlusion_variant);
+	auto &frag_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), occlusion_variant);
+
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&vert_shader_module, &frag_shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.set_vertex_input_state({});
+
+	auto &render_target = get_render_context().get_active_frame().GetRenderTarget();
+	auto &target_views  = render_target.get_views();
+	assert(3 < target_views.size());
+
+	command_buffer.bind_input(target_views[1], 0, 0, 0);
+	command_buffer.bind_input(target_views[3], 0, 2, 0);
+
+	// Set cull mode to front as full screen triangle is clock-wise
+	RasterizationState rasterization_state;
+	rasterization_state.cull_mode = VK_CULL_MODE_FRONT_BIT;
+	command_buffer.set_rasterization_state(rasterization_state);
+
+	DepthStencilState depth_stencil_state{};
+	depth_stencil_state.depth_test_enable  = VK_FALSE;
+	depth_stencil_state.depth_write_enable = VK_FALSE;
+	command_buffer.set_depth_stencil_state(depth_stencil_state);
+
+	// The shadows and the ambient occlusion share the attachment, each one writing its channel
+	ColorBlendAttachmentState color_blend_attachment{};
+	color_blend_attachment.color_write_mask = channel;
+
+	ColorBlendState color_blend_state{};
+	color_blend_state.attachments.resize(get_output_attachments().size(), color_blend_attachment);
+	command_buffer.set_color_blend_state(color_blend_state);
+
+	auto top_level_structure = ray_tracing_scene.get_device_address();
+
+	RayQueryOcclusionUniform uniform{};
+	uniform.inv_view_proj       = glm::inverse(camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view());
+	uniform.camera_position     = glm::inverse(camera.get_view())[3];
+	uniform.inv_resolution      = {1.0f / render_target.get_extent().width, 1.0f / render_target.get_extent().height};
+	uniform.top_level_structure = {static_cast<uint32_t>(top_level_structure), static_cast<uint32_t>(top_level_structure >> 32)};
+	uniform.ray_length          = ray_length;
+	uniform.bias                = 0.001f;
+	uniform.rays_per_pixel      = rays_per_pixel;
+	update_uniform(uniform);
+
+	auto allocation = get_render_context().get_active_frame().AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(RayQueryOcclusionUniform));
+	allocation.update(uniform);
+	command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, 3, 0);
+
+	command_buffer.draw(3, 1, 0, 0);
+}
+
+void RayQueryOcclusionSubpass::update_uniform(RayQueryOcclusionUniform &uniform)
+{
+}
+
+RayQueryShadowSubpass::RayQueryShadowSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader,
+                                             sg::Camera &camera, sg::Scene &scene, RayTracingScene &ray_tracing_scene) :
+    RayQueryOcclusionSubpass{render_context, std::move(vertex_shader), std::move(fragment_shader), camera, ray_tracing_scene,
+                             "RAY_QUERY_SHADOWS", VK_COLOR_COMPONENT_R_BIT, 1, DefaultRayLength}
+{
+	// The same light as the first directional light allocated by the lighting subpass
+	for (auto scene_light : scene.get_component_view<sg::Light>())
+	{
+		if (scene_light->get_light_type() == sg::LightType::Directional)
+		{
+			light = scene_light;
+			break;
+		}
+	}
+
+	if (!light)
+	{
+		LOGW("The scene has no directional light, the ray query shadows are not traced");
+	}
+}
+
+void RayQueryShadowSubpass::update_uniform(RayQueryOcclusionUniform &uniform)
+{
+	if (light)
+	{
+		auto &transform         = light->get_node()->get_transform();
+		uniform.light_direction = glm::vec4(transform.get_rotation() * light->get_properties().direction, 1.0f);
+	}
+}
+
+RayQueryAmbientOcclusionSubpass::RayQueryAmbientOcclusionSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader,
+                                                                 sg::Camera &camera, RayTracingScene &ray_tracing_scene) :
+    RayQueryOcclusionSubpass{render_context, std::move(vertex_shader), std::move(fragment_shader), camera, ray_tracing_scene,
+                             "RAY_QUERY_AMBIENT_OCCLUSION", VK_COLOR_COMPONENT_G_BIT, DefaultRaysPerPixel, DefaultRayLength}
+{
+}
+}        // namespace vkb
@@ -0,0 +1,168 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "common/glm_common.h"
+#include "rendering/subpass.h"
+
+namespace vkb
+{
+class RayTracingScene;
+
+namespace sg
+{
+class Camera;
+class Light;
+class Scene;
+}        // namespace sg
+
+/**
+ * @brief Uniform of deferred/ray_query_occlusion.frag
+ */
+struct alignas(16) RayQueryOcclusionUniform
+{
+	glm::mat4 inv_view_proj;
+
+	glm::vec4 camera_position;
+
+	/// Direction the light travels in, for the shadows
+	glm::vec4 light_direction;
+
+	glm::vec2 inv_resolution;
+
+	/// Device address of the top-level acceleration structure, as two 32-bit words
+	glm::uvec2 top_level_structure;
+
+	float ray_length;
+
+	/// Offset of the ray origins along the normal, relative to the distance to the camera
+	float bias;
+
+	uint32_t rays_per_pixel;
+};
+
+/**
+ * @brief Traces rays with ray queries from the surfaces of the G-buffer, writing their visibility to a channel of an occlusion attachment
+ *
+ * A subpass of the deferred render pass following the geometry subpass, drawing a full screen triangle with a vertex
+ * shader like deferred/lighting.vert and deferred/ray_query_occlusion.frag. It reads the depth and the normal as its
+ * input attachments 0 and 1, from the views 1 and 3 of the render target like the LightingSubpass, and writes its
+ * single output attachment, which must be cleared to white, see LightingSubpass::set_occlusion_attachment().
+ *
+ * At half resolution, each 2x2 quad of pixels traces the rays of a single pixel, spread across its four pixels, and
+ * the pixels blend the visibility of the quad with bilateral weights from their distance to the camera and their
+ * normal. A pixel getting less than half of the rays of the quad from its own surface traces them all, so the edges
+ * stay sharp. This
+ * needs subgroup quad operations in the fragment shaders, otherwise the rays are traced at full resolution.
+ *
+ * Shaders are compiled with GL_EXT_ray_query, which needs GLSLCompiler to target SPIR-V 1.4.
+ */
+class RayQueryOcclusionSubpass : public vkb::rendering::SubpassC
+{
+  public:
+	/**
+	 * @brief Sets the number of rays traced for a pixel, or for a quad of pixels at half resolution
+	 */
+	void set_rays_per_pixel(uint32_t rays_per_pixel);
+
+	/**
+	 * @brief Traces the rays of one pixel per quad, must be called before prepare()
+	 */
+	void set_half_resolution(bool half_resolution);
+
+	void set_ray_length(float ray_length);
+
+	virtual void prepare() override;
+
+	/**
+	 * @brief Updates the acceleration structures of the scene
+	 */
+	void draw_before_render_pass(CommandBuffer &command_buffer) override;
+
+	void draw(CommandBuffer &command_buffer) override;
+
+  protected:
+	/**
+	 * @param definition Selects what the fragment shader traces
+	 * @param channel Channel of the occlusion attachment written
+	 */
+	RayQueryOcclusionSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader,
+	                         sg::Camera &camera, RayTracingScene &ray_tracing_scene,
+	                         const std::string &definition, VkColorComponentFlags channel, uint32_t rays_per_pixel, float ray_length);
+
+	/**
+	 * @brief Fills the fields of the uniform specific to what is traced
+	 */
+	virtual void update_uniform(RayQueryOcclusionUniform &uniform);
+
+  private:
+	sg::Camera &camera;
+
+	RayTracingScene &ray_tracing_scene;
+
+	VkColorComponentFlags channel;
+
+	uint32_t rays_per_pixel;
+
+	float ray_length;
+
+	bool half_resolution{false};
+
+	ShaderVariant occlusion_variant;
+};
+
+/**
+ * @brief Hard shadows of the first directional light of the scene, written to the red channel of the occlusion attachment
+ *
+ * Replaces the shadow map of the light and the pass rendering it. The LightingSubpass applies the shadows to the
+ * first directional light, which is the light traced.
+ */
+class RayQueryShadowSubpass : public RayQueryOcclusionSubpass
+{
+  public:
+	/// Length of the shadow rays, in world units
+	static constexpr float DefaultRayLength = 1000.0f;
+
+	RayQueryShadowSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader,
+	                      sg::Camera &camera, sg::Scene &scene, RayTracingScene &ray_tracing_scene);
+
+  protected:
+	void update_uniform(RayQueryOcclusionUniform &uniform) override;
+
+  private:
+	sg::Light *light{nullptr};
+};
+
+/**
+ * @brief Short-range ambient occlusion, written to the green channel of the occlusion attachment
+ *
+ * The rays are distributed over the cosine-weighted hemisphere of the normal and rotated per quad of pixels,
+ * the occlusion being the fraction of the rays hitting geometry closer than the ray length.
+ */
+class RayQueryAmbientOcclusionSubpass : public RayQueryOcclusionSubpass
+{
+  public:
+	static constexpr uint32_t DefaultRaysPerPixel = 4;
+
+	/// Length of the ambient occlusion rays, in world units
+	static constexpr float DefaultRayLength = 0.5f;
+
+	RayQueryAmbientOcclusionSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader,
+	                                sg::Camera &camera, RayTracingScene &ray_tracing_scene);
+};
+}        // namespace vkb
@@ -0,0 +1,212 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpasses/tiled_lighting_subpass.h"
+
+#include <algorithm>
+
+#include "core/util/profiling.hpp"
+#include "rendering/light_clusters.h"
+#include "rendering/render_context.h"
+#include "scene_graph/components/camera.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+namespace
+{
+/// Format of the lit image, storage support is required for it
+constexpr VkFormat LitImageFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+}        // namespace
+
+TiledLightingSubpass::TiledLightingSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader, sg::Camera &camera, sg::Scene &scene) :
+    Subpass{render_context, std::move(vertex_shader), std::move(fragment_shader)},
+    camera{camera},
+    scene{scene},
+    tiled_shader{"deferred/tiled_lighting.comp"}
+{
+	tiled_variant.add_definitions({"TILE_SIZE " + std::to_string(TileSize),
+	                               "MAX_LIGHTS_PER_TILE " + std::to_string(MaxLightsPerTile)});
+	tiled_variant.add_definitions(vkb::rendering::light_type_definitions);
+
+	// The depth is only read by the compute pass, the composite draw doesn't test against it
+	set_disable_depth_stencil_attachment(true);
+
+	// The shader fetches the texels, filtering isn't used
+	VkSamplerCreateInfo sampler_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+	sampler_info.magFilter    = VK_FILTER_NEAREST;
+	sampler_info.minFilter    = VK_FILTER_NEAREST;
+	sampler_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	gbuffer_sampler           = std::make_unique<core::Sampler>(render_context.get_device(), sampler_info);
+}
+
+void TiledLightingSubpass::set_gbuffer_attachments(const std::array<uint32_t, 3> &attachments)
+{
+	gbuffer_attachments = attachments;
+}
+
+void TiledLightingSubpass::prepare()
+{
+	auto &resource_cache = get_render_context().get_device().get_resource_cache();
+	resource_cache.CompileShaderModulesAsync({{VK_SHADER_STAGE_COMPUTE_BIT, tiled_shader, tiled_variant},
+	                                          {VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), composite_variant},
+	                                          {VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), composite_variant}});
+}
+
+void TiledLightingSubpass::create_lit_image(const VkExtent2D &extent)
+{
+	lit_image_view.reset();
+
+	lit_image = std::make_unique<core::Image>(get_render_context().get_device(),
+	                                          core::ImageBuilder(VkExtent3D{extent.width, extent.height, 1})
+	                                              .with_format(LitImageFormat)
+	                                              .with_usage(VK_IMAGE_USAGE_STORAGE_BIT)
+	                                              .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY)
+	                                              .with_debug_name("Tiled lighting subpass: lit image"));
+
+	lit_image_view = std::make_unique<core::ImageView>(*lit_image, VK_IMAGE_VIEW_TYPE_2D, LitImageFormat);
+}
+
+void TiledLightingSubpass::draw_before_render_pass(CommandBuffer &command_buffer)
+{
+	PROFILE_SCOPE("Tiled Lighting");
+
+	auto &render_frame  = get_render_context().get_active_frame();
+	auto &render_target = render_frame.GetRenderTarget();
+	auto &extent        = render_target.get_extent();
+
+	if (!lit_image || lit_image->get_extent().width != extent.width || lit_image->get_extent().height != extent.height)
+	{
+		create_lit_image(extent);
+	}
+
+	ScopedDebugLabel debug_label{command_buffer, "Tiled lighting"};
+
+	// The G-buffer is left in the layouts of the geometry render pass
+	auto &views = render_target.get_views();
+	for (auto attachment : gbuffer_attachments)
+	{
+		auto &view = views.at(attachment);
+
+		ImageMemoryBarrier barrier{};
+		if (is_depth_format(view.get_format()))
+		{
+			barrier.old_layout      = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+			barrier.new_layout      = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+			barrier.src_stage_mask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			barrier.src_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		}
+		else
+		{
+			barrier.old_layout      = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.src_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			barrier.src_access_mask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		}
+		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+
+		command_buffer.image_memory_barrier(view, barrier);
+	}
+
+	// The copy of the previous frame read the lit image before it is written again, its content is discarded
+	ImageMemoryBarrier lit_barrier{};
+	lit_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+	lit_barrier.new_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	lit_barrier.src_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	lit_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	lit_barrier.dst_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	command_buffer.image_memory_barrier(*lit_image_view, lit_barrier);
+
+	auto global_light_count = LightClusters::gather_lights(scene, lights, light_bounds);
+
+	// Storage buffers can't be empty, an unused element is allocated without lights
+	auto light_allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, std::max<size_t>(lights.size(), 1) * sizeof(vkb::rendering::Light));
+	if (!lights.empty())
+	{
+		light_allocation.update(lights.data(), lights.size() * sizeof(vkb::rendering::Light));
+	}
+
+	auto bounds_allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, std::max<size_t>(light_bounds.size(), 1) * sizeof(glm::vec4));
+	if (!light_bounds.empty())
+	{
+		bounds_allocation.update(light_bounds.data(), light_bounds.size() * sizeof(glm::vec4));
+	}
+
+	auto projection = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection());
+
+	TiledLightingUniform uniform{};
+	uniform.inv_view_proj      = glm::inverse(projection * camera.get_view());
+	uniform.inv_projection     = glm::inverse(projection);
+	uniform.view               = camera.get_view();
+	uniform.resolution         = glm::uvec2(extent.width, extent.height);
+	uniform.global_light_count = global_light_count;
+	uniform.tiled_light_count  = to_u32(light_bounds.size());
+
+	auto uniform_allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(TiledLightingUniform));
+	uniform_allocation.update(uniform);
+
+	auto &resource_cache  = command_buffer.get_device().get_resource_cache();
+	auto &tiled_module    = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, tiled_shader, tiled_variant);
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&tiled_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	command_buffer.bind_image(views.at(gbuffer_attachments[0]), *gbuffer_sampler, 0, 0, 0);
+	command_buffer.bind_image(views.at(gbuffer_attachments[1]), *gbuffer_sampler, 0, 1, 0);
+	command_buffer.bind_image(views.at(gbuffer_attachments[2]), *gbuffer_sampler, 0, 2, 0);
+	command_buffer.bind_buffer(uniform_allocation.get_buffer(), uniform_allocation.get_offset(), uniform_allocation.get_size(), 0, 3, 0);
+	command_buffer.bind_buffer(light_allocation.get_buffer(), light_allocation.get_offset(), light_allocation.get_size(), 0, 4, 0);
+	command_buffer.bind_buffer(bounds_allocation.get_buffer(), bounds_allocation.get_offset(), bounds_allocation.get_size(), 0, 5, 0);
+	command_buffer.bind_image(*lit_image_view, 0, 6, 0);
+
+	command_buffer.dispatch((extent.width + TileSize - 1) / TileSize, (extent.height + TileSize - 1) / TileSize, 1);
+
+	ImageMemoryBarrier copy_barrier{};
+	copy_barrier.old_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	copy_barrier.new_layout      = VK_IMAGE_LAYOUT_GENERAL;
+	copy_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	copy_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	copy_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+	copy_barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+	command_buffer.image_memory_barrier(*lit_image_view, copy_barrier);
+}
+
+void TiledLightingSubpass::draw(CommandBuffer &command_buffer)
+{
+	auto &resource_cache     = command_buffer.get_device().get_resource_cache();
+	auto &vert_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), composite_variant);
+	auto &frag_shader_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), composite_variant);
+
+	auto &pipeline_layout = resource_cache.RequestPipelineLayout({&vert_shader_module, &frag_shader_module});
+	command_buffer.bind_pipeline_layout(pipeline_layout);
+
+	// The full screen triangle has no vertex input
+	command_buffer.set_vertex_input_state({});
+
+	// Set cull mode to front as full screen triangle is clock-wise
+	RasterizationState rasterization_state;
+	rasterization_state.cull_mode = VK_CULL_MODE_FRONT_BIT;
+	command_buffer.set_rasterization_state(rasterization_state);
+
+	command_buffer.bind_image(*lit_image_view, 0, 0, 0);
+
+	command_buffer.draw(3, 1, 0, 0);
+}
+}        // namespace vkb
@@ -0,0 +1,136 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "common/glm_common.h"
+#include "core/image.h"
+#include "core/image_view.h"
+#include "core/sampler.h"
+#include "rendering/subpass.h"
+
+namespace vkb
+{
+namespace sg
+{
+class Camera;
+class Scene;
+}        // namespace sg
+
+/**
+ * @brief Parameters of the tiled lighting shader, laid out as in the shader
+ */
+struct alignas(16) TiledLightingUniform
+{
+	/// Reconstructs the world position of a pixel from its depth
+	glm::mat4 inv_view_proj;
+
+	/// Reconstructs the view space bounds of a tile from its depth range
+	glm::mat4 inv_projection;
+
+	glm::mat4 view;
+
+	glm::uvec2 resolution;
+
+	/// Lights affecting every pixel, first in the light buffer
+	uint32_t global_light_count;
+
+	/// Lights culled against the tiles, after the global lights
+	uint32_t tiled_light_count;
+};
+
+/**
+ * @brief Lighting pass of Deferred Rendering evaluated by a compute shader, one workgroup per screen tile
+ *
+ * Before the render pass, the compute shader samples the depth, albedo and normal of the G-buffer, which
+ * the geometry render pass must have stored in images created with VK_IMAGE_USAGE_SAMPLED_BIT. Each workgroup
+ * reduces the depth of its TileSize x TileSize pixels to a depth range, culls the bounded lights against the
+ * view space bounds of the tile into a list in shared memory, then shades its pixels with the lights of the list
+ * only. The result is written to a storage image, which the subpass copies to its output attachment.
+ *
+ * Unlike the LightingSubpass, the G-buffer leaves the tile memory, so this path suits desktop GPUs where it is
+ * cheap to read it back and where the lights outnumber what a full screen pass can loop over. Lights are gathered
+ * as for the LightClusters, without the limits of MAX_DEFERRED_LIGHT_COUNT.
+ */
+class TiledLightingSubpass : public vkb::rendering::SubpassC
+{
+  public:
+	/// Width and height in pixels of a tile, the workgroup size of the shader
+	static constexpr uint32_t TileSize = 16;
+
+	/// Defined as MAX_LIGHTS_PER_TILE in the shader, the other lights of a tile are dropped
+	static constexpr uint32_t MaxLightsPerTile = 256;
+
+	/**
+	 * @param render_context Render context
+	 * @param vertex_shader Vertex shader source of the full screen triangle
+	 * @param fragment_shader Fragment shader source, copying the lit image
+	 * @param camera Camera the G-buffer was rendered with
+	 * @param scene Scene the lights are read from
+	 */
+	TiledLightingSubpass(RenderContext &render_context, ShaderSource &&vertex_shader, ShaderSource &&fragment_shader, sg::Camera &camera, sg::Scene &scene);
+
+	/**
+	 * @brief Sets the attachments of the render target holding the depth, albedo and normal, 1, 2 and 3 by default
+	 */
+	void set_gbuffer_attachments(const std::array<uint32_t, 3> &attachments);
+
+	virtual void prepare() override;
+
+	/**
+	 * @brief Lights the G-buffer into the lit image
+	 */
+	void draw_before_render_pass(CommandBuffer &command_buffer) override;
+
+	/**
+	 * @brief Copies the lit image to the output attachment
+	 */
+	void draw(CommandBuffer &command_buffer) override;
+
+  private:
+	void create_lit_image(const VkExtent2D &extent);
+
+	sg::Camera &camera;
+
+	sg::Scene &scene;
+
+	ShaderSource tiled_shader;
+
+	ShaderVariant tiled_variant;
+
+	ShaderVariant composite_variant;
+
+	std::array<uint32_t, 3> gbuffer_attachments{1, 2, 3};
+
+	std::unique_ptr<core::Sampler> gbuffer_sampler;
+
+	std::unique_ptr<core::Image> lit_image;
+
+	std::unique_ptr<core::ImageView> lit_image_view;
+
+	/// Global lights followed by the tiled lights
+	std::vector<vkb::rendering::Light> lights;
+
+	/// World position and radius of each tiled light
+	std::vector<glm::vec4> light_bounds;
+};
+}        // namespace vkb
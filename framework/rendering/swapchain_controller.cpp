@@ -0,0 +1,173 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/swapchain_controller.h"
+
+#include <algorithm>
+
+#include "common/strings.h"
+#include "core/util/logging.hpp"
+
+namespace vkb
+{
+SwapchainController::SwapchainController(std::chrono::duration<float>         target_frame_time,
+                                         const std::vector<VkPresentModeKHR> &present_modes,
+                                         uint32_t                             min_image_count,
+                                         bool                                 allow_tearing,
+                                         const Configuration                 &current) :
+    target_frame_time{target_frame_time}
+{
+	auto supported = [&](VkPresentModeKHR present_mode) {
+		return std::find(present_modes.begin(), present_modes.end(), present_mode) != present_modes.end();
+	};
+
+	bool relaxed = allow_tearing && supported(VK_PRESENT_MODE_FIFO_RELAXED_KHR);
+
+	std::vector<Configuration> configurations{{2, VK_PRESENT_MODE_FIFO_KHR}};
+	if (relaxed)
+	{
+		configurations.push_back({2, VK_PRESENT_MODE_FIFO_RELAXED_KHR});
+	}
+	configurations.push_back({3, relaxed ? VK_PRESENT_MODE_FIFO_RELAXED_KHR : VK_PRESENT_MODE_FIFO_KHR});
+	if (supported(VK_PRESENT_MODE_MAILBOX_KHR))
+	{
+		configurations.push_back({3, VK_PRESENT_MODE_MAILBOX_KHR});
+	}
+
+	for (auto configuration : configurations)
+	{
+		// The swapchain can't have fewer images than the surface requires
+		configuration.image_count = std::max(configuration.image_count, min_image_count);
+
+		if (levels.empty() ||
+		    levels.back().configuration.image_count != configuration.image_count ||
+		    levels.back().configuration.present_mode != configuration.present_mode)
+		{
+			levels.push_back({configuration});
+		}
+	}
+
+	auto it = std::find_if(levels.begin(), levels.end(), [&](const Level &candidate) {
+		return candidate.configuration.image_count == current.image_count && candidate.configuration.present_mode == current.present_mode;
+	});
+	level   = it != levels.end() ? static_cast<size_t>(it - levels.begin()) : levels.size() - 1;
+}
+
+bool SwapchainController::begin_frame()
+{
+	auto now     = std::chrono::steady_clock::now();
+	bool changed = false;
+
+	if (last_frame_start != std::chrono::steady_clock::time_point{})
+	{
+		std::chrono::duration<float> frame_time = now - last_frame_start;
+
+		++frame_count;
+		if (frame_time > target_frame_time * MissedFrameFactor)
+		{
+			++missed_frame_count;
+		}
+
+		if (frame_count >= window)
+		{
+			changed = evaluate_window();
+		}
+	}
+
+	last_frame_start = now;
+
+	return changed;
+}
+
+void SwapchainController::record_acquire_wait(std::chrono::duration<float> wait)
+{
+	acquire_wait += wait;
+}
+
+const SwapchainController::Configuration &SwapchainController::get_configuration() const
+{
+	return levels[level].configuration;
+}
+
+void SwapchainController::set_window(uint32_t frame_count)
+{
+	window = std::max(frame_count, 1u);
+}
+
+bool SwapchainController::evaluate_window()
+{
+	auto missed_ratio = static_cast<float>(missed_frame_count) / frame_count;
+	auto mean_wait    = acquire_wait / static_cast<float>(frame_count);
+	auto missed       = missed_frame_count;
+
+	frame_count        = 0;
+	missed_frame_count = 0;
+	acquire_wait       = std::chrono::duration<float>{0};
+
+	if (settling)
+	{
+		settling = false;
+		return false;
+	}
+
+	if (missed_ratio > MaxMissedRatio)
+	{
+		if (level + 1 >= levels.size())
+		{
+			return false;
+		}
+
+		if (on_trial)
+		{
+			// The configuration can't hold the frame rate yet, it is tried again later
+			levels[level].required_windows = std::min(levels[level].required_windows * 2, MaxRequiredWindows);
+		}
+
+		move_to(level + 1);
+		return true;
+	}
+
+	on_trial = false;
+
+	// Frames waiting for their images could start later and be presented as soon
+	if (level > 0 && missed == 0 && mean_wait >= target_frame_time * MinAcquireWaitRatio)
+	{
+		if (++good_windows >= levels[level - 1].required_windows)
+		{
+			move_to(level - 1);
+			on_trial = true;
+			return true;
+		}
+	}
+	else
+	{
+		good_windows = 0;
+	}
+
+	return false;
+}
+
+void SwapchainController::move_to(size_t new_level)
+{
+	level        = new_level;
+	good_windows = 0;
+	on_trial     = false;
+	settling     = true;
+
+	LOGD("Swapchain controller selected {} images with {}", levels[level].configuration.image_count, to_string(levels[level].configuration.present_mode));
+}
+}        // namespace vkb
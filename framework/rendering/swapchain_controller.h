@@ -0,0 +1,136 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "common/vk_common.h"
+
+namespace vkb
+{
+/**
+ * @brief Adapts the image count and present mode of a swapchain, for the lowest latency that holds a frame rate
+ *
+ * The render context reports the time each frame waited for its swapchain image, and the controller measures
+ * the time between the starts of consecutive frames. At the end of each window of frames:
+ *  - If too many frames missed the target interval, it moves to the next configuration, trading latency
+ *    for throughput.
+ *  - If none missed it and the frames waited for their images, the application renders ahead of the
+ *    presentation engine and its frames sit in the queue. After enough such windows, it moves back to the
+ *    previous configuration.
+ * A configuration that misses frames right after being moved back to needs twice the windows before the next try.
+ *
+ * The configurations, by increasing latency: 2 images with FIFO, 2 images with FIFO_RELAXED, 3 images with
+ * FIFO_RELAXED, 3 images with MAILBOX. The present modes that the surface doesn't support are skipped, as well as
+ * FIFO_RELAXED when tearing isn't allowed, which falls back to 3 images with FIFO.
+ */
+class SwapchainController
+{
+  public:
+	struct Configuration
+	{
+		uint32_t image_count;
+
+		VkPresentModeKHR present_mode;
+	};
+
+	/// Number of frames a decision is taken on
+	static constexpr uint32_t DefaultWindow = 120;
+
+	/**
+	 * @param target_frame_time The interval between frames to hold
+	 * @param present_modes The present modes supported by the surface
+	 * @param min_image_count The minimum image count of the surface
+	 * @param allow_tearing Whether late frames may be presented without waiting for the vertical blank
+	 * @param current The configuration of the swapchain, the controller starts from it if it is one of its own,
+	 *                otherwise from the one with the most throughput
+	 */
+	SwapchainController(std::chrono::duration<float>         target_frame_time,
+	                    const std::vector<VkPresentModeKHR> &present_modes,
+	                    uint32_t                             min_image_count,
+	                    bool                                 allow_tearing,
+	                    const Configuration                 &current);
+
+	/**
+	 * @brief Marks the start of a frame, before its swapchain image is acquired
+	 * @return Whether the configuration changed, the swapchain has to be recreated with get_configuration()
+	 */
+	bool begin_frame();
+
+	/**
+	 * @param wait The time the frame waited for its swapchain image
+	 */
+	void record_acquire_wait(std::chrono::duration<float> wait);
+
+	const Configuration &get_configuration() const;
+
+	void set_window(uint32_t frame_count);
+
+  private:
+	struct Level
+	{
+		Configuration configuration;
+
+		/// Windows without missed frames on the next level before moving back to this one
+		uint32_t required_windows{2};
+	};
+
+	/// Frames slower than this fraction of the target interval are counted as missed
+	static constexpr float MissedFrameFactor = 1.5f;
+
+	/// Fraction of missed frames in a window above which the throughput is increased
+	static constexpr float MaxMissedRatio = 0.05f;
+
+	/// Fraction of the target interval the frames have to wait for their images on average to reduce the latency
+	static constexpr float MinAcquireWaitRatio = 0.25f;
+
+	static constexpr uint32_t MaxRequiredWindows = 32;
+
+	/**
+	 * @return Whether the level changed
+	 */
+	bool evaluate_window();
+
+	void move_to(size_t level);
+
+	std::chrono::duration<float> target_frame_time;
+
+	std::vector<Level> levels;
+
+	size_t level{0};
+
+	uint32_t window{DefaultWindow};
+
+	std::chrono::steady_clock::time_point last_frame_start{};
+
+	uint32_t frame_count{0};
+
+	uint32_t missed_frame_count{0};
+
+	std::chrono::duration<float> acquire_wait{0};
+
+	uint32_t good_windows{0};
+
+	/// Whether the current level was moved back to, and hasn't held the frame rate for a window yet
+	bool on_trial{false};
+
+	/// Whether the first window after a change is skipped, absorbing the recreation of the swapchain
+	bool settling{true};
+};
+}        // namespace vkb
@@ -0,0 +1,335 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/texture_residency_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/command_buffer.h"
+#include "core/command_pool.h"
+#include "core/device.h"
+#include "core/image.h"
+#include "core/image_view.h"
+#include "scene_graph/components/image.h"
+
+namespace vkb
+{
+namespace
+{
+VmaBudget get_device_local_budget(Device &device)
+{
+	VmaBudget heap_budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetHeapBudgets(allocated::get_memory_allocator(), heap_budgets);
+
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties(device.get_gpu().get_handle(), &memory_properties);
+
+	VmaBudget budget{};
+	for (uint32_t heap = 0; heap < memory_properties.memoryHeapCount; ++heap)
+	{
+		if (memory_properties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			budget.budget += heap_budgets[heap].budget;
+			budget.usage += heap_budgets[heap].usage;
+		}
+	}
+	return budget;
+}
+}        // namespace
+
+TextureResidencyManager::TextureResidencyManager(Device &device, uint32_t frame_count) :
+    device{device},
+    frame_count{frame_count},
+    graphics_queue{device.get_suitable_graphics_queue()}
+{
+	for (auto &slot : upload_slots)
+	{
+		slot.command_pool = std::make_unique<CommandPool>(device, graphics_queue.get_family_index());
+
+		VkFenceCreateInfo fence_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+		VK_CHECK(vkCreateFence(device.get_handle(), &fence_info, nullptr, &slot.fence));
+	}
+}
+
+TextureResidencyManager::~TextureResidencyManager()
+{
+	for (auto &slot : upload_slots)
+	{
+		wait(slot);
+
+		vkDestroyFence(device.get_handle(), slot.fence, nullptr);
+	}
+
+	// The frames in flight may still sample the retired images
+	device.wait_idle();
+}
+
+bool TextureResidencyManager::can_stream(const sg::Image &image) const
+{
+	return image.get_mipmaps().size() > 1 && image.get_layers() == 1 && !image.has_gpu_mipmaps() && !image.get_data().empty();
+}
+
+uint32_t TextureResidencyManager::get_initial_base_level(const sg::Image &image) const
+{
+	auto &mipmaps = image.get_mipmaps();
+
+	for (uint32_t level = 0; level < mipmaps.size(); ++level)
+	{
+		if (std::max(mipmaps[level].extent.width, mipmaps[level].extent.height) <= InitialMaxExtent)
+		{
+			return level;
+		}
+	}
+
+	return to_u32(mipmaps.size()) - 1;
+}
+
+void TextureResidencyManager::register_image(sg::Image &image)
+{
+	assert(can_stream(image) && "The image has no mip chain to stream");
+
+	entries.emplace(&image, Entry{&image, image.get_resident_base_level()});
+}
+
+void TextureResidencyManager::request(const sg::Image &image, float screen_size)
+{
+	auto it = entries.find(&image);
+	if (it == entries.end())
+	{
+		return;
+	}
+
+	auto &entry      = it->second;
+	auto &extent     = image.get_extent();
+	auto  last_level = to_u32(image.get_mipmaps().size()) - 1;
+
+	// A texture mapped once over the surface needs the level matching its size on screen
+	uint32_t level = last_level;
+	if (screen_size >= 1.0f)
+	{
+		float texels_per_pixel = std::max(extent.width, extent.height) / screen_size;
+		level                  = texels_per_pixel > 1.0f ? static_cast<uint32_t>(std::floor(std::log2(texels_per_pixel))) : 0;
+		level                  = std::min(level, last_level);
+	}
+
+	// Keeps the finest level of the draws of an update
+	if (entry.last_requested != update_count)
+	{
+		entry.desired_level  = level;
+		entry.last_requested = update_count;
+	}
+	else
+	{
+		entry.desired_level = std::min(entry.desired_level, level);
+	}
+}
+
+void TextureResidencyManager::update()
+{
+	++update_count;
+
+	// Destroys the images the frames in flight are done with
+	retired_images.erase(std::remove_if(retired_images.begin(), retired_images.end(),
+	                                    [this](const RetiredImage &retired) { return retired.last_use < update_count; }),
+	                     retired_images.end());
+
+	auto &slot = upload_slots[current_slot];
+	wait(slot);
+	slot.command_pool->reset_pool();
+	slot.staging_buffers.clear();
+
+	auto budget = get_device_local_budget(device);
+
+	const auto high_watermark = static_cast<VkDeviceSize>(budget.budget * HighWatermark);
+	const auto low_watermark  = static_cast<VkDeviceSize>(budget.budget * LowWatermark);
+
+	std::vector<Entry *> candidates;
+	bool                 dropping = budget.usage > high_watermark;
+
+	if (dropping)
+	{
+		// Drops a level of the images least recently requested
+		for (auto &it : entries)
+		{
+			auto &entry = it.second;
+			if (entry.image->get_resident_base_level() + 1 < entry.image->get_mipmaps().size())
+			{
+				candidates.push_back(&entry);
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Entry *a, const Entry *b) { return a->last_requested < b->last_requested; });
+	}
+	else if (budget.usage < low_watermark)
+	{
+		// Restores a level of the images most recently requested which need it, once it is loaded
+		for (auto &it : entries)
+		{
+			auto &entry = it.second;
+			if (entry.desired_level < entry.image->get_resident_base_level() &&
+			    entry.image->get_loaded_base_level() < entry.image->get_resident_base_level())
+			{
+				candidates.push_back(&entry);
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Entry *a, const Entry *b) { return a->last_requested > b->last_requested; });
+	}
+
+	if (candidates.empty())
+	{
+		return;
+	}
+
+	auto &command_buffer = slot.command_pool->request_command_buffer();
+	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	VkDeviceSize usage        = budget.usage;
+	uint32_t     change_count = 0;
+
+	for (auto *entry : candidates)
+	{
+		if (change_count == MaxChangesPerUpdate)
+		{
+			break;
+		}
+
+		auto base_level   = entry->image->get_resident_base_level();
+		auto current_size = get_resident_size(*entry->image, base_level);
+
+		if (dropping)
+		{
+			if (usage <= high_watermark)
+			{
+				break;
+			}
+
+			change_base_level(*entry, base_level + 1, slot, command_buffer);
+			usage -= current_size - get_resident_size(*entry->image, base_level + 1);
+		}
+		else
+		{
+			auto extra_size = get_resident_size(*entry->image, base_level - 1) - current_size;
+			if (usage + extra_size > high_watermark)
+			{
+				continue;
+			}
+
+			change_base_level(*entry, base_level - 1, slot, command_buffer);
+			usage += extra_size;
+		}
+
+		++change_count;
+	}
+
+	command_buffer.end();
+
+	if (change_count == 0)
+	{
+		slot.command_pool->reset_pool();
+		return;
+	}
+
+	VK_CHECK(graphics_queue.submit(command_buffer, slot.fence));
+
+	slot.in_flight = true;
+	current_slot   = (current_slot + 1) % UploadSlotCount;
+}
+
+VkDeviceSize TextureResidencyManager::get_budget() const
+{
+	return get_device_local_budget(device).budget;
+}
+
+VkDeviceSize TextureResidencyManager::get_usage() const
+{
+	return get_device_local_budget(device).usage;
+}
+
+VkDeviceSize TextureResidencyManager::get_resident_size(const sg::Image &image, uint32_t base_level) const
+{
+	return image.get_data().size() - image.get_mipmaps()[base_level].offset;
+}
+
+void TextureResidencyManager::change_base_level(Entry &entry, uint32_t base_level, UploadSlot &slot, CommandBuffer &command_buffer)
+{
+	auto &image = *entry.image;
+
+	// The frames in flight keep sampling the previous image
+	auto previous = image.release_vk_image();
+	retired_images.push_back({std::move(previous.first), std::move(previous.second), update_count + frame_count});
+
+	image.set_resident_base_level(base_level);
+	image.create_vk_image(device);
+
+	auto &mipmaps     = image.get_mipmaps();
+	auto &data        = image.get_data();
+	auto  data_offset = mipmaps[base_level].offset;
+
+	slot.staging_buffers.push_back(core::BufferC::create_staging_buffer(device, data.size() - data_offset, data.data() + data_offset));
+	auto &staging_buffer = slot.staging_buffers.back();
+
+	std::vector<VkBufferImageCopy> copy_regions(mipmaps.size() - base_level);
+	for (size_t i = base_level; i < mipmaps.size(); ++i)
+	{
+		auto &copy_region = copy_regions[i - base_level];
+
+		copy_region.bufferOffset              = mipmaps[i].offset - data_offset;
+		copy_region.imageSubresource          = image.get_vk_image_view().get_subresource_layers();
+		copy_region.imageSubresource.mipLevel = mipmaps[i].level - base_level;
+		copy_region.imageExtent               = mipmaps[i].extent;
+	}
+
+	VkImageMemoryBarrier image_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+	image_barrier.srcAccessMask       = 0;
+	image_barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+	image_barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.image               = image.get_vk_image().get_handle();
+	image_barrier.subresourceRange    = image.get_vk_image_view().get_subresource_range();
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+	vkCmdCopyBufferToImage(command_buffer.get_handle(), staging_buffer.get_handle(), image_barrier.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	                       to_u32(copy_regions.size()), copy_regions.data());
+
+	// The frames submitted after the upload sample the new image
+	image_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	image_barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+}
+
+void TextureResidencyManager::wait(UploadSlot &slot)
+{
+	if (!slot.in_flight)
+	{
+		return;
+	}
+
+	VK_CHECK(vkWaitForFences(device.get_handle(), 1, &slot.fence, VK_TRUE, std::numeric_limits<uint64_t>::max()));
+	VK_CHECK(vkResetFences(device.get_handle(), 1, &slot.fence));
+
+	slot.in_flight = false;
+}
+}        // namespace vkb
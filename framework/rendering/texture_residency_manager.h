@@ -0,0 +1,198 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/buffer.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class CommandPool;
+class Device;
+class Queue;
+
+namespace core
+{
+class Image;
+class ImageView;
+}        // namespace core
+
+namespace sg
+{
+class Image;
+}        // namespace sg
+
+/**
+ * @brief Streams the mip levels of images within the device memory budget
+ *
+ * The registered images keep their full mip chain in host memory, while their Vulkan image
+ * only holds the levels from a resident base level. Every frame the renderer requests the
+ * images it draws with their size on screen, from which the finest useful level is derived.
+ *
+ * Each update compares the device local memory in use to the budget reported by the allocator,
+ * which comes from VK_EXT_memory_budget when the extension is enabled. Above the high watermark,
+ * the images least recently requested drop their finest level. Below the low watermark, the
+ * images most recently requested get back a level they need, if it fits under the high watermark
+ * and it is loaded: the finer levels of images may still be decoding when they are registered.
+ *
+ * Changing the base level recreates the Vulkan image and uploads its levels on the graphics
+ * queue, before the frame using it. The previous image is destroyed once the frames in flight
+ * are complete. Descriptors must be bound at every draw, as the image views change.
+ */
+class TextureResidencyManager
+{
+  public:
+	/// Fraction of the budget above which levels are dropped
+	static constexpr float HighWatermark = 0.9f;
+
+	/// Fraction of the budget below which levels are restored
+	static constexpr float LowWatermark = 0.75f;
+
+	/// Largest side of the levels images are created with
+	static constexpr uint32_t InitialMaxExtent = 128;
+
+	/// Images whose base level changes per update, bounding the upload work of a frame
+	static constexpr uint32_t MaxChangesPerUpdate = 4;
+
+	/// Upload batches in flight
+	static constexpr uint32_t UploadSlotCount = 3;
+
+	/**
+	 * @param device The device the images are created on
+	 * @param frame_count The number of frames in flight, which may still use a replaced image
+	 */
+	TextureResidencyManager(Device &device, uint32_t frame_count);
+
+	TextureResidencyManager(const TextureResidencyManager &) = delete;
+
+	TextureResidencyManager(TextureResidencyManager &&) = delete;
+
+	~TextureResidencyManager();
+
+	TextureResidencyManager &operator=(const TextureResidencyManager &) = delete;
+
+	TextureResidencyManager &operator=(TextureResidencyManager &&) = delete;
+
+	/**
+	 * @return Whether the levels of an image can be streamed, it needs a mip chain in its data and a single layer
+	 */
+	bool can_stream(const sg::Image &image) const;
+
+	/**
+	 * @return The base level an image is created with, the first level no larger than InitialMaxExtent
+	 */
+	uint32_t get_initial_base_level(const sg::Image &image) const;
+
+	/**
+	 * @brief Manages the levels of an image, whose Vulkan image is created from its resident base level
+	 *        The image must outlive the manager, and keep its data.
+	 */
+	void register_image(sg::Image &image);
+
+	/**
+	 * @brief Reports that an image is drawn in the current frame
+	 * @param image The image sampled, ignored if it isn't registered
+	 * @param screen_size The largest side of the image on screen, in pixels
+	 */
+	void request(const sg::Image &image, float screen_size);
+
+	/**
+	 * @brief Changes the base level of the images according to the requests and the memory budget
+	 *        Called once per frame, before the frame is drawn.
+	 */
+	void update();
+
+	/**
+	 * @return The budget of the device local heaps, in bytes
+	 */
+	VkDeviceSize get_budget() const;
+
+	/**
+	 * @return The device local memory in use, in bytes
+	 */
+	VkDeviceSize get_usage() const;
+
+  private:
+	struct Entry
+	{
+		sg::Image *image;
+
+		/// Finest level requested during the last update it was requested in
+		uint32_t desired_level;
+
+		/// Last update requesting the image
+		uint64_t last_requested{0};
+	};
+
+	struct RetiredImage
+	{
+		std::unique_ptr<core::Image> image;
+
+		std::unique_ptr<core::ImageView> image_view;
+
+		/// Update after which the image is no longer in use
+		uint64_t last_use;
+	};
+
+	struct UploadSlot
+	{
+		std::vector<core::BufferC> staging_buffers;
+
+		std::unique_ptr<CommandPool> command_pool;
+
+		VkFence fence{VK_NULL_HANDLE};
+
+		bool in_flight{false};
+	};
+
+	/**
+	 * @return The size of the levels of an image from a base level
+	 */
+	VkDeviceSize get_resident_size(const sg::Image &image, uint32_t base_level) const;
+
+	/**
+	 * @brief Recreates the Vulkan image of an entry from a new base level, and records its upload
+	 */
+	void change_base_level(Entry &entry, uint32_t base_level, UploadSlot &slot, CommandBuffer &command_buffer);
+
+	void wait(UploadSlot &slot);
+
+	Device &device;
+
+	uint32_t frame_count;
+
+	const Queue &graphics_queue;
+
+	std::unordered_map<const sg::Image *, Entry> entries;
+
+	std::vector<RetiredImage> retired_images;
+
+	std::array<UploadSlot, UploadSlotCount> upload_slots;
+
+	uint32_t current_slot{0};
+
+	uint64_t update_count{0};
+};
+}        // namespace vkb
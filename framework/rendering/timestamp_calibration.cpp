@@ -0,0 +1,145 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/timestamp_calibration.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "core/device.h"
+
+#ifdef _WIN32
+#	include <windows.h>
+#endif
+
+namespace vkb
+{
+namespace
+{
+/// Samples taken by a calibration, the implementation may be preempted between reading the clocks
+constexpr uint32_t CalibrationSamples = 4;
+
+/**
+ * @return The time domain of the host clock behind Timer::Clock
+ */
+VkTimeDomainEXT get_host_domain()
+{
+#ifdef _WIN32
+	return VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+	return VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+}
+}        // namespace
+
+bool TimestampCalibration::is_supported(Device &device)
+{
+	if (!device.is_enabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+	{
+		return false;
+	}
+
+	uint32_t domain_count{0};
+	VK_CHECK(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(device.get_gpu().get_handle(), &domain_count, nullptr));
+
+	std::vector<VkTimeDomainEXT> domains(domain_count);
+	VK_CHECK(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(device.get_gpu().get_handle(), &domain_count, domains.data()));
+
+	return std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end() &&
+	       std::find(domains.begin(), domains.end(), get_host_domain()) != domains.end();
+}
+
+TimestampCalibration::TimestampCalibration(Device &device, uint32_t queue_family_index, std::chrono::milliseconds period) :
+    device{device},
+    period{period},
+    host_domain{get_host_domain()}
+{
+	assert(is_supported(device) && "The device can't calibrate its timestamps with the host clock");
+
+	timestamp_period = device.get_gpu().get_properties().limits.timestampPeriod;
+
+	uint32_t valid_bits = device.get_gpu().get_queue_family_properties()[queue_family_index].timestampValidBits;
+	if (valid_bits < 64)
+	{
+		timestamp_mask = (1ull << valid_bits) - 1;
+	}
+
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	host_frequency = static_cast<uint64_t>(frequency.QuadPart);
+#endif
+
+	calibrate();
+}
+
+void TimestampCalibration::update()
+{
+	if (Timer::Clock::now() - host_time >= period)
+	{
+		calibrate();
+	}
+}
+
+void TimestampCalibration::calibrate()
+{
+	std::array<VkCalibratedTimestampInfoEXT, 2> infos{};
+	infos[0].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+	infos[1].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	infos[1].timeDomain = host_domain;
+
+	uint64_t best_deviation = ~0ull;
+	for (uint32_t i = 0; i < CalibrationSamples; ++i)
+	{
+		std::array<uint64_t, 2> timestamps{};
+		uint64_t                deviation{0};
+		VK_CHECK(vkGetCalibratedTimestampsEXT(device.get_handle(), to_u32(infos.size()), infos.data(), timestamps.data(), &deviation));
+
+		if (deviation >= best_deviation)
+		{
+			continue;
+		}
+
+		best_deviation   = deviation;
+		device_timestamp = timestamps[0] & timestamp_mask;
+
+		// Split to keep the product in 64 bits for the frequencies of performance counters
+		uint64_t host_ticks = timestamps[1];
+		uint64_t host_ns    = host_ticks / host_frequency * 1000000000ull + host_ticks % host_frequency * 1000000000ull / host_frequency;
+		host_time           = Timer::Clock::time_point{std::chrono::duration_cast<Timer::Clock::duration>(std::chrono::nanoseconds{host_ns})};
+	}
+
+	max_deviation = std::chrono::nanoseconds{best_deviation};
+}
+
+Timer::Clock::time_point TimestampCalibration::to_host_time(uint64_t timestamp) const
+{
+	// Timestamps written before the calibration are behind it, sign extend the ticks from the valid bits
+	uint64_t ticks = (timestamp - device_timestamp) & timestamp_mask;
+	int64_t  delta = ticks > (timestamp_mask >> 1) ? -static_cast<int64_t>((timestamp_mask - ticks) + 1) : static_cast<int64_t>(ticks);
+
+	auto offset = std::chrono::nanoseconds{static_cast<int64_t>(static_cast<double>(delta) * timestamp_period)};
+	return host_time + std::chrono::duration_cast<Timer::Clock::duration>(offset);
+}
+
+std::chrono::nanoseconds TimestampCalibration::get_max_deviation() const
+{
+	return max_deviation;
+}
+}        // namespace vkb
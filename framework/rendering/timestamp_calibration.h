@@ -0,0 +1,98 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include "common/vk_common.h"
+#include "timer.h"
+
+namespace vkb
+{
+class Device;
+
+/**
+ * @brief Converts the timestamps of a device into the clock of vkb::Timer, with VK_EXT_calibrated_timestamps
+ *
+ * Each calibration samples the device timestamp and the host clock together. The clocks drift apart over time,
+ * so update() calibrates again once a period elapsed. The timestamps written by queries can then be compared
+ * with the CPU times, e.g. to measure the time between a submission and the GPU starting it.
+ */
+class TimestampCalibration
+{
+  public:
+	/// Default time between two calibrations
+	static constexpr std::chrono::seconds DefaultPeriod{1};
+
+	/**
+	 * @return Whether the extension is enabled with both the device and the host clock calibrateable
+	 */
+	static bool is_supported(Device &device);
+
+	/**
+	 * @param device The device the timestamps are written by
+	 * @param queue_family_index The family of the queues writing the timestamps, for their valid bits
+	 * @param period Time between two calibrations in update()
+	 */
+	TimestampCalibration(Device &device, uint32_t queue_family_index, std::chrono::milliseconds period = DefaultPeriod);
+
+	/**
+	 * @brief Calibrates again if the period elapsed since the last calibration, to be called once per frame
+	 */
+	void update();
+
+	/**
+	 * @brief Samples both clocks, keeping the sample with the lowest deviation of a few
+	 */
+	void calibrate();
+
+	/**
+	 * @param timestamp A timestamp written by a query of the device, masked with the valid bits of its queue
+	 * @return The time of the host clock the device wrote the timestamp at
+	 */
+	Timer::Clock::time_point to_host_time(uint64_t timestamp) const;
+
+	/**
+	 * @return The largest error of the last calibration, as reported by the implementation
+	 */
+	std::chrono::nanoseconds get_max_deviation() const;
+
+  private:
+	Device &device;
+
+	std::chrono::milliseconds period;
+
+	/// The host time domain Timer::Clock reads
+	VkTimeDomainEXT host_domain;
+
+	/// Nanoseconds per timestamp tick
+	double timestamp_period{1.0};
+
+	/// Masks the bits of the timestamps the queues don't write
+	uint64_t timestamp_mask{~0ull};
+
+	/// Host clock ticks per second, the host domain may count in other units than nanoseconds
+	uint64_t host_frequency{1000000000};
+
+	uint64_t device_timestamp{0};
+
+	Timer::Clock::time_point host_time;
+
+	std::chrono::nanoseconds max_deviation{0};
+};
+}        // namespace vkb
@@ -0,0 +1,918 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/virtual_texture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "common/vk_initializers.h"
+#include "core/command_buffer.h"
+#include "core/command_pool.h"
+#include "core/device.h"
+#include "scene_graph/components/image.h"
+
+namespace vkb
+{
+namespace
+{
+const VkImageUsageFlags image_usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+uint32_t get_level_size(uint32_t size, uint32_t level)
+{
+	return std::max(1u, size >> level);
+}
+}        // namespace
+
+VirtualTexture::VirtualTexture(Device &device, VkFormat format, const VkExtent2D &extent, uint32_t mip_levels, VkDeviceSize memory_budget, uint32_t frame_count, PageSource page_source) :
+    device{device},
+    format{format},
+    extent{extent},
+    mip_levels{mip_levels},
+    page_source{std::move(page_source)},
+    graphics_queue{device.get_suitable_graphics_queue()},
+    sparse_queue{device.get_queue_by_flags(VK_QUEUE_SPARSE_BINDING_BIT, 0)}
+{
+	create_image();
+
+	// Every page of the pool has the size of a sparse block
+	VkMemoryRequirements memory_requirements;
+	vkGetImageMemoryRequirements(device.get_handle(), image, &memory_requirements);
+
+	uint32_t slot_count = static_cast<uint32_t>(std::max<VkDeviceSize>(1, memory_budget / page_size));
+
+	VkMemoryAllocateInfo memory_info{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+	memory_info.allocationSize  = slot_count * page_size;
+	memory_info.memoryTypeIndex = device.get_memory_type(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	VK_CHECK(vkAllocateMemory(device.get_handle(), &memory_info, nullptr, &page_memory));
+
+	// Slots are taken from the back
+	free_slots.resize(slot_count);
+	for (uint32_t i = 0; i < slot_count; ++i)
+	{
+		free_slots[i] = slot_count - 1 - i;
+	}
+
+	feedback_buffers.reserve(frame_count);
+	for (uint32_t i = 0; i < frame_count; ++i)
+	{
+		feedback_buffers.push_back(std::make_unique<core::BufferC>(device,
+		                                                           pages.size() * sizeof(uint32_t),
+		                                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		                                                           VMA_MEMORY_USAGE_GPU_TO_CPU));
+		std::memset(feedback_buffers.back()->map(), 0, pages.size() * sizeof(uint32_t));
+	}
+
+	const VkDeviceSize page_table_size = levels[0].columns * levels[0].rows * sizeof(uint32_t);
+
+	page_table_buffer = std::make_unique<core::BufferC>(device,
+	                                                    page_table_size,
+	                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                    VMA_MEMORY_USAGE_GPU_ONLY);
+
+	for (auto &slot : upload_slots)
+	{
+		// The new pages, then the page tables after the evictions and after the uploads
+		slot.staging_buffer = std::make_unique<core::BufferC>(
+		    core::BufferC::create_staging_buffer(device, MaxPagesPerUpdate * page_size + 2 * page_table_size, nullptr));
+
+		slot.command_pool = std::make_unique<CommandPool>(device, graphics_queue.get_family_index());
+
+		VkFenceCreateInfo fence_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+		VK_CHECK(vkCreateFence(device.get_handle(), &fence_info, nullptr, &slot.fence));
+
+		VkSemaphoreCreateInfo semaphore_info{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+		VK_CHECK(vkCreateSemaphore(device.get_handle(), &semaphore_info, nullptr, &slot.evicted_semaphore));
+		VK_CHECK(vkCreateSemaphore(device.get_handle(), &semaphore_info, nullptr, &slot.bound_semaphore));
+	}
+
+	bind_mip_tail();
+
+	upload_initial_levels();
+}
+
+VirtualTexture::~VirtualTexture()
+{
+	for (auto &slot : upload_slots)
+	{
+		wait(slot);
+
+		vkDestroyFence(device.get_handle(), slot.fence, nullptr);
+		vkDestroySemaphore(device.get_handle(), slot.evicted_semaphore, nullptr);
+		vkDestroySemaphore(device.get_handle(), slot.bound_semaphore, nullptr);
+	}
+
+	// The sparse binding queue may still be binding pages
+	vkQueueWaitIdle(sparse_queue.get_handle());
+
+	vkDestroyImageView(device.get_handle(), image_view, nullptr);
+	vkDestroyImage(device.get_handle(), image, nullptr);
+
+	vkFreeMemory(device.get_handle(), page_memory, nullptr);
+
+	if (mip_tail_memory != VK_NULL_HANDLE)
+	{
+		vkFreeMemory(device.get_handle(), mip_tail_memory, nullptr);
+	}
+}
+
+bool VirtualTexture::is_supported(Device &device, VkFormat format)
+{
+	auto &features = device.get_gpu().get_features();
+	if (!features.sparseBinding || !features.sparseResidencyImage2D)
+	{
+		return false;
+	}
+
+	uint32_t property_count = 0;
+	vkGetPhysicalDeviceSparseImageFormatProperties(device.get_gpu().get_handle(), format, VK_IMAGE_TYPE_2D, VK_SAMPLE_COUNT_1_BIT,
+	                                               image_usage, VK_IMAGE_TILING_OPTIMAL, &property_count, nullptr);
+
+	return property_count > 0;
+}
+
+VirtualTexture::PageSource VirtualTexture::create_page_source(const sg::Image &image)
+{
+	assert(!image.get_data().empty() && "The image data is needed to fill the pages");
+
+	return [&image](uint32_t level, const VkOffset2D &offset, const VkExtent2D &extent, uint8_t *texels) {
+		auto &mipmap = image.get_mipmaps().at(level);
+
+		const uint8_t *mipmap_data = image.get_data().data() + mipmap.offset;
+		const size_t   row_size    = extent.width * TexelSize;
+
+		for (uint32_t row = 0; row < extent.height; ++row)
+		{
+			size_t source_offset = ((offset.y + row) * static_cast<size_t>(mipmap.extent.width) + offset.x) * TexelSize;
+			std::memcpy(texels + row * row_size, mipmap_data + source_offset, row_size);
+		}
+	};
+}
+
+void VirtualTexture::update(uint32_t frame_index)
+{
+	++update_count;
+
+	// The frame is complete, the host reads its feedback then clears it for the next use
+	auto *feedback = reinterpret_cast<uint32_t *>(feedback_buffers[frame_index]->map());
+	for (uint32_t i = 0; i < to_u32(pages.size()); ++i)
+	{
+		if (feedback[i])
+		{
+			request_page(i);
+		}
+	}
+	std::memset(feedback, 0, pages.size() * sizeof(uint32_t));
+
+	std::vector<uint32_t> requested_pages;
+	for (uint32_t i = 0; i < to_u32(pages.size()); ++i)
+	{
+		auto &page = pages[i];
+
+		// Drops the requests which couldn't be served while the page was in view
+		if (page.pending && page.last_used + EvictionDelay <= update_count)
+		{
+			page.pending = false;
+		}
+
+		if (page.pending)
+		{
+			requested_pages.push_back(i);
+		}
+	}
+
+	if (requested_pages.empty())
+	{
+		return;
+	}
+
+	// The coarser pages first, they must be resident before the finer ones covering them
+	std::stable_sort(requested_pages.begin(), requested_pages.end(), [this](uint32_t a, uint32_t b) { return pages[a].level > pages[b].level; });
+
+	auto &slot = upload_slots[current_slot];
+	wait(slot);
+	slot.command_pool->reset_pool();
+
+	std::vector<uint32_t> evicted_pages;
+	std::vector<uint32_t> new_pages;
+
+	for (auto page_index : requested_pages)
+	{
+		if (new_pages.size() == MaxPagesPerUpdate)
+		{
+			break;
+		}
+
+		auto &page = pages[page_index];
+
+		// Waits for a later update if its parent couldn't be made resident in this one
+		if (page.level + 1 < sparse_level_count)
+		{
+			auto &parent = pages[get_page_index(page.level + 1, page.x / 2, page.y / 2)];
+			if (!parent.resident)
+			{
+				continue;
+			}
+		}
+
+		uint32_t memory_slot = 0;
+		if (!acquire_slot(evicted_pages, memory_slot))
+		{
+			break;
+		}
+
+		page.slot     = memory_slot;
+		page.resident = true;
+		page.pending  = false;
+
+		lru.push_front(page_index);
+		page.lru_position = lru.begin();
+
+		new_pages.push_back(page_index);
+	}
+
+	if (new_pages.empty())
+	{
+		return;
+	}
+
+	uint8_t *staging_data = slot.staging_buffer->map();
+
+	const VkDeviceSize page_table_size       = page_table_buffer->get_size();
+	const VkDeviceSize evicted_table_offset  = MaxPagesPerUpdate * page_size;
+	const VkDeviceSize resident_table_offset = evicted_table_offset + page_table_size;
+
+	// The page table before the new pages are resident
+	for (auto page_index : new_pages)
+	{
+		pages[page_index].resident = false;
+	}
+	build_page_table(reinterpret_cast<uint32_t *>(staging_data + evicted_table_offset));
+	for (auto page_index : new_pages)
+	{
+		pages[page_index].resident = true;
+	}
+	build_page_table(reinterpret_cast<uint32_t *>(staging_data + resident_table_offset));
+
+	std::vector<VkBufferImageCopy> copy_regions;
+	copy_regions.reserve(new_pages.size());
+
+	for (size_t i = 0; i < new_pages.size(); ++i)
+	{
+		auto &page        = pages[new_pages[i]];
+		auto  page_bind   = get_page_bind(page);
+		auto  page_extent = get_page_extent(page);
+
+		page_source(page.level, {page_bind.offset.x, page_bind.offset.y}, page_extent, staging_data + i * page_size);
+
+		VkBufferImageCopy copy_region{};
+		copy_region.bufferOffset     = i * page_size;
+		copy_region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, page.level, 0, 1};
+		copy_region.imageOffset      = page_bind.offset;
+		copy_region.imageExtent      = page_bind.extent;
+		copy_regions.push_back(copy_region);
+	}
+
+	slot.staging_buffer->flush();
+
+	// The coarser page table is used by the frames submitted from now on, the evicted pages
+	// are unbound once the frames submitted before are complete
+	auto &eviction_command_buffer = slot.command_pool->request_command_buffer();
+	eviction_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	VkBufferMemoryBarrier page_table_barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+	page_table_barrier.srcAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+	page_table_barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+	page_table_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	page_table_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	page_table_barrier.buffer              = page_table_buffer->get_handle();
+	page_table_barrier.size                = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(eviction_command_buffer.get_handle(), VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &page_table_barrier, 0, nullptr);
+
+	VkBufferCopy page_table_copy{evicted_table_offset, 0, page_table_size};
+	vkCmdCopyBuffer(eviction_command_buffer.get_handle(), slot.staging_buffer->get_handle(), page_table_buffer->get_handle(), 1, &page_table_copy);
+
+	page_table_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	page_table_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(eviction_command_buffer.get_handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 1, &page_table_barrier, 0, nullptr);
+
+	eviction_command_buffer.end();
+
+	VkCommandBuffer eviction_handle = eviction_command_buffer.get_handle();
+
+	VkSubmitInfo eviction_submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	eviction_submit_info.commandBufferCount   = 1;
+	eviction_submit_info.pCommandBuffers      = &eviction_handle;
+	eviction_submit_info.signalSemaphoreCount = 1;
+	eviction_submit_info.pSignalSemaphores    = &slot.evicted_semaphore;
+
+	VK_CHECK(graphics_queue.submit({eviction_submit_info}, VK_NULL_HANDLE));
+
+	// Unbinds the evicted pages and binds the new ones
+	std::vector<VkSparseImageMemoryBind> binds;
+	binds.reserve(evicted_pages.size() + new_pages.size());
+
+	for (auto page_index : evicted_pages)
+	{
+		auto bind   = get_page_bind(pages[page_index]);
+		bind.memory = VK_NULL_HANDLE;
+		binds.push_back(bind);
+	}
+
+	for (auto page_index : new_pages)
+	{
+		auto &page        = pages[page_index];
+		auto  bind        = get_page_bind(page);
+		bind.memory       = page_memory;
+		bind.memoryOffset = page.slot * page_size;
+		binds.push_back(bind);
+	}
+
+	VkSparseImageMemoryBindInfo image_bind_info{};
+	image_bind_info.image     = image;
+	image_bind_info.bindCount = to_u32(binds.size());
+	image_bind_info.pBinds    = binds.data();
+
+	VkBindSparseInfo bind_sparse_info = initializers::bind_sparse_info();
+	bind_sparse_info.waitSemaphoreCount   = 1;
+	bind_sparse_info.pWaitSemaphores      = &slot.evicted_semaphore;
+	bind_sparse_info.imageBindCount       = 1;
+	bind_sparse_info.pImageBinds          = &image_bind_info;
+	bind_sparse_info.signalSemaphoreCount = 1;
+	bind_sparse_info.pSignalSemaphores    = &slot.bound_semaphore;
+
+	VK_CHECK(vkQueueBindSparse(sparse_queue.get_handle(), 1, &bind_sparse_info, VK_NULL_HANDLE));
+
+	// Uploads the new pages once bound, then publishes them in the page table
+	auto &upload_command_buffer = slot.command_pool->request_command_buffer();
+	upload_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	uint32_t first_level = std::numeric_limits<uint32_t>::max();
+	uint32_t last_level  = 0;
+	for (auto page_index : new_pages)
+	{
+		first_level = std::min(first_level, pages[page_index].level);
+		last_level  = std::max(last_level, pages[page_index].level);
+	}
+
+	VkImageMemoryBarrier image_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+	image_barrier.srcAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+	image_barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier.oldLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	image_barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.image               = image;
+	image_barrier.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, first_level, last_level - first_level + 1, 0, 1};
+
+	vkCmdPipelineBarrier(upload_command_buffer.get_handle(), VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+	vkCmdCopyBufferToImage(upload_command_buffer.get_handle(), slot.staging_buffer->get_handle(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	                       to_u32(copy_regions.size()), copy_regions.data());
+
+	image_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	image_barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	page_table_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	page_table_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(upload_command_buffer.get_handle(), VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+	                     0, 0, nullptr, 1, &page_table_barrier, 1, &image_barrier);
+
+	page_table_copy.srcOffset = resident_table_offset;
+	vkCmdCopyBuffer(upload_command_buffer.get_handle(), slot.staging_buffer->get_handle(), page_table_buffer->get_handle(), 1, &page_table_copy);
+
+	page_table_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	page_table_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(upload_command_buffer.get_handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 1, &page_table_barrier, 0, nullptr);
+
+	upload_command_buffer.end();
+
+	VkCommandBuffer      upload_handle = upload_command_buffer.get_handle();
+	VkPipelineStageFlags wait_stage    = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	VkSubmitInfo upload_submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	upload_submit_info.waitSemaphoreCount = 1;
+	upload_submit_info.pWaitSemaphores    = &slot.bound_semaphore;
+	upload_submit_info.pWaitDstStageMask  = &wait_stage;
+	upload_submit_info.commandBufferCount = 1;
+	upload_submit_info.pCommandBuffers    = &upload_handle;
+
+	VK_CHECK(graphics_queue.submit({upload_submit_info}, slot.fence));
+
+	slot.in_flight = true;
+	current_slot   = (current_slot + 1) % UploadSlotCount;
+}
+
+void VirtualTexture::record_feedback_barrier(CommandBuffer &command_buffer, uint32_t frame_index) const
+{
+	VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+	barrier.srcAccessMask       = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer              = feedback_buffers[frame_index]->get_handle();
+	barrier.size                = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+VkImage VirtualTexture::get_image() const
+{
+	return image;
+}
+
+VkImageView VirtualTexture::get_image_view() const
+{
+	return image_view;
+}
+
+const core::BufferC &VirtualTexture::get_feedback_buffer(uint32_t frame_index) const
+{
+	return *feedback_buffers[frame_index];
+}
+
+const core::BufferC &VirtualTexture::get_page_table_buffer() const
+{
+	return *page_table_buffer;
+}
+
+const std::vector<VirtualTexture::LevelInfo> &VirtualTexture::get_levels() const
+{
+	return levels;
+}
+
+uint32_t VirtualTexture::get_resident_page_count() const
+{
+	return to_u32(lru.size());
+}
+
+void VirtualTexture::create_image()
+{
+	VkImageCreateInfo image_info = initializers::image_create_info();
+	image_info.flags             = VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
+	image_info.imageType         = VK_IMAGE_TYPE_2D;
+	image_info.format            = format;
+	image_info.extent            = {extent.width, extent.height, 1};
+	image_info.mipLevels         = mip_levels;
+	image_info.arrayLayers       = 1;
+	image_info.samples           = VK_SAMPLE_COUNT_1_BIT;
+	image_info.tiling            = VK_IMAGE_TILING_OPTIMAL;
+	image_info.usage             = image_usage;
+	image_info.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+	image_info.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	VK_CHECK(vkCreateImage(device.get_handle(), &image_info, nullptr, &image));
+
+	uint32_t requirement_count = 0;
+	vkGetImageSparseMemoryRequirements(device.get_handle(), image, &requirement_count, nullptr);
+	std::vector<VkSparseImageMemoryRequirements> requirements(requirement_count);
+	vkGetImageSparseMemoryRequirements(device.get_handle(), image, &requirement_count, requirements.data());
+
+	auto color_requirements = std::find_if(requirements.begin(), requirements.end(), [](const VkSparseImageMemoryRequirements &requirement) {
+		return requirement.formatProperties.aspectMask & VK_IMAGE_ASPECT_COLOR_BIT;
+	});
+	if (color_requirements == requirements.end())
+	{
+		throw std::runtime_error{"Sparse residency is not supported for the virtual texture format"};
+	}
+
+	sparse_requirements = *color_requirements;
+	sparse_properties   = sparse_requirements.formatProperties;
+
+	VkMemoryRequirements memory_requirements;
+	vkGetImageMemoryRequirements(device.get_handle(), image, &memory_requirements);
+	page_size = memory_requirements.alignment;
+
+	assert(sparse_properties.imageGranularity.width * sparse_properties.imageGranularity.height * TexelSize <= page_size &&
+	       "A page doesn't fit in a sparse block");
+
+	// The levels before the mip tail are made of pages
+	sparse_level_count = std::min(mip_levels, sparse_requirements.imageMipTailFirstLod);
+
+	uint32_t page_count = 0;
+	for (uint32_t level = 0; level < sparse_level_count; ++level)
+	{
+		LevelInfo level_info{};
+		level_info.first_page = page_count;
+		level_info.columns    = (get_level_size(extent.width, level) + sparse_properties.imageGranularity.width - 1) / sparse_properties.imageGranularity.width;
+		level_info.rows       = (get_level_size(extent.height, level) + sparse_properties.imageGranularity.height - 1) / sparse_properties.imageGranularity.height;
+
+		levels.push_back(level_info);
+		page_count += level_info.columns * level_info.rows;
+	}
+
+	if (levels.empty())
+	{
+		throw std::runtime_error{"The virtual texture fits in its mip tail"};
+	}
+
+	pages.reserve(page_count);
+	for (uint32_t level = 0; level < sparse_level_count; ++level)
+	{
+		for (uint32_t y = 0; y < levels[level].rows; ++y)
+		{
+			for (uint32_t x = 0; x < levels[level].columns; ++x)
+			{
+				Page page{};
+				page.level = level;
+				page.x     = x;
+				page.y     = y;
+				pages.push_back(page);
+			}
+		}
+	}
+
+	VkImageViewCreateInfo view_info = initializers::image_view_create_info();
+	view_info.image                 = image;
+	view_info.viewType              = VK_IMAGE_VIEW_TYPE_2D;
+	view_info.format                = format;
+	view_info.subresourceRange      = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mip_levels, 0, 1};
+
+	VK_CHECK(vkCreateImageView(device.get_handle(), &view_info, nullptr, &image_view));
+}
+
+void VirtualTexture::bind_mip_tail()
+{
+	uint32_t requirement_count = 0;
+	vkGetImageSparseMemoryRequirements(device.get_handle(), image, &requirement_count, nullptr);
+	std::vector<VkSparseImageMemoryRequirements> requirements(requirement_count);
+	vkGetImageSparseMemoryRequirements(device.get_handle(), image, &requirement_count, requirements.data());
+
+	VkMemoryRequirements memory_requirements;
+	vkGetImageMemoryRequirements(device.get_handle(), image, &memory_requirements);
+
+	// The mip tails of the color and of the metadata, if any, share an allocation
+	std::vector<VkSparseMemoryBind> binds;
+	VkDeviceSize                    memory_size = 0;
+
+	for (auto &requirement : requirements)
+	{
+		bool metadata = requirement.formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT;
+
+		if (requirement.imageMipTailFirstLod >= mip_levels && !metadata)
+		{
+			continue;
+		}
+
+		VkSparseMemoryBind bind{};
+		bind.resourceOffset = requirement.imageMipTailOffset;
+		bind.size           = requirement.imageMipTailSize;
+		bind.memoryOffset   = memory_size;
+		bind.flags          = metadata ? VK_SPARSE_MEMORY_BIND_METADATA_BIT : 0;
+		binds.push_back(bind);
+
+		memory_size += (requirement.imageMipTailSize + memory_requirements.alignment - 1) / memory_requirements.alignment * memory_requirements.alignment;
+	}
+
+	if (binds.empty())
+	{
+		return;
+	}
+
+	VkMemoryAllocateInfo memory_info{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+	memory_info.allocationSize  = memory_size;
+	memory_info.memoryTypeIndex = device.get_memory_type(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	VK_CHECK(vkAllocateMemory(device.get_handle(), &memory_info, nullptr, &mip_tail_memory));
+
+	for (auto &bind : binds)
+	{
+		bind.memory = mip_tail_memory;
+	}
+
+	VkSparseImageOpaqueMemoryBindInfo opaque_bind_info{};
+	opaque_bind_info.image     = image;
+	opaque_bind_info.bindCount = to_u32(binds.size());
+	opaque_bind_info.pBinds    = binds.data();
+
+	VkBindSparseInfo bind_sparse_info     = initializers::bind_sparse_info();
+	bind_sparse_info.imageOpaqueBindCount = 1;
+	bind_sparse_info.pImageOpaqueBinds    = &opaque_bind_info;
+
+	VK_CHECK(vkQueueBindSparse(sparse_queue.get_handle(), 1, &bind_sparse_info, VK_NULL_HANDLE));
+	VK_CHECK(vkQueueWaitIdle(sparse_queue.get_handle()));
+}
+
+void VirtualTexture::upload_initial_levels()
+{
+	// Without a mip tail, the coarsest level is always resident so every page has a fallback
+	std::vector<uint32_t> fixed_pages;
+	if (sparse_level_count == mip_levels)
+	{
+		auto &coarsest_level = levels.back();
+		for (uint32_t i = 0; i < coarsest_level.columns * coarsest_level.rows; ++i)
+		{
+			fixed_pages.push_back(coarsest_level.first_page + i);
+		}
+
+		if (fixed_pages.size() > free_slots.size())
+		{
+			throw std::runtime_error{"The memory budget of the virtual texture is too small for its coarsest level"};
+		}
+	}
+
+	std::vector<VkSparseImageMemoryBind> binds;
+	for (auto page_index : fixed_pages)
+	{
+		auto &page = pages[page_index];
+		page.slot     = free_slots.back();
+		page.resident = true;
+		page.fixed    = true;
+		free_slots.pop_back();
+
+		auto bind         = get_page_bind(page);
+		bind.memory       = page_memory;
+		bind.memoryOffset = page.slot * page_size;
+		binds.push_back(bind);
+	}
+
+	if (!binds.empty())
+	{
+		VkSparseImageMemoryBindInfo image_bind_info{};
+		image_bind_info.image     = image;
+		image_bind_info.bindCount = to_u32(binds.size());
+		image_bind_info.pBinds    = binds.data();
+
+		VkBindSparseInfo bind_sparse_info = initializers::bind_sparse_info();
+		bind_sparse_info.imageBindCount   = 1;
+		bind_sparse_info.pImageBinds      = &image_bind_info;
+
+		VK_CHECK(vkQueueBindSparse(sparse_queue.get_handle(), 1, &bind_sparse_info, VK_NULL_HANDLE));
+		VK_CHECK(vkQueueWaitIdle(sparse_queue.get_handle()));
+	}
+
+	// The mip tail levels, the fixed pages, then the page table
+	VkDeviceSize staging_size = 0;
+	for (uint32_t level = sparse_level_count; level < mip_levels; ++level)
+	{
+		staging_size += VkDeviceSize{get_level_size(extent.width, level)} * get_level_size(extent.height, level) * TexelSize;
+	}
+	staging_size += fixed_pages.size() * page_size;
+
+	const VkDeviceSize page_table_offset = staging_size;
+	staging_size += page_table_buffer->get_size();
+
+	auto     staging_buffer = core::BufferC::create_staging_buffer(device, staging_size, nullptr);
+	uint8_t *staging_data   = staging_buffer.map();
+
+	std::vector<VkBufferImageCopy> copy_regions;
+	VkDeviceSize                   offset = 0;
+
+	for (uint32_t level = sparse_level_count; level < mip_levels; ++level)
+	{
+		VkExtent2D level_extent{get_level_size(extent.width, level), get_level_size(extent.height, level)};
+		page_source(level, {0, 0}, level_extent, staging_data + offset);
+
+		VkBufferImageCopy copy_region{};
+		copy_region.bufferOffset     = offset;
+		copy_region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+		copy_region.imageExtent      = {level_extent.width, level_extent.height, 1};
+		copy_regions.push_back(copy_region);
+
+		offset += VkDeviceSize{level_extent.width} * level_extent.height * TexelSize;
+	}
+
+	for (auto page_index : fixed_pages)
+	{
+		auto &page      = pages[page_index];
+		auto  page_bind = get_page_bind(page);
+
+		page_source(page.level, {page_bind.offset.x, page_bind.offset.y}, get_page_extent(page), staging_data + offset);
+
+		VkBufferImageCopy copy_region{};
+		copy_region.bufferOffset     = offset;
+		copy_region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, page.level, 0, 1};
+		copy_region.imageOffset      = page_bind.offset;
+		copy_region.imageExtent      = page_bind.extent;
+		copy_regions.push_back(copy_region);
+
+		offset += page_size;
+	}
+
+	build_page_table(reinterpret_cast<uint32_t *>(staging_data + page_table_offset));
+	staging_buffer.flush();
+
+	auto &command_buffer = device.request_command_buffer();
+	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	VkImageMemoryBarrier image_barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+	image_barrier.srcAccessMask       = 0;
+	image_barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+	image_barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	image_barrier.image               = image;
+	image_barrier.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mip_levels, 0, 1};
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+	if (!copy_regions.empty())
+	{
+		vkCmdCopyBufferToImage(command_buffer.get_handle(), staging_buffer.get_handle(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		                       to_u32(copy_regions.size()), copy_regions.data());
+	}
+
+	VkBufferCopy page_table_copy{page_table_offset, 0, page_table_buffer->get_size()};
+	vkCmdCopyBuffer(command_buffer.get_handle(), staging_buffer.get_handle(), page_table_buffer->get_handle(), 1, &page_table_copy);
+
+	image_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	image_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	image_barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	image_barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkBufferMemoryBarrier page_table_barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+	page_table_barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+	page_table_barrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+	page_table_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	page_table_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	page_table_barrier.buffer              = page_table_buffer->get_handle();
+	page_table_barrier.size                = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 1, &page_table_barrier, 1, &image_barrier);
+
+	command_buffer.end();
+
+	auto &queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0);
+	VK_CHECK(queue.submit(command_buffer, VK_NULL_HANDLE));
+	VK_CHECK(vkQueueWaitIdle(queue.get_handle()));
+}
+
+uint32_t VirtualTexture::get_page_index(uint32_t level, uint32_t x, uint32_t y) const
+{
+	auto &level_info = levels[level];
+	return level_info.first_page + std::min(y, level_info.rows - 1) * level_info.columns + std::min(x, level_info.columns - 1);
+}
+
+void VirtualTexture::request_page(uint32_t page_index)
+{
+	auto level = pages[page_index].level;
+	auto x     = pages[page_index].x;
+	auto y     = pages[page_index].y;
+
+	// Touching the coarser pages too keeps them more recently used than the finer ones
+	for (; level < sparse_level_count; ++level, x /= 2, y /= 2)
+	{
+		auto &page = pages[get_page_index(level, x, y)];
+
+		if (page.last_used == update_count)
+		{
+			break;
+		}
+		page.last_used = update_count;
+
+		if (page.fixed)
+		{
+			continue;
+		}
+
+		if (page.resident)
+		{
+			lru.splice(lru.begin(), lru, page.lru_position);
+		}
+		else
+		{
+			page.pending = true;
+		}
+	}
+}
+
+bool VirtualTexture::has_resident_children(const Page &page) const
+{
+	if (page.level == 0)
+	{
+		return false;
+	}
+
+	auto &child_level = levels[page.level - 1];
+	for (uint32_t y = page.y * 2; y < std::min(page.y * 2 + 2, child_level.rows); ++y)
+	{
+		for (uint32_t x = page.x * 2; x < std::min(page.x * 2 + 2, child_level.columns); ++x)
+		{
+			if (pages[child_level.first_page + y * child_level.columns + x].resident)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool VirtualTexture::acquire_slot(std::vector<uint32_t> &evicted_pages, uint32_t &slot)
+{
+	if (!free_slots.empty())
+	{
+		slot = free_slots.back();
+		free_slots.pop_back();
+		return true;
+	}
+
+	for (auto it = lru.rbegin(); it != lru.rend(); ++it)
+	{
+		auto &page = pages[*it];
+
+		// The remaining pages were used more recently
+		if (page.last_used + EvictionDelay > update_count)
+		{
+			return false;
+		}
+
+		if (has_resident_children(page))
+		{
+			continue;
+		}
+
+		slot          = page.slot;
+		page.resident = false;
+
+		evicted_pages.push_back(*it);
+		lru.erase(std::next(it).base());
+
+		return true;
+	}
+
+	return false;
+}
+
+void VirtualTexture::build_page_table(uint32_t *page_table) const
+{
+	auto &first_level = levels[0];
+
+	for (uint32_t y = 0; y < first_level.rows; ++y)
+	{
+		for (uint32_t x = 0; x < first_level.columns; ++x)
+		{
+			// The mip tail when none of the pages over this one is resident
+			uint32_t resident_level = sparse_level_count;
+
+			for (uint32_t level = 0; level < sparse_level_count; ++level)
+			{
+				if (pages[get_page_index(level, x >> level, y >> level)].resident)
+				{
+					resident_level = level;
+					break;
+				}
+			}
+
+			page_table[y * first_level.columns + x] = resident_level;
+		}
+	}
+}
+
+VkSparseImageMemoryBind VirtualTexture::get_page_bind(const Page &page) const
+{
+	auto &granularity = sparse_properties.imageGranularity;
+
+	VkSparseImageMemoryBind bind{};
+	bind.subresource = {VK_IMAGE_ASPECT_COLOR_BIT, page.level, 0};
+	bind.offset      = {static_cast<int32_t>(page.x * granularity.width), static_cast<int32_t>(page.y * granularity.height), 0};
+
+	auto page_extent = get_page_extent(page);
+	bind.extent      = {page_extent.width, page_extent.height, 1};
+
+	return bind;
+}
+
+VkExtent2D VirtualTexture::get_page_extent(const Page &page) const
+{
+	auto &granularity = sparse_properties.imageGranularity;
+
+	// The last pages of a row or column may be cut by the edge of the level
+	return {std::min(granularity.width, get_level_size(extent.width, page.level) - page.x * granularity.width),
+	        std::min(granularity.height, get_level_size(extent.height, page.level) - page.y * granularity.height)};
+}
+
+void VirtualTexture::wait(UploadSlot &slot)
+{
+	if (!slot.in_flight)
+	{
+		return;
+	}
+
+	VK_CHECK(vkWaitForFences(device.get_handle(), 1, &slot.fence, VK_TRUE, std::numeric_limits<uint64_t>::max()));
+	VK_CHECK(vkResetFences(device.get_handle(), 1, &slot.fence));
+
+	slot.in_flight = false;
+}
+}        // namespace vkb
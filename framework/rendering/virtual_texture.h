@@ -0,0 +1,281 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "common/helpers.h"
+#include "common/vk_common.h"
+#include "core/buffer.h"
+
+namespace vkb
+{
+class CommandBuffer;
+class CommandPool;
+class Device;
+class Queue;
+
+namespace sg
+{
+class Image;
+}        // namespace sg
+
+/**
+ * @brief Texture larger than the device memory, streamed in pages through sparse residency
+ *
+ * The levels above the mip tail are split into pages of the sparse block size. Only the pages
+ * the shaders asked for are resident, in a pool of a fixed memory budget recycled in least
+ * recently used order. The mip tail stays resident.
+ *
+ * Shaders report the pages they need in a feedback buffer, with one element per page set to
+ * a non-zero value, at LevelInfo::first_page + y * LevelInfo::columns + x for the page (x, y)
+ * of the level sampled. They clamp the level they sample to the page table, which holds for
+ * every page of level 0 the finest level resident over it. A page is only made resident after
+ * the coarser pages covering it, so every level from the page table value up is resident.
+ *
+ * Each update reads the feedback of a frame back, then binds and uploads the requested pages
+ * with vkQueueBindSparse on the sparse binding queue and copies on the graphics queue, without
+ * waiting for the GPU. Evicted pages are only unbound once the frames submitted before their
+ * eviction are complete.
+ *
+ * The image is 2D with a single layer and a format of 4 bytes per texel.
+ */
+class VirtualTexture
+{
+  public:
+	/// Updates without a request for a page before it can be evicted, covering the frames in flight whose feedback isn't read yet
+	static constexpr uint64_t EvictionDelay = 4;
+
+	/// Pages made resident per update, bounding the upload work of a frame
+	static constexpr uint32_t MaxPagesPerUpdate = 64;
+
+	/// Upload batches in flight
+	static constexpr uint32_t UploadSlotCount = 3;
+
+	/// Size of a texel, in bytes
+	static constexpr uint32_t TexelSize = 4;
+
+	/**
+	 * @brief Location of the pages of a level in the feedback buffer
+	 */
+	struct LevelInfo
+	{
+		uint32_t first_page;
+
+		uint32_t columns;
+
+		uint32_t rows;
+	};
+
+	/**
+	 * @brief Fills the texels of a region of a level, in rows of extent.width tightly packed texels
+	 */
+	using PageSource = std::function<void(uint32_t level, const VkOffset2D &offset, const VkExtent2D &extent, uint8_t *texels)>;
+
+	/**
+	 * @param device The device the texture is created on, with the sparseBinding and sparseResidencyImage2D features enabled
+	 * @param format The format of the texture, of TexelSize bytes per texel
+	 * @param extent The size of level 0
+	 * @param mip_levels The number of levels
+	 * @param memory_budget The device memory used by the pages outside of the mip tail
+	 * @param frame_count The number of frames in flight, each frame has its own feedback buffer
+	 * @param page_source Provides the texels of the pages when they are made resident
+	 */
+	VirtualTexture(Device &device, VkFormat format, const VkExtent2D &extent, uint32_t mip_levels, VkDeviceSize memory_budget, uint32_t frame_count, PageSource page_source);
+
+	VirtualTexture(const VirtualTexture &) = delete;
+
+	VirtualTexture(VirtualTexture &&) = delete;
+
+	~VirtualTexture();
+
+	VirtualTexture &operator=(const VirtualTexture &) = delete;
+
+	VirtualTexture &operator=(VirtualTexture &&) = delete;
+
+	/**
+	 * @return Whether the device can create virtual textures of a format
+	 */
+	static bool is_supported(Device &device, VkFormat format);
+
+	/**
+	 * @brief Creates a page source reading the levels of an image in host memory, like an image loaded by the GLTFLoader
+	 *        The image must outlive the page source, and have an uncompressed format of TexelSize bytes per texel.
+	 */
+	static PageSource create_page_source(const sg::Image &image);
+
+	/**
+	 * @brief Reads back the feedback of a frame, then schedules the binding and the upload of the requested pages
+	 *        Called once the frame is complete, before recording it again, which also clears its feedback.
+	 */
+	void update(uint32_t frame_index);
+
+	/**
+	 * @brief Records the barrier making the feedback written by a frame visible to the host, at the end of the frame
+	 */
+	void record_feedback_barrier(CommandBuffer &command_buffer, uint32_t frame_index) const;
+
+	VkImage get_image() const;
+
+	VkImageView get_image_view() const;
+
+	/**
+	 * @return The feedback buffer written by a frame, of one uint32_t per page
+	 */
+	const core::BufferC &get_feedback_buffer(uint32_t frame_index) const;
+
+	/**
+	 * @return The page table, one uint32_t per page of level 0
+	 */
+	const core::BufferC &get_page_table_buffer() const;
+
+	/**
+	 * @return The pages of the levels above the mip tail
+	 */
+	const std::vector<LevelInfo> &get_levels() const;
+
+	/**
+	 * @return Number of resident pages, the mip tail excluded
+	 */
+	uint32_t get_resident_page_count() const;
+
+  private:
+	struct Page
+	{
+		uint32_t level;
+
+		uint32_t x;
+
+		uint32_t y;
+
+		/// Memory slot of a resident page
+		uint32_t slot{0};
+
+		/// Last update requesting the page
+		uint64_t last_used{0};
+
+		bool resident{false};
+
+		bool pending{false};
+
+		/// Pages of the coarsest level, when there is no mip tail
+		bool fixed{false};
+
+		std::list<uint32_t>::iterator lru_position;
+	};
+
+	struct UploadSlot
+	{
+		std::unique_ptr<core::BufferC> staging_buffer;
+
+		std::unique_ptr<CommandPool> command_pool;
+
+		VkFence fence{VK_NULL_HANDLE};
+
+		VkSemaphore evicted_semaphore{VK_NULL_HANDLE};
+
+		VkSemaphore bound_semaphore{VK_NULL_HANDLE};
+
+		bool in_flight{false};
+	};
+
+	void create_image();
+
+	void bind_mip_tail();
+
+	void upload_initial_levels();
+
+	uint32_t get_page_index(uint32_t level, uint32_t x, uint32_t y) const;
+
+	/**
+	 * @brief Marks a page and the coarser pages covering it as used
+	 */
+	void request_page(uint32_t page_index);
+
+	bool has_resident_children(const Page &page) const;
+
+	/**
+	 * @brief Returns a free memory slot, evicting the least recently used page if none is left
+	 * @return False if every resident page is still in use
+	 */
+	bool acquire_slot(std::vector<uint32_t> &evicted_pages, uint32_t &slot);
+
+	void build_page_table(uint32_t *page_table) const;
+
+	VkSparseImageMemoryBind get_page_bind(const Page &page) const;
+
+	VkExtent2D get_page_extent(const Page &page) const;
+
+	void wait(UploadSlot &slot);
+
+	Device &device;
+
+	VkFormat format;
+
+	VkExtent2D extent;
+
+	uint32_t mip_levels;
+
+	PageSource page_source;
+
+	const Queue &graphics_queue;
+
+	const Queue &sparse_queue;
+
+	VkImage image{VK_NULL_HANDLE};
+
+	VkImageView image_view{VK_NULL_HANDLE};
+
+	VkSparseImageFormatProperties sparse_properties{};
+
+	VkSparseImageMemoryRequirements sparse_requirements{};
+
+	/// Size of a page in bytes, the sparse block size
+	VkDeviceSize page_size{0};
+
+	/// Levels made of pages, the following ones are in the mip tail
+	uint32_t sparse_level_count{0};
+
+	std::vector<LevelInfo> levels;
+
+	std::vector<Page> pages;
+
+	/// Resident pages, the most recently used first
+	std::list<uint32_t> lru;
+
+	std::vector<uint32_t> free_slots;
+
+	VkDeviceMemory page_memory{VK_NULL_HANDLE};
+
+	VkDeviceMemory mip_tail_memory{VK_NULL_HANDLE};
+
+	std::vector<std::unique_ptr<core::BufferC>> feedback_buffers;
+
+	std::unique_ptr<core::BufferC> page_table_buffer;
+
+	std::array<UploadSlot, UploadSlotCount> upload_slots;
+
+	uint32_t current_slot{0};
+
+	uint64_t update_count{0};
+};
+}        // namespace vkb
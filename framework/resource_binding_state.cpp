@@ -21,57 +21,95 @@ namespace vkb
 {
 void ResourceBindingState::reset()
 {
-	clear_dirty();
+	for (uint32_t set = 0; set < MAX_SETS; ++set)
+	{
+		if (bound_sets & (1u << set))
+		{
+			resource_sets[set].reset();
+		}
+	}
 
-	resource_sets.clear();
+	dirty_sets = 0;
+	bound_sets = 0;
 }
 
 bool ResourceBindingState::is_dirty()
 {
-	return dirty;
+	return dirty_sets != 0;
 }
 
 void ResourceBindingState::clear_dirty()
 {
-	dirty = false;
+	for (uint32_t set = 0; set < MAX_SETS; ++set)
+	{
+		if (dirty_sets & (1u << set))
+		{
+			resource_sets[set].clear_dirty();
+		}
+	}
+
+	dirty_sets = 0;
 }
 
 void ResourceBindingState::clear_dirty(uint32_t set)
 {
+	assert(set < MAX_SETS && "Descriptor set index is out of bounds");
+
 	resource_sets[set].clear_dirty();
+
+	dirty_sets &= ~(1u << set);
 }
 
-void ResourceBindingState::bind_buffer(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t set, uint32_t binding, uint32_t array_element)
+void ResourceBindingState::mark_dirty(uint32_t sets)
 {
-	resource_sets[set].bind_buffer(buffer, offset, range, binding, array_element);
+	dirty_sets |= sets & bound_sets;
+}
 
-	dirty = true;
+uint32_t ResourceBindingState::get_dirty_sets() const
+{
+	return dirty_sets;
 }
 
-void ResourceBindingState::bind_image(const core::ImageView &image_view, const core::Sampler &sampler, uint32_t set, uint32_t binding, uint32_t array_element)
+uint32_t ResourceBindingState::get_bound_sets() const
 {
-	resource_sets[set].bind_image(image_view, sampler, binding, array_element);
+	return bound_sets;
+}
 
-	dirty = true;
+const ResourceSet &ResourceBindingState::get_resource_set(uint32_t set) const
+{
+	assert(set < MAX_SETS && "Descriptor set index is out of bounds");
+
+	return resource_sets[set];
 }
 
-void ResourceBindingState::bind_image(const core::ImageView &image_view, uint32_t set, uint32_t binding, uint32_t array_element)
+ResourceSet &ResourceBindingState::bind_set(uint32_t set)
 {
-	resource_sets[set].bind_image(image_view, binding, array_element);
+	assert(set < MAX_SETS && "Descriptor set index is out of bounds");
 
-	dirty = true;
+	dirty_sets |= 1u << set;
+	bound_sets |= 1u << set;
+
+	return resource_sets[set];
 }
 
-void ResourceBindingState::bind_input(const core::ImageView &image_view, uint32_t set, uint32_t binding, uint32_t array_element)
+void ResourceBindingState::bind_buffer(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t set, uint32_t binding, uint32_t array_element)
 {
-	resource_sets[set].bind_input(image_view, binding, array_element);
+	bind_set(set).bind_buffer(buffer, offset, range, binding, array_element);
+}
 
-	dirty = true;
+void ResourceBindingState::bind_image(const core::ImageView &image_view, const core::Sampler &sampler, uint32_t set, uint32_t binding, uint32_t array_element)
+{
+	bind_set(set).bind_image(image_view, sampler, binding, array_element);
 }
 
-const std::unordered_map<uint32_t, ResourceSet> &ResourceBindingState::get_resource_sets()
+void ResourceBindingState::bind_image(const core::ImageView &image_view, uint32_t set, uint32_t binding, uint32_t array_element)
+{
+	bind_set(set).bind_image(image_view, binding, array_element);
+}
+
+void ResourceBindingState::bind_input(const core::ImageView &image_view, uint32_t set, uint32_t binding, uint32_t array_element)
 {
-	return resource_sets;
+	bind_set(set).bind_input(image_view, binding, array_element);
 }
 
 void ResourceSet::reset()
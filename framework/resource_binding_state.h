@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "common/vk_common.h"
 #include "core/buffer.h"
 #include "core/image_view.h"
@@ -82,10 +84,15 @@ class ResourceSet
  *
  * Keeps track of all the resources bound by the command buffer. The ResourceBindingState is used by
  * the command buffer to create the appropriate descriptor sets when it comes to draw.
+ * Sets are stored in a fixed-size array, with one bit per set in the dirty and bound masks,
+ * so that checking the state at each draw doesn't allocate.
  */
 class ResourceBindingState
 {
   public:
+	/// Maximum number of descriptor sets that can be bound, one bit each in the masks
+	static constexpr uint32_t MAX_SETS = 16;
+
 	void reset();
 
 	bool is_dirty();
@@ -94,6 +101,24 @@ class ResourceBindingState
 
 	void clear_dirty(uint32_t set);
 
+	/**
+	 * @brief Flags bound sets to be flushed again, e.g. when the memory holding their descriptors was unbound
+	 * @param sets Mask of the sets, the ones without bound resources are ignored
+	 */
+	void mark_dirty(uint32_t sets);
+
+	/**
+	 * @return Mask of the sets with resources bound since the last clear_dirty
+	 */
+	uint32_t get_dirty_sets() const;
+
+	/**
+	 * @return Mask of the sets with any resource bound since the last reset
+	 */
+	uint32_t get_bound_sets() const;
+
+	const ResourceSet &get_resource_set(uint32_t set) const;
+
 	void bind_buffer(const vkb::core::BufferC &buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t set, uint32_t binding, uint32_t array_element);
 
 	void bind_image(const core::ImageView &image_view, const core::Sampler &sampler, uint32_t set, uint32_t binding, uint32_t array_element);
@@ -102,11 +127,13 @@ class ResourceBindingState
 
 	void bind_input(const core::ImageView &image_view, uint32_t set, uint32_t binding, uint32_t array_element);
 
-	const std::unordered_map<uint32_t, ResourceSet> &get_resource_sets();
-
   private:
-	bool dirty{false};
+	ResourceSet &bind_set(uint32_t set);
+
+	uint32_t dirty_sets{0};
+
+	uint32_t bound_sets{0};
 
-	std::unordered_map<uint32_t, ResourceSet> resource_sets;
+	std::array<ResourceSet, MAX_SETS> resource_sets;
 };
 }        // namespace vkb
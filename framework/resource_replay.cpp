@@ -17,10 +17,17 @@
 
 #include "resource_replay.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
 #include "common/vk_common.h"
+#include "core/util/job_system.hpp"
 #include "core/util/logging.hpp"
 #include "rendering/pipeline_state.h"
 #include "ResourceCache.h"
+#include "timer.h"
 
 namespace vkb
 {
@@ -38,6 +45,32 @@ inline void read_subpass_info(std::istringstream &is, std::vector<SubpassInfo> &
 	}
 }
 
+inline void read_shader_resources(std::istringstream &is, std::vector<ShaderResource> &value)
+{
+	std::size_t size;
+	read(is, size);
+	value.resize(size);
+	for (ShaderResource &item : value)
+	{
+		read(is,
+		     item.stages,
+		     item.type,
+		     item.mode,
+		     item.set,
+		     item.binding,
+		     item.location,
+		     item.input_attachment_index,
+		     item.vec_size,
+		     item.columns,
+		     item.array_size,
+		     item.offset,
+		     item.size,
+		     item.constant_id,
+		     item.qualifiers,
+		     item.name);
+	}
+}
+
 inline void read_processes(std::istringstream &is, std::vector<std::string> &value)
 {
 	std::size_t size;
@@ -48,20 +81,69 @@ inline void read_processes(std::istringstream &is, std::vector<std::string> &val
 		read(is, item);
 	}
 }
+
+/// Resources of a stage only depend on resources of earlier stages
+enum class ReplayStage
+{
+	ShaderModulesAndRenderPasses,
+	DescriptorSetLayouts,
+	PipelineLayouts,
+	Pipelines,
+	Count
+};
+
+const char *to_string(ReplayStage stage)
+{
+	switch (stage)
+	{
+		case ReplayStage::ShaderModulesAndRenderPasses:
+			return "shader modules and render passes";
+		case ReplayStage::DescriptorSetLayouts:
+			return "descriptor set layouts";
+		case ReplayStage::PipelineLayouts:
+			return "pipeline layouts";
+		case ReplayStage::Pipelines:
+			return "pipelines";
+		default:
+			return "unknown";
+	}
+}
+
+ReplayStage get_stage(ResourceType resource_type)
+{
+	switch (resource_type)
+	{
+		case ResourceType::ShaderModule:
+		case ResourceType::RenderPass:
+			return ReplayStage::ShaderModulesAndRenderPasses;
+		case ResourceType::DescriptorSetLayout:
+			return ReplayStage::DescriptorSetLayouts;
+		case ResourceType::PipelineLayout:
+			return ReplayStage::PipelineLayouts;
+		default:
+			return ReplayStage::Pipelines;
+	}
+}
 }        // namespace
 
 ResourceReplay::ResourceReplay()
 {
-	stream_resources[ResourceType::ShaderModule]     = std::bind(&ResourceReplay::create_shader_module, this, std::placeholders::_1, std::placeholders::_2);
-	stream_resources[ResourceType::PipelineLayout]   = std::bind(&ResourceReplay::create_pipeline_layout, this, std::placeholders::_1, std::placeholders::_2);
-	stream_resources[ResourceType::RenderPass]       = std::bind(&ResourceReplay::create_render_pass, this, std::placeholders::_1, std::placeholders::_2);
-	stream_resources[ResourceType::GraphicsPipeline] = std::bind(&ResourceReplay::create_graphics_pipeline, this, std::placeholders::_1, std::placeholders::_2);
+	stream_resources[ResourceType::ShaderModule]        = std::bind(&ResourceReplay::create_shader_module, this, std::placeholders::_1);
+	stream_resources[ResourceType::PipelineLayout]      = std::bind(&ResourceReplay::create_pipeline_layout, this, std::placeholders::_1);
+	stream_resources[ResourceType::RenderPass]          = std::bind(&ResourceReplay::create_render_pass, this, std::placeholders::_1);
+	stream_resources[ResourceType::GraphicsPipeline]    = std::bind(&ResourceReplay::create_graphics_pipeline, this, std::placeholders::_1);
+	stream_resources[ResourceType::DescriptorSetLayout] = std::bind(&ResourceReplay::create_descriptor_set_layout, this, std::placeholders::_1);
+	stream_resources[ResourceType::ComputePipeline]     = std::bind(&ResourceReplay::create_compute_pipeline, this, std::placeholders::_1);
+	stream_resources[ResourceType::DescriptorSetPeak]   = std::bind(&ResourceReplay::create_descriptor_set_peak, this, std::placeholders::_1);
 }
 
-void ResourceReplay::play(ResourceCache &resource_cache, ResourceRecord &recorder)
+void ResourceReplay::play(ResourceCache &resource_cache, ResourceRecord &recorder, size_t thread_count)
 {
 	std::istringstream stream{ recorder.GetStream().str() };
 
+	std::array<std::vector<ReplayJob>, static_cast<size_t>(ReplayStage::Count)> stages;
+
+	// Decode the whole stream first, which also assigns the index of every resource
 	while (true)
 	{
 		// Read command id
@@ -80,16 +162,93 @@ void ResourceReplay::play(ResourceCache &resource_cache, ResourceRecord &recorde
 		if (cmd_it != stream_resources.end())
 		{
 			// Run command function
-			cmd_it->second(resource_cache, stream);
+			stages[static_cast<size_t>(get_stage(resource_type))].push_back(cmd_it->second(stream));
 		}
 		else
 		{
 			LOGE("Replay command not supported.");
+			break;
 		}
 	}
+
+	auto &job_system = JobSystem::get();
+	thread_count     = std::clamp<size_t>(thread_count, 1, job_system.get_worker_count() + 1);
+
+	stage_timings.clear();
+
+	for (size_t stage_index = 0; stage_index < stages.size(); ++stage_index)
+	{
+		auto &jobs = stages[stage_index];
+
+		Timer timer;
+		timer.start();
+
+		if (thread_count > 1)
+		{
+			// Each thread takes the next resource of the stage, as their creation times vary a lot
+			std::atomic<size_t> next{0};
+			std::exception_ptr  error;
+			std::mutex          error_mutex;
+
+			auto replay = [&]() {
+				try
+				{
+					for (size_t i = next++; i < jobs.size(); i = next++)
+					{
+						jobs[i](resource_cache);
+					}
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> guard(error_mutex);
+					if (!error)
+					{
+						error = std::current_exception();
+					}
+					next = jobs.size();
+				}
+			};
+
+			JobCounter counter;
+			for (size_t i = 1; i < thread_count; ++i)
+			{
+				job_system.schedule(replay, &counter);
+			}
+			replay();
+
+			// Wait for the whole stage, as the next stage refers to its resources
+			job_system.wait(counter);
+
+			if (error)
+			{
+				std::rethrow_exception(error);
+			}
+		}
+		else
+		{
+			for (auto &job : jobs)
+			{
+				job(resource_cache);
+			}
+		}
+
+		ResourceReplayStage stage_timing;
+		stage_timing.name           = to_string(static_cast<ReplayStage>(stage_index));
+		stage_timing.resource_count = jobs.size();
+		stage_timing.duration_ms    = timer.stop<Timer::Milliseconds>();
+
+		LOGI("Replayed {} {} in {:.2f} ms ({} threads)", stage_timing.resource_count, stage_timing.name, stage_timing.duration_ms, thread_count);
+
+		stage_timings.push_back(std::move(stage_timing));
+	}
+}
+
+const std::vector<ResourceReplayStage> &ResourceReplay::get_stage_timings() const
+{
+	return stage_timings;
 }
 
-void ResourceReplay::create_shader_module(ResourceCache &resource_cache, std::istringstream &stream)
+ResourceReplay::ReplayJob ResourceReplay::create_shader_module(std::istringstream &stream)
 {
 	VkShaderStageFlagBits    stage{};
 	std::string              glsl_source;
@@ -109,33 +268,39 @@ void ResourceReplay::create_shader_module(ResourceCache &resource_cache, std::is
 	shader_source.set_source(std::move(glsl_source));
 	ShaderVariant shader_variant(std::move(preamble), std::move(processes));
 
-	auto &shader_module = resource_cache.RequestShaderModule(stage, shader_source, shader_variant);
+	size_t index = shader_modules.size();
+	shader_modules.push_back(nullptr);
 
-	shader_modules.push_back(&shader_module);
+	return [this, index, stage, shader_source, shader_variant](ResourceCache &resource_cache) {
+		shader_modules[index] = &resource_cache.RequestShaderModule(stage, shader_source, shader_variant);
+	};
 }
 
-void ResourceReplay::create_pipeline_layout(ResourceCache &resource_cache, std::istringstream &stream)
+ResourceReplay::ReplayJob ResourceReplay::create_pipeline_layout(std::istringstream &stream)
 {
 	std::vector<size_t> shader_indices;
 
 	read(stream,
 	     shader_indices);
 
-	std::vector<ShaderModule *> shader_stages(shader_indices.size());
-	std::transform(shader_indices.begin(),
-	               shader_indices.end(),
-	               shader_stages.begin(),
-	               [&](size_t shader_index) {
-		               assert(shader_index < shader_modules.size());
-		               return shader_modules[shader_index];
-	               });
-
-	auto &pipeline_layout = resource_cache.RequestPipelineLayout(shader_stages);
-
-	pipeline_layouts.push_back(&pipeline_layout);
+	size_t index = pipeline_layouts.size();
+	pipeline_layouts.push_back(nullptr);
+
+	return [this, index, shader_indices](ResourceCache &resource_cache) {
+		std::vector<ShaderModule *> shader_stages(shader_indices.size());
+		std::transform(shader_indices.begin(),
+		               shader_indices.end(),
+		               shader_stages.begin(),
+		               [&](size_t shader_index) {
+			               assert(shader_index < shader_modules.size());
+			               return shader_modules[shader_index];
+		               });
+
+		pipeline_layouts[index] = &resource_cache.RequestPipelineLayout(shader_stages);
+	};
 }
 
-void ResourceReplay::create_render_pass(ResourceCache &resource_cache, std::istringstream &stream)
+ResourceReplay::ReplayJob ResourceReplay::create_render_pass(std::istringstream &stream)
 {
 	std::vector<Attachment>    attachments;
 	std::vector<LoadStoreInfo> load_store_infos;
@@ -147,12 +312,15 @@ void ResourceReplay::create_render_pass(ResourceCache &resource_cache, std::istr
 
 	read_subpass_info(stream, subpasses);
 
-	auto &render_pass = resource_cache.RequestRenderPass(attachments, load_store_infos, subpasses);
+	size_t index = render_passes.size();
+	render_passes.push_back(nullptr);
 
-	render_passes.push_back(&render_pass);
+	return [this, index, attachments, load_store_infos, subpasses](ResourceCache &resource_cache) {
+		render_passes[index] = &resource_cache.RequestRenderPass(attachments, load_store_infos, subpasses);
+	};
 }
 
-void ResourceReplay::create_graphics_pipeline(ResourceCache &resource_cache, std::istringstream &stream)
+ResourceReplay::ReplayJob ResourceReplay::create_graphics_pipeline(std::istringstream &stream)
 {
 	size_t   pipeline_layout_index{};
 	size_t   render_pass_index{};
@@ -193,28 +361,103 @@ void ResourceReplay::create_graphics_pipeline(ResourceCache &resource_cache, std
 	     color_blend_state.logic_op_enable,
 	     color_blend_state.attachments);
 
-	PipelineState pipeline_state{};
-	assert(pipeline_layout_index < pipeline_layouts.size());
-	pipeline_state.set_pipeline_layout(*pipeline_layouts[pipeline_layout_index]);
-	assert(render_pass_index < render_passes.size());
-	pipeline_state.set_render_pass(*render_passes[render_pass_index]);
+	size_t index = graphics_pipelines.size();
+	graphics_pipelines.push_back(nullptr);
 
-	for (auto &item : specialization_constant_state)
-	{
-		pipeline_state.set_specialization_constant(item.first, item.second);
-	}
+	return [=](ResourceCache &resource_cache) {
+		PipelineState pipeline_state{};
+		assert(pipeline_layout_index < pipeline_layouts.size());
+		pipeline_state.set_pipeline_layout(*pipeline_layouts[pipeline_layout_index]);
+		assert(render_pass_index < render_passes.size());
+		pipeline_state.set_render_pass(*render_passes[render_pass_index]);
+
+		for (auto &item : specialization_constant_state)
+		{
+			pipeline_state.set_specialization_constant(item.first, item.second);
+		}
+
+		pipeline_state.set_subpass_index(subpass_index);
+		pipeline_state.set_vertex_input_state(vertex_input_state);
+		pipeline_state.set_input_assembly_state(input_assembly_state);
+		pipeline_state.set_rasterization_state(rasterization_state);
+		pipeline_state.set_viewport_state(viewport_state);
+		pipeline_state.set_multisample_state(multisample_state);
+		pipeline_state.set_depth_stencil_state(depth_stencil_state);
+		pipeline_state.set_color_blend_state(color_blend_state);
+
+		graphics_pipelines[index] = &resource_cache.RequestGraphicsPipeline(pipeline_state);
+	};
+}
+
+ResourceReplay::ReplayJob ResourceReplay::create_descriptor_set_layout(std::istringstream &stream)
+{
+	uint32_t                    set_index{};
+	std::vector<size_t>         shader_indices;
+	std::vector<ShaderResource> set_resources;
+
+	read(stream,
+	     set_index,
+	     shader_indices);
+
+	read_shader_resources(stream, set_resources);
+
+	size_t index = descriptor_set_layouts.size();
+	descriptor_set_layouts.push_back(nullptr);
+
+	return [this, index, set_index, shader_indices, set_resources](ResourceCache &resource_cache) {
+		std::vector<ShaderModule *> shader_stages(shader_indices.size());
+		std::transform(shader_indices.begin(),
+		               shader_indices.end(),
+		               shader_stages.begin(),
+		               [&](size_t shader_index) {
+			               assert(shader_index < shader_modules.size());
+			               return shader_modules[shader_index];
+		               });
 
-	pipeline_state.set_subpass_index(subpass_index);
-	pipeline_state.set_vertex_input_state(vertex_input_state);
-	pipeline_state.set_input_assembly_state(input_assembly_state);
-	pipeline_state.set_rasterization_state(rasterization_state);
-	pipeline_state.set_viewport_state(viewport_state);
-	pipeline_state.set_multisample_state(multisample_state);
-	pipeline_state.set_depth_stencil_state(depth_stencil_state);
-	pipeline_state.set_color_blend_state(color_blend_state);
+		descriptor_set_layouts[index] = &resource_cache.RequestDescriptorSetLayout(set_index, shader_stages, set_resources);
+	};
+}
+
+ResourceReplay::ReplayJob ResourceReplay::create_compute_pipeline(std::istringstream &stream)
+{
+	size_t pipeline_layout_index{};
+
+	read(stream,
+	     pipeline_layout_index);
+
+	std::map<uint32_t, std::vector<uint8_t>> specialization_constant_state{};
+	read(stream,
+	     specialization_constant_state);
+
+	size_t index = compute_pipelines.size();
+	compute_pipelines.push_back(nullptr);
 
-	auto &graphics_pipeline = resource_cache.RequestGraphicsPipeline(pipeline_state);
+	return [=](ResourceCache &resource_cache) {
+		PipelineState pipeline_state{};
+		assert(pipeline_layout_index < pipeline_layouts.size());
+		pipeline_state.set_pipeline_layout(*pipeline_layouts[pipeline_layout_index]);
+
+		for (auto &item : specialization_constant_state)
+		{
+			pipeline_state.set_specialization_constant(item.first, item.second);
+		}
+
+		compute_pipelines[index] = &resource_cache.RequestComputePipeline(pipeline_state);
+	};
+}
+
+ResourceReplay::ReplayJob ResourceReplay::create_descriptor_set_peak(std::istringstream &stream)
+{
+	size_t   descriptor_set_layout_index{};
+	uint32_t set_count{};
+
+	read(stream,
+	     descriptor_set_layout_index,
+	     set_count);
 
-	graphics_pipelines.push_back(&graphics_pipeline);
+	return [=](ResourceCache &resource_cache) {
+		assert(descriptor_set_layout_index < descriptor_set_layouts.size());
+		resource_cache.RecordDescriptorSetPeak(*descriptor_set_layouts[descriptor_set_layout_index], set_count);
+	};
 }
 }        // namespace vkb
@@ -23,27 +23,65 @@ namespace vkb
 {
 class ResourceCache;
 
+/**
+ * @brief Duration of one replay stage
+ */
+struct ResourceReplayStage
+{
+	std::string name;
+
+	size_t resource_count{0};
+
+	double duration_ms{0.0};
+};
+
 /**
  * @brief Reads Vulkan objects from a memory stream and creates them in the resource cache.
+ *
+ * The stream is decoded first, then the resources are created stage by stage following their
+ * dependencies: shader modules and render passes, descriptor set layouts, pipeline layouts, and
+ * finally graphics and compute pipelines along with the peak descriptor set counts of the layouts. Resources within a stage do not depend on each other,
+ * so with more than one thread they are created in parallel on a thread pool.
  */
 class ResourceReplay
 {
   public:
 	ResourceReplay();
 
-	void play(ResourceCache &resource_cache, ResourceRecord &recorder);
+	/**
+	 * @brief Creates all resources recorded in the stream
+	 * @param resource_cache The cache to create the resources in
+	 * @param recorder The recorder holding the stream
+	 * @param thread_count Number of threads creating the resources of a stage, the calling thread and workers
+	 *        of the job system. 1 replays on the calling thread
+	 */
+	void play(ResourceCache &resource_cache, ResourceRecord &recorder, size_t thread_count = 1);
+
+	/**
+	 * @return Timings of each stage of the last replay
+	 */
+	const std::vector<ResourceReplayStage> &get_stage_timings() const;
 
   protected:
-	void create_shader_module(ResourceCache &resource_cache, std::istringstream &stream);
+	/// Creates one decoded resource in the cache
+	using ReplayJob = std::function<void(ResourceCache &)>;
+
+	ReplayJob create_shader_module(std::istringstream &stream);
+
+	ReplayJob create_pipeline_layout(std::istringstream &stream);
+
+	ReplayJob create_render_pass(std::istringstream &stream);
 
-	void create_pipeline_layout(ResourceCache &resource_cache, std::istringstream &stream);
+	ReplayJob create_graphics_pipeline(std::istringstream &stream);
 
-	void create_render_pass(ResourceCache &resource_cache, std::istringstream &stream);
+	ReplayJob create_descriptor_set_layout(std::istringstream &stream);
 
-	void create_graphics_pipeline(ResourceCache &resource_cache, std::istringstream &stream);
+	ReplayJob create_compute_pipeline(std::istringstream &stream);
+
+	ReplayJob create_descriptor_set_peak(std::istringstream &stream);
 
   private:
-	using ResourceFunc = std::function<void(ResourceCache &, std::istringstream &)>;
+	using ResourceFunc = std::function<ReplayJob(std::istringstream &)>;
 
 	std::unordered_map<ResourceType, ResourceFunc> stream_resources;
 
@@ -54,5 +92,11 @@ class ResourceReplay
 	std::vector<const RenderPass *> render_passes;
 
 	std::vector<const GraphicsPipeline *> graphics_pipelines;
+
+	std::vector<const DescriptorSetLayout *> descriptor_set_layouts;
+
+	std::vector<const ComputePipeline *> compute_pipelines;
+
+	std::vector<ResourceReplayStage> stage_timings;
 };
 }        // namespace vkb
@@ -0,0 +1,177 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+namespace vkb
+{
+namespace sg
+{
+class Component;
+
+/**
+ * @brief Non-owning view of the components of one type stored in a Scene
+ *
+ * Iterates the contiguous array of the scene components of that type in place, yielding
+ * pointers to T without allocating. The view is invalidated when components of that type
+ * are added or replaced.
+ */
+template <class T>
+class ComponentView
+{
+  public:
+	class Iterator
+	{
+	  public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type        = T *;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = T **;
+		using reference         = T *;
+
+		Iterator() = default;
+
+		explicit Iterator(const std::unique_ptr<Component> *element) :
+		    element{element}
+		{}
+
+		T *operator*() const
+		{
+			// Components are stored by their type, the cast can't fail
+			return static_cast<T *>(element->get());
+		}
+
+		T *operator[](difference_type offset) const
+		{
+			return *(*this + offset);
+		}
+
+		Iterator &operator++()
+		{
+			++element;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator previous = *this;
+			++element;
+			return previous;
+		}
+
+		Iterator &operator--()
+		{
+			--element;
+			return *this;
+		}
+
+		Iterator operator--(int)
+		{
+			Iterator previous = *this;
+			--element;
+			return previous;
+		}
+
+		Iterator &operator+=(difference_type offset)
+		{
+			element += offset;
+			return *this;
+		}
+
+		Iterator &operator-=(difference_type offset)
+		{
+			element -= offset;
+			return *this;
+		}
+
+		Iterator operator+(difference_type offset) const
+		{
+			return Iterator{element + offset};
+		}
+
+		Iterator operator-(difference_type offset) const
+		{
+			return Iterator{element - offset};
+		}
+
+		difference_type operator-(const Iterator &other) const
+		{
+			return element - other.element;
+		}
+
+		bool operator==(const Iterator &other) const
+		{
+			return element == other.element;
+		}
+
+		bool operator!=(const Iterator &other) const
+		{
+			return element != other.element;
+		}
+
+		bool operator<(const Iterator &other) const
+		{
+			return element < other.element;
+		}
+
+	  private:
+		const std::unique_ptr<Component> *element{nullptr};
+	};
+
+	ComponentView() = default;
+
+	ComponentView(const std::unique_ptr<Component> *data, size_t count) :
+	    data{data},
+	    count{count}
+	{}
+
+	Iterator begin() const
+	{
+		return Iterator{data};
+	}
+
+	Iterator end() const
+	{
+		return Iterator{data + count};
+	}
+
+	T *operator[](size_t index) const
+	{
+		return static_cast<T *>(data[index].get());
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+  private:
+	const std::unique_ptr<Component> *data{nullptr};
+
+	size_t count{0};
+};
+}        // namespace sg
+}        // namespace vkb
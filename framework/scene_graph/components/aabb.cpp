@@ -17,12 +17,70 @@
 
 #include "aabb.h"
 
+#include <cstring>
+
 #include "core/util/logging.hpp"
+#include "geometry/simd_lanes.h"
 
 namespace vkb
 {
 namespace sg
 {
+namespace
+{
+/**
+ * @brief Loads the three floats of a position in the first lanes
+ *        Reading four floats could overrun the data after the last position, which is copied instead.
+ */
+inline simd::Lanes load_position(const uint8_t *position, bool has_padding)
+{
+	if (has_padding)
+	{
+		return simd::load(reinterpret_cast<const float *>(position));
+	}
+
+	float values[simd::LANE_COUNT]{};
+	std::memcpy(values, position, 3 * sizeof(float));
+	return simd::load(values);
+}
+
+/// Merges the first three lanes of the reduced minimum and maximum into the bounding box
+inline void update_lanes(AABB &aabb, simd::Lanes min_lanes, simd::Lanes max_lanes)
+{
+	float min_values[simd::LANE_COUNT];
+	float max_values[simd::LANE_COUNT];
+	simd::store(min_values, min_lanes);
+	simd::store(max_values, max_lanes);
+
+	aabb.update(glm::vec3(min_values[0], min_values[1], min_values[2]));
+	aabb.update(glm::vec3(max_values[0], max_values[1], max_values[2]));
+}
+
+template <typename IndexType>
+void update_indexed(AABB &aabb, const std::vector<glm::vec3> &vertex_data, const std::vector<IndexType> &index_data)
+{
+	if (vertex_data.empty() || index_data.empty())
+	{
+		return;
+	}
+
+	auto *positions = reinterpret_cast<const uint8_t *>(vertex_data.data());
+
+	simd::Lanes min_lanes = simd::splat(std::numeric_limits<float>::max());
+	simd::Lanes max_lanes = simd::splat(std::numeric_limits<float>::lowest());
+
+	for (auto index : index_data)
+	{
+		assert(index < vertex_data.size());
+		auto position = load_position(positions + index * sizeof(glm::vec3), static_cast<size_t>(index) + 1 < vertex_data.size());
+		min_lanes     = simd::min(min_lanes, position);
+		max_lanes     = simd::max(max_lanes, position);
+	}
+
+	update_lanes(aabb, min_lanes, max_lanes);
+}
+}        // namespace
+
 AABB::AABB()
 {
 	reset();
@@ -50,34 +108,75 @@ void AABB::update(const std::vector<glm::vec3> &vertex_data, const std::vector<u
 	// Check if submesh is indexed
 	if (index_data.size() > 0)
 	{
-		// Update bounding box for each indexed vertex
-		for (size_t index_id = 0; index_id < index_data.size(); index_id++)
-		{
-			update(vertex_data[index_data[index_id]]);
-		}
+		update_indexed(*this, vertex_data, index_data);
 	}
 	else
 	{
-		// Update bounding box for each vertex
-		for (size_t vertex_id = 0; vertex_id < vertex_data.size(); vertex_id++)
-		{
-			update(vertex_data[vertex_id]);
-		}
+		update(reinterpret_cast<const uint8_t *>(vertex_data.data()), sizeof(glm::vec3), vertex_data.size());
 	}
 }
 
+void AABB::update(const std::vector<glm::vec3> &vertex_data, const std::vector<uint32_t> &index_data)
+{
+	if (index_data.size() > 0)
+	{
+		update_indexed(*this, vertex_data, index_data);
+	}
+	else
+	{
+		update(reinterpret_cast<const uint8_t *>(vertex_data.data()), sizeof(glm::vec3), vertex_data.size());
+	}
+}
+
+void AABB::update(const uint8_t *position_data, size_t stride, size_t count)
+{
+	assert(stride >= 3 * sizeof(float));
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	simd::Lanes min_lanes = simd::splat(std::numeric_limits<float>::max());
+	simd::Lanes max_lanes = simd::splat(std::numeric_limits<float>::lowest());
+
+	// Every position but the last one is followed by at least the floats of the next one
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto position = load_position(position_data + i * stride, i + 1 < count);
+		min_lanes     = simd::min(min_lanes, position);
+		max_lanes     = simd::max(max_lanes, position);
+	}
+
+	update_lanes(*this, min_lanes, max_lanes);
+}
+
+void AABB::update(const AABB &other)
+{
+	if (glm::any(glm::greaterThan(other.min, other.max)))
+	{
+		return;
+	}
+
+	update(other.min);
+	update(other.max);
+}
+
 void AABB::transform(glm::mat4 &transform)
 {
-	min = max = glm::vec4(min, 1.0f) * transform;
+	glm::vec3 local_min = min;
+	glm::vec3 local_max = max;
+
+	min = max = glm::vec3(transform * glm::vec4(local_min, 1.0f));
 
 	// Update bounding box for the remaining 7 corners of the box
-	update(glm::vec4(min.x, min.y, max.z, 1.0f) * transform);
-	update(glm::vec4(min.x, max.y, min.z, 1.0f) * transform);
-	update(glm::vec4(min.x, max.y, max.z, 1.0f) * transform);
-	update(glm::vec4(max.x, min.y, min.z, 1.0f) * transform);
-	update(glm::vec4(max.x, min.y, max.z, 1.0f) * transform);
-	update(glm::vec4(max.x, max.y, min.z, 1.0f) * transform);
-	update(glm::vec4(max, 1.0f) * transform);
+	update(glm::vec3(transform * glm::vec4(local_min.x, local_min.y, local_max.z, 1.0f)));
+	update(glm::vec3(transform * glm::vec4(local_min.x, local_max.y, local_min.z, 1.0f)));
+	update(glm::vec3(transform * glm::vec4(local_min.x, local_max.y, local_max.z, 1.0f)));
+	update(glm::vec3(transform * glm::vec4(local_max.x, local_min.y, local_min.z, 1.0f)));
+	update(glm::vec3(transform * glm::vec4(local_max.x, local_min.y, local_max.z, 1.0f)));
+	update(glm::vec3(transform * glm::vec4(local_max.x, local_max.y, local_min.z, 1.0f)));
+	update(glm::vec3(transform * glm::vec4(local_max, 1.0f)));
 }
 
 glm::vec3 AABB::get_scale() const
@@ -102,9 +201,9 @@ glm::vec3 AABB::get_max() const
 
 void AABB::reset()
 {
-	min = std::numeric_limits<glm::vec3>::max();
+	min = glm::vec3(std::numeric_limits<float>::max());
 
-	max = std::numeric_limits<glm::vec3>::min();
+	max = glm::vec3(std::numeric_limits<float>::lowest());
 }
 
 }        // namespace sg
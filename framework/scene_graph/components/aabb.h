@@ -60,6 +60,27 @@ class AABB : public Component
 	 */
 	void update(const std::vector<glm::vec3> &vertex_data, const std::vector<uint16_t> &index_data);
 
+	/**
+	 * @brief Update the bounding box based on the given submesh vertices, with 32-bit indices
+	 * @param vertex_data The position vertex data
+	 * @param index_data The index vertex data
+	 */
+	void update(const std::vector<glm::vec3> &vertex_data, const std::vector<uint32_t> &index_data);
+
+	/**
+	 * @brief Update the bounding box based on tightly or loosely packed float positions, four lanes at a time
+	 * @param position_data The first position, three floats followed by any other data up to the stride
+	 * @param stride The distance in bytes between two positions, at least 12
+	 * @param count The number of positions
+	 */
+	void update(const uint8_t *position_data, size_t stride, size_t count);
+
+	/**
+	 * @brief Update the bounding box to contain another one, ignored if it is empty
+	 * @param other The bounding box to merge
+	 */
+	void update(const AABB &other);
+
 	/**
 	 * @brief Apply a given matrix transformation to the bounding box
 	 * @param transform The matrix transform to apply
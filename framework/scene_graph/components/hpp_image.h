@@ -95,6 +95,9 @@ class HPPImage : public vkb::sg::Component
 	vk::Format                                           format = vk::Format::eUndefined;
 	uint32_t                                             layers = 1;
 	std::vector<vkb::scene_graph::components::HPPMipmap> mipmaps{{}};
+	uint32_t                                             gpu_mip_levels      = 0;        // Mirrors vkb::sg::Image, the GLTFLoader creates the images
+	uint32_t                                             resident_base_level = 0;
+	bool                                                 host_copy           = false;        // Mirrors vkb::sg::Image, only set for images created by the GLTFLoader
 	std::vector<std::vector<vk::DeviceSize>>             offsets;        // Offsets stored like offsets[array_layer][mipmap_layer]
 	std::unique_ptr<vkb::core::HPPImage>                 vk_image;
 	std::unique_ptr<vkb::core::HPPImageView>             vk_image_view;
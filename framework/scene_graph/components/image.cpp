@@ -17,6 +17,8 @@
 
 #include "image.h"
 
+#include <algorithm>
+#include <array>
 #include <mutex>
 
 #include "common/error.h"
@@ -25,6 +27,9 @@
 #include <stb_image_resize.h>
 
 #include "common/utils.h"
+#include "core/command_buffer.h"
+#include "core/device.h"
+#include "filesystem/filesystem.hpp"
 #include "filesystem/legacy.h"
 #include "scene_graph/components/image/astc.h"
 #include "scene_graph/components/image/ktx.h"
@@ -200,13 +205,30 @@ void Image::create_vk_image(Device &device, VkImageViewType image_view_type, VkI
 {
 	assert(!vk_image && !vk_image_view && "Vulkan image already constructed");
 
+	VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	if (gpu_mip_levels > 0)
+	{
+		// Each level is blitted from the previous one
+		usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
+
+	// The mip chain generated on the GPU needs a command buffer anyway
+	host_copy = gpu_mip_levels == 0 && supports_host_copy(device, format, flags);
+	if (host_copy)
+	{
+		// Transfers are kept, the image can still be written through a staging buffer
+		usage |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+	}
+
+	assert((resident_base_level == 0 || gpu_mip_levels == 0) && "Levels can only be dropped from a mip chain held in the image data");
+
 	vk_image = std::make_unique<core::Image>(device,
-	                                         get_extent(),
+	                                         mipmaps[resident_base_level].extent,
 	                                         format,
-	                                         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+	                                         usage,
 	                                         VMA_MEMORY_USAGE_GPU_ONLY,
 	                                         VK_SAMPLE_COUNT_1_BIT,
-	                                         to_u32(mipmaps.size()),
+	                                         gpu_mip_levels > 0 ? gpu_mip_levels : to_u32(mipmaps.size()) - resident_base_level,
 	                                         layers,
 	                                         VK_IMAGE_TILING_OPTIMAL,
 	                                         flags);
@@ -216,6 +238,30 @@ void Image::create_vk_image(Device &device, VkImageViewType image_view_type, VkI
 	vk_image_view->set_debug_name("View on " + get_name());
 }
 
+void Image::set_resident_base_level(uint32_t base_level)
+{
+	assert(base_level < mipmaps.size() && "Not enough mip levels");
+	resident_base_level = base_level;
+}
+
+uint32_t Image::get_resident_base_level() const
+{
+	return resident_base_level;
+}
+
+uint32_t Image::get_loaded_base_level() const
+{
+	return 0;
+}
+
+void Image::wait_for_levels(uint32_t base_level)
+{}
+
+std::pair<std::unique_ptr<core::Image>, std::unique_ptr<core::ImageView>> Image::release_vk_image()
+{
+	return {std::move(vk_image), std::move(vk_image_view)};
+}
+
 const core::Image &Image::get_vk_image() const
 {
 	assert(vk_image && "Vulkan image was not created");
@@ -302,6 +348,210 @@ void Image::generate_mipmaps()
 	}
 }
 
+void Image::generate_mipmaps_on_gpu()
+{
+	assert(mipmaps.size() == 1 && "Mipmaps already generated");
+	assert(!vk_image && "Vulkan image already constructed");
+
+	auto extent = get_extent();
+
+	// Same chain as generate_mipmaps, down to 1x1
+	uint32_t levels = 1;
+	for (auto size = std::max(extent.width, extent.height); size > 1; size >>= 1)
+	{
+		++levels;
+	}
+
+	// Nothing to generate for a single texel
+	gpu_mip_levels = levels > 1 ? levels : 0;
+}
+
+bool Image::has_gpu_mipmaps() const
+{
+	return gpu_mip_levels > 0;
+}
+
+void Image::record_mipmap_generation(CommandBuffer &command_buffer) const
+{
+	assert(vk_image && "Vulkan image was not created");
+
+	VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+	barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image                       = vk_image->get_handle();
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = layers;
+
+	auto extent = get_extent();
+
+	for (uint32_t level = 1; level < gpu_mip_levels; ++level)
+	{
+		// The previous level becomes the source of the blit
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		VkImageBlit blit{};
+		blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, layers};
+		blit.srcOffsets[1]  = {static_cast<int32_t>(std::max(1u, extent.width >> (level - 1))),
+		                       static_cast<int32_t>(std::max(1u, extent.height >> (level - 1))),
+		                       1};
+		blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, layers};
+		blit.dstOffsets[1]  = {static_cast<int32_t>(std::max(1u, extent.width >> level)),
+		                       static_cast<int32_t>(std::max(1u, extent.height >> level)),
+		                       1};
+
+		vkCmdBlitImage(command_buffer.get_handle(),
+		               vk_image->get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		               vk_image->get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		               1, &blit, VK_FILTER_LINEAR);
+	}
+
+	// All the levels but the last one were blit sources
+	std::array<VkImageMemoryBarrier, 2> final_barriers{barrier, barrier};
+
+	final_barriers[0].subresourceRange.baseMipLevel = 0;
+	final_barriers[0].subresourceRange.levelCount   = gpu_mip_levels - 1;
+	final_barriers[0].oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	final_barriers[0].newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	final_barriers[0].srcAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+	final_barriers[0].dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+
+	final_barriers[1].subresourceRange.baseMipLevel = gpu_mip_levels - 1;
+	final_barriers[1].subresourceRange.levelCount   = 1;
+	final_barriers[1].oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	final_barriers[1].newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	final_barriers[1].srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+	final_barriers[1].dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+	                     to_u32(final_barriers.size()), final_barriers.data());
+}
+
+bool Image::supports_gpu_mipmaps(Device &device, VkFormat format)
+{
+	const VkFormatFeatureFlags required_features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+	auto format_properties = device.get_gpu().get_format_properties(format);
+	return (format_properties.optimalTilingFeatures & required_features) == required_features;
+}
+
+bool Image::supports_host_copy(Device &device, VkFormat format, VkImageCreateFlags flags)
+{
+	if (!device.is_enabled(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME))
+	{
+		return false;
+	}
+
+	auto *host_image_copy_features = device.get_gpu().get_requested_extension_features<VkPhysicalDeviceHostImageCopyFeaturesEXT>(VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT);
+	if (!host_image_copy_features || !host_image_copy_features->hostImageCopy)
+	{
+		return false;
+	}
+
+	VkPhysicalDevice gpu = device.get_gpu().get_handle();
+
+	VkFormatProperties3KHR format_properties_3{VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3_KHR};
+	VkFormatProperties2KHR format_properties_2{VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2_KHR, &format_properties_3};
+	vkGetPhysicalDeviceFormatProperties2KHR(gpu, format, &format_properties_2);
+	if (!(format_properties_3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT))
+	{
+		return false;
+	}
+
+	// The image is written in the layout it is sampled in
+	VkPhysicalDeviceHostImageCopyPropertiesEXT host_image_copy_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT};
+	VkPhysicalDeviceProperties2KHR             properties_2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR, &host_image_copy_properties};
+	vkGetPhysicalDeviceProperties2KHR(gpu, &properties_2);
+
+	std::vector<VkImageLayout> copy_dst_layouts(host_image_copy_properties.copyDstLayoutCount);
+	host_image_copy_properties.pCopyDstLayouts = copy_dst_layouts.data();
+	vkGetPhysicalDeviceProperties2KHR(gpu, &properties_2);
+
+	if (std::find(copy_dst_layouts.begin(), copy_dst_layouts.end(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) == copy_dst_layouts.end())
+	{
+		return false;
+	}
+
+	// The host transfer usage may make the image slower to sample, the staging copy is kept in that case
+	VkHostImageCopyDevicePerformanceQueryEXT performance_query{VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT};
+	VkImageFormatProperties2KHR              image_format_properties{VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2_KHR, &performance_query};
+
+	VkPhysicalDeviceImageFormatInfo2KHR image_format_info{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2_KHR};
+	image_format_info.format = format;
+	image_format_info.type   = VK_IMAGE_TYPE_2D;
+	image_format_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+	image_format_info.usage  = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+	image_format_info.flags  = flags;
+
+	if (vkGetPhysicalDeviceImageFormatProperties2KHR(gpu, &image_format_info, &image_format_properties) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	return performance_query.optimalDeviceAccess;
+}
+
+bool Image::has_host_copy() const
+{
+	return host_copy;
+}
+
+void Image::copy_data_from_host()
+{
+	assert(host_copy && "Vulkan image not created for host copies");
+	assert(!data.empty() && "No image data to copy");
+
+	VkImageSubresourceRange subresource_range = vk_image_view->get_subresource_range();
+
+	// Only the layout changes, the transition doesn't need to be ordered with any device access
+	VkHostImageLayoutTransitionInfoEXT layout_transition_info{VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT};
+	layout_transition_info.image            = vk_image->get_handle();
+	layout_transition_info.oldLayout        = VK_IMAGE_LAYOUT_UNDEFINED;
+	layout_transition_info.newLayout        = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	layout_transition_info.subresourceRange = subresource_range;
+	VK_CHECK(vkTransitionImageLayoutEXT(vk_image->get_device().get_handle(), 1, &layout_transition_info));
+
+	// One copy per resident level, and per layer when the layers have offsets of their own
+	std::vector<VkMemoryToImageCopyEXT> copy_regions;
+	for (uint32_t level = resident_base_level; level < to_u32(mipmaps.size()); ++level)
+	{
+		VkMemoryToImageCopyEXT copy_region{VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT};
+		copy_region.imageSubresource.aspectMask = subresource_range.aspectMask;
+		copy_region.imageSubresource.mipLevel   = level - resident_base_level;
+		copy_region.imageExtent                 = mipmaps[level].extent;
+
+		if (offsets.empty())
+		{
+			copy_region.pHostPointer                    = data.data() + mipmaps[level].offset;
+			copy_region.imageSubresource.layerCount     = subresource_range.layerCount;
+			copy_region.imageSubresource.baseArrayLayer = 0;
+			copy_regions.push_back(copy_region);
+			continue;
+		}
+
+		for (uint32_t layer = 0; layer < layers; ++layer)
+		{
+			copy_region.pHostPointer                    = data.data() + offsets[layer][level];
+			copy_region.imageSubresource.layerCount     = 1;
+			copy_region.imageSubresource.baseArrayLayer = layer;
+			copy_regions.push_back(copy_region);
+		}
+	}
+
+	VkCopyMemoryToImageInfoEXT copy_info{VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT};
+	copy_info.dstImage       = vk_image->get_handle();
+	copy_info.dstImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	copy_info.regionCount    = to_u32(copy_regions.size());
+	copy_info.pRegions       = copy_regions.data();
+	VK_CHECK(vkCopyMemoryToImageEXT(vk_image->get_device().get_handle(), &copy_info));
+}
+
 std::vector<Mipmap> &Image::get_mut_mipmaps()
 {
 	return mipmaps;
@@ -361,26 +611,27 @@ std::unique_ptr<Image> Image::load(const std::string &name, const std::string &u
 {
 	std::unique_ptr<Image> image{nullptr};
 
-	auto data = fs::read_asset(uri);
+	// The decoders read the file straight from the mapping
+	auto file = fs::map_asset(uri);
 
 	// Get extension
 	auto extension = get_extension(uri);
 
 	if (extension == "png" || extension == "jpg")
 	{
-		image = std::make_unique<Stb>(name, data, content_type);
+		image = std::make_unique<Stb>(name, file->data(), file->size(), content_type);
 	}
 	else if (extension == "astc")
 	{
-		image = std::make_unique<Astc>(name, data);
+		image = std::make_unique<Astc>(name, file->data(), file->size());
 	}
 	else if (extension == "ktx")
 	{
-		image = std::make_unique<Ktx>(name, data, content_type);
+		image = std::make_unique<Ktx>(name, file->data(), file->size(), content_type);
 	}
 	else if (extension == "ktx2")
 	{
-		image = std::make_unique<Ktx>(name, data, content_type);
+		image = std::make_unique<Ktx>(name, file->data(), file->size(), content_type);
 	}
 
 	return image;
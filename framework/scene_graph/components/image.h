@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 
 #include <volk.h>
@@ -30,6 +31,8 @@
 
 namespace vkb
 {
+class CommandBuffer;
+
 namespace sg
 {
 /**
@@ -38,6 +41,11 @@ namespace sg
  */
 bool is_astc(VkFormat format);
 
+/**
+ * @return Bytes of the RGBA8 mip chain of an extent, the base level included
+ */
+uint32_t get_required_mipmaps_size(const VkExtent3D &extent);
+
 /**
  * @brief Mipmap information
  */
@@ -94,6 +102,79 @@ class Image : public Component
 
 	void generate_mipmaps();
 
+	/**
+	 * @brief Requests the mip chain to be generated on the GPU from level 0, instead of on the CPU by generate_mipmaps
+	 *        Must be called before create_vk_image, which then creates the image with the full mip chain
+	 *        while only level 0 is held in the image data.
+	 */
+	void generate_mipmaps_on_gpu();
+
+	/**
+	 * @return Whether the mip chain is generated on the GPU, with record_mipmap_generation
+	 */
+	bool has_gpu_mipmaps() const;
+
+	/**
+	 * @brief Records the blits generating the mip chain from level 0
+	 *        The whole image must be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL with level 0 written,
+	 *        it is left in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+	 * @param command_buffer A command buffer of a queue family with graphics support
+	 */
+	void record_mipmap_generation(CommandBuffer &command_buffer) const;
+
+	/**
+	 * @param device The device the image is created on
+	 * @param format The format of the image
+	 * @return Whether images of the format can be downsampled with linear blits
+	 */
+	static bool supports_gpu_mipmaps(Device &device, VkFormat format);
+
+	/**
+	 * @param device The device the image is created on
+	 * @param format The format of the image
+	 * @param flags The create flags of the image
+	 * @return Whether images of the format can be written from host memory with VK_EXT_host_image_copy,
+	 *         which requires the extension and its hostImageCopy feature to be enabled on the device
+	 */
+	static bool supports_host_copy(Device &device, VkFormat format, VkImageCreateFlags flags = 0);
+
+	/**
+	 * @return Whether the Vulkan image was created to be written with copy_data_from_host
+	 */
+	bool has_host_copy() const;
+
+	/**
+	 * @brief Writes the resident levels of the image data to the Vulkan image from the calling thread, without a command buffer
+	 *        The image is left in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. Different images can be written from different threads.
+	 */
+	void copy_data_from_host();
+
+	/**
+	 * @brief Sets the first mip level held by the Vulkan image, the finer levels are only kept in the image data
+	 *        Applies to the next create_vk_image, level 0 of the Vulkan image is then this level of the image data.
+	 */
+	void set_resident_base_level(uint32_t base_level);
+
+	uint32_t get_resident_base_level() const;
+
+	/**
+	 * @return The finest mip level from which the image data is loaded, the finer levels are still being decoded
+	 *         The number of mip levels if none is loaded yet.
+	 */
+	virtual uint32_t get_loaded_base_level() const;
+
+	/**
+	 * @brief Blocks until the levels of the image data from a base level are loaded, running queued jobs meanwhile
+	 *        Throws if one of them failed to load.
+	 */
+	virtual void wait_for_levels(uint32_t base_level);
+
+	/**
+	 * @brief Takes the Vulkan image and its view out of the image, so a new one can be created
+	 *        while the frames in flight still use the previous one
+	 */
+	std::pair<std::unique_ptr<core::Image>, std::unique_ptr<core::ImageView>> release_vk_image();
+
 	void create_vk_image(Device &device, VkImageViewType image_view_type = VK_IMAGE_VIEW_TYPE_2D, VkImageCreateFlags flags = 0);
 
 	const core::Image &get_vk_image() const;
@@ -132,6 +213,15 @@ class Image : public Component
 
 	std::vector<Mipmap> mipmaps{{}};
 
+	/// Levels of the Vulkan image when the mip chain is generated on the GPU, 0 otherwise
+	uint32_t gpu_mip_levels{0};
+
+	/// First mip level of the image data held by the Vulkan image
+	uint32_t resident_base_level{0};
+
+	/// Whether the Vulkan image is written from the host, instead of through a staging buffer
+	bool host_copy{false};
+
 	// Offsets stored like offsets[array_layer][mipmap_layer]
 	std::vector<std::vector<VkDeviceSize>> offsets;
 
@@ -17,9 +17,14 @@
 
 #include "scene_graph/components/image/astc.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <mutex>
+#include <tuple>
 
 #include "common/error.h"
+#include "core/util/job_system.hpp"
 #include "core/util/profiling.hpp"
 
 #include "common/glm_common.h"
@@ -97,6 +102,111 @@ struct AstcHeader
 	uint8_t zsize[3];        // block count is inferred
 };
 
+namespace
+{
+/**
+ * @brief Decompression contexts kept across images, an astcenc context is costly to allocate
+ *
+ * The contexts are keyed by block size, which is fixed when allocating one. Their thread count is
+ * fixed too, but any number of threads up to it can decode an image, so it isn't part of the key.
+ * A context decodes one image at a time, images decoded concurrently get a context each.
+ */
+class AstcContextCache
+{
+  public:
+	using Key = std::tuple<uint8_t, uint8_t, uint8_t>;
+
+	struct Context
+	{
+		astcenc_context *handle{nullptr};
+
+		/// Number of threads the context was allocated for
+		unsigned int thread_count{0};
+	};
+
+	~AstcContextCache()
+	{
+		for (auto &it : free_contexts)
+		{
+			for (auto &context : it.second)
+			{
+				astcenc_context_free(context.handle);
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns a free context for the block size, or allocates one
+	 * @param thread_count Number of threads the context must support at least
+	 */
+	Context acquire(BlockDim blockdim, unsigned int thread_count)
+	{
+		{
+			std::lock_guard<std::mutex> guard{mutex};
+
+			auto &contexts = free_contexts[{blockdim.x, blockdim.y, blockdim.z}];
+
+			// Contexts allocated for fewer threads are left from a job system with fewer workers
+			auto it = std::find_if(contexts.begin(), contexts.end(), [thread_count](const Context &context) { return context.thread_count >= thread_count; });
+			if (it != contexts.end())
+			{
+				auto context = *it;
+				contexts.erase(it);
+				return context;
+			}
+		}
+
+		// Configure the decompressor run
+		astcenc_config astc_config;
+		auto           astc_result = astcenc_config_init(
+            ASTCENC_PRF_LDR_SRGB,
+            blockdim.x,
+            blockdim.y,
+            blockdim.z,
+            ASTCENC_PRE_FAST,
+            ASTCENC_FLG_DECOMPRESS_ONLY,
+            &astc_config);
+
+		if (astc_result != ASTCENC_SUCCESS)
+		{
+			throw std::runtime_error{"Error initializing astc"};
+		}
+
+		// Allocate working state given config and thread_count
+		astcenc_context *context = nullptr;
+		astc_result              = astcenc_context_alloc(&astc_config, thread_count, &context);
+
+		if (astc_result != ASTCENC_SUCCESS)
+		{
+			throw std::runtime_error{"Error allocating astc context"};
+		}
+
+		return {context, thread_count};
+	}
+
+	/**
+	 * @brief Makes a context available to the next image with the same block size
+	 */
+	void release(BlockDim blockdim, const Context &context)
+	{
+		astcenc_decompress_reset(context.handle);
+
+		std::lock_guard<std::mutex> guard{mutex};
+		free_contexts[{blockdim.x, blockdim.y, blockdim.z}].push_back(context);
+	}
+
+  private:
+	std::mutex mutex;
+
+	std::map<Key, std::vector<Context>> free_contexts;
+};
+
+AstcContextCache context_cache;
+
+/// Images being decoded, the cores are shared between them
+std::atomic<unsigned int> active_decodes{0};
+}        // namespace
+
 void Astc::init()
 {
 }
@@ -107,30 +217,31 @@ void Astc::decode(BlockDim blockdim, VkExtent3D extent, const uint8_t *compresse
 
 	// Actual decoding
 	astcenc_swizzle swizzle = {ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A};
-	// Configure the compressor run
-	astcenc_config astc_config;
-	auto           atscresult = astcenc_config_init(
-        ASTCENC_PRF_LDR_SRGB,
-        blockdim.x,
-        blockdim.y,
-        blockdim.z,
-        ASTCENC_PRE_FAST,
-        ASTCENC_FLG_DECOMPRESS_ONLY,
-        &astc_config);
-
-	if (atscresult != ASTCENC_SUCCESS)
-	{
-		throw std::runtime_error{"Error initializing astc"};
-	}
 
 	if (extent.width == 0 || extent.height == 0 || extent.depth == 0)
 	{
 		throw std::runtime_error{"Error reading astc: invalid size"};
 	}
 
-	// Allocate working state given config and thread_count
-	astcenc_context *astc_context;
-	astcenc_context_alloc(&astc_config, 1, &astc_context);
+	// Loaders already decoding several images in parallel keep fewer threads per image.
+	// The contexts support every thread though, so that they are reused whatever the number of decodes.
+	auto        &jobs               = JobSystem::get();
+	unsigned int max_thread_count   = jobs.get_worker_count() + 1;
+	unsigned int concurrent_decodes = ++active_decodes;
+	unsigned int thread_count       = std::max(1u, max_thread_count / concurrent_decodes);
+
+	AstcContextCache::Context cached_context;
+	try
+	{
+		cached_context = context_cache.acquire(blockdim, max_thread_count);
+	}
+	catch (...)
+	{
+		--active_decodes;
+		throw;
+	}
+
+	astcenc_context *astc_context = cached_context.handle;
 
 	astcenc_image decoded{};
 	decoded.dim_x     = extent.width;
@@ -146,12 +257,31 @@ void Astc::decode(BlockDim blockdim, VkExtent3D extent, const uint8_t *compresse
 	void *data_ptr = static_cast<void *>(decoded_data.data());
 	decoded.data   = &data_ptr;
 
-	atscresult = astcenc_decompress_image(astc_context, compressed_data, compressed_size, &decoded, &swizzle, 0);
-	if (atscresult != ASTCENC_SUCCESS)
+	// The threads of the context share the blocks as they join, the calling one does them all if no worker is free.
+	// Every job has to run before the context is reset though, so the calling thread waits for them.
+	std::vector<astcenc_error> thread_results(thread_count, ASTCENC_SUCCESS);
+
+	JobCounter decodes;
+	for (unsigned int thread_index = 1; thread_index < thread_count; ++thread_index)
+	{
+		jobs.schedule(
+		    [&, thread_index]() {
+			    thread_results[thread_index] = astcenc_decompress_image(astc_context, compressed_data, compressed_size, &decoded, &swizzle, thread_index);
+		    },
+		    &decodes);
+	}
+
+	thread_results[0] = astcenc_decompress_image(astc_context, compressed_data, compressed_size, &decoded, &swizzle, 0);
+
+	jobs.wait(decodes);
+
+	context_cache.release(blockdim, cached_context);
+	--active_decodes;
+
+	if (std::any_of(thread_results.begin(), thread_results.end(), [](astcenc_error result) { return result != ASTCENC_SUCCESS; }))
 	{
 		throw std::runtime_error("Error decoding astc");
 	}
-	astcenc_context_free(astc_context);
 
 	set_format(VK_FORMAT_R8G8B8A8_SRGB);
 	set_width(decoded.dim_x);
@@ -179,17 +309,21 @@ Astc::Astc(const Image &image) :
 }
 
 Astc::Astc(const std::string &name, const std::vector<uint8_t> &data) :
+    Astc{name, data.data(), data.size()}
+{}
+
+Astc::Astc(const std::string &name, const uint8_t *data, size_t size) :
     Image{name}
 {
 	init();
 
 	// Read header
-	if (data.size() < sizeof(AstcHeader))
+	if (size < sizeof(AstcHeader))
 	{
 		throw std::runtime_error{"Error reading astc: invalid memory"};
 	}
 	AstcHeader header{};
-	std::memcpy(&header, data.data(), sizeof(AstcHeader));
+	std::memcpy(&header, data, sizeof(AstcHeader));
 	uint32_t magicval = header.magic[0] + 256 * static_cast<uint32_t>(header.magic[1]) + 65536 * static_cast<uint32_t>(header.magic[2]) + 16777216 * static_cast<uint32_t>(header.magic[3]);
 	if (magicval != MAGIC_FILE_CONSTANT)
 	{
@@ -206,7 +340,7 @@ Astc::Astc(const std::string &name, const std::vector<uint8_t> &data) :
 	    /* height = */ static_cast<uint32_t>(header.ysize[0] + 256 * header.ysize[1] + 65536 * header.ysize[2]),
 	    /* depth  = */ static_cast<uint32_t>(header.zsize[0] + 256 * header.zsize[1] + 65536 * header.zsize[2])};
 
-	decode(blockdim, extent, data.data() + sizeof(AstcHeader), to_u32(data.size() - sizeof(AstcHeader)));
+	decode(blockdim, extent, data + sizeof(AstcHeader), to_u32(size - sizeof(AstcHeader)));
 }
 
 }        // namespace sg
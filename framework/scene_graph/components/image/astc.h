@@ -47,6 +47,11 @@ class Astc : public Image
 	 */
 	Astc(const std::string &name, const std::vector<uint8_t> &data);
 
+	/**
+	 * @brief Decodes the image from memory it doesn't own, like a mapped file
+	 */
+	Astc(const std::string &name, const uint8_t *data, size_t size);
+
 	virtual ~Astc() = default;
 
   private:
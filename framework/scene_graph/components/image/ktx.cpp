@@ -18,15 +18,45 @@
 
 #include "scene_graph/components/image/ktx.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+
 #include "common/error.h"
+#include "common/helpers.h"
+#include "core/util/job_system.hpp"
 
 #include <ktx.h>
 #include <ktxvulkan.h>
+#include <zstd.h>
 
 namespace vkb
 {
 namespace sg
 {
+namespace
+{
+/// Offset of the level index in a KTX2 file, after the identifier, the texture description and the index of the other blocks
+constexpr size_t Ktx2LevelIndexOffset = 80;
+
+/// An entry of the level index of a KTX2 file
+struct Ktx2Level
+{
+	uint64_t byte_offset;
+	uint64_t byte_length;
+	uint64_t uncompressed_byte_length;
+};
+}        // namespace
+
+struct Ktx::LevelJob
+{
+	JobCounter counter;
+
+	/// Set once the level is written to the image data
+	std::atomic<bool> inflated{false};
+};
+
 struct CallbackData final
 {
 	ktxTexture          *texture;
@@ -66,10 +96,14 @@ static ktx_error_code_e KTX_APIENTRY optimal_tiling_callback(int          mip_le
 }
 
 Ktx::Ktx(const std::string &name, const std::vector<uint8_t> &data, ContentType content_type) :
+    Ktx{name, data.data(), data.size(), content_type}
+{}
+
+Ktx::Ktx(const std::string &name, const uint8_t *data, size_t size, ContentType content_type) :
     Image{name}
 {
-	auto data_buffer = reinterpret_cast<const ktx_uint8_t *>(data.data());
-	auto data_size   = static_cast<ktx_size_t>(data.size());
+	auto data_buffer = reinterpret_cast<const ktx_uint8_t *>(data);
+	auto data_size   = static_cast<ktx_size_t>(size);
 
 	ktxTexture *texture;
 	auto        load_ktx_result = ktxTexture_CreateFromMemory(data_buffer,
@@ -81,12 +115,98 @@ Ktx::Ktx(const std::string &name, const std::vector<uint8_t> &data, ContentType
 		throw std::runtime_error{"Error loading KTX texture: " + name};
 	}
 
+	try
+	{
+		load(texture, content_type, data, size);
+	}
+	catch (...)
+	{
+		ktxTexture_Destroy(texture);
+		throw;
+	}
+
+	ktxTexture_Destroy(texture);
+
+	// The callers of this constructor use the whole mip chain
+	wait_for_levels(0);
+}
+
+Ktx::Ktx(const std::string &name, ktxTexture *texture, ContentType content_type) :
+    Image{name}
+{
+	load(texture, content_type);
+}
+
+Ktx::Ktx(const std::string &name, ktxTexture *texture, const uint8_t *data, size_t size, ContentType content_type) :
+    Image{name}
+{
+	load(texture, content_type, data, size);
+}
+
+Ktx::~Ktx()
+{
+	if (level_jobs.empty())
+	{
+		return;
+	}
+
+	// The jobs write to the image data
+	auto &jobs = JobSystem::get();
+	for (auto &level_job : level_jobs)
+	{
+		jobs.wait(level_job->counter);
+	}
+}
+
+uint32_t Ktx::get_loaded_base_level() const
+{
+	// The levels are only usable from the coarsest one, even if finer ones are already inflated
+	for (size_t level = level_jobs.size(); level > 0; --level)
+	{
+		if (!level_jobs[level - 1]->inflated.load(std::memory_order_acquire))
+		{
+			return to_u32(level);
+		}
+	}
+
+	return 0;
+}
+
+void Ktx::wait_for_levels(uint32_t base_level)
+{
+	if (level_jobs.empty())
+	{
+		return;
+	}
+
+	auto &jobs = JobSystem::get();
+	for (size_t level = level_jobs.size(); level > base_level; --level)
+	{
+		jobs.wait(level_jobs[level - 1]->counter);
+	}
+
+	// Checked once every level waited for ran, a constructor throwing frees the data the jobs write to
+	for (size_t level = base_level; level < level_jobs.size(); ++level)
+	{
+		if (!level_jobs[level]->inflated.load(std::memory_order_acquire))
+		{
+			throw std::runtime_error{"Error inflating level " + std::to_string(level) + " of KTX2 texture: " + get_name()};
+		}
+	}
+}
+
+void Ktx::load(ktxTexture *texture, ContentType content_type, const uint8_t *file_data, size_t file_size)
+{
+	// Inflated here level by level, rather than all at once by libktx
+	bool inflate_in_jobs = !texture->pData && file_data && texture->classId == ktxTexture2_c &&
+	                       reinterpret_cast<ktxTexture2 *>(texture)->supercompressionScheme == KTX_SS_ZSTD;
+
 	if (texture->pData)
 	{
 		// Already loaded
 		set_data(texture->pData, texture->dataSize);
 	}
-	else
+	else if (!inflate_in_jobs)
 	{
 		// Load
 		auto &mut_data = get_mut_data();
@@ -95,7 +215,7 @@ Ktx::Ktx(const std::string &name, const std::vector<uint8_t> &data, ContentType
 		auto load_data_result = ktxTexture_LoadImageData(texture, mut_data.data(), size);
 		if (load_data_result != KTX_SUCCESS)
 		{
-			throw std::runtime_error{"Error loading KTX image data: " + name};
+			throw std::runtime_error{"Error loading KTX image data: " + get_name()};
 		}
 	}
 
@@ -125,6 +245,12 @@ Ktx::Ktx(const std::string &name, const std::vector<uint8_t> &data, ContentType
 		coerce_format_to_srgb();
 	}
 
+	if (inflate_in_jobs)
+	{
+		inflate_levels(texture, file_data, file_size);
+		return;
+	}
+
 	auto &mipmap_levels = get_mut_mipmaps();
 	mipmap_levels.resize(texture->numLevels);
 
@@ -175,9 +301,87 @@ Ktx::Ktx(const std::string &name, const std::vector<uint8_t> &data, ContentType
 		}
 		set_offsets(offsets);
 	}
-
-	ktxTexture_Destroy(texture);
 }
 
+void Ktx::inflate_levels(ktxTexture *texture, const uint8_t *file_data, size_t file_size)
+{
+	uint32_t level_count = texture->numLevels;
+	uint32_t image_count = texture->numLayers * texture->numFaces;
+
+	if (file_size < Ktx2LevelIndexOffset + level_count * sizeof(Ktx2Level))
+	{
+		throw std::runtime_error{"Error loading KTX2 level index: " + get_name()};
+	}
+
+	std::vector<Ktx2Level> level_index(level_count);
+	std::memcpy(level_index.data(), file_data + Ktx2LevelIndexOffset, level_index.size() * sizeof(Ktx2Level));
+
+	// Each level starts on a texel block, as buffer to image copies require
+	VkDeviceSize alignment = std::lcm<VkDeviceSize>(4, std::max(ktxTexture_GetElementSize(texture), 1u));
+
+	auto &mipmaps = get_mut_mipmaps();
+	mipmaps.resize(level_count);
+
+	// Offsets of every layer, or face of a cubemap, the images of a level follow each other
+	std::vector<std::vector<VkDeviceSize>> offsets(image_count, std::vector<VkDeviceSize>(level_count));
+
+	VkDeviceSize data_size = 0;
+	for (uint32_t level = 0; level < level_count; level++)
+	{
+		auto &level_entry = level_index[level];
+		if (level_entry.byte_offset + level_entry.byte_length > file_size || level_entry.uncompressed_byte_length % image_count != 0)
+		{
+			throw std::runtime_error{"Error loading KTX2 level index: " + get_name()};
+		}
+
+		data_size = (data_size + alignment - 1) / alignment * alignment;
+
+		auto &mipmap         = mipmaps[level];
+		mipmap.level         = level;
+		mipmap.offset        = to_u32(data_size);
+		mipmap.extent.width  = std::max(texture->baseWidth >> level, 1u);
+		mipmap.extent.height = std::max(texture->baseHeight >> level, 1u);
+		mipmap.extent.depth  = std::max(texture->baseDepth >> level, 1u);
+
+		VkDeviceSize image_size = level_entry.uncompressed_byte_length / image_count;
+		for (uint32_t image = 0; image < image_count; image++)
+		{
+			offsets[image][level] = data_size + image * image_size;
+		}
+
+		data_size += level_entry.uncompressed_byte_length;
+	}
+
+	set_offsets(offsets);
+
+	auto &data = get_mut_data();
+	data.resize(static_cast<size_t>(data_size));
+
+	for (uint32_t level = 0; level < level_count; level++)
+	{
+		level_jobs.push_back(std::make_unique<LevelJob>());
+	}
+
+	// Queued from level 0: a worker runs its own jobs from the last queued, the coarsest level,
+	// while the other workers steal the finest levels first
+	auto &jobs = JobSystem::get();
+	for (uint32_t level = 0; level < level_count; level++)
+	{
+		auto &level_entry = level_index[level];
+
+		// The jobs own the compressed level, the file data may not outlive the constructor
+		std::vector<uint8_t> compressed{file_data + level_entry.byte_offset, file_data + level_entry.byte_offset + level_entry.byte_length};
+
+		jobs.schedule(
+		    [level_job  = level_jobs[level].get(),
+		     compressed = std::move(compressed),
+		     inflated   = data.data() + mipmaps[level].offset,
+		     size       = static_cast<size_t>(level_entry.uncompressed_byte_length)]() {
+			    auto result = ZSTD_decompress(inflated, size, compressed.data(), compressed.size());
+			    level_job->inflated.store(!ZSTD_isError(result) && result == size, std::memory_order_release);
+		    },
+		    &level_jobs[level]->counter);
+	}
+}
 }        // namespace sg
 }        // namespace vkb
@@ -17,18 +17,68 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "scene_graph/components/image.h"
 
+struct ktxTexture;
+
 namespace vkb
 {
 namespace sg
 {
+/**
+ * @brief An image loaded from a KTX or KTX2 texture
+ *
+ * The levels of zstd supercompressed KTX2 textures are inflated as separate jobs of the shared
+ * JobSystem, so they decode in parallel and the coarse levels are available first.
+ */
 class Ktx : public Image
 {
   public:
 	Ktx(const std::string &name, const std::vector<uint8_t> &data, ContentType content_type);
 
-	virtual ~Ktx() = default;
+	/**
+	 * @brief Loads the texture from memory it doesn't own, like a mapped file
+	 *        Returns once every level is loaded.
+	 */
+	Ktx(const std::string &name, const uint8_t *data, size_t size, ContentType content_type);
+
+	/**
+	 * @brief Loads a texture already created by libktx, like a transcoded KTX2 texture
+	 *        The texture stays owned by the caller.
+	 */
+	Ktx(const std::string &name, ktxTexture *texture, ContentType content_type);
+
+	/**
+	 * @brief Loads a texture created by libktx without its image data, from the file it was created from
+	 *        Returns before the levels of zstd supercompressed textures are inflated, see wait_for_levels().
+	 *        The file data is only read by the constructor, and the texture stays owned by the caller.
+	 */
+	Ktx(const std::string &name, ktxTexture *texture, const uint8_t *data, size_t size, ContentType content_type);
+
+	/**
+	 * @brief Waits for the levels still being inflated
+	 */
+	virtual ~Ktx();
+
+	uint32_t get_loaded_base_level() const override;
+
+	void wait_for_levels(uint32_t base_level) override;
+
+  private:
+	struct LevelJob;
+
+	void load(ktxTexture *texture, ContentType content_type, const uint8_t *file_data = nullptr, size_t file_size = 0);
+
+	/**
+	 * @brief Lays out the levels of a zstd supercompressed KTX2 texture from level 0, and queues a job inflating each of them
+	 */
+	void inflate_levels(ktxTexture *texture, const uint8_t *file_data, size_t file_size);
+
+	/// Jobs inflating the levels into the image data, by level, empty unless the texture is zstd supercompressed
+	std::vector<std::unique_ptr<LevelJob>> level_jobs;
 };
 
 }        // namespace sg
@@ -0,0 +1,271 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene_graph/components/image/ktx_transcoder.h"
+
+#include <cstring>
+
+#include <ktx.h>
+
+#include "common/error.h"
+#include "common/helpers.h"
+#include "core/physical_device.h"
+#include "core/util/cache_file.hpp"
+#include "core/util/hash.hpp"
+#include "filesystem/filesystem.hpp"
+#include "filesystem/legacy.h"
+#include "scene_graph/components/image/ktx.h"
+
+namespace vkb
+{
+namespace sg
+{
+namespace
+{
+constexpr uint32_t CacheMagic   = 0x3258544b;        // "KTX2"
+constexpr uint32_t CacheVersion = 2;
+
+/// Starts the payload of the transcoded image, followed by its mipmaps, its offsets and its data
+struct CacheHeader
+{
+	uint64_t source_hash;
+	uint32_t target_format;
+	uint32_t format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t layers;
+	uint32_t mipmap_count;
+	uint32_t offset_layer_count;
+	uint32_t offset_level_count;
+	uint32_t padding;
+	uint64_t data_size;
+};
+
+struct TargetFormat
+{
+	ktx_transcode_fmt_e ktx_format;
+	VkFormat            format;
+};
+
+/// Candidate targets, from the preferred one
+const TargetFormat target_formats[] = {
+    {KTX_TTF_ASTC_4x4_RGBA, VK_FORMAT_ASTC_4x4_UNORM_BLOCK},
+    {KTX_TTF_BC7_RGBA, VK_FORMAT_BC7_UNORM_BLOCK},
+    {KTX_TTF_ETC2_RGBA, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK}};
+
+/// An image read back from the cache
+class CachedImage : public Image
+{
+  public:
+	CachedImage(const std::string &name, const CacheHeader &header, const uint8_t *payload) :
+	    Image{name}
+	{
+		set_format(static_cast<VkFormat>(header.format));
+		set_width(header.width);
+		set_height(header.height);
+		set_depth(header.depth);
+		set_layers(header.layers);
+
+		auto &mipmaps = get_mut_mipmaps();
+		mipmaps.resize(header.mipmap_count);
+		std::memcpy(mipmaps.data(), payload, mipmaps.size() * sizeof(Mipmap));
+		payload += mipmaps.size() * sizeof(Mipmap);
+
+		std::vector<std::vector<VkDeviceSize>> offsets(header.offset_layer_count, std::vector<VkDeviceSize>(header.offset_level_count));
+		for (auto &layer_offsets : offsets)
+		{
+			std::memcpy(layer_offsets.data(), payload, layer_offsets.size() * sizeof(VkDeviceSize));
+			payload += layer_offsets.size() * sizeof(VkDeviceSize);
+		}
+		set_offsets(offsets);
+
+		set_data(payload, static_cast<size_t>(header.data_size));
+	}
+};
+}        // namespace
+
+KtxTranscoder::KtxTranscoder(const PhysicalDevice &gpu, const std::string &cache_directory) :
+    target_format{KTX_TTF_RGBA32},
+    cache_directory{cache_directory}
+{
+	if (this->cache_directory.empty())
+	{
+		this->cache_directory = (vkb::filesystem::get()->temp_directory() / "ktx2_cache").string();
+	}
+
+	for (auto &target : target_formats)
+	{
+		auto format_properties = gpu.get_format_properties(target.format);
+		if (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+		{
+			target_format = target.ktx_format;
+			break;
+		}
+	}
+}
+
+std::unique_ptr<Image> KtxTranscoder::load(const std::string &name, const uint8_t *data, size_t size, Image::ContentType content_type) const
+{
+	ktxTexture *texture = nullptr;
+	if (ktxTexture_CreateFromMemory(data, size, KTX_TEXTURE_CREATE_NO_FLAGS, &texture) != KTX_SUCCESS)
+	{
+		throw std::runtime_error{"Error loading KTX texture: " + name};
+	}
+
+	auto *texture2 = texture->classId == ktxTexture2_c ? reinterpret_cast<ktxTexture2 *>(texture) : nullptr;
+
+	if (!texture2 || !ktxTexture2_NeedsTranscoding(texture2))
+	{
+		// Zstd supercompressed levels are still inflating when the image is returned
+		std::unique_ptr<Image> image;
+		try
+		{
+			image = std::make_unique<Ktx>(name, texture, data, size, content_type);
+		}
+		catch (...)
+		{
+			ktxTexture_Destroy(texture);
+			throw;
+		}
+		ktxTexture_Destroy(texture);
+		return image;
+	}
+
+	uint64_t hash = fnv1a_hash(data, size);
+	auto     path = get_cache_path(hash);
+
+	if (auto image = load_cached(name, path, hash))
+	{
+		ktxTexture_Destroy(texture);
+		return image;
+	}
+
+	LOGI("Transcoding {}", name);
+
+	if (ktxTexture_LoadImageData(texture, nullptr, 0) != KTX_SUCCESS)
+	{
+		ktxTexture_Destroy(texture);
+		throw std::runtime_error{"Error loading KTX image data: " + name};
+	}
+
+	auto result = ktxTexture2_TranscodeBasis(texture2, static_cast<ktx_transcode_fmt_e>(target_format), 0);
+	if (result != KTX_SUCCESS)
+	{
+		ktxTexture_Destroy(texture);
+		throw std::runtime_error{"Error transcoding KTX2 texture: " + name};
+	}
+
+	auto image = std::make_unique<Ktx>(name, texture, content_type);
+	ktxTexture_Destroy(texture);
+
+	write_cached(*image, path, hash);
+
+	return image;
+}
+
+std::unique_ptr<Image> KtxTranscoder::load(const std::string &name, const std::string &uri, Image::ContentType content_type) const
+{
+	auto file = fs::map_asset(uri);
+	return load(name, file->data(), file->size(), content_type);
+}
+
+uint32_t KtxTranscoder::get_target_format() const
+{
+	return target_format;
+}
+
+std::unique_ptr<Image> KtxTranscoder::load_cached(const std::string &name, const std::string &path, uint64_t hash) const
+{
+	auto file_system = vkb::filesystem::get();
+
+	if (!file_system->is_file(path))
+	{
+		return nullptr;
+	}
+
+	auto file = file_system->map_file(path);
+
+	CacheFileReader reader{file->data(), file->size(), CacheMagic, CacheVersion};
+	CacheHeader     header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		LOGW("Ignoring truncated transcoded texture {}", path);
+		return nullptr;
+	}
+
+	if (!reader.read(header) || header.source_hash != hash || header.target_format != target_format ||
+	    reader.get_remaining_size() != header.mipmap_count * sizeof(Mipmap) +
+	                                       uint64_t{header.offset_layer_count} * header.offset_level_count * sizeof(VkDeviceSize) +
+	                                       header.data_size)
+	{
+		LOGW("Ignoring stale transcoded texture {}", path);
+		return nullptr;
+	}
+
+	return std::make_unique<CachedImage>(name, header, reader.get_data());
+}
+
+void KtxTranscoder::write_cached(const Image &image, const std::string &path, uint64_t hash) const
+{
+	auto &mipmaps = image.get_mipmaps();
+	auto &offsets = image.get_offsets();
+	auto &data    = image.get_data();
+
+	CacheHeader header{};
+	header.source_hash        = hash;
+	header.target_format      = target_format;
+	header.format             = static_cast<uint32_t>(image.get_format());
+	header.width              = image.get_extent().width;
+	header.height             = image.get_extent().height;
+	header.depth              = image.get_extent().depth;
+	header.layers             = image.get_layers();
+	header.mipmap_count       = to_u32(mipmaps.size());
+	header.offset_layer_count = to_u32(offsets.size());
+	header.offset_level_count = offsets.empty() ? 0 : to_u32(offsets[0].size());
+	header.data_size          = data.size();
+
+	CacheFileWriter writer{CacheMagic, CacheVersion};
+	writer.append(header);
+	writer.append(mipmaps.data(), mipmaps.size() * sizeof(Mipmap));
+	for (auto &layer_offsets : offsets)
+	{
+		assert(layer_offsets.size() == header.offset_level_count && "Every layer has the same levels");
+		writer.append(layer_offsets.data(), layer_offsets.size() * sizeof(VkDeviceSize));
+	}
+	writer.append(data.data(), data.size());
+
+	try
+	{
+		auto file_system = vkb::filesystem::get();
+		file_system->create_directory(cache_directory);
+		file_system->write_file(path, writer.finish());
+	}
+	catch (const std::exception &e)
+	{
+		// The texture is transcoded again next time
+		LOGW("Failed to write transcoded texture {}: {}", path, e.what());
+	}
+}
+
+std::string KtxTranscoder::get_cache_path(uint64_t hash) const
+{
+	return (vkb::filesystem::Path{cache_directory} / fmt::format("{:016x}_{}.bin", hash, target_format)).string();
+}
+}        // namespace sg
+}        // namespace vkb
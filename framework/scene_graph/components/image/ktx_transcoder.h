@@ -0,0 +1,80 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "scene_graph/components/image.h"
+
+namespace vkb
+{
+class PhysicalDevice;
+
+namespace sg
+{
+/**
+ * @brief Loads KTX2 textures, transcoding the Basis Universal ones to a format native to the GPU
+ *
+ * The target format is picked once from the formats the GPU can sample: ASTC 4x4, then BC7,
+ * then ETC2, falling back to uncompressed RGBA. Transcoded textures are written to a disk cache
+ * keyed by the hash of the file contents and the target format, so they are only transcoded
+ * the first time they are loaded.
+ *
+ * Loading is thread safe, textures loaded on several threads are transcoded in parallel.
+ * The levels of zstd supercompressed textures which don't need transcoding are inflated by jobs
+ * still running when the image is returned, see Image::wait_for_levels().
+ */
+class KtxTranscoder
+{
+  public:
+	/**
+	 * @param gpu The physical device the textures are sampled on
+	 * @param cache_directory Directory of the transcoded textures, defaults to a folder of the temporary directory
+	 */
+	explicit KtxTranscoder(const PhysicalDevice &gpu, const std::string &cache_directory = "");
+
+	/**
+	 * @brief Loads a KTX2 texture from memory, from the cache if it was transcoded before
+	 *        Textures which don't need transcoding are loaded as they are, the memory is only read until the call returns.
+	 */
+	std::unique_ptr<Image> load(const std::string &name, const uint8_t *data, size_t size, Image::ContentType content_type) const;
+
+	/**
+	 * @brief Loads a KTX2 texture from an asset file
+	 */
+	std::unique_ptr<Image> load(const std::string &name, const std::string &uri, Image::ContentType content_type) const;
+
+	/**
+	 * @return The Basis Universal transcode target, a ktx_transcode_fmt_e
+	 */
+	uint32_t get_target_format() const;
+
+  private:
+	std::unique_ptr<Image> load_cached(const std::string &name, const std::string &path, uint64_t hash) const;
+
+	void write_cached(const Image &image, const std::string &path, uint64_t hash) const;
+
+	std::string get_cache_path(uint64_t hash) const;
+
+	uint32_t target_format;
+
+	std::string cache_directory;
+};
+}        // namespace sg
+}        // namespace vkb
@@ -25,6 +25,10 @@ namespace vkb
 namespace sg
 {
 Stb::Stb(const std::string &name, const std::vector<uint8_t> &data, ContentType content_type) :
+    Stb{name, data.data(), data.size(), content_type}
+{}
+
+Stb::Stb(const std::string &name, const uint8_t *data, size_t size, ContentType content_type) :
     Image{name}
 {
 	int width;
@@ -32,8 +36,8 @@ Stb::Stb(const std::string &name, const std::vector<uint8_t> &data, ContentType
 	int comp;
 	int req_comp = 4;
 
-	auto data_buffer = reinterpret_cast<const stbi_uc *>(data.data());
-	auto data_size   = static_cast<int>(data.size());
+	auto data_buffer = reinterpret_cast<const stbi_uc *>(data);
+	auto data_size   = static_cast<int>(size);
 
 	auto raw_data = stbi_load_from_memory(data_buffer, data_size, &width, &height, &comp, req_comp);
 
@@ -42,7 +46,10 @@ Stb::Stb(const std::string &name, const std::vector<uint8_t> &data, ContentType
 		throw std::runtime_error{"Failed to load " + name + ": " + stbi_failure_reason()};
 	}
 
-	set_data(raw_data, width * height * req_comp);
+	// Room is reserved for the mip chain, so generate_mipmaps appends to level 0 without moving it
+	auto &image_data = get_mut_data();
+	image_data.reserve(get_required_mipmaps_size({to_u32(width), to_u32(height), 1u}));
+	image_data.assign(raw_data, raw_data + width * height * req_comp);
 	stbi_image_free(raw_data);
 
 	set_format(content_type == Color ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM);
@@ -80,12 +80,20 @@ class Light : public Component
 
 	const LightProperties &get_properties();
 
+	/**
+	 * @brief Returns a counter incremented each time the type or the properties of the light are set,
+	 *        used to detect whether data derived from the light is outdated
+	 */
+	uint32_t get_version() const;
+
   private:
 	Node *node{nullptr};
 
 	LightType light_type;
 
 	LightProperties properties;
+
+	uint32_t version{0};
 };
 
 }        // namespace sg
@@ -17,6 +17,8 @@
 
 #include "material.h"
 
+#include <algorithm>
+
 namespace vkb
 {
 namespace sg
@@ -30,5 +32,44 @@ std::type_index Material::get_type()
 	return typeid(Material);
 }
 
+void Material::set_texture(const std::string &name, Texture *texture)
+{
+	textures[name] = texture;
+
+	auto slot = std::find(material_texture_names.begin(), material_texture_names.end(), name);
+	if (slot != material_texture_names.end())
+	{
+		texture_slots[std::distance(material_texture_names.begin(), slot)] = texture;
+		return;
+	}
+
+	auto other = std::find_if(other_textures.begin(), other_textures.end(), [&name](const std::pair<std::string, Texture *> &other_texture) {
+		return other_texture.first == name;
+	});
+	if (other != other_textures.end())
+	{
+		other->second = texture;
+	}
+	else
+	{
+		other_textures.emplace_back(name, texture);
+	}
+}
+
+Texture *Material::get_texture(MaterialTexture texture) const
+{
+	return texture_slots[static_cast<uint32_t>(texture)];
+}
+
+const std::array<Texture *, MaterialTextureCount> &Material::get_texture_slots() const
+{
+	return texture_slots;
+}
+
+const std::vector<std::pair<std::string, Texture *>> &Material::get_other_textures() const
+{
+	return other_textures;
+}
+
 }        // namespace sg
 }        // namespace vkb
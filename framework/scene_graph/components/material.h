@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 #include <typeinfo>
@@ -48,6 +49,28 @@ enum class AlphaMode
 	Blend
 };
 
+/**
+ * @brief The textures of the metallic roughness model, which materials keep in an array besides their map of textures
+ */
+enum class MaterialTexture : uint32_t
+{
+	BaseColor,
+	MetallicRoughness,
+	Normal,
+	Occlusion,
+	Emissive
+};
+
+constexpr uint32_t MaterialTextureCount = 5;
+
+/// Name of each MaterialTexture, in Material::textures and in the shaders
+inline const std::vector<std::string> material_texture_names = {
+    "base_color_texture",
+    "metallic_roughness_texture",
+    "normal_texture",
+    "occlusion_texture",
+    "emissive_texture"};
+
 class Material : public Component
 {
   public:
@@ -59,8 +82,29 @@ class Material : public Component
 
 	virtual std::type_index get_type() override;
 
+	/// Textures by name, to be set with set_texture so the arrays of the material stay in sync
 	std::unordered_map<std::string, Texture *> textures;
 
+	/**
+	 * @brief Sets a texture of the material, in the slot of its MaterialTexture if its name has one
+	 */
+	void set_texture(const std::string &name, Texture *texture);
+
+	/**
+	 * @return The texture in a slot, null if the material doesn't have it
+	 */
+	Texture *get_texture(MaterialTexture texture) const;
+
+	/**
+	 * @return The texture of each MaterialTexture, null for the ones the material doesn't have
+	 */
+	const std::array<Texture *, MaterialTextureCount> &get_texture_slots() const;
+
+	/**
+	 * @return The textures whose name isn't one of a MaterialTexture, bound by their name
+	 */
+	const std::vector<std::pair<std::string, Texture *>> &get_other_textures() const;
+
 	/// Emissive color of the material
 	glm::vec3 emissive{0.0f, 0.0f, 0.0f};
 
@@ -72,6 +116,11 @@ class Material : public Component
 
 	/// Alpha rendering mode
 	AlphaMode alpha_mode{AlphaMode::Opaque};
+
+  private:
+	std::array<Texture *, MaterialTextureCount> texture_slots{};
+
+	std::vector<std::pair<std::string, Texture *>> other_textures;
 };
 
 }        // namespace sg
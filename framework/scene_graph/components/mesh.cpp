@@ -30,6 +30,16 @@ void Mesh::update_bounds(const std::vector<glm::vec3> &vertex_data, const std::v
 	bounds.update(vertex_data, index_data);
 }
 
+void Mesh::update_bounds(const std::vector<glm::vec3> &vertex_data, const std::vector<uint32_t> &index_data)
+{
+	bounds.update(vertex_data, index_data);
+}
+
+void Mesh::update_bounds(const AABB &submesh_bounds)
+{
+	bounds.update(submesh_bounds);
+}
+
 std::type_index Mesh::get_type()
 {
 	return typeid(Mesh);
@@ -40,6 +40,13 @@ class Mesh : public Component
 
 	void update_bounds(const std::vector<glm::vec3> &vertex_data, const std::vector<uint16_t> &index_data = {});
 
+	void update_bounds(const std::vector<glm::vec3> &vertex_data, const std::vector<uint32_t> &index_data);
+
+	/**
+	 * @brief Grows the bounds of the mesh to contain those of one of its submeshes
+	 */
+	void update_bounds(const AABB &submesh_bounds);
+
 	virtual std::type_index get_type() override;
 
 	const AABB &get_bounds() const;
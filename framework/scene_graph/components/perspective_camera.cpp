@@ -67,7 +67,29 @@ float PerspectiveCamera::get_aspect_ratio()
 	return aspect_ratio;
 }
 
+void PerspectiveCamera::set_jitter(const glm::vec2 &new_jitter)
+{
+	jitter = new_jitter;
+}
+
+const glm::vec2 &PerspectiveCamera::get_jitter() const
+{
+	return jitter;
+}
+
 glm::mat4 PerspectiveCamera::get_projection()
+{
+	glm::mat4 projection = get_unjittered_projection();
+
+	// Divided by the clip w, the negated view z, these shift the coordinates by the jitter after the perspective divide.
+	// vulkan_style_projection() only flips the y scale, so the jitter is also in Vulkan coordinates.
+	projection[2][0] -= jitter.x;
+	projection[2][1] -= jitter.y;
+
+	return projection;
+}
+
+glm::mat4 PerspectiveCamera::get_unjittered_projection() const
 {
 	// Note: Using reversed depth-buffer for increased precision, so Znear and Zfar are flipped
 	return glm::perspective(fov, aspect_ratio, far_plane, near_plane);
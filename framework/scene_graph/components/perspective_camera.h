@@ -56,8 +56,24 @@ class PerspectiveCamera : public Camera
 
 	float get_field_of_view();
 
+	/**
+	 * @brief Offsets the projection by a fraction of a pixel, for the temporal passes accumulating samples across frames
+	 * @param jitter Offset in normalized device coordinates of the Vulkan-style projection, x to the right and y down
+	 */
+	void set_jitter(const glm::vec2 &jitter);
+
+	const glm::vec2 &get_jitter() const;
+
+	/**
+	 * @return The projection with the jitter, see set_jitter()
+	 */
 	virtual glm::mat4 get_projection() override;
 
+	/**
+	 * @return The projection without the jitter, which the motion between frames is measured with
+	 */
+	glm::mat4 get_unjittered_projection() const;
+
   private:
 	/**
 	 * @brief Screen size aspect ratio
@@ -72,6 +88,8 @@ class PerspectiveCamera : public Camera
 	float far_plane{100.0};
 
 	float near_plane{0.1f};
+
+	glm::vec2 jitter{0.0f};
 };
 }        // namespace sg
 }        // namespace vkb
@@ -21,9 +21,9 @@ namespace vkb
 {
 namespace sg
 {
-Sampler::Sampler(const std::string &name, core::Sampler &&vk_sampler) :
+Sampler::Sampler(const std::string &name, const core::Sampler &vk_sampler) :
     Component{name},
-    vk_sampler{std::move(vk_sampler)}
+    vk_sampler{vk_sampler}
 {}
 
 std::type_index Sampler::get_type()
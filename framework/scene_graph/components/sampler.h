@@ -29,10 +29,14 @@ namespace vkb
 {
 namespace sg
 {
+/**
+ * @brief A sampler of the scene, referring to a sampler shared through the resource cache
+ *        The scene samplers with identical states share a Vulkan sampler, see ResourceCache::RequestSampler.
+ */
 class Sampler : public Component
 {
   public:
-	Sampler(const std::string &name, core::Sampler &&vk_sampler);
+	Sampler(const std::string &name, const core::Sampler &vk_sampler);
 
 	Sampler(Sampler &&other) = default;
 
@@ -40,7 +44,7 @@ class Sampler : public Component
 
 	virtual std::type_index get_type() override;
 
-	core::Sampler vk_sampler;
+	const core::Sampler &vk_sampler;
 };
 }        // namespace sg
 }        // namespace vkb
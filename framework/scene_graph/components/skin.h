@@ -0,0 +1,69 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "common/error.h"
+
+#include "common/glm_common.h"
+
+#include "scene_graph/component.h"
+
+namespace vkb
+{
+namespace sg
+{
+class Node;
+
+/**
+ * @brief Joints deforming the meshes of the nodes it is attached to, as a glTF skin
+ *
+ * The vertices of a skinned mesh are moved by the weighted matrices of the joints they reference,
+ * each being the world matrix of the joint node times its inverse bind matrix. See SkinningPass.
+ */
+class Skin : public Component
+{
+  public:
+	Skin(const std::string &name);
+
+	Skin(Skin &&other) = default;
+
+	virtual ~Skin() = default;
+
+	virtual std::type_index get_type() override;
+
+	/**
+	 * @param joint Node of the joint
+	 * @param inverse_bind_matrix Transforms the mesh from its bind pose into the space of the joint
+	 */
+	void add_joint(Node &joint, const glm::mat4 &inverse_bind_matrix);
+
+	const std::vector<Node *> &get_joints() const;
+
+	const std::vector<glm::mat4> &get_inverse_bind_matrices() const;
+
+  private:
+	std::vector<Node *> joints;
+
+	std::vector<glm::mat4> inverse_bind_matrices;
+};
+}        // namespace sg
+}        // namespace vkb
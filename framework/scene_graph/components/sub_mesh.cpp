@@ -92,6 +92,19 @@ void SubMesh::compute_shader_variant()
 		std::transform(attrib_name.begin(), attrib_name.end(), attrib_name.begin(), ::toupper);
 		shader_variant.add_define("HAS_" + attrib_name);
 	}
+
+	// The packed formats the vertex input can't decode on its own
+	auto position = vertex_attributes.find("position");
+	if (position != vertex_attributes.end() && position->second.format == VK_FORMAT_R16G16B16A16_UNORM)
+	{
+		shader_variant.add_define("PACKED_POSITION");
+	}
+
+	auto normal = vertex_attributes.find("normal");
+	if (normal != vertex_attributes.end() && normal->second.format == VK_FORMAT_R16G16_SNORM)
+	{
+		shader_variant.add_define("PACKED_NORMAL");
+	}
 }
 
 ShaderVariant &SubMesh::get_mut_shader_variant()
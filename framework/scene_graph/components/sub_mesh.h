@@ -23,9 +23,11 @@
 #include <unordered_map>
 #include <vector>
 
+#include "common/glm_common.h"
 #include "common/vk_common.h"
 #include "core/buffer.h"
 #include "core/shader_module.h"
+#include "geometry/lod.h"
 #include "scene_graph/component.h"
 
 namespace vkb
@@ -64,6 +66,24 @@ class SubMesh : public Component
 
 	std::unique_ptr<vkb::core::BufferC> index_buffer;
 
+	/// Bounds the positions are normalized in when packed to VK_FORMAT_R16G16B16A16_UNORM, the shaders rebuild them as offset + position * scale
+	glm::vec3 position_offset{0.0f};
+
+	glm::vec3 position_scale{1.0f};
+
+	/// Levels of detail in index_buffer, the full mesh first, empty if none were generated
+	std::vector<LevelOfDetail> lods;
+
+	/// Number of meshlets in meshlet_buffer, zero if none were built
+	std::uint32_t meshlet_count = 0;
+
+	/// The mesh_optimizer::Meshlet array, with the meshlet vertex and triangle lists it indexes into
+	std::unique_ptr<vkb::core::BufferC> meshlet_buffer;
+
+	std::unique_ptr<vkb::core::BufferC> meshlet_vertex_buffer;
+
+	std::unique_ptr<vkb::core::BufferC> meshlet_triangle_buffer;
+
 	void set_attribute(const std::string &name, const VertexAttribute &attribute);
 
 	bool get_attribute(const std::string &name, VertexAttribute &attribute) const;
@@ -21,6 +21,7 @@
 #include <glm/gtx/matrix_decompose.hpp>
 
 #include "scene_graph/node.h"
+#include "scene_graph/transform_store.h"
 
 namespace vkb
 {
@@ -43,6 +44,12 @@ std::type_index Transform::get_type()
 
 void Transform::set_translation(const glm::vec3 &new_translation)
 {
+	if (store)
+	{
+		store->set_translation(store_index, new_translation);
+		return;
+	}
+
 	translation = new_translation;
 
 	invalidate_world_matrix();
@@ -50,6 +57,12 @@ void Transform::set_translation(const glm::vec3 &new_translation)
 
 void Transform::set_rotation(const glm::quat &new_rotation)
 {
+	if (store)
+	{
+		store->set_rotation(store_index, new_rotation);
+		return;
+	}
+
 	rotation = new_rotation;
 
 	invalidate_world_matrix();
@@ -57,6 +70,12 @@ void Transform::set_rotation(const glm::quat &new_rotation)
 
 void Transform::set_scale(const glm::vec3 &new_scale)
 {
+	if (store)
+	{
+		store->set_scale(store_index, new_scale);
+		return;
+	}
+
 	scale = new_scale;
 
 	invalidate_world_matrix();
@@ -64,47 +83,90 @@ void Transform::set_scale(const glm::vec3 &new_scale)
 
 const glm::vec3 &Transform::get_translation() const
 {
-	return translation;
+	return store ? store->get_translation(store_index) : translation;
 }
 
 const glm::quat &Transform::get_rotation() const
 {
-	return rotation;
+	return store ? store->get_rotation(store_index) : rotation;
 }
 
 const glm::vec3 &Transform::get_scale() const
 {
-	return scale;
+	return store ? store->get_scale(store_index) : scale;
 }
 
 void Transform::set_matrix(const glm::mat4 &matrix)
 {
+	glm::vec3 new_scale;
+	glm::quat new_rotation;
+	glm::vec3 new_translation;
 	glm::vec3 skew;
 	glm::vec4 perspective;
-	glm::decompose(matrix, scale, rotation, translation, skew, perspective);
+	glm::decompose(matrix, new_scale, new_rotation, new_translation, skew, perspective);
 
-	invalidate_world_matrix();
+	set_translation(new_translation);
+	set_rotation(new_rotation);
+	set_scale(new_scale);
 }
 
 glm::mat4 Transform::get_matrix() const
 {
-	return glm::translate(glm::mat4(1.0), translation) *
-	       glm::mat4_cast(rotation) *
-	       glm::scale(glm::mat4(1.0), scale);
+	return glm::translate(glm::mat4(1.0), get_translation()) *
+	       glm::mat4_cast(get_rotation()) *
+	       glm::scale(glm::mat4(1.0), get_scale());
 }
 
 glm::mat4 Transform::get_world_matrix()
 {
+	if (store)
+	{
+		return store->get_world_matrix(store_index);
+	}
+
 	update_world_transform();
 
 	return world_matrix;
 }
 
+uint32_t Transform::get_world_matrix_version()
+{
+	if (store)
+	{
+		return store->get_world_matrix_version(store_index);
+	}
+
+	update_world_transform();
+
+	return world_matrix_version;
+}
+
 void Transform::invalidate_world_matrix()
 {
+	if (store)
+	{
+		store->invalidate(store_index);
+		return;
+	}
+
 	update_world_matrix = true;
 }
 
+void Transform::invalidate_hierarchy()
+{
+	if (store)
+	{
+		store->invalidate_hierarchy();
+	}
+
+	invalidate_world_matrix();
+}
+
+bool Transform::is_in_store() const
+{
+	return store != nullptr;
+}
+
 void Transform::update_world_transform()
 {
 	if (!update_world_matrix)
@@ -123,6 +185,8 @@ void Transform::update_world_transform()
 	}
 
 	update_world_matrix = false;
+
+	++world_matrix_version;
 }
 
 }        // namespace sg
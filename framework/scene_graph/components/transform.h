@@ -34,7 +34,15 @@ namespace vkb
 namespace sg
 {
 class Node;
+class TransformStore;
 
+/**
+ * @brief Local transform of a node and its world matrix
+ *
+ * Once the transform store of the scene is built the transform is a handle into it,
+ * reading and writing the local transform and the world matrix there. Otherwise the
+ * world matrix is computed lazily from the parent's.
+ */
 class Transform : public Component
 {
   public:
@@ -64,6 +72,12 @@ class Transform : public Component
 
 	glm::mat4 get_world_matrix();
 
+	/**
+	 * @brief Returns a counter incremented each time the world matrix is recomputed,
+	 *        used to detect whether data derived from the world matrix is outdated
+	 */
+	uint32_t get_world_matrix_version();
+
 	/**
 	 * @brief Marks the world transform invalid if any of
 	 *        the local transform are changed or the parent
@@ -71,9 +85,26 @@ class Transform : public Component
 	 */
 	void invalidate_world_matrix();
 
+	/**
+	 * @brief Called when the node gets a new parent or child, the store the transform belongs to is rebuilt
+	 */
+	void invalidate_hierarchy();
+
+	/**
+	 * @return Whether the transform is a handle into a transform store, its setters then only write its entries in the store
+	 */
+	bool is_in_store() const;
+
   private:
+	friend class TransformStore;
+
 	Node &node;
 
+	/// Store holding the transform, null if not built yet
+	TransformStore *store{nullptr};
+
+	uint32_t store_index{0};
+
 	glm::vec3 translation = glm::vec3(0.0, 0.0, 0.0);
 
 	glm::quat rotation = glm::quat(1.0, 0.0, 0.0, 0.0);
@@ -84,6 +115,8 @@ class Transform : public Component
 
 	bool update_world_matrix = false;
 
+	uint32_t world_matrix_version = 0;
+
 	void update_world_transform();
 };
 
@@ -35,6 +35,8 @@ namespace scene_graph
 class HPPScene : private vkb::sg::Scene
 {
   public:
+	using vkb::sg::Scene::update_transforms;
+
 	template <class T>
 	std::vector<T *> get_components() const
 	{
@@ -55,6 +57,21 @@ class HPPScene : private vkb::sg::Scene
 		}
 	}
 
+	template <class T>
+	vkb::sg::ComponentView<T> get_component_view() const
+	{
+		if constexpr (std::is_same<T, vkb::sg::Animation>::value || std::is_same<T, vkb::sg::Camera>::value || std::is_same<T, vkb::sg::Script>::value ||
+		              std::is_same<T, vkb::sg::SubMesh>::value || std::is_same<T, vkb::sg::Texture>::value || std::is_same<T, vkb::sg::Light>::value)
+		{
+			return vkb::sg::Scene::get_component_view<T>();
+		}
+		else
+		{
+			assert(false);        // path never passed -> Please add a type-check here!
+			return {};
+		}
+	}
+
 	template <class T>
 	bool has_component() const
 	{
@@ -17,7 +17,12 @@
 
 #include "node.h"
 
+#include <algorithm>
+
 #include "component.h"
+#include "components/camera.h"
+#include "components/light.h"
+#include "components/mesh.h"
 #include "components/transform.h"
 
 namespace vkb
@@ -46,7 +51,7 @@ void Node::set_parent(Node &p)
 {
 	parent = &p;
 
-	transform.invalidate_world_matrix();
+	transform.invalidate_hierarchy();
 }
 
 Node *Node::get_parent() const
@@ -57,6 +62,22 @@ Node *Node::get_parent() const
 void Node::add_child(Node &child)
 {
 	children.push_back(&child);
+
+	transform.invalidate_hierarchy();
+}
+
+void Node::remove_child(Node &child)
+{
+	auto it = std::find(children.begin(), children.end(), &child);
+	if (it == children.end())
+	{
+		return;
+	}
+
+	children.erase(it);
+	child.parent = nullptr;
+
+	transform.invalidate_hierarchy();
 }
 
 const std::vector<Node *> &Node::get_children() const
@@ -76,6 +97,12 @@ void Node::set_component(Component &component)
 	{
 		components.insert(std::make_pair(component.get_type(), &component));
 	}
+
+	auto slot = get_slot(component.get_type());
+	if (slot != SlotCount)
+	{
+		slots[slot] = &component;
+	}
 }
 
 Component &Node::get_component(const std::type_index index)
@@ -88,5 +115,26 @@ bool Node::has_component(const std::type_index index)
 	return components.count(index) > 0;
 }
 
+size_t Node::get_slot(const std::type_index index)
+{
+	if (index == typeid(Transform))
+	{
+		return TransformSlot;
+	}
+	else if (index == typeid(Mesh))
+	{
+		return MeshSlot;
+	}
+	else if (index == typeid(Camera))
+	{
+		return CameraSlot;
+	}
+	else if (index == typeid(Light))
+	{
+		return LightSlot;
+	}
+	return SlotCount;
+}
+
 }        // namespace sg
 }        // namespace vkb
@@ -17,8 +17,10 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
 #include <vector>
@@ -29,7 +31,10 @@ namespace vkb
 {
 namespace sg
 {
+class Camera;
 class Component;
+class Light;
+class Mesh;
 
 /// @brief A leaf of the tree structure which can have children and a single parent.
 class Node
@@ -54,13 +59,29 @@ class Node
 
 	void add_child(Node &child);
 
+	/**
+	 * @brief Removes a child of the node, which is left without a parent
+	 */
+	void remove_child(Node &child);
+
 	const std::vector<Node *> &get_children() const;
 
 	void set_component(Component &component);
 
+	/**
+	 * @brief Returns the component of a type, the transforms, meshes, cameras and lights are read from a slot of their own
+	 *        instead of the map, so drawing doesn't hash their type
+	 */
 	template <class T>
 	inline T &get_component()
 	{
+		if constexpr (get_slot<T>() != SlotCount)
+		{
+			if (auto *component = slots[get_slot<T>()])
+			{
+				return static_cast<T &>(*component);
+			}
+		}
 		return dynamic_cast<T &>(get_component(typeid(T)));
 	}
 
@@ -69,12 +90,59 @@ class Node
 	template <class T>
 	bool has_component()
 	{
-		return has_component(typeid(T));
+		if constexpr (get_slot<T>() != SlotCount)
+		{
+			return slots[get_slot<T>()] != nullptr;
+		}
+		else
+		{
+			return has_component(typeid(T));
+		}
 	}
 
 	bool has_component(const std::type_index index);
 
   private:
+	/// The component types with a slot
+	enum ComponentSlot : size_t
+	{
+		TransformSlot,
+		MeshSlot,
+		CameraSlot,
+		LightSlot,
+		SlotCount
+	};
+
+	/**
+	 * @return The slot of a component type, SlotCount if it is only stored in the map
+	 */
+	template <class T>
+	static constexpr size_t get_slot()
+	{
+		if constexpr (std::is_same_v<T, Transform>)
+		{
+			return TransformSlot;
+		}
+		else if constexpr (std::is_same_v<T, Mesh>)
+		{
+			return MeshSlot;
+		}
+		else if constexpr (std::is_same_v<T, Camera>)
+		{
+			return CameraSlot;
+		}
+		else if constexpr (std::is_same_v<T, Light>)
+		{
+			return LightSlot;
+		}
+		else
+		{
+			return SlotCount;
+		}
+	}
+
+	static size_t get_slot(const std::type_index index);
+
 	size_t id;
 
 	std::string name;
@@ -86,6 +154,9 @@ class Node
 	std::vector<Node *> children;
 
 	std::unordered_map<std::type_index, Component *> components;
+
+	/// The components of the types with a slot, also kept in the map
+	std::array<Component *, SlotCount> slots{};
 };
 }        // namespace sg
 }        // namespace vkb
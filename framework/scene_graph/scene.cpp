@@ -17,7 +17,7 @@
 
 #include "scene.h"
 
-#include <queue>
+#include <iterator>
 
 #include "component.h"
 #include "components/sub_mesh.h"
@@ -45,16 +45,130 @@ void Scene::set_nodes(std::vector<std::unique_ptr<Node>> &&n)
 {
 	assert(nodes.empty() && "Scene nodes were already set");
 	nodes = std::move(n);
+
+	for (auto &node : nodes)
+	{
+		index_node(*node);
+	}
+
+	transform_store->invalidate_hierarchy();
 }
 
 void Scene::add_node(std::unique_ptr<Node> &&n)
 {
+	index_node(*n);
+
 	nodes.emplace_back(std::move(n));
+
+	transform_store->invalidate_hierarchy();
 }
 
 void Scene::add_child(Node &child)
 {
 	root->add_child(child);
+
+	transform_store->invalidate_hierarchy();
+}
+
+Node &Scene::attach(std::unique_ptr<Scene> &&other)
+{
+	assert(other && other->root && "Only scenes with a root node can be attached");
+
+	// The transforms are bound to the store of the other scene, which is destroyed with it
+	other->transform_store->release();
+
+	Node &other_root = *other->root;
+
+	auto &attachment = attachments[&other_root];
+
+	for (auto &node : other->nodes)
+	{
+		attachment.nodes.insert(node.get());
+		index_node(*node);
+		nodes.push_back(std::move(node));
+	}
+
+	for (auto &[type, type_components] : other->components)
+	{
+		auto &scene_components = components[type];
+		for (auto &component : type_components)
+		{
+			attachment.components.insert(component.get());
+			scene_components.push_back(std::move(component));
+		}
+	}
+
+	assert(attachment.nodes.count(&other_root) && "The attached scene must own its root node");
+
+	other->nodes.clear();
+	other->components.clear();
+	other->root = nullptr;
+
+	other_root.set_parent(*root);
+	root->add_child(other_root);
+
+	transform_store->invalidate_hierarchy();
+
+	++version;
+
+	return other_root;
+}
+
+std::unique_ptr<Scene> Scene::detach(Node &other_root)
+{
+	auto it = attachments.find(&other_root);
+	assert(it != attachments.end() && "Only attached scenes can be detached");
+
+	auto &attachment = it->second;
+
+	// The store holds the transforms of the detached nodes until it is rebuilt
+	transform_store->release();
+
+	auto scene = std::make_unique<Scene>(other_root.get_name());
+
+	auto node_it = std::stable_partition(nodes.begin(), nodes.end(), [&attachment](const std::unique_ptr<Node> &node) {
+		return attachment.nodes.count(node.get()) == 0;
+	});
+
+	for (auto detached_it = node_it; detached_it != nodes.end(); ++detached_it)
+	{
+		unindex_node(**detached_it);
+		scene->nodes.push_back(std::move(*detached_it));
+	}
+	nodes.erase(node_it, nodes.end());
+
+	for (auto &[type, type_components] : components)
+	{
+		auto component_it = std::stable_partition(type_components.begin(), type_components.end(), [&attachment](const std::unique_ptr<Component> &component) {
+			return attachment.components.count(component.get()) == 0;
+		});
+
+		if (component_it == type_components.end())
+		{
+			continue;
+		}
+
+		auto &detached_components = scene->components[type];
+		std::move(component_it, type_components.end(), std::back_inserter(detached_components));
+		type_components.erase(component_it, type_components.end());
+	}
+
+	root->remove_child(other_root);
+
+	scene->set_root_node(other_root);
+
+	attachments.erase(it);
+
+	transform_store->invalidate_hierarchy();
+
+	++version;
+
+	return scene;
+}
+
+uint64_t Scene::get_version() const
+{
+	return version;
 }
 
 std::unique_ptr<Component> Scene::get_model(uint32_t index)
@@ -101,39 +215,65 @@ bool Scene::has_component(const std::type_index &type_info) const
 
 Node *Scene::find_node(const std::string &node_name)
 {
-	for (auto root_node : root->get_children())
-	{
-		std::queue<sg::Node *> traverse_nodes{};
-		traverse_nodes.push(root_node);
-
-		while (!traverse_nodes.empty())
-		{
-			auto node = traverse_nodes.front();
-			traverse_nodes.pop();
-
-			if (node->get_name() == node_name)
-			{
-				return node;
-			}
-
-			for (auto child_node : node->get_children())
-			{
-				traverse_nodes.push(child_node);
-			}
-		}
-	}
+	auto it = nodes_by_name.find(node_name);
+	return it != nodes_by_name.end() ? it->second : nullptr;
+}
 
-	return nullptr;
+Node *Scene::find_node_by_id(size_t id)
+{
+	auto it = nodes_by_id.find(id);
+	return it != nodes_by_id.end() ? it->second : nullptr;
 }
 
 void Scene::set_root_node(Node &node)
 {
 	root = &node;
+
+	// The root was not part of the search before the indices either
+	unindex_node(node);
+
+	transform_store->set_root(node);
 }
 
 Node &Scene::get_root_node()
 {
 	return *root;
 }
+
+void Scene::update_transforms(JobSystem *jobs)
+{
+	transform_store->update(jobs);
+}
+
+TransformStore &Scene::get_transform_store()
+{
+	return *transform_store;
+}
+
+void Scene::index_node(Node &node)
+{
+	if (&node == root)
+	{
+		return;
+	}
+
+	nodes_by_name.emplace(node.get_name(), &node);
+	nodes_by_id.emplace(node.get_id(), &node);
+}
+
+void Scene::unindex_node(Node &node)
+{
+	auto name_it = nodes_by_name.find(node.get_name());
+	if (name_it != nodes_by_name.end() && name_it->second == &node)
+	{
+		nodes_by_name.erase(name_it);
+	}
+
+	auto id_it = nodes_by_id.find(node.get_id());
+	if (id_it != nodes_by_id.end() && id_it->second == &node)
+	{
+		nodes_by_id.erase(id_it);
+	}
+}
 }        // namespace sg
 }        // namespace vkb
\ No newline at end of file
@@ -22,10 +22,13 @@
 #include <string>
 #include <typeindex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "scene_graph/component_view.h"
 #include "scene_graph/components/light.h"
 #include "scene_graph/components/texture.h"
+#include "scene_graph/transform_store.h"
 
 namespace vkb
 {
@@ -54,6 +57,29 @@ class Scene
 
 	void add_child(Node &child);
 
+	/**
+	 * @brief Moves the nodes and components of another scene into this one, its root becoming a child of the root of this scene
+	 *        Used to stream parts of a world in and out, see SceneStreamer. Increments the version of the scene.
+	 * @param other The scene to attach, owning its root node like the scenes of GLTFLoader, emptied and destroyed
+	 * @return The root node of the attached scene, which identifies it to detach()
+	 */
+	Node &attach(std::unique_ptr<Scene> &&other);
+
+	/**
+	 * @brief Moves the nodes and components of an attached scene back into a scene of their own
+	 *        Increments the version of the scene. The GPU may still be reading the resources of the detached scene,
+	 *        so it should be retired to the DeferredDestructionQueue of the device rather than destroyed.
+	 * @param root The root node returned by attach()
+	 * @return The detached scene
+	 */
+	std::unique_ptr<Scene> detach(Node &root);
+
+	/**
+	 * @return Number of times scenes were attached or detached, the subpasses caching the components of the scene
+	 *         refresh them when it changes
+	 */
+	uint64_t get_version() const;
+
 	std::unique_ptr<Component> get_model(uint32_t index = 0);
 
 	void add_component(std::unique_ptr<Component> &&component);
@@ -111,6 +137,22 @@ class Scene
 		return result;
 	}
 
+	/**
+	 * @return View of the components of the given template type, iterating them in place without allocating
+	 *         It stays valid until components of that type are added or replaced.
+	 */
+	template <class T>
+	ComponentView<T> get_component_view() const
+	{
+		auto it = components.find(typeid(T));
+		if (it == components.end())
+		{
+			return {};
+		}
+
+		return {it->second.data(), it->second.size()};
+	}
+
 	/**
 	 * @return List of components for the given type
 	 */
@@ -124,13 +166,50 @@ class Scene
 
 	bool has_component(const std::type_index &type_info) const;
 
+	/**
+	 * @brief Looks up a node of the scene by name in constant time, the root node excluded
+	 * @return The first node added with that name, or nullptr if there is none
+	 */
 	Node *find_node(const std::string &name);
 
+	/**
+	 * @brief Looks up a node of the scene by id in constant time, the root node excluded
+	 * @return The first node added with that id, or nullptr if there is none
+	 */
+	Node *find_node_by_id(size_t id);
+
 	void set_root_node(Node &node);
 
 	Node &get_root_node();
 
+	/**
+	 * @brief Updates the world matrices of the nodes whose transform or ancestors changed since the last update,
+	 *        building the transform store first if the hierarchy changed. Called once per frame before drawing.
+	 * @param jobs Optional job system splitting the update of large scenes across its workers
+	 */
+	void update_transforms(JobSystem *jobs = nullptr);
+
+	TransformStore &get_transform_store();
+
   private:
+	/**
+	 * @brief Adds a node to the name and id indices, keeping the first node added for a given key
+	 */
+	void index_node(Node &node);
+
+	/**
+	 * @brief Removes a node from the name and id indices, if it is the one indexed for its keys
+	 */
+	void unindex_node(Node &node);
+
+	/// Nodes and components of a scene attached to this one
+	struct Attachment
+	{
+		std::unordered_set<Node *> nodes;
+
+		std::unordered_set<Component *> components;
+	};
+
 	std::string name;
 
 	/// List of all the nodes
@@ -138,7 +217,19 @@ class Scene
 
 	Node *root{nullptr};
 
+	std::unordered_map<std::string, Node *> nodes_by_name;
+
+	std::unordered_map<size_t, Node *> nodes_by_id;
+
 	std::unordered_map<std::type_index, std::vector<std::unique_ptr<Component>>> components;
+
+	/// Attached scenes by their root node
+	std::unordered_map<Node *, Attachment> attachments;
+
+	uint64_t version{0};
+
+	/// Declared after the nodes, so it is destroyed first
+	std::unique_ptr<TransformStore> transform_store{std::make_unique<TransformStore>()};
 };
 }        // namespace sg
 }        // namespace vkb
\ No newline at end of file
@@ -17,6 +17,10 @@
 
 #include "animation.h"
 
+#include <algorithm>
+#include <numeric>
+
+#include "core/util/job_system.hpp"
 #include "scene_graph/node.h"
 
 namespace vkb
@@ -39,6 +43,11 @@ void Animation::add_channel(Node &node, const AnimationTarget &target, const Ani
 }
 
 void Animation::update(float delta_time)
+{
+	update(delta_time, nullptr);
+}
+
+void Animation::update(float delta_time, JobSystem *jobs)
 {
 	current_time += delta_time;
 	if (current_time > end_time)
@@ -46,123 +55,205 @@ void Animation::update(float delta_time)
 		current_time -= end_time;
 	}
 
-	for (auto &channel : channels)
+	if (channel_order.size() != channels.size())
 	{
-		for (size_t i = 0; i < channel.sampler.inputs.size() - 1; ++i)
+		build_node_groups();
+	}
+
+	bool parallel = jobs && channels.size() >= ParallelThreshold;
+
+	// Transforms outside of the store invalidate their children, which other threads may be writing
+	parallel = parallel && std::all_of(channels.begin(), channels.end(), [](AnimationChannel &channel) {
+		           return channel.node.get_transform().is_in_store();
+	           });
+
+	if (!parallel)
+	{
+		for (auto &channel : channels)
+		{
+			evaluate_channel(channel, current_time);
+		}
+		return;
+	}
+
+	// The channels of a node are evaluated by the same job, as they write the same transform
+	size_t group_count = node_group_starts.size() - 1;
+	jobs->parallel_for(group_count, 1, [this](size_t first_group, size_t last_group) {
+		for (size_t i = node_group_starts[first_group]; i < node_group_starts[last_group]; ++i)
 		{
-			if ((current_time >= channel.sampler.inputs[i]) && (current_time <= channel.sampler.inputs[i + 1]))
+			evaluate_channel(channels[channel_order[i]], current_time);
+		}
+	});
+}
+
+bool Animation::find_keyframe(AnimationChannel &channel, float time, size_t &index)
+{
+	auto &inputs = channel.sampler.inputs;
+
+	if (inputs.size() < 2 || time < inputs.front() || time > inputs.back())
+	{
+		return false;
+	}
+
+	size_t cursor = channel.cursor;
+
+	if (cursor + 1 < inputs.size() && inputs[cursor] <= time && time < inputs[cursor + 1])
+	{
+		index = cursor;
+	}
+	else if (cursor + 2 < inputs.size() && inputs[cursor + 1] <= time && time < inputs[cursor + 2])
+	{
+		index = cursor + 1;
+	}
+	else
+	{
+		// The animation looped or jumped, the last interval also holds the last input
+		size_t next = std::upper_bound(inputs.begin(), inputs.end(), time) - inputs.begin();
+		index       = std::min(next, inputs.size() - 1) - 1;
+	}
+
+	channel.cursor = index;
+
+	return true;
+}
+
+void Animation::evaluate_channel(AnimationChannel &channel, float animation_time)
+{
+	size_t i;
+	if (!find_keyframe(channel, animation_time, i))
+	{
+		return;
+	}
+
+	float time = (animation_time - channel.sampler.inputs[i]) / (channel.sampler.inputs[i + 1] - channel.sampler.inputs[i]);
+
+	auto &transform = channel.node.get_transform();
+
+	if (channel.sampler.type == AnimationType::Linear)
+	{
+		switch (channel.target)
+		{
+			case Translation:
 			{
-				float time = (current_time - channel.sampler.inputs[i]) / (channel.sampler.inputs[i + 1] - channel.sampler.inputs[i]);
-
-				auto &transform = channel.node.get_transform();
-
-				if (channel.sampler.type == AnimationType::Linear)
-				{
-					switch (channel.target)
-					{
-						case Translation:
-						{
-							transform.set_translation(glm::vec3(glm::mix(channel.sampler.outputs[i],
-							                                             channel.sampler.outputs[i + 1],
-							                                             time)));
-							break;
-						}
-						case Rotation:
-						{
-							glm::quat q1;
-							q1.x = channel.sampler.outputs[i].x;
-							q1.y = channel.sampler.outputs[i].y;
-							q1.z = channel.sampler.outputs[i].z;
-							q1.w = channel.sampler.outputs[i].w;
-
-							glm::quat q2;
-							q2.x = channel.sampler.outputs[i + 1].x;
-							q2.y = channel.sampler.outputs[i + 1].y;
-							q2.z = channel.sampler.outputs[i + 1].z;
-							q2.w = channel.sampler.outputs[i + 1].w;
-
-							transform.set_rotation(glm::normalize(glm::slerp(q1, q2, time)));
-							break;
-						}
-
-						case Scale:
-						{
-							transform.set_scale(glm::vec3(glm::mix(channel.sampler.outputs[i],
-							                                       channel.sampler.outputs[i + 1],
-							                                       time)));
-						}
-					}
-				}
-				else if (channel.sampler.type == AnimationType::Step)
-				{
-					switch (channel.target)
-					{
-						case Translation:
-						{
-							transform.set_translation(glm::vec3(channel.sampler.outputs[i]));
-							break;
-						}
-						case Rotation:
-						{
-							glm::quat q1;
-							q1.x = channel.sampler.outputs[i].x;
-							q1.y = channel.sampler.outputs[i].y;
-							q1.z = channel.sampler.outputs[i].z;
-							q1.w = channel.sampler.outputs[i].w;
-
-							transform.set_rotation(glm::normalize(q1));
-							break;
-						}
-
-						case Scale:
-						{
-							transform.set_scale(glm::vec3(channel.sampler.outputs[i]));
-						}
-					}
-				}
-				else if (channel.sampler.type == AnimationType::CubicSpline)
-				{
-					float delta = channel.sampler.inputs[i + 1] - channel.sampler.inputs[i];
-
-					glm::vec4 p0 = channel.sampler.outputs[i * 3 + 1];              // Starting point
-					glm::vec4 p1 = channel.sampler.outputs[(i + 1) * 3 + 1];        // Ending point
-
-					glm::vec4 m0 = delta * channel.sampler.outputs[i * 3 + 2];              // Delta time * out tangent
-					glm::vec4 m1 = delta * channel.sampler.outputs[(i + 1) * 3 + 0];        // Delta time * in tangent of next point
-
-					// This equation is taken from the GLTF 2.0 specification Appendix C (https://github.com/KhronosGroup/glTF/tree/main/specification/2.0#appendix-c-spline-interpolation)
-					glm::vec4 result = (2.0f * glm::pow(time, 3.0f) - 3.0f * glm::pow(time, 2.0f) + 1.0f) * p0 + (glm::pow(time, 3.0f) - 2.0f * glm::pow(time, 2.0f) + time) * m0 + (-2.0f * glm::pow(time, 3.0f) + 3.0f * glm::pow(time, 2.0f)) * p1 + (glm::pow(time, 3.0f) - glm::pow(time, 2.0f)) * m1;
-
-					auto &transform = channel.node.get_transform();
-
-					switch (channel.target)
-					{
-						case Translation:
-						{
-							transform.set_translation(glm::vec3(result));
-							break;
-						}
-						case Rotation:
-						{
-							glm::quat q1;
-							q1.x = result.x;
-							q1.y = result.y;
-							q1.z = result.z;
-							q1.w = result.w;
-
-							transform.set_rotation(glm::normalize(q1));
-							break;
-						}
-
-						case Scale:
-						{
-							transform.set_scale(glm::vec3(result));
-						}
-					}
-				}
+				transform.set_translation(glm::vec3(glm::mix(channel.sampler.outputs[i],
+				                                             channel.sampler.outputs[i + 1],
+				                                             time)));
+				break;
 			}
+			case Rotation:
+			{
+				glm::quat q1;
+				q1.x = channel.sampler.outputs[i].x;
+				q1.y = channel.sampler.outputs[i].y;
+				q1.z = channel.sampler.outputs[i].z;
+				q1.w = channel.sampler.outputs[i].w;
+
+				glm::quat q2;
+				q2.x = channel.sampler.outputs[i + 1].x;
+				q2.y = channel.sampler.outputs[i + 1].y;
+				q2.z = channel.sampler.outputs[i + 1].z;
+				q2.w = channel.sampler.outputs[i + 1].w;
+
+				transform.set_rotation(glm::normalize(glm::slerp(q1, q2, time)));
+				break;
+			}
+
+			case Scale:
+			{
+				transform.set_scale(glm::vec3(glm::mix(channel.sampler.outputs[i],
+				                                       channel.sampler.outputs[i + 1],
+				                                       time)));
+			}
+		}
+	}
+	else if (channel.sampler.type == AnimationType::Step)
+	{
+		switch (channel.target)
+		{
+			case Translation:
+			{
+				transform.set_translation(glm::vec3(channel.sampler.outputs[i]));
+				break;
+			}
+			case Rotation:
+			{
+				glm::quat q1;
+				q1.x = channel.sampler.outputs[i].x;
+				q1.y = channel.sampler.outputs[i].y;
+				q1.z = channel.sampler.outputs[i].z;
+				q1.w = channel.sampler.outputs[i].w;
+
+				transform.set_rotation(glm::normalize(q1));
+				break;
+			}
+
+			case Scale:
+			{
+				transform.set_scale(glm::vec3(channel.sampler.outputs[i]));
+			}
+		}
+	}
+	else if (channel.sampler.type == AnimationType::CubicSpline)
+	{
+		float delta = channel.sampler.inputs[i + 1] - channel.sampler.inputs[i];
+
+		glm::vec4 p0 = channel.sampler.outputs[i * 3 + 1];              // Starting point
+		glm::vec4 p1 = channel.sampler.outputs[(i + 1) * 3 + 1];        // Ending point
+
+		glm::vec4 m0 = delta * channel.sampler.outputs[i * 3 + 2];              // Delta time * out tangent
+		glm::vec4 m1 = delta * channel.sampler.outputs[(i + 1) * 3 + 0];        // Delta time * in tangent of next point
+
+		// This equation is taken from the GLTF 2.0 specification Appendix C (https://github.com/KhronosGroup/glTF/tree/main/specification/2.0#appendix-c-spline-interpolation)
+		glm::vec4 result = (2.0f * glm::pow(time, 3.0f) - 3.0f * glm::pow(time, 2.0f) + 1.0f) * p0 + (glm::pow(time, 3.0f) - 2.0f * glm::pow(time, 2.0f) + time) * m0 + (-2.0f * glm::pow(time, 3.0f) + 3.0f * glm::pow(time, 2.0f)) * p1 + (glm::pow(time, 3.0f) - glm::pow(time, 2.0f)) * m1;
+
+		auto &transform = channel.node.get_transform();
+
+		switch (channel.target)
+		{
+			case Translation:
+			{
+				transform.set_translation(glm::vec3(result));
+				break;
+			}
+			case Rotation:
+			{
+				glm::quat q1;
+				q1.x = result.x;
+				q1.y = result.y;
+				q1.z = result.z;
+				q1.w = result.w;
+
+				transform.set_rotation(glm::normalize(q1));
+				break;
+			}
+
+			case Scale:
+			{
+				transform.set_scale(glm::vec3(result));
+			}
+		}
+	}
+}
+
+void Animation::build_node_groups()
+{
+	channel_order.resize(channels.size());
+	std::iota(channel_order.begin(), channel_order.end(), 0);
+
+	// Stable, so the channels of a node keep being evaluated in the order they were added
+	std::stable_sort(channel_order.begin(), channel_order.end(), [this](size_t lhs, size_t rhs) {
+		return std::less<Node *>{}(&channels[lhs].node, &channels[rhs].node);
+	});
+
+	node_group_starts.clear();
+	for (size_t i = 0; i < channel_order.size(); ++i)
+	{
+		if (i == 0 || &channels[channel_order[i]].node != &channels[channel_order[i - 1]].node)
+		{
+			node_group_starts.push_back(i);
 		}
 	}
+	node_group_starts.push_back(channel_order.size());
 }
 
 void Animation::update_times(float new_start_time, float new_end_time)
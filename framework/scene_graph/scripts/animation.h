@@ -28,6 +28,8 @@
 
 namespace vkb
 {
+class JobSystem;
+
 namespace sg
 {
 enum AnimationType
@@ -60,24 +62,57 @@ struct AnimationChannel
 	AnimationTarget target;
 
 	AnimationSampler sampler;
+
+	/// Keyframe of the last update, usually still valid or followed by the right one on the next update
+	size_t cursor{0};
 };
 
 class Animation : public Script
 {
   public:
+	/// Smallest number of channels worth splitting across the workers of a job system
+	static constexpr size_t ParallelThreshold = 256;
+
 	Animation(const std::string &name = "");
 
 	Animation(const Animation &);
 
 	virtual void update(float delta_time) override;
 
+	/**
+	 * @brief Advances the animation and evaluates its channels
+	 * @param delta_time Time passed since the last update
+	 * @param jobs Optional job system splitting the channels across its workers, by target node.
+	 *        Only used once the targeted transforms belong to the transform store of the scene.
+	 */
+	void update(float delta_time, JobSystem *jobs);
+
 	void update_times(float start_time, float end_time);
 
 	void add_channel(Node &node, const AnimationTarget &target, const AnimationSampler &sampler);
 
   private:
+	/**
+	 * @brief Finds the keyframe interval of the sampler containing the time, starting from the cursor of the channel
+	 * @return False if the time is outside of the sampler inputs
+	 */
+	static bool find_keyframe(AnimationChannel &channel, float time, size_t &index);
+
+	static void evaluate_channel(AnimationChannel &channel, float animation_time);
+
+	/**
+	 * @brief Groups the channels by target node, so no two threads write the same transform
+	 */
+	void build_node_groups();
+
 	std::vector<AnimationChannel> channels;
 
+	/// Channel indices sorted by target node
+	std::vector<size_t> channel_order;
+
+	/// Start of the channels of each target node in channel_order, followed by its size
+	std::vector<size_t> node_group_starts;
+
 	float current_time{0.0f};
 
 	float start_time{std::numeric_limits<float>::max()};
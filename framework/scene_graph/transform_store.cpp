@@ -0,0 +1,286 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transform_store.h"
+
+#include <algorithm>
+
+#include "common/helpers.h"
+#include "core/util/job_system.hpp"
+#include "scene_graph/components/transform.h"
+#include "scene_graph/node.h"
+
+namespace vkb
+{
+namespace sg
+{
+void TransformStore::set_root(Node &new_root)
+{
+	root = &new_root;
+
+	invalidate_hierarchy();
+}
+
+void TransformStore::invalidate_hierarchy()
+{
+	hierarchy_changed = true;
+
+	needs_update.store(true, std::memory_order_release);
+}
+
+void TransformStore::release()
+{
+	unbind_all();
+
+	transforms.clear();
+	parents.clear();
+	translations.clear();
+	rotations.clear();
+	scales.clear();
+	world_matrices.clear();
+	world_matrix_versions.clear();
+	dirty.clear();
+	levels.clear();
+
+	first_dirty = std::numeric_limits<size_t>::max();
+
+	invalidate_hierarchy();
+}
+
+void TransformStore::update(JobSystem *jobs)
+{
+	if (!needs_update.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard{update_mutex};
+
+	// Another thread may have done the update while this one was waiting
+	if (!needs_update.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	if (hierarchy_changed)
+	{
+		build();
+	}
+
+	const size_t sweep_first = first_dirty.load(std::memory_order_relaxed);
+
+	for (auto &level : levels)
+	{
+		// Nothing changed before the first dirty transform
+		if (level.second <= sweep_first)
+		{
+			continue;
+		}
+
+		size_t first = std::max(level.first, sweep_first);
+		size_t count = level.second - first;
+
+		if (jobs)
+		{
+			// Returns once the level is done, as the next level reads its world matrices
+			jobs->parallel_for(count, ParallelThreshold, [this, first](size_t range_first, size_t range_last) {
+				update_range(first + range_first, first + range_last);
+			});
+		}
+		else
+		{
+			update_range(first, level.second);
+		}
+	}
+
+	if (sweep_first < dirty.size())
+	{
+		std::fill(dirty.begin() + sweep_first, dirty.end(), 0);
+	}
+
+	first_dirty.store(std::numeric_limits<size_t>::max(), std::memory_order_relaxed);
+
+	needs_update.store(false, std::memory_order_release);
+}
+
+size_t TransformStore::size() const
+{
+	return transforms.size();
+}
+
+const glm::vec3 &TransformStore::get_translation(uint32_t index) const
+{
+	return translations[index];
+}
+
+const glm::quat &TransformStore::get_rotation(uint32_t index) const
+{
+	return rotations[index];
+}
+
+const glm::vec3 &TransformStore::get_scale(uint32_t index) const
+{
+	return scales[index];
+}
+
+void TransformStore::set_translation(uint32_t index, const glm::vec3 &translation)
+{
+	translations[index] = translation;
+
+	invalidate(index);
+}
+
+void TransformStore::set_rotation(uint32_t index, const glm::quat &rotation)
+{
+	rotations[index] = rotation;
+
+	invalidate(index);
+}
+
+void TransformStore::set_scale(uint32_t index, const glm::vec3 &scale)
+{
+	scales[index] = scale;
+
+	invalidate(index);
+}
+
+void TransformStore::invalidate(uint32_t index)
+{
+	dirty[index] = 1;
+
+	// Lowers the first dirty index, other threads may be invalidating transforms too
+	size_t current = first_dirty.load(std::memory_order_relaxed);
+	while (index < current && !first_dirty.compare_exchange_weak(current, index, std::memory_order_relaxed))
+	{
+	}
+
+	needs_update.store(true, std::memory_order_release);
+}
+
+const glm::mat4 &TransformStore::get_world_matrix(uint32_t index)
+{
+	update();
+
+	return world_matrices[index];
+}
+
+uint32_t TransformStore::get_world_matrix_version(uint32_t index)
+{
+	update();
+
+	return world_matrix_versions[index];
+}
+
+void TransformStore::build()
+{
+	release();
+
+	hierarchy_changed = false;
+
+	if (!root)
+	{
+		return;
+	}
+
+	// Breadth-first traversal, each level is appended after the previous one
+	std::vector<std::pair<Node *, uint32_t>> current_level{{root, NoParent}};
+	std::vector<std::pair<Node *, uint32_t>> next_level;
+
+	while (!current_level.empty())
+	{
+		levels.emplace_back(transforms.size(), transforms.size() + current_level.size());
+
+		for (auto &[node, parent] : current_level)
+		{
+			auto index = to_u32(transforms.size());
+
+			auto &transform = node->get_transform();
+
+			transforms.push_back(&transform);
+			parents.push_back(parent);
+			translations.push_back(transform.translation);
+			rotations.push_back(transform.rotation);
+			scales.push_back(transform.scale);
+			world_matrices.push_back(transform.world_matrix);
+			world_matrix_versions.push_back(transform.world_matrix_version);
+
+			// Everything is recomputed once, the parents of the nodes may have changed
+			dirty.push_back(1);
+
+			transform.store       = this;
+			transform.store_index = index;
+
+			for (auto child : node->get_children())
+			{
+				next_level.emplace_back(child, index);
+			}
+		}
+
+		current_level.swap(next_level);
+		next_level.clear();
+	}
+
+	first_dirty = 0;
+}
+
+void TransformStore::unbind_all()
+{
+	for (size_t i = 0; i < transforms.size(); ++i)
+	{
+		auto &transform = *transforms[i];
+
+		// Skip the transforms bound to another store in the meantime
+		if (transform.store != this)
+		{
+			continue;
+		}
+
+		transform.translation          = translations[i];
+		transform.rotation             = rotations[i];
+		transform.scale                = scales[i];
+		transform.world_matrix         = world_matrices[i];
+		transform.world_matrix_version = world_matrix_versions[i];
+		transform.update_world_matrix  = true;
+		transform.store                = nullptr;
+	}
+}
+
+void TransformStore::update_range(size_t first, size_t last)
+{
+	for (size_t i = first; i < last; ++i)
+	{
+		uint32_t parent = parents[i];
+
+		if (!dirty[i] && (parent == NoParent || !dirty[parent]))
+		{
+			continue;
+		}
+
+		// Propagates to the children, which come later in the sweep
+		dirty[i] = 1;
+
+		glm::mat4 local_matrix = glm::translate(glm::mat4(1.0), translations[i]) *
+		                         glm::mat4_cast(rotations[i]) *
+		                         glm::scale(glm::mat4(1.0), scales[i]);
+
+		world_matrices[i] = parent == NoParent ? local_matrix : world_matrices[parent] * local_matrix;
+
+		++world_matrix_versions[i];
+	}
+}
+}        // namespace sg
+}        // namespace vkb
@@ -0,0 +1,181 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "common/error.h"
+
+#include "common/glm_common.h"
+#include <glm/gtx/quaternion.hpp>
+
+namespace vkb
+{
+class JobSystem;
+
+namespace sg
+{
+class Node;
+class Transform;
+
+/**
+ * @brief Flat storage of the transforms of a node hierarchy
+ *
+ * Local transforms and world matrices are kept in contiguous arrays, ordered breadth-first
+ * from the root so parents always come before their children and the nodes of a depth level
+ * are contiguous. The world matrices are updated in one linear sweep starting at the first
+ * changed transform, recomputing only the changed transforms and their descendants, and the
+ * levels with many nodes can be split across the workers of a job system.
+ *
+ * The Transform components of the hierarchy become handles into the store once it is built,
+ * which happens lazily on update after the hierarchy changed.
+ */
+class TransformStore
+{
+  public:
+	/// Smallest number of nodes of a depth level worth a job of their own
+	static constexpr size_t ParallelThreshold = 1024;
+
+	/// Parent index of the root
+	static constexpr uint32_t NoParent = std::numeric_limits<uint32_t>::max();
+
+	TransformStore() = default;
+
+	TransformStore(const TransformStore &) = delete;
+
+	TransformStore(TransformStore &&) = delete;
+
+	/// Transforms are not detached, the store is destroyed with the scene owning their nodes unless they were released
+	~TransformStore() = default;
+
+	TransformStore &operator=(const TransformStore &) = delete;
+
+	TransformStore &operator=(TransformStore &&) = delete;
+
+	/**
+	 * @brief Sets the root of the hierarchy, the store is rebuilt on the next update
+	 */
+	void set_root(Node &root);
+
+	/**
+	 * @brief Requests a rebuild of the store on the next update, called when nodes are added or reparented
+	 */
+	void invalidate_hierarchy();
+
+	/**
+	 * @brief Gives the state of the store back to the transforms and empties it, the store is rebuilt on the next update
+	 *        Called before nodes leave the hierarchy or the store is destroyed while their nodes live on,
+	 *        not during an update.
+	 */
+	void release();
+
+	/**
+	 * @brief Rebuilds the store if the hierarchy changed, then updates the world matrices of the changed transforms
+	 *        Safe to call from several threads, the first one does the work.
+	 * @param jobs Optional job system splitting the large depth levels across its workers
+	 */
+	void update(JobSystem *jobs = nullptr);
+
+	/**
+	 * @return Number of transforms in the store
+	 */
+	size_t size() const;
+
+	const glm::vec3 &get_translation(uint32_t index) const;
+
+	const glm::quat &get_rotation(uint32_t index) const;
+
+	const glm::vec3 &get_scale(uint32_t index) const;
+
+	/**
+	 * @brief The setters can be called concurrently for different transforms, but not during an update
+	 */
+	void set_translation(uint32_t index, const glm::vec3 &translation);
+
+	void set_rotation(uint32_t index, const glm::quat &rotation);
+
+	void set_scale(uint32_t index, const glm::vec3 &scale);
+
+	/**
+	 * @brief Marks a transform changed, its world matrix and the ones of its descendants are updated on the next sweep
+	 */
+	void invalidate(uint32_t index);
+
+	/**
+	 * @return The world matrix of a transform, updating the store first if needed
+	 */
+	const glm::mat4 &get_world_matrix(uint32_t index);
+
+	/**
+	 * @return The version of the world matrix of a transform, updating the store first if needed
+	 */
+	uint32_t get_world_matrix_version(uint32_t index);
+
+  private:
+	/**
+	 * @brief Unbinds the transforms, then binds the ones of the hierarchy under the root in breadth-first order
+	 */
+	void build();
+
+	/**
+	 * @brief Gives the state of the store back to the transforms and detaches them from it
+	 */
+	void unbind_all();
+
+	/**
+	 * @brief Updates the world matrices of the transforms in [first, last), whose parents are already up to date
+	 */
+	void update_range(size_t first, size_t last);
+
+	Node *root{nullptr};
+
+	std::vector<Transform *> transforms;
+
+	std::vector<uint32_t> parents;
+
+	std::vector<glm::vec3> translations;
+
+	std::vector<glm::quat> rotations;
+
+	std::vector<glm::vec3> scales;
+
+	std::vector<glm::mat4> world_matrices;
+
+	std::vector<uint32_t> world_matrix_versions;
+
+	/// Set for the changed transforms, then for their descendants during the sweep
+	std::vector<uint8_t> dirty;
+
+	/// Index range of each depth level
+	std::vector<std::pair<size_t, size_t>> levels;
+
+	/// First changed transform, the sweep starts there
+	std::atomic<size_t> first_dirty{std::numeric_limits<size_t>::max()};
+
+	bool hierarchy_changed{false};
+
+	std::atomic<bool> needs_update{false};
+
+	std::mutex update_mutex;
+};
+}        // namespace sg
+}        // namespace vkb
@@ -0,0 +1,275 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene_streamer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "common/helpers.h"
+#include "core/allocated.h"
+#include "core/device.h"
+#include "core/image.h"
+#include "core/util/job_system.hpp"
+#include "core/util/logging.hpp"
+#include "core/util/profiling.hpp"
+#include "gltf_loader.h"
+#include "scene_graph/components/image.h"
+#include "scene_graph/components/sub_mesh.h"
+#include "scene_graph/node.h"
+#include "scene_graph/scene.h"
+
+namespace vkb
+{
+namespace
+{
+VkDeviceSize get_allocation_size(VmaAllocation allocation)
+{
+	if (allocation == VK_NULL_HANDLE)
+	{
+		return 0;
+	}
+
+	VmaAllocationInfo allocation_info{};
+	vmaGetAllocationInfo(allocated::get_memory_allocator(), allocation, &allocation_info);
+	return allocation_info.size;
+}
+
+/**
+ * @return The device memory taken by the buffers and images of a scene
+ */
+VkDeviceSize measure_scene(const sg::Scene &scene)
+{
+	VkDeviceSize size = 0;
+
+	for (auto *sub_mesh : scene.get_components<sg::SubMesh>())
+	{
+		for (auto &vertex_buffer : sub_mesh->vertex_buffers)
+		{
+			size += get_allocation_size(vertex_buffer.second.get_allocation());
+		}
+
+		if (sub_mesh->index_buffer)
+		{
+			size += get_allocation_size(sub_mesh->index_buffer->get_allocation());
+		}
+	}
+
+	for (auto *image : scene.get_components<sg::Image>())
+	{
+		size += get_allocation_size(image->get_vk_image().get_allocation());
+	}
+
+	return size;
+}
+
+/**
+ * @return The distance from a point to a box, zero inside of it
+ */
+float get_distance(const glm::vec3 &point, const glm::vec3 &min, const glm::vec3 &max)
+{
+	return glm::length(glm::max(glm::max(min - point, point - max), glm::vec3(0.0f)));
+}
+
+bool is_ready(const std::future<std::unique_ptr<sg::Scene>> &load)
+{
+	return load.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+}        // namespace
+
+SceneStreamer::SceneStreamer(Device &device, sg::Scene &scene) :
+    device{device},
+    scene{scene}
+{}
+
+SceneStreamer::~SceneStreamer()
+{
+	for (auto &cell : cells)
+	{
+		if (cell.state == CellState::Loading)
+		{
+			JobSystem::get_background().wait_for_future(cell.load);
+		}
+	}
+}
+
+size_t SceneStreamer::add_cell(const std::string &file_name, const glm::vec3 &min, const glm::vec3 &max, VkDeviceSize size_estimate)
+{
+	Cell cell;
+	cell.file_name = file_name;
+	cell.min       = min;
+	cell.max       = max;
+	cell.size      = size_estimate;
+
+	cells.push_back(std::move(cell));
+
+	return cells.size() - 1;
+}
+
+void SceneStreamer::set_radii(float load, float unload)
+{
+	load_radius   = load;
+	unload_radius = std::max(load, unload);
+}
+
+void SceneStreamer::set_memory_budget(VkDeviceSize budget)
+{
+	memory_budget = budget;
+}
+
+void SceneStreamer::set_loader_setup(std::function<void(GLTFLoader &)> setup)
+{
+	loader_setup = std::move(setup);
+}
+
+void SceneStreamer::update(const glm::vec3 &camera_position)
+{
+	PROFILE_SCOPE("Stream scene");
+
+	cell_order.clear();
+	for (size_t i = 0; i < cells.size(); ++i)
+	{
+		cell_order.emplace_back(get_distance(camera_position, cells[i].min, cells[i].max), i);
+	}
+	std::sort(cell_order.begin(), cell_order.end());
+
+	uint32_t loading_count = to_u32(get_loading_count());
+
+	// The nearest cells are wanted first, the ones already loaded or loading keep being wanted up to the unload radius
+	VkDeviceSize wanted_size = 0;
+	for (auto &[distance, index] : cell_order)
+	{
+		auto &cell = cells[index];
+
+		bool resident = cell.state == CellState::Loaded || cell.state == CellState::Loading;
+		bool wanted   = cell.state != CellState::Failed && distance <= (resident ? unload_radius : load_radius) &&
+		              cell.size <= memory_budget - wanted_size;
+
+		if (wanted)
+		{
+			wanted_size += cell.size;
+		}
+
+		if (cell.state == CellState::Loading && is_ready(cell.load))
+		{
+			finish_load(cell, wanted);
+			--loading_count;
+		}
+
+		if (cell.state == CellState::Loaded && !wanted)
+		{
+			unload(cell);
+		}
+		else if (cell.state == CellState::Unloaded && wanted && loading_count < MaxConcurrentLoads)
+		{
+			start_load(cell);
+			++loading_count;
+		}
+	}
+}
+
+bool SceneStreamer::is_loaded(size_t cell) const
+{
+	return cells[cell].state == CellState::Loaded;
+}
+
+size_t SceneStreamer::get_loaded_count() const
+{
+	return std::count_if(cells.begin(), cells.end(), [](const Cell &cell) { return cell.state == CellState::Loaded; });
+}
+
+size_t SceneStreamer::get_loading_count() const
+{
+	return std::count_if(cells.begin(), cells.end(), [](const Cell &cell) { return cell.state == CellState::Loading; });
+}
+
+VkDeviceSize SceneStreamer::get_loaded_size() const
+{
+	VkDeviceSize size = 0;
+	for (auto &cell : cells)
+	{
+		if (cell.state == CellState::Loaded)
+		{
+			size += cell.size;
+		}
+	}
+	return size;
+}
+
+void SceneStreamer::finish_load(Cell &cell, bool wanted)
+{
+	std::unique_ptr<sg::Scene> cell_scene;
+	try
+	{
+		cell_scene = cell.load.get();
+	}
+	catch (const std::exception &e)
+	{
+		LOGE("Failed to load the cell {}: {}", cell.file_name, e.what());
+	}
+
+	if (!cell_scene)
+	{
+		cell.state = CellState::Failed;
+		return;
+	}
+
+	cell.size = measure_scene(*cell_scene);
+
+	if (!wanted)
+	{
+		// The camera moved away while it loaded, the loader waited for its uploads so nothing uses it yet
+		cell.state = CellState::Unloaded;
+		return;
+	}
+
+	cell.root  = &scene.attach(std::move(cell_scene));
+	cell.state = CellState::Loaded;
+
+	LOGD("Attached the cell {}, {} bytes", cell.file_name, cell.size);
+}
+
+void SceneStreamer::start_load(Cell &cell)
+{
+	// Off the workers the frames wait for, a cell may take several frames to load
+	cell.load = JobSystem::get_background().async([&load_device = device, file_name = cell.file_name, setup = loader_setup]() {
+		GLTFLoader loader{load_device};
+		loader.set_default_camera_and_light(false);
+		if (setup)
+		{
+			setup(loader);
+		}
+
+		return loader.read_scene_from_file(file_name);
+	});
+
+	cell.state = CellState::Loading;
+}
+
+void SceneStreamer::unload(Cell &cell)
+{
+	auto cell_scene = scene.detach(*cell.root);
+
+	// Frames in flight may still draw the cell
+	device.get_deferred_destruction_queue().retire(std::move(cell_scene));
+
+	cell.root  = nullptr;
+	cell.state = CellState::Unloaded;
+
+	LOGD("Detached the cell {}", cell.file_name);
+}
+}        // namespace vkb
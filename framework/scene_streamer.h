@@ -0,0 +1,192 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/glm_common.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Device;
+class GLTFLoader;
+
+namespace sg
+{
+class Node;
+class Scene;
+}        // namespace sg
+
+/**
+ * @brief Streams the cells of a large world in and out of a scene, by distance to the camera and within a memory budget
+ *
+ * The world is split offline into cells, glTF files each holding the nodes within their bounds. Every update orders the
+ * cells by the distance of their bounds to the camera, and keeps the nearest ones within the load radius as long as their
+ * sizes fit in the memory budget. The cells to load are read by a GLTFLoader on the background workers of the job system, at most
+ * MaxConcurrentLoads at a time, and attached to the scene on the thread calling update(), see sg::Scene::attach().
+ *
+ * The cells beyond the unload radius, or over the budget, are detached and retired to the deferred destruction queue of
+ * the device, as the frames in flight may still draw them. The gap between the two radii keeps the cells on the border
+ * from being loaded and unloaded every other frame.
+ *
+ * The subpasses drawing the scene refresh their meshes when it changes, see GeometrySubpass::refresh_meshes().
+ * The textures of the cells are loaded whole, not through a TextureResidencyManager.
+ */
+class SceneStreamer
+{
+  public:
+	/// Cells read at the same time, bounding the workers and staging memory taken by the loads
+	static constexpr uint32_t MaxConcurrentLoads = 2;
+
+	/**
+	 * @param device The device the cells are loaded on
+	 * @param scene The scene the cells are attached to, must outlive the streamer
+	 */
+	SceneStreamer(Device &device, sg::Scene &scene);
+
+	SceneStreamer(const SceneStreamer &) = delete;
+
+	SceneStreamer(SceneStreamer &&) = delete;
+
+	/**
+	 * @brief Waits for the loads in flight, the cells attached stay in the scene
+	 */
+	~SceneStreamer();
+
+	SceneStreamer &operator=(const SceneStreamer &) = delete;
+
+	SceneStreamer &operator=(SceneStreamer &&) = delete;
+
+	/**
+	 * @brief Adds a cell of the world
+	 * @param file_name The glTF file of the cell, relative to the assets directory
+	 * @param min The minimum corner of the bounds of the cell in world space
+	 * @param max The maximum corner of the bounds of the cell in world space
+	 * @param size_estimate The device memory taken by the cell, replaced by the size measured once it is loaded
+	 * @return The index of the cell
+	 */
+	size_t add_cell(const std::string &file_name, const glm::vec3 &min, const glm::vec3 &max, VkDeviceSize size_estimate = 0);
+
+	/**
+	 * @brief Sets the distances to the bounds of the cells within which they are loaded, and beyond which they are unloaded
+	 *        The unload radius is at least the load radius.
+	 */
+	void set_radii(float load_radius, float unload_radius);
+
+	/**
+	 * @brief Sets the device memory the cells may take, unlimited by default
+	 */
+	void set_memory_budget(VkDeviceSize budget);
+
+	/**
+	 * @brief Sets a function configuring the loader of every cell, e.g. to pack the vertices of the cells like the rest of the scene
+	 *        Called on the workers of the job system.
+	 */
+	void set_loader_setup(std::function<void(GLTFLoader &)> setup);
+
+	/**
+	 * @brief Attaches the cells loaded since the last update, detaches the cells no longer wanted and starts the loads of the cells wanted
+	 *        Called once per frame, before the frame is drawn.
+	 * @param camera_position The position of the camera in world space
+	 */
+	void update(const glm::vec3 &camera_position);
+
+	/**
+	 * @return Whether a cell is attached to the scene
+	 */
+	bool is_loaded(size_t cell) const;
+
+	/**
+	 * @return Number of cells attached to the scene
+	 */
+	size_t get_loaded_count() const;
+
+	/**
+	 * @return Number of cells being read
+	 */
+	size_t get_loading_count() const;
+
+	/**
+	 * @return The device memory taken by the cells attached to the scene, in bytes
+	 */
+	VkDeviceSize get_loaded_size() const;
+
+  private:
+	enum class CellState
+	{
+		Unloaded,
+		Loading,
+		Loaded,
+
+		/// The load failed, the cell isn't requested again
+		Failed
+	};
+
+	struct Cell
+	{
+		std::string file_name;
+
+		glm::vec3 min;
+
+		glm::vec3 max;
+
+		VkDeviceSize size;
+
+		CellState state{CellState::Unloaded};
+
+		/// The scene read by the load in flight
+		std::future<std::unique_ptr<sg::Scene>> load;
+
+		/// Root node of the cell in the scene once attached
+		sg::Node *root{nullptr};
+	};
+
+	/**
+	 * @brief Attaches or discards a cell whose load completed
+	 * @param wanted Whether the cell is still wanted
+	 */
+	void finish_load(Cell &cell, bool wanted);
+
+	void start_load(Cell &cell);
+
+	void unload(Cell &cell);
+
+	Device &device;
+
+	sg::Scene &scene;
+
+	std::vector<Cell> cells;
+
+	float load_radius{100.0f};
+
+	float unload_radius{120.0f};
+
+	VkDeviceSize memory_budget{std::numeric_limits<VkDeviceSize>::max()};
+
+	std::function<void(GLTFLoader &)> loader_setup;
+
+	/// Scratch space of update(), the cells ordered by distance to the camera
+	std::vector<std::pair<float, size_t>> cell_order;
+};
+}        // namespace vkb
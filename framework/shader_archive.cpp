@@ -0,0 +1,196 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shader_archive.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/util/cache_file.hpp"
+#include "core/util/logging.hpp"
+#include "filesystem/filesystem.hpp"
+#include "filesystem/legacy.h"
+
+namespace vkb
+{
+namespace
+{
+constexpr uint32_t ShaderArchiveMagic   = 0x41565053;        // "SPVA"
+constexpr uint32_t ShaderArchiveVersion = 2;
+
+/// Starts the payload of the archive, followed by its index and the keys and data of the entries
+struct ShaderArchiveHeader
+{
+	uint64_t entry_count;
+	uint64_t data_size;
+};
+
+/// Locates an entry in the data following the index
+struct ShaderArchiveIndexEntry
+{
+	uint32_t type;
+	uint32_t reserved;
+	uint64_t key_offset;
+	uint64_t key_size;
+	uint64_t data_offset;
+	uint64_t data_size;
+};
+
+std::string get_entry_key(ShaderArchive::EntryType type, const uint8_t *key, size_t key_size)
+{
+	std::string entry_key(1, static_cast<char>(type));
+	entry_key.append(reinterpret_cast<const char *>(key), key_size);
+	return entry_key;
+}
+}        // namespace
+
+bool ShaderArchive::enabled = true;
+
+void ShaderArchive::set_enabled(bool enabled_)
+{
+	ShaderArchive::enabled = enabled_;
+}
+
+const std::vector<uint8_t> *ShaderArchive::find_default(EntryType type, const std::vector<uint8_t> &key)
+{
+	if (!ShaderArchive::enabled)
+	{
+		return nullptr;
+	}
+
+	// Loaded once, the compile queue looks shaders up from several threads
+	static const ShaderArchive default_archive = []() {
+		ShaderArchive archive;
+
+		auto path = fs::path::get(fs::path::Type::Shaders, FileName);
+		if (fs::is_file(path) && archive.load(path))
+		{
+			LOGI("Loaded {} precompiled shader entries from {}", archive.get_entry_count(), path);
+		}
+
+		return archive;
+	}();
+
+	return default_archive.find(type, key);
+}
+
+bool ShaderArchive::load(const std::string &path)
+{
+	entries.clear();
+
+	auto file_system = vkb::filesystem::get();
+
+	if (!file_system->is_file(path))
+	{
+		return false;
+	}
+
+	auto file = file_system->map_file(path);
+
+	CacheFileReader     reader{file->data(), file->size(), ShaderArchiveMagic, ShaderArchiveVersion};
+	ShaderArchiveHeader header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		return false;
+	}
+
+	if (!reader.read(header) || header.entry_count > reader.get_remaining_size() / sizeof(ShaderArchiveIndexEntry) ||
+	    reader.get_remaining_size() != header.entry_count * sizeof(ShaderArchiveIndexEntry) + header.data_size)
+	{
+		LOGW("Ignoring invalid shader archive {}", path);
+		return false;
+	}
+
+	const uint8_t *index = reader.get_data();
+	const uint8_t *data  = index + header.entry_count * sizeof(ShaderArchiveIndexEntry);
+
+	for (uint64_t i = 0; i < header.entry_count; ++i)
+	{
+		ShaderArchiveIndexEntry entry{};
+		std::memcpy(&entry, index + i * sizeof(entry), sizeof(entry));
+
+		if (entry.key_offset + entry.key_size > header.data_size || entry.data_offset + entry.data_size > header.data_size)
+		{
+			LOGW("Ignoring invalid shader archive {}", path);
+			entries.clear();
+			return false;
+		}
+
+		entries[get_entry_key(static_cast<EntryType>(entry.type), data + entry.key_offset, entry.key_size)] =
+		    std::vector<uint8_t>{data + entry.data_offset, data + entry.data_offset + entry.data_size};
+	}
+
+	return true;
+}
+
+void ShaderArchive::write(const std::string &path) const
+{
+	// Sorted, so that building the same shaders writes the same archive
+	std::vector<const std::pair<const std::string, std::vector<uint8_t>> *> sorted_entries;
+	sorted_entries.reserve(entries.size());
+	for (auto &entry : entries)
+	{
+		sorted_entries.push_back(&entry);
+	}
+	std::sort(sorted_entries.begin(), sorted_entries.end(), [](auto *lhs, auto *rhs) { return lhs->first < rhs->first; });
+
+	std::vector<ShaderArchiveIndexEntry> index;
+	std::vector<uint8_t>                 data;
+
+	for (auto *entry : sorted_entries)
+	{
+		ShaderArchiveIndexEntry index_entry{};
+		index_entry.type       = static_cast<uint8_t>(entry->first[0]);
+		index_entry.key_offset = data.size();
+		index_entry.key_size   = entry->first.size() - 1;
+		data.insert(data.end(), entry->first.begin() + 1, entry->first.end());
+		index_entry.data_offset = data.size();
+		index_entry.data_size   = entry->second.size();
+		data.insert(data.end(), entry->second.begin(), entry->second.end());
+
+		index.push_back(index_entry);
+	}
+
+	ShaderArchiveHeader header{};
+	header.entry_count = index.size();
+	header.data_size   = data.size();
+
+	CacheFileWriter writer{ShaderArchiveMagic, ShaderArchiveVersion};
+	writer.append(header);
+	writer.append(index.data(), index.size() * sizeof(ShaderArchiveIndexEntry));
+	writer.append(data.data(), data.size());
+
+	vkb::filesystem::get()->write_file(path, writer.finish());
+}
+
+void ShaderArchive::add(EntryType type, const std::vector<uint8_t> &key, const std::vector<uint8_t> &data)
+{
+	entries[get_entry_key(type, key.data(), key.size())] = data;
+}
+
+const std::vector<uint8_t> *ShaderArchive::find(EntryType type, const std::vector<uint8_t> &key) const
+{
+	auto it = entries.find(get_entry_key(type, key.data(), key.size()));
+	return it != entries.end() ? &it->second : nullptr;
+}
+
+size_t ShaderArchive::get_entry_count() const
+{
+	return entries.size();
+}
+}        // namespace vkb
@@ -0,0 +1,86 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vkb
+{
+/**
+ * @brief Shaders compiled ahead of time by the vkb__shader_archive build target
+ *
+ * The archive holds the SPIRV code of every shader variant listed in shaders/shader_archive.txt, and the
+ * resources reflected from it. The entries are indexed by the keys of the SPIRV and reflection caches, which
+ * serialize the final source, the variant, the stage, the entry point and the target environment, so
+ * GLSLCompiler and SPIRVReflection look up a shader in the archive before compiling or reflecting it, and
+ * only variants missing from it are compiled at runtime.
+ */
+class ShaderArchive
+{
+  public:
+	/// The name of the archive in the shaders directory
+	static constexpr const char *FileName = "shaders.spva";
+
+	enum class EntryType : uint32_t
+	{
+		Spirv,
+		Resources
+	};
+
+	/**
+	 * @brief Sets whether shaders are looked up in the archive of the shaders directory, enabled by default
+	 */
+	static void set_enabled(bool enabled);
+
+	/**
+	 * @brief Looks up an entry in the archive of the shaders directory, loaded on first use
+	 * @return The data of the entry, or nullptr if the archive is disabled, missing, or doesn't hold the key
+	 */
+	static const std::vector<uint8_t> *find_default(EntryType type, const std::vector<uint8_t> &key);
+
+	/**
+	 * @brief Reads the entries of an archive file
+	 * @return False if the file is missing or isn't a valid archive, the archive is then left empty
+	 */
+	bool load(const std::string &path);
+
+	/**
+	 * @brief Writes the entries to an archive file
+	 * @throws std::runtime_error if the file can't be written
+	 */
+	void write(const std::string &path) const;
+
+	/**
+	 * @brief Adds an entry, replacing the data of an entry with the same key
+	 */
+	void add(EntryType type, const std::vector<uint8_t> &key, const std::vector<uint8_t> &data);
+
+	const std::vector<uint8_t> *find(EntryType type, const std::vector<uint8_t> &key) const;
+
+	size_t get_entry_count() const;
+
+  private:
+	static bool enabled;
+
+	/// Data of the entries, keyed by their type followed by their key
+	std::unordered_map<std::string, std::vector<uint8_t>> entries;
+};
+}        // namespace vkb
@@ -1,4 +1,4 @@
-/* Copyright (c) 2019-2020, Arm Limited and Contributors
+/* Copyright (c) 2019-2024, Arm Limited and Contributors
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -17,6 +17,15 @@
 
 #include "spirv_reflection.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "core/util/cache_file.hpp"
+#include "core/util/hash.hpp"
+#include "core/util/logging.hpp"
+#include "filesystem/filesystem.hpp"
+#include "shader_archive.h"
+
 namespace vkb
 {
 namespace
@@ -370,10 +379,105 @@ inline void read_shader_resource<ShaderResourceType::BufferStorage>(const spirv_
 		resources.push_back(shader_resource);
 	}
 }
+
+constexpr uint32_t ReflectionCacheMagic   = 0x4c464552;        // "REFL"
+constexpr uint32_t ReflectionCacheVersion = 2;
+
+/// Starts the payload of cached resources, followed by their key and their data
+struct ReflectionCacheHeader
+{
+	uint64_t key_size;
+	uint64_t resource_count;
+	uint64_t data_size;
+};
+
+/// The fixed size fields of a cached resource, followed by its name
+struct CachedShaderResource
+{
+	uint32_t stages;
+	uint32_t type;
+	uint32_t mode;
+	uint32_t set;
+	uint32_t binding;
+	uint32_t location;
+	uint32_t input_attachment_index;
+	uint32_t vec_size;
+	uint32_t columns;
+	uint32_t array_size;
+	uint32_t offset;
+	uint32_t size;
+	uint32_t constant_id;
+	uint32_t qualifiers;
+	uint32_t name_size;
+};
 }        // namespace
 
+bool SPIRVReflection::cache_enabled = true;
+
+void SPIRVReflection::set_cache_enabled(bool enabled)
+{
+	SPIRVReflection::cache_enabled = enabled;
+}
+
+std::vector<uint8_t> SPIRVReflection::get_resources_key(VkShaderStageFlagBits stage, const std::vector<uint32_t> &spirv, const ShaderVariant &variant)
+{
+	std::vector<uint8_t> key;
+
+	auto append = [&key](const void *bytes, size_t size) {
+		auto begin = reinterpret_cast<const uint8_t *>(bytes);
+		key.insert(key.end(), begin, begin + size);
+	};
+
+	uint64_t values[] = {static_cast<uint64_t>(stage), spirv.size(),
+	                     fnv1a_hash(reinterpret_cast<const uint8_t *>(spirv.data()), spirv.size() * sizeof(uint32_t))};
+	append(values, sizeof(values));
+
+	// Sorted, the map iterates in any order
+	std::vector<std::pair<std::string, size_t>> runtime_array_sizes{variant.get_runtime_array_sizes().begin(), variant.get_runtime_array_sizes().end()};
+	std::sort(runtime_array_sizes.begin(), runtime_array_sizes.end());
+
+	for (auto &runtime_array_size : runtime_array_sizes)
+	{
+		uint64_t sizes[] = {runtime_array_size.first.size(), runtime_array_size.second};
+		append(sizes, sizeof(sizes));
+		append(runtime_array_size.first.data(), runtime_array_size.first.size());
+	}
+
+	return key;
+}
+
 bool SPIRVReflection::reflect_shader_resources(VkShaderStageFlagBits stage, const std::vector<uint32_t> &spirv, std::vector<ShaderResource> &resources, const ShaderVariant &variant)
 {
+	std::string          cache_path;
+	std::vector<uint8_t> cache_key = get_resources_key(stage, spirv, variant);
+
+	// Variants built by the vkb__shader_archive target skip SPIRV-Cross altogether
+	if (auto archived_resources = ShaderArchive::find_default(ShaderArchive::EntryType::Resources, cache_key))
+	{
+		uint64_t resource_count{0};
+		if (archived_resources->size() >= sizeof(resource_count))
+		{
+			std::memcpy(&resource_count, archived_resources->data(), sizeof(resource_count));
+
+			if (deserialize_resources(archived_resources->data() + sizeof(resource_count), archived_resources->size() - sizeof(resource_count), resource_count, resources))
+			{
+				return true;
+			}
+		}
+	}
+
+	if (SPIRVReflection::cache_enabled)
+	{
+		cache_path = (vkb::filesystem::get()->temp_directory() / "spirv_cache" / fmt::format("{:016x}.refl", fnv1a_hash(cache_key.data(), cache_key.size()))).string();
+
+		if (load_cached_resources(cache_path, cache_key, resources))
+		{
+			return true;
+		}
+	}
+
+	auto first_resource = resources.size();
+
 	spirv_cross::CompilerGLSL compiler{spirv};
 
 	auto opts                     = compiler.get_common_options();
@@ -385,9 +489,152 @@ bool SPIRVReflection::reflect_shader_resources(VkShaderStageFlagBits stage, cons
 	parse_push_constants(compiler, stage, resources, variant);
 	parse_specialization_constants(compiler, stage, resources, variant);
 
+	if (!cache_path.empty())
+	{
+		write_cached_resources(cache_path, cache_key, {resources.begin() + first_resource, resources.end()});
+	}
+
+	return true;
+}
+
+std::vector<uint8_t> SPIRVReflection::serialize_resources(const std::vector<ShaderResource> &resources)
+{
+	std::vector<uint8_t> data;
+
+	for (auto &resource : resources)
+	{
+		CachedShaderResource cached{};
+		cached.stages                 = resource.stages;
+		cached.type                   = static_cast<uint32_t>(resource.type);
+		cached.mode                   = static_cast<uint32_t>(resource.mode);
+		cached.set                    = resource.set;
+		cached.binding                = resource.binding;
+		cached.location               = resource.location;
+		cached.input_attachment_index = resource.input_attachment_index;
+		cached.vec_size               = resource.vec_size;
+		cached.columns                = resource.columns;
+		cached.array_size             = resource.array_size;
+		cached.offset                 = resource.offset;
+		cached.size                   = resource.size;
+		cached.constant_id            = resource.constant_id;
+		cached.qualifiers             = resource.qualifiers;
+		cached.name_size              = to_u32(resource.name.size());
+
+		auto begin = reinterpret_cast<const uint8_t *>(&cached);
+		data.insert(data.end(), begin, begin + sizeof(cached));
+		data.insert(data.end(), resource.name.begin(), resource.name.end());
+	}
+
+	return data;
+}
+
+bool SPIRVReflection::deserialize_resources(const uint8_t *data, size_t data_size, uint64_t resource_count, std::vector<ShaderResource> &resources)
+{
+	std::vector<ShaderResource> cached_resources;
+	cached_resources.reserve(resource_count);
+
+	const uint8_t *data_end = data + data_size;
+
+	for (uint64_t i = 0; i < resource_count; ++i)
+	{
+		CachedShaderResource cached{};
+		if (static_cast<size_t>(data_end - data) < sizeof(cached))
+		{
+			return false;
+		}
+		std::memcpy(&cached, data, sizeof(cached));
+		data += sizeof(cached);
+
+		if (static_cast<size_t>(data_end - data) < cached.name_size)
+		{
+			return false;
+		}
+
+		ShaderResource resource{};
+		resource.stages                 = cached.stages;
+		resource.type                   = static_cast<ShaderResourceType>(cached.type);
+		resource.mode                   = static_cast<ShaderResourceMode>(cached.mode);
+		resource.set                    = cached.set;
+		resource.binding                = cached.binding;
+		resource.location               = cached.location;
+		resource.input_attachment_index = cached.input_attachment_index;
+		resource.vec_size               = cached.vec_size;
+		resource.columns                = cached.columns;
+		resource.array_size             = cached.array_size;
+		resource.offset                 = cached.offset;
+		resource.size                   = cached.size;
+		resource.constant_id            = cached.constant_id;
+		resource.qualifiers             = cached.qualifiers;
+		resource.name                   = std::string{reinterpret_cast<const char *>(data), cached.name_size};
+		data += cached.name_size;
+
+		cached_resources.push_back(std::move(resource));
+	}
+
+	resources.insert(resources.end(), cached_resources.begin(), cached_resources.end());
+
 	return true;
 }
 
+bool SPIRVReflection::load_cached_resources(const std::string &cache_path, const std::vector<uint8_t> &cache_key, std::vector<ShaderResource> &resources)
+{
+	auto file_system = vkb::filesystem::get();
+
+	if (!file_system->is_file(cache_path))
+	{
+		return false;
+	}
+
+	auto file = file_system->map_file(cache_path);
+
+	CacheFileReader       reader{file->data(), file->size(), ReflectionCacheMagic, ReflectionCacheVersion};
+	ReflectionCacheHeader header{};
+
+	if (reader.get_status() == CacheFileReader::Status::Truncated)
+	{
+		return false;
+	}
+
+	// The full key is compared, a hash collision can't return the resources of another shader
+	if (!reader.read(header) || header.key_size != cache_key.size() ||
+	    reader.get_remaining_size() != header.key_size + header.data_size ||
+	    std::memcmp(reader.get_data(), cache_key.data(), cache_key.size()) != 0)
+	{
+		LOGW("Ignoring stale reflection cache {}", cache_path);
+		return false;
+	}
+	reader.skip(header.key_size);
+
+	return deserialize_resources(reader.get_data(), header.data_size, header.resource_count, resources);
+}
+
+void SPIRVReflection::write_cached_resources(const std::string &cache_path, const std::vector<uint8_t> &cache_key, const std::vector<ShaderResource> &resources)
+{
+	auto data = serialize_resources(resources);
+
+	ReflectionCacheHeader header{};
+	header.key_size       = cache_key.size();
+	header.resource_count = resources.size();
+	header.data_size      = data.size();
+
+	CacheFileWriter writer{ReflectionCacheMagic, ReflectionCacheVersion};
+	writer.append(header);
+	writer.append(cache_key.data(), cache_key.size());
+	writer.append(data.data(), data.size());
+
+	try
+	{
+		auto file_system = vkb::filesystem::get();
+		file_system->create_directory(vkb::filesystem::Path{cache_path}.parent_path());
+		file_system->write_file(cache_path, writer.finish());
+	}
+	catch (const std::exception &e)
+	{
+		// The shader is reflected again next time
+		LOGW("Failed to write reflection cache {}: {}", cache_path, e.what());
+	}
+}
+
 void SPIRVReflection::parse_shader_resources(const spirv_cross::Compiler &compiler, VkShaderStageFlagBits stage, std::vector<ShaderResource> &resources, const ShaderVariant &variant)
 {
 	read_shader_resource<ShaderResourceType::Input>(compiler, stage, resources, variant);
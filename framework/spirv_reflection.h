@@ -34,6 +34,22 @@ namespace vkb
 class SPIRVReflection
 {
   public:
+	/// @brief Sets whether the reflected resources are cached in the temporary directory, next to the cached SPIRV code, enabled by default
+	///        The cache is keyed by the code, the stage and the runtime array sizes of the variant, so shaders reflected before
+	///        skip SPIRV-Cross.
+	static void set_cache_enabled(bool enabled);
+
+	/// @brief Serializes everything the reflected resources of a shader depend on
+	///        It keys the resources in the reflection cache and in the ShaderArchive, which reflect_shader_resources looks up first.
+	static std::vector<uint8_t> get_resources_key(VkShaderStageFlagBits stage, const std::vector<uint32_t> &spirv, const ShaderVariant &variant);
+
+	/// @brief Serializes reflected resources, as stored in the reflection cache and in the ShaderArchive
+	static std::vector<uint8_t> serialize_resources(const std::vector<ShaderResource> &resources);
+
+	/// @brief Reads serialized resources, appending them to the list
+	/// @return False if the data is truncated, the list is then left unchanged
+	static bool deserialize_resources(const uint8_t *data, size_t data_size, uint64_t resource_count, std::vector<ShaderResource> &resources);
+
 	/// @brief Reflects shader resources from SPIRV code
 	/// @param stage The Vulkan shader stage flag
 	/// @param spirv The SPIRV code of shader
@@ -45,6 +61,13 @@ class SPIRVReflection
 	                              const ShaderVariant         &variant);
 
   private:
+	static bool cache_enabled;
+
+	/// @brief Reads the resources of a shader from the cache, if it was reflected with the same key before
+	static bool load_cached_resources(const std::string &cache_path, const std::vector<uint8_t> &cache_key, std::vector<ShaderResource> &resources);
+
+	static void write_cached_resources(const std::string &cache_path, const std::vector<uint8_t> &cache_key, const std::vector<ShaderResource> &resources);
+
 	void parse_shader_resources(const spirv_cross::Compiler &compiler,
 	                            VkShaderStageFlagBits        stage,
 	                            std::vector<ShaderResource> &resources,
@@ -0,0 +1,85 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "draw_stats_provider.h"
+
+#include <algorithm>
+#include <array>
+
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+namespace
+{
+/// Stat of the draws at each level of detail
+constexpr std::array<StatIndex, MaxLodCount> LodStats{StatIndex::lod0_draws, StatIndex::lod1_draws, StatIndex::lod2_draws, StatIndex::lod3_draws};
+}        // namespace
+
+DrawStatsProvider::DrawStatsProvider(std::set<StatIndex> &requested_stats, RenderContext &render_context) :
+    render_context{render_context}
+{
+	// Draw counts are always available, stop other providers looking for them
+	requested_stats.erase(StatIndex::visible_draws);
+	requested_stats.erase(StatIndex::culled_draws);
+	requested_stats.erase(StatIndex::occluded_draws);
+	for (auto index : LodStats)
+	{
+		requested_stats.erase(index);
+	}
+	requested_stats.erase(StatIndex::queue_submits);
+	requested_stats.erase(StatIndex::redundant_commands);
+
+	// The latency is only measured when the presents can be waited for
+	if (render_context.get_frame_pacer().is_present_wait_enabled())
+	{
+		requested_stats.erase(StatIndex::frame_latency);
+	}
+}
+
+bool DrawStatsProvider::is_available(StatIndex index) const
+{
+	return index == StatIndex::visible_draws || index == StatIndex::culled_draws || index == StatIndex::occluded_draws ||
+	       std::find(LodStats.begin(), LodStats.end(), index) != LodStats.end() || index == StatIndex::queue_submits ||
+	       index == StatIndex::redundant_commands ||
+	       (index == StatIndex::frame_latency && render_context.get_frame_pacer().is_present_wait_enabled());
+}
+
+StatsProvider::Counters DrawStatsProvider::sample(float delta_time)
+{
+	auto draw_counts = render_context.reset_draw_counts();
+
+	Counters res;
+	res[StatIndex::visible_draws].result  = static_cast<double>(draw_counts.visible);
+	res[StatIndex::culled_draws].result   = static_cast<double>(draw_counts.culled);
+	res[StatIndex::occluded_draws].result = static_cast<double>(draw_counts.occluded);
+	res[StatIndex::queue_submits].result  = static_cast<double>(render_context.reset_submit_count());
+
+	res[StatIndex::redundant_commands].result = static_cast<double>(render_context.reset_redundant_command_count());
+
+	for (size_t i = 0; i < LodStats.size(); ++i)
+	{
+		res[LodStats[i]].result = static_cast<double>(draw_counts.lods[i]);
+	}
+
+	if (render_context.get_frame_pacer().is_present_wait_enabled())
+	{
+		res[StatIndex::frame_latency].result = render_context.get_frame_pacer().get_latency();
+	}
+	return res;
+}
+}        // namespace vkb
@@ -0,0 +1,153 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gpu_time_stats_provider.h"
+
+#include <algorithm>
+
+#include "core/util/logging.hpp"
+
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+namespace
+{
+StatIndex get_pass_stat(uint32_t pass)
+{
+	return static_cast<StatIndex>(static_cast<uint32_t>(StatIndex::gpu_pass_time_0) + pass);
+}
+
+bool is_gpu_time_stat(StatIndex index)
+{
+	return index >= StatIndex::gpu_time && index <= StatIndex::gpu_compute_invocations;
+}
+
+bool is_pipeline_statistics_stat(StatIndex index)
+{
+	return index >= StatIndex::gpu_input_primitives && index <= StatIndex::gpu_compute_invocations;
+}
+}        // namespace
+
+GpuTimeStatsProvider::GpuTimeStatsProvider(std::set<StatIndex> &requested_stats, RenderContext &render_context) :
+    render_context{render_context}
+{
+	bool requested = false;
+	for (auto index : requested_stats)
+	{
+		if (is_gpu_time_stat(index))
+		{
+			requested = true;
+			graph_data.emplace(index, default_graph_data(index));
+		}
+	}
+
+	if (!requested || !render_context.enable_gpu_frame_timing())
+	{
+		graph_data.clear();
+		return;
+	}
+
+	bool statistics_requested = std::any_of(graph_data.begin(), graph_data.end(), [](const auto &it) { return is_pipeline_statistics_stat(it.first); });
+	if (statistics_requested && !render_context.get_gpu_frame_timer()->enable_pipeline_statistics())
+	{
+		LOGW("The device doesn't support pipeline statistics queries, the shader invocations aren't counted");
+
+		for (auto it = graph_data.begin(); it != graph_data.end();)
+		{
+			it = is_pipeline_statistics_stat(it->first) ? graph_data.erase(it) : std::next(it);
+		}
+	}
+
+	for (auto &it : graph_data)
+	{
+		requested_stats.erase(it.first);
+	}
+}
+
+bool GpuTimeStatsProvider::is_available(StatIndex index) const
+{
+	return graph_data.count(index) != 0;
+}
+
+const StatGraphData &GpuTimeStatsProvider::get_graph_data(StatIndex index) const
+{
+	assert(is_available(index) && "GpuTimeStatsProvider::get_graph_data() called with invalid StatIndex");
+	return graph_data.at(index);
+}
+
+StatsProvider::Counters GpuTimeStatsProvider::sample(float delta_time)
+{
+	Counters res;
+
+	auto *gpu_frame_timer = render_context.get_gpu_frame_timer();
+	if (graph_data.empty() || !gpu_frame_timer)
+	{
+		return res;
+	}
+
+	res[StatIndex::gpu_time].result = gpu_frame_timer->get_frame_time();
+
+	// Measured with a calibration of the timestamps only, zero otherwise
+	res[StatIndex::gpu_submit_latency].result = gpu_frame_timer->get_submit_latency();
+
+	auto &pass_times = gpu_frame_timer->get_pass_times();
+	for (uint32_t pass = 0; pass < GpuFrameTimer::MaxPasses; ++pass)
+	{
+		auto index = get_pass_stat(pass);
+		if (pass < pass_times.size())
+		{
+			res[index].result = pass_times[pass].time;
+
+			auto it = graph_data.find(index);
+			if (it != graph_data.end())
+			{
+				it->second.name = pass_times[pass].name;
+			}
+		}
+		else
+		{
+			res[index].result = 0.0;
+		}
+	}
+
+	// Totals of the passes, the work recorded outside of them isn't counted
+	if (gpu_frame_timer->is_pipeline_statistics_enabled())
+	{
+		GpuFrameTimer::PipelineStatistics totals;
+		for (auto &pass : pass_times)
+		{
+			if (pass.has_statistics)
+			{
+				totals.input_assembly_primitives += pass.statistics.input_assembly_primitives;
+				totals.clipping_primitives += pass.statistics.clipping_primitives;
+				totals.vertex_shader_invocations += pass.statistics.vertex_shader_invocations;
+				totals.fragment_shader_invocations += pass.statistics.fragment_shader_invocations;
+				totals.compute_shader_invocations += pass.statistics.compute_shader_invocations;
+			}
+		}
+
+		res[StatIndex::gpu_input_primitives].result     = static_cast<double>(totals.input_assembly_primitives);
+		res[StatIndex::gpu_clipped_primitives].result   = static_cast<double>(totals.clipping_primitives);
+		res[StatIndex::gpu_vertex_invocations].result   = static_cast<double>(totals.vertex_shader_invocations);
+		res[StatIndex::gpu_fragment_invocations].result = static_cast<double>(totals.fragment_shader_invocations);
+		res[StatIndex::gpu_compute_invocations].result  = static_cast<double>(totals.compute_shader_invocations);
+	}
+
+	return res;
+}
+}        // namespace vkb
@@ -0,0 +1,71 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "stats_provider.h"
+
+namespace vkb
+{
+class RenderContext;
+
+/**
+ * @brief Reports the GPU time of the frames of a RenderContext and of the passes of its render and postprocessing pipelines
+ *
+ * Requesting any of these stats enables GPU frame timing on the render context. The times are read a few frames after
+ * their rendering without stalling, see GpuFrameTimer. The graphs of the passes are named after them. The latency
+ * between the submission of a frame and the GPU starting it needs VK_EXT_calibrated_timestamps.
+ *
+ * Requesting the primitive or shader invocation stats also counts the pipeline statistics of the passes, summed over the
+ * passes of each frame, which needs the pipelineStatisticsQuery feature, see GpuFrameTimer::enable_pipeline_statistics().
+ */
+class GpuTimeStatsProvider : public StatsProvider
+{
+  public:
+	/**
+	 * @brief Constructs a GpuTimeStatsProvider
+	 * @param requested_stats Set of stats to be collected. Supported stats will be removed from the set.
+	 * @param render_context The RenderContext whose frames are timed
+	 */
+	GpuTimeStatsProvider(std::set<StatIndex> &requested_stats, RenderContext &render_context);
+
+	/**
+	 * @brief Checks if this provider can supply the given enabled stat
+	 * @param index The stat index
+	 * @return True if the stat is available, false otherwise
+	 */
+	bool is_available(StatIndex index) const override;
+
+	/**
+	 * @brief Retrieve graphing data for the given enabled stat
+	 * @param index The stat index
+	 */
+	const StatGraphData &get_graph_data(StatIndex index) const override;
+
+	/**
+	 * @brief Retrieve a new sample set
+	 * @param delta_time Time since last sample
+	 */
+	Counters sample(float delta_time) override;
+
+  private:
+	RenderContext &render_context;
+
+	/// Graph data of the stats, renamed after the passes
+	std::map<StatIndex, StatGraphData> graph_data;
+};
+}        // namespace vkb
@@ -0,0 +1,82 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory_stats_provider.h"
+
+#include "core/allocated.h"
+
+namespace vkb
+{
+namespace
+{
+bool is_memory_stat(StatIndex index)
+{
+	return index >= StatIndex::cpu_heap_allocations && index <= StatIndex::gpu_memory_staging;
+}
+}        // namespace
+
+MemoryStatsProvider::MemoryStatsProvider(std::set<StatIndex> &requested_stats) :
+    previous_heap_allocations{get_heap_allocation_counters()}
+{
+	// Memory accounting is always available, stop other providers looking for it
+	for (auto it = requested_stats.begin(); it != requested_stats.end();)
+	{
+		it = is_memory_stat(*it) ? requested_stats.erase(it) : std::next(it);
+	}
+}
+
+bool MemoryStatsProvider::is_available(StatIndex index) const
+{
+	return is_memory_stat(index);
+}
+
+StatsProvider::Counters MemoryStatsProvider::sample(float delta_time)
+{
+	Counters res;
+
+	auto heap_allocations = get_heap_allocation_counters();
+
+	res[StatIndex::cpu_heap_allocations].result      = static_cast<double>(heap_allocations.allocations - previous_heap_allocations.allocations);
+	res[StatIndex::cpu_heap_allocation_bytes].result = static_cast<double>(heap_allocations.bytes - previous_heap_allocations.bytes);
+
+	previous_heap_allocations = heap_allocations;
+
+	auto &allocator = allocated::get_memory_allocator();
+	if (allocator != VK_NULL_HANDLE)
+	{
+		const VkPhysicalDeviceMemoryProperties *memory_properties{nullptr};
+		vmaGetMemoryProperties(allocator, &memory_properties);
+
+		VmaBudget heap_budgets[VK_MAX_MEMORY_HEAPS];
+		vmaGetHeapBudgets(allocator, heap_budgets);
+
+		VkDeviceSize usage = 0;
+		for (uint32_t heap = 0; heap < memory_properties->memoryHeapCount; ++heap)
+		{
+			usage += heap_budgets[heap].usage;
+		}
+		res[StatIndex::gpu_memory_usage].result = static_cast<double>(usage);
+	}
+
+	res[StatIndex::gpu_memory_buffers].result        = static_cast<double>(allocated::get_memory_usage(allocated::MemoryCategory::Buffers));
+	res[StatIndex::gpu_memory_images].result         = static_cast<double>(allocated::get_memory_usage(allocated::MemoryCategory::Images));
+	res[StatIndex::gpu_memory_render_targets].result = static_cast<double>(allocated::get_memory_usage(allocated::MemoryCategory::RenderTargets));
+	res[StatIndex::gpu_memory_staging].result        = static_cast<double>(allocated::get_memory_usage(allocated::MemoryCategory::Staging));
+
+	return res;
+}
+}        // namespace vkb
@@ -0,0 +1,93 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "molten_vk_stats_provider.h"
+
+#include "core/device.h"
+#include "core/portability.h"
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+namespace
+{
+bool is_molten_vk_stat(StatIndex index)
+{
+	return index >= StatIndex::molten_vk_spirv_to_msl_time && index <= StatIndex::molten_vk_msl_load_time;
+}
+}        // namespace
+
+MoltenVkStatsProvider::MoltenVkStatsProvider(std::set<StatIndex> &requested_stats, RenderContext &render_context) :
+    render_context{render_context}
+{
+	auto &device = render_context.get_device();
+	if (!portability::is_molten_vk(device.get_gpu()))
+	{
+		return;
+	}
+
+	// Not a Vulkan command, the loader forwards it to MoltenVK as an unknown device function
+	get_performance_statistics = reinterpret_cast<decltype(get_performance_statistics)>(vkGetDeviceProcAddr(device.get_handle(), "vkGetPerformanceStatisticsMVK"));
+	if (!get_performance_statistics || !get_statistics(previous_statistics))
+	{
+		get_performance_statistics = nullptr;
+		return;
+	}
+
+	for (auto it = requested_stats.begin(); it != requested_stats.end();)
+	{
+		it = is_molten_vk_stat(*it) ? requested_stats.erase(it) : std::next(it);
+	}
+}
+
+bool MoltenVkStatsProvider::is_available(StatIndex index) const
+{
+	return get_performance_statistics && is_molten_vk_stat(index);
+}
+
+StatsProvider::Counters MoltenVkStatsProvider::sample(float delta_time)
+{
+	Counters res;
+
+	PerformanceStatistics statistics{};
+	if (!get_statistics(statistics))
+	{
+		return res;
+	}
+
+	// The trackers keep the average time, in milliseconds
+	auto get_time = [&](PerformanceTracker PerformanceStatistics::*tracker) {
+		return (statistics.*tracker).count * (statistics.*tracker).average - (previous_statistics.*tracker).count * (previous_statistics.*tracker).average;
+	};
+
+	res[StatIndex::molten_vk_spirv_to_msl_time].result = get_time(&PerformanceStatistics::spirv_to_msl);
+	res[StatIndex::molten_vk_msl_compile_time].result  = get_time(&PerformanceStatistics::msl_compile);
+	res[StatIndex::molten_vk_msl_load_time].result     = get_time(&PerformanceStatistics::msl_load);
+
+	previous_statistics = statistics;
+
+	return res;
+}
+
+bool MoltenVkStatsProvider::get_statistics(PerformanceStatistics &statistics) const
+{
+	// VK_INCOMPLETE as the statistics of MoltenVK are larger than the members read here
+	size_t   size   = sizeof(statistics);
+	VkResult result = get_performance_statistics(render_context.get_device().get_handle(), &statistics, &size);
+	return result == VK_SUCCESS || result == VK_INCOMPLETE;
+}
+}        // namespace vkb
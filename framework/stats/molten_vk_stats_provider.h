@@ -0,0 +1,92 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "common/vk_common.h"
+#include "stats_provider.h"
+
+namespace vkb
+{
+class RenderContext;
+
+/**
+ * @brief Reports the time MoltenVK spent translating and compiling shaders since the previous sample
+ *
+ * The times come from vkGetPerformanceStatisticsMVK, only recorded by MoltenVK when MVK_CONFIG_PERFORMANCE_TRACKING
+ * is set in the environment. The MSL load time is spent on the shaders found in the pipeline cache, which skip their
+ * translation, see portability::Settings::persistent_pipeline_cache.
+ */
+class MoltenVkStatsProvider : public StatsProvider
+{
+  public:
+	/**
+	 * @brief Constructs a MoltenVkStatsProvider
+	 * @param requested_stats Set of stats to be collected. Supported stats will be removed from the set.
+	 * @param render_context The RenderContext whose device is implemented by MoltenVK
+	 */
+	MoltenVkStatsProvider(std::set<StatIndex> &requested_stats, RenderContext &render_context);
+
+	/**
+	 * @brief Checks if this provider can supply the given enabled stat
+	 * @param index The stat index
+	 * @return True if the stat is available, false otherwise
+	 */
+	bool is_available(StatIndex index) const override;
+
+	/**
+	 * @brief Retrieve a new sample set
+	 * @param delta_time Time since last sample
+	 */
+	Counters sample(float delta_time) override;
+
+  private:
+	/**
+	 * @brief Layout of MVKPerformanceTracker in the private API of MoltenVK
+	 */
+	struct PerformanceTracker
+	{
+		uint32_t count;
+		double   latest;
+		double   average;
+		double   minimum;
+		double   maximum;
+	};
+
+	/**
+	 * @brief Leading members of MVKPerformanceStatistics, MoltenVK only copies the size requested
+	 */
+	struct PerformanceStatistics
+	{
+		PerformanceTracker hash_shader_code;
+		PerformanceTracker spirv_to_msl;
+		PerformanceTracker msl_compile;
+		PerformanceTracker msl_load;
+	};
+
+	/**
+	 * @return Whether the statistics of the device were copied
+	 */
+	bool get_statistics(PerformanceStatistics &statistics) const;
+
+	RenderContext &render_context;
+
+	VkResult (*get_performance_statistics)(VkDevice, PerformanceStatistics *, size_t *){nullptr};
+
+	PerformanceStatistics previous_statistics{};
+};
+}        // namespace vkb
@@ -0,0 +1,53 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pipeline_stats_provider.h"
+
+#include "core/device.h"
+#include "rendering/render_context.h"
+
+namespace vkb
+{
+PipelineStatsProvider::PipelineStatsProvider(std::set<StatIndex> &requested_stats, RenderContext &render_context) :
+    render_context{render_context},
+    previous_totals{render_context.get_device().get_resource_cache().GetPipelineCreationTotals()}
+{
+	// Pipeline creations are always available, stop other providers looking for them
+	requested_stats.erase(StatIndex::pipeline_creations);
+	requested_stats.erase(StatIndex::pipeline_creation_time);
+	requested_stats.erase(StatIndex::pipeline_cache_hits);
+}
+
+bool PipelineStatsProvider::is_available(StatIndex index) const
+{
+	return index == StatIndex::pipeline_creations || index == StatIndex::pipeline_creation_time || index == StatIndex::pipeline_cache_hits;
+}
+
+StatsProvider::Counters PipelineStatsProvider::sample(float delta_time)
+{
+	auto totals = render_context.get_device().get_resource_cache().GetPipelineCreationTotals();
+
+	Counters res;
+	res[StatIndex::pipeline_creations].result     = static_cast<double>(totals.pipelines - previous_totals.pipelines);
+	res[StatIndex::pipeline_creation_time].result = totals.duration_ms - previous_totals.duration_ms;
+	res[StatIndex::pipeline_cache_hits].result    = static_cast<double>(totals.cache_hits - previous_totals.cache_hits);
+
+	previous_totals = totals;
+
+	return res;
+}
+}        // namespace vkb
@@ -19,11 +19,17 @@
 #include "stats/stats.h"
 
 #include <core/util/profiling.hpp>
+#include <core/util/thread_role.hpp>
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.hpp>
 
 #include "core/device.h"
+#include "draw_stats_provider.h"
 #include "frame_time_stats_provider.h"
+#include "gpu_time_stats_provider.h"
+#include "memory_stats_provider.h"
+#include "molten_vk_stats_provider.h"
+#include "pipeline_stats_provider.h"
 #ifdef VK_USE_PLATFORM_ANDROID_KHR
 #	include "hwcpipe_stats_provider.h"
 #endif
@@ -33,6 +39,52 @@
 
 namespace vkb
 {
+StatHistory::StatHistory(size_t capacity) :
+    values(capacity, 0.0f)
+{
+}
+
+void StatHistory::push(float value)
+{
+	values[head] = value;
+	head         = (head + 1) % values.size();
+}
+
+float StatHistory::back() const
+{
+	return values[(head + values.size() - 1) % values.size()];
+}
+
+void StatHistory::resize(size_t capacity)
+{
+	// Linearize the newest values at the end of the new ring, its head is then at the start
+	std::vector<float> resized(capacity, 0.0f);
+
+	size_t kept = std::min(capacity, values.size());
+	for (size_t i = 0; i < kept; ++i)
+	{
+		resized[capacity - kept + i] = values[(head + values.size() - kept + i) % values.size()];
+	}
+
+	values = std::move(resized);
+	head   = 0;
+}
+
+size_t StatHistory::size() const
+{
+	return values.size();
+}
+
+size_t StatHistory::get_head() const
+{
+	return head;
+}
+
+const std::vector<float> &StatHistory::get_values() const
+{
+	return values;
+}
+
 Stats::Stats(RenderContext &render_context, size_t buffer_size) :
     render_context(render_context),
     buffer_size(buffer_size)
@@ -71,6 +123,13 @@ void Stats::request_stats(const std::set<StatIndex> &wanted_stats,
 	// All supported stats will be removed from the given 'stats' set by the provider's constructor
 	// so subsequent providers only see requests for stats that aren't already supported.
 	providers.emplace_back(std::make_unique<FrameTimeStatsProvider>(stats));
+	providers.emplace_back(std::make_unique<DrawStatsProvider>(stats, render_context));
+	providers.emplace_back(std::make_unique<PipelineStatsProvider>(stats, render_context));
+	providers.emplace_back(std::make_unique<GpuTimeStatsProvider>(stats, render_context));
+	providers.emplace_back(std::make_unique<MemoryStatsProvider>(stats));
+#ifdef VKB_ENABLE_PORTABILITY
+	providers.emplace_back(std::make_unique<MoltenVkStatsProvider>(stats, render_context));
+#endif
 #ifdef VK_USE_PLATFORM_ANDROID_KHR
 	providers.emplace_back(std::make_unique<HWCPipeStatsProvider>(stats));
 #endif
@@ -82,11 +141,17 @@ void Stats::request_stats(const std::set<StatIndex> &wanted_stats,
 
 	for (const auto &stat : requested_stats)
 	{
-		counters[stat] = std::vector<float>(buffer_size, 0);
+		counters[stat] = StatHistory(buffer_size);
 	}
 
 	if (sampling_config.mode == CounterSamplingMode::Continuous)
 	{
+		continuous_samples.resize(ContinuousSampleCapacity);
+		for (auto &sample : continuous_samples)
+		{
+			sample.reserve(requested_stats.size());
+		}
+
 		// Start a thread for continuous sample capture
 		stop_worker = std::make_unique<std::promise<void>>();
 
@@ -116,7 +181,6 @@ void Stats::resize(const size_t width)
 	for (auto &counter : counters)
 	{
 		counter.second.resize(buffer_size);
-		counter.second.shrink_to_fit();
 	}
 }
 
@@ -132,18 +196,12 @@ bool Stats::is_available(const StatIndex index) const
 	return false;
 }
 
-static void add_smoothed_value(std::vector<float> &values, float value, float alpha)
+static void add_smoothed_value(StatHistory &values, float value, float alpha)
 {
 	assert(values.size() >= 2 && "Buffers size should be greater than 2");
 
-	if (values.size() == values.capacity())
-	{
-		// Shift values to the left to make space at the end and update counters
-		std::rotate(values.begin(), values.begin() + 1, values.end());
-	}
-
 	// Use an exponential moving average to smooth values
-	values.back() = value * alpha + *(values.end() - 2) * (1.0f - alpha);
+	values.push(value * alpha + values.back() * (1.0f - alpha));
 }
 
 void Stats::update(float delta_time)
@@ -164,37 +222,21 @@ void Stats::update(float delta_time)
 		}
 		case CounterSamplingMode::Continuous:
 		{
-			// Check that we have no pending samples to be shown
-			if (pending_samples.size() == 0)
-			{
-				std::unique_lock<std::mutex> lock(continuous_sampling_mutex);
-				if (!should_add_to_continuous_samples)
-				{
-					// If we have no pending samples, we let the worker thread
-					// capture samples for the next frame
-					should_add_to_continuous_samples = true;
-				}
-				else
-				{
-					// The worker thread has captured a frame, so we stop it
-					// and read the samples
-					should_add_to_continuous_samples = false;
-					pending_samples.clear();
-					std::swap(pending_samples, continuous_samples);
-				}
-			}
+			// The samples up to the write index are complete, and the worker thread doesn't touch them until they are read
+			auto   read          = continuous_read_index.load(std::memory_order_relaxed);
+			size_t pending_count = continuous_write_index.load(std::memory_order_acquire) - read;
 
-			if (pending_samples.size() == 0)
+			if (pending_count == 0)
 			{
 				return;
 			}
 
 			// Ensure the number of pending samples is capped at a reasonable value
-			if (pending_samples.size() > 100)
+			if (pending_count > MaxPendingSamples)
 			{
-				// Prefer later samples over new samples.
-				std::move(pending_samples.end() - 100, pending_samples.end(), pending_samples.begin());
-				pending_samples.erase(pending_samples.begin() + 100, pending_samples.end());
+				// Prefer later samples over older samples.
+				read += pending_count - MaxPendingSamples;
+				pending_count = MaxPendingSamples;
 
 				// If we get to this point, we're not reading samples fast enough, nudge a little ahead.
 				fractional_pending_samples += 1.0f;
@@ -210,19 +252,28 @@ void Stats::update(float delta_time)
 			auto sample_count = static_cast<size_t>(floating_sample_count);
 
 			// Clamp the number of samples
-			sample_count = std::max<size_t>(1, std::min<size_t>(sample_count, pending_samples.size()));
+			sample_count = std::max<size_t>(1, std::min<size_t>(sample_count, pending_count));
 
 			// Get the frame time stats (not a continuous stat)
 			StatsProvider::Counters frame_time_sample = frame_time_provider->sample(delta_time);
 
 			// Push the samples to circular buffers
-			std::for_each(pending_samples.begin(), pending_samples.begin() + sample_count, [this, frame_time_sample](auto &s) {
+			for (size_t i = 0; i < sample_count; ++i)
+			{
+				auto &s = continuous_samples[(read + i) % continuous_samples.size()];
+
 				// Write the correct frame time into the continuous stats
-				s.insert(frame_time_sample.begin(), frame_time_sample.end());
+				for (auto &counter : frame_time_sample)
+				{
+					s[counter.first] = counter.second;
+				}
+
 				// Then push the sample to the counters list
-				this->push_sample(s);
-			});
-			pending_samples.erase(pending_samples.begin(), pending_samples.begin() + sample_count);
+				push_sample(s);
+			}
+
+			// Hand the slots back to the worker thread
+			continuous_read_index.store(read + sample_count, std::memory_order_release);
 
 			break;
 		}
@@ -233,6 +284,8 @@ void Stats::update(float delta_time)
 
 void Stats::continuous_sampling_worker(std::future<void> should_terminate)
 {
+	set_current_thread_role(ThreadRole::Background);
+
 	worker_timer.tick();
 
 	for (auto &p : providers)
@@ -252,21 +305,28 @@ void Stats::continuous_sampling_worker(std::future<void> should_terminate)
 			delta_time += static_cast<float>(worker_timer.tick());
 		}
 
-		// Sample counters
-		StatsProvider::Counters sample;
+		// Counters are sampled even if the ring is full, as the providers measure the time between two samples
+		auto write = continuous_write_index.load(std::memory_order_relaxed);
+		bool full  = write - continuous_read_index.load(std::memory_order_acquire) >= continuous_samples.size();
+
+		auto &slot = continuous_samples[write % continuous_samples.size()];
 		for (auto &p : providers)
 		{
 			StatsProvider::Counters s = p->continuous_sample(delta_time);
-			sample.insert(s.begin(), s.end());
+			if (!full)
+			{
+				// Assigning keeps the nodes of the slot, the providers sample the same stats every time
+				for (auto &counter : s)
+				{
+					slot[counter.first] = counter.second;
+				}
+			}
 		}
 
-		// Add the new sample to the vector of continuous samples
+		// Publish the new sample to the main thread, the oldest samples are kept while it is behind
+		if (!full)
 		{
-			std::unique_lock<std::mutex> lock(continuous_sampling_mutex);
-			if (should_add_to_continuous_samples)
-			{
-				continuous_samples.push_back(sample);
-			}
+			continuous_write_index.store(write + 1, std::memory_order_release);
 		}
 	}
 }
@@ -275,8 +335,8 @@ void Stats::push_sample(const StatsProvider::Counters &sample)
 {
 	for (auto &c : counters)
 	{
-		StatIndex           idx    = c.first;
-		std::vector<float> &values = c.second;
+		StatIndex    idx    = c.first;
+		StatHistory &values = c.second;
 
 		// Find the counter matching this StatIndex in the Sample
 		const auto &smp = sample.find(idx);
@@ -358,6 +418,90 @@ const char *to_string(StatIndex index)
 			return "External Read Bytes (MiB/s)";
 		case StatIndex::gpu_ext_write_bytes:
 			return "External Write Bytes (MiB/s)";
+		case StatIndex::gpu_vendor_counter_0:
+			return "GPU Vendor Counter 0";
+		case StatIndex::gpu_vendor_counter_1:
+			return "GPU Vendor Counter 1";
+		case StatIndex::gpu_vendor_counter_2:
+			return "GPU Vendor Counter 2";
+		case StatIndex::gpu_vendor_counter_3:
+			return "GPU Vendor Counter 3";
+		case StatIndex::visible_draws:
+			return "Visible Draws";
+		case StatIndex::culled_draws:
+			return "Culled Draws";
+		case StatIndex::occluded_draws:
+			return "Occluded Draws";
+		case StatIndex::lod0_draws:
+			return "LOD 0 Draws";
+		case StatIndex::lod1_draws:
+			return "LOD 1 Draws";
+		case StatIndex::lod2_draws:
+			return "LOD 2 Draws";
+		case StatIndex::lod3_draws:
+			return "LOD 3 Draws";
+		case StatIndex::queue_submits:
+			return "Queue Submits";
+		case StatIndex::redundant_commands:
+			return "Redundant Commands";
+		case StatIndex::frame_latency:
+			return "Frame Latency (ms)";
+		case StatIndex::pipeline_creations:
+			return "Pipelines Created";
+		case StatIndex::pipeline_creation_time:
+			return "Pipeline Creation Time (ms)";
+		case StatIndex::pipeline_cache_hits:
+			return "Pipeline Cache Hits";
+		case StatIndex::gpu_time:
+			return "GPU Time (ms)";
+		case StatIndex::gpu_pass_time_0:
+			return "GPU Pass 0 Time (ms)";
+		case StatIndex::gpu_pass_time_1:
+			return "GPU Pass 1 Time (ms)";
+		case StatIndex::gpu_pass_time_2:
+			return "GPU Pass 2 Time (ms)";
+		case StatIndex::gpu_pass_time_3:
+			return "GPU Pass 3 Time (ms)";
+		case StatIndex::gpu_pass_time_4:
+			return "GPU Pass 4 Time (ms)";
+		case StatIndex::gpu_pass_time_5:
+			return "GPU Pass 5 Time (ms)";
+		case StatIndex::gpu_pass_time_6:
+			return "GPU Pass 6 Time (ms)";
+		case StatIndex::gpu_pass_time_7:
+			return "GPU Pass 7 Time (ms)";
+		case StatIndex::gpu_submit_latency:
+			return "GPU Submit Latency (ms)";
+		case StatIndex::gpu_input_primitives:
+			return "Input Primitives";
+		case StatIndex::gpu_clipped_primitives:
+			return "Primitives After Clipping";
+		case StatIndex::gpu_vertex_invocations:
+			return "Vertex Shader Invocations";
+		case StatIndex::gpu_fragment_invocations:
+			return "Fragment Shader Invocations";
+		case StatIndex::gpu_compute_invocations:
+			return "Compute Shader Invocations";
+		case StatIndex::cpu_heap_allocations:
+			return "CPU Heap Allocations";
+		case StatIndex::cpu_heap_allocation_bytes:
+			return "CPU Heap Allocated Bytes (KiB)";
+		case StatIndex::gpu_memory_usage:
+			return "Device Memory Usage (MiB)";
+		case StatIndex::gpu_memory_buffers:
+			return "Buffer Memory (MiB)";
+		case StatIndex::gpu_memory_images:
+			return "Image Memory (MiB)";
+		case StatIndex::gpu_memory_render_targets:
+			return "Render Target Memory (MiB)";
+		case StatIndex::gpu_memory_staging:
+			return "Staging Memory (MiB)";
+		case StatIndex::molten_vk_spirv_to_msl_time:
+			return "SPIR-V to MSL Time (ms)";
+		case StatIndex::molten_vk_msl_compile_time:
+			return "MSL Compile Time (ms)";
+		case StatIndex::molten_vk_msl_load_time:
+			return "MSL Load Time (ms)";
 		default:
 			return nullptr;
 	}
@@ -367,6 +511,8 @@ const char *to_string(StatIndex index)
 void Stats::profile_counters() const
 {
 #if VKB_PROFILING
+	profile_resource_cache();
+
 	static std::chrono::high_resolution_clock::time_point last_time = std::chrono::high_resolution_clock::now();
 	std::chrono::high_resolution_clock::time_point        now       = std::chrono::high_resolution_clock::now();
 
@@ -382,13 +528,14 @@ void Stats::profile_counters() const
 		StatIndex idx        = c.first;
 		auto     &graph_data = get_graph_data(idx);
 
-		if (c.second.empty())
+		if (c.second.size() == 0)
 		{
 			continue;
 		}
 
+		// The average doesn't depend on the order of the values, so the ring is read from its start
 		float average = 0.0f;
-		for (auto &v : c.second)
+		for (auto &v : c.second.get_values())
 		{
 			average += v;
 		}
@@ -430,6 +577,48 @@ void Stats::profile_counters() const
 #endif
 }
 
+void Stats::profile_resource_cache() const
+{
+#if VKB_PROFILING
+	// Totals of the previous frame, the rates are plotted for the lookups done since
+	static ResourceCacheCounters last_all{};
+	static ResourceCacheCounters last_descriptor_sets{};
+
+	auto cache_stats = render_context.get_device().get_resource_cache().GetStats();
+
+	ResourceCacheCounters all{};
+	for (auto *counters : {&cache_stats.shader_modules, &cache_stats.pipeline_layouts, &cache_stats.descriptor_set_layouts,
+	                       &cache_stats.render_passes, &cache_stats.graphics_pipelines, &cache_stats.graphics_pipeline_libraries,
+	                       &cache_stats.compute_pipelines, &cache_stats.shader_objects, &cache_stats.descriptor_sets, &cache_stats.framebuffers})
+	{
+		all.hits += counters->hits;
+		all.misses += counters->misses;
+		all.evictions += counters->evictions;
+	}
+
+	auto plot_hit_rate = [](const char *name, const ResourceCacheCounters &counters, ResourceCacheCounters &last) {
+		// The counters start again from zero after ResourceCache::ResetStats
+		if (counters.hits < last.hits || counters.misses < last.misses)
+		{
+			last = {};
+		}
+
+		uint64_t hits    = counters.hits - last.hits;
+		uint64_t lookups = hits + counters.misses - last.misses;
+		last             = counters;
+
+		if (lookups > 0)
+		{
+			Plot<float, PlotType::Percentage>::plot(name, 100.0f * static_cast<float>(hits) / static_cast<float>(lookups));
+		}
+	};
+
+	plot_hit_rate("Resource Cache Hit Rate", all, last_all);
+	plot_hit_rate("Descriptor Set Cache Hit Rate", cache_stats.descriptor_sets, last_descriptor_sets);
+	Plot<int64_t>::plot("Resource Cache Evictions", static_cast<int64_t>(all.evictions));
+#endif
+}
+
 void Stats::begin_sampling(CommandBuffer &cb)
 {
 	// Inform the providers
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 #include <future>
@@ -35,6 +36,50 @@ class Device;
 class CommandBuffer;
 class RenderContext;
 
+/**
+ * @brief The last values of a stat, in a ring of fixed capacity
+ *
+ * Pushing a value overwrites the oldest one rather than shifting the others. The oldest value is
+ * at the head, so the ring can be plotted in place, e.g. with the head as values_offset of ImGui::PlotLines.
+ */
+class StatHistory
+{
+  public:
+	explicit StatHistory(size_t capacity = 0);
+
+	/**
+	 * @brief Replaces the oldest value
+	 */
+	void push(float value);
+
+	/**
+	 * @return The newest value
+	 */
+	float back() const;
+
+	/**
+	 * @brief Changes the capacity of the ring, keeping its newest values
+	 */
+	void resize(size_t capacity);
+
+	size_t size() const;
+
+	/**
+	 * @return The index of the oldest value in get_values()
+	 */
+	size_t get_head() const;
+
+	/**
+	 * @return The values from the head, wrapping around at the end
+	 */
+	const std::vector<float> &get_values() const;
+
+  private:
+	std::vector<float> values;
+
+	size_t head{0};
+};
+
 /*
  * @brief Helper class for querying statistics about the CPU and the GPU
  */
@@ -86,7 +131,7 @@ class Stats
 	 * @param index The stat index of the data requested
 	 * @return The data of the specified stat
 	 */
-	const std::vector<float> &get_data(StatIndex index) const
+	const StatHistory &get_data(StatIndex index) const
 	{
 		return counters.at(index);
 	};
@@ -162,7 +207,7 @@ class Stats
 	float alpha_smoothing{0.2f};
 
 	/// Circular buffers for counter data
-	std::map<StatIndex, std::vector<float>> counters{};
+	std::map<StatIndex, StatHistory> counters{};
 
 	/// Worker thread for continuous sampling
 	std::thread worker_thread;
@@ -170,23 +215,27 @@ class Stats
 	/// Promise to stop the worker thread
 	std::unique_ptr<std::promise<void>> stop_worker;
 
-	/// A mutex for accessing measurements during continuous sampling
-	std::mutex continuous_sampling_mutex;
+	/// Number of samples the worker thread can read ahead of the main thread
+	static constexpr size_t ContinuousSampleCapacity = 128;
+
+	/// Most samples waiting to be displayed, the older ones are skipped
+	static constexpr size_t MaxPendingSamples = 100;
 
-	/// The samples read during continuous sampling
+	/// Ring of the samples read during continuous sampling, written by the worker thread and read by the main thread
+	/// The slots are kept from one lap to the next, so the nodes of their maps are only allocated once
 	std::vector<StatsProvider::Counters> continuous_samples;
 
-	/// A flag specifying if the worker thread should add entries to continuous_samples
-	bool should_add_to_continuous_samples{false};
+	/// Number of samples written to continuous_samples, only changed by the worker thread
+	std::atomic<size_t> continuous_write_index{0};
 
-	/// The samples waiting to be displayed
-	std::vector<StatsProvider::Counters> pending_samples;
+	/// Number of samples read from continuous_samples, only changed by the main thread
+	std::atomic<size_t> continuous_read_index{0};
 
 	/// A value which helps keep a steady pace of continuous samples output.
 	float fractional_pending_samples{0.0f};
 
 	/// The worker thread function for continuous sampling;
-	/// it adds a new entry to continuous_samples at every interval
+	/// it adds a new entry to continuous_samples at every interval, unless the ring is full
 	void continuous_sampling_worker(std::future<void> should_terminate);
 
 	/// Updates circular buffers for CPU and GPU counters
@@ -194,6 +243,9 @@ class Stats
 
 	// Push counters to external profilers
 	void profile_counters() const;
+
+	// Push the hit rates of the resource cache lookups of the frame to external profilers
+	void profile_resource_cache() const;
 };
 
 }        // namespace vkb
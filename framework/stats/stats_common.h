@@ -1,4 +1,4 @@
-/* Copyright (c) 2018-2022, Arm Limited and Contributors
+/* Copyright (c) 2018-2024, Arm Limited and Contributors
  * Copyright (c) 2020-2022, Broadcom Inc.
  *
  * SPDX-License-Identifier: Apache-2.0
@@ -63,6 +63,54 @@ enum class StatIndex
 	gpu_ext_read_bytes,
 	gpu_ext_write_bytes,
 	gpu_tex_cycles,
+	gpu_vendor_counter_0,
+	gpu_vendor_counter_1,
+	gpu_vendor_counter_2,
+	gpu_vendor_counter_3,
+
+	visible_draws,
+	culled_draws,
+	occluded_draws,
+	lod0_draws,
+	lod1_draws,
+	lod2_draws,
+	lod3_draws,
+	queue_submits,
+	redundant_commands,
+	frame_latency,
+
+	pipeline_creations,
+	pipeline_creation_time,
+	pipeline_cache_hits,
+
+	gpu_time,
+	gpu_pass_time_0,
+	gpu_pass_time_1,
+	gpu_pass_time_2,
+	gpu_pass_time_3,
+	gpu_pass_time_4,
+	gpu_pass_time_5,
+	gpu_pass_time_6,
+	gpu_pass_time_7,
+	gpu_submit_latency,
+	gpu_input_primitives,
+	gpu_clipped_primitives,
+	gpu_vertex_invocations,
+	gpu_fragment_invocations,
+	gpu_compute_invocations,
+
+	cpu_heap_allocations,
+	cpu_heap_allocation_bytes,
+
+	gpu_memory_usage,
+	gpu_memory_buffers,
+	gpu_memory_images,
+	gpu_memory_render_targets,
+	gpu_memory_staging,
+
+	molten_vk_spirv_to_msl_time,
+	molten_vk_msl_compile_time,
+	molten_vk_msl_load_time,
 };
 
 struct StatIndexHash
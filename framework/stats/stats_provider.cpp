@@ -54,6 +54,54 @@ std::map<StatIndex, StatGraphData> StatsProvider::default_graph_map{
     {StatIndex::gpu_ext_write_stalls,  {"External Write Stalls",                       "{:4.1f} M/s",   static_cast<float>(1e-6)}},
     {StatIndex::gpu_ext_read_bytes,    {"External Read Bytes",                         "{:4.1f} MiB/s", 1.0f / (1024.0f * 1024.0f)}},
     {StatIndex::gpu_ext_write_bytes,   {"External Write Bytes",                        "{:4.1f} MiB/s", 1.0f / (1024.0f * 1024.0f)}},
+    {StatIndex::gpu_vendor_counter_0,  {"GPU Vendor Counter 0",                        "{:4.1f}"}},
+    {StatIndex::gpu_vendor_counter_1,  {"GPU Vendor Counter 1",                        "{:4.1f}"}},
+    {StatIndex::gpu_vendor_counter_2,  {"GPU Vendor Counter 2",                        "{:4.1f}"}},
+    {StatIndex::gpu_vendor_counter_3,  {"GPU Vendor Counter 3",                        "{:4.1f}"}},
+
+    {StatIndex::visible_draws,         {"Visible Draws",                               "{:4.0f}"}},
+    {StatIndex::culled_draws,          {"Culled Draws",                                "{:4.0f}"}},
+    {StatIndex::occluded_draws,        {"Occluded Draws",                              "{:4.0f}"}},
+    {StatIndex::lod0_draws,            {"LOD 0 Draws",                                 "{:4.0f}"}},
+    {StatIndex::lod1_draws,            {"LOD 1 Draws",                                 "{:4.0f}"}},
+    {StatIndex::lod2_draws,            {"LOD 2 Draws",                                 "{:4.0f}"}},
+    {StatIndex::lod3_draws,            {"LOD 3 Draws",                                 "{:4.0f}"}},
+    {StatIndex::queue_submits,         {"Queue Submits",                               "{:4.0f}"}},
+    {StatIndex::redundant_commands,    {"Redundant Commands",                          "{:4.0f}"}},
+    {StatIndex::frame_latency,         {"Frame Latency",                               "{:4.1f} ms"}},
+
+    {StatIndex::pipeline_creations,    {"Pipelines Created",                           "{:4.0f}"}},
+    {StatIndex::pipeline_creation_time, {"Pipeline Creation Time",                     "{:4.1f} ms"}},
+    {StatIndex::pipeline_cache_hits,   {"Pipeline Cache Hits",                         "{:4.0f}"}},
+
+    {StatIndex::gpu_time,              {"GPU Time",                                    "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_0,       {"GPU Pass 0 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_1,       {"GPU Pass 1 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_2,       {"GPU Pass 2 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_3,       {"GPU Pass 3 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_4,       {"GPU Pass 4 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_5,       {"GPU Pass 5 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_6,       {"GPU Pass 6 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_pass_time_7,       {"GPU Pass 7 Time",                             "{:4.2f} ms"}},
+    {StatIndex::gpu_submit_latency,    {"GPU Submit Latency",                          "{:4.2f} ms"}},
+    {StatIndex::gpu_input_primitives,  {"Input Primitives",                            "{:4.1f} k",     static_cast<float>(1e-3)}},
+    {StatIndex::gpu_clipped_primitives, {"Primitives After Clipping",                  "{:4.1f} k",     static_cast<float>(1e-3)}},
+    {StatIndex::gpu_vertex_invocations, {"Vertex Shader Invocations",                  "{:4.1f} k",     static_cast<float>(1e-3)}},
+    {StatIndex::gpu_fragment_invocations, {"Fragment Shader Invocations",              "{:4.2f} M",     static_cast<float>(1e-6)}},
+    {StatIndex::gpu_compute_invocations, {"Compute Shader Invocations",                "{:4.1f} k",     static_cast<float>(1e-3)}},
+
+    {StatIndex::cpu_heap_allocations,  {"CPU Heap Allocations",                        "{:4.0f}"}},
+    {StatIndex::cpu_heap_allocation_bytes, {"CPU Heap Allocated Bytes",                "{:4.1f} KiB", 1.0f / 1024.0f}},
+
+    {StatIndex::gpu_memory_usage,      {"Device Memory Usage",                         "{:4.1f} MiB", 1.0f / (1024.0f * 1024.0f)}},
+    {StatIndex::gpu_memory_buffers,    {"Buffer Memory",                               "{:4.1f} MiB", 1.0f / (1024.0f * 1024.0f)}},
+    {StatIndex::gpu_memory_images,     {"Image Memory",                                "{:4.1f} MiB", 1.0f / (1024.0f * 1024.0f)}},
+    {StatIndex::gpu_memory_render_targets, {"Render Target Memory",                    "{:4.1f} MiB", 1.0f / (1024.0f * 1024.0f)}},
+    {StatIndex::gpu_memory_staging,    {"Staging Memory",                              "{:4.1f} MiB", 1.0f / (1024.0f * 1024.0f)}},
+
+    {StatIndex::molten_vk_spirv_to_msl_time, {"SPIR-V to MSL Time",                     "{:4.1f} ms"}},
+    {StatIndex::molten_vk_msl_compile_time, {"MSL Compile Time",                       "{:4.1f} ms"}},
+    {StatIndex::molten_vk_msl_load_time, {"MSL Load Time",                             "{:4.1f} ms"}},
     // clang-format on
 };
 
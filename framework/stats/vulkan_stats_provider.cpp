@@ -21,10 +21,58 @@
 #include "rendering/render_context.h"
 #include "vulkan_stats_provider.h"
 
+#include <algorithm>
 #include <regex>
 
 namespace vkb
 {
+namespace
+{
+bool is_vendor_counter(StatIndex index)
+{
+	return index >= StatIndex::gpu_vendor_counter_0 && index <= StatIndex::gpu_vendor_counter_3;
+}
+
+// Counters measured in a rate or a ratio are shown as they are, others per second
+bool is_rate(VkPerformanceCounterUnitKHR unit)
+{
+	switch (unit)
+	{
+		case VK_PERFORMANCE_COUNTER_UNIT_PERCENTAGE_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_BYTES_PER_SECOND_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_KELVIN_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_WATTS_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_VOLTS_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_AMPS_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_HERTZ_KHR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+StatGraphData get_counter_graph_data(const VkPerformanceCounterDescriptionKHR &desc, VkPerformanceCounterUnitKHR unit)
+{
+	switch (unit)
+	{
+		case VK_PERFORMANCE_COUNTER_UNIT_PERCENTAGE_KHR:
+			return {desc.name, "{:3.1f}%", 1.0f, true, 100.0f};
+		case VK_PERFORMANCE_COUNTER_UNIT_BYTES_PER_SECOND_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_BYTES_KHR:
+			return {desc.name, "{:4.1f} MiB/s", 1.0f / (1024.0f * 1024.0f)};
+		case VK_PERFORMANCE_COUNTER_UNIT_HERTZ_KHR:
+			return {desc.name, "{:4.0f} MHz", static_cast<float>(1e-6)};
+		case VK_PERFORMANCE_COUNTER_UNIT_KELVIN_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_WATTS_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_VOLTS_KHR:
+		case VK_PERFORMANCE_COUNTER_UNIT_AMPS_KHR:
+			return {desc.name, "{:4.1f}"};
+		default:
+			return {desc.name, "{:4.1f} M/s", static_cast<float>(1e-6)};
+	}
+}
+}        // namespace
+
 VulkanStatsProvider::VulkanStatsProvider(std::set<StatIndex>         &requested_stats,
                                          const CounterSamplingConfig &sampling_config,
                                          RenderContext               &render_context) :
@@ -70,13 +118,15 @@ VulkanStatsProvider::VulkanStatsProvider(std::set<StatIndex>         &requested_
 	gpu.enumerate_queue_family_performance_query_counters(queue_family_index, &count,
 	                                                      counters.data(), descs.data());
 
-	// Every vendor has a different set of performance counters each
-	// with different names. Match them to the stats we want, where available.
-	if (!fill_vendor_data())
+	for (uint32_t i = 0; i < count; i++)
 	{
-		return;
+		LOGD("Vulkan performance counter {}: {} ({})", i, descs[i].name, descs[i].description);
 	}
 
+	// Every vendor has a different set of performance counters each
+	// with different names. Match them to the stats we want, where available.
+	fill_vendor_data(descs);
+
 	bool performance_impact = false;
 
 	// Now build stat_data by matching vendor_data to Vulkan counter data
@@ -94,8 +144,8 @@ VulkanStatsProvider::VulkanStatsProvider(std::set<StatIndex>         &requested_
 		bool        found_div = (init.divisor_name == "");
 		uint32_t    ctr_idx, div_idx;
 
-		std::regex name_regex(init.name);
-		std::regex div_regex(init.divisor_name);
+		std::regex name_regex(init.name, std::regex::icase);
+		std::regex div_regex(init.divisor_name, std::regex::icase);
 
 		for (uint32_t i = 0; !(found_ctr && found_div) && i < descs.size(); i++)
 		{
@@ -111,37 +161,65 @@ VulkanStatsProvider::VulkanStatsProvider(std::set<StatIndex>         &requested_
 			}
 		}
 
-		if (found_ctr && found_div)
+		if (!found_ctr || !found_div)
 		{
-			if ((descs[ctr_idx].flags & VK_PERFORMANCE_COUNTER_DESCRIPTION_PERFORMANCE_IMPACTING_KHR) ||
-			    (init.divisor_name != "" && descs[div_idx].flags != VK_PERFORMANCE_COUNTER_DESCRIPTION_PERFORMANCE_IMPACTING_KHR))
-			{
-				performance_impact = true;
-			}
+			continue;
+		}
 
-			// Record the counter data
-			counter_indices.emplace_back(ctr_idx);
-			if (init.divisor_name == "")
-			{
-				stat_data[index] = StatData(ctr_idx, counters[ctr_idx].storage);
-			}
-			else
-			{
-				counter_indices.emplace_back(div_idx);
-				stat_data[index] = StatData(ctr_idx, counters[ctr_idx].storage, init.scaling,
-				                            div_idx, counters[div_idx].storage);
-			}
+		StatData data;
+		if (init.divisor_name == "")
+		{
+			// Rates and ratios measured by the device aren't divided by the frame time
+			data = StatData(ctr_idx, counters[ctr_idx].storage, is_rate(counters[ctr_idx].unit) ? StatScaling::None : init.scaling);
+		}
+		else
+		{
+			data = StatData(ctr_idx, counters[ctr_idx].storage, init.scaling,
+			                div_idx, counters[div_idx].storage);
+		}
+
+		if (init.has_vendor_graph_data)
+		{
+			data.graph_data = init.graph_data;
+		}
+		else if (is_vendor_counter(index))
+		{
+			data.graph_data = get_counter_graph_data(descs[ctr_idx], counters[ctr_idx].unit);
+		}
+		else
+		{
+			data.graph_data = default_graph_map[index];
+		}
+
+		if (!add_to_group(queue_family_index, data))
+		{
+			LOGW("Vulkan performance counter {} can't be collected in a single pass, we won't collect it", descs[ctr_idx].name);
+			continue;
+		}
+
+		if ((descs[ctr_idx].flags & VK_PERFORMANCE_COUNTER_DESCRIPTION_PERFORMANCE_IMPACTING_KHR) ||
+		    (init.divisor_name != "" && descs[div_idx].flags != VK_PERFORMANCE_COUNTER_DESCRIPTION_PERFORMANCE_IMPACTING_KHR))
+		{
+			performance_impact = true;
 		}
+
+		// Record the counter data
+		stat_data[index] = data;
 	}
 
 	if (performance_impact)
 		LOGW("The collection of performance counters may impact performance");
 
-	if (counter_indices.size() == 0)
+	if (stat_data.size() == 0)
 	{
 		return;        // No stats available
 	}
 
+	if (groups.size() > 1)
+	{
+		LOGI("Requested Vulkan stats need {} passes, each frame samples one of them in turn", groups.size());
+	}
+
 	// Acquire the profiling lock, without which we can't collect stats
 	VkAcquireProfilingLockInfoKHR info{};
 	info.sType   = VK_STRUCTURE_TYPE_ACQUIRE_PROFILING_LOCK_INFO_KHR;
@@ -150,21 +228,21 @@ VulkanStatsProvider::VulkanStatsProvider(std::set<StatIndex>         &requested_
 	if (vkAcquireProfilingLockKHR(device.get_handle(), &info) != VK_SUCCESS)
 	{
 		stat_data.clear();
-		counter_indices.clear();
+		groups.clear();
 		LOGW("Profiling lock acquisition timed-out");
 		return;
 	}
+	profiling_lock = true;
 
-	// Now we know the counters and that we can collect them, make a query pool for the results.
+	// Now we know the counters and that we can collect them, make query pools for the results.
 	if (!create_query_pools(queue_family_index))
 	{
 		stat_data.clear();
-		counter_indices.clear();
+		groups.clear();
 		return;
 	}
 
-	// These stats are fully supported by this provider and in a single pass, so remove
-	// from the requested set.
+	// These stats are fully supported by this provider, so remove them from the requested set.
 	// Subsequent providers will then only look for things that aren't already supported.
 	for (const auto &s : stat_data)
 	{
@@ -174,23 +252,23 @@ VulkanStatsProvider::VulkanStatsProvider(std::set<StatIndex>         &requested_
 
 VulkanStatsProvider::~VulkanStatsProvider()
 {
-	if (stat_data.size() > 0)
+	if (profiling_lock)
 	{
 		// Release profiling lock
 		vkReleaseProfilingLockKHR(render_context.get_device().get_handle());
 	}
 }
 
-bool VulkanStatsProvider::fill_vendor_data()
+void VulkanStatsProvider::fill_vendor_data(const std::vector<VkPerformanceCounterDescriptionKHR> &descs)
 {
+	// NOTE: The names here are actually case insensitive regular-expressions.
+	// Counter names can change between hardware variants for the same vendor,
+	// so regular expression names mean that multiple h/w variants can be easily supported.
 	const auto &pd_props = render_context.get_device().get_gpu().get_properties();
 	if (pd_props.vendorID == 0x14E4)        // Broadcom devices
 	{
 		LOGI("Using Vulkan performance counters from Broadcom device");
 
-		// NOTE: The names here are actually regular-expressions.
-		// Counter names can change between hardware variants for the same vendor,
-		// so regular expression names mean that multiple h/w variants can be easily supported.
 		// clang-format off
 		vendor_data = {
 		    {StatIndex::gpu_cycles,          {"cycle_count"}},
@@ -207,64 +285,155 @@ bool VulkanStatsProvider::fill_vendor_data()
 		// Override vendor-specific graph data
 		vendor_data.at(StatIndex::gpu_vertex_cycles).set_vendor_graph_data({"Vertex/Coord/User Cycles", "{:4.1f} M/s", static_cast<float>(1e-6)});
 		vendor_data.at(StatIndex::gpu_fragment_jobs).set_vendor_graph_data({"Render Jobs", "{:4.0f}/s"});
+	}
+	else if (pd_props.vendorID == 0x8086)        // Intel devices
+	{
+		LOGI("Using Vulkan performance counters from Intel device");
 
-		return true;
+		// clang-format off
+		vendor_data = {
+		    {StatIndex::gpu_cycles,           {"GPU Core Clocks"}},
+		    {StatIndex::gpu_ext_read_bytes,   {"GTI Read Throughput"}},
+		    {StatIndex::gpu_ext_write_bytes,  {"GTI Write Throughput"}},
+		    {StatIndex::gpu_vendor_counter_0, {"GPU Busy"}},
+		    {StatIndex::gpu_vendor_counter_1, {"EU Active"}},
+		    {StatIndex::gpu_vendor_counter_2, {"EU Stall"}},
+		    {StatIndex::gpu_vendor_counter_3, {"Sampler Busy"}},
+		};
+		// clang-format on
 	}
-#if 0
-	else if (pd_props.vendorID == xxxx) // Other vendor's devices
+	else if (pd_props.vendorID == 0x1002)        // AMD devices
 	{
-		// Fill vendor_data for other vendor
-		return true;
+		LOGI("Using Vulkan performance counters from AMD device");
+
+		// clang-format off
+		vendor_data = {
+		    {StatIndex::gpu_cycles,           {"GPU active cycles"}},
+		    {StatIndex::gpu_ext_read_bytes,   {"VRAM read size"}},
+		    {StatIndex::gpu_ext_write_bytes,  {"VRAM write size"}},
+		    {StatIndex::gpu_vendor_counter_0, {"VALU busy"}},
+		    {StatIndex::gpu_vendor_counter_1, {"SALU busy"}},
+		    {StatIndex::gpu_vendor_counter_2, {"L2 cache hit ratio"}},
+		    {StatIndex::gpu_vendor_counter_3, {"Waves"}},
+		};
+		// clang-format on
 	}
-#endif
+	else
 	{
-		// Unsupported vendor
-		return false;
+		LOGI("Using generic Vulkan performance counters from device 0x{:X}", pd_props.vendorID);
+
+		// clang-format off
+		vendor_data = {
+		    {StatIndex::gpu_cycles,          {".*(gpu|core).*(cycle|clock).*"}},
+		    {StatIndex::gpu_ext_read_bytes,  {".*(memory|dram|vram|external).*read.*(bytes|size|throughput).*"}},
+		    {StatIndex::gpu_ext_write_bytes, {".*(memory|dram|vram|external).*write.*(bytes|size|throughput).*"}},
+		};
+		// clang-format on
+
+		// Surface the first counters of the device, the generic table only knows a few common ones
+		uint32_t vendor_counter = 0;
+		for (size_t i = 0; i < descs.size() && vendor_counter < 4; i++)
+		{
+			auto index = static_cast<StatIndex>(static_cast<uint32_t>(StatIndex::gpu_vendor_counter_0) + vendor_counter++);
+			vendor_data.emplace(index, VendorStat{std::regex_replace(descs[i].name, std::regex(R"([.^$|()\[\]{}*+?\\])"), R"(\$&)")});
+		}
 	}
 }
 
-bool VulkanStatsProvider::create_query_pools(uint32_t queue_family_index)
+bool VulkanStatsProvider::add_to_group(uint32_t queue_family_index, StatData &data)
 {
-	Device               &device           = render_context.get_device();
-	const PhysicalDevice &gpu              = device.get_gpu();
-	uint32_t              num_framebuffers = static_cast<uint32_t>(render_context.get_render_frames().size());
-
-	// Now we know the available counters, we can build a query pool that will collect them.
-	// We will check that the counters can be collected in a single pass. Multi-pass would
-	// be a big performance hit so for these samples, we don't want to use it.
-	VkQueryPoolPerformanceCreateInfoKHR perf_create_info{};
-	perf_create_info.sType             = VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR;
-	perf_create_info.queueFamilyIndex  = queue_family_index;
-	perf_create_info.counterIndexCount = static_cast<uint32_t>(counter_indices.size());
-	perf_create_info.pCounterIndices   = counter_indices.data();
-
-	uint32_t passes_needed = gpu.get_queue_family_performance_query_passes(&perf_create_info);
-	if (passes_needed != 1)
-	{
-		// Needs more than one pass, remove all our supported stats
-		LOGW("Requested Vulkan stats require multiple passes, we won't collect them");
-		return false;
+	const PhysicalDevice &gpu = render_context.get_device().get_gpu();
+
+	std::vector<uint32_t> needed{data.counter_index};
+	if (data.scaling == StatScaling::ByCounter)
+	{
+		needed.push_back(data.divisor_counter_index);
+	}
+
+	auto needs_single_pass = [&gpu, queue_family_index](const std::vector<uint32_t> &counter_indices) {
+		VkQueryPoolPerformanceCreateInfoKHR perf_create_info{};
+		perf_create_info.sType             = VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR;
+		perf_create_info.queueFamilyIndex  = queue_family_index;
+		perf_create_info.counterIndexCount = static_cast<uint32_t>(counter_indices.size());
+		perf_create_info.pCounterIndices   = counter_indices.data();
+		return gpu.get_queue_family_performance_query_passes(&perf_create_info) == 1;
+	};
+
+	auto merge = [&needed](std::vector<uint32_t> counter_indices) {
+		for (auto counter_index : needed)
+		{
+			if (std::find(counter_indices.begin(), counter_indices.end(), counter_index) == counter_indices.end())
+			{
+				counter_indices.push_back(counter_index);
+			}
+		}
+		return counter_indices;
+	};
+
+	// Fill the last group first, a new group is only started when the counters don't fit in its pass
+	if (groups.empty() || !needs_single_pass(merge(groups.back().counter_indices)))
+	{
+		if (!needs_single_pass(needed))
+		{
+			return false;
+		}
+		groups.emplace_back();
 	}
 
-	// We will need a query pool to report the stats back to us
-	VkQueryPoolCreateInfo pool_create_info{};
-	pool_create_info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-	pool_create_info.pNext      = &perf_create_info;
-	pool_create_info.queryType  = VK_QUERY_TYPE_PERFORMANCE_QUERY_KHR;
-	pool_create_info.queryCount = num_framebuffers;
+	auto &group           = groups.back();
+	group.counter_indices = merge(group.counter_indices);
 
-	query_pool = std::make_unique<QueryPool>(device, pool_create_info);
+	auto position = [&group](uint32_t counter_index) {
+		return static_cast<uint32_t>(std::find(group.counter_indices.begin(), group.counter_indices.end(), counter_index) - group.counter_indices.begin());
+	};
 
-	if (!query_pool)
+	data.group            = static_cast<uint32_t>(groups.size() - 1);
+	data.counter_position = position(data.counter_index);
+	if (data.scaling == StatScaling::ByCounter)
 	{
-		LOGW("Failed to create performance query pool");
-		return false;
+		data.divisor_position = position(data.divisor_counter_index);
 	}
 
-	// Reset the query pool before first use. We cannot do these in the command buffer
-	// as that is invalid usage for performance queries due to the potential for multiple
-	// passes being required.
-	query_pool->host_reset(0, num_framebuffers);
+	return true;
+}
+
+bool VulkanStatsProvider::create_query_pools(uint32_t queue_family_index)
+{
+	Device  &device           = render_context.get_device();
+	uint32_t num_framebuffers = static_cast<uint32_t>(render_context.get_render_frames().size());
+
+	// Each group of counters has its own query pool, the groups were built so each is collected in a single pass.
+	// Multi-pass queries would need the command buffers submitted once per pass, so the frames sample the groups in turn instead.
+	for (auto &group : groups)
+	{
+		VkQueryPoolPerformanceCreateInfoKHR perf_create_info{};
+		perf_create_info.sType             = VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR;
+		perf_create_info.queueFamilyIndex  = queue_family_index;
+		perf_create_info.counterIndexCount = static_cast<uint32_t>(group.counter_indices.size());
+		perf_create_info.pCounterIndices   = group.counter_indices.data();
+
+		// We will need a query pool to report the stats back to us
+		VkQueryPoolCreateInfo pool_create_info{};
+		pool_create_info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		pool_create_info.pNext      = &perf_create_info;
+		pool_create_info.queryType  = VK_QUERY_TYPE_PERFORMANCE_QUERY_KHR;
+		pool_create_info.queryCount = num_framebuffers;
+
+		group.query_pool = std::make_unique<QueryPool>(device, pool_create_info);
+
+		if (!group.query_pool)
+		{
+			LOGW("Failed to create performance query pool");
+			return false;
+		}
+
+		// Reset the query pool before first use. We cannot do these in the command buffer
+		// as that is invalid usage for performance queries due to the potential for multiple
+		// passes being required.
+		group.query_pool->host_reset(0, num_framebuffers);
+	}
+
+	frame_groups.assign(num_framebuffers, static_cast<uint32_t>(groups.size()));
 
 	if (has_timestamps)
 	{
@@ -326,13 +495,7 @@ const StatGraphData &VulkanStatsProvider::get_graph_data(StatIndex index) const
 {
 	assert(is_available(index) && "VulkanStatsProvider::get_graph_data() called with invalid StatIndex");
 
-	const auto &data = vendor_data.find(index)->second;
-	if (data.has_vendor_graph_data)
-	{
-		return data.graph_data;
-	}
-
-	return default_graph_map[index];
+	return stat_data.at(index).graph_data;
 }
 
 void VulkanStatsProvider::begin_sampling(CommandBuffer &cb)
@@ -349,9 +512,11 @@ void VulkanStatsProvider::begin_sampling(CommandBuffer &cb)
 		                   active_frame_idx * 2);
 	}
 
-	if (query_pool)
+	// Frames created with a new swapchain after the query pools don't sample any group
+	if (!groups.empty() && active_frame_idx < frame_groups.size())
 	{
-		cb.begin_query(*query_pool, active_frame_idx, static_cast<VkQueryControlFlags>(0));
+		frame_groups[active_frame_idx] = next_group;
+		cb.begin_query(*groups[next_group].query_pool, active_frame_idx, static_cast<VkQueryControlFlags>(0));
 	}
 }
 
@@ -359,7 +524,7 @@ void VulkanStatsProvider::end_sampling(CommandBuffer &cb)
 {
 	uint32_t active_frame_idx = render_context.get_active_frame_index();
 
-	if (query_pool)
+	if (active_frame_idx < frame_groups.size() && frame_groups[active_frame_idx] < groups.size())
 	{
 		// Perform a barrier to ensure all previous commands complete before ending the query
 		// This does not block later commands from executing as we use BOTTOM_OF_PIPE in the
@@ -368,9 +533,9 @@ void VulkanStatsProvider::end_sampling(CommandBuffer &cb)
 		                     VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
 		                     VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
 		                     0, 0, nullptr, 0, nullptr, 0, nullptr);
-		cb.end_query(*query_pool, active_frame_idx);
+		cb.end_query(*groups[frame_groups[active_frame_idx]].query_pool, active_frame_idx);
 
-		++queries_ready;
+		next_group = (next_group + 1) % static_cast<uint32_t>(groups.size());
 	}
 
 	if (timestamp_pool)
@@ -434,20 +599,29 @@ float VulkanStatsProvider::get_best_delta_time(float sw_delta_time) const
 StatsProvider::Counters VulkanStatsProvider::sample(float delta_time)
 {
 	Counters out;
-	if (!query_pool || queries_ready == 0)
+
+	uint32_t active_frame_idx = render_context.get_active_frame_index();
+	if (active_frame_idx >= frame_groups.size() || frame_groups[active_frame_idx] >= groups.size())
 	{
 		return out;
 	}
 
-	uint32_t active_frame_idx = render_context.get_active_frame_index();
+	// The frame was waited for before being reused, its results are available
+	uint32_t group_index = frame_groups[active_frame_idx];
+	auto    &group       = groups[group_index];
+
+	VkDeviceSize stride = sizeof(VkPerformanceCounterResultKHR) * group.counter_indices.size();
 
-	VkDeviceSize stride = sizeof(VkPerformanceCounterResultKHR) * counter_indices.size();
+	std::vector<VkPerformanceCounterResultKHR> results(group.counter_indices.size());
 
-	std::vector<VkPerformanceCounterResultKHR> results(counter_indices.size());
+	VkResult r = group.query_pool->get_results(active_frame_idx, 1,
+	                                           results.size() * sizeof(VkPerformanceCounterResultKHR),
+	                                           results.data(), stride, VK_QUERY_RESULT_WAIT_BIT);
+
+	// Now reset the query we just fetched the results from
+	group.query_pool->host_reset(active_frame_idx, 1);
+	frame_groups[active_frame_idx] = static_cast<uint32_t>(groups.size());
 
-	VkResult r = query_pool->get_results(active_frame_idx, 1,
-	                                     results.size() * sizeof(VkPerformanceCounterResultKHR),
-	                                     results.data(), stride, VK_QUERY_RESULT_WAIT_BIT);
 	if (r != VK_SUCCESS)
 	{
 		return out;
@@ -456,49 +630,32 @@ StatsProvider::Counters VulkanStatsProvider::sample(float delta_time)
 	// Use timestamps to get a more accurate delta if available
 	delta_time = get_best_delta_time(delta_time);
 
-	// Parse the results - they are in the order we gave in counter_indices
+	// Parse the results of the stats of the group - they are in the order of its counter_indices
 	for (const auto &s : stat_data)
 	{
-		StatIndex si = s.first;
+		const StatData &data = s.second;
+		if (data.group != group_index)
+		{
+			continue;
+		}
 
-		bool   need_divisor  = (stat_data[si].scaling == StatScaling::ByCounter);
-		double divisor_value = 1.0;
-		double value         = 0.0;
-		bool   found_ctr = false, found_div = !need_divisor;
+		double value = get_counter_value(results[data.counter_position], data.storage);
 
-		for (uint32_t i = 0; !(found_ctr && found_div) && i < counter_indices.size(); i++)
+		if (data.scaling == StatScaling::ByDeltaTime && delta_time != 0.0)
 		{
-			if (s.second.counter_index == counter_indices[i])
-			{
-				value     = get_counter_value(results[i], stat_data[si].storage);
-				found_ctr = true;
-			}
-			if (need_divisor && s.second.divisor_counter_index == counter_indices[i])
-			{
-				divisor_value = get_counter_value(results[i], stat_data[si].divisor_storage);
-				found_div     = true;
-			}
+			value /= delta_time;
 		}
-
-		if (found_ctr && found_div)
+		else if (data.scaling == StatScaling::ByCounter)
 		{
-			if (stat_data[si].scaling == StatScaling::ByDeltaTime && delta_time != 0.0)
-			{
-				value /= delta_time;
-			}
-			else if (stat_data[si].scaling == StatScaling::ByCounter && divisor_value != 0.0)
+			double divisor_value = get_counter_value(results[data.divisor_position], data.divisor_storage);
+			if (divisor_value != 0.0)
 			{
 				value /= divisor_value;
 			}
-			out[si].result = value;
 		}
+		out[s.first].result = value;
 	}
 
-	// Now reset the query we just fetched the results from
-	query_pool->host_reset(active_frame_idx, 1);
-
-	--queries_ready;
-
 	return out;
 }
 
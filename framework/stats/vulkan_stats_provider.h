@@ -24,6 +24,16 @@ namespace vkb
 {
 class RenderContext;
 
+/**
+ * @brief Reports GPU counters through VK_KHR_performance_query
+ *
+ * The counters of each vendor are matched to the stats by name. Vendors without a table of their own get a generic
+ * one, matching the common names of the counters. The gpu_vendor_counter stats show counters without an equivalent
+ * stat, named after them.
+ *
+ * The profiling lock is held for the lifetime of the provider. Counters which can't be collected in a single pass
+ * are split in groups that can, each frame samples the next group, so each stat is updated every few frames.
+ */
 class VulkanStatsProvider : public StatsProvider
 {
   private:
@@ -36,6 +46,11 @@ class VulkanStatsProvider : public StatsProvider
 		VkPerformanceCounterStorageKHR divisor_storage;
 		StatGraphData                  graph_data;
 
+		/// The counter group the stat is sampled with, and the positions of its counters in the results of the group
+		uint32_t group{0};
+		uint32_t counter_position{0};
+		uint32_t divisor_position{0};
+
 		StatData() = default;
 
 		StatData(uint32_t counter_index, VkPerformanceCounterStorageKHR storage,
@@ -73,6 +88,16 @@ class VulkanStatsProvider : public StatsProvider
 		StatGraphData graph_data;
 	};
 
+	/// Counters collected together in a single pass
+	struct CounterGroup
+	{
+		// An ordered list of the Vulkan counter ids
+		std::vector<uint32_t> counter_indices;
+
+		// The query pool for the performance queries, one query per frame
+		std::unique_ptr<QueryPool> query_pool;
+	};
+
 	using StatDataMap   = std::unordered_map<StatIndex, StatData, StatIndexHash>;
 	using VendorStatMap = std::unordered_map<StatIndex, VendorStat, StatIndexHash>;
 
@@ -125,7 +150,16 @@ class VulkanStatsProvider : public StatsProvider
   private:
 	bool is_supported(const CounterSamplingConfig &sampling_config) const;
 
-	bool fill_vendor_data();
+	/**
+	 * @param descs The descriptions of the counters of the device
+	 */
+	void fill_vendor_data(const std::vector<VkPerformanceCounterDescriptionKHR> &descs);
+
+	/**
+	 * @brief Adds the counters of a stat to a group they can be collected in a single pass with
+	 * @return Whether some group could hold them
+	 */
+	bool add_to_group(uint32_t queue_family_index, StatData &data);
 
 	bool create_query_pools(uint32_t queue_family_index);
 
@@ -135,8 +169,17 @@ class VulkanStatsProvider : public StatsProvider
 	// The render context
 	RenderContext &render_context;
 
-	// The query pool for the performance queries
-	std::unique_ptr<QueryPool> query_pool;
+	// Groups of counters collected in a single pass, sampled in turn
+	std::vector<CounterGroup> groups;
+
+	// The group sampled by each frame, groups.size() if none
+	std::vector<uint32_t> frame_groups;
+
+	// The group the next frame samples
+	uint32_t next_group{0};
+
+	// Whether the profiling lock is held
+	bool profiling_lock{false};
 
 	// Do we support timestamp queries
 	bool has_timestamps{false};
@@ -152,12 +195,6 @@ class VulkanStatsProvider : public StatsProvider
 
 	// Only stats which are available and were requested end up in stat_data
 	StatDataMap stat_data;
-
-	// An ordered list of the Vulkan counter ids
-	std::vector<uint32_t> counter_indices;
-
-	// How many queries have been ended?
-	uint32_t queries_ready = 0;
 };
 
 }        // namespace vkb
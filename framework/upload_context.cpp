@@ -0,0 +1,243 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "upload_context.h"
+
+#include "core/device.h"
+
+namespace vkb
+{
+UploadContext::UploadContext(Device &device, const Queue &queue, VkDeviceSize staging_size) :
+    device{device},
+    queue{queue},
+    command_pool{device.create_command_pool(queue.get_family_index(), VK_COMMAND_POOL_CREATE_TRANSIENT_BIT)},
+    staging_ring{device, staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT}
+{
+}
+
+UploadContext::~UploadContext()
+{
+	wait_idle();
+
+	for (auto fence : free_fences)
+	{
+		vkDestroyFence(device.get_handle(), fence, nullptr);
+	}
+
+	vkDestroyCommandPool(device.get_handle(), command_pool, nullptr);
+}
+
+void UploadContext::upload_buffer(core::BufferC &buffer, const void *data, VkDeviceSize size, VkDeviceSize offset)
+{
+	assert(size > 0 && "Upload size must be greater than zero");
+
+	auto staging = stage(data, size);
+
+	VkBufferCopy copy_region{};
+	copy_region.srcOffset = staging.second;
+	copy_region.dstOffset = offset;
+	copy_region.size      = size;
+
+	vkCmdCopyBuffer(get_command_buffer(), staging.first, buffer.get_handle(), 1, &copy_region);
+
+	open_batch->has_buffer_copies = true;
+}
+
+void UploadContext::upload_image(VkImage                               image,
+                                 const std::vector<uint8_t>           &data,
+                                 const std::vector<VkBufferImageCopy> &regions,
+                                 const VkImageSubresourceRange        &subresource_range,
+                                 VkImageLayout                         new_layout)
+{
+	assert(!data.empty() && "Upload size must be greater than zero");
+
+	auto staging = stage(data.data(), data.size());
+
+	std::vector<VkBufferImageCopy> staging_regions{regions};
+	for (auto &region : staging_regions)
+	{
+		region.bufferOffset += staging.second;
+	}
+
+	VkCommandBuffer command_buffer = get_command_buffer();
+
+	image_layout_transition(command_buffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresource_range);
+
+	vkCmdCopyBufferToImage(command_buffer,
+	                       staging.first,
+	                       image,
+	                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	                       to_u32(staging_regions.size()),
+	                       staging_regions.data());
+
+	// The transition also makes the copies visible to the commands submitted after the batch
+	image_layout_transition(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, new_layout, subresource_range);
+}
+
+UploadContext::Token UploadContext::flush()
+{
+	if (!open_batch)
+	{
+		return last_token;
+	}
+
+	if (open_batch->has_buffer_copies)
+	{
+		VkMemoryBarrier memory_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+		memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memory_barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+		vkCmdPipelineBarrier(open_batch->command_buffer,
+		                     VK_PIPELINE_STAGE_TRANSFER_BIT,
+		                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		                     0,
+		                     1, &memory_barrier,
+		                     0, nullptr,
+		                     0, nullptr);
+	}
+
+	VK_CHECK(vkEndCommandBuffer(open_batch->command_buffer));
+
+	if (free_fences.empty())
+	{
+		VkFenceCreateInfo fence_info{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+		VK_CHECK(vkCreateFence(device.get_handle(), &fence_info, nullptr, &open_batch->fence));
+	}
+	else
+	{
+		open_batch->fence = free_fences.back();
+		free_fences.pop_back();
+	}
+
+	VkSubmitInfo submit_info{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers    = &open_batch->command_buffer;
+
+	VK_CHECK(queue.submit({submit_info}, open_batch->fence));
+
+	last_token = open_batch->token;
+	submitted_batches.push_back(std::move(open_batch));
+
+	return last_token;
+}
+
+bool UploadContext::is_complete(Token token)
+{
+	collect();
+	return token <= completed_token;
+}
+
+void UploadContext::wait(Token token)
+{
+	assert(token <= last_token && "Token of a batch which wasn't submitted");
+
+	collect();
+	while (completed_token < token)
+	{
+		wait_oldest();
+	}
+}
+
+void UploadContext::wait_idle()
+{
+	wait(flush());
+}
+
+VkCommandBuffer UploadContext::get_command_buffer()
+{
+	if (!open_batch)
+	{
+		open_batch        = std::make_unique<Batch>();
+		open_batch->token = last_token + 1;
+
+		VkCommandBufferAllocateInfo allocate_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+		allocate_info.commandPool        = command_pool;
+		allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocate_info.commandBufferCount = 1;
+		VK_CHECK(vkAllocateCommandBuffers(device.get_handle(), &allocate_info, &open_batch->command_buffer));
+
+		VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+		begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK(vkBeginCommandBuffer(open_batch->command_buffer, &begin_info));
+	}
+
+	return open_batch->command_buffer;
+}
+
+std::pair<VkBuffer, VkDeviceSize> UploadContext::stage(const void *data, VkDeviceSize size)
+{
+	// Opens the batch first, the staging memory is owned by it
+	get_command_buffer();
+
+	if (size > staging_ring.get_size())
+	{
+		open_batch->staging_buffers.push_back(std::make_unique<core::BufferC>(core::BufferC::create_staging_buffer(device, size, data)));
+		return {open_batch->staging_buffers.back()->get_handle(), 0};
+	}
+
+	collect();
+
+	auto allocation = staging_ring.allocate(open_batch.get(), size);
+	if (allocation.empty())
+	{
+		// The open batch may hold most of the ring, it is submitted before waiting for the older ones
+		flush();
+		get_command_buffer();
+		while (allocation.empty() && !submitted_batches.empty())
+		{
+			// Only regions before the oldest batch in flight can be reclaimed
+			wait_oldest();
+			allocation = staging_ring.allocate(open_batch.get(), size);
+		}
+		assert(!allocation.empty());
+	}
+
+	allocation.update(data, static_cast<size_t>(size));
+
+	return {allocation.get_buffer().get_handle(), allocation.get_offset()};
+}
+
+void UploadContext::collect()
+{
+	while (!submitted_batches.empty() && vkGetFenceStatus(device.get_handle(), submitted_batches.front()->fence) == VK_SUCCESS)
+	{
+		release(*submitted_batches.front());
+		submitted_batches.pop_front();
+	}
+}
+
+void UploadContext::wait_oldest()
+{
+	auto &batch = *submitted_batches.front();
+	VK_CHECK(vkWaitForFences(device.get_handle(), 1, &batch.fence, VK_TRUE, UINT64_MAX));
+
+	release(batch);
+	submitted_batches.pop_front();
+}
+
+void UploadContext::release(Batch &batch)
+{
+	VK_CHECK(vkResetFences(device.get_handle(), 1, &batch.fence));
+	free_fences.push_back(batch.fence);
+
+	vkFreeCommandBuffers(device.get_handle(), command_pool, 1, &batch.command_buffer);
+
+	staging_ring.release(&batch);
+
+	completed_token = batch.token;
+}
+}        // namespace vkb
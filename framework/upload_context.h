@@ -0,0 +1,175 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "buffer_ring.h"
+#include "common/vk_common.h"
+
+namespace vkb
+{
+class Queue;
+
+/**
+ * @brief Uploads buffer and image data to the device without waiting for each copy
+ *
+ * The data of the uploads is written to a ring of staging memory, and their copies are recorded
+ * in the command buffer of the open batch. flush() submits the batch with a fence of its own and
+ * returns a token, which the caller only waits on when it needs the copies to be complete: the
+ * commands submitted later to the same queue are ordered after them by the barriers of the batch.
+ * The staging memory of a batch is reused once its fence is signaled.
+ *
+ * The context isn't thread safe, uploads are expected to be enqueued from a single thread.
+ */
+class UploadContext
+{
+  public:
+	/// Identifies a submitted batch, a token is complete once the batches up to it have completed
+	using Token = uint64_t;
+
+	/// Default size of the staging ring
+	static constexpr VkDeviceSize DefaultStagingSize = 32 * 1024 * 1024;
+
+	/**
+	 * @param device The device the copies are executed on
+	 * @param queue The queue the batches are submitted to, the images are used on its queue family
+	 * @param staging_size Size of the staging ring, larger uploads get a staging buffer of their own
+	 */
+	UploadContext(Device &device, const Queue &queue, VkDeviceSize staging_size = DefaultStagingSize);
+
+	UploadContext(const UploadContext &) = delete;
+
+	UploadContext(UploadContext &&) = delete;
+
+	/**
+	 * @brief Submits the pending uploads and waits for all of them
+	 */
+	~UploadContext();
+
+	UploadContext &operator=(const UploadContext &) = delete;
+
+	UploadContext &operator=(UploadContext &&) = delete;
+
+	/**
+	 * @brief Copies data to a buffer
+	 * @param buffer The destination buffer, created with VK_BUFFER_USAGE_TRANSFER_DST_BIT
+	 * @param data The data to copy
+	 * @param size Size of the data in bytes
+	 * @param offset Offset in the destination buffer
+	 */
+	void upload_buffer(core::BufferC &buffer, const void *data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+	/**
+	 * @brief Copies data to the subresources of an image, whose previous content is discarded
+	 * @param image The destination image, created with VK_IMAGE_USAGE_TRANSFER_DST_BIT
+	 * @param data The data to copy
+	 * @param regions The copies, with buffer offsets relative to the start of the data
+	 * @param subresource_range The subresources written by the copies
+	 * @param new_layout The layout of the image once the copies are complete
+	 */
+	void upload_image(VkImage                               image,
+	                  const std::vector<uint8_t>           &data,
+	                  const std::vector<VkBufferImageCopy> &regions,
+	                  const VkImageSubresourceRange        &subresource_range,
+	                  VkImageLayout                         new_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	/**
+	 * @brief Submits the open batch, without waiting for it
+	 * @return The token of the batch, or of the last submitted batch if there was nothing to submit
+	 */
+	Token flush();
+
+	/**
+	 * @return Whether the batches up to the token have completed, without waiting
+	 */
+	bool is_complete(Token token);
+
+	/**
+	 * @brief Waits for the batches up to the token to complete
+	 */
+	void wait(Token token);
+
+	/**
+	 * @brief Submits the open batch and waits for all batches to complete
+	 */
+	void wait_idle();
+
+  private:
+	struct Batch
+	{
+		Token token{0};
+
+		VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+
+		VkFence fence{VK_NULL_HANDLE};
+
+		/// Staging buffers of the uploads which didn't fit in the ring
+		std::vector<std::unique_ptr<core::BufferC>> staging_buffers;
+
+		/// Whether buffers were written, their reads are made visible with a single barrier
+		bool has_buffer_copies{false};
+	};
+
+	/**
+	 * @return The command buffer of the open batch, begun on the first upload
+	 */
+	VkCommandBuffer get_command_buffer();
+
+	/**
+	 * @brief Writes data to staging memory, waiting for the oldest batches if the ring is full
+	 * @return The buffer and offset the data was written to
+	 */
+	std::pair<VkBuffer, VkDeviceSize> stage(const void *data, VkDeviceSize size);
+
+	/**
+	 * @brief Releases the batches whose fence is signaled, oldest first
+	 */
+	void collect();
+
+	/**
+	 * @brief Waits for the oldest submitted batch and releases it
+	 */
+	void wait_oldest();
+
+	void release(Batch &batch);
+
+	Device &device;
+
+	const Queue &queue;
+
+	VkCommandPool command_pool{VK_NULL_HANDLE};
+
+	BufferRing staging_ring;
+
+	/// The batch the uploads are recorded to, not submitted yet
+	std::unique_ptr<Batch> open_batch;
+
+	/// The submitted batches, oldest first
+	std::deque<std::unique_ptr<Batch>> submitted_batches;
+
+	std::vector<VkFence> free_fences;
+
+	Token last_token{0};
+
+	/// All the batches up to this token have completed
+	Token completed_token{0};
+};
+}        // namespace vkb
@@ -18,14 +18,24 @@
 
 #pragma once
 
+#include <future>
+
+#include "common/gpu_profiling.h"
 #include "common/hpp_utils.h"
+#include "core/backend.h"
+#include "core/defragmenter.h"
+#include "core/pipeline_cache_store.h"
+#include "core/portability.h"
+#include "core/util/job_system.hpp"
 #include "hpp_gltf_loader.h"
 #include "hpp_gui.h"
 #include "platform/application.h"
+#include "rendering/compute_context.h"
 #include "rendering/hpp_render_pipeline.h"
 #include "scene_graph/components/camera.h"
 #include "scene_graph/hpp_scene.h"
 #include "scene_graph/scripts/animation.h"
+#include "scene_graph/scripts/free_camera.h"
 
 #if defined(PLATFORM__MACOS)
 #	include <TargetConditionals.h>
@@ -156,6 +166,11 @@ class VulkanSample : public vkb::Application
 	RenderContextType const &get_render_context() const;
 	bool                     has_render_context() const;
 
+	/**
+	 * @return Whether the sample runs without a surface, a swapchain or a render context, see enable_compute_only()
+	 */
+	bool is_compute_only() const;
+
 	/// <summary>
 	/// PROTECTED VIRTUAL INTERFACE
 	/// </summary>
@@ -189,6 +204,12 @@ class VulkanSample : public vkb::Application
 	 */
 	virtual void draw(CommandBufferType &command_buffer, RenderTargetType &render_target);
 
+	/**
+	 * @brief Compute-only samples override this to record the work of a frame, instead of draw()
+	 * @param command_buffer The command buffer of the compute queue to record the commands to
+	 */
+	virtual void dispatch(CommandBufferType &command_buffer);
+
 	/**
 	 * @brief Samples should override this function to draw their interface
 	 */
@@ -261,6 +282,20 @@ class VulkanSample : public vkb::Application
 
 	void create_gui(const Window &window, StatsType const *stats = nullptr, const float font_size = 21.0f, bool explicit_update = false);
 
+	/**
+	 * @brief Runs the sample without a surface, a swapchain or a render context, must be called in the constructor
+	 *        The window is never attached to a surface, whatever its mode, so the sample runs on GPUs without a display,
+	 *        presentation support or graphics queue. The frames are recorded by dispatch() into command buffers of a
+	 *        ComputeContext, submitted to the compute queue and paced by a timeline semaphore when supported. There is
+	 *        no GUI nor stats, the sample must not call get_render_context() or get_stats().
+	 */
+	void enable_compute_only();
+
+	/**
+	 * @brief The per-frame resources of a compute-only sample
+	 */
+	vkb::ComputeContext &get_compute_context();
+
 	/**
 	 * @brief A helper to create a render context
 	 */
@@ -287,10 +322,23 @@ class VulkanSample : public vkb::Application
 
 	/**
 	 * @brief Loads the scene
+	 *        Takes the scene loaded by preload_scene() if it was given the same path and no additional buffer usage.
 	 *
 	 * @param path The path of the glTF file
+	 * @param additional_buffer_usage_flags Usage added to the vertex and index buffers, such as
+	 *        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, see GLTFLoader::read_scene_from_file()
+	 */
+	void load_scene(const std::string &path, VkBufferUsageFlags additional_buffer_usage_flags = 0);
+
+	/**
+	 * @brief Loads a scene on a worker thread during prepare(), while the stats and the allocator are set up
+	 *        Must be called before prepare(), typically from the constructor of the sample.
+	 *        The loading starts once the render context is prepared, as the setup of the context waits for the device
+	 *        to be idle. prepare() waits for it before returning.
+	 *
+	 * @param path The path of the glTF file, passed to load_scene() afterwards
 	 */
-	void load_scene(const std::string &path);
+	void preload_scene(const std::string &path);
 
 	/**
 	 * @brief Additional sample initialization
@@ -311,6 +359,14 @@ class VulkanSample : public vkb::Application
 	 */
 	void set_high_priority_graphics_queue_enable(bool enable);
 
+	/**
+	 * @brief Sets whether the swapchain is pre-rotated, enabled by default on Android.
+	 * The cameras of the free camera scripts get the matching rotation, samples building
+	 * their own projections should disable it.
+	 * Needs to be called before prepare(), use the render context afterwards.
+	 */
+	void set_pre_rotation_enable(bool enable);
+
 	void set_render_context(std::unique_ptr<RenderContextType> &&render_context);
 
 	void set_render_pipeline(std::unique_ptr<RenderPipelineType> &&render_pipeline);
@@ -341,7 +397,7 @@ class VulkanSample : public vkb::Application
 	/**
 	 * @brief Set viewport and scissor state in command buffer for a given extent
 	 */
-	static void set_viewport_and_scissor(CommandBufferType const &command_buffer, Extent2DType const &extent);
+	static void set_viewport_and_scissor(CommandBufferType &command_buffer, Extent2DType const &extent);
 
 	/// <summary>
 	/// PRIVATE INTERFACE
@@ -351,7 +407,12 @@ class VulkanSample : public vkb::Application
 	void        draw_impl(vkb::core::HPPCommandBuffer &command_buffer, vkb::rendering::HPPRenderTarget &render_target);
 	void        draw_renderpass_impl(vkb::core::HPPCommandBuffer &command_buffer, vkb::rendering::HPPRenderTarget &render_target);
 	void        render_impl(vkb::core::HPPCommandBuffer &command_buffer);
-	static void set_viewport_and_scissor_impl(vkb::core::HPPCommandBuffer const &command_buffer, vk::Extent2D const &extent);
+	static void set_viewport_and_scissor_impl(vkb::core::HPPCommandBuffer &command_buffer, vk::Extent2D const &extent);
+
+	/**
+	 * @brief Main loop of compute-only samples, records the frame with dispatch() and submits it to the compute context
+	 */
+	void update_compute(float delta_time);
 
 	/**
 	 * @brief Get sample-specific device extensions.
@@ -400,6 +461,13 @@ class VulkanSample : public vkb::Application
 	 */
 	std::unique_ptr<vkb::rendering::HPPRenderContext> render_context;
 
+	/**
+	 * @brief Replaces the render context of compute-only samples, see enable_compute_only()
+	 */
+	std::unique_ptr<vkb::ComputeContext> compute_context;
+
+	bool compute_only{false};
+
 	/**
 	 * @brief Pipeline used for rendering, it should be set up by the concrete sample
 	 */
@@ -451,7 +519,21 @@ class VulkanSample : public vkb::Application
 	/** @brief Whether or not we want a high priority graphics queue. */
 	bool high_priority_graphics_queue{false};
 
+	/** @brief Whether the render context pre-rotates the swapchain, see set_pre_rotation_enable() */
+	bool pre_rotation{vkb::rendering::HPPRenderContext::DEFAULT_PRE_ROTATION};
+
+	/** @brief The scene to load during prepare(), see preload_scene() */
+	std::string preloaded_scene_path;
+
+	std::future<std::unique_ptr<vkb::scene_graph::HPPScene>> preloaded_scene;
+
 	std::unique_ptr<vkb::core::HPPDebugUtils> debug_utils;
+
+	/** @brief Compacts the memory blocks, see the --memory-defragmentation option */
+	std::unique_ptr<vkb::Defragmenter> defragmenter;
+
+	/** @brief Keeps the pipeline cache of the resource cache on disk, see vkb::portability::Settings */
+	std::unique_ptr<vkb::PipelineCacheStore> resource_pipeline_cache_store;
 };
 
 template <vkb::BindingType bindingType>
@@ -465,7 +547,19 @@ inline VulkanSample<bindingType>::~VulkanSample()
 	scene.reset();
 	stats.reset();
 	gui.reset();
+	render_pipeline.reset();
 	render_context.reset();
+	compute_context.reset();
+	defragmenter.reset();
+
+	if (resource_pipeline_cache_store)
+	{
+		// Writes the cache a last time before destroying it
+		device->get_resource_cache().set_pipeline_cache(nullptr);
+		resource_pipeline_cache_store.reset();
+	}
+
+	vkb::gpu_profiling::destroy_context();
 	device.reset();
 
 	if (surface)
@@ -554,7 +648,7 @@ void VulkanSample<bindingType>::create_render_context_impl(const std::vector<vk:
 #endif
 
 	render_context =
-	    std::make_unique<vkb::rendering::HPPRenderContext>(*device, surface, *window, present_mode, present_mode_priority_list, surface_priority_list);
+	    std::make_unique<vkb::rendering::HPPRenderContext>(*device, surface, *window, present_mode, present_mode_priority_list, surface_priority_list, pre_rotation);
 }
 
 template <vkb::BindingType bindingType>
@@ -588,9 +682,13 @@ inline void VulkanSample<bindingType>::draw_impl(vkb::core::HPPCommandBuffer &co
 		command_buffer.image_memory_barrier(views[0], memory_barrier);
 		render_target.set_layout(0, memory_barrier.new_layout);
 
-		// Skip 1 as it is handled later as a depth-stencil attachment
+		// Skip 1 as it is handled later as a depth-stencil attachment, with the depth resolve attachments
 		for (size_t i = 2; i < views.size(); ++i)
 		{
+			if (vkb::common::is_depth_format(views[i].get_format()))
+			{
+				continue;
+			}
 			command_buffer.image_memory_barrier(views[i], memory_barrier);
 			render_target.set_layout(static_cast<uint32_t>(i), memory_barrier.new_layout);
 		}
@@ -607,6 +705,15 @@ inline void VulkanSample<bindingType>::draw_impl(vkb::core::HPPCommandBuffer &co
 
 		command_buffer.image_memory_barrier(views[1], memory_barrier);
 		render_target.set_layout(1, memory_barrier.new_layout);
+
+		for (size_t i = 2; i < views.size(); ++i)
+		{
+			if (vkb::common::is_depth_format(views[i].get_format()))
+			{
+				command_buffer.image_memory_barrier(views[i], memory_barrier);
+				render_target.set_layout(static_cast<uint32_t>(i), memory_barrier.new_layout);
+			}
+		}
 	}
 
 	if constexpr (bindingType == BindingType::Cpp)
@@ -636,6 +743,12 @@ inline void VulkanSample<bindingType>::draw_gui()
 {
 }
 
+template <vkb::BindingType bindingType>
+inline void VulkanSample<bindingType>::dispatch(CommandBufferType &command_buffer)
+{
+	// To be overridden by compute-only samples
+}
+
 template <vkb::BindingType bindingType>
 inline void VulkanSample<bindingType>::draw_renderpass(CommandBufferType &command_buffer, RenderTargetType &render_target)
 {
@@ -660,17 +773,36 @@ inline void VulkanSample<bindingType>::draw_renderpass_impl(vkb::core::HPPComman
 	}
 	else
 	{
-		set_viewport_and_scissor(reinterpret_cast<vkb::CommandBuffer const &>(command_buffer),
+		set_viewport_and_scissor(reinterpret_cast<vkb::CommandBuffer &>(command_buffer),
 		                         reinterpret_cast<VkExtent2D const &>(render_target.get_extent()));
 		render(reinterpret_cast<vkb::CommandBuffer &>(command_buffer));
 	}
 
 	if (gui)
 	{
-		gui->draw(command_buffer);
+		if (render_pipeline && render_pipeline->get_last_subpass_contents() == vk::SubpassContents::eSecondaryCommandBuffers)
+		{
+			// The last subpass only accepts secondary command buffers, so the gui gets one too
+			// With the reset mode of the primary, as requesting another one recreates the pools of the frame
+			auto &secondary_command_buffer = render_context->get_active_frame().request_command_buffer(device->get_queue_by_flags(vk::QueueFlagBits::eGraphics, 0),
+			                                                                                           command_buffer.get_reset_mode(),
+			                                                                                           vk::CommandBufferLevel::eSecondary);
+
+			secondary_command_buffer.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue, &command_buffer);
+			set_viewport_and_scissor_impl(secondary_command_buffer, render_target.get_extent());
+			gui->draw(secondary_command_buffer);
+			secondary_command_buffer.end();
+
+			command_buffer.execute_commands(secondary_command_buffer);
+		}
+		else
+		{
+			gui->draw(command_buffer);
+		}
 	}
 
-	command_buffer.get_handle().endRenderPass();
+	// Ends the dynamic rendering instance instead, if the render pipeline began one
+	reinterpret_cast<vkb::CommandBuffer &>(command_buffer).end_render_pass();
 }
 
 template <vkb::BindingType bindingType>
@@ -681,6 +813,12 @@ inline void VulkanSample<bindingType>::finish()
 	if (device)
 	{
 		device->get_handle().waitIdle();
+
+		// Only vkb::ResourceCache records the pipelines it creates
+		if constexpr (bindingType == BindingType::C)
+		{
+			get_device().get_resource_cache().WritePipelineCreationReport(vkb::filesystem::get()->temp_directory() / "pipeline_creations.csv");
+		}
 	}
 }
 
@@ -951,6 +1089,26 @@ inline bool VulkanSample<bindingType>::has_render_context() const
 	return render_context != nullptr;
 }
 
+template <vkb::BindingType bindingType>
+inline bool VulkanSample<bindingType>::is_compute_only() const
+{
+	return compute_only;
+}
+
+template <vkb::BindingType bindingType>
+inline void VulkanSample<bindingType>::enable_compute_only()
+{
+	assert(!device && "Compute-only mode must be enabled before the sample is prepared");
+	compute_only = true;
+}
+
+template <vkb::BindingType bindingType>
+inline vkb::ComputeContext &VulkanSample<bindingType>::get_compute_context()
+{
+	assert(compute_context && "Compute context is not valid, the sample isn't compute-only");
+	return *compute_context;
+}
+
 template <vkb::BindingType bindingType>
 inline bool VulkanSample<bindingType>::has_render_pipeline() const
 {
@@ -994,17 +1152,31 @@ inline void VulkanSample<bindingType>::input_event(const InputEvent &input_event
 		if (key_event.get_action() == KeyAction::Down &&
 		    (key_event.get_code() == KeyCode::PrintScreen || key_event.get_code() == KeyCode::F12))
 		{
-			vkb::common::screenshot(*render_context, "screenshot-" + get_name());
+			if (render_context)
+			{
+				vkb::common::screenshot(*render_context, "screenshot-" + get_name());
+			}
+		}
+		else if (key_event.get_action() == KeyAction::Down && key_event.get_code() == KeyCode::F5)
+		{
+			// Only the pipelines of the edited shader files are rebuilt, in the background
+			device->get_resource_cache().ReloadShaders();
 		}
 	}
 }
 
 template <vkb::BindingType bindingType>
-inline void VulkanSample<bindingType>::load_scene(const std::string &path)
+inline void VulkanSample<bindingType>::load_scene(const std::string &path, VkBufferUsageFlags additional_buffer_usage_flags)
 {
+	if (preloaded_scene.valid() && path == preloaded_scene_path && additional_buffer_usage_flags == 0)
+	{
+		scene = preloaded_scene.get();
+		return;
+	}
+
 	vkb::HPPGLTFLoader loader(*device);
 
-	scene = loader.read_scene_from_file(path);
+	scene = loader.read_scene_from_file(path, -1, static_cast<vk::BufferUsageFlags>(additional_buffer_usage_flags));
 
 	if (!scene)
 	{
@@ -1013,6 +1185,13 @@ inline void VulkanSample<bindingType>::load_scene(const std::string &path)
 	}
 }
 
+template <vkb::BindingType bindingType>
+inline void VulkanSample<bindingType>::preload_scene(const std::string &path)
+{
+	assert(!device && "The scene must be preloaded before prepare()");
+	preloaded_scene_path = path;
+}
+
 template <vkb::BindingType bindingType>
 inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options)
 {
@@ -1023,6 +1202,14 @@ inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options
 
 	LOGI("Initializing Vulkan sample");
 
+	// Times each phase of the startup, scene loading included when it overlaps the render context setup
+	Timer startup_timer;
+	startup_timer.start();
+	auto log_startup_phase = [&startup_timer](const char *phase) {
+		LOGI("Startup: {} took {:.1f} ms", phase, startup_timer.elapsed<Timer::Milliseconds>());
+		startup_timer.lap();
+	};
+
 	// initialize C++-Bindings default dispatcher, first step
 #if defined(_HPP_VULKAN_LIBRARY)
 	static vk::DynamicLoader dl(_HPP_VULKAN_LIBRARY);
@@ -1031,7 +1218,11 @@ inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options
 #endif
 	VULKAN_HPP_DEFAULT_DISPATCHER.init(dl.getProcAddress<PFN_vkGetInstanceProcAddr>("vkGetInstanceProcAddr"));
 
-	bool headless = window->get_window_mode() == Window::Mode::Headless;
+	bool headless  = window->get_window_mode() == Window::Mode::Headless;
+	bool offscreen = window->get_window_mode() == Window::Mode::Offscreen;
+
+	// Compute-only samples have no surface, whatever the window mode
+	bool surfaceless = offscreen || compute_only;
 
 	// for a while we're running on mixed C- and C++-bindings, needing volk for the C-bindings!
 	VkResult result = volkInitialize();
@@ -1041,10 +1232,32 @@ inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options
 	}
 
 	// Creating the vulkan instance
-	for (const char *extension_name : window->get_required_surface_extensions())
+	if (!compute_only)
+	{
+		for (const char *extension_name : window->get_required_surface_extensions())
+		{
+			add_instance_extension(extension_name);
+		}
+	}
+	else
+	{
+		// Lets the compute context query the timeline semaphore feature
+		add_instance_extension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, /*optional=*/true);
+	}
+
+	// Lets direct-to-display windows wait for the vertical blanking of the display, see Window::wait_for_vblank
+	if (instance_extensions.find(VK_KHR_DISPLAY_EXTENSION_NAME) != instance_extensions.end())
+	{
+		add_instance_extension(VK_EXT_DISPLAY_SURFACE_COUNTER_EXTENSION_NAME, /*optional=*/true);
+	}
+
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+	// VK_EXT_full_screen_exclusive depends on it, see Window::get_full_screen_exclusive_monitor
+	if (window->get_window_mode() == Window::Mode::FullscreenExclusive)
 	{
-		add_instance_extension(extension_name);
+		add_instance_extension(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME, /*optional=*/true);
 	}
+#endif
 
 #ifdef VKB_VULKAN_DEBUG
 	{
@@ -1075,22 +1288,42 @@ inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options
 	// initialize C++-Bindings default dispatcher, second step
 	VULKAN_HPP_DEFAULT_DISPATCHER.init(instance->get_handle());
 
-	// Getting a valid vulkan surface from the platform
-	surface = static_cast<vk::SurfaceKHR>(window->create_surface(reinterpret_cast<vkb::Instance &>(*instance)));
-	if (!surface)
+	log_startup_phase("instance creation");
+
+	// Getting a valid vulkan surface from the platform, the render context renders offscreen without one
+	if (!compute_only)
+	{
+		surface = static_cast<vk::SurfaceKHR>(window->create_surface(reinterpret_cast<vkb::Instance &>(*instance)));
+	}
+	if (!surface && !surfaceless)
 	{
 		throw std::runtime_error("Failed to create window surface.");
 	}
 
-	auto &gpu = instance->get_suitable_gpu(surface, headless);
+	auto &gpu = instance->get_suitable_gpu(surface, headless || surfaceless);
 	gpu.set_high_priority_graphics_queue_enable(high_priority_graphics_queue);
 
+#ifdef VKB_ENABLE_PORTABILITY
+	// Tunes the descriptor sets and the pipeline cache for MoltenVK, see vkb::portability::Settings
+	if (vkb::portability::is_molten_vk(reinterpret_cast<vkb::PhysicalDevice &>(gpu)))
+	{
+		LOGI("Running on MoltenVK, applying the MoltenVK portability settings");
+		vkb::portability::set_settings(vkb::portability::get_molten_vk_settings());
+	}
+#endif
+
 	// Request to enable ASTC
 	if (gpu.get_features().textureCompressionASTC_LDR)
 	{
 		gpu.get_mutable_requested_features().textureCompressionASTC_LDR = true;
 	}
 
+	// Lets the GPU frame timer count the shader invocations of the passes, see vkb::GpuFrameTimer::enable_pipeline_statistics()
+	if (gpu.get_features().pipelineStatisticsQuery)
+	{
+		gpu.get_mutable_requested_features().pipelineStatisticsQuery = true;
+	}
+
 	// Request sample required GPU features
 	if constexpr (bindingType == BindingType::Cpp)
 	{
@@ -1101,8 +1334,9 @@ inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options
 		request_gpu_features(reinterpret_cast<vkb::PhysicalDevice &>(gpu));
 	}
 
-	// Creating vulkan device, specifying the swapchain extension always
+	// Creating vulkan device, specifying the swapchain extension unless rendering offscreen
 	// If using VK_EXT_headless_surface, we still create and use a swap-chain
+	if (!surfaceless)
 	{
 		add_device_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
@@ -1110,6 +1344,107 @@ inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options
 		{
 			add_device_extension(VK_KHR_DISPLAY_SWAPCHAIN_EXTENSION_NAME, /*optional=*/true);
 		}
+
+		if (instance->is_enabled(VK_EXT_DISPLAY_SURFACE_COUNTER_EXTENSION_NAME))
+		{
+			add_device_extension(VK_EXT_DISPLAY_CONTROL_EXTENSION_NAME, /*optional=*/true);
+		}
+
+#if defined(VK_USE_PLATFORM_WIN32_KHR)
+		if (instance->is_enabled(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME))
+		{
+			add_device_extension(VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME, /*optional=*/true);
+		}
+#endif
+	}
+
+	// Lets DescriptorSetLayout create update templates to write whole descriptor sets in one call
+	add_device_extension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, /*optional=*/true);
+
+	// Lets the pipelines report their creation time and pipeline cache hits, see Pipeline::get_creation_feedback
+	add_device_extension(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME, /*optional=*/true);
+
+	// Lets the command buffers push the descriptor sets with per-draw resources, see ShaderResourceMode::PerDraw
+	if (instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+	{
+		add_device_extension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME, /*optional=*/true);
+	}
+
+	// Lets the frame pacer wait for the presentation of older frames and measure their latency, see vkb::FramePacer
+	if (instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+	{
+		add_device_extension(VK_KHR_PRESENT_ID_EXTENSION_NAME, /*optional=*/true);
+		add_device_extension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME, /*optional=*/true);
+		vkb::FramePacer::request_features(reinterpret_cast<vkb::PhysicalDevice &>(gpu));
+	}
+
+	// Lets the GPU frame timer and the GPU zones place their timestamps on the CPU clock, see vkb::TimestampCalibration
+	if (instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+	{
+		add_device_extension(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, /*optional=*/true);
+	}
+
+	// Lets the VMA give each class of resources a memory priority, see vkb::allocated::Settings
+	if (instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) && gpu.is_extension_supported(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME) &&
+	    HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceMemoryPriorityFeaturesEXT, memoryPriority))
+	{
+		add_device_extension(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
+	}
+
+	// Lets the subpasses light the scene in half precision, see vkb::select_shader_precision
+	if (instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) && gpu.is_extension_supported(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME) &&
+	    HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceShaderFloat16Int8FeaturesKHR, shaderFloat16))
+	{
+		add_device_extension(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME);
+	}
+
+	// Lets the compute and render contexts pace the frames with a timeline semaphore instead of a fence per submission
+	if (instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) &&
+	    gpu.is_extension_supported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) &&
+	    HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR, timelineSemaphore))
+	{
+		add_device_extension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+	}
+
+	// Lets the render frames write their descriptors into descriptor buffers, see the --descriptor-buffers option
+	if (vkb::backend::get_settings().descriptor_buffers && instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) &&
+	    gpu.is_extension_supported(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) && gpu.is_extension_supported(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME) &&
+	    gpu.get_extension_features<vk::PhysicalDeviceBufferDeviceAddressFeaturesKHR>().bufferDeviceAddress &&
+	    HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceDescriptorBufferFeaturesEXT, descriptorBuffer))
+	{
+		HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceBufferDeviceAddressFeaturesKHR, bufferDeviceAddress);
+		add_device_extension(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+		add_device_extension(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+
+		// Required by VK_EXT_descriptor_buffer, core in Vulkan 1.2 and 1.3
+		add_device_extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, /*optional=*/true);
+		add_device_extension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME, /*optional=*/true);
+	}
+
+	// Lets the command buffers bind shader objects instead of pipelines, see the --shader-objects option
+	if (vkb::backend::get_settings().shader_objects && instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) &&
+	    gpu.is_extension_supported(VK_EXT_SHADER_OBJECT_EXTENSION_NAME) &&
+	    HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceShaderObjectFeaturesEXT, shaderObject))
+	{
+		add_device_extension(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+
+		// Required by VK_EXT_shader_object, core in Vulkan 1.3
+		add_device_extension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, /*optional=*/true);
+	}
+
+	// Lets the render pipelines begin rendering instances instead of render passes, see the --dynamic-rendering option
+	if (vkb::backend::get_settings().dynamic_rendering && instance->is_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) &&
+	    gpu.is_extension_supported(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) &&
+	    HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceDynamicRenderingFeaturesKHR, dynamicRendering))
+	{
+		add_device_extension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+		// Lets the subpasses reading input attachments share a single rendering instance
+		if (gpu.is_extension_supported(VK_KHR_DYNAMIC_RENDERING_LOCAL_READ_EXTENSION_NAME) &&
+		    HPP_REQUEST_OPTIONAL_FEATURE(gpu, vk::PhysicalDeviceDynamicRenderingLocalReadFeaturesKHR, dynamicRenderingLocalRead))
+		{
+			add_device_extension(VK_KHR_DYNAMIC_RENDERING_LOCAL_READ_EXTENSION_NAME);
+		}
 	}
 
 #ifdef VKB_ENABLE_PORTABILITY
@@ -1157,10 +1492,96 @@ inline bool VulkanSample<bindingType>::prepare(const ApplicationOptions &options
 	// initialize C++-Bindings default dispatcher, optional third step
 	VULKAN_HPP_DEFAULT_DISPATCHER.init(device->get_handle());
 
-	create_render_context();
-	prepare_render_context();
+	// Before the render context, whose frames pick their descriptor management from the device
+	if (vkb::backend::get_settings().descriptor_buffers)
+	{
+		device->enable_descriptor_buffers();
+	}
+	if (vkb::backend::get_settings().shader_objects)
+	{
+		reinterpret_cast<vkb::Device &>(*device).enable_shader_objects();
+	}
+	if (vkb::backend::get_settings().dynamic_rendering)
+	{
+		reinterpret_cast<vkb::Device &>(*device).enable_dynamic_rendering();
+	}
+
+	log_startup_phase("physical device selection and device creation");
+
+	if (vkb::portability::get_settings().persistent_pipeline_cache)
+	{
+		// The pipelines created through the resource cache don't depend on the other samples, so each one keeps a file of its own
+		auto path = vkb::filesystem::get()->temp_directory() / "pipeline_caches" / (get_name() + "_resources.bin");
+
+		resource_pipeline_cache_store = std::make_unique<vkb::PipelineCacheStore>(reinterpret_cast<vkb::Device &>(*device), path);
+		device->get_resource_cache().set_pipeline_cache(resource_pipeline_cache_store->get_handle());
+	}
+
+	// Submits a calibration command buffer, before the loader thread is started
+	vkb::gpu_profiling::create_context(reinterpret_cast<vkb::Device &>(*device));
+
+	if (compute_only)
+	{
+		compute_context = std::make_unique<vkb::ComputeContext>(reinterpret_cast<vkb::Device &>(*device));
+
+		log_startup_phase("compute context setup");
+	}
+	else
+	{
+		create_render_context();
+		if (device->is_enabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+		{
+			// Lets the deferred destruction queue retire objects by the progress of the queues, without waiting for the device
+			render_context->enable_timeline_semaphores();
+		}
+		prepare_render_context();
+	}
+
+	if (!preloaded_scene_path.empty())
+	{
+		// Started once the contexts are prepared, as their setup waits for the device to be idle, which mustn't overlap
+		// the submissions of the loader thread
+		preloaded_scene = std::async(std::launch::async, [this]() {
+			Timer scene_timer;
+			scene_timer.start();
+
+			vkb::HPPGLTFLoader loader(*device);
+			auto               loaded_scene = loader.read_scene_from_file(preloaded_scene_path);
+			if (!loaded_scene)
+			{
+				LOGE("Cannot load scene: {}", preloaded_scene_path.c_str());
+				throw std::runtime_error("Cannot load scene: " + preloaded_scene_path);
+			}
+
+			LOGI("Startup: loading {} took {:.1f} ms", preloaded_scene_path, scene_timer.stop<Timer::Milliseconds>());
+			return loaded_scene;
+		});
+	}
+
+	if (!compute_only)
+	{
+		// Spread the frames over the GPUs of the device group, see the --device-group option
+		if (device->get_physical_device_count() > 1)
+		{
+			render_context->enable_alternate_frame_rendering();
+		}
+
+		stats = std::make_unique<vkb::stats::HPPStats>(*render_context);
+
+		log_startup_phase("render context setup");
+	}
+
+	if (preloaded_scene.valid())
+	{
+		// The sample may submit work as soon as it is prepared, so the loader must be done with the queues
+		preloaded_scene.wait();
+		log_startup_phase("waiting for the scene");
+	}
 
-	stats = std::make_unique<vkb::stats::HPPStats>(*render_context);
+	if (vkb::allocated::get_settings().defragmentation)
+	{
+		defragmenter = std::make_unique<vkb::Defragmenter>(reinterpret_cast<vkb::Device &>(*device));
+	}
 
 	// Start the sample in the first GUI configuration
 	configuration.reset();
@@ -1180,6 +1601,11 @@ inline void VulkanSample<bindingType>::create_gui(const Window &window, StatsTyp
 		gui = std::make_unique<vkb::HPPGui>(
 		    *reinterpret_cast<VulkanSampleCpp *>(this), window, reinterpret_cast<vkb::stats::HPPStats const *>(stats), font_size, explicit_update);
 	}
+
+	if (is_gui_cached())
+	{
+		gui->set_cached(true);
+	}
 }
 
 template <vkb::BindingType bindingType>
@@ -1263,6 +1689,12 @@ inline void VulkanSample<bindingType>::set_high_priority_graphics_queue_enable(b
 	high_priority_graphics_queue = enable;
 }
 
+template <vkb::BindingType bindingType>
+inline void VulkanSample<bindingType>::set_pre_rotation_enable(bool enable)
+{
+	pre_rotation = enable;
+}
+
 template <vkb::BindingType bindingType>
 inline void VulkanSample<bindingType>::set_render_context(std::unique_ptr<RenderContextType> &&rc)
 {
@@ -1290,7 +1722,7 @@ inline void VulkanSample<bindingType>::set_render_pipeline(std::unique_ptr<Rende
 }
 
 template <vkb::BindingType bindingType>
-inline void VulkanSample<bindingType>::set_viewport_and_scissor(CommandBufferType const &command_buffer, Extent2DType const &extent)
+inline void VulkanSample<bindingType>::set_viewport_and_scissor(CommandBufferType &command_buffer, Extent2DType const &extent)
 {
 	if constexpr (bindingType == BindingType::Cpp)
 	{
@@ -1298,15 +1730,16 @@ inline void VulkanSample<bindingType>::set_viewport_and_scissor(CommandBufferTyp
 	}
 	else
 	{
-		set_viewport_and_scissor_impl(reinterpret_cast<vkb::core::HPPCommandBuffer const &>(command_buffer), reinterpret_cast<vk::Extent2D const &>(extent));
+		set_viewport_and_scissor_impl(reinterpret_cast<vkb::core::HPPCommandBuffer &>(command_buffer), reinterpret_cast<vk::Extent2D const &>(extent));
 	}
 }
 
 template <vkb::BindingType bindingType>
-inline void VulkanSample<bindingType>::set_viewport_and_scissor_impl(vkb::core::HPPCommandBuffer const &command_buffer, vk::Extent2D const &extent)
+inline void VulkanSample<bindingType>::set_viewport_and_scissor_impl(vkb::core::HPPCommandBuffer &command_buffer, vk::Extent2D const &extent)
 {
-	command_buffer.get_handle().setViewport(0, {{0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f}});
-	command_buffer.get_handle().setScissor(0, vk::Rect2D({}, extent));
+	// Through the wrapper, which skips them if the command buffer already has them
+	command_buffer.set_viewport(0, {{0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f}});
+	command_buffer.set_scissor(0, {vk::Rect2D({}, extent)});
 }
 
 template <vkb::BindingType bindingType>
@@ -1314,6 +1747,21 @@ inline void VulkanSample<bindingType>::update(float delta_time)
 {
 	vkb::Application::update(delta_time);
 
+	if (compute_only)
+	{
+		update_compute(delta_time);
+		return;
+	}
+
+	// Waits for older frames before the simulation, so it starts as late as the frames in flight allow
+	render_context->pace_frame();
+
+	if (defragmenter)
+	{
+		// No frame is being recorded, so the moved buffers are only referenced by the frames in flight
+		defragmenter->update();
+	}
+
 	update_scene(delta_time);
 
 	update_gui(delta_time);
@@ -1324,22 +1772,66 @@ inline void VulkanSample<bindingType>::update(float delta_time)
 	update_stats(delta_time);
 
 	command_buffer.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+	vkb::gpu_profiling::collect(static_cast<VkCommandBuffer>(command_buffer.get_handle()));
 	stats->begin_sampling(command_buffer);
 
-	if constexpr (bindingType == BindingType::Cpp)
 	{
-		draw(command_buffer, render_context->get_active_frame().get_render_target());
-	}
-	else
-	{
-		draw(reinterpret_cast<vkb::CommandBuffer &>(command_buffer),
-		     reinterpret_cast<vkb::RenderTarget &>(render_context->get_active_frame().get_render_target()));
+		PROFILE_GPU_SCOPE(static_cast<VkCommandBuffer>(command_buffer.get_handle()), "Draw");
+
+		if constexpr (bindingType == BindingType::Cpp)
+		{
+			draw(command_buffer, render_context->get_active_frame().get_render_target());
+		}
+		else
+		{
+			draw(reinterpret_cast<vkb::CommandBuffer &>(command_buffer),
+			     reinterpret_cast<vkb::RenderTarget &>(render_context->get_active_frame().get_render_target()));
+		}
 	}
 
 	stats->end_sampling(command_buffer);
 	command_buffer.end();
 
 	render_context->submit(command_buffer);
+
+	PROFILE_FRAME();
+}
+
+template <vkb::BindingType bindingType>
+inline void VulkanSample<bindingType>::update_compute(float delta_time)
+{
+	if (defragmenter)
+	{
+		// No frame is being recorded, the moved buffers are only referenced by the frames in flight
+		defragmenter->update();
+	}
+
+	update_scene(delta_time);
+
+	// Waits for the submission of the frame, frame count frames ago
+	auto &command_buffer = compute_context->begin();
+
+	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	vkb::gpu_profiling::collect(command_buffer.get_handle());
+
+	{
+		PROFILE_GPU_SCOPE(command_buffer.get_handle(), "Dispatch");
+
+		if constexpr (bindingType == BindingType::Cpp)
+		{
+			dispatch(reinterpret_cast<vkb::core::HPPCommandBuffer &>(command_buffer));
+		}
+		else
+		{
+			dispatch(command_buffer);
+		}
+	}
+
+	command_buffer.end();
+
+	compute_context->submit(command_buffer);
+
+	PROFILE_FRAME();
 }
 
 template <vkb::BindingType bindingType>
@@ -1350,10 +1842,10 @@ inline void VulkanSample<bindingType>::update_debug_window()
 
 	get_debug_info().template insert<field::Static, std::string>("driver_version", driver_version_str);
 	get_debug_info().template insert<field::Static, std::string>("resolution",
-	                                                             to_string(static_cast<VkExtent2D const &>(render_context->get_swapchain().get_extent())));
+	                                                             to_string(static_cast<VkExtent2D const &>(render_context->get_surface_extent())));
 	get_debug_info().template insert<field::Static, std::string>("surface_format",
-	                                                             to_string(render_context->get_swapchain().get_format()) + " (" +
-	                                                                 to_string(vkb::common::get_bits_per_pixel(render_context->get_swapchain().get_format())) +
+	                                                             to_string(render_context->get_format()) + " (" +
+	                                                                 to_string(vkb::common::get_bits_per_pixel(render_context->get_format())) +
 	                                                                 "bpp)");
 
 	if (scene != nullptr)
@@ -1375,7 +1867,10 @@ inline void VulkanSample<bindingType>::update_debug_window()
 template <vkb::BindingType bindingType>
 inline void VulkanSample<bindingType>::update_gui(float delta_time)
 {
-	if (gui)
+	PROFILE_SCOPE("Update GUI");
+
+	// A cached GUI draws its last rebuild again, the windows are only shown when it may have changed
+	if (gui && gui->needs_rebuild(delta_time))
 	{
 		if (gui->is_debug_view_active())
 		{
@@ -1396,29 +1891,37 @@ inline void VulkanSample<bindingType>::update_gui(float delta_time)
 template <vkb::BindingType bindingType>
 inline void VulkanSample<bindingType>::update_scene(float delta_time)
 {
+	PROFILE_SCOPE("Update Scene");
+
 	if (scene)
 	{
-		// Update scripts
-		if (scene->has_component<sg::Script>())
+		// Update scripts, the views walk the scene components without building lists every frame
+		// The projections of the cameras driven by the user target the swapchain, the others keep their own orientation
+		auto pre_rotation_matrix = render_context ? render_context->get_pre_rotation() : glm::mat4(1.0f);
+
+		for (auto script : scene->get_component_view<sg::Script>())
 		{
-			auto scripts = scene->get_components<sg::Script>();
+			script->update(delta_time);
 
-			for (auto script : scripts)
+			if (auto free_camera = dynamic_cast<sg::FreeCamera *>(script))
 			{
-				script->update(delta_time);
+				auto &node = free_camera->get_node();
+				if (node.has_component<sg::Camera>())
+				{
+					node.get_component<sg::Camera>().set_pre_rotation(pre_rotation_matrix);
+				}
 			}
 		}
 
-		// Update animations
-		if (scene->has_component<sg::Animation>())
+		// Update animations, large ones are split across the job system
+		auto &jobs = JobSystem::get();
+		for (auto animation : scene->get_component_view<sg::Animation>())
 		{
-			auto animations = scene->get_components<sg::Animation>();
-
-			for (auto animation : animations)
-			{
-				animation->update(delta_time);
-			}
+			animation->update(delta_time, &jobs);
 		}
+
+		// Propagate the transforms changed by the scripts and animations in a single sweep
+		scene->update_transforms(&jobs);
 	}
 }
 
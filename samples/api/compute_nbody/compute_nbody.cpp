@@ -58,6 +58,11 @@ ComputeNBody::~ComputeNBody()
 
 		vkDestroySampler(get_device().get_handle(), textures.particle.sampler, nullptr);
 		vkDestroySampler(get_device().get_handle(), textures.gradient.sampler, nullptr);
+
+		if (query_pool_timestamps != VK_NULL_HANDLE)
+		{
+			vkDestroyQueryPool(get_device().get_handle(), query_pool_timestamps, nullptr);
+		}
 	}
 }
 
@@ -100,6 +105,11 @@ void ComputeNBody::build_command_buffers()
 
 		VK_CHECK(vkBeginCommandBuffer(draw_cmd_buffers[i], &command_buffer_begin_info));
 
+		if (time_stamps_supported)
+		{
+			vkCmdResetQueryPool(draw_cmd_buffers[i], query_pool_timestamps, 2, 2);
+		}
+
 		// Acquire
 		if (graphics.queue_family_index != compute.queue_family_index)
 		{
@@ -125,6 +135,11 @@ void ComputeNBody::build_command_buffers()
 			    0, nullptr);
 		}
 
+		if (time_stamps_supported)
+		{
+			vkCmdWriteTimestamp(draw_cmd_buffers[i], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query_pool_timestamps, 2);
+		}
+
 		// Draw the particle system using the update vertex buffer
 		vkCmdBeginRenderPass(draw_cmd_buffers[i], &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 		VkViewport viewport = vkb::initializers::viewport(static_cast<float>(width), static_cast<float>(height), 0.0f, 1.0f);
@@ -139,6 +154,11 @@ void ComputeNBody::build_command_buffers()
 		draw_ui(draw_cmd_buffers[i]);
 		vkCmdEndRenderPass(draw_cmd_buffers[i]);
 
+		if (time_stamps_supported)
+		{
+			vkCmdWriteTimestamp(draw_cmd_buffers[i], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pool_timestamps, 3);
+		}
+
 		// Release barrier
 		if (graphics.queue_family_index != compute.queue_family_index)
 		{
@@ -174,6 +194,12 @@ void ComputeNBody::build_compute_command_buffer()
 
 	VK_CHECK(vkBeginCommandBuffer(compute.command_buffer, &command_buffer_begin_info));
 
+	if (time_stamps_supported)
+	{
+		vkCmdResetQueryPool(compute.command_buffer, query_pool_timestamps, 0, 2);
+		vkCmdWriteTimestamp(compute.command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query_pool_timestamps, 0);
+	}
+
 	// Acquire
 	if (graphics.queue_family_index != compute.queue_family_index)
 	{
@@ -203,7 +229,9 @@ void ComputeNBody::build_compute_command_buffer()
 	// -------------------------------------------------------------------------------------------------------
 	vkCmdBindPipeline(compute.command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, compute.pipeline_calculate);
 	vkCmdBindDescriptorSets(compute.command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, compute.pipeline_layout, 0, 1, &compute.descriptor_set, 0, 0);
-	vkCmdDispatch(compute.command_buffer, num_particles / work_group_size, 1, 1);
+	// The last work group is partially filled when the particle count isn't a multiple of its size
+	uint32_t group_count = (num_particles + work_group_size - 1) / work_group_size;
+	vkCmdDispatch(compute.command_buffer, group_count, 1, 1);
 
 	// Add memory barrier to ensure that the computer shader has finished writing to the buffer
 	VkBufferMemoryBarrier memory_barrier = vkb::initializers::buffer_memory_barrier();
@@ -226,7 +254,12 @@ void ComputeNBody::build_compute_command_buffer()
 	// Second pass: Integrate particles
 	// -------------------------------------------------------------------------------------------------------
 	vkCmdBindPipeline(compute.command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, compute.pipeline_integrate);
-	vkCmdDispatch(compute.command_buffer, num_particles / work_group_size, 1, 1);
+	vkCmdDispatch(compute.command_buffer, group_count, 1, 1);
+
+	if (time_stamps_supported)
+	{
+		vkCmdWriteTimestamp(compute.command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pool_timestamps, 1);
+	}
 
 	// Release
 	if (graphics.queue_family_index != compute.queue_family_index)
@@ -275,7 +308,7 @@ void ComputeNBody::prepare_storage_buffers()
 	};
 #endif
 
-	num_particles = static_cast<uint32_t>(attractors.size()) * PARTICLES_PER_ATTRACTOR;
+	num_particles = static_cast<uint32_t>(attractors.size()) * particles_per_attractor;
 
 	// Initial particle positions
 	std::vector<Particle> particle_buffer(num_particles);
@@ -285,9 +318,9 @@ void ComputeNBody::prepare_storage_buffers()
 
 	for (uint32_t i = 0; i < static_cast<uint32_t>(attractors.size()); i++)
 	{
-		for (uint32_t j = 0; j < PARTICLES_PER_ATTRACTOR; j++)
+		for (uint32_t j = 0; j < particles_per_attractor; j++)
 		{
-			Particle &particle = particle_buffer[i * PARTICLES_PER_ATTRACTOR + j];
+			Particle &particle = particle_buffer[i * particles_per_attractor + j];
 
 			// First particle in group as heavy center of gravity
 			if (j == 0)
@@ -649,6 +682,7 @@ void ComputeNBody::prepare_compute()
 	VkCommandPoolCreateInfo command_pool_create_info = {};
 	command_pool_create_info.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	command_pool_create_info.queueFamilyIndex        = get_device().get_queue_family_index(VK_QUEUE_COMPUTE_BIT);
+	command_pool_create_info.flags                   = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;        // The command buffer is recorded again when the particle count changes
 	VK_CHECK(vkCreateCommandPool(get_device().get_handle(), &command_pool_create_info, nullptr, &compute.command_pool));
 
 	// Create a command buffer for compute operations
@@ -674,8 +708,13 @@ void ComputeNBody::prepare_compute()
 	// Build a single command buffer containing the compute dispatch commands
 	build_compute_command_buffer();
 
-	// If necessary, acquire and immediately release the storage buffer, so that the initial acquire
-	// from the graphics command buffers are matched up properly.
+	release_storage_buffer_to_graphics();
+}
+
+// If necessary, acquire and immediately release the storage buffer, so that the initial acquire
+// from the graphics command buffers are matched up properly.
+void ComputeNBody::release_storage_buffer_to_graphics()
+{
 	if (graphics.queue_family_index != compute.queue_family_index)
 	{
 		VkCommandBuffer transfer_command;
@@ -760,6 +799,83 @@ void ComputeNBody::prepare_compute()
 	}
 }
 
+// Replaces the particles with a new set, when their count changes
+void ComputeNBody::recreate_storage_buffers()
+{
+	get_device().wait_idle();
+
+	prepare_storage_buffers();
+	release_storage_buffer_to_graphics();
+
+	VkDescriptorBufferInfo storage_buffer_descriptor = create_descriptor(*compute.storage_buffer);
+	VkWriteDescriptorSet   storage_buffer_write =
+	    vkb::initializers::write_descriptor_set(
+	        compute.descriptor_set,
+	        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+	        0,
+	        &storage_buffer_descriptor);
+	vkUpdateDescriptorSets(get_device().get_handle(), 1, &storage_buffer_write, 0, NULL);
+
+	build_compute_command_buffer();
+	rebuild_command_buffers();
+}
+
+void ComputeNBody::prepare_time_stamp_queries()
+{
+	// Timing is optional, the simulation also runs on queues without timestamp support
+	const auto &limits                  = get_device().get_gpu().get_properties().limits;
+	const auto &queue_family_properties = get_device().get_gpu().get_queue_family_properties();
+	time_stamps_supported               = (limits.timestampPeriod > 0) &&
+	                        (queue_family_properties[graphics.queue_family_index].timestampValidBits > 0) &&
+	                        (queue_family_properties[compute.queue_family_index].timestampValidBits > 0);
+	if (!time_stamps_supported)
+	{
+		LOGW("The graphics or compute queue doesn't support timestamp queries, timings are disabled");
+		return;
+	}
+
+	VkQueryPoolCreateInfo query_pool_info{};
+	query_pool_info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	query_pool_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	query_pool_info.queryCount = static_cast<uint32_t>(time_stamps.size());
+	VK_CHECK(vkCreateQueryPool(get_device().get_handle(), &query_pool_info, nullptr, &query_pool_timestamps));
+
+	// The results are read before the first submissions complete, so the queries start out reset
+	VkCommandBuffer reset_command = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+	vkCmdResetQueryPool(reset_command, query_pool_timestamps, 0, query_pool_info.queryCount);
+	get_device().flush_command_buffer(reset_command, queue, true);
+}
+
+void ComputeNBody::get_time_stamp_results()
+{
+	if (!time_stamps_supported)
+	{
+		return;
+	}
+
+	// Without VK_QUERY_RESULT_WAIT_BIT, so reading the timings doesn't stall the CPU on the queues
+	// Each query returns its value followed by its availability, and a pair is only kept once both queries are available
+	std::array<uint64_t, 8> results{};
+	vkGetQueryPoolResults(
+	    get_device().get_handle(),
+	    query_pool_timestamps,
+	    0,
+	    static_cast<uint32_t>(time_stamps.size()),
+	    results.size() * sizeof(uint64_t),
+	    results.data(),
+	    2 * sizeof(uint64_t),
+	    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	for (size_t pair = 0; pair < 2; ++pair)
+	{
+		if (results[pair * 4 + 1] != 0 && results[pair * 4 + 3] != 0)
+		{
+			time_stamps[pair * 2]     = results[pair * 4];
+			time_stamps[pair * 2 + 1] = results[pair * 4 + 2];
+		}
+	}
+}
+
 // Prepare and initialize uniform buffer containing shader uniforms
 void ComputeNBody::prepare_uniform_buffers()
 {
@@ -826,6 +942,8 @@ void ComputeNBody::draw()
 	compute_submit_info.signalSemaphoreCount = 1;
 	compute_submit_info.pSignalSemaphores    = &compute.semaphore;
 	VK_CHECK(vkQueueSubmit(compute.queue, 1, &compute_submit_info, VK_NULL_HANDLE));
+
+	get_time_stamp_results();
 }
 
 bool ComputeNBody::prepare(const vkb::ApplicationOptions &options)
@@ -838,14 +956,24 @@ bool ComputeNBody::prepare(const vkb::ApplicationOptions &options)
 	graphics.queue_family_index = get_device().get_queue_family_index(VK_QUEUE_GRAPHICS_BIT);
 	compute.queue_family_index  = get_device().get_queue_family_index(VK_QUEUE_COMPUTE_BIT);
 
-	// Not all implementations support a work group size of 256, so we need to check with the device limits
-	work_group_size = std::min(static_cast<uint32_t>(256), get_device().get_gpu().get_properties().limits.maxComputeWorkGroupSize[0]);
-	// Same for shared data size for passing data between shader invocations
-	shared_data_size = std::min(static_cast<uint32_t>(1024), static_cast<uint32_t>(get_device().get_gpu().get_properties().limits.maxComputeSharedMemorySize / sizeof(glm::vec4)));
+	// Each invocation loads one position of the tile shared by its work group, so larger work groups need fewer barriers per particle
+	// The size is bounded by the device limits, including the shared memory holding the tile
+	const auto &limits = get_device().get_gpu().get_properties().limits;
+	work_group_size    = std::min({static_cast<uint32_t>(512),
+	                               limits.maxComputeWorkGroupSize[0],
+	                               limits.maxComputeWorkGroupInvocations,
+	                               static_cast<uint32_t>(limits.maxComputeSharedMemorySize / sizeof(glm::vec4))});
+	if (get_shading_language() == vkb::ShadingLanguage::HLSL)
+	{
+		// The HLSL shaders are compiled offline with a fixed thread group size
+		work_group_size = 256;
+	}
+	shared_data_size = work_group_size;
 
 	load_assets();
 	setup_descriptor_pool();
 	prepare_graphics();
+	prepare_time_stamp_queries();
 	prepare_compute();
 	build_command_buffers();
 	prepared = true;
@@ -873,6 +1001,41 @@ bool ComputeNBody::resize(const uint32_t width, const uint32_t height)
 	return true;
 }
 
+void ComputeNBody::on_update_ui_overlay(vkb::Drawer &drawer)
+{
+	if (drawer.header("Settings"))
+	{
+		// The forces are summed over all pairs of particles, so the cost grows with the square of the count
+		std::vector<uint32_t> counts = {1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024};
+		if (std::find(counts.begin(), counts.end(), static_cast<uint32_t>(PARTICLES_PER_ATTRACTOR)) == counts.end())
+		{
+			counts.insert(std::upper_bound(counts.begin(), counts.end(), static_cast<uint32_t>(PARTICLES_PER_ATTRACTOR)), PARTICLES_PER_ATTRACTOR);
+		}
+
+		std::vector<std::string> names;
+		for (auto count : counts)
+		{
+			names.push_back(std::to_string(count));
+		}
+
+		int32_t index = static_cast<int32_t>(std::find(counts.begin(), counts.end(), particles_per_attractor) - counts.begin());
+		if (drawer.combo_box("Particles per attractor", &index, names))
+		{
+			particles_per_attractor = counts[index];
+			recreate_storage_buffers();
+		}
+		drawer.text("Particles: %u, work group size: %u", num_particles, work_group_size);
+	}
+	if (time_stamps_supported && drawer.header("Timing"))
+	{
+		// The timestampPeriod property of the device tells how many nanoseconds a timestamp step is
+		float timestamp_period = get_device().get_gpu().get_properties().limits.timestampPeriod;
+
+		drawer.text("Compute: %.3f ms", static_cast<float>(time_stamps[1] - time_stamps[0]) * timestamp_period / 1000000.0f);
+		drawer.text("Graphics: %.3f ms", static_cast<float>(time_stamps[3] - time_stamps[2]) * timestamp_period / 1000000.0f);
+	}
+}
+
 std::unique_ptr<vkb::Application> create_compute_nbody()
 {
 	return std::make_unique<ComputeNBody>();
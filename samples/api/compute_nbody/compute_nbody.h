@@ -34,8 +34,14 @@ class ComputeNBody : public ApiVulkanSample
 {
   public:
 	uint32_t num_particles;
-	uint32_t work_group_size  = 128;
-	uint32_t shared_data_size = 1024;
+	uint32_t particles_per_attractor = PARTICLES_PER_ATTRACTOR;
+	uint32_t work_group_size         = 128;
+	uint32_t shared_data_size        = 1024;
+
+	// Begin and end of the compute work (queries 0 and 1), then of the graphics work (queries 2 and 3)
+	VkQueryPool             query_pool_timestamps = VK_NULL_HANDLE;
+	std::array<uint64_t, 4> time_stamps{};
+	bool                    time_stamps_supported = false;
 
 	struct
 	{
@@ -101,6 +107,10 @@ class ComputeNBody : public ApiVulkanSample
 	void         build_command_buffers() override;
 	void         build_compute_command_buffer();
 	void         prepare_storage_buffers();
+	void         release_storage_buffer_to_graphics();
+	void         recreate_storage_buffers();
+	void         prepare_time_stamp_queries();
+	void         get_time_stamp_results();
 	void         setup_descriptor_pool();
 	void         setup_descriptor_set_layout();
 	void         setup_descriptor_set();
@@ -114,6 +124,7 @@ class ComputeNBody : public ApiVulkanSample
 	bool         prepare(const vkb::ApplicationOptions &options) override;
 	virtual void render(float delta_time) override;
 	virtual bool resize(const uint32_t width, const uint32_t height) override;
+	virtual void on_update_ui_overlay(vkb::Drawer &drawer) override;
 };
 
 std::unique_ptr<vkb::Application> create_compute_nbody();
@@ -444,6 +444,19 @@ void DynamicUniformBuffers::update_dynamic_uniform_buffer(float delta_time, bool
 		return;
 	}
 
+	// Update rotations
+	for (uint32_t i = 0; i < OBJECT_INSTANCES; i++)
+	{
+		rotations[i] += animation_timer * rotation_speeds[i];
+	}
+
+	animation_timer = 0.0f;
+
+	update_model_matrices(rotations);
+}
+
+void DynamicUniformBuffers::update_model_matrices(const glm::vec3 *object_rotations)
+{
 	// Dynamic ubo with per-object model matrices indexed by offsets in the command buffer
 	auto      dim  = static_cast<uint32_t>(pow(OBJECT_INSTANCES, (1.0f / 3.0f)));
 	auto      fdim = static_cast<float>(dim);
@@ -463,23 +476,18 @@ void DynamicUniformBuffers::update_dynamic_uniform_buffer(float delta_time, bool
 				// Aligned offset
 				auto model_mat = (glm::mat4 *) (((uint64_t) ubo_data_dynamic.model + (index * dynamic_alignment)));
 
-				// Update rotations
-				rotations[index] += animation_timer * rotation_speeds[index];
-
 				// Update matrices
 				glm::vec3 pos(-((fdim * offset.x) / 2.0f) + offset.x / 2.0f + fx * offset.x,
 				              -((fdim * offset.y) / 2.0f) + offset.y / 2.0f + fy * offset.y,
 				              -((fdim * offset.z) / 2.0f) + offset.z / 2.0f + fz * offset.z);
 				*model_mat = glm::translate(glm::mat4(1.0f), pos);
-				*model_mat = glm::rotate(*model_mat, rotations[index].x, glm::vec3(1.0f, 1.0f, 0.0f));
-				*model_mat = glm::rotate(*model_mat, rotations[index].y, glm::vec3(0.0f, 1.0f, 0.0f));
-				*model_mat = glm::rotate(*model_mat, rotations[index].z, glm::vec3(0.0f, 0.0f, 1.0f));
+				*model_mat = glm::rotate(*model_mat, object_rotations[index].x, glm::vec3(1.0f, 1.0f, 0.0f));
+				*model_mat = glm::rotate(*model_mat, object_rotations[index].y, glm::vec3(0.0f, 1.0f, 0.0f));
+				*model_mat = glm::rotate(*model_mat, object_rotations[index].z, glm::vec3(0.0f, 0.0f, 1.0f));
 			}
 		}
 	}
 
-	animation_timer = 0.0f;
-
 	uniform_buffers.dynamic->update(ubo_data_dynamic.model, static_cast<size_t>(uniform_buffers.dynamic->get_size()));
 
 	// Flush to make changes visible to the device
@@ -525,7 +533,12 @@ void DynamicUniformBuffers::render(float delta_time)
 		return;
 	}
 	draw();
-	if (!paused)
+	simulation_paused = paused;
+	if (is_fixed_update_enabled())
+	{
+		update_simulated_uniform_buffer();
+	}
+	else if (!paused)
 	{
 		update_dynamic_uniform_buffer(delta_time);
 	}
@@ -535,6 +548,47 @@ void DynamicUniformBuffers::render(float delta_time)
 	}
 }
 
+void DynamicUniformBuffers::update_simulated_uniform_buffer()
+{
+	auto blend = [](const Rotations &previous, const Rotations &current, float alpha) {
+		Rotations blended;
+		for (uint32_t i = 0; i < OBJECT_INSTANCES; i++)
+		{
+			blended[i] = glm::mix(previous[i], current[i], alpha);
+		}
+		return blended;
+	};
+
+	Rotations object_rotations;
+	if (simulated_rotations.sample(blend, object_rotations))
+	{
+		update_model_matrices(object_rotations.data());
+	}
+}
+
+void DynamicUniformBuffers::fixed_update(float tick)
+{
+	if (simulation_paused)
+	{
+		return;
+	}
+
+	// Only the simulation thread touches the rotations while the timestep is fixed
+	for (uint32_t i = 0; i < OBJECT_INSTANCES; i++)
+	{
+		rotations[i] += tick * rotation_speeds[i];
+	}
+
+	Rotations state;
+	std::copy(std::begin(rotations), std::end(rotations), state.begin());
+	simulated_rotations.publish(state, tick);
+}
+
+bool DynamicUniformBuffers::supports_fixed_update() const
+{
+	return true;
+}
+
 std::unique_ptr<vkb::Application> create_dynamic_uniform_buffers()
 {
 	return std::make_unique<DynamicUniformBuffers>();
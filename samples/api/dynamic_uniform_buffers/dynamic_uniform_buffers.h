@@ -28,7 +28,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+
 #include "api_vulkan_sample.h"
+#include "platform/simulation_thread.h"
 
 #define OBJECT_INSTANCES 125
 
@@ -79,6 +83,12 @@ class DynamicUniformBuffers : public ApiVulkanSample
 
 	float animation_timer = 0.0f;
 
+	// With a fixed timestep the rotations are advanced on the simulation thread, and interpolated when rendering
+	using Rotations = std::array<glm::vec3, OBJECT_INSTANCES>;
+
+	vkb::InterpolatedState<Rotations> simulated_rotations;
+	std::atomic<bool>                 simulation_paused{false};
+
 	size_t dynamic_alignment = 0;
 
 	DynamicUniformBuffers();
@@ -92,9 +102,13 @@ class DynamicUniformBuffers : public ApiVulkanSample
 	void         prepare_uniform_buffers();
 	void         update_uniform_buffers();
 	void         update_dynamic_uniform_buffer(float delta_time, bool force = false);
+	void         update_model_matrices(const glm::vec3 *object_rotations);
+	void         update_simulated_uniform_buffer();
 	void         draw();
 	bool         prepare(const vkb::ApplicationOptions &options) override;
 	virtual void render(float delta_time) override;
+	void         fixed_update(float tick) override;
+	bool         supports_fixed_update() const override;
 	virtual bool resize(const uint32_t width, const uint32_t height) override;
 };
 
@@ -39,6 +39,7 @@ HPPComputeNBody::~HPPComputeNBody()
 		compute.destroy(device);
 		graphics.destroy(device);
 		textures.destroy(device);
+		time_stamps.destroy(device);
 	}
 }
 
@@ -51,6 +52,7 @@ bool HPPComputeNBody::prepare(const vkb::ApplicationOptions &options)
 		load_assets();
 		descriptor_pool = create_descriptor_pool();
 		prepare_graphics();
+		prepare_time_stamps();
 		prepare_compute();
 		build_command_buffers();
 
@@ -91,6 +93,11 @@ void HPPComputeNBody::build_command_buffers()
 		vk::CommandBuffer command_buffer = draw_cmd_buffers[i];
 		command_buffer.begin(vk::CommandBufferBeginInfo());
 
+		if (time_stamps.supported)
+		{
+			command_buffer.resetQueryPool(time_stamps.query_pool, 2, 2);
+		}
+
 		// Acquire
 		if (graphics.queue_family_index != compute.queue_family_index)
 		{
@@ -106,6 +113,11 @@ void HPPComputeNBody::build_command_buffers()
 			    vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eVertexInput, {}, nullptr, buffer_barrier, nullptr);
 		}
 
+		if (time_stamps.supported)
+		{
+			command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, time_stamps.query_pool, 2);
+		}
+
 		// Draw the particle system using the update vertex buffer
 		command_buffer.beginRenderPass(render_pass_begin_info, vk::SubpassContents::eInline);
 		command_buffer.setViewport(0, {{0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f}});
@@ -117,6 +129,11 @@ void HPPComputeNBody::build_command_buffers()
 		draw_ui(command_buffer);
 		command_buffer.endRenderPass();
 
+		if (time_stamps.supported)
+		{
+			command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, time_stamps.query_pool, 3);
+		}
+
 		// Release barrier
 		if (graphics.queue_family_index != compute.queue_family_index)
 		{
@@ -136,6 +153,41 @@ void HPPComputeNBody::build_command_buffers()
 	}
 }
 
+void HPPComputeNBody::on_update_ui_overlay(vkb::Drawer &drawer)
+{
+	if (drawer.header("Settings"))
+	{
+		// The forces are summed over all pairs of particles, so the cost grows with the square of the count
+		std::vector<uint32_t> counts = {1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024};
+		if (std::find(counts.begin(), counts.end(), static_cast<uint32_t>(PARTICLES_PER_ATTRACTOR)) == counts.end())
+		{
+			counts.insert(std::upper_bound(counts.begin(), counts.end(), static_cast<uint32_t>(PARTICLES_PER_ATTRACTOR)), PARTICLES_PER_ATTRACTOR);
+		}
+
+		std::vector<std::string> names;
+		for (auto count : counts)
+		{
+			names.push_back(std::to_string(count));
+		}
+
+		int32_t index = static_cast<int32_t>(std::find(counts.begin(), counts.end(), compute.particles_per_attractor) - counts.begin());
+		if (drawer.combo_box("Particles per attractor", &index, names))
+		{
+			compute.particles_per_attractor = counts[index];
+			recreate_compute_storage_buffers();
+		}
+		drawer.text("Particles: %d, work group size: %u", compute.ubo.particle_count, compute.work_group_size);
+	}
+	if (time_stamps.supported && drawer.header("Timing"))
+	{
+		// The timestampPeriod property of the device tells how many nanoseconds a timestamp step is
+		float timestamp_period = get_device().get_gpu().get_properties().limits.timestampPeriod;
+
+		drawer.text("Compute: %.3f ms", static_cast<float>(time_stamps.values[1] - time_stamps.values[0]) * timestamp_period / 1000000.0f);
+		drawer.text("Graphics: %.3f ms", static_cast<float>(time_stamps.values[3] - time_stamps.values[2]) * timestamp_period / 1000000.0f);
+	}
+}
+
 void HPPComputeNBody::render(float delta_time)
 {
 	if (prepared)
@@ -153,6 +205,12 @@ void HPPComputeNBody::build_compute_command_buffer()
 {
 	compute.command_buffer.begin(vk::CommandBufferBeginInfo());
 
+	if (time_stamps.supported)
+	{
+		compute.command_buffer.resetQueryPool(time_stamps.query_pool, 0, 2);
+		compute.command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, time_stamps.query_pool, 0);
+	}
+
 	// Acquire
 	if (graphics.queue_family_index != compute.queue_family_index)
 	{
@@ -172,7 +230,9 @@ void HPPComputeNBody::build_compute_command_buffer()
 	// -------------------------------------------------------------------------------------------------------
 	compute.command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, compute.pipeline_calculate);
 	compute.command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, compute.pipeline_layout, 0, compute.descriptor_set, nullptr);
-	compute.command_buffer.dispatch(compute.ubo.particle_count / compute.work_group_size, 1, 1);
+	// The last work group is partially filled when the particle count isn't a multiple of its size
+	uint32_t group_count = (compute.ubo.particle_count + compute.work_group_size - 1) / compute.work_group_size;
+	compute.command_buffer.dispatch(group_count, 1, 1);
 
 	// Add memory barrier to ensure that the computer shader has finished writing to the buffer
 	vk::BufferMemoryBarrier memory_barrier(vk::AccessFlagBits::eShaderWrite,
@@ -189,7 +249,12 @@ void HPPComputeNBody::build_compute_command_buffer()
 	// Second pass: Integrate particles
 	// -------------------------------------------------------------------------------------------------------
 	compute.command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, compute.pipeline_integrate);
-	compute.command_buffer.dispatch(compute.ubo.particle_count / compute.work_group_size, 1, 1);
+	compute.command_buffer.dispatch(group_count, 1, 1);
+
+	if (time_stamps.supported)
+	{
+		compute.command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, time_stamps.query_pool, 1);
+	}
 
 	// Release
 	if (graphics.queue_family_index != compute.queue_family_index)
@@ -364,6 +429,37 @@ void HPPComputeNBody::draw()
 	vk::PipelineStageFlags wait_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
 	vk::SubmitInfo         compute_submit_info(graphics.semaphore, wait_stage_mask, compute.command_buffer, compute.semaphore);
 	compute.queue.submit(compute_submit_info);
+
+	get_time_stamp_results();
+}
+
+void HPPComputeNBody::get_time_stamp_results()
+{
+	if (!time_stamps.supported)
+	{
+		return;
+	}
+
+	// Without vk::QueryResultFlagBits::eWait, so reading the timings doesn't stall the CPU on the queues
+	// Each query returns its value followed by its availability, and a pair is only kept once both queries are available
+	std::array<uint64_t, 8> results = {};
+	vk::Result              result  = get_device().get_handle().getQueryPoolResults(time_stamps.query_pool,
+	                                                                                 0,
+	                                                                                 static_cast<uint32_t>(time_stamps.values.size()),
+	                                                                                 results.size() * sizeof(uint64_t),
+	                                                                                 results.data(),
+	                                                                                 2 * sizeof(uint64_t),
+	                                                                                 vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+	assert(result == vk::Result::eSuccess || result == vk::Result::eNotReady);
+
+	for (size_t pair = 0; pair < 2; ++pair)
+	{
+		if (results[pair * 4 + 1] != 0 && results[pair * 4 + 3] != 0)
+		{
+			time_stamps.values[pair * 2]     = results[pair * 4];
+			time_stamps.values[pair * 2 + 1] = results[pair * 4 + 2];
+		}
+	}
 }
 
 void HPPComputeNBody::initializeCamera()
@@ -390,10 +486,18 @@ void HPPComputeNBody::prepare_compute()
 	compute.queue_family_index = get_device().get_queue_family_index(vk::QueueFlagBits::eCompute);
 
 	vk::PhysicalDeviceLimits const &limits = get_device().get_gpu().get_properties().limits;
-	// Not all implementations support a work group size of 256, so we need to check with the device limits
-	compute.work_group_size = std::min<uint32_t>(256, limits.maxComputeWorkGroupSize[0]);
-	// Same for shared data size for passing data between shader invocations
-	compute.shared_data_size = std::min<uint32_t>(1024, limits.maxComputeSharedMemorySize / sizeof(glm::vec4));
+	// Each invocation loads one position of the tile shared by its work group, so larger work groups need fewer barriers per particle
+	// The size is bounded by the device limits, including the shared memory holding the tile
+	compute.work_group_size = std::min<uint32_t>({512,
+	                                              limits.maxComputeWorkGroupSize[0],
+	                                              limits.maxComputeWorkGroupInvocations,
+	                                              static_cast<uint32_t>(limits.maxComputeSharedMemorySize / sizeof(glm::vec4))});
+	if (get_shading_language() == vkb::ShadingLanguage::HLSL)
+	{
+		// The HLSL shaders are compiled offline with a fixed thread group size
+		compute.work_group_size = 256;
+	}
+	compute.shared_data_size = compute.work_group_size;
 
 	prepare_compute_storage_buffers();
 
@@ -458,7 +562,8 @@ void HPPComputeNBody::prepare_compute()
 	}
 
 	// Separate command pool as queue family for compute may be different than graphics
-	compute.command_pool = device.createCommandPool({{}, compute.queue_family_index});
+	// The command buffer is recorded again when the particle count changes
+	compute.command_pool = device.createCommandPool({vk::CommandPoolCreateFlagBits::eResetCommandBuffer, compute.queue_family_index});
 
 	// Create a command buffer for compute operations
 	compute.command_buffer = vkb::common::allocate_command_buffer(device, compute.command_pool);
@@ -472,21 +577,7 @@ void HPPComputeNBody::prepare_compute()
 	// Build a single command buffer containing the compute dispatch commands
 	build_compute_command_buffer();
 
-	// If necessary, acquire and immediately release the storage buffer, so that the initial acquire
-	// from the graphics command buffers are matched up properly.
-	if (graphics.queue_family_index != compute.queue_family_index)
-	{
-		// Create a transient command buffer for setting up the initial buffer transfer state
-		vk::CommandBuffer transfer_command = vkb::common::allocate_command_buffer(device, compute.command_pool);
-
-		build_compute_transfer_command_buffer(transfer_command);
-
-		// Submit and wait for compute commands
-		vkb::common::submit_and_wait(device, compute.queue, {transfer_command});
-
-		// free the transfer command buffer
-		device.freeCommandBuffers(compute.command_pool, transfer_command);
-	}
+	release_compute_storage_buffer();
 }
 
 // Setup and fill the compute shader storage buffers containing the particles
@@ -508,7 +599,7 @@ void HPPComputeNBody::prepare_compute_storage_buffers()
 	};
 #endif
 
-	compute.ubo.particle_count = static_cast<uint32_t>(attractors.size()) * PARTICLES_PER_ATTRACTOR;
+	compute.ubo.particle_count = static_cast<uint32_t>(attractors.size()) * compute.particles_per_attractor;
 
 	// Initial particle positions
 	std::vector<Particle> particle_buffer(compute.ubo.particle_count);
@@ -518,9 +609,9 @@ void HPPComputeNBody::prepare_compute_storage_buffers()
 
 	for (uint32_t i = 0; i < static_cast<uint32_t>(attractors.size()); i++)
 	{
-		for (uint32_t j = 0; j < PARTICLES_PER_ATTRACTOR; j++)
+		for (uint32_t j = 0; j < compute.particles_per_attractor; j++)
 		{
-			Particle &particle = particle_buffer[i * PARTICLES_PER_ATTRACTOR + j];
+			Particle &particle = particle_buffer[i * compute.particles_per_attractor + j];
 
 			// First particle in group as heavy center of gravity
 			if (j == 0)
@@ -597,6 +688,68 @@ void HPPComputeNBody::prepare_graphics()
 	graphics.semaphore = device.createSemaphore({});
 }
 
+void HPPComputeNBody::prepare_time_stamps()
+{
+	// Timing is optional, the simulation also runs on queues without timestamp support
+	vk::PhysicalDeviceLimits const                &limits                  = get_device().get_gpu().get_properties().limits;
+	std::vector<vk::QueueFamilyProperties> const &queue_family_properties = get_device().get_gpu().get_queue_family_properties();
+	uint32_t                                       compute_queue_family    = get_device().get_queue_family_index(vk::QueueFlagBits::eCompute);
+
+	time_stamps.supported = (0 < limits.timestampPeriod) && (0 < queue_family_properties[graphics.queue_family_index].timestampValidBits) &&
+	                        (0 < queue_family_properties[compute_queue_family].timestampValidBits);
+	if (!time_stamps.supported)
+	{
+		LOGW("The graphics or compute queue doesn't support timestamp queries, timings are disabled");
+		return;
+	}
+
+	time_stamps.query_pool =
+	    vkb::common::create_query_pool(get_device().get_handle(), vk::QueryType::eTimestamp, static_cast<uint32_t>(time_stamps.values.size()));
+
+	// The results are read before the first submissions complete, so the queries start out reset
+	vk::Device        device        = get_device().get_handle();
+	vk::CommandBuffer reset_command = vkb::common::allocate_command_buffer(device, get_device().get_command_pool().get_handle());
+	reset_command.begin(vk::CommandBufferBeginInfo());
+	reset_command.resetQueryPool(time_stamps.query_pool, 0, static_cast<uint32_t>(time_stamps.values.size()));
+	reset_command.end();
+	vkb::common::submit_and_wait(device, queue, {reset_command});
+	device.freeCommandBuffers(get_device().get_command_pool().get_handle(), reset_command);
+}
+
+// Replaces the particles with a new set, when their count changes
+void HPPComputeNBody::recreate_compute_storage_buffers()
+{
+	get_device().get_handle().waitIdle();
+
+	prepare_compute_storage_buffers();
+	release_compute_storage_buffer();
+	update_compute_descriptor_set();
+
+	build_compute_command_buffer();
+	rebuild_command_buffers();
+}
+
+// If necessary, acquire and immediately release the storage buffer, so that the initial acquire
+// from the graphics command buffers are matched up properly.
+void HPPComputeNBody::release_compute_storage_buffer()
+{
+	if (graphics.queue_family_index != compute.queue_family_index)
+	{
+		vk::Device device = get_device().get_handle();
+
+		// Create a transient command buffer for setting up the initial buffer transfer state
+		vk::CommandBuffer transfer_command = vkb::common::allocate_command_buffer(device, compute.command_pool);
+
+		build_compute_transfer_command_buffer(transfer_command);
+
+		// Submit and wait for compute commands
+		vkb::common::submit_and_wait(device, compute.queue, {transfer_command});
+
+		// free the transfer command buffer
+		device.freeCommandBuffers(compute.command_pool, transfer_command);
+	}
+}
+
 void HPPComputeNBody::update_compute_descriptor_set()
 {
 	vk::DescriptorBufferInfo              storage_buffer_descriptor(compute.storage_buffer->get_handle(), 0, VK_WHOLE_SIZE);
@@ -54,7 +54,8 @@ class HPPComputeNBody : public HPPApiVulkanSample
 		vk::Pipeline                          pipeline_integrate;           // Compute pipeline for euler integration (2nd pass)
 		vk::PipelineLayout                    pipeline_layout;              // Layout of the compute pipeline
 		vk::Queue                             queue;                        // Separate queue for compute commands (queue family may differ from the one used for graphics)
-		uint32_t                              queue_family_index = ~0;
+		uint32_t                              particles_per_attractor = PARTICLES_PER_ATTRACTOR;
+		uint32_t                              queue_family_index      = ~0;
 		vk::Semaphore                         semaphore;        // Execution dependency between compute & graphic submission
 		uint32_t                              shared_data_size = 1024;
 		std::unique_ptr<vkb::core::BufferCpp> storage_buffer;        // (Shader) storage buffer object containing the particles
@@ -114,6 +115,18 @@ class HPPComputeNBody : public HPPApiVulkanSample
 		glm::vec4 vel;        // xyz = velocity, w = gradient texture position
 	};
 
+	struct TimeStamps
+	{
+		std::array<uint64_t, 4> values = {};        // Begin and end of the compute work (0 and 1), then of the graphics work (2 and 3)
+		vk::QueryPool           query_pool;
+		bool                    supported = false;
+
+		void destroy(vk::Device device)
+		{
+			device.destroyQueryPool(query_pool);
+		}
+	};
+
 	struct Textures
 	{
 		HPPTexture gradient;
@@ -136,6 +149,7 @@ class HPPComputeNBody : public HPPApiVulkanSample
 
 	// from HPPApiVulkanSample
 	void build_command_buffers() override;
+	void on_update_ui_overlay(vkb::Drawer &drawer) override;
 	void render(float delta_time) override;
 
 	void                    build_compute_command_buffer();
@@ -147,20 +161,25 @@ class HPPComputeNBody : public HPPApiVulkanSample
 	vk::DescriptorSetLayout create_graphics_descriptor_set_layout();
 	vk::Pipeline            create_graphics_pipeline();
 	void                    draw();
+	void                    get_time_stamp_results();
 	void                    initializeCamera();
 	void                    load_assets();
 	void                    prepare_compute();
 	void                    prepare_compute_storage_buffers();
 	void                    prepare_graphics();
+	void                    prepare_time_stamps();
+	void                    recreate_compute_storage_buffers();
+	void                    release_compute_storage_buffer();
 	void                    update_compute_descriptor_set();
 	void                    update_compute_uniform_buffers(float delta_time);
 	void                    update_graphics_descriptor_set();
 	void                    update_graphics_uniform_buffers();
 
   private:
-	Compute  compute;
-	Graphics graphics;
-	Textures textures;
+	Compute    compute;
+	Graphics   graphics;
+	Textures   textures;
+	TimeStamps time_stamps;
 };
 
 std::unique_ptr<vkb::Application> create_hpp_compute_nbody();
@@ -402,23 +402,11 @@ void Instancing::prepare_instance_data()
 	// On devices with separate memory types for host visible and device local memory this will result in better performance
 	// On devices with unified memory types (DEVICE_LOCAL_BIT and HOST_VISIBLE_BIT supported at once) this isn't necessary and you could skip the staging
 
-	vkb::core::BufferC staging_buffer = vkb::core::BufferC::create_staging_buffer(get_device(), instance_data);
-
 	instance_buffer.buffer = std::make_unique<vkb::core::BufferC>(get_device(), instance_buffer.size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
 
-	// Copy to staging buffer
-	VkCommandBuffer copy_command = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-	VkBufferCopy copy_region = {};
-	copy_region.size         = instance_buffer.size;
-	vkCmdCopyBuffer(
-	    copy_command,
-	    staging_buffer.get_handle(),
-	    instance_buffer.buffer->get_handle(),
-	    1,
-	    &copy_region);
-
-	get_device().flush_command_buffer(copy_command, queue, true);
+	// The copy goes through the staging ring of the upload context, the draws submitted later are ordered after it
+	upload_context->upload_buffer(*instance_buffer.buffer, instance_data.data(), instance_buffer.size);
+	upload_context->flush();
 
 	instance_buffer.descriptor.range  = instance_buffer.size;
 	instance_buffer.descriptor.buffer = instance_buffer.buffer->get_handle();
@@ -40,12 +40,30 @@ TerrainTessellation::~TerrainTessellation()
 			vkDestroyPipeline(get_device().get_handle(), pipelines.wireframe, nullptr);
 		}
 		vkDestroyPipeline(get_device().get_handle(), pipelines.skysphere, nullptr);
+		if (pipelines.terrain_culled != VK_NULL_HANDLE)
+		{
+			vkDestroyPipeline(get_device().get_handle(), pipelines.terrain_culled, nullptr);
+		}
+		if (pipelines.wireframe_culled != VK_NULL_HANDLE)
+		{
+			vkDestroyPipeline(get_device().get_handle(), pipelines.wireframe_culled, nullptr);
+		}
+		if (pipelines.cull != VK_NULL_HANDLE)
+		{
+			vkDestroyPipeline(get_device().get_handle(), pipelines.cull, nullptr);
+		}
 
 		vkDestroyPipelineLayout(get_device().get_handle(), pipeline_layouts.skysphere, nullptr);
 		vkDestroyPipelineLayout(get_device().get_handle(), pipeline_layouts.terrain, nullptr);
+		vkDestroyPipelineLayout(get_device().get_handle(), pipeline_layouts.cull, nullptr);
 
 		vkDestroyDescriptorSetLayout(get_device().get_handle(), descriptor_set_layouts.terrain, nullptr);
 		vkDestroyDescriptorSetLayout(get_device().get_handle(), descriptor_set_layouts.skysphere, nullptr);
+		vkDestroyDescriptorSetLayout(get_device().get_handle(), descriptor_set_layouts.cull, nullptr);
+
+		culling.visible_indices.reset();
+		culling.patch_levels.reset();
+		culling.draw_command.reset();
 
 		uniform_buffers.skysphere_vertex.reset();
 		uniform_buffers.terrain_tessellation.reset();
@@ -214,6 +232,12 @@ void TerrainTessellation::build_command_buffers()
 			vkCmdResetQueryPool(draw_cmd_buffers[i], query_pool, 0, 2);
 		}
 
+		const bool culled = gpu_culling && is_gpu_culling_supported();
+		if (culled)
+		{
+			record_culling(draw_cmd_buffers[i]);
+		}
+
 		vkCmdBeginRenderPass(draw_cmd_buffers[i], &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 
 		VkViewport viewport = vkb::initializers::viewport(static_cast<float>(width), static_cast<float>(height), 0.0f, 1.0f);
@@ -238,11 +262,21 @@ void TerrainTessellation::build_command_buffers()
 			vkCmdBeginQuery(draw_cmd_buffers[i], query_pool, 0, 0);
 		}
 		// Render
-		vkCmdBindPipeline(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, wireframe ? pipelines.wireframe : pipelines.terrain);
 		vkCmdBindDescriptorSets(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layouts.terrain, 0, 1, &descriptor_sets.terrain, 0, NULL);
 		vkCmdBindVertexBuffers(draw_cmd_buffers[i], 0, 1, terrain.vertices->get(), offsets);
-		vkCmdBindIndexBuffer(draw_cmd_buffers[i], terrain.indices->get_handle(), 0, VK_INDEX_TYPE_UINT32);
-		vkCmdDrawIndexed(draw_cmd_buffers[i], terrain.index_count, 1, 0, 0, 0);
+		if (culled)
+		{
+			// Only the patches appended by the culling pass are drawn, their count is written by the GPU
+			vkCmdBindPipeline(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, wireframe ? pipelines.wireframe_culled : pipelines.terrain_culled);
+			vkCmdBindIndexBuffer(draw_cmd_buffers[i], culling.visible_indices->get_handle(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdDrawIndexedIndirect(draw_cmd_buffers[i], culling.draw_command->get_handle(), 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+		}
+		else
+		{
+			vkCmdBindPipeline(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, wireframe ? pipelines.wireframe : pipelines.terrain);
+			vkCmdBindIndexBuffer(draw_cmd_buffers[i], terrain.indices->get_handle(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdDrawIndexed(draw_cmd_buffers[i], terrain.index_count, 1, 0, 0, 0);
+		}
 		if (get_device().get_gpu().get_features().pipelineStatisticsQuery)
 		{
 			// End pipeline statistics query
@@ -326,6 +360,7 @@ void TerrainTessellation::generate_terrain()
 		}
 	}
 	terrain.index_count = index_count;
+	culling.grid_size   = w;
 
 	uint32_t vertex_buffer_size = vertex_count * sizeof(Vertex);
 	uint32_t index_buffer_size  = index_count * sizeof(uint32_t);
@@ -337,12 +372,12 @@ void TerrainTessellation::generate_terrain()
 
 	terrain.vertices = std::make_unique<vkb::core::BufferC>(get_device(),
 	                                                        vertex_buffer_size,
-	                                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 	                                                        VMA_MEMORY_USAGE_GPU_ONLY);
 
 	terrain.indices = std::make_unique<vkb::core::BufferC>(get_device(),
 	                                                       index_buffer_size,
-	                                                       VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                       VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 	                                                       VMA_MEMORY_USAGE_GPU_ONLY);
 
 	// Copy from staging buffers
@@ -369,18 +404,98 @@ void TerrainTessellation::generate_terrain()
 	get_device().flush_command_buffer(copy_command, queue, true);
 }
 
+// The culling shaders are only available in GLSL
+bool TerrainTessellation::is_gpu_culling_supported()
+{
+	return get_shading_language() != vkb::ShadingLanguage::HLSL;
+}
+
+// Create the buffers written by the culling pass
+// In the worst case all patches are visible, so they are sized for the whole terrain
+void TerrainTessellation::prepare_culling()
+{
+	const uint32_t patch_count = terrain.index_count / 4;
+
+	culling.visible_indices = std::make_unique<vkb::core::BufferC>(get_device(),
+	                                                               terrain.index_count * sizeof(uint32_t),
+	                                                               VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+	                                                               VMA_MEMORY_USAGE_GPU_ONLY);
+
+	// Outer and inner levels of each visible patch, as two vec4s
+	culling.patch_levels = std::make_unique<vkb::core::BufferC>(get_device(),
+	                                                            patch_count * 2 * sizeof(glm::vec4),
+	                                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+	                                                            VMA_MEMORY_USAGE_GPU_ONLY);
+
+	culling.draw_command = std::make_unique<vkb::core::BufferC>(get_device(),
+	                                                            sizeof(VkDrawIndexedIndirectCommand),
+	                                                            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                            VMA_MEMORY_USAGE_GPU_ONLY);
+}
+
+// Record the compute pass appending the visible patches to the indirect draw
+void TerrainTessellation::record_culling(VkCommandBuffer command_buffer)
+{
+	// The draw of the previous frame must have consumed the outputs before they are overwritten
+	vkCmdPipelineBarrier(
+	    command_buffer,
+	    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT,
+	    VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+	    0,
+	    0, nullptr,
+	    0, nullptr,
+	    0, nullptr);
+
+	// Start from an empty draw, the shader increments the index count for each visible patch
+	VkDrawIndexedIndirectCommand draw_command{};
+	draw_command.instanceCount = 1;
+	vkCmdUpdateBuffer(command_buffer, culling.draw_command->get_handle(), 0, sizeof(draw_command), &draw_command);
+
+	VkMemoryBarrier memory_barrier = vkb::initializers::memory_barrier();
+	memory_barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memory_barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(
+	    command_buffer,
+	    VK_PIPELINE_STAGE_TRANSFER_BIT,
+	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+	    0,
+	    1, &memory_barrier,
+	    0, nullptr,
+	    0, nullptr);
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.cull);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layouts.cull, 0, 1, &descriptor_sets.cull, 0, nullptr);
+	vkCmdPushConstants(command_buffer, pipeline_layouts.cull, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &culling.grid_size);
+
+	// One invocation per patch, in tiles of 8x8 patches
+	const uint32_t group_count = (culling.grid_size + 7) / 8;
+	vkCmdDispatch(command_buffer, group_count, group_count, 1);
+
+	memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(
+	    command_buffer,
+	    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+	    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT,
+	    0,
+	    1, &memory_barrier,
+	    0, nullptr,
+	    0, nullptr);
+}
+
 void TerrainTessellation::setup_descriptor_pool()
 {
 	std::vector<VkDescriptorPoolSize> pool_sizes =
 	    {
-	        vkb::initializers::descriptor_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3),
-	        vkb::initializers::descriptor_pool_size(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3)};
+	        vkb::initializers::descriptor_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4),
+	        vkb::initializers::descriptor_pool_size(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4),
+	        vkb::initializers::descriptor_pool_size(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6)};
 
 	VkDescriptorPoolCreateInfo descriptor_pool_create_info =
 	    vkb::initializers::descriptor_pool_create_info(
 	        static_cast<uint32_t>(pool_sizes.size()),
 	        pool_sizes.data(),
-	        2);
+	        3);
 
 	VK_CHECK(vkCreateDescriptorPool(get_device().get_handle(), &descriptor_pool_create_info, nullptr, &descriptor_pool));
 }
@@ -404,11 +519,16 @@ void TerrainTessellation::setup_descriptor_set_layouts()
 	            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
 	            VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT | VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
 	            1),
-	        // Binding 3 : Terrain texture array layers
+	        // Binding 2 : Terrain texture array layers
 	        vkb::initializers::descriptor_set_layout_binding(
 	            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
 	            VK_SHADER_STAGE_FRAGMENT_BIT,
 	            2),
+	        // Binding 3 : Tessellation levels of the patches kept by the culling pass
+	        vkb::initializers::descriptor_set_layout_binding(
+	            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+	            VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+	            3),
 	    };
 
 	descriptor_layout = vkb::initializers::descriptor_set_layout_create_info(set_layout_bindings.data(), static_cast<uint32_t>(set_layout_bindings.size()));
@@ -435,6 +555,35 @@ void TerrainTessellation::setup_descriptor_set_layouts()
 	VK_CHECK(vkCreateDescriptorSetLayout(get_device().get_handle(), &descriptor_layout, nullptr, &descriptor_set_layouts.skysphere));
 	pipeline_layout_create_info = vkb::initializers::pipeline_layout_create_info(&descriptor_set_layouts.skysphere, 1);
 	VK_CHECK(vkCreatePipelineLayout(get_device().get_handle(), &pipeline_layout_create_info, nullptr, &pipeline_layouts.skysphere));
+
+	// Patch culling
+	set_layout_bindings =
+	    {
+	        // Binding 0 : Shared tessellation shader ubo
+	        vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 0),
+	        // Binding 1 : Height map
+	        vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 1),
+	        // Binding 2 : Terrain vertices
+	        vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 2),
+	        // Binding 3 : Terrain patch indices
+	        vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 3),
+	        // Binding 4 : Indices of the visible patches
+	        vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 4),
+	        // Binding 5 : Tessellation levels of the visible patches
+	        vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 5),
+	        // Binding 6 : Indirect draw command
+	        vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 6),
+	    };
+
+	descriptor_layout = vkb::initializers::descriptor_set_layout_create_info(set_layout_bindings.data(), static_cast<uint32_t>(set_layout_bindings.size()));
+	VK_CHECK(vkCreateDescriptorSetLayout(get_device().get_handle(), &descriptor_layout, nullptr, &descriptor_set_layouts.cull));
+	pipeline_layout_create_info = vkb::initializers::pipeline_layout_create_info(&descriptor_set_layouts.cull, 1);
+
+	// Push constant for the number of patches along each side of the terrain
+	VkPushConstantRange push_constant_range          = vkb::initializers::push_constant_range(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(uint32_t), 0);
+	pipeline_layout_create_info.pushConstantRangeCount = 1;
+	pipeline_layout_create_info.pPushConstantRanges    = &push_constant_range;
+	VK_CHECK(vkCreatePipelineLayout(get_device().get_handle(), &pipeline_layout_create_info, nullptr, &pipeline_layouts.cull));
 }
 
 void TerrainTessellation::setup_descriptor_sets()
@@ -449,6 +598,7 @@ void TerrainTessellation::setup_descriptor_sets()
 	VkDescriptorBufferInfo terrain_buffer_descriptor   = create_descriptor(*uniform_buffers.terrain_tessellation);
 	VkDescriptorImageInfo  heightmap_image_descriptor  = create_descriptor(textures.heightmap);
 	VkDescriptorImageInfo  terrainmap_image_descriptor = create_descriptor(textures.terrain_array);
+	VkDescriptorBufferInfo patch_levels_descriptor     = create_descriptor(*culling.patch_levels);
 	write_descriptor_sets =
 	    {
 	        // Binding 0 : Shared tessellation shader ubo
@@ -469,6 +619,12 @@ void TerrainTessellation::setup_descriptor_sets()
 	            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
 	            2,
 	            &terrainmap_image_descriptor),
+	        // Binding 3 : Tessellation levels of the visible patches
+	        vkb::initializers::write_descriptor_set(
+	            descriptor_sets.terrain,
+	            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+	            3,
+	            &patch_levels_descriptor),
 	    };
 	vkUpdateDescriptorSets(get_device().get_handle(), static_cast<uint32_t>(write_descriptor_sets.size()), write_descriptor_sets.data(), 0, NULL);
 
@@ -494,6 +650,26 @@ void TerrainTessellation::setup_descriptor_sets()
 	            &skysphere_image_descriptor),
 	    };
 	vkUpdateDescriptorSets(get_device().get_handle(), static_cast<uint32_t>(write_descriptor_sets.size()), write_descriptor_sets.data(), 0, NULL);
+
+	// Patch culling
+	alloc_info = vkb::initializers::descriptor_set_allocate_info(descriptor_pool, &descriptor_set_layouts.cull, 1);
+	VK_CHECK(vkAllocateDescriptorSets(get_device().get_handle(), &alloc_info, &descriptor_sets.cull));
+
+	VkDescriptorBufferInfo vertices_descriptor        = create_descriptor(*terrain.vertices);
+	VkDescriptorBufferInfo indices_descriptor         = create_descriptor(*terrain.indices);
+	VkDescriptorBufferInfo visible_indices_descriptor = create_descriptor(*culling.visible_indices);
+	VkDescriptorBufferInfo draw_command_descriptor    = create_descriptor(*culling.draw_command);
+	write_descriptor_sets =
+	    {
+	        vkb::initializers::write_descriptor_set(descriptor_sets.cull, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &terrain_buffer_descriptor),
+	        vkb::initializers::write_descriptor_set(descriptor_sets.cull, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &heightmap_image_descriptor),
+	        vkb::initializers::write_descriptor_set(descriptor_sets.cull, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, &vertices_descriptor),
+	        vkb::initializers::write_descriptor_set(descriptor_sets.cull, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, &indices_descriptor),
+	        vkb::initializers::write_descriptor_set(descriptor_sets.cull, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4, &visible_indices_descriptor),
+	        vkb::initializers::write_descriptor_set(descriptor_sets.cull, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5, &patch_levels_descriptor),
+	        vkb::initializers::write_descriptor_set(descriptor_sets.cull, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6, &draw_command_descriptor),
+	    };
+	vkUpdateDescriptorSets(get_device().get_handle(), static_cast<uint32_t>(write_descriptor_sets.size()), write_descriptor_sets.data(), 0, NULL);
 }
 
 void TerrainTessellation::prepare_pipelines()
@@ -603,6 +779,25 @@ void TerrainTessellation::prepare_pipelines()
 		VK_CHECK(vkCreateGraphicsPipelines(get_device().get_handle(), pipeline_cache, 1, &pipeline_create_info, nullptr, &pipelines.wireframe));
 	};
 
+	if (is_gpu_culling_supported())
+	{
+		// Terrain pipelines drawing the patches kept by the culling pass, with their precomputed tessellation levels
+		shader_stages[2]                = load_shader("terrain_tessellation", "terrain_culled.tesc", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
+		rasterization_state.polygonMode = VK_POLYGON_MODE_FILL;
+		VK_CHECK(vkCreateGraphicsPipelines(get_device().get_handle(), pipeline_cache, 1, &pipeline_create_info, nullptr, &pipelines.terrain_culled));
+
+		if (get_device().get_gpu().get_features().fillModeNonSolid)
+		{
+			rasterization_state.polygonMode = VK_POLYGON_MODE_LINE;
+			VK_CHECK(vkCreateGraphicsPipelines(get_device().get_handle(), pipeline_cache, 1, &pipeline_create_info, nullptr, &pipelines.wireframe_culled));
+		}
+
+		// Patch culling pipeline
+		VkComputePipelineCreateInfo compute_pipeline_create_info = vkb::initializers::compute_pipeline_create_info(pipeline_layouts.cull, 0);
+		compute_pipeline_create_info.stage                       = load_shader("terrain_tessellation", "terrain_cull.comp", VK_SHADER_STAGE_COMPUTE_BIT);
+		VK_CHECK(vkCreateComputePipelines(get_device().get_handle(), pipeline_cache, 1, &compute_pipeline_create_info, nullptr, &pipelines.cull));
+	}
+
 	// Skysphere pipeline
 
 	// Stride from glTF model vertex layout
@@ -707,6 +902,7 @@ bool TerrainTessellation::prepare(const vkb::ApplicationOptions &options)
 
 	load_assets();
 	generate_terrain();
+	prepare_culling();
 	if (get_device().get_gpu().get_features().pipelineStatisticsQuery)
 	{
 		setup_query_result_buffer();
@@ -747,6 +943,13 @@ void TerrainTessellation::on_update_ui_overlay(vkb::Drawer &drawer)
 		{
 			update_uniform_buffers();
 		}
+		if (is_gpu_culling_supported())
+		{
+			if (drawer.checkbox("GPU culling", &gpu_culling))
+			{
+				rebuild_command_buffers();
+			}
+		}
 		if (get_device().get_gpu().get_features().fillModeNonSolid)
 		{
 			if (drawer.checkbox("Wireframe", &wireframe))
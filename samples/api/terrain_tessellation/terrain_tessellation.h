@@ -30,6 +30,8 @@ class TerrainTessellation : public ApiVulkanSample
   public:
 	bool wireframe    = false;
 	bool tessellation = true;
+	// Cull the patches in a compute pre-pass and draw the visible ones indirectly
+	bool gpu_culling = true;
 
 	struct
 	{
@@ -54,6 +56,15 @@ class TerrainTessellation : public ApiVulkanSample
 		uint32_t                            index_count;
 	} terrain;
 
+	// Outputs of the culling pre-pass, the indices and tessellation levels of the visible patches
+	struct
+	{
+		std::unique_ptr<vkb::core::BufferC> visible_indices;
+		std::unique_ptr<vkb::core::BufferC> patch_levels;
+		std::unique_ptr<vkb::core::BufferC> draw_command;
+		uint32_t                            grid_size;
+	} culling;
+
 	struct
 	{
 		std::unique_ptr<vkb::core::BufferC> terrain_tessellation;
@@ -85,24 +96,30 @@ class TerrainTessellation : public ApiVulkanSample
 		VkPipeline terrain;
 		VkPipeline wireframe = VK_NULL_HANDLE;
 		VkPipeline skysphere;
+		VkPipeline terrain_culled   = VK_NULL_HANDLE;
+		VkPipeline wireframe_culled = VK_NULL_HANDLE;
+		VkPipeline cull             = VK_NULL_HANDLE;
 	} pipelines;
 
 	struct
 	{
 		VkDescriptorSetLayout terrain;
 		VkDescriptorSetLayout skysphere;
+		VkDescriptorSetLayout cull = VK_NULL_HANDLE;
 	} descriptor_set_layouts;
 
 	struct
 	{
 		VkPipelineLayout terrain;
 		VkPipelineLayout skysphere;
+		VkPipelineLayout cull = VK_NULL_HANDLE;
 	} pipeline_layouts;
 
 	struct
 	{
 		VkDescriptorSet terrain;
 		VkDescriptorSet skysphere;
+		VkDescriptorSet cull = VK_NULL_HANDLE;
 	} descriptor_sets;
 
 	// Pipeline statistics
@@ -120,6 +137,9 @@ class TerrainTessellation : public ApiVulkanSample
 	void         load_assets();
 	void         build_command_buffers() override;
 	void         generate_terrain();
+	bool         is_gpu_culling_supported();
+	void         prepare_culling();
+	void         record_culling(VkCommandBuffer command_buffer);
 	void         setup_descriptor_pool();
 	void         setup_descriptor_set_layouts();
 	void         setup_descriptor_sets();
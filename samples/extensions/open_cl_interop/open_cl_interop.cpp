@@ -22,102 +22,21 @@
 
 #include <sstream>
 
-#ifdef VK_USE_PLATFORM_WIN32_KHR
-#	include <aclapi.h>
-#	include <dxgi1_2.h>
-#endif
-
-#ifdef _WIN32
-// On Windows, we need to enable some security settings to allow api interop
-// The spec states: For handles of the following types: VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT The implementation must ensure the access rights allow read and write access to the memory.
-// This class sets up the structures required for tis
-class WinSecurityAttributes
-{
-  private:
-	SECURITY_ATTRIBUTES  security_attributes;
-	PSECURITY_DESCRIPTOR security_descriptor;
-
-  public:
-	WinSecurityAttributes();
-	~WinSecurityAttributes();
-	SECURITY_ATTRIBUTES *operator&();
-};
-
-WinSecurityAttributes::WinSecurityAttributes()
-{
-	security_descriptor = (PSECURITY_DESCRIPTOR) calloc(1, SECURITY_DESCRIPTOR_MIN_LENGTH + 2 * sizeof(void **));
-
-	PSID *ppSID = (PSID *) ((PBYTE) security_descriptor + SECURITY_DESCRIPTOR_MIN_LENGTH);
-	PACL *ppACL = (PACL *) ((PBYTE) ppSID + sizeof(PSID *));
-
-	InitializeSecurityDescriptor(security_descriptor, SECURITY_DESCRIPTOR_REVISION);
-
-	SID_IDENTIFIER_AUTHORITY sid_identifier_authority = SECURITY_WORLD_SID_AUTHORITY;
-	AllocateAndInitializeSid(&sid_identifier_authority, 1, SECURITY_WORLD_RID, 0, 0, 0, 0, 0, 0, 0, ppSID);
-
-	EXPLICIT_ACCESS explicit_access{};
-	ZeroMemory(&explicit_access, sizeof(EXPLICIT_ACCESS));
-	explicit_access.grfAccessPermissions = STANDARD_RIGHTS_ALL | SPECIFIC_RIGHTS_ALL;
-	explicit_access.grfAccessMode        = SET_ACCESS;
-	explicit_access.grfInheritance       = INHERIT_ONLY;
-	explicit_access.Trustee.TrusteeForm  = TRUSTEE_IS_SID;
-	explicit_access.Trustee.TrusteeType  = TRUSTEE_IS_WELL_KNOWN_GROUP;
-	explicit_access.Trustee.ptstrName    = (LPTSTR) *ppSID;
-	SetEntriesInAcl(1, &explicit_access, nullptr, ppACL);
-
-	SetSecurityDescriptorDacl(security_descriptor, TRUE, *ppACL, FALSE);
-
-	security_attributes.nLength              = sizeof(SECURITY_ATTRIBUTES);
-	security_attributes.lpSecurityDescriptor = security_descriptor;
-	security_attributes.bInheritHandle       = TRUE;
-}
-
-SECURITY_ATTRIBUTES *WinSecurityAttributes::operator&()
-{
-	return &security_attributes;
-}
-
-WinSecurityAttributes::~WinSecurityAttributes()
+OpenCLInterop::OpenCLInterop()
 {
-	PSID *ppSID = (PSID *) ((PBYTE) security_descriptor + SECURITY_DESCRIPTOR_MIN_LENGTH);
-	PACL *ppACL = (PACL *) ((PBYTE) ppSID + sizeof(PSID *));
+	zoom  = -3.5f;
+	title = "Interoperability with OpenCL";
 
-	if (*ppSID)
+	// To use external memory and semaphores, we need to enable several extensions, both on the device as well as the instance
+	// Some of the extensions are platform dependent, the framework lists those of the current platform
+	for (auto extension : vkb::core::get_external_memory_device_extensions())
 	{
-		FreeSid(*ppSID);
+		add_device_extension(extension);
 	}
-
-	if (*ppACL)
+	for (auto extension : vkb::core::get_external_memory_instance_extensions())
 	{
-		LocalFree(*ppACL);
+		add_instance_extension(extension);
 	}
-
-	free(security_descriptor);
-}
-#endif
-
-OpenCLInterop::OpenCLInterop()
-{
-	zoom  = -3.5f;
-	title = "Interoperability with OpenCL";
-
-	// To use external memory, semaphores and fences, we need to enable several extensions, both on the device as well as the instance
-	add_device_extension(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME);
-	add_device_extension(VK_KHR_EXTERNAL_SEMAPHORE_EXTENSION_NAME);
-	add_device_extension(VK_KHR_EXTERNAL_FENCE_EXTENSION_NAME);
-	// Some of the extensions are platform dependent
-#ifdef _WIN32
-	add_device_extension(VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME);
-	add_device_extension(VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME);
-	add_device_extension(VK_KHR_EXTERNAL_FENCE_WIN32_EXTENSION_NAME);
-#else
-	add_device_extension(VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME);
-	add_device_extension(VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME);
-	add_device_extension(VK_KHR_EXTERNAL_FENCE_FD_EXTENSION_NAME);
-#endif
-	add_instance_extension(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
-	add_instance_extension(VK_KHR_EXTERNAL_SEMAPHORE_CAPABILITIES_EXTENSION_NAME);
-	add_instance_extension(VK_KHR_EXTERNAL_FENCE_CAPABILITIES_EXTENSION_NAME);
 }
 
 OpenCLInterop::~OpenCLInterop()
@@ -128,12 +47,11 @@ OpenCLInterop::~OpenCLInterop()
 		vkDestroyPipelineLayout(get_device().get_handle(), pipeline_layout, nullptr);
 		vkDestroyDescriptorSetLayout(get_device().get_handle(), descriptor_set_layout, nullptr);
 		vkDestroyFence(get_device().get_handle(), rendering_finished_fence, nullptr);
-		vkDestroySemaphore(get_device().get_handle(), cl_update_vk_semaphore, nullptr);
-		vkDestroySemaphore(get_device().get_handle(), vk_update_cl_semaphore, nullptr);
+		cl_update_vk_semaphore.reset();
+		vk_update_cl_semaphore.reset();
 		vkDestroySampler(get_device().get_handle(), shared_image.sampler, nullptr);
 		vkDestroyImageView(get_device().get_handle(), shared_image.view, nullptr);
-		vkDestroyImage(get_device().get_handle(), shared_image.image, nullptr);
-		vkFreeMemory(get_device().get_handle(), shared_image.memory, nullptr);
+		shared_image.image.reset();
 	}
 
 	if (opencl_objects.initialized)
@@ -179,13 +97,13 @@ void OpenCLInterop::render(float delta_time)
 		first_submit      = false;
 		wait_stages       = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
 		wait_semaphores   = {semaphores.acquired_image_ready};
-		signal_semaphores = {semaphores.render_complete, vk_update_cl_semaphore};
+		signal_semaphores = {semaphores.render_complete, vk_update_cl_semaphore->get_handle()};
 	}
 	else
 	{
 		wait_stages       = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
-		wait_semaphores   = {semaphores.acquired_image_ready, cl_update_vk_semaphore};
-		signal_semaphores = {semaphores.render_complete, vk_update_cl_semaphore};
+		wait_semaphores   = {semaphores.acquired_image_ready, cl_update_vk_semaphore->get_handle()};
+		signal_semaphores = {semaphores.render_complete, vk_update_cl_semaphore->get_handle()};
 	}
 
 	submit_info.pWaitDstStageMask    = wait_stages.data();
@@ -464,118 +382,27 @@ void OpenCLInterop::update_uniform_buffers()
 	uniform_buffer_vs->convert_and_update(ubo_vs);
 }
 
-// These functions wraps the platform specific functions to get platform handles for Vulkan memory objects (e.g. the memory backing the image) and semaphores
-
-#ifdef _WIN32
-HANDLE OpenCLInterop::get_vulkan_memory_handle(VkDeviceMemory memory)
-{
-	HANDLE                        handle;
-	VkMemoryGetWin32HandleInfoKHR win32_handle_info{};
-	win32_handle_info.sType      = VK_STRUCTURE_TYPE_MEMORY_GET_WIN32_HANDLE_INFO_KHR;
-	win32_handle_info.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT_KHR;
-	win32_handle_info.memory     = memory;
-	vkGetMemoryWin32HandleKHR(get_device().get_handle(), &win32_handle_info, &handle);
-	return handle;
-}
-
-HANDLE OpenCLInterop::get_vulkan_semaphore_handle(VkSemaphore &sempahore)
-{
-	HANDLE                           handle;
-	VkSemaphoreGetWin32HandleInfoKHR win32_handle_info{};
-	win32_handle_info.sType      = VK_STRUCTURE_TYPE_SEMAPHORE_GET_WIN32_HANDLE_INFO_KHR;
-	win32_handle_info.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_WIN32_BIT;
-	win32_handle_info.semaphore  = sempahore;
-	vkGetSemaphoreWin32HandleKHR(get_device().get_handle(), &win32_handle_info, &handle);
-	return handle;
-}
-#else
-int OpenCLInterop::get_vulkan_memory_handle(VkDeviceMemory memory)
-{
-	int fd;
-	VkMemoryGetFdInfoKHR fd_info{};
-	fd_info.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
-	fd_info.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT_KHR;
-	fd_info.memory = memory;
-	vkGetMemoryFdKHR(get_device().get_handle(), &fd_info, &fd);
-	return fd;
-}
-
-int OpenCLInterop::get_vulkan_semaphore_handle(VkSemaphore &sempahore)
-{
-	int fd;
-	VkSemaphoreGetFdInfoKHR fd_info{};
-	fd_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR;
-	fd_info.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT_KHR;
-	fd_info.semaphore = sempahore;
-	vkGetSemaphoreFdKHR(get_device().get_handle(), &fd_info, &fd);
-	return fd;
-}
-#endif
-
 void OpenCLInterop::prepare_shared_image()
 {
 	// This texture will be shared between both APIs: OpenCL fills it and Vulkan uses it for rendering
 	shared_image.width  = 512;
 	shared_image.height = 512;
 
-	// We need to select the external handle type based on our target platform
+	// The framework gives exported images a memory object of their own, allocated with the opaque handle type of the platform
 	// Note: Windows 8 and older requires the _KMT suffixed handle type, which we don't support in this sample
-	VkExternalMemoryHandleTypeFlagBits external_handle_type{};
-#ifdef _WIN32
-	external_handle_type = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT_KHR;
-#else
-	external_handle_type = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT_KHR;
-#endif
+	shared_image.image = vkb::core::ImageBuilder(shared_image.width, shared_image.height)
+	                         .with_format(VK_FORMAT_R8G8B8A8_UNORM)
+	                         .with_usage(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+	                         .with_external_memory(vkb::core::get_external_memory_handle_type())
+	                         .with_debug_name("shared_image")
+	                         .build_unique(get_device());
 
 	auto device_handle = get_device().get_handle();
 
-	// Setting up Vulkan resources (image, memory, image view and sampler)
-
-	VkImageCreateInfo image_create_info = vkb::initializers::image_create_info();
-	image_create_info.imageType         = VK_IMAGE_TYPE_2D;
-	image_create_info.format            = VK_FORMAT_R8G8B8A8_UNORM;
-	image_create_info.mipLevels         = 1;
-	image_create_info.arrayLayers       = 1;
-	image_create_info.samples           = VK_SAMPLE_COUNT_1_BIT;
-	image_create_info.tiling            = VK_IMAGE_TILING_OPTIMAL;
-	image_create_info.extent            = {shared_image.width, shared_image.height, 1};
-	image_create_info.usage             = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-
-	VkExternalMemoryImageCreateInfo external_memory_image_info{};
-	external_memory_image_info.sType       = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO;
-	external_memory_image_info.handleTypes = external_handle_type;
-
-	image_create_info.pNext = &external_memory_image_info;
-	VK_CHECK(vkCreateImage(get_device().get_handle(), &image_create_info, nullptr, &shared_image.image));
-
-	VkMemoryRequirements memory_requirements{};
-	vkGetImageMemoryRequirements(get_device().get_handle(), shared_image.image, &memory_requirements);
-
-	VkExportMemoryAllocateInfoKHR export_memory_allocate_info{};
-	export_memory_allocate_info.sType       = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO_KHR;
-	export_memory_allocate_info.handleTypes = external_handle_type;
-
-#ifdef _WIN32
-	WinSecurityAttributes            win_security_attributes;
-	VkExportMemoryWin32HandleInfoKHR export_memory_win32_handle_info{};
-	export_memory_win32_handle_info.sType       = VK_STRUCTURE_TYPE_EXPORT_MEMORY_WIN32_HANDLE_INFO_KHR;
-	export_memory_win32_handle_info.pAttributes = &win_security_attributes;
-	export_memory_win32_handle_info.dwAccess    = DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE;
-	export_memory_allocate_info.pNext           = &export_memory_win32_handle_info;
-#endif
-
-	VkMemoryAllocateInfo memory_allocate_info = vkb::initializers::memory_allocate_info();
-	memory_allocate_info.pNext                = &export_memory_allocate_info;
-	memory_allocate_info.allocationSize       = memory_requirements.size;
-	memory_allocate_info.memoryTypeIndex      = get_device().get_memory_type(memory_requirements.memoryTypeBits, 0);
-
-	VK_CHECK(vkAllocateMemory(device_handle, &memory_allocate_info, nullptr, &shared_image.memory));
-	VK_CHECK(vkBindImageMemory(device_handle, shared_image.image, shared_image.memory, 0));
-
-	// Calculate valid filter and mipmap modes
+	// Setting up the image view and sampler, calculating valid filter and mipmap modes first
 	VkFilter            filter      = VK_FILTER_LINEAR;
 	VkSamplerMipmapMode mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-	vkb::make_filters_valid(get_device().get_gpu().get_handle(), image_create_info.format, &filter, &mipmap_mode);
+	vkb::make_filters_valid(get_device().get_gpu().get_handle(), shared_image.image->get_format(), &filter, &mipmap_mode);
 
 	VkSamplerCreateInfo sampler_create_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
 	sampler_create_info.magFilter   = filter;
@@ -587,7 +414,7 @@ void OpenCLInterop::prepare_shared_image()
 
 	VkImageViewCreateInfo view_create_info{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
 	view_create_info.viewType         = VK_IMAGE_VIEW_TYPE_2D;
-	view_create_info.image            = shared_image.image;
+	view_create_info.image            = shared_image.image->get_handle();
 	view_create_info.format           = VK_FORMAT_R8G8B8A8_UNORM;
 	view_create_info.subresourceRange = VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
 	vkCreateImageView(device_handle, &view_create_info, nullptr, &shared_image.view);
@@ -601,7 +428,7 @@ void OpenCLInterop::prepare_shared_image()
 	subresource_range.layerCount              = 1;
 
 	VkImageMemoryBarrier image_memory_barrier = vkb::initializers::image_memory_barrier();
-	image_memory_barrier.image                = shared_image.image;
+	image_memory_barrier.image                = shared_image.image->get_handle();
 	image_memory_barrier.subresourceRange     = subresource_range;
 	image_memory_barrier.srcAccessMask        = 0;
 	image_memory_barrier.dstAccessMask        = VK_ACCESS_SHADER_READ_BIT;
@@ -623,15 +450,13 @@ void OpenCLInterop::prepare_shared_image()
 
 	std::vector<cl_mem_properties> mem_properties;
 
+	vkb::core::ExternalHandle handle = vkb::core::export_memory(get_device(), shared_image.image->get_memory());
 #ifdef _WIN32
-	HANDLE handle = get_vulkan_memory_handle(shared_image.memory);
 	mem_properties.push_back((cl_mem_properties) CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_WIN32_KHR);
-	mem_properties.push_back((cl_mem_properties) handle);
 #else
-	int fd = get_vulkan_memory_handle(shared_image.memory);
 	mem_properties.push_back((cl_mem_properties) CL_EXTERNAL_MEMORY_HANDLE_OPAQUE_FD_KHR);
-	mem_properties.push_back((cl_mem_properties) fd);
 #endif
+	mem_properties.push_back((cl_mem_properties) handle);
 	mem_properties.push_back((cl_mem_properties) CL_MEM_DEVICE_HANDLE_LIST_KHR);
 	mem_properties.push_back((cl_mem_properties) opencl_objects.device_id);
 	mem_properties.push_back((cl_mem_properties) CL_MEM_DEVICE_HANDLE_LIST_END_KHR);
@@ -663,28 +488,9 @@ void OpenCLInterop::prepare_shared_image()
 void OpenCLInterop::prepare_sync_objects()
 {
 	// Just as the image, we also create the semaphores in Vulkan and export them
-	VkExportSemaphoreCreateInfoKHR export_semaphore_create_info{};
-	export_semaphore_create_info.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO_KHR;
-
-#ifdef _WIN32
-	WinSecurityAttributes               win_security_attributes;
-	VkExportSemaphoreWin32HandleInfoKHR export_semaphore_handle_info{};
-	export_semaphore_handle_info.sType       = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_WIN32_HANDLE_INFO_KHR;
-	export_semaphore_handle_info.pAttributes = &win_security_attributes;
-	export_semaphore_handle_info.dwAccess    = DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE;
-
-	export_semaphore_create_info.pNext       = &export_semaphore_handle_info;
-	export_semaphore_create_info.handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_WIN32_BIT;
-#else
-	export_semaphore_create_info.handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
-#endif
-
-	VkSemaphoreCreateInfo semaphore_create_info{};
-	semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-	semaphore_create_info.pNext = &export_semaphore_create_info;
-
-	VK_CHECK(vkCreateSemaphore(get_device().get_handle(), &semaphore_create_info, nullptr, &cl_update_vk_semaphore));
-	VK_CHECK(vkCreateSemaphore(get_device().get_handle(), &semaphore_create_info, nullptr, &vk_update_cl_semaphore));
+	// OpenCL waits and signals them once per frame each, so binary semaphores are enough
+	cl_update_vk_semaphore = std::make_unique<vkb::core::ExternalSemaphore>(get_device(), VK_SEMAPHORE_TYPE_BINARY);
+	vk_update_cl_semaphore = std::make_unique<vkb::core::ExternalSemaphore>(get_device(), VK_SEMAPHORE_TYPE_BINARY);
 
 	// We also need a fence for the Vulkan side of things, which is not shared with OpenCL
 	VkFenceCreateInfo fence_create_info = vkb::initializers::fence_create_info(VK_FENCE_CREATE_SIGNALED_BIT);
@@ -703,13 +509,10 @@ void OpenCLInterop::prepare_sync_objects()
 
 #ifdef _WIN32
 	semaphore_properties.push_back((cl_semaphore_properties_khr) CL_SEMAPHORE_HANDLE_OPAQUE_WIN32_KHR);
-	HANDLE handle = get_vulkan_semaphore_handle(cl_update_vk_semaphore);
-	semaphore_properties.push_back((cl_semaphore_properties_khr) handle);
 #else
 	semaphore_properties.push_back((cl_semaphore_properties_khr) CL_SEMAPHORE_HANDLE_OPAQUE_FD_KHR);
-	int fd = get_vulkan_semaphore_handle(cl_update_vk_semaphore);
-	semaphore_properties.push_back((cl_semaphore_properties_khr) fd);
 #endif
+	semaphore_properties.push_back((cl_semaphore_properties_khr) cl_update_vk_semaphore->export_handle());
 	semaphore_properties.push_back(0);
 
 	cl_int cl_result;
@@ -722,13 +525,7 @@ void OpenCLInterop::prepare_sync_objects()
 	semaphore_properties.pop_back();
 
 	// VK to CL semaphore
-#ifdef _WIN32
-	handle = get_vulkan_semaphore_handle(vk_update_cl_semaphore);
-	semaphore_properties.push_back((cl_semaphore_properties_khr) handle);
-#else
-	fd = get_vulkan_semaphore_handle(vk_update_cl_semaphore);
-	semaphore_properties.push_back((cl_semaphore_properties_khr) fd);
-#endif
+	semaphore_properties.push_back((cl_semaphore_properties_khr) vk_update_cl_semaphore->export_handle());
 	semaphore_properties.push_back(0);
 
 	opencl_objects.vk_update_cl_semaphore = clCreateSemaphoreWithPropertiesKHR(opencl_objects.context, semaphore_properties.data(), &cl_result);
@@ -18,6 +18,8 @@
 #pragma once
 
 #include "api_vulkan_sample.h"
+#include "core/image.h"
+#include "core/interop.h"
 #include "rendering/render_pipeline.h"
 #include "scene_graph/components/camera.h"
 
@@ -60,14 +62,6 @@ class OpenCLInterop : public ApiVulkanSample
 	void prepare_uniform_buffers();
 	void update_uniform_buffers();
 
-#ifdef _WIN32
-	HANDLE get_vulkan_memory_handle(VkDeviceMemory memory);
-	HANDLE get_vulkan_semaphore_handle(VkSemaphore &sempahore);
-#else
-	int get_vulkan_memory_handle(VkDeviceMemory memory);
-	int get_vulkan_semaphore_handle(VkSemaphore &sempahore);
-#endif
-
 	struct VertexStructure
 	{
 		float pos[3];
@@ -77,14 +71,11 @@ class OpenCLInterop : public ApiVulkanSample
 
 	struct SharedImage
 	{
-		uint32_t       width{0};
-		uint32_t       height{0};
-		VkImage        image{VK_NULL_HANDLE};
-		VkDeviceMemory memory{VK_NULL_HANDLE};
-		VkDeviceSize   size{0};
-		VkDeviceSize   allocationSize{0};
-		VkSampler      sampler{VK_NULL_HANDLE};
-		VkImageView    view{VK_NULL_HANDLE};
+		uint32_t                          width{0};
+		uint32_t                          height{0};
+		std::unique_ptr<vkb::core::Image> image;
+		VkSampler                         sampler{VK_NULL_HANDLE};
+		VkImageView                       view{VK_NULL_HANDLE};
 
 	} shared_image;
 
@@ -120,9 +111,8 @@ class OpenCLInterop : public ApiVulkanSample
 	uint32_t                            index_count{0};
 	std::unique_ptr<vkb::core::BufferC> uniform_buffer_vs;
 
-	// @todo: rename
-	VkSemaphore cl_update_vk_semaphore{VK_NULL_HANDLE};
-	VkSemaphore vk_update_cl_semaphore{VK_NULL_HANDLE};
+	std::unique_ptr<vkb::core::ExternalSemaphore> cl_update_vk_semaphore;
+	std::unique_ptr<vkb::core::ExternalSemaphore> vk_update_cl_semaphore;
 
 	VkFence rendering_finished_fence{VK_NULL_HANDLE};
 
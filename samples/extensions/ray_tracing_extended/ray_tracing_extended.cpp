@@ -569,10 +569,11 @@ VkTransformMatrixKHR RaytracingExtended::calculate_rotation(glm::vec3 pt, float
 /*
     Create the top level acceleration structure containing geometry instances of the bottom level acceleration structure(s)
 */
-void RaytracingExtended::create_top_level_acceleration_structure(bool print_time)
+bool RaytracingExtended::create_top_level_acceleration_structure(VkCommandBuffer command_buffer, uint32_t frame_index, bool print_time)
 {
 	/*
 	Often, good performance can be obtained when the TLAS uses PREFER_FAST_TRACE with full rebuilds.
+	The framework structure refits the TLAS while only the particles move, and rebuilds it once they moved too far.
 	*/
 	QuickTimer timer{"TLAS Build", print_time};
 	assert(!!raytracing_scene);
@@ -651,6 +652,10 @@ void RaytracingExtended::create_top_level_acceleration_structure(bool print_time
 	}
 	data_to_model_buffer->update(model_instance_data.data(), data_to_model_size, 0);
 
+#ifdef USE_FRAMEWORK_ACCELERATION_STRUCTURE
+	// The instances are streamed to the buffer of the frame, and the build is recorded into its command buffer
+	return top_level_acceleration_structure->update(command_buffer, frame_index, instances);
+#else
 	const size_t instancesDataSize = sizeof(VkAccelerationStructureInstanceKHR) * instances.size();
 	if (!instances_buffer || instances_buffer->get_size() != instancesDataSize)
 	{
@@ -661,18 +666,6 @@ void RaytracingExtended::create_top_level_acceleration_structure(bool print_time
 	}
 	instances_buffer->update(instances.data(), instancesDataSize);
 
-#ifdef USE_FRAMEWORK_ACCELERATION_STRUCTURE
-	// Top Level AS with single instance
-	if (instance_uid == std::numeric_limits<uint64_t>::max())        // test if first time adding
-	{
-		instance_uid = top_level_acceleration_structure->add_instance_geometry(instances_buffer, static_cast<uint32_t>(instances.size()));
-	}
-	else
-	{
-		top_level_acceleration_structure->update_instance_geometry(instance_uid, instances_buffer, static_cast<uint32_t>(instances.size()));
-	}
-	top_level_acceleration_structure->build(queue);
-#else
 	VkDeviceOrHostAddressConstKHR instance_data_device_address{};
 	instance_data_device_address.deviceAddress = get_buffer_device_address(instances_buffer->get_handle());
 
@@ -762,13 +755,13 @@ void RaytracingExtended::create_top_level_acceleration_structure(bool print_time
 
 	// Build the acceleration structure on the device via a one-time command buffer submission
 	// Some implementations may support acceleration structure building on the host (VkPhysicalDeviceAccelerationStructureFeaturesKHR->accelerationStructureHostCommands), but we prefer device builds
-	VkCommandBuffer command_buffer = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+	VkCommandBuffer build_command_buffer = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
 	vkCmdBuildAccelerationStructuresKHR(
-	    command_buffer,
+	    build_command_buffer,
 	    1,
 	    &acceleration_build_geometry_info,
 	    acceleration_build_structure_range_infos.data());
-	get_device().flush_command_buffer(command_buffer, queue);
+	get_device().flush_command_buffer(build_command_buffer, queue);
 
 	scratch_buffer.reset();
 
@@ -778,6 +771,7 @@ void RaytracingExtended::create_top_level_acceleration_structure(bool print_time
 	acceleration_device_address_info.accelerationStructure = top_level_acceleration_structure.handle;
 	top_level_acceleration_structure.device_address =
 	    vkGetAccelerationStructureDeviceAddressKHR(get_device().get_handle(), &acceleration_device_address_info);
+	return !is_update;
 #endif
 }
 
@@ -839,9 +833,12 @@ void RaytracingExtended::create_scene()
 	create_dynamic_object_buffers(0.f);
 	create_bottom_level_acceleration_structure(false);
 #ifdef USE_FRAMEWORK_ACCELERATION_STRUCTURE
-	top_level_acceleration_structure = std::make_unique<vkb::core::AccelerationStructure>(get_device(), VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR);
+	top_level_acceleration_structure = std::make_unique<vkb::core::DynamicTopLevelAccelerationStructure>(get_device(), static_cast<uint32_t>(draw_cmd_buffers.size()));
 #endif
-	create_top_level_acceleration_structure();
+
+	VkCommandBuffer command_buffer = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+	create_top_level_acceleration_structure(command_buffer, 0);
+	get_device().flush_command_buffer(command_buffer, queue);
 }
 
 /*
@@ -907,25 +904,7 @@ void RaytracingExtended::create_descriptor_sets()
 	VkDescriptorSetAllocateInfo descriptor_set_allocate_info = vkb::initializers::descriptor_set_allocate_info(descriptor_pool, &descriptor_set_layout, 1);
 	VK_CHECK(vkAllocateDescriptorSets(get_device().get_handle(), &descriptor_set_allocate_info, &descriptor_set));
 
-	// Set up the descriptor for binding our top level acceleration structure to the ray tracing shaders
-	VkWriteDescriptorSetAccelerationStructureKHR descriptor_acceleration_structure_info{};
-	descriptor_acceleration_structure_info.sType                      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
-	descriptor_acceleration_structure_info.accelerationStructureCount = 1;
-#ifdef USE_FRAMEWORK_ACCELERATION_STRUCTURE
-	auto rhs                                                       = top_level_acceleration_structure->get_handle();
-	descriptor_acceleration_structure_info.pAccelerationStructures = &rhs;
-#else
-	descriptor_acceleration_structure_info.pAccelerationStructures = &top_level_acceleration_structure.handle;
-#endif
-
-	VkWriteDescriptorSet acceleration_structure_write{};
-	acceleration_structure_write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	acceleration_structure_write.dstSet          = descriptor_set;
-	acceleration_structure_write.dstBinding      = 0;
-	acceleration_structure_write.descriptorCount = 1;
-	acceleration_structure_write.descriptorType  = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-	// The acceleration structure descriptor has to be chained via pNext
-	acceleration_structure_write.pNext = &descriptor_acceleration_structure_info;
+	write_acceleration_structure_descriptor();
 
 	VkDescriptorImageInfo image_descriptor{};
 	image_descriptor.imageView   = storage_image.view;
@@ -948,7 +927,6 @@ void RaytracingExtended::create_descriptor_sets()
 	VkWriteDescriptorSet dynamic_index_buffer_write  = vkb::initializers::write_descriptor_set(descriptor_set, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 9, &dynamic_index_descriptor);
 
 	std::vector<VkWriteDescriptorSet> write_descriptor_sets = {
-	    acceleration_structure_write,
 	    result_image_write,
 	    uniform_buffer_write,
 	    vertex_buffer_write,
@@ -960,6 +938,31 @@ void RaytracingExtended::create_descriptor_sets()
 	vkUpdateDescriptorSets(get_device().get_handle(), static_cast<uint32_t>(write_descriptor_sets.size()), write_descriptor_sets.data(), 0, VK_NULL_HANDLE);
 }
 
+void RaytracingExtended::write_acceleration_structure_descriptor()
+{
+	// Set up the descriptor for binding our top level acceleration structure to the ray tracing shaders
+	VkWriteDescriptorSetAccelerationStructureKHR descriptor_acceleration_structure_info{};
+	descriptor_acceleration_structure_info.sType                      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+	descriptor_acceleration_structure_info.accelerationStructureCount = 1;
+#ifdef USE_FRAMEWORK_ACCELERATION_STRUCTURE
+	auto rhs                                                       = top_level_acceleration_structure->get_handle();
+	descriptor_acceleration_structure_info.pAccelerationStructures = &rhs;
+#else
+	descriptor_acceleration_structure_info.pAccelerationStructures = &top_level_acceleration_structure.handle;
+#endif
+
+	VkWriteDescriptorSet acceleration_structure_write{};
+	acceleration_structure_write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	acceleration_structure_write.dstSet          = descriptor_set;
+	acceleration_structure_write.dstBinding      = 0;
+	acceleration_structure_write.descriptorCount = 1;
+	acceleration_structure_write.descriptorType  = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+	// The acceleration structure descriptor has to be chained via pNext
+	acceleration_structure_write.pNext = &descriptor_acceleration_structure_info;
+
+	vkUpdateDescriptorSets(get_device().get_handle(), 1, &acceleration_structure_write, 0, VK_NULL_HANDLE);
+}
+
 void RaytracingExtended::create_dynamic_object_buffers(float time)
 {
 	for (uint32_t i = 0; i < grid_size; ++i)
@@ -1319,7 +1322,9 @@ void RaytracingExtended::build_command_buffers()
 		};
 		barriers.emplace_back(getBufferBarrier(*dynamic_vertex_buffer));
 		barriers.emplace_back(getBufferBarrier(*dynamic_index_buffer));
+#ifndef USE_FRAMEWORK_ACCELERATION_STRUCTURE
 		barriers.emplace_back(getBufferBarrier(*instances_buffer));
+#endif
 		barriers.emplace_back(getBufferBarrier(*ubo));
 
 		vkCmdPipelineBarrier(raytracing_command_buffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_HOST_BIT, 0,
@@ -1396,7 +1401,7 @@ bool RaytracingExtended::prepare(const vkb::ApplicationOptions &options)
 	return true;
 }
 
-void RaytracingExtended::draw()
+void RaytracingExtended::draw(bool print_time)
 {
 	get_device().get_fence_pool().wait();
 	get_device().get_fence_pool().reset();
@@ -1404,9 +1409,27 @@ void RaytracingExtended::draw()
 	ApiVulkanSample::prepare_frame();
 	size_t i = current_buffer;
 
+	// The top level acceleration structure is updated by the submission tracing the frame, the previous one of this index completed
+	acceleration_structure_command_buffers.resize(draw_cmd_buffers.size(), VK_NULL_HANDLE);
+	auto &acceleration_structure_command_buffer = acceleration_structure_command_buffers[i];
+	if (acceleration_structure_command_buffer != VK_NULL_HANDLE)
+	{
+		vkFreeCommandBuffers(get_device().get_handle(), get_device().get_command_pool().get_handle(), 1, &acceleration_structure_command_buffer);
+	}
+	acceleration_structure_command_buffer = get_device().create_command_buffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+	if (create_top_level_acceleration_structure(acceleration_structure_command_buffer, static_cast<uint32_t>(i), print_time))
+	{
+		// The prebuilt ray tracing command buffers bound the descriptor set, so they are recorded again
+		write_acceleration_structure_descriptor();
+		build_command_buffers();
+	}
+	VK_CHECK(vkEndCommandBuffer(acceleration_structure_command_buffer));
+
+	std::array<VkCommandBuffer, 2> command_buffers{acceleration_structure_command_buffer, raytracing_command_buffers[i]};
+
 	VkSubmitInfo submit       = vkb::initializers::submit_info();
-	submit.commandBufferCount = 1;
-	submit.pCommandBuffers    = &raytracing_command_buffers[i];
+	submit.commandBufferCount = static_cast<uint32_t>(command_buffers.size());
+	submit.pCommandBuffers    = command_buffers.data();
 
 	VK_CHECK(vkQueueSubmit(queue, 1, &submit, get_device().request_fence()));
 	get_device().get_fence_pool().wait();
@@ -1482,8 +1505,7 @@ void RaytracingExtended::render(float delta_time)
 	flame_generator.update_particles(delta_time);
 	create_dynamic_object_buffers(static_cast<float>(time.count()) / 1000.f / 1000.f);
 	create_bottom_level_acceleration_structure(true, print_time);
-	create_top_level_acceleration_structure(print_time);
-	draw();
+	draw(print_time);
 	if (camera.updated)
 	{
 		update_uniform_buffers();
@@ -26,6 +26,7 @@
 #include "api_vulkan_sample.h"
 #include "glsl_compiler.h"
 #include <core/acceleration_structure.h>
+#include <core/dynamic_top_level_acceleration_structure.h>
 
 class RaytracingExtended : public ApiVulkanSample
 {
@@ -179,7 +180,9 @@ class RaytracingExtended : public ApiVulkanSample
 	std::unique_ptr<vkb::core::BufferC> index_buffer          = nullptr;
 	std::unique_ptr<vkb::core::BufferC> dynamic_vertex_buffer = nullptr;
 	std::unique_ptr<vkb::core::BufferC> dynamic_index_buffer  = nullptr;
-	std::unique_ptr<vkb::core::BufferC> instances_buffer      = nullptr;
+#ifndef USE_FRAMEWORK_ACCELERATION_STRUCTURE
+	std::unique_ptr<vkb::core::BufferC> instances_buffer = nullptr;
+#endif
 
 	struct SceneLoadInfo
 	{
@@ -207,11 +210,10 @@ class RaytracingExtended : public ApiVulkanSample
 	Texture                          flame_texture;
 
 #ifdef USE_FRAMEWORK_ACCELERATION_STRUCTURE
-	std::unique_ptr<vkb::core::AccelerationStructure> top_level_acceleration_structure = nullptr;
+	std::unique_ptr<vkb::core::DynamicTopLevelAccelerationStructure> top_level_acceleration_structure = nullptr;
 #else
 	AccelerationStructureExtended top_level_acceleration_structure;
 #endif
-	uint64_t                                          instance_uid = std::numeric_limits<uint64_t>::max();
 	uint32_t                                          index_count;
 	std::vector<VkRayTracingShaderGroupCreateInfoKHR> shader_groups{};
 
@@ -249,6 +251,7 @@ class RaytracingExtended : public ApiVulkanSample
 	std::unique_ptr<vkb::core::BufferC> data_to_model_buffer;
 
 	std::vector<VkCommandBuffer> raytracing_command_buffers;
+	std::vector<VkCommandBuffer> acceleration_structure_command_buffers;        // update the TLAS before tracing, one per frame
 	VkPipeline                   pipeline;
 	VkPipelineLayout             pipeline_layout;
 	VkDescriptorSet              descriptor_set;
@@ -269,7 +272,7 @@ class RaytracingExtended : public ApiVulkanSample
 	void                 create_dynamic_object_buffers(float time);
 	void                 create_bottom_level_acceleration_structure(bool is_update, bool print_time = true);
 	VkTransformMatrixKHR calculate_rotation(glm::vec3 pt, float scale = 1.f, bool freeze_y = false);
-	void                 create_top_level_acceleration_structure(bool print_time = true);
+	bool                 create_top_level_acceleration_structure(VkCommandBuffer command_buffer, uint32_t frame_index, bool print_time = true);
 #ifndef USE_FRAMEWORK_ACCELERATION_STRUCTURE
 	void delete_acceleration_structure(AccelerationStructureExtended &acceleration_structure);
 #endif
@@ -277,11 +280,12 @@ class RaytracingExtended : public ApiVulkanSample
 	void create_scene();
 	void create_shader_binding_tables();
 	void create_descriptor_sets();
+	void write_acceleration_structure_descriptor();
 	void create_ray_tracing_pipeline();
 	void create_uniform_buffer();
 	void build_command_buffers() override;
 	void update_uniform_buffers();
-	void draw();
+	void draw(bool print_time);
 	bool prepare(const vkb::ApplicationOptions &options) override;
 	void render(float delta_time) override;
 };
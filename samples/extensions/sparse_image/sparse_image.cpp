@@ -27,8 +27,22 @@ SparseImage::~SparseImage()
 {
 	if (has_device())
 	{
+		vkDeviceWaitIdle(get_device().get_handle());
+		release_completed_work();
+		for (auto &page : virtual_texture.page_table)
+		{
+			page.page_memory_info.memory_sector.reset();
+		}
+		retired_memory_sectors.clear();
+		for (auto fence : free_fences)
+		{
+			vkDestroyFence(get_device().get_handle(), fence, nullptr);
+		}
+		vmaDestroyPool(vkb::allocated::get_memory_allocator(), virtual_texture.memory_allocations.pool);
+
 		vkDestroySemaphore(get_device().get_handle(), submit_semaphore, nullptr);
 		vkDestroySemaphore(get_device().get_handle(), bound_semaphore, nullptr);
+		vkDestroySemaphore(get_device().get_handle(), transfer_semaphore, nullptr);
 		vkDestroyPipeline(get_device().get_handle(), sample_pipeline, nullptr);
 		vkDestroyPipelineLayout(get_device().get_handle(), sample_pipeline_layout, nullptr);
 		vkDestroyDescriptorSetLayout(get_device().get_handle(), descriptor_set_layout, nullptr);
@@ -183,25 +197,37 @@ void SparseImage::setup_camera()
  */
 void SparseImage::bind_sparse_image()
 {
+	// Only the pages whose binding changed since the last call are passed to vkQueueBindSparse()
+	std::vector<VkSparseImageMemoryBind> changed_binds;
 	for (size_t page_index = 0U; page_index < virtual_texture.page_table.size(); page_index++)
 	{
 		auto &page = virtual_texture.page_table[page_index];
-		if (!page.gen_mip_required && page.render_required_set.empty())
+
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize   offset = 0U;
+		if (page.gen_mip_required || !page.render_required_set.empty())
 		{
-			virtual_texture.sparse_image_memory_bind[page_index].memory = VK_NULL_HANDLE;
-			continue;
+			if (!page.page_memory_info.memory_sector)
+			{
+				virtual_texture.memory_allocations.get_allocation(page.page_memory_info, page_index);
+			}
+			memory = page.page_memory_info.memory_sector->memory;
+			offset = page.page_memory_info.offset;
 		}
 
-		if (page.valid)
+		if (memory == page.bound_memory && offset == page.bound_offset)
 		{
 			continue;
 		}
+		page.bound_memory = memory;
+		page.bound_offset = offset;
 
-		virtual_texture.memory_allocations.get_allocation(page.page_memory_info, page_index);
-
-		virtual_texture.sparse_image_memory_bind[page_index].memory       = page.page_memory_info.memory_sector->memory;
-		virtual_texture.sparse_image_memory_bind[page_index].memoryOffset = page.page_memory_info.offset;
+		auto &memory_bind        = virtual_texture.sparse_image_memory_bind[page_index];
+		memory_bind.memory       = memory;
+		memory_bind.memoryOffset = offset;
+		changed_binds.push_back(memory_bind);
 	}
+	last_bind_count = changed_binds.size();
 
 	VkBindSparseInfo bind_sparse_info = vkb::initializers::bind_sparse_info();
 	bind_sparse_info.bufferBindCount  = 0U;
@@ -209,10 +235,11 @@ void SparseImage::bind_sparse_image()
 
 	VkSparseImageMemoryBindInfo sparse_image_memory_bind_info{};
 	sparse_image_memory_bind_info.image     = virtual_texture.texture_image;
-	sparse_image_memory_bind_info.bindCount = static_cast<uint32_t>(virtual_texture.sparse_image_memory_bind.size());
-	sparse_image_memory_bind_info.pBinds    = virtual_texture.sparse_image_memory_bind.data();
+	sparse_image_memory_bind_info.bindCount = static_cast<uint32_t>(changed_binds.size());
+	sparse_image_memory_bind_info.pBinds    = changed_binds.data();
 
-	bind_sparse_info.imageBindCount = 1U;
+	// The bind is still submitted when nothing changed, to keep the semaphores between the frames in order
+	bind_sparse_info.imageBindCount = changed_binds.empty() ? 0U : 1U;
 	bind_sparse_info.pImageBinds    = &sparse_image_memory_bind_info;
 
 	bind_sparse_info.signalSemaphoreCount = 1U;
@@ -220,15 +247,86 @@ void SparseImage::bind_sparse_image()
 	bind_sparse_info.waitSemaphoreCount   = 1U;
 	bind_sparse_info.pWaitSemaphores      = &submit_semaphore;
 
-	VkFence           fence;
-	VkFenceCreateInfo fence_info{};
-	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fence_info.flags = VK_FLAGS_NONE;
+	// The CPU doesn't wait for the bind, the fence only tells when the sectors it unbound can be freed
+	InFlightWork work{};
+	work.fence          = acquire_fence();
+	work.memory_sectors = std::move(retired_memory_sectors);
+	retired_memory_sectors.clear();
+
+	VK_CHECK(vkQueueBindSparse(sparse_queue, 1U, &bind_sparse_info, work.fence));
+	in_flight_work.push_back(std::move(work));
+
+	render_wait_semaphore = bound_semaphore;
+}
+
+/**
+ * 	@brief Submit the transfer commands after the last bind, without waiting for them to complete.
+ */
+void SparseImage::submit_transfer(VkCommandBuffer command_buffer, std::unique_ptr<vkb::core::BufferC> staging_buffer)
+{
+	VK_CHECK(vkEndCommandBuffer(command_buffer));
+
+	VkPipelineStageFlags wait_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	VkSubmitInfo transfer_submit_info         = vkb::initializers::submit_info();
+	transfer_submit_info.commandBufferCount   = 1U;
+	transfer_submit_info.pCommandBuffers      = &command_buffer;
+	transfer_submit_info.waitSemaphoreCount   = 1U;
+	transfer_submit_info.pWaitSemaphores      = &bound_semaphore;
+	transfer_submit_info.pWaitDstStageMask    = &wait_stage_mask;
+	transfer_submit_info.signalSemaphoreCount = 1U;
+	transfer_submit_info.pSignalSemaphores    = &transfer_semaphore;
+
+	InFlightWork work{};
+	work.fence          = acquire_fence();
+	work.command_buffer = command_buffer;
+	work.staging_buffer = std::move(staging_buffer);
+
+	VK_CHECK(vkQueueSubmit(queue, 1U, &transfer_submit_info, work.fence));
+	in_flight_work.push_back(std::move(work));
+
+	render_wait_semaphore = transfer_semaphore;
+}
 
+/**
+ * 	@brief Keep the sector of an unbound page alive until the next bind, which stops the GPU from accessing it, completes.
+ */
+void SparseImage::retire_memory_sector(std::shared_ptr<MemSector> &memory_sector)
+{
+	retired_memory_sectors.push_back(std::move(memory_sector));
+}
+
+VkFence SparseImage::acquire_fence()
+{
+	if (!free_fences.empty())
+	{
+		VkFence fence = free_fences.back();
+		free_fences.pop_back();
+		return fence;
+	}
+
+	VkFence           fence;
+	VkFenceCreateInfo fence_info = vkb::initializers::fence_create_info();
 	VK_CHECK(vkCreateFence(get_device().get_handle(), &fence_info, nullptr, &fence));
-	vkQueueBindSparse(sparse_queue, 1U, &bind_sparse_info, fence);
-	VK_CHECK(vkWaitForFences(get_device().get_handle(), 1, &fence, VK_TRUE, DEFAULT_FENCE_TIMEOUT));
-	vkDestroyFence(get_device().get_handle(), fence, nullptr);
+	return fence;
+}
+
+/**
+ * 	@brief Release the resources of the submitted work the GPU is done with, in submission order.
+ */
+void SparseImage::release_completed_work()
+{
+	while (!in_flight_work.empty() && vkGetFenceStatus(get_device().get_handle(), in_flight_work.front().fence) == VK_SUCCESS)
+	{
+		auto &work = in_flight_work.front();
+		VK_CHECK(vkResetFences(get_device().get_handle(), 1U, &work.fence));
+		free_fences.push_back(work.fence);
+		if (work.command_buffer != VK_NULL_HANDLE)
+		{
+			vkFreeCommandBuffers(get_device().get_handle(), get_device().get_command_pool().get_handle(), 1U, &work.command_buffer);
+		}
+		in_flight_work.pop_front();
+	}
 }
 
 /**
@@ -674,7 +772,7 @@ void SparseImage::update_and_generate()
 		}
 	}
 
-	get_device().flush_command_buffer(command_buffer, queue, true);
+	submit_transfer(command_buffer, std::move(multi_page_buffer));
 
 	for (auto &page : virtual_texture.page_table)
 	{
@@ -695,7 +793,7 @@ void SparseImage::free_unused_memory()
 			page.valid  = false;
 			auto result = page.page_memory_info.memory_sector->available_offsets.insert(page.page_memory_info.offset);
 			page.page_memory_info.memory_sector->virt_page_indices.erase(page_index);
-			page.page_memory_info.memory_sector.reset();
+			retire_memory_sector(page.page_memory_info.memory_sector);
 		}
 	}
 
@@ -776,15 +874,12 @@ void SparseImage::free_unused_memory()
 		vkCmdCopyImageToBuffer(command_buffer, virtual_texture.texture_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, reallocation_buffer->get_handle(), static_cast<uint32_t>(copy_infos.size()), copy_infos.data());
 		get_device().flush_command_buffer(command_buffer, queue, true);
 
-		std::vector<std::shared_ptr<MemSector>> temp_sectors;
 		for (auto &page_index : pages_to_reallocate)
 		{
 			auto &page = virtual_texture.page_table[page_index];
 
-			temp_sectors.push_back(page.page_memory_info.memory_sector);
-
 			page.page_memory_info.memory_sector->virt_page_indices.erase(page_index);
-			page.page_memory_info.memory_sector.reset();
+			retire_memory_sector(page.page_memory_info.memory_sector);
 			page.valid = false;
 		}
 
@@ -796,13 +891,12 @@ void SparseImage::free_unused_memory()
 		vkb::image_layout_transition(command_buffer, virtual_texture.texture_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresource_range);
 		vkCmdCopyBufferToImage(command_buffer, reallocation_buffer->get_handle(), virtual_texture.texture_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copy_infos.size()), copy_infos.data());
 		vkb::image_layout_transition(command_buffer, virtual_texture.texture_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresource_range);
-		get_device().flush_command_buffer(command_buffer, queue, true);
+		submit_transfer(command_buffer, std::move(reallocation_buffer));
 
 		for (auto &page_index : pages_to_reallocate)
 		{
 			virtual_texture.page_table[page_index].valid = true;
 		}
-		temp_sectors.clear();
 	}
 	else
 	{
@@ -904,8 +998,9 @@ void SparseImage::draw()
 	submit_info.commandBufferCount = 1U;
 	submit_info.pCommandBuffers    = &draw_cmd_buffers[current_buffer];
 
-	std::array<VkPipelineStageFlags, 2U> wait_stage_masks  = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-	std::array<VkSemaphore, 2U>          wait_semaphores   = {bound_semaphore, semaphores.acquired_image_ready};
+	// Only the texture sampling has to wait for the binds and copies of the frame
+	std::array<VkPipelineStageFlags, 2U> wait_stage_masks  = {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+	std::array<VkSemaphore, 2U>          wait_semaphores   = {render_wait_semaphore, semaphores.acquired_image_ready};
 	std::array<VkSemaphore, 2U>          signal_semaphores = {submit_semaphore, semaphores.render_complete};
 
 	submit_info.waitSemaphoreCount = wait_semaphores.size();
@@ -935,6 +1030,7 @@ void SparseImage::render(float delta_time)
 		color_highlight_changed = false;
 	}
 
+	release_completed_work();
 	process_stage(next_stage);
 
 	draw();
@@ -1507,11 +1603,18 @@ void SparseImage::create_sparse_texture_image()
 	reset_mip_table();
 
 	// Memory allocation required data
-	virtual_texture.memory_allocations.device               = get_device().get_handle();
 	virtual_texture.memory_allocations.page_size            = virtual_texture.page_size;
+	virtual_texture.memory_allocations.page_alignment       = memory_requirements.alignment;
 	virtual_texture.memory_allocations.memory_type_index    = get_device().get_memory_type(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 	virtual_texture.memory_allocations.pages_per_allocation = PAGES_PER_ALLOC;
 
+	// Memory sectors are sub-allocated from large blocks, instead of a vkAllocateMemory() call for each of them
+	VmaPoolCreateInfo pool_create_info{};
+	pool_create_info.memoryTypeIndex = virtual_texture.memory_allocations.memory_type_index;
+	pool_create_info.blockSize       = virtual_texture.page_size * PAGES_PER_ALLOC * SECTORS_PER_BLOCK;
+	pool_create_info.minBlockCount   = 1U;
+	VK_CHECK(vmaCreatePool(vkb::allocated::get_memory_allocator(), &pool_create_info, &virtual_texture.memory_allocations.pool));
+
 	// Setting the constant data for memory page binding via vkQueueBindSparse()
 	for (size_t page_index = 0U; page_index < virtual_texture.page_table.size(); page_index++)
 	{
@@ -1567,6 +1670,7 @@ void SparseImage::create_sparse_texture_image()
 	VkSemaphoreCreateInfo semaphore_create_info = vkb::initializers::semaphore_create_info();
 	VK_CHECK(vkCreateSemaphore(get_device().get_handle(), &semaphore_create_info, nullptr, &submit_semaphore));
 	VK_CHECK(vkCreateSemaphore(get_device().get_handle(), &semaphore_create_info, nullptr, &bound_semaphore));
+	VK_CHECK(vkCreateSemaphore(get_device().get_handle(), &semaphore_create_info, nullptr, &transfer_semaphore));
 }
 
 /**
@@ -1617,5 +1721,6 @@ void SparseImage::on_update_ui_overlay(vkb::Drawer &drawer)
 		drawer.text("Memory usage in pages:");
 		drawer.text("* Virtual: %zu ", virtual_texture.page_table.size());
 		drawer.text("* Allocated: %zu ", virtual_texture.memory_allocations.get_size() * PAGES_PER_ALLOC);
+		drawer.text("Pages bound last cycle: %zu ", last_bind_count);
 	}
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "api_vulkan_sample.h"
+#include "core/allocated.h"
 
 class SparseImage : public ApiVulkanSample
 {
@@ -122,13 +123,17 @@ class SparseImage : public ApiVulkanSample
 		bool     fixed            = false;        // not freed from the memory at any cases
 		PageInfo page_memory_info;                // memory-related info
 
+		VkDeviceMemory bound_memory = VK_NULL_HANDLE;        // memory the page was bound to by the last vkQueueBindSparse()
+		VkDeviceSize   bound_offset = 0U;
+
 		std::set<std::tuple<uint8_t, size_t, size_t>> render_required_set;        // set holding information on what BLOCKS require this particular memory page to be valid for rendering
 	};
 
 	struct MemAllocInfo
 	{
-		VkDevice device               = VK_NULL_HANDLE;
+		VmaPool  pool                 = VK_NULL_HANDLE;
 		uint64_t page_size            = 0U;
+		uint64_t page_alignment       = 0U;
 		uint32_t memory_type_index    = 0U;
 		size_t   pages_per_allocation = 0U;
 
@@ -172,7 +177,8 @@ class SparseImage : public ApiVulkanSample
 
 	struct MemSector : public MemAllocInfo
 	{
-		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceMemory memory     = VK_NULL_HANDLE;
+		VmaAllocation  allocation = VK_NULL_HANDLE;
 
 		std::set<uint32_t> available_offsets;
 		std::set<size_t>   virt_page_indices;
@@ -180,28 +186,41 @@ class SparseImage : public ApiVulkanSample
 		MemSector(MemAllocInfo &mem_alloc_info) :
 		    MemAllocInfo(mem_alloc_info)
 		{
-			VkMemoryAllocateInfo memory_allocate_info{};
-			memory_allocate_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			memory_allocate_info.allocationSize  = page_size * pages_per_allocation;
-			memory_allocate_info.memoryTypeIndex = memory_type_index;
+			// Sectors are sub-allocated from the blocks of the pool, so most of them don't need a vkAllocateMemory() call
+			VkMemoryRequirements memory_requirements{};
+			memory_requirements.size           = page_size * pages_per_allocation;
+			memory_requirements.alignment      = page_alignment;
+			memory_requirements.memoryTypeBits = 1U << memory_type_index;
+
+			VmaAllocationCreateInfo allocation_create_info{};
+			allocation_create_info.pool = pool;
 
-			VkDeviceMemory memory;
-			VK_CHECK(vkAllocateMemory(device, &memory_allocate_info, nullptr, &memory));
-			this->memory = memory;
+			VmaAllocationInfo allocation_info{};
+			VK_CHECK(vmaAllocateMemory(vkb::allocated::get_memory_allocator(), &memory_requirements, &allocation_create_info, &allocation, &allocation_info));
+			memory = allocation_info.deviceMemory;
 
 			for (size_t i = 0U; i < pages_per_allocation; i++)
 			{
-				available_offsets.insert(static_cast<uint32_t>(page_size * i));
+				available_offsets.insert(static_cast<uint32_t>(allocation_info.offset + page_size * i));
 			}
 		}
 
+		// Sectors are only destroyed once the GPU is done with them, see SparseImage::retire_memory_sector()
 		~MemSector()
 		{
-			vkDeviceWaitIdle(device);
-			vkFreeMemory(device, memory, nullptr);
+			vmaFreeMemory(vkb::allocated::get_memory_allocator(), allocation);
 		}
 	};
 
+	// Work submitted without waiting for it, with the resources it uses until its fence is signaled
+	struct InFlightWork
+	{
+		VkFence                                 fence          = VK_NULL_HANDLE;
+		VkCommandBuffer                         command_buffer = VK_NULL_HANDLE;
+		std::unique_ptr<vkb::core::BufferC>     staging_buffer;
+		std::vector<std::shared_ptr<MemSector>> memory_sectors;
+	};
+
 	struct MemSectorCompare
 	{
 		bool operator()(const std::weak_ptr<MemSector> &left, const std::weak_ptr<MemSector> &right)
@@ -311,6 +330,7 @@ class SparseImage : public ApiVulkanSample
 	const uint8_t FRAME_COUNTER_CAP        = 10U;
 	const uint8_t MEMORY_FRAGMENTATION_CAP = 20U;
 	const uint8_t PAGES_PER_ALLOC          = 50U;
+	const uint8_t SECTORS_PER_BLOCK        = 4U;
 	const double  FOV_DEGREES              = 60.0;
 
 	Stages next_stage = Stages::Idle;
@@ -343,6 +363,19 @@ class SparseImage : public ApiVulkanSample
 
 	VkSemaphore bound_semaphore;
 	VkSemaphore submit_semaphore;
+	VkSemaphore transfer_semaphore;
+
+	// Signaled by the last bind or transfer of the frame, waited by its rendering
+	VkSemaphore render_wait_semaphore = VK_NULL_HANDLE;
+
+	std::list<InFlightWork> in_flight_work;
+	std::vector<VkFence>    free_fences;
+
+	// Sectors of the pages unbound by the next vkQueueBindSparse(), kept alive until it completes
+	std::vector<std::shared_ptr<MemSector>> retired_memory_sectors;
+
+	// Number of pages whose binding changed in the last vkQueueBindSparse()
+	size_t last_bind_count = 0U;
 
 	//==================================================================================================
 	SparseImage();
@@ -381,6 +414,10 @@ class SparseImage : public ApiVulkanSample
 	std::vector<size_t>       get_memory_dependency_for_the_block(size_t column, size_t row, uint8_t mip_level);
 	void                      check_mip_page_requirements(std::vector<MemPageDescription> &mipgen_required_vec, MemPageDescription mip_dependency);
 	void                      bind_sparse_image();
+	void                      submit_transfer(VkCommandBuffer command_buffer, std::unique_ptr<vkb::core::BufferC> staging_buffer);
+	void                      retire_memory_sector(std::shared_ptr<MemSector> &memory_sector);
+	VkFence                   acquire_fence();
+	void                      release_completed_work();
 	void                      load_least_detailed_level();
 	void                      set_least_detailed_level();
 	void                      update_frag_settings();
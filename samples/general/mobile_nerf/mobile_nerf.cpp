@@ -17,6 +17,7 @@
 
 #include "mobile_nerf.h"
 #include "filesystem/legacy.h"
+#include "glm/gtc/packing.hpp"
 #include "glm/gtx/matrix_decompose.hpp"
 #include "gltf_loader.h"
 #include "platform/platform.h"
@@ -86,6 +87,8 @@ MobileNerf::MobileNerf()
 	add_device_extension(VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME);
 	// For choosing different sets of weights
 	add_device_extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+	// For evaluating the MLP in half precision
+	add_device_extension(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME, true);
 }
 
 MobileNerf::~MobileNerf()
@@ -131,6 +134,23 @@ MobileNerf::~MobileNerf()
 		vkDestroyPipelineLayout(device_ptr, pipeline_first_pass_layout, nullptr);
 		vkDestroyDescriptorSetLayout(device_ptr, descriptor_set_first_pass_layout, nullptr);
 
+		if (pipeline_mlp_compute)
+		{
+			vkDestroyPipeline(device_ptr, pipeline_compact_pixels, nullptr);
+			vkDestroyPipeline(device_ptr, pipeline_mlp_compute, nullptr);
+			vkDestroyPipelineLayout(device_ptr, pipeline_layout_compute, nullptr);
+			vkDestroyDescriptorSetLayout(device_ptr, descriptor_set_layout_compute, nullptr);
+			vkDestroyPipeline(device_ptr, pipeline_composite, nullptr);
+			vkDestroyPipelineLayout(device_ptr, pipeline_layout_composite, nullptr);
+			vkDestroyDescriptorSetLayout(device_ptr, descriptor_set_layout_composite, nullptr);
+			vkDestroySampler(device_ptr, feature_sampler, nullptr);
+		}
+
+		for (auto &work_list_buffer : work_list_buffers)
+		{
+			work_list_buffer.reset();
+		}
+
 		if (pipeline_baseline)
 		{
 			vkDestroyPipeline(get_device().get_handle(), pipeline_baseline, nullptr);
@@ -144,6 +164,7 @@ MobileNerf::~MobileNerf()
 			attachment.feature_1.destroy();
 			attachment.feature_2.destroy();
 			attachment.weights_idx.destroy();
+			attachment.mlp_output.destroy();
 		}
 	}
 }
@@ -184,6 +205,10 @@ void MobileNerf::read_json_map()
 
             "rotation": true,
 
+            "half_precision": true,
+
+            "compute_mlp": false,
+
             "lego_ball":{
                 "path": "scenes/morpheus_team/lego_ball_phone/",
                 "num_sub_model": 1,
@@ -310,6 +335,22 @@ void MobileNerf::read_json_map()
 	use_deferred = raw_asset_map["deferred"].get<bool>();
 	do_rotation  = raw_asset_map["rotation"].get<bool>();
 
+	// Set to false to compare against the full precision MLP
+	if (!raw_asset_map["half_precision"].is_null())
+	{
+		use_half_precision_mlp = raw_asset_map["half_precision"].get<bool>();
+	}
+
+	if (!raw_asset_map["compute_mlp"].is_null())
+	{
+		use_compute_mlp = raw_asset_map["compute_mlp"].get<bool>();
+	}
+	if (use_compute_mlp && !use_deferred)
+	{
+		LOGW("The compute MLP needs the deferred mode, evaluating the MLP in the fragment shaders");
+		use_compute_mlp = false;
+	}
+
 	view_port_width  = raw_asset_map["width"].get<int>();
 	view_port_height = raw_asset_map["height"].get<int>();
 
@@ -363,24 +404,81 @@ void MobileNerf::load_shaders()
 		        (using_original_nerf_models[0] ? "mobile_nerf/raster.frag" : "mobile_nerf/raster_morpheus.frag"),
 		    VK_SHADER_STAGE_FRAGMENT_BIT);
 
-		// Loading second pass shaders
-		shader_stages_second_pass[0] = load_shader("mobile_nerf/quad.vert", VK_SHADER_STAGE_VERTEX_BIT);
-		shader_stages_second_pass[1] = load_shader(
-		    combo_mode ?
-		        (using_original_nerf_models[0] ? "mobile_nerf/mlp_combo.frag" : "mobile_nerf/mlp_morpheus_combo.frag") :
-		        (using_original_nerf_models[0] ? "mobile_nerf/mlp.frag" : "mobile_nerf/mlp_morpheus.frag"),
-		    VK_SHADER_STAGE_FRAGMENT_BIT);
+		if (use_compute_mlp)
+		{
+			// Loading compute shaders, then the shaders copying their output to the swapchain
+			std::vector<std::string> definitions;
+			if (combo_mode)
+			{
+				definitions.push_back("COMBO");
+			}
+			if (!using_original_nerf_models[0])
+			{
+				definitions.push_back("MORPHEUS");
+			}
+			shader_stage_compact_pixels = load_shader("mobile_nerf/compact_pixels.comp", VK_SHADER_STAGE_COMPUTE_BIT);
+			shader_stage_mlp_compute    = load_mlp_shader("mobile_nerf/mlp.comp", VK_SHADER_STAGE_COMPUTE_BIT, definitions);
+			shader_stages_composite[0]  = load_shader("mobile_nerf/quad.vert", VK_SHADER_STAGE_VERTEX_BIT);
+			shader_stages_composite[1]  = load_shader("mobile_nerf/composite.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
+		}
+		else
+		{
+			// Loading second pass shaders
+			shader_stages_second_pass[0] = load_shader("mobile_nerf/quad.vert", VK_SHADER_STAGE_VERTEX_BIT);
+			shader_stages_second_pass[1] = load_mlp_shader(
+			    combo_mode ?
+			        (using_original_nerf_models[0] ? "mobile_nerf/mlp_combo.frag" : "mobile_nerf/mlp_morpheus_combo.frag") :
+			        (using_original_nerf_models[0] ? "mobile_nerf/mlp.frag" : "mobile_nerf/mlp_morpheus.frag"),
+			    VK_SHADER_STAGE_FRAGMENT_BIT);
+		}
 	}
 	else
 	{
 		// Loading one pass shaders
 		shader_stages_first_pass[0] = load_shader("mobile_nerf/raster.vert", VK_SHADER_STAGE_VERTEX_BIT);
-		shader_stages_first_pass[1] = load_shader(
+		shader_stages_first_pass[1] = load_mlp_shader(
 		    using_original_nerf_models[0] ? "mobile_nerf/merged.frag" : "mobile_nerf/merged_morpheus.frag",
 		    VK_SHADER_STAGE_FRAGMENT_BIT);
 	}
 }
 
+VkPipelineShaderStageCreateInfo MobileNerf::load_mlp_shader(const std::string &file, VkShaderStageFlagBits stage, const std::vector<std::string> &definitions)
+{
+	if (!use_half_precision_mlp && definitions.empty())
+	{
+		return load_shader(file, stage);
+	}
+
+	// ApiVulkanSample::load_shader compiles without definitions, so the variants are compiled here
+	vkb::ShaderVariant shader_variant;
+	shader_variant.add_definitions(definitions);
+	if (use_half_precision_mlp)
+	{
+		shader_variant.add_define("MLP_FP16");
+	}
+
+	vkb::GLSLCompiler     glsl_compiler;
+	auto                  buffer = vkb::fs::read_shader_binary(file);
+	std::vector<uint32_t> spirv;
+	std::string           info_log;
+	if (!glsl_compiler.compile_to_spirv(stage, buffer, "main", shader_variant, spirv, info_log))
+	{
+		LOGE("Failed to compile shader, Error: {}", info_log.c_str());
+		throw std::runtime_error{"Failed to compile shader"};
+	}
+
+	VkShaderModuleCreateInfo module_create_info{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+	module_create_info.codeSize = spirv.size() * sizeof(uint32_t);
+	module_create_info.pCode    = spirv.data();
+
+	VkPipelineShaderStageCreateInfo shader_stage{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+	shader_stage.stage = stage;
+	shader_stage.pName = "main";
+	VK_CHECK(vkCreateShaderModule(get_device().get_handle(), &module_create_info, nullptr, &shader_stage.module));
+	shader_modules.push_back(shader_stage.module);
+	return shader_stage;
+}
+
 bool MobileNerf::prepare(const vkb::ApplicationOptions &options)
 {
 	read_json_map();
@@ -446,7 +544,11 @@ bool MobileNerf::prepare(const vkb::ApplicationOptions &options)
 	prepare_instance_data();
 	create_pipeline_layout_fist_pass();
 
-	if (use_deferred)
+	if (use_compute_mlp)
+	{
+		create_pipeline_layout_compute();
+	}
+	else if (use_deferred)
 	{
 		create_pipeline_layout_baseline();
 	}
@@ -457,7 +559,11 @@ bool MobileNerf::prepare(const vkb::ApplicationOptions &options)
 		create_descriptor_sets_first_pass(model);
 	}
 
-	if (use_deferred)
+	if (use_compute_mlp)
+	{
+		create_descriptor_sets_compute();
+	}
+	else if (use_deferred)
 	{
 		create_descriptor_sets_baseline();
 	}
@@ -481,6 +587,14 @@ void MobileNerf::request_gpu_features(vkb::PhysicalDevice &gpu)
 	REQUEST_REQUIRED_FEATURE(gpu, VkPhysicalDeviceDescriptorIndexingFeaturesEXT, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT, shaderUniformBufferArrayNonUniformIndexing);
 	REQUEST_REQUIRED_FEATURE(gpu, VkPhysicalDeviceDescriptorIndexingFeaturesEXT, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT, runtimeDescriptorArray);
 	REQUEST_REQUIRED_FEATURE(gpu, VkPhysicalDeviceDescriptorIndexingFeaturesEXT, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT, descriptorBindingVariableDescriptorCount);
+
+	// The half floats are unpacked from 32-bit words, so no 16-bit storage feature is needed
+	if (use_half_precision_mlp)
+	{
+		use_half_precision_mlp = gpu.is_extension_supported(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME) &&
+		                         REQUEST_OPTIONAL_FEATURE(gpu, VkPhysicalDeviceFloat16Int8FeaturesKHR, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FLOAT16_INT8_FEATURES_KHR, shaderFloat16);
+	}
+	LOGI("Evaluating the MLP in {} precision", use_half_precision_mlp ? "half" : "full");
 }
 
 void MobileNerf::render(float delta_time)
@@ -557,13 +671,32 @@ void MobileNerf::setup_nerf_framebuffer_baseline()
 	{
 		frameAttachments.resize(get_render_context().get_render_frames().size());
 
+		// The compute MLP samples the G-buffer after the render pass, rather than reading input attachments
+		VkImageUsageFlags feature_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (use_compute_mlp ? VK_IMAGE_USAGE_SAMPLED_BIT : VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+
 		for (auto i = 0; i < frameAttachments.size(); i++)
 		{
-			setup_attachment(feature_map_format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, frameAttachments[i].feature_0);
-			setup_attachment(feature_map_format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, frameAttachments[i].feature_1);
-			setup_attachment(VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, frameAttachments[i].feature_2);
+			setup_attachment(feature_map_format, feature_usage, frameAttachments[i].feature_0);
+			setup_attachment(feature_map_format, feature_usage, frameAttachments[i].feature_1);
+			setup_attachment(VK_FORMAT_R16G16B16A16_SFLOAT, feature_usage, frameAttachments[i].feature_2);
 			if (combo_mode)
-				setup_attachment(VK_FORMAT_R8_UINT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, frameAttachments[i].weights_idx);
+				setup_attachment(VK_FORMAT_R8_UINT, feature_usage, frameAttachments[i].weights_idx);
+			if (use_compute_mlp)
+				setup_attachment(VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, frameAttachments[i].mlp_output);
+		}
+
+		if (use_compute_mlp)
+		{
+			// The dispatch arguments and the pixel count, followed by up to one entry per pixel
+			auto extent = get_render_context().get_surface_extent();
+			work_list_buffers.resize(frameAttachments.size());
+			for (auto &work_list_buffer : work_list_buffers)
+			{
+				work_list_buffer = std::make_unique<vkb::core::BufferC>(get_device(),
+				                                                        (4 + extent.width * extent.height) * sizeof(uint32_t),
+				                                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				                                                        VMA_MEMORY_USAGE_GPU_ONLY);
+			}
 		}
 	}
 
@@ -583,7 +716,8 @@ void MobileNerf::setup_nerf_framebuffer_baseline()
 
 	if (use_deferred)
 	{
-		views.resize(combo_mode ? 6 : 5);
+		// The compute MLP writes the swapchain in the UI render pass
+		views.resize((combo_mode ? 6 : 5) - (use_compute_mlp ? 1 : 0));
 		views[depth_attach_idx] = depth_stencil.view;
 	}
 	else
@@ -615,7 +749,8 @@ void MobileNerf::setup_nerf_framebuffer_baseline()
 			views[color_attach_2_idx] = frameAttachments[i].feature_2.view;
 			if (combo_mode)
 				views[color_attach_3_idx] = frameAttachments[i].weights_idx.view;
-			views[swapchain_attach_idx] = swapchain_buffers[i].view;
+			if (!use_compute_mlp)
+				views[swapchain_attach_idx] = swapchain_buffers[i].view;
 		}
 		else
 		{
@@ -698,7 +833,11 @@ void MobileNerf::build_command_buffers_baseline()
 	{
 		setup_nerf_framebuffer_baseline();
 
-		if (use_deferred)
+		if (use_compute_mlp)
+		{
+			update_descriptor_sets_compute();
+		}
+		else if (use_deferred)
 		{
 			update_descriptor_sets_baseline();
 		}
@@ -728,6 +867,12 @@ void MobileNerf::build_command_buffers_baseline()
 			clear_values[3].depthStencil = {1.0f, 0};
 			clear_values[4].color        = {{1.0f, 1.0f, 1.0f, 0.5f}};        // default_clear_color;
 		}
+
+		// The swapchain is the last attachment, which the compute MLP doesn't render to
+		if (use_compute_mlp)
+		{
+			clear_values.pop_back();
+		}
 	}
 	else
 	{
@@ -766,6 +911,27 @@ void MobileNerf::build_command_buffers_baseline()
 
 		VK_CHECK(vkBeginCommandBuffer(draw_cmd_buffers[i], &command_buffer_begin_info));
 
+		if (use_compute_mlp)
+		{
+			// Reset the work list and clear the uncovered pixels of the compute MLP output to the background color
+			VkMemoryBarrier memory_barrier = vkb::initializers::memory_barrier();
+			memory_barrier.srcAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			memory_barrier.dstAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(draw_cmd_buffers[i], VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			                     VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memory_barrier, 0, nullptr, 0, nullptr);
+
+			const std::array<uint32_t, 4> work_list_header = {0, 1, 1, 0};
+			vkCmdUpdateBuffer(draw_cmd_buffers[i], work_list_buffers[i]->get_handle(), 0, sizeof(work_list_header), work_list_header.data());
+
+			VkClearColorValue background_color = {{1.0f, 1.0f, 1.0f, 1.0f}};
+			vkCmdClearColorImage(draw_cmd_buffers[i], frameAttachments[i].mlp_output.image->get_handle(), VK_IMAGE_LAYOUT_GENERAL, &background_color, 1, &subresource_range);
+
+			memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(draw_cmd_buffers[i], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			                     0, 1, &memory_barrier, 0, nullptr, 0, nullptr);
+		}
+
 		vkCmdBeginRenderPass(draw_cmd_buffers[i], &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 
 		// First sub pass
@@ -803,7 +969,13 @@ void MobileNerf::build_command_buffers_baseline()
 			vkCmdDrawIndexed(draw_cmd_buffers[i], static_cast<uint32_t>(model.indices.size()) * 3, ii.dim.x * ii.dim.y * ii.dim.z, 0, 0, 0);
 		}
 
-		if (use_deferred)
+		if (use_compute_mlp)
+		{
+			vkCmdEndRenderPass(draw_cmd_buffers[i]);
+
+			record_mlp_compute(draw_cmd_buffers[i], i);
+		}
+		else if (use_deferred)
 		{
 			// Second sub pass
 			// Render a full screen quad, reading from the previously written attachments via input attachments
@@ -825,6 +997,15 @@ void MobileNerf::build_command_buffers_baseline()
 		render_pass_begin_info_UI.framebuffer = framebuffers[i];
 
 		vkCmdBeginRenderPass(draw_cmd_buffers[i], &render_pass_begin_info_UI, VK_SUBPASS_CONTENTS_INLINE);
+		if (use_compute_mlp)
+		{
+			vkCmdSetViewport(draw_cmd_buffers[i], 0, 1, &viewport);
+			vkCmdSetScissor(draw_cmd_buffers[i], 0, 1, &scissor);
+
+			vkCmdBindPipeline(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_composite);
+			vkCmdBindDescriptorSets(draw_cmd_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_composite, 0, 1, &descriptor_set_composite[i], 0, nullptr);
+			vkCmdDraw(draw_cmd_buffers[i], 3, 1, 0, 0);
+		}
 		draw_ui(draw_cmd_buffers[i]);
 		vkCmdEndRenderPass(draw_cmd_buffers[i]);
 
@@ -911,6 +1092,19 @@ void MobileNerf::create_descriptor_pool()
 		    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 * static_cast<uint32_t>(models.size())},
 		};
 		// Second Pass
+		if (use_compute_mlp)
+		{
+			// Compute MLP, then the copy of its output to the swapchain
+			uint32_t feature_count = combo_mode ? 4 : 3;
+			pool_sizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (feature_count + 1) * static_cast<uint32_t>(framebuffers.size())});
+			pool_sizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 * static_cast<uint32_t>(framebuffers.size())});
+			pool_sizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 * static_cast<uint32_t>(framebuffers.size())});
+			pool_sizes.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 * static_cast<uint32_t>(framebuffers.size()) * static_cast<uint32_t>(combo_mode ? model_path.size() : 1)});
+
+			VkDescriptorPoolCreateInfo descriptor_pool_create_info = vkb::initializers::descriptor_pool_create_info(pool_sizes, static_cast<uint32_t>(models.size() + 2 * framebuffers.size()));
+			VK_CHECK(vkCreateDescriptorPool(get_device().get_handle(), &descriptor_pool_create_info, nullptr, &descriptor_pool));
+			return;
+		}
 		if (combo_mode)
 		{
 			pool_sizes.push_back({VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 4 * static_cast<uint32_t>(framebuffers.size())});
@@ -1022,6 +1216,146 @@ void MobileNerf::create_pipeline_layout_baseline()
 	VK_CHECK(vkCreatePipelineLayout(get_device().get_handle(), &pipeline_layout_create_info, nullptr, &pipeline_layout_baseline));
 }
 
+void MobileNerf::create_pipeline_layout_compute()
+{
+	// The G-buffer is sampled at the pixel centers, without filtering
+	VkSamplerCreateInfo sampler_create_info = vkb::initializers::sampler_create_info();
+	sampler_create_info.magFilter           = VK_FILTER_NEAREST;
+	sampler_create_info.minFilter           = VK_FILTER_NEAREST;
+	sampler_create_info.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_create_info.addressModeU        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_create_info.addressModeV        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_create_info.addressModeW        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler_create_info.maxLod              = 1.0f;
+	sampler_create_info.borderColor         = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	VK_CHECK(vkCreateSampler(get_device().get_handle(), &sampler_create_info, nullptr, &feature_sampler));
+
+	std::vector<VkDescriptorSetLayoutBinding> set_layout_bindings = {
+	    // Two features from the first pass and ray direction
+	    vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0),
+	    vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 1),
+	    vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 2),
+	};
+	if (combo_mode)
+	{
+		set_layout_bindings.push_back(vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 3));
+	}
+	// Output colors and list of the covered pixels
+	set_layout_bindings.push_back(vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 4));
+	set_layout_bindings.push_back(vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 5));
+	// MLP weights, an array using descriptor indexing in combo mode
+	set_layout_bindings.push_back(vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 6,
+	                                                                               combo_mode ? static_cast<uint32_t>(model_path.size()) : 1));
+
+	VkDescriptorSetLayoutCreateInfo descriptor_layout = vkb::initializers::descriptor_set_layout_create_info(set_layout_bindings.data(), static_cast<uint32_t>(set_layout_bindings.size()));
+
+	std::vector<VkDescriptorBindingFlagsEXT> flags(set_layout_bindings.size(), 0);
+	flags.back() = VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT;
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfoEXT setLayoutBindingFlags{};
+	setLayoutBindingFlags.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+	setLayoutBindingFlags.bindingCount  = static_cast<uint32_t>(flags.size());
+	setLayoutBindingFlags.pBindingFlags = flags.data();
+	if (combo_mode)
+	{
+		descriptor_layout.pNext = &setLayoutBindingFlags;
+	}
+	VK_CHECK(vkCreateDescriptorSetLayout(get_device().get_handle(), &descriptor_layout, nullptr, &descriptor_set_layout_compute));
+
+	VkPipelineLayoutCreateInfo pipeline_layout_create_info =
+	    vkb::initializers::pipeline_layout_create_info(
+	        &descriptor_set_layout_compute,
+	        1);
+
+	VK_CHECK(vkCreatePipelineLayout(get_device().get_handle(), &pipeline_layout_create_info, nullptr, &pipeline_layout_compute));
+
+	// Copy of the output colors to the swapchain
+	VkDescriptorSetLayoutBinding composite_binding = vkb::initializers::descriptor_set_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0);
+
+	VkDescriptorSetLayoutCreateInfo composite_layout = vkb::initializers::descriptor_set_layout_create_info(&composite_binding, 1);
+	VK_CHECK(vkCreateDescriptorSetLayout(get_device().get_handle(), &composite_layout, nullptr, &descriptor_set_layout_composite));
+
+	pipeline_layout_create_info = vkb::initializers::pipeline_layout_create_info(&descriptor_set_layout_composite, 1);
+	VK_CHECK(vkCreatePipelineLayout(get_device().get_handle(), &pipeline_layout_create_info, nullptr, &pipeline_layout_composite));
+}
+
+void MobileNerf::create_descriptor_sets_compute()
+{
+	descriptor_set_compute.resize(nerf_framebuffers.size());
+	descriptor_set_composite.resize(nerf_framebuffers.size());
+
+	for (int i = 0; i < nerf_framebuffers.size(); i++)
+	{
+		VkDescriptorSetAllocateInfo descriptor_set_allocate_info = vkb::initializers::descriptor_set_allocate_info(descriptor_pool, &descriptor_set_layout_compute, 1);
+
+		uint32_t counts[1];
+		counts[0] = static_cast<uint32_t>(model_path.size());
+
+		VkDescriptorSetVariableDescriptorCountAllocateInfo set_counts = {};
+		set_counts.sType                                              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+		set_counts.descriptorSetCount                                 = 1;
+		set_counts.pDescriptorCounts                                  = counts;
+
+		if (combo_mode)
+		{
+			descriptor_set_allocate_info.pNext = &set_counts;
+		}
+		VK_CHECK(vkAllocateDescriptorSets(get_device().get_handle(), &descriptor_set_allocate_info, &descriptor_set_compute[i]));
+
+		descriptor_set_allocate_info = vkb::initializers::descriptor_set_allocate_info(descriptor_pool, &descriptor_set_layout_composite, 1);
+		VK_CHECK(vkAllocateDescriptorSets(get_device().get_handle(), &descriptor_set_allocate_info, &descriptor_set_composite[i]));
+	}
+
+	update_descriptor_sets_compute();
+}
+
+void MobileNerf::update_descriptor_sets_compute()
+{
+	for (int i = 0; i < nerf_framebuffers.size(); i++)
+	{
+		std::vector<VkDescriptorImageInfo> feature_descriptors;
+		feature_descriptors.push_back({feature_sampler, frameAttachments[i].feature_0.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+		feature_descriptors.push_back({feature_sampler, frameAttachments[i].feature_1.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+		feature_descriptors.push_back({feature_sampler, frameAttachments[i].feature_2.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+		if (combo_mode)
+		{
+			feature_descriptors.push_back({feature_sampler, frameAttachments[i].weights_idx.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+		}
+
+		// The output is written and sampled in the general layout it was created in
+		VkDescriptorImageInfo output_descriptor{VK_NULL_HANDLE, frameAttachments[i].mlp_output.view, VK_IMAGE_LAYOUT_GENERAL};
+		VkDescriptorImageInfo composite_descriptor{feature_sampler, frameAttachments[i].mlp_output.view, VK_IMAGE_LAYOUT_GENERAL};
+
+		VkDescriptorBufferInfo work_list_descriptor = create_descriptor(*work_list_buffers[i]);
+
+		std::vector<VkDescriptorBufferInfo> weights_buffer_descriptors;
+		if (combo_mode)
+		{
+			for (auto &weight_buffer : weights_buffers)
+			{
+				weights_buffer_descriptors.emplace_back(create_descriptor(*weight_buffer));
+			}
+		}
+		else
+		{
+			weights_buffer_descriptors.emplace_back(create_descriptor(*weights_buffers[models[0].model_index]));
+		}
+
+		std::vector<VkWriteDescriptorSet> write_descriptor_sets;
+		for (uint32_t binding = 0; binding < feature_descriptors.size(); binding++)
+		{
+			write_descriptor_sets.push_back(vkb::initializers::write_descriptor_set(descriptor_set_compute[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, binding, &feature_descriptors[binding]));
+		}
+		write_descriptor_sets.push_back(vkb::initializers::write_descriptor_set(descriptor_set_compute[i], VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 4, &output_descriptor));
+		write_descriptor_sets.push_back(vkb::initializers::write_descriptor_set(descriptor_set_compute[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5, &work_list_descriptor));
+		write_descriptor_sets.push_back(vkb::initializers::write_descriptor_set(descriptor_set_compute[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 6,
+		                                                                        weights_buffer_descriptors.data(), static_cast<uint32_t>(weights_buffer_descriptors.size())));
+		write_descriptor_sets.push_back(vkb::initializers::write_descriptor_set(descriptor_set_composite[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &composite_descriptor));
+
+		vkUpdateDescriptorSets(get_device().get_handle(), static_cast<uint32_t>(write_descriptor_sets.size()), write_descriptor_sets.data(), 0, VK_NULL_HANDLE);
+	}
+}
+
 void MobileNerf::create_descriptor_sets_first_pass(Model &model)
 {
 	int numDescriptorPerModel = use_deferred ? 1 : static_cast<int>(nerf_framebuffers.size());
@@ -1234,7 +1568,11 @@ void MobileNerf::prepare_pipelines()
 		VK_CHECK(vkCreateGraphicsPipelines(get_device().get_handle(), pipeline_cache, 1, &pipeline_create_info, nullptr, &model.pipeline_first_pass));
 	}
 
-	if (use_deferred)
+	if (use_compute_mlp)
+	{
+		prepare_pipelines_compute();
+	}
+	else if (use_deferred)
 	{
 		// Second Pass
 
@@ -1255,6 +1593,86 @@ void MobileNerf::prepare_pipelines()
 	}
 }
 
+void MobileNerf::prepare_pipelines_compute()
+{
+	VkComputePipelineCreateInfo compute_pipeline_create_info = vkb::initializers::compute_pipeline_create_info(pipeline_layout_compute);
+
+	compute_pipeline_create_info.stage = shader_stage_compact_pixels;
+	VK_CHECK(vkCreateComputePipelines(get_device().get_handle(), pipeline_cache, 1, &compute_pipeline_create_info, nullptr, &pipeline_compact_pixels));
+
+	compute_pipeline_create_info.stage = shader_stage_mlp_compute;
+	VK_CHECK(vkCreateComputePipelines(get_device().get_handle(), pipeline_cache, 1, &compute_pipeline_create_info, nullptr, &pipeline_mlp_compute));
+
+	// Full screen triangle in the UI render pass, copying the output before the UI is drawn over it
+
+	VkPipelineInputAssemblyStateCreateInfo input_assembly_state = vkb::initializers::pipeline_input_assembly_state_create_info(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
+
+	VkPipelineRasterizationStateCreateInfo rasterization_state = vkb::initializers::pipeline_rasterization_state_create_info(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0);
+
+	VkPipelineColorBlendAttachmentState blend_attachment_state = vkb::initializers::pipeline_color_blend_attachment_state(0xf, VK_FALSE);
+
+	VkPipelineColorBlendStateCreateInfo color_blend_state = vkb::initializers::pipeline_color_blend_state_create_info(1, &blend_attachment_state);
+
+	VkPipelineDepthStencilStateCreateInfo depth_stencil_state = vkb::initializers::pipeline_depth_stencil_state_create_info(VK_FALSE, VK_FALSE, VK_COMPARE_OP_ALWAYS);
+
+	VkPipelineViewportStateCreateInfo viewport_state = vkb::initializers::pipeline_viewport_state_create_info(1, 1, 0);
+
+	std::vector<VkDynamicState> dynamic_state_enables = {
+	    VK_DYNAMIC_STATE_VIEWPORT,
+	    VK_DYNAMIC_STATE_SCISSOR};
+
+	VkPipelineDynamicStateCreateInfo dynamic_state =
+	    vkb::initializers::pipeline_dynamic_state_create_info(
+	        dynamic_state_enables.data(),
+	        static_cast<uint32_t>(dynamic_state_enables.size()),
+	        0);
+
+	VkPipelineMultisampleStateCreateInfo multisample_state = vkb::initializers::pipeline_multisample_state_create_info(VK_SAMPLE_COUNT_1_BIT, 0);
+
+	VkPipelineVertexInputStateCreateInfo emptyInputStateCI{};
+	emptyInputStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+	VkGraphicsPipelineCreateInfo pipeline_create_info = vkb::initializers::pipeline_create_info(pipeline_layout_composite, render_pass, 0);
+	pipeline_create_info.pVertexInputState            = &emptyInputStateCI;
+	pipeline_create_info.pInputAssemblyState          = &input_assembly_state;
+	pipeline_create_info.pRasterizationState          = &rasterization_state;
+	pipeline_create_info.pColorBlendState             = &color_blend_state;
+	pipeline_create_info.pMultisampleState            = &multisample_state;
+	pipeline_create_info.pViewportState               = &viewport_state;
+	pipeline_create_info.pDepthStencilState           = &depth_stencil_state;
+	pipeline_create_info.pDynamicState                = &dynamic_state;
+	pipeline_create_info.subpass                      = 0;
+	pipeline_create_info.stageCount                   = static_cast<uint32_t>(shader_stages_composite.size());
+	pipeline_create_info.pStages                      = shader_stages_composite.data();
+
+	VK_CHECK(vkCreateGraphicsPipelines(get_device().get_handle(), pipeline_cache, 1, &pipeline_create_info, nullptr, &pipeline_composite));
+}
+
+void MobileNerf::record_mlp_compute(VkCommandBuffer command_buffer, size_t index)
+{
+	auto extent = get_render_context().get_surface_extent();
+
+	// Lists the pixels covered by the first pass, and sizes the indirect dispatch over them
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_compact_pixels);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout_compute, 0, 1, &descriptor_set_compute[index], 0, nullptr);
+	vkCmdDispatch(command_buffer, (extent.width + 7) / 8, (extent.height + 7) / 8, 1);
+
+	VkMemoryBarrier memory_barrier = vkb::initializers::memory_barrier();
+	memory_barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+	memory_barrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+	                     0, 1, &memory_barrier, 0, nullptr, 0, nullptr);
+
+	// One invocation per listed pixel
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_mlp_compute);
+	vkCmdDispatchIndirect(command_buffer, work_list_buffers[index]->get_handle(), 0);
+
+	memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+	                     0, 1, &memory_barrier, 0, nullptr, 0, nullptr);
+}
+
 void MobileNerf::create_static_object_buffers(int model_index, int sub_model_index, int models_entry)
 {
 	LOGI("Creating static object buffers");
@@ -1315,7 +1733,7 @@ void MobileNerf::create_uniforms()
 
 		LOGI("Creating mlp weights uniform buffer for model {}", i);
 		weights_buffers[i] = std::make_unique<vkb::core::BufferC>(get_device(),
-		                                                          sizeof(MLP_Weights),
+		                                                          use_half_precision_mlp ? sizeof(MLP_Weights_FP16) : sizeof(MLP_Weights),
 		                                                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
 		                                                          VMA_MEMORY_USAGE_CPU_TO_GPU);
 	}
@@ -1507,7 +1925,19 @@ void MobileNerf::update_weights_buffers()
 	// No need to be updated for every frames
 	for (int i = 0; i < model_path.size(); i++)
 	{
-		weights_buffers[i]->update(&(mlp_weight_vector[i].data[0]), sizeof(MLP_Weights));
+		if (use_half_precision_mlp)
+		{
+			MLP_Weights_FP16 packed_weights{};
+			for (size_t ii = 0; ii < std::size(mlp_weight_vector[i].data); ii++)
+			{
+				packed_weights.data[ii] = glm::packHalf1x16(mlp_weight_vector[i].data[ii]);
+			}
+			weights_buffers[i]->update(&(packed_weights.data[0]), sizeof(MLP_Weights_FP16));
+		}
+		else
+		{
+			weights_buffers[i]->update(&(mlp_weight_vector[i].data[0]), sizeof(MLP_Weights));
+		}
 	}
 }
 
@@ -1741,6 +2171,16 @@ void MobileNerf::update_render_pass_nerf_baseline()
 	swapchain_description.initialLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
 	swapchain_description.finalLayout             = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
+	if (use_compute_mlp)
+	{
+		// The G-buffer is sampled by the compute MLP after the render pass
+		for (auto *color_description : {&color_description_0, &color_description_1, &color_description_2, &color_description_3})
+		{
+			color_description->storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
+			color_description->finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+	}
+
 	std::vector<VkAttachmentDescription> attachments;
 	attachments.push_back(color_description_0);
 	attachments.push_back(color_description_1);
@@ -1748,7 +2188,8 @@ void MobileNerf::update_render_pass_nerf_baseline()
 	if (combo_mode)
 		attachments.push_back(color_description_3);
 	attachments.push_back(depth_description);
-	attachments.push_back(swapchain_description);
+	if (!use_compute_mlp)
+		attachments.push_back(swapchain_description);
 
 	VkAttachmentReference color_reference_0 = {};
 	color_reference_0.attachment            = color_attach_0_idx;
@@ -1836,13 +2277,27 @@ void MobileNerf::update_render_pass_nerf_baseline()
 	dependencies[2].dstAccessMask   = VK_ACCESS_NONE;
 	dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
+	// The compute MLP only uses the first sub pass, whose G-buffer is read by the compute shaders
+	uint32_t subpass_count    = static_cast<uint32_t>(subpassDescriptions.size());
+	uint32_t dependency_count = static_cast<uint32_t>(dependencies.size());
+	if (use_compute_mlp)
+	{
+		dependencies[1].dstSubpass      = VK_SUBPASS_EXTERNAL;
+		dependencies[1].dstStageMask    = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[1].dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
+		dependencies[1].dependencyFlags = 0;
+
+		subpass_count    = 1;
+		dependency_count = 2;
+	}
+
 	VkRenderPassCreateInfo render_pass_create_info = {};
 	render_pass_create_info.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 	render_pass_create_info.attachmentCount        = static_cast<uint32_t>(attachments.size());
 	render_pass_create_info.pAttachments           = attachments.data();
-	render_pass_create_info.subpassCount           = static_cast<uint32_t>(subpassDescriptions.size());
+	render_pass_create_info.subpassCount           = subpass_count;
 	render_pass_create_info.pSubpasses             = subpassDescriptions.data();
-	render_pass_create_info.dependencyCount        = static_cast<uint32_t>(dependencies.size());
+	render_pass_create_info.dependencyCount        = dependency_count;
 	render_pass_create_info.pDependencies          = dependencies.data();
 
 	VK_CHECK(vkCreateRenderPass(get_device().get_handle(), &render_pass_create_info, nullptr, &render_pass_nerf));
@@ -81,6 +81,14 @@ class MobileNerf : public ApiVulkanSample
 		           BIAS_0_COUNT + BIAS_1_COUNT + BIAS_2_COUNT];        // Array of floats
 	};
 
+	// The weights packed as half floats, padded to a whole number of 16 bytes
+	struct MLP_Weights_FP16
+	{
+		uint16_t data[(WEIGHTS_0_COUNT + WEIGHTS_1_COUNT + WEIGHTS_2_COUNT +
+		               BIAS_0_COUNT + BIAS_1_COUNT + BIAS_2_COUNT + 7) /
+		              8 * 8];        // Array of half floats
+	};
+
 	struct Vertex
 	{
 		glm::vec3 position;
@@ -149,6 +157,7 @@ class MobileNerf : public ApiVulkanSample
 	// Common
 	void read_json_map();
 	void load_shaders();
+	VkPipelineShaderStageCreateInfo load_mlp_shader(const std::string &file, VkShaderStageFlagBits stage, const std::vector<std::string> &definitions = {});
 	void build_command_buffers() override;
 	void create_uniforms();
 	void create_static_object_buffers(int model_index, int sub_model_index, int models_entry);
@@ -188,6 +197,9 @@ class MobileNerf : public ApiVulkanSample
 	struct Attachments_baseline
 	{
 		FrameBufferAttachment feature_0, feature_1, feature_2, weights_idx;
+
+		// Colors evaluated by the compute MLP
+		FrameBufferAttachment mlp_output;
 	};
 
 	std::vector<Attachments_baseline> frameAttachments;
@@ -207,6 +219,30 @@ class MobileNerf : public ApiVulkanSample
 	void update_descriptor_sets_baseline();
 	void build_command_buffers_baseline();
 
+	// For the compute MLP, evaluated over the pixels covered by the first pass only
+	VkPipeline                                       pipeline_compact_pixels{VK_NULL_HANDLE};
+	VkPipeline                                       pipeline_mlp_compute{VK_NULL_HANDLE};
+	VkPipelineLayout                                 pipeline_layout_compute{VK_NULL_HANDLE};
+	VkDescriptorSetLayout                            descriptor_set_layout_compute{VK_NULL_HANDLE};
+	std::vector<VkDescriptorSet>                     descriptor_set_compute;
+	VkPipelineShaderStageCreateInfo                  shader_stage_compact_pixels{};
+	VkPipelineShaderStageCreateInfo                  shader_stage_mlp_compute{};
+	VkSampler                                        feature_sampler{VK_NULL_HANDLE};
+	std::vector<std::unique_ptr<vkb::core::BufferC>> work_list_buffers;
+
+	// Copies the colors of the compute MLP to the swapchain in the UI render pass
+	VkPipeline                                     pipeline_composite{VK_NULL_HANDLE};
+	VkPipelineLayout                               pipeline_layout_composite{VK_NULL_HANDLE};
+	VkDescriptorSetLayout                          descriptor_set_layout_composite{VK_NULL_HANDLE};
+	std::vector<VkDescriptorSet>                   descriptor_set_composite;
+	std::array<VkPipelineShaderStageCreateInfo, 2> shader_stages_composite;
+
+	void create_pipeline_layout_compute();
+	void create_descriptor_sets_compute();
+	void update_descriptor_sets_compute();
+	void prepare_pipelines_compute();
+	void record_mlp_compute(VkCommandBuffer command_buffer, size_t index);
+
 	// For creating the forward mode rendepass
 	void update_render_pass_nerf_forward();
 
@@ -218,6 +254,12 @@ class MobileNerf : public ApiVulkanSample
 	bool                     use_deferred = false;
 	bool                     do_rotation  = false;
 
+	// Evaluate the MLP with float16_t and upload the weights as half floats, if shaderFloat16 is supported
+	bool use_half_precision_mlp = true;
+
+	// Evaluate the MLP in compute dispatches over a list of the covered pixels rather than in a full screen subpass, deferred only
+	bool use_compute_mlp = false;
+
 	glm::vec3 camera_pos = glm::vec3(-2.2f, 2.2f, 2.2f);
 
 	// Currently combo mode translation are hard-coded
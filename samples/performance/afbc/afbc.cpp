@@ -35,6 +35,9 @@
 
 AFBCSample::AFBCSample()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	// Extension that may be used to query if AFBC is enabled
 	add_device_extension(VK_EXT_IMAGE_COMPRESSION_CONTROL_EXTENSION_NAME, true);
 
@@ -63,6 +66,7 @@ bool AFBCSample::prepare(const vkb::ApplicationOptions &options)
 	vkb::ShaderSource vert_shader("base.vert");
 	vkb::ShaderSource frag_shader("base.frag");
 	auto              scene_subpass = std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(vert_shader), std::move(frag_shader), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	auto render_pipeline = std::make_unique<vkb::RenderPipeline>();
 	render_pipeline->add_subpass(std::move(scene_subpass));
@@ -36,6 +36,14 @@ AsyncComputeSample::AsyncComputeSample()
 	config.insert<vkb::BoolSetting>(1, rotate_shadows, true);
 	config.insert<vkb::BoolSetting>(0, double_buffer_hdr_frames, false);
 	config.insert<vkb::BoolSetting>(1, double_buffer_hdr_frames, true);
+	config.insert<vkb::BoolSetting>(0, scheduler_enabled, false);
+	config.insert<vkb::BoolSetting>(1, scheduler_enabled, false);
+
+	// Let the AsyncComputeScheduler hand the post over between the queues
+	config.insert<vkb::BoolSetting>(2, async_enabled, true);
+	config.insert<vkb::BoolSetting>(2, rotate_shadows, true);
+	config.insert<vkb::BoolSetting>(2, double_buffer_hdr_frames, true);
+	config.insert<vkb::BoolSetting>(2, scheduler_enabled, true);
 }
 
 void AsyncComputeSample::request_gpu_features(vkb::PhysicalDevice &gpu)
@@ -54,8 +62,14 @@ void AsyncComputeSample::draw_gui()
 		    ImGui::Checkbox("Enable async queues", &async_enabled);
 		    ImGui::Checkbox("Double buffer HDR", &double_buffer_hdr_frames);
 		    ImGui::Checkbox("Rotate shadows", &rotate_shadows);
+		    ImGui::Checkbox("Schedule the post", &scheduler_enabled);
+		    if (use_scheduler)
+		    {
+			    auto &timings = compute_scheduler->get_timings();
+			    ImGui::Text("Post: %.2f ms, stall: %.2f ms, overlap: %.2f ms", timings.compute_ms, timings.graphics_stall_ms, timings.overlap_ms);
+		    }
 	    },
-	    /* lines = */ 3);
+	    /* lines = */ use_scheduler ? 5 : 4);
 }
 
 static VkExtent3D downsample_extent(const VkExtent3D &extent, uint32_t level)
@@ -164,10 +178,36 @@ void AsyncComputeSample::setup_queues()
 {
 	present_graphics_queue = &get_device().get_queue_by_present(0);
 	last_async_enabled     = async_enabled;
+	last_scheduler_enabled = scheduler_enabled;
 
 	// Need to be careful about sync if we're going to suddenly switch to async compute.
 	get_device().wait_idle();
 
+	// The scheduler submits the post between the graphics work submitted before and after it,
+	// so the rest of the frame has to go through its graphics queue.
+	use_scheduler = async_enabled && scheduler_enabled;
+	if (use_scheduler && compute_scheduler->get_graphics_queue().get_handle() != present_graphics_queue->get_handle())
+	{
+		LOGW("The graphics queue of the scheduler can't present, the post is synchronized by the sample");
+		use_scheduler = false;
+	}
+
+	if (use_scheduler)
+	{
+		// The scheduler orders the post with the frames itself, nothing waits for the semaphores of the last frames.
+		for (auto &semaphore : hdr_wait_semaphores)
+		{
+			vkDestroySemaphore(get_device().get_handle(), semaphore, nullptr);
+			semaphore = VK_NULL_HANDLE;
+		}
+		vkDestroySemaphore(get_device().get_handle(), compute_post_semaphore, nullptr);
+		compute_post_semaphore = VK_NULL_HANDLE;
+
+		early_graphics_queue = present_graphics_queue;
+		post_compute_queue   = present_graphics_queue;
+		return;
+	}
+
 	// The way we set things up here somewhat heavily favors devices where we have 2 or more graphics queues.
 	// The pipeline we ideally want is:
 	// - Low priority graphics queue renders the HDR frames
@@ -320,6 +360,8 @@ bool AsyncComputeSample::prepare(const vkb::ApplicationOptions &options)
 	blur_up_pipeline       = &get_device().get_resource_cache().RequestPipelineLayout({&blur_up_module});
 	blur_down_pipeline     = &get_device().get_resource_cache().RequestPipelineLayout({&blur_down_module});
 
+	compute_scheduler = std::make_unique<vkb::AsyncComputeScheduler>(get_render_context());
+
 	setup_queues();
 
 	return true;
@@ -437,6 +479,13 @@ VkSemaphore AsyncComputeSample::render_forward_offscreen_pass(VkSemaphore hdr_wa
 
 	command_buffer.end();
 
+	if (use_scheduler)
+	{
+		// The scheduler waits for the work submitted so far before it runs the post
+		get_render_context().submit(queue, {&command_buffer});
+		return VK_NULL_HANDLE;
+	}
+
 	// Conditionally waits on hdr_wait_semaphore.
 	// This resolves the write-after-read hazard where previous frame tonemap read from HDR buffer.
 	auto signal_semaphore = get_render_context().submit(queue, {&command_buffer},
@@ -478,15 +527,20 @@ VkSemaphore AsyncComputeSample::render_swapchain(VkSemaphore post_semaphore)
 
 	command_buffer.end();
 
-	// We're going to wait on this semaphore in different frame,
-	// so we need to hold ownership of the semaphore until we complete the wait.
-	hdr_wait_semaphores[forward_render_target_index] = get_render_context().request_semaphore_with_ownership();
-
-	// We've read the post buffer outputs, so we need to consider write-after-read
-	// next frame. This is only meaningful if we're doing double buffered HDR since it's
-	// theoretically possible to complete HDR rendering for frame N + 1 while we're doing presentation.
-	// In that case, the async compute post pipeline can start writing blur results *before* we're done reading.
-	compute_post_semaphore = get_render_context().request_semaphore_with_ownership();
+	// Without a post semaphore the scheduler already made this submission wait for the post,
+	// and orders the post of the next frame after it.
+	if (post_semaphore != VK_NULL_HANDLE)
+	{
+		// We're going to wait on this semaphore in different frame,
+		// so we need to hold ownership of the semaphore until we complete the wait.
+		hdr_wait_semaphores[forward_render_target_index] = get_render_context().request_semaphore_with_ownership();
+
+		// We've read the post buffer outputs, so we need to consider write-after-read
+		// next frame. This is only meaningful if we're doing double buffered HDR since it's
+		// theoretically possible to complete HDR rendering for frame N + 1 while we're doing presentation.
+		// In that case, the async compute post pipeline can start writing blur results *before* we're done reading.
+		compute_post_semaphore = get_render_context().request_semaphore_with_ownership();
+	}
 
 	const VkSemaphore signal_semaphores[] = {
 	    get_render_context().request_semaphore(),
@@ -495,26 +549,26 @@ VkSemaphore AsyncComputeSample::render_swapchain(VkSemaphore post_semaphore)
 	};
 
 	const VkSemaphore wait_semaphores[] = {
-	    post_semaphore,
 	    get_render_context().consume_acquired_semaphore(),
+	    post_semaphore,
 	};
 
 	const VkPipelineStageFlags wait_stages[] = {
-	    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
 	    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+	    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
 	};
 
 	auto info                 = vkb::initializers::submit_info();
 	info.pSignalSemaphores    = signal_semaphores;
-	info.signalSemaphoreCount = 3;
+	info.signalSemaphoreCount = post_semaphore != VK_NULL_HANDLE ? 3 : 1;
 	info.pWaitSemaphores      = wait_semaphores;
-	info.waitSemaphoreCount   = 2;
+	info.waitSemaphoreCount   = post_semaphore != VK_NULL_HANDLE ? 2 : 1;
 	info.pWaitDstStageMask    = wait_stages;
 	info.commandBufferCount   = 1;
 	info.pCommandBuffers      = &command_buffer.get_handle();
 
 	queue.submit({info}, get_render_context().get_active_frame().RequestFence());
-	get_render_context().release_owned_semaphore(wait_semaphores[1]);
+	get_render_context().release_owned_semaphore(wait_semaphores[0]);
 	return signal_semaphores[0];
 }
 
@@ -545,6 +599,51 @@ VkSemaphore AsyncComputeSample::render_compute_post(VkSemaphore wait_graphics_se
 		command_buffer.image_memory_barrier(get_current_forward_render_target().get_views()[0], memory_barrier);
 	}
 
+	record_compute_post(command_buffer);
+
+	// We're going to read the HDR texture again in the present queue.
+	// Need to release ownership back to that queue.
+	if (post_compute_queue->get_family_index() != present_graphics_queue->get_family_index())
+	{
+		vkb::ImageMemoryBarrier memory_barrier{};
+		memory_barrier.old_layout       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		memory_barrier.new_layout       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		memory_barrier.src_access_mask  = 0;
+		memory_barrier.dst_access_mask  = 0;
+		memory_barrier.src_stage_mask   = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		memory_barrier.dst_stage_mask   = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		memory_barrier.old_queue_family = post_compute_queue->get_family_index();
+		memory_barrier.new_queue_family = present_graphics_queue->get_family_index();
+
+		command_buffer.image_memory_barrier(get_current_forward_render_target().get_views()[0], memory_barrier);
+	}
+
+	command_buffer.end();
+
+	VkPipelineStageFlags wait_stages[]     = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT};
+	VkSemaphore          wait_semaphores[] = {wait_graphics_semaphore, wait_present_semaphore};
+	VkSemaphore          signal_semaphore  = get_render_context().request_semaphore();
+
+	auto info                 = vkb::initializers::submit_info();
+	info.pSignalSemaphores    = &signal_semaphore;
+	info.signalSemaphoreCount = 1;
+	info.pWaitSemaphores      = wait_semaphores;
+	info.waitSemaphoreCount   = wait_present_semaphore != VK_NULL_HANDLE ? 2 : 1;
+	info.pWaitDstStageMask    = wait_stages;
+	info.commandBufferCount   = 1;
+	info.pCommandBuffers      = &command_buffer.get_handle();
+
+	if (wait_present_semaphore != VK_NULL_HANDLE)
+	{
+		get_render_context().release_owned_semaphore(wait_present_semaphore);
+	}
+
+	queue.submit({info}, VK_NULL_HANDLE);
+	return signal_semaphore;
+}
+
+void AsyncComputeSample::record_compute_post(vkb::CommandBuffer &command_buffer)
+{
 	const auto discard_blur_view = [&](const vkb::core::ImageView &view) {
 		vkb::ImageMemoryBarrier memory_barrier{};
 
@@ -619,46 +718,32 @@ VkSemaphore AsyncComputeSample::render_compute_post(VkSemaphore wait_graphics_se
 	{
 		dispatch_pass(*blur_chain_views[index], *blur_chain_views[index + 1], index == 1);
 	}
+}
 
-	// We're going to read the HDR texture again in the present queue.
-	// Need to release ownership back to that queue.
-	if (post_compute_queue->get_family_index() != present_graphics_queue->get_family_index())
-	{
-		vkb::ImageMemoryBarrier memory_barrier{};
-		memory_barrier.old_layout       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		memory_barrier.new_layout       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		memory_barrier.src_access_mask  = 0;
-		memory_barrier.dst_access_mask  = 0;
-		memory_barrier.src_stage_mask   = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-		memory_barrier.dst_stage_mask   = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-		memory_barrier.old_queue_family = post_compute_queue->get_family_index();
-		memory_barrier.new_queue_family = present_graphics_queue->get_family_index();
-
-		command_buffer.image_memory_barrier(get_current_forward_render_target().get_views()[0], memory_barrier);
-	}
-
-	command_buffer.end();
-
-	VkPipelineStageFlags wait_stages[]     = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT};
-	VkSemaphore          wait_semaphores[] = {wait_graphics_semaphore, wait_present_semaphore};
-	VkSemaphore          signal_semaphore  = get_render_context().request_semaphore();
-
-	auto info                 = vkb::initializers::submit_info();
-	info.pSignalSemaphores    = &signal_semaphore;
-	info.signalSemaphoreCount = 1;
-	info.pWaitSemaphores      = wait_semaphores;
-	info.waitSemaphoreCount   = wait_present_semaphore != VK_NULL_HANDLE ? 2 : 1;
-	info.pWaitDstStageMask    = wait_stages;
-	info.commandBufferCount   = 1;
-	info.pCommandBuffers      = &command_buffer.get_handle();
-
-	if (wait_present_semaphore != VK_NULL_HANDLE)
-	{
-		get_render_context().release_owned_semaphore(wait_present_semaphore);
-	}
-
-	queue.submit({info}, VK_NULL_HANDLE);
-	return signal_semaphore;
+void AsyncComputeSample::schedule_compute_post()
+{
+	// The HDR image is written before the post and sampled by the composite after it, the bloom is only sampled
+	vkb::AsyncComputePass::ImageAccess hdr_access{};
+	hdr_access.image           = &get_current_forward_render_target().get_views()[0].get_image();
+	hdr_access.graphics_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	hdr_access.compute_layout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	hdr_access.graphics_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	hdr_access.graphics_access = VK_ACCESS_SHADER_READ_BIT;
+	hdr_access.compute_access  = VK_ACCESS_SHADER_READ_BIT;
+
+	vkb::AsyncComputePass::ImageAccess bloom_access{};
+	bloom_access.image           = blur_chain[1].get();
+	bloom_access.graphics_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	bloom_access.compute_layout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	bloom_access.graphics_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	bloom_access.graphics_access = VK_ACCESS_SHADER_READ_BIT;
+	bloom_access.compute_access  = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	vkb::AsyncComputePass pass;
+	pass.record = [this](vkb::CommandBuffer &command_buffer) { record_compute_post(command_buffer); };
+	pass.images = {hdr_access, bloom_access};
+
+	compute_scheduler->submit(pass);
 }
 
 void AsyncComputeSample::update(float delta_time)
@@ -666,7 +751,7 @@ void AsyncComputeSample::update(float delta_time)
 	// don't call the parent's update, because it's done differently here... but call the grandparent's update for fps logging
 	vkb::Application::update(delta_time);
 
-	if (last_async_enabled != async_enabled)
+	if (last_async_enabled != async_enabled || last_scheduler_enabled != scheduler_enabled)
 	{
 		setup_queues();
 	}
@@ -727,11 +812,21 @@ void AsyncComputeSample::update(float delta_time)
 	// - Async compute post
 	// - Composite
 	render_shadow_pass();
-	VkSemaphore graphics_semaphore                   = render_forward_offscreen_pass(hdr_wait_semaphores[forward_render_target_index]);
-	hdr_wait_semaphores[forward_render_target_index] = VK_NULL_HANDLE;
-	VkSemaphore post_semaphore                       = render_compute_post(graphics_semaphore, compute_post_semaphore);
-	compute_post_semaphore                           = VK_NULL_HANDLE;
-	VkSemaphore present_semaphore                    = render_swapchain(post_semaphore);
+	VkSemaphore present_semaphore = VK_NULL_HANDLE;
+	if (use_scheduler)
+	{
+		render_forward_offscreen_pass(VK_NULL_HANDLE);
+		schedule_compute_post();
+		present_semaphore = render_swapchain(VK_NULL_HANDLE);
+	}
+	else
+	{
+		VkSemaphore graphics_semaphore                   = render_forward_offscreen_pass(hdr_wait_semaphores[forward_render_target_index]);
+		hdr_wait_semaphores[forward_render_target_index] = VK_NULL_HANDLE;
+		VkSemaphore post_semaphore                       = render_compute_post(graphics_semaphore, compute_post_semaphore);
+		compute_post_semaphore                           = VK_NULL_HANDLE;
+		present_semaphore                                = render_swapchain(post_semaphore);
+	}
 
 	get_render_context().end_frame(present_semaphore);
 }
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "rendering/async_compute_scheduler.h"
 #include "rendering/render_pipeline.h"
 #include "rendering/subpasses/forward_subpass.h"
 #include "scene_graph/components/camera.h"
@@ -52,6 +53,8 @@ class AsyncComputeSample : public vkb::VulkanSampleC
 	void        render_shadow_pass();
 	VkSemaphore render_forward_offscreen_pass(VkSemaphore hdr_wait_semaphore);
 	VkSemaphore render_compute_post(VkSemaphore wait_graphics_semaphore, VkSemaphore wait_present_semaphore);
+	void        record_compute_post(vkb::CommandBuffer &command_buffer);
+	void        schedule_compute_post();
 	VkSemaphore render_swapchain(VkSemaphore post_semaphore);
 	void        setup_queues();
 
@@ -73,9 +76,15 @@ class AsyncComputeSample : public vkb::VulkanSampleC
 	const vkb::Queue *present_graphics_queue{nullptr};
 	const vkb::Queue *post_compute_queue{nullptr};
 
+	/// Hands the post over to the compute queue and back, instead of the barriers and semaphores of the sample
+	std::unique_ptr<vkb::AsyncComputeScheduler> compute_scheduler;
+
 	VkSemaphore hdr_wait_semaphores[2]{};
 	VkSemaphore compute_post_semaphore{};
 	bool        async_enabled{false};
+	bool        scheduler_enabled{false};
+	bool        last_scheduler_enabled{false};
+	bool        use_scheduler{false};
 	bool        rotate_shadows{true};
 	bool        last_async_enabled{false};
 	bool        double_buffer_hdr_frames{false};
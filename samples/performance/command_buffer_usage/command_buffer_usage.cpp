@@ -251,8 +251,8 @@ CommandBufferUsage::ForwardSubpassSecondary::ForwardSubpassSecondary(vkb::Render
 {
 }
 
-void CommandBufferUsage::ForwardSubpassSecondary::record_draw(vkb::CommandBuffer                                                &command_buffer,
-                                                              const std::vector<std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> &nodes,
+void CommandBufferUsage::ForwardSubpassSecondary::record_draw(vkb::CommandBuffer                  &command_buffer,
+                                                              const std::vector<vkb::DrawPacket> &nodes,
                                                               uint32_t mesh_start, uint32_t mesh_end, size_t thread_index)
 {
 	command_buffer.set_color_blend_state(color_blend_state);
@@ -264,14 +264,14 @@ void CommandBufferUsage::ForwardSubpassSecondary::record_draw(vkb::CommandBuffer
 	assert(mesh_end <= nodes.size());
 	for (uint32_t i = mesh_start; i < mesh_end; i++)
 	{
-		update_uniform(command_buffer, *nodes[i].first, thread_index);
+		update_uniform(command_buffer, *nodes[i].node, thread_index);
 
-		draw_submesh(command_buffer, *nodes[i].second);
+		draw_submesh(command_buffer, *nodes[i].sub_mesh);
 	}
 }
 
-vkb::CommandBuffer *CommandBufferUsage::ForwardSubpassSecondary::record_draw_secondary(vkb::CommandBuffer                                                &primary_command_buffer,
-                                                                                       const std::vector<std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> &nodes,
+vkb::CommandBuffer *CommandBufferUsage::ForwardSubpassSecondary::record_draw_secondary(vkb::CommandBuffer                  &primary_command_buffer,
+                                                                                       const std::vector<vkb::DrawPacket> &nodes,
                                                                                        uint32_t mesh_start, uint32_t mesh_end, size_t thread_index)
 {
 	const auto &queue = get_render_context().get_device().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
@@ -294,30 +294,14 @@ vkb::CommandBuffer *CommandBufferUsage::ForwardSubpassSecondary::record_draw_sec
 
 void CommandBufferUsage::ForwardSubpassSecondary::draw(vkb::CommandBuffer &primary_command_buffer)
 {
-	std::multimap<float, std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> opaque_nodes;
-
-	std::multimap<float, std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> transparent_nodes;
-
-	get_sorted_nodes(opaque_nodes, transparent_nodes);
-
-	// Sort opaque objects in front-to-back order
+	// Opaque objects are sorted front-to-back and transparent objects back-to-front
 	// Note: sorting objects does not help on PowerVR, so it can be avoided to save CPU cycles
-	std::vector<std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> sorted_opaque_nodes;
-	for (auto node_it = opaque_nodes.begin(); node_it != opaque_nodes.end(); node_it++)
-	{
-		sorted_opaque_nodes.push_back(node_it->second);
-	}
-	const auto opaque_submeshes = vkb::to_u32(sorted_opaque_nodes.size());
+	get_sorted_nodes(opaque_draws, transparent_draws);
 
-	// Sort transparent objects in back-to-front order
-	std::vector<std::pair<vkb::sg::Node *, vkb::sg::SubMesh *>> sorted_transparent_nodes;
-	for (auto node_it = transparent_nodes.rbegin(); node_it != transparent_nodes.rend(); node_it++)
-	{
-		sorted_transparent_nodes.push_back(node_it->second);
-	}
-	const auto transparent_submeshes = vkb::to_u32(sorted_transparent_nodes.size());
+	const auto opaque_submeshes      = vkb::to_u32(opaque_draws.size());
+	const auto transparent_submeshes = vkb::to_u32(transparent_draws.size());
 
-	allocate_lights<vkb::ForwardLights>(scene.get_components<vkb::sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
+	allocate_lights<vkb::ForwardLights>(scene.get_component_view<vkb::sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
 
 	color_blend_attachment.blend_enable = VK_FALSE;
 	color_blend_state.attachments.resize(get_output_attachments().size());
@@ -356,15 +340,15 @@ void CommandBufferUsage::ForwardSubpassSecondary::draw(vkb::CommandBuffer &prima
 			if (state.multi_threading)
 			{
 				auto fut = thread_pool.push(
-				    [this, cb_count, &primary_command_buffer, &sorted_opaque_nodes, mesh_start, mesh_end](size_t thread_id) {
-					    return record_draw_secondary(primary_command_buffer, sorted_opaque_nodes, mesh_start, mesh_end, thread_id);
+				    [this, cb_count, &primary_command_buffer, mesh_start, mesh_end](size_t thread_id) {
+					    return record_draw_secondary(primary_command_buffer, opaque_draws, mesh_start, mesh_end, thread_id);
 				    });
 
 				secondary_cmd_buf_futures.push_back(std::move(fut));
 			}
 			else
 			{
-				secondary_command_buffers.push_back(record_draw_secondary(primary_command_buffer, sorted_opaque_nodes, mesh_start, mesh_end));
+				secondary_command_buffers.push_back(record_draw_secondary(primary_command_buffer, opaque_draws, mesh_start, mesh_end));
 			}
 
 			mesh_start = mesh_end;
@@ -380,7 +364,7 @@ void CommandBufferUsage::ForwardSubpassSecondary::draw(vkb::CommandBuffer &prima
 	}
 	else
 	{
-		record_draw(primary_command_buffer, sorted_opaque_nodes, 0, opaque_submeshes);
+		record_draw(primary_command_buffer, opaque_draws, 0, opaque_submeshes);
 	}
 
 	// Enable alpha blending
@@ -396,11 +380,11 @@ void CommandBufferUsage::ForwardSubpassSecondary::draw(vkb::CommandBuffer &prima
 	{
 		if (use_secondary_command_buffers)
 		{
-			secondary_command_buffers.push_back(record_draw_secondary(primary_command_buffer, sorted_transparent_nodes, 0, transparent_submeshes));
+			secondary_command_buffers.push_back(record_draw_secondary(primary_command_buffer, transparent_draws, 0, transparent_submeshes));
 		}
 		else
 		{
-			record_draw(primary_command_buffer, sorted_transparent_nodes, 0, transparent_submeshes);
+			record_draw(primary_command_buffer, transparent_draws, 0, transparent_submeshes);
 		}
 	}
 
@@ -21,6 +21,7 @@
 #include "constant_data.h"
 
 #include "common/vk_common.h"
+#include "core/allocated.h"
 #include "filesystem/legacy.h"
 #include "gltf_loader.h"
 #include "gui.h"
@@ -55,7 +56,7 @@ inline MVPUniform fill_mvp(vkb::sg::Node &node, vkb::sg::Camera &camera)
 
 	mvp.model = transform.get_world_matrix();
 
-	mvp.camera_view_proj = vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
+	mvp.camera_view_proj = camera.get_pre_rotation() * vkb::rendering::vulkan_style_projection(camera.get_projection()) * camera.get_view();
 
 	mvp.scale = glm::mat4(1.0f);
 
@@ -187,6 +188,23 @@ void ConstantData::draw_renderpass(vkb::CommandBuffer &command_buffer, vkb::Rend
 			last_gui_method_value = gui_method_value;
 		}
 
+		// If the per-frame buffer placement is changed, recreate the buffer pools so they are allocated with the new placement
+		if (gui_resizable_bar != last_gui_resizable_bar)
+		{
+			get_device().wait_idle();
+
+			auto settings                    = vkb::allocated::get_settings();
+			settings.per_frame_resizable_bar = gui_resizable_bar;
+			vkb::allocated::set_settings(settings);
+
+			for (auto &render_frame : get_render_context().get_render_frames())
+			{
+				render_frame->ClearBufferPools();
+			}
+
+			last_gui_resizable_bar = gui_resizable_bar;
+		}
+
 		// Choose the correct dedicated pipeline to draw to the render target
 		if (selected_method == Method::PushConstants)
 		{
@@ -239,6 +257,11 @@ void ConstantData::draw_gui()
 		lines = lines * 2;
 	}
 
+	if (vkb::allocated::has_resizable_bar())
+	{
+		lines++;
+	}
+
 	get_gui().show_options_window(
 	    /* body = */ [this]() {
 		    // Create a line for every config
@@ -274,6 +297,12 @@ void ConstantData::draw_gui()
 			    }
 			    ImGui::EndCombo();
 		    }
+
+		    // Only offer the placement if the device exposes a resizable BAR to compare against
+		    if (vkb::allocated::has_resizable_bar())
+		    {
+			    ImGui::Checkbox("Per-frame buffers in device local memory (ReBAR)", &gui_resizable_bar);
+		    }
 	    },
 	    /* lines = */ vkb::to_u32(lines));
 }
@@ -285,6 +314,9 @@ std::unique_ptr<vkb::VulkanSampleC> create_constant_data()
 
 void ConstantData::ConstantDataSubpass::prepare()
 {
+	// The resource modes of the pipeline layouts depend on the method, which may have changed
+	clear_render_proxies();
+
 	// Build all shader variance upfront
 	auto &device = get_render_context().get_device();
 
@@ -311,7 +343,7 @@ void ConstantData::ConstantDataSubpass::prepare()
 	}
 }
 
-void ConstantData::PushConstantSubpass::update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, size_t thread_index)
+void ConstantData::PushConstantSubpass::update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, vkb::sg::SubMesh &sub_mesh, size_t thread_index)
 {
 	mvp_uniform = fill_mvp(node, camera);
 }
@@ -345,7 +377,7 @@ void ConstantData::PushConstantSubpass::prepare_push_constants(vkb::CommandBuffe
 	}
 }
 
-void ConstantData::DescriptorSetSubpass::update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, size_t thread_index)
+void ConstantData::DescriptorSetSubpass::update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, vkb::sg::SubMesh &sub_mesh, size_t thread_index)
 {
 	MVPUniform mvp;
 
@@ -444,13 +476,13 @@ void ConstantData::BufferArraySubpass::draw(vkb::CommandBuffer &command_buffer)
 	// Reset the instance index back to 0 for each draw call
 	instance_index = 0;
 
-	allocate_lights<vkb::ForwardLights>(scene.get_components<vkb::sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
+	allocate_lights<vkb::ForwardLights>(scene.get_component_view<vkb::sg::Light>(), MAX_FORWARD_LIGHT_COUNT);
 	command_buffer.bind_lighting(get_lighting_state(), 0, 4);
 
 	GeometrySubpass::draw(command_buffer);
 }
 
-void ConstantData::BufferArraySubpass::update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, size_t thread_index)
+void ConstantData::BufferArraySubpass::update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, vkb::sg::SubMesh &sub_mesh, size_t thread_index)
 {
 	/**
 	 * POI
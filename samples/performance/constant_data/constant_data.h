@@ -129,7 +129,7 @@ class ConstantData : public vkb::VulkanSampleC
 		/**
 		 * @brief Updates the MVP uniform member variable to then be pushed into the shader
 		 */
-		virtual void update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, size_t thread_index) override;
+		virtual void update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, vkb::sg::SubMesh &sub_mesh, size_t thread_index) override;
 
 		/**
 		 * @brief Overridden to intentionally disable any dynamic shader module updates
@@ -161,7 +161,7 @@ class ConstantData : public vkb::VulkanSampleC
 		/**
 		 * @brief Creates a buffer filled with the mvp data and binds it
 		 */
-		virtual void update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, size_t thread_index) override;
+		virtual void update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, vkb::sg::SubMesh &sub_mesh, size_t thread_index) override;
 
 		/**
 		 * @brief Dynamically retrieves the correct pipeline layout depending on the method of UBO
@@ -195,7 +195,7 @@ class ConstantData : public vkb::VulkanSampleC
 		/**
 		 * @brief No-op, uniform data is sent upfront before the draw call
 		 */
-		virtual void update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, size_t thread_index) override;
+		virtual void update_uniform(vkb::CommandBuffer &command_buffer, vkb::sg::Node &node, vkb::sg::SubMesh &sub_mesh, size_t thread_index) override;
 
 		/**
 		 * @brief Returns a default pipeline layout
@@ -272,6 +272,11 @@ class ConstantData : public vkb::VulkanSampleC
 	int gui_method_value{static_cast<int>(Method::PushConstants)};
 
 	int last_gui_method_value{static_cast<int>(Method::PushConstants)};
+
+	// Whether the per-frame buffers are placed in device local memory mapped through a resizable BAR
+	bool gui_resizable_bar{true};
+
+	bool last_gui_resizable_bar{true};
 };
 
 std::unique_ptr<vkb::VulkanSampleC> create_constant_data();
@@ -31,9 +31,15 @@ DescriptorManagement::DescriptorManagement()
 
 	config.insert<vkb::IntSetting>(0, descriptor_caching.value, 0);
 	config.insert<vkb::IntSetting>(0, buffer_allocation.value, 0);
+	config.insert<vkb::IntSetting>(0, descriptor_budget.value, 0);
 
 	config.insert<vkb::IntSetting>(1, descriptor_caching.value, 1);
 	config.insert<vkb::IntSetting>(1, buffer_allocation.value, 1);
+	config.insert<vkb::IntSetting>(1, descriptor_budget.value, 0);
+
+	config.insert<vkb::IntSetting>(2, descriptor_caching.value, 1);
+	config.insert<vkb::IntSetting>(2, buffer_allocation.value, 1);
+	config.insert<vkb::IntSetting>(2, descriptor_budget.value, 1);
 }
 
 bool DescriptorManagement::prepare(const vkb::ApplicationOptions &options)
@@ -92,6 +98,18 @@ void DescriptorManagement::update(float delta_time)
 
 	render_context.get_active_frame().SetDescriptorManagementStrategy(descriptor_management_strategy);
 
+	if (descriptor_budget.value != applied_descriptor_budget)
+	{
+		// The frames age the cached sets from now on, and free the least recently used ones above the budget
+		size_t budget = (descriptor_budget.value == 0) ? 0 : 256;
+		for (auto &render_frame : render_context.get_render_frames())
+		{
+			render_frame->SetDescriptorSetBudget(budget);
+		}
+
+		applied_descriptor_budget = descriptor_budget.value;
+	}
+
 	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 	get_stats().begin_sampling(command_buffer);
 
@@ -54,7 +54,15 @@ class DescriptorManagement : public vkb::VulkanSampleC
 	    {"Disabled", "Enabled"},
 	    0};
 
-	std::vector<RadioButtonGroup *> radio_buttons = {&descriptor_caching, &buffer_allocation};
+	RadioButtonGroup descriptor_budget{
+	    "Descriptor set budget",
+	    {"Unbounded", "256 per thread"},
+	    0};
+
+	std::vector<RadioButtonGroup *> radio_buttons = {&descriptor_caching, &buffer_allocation, &descriptor_budget};
+
+	/// Value of the budget option applied to the render frames
+	int applied_descriptor_budget{0};
 
 	vkb::sg::PerspectiveCamera *camera{nullptr};
 
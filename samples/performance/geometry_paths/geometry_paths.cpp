@@ -0,0 +1,333 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "geometry_paths.h"
+
+#include "common/utils.h"
+#include "core/device.h"
+#include "gui.h"
+#include "rendering/subpasses/forward_subpass.h"
+#include "rendering/subpasses/oit_composite_subpass.h"
+#include "scene_graph/components/sub_mesh.h"
+#include "stats/stats.h"
+
+bool GeometryPaths::Paths::operator!=(const Paths &other) const
+{
+	return instancing != other.instancing || gpu_scene != other.gpu_scene || vertex_pulling != other.vertex_pulling ||
+	       conditional_rendering != other.conditional_rendering || bindless != other.bindless ||
+	       order_independent_transparency != other.order_independent_transparency || skinning != other.skinning;
+}
+
+GeometryPaths::GeometryPaths()
+{
+	// Vertex pulling reads the vertex buffers through their addresses
+	add_device_extension(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME, /*optional=*/true);
+
+	// Conditional rendering predicates the draws with the occlusion query results
+	add_device_extension(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME, /*optional=*/true);
+
+	// The bindless array is update-after-bind and partially bound
+	add_device_extension(VK_KHR_MAINTENANCE3_EXTENSION_NAME, /*optional=*/true);
+	add_device_extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, /*optional=*/true);
+
+	auto &config = get_configuration();
+
+	config.insert<vkb::BoolSetting>(0, paths.instancing, false);
+	config.insert<vkb::BoolSetting>(1, paths.instancing, true);
+	config.insert<vkb::BoolSetting>(2, paths.instancing, false);
+	config.insert<vkb::BoolSetting>(3, paths.instancing, false);
+	config.insert<vkb::BoolSetting>(4, paths.instancing, false);
+	config.insert<vkb::BoolSetting>(5, paths.instancing, false);
+	config.insert<vkb::BoolSetting>(6, paths.instancing, false);
+	config.insert<vkb::BoolSetting>(7, paths.instancing, false);
+
+	config.insert<vkb::BoolSetting>(0, paths.gpu_scene, false);
+	config.insert<vkb::BoolSetting>(1, paths.gpu_scene, false);
+	config.insert<vkb::BoolSetting>(2, paths.gpu_scene, true);
+	config.insert<vkb::BoolSetting>(3, paths.gpu_scene, false);
+	config.insert<vkb::BoolSetting>(4, paths.gpu_scene, false);
+	config.insert<vkb::BoolSetting>(5, paths.gpu_scene, false);
+	config.insert<vkb::BoolSetting>(6, paths.gpu_scene, false);
+	config.insert<vkb::BoolSetting>(7, paths.gpu_scene, false);
+
+	config.insert<vkb::BoolSetting>(0, paths.vertex_pulling, false);
+	config.insert<vkb::BoolSetting>(1, paths.vertex_pulling, false);
+	config.insert<vkb::BoolSetting>(2, paths.vertex_pulling, false);
+	config.insert<vkb::BoolSetting>(3, paths.vertex_pulling, true);
+	config.insert<vkb::BoolSetting>(4, paths.vertex_pulling, false);
+	config.insert<vkb::BoolSetting>(5, paths.vertex_pulling, false);
+	config.insert<vkb::BoolSetting>(6, paths.vertex_pulling, false);
+	config.insert<vkb::BoolSetting>(7, paths.vertex_pulling, false);
+
+	config.insert<vkb::BoolSetting>(0, paths.conditional_rendering, false);
+	config.insert<vkb::BoolSetting>(1, paths.conditional_rendering, false);
+	config.insert<vkb::BoolSetting>(2, paths.conditional_rendering, false);
+	config.insert<vkb::BoolSetting>(3, paths.conditional_rendering, false);
+	config.insert<vkb::BoolSetting>(4, paths.conditional_rendering, true);
+	config.insert<vkb::BoolSetting>(5, paths.conditional_rendering, false);
+	config.insert<vkb::BoolSetting>(6, paths.conditional_rendering, false);
+	config.insert<vkb::BoolSetting>(7, paths.conditional_rendering, false);
+
+	config.insert<vkb::BoolSetting>(0, paths.bindless, false);
+	config.insert<vkb::BoolSetting>(1, paths.bindless, false);
+	config.insert<vkb::BoolSetting>(2, paths.bindless, false);
+	config.insert<vkb::BoolSetting>(3, paths.bindless, false);
+	config.insert<vkb::BoolSetting>(4, paths.bindless, false);
+	config.insert<vkb::BoolSetting>(5, paths.bindless, true);
+	config.insert<vkb::BoolSetting>(6, paths.bindless, false);
+	config.insert<vkb::BoolSetting>(7, paths.bindless, false);
+
+	config.insert<vkb::BoolSetting>(0, paths.order_independent_transparency, false);
+	config.insert<vkb::BoolSetting>(1, paths.order_independent_transparency, false);
+	config.insert<vkb::BoolSetting>(2, paths.order_independent_transparency, false);
+	config.insert<vkb::BoolSetting>(3, paths.order_independent_transparency, false);
+	config.insert<vkb::BoolSetting>(4, paths.order_independent_transparency, false);
+	config.insert<vkb::BoolSetting>(5, paths.order_independent_transparency, false);
+	config.insert<vkb::BoolSetting>(6, paths.order_independent_transparency, true);
+	config.insert<vkb::BoolSetting>(7, paths.order_independent_transparency, false);
+
+	config.insert<vkb::BoolSetting>(0, paths.skinning, false);
+	config.insert<vkb::BoolSetting>(1, paths.skinning, false);
+	config.insert<vkb::BoolSetting>(2, paths.skinning, false);
+	config.insert<vkb::BoolSetting>(3, paths.skinning, false);
+	config.insert<vkb::BoolSetting>(4, paths.skinning, false);
+	config.insert<vkb::BoolSetting>(5, paths.skinning, false);
+	config.insert<vkb::BoolSetting>(6, paths.skinning, false);
+	config.insert<vkb::BoolSetting>(7, paths.skinning, true);
+}
+
+GeometryPaths::~GeometryPaths()
+{
+	if (has_device())
+	{
+		// The bindless array is destroyed before the render pipeline binding it
+		get_device().wait_idle();
+	}
+}
+
+void GeometryPaths::request_gpu_features(vkb::PhysicalDevice &gpu)
+{
+	buffer_device_address = REQUEST_OPTIONAL_FEATURE(gpu,
+	                                                 VkPhysicalDeviceBufferDeviceAddressFeaturesKHR,
+	                                                 VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR,
+	                                                 bufferDeviceAddress);
+
+	conditional_rendering = REQUEST_OPTIONAL_FEATURE(gpu,
+	                                                 VkPhysicalDeviceConditionalRenderingFeaturesEXT,
+	                                                 VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT,
+	                                                 conditionalRendering);
+
+	descriptor_indexing = REQUEST_OPTIONAL_FEATURE(gpu,
+	                                               VkPhysicalDeviceDescriptorIndexingFeaturesEXT,
+	                                               VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+	                                               descriptorBindingSampledImageUpdateAfterBind);
+	descriptor_indexing &= REQUEST_OPTIONAL_FEATURE(gpu,
+	                                                VkPhysicalDeviceDescriptorIndexingFeaturesEXT,
+	                                                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+	                                                descriptorBindingPartiallyBound);
+}
+
+bool GeometryPaths::prepare(const vkb::ApplicationOptions &options)
+{
+	if (!vkb::VulkanSampleC::prepare(options))
+	{
+		return false;
+	}
+
+	// The vertex buffers are created with their addresses when they can be pulled, whether or not vertex pulling is selected
+	load_scene("scenes/bonza/Bonza4X.gltf", buffer_device_address ? VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT : 0);
+
+	auto &camera_node = vkb::add_free_camera(get_scene(), "main_camera", get_render_context().get_surface_extent());
+	camera            = &camera_node.get_component<vkb::sg::Camera>();
+
+	for (auto *sub_mesh : get_scene().get_components<vkb::sg::SubMesh>())
+	{
+		loaded_variants.emplace(sub_mesh, sub_mesh->get_shader_variant());
+	}
+
+	if (descriptor_indexing)
+	{
+		try
+		{
+			bindless_registry = std::make_unique<vkb::BindlessRegistry>(get_device());
+		}
+		catch (const std::runtime_error &e)
+		{
+			LOGW("Bindless textures are not available: {}", e.what());
+		}
+	}
+
+	order_independent_transparency = std::make_unique<vkb::OrderIndependentTransparency>(get_render_context());
+
+	// The skinning pass fetches the vertices through the addresses the vertex buffers were created with
+	if (buffer_device_address)
+	{
+		skinning_pass = std::make_unique<vkb::SkinningPass>(get_render_context(), get_scene());
+		skinning_pass->prepare();
+
+		for (auto &loaded_variant : loaded_variants)
+		{
+			skinned_sub_mesh_count += skinning_pass->is_skinned(*loaded_variant.first) ? 1 : 0;
+		}
+	}
+
+	set_render_pipeline(create_render_pipeline());
+	last_paths = paths;
+
+	get_stats().request_stats({vkb::StatIndex::frame_times, vkb::StatIndex::cpu_cycles});
+	create_gui(*window, &get_stats());
+
+	return true;
+}
+
+std::unique_ptr<vkb::RenderPipeline> GeometryPaths::create_render_pipeline()
+{
+	// The subpass being replaced added the definitions of its paths to the variants
+	for (auto &loaded_variant : loaded_variants)
+	{
+		loaded_variant.first->get_mut_shader_variant() = loaded_variant.second;
+	}
+
+	vkb::ShaderSource vert_shader("base.vert");
+	vkb::ShaderSource frag_shader("base.frag");
+	auto              scene_subpass = std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(vert_shader), std::move(frag_shader), get_scene(), *camera);
+
+	// The paths add their definitions to the variants, so they are selected before the subpass is prepared
+	// Both select the world matrix with the instance index
+	if (paths.instancing)
+	{
+		scene_subpass->enable_instancing();
+	}
+	else if (paths.gpu_scene)
+	{
+		scene_subpass->enable_gpu_scene();
+	}
+
+	// The skinned streams are selected before the vertex pulling reads them
+	if (paths.skinning && skinning_pass)
+	{
+		scene_subpass->set_skinning_pass(*skinning_pass);
+	}
+
+	if (paths.vertex_pulling && buffer_device_address)
+	{
+		scene_subpass->enable_vertex_pulling();
+	}
+
+	// A batched draw covers several nodes, so the draws are only predicated without instancing
+	if (paths.conditional_rendering && conditional_rendering && !paths.instancing)
+	{
+		scene_subpass->enable_conditional_rendering();
+	}
+
+	if (paths.bindless && bindless_registry)
+	{
+		scene_subpass->set_bindless_registry(*bindless_registry);
+	}
+
+	if (paths.order_independent_transparency)
+	{
+		scene_subpass->set_order_independent_transparency(*order_independent_transparency);
+	}
+
+	auto render_pipeline = std::make_unique<vkb::RenderPipeline>();
+	render_pipeline->add_subpass(std::move(scene_subpass));
+
+	// The composite must follow the subpass storing the fragments
+	if (paths.order_independent_transparency)
+	{
+		render_pipeline->add_subpass(std::make_unique<vkb::OITCompositeSubpass>(get_render_context(),
+		                                                                        vkb::ShaderSource{"postprocessing/postprocessing.vert"},
+		                                                                        vkb::ShaderSource{"oit/composite.frag"},
+		                                                                        *order_independent_transparency));
+	}
+
+	return render_pipeline;
+}
+
+void GeometryPaths::update(float delta_time)
+{
+	if (paths != last_paths)
+	{
+		// The resources of the paths being replaced may still be in use
+		get_device().wait_idle();
+
+		set_render_pipeline(create_render_pipeline());
+		last_paths = paths;
+	}
+
+	VulkanSample::update(delta_time);
+}
+
+void GeometryPaths::draw_gui()
+{
+	get_gui().show_options_window(
+	    /* body = */ [this]() {
+		    // Instancing and the GPU scene both select the world matrix with the instance index
+		    if (ImGui::Checkbox("Instancing", &paths.instancing) && paths.instancing)
+		    {
+			    paths.gpu_scene             = false;
+			    paths.conditional_rendering = false;
+		    }
+		    ImGui::SameLine();
+		    if (ImGui::Checkbox("GPU scene", &paths.gpu_scene) && paths.gpu_scene)
+		    {
+			    paths.instancing = false;
+		    }
+		    if (buffer_device_address)
+		    {
+			    ImGui::SameLine();
+			    ImGui::Checkbox("Vertex pulling", &paths.vertex_pulling);
+		    }
+		    if (conditional_rendering)
+		    {
+			    ImGui::SameLine();
+			    if (ImGui::Checkbox("Conditional rendering", &paths.conditional_rendering) && paths.conditional_rendering)
+			    {
+				    paths.instancing = false;
+			    }
+		    }
+
+		    // The paths changing the shading go on a second line
+		    if (bindless_registry)
+		    {
+			    ImGui::Checkbox("Bindless textures", &paths.bindless);
+			    ImGui::SameLine();
+		    }
+		    ImGui::Checkbox("OIT", &paths.order_independent_transparency);
+		    if (skinning_pass)
+		    {
+			    ImGui::SameLine();
+			    ImGui::Checkbox("GPU skinning", &paths.skinning);
+			    ImGui::SameLine();
+			    ImGui::Text("(%zu skinned sub meshes)", skinned_sub_mesh_count);
+		    }
+
+		    if (last_paths.order_independent_transparency)
+		    {
+			    const auto &oit_stats = order_independent_transparency->get_stats();
+			    ImGui::Text("Transparent fragments: %u, dropped: %u in %u pixels",
+			                oit_stats.fragment_count, oit_stats.overflow_fragment_count, oit_stats.overflow_pixel_count);
+		    }
+	    },
+	    /* lines = */ last_paths.order_independent_transparency ? 3 : 2);
+}
+
+std::unique_ptr<vkb::VulkanSampleC> create_geometry_paths()
+{
+	return std::make_unique<GeometryPaths>();
+}
@@ -0,0 +1,125 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+#include "core/shader_module.h"
+#include "rendering/bindless_registry.h"
+#include "rendering/order_independent_transparency.h"
+#include "rendering/render_pipeline.h"
+#include "rendering/skinning_pass.h"
+#include "scene_graph/components/camera.h"
+#include "vulkan_sample.h"
+
+namespace vkb
+{
+namespace sg
+{
+class SubMesh;
+}        // namespace sg
+}        // namespace vkb
+
+/**
+ * @brief Switches the geometry subpass between the ways it can draw a scene
+ *
+ * Each option selects a path of the vkb::GeometrySubpass drawing the scene, and the render pipeline is rebuilt
+ * whenever one changes, so that the paths can be compared on the same frames.
+ */
+class GeometryPaths : public vkb::VulkanSampleC
+{
+  public:
+	GeometryPaths();
+
+	virtual ~GeometryPaths();
+
+	virtual bool prepare(const vkb::ApplicationOptions &options) override;
+
+	virtual void request_gpu_features(vkb::PhysicalDevice &gpu) override;
+
+	virtual void update(float delta_time) override;
+
+  private:
+	/**
+	 * @brief The paths of the subpass selected in the options
+	 */
+	struct Paths
+	{
+		/// Draws the nodes sharing a sub mesh with a single instanced draw, see GeometrySubpass::enable_instancing
+		bool instancing{false};
+
+		/// Keeps the world matrices in a buffer updated as the nodes move, see GeometrySubpass::enable_gpu_scene
+		bool gpu_scene{false};
+
+		/// Fetches the vertex attributes through their buffer device addresses, see GeometrySubpass::enable_vertex_pulling
+		bool vertex_pulling{false};
+
+		/// Skips the draws of the nodes hidden in the previous frame, see GeometrySubpass::enable_conditional_rendering
+		bool conditional_rendering{false};
+
+		/// Reads the base color textures from a bindless array, see GeometrySubpass::set_bindless_registry
+		bool bindless{false};
+
+		/// Stores the blended fragments in a k-buffer sorted by a composite, see GeometrySubpass::set_order_independent_transparency
+		bool order_independent_transparency{false};
+
+		/// Draws the skinned sub meshes with the vertices skinned by a compute pass, see GeometrySubpass::set_skinning_pass
+		bool skinning{false};
+
+		bool operator!=(const Paths &other) const;
+	};
+
+	virtual void draw_gui() override;
+
+	/**
+	 * @brief Creates a forward render pipeline drawing the scene with the selected paths
+	 */
+	std::unique_ptr<vkb::RenderPipeline> create_render_pipeline();
+
+	vkb::sg::Camera *camera{nullptr};
+
+	/// Whether the bufferDeviceAddress feature is enabled, the vertex buffers can then be pulled
+	bool buffer_device_address{false};
+
+	/// Whether the conditionalRendering feature is enabled, the draws can then be predicated
+	bool conditional_rendering{false};
+
+	/// Whether the features of the bindless array are enabled
+	bool descriptor_indexing{false};
+
+	/// Bindless array shared by the subpasses created, null if it can't be created on the device
+	std::unique_ptr<vkb::BindlessRegistry> bindless_registry;
+
+	/// K-buffer shared by the subpasses created
+	std::unique_ptr<vkb::OrderIndependentTransparency> order_independent_transparency;
+
+	/// Skins the sub meshes of the scene, null without the bufferDeviceAddress feature it fetches the vertices with
+	std::unique_ptr<vkb::SkinningPass> skinning_pass;
+
+	/// Number of sub meshes the skinning pass skins
+	size_t skinned_sub_mesh_count{0};
+
+	/// Shader variants of the sub meshes as loaded, restored before each rebuild as the paths add their definitions to them
+	std::unordered_map<vkb::sg::SubMesh *, vkb::ShaderVariant> loaded_variants;
+
+	Paths paths;
+
+	Paths last_paths;
+};
+
+std::unique_ptr<vkb::VulkanSampleC> create_geometry_paths();
@@ -0,0 +1,558 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gpu_microbenchmarks.h"
+
+#include <algorithm>
+
+#include "gui.h"
+#include "rendering/gpu_frame_timer.h"
+#include "stats/stats.h"
+
+namespace
+{
+constexpr VkDeviceSize MiB = 1024 * 1024;
+
+/// Buffer sizes of the bandwidth microbenchmarks, in and out of the caches of most devices
+constexpr VkDeviceSize BandwidthSizes[] = {4 * MiB, 64 * MiB};
+
+constexpr VkDeviceSize BandwidthBufferSize = 64 * MiB;
+
+constexpr uint32_t TextureSize = 1024;
+
+/// Fetches per invocation of texture_fetch.comp
+constexpr uint32_t FetchCount = 16;
+
+constexpr VkExtent2D FillExtent = {1920, 1080};
+
+/// Full screen triangles per fill microbenchmark
+constexpr uint32_t FillLayers = 16;
+
+/// Invocations and iterations of alu.comp, eight vec4 fma a iteration
+constexpr uint32_t AluWorkgroups = 4096;
+
+constexpr uint32_t AluIterations = 256;
+
+constexpr uint32_t SubmissionCalls = 1000;
+
+/**
+ * @brief Waits for the commands before, so that a microbenchmark runs alone between its timestamps
+ */
+void wait_for_previous_commands(vkb::CommandBuffer &command_buffer)
+{
+	command_buffer.flush_barriers();
+
+	VkMemoryBarrier memory_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+	memory_barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+	vkCmdPipelineBarrier(command_buffer.get_handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+	                     1, &memory_barrier, 0, nullptr, 0, nullptr);
+}
+
+std::string get_size_name(VkDeviceSize size)
+{
+	return std::to_string(size / MiB) + " MiB";
+}
+}        // namespace
+
+GpuMicrobenchmarks::GpuMicrobenchmarks()
+{
+	// The fp16 arithmetic microbenchmark only runs if the device supports it
+	add_instance_extension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, true);
+	add_device_extension(VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME, true);
+}
+
+void GpuMicrobenchmarks::request_gpu_features(vkb::PhysicalDevice &gpu)
+{
+	fp16_supported = REQUEST_OPTIONAL_FEATURE(gpu,
+	                                          VkPhysicalDeviceFloat16Int8FeaturesKHR,
+	                                          VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FLOAT16_INT8_FEATURES_KHR,
+	                                          shaderFloat16);
+
+	// The compressed formats fetched, if supported
+	auto &features = gpu.get_features();
+	auto &requested = gpu.get_mutable_requested_features();
+
+	requested.textureCompressionBC       = features.textureCompressionBC;
+	requested.textureCompressionETC2     = features.textureCompressionETC2;
+	requested.textureCompressionASTC_LDR = features.textureCompressionASTC_LDR;
+}
+
+bool GpuMicrobenchmarks::prepare(const vkb::ApplicationOptions &options)
+{
+	if (!VulkanSample::prepare(options))
+	{
+		return false;
+	}
+
+	if (!get_render_context().enable_gpu_frame_timing())
+	{
+		LOGE("The microbenchmarks are timed with timestamps, which the graphics queue doesn't support");
+		return false;
+	}
+
+	get_stats().request_stats({vkb::StatIndex::frame_times, vkb::StatIndex::gpu_time});
+	create_gui(*window, &get_stats());
+
+	load_store_infos.resize(2);
+	load_store_infos[0].load_op  = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	load_store_infos[0].store_op = VK_ATTACHMENT_STORE_OP_STORE;
+	load_store_infos[1].load_op  = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	load_store_infos[1].store_op = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+	clear_values.resize(2);
+	clear_values[0].color        = {{0.0f, 0.0f, 0.0f, 1.0f}};
+	clear_values[1].depthStencil = {1.0f, 0};
+
+	auto &device = get_device();
+
+	VkBufferUsageFlags buffer_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	source_buffer      = std::make_unique<vkb::core::BufferC>(device, BandwidthBufferSize, buffer_usage, VMA_MEMORY_USAGE_GPU_ONLY);
+	destination_buffer = std::make_unique<vkb::core::BufferC>(device, BandwidthBufferSize, buffer_usage, VMA_MEMORY_USAGE_GPU_ONLY);
+	result_buffer      = std::make_unique<vkb::core::BufferC>(device, 64 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+	add_bandwidth_microbenchmarks();
+	add_texture_microbenchmarks();
+	add_fill_microbenchmarks();
+	add_alu_microbenchmarks();
+	add_submission_microbenchmarks();
+
+	gui_subpasses.push_back(std::make_unique<FillSubpass>(get_render_context(),
+	                                                      vkb::ShaderSource{"gpu_microbenchmarks/fullscreen.vert"},
+	                                                      vkb::ShaderSource{"gpu_microbenchmarks/fill.frag"}));
+
+	for (auto &subpass : fill_subpasses)
+	{
+		subpass->prepare();
+	}
+	gui_subpasses.front()->prepare();
+
+	LOGI("Running {} GPU microbenchmarks, {} per frame", microbenchmarks.size(), vkb::GpuFrameTimer::MaxPasses);
+
+	return true;
+}
+
+void GpuMicrobenchmarks::add_bandwidth_microbenchmarks()
+{
+	auto &resource_cache = get_device().get_resource_cache();
+
+	auto &module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, vkb::ShaderSource{"gpu_microbenchmarks/bandwidth.comp"});
+	auto *layout = &resource_cache.RequestPipelineLayout({&module});
+
+	for (auto size : BandwidthSizes)
+	{
+		// Read and written
+		microbenchmarks.push_back({"Buffer copy " + get_size_name(size), [this, size](vkb::CommandBuffer &command_buffer) {
+			                           command_buffer.copy_buffer(*source_buffer, *destination_buffer, size);
+		                           },
+		                           2.0 * size, "GB/s"});
+
+		for (uint32_t mode : {0u, 1u})
+		{
+			microbenchmarks.push_back({(mode == 0 ? "Buffer read " : "Buffer write ") + get_size_name(size), [this, layout, mode, size](vkb::CommandBuffer &command_buffer) {
+				                           auto count = vkb::to_u32(size / sizeof(glm::vec4));
+
+				                           command_buffer.bind_pipeline_layout(*layout);
+				                           command_buffer.set_specialization_constant(0, mode);
+				                           command_buffer.bind_buffer(*source_buffer, 0, size, 0, 0, 0);
+				                           command_buffer.bind_buffer(*result_buffer, 0, result_buffer->get_size(), 0, 1, 0);
+				                           command_buffer.push_constants(count);
+
+				                           // Four vec4 per invocation, workgroups of 256
+				                           command_buffer.dispatch(std::max(count / 1024, 1u), 1, 1);
+			                           },
+			                           static_cast<double>(size), "GB/s"});
+		}
+	}
+}
+
+void GpuMicrobenchmarks::add_texture_microbenchmarks()
+{
+	auto &device   = get_device();
+	auto &gpu      = device.get_gpu();
+	auto &features = gpu.get_features();
+
+	struct TextureFormat
+	{
+		VkFormat format;
+
+		const char *name;
+
+		VkBool32 supported;
+	};
+
+	const TextureFormat formats[] = {{VK_FORMAT_R8G8B8A8_UNORM, "RGBA8", VK_TRUE},
+	                                 {VK_FORMAT_R16G16B16A16_SFLOAT, "RGBA16F", VK_TRUE},
+	                                 {VK_FORMAT_R32G32B32A32_SFLOAT, "RGBA32F", VK_TRUE},
+	                                 {VK_FORMAT_BC1_RGBA_UNORM_BLOCK, "BC1", features.textureCompressionBC},
+	                                 {VK_FORMAT_BC7_UNORM_BLOCK, "BC7", features.textureCompressionBC},
+	                                 {VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, "ETC2", features.textureCompressionETC2},
+	                                 {VK_FORMAT_ASTC_4x4_UNORM_BLOCK, "ASTC 4x4", features.textureCompressionASTC_LDR}};
+
+	VkSamplerCreateInfo sampler_create_info{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+	sampler_create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	sampler_create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	sampler_create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	sampler_create_info.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_create_info.magFilter    = VK_FILTER_NEAREST;
+	sampler_create_info.minFilter    = VK_FILTER_NEAREST;
+	nearest_sampler                  = std::make_unique<vkb::core::Sampler>(device, sampler_create_info);
+
+	sampler_create_info.magFilter = VK_FILTER_LINEAR;
+	sampler_create_info.minFilter = VK_FILTER_LINEAR;
+	linear_sampler                = std::make_unique<vkb::core::Sampler>(device, sampler_create_info);
+
+	auto &resource_cache = device.get_resource_cache();
+
+	auto &module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, vkb::ShaderSource{"gpu_microbenchmarks/texture_fetch.comp"});
+	auto *layout = &resource_cache.RequestPipelineLayout({&module});
+
+	// The contents of the textures don't change the rate, they are copied from the zeroed source buffer
+	auto &command_buffer = device.request_command_buffer();
+	command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, VK_NULL_HANDLE);
+
+	command_buffer.flush_barriers();
+	vkCmdFillBuffer(command_buffer.get_handle(), source_buffer->get_handle(), 0, VK_WHOLE_SIZE, 0);
+
+	vkb::BufferMemoryBarrier buffer_barrier;
+	buffer_barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	buffer_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	buffer_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	buffer_barrier.dst_access_mask = VK_ACCESS_TRANSFER_READ_BIT;
+	command_buffer.buffer_memory_barrier(*source_buffer, 0, VK_WHOLE_SIZE, buffer_barrier);
+
+	for (auto &texture_format : formats)
+	{
+		auto format_features = gpu.get_format_properties(texture_format.format).optimalTilingFeatures;
+		if (!texture_format.supported || !(format_features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+		{
+			LOGI("Skipping the texture fetch microbenchmarks of {}, unsupported", texture_format.name);
+			continue;
+		}
+
+		textures.push_back(std::make_unique<vkb::core::Image>(device, VkExtent3D{TextureSize, TextureSize, 1}, texture_format.format,
+		                                                      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY));
+		auto &texture = *textures.back();
+
+		texture_views.push_back(std::make_unique<vkb::core::ImageView>(texture, VK_IMAGE_VIEW_TYPE_2D));
+		auto *view = texture_views.back().get();
+
+		vkb::ImageMemoryBarrier barrier;
+		barrier.src_stage_mask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		barrier.dst_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.new_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		command_buffer.image_memory_barrier(*view, barrier);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+		region.imageExtent      = texture.get_extent();
+		command_buffer.copy_buffer_to_image(*source_buffer, texture, {region});
+
+		barrier.src_stage_mask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.old_layout      = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.new_layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		command_buffer.image_memory_barrier(*view, barrier);
+
+		bool linear = format_features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+		for (auto *sampler : {nearest_sampler.get(), linear ? linear_sampler.get() : nullptr})
+		{
+			if (!sampler)
+			{
+				continue;
+			}
+
+			auto name = std::string{"Fetch "} + texture_format.name + (sampler == linear_sampler.get() ? " linear" : " nearest");
+
+			microbenchmarks.push_back({name, [this, layout, view, sampler](vkb::CommandBuffer &command_buffer) {
+				                           command_buffer.bind_pipeline_layout(*layout);
+				                           command_buffer.set_specialization_constant(0, FetchCount);
+				                           command_buffer.bind_image(*view, *sampler, 0, 0, 0);
+				                           command_buffer.bind_buffer(*result_buffer, 0, result_buffer->get_size(), 0, 1, 0);
+
+				                           // An invocation per texel, workgroups of 8x8
+				                           command_buffer.dispatch(TextureSize / 8, TextureSize / 8, 1);
+			                           },
+			                           static_cast<double>(TextureSize) * TextureSize * FetchCount, "Gtexel/s"});
+		}
+	}
+
+	command_buffer.end();
+
+	auto &queue = device.get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+	queue.submit(command_buffer, device.request_fence());
+	device.get_fence_pool().wait();
+}
+
+void GpuMicrobenchmarks::add_fill_microbenchmarks()
+{
+	auto &device = get_device();
+
+	fill_load_store_infos.resize(1);
+	fill_load_store_infos[0].load_op  = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	fill_load_store_infos[0].store_op = VK_ATTACHMENT_STORE_OP_STORE;
+
+	fill_clear_values.resize(1);
+	fill_clear_values[0].color = {{0.0f, 0.0f, 0.0f, 0.0f}};
+
+	fill_subpasses.push_back(std::make_unique<FillSubpass>(get_render_context(),
+	                                                       vkb::ShaderSource{"gpu_microbenchmarks/fullscreen.vert"},
+	                                                       vkb::ShaderSource{"gpu_microbenchmarks/fill.frag"}));
+	auto *subpass = static_cast<FillSubpass *>(fill_subpasses.back().get());
+
+	struct FillFormat
+	{
+		VkFormat format;
+
+		const char *name;
+	};
+
+	for (auto &fill_format : {FillFormat{VK_FORMAT_R8G8B8A8_UNORM, "RGBA8"}, FillFormat{VK_FORMAT_R16G16B16A16_SFLOAT, "RGBA16F"}})
+	{
+		auto format_features = device.get_gpu().get_format_properties(fill_format.format).optimalTilingFeatures;
+		if (!(format_features & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT))
+		{
+			LOGI("Skipping the fill microbenchmarks of {}, unsupported", fill_format.name);
+			continue;
+		}
+
+		std::vector<vkb::core::Image> images;
+		images.emplace_back(device, VkExtent3D{FillExtent.width, FillExtent.height, 1}, fill_format.format,
+		                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		fill_targets.push_back(std::make_unique<vkb::RenderTarget>(std::move(images)));
+		auto *fill_target = fill_targets.back().get();
+
+		for (bool blend : {false, true})
+		{
+			auto name = std::string{"Fill "} + fill_format.name + (blend ? " blend" : " opaque");
+
+			microbenchmarks.push_back({name, [this, subpass, fill_target, blend](vkb::CommandBuffer &command_buffer) {
+				                           subpass->blend      = blend;
+				                           subpass->draw_count = FillLayers;
+
+				                           command_buffer.begin_render_pass(*fill_target, fill_load_store_infos, fill_clear_values, fill_subpasses);
+				                           command_buffer.set_viewport(0, {{0.0f, 0.0f, static_cast<float>(FillExtent.width), static_cast<float>(FillExtent.height), 0.0f, 1.0f}});
+				                           command_buffer.set_scissor(0, {{{0, 0}, FillExtent}});
+				                           subpass->draw(command_buffer);
+				                           command_buffer.end_render_pass();
+			                           },
+			                           static_cast<double>(FillExtent.width) * FillExtent.height * FillLayers, "Gpixel/s"});
+		}
+	}
+}
+
+void GpuMicrobenchmarks::add_alu_microbenchmarks()
+{
+	auto &resource_cache = get_device().get_resource_cache();
+
+	// Two operations per fma
+	double operations = 2.0 * AluWorkgroups * 64 * AluIterations * 8 * 4;
+
+	for (bool fp16 : {false, true})
+	{
+		if (fp16 && !fp16_supported)
+		{
+			LOGI("Skipping the fp16 arithmetic microbenchmark, shaderFloat16 is unsupported");
+			continue;
+		}
+
+		vkb::ShaderVariant variant;
+		if (fp16)
+		{
+			variant.add_define("FP16");
+		}
+
+		auto &module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, vkb::ShaderSource{"gpu_microbenchmarks/alu.comp"}, variant);
+		auto *layout = &resource_cache.RequestPipelineLayout({&module});
+
+		microbenchmarks.push_back({fp16 ? "ALU fp16" : "ALU fp32", [this, layout](vkb::CommandBuffer &command_buffer) {
+			                           command_buffer.bind_pipeline_layout(*layout);
+			                           command_buffer.set_specialization_constant(0, AluIterations);
+			                           command_buffer.bind_buffer(*result_buffer, 0, result_buffer->get_size(), 0, 0, 0);
+			                           command_buffer.push_constants(0.0f);
+			                           command_buffer.dispatch(AluWorkgroups, 1, 1);
+		                           },
+		                           operations, "GFLOP/s"});
+	}
+}
+
+void GpuMicrobenchmarks::add_submission_microbenchmarks()
+{
+	auto &resource_cache = get_device().get_resource_cache();
+
+	auto &module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, vkb::ShaderSource{"gpu_microbenchmarks/empty.comp"});
+	auto *layout = &resource_cache.RequestPipelineLayout({&module});
+
+	microbenchmarks.push_back({std::to_string(SubmissionCalls) + " dispatches", [this, layout](vkb::CommandBuffer &command_buffer) {
+		                           command_buffer.bind_pipeline_layout(*layout);
+		                           command_buffer.bind_buffer(*result_buffer, 0, result_buffer->get_size(), 0, 0, 0);
+		                           for (uint32_t i = 0; i < SubmissionCalls; ++i)
+		                           {
+			                           command_buffer.dispatch(1, 1, 1);
+		                           }
+	                           },
+	                           SubmissionCalls, nullptr});
+
+	if (fill_targets.empty())
+	{
+		return;
+	}
+
+	auto *subpass = static_cast<FillSubpass *>(fill_subpasses.back().get());
+
+	// A single pixel each, so that the draws cost more than their fragments
+	microbenchmarks.push_back({std::to_string(SubmissionCalls) + " draws", [this, subpass](vkb::CommandBuffer &command_buffer) {
+		                           subpass->blend      = false;
+		                           subpass->draw_count = SubmissionCalls;
+
+		                           command_buffer.begin_render_pass(*fill_targets.front(), fill_load_store_infos, fill_clear_values, fill_subpasses);
+		                           command_buffer.set_viewport(0, {{0.0f, 0.0f, static_cast<float>(FillExtent.width), static_cast<float>(FillExtent.height), 0.0f, 1.0f}});
+		                           command_buffer.set_scissor(0, {{{0, 0}, {1, 1}}});
+		                           subpass->draw(command_buffer);
+		                           command_buffer.end_render_pass();
+	                           },
+	                           SubmissionCalls, nullptr});
+}
+
+GpuMicrobenchmarks::FillSubpass::FillSubpass(vkb::RenderContext &context, vkb::ShaderSource &&vertex_source, vkb::ShaderSource &&fragment_source) :
+    vkb::rendering::SubpassC(context, std::move(vertex_source), std::move(fragment_source))
+{
+	set_output_attachments({0});
+}
+
+void GpuMicrobenchmarks::FillSubpass::prepare()
+{
+	auto &resource_cache  = get_render_context().get_device().get_resource_cache();
+	auto &vertex_module   = resource_cache.RequestShaderModule(VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader());
+	auto &fragment_module = resource_cache.RequestShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader());
+	layout                = &resource_cache.RequestPipelineLayout({&vertex_module, &fragment_module});
+}
+
+void GpuMicrobenchmarks::FillSubpass::draw(vkb::CommandBuffer &command_buffer)
+{
+	command_buffer.bind_pipeline_layout(*layout);
+
+	vkb::DepthStencilState depth_stencil_state{};
+	depth_stencil_state.depth_test_enable  = VK_FALSE;
+	depth_stencil_state.depth_write_enable = VK_FALSE;
+	command_buffer.set_depth_stencil_state(depth_stencil_state);
+
+	vkb::ColorBlendAttachmentState blend_attachment{};
+	blend_attachment.blend_enable           = blend;
+	blend_attachment.src_color_blend_factor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blend_attachment.dst_color_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blend_attachment.src_alpha_blend_factor = VK_BLEND_FACTOR_ONE;
+	blend_attachment.dst_alpha_blend_factor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+
+	vkb::ColorBlendState color_blend_state{};
+	color_blend_state.attachments = {blend_attachment};
+	command_buffer.set_color_blend_state(color_blend_state);
+
+	command_buffer.push_constants(glm::vec4(0.1f, 0.2f, 0.3f, 0.25f));
+
+	for (uint32_t i = 0; i < draw_count; ++i)
+	{
+		command_buffer.draw(3, 1, 0, 0);
+	}
+}
+
+void GpuMicrobenchmarks::collect_times()
+{
+	auto *gpu_frame_timer = get_render_context().get_gpu_frame_timer();
+	if (!gpu_frame_timer)
+	{
+		return;
+	}
+
+	for (auto &pass : gpu_frame_timer->get_pass_times())
+	{
+		auto it = std::find_if(microbenchmarks.begin(), microbenchmarks.end(), [&pass](const Microbenchmark &microbenchmark) { return microbenchmark.name == pass.name; });
+		if (it != microbenchmarks.end())
+		{
+			it->time = pass.time;
+		}
+	}
+}
+
+void GpuMicrobenchmarks::draw_renderpass(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
+{
+	collect_times();
+
+	auto *gpu_frame_timer = get_render_context().get_gpu_frame_timer();
+	auto  frame_index     = get_render_context().get_active_frame_index();
+
+	// As many as the frame timer times, the next frames run the following ones
+	size_t count = std::min<size_t>(microbenchmarks.size(), vkb::GpuFrameTimer::MaxPasses);
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto &microbenchmark = microbenchmarks[(next_microbenchmark + i) % microbenchmarks.size()];
+
+		wait_for_previous_commands(command_buffer);
+
+		auto pass = gpu_frame_timer->begin_pass(command_buffer.get_handle(), frame_index, microbenchmark.name);
+		microbenchmark.record(command_buffer);
+		command_buffer.flush_barriers();
+		gpu_frame_timer->end_pass(command_buffer.get_handle(), frame_index, pass);
+	}
+	next_microbenchmark = (next_microbenchmark + count) % microbenchmarks.size();
+
+	wait_for_previous_commands(command_buffer);
+
+	command_buffer.begin_render_pass(render_target, load_store_infos, clear_values, gui_subpasses);
+	command_buffer.set_viewport(0, {{0.0f, 0.0f, static_cast<float>(render_target.get_extent().width), static_cast<float>(render_target.get_extent().height), 0.0f, 1.0f}});
+	command_buffer.set_scissor(0, {{{0, 0}, render_target.get_extent()}});
+
+	get_gui().draw(command_buffer);
+	command_buffer.end_render_pass();
+}
+
+void GpuMicrobenchmarks::draw_gui()
+{
+	get_gui().show_options_window(
+	    /* body = */ [this]() {
+		    for (auto &microbenchmark : microbenchmarks)
+		    {
+			    if (microbenchmark.time <= 0.0f)
+			    {
+				    ImGui::Text("%-24s -", microbenchmark.name.c_str());
+			    }
+			    else if (microbenchmark.rate_unit)
+			    {
+				    // Work per nanosecond, e.g. bytes per nanosecond are GB/s
+				    double rate = microbenchmark.work / (static_cast<double>(microbenchmark.time) * 1e6);
+				    ImGui::Text("%-24s %8.3f ms %10.2f %s", microbenchmark.name.c_str(), microbenchmark.time, rate, microbenchmark.rate_unit);
+			    }
+			    else
+			    {
+				    double per_call = static_cast<double>(microbenchmark.time) * 1e3 / microbenchmark.work;
+				    ImGui::Text("%-24s %8.3f ms %10.3f us/call", microbenchmark.name.c_str(), microbenchmark.time, per_call);
+			    }
+		    }
+	    },
+	    /* lines = */ vkb::to_u32(microbenchmarks.size()));
+}
+
+std::unique_ptr<vkb::VulkanSampleC> create_gpu_microbenchmarks()
+{
+	return std::make_unique<GpuMicrobenchmarks>();
+}
@@ -0,0 +1,142 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vulkan_sample.h"
+
+/**
+ * @brief Measures the raw capabilities of the device, to pick the code paths of a device from measured data
+ *
+ * Each microbenchmark is a pass timed with timestamp queries by the GPU frame timer of the render context: memory bandwidth
+ * with buffer copies, reads and writes at several sizes, texture fetch rate per format and filter, fill rate with and
+ * without blending, fp32 and fp16 arithmetic throughput, and the cost of dispatches and draws. The frame timer times a
+ * few passes per frame, so the frames cycle through the microbenchmarks.
+ *
+ * The times show in the options window, converted to rates. With --benchmark they are summarized in the passes of the
+ * benchmark report, by the name of each microbenchmark.
+ */
+class GpuMicrobenchmarks : public vkb::VulkanSampleC
+{
+  public:
+	GpuMicrobenchmarks();
+
+	virtual ~GpuMicrobenchmarks() = default;
+
+	virtual bool prepare(const vkb::ApplicationOptions &options) override;
+
+	virtual void request_gpu_features(vkb::PhysicalDevice &gpu) override;
+
+	virtual void draw_renderpass(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target) override;
+
+  private:
+	struct Microbenchmark
+	{
+		/// Name of the pass timing it
+		std::string name;
+
+		std::function<void(vkb::CommandBuffer &)> record;
+
+		/// Bytes, texels, pixels, operations or calls of a run
+		double work;
+
+		/// Unit of the rate shown, the work per nanosecond, or microseconds per call if null
+		const char *rate_unit;
+
+		/// GPU time of the last run in milliseconds, negative until measured
+		float time{-1.0f};
+	};
+
+	/**
+	 * @brief Draws full screen triangles of a flat color, or a single call per draw with a one pixel scissor
+	 */
+	struct FillSubpass : vkb::rendering::SubpassC
+	{
+		FillSubpass(vkb::RenderContext &context, vkb::ShaderSource &&vertex_source, vkb::ShaderSource &&fragment_source);
+
+		virtual void prepare() override;
+
+		virtual void draw(vkb::CommandBuffer &command_buffer) override;
+
+		vkb::PipelineLayout *layout{nullptr};
+
+		bool blend{false};
+
+		uint32_t draw_count{1};
+	};
+
+	virtual void draw_gui() override;
+
+	void add_bandwidth_microbenchmarks();
+
+	void add_texture_microbenchmarks();
+
+	void add_fill_microbenchmarks();
+
+	void add_alu_microbenchmarks();
+
+	void add_submission_microbenchmarks();
+
+	/**
+	 * @brief Reads the times of the microbenchmarks from the last frame the GPU frame timer resolved, when a frame began
+	 */
+	void collect_times();
+
+	bool fp16_supported{false};
+
+	std::vector<Microbenchmark> microbenchmarks;
+
+	/// The first microbenchmark of the next frame
+	size_t next_microbenchmark{0};
+
+	std::unique_ptr<vkb::core::BufferC> source_buffer;
+
+	std::unique_ptr<vkb::core::BufferC> destination_buffer;
+
+	/// Written by the shaders only if their results are impossible, so that their work isn't optimized out
+	std::unique_ptr<vkb::core::BufferC> result_buffer;
+
+	std::vector<std::unique_ptr<vkb::core::Image>> textures;
+
+	std::vector<std::unique_ptr<vkb::core::ImageView>> texture_views;
+
+	std::unique_ptr<vkb::core::Sampler> nearest_sampler;
+
+	std::unique_ptr<vkb::core::Sampler> linear_sampler;
+
+	std::vector<std::unique_ptr<vkb::RenderTarget>> fill_targets;
+
+	std::vector<std::unique_ptr<vkb::rendering::SubpassC>> fill_subpasses;
+
+	/// Only describes the attachments of the swapchain render pass, the GUI is drawn in it
+	std::vector<std::unique_ptr<vkb::rendering::SubpassC>> gui_subpasses;
+
+	std::vector<vkb::LoadStoreInfo> fill_load_store_infos;
+
+	std::vector<VkClearValue> fill_clear_values;
+
+	std::vector<vkb::LoadStoreInfo> load_store_infos;
+
+	std::vector<VkClearValue> clear_values;
+};
+
+std::unique_ptr<vkb::VulkanSampleC> create_gpu_microbenchmarks();
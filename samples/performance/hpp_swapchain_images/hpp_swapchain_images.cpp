@@ -23,6 +23,9 @@
 
 HPPSwapchainImages::HPPSwapchainImages()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	auto &config = get_configuration();
 
 	config.insert<vkb::IntSetting>(0, swapchain_image_count, 3);
@@ -45,6 +48,7 @@ bool HPPSwapchainImages::prepare(const vkb::ApplicationOptions &options)
 	vkb::ShaderSource frag_shader("base.frag");
 	auto              scene_subpass = std::make_unique<vkb::rendering::subpasses::HPPForwardSubpass>(
         get_render_context(), std::move(vert_shader), std::move(frag_shader), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	auto render_pipeline = std::make_unique<vkb::rendering::HPPRenderPipeline>();
 	render_pipeline->add_subpass(std::move(scene_subpass));
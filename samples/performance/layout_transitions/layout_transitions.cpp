@@ -32,6 +32,9 @@
 
 LayoutTransitions::LayoutTransitions()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	auto &config = get_configuration();
 
 	config.insert<vkb::IntSetting>(0, reinterpret_cast<int &>(layout_transition_type), LayoutTransitionType::UNDEFINED);
@@ -53,8 +56,8 @@ bool LayoutTransitions::prepare(const vkb::ApplicationOptions &options)
 	auto geometry_vs = vkb::ShaderSource{"deferred/geometry.vert"};
 	auto geometry_fs = vkb::ShaderSource{"deferred/geometry.frag"};
 
-	std::unique_ptr<vkb::rendering::SubpassC> gbuffer_pass =
-	    std::make_unique<vkb::GeometrySubpass>(get_render_context(), std::move(geometry_vs), std::move(geometry_fs), get_scene(), *camera);
+	auto gbuffer_pass = std::make_unique<vkb::GeometrySubpass>(get_render_context(), std::move(geometry_vs), std::move(geometry_fs), get_scene(), *camera);
+	gbuffer_pass->set_frustum_culling(true);
 	gbuffer_pass->set_output_attachments({1, 2, 3});
 	gbuffer_pipeline.add_subpass(std::move(gbuffer_pass));
 	gbuffer_pipeline.set_load_store(vkb::gbuffer::get_clear_store_all());
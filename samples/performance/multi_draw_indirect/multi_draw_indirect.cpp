@@ -16,6 +16,8 @@
  */
 
 #include "multi_draw_indirect.h"
+
+#include "core/util/job_system.hpp"
 #include "gltf_loader.h"
 #include "ktx.h"
 #include "scene_graph/components/camera.h"
@@ -209,6 +211,11 @@ void MultiDrawIndirect::on_update_ui_overlay(vkb::Drawer &drawer)
 
 			memcpy(cpu_commands.data(), cpu_staging_buffer->get_data(), cpu_staging_buffer->get_size());
 		}
+		else
+		{
+			// The CPU culling writes the commands straight into the staging buffer
+			memcpy(cpu_commands.data(), cpu_staging_buffer->get_data(), cpu_staging_buffer->get_size());
+		}
 
 		for (auto &&cmd : cpu_commands)
 		{
@@ -899,18 +906,25 @@ void MultiDrawIndirect::cpu_cull()
 {
 	cpu_commands.resize(models.size());
 
-	VisibilityTester tester(scene_uniform.proj * scene_uniform.view);
-	for (size_t i = 0; i < models.size(); ++i)
+	// The draws only change by their instance count from a frame to the next, zero for the culled models
+	if (cpu_draws.size() != models.size())
 	{
-		// we control visibility by changing the instance count
-		auto                        &model = models[i];
-		VkDrawIndexedIndirectCommand cmd{};
-		cmd.firstIndex    = static_cast<uint32_t>(model.index_buffer_offset / (sizeof(model.triangles[0][0])));
-		cmd.indexCount    = static_cast<uint32_t>(model.triangles.size()) * 3;
-		cmd.vertexOffset  = static_cast<int32_t>(model.vertex_buffer_offset / sizeof(Vertex));
-		cmd.firstInstance = static_cast<uint32_t>(i);
-		cmd.instanceCount = tester.is_visible(model.bounding_sphere.center, model.bounding_sphere.radius);
-		cpu_commands[i]   = cmd;
+		cpu_draws.resize(models.size());
+		model_bounds.clear();
+
+		for (size_t i = 0; i < models.size(); ++i)
+		{
+			auto                        &model = models[i];
+			VkDrawIndexedIndirectCommand cmd{};
+			cmd.firstIndex    = static_cast<uint32_t>(model.index_buffer_offset / (sizeof(model.triangles[0][0])));
+			cmd.indexCount    = static_cast<uint32_t>(model.triangles.size()) * 3;
+			cmd.vertexOffset  = static_cast<int32_t>(model.vertex_buffer_offset / sizeof(Vertex));
+			cmd.firstInstance = static_cast<uint32_t>(i);
+			cmd.instanceCount = 1;
+			cpu_draws[i]      = cmd;
+
+			model_bounds.add(model.bounding_sphere.center, model.bounding_sphere.radius);
+		}
 	}
 
 	const auto call_buffer_size = cpu_commands.size() * sizeof(cpu_commands[0]);
@@ -921,8 +935,15 @@ void MultiDrawIndirect::cpu_cull()
 		cpu_staging_buffer = std::make_unique<vkb::core::BufferC>(get_device(), models.size() * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
 	}
 
-	cpu_staging_buffer->update(cpu_commands.data(), call_buffer_size, 0);
+	// Same planes as the culling shaders, the top and bottom ones are not tested
+	VisibilityTester                tester(scene_uniform.proj * scene_uniform.view);
+	const std::array<glm::vec4, 4> planes{tester.planes[0], tester.planes[1], tester.planes[4], tester.planes[5]};
+
+	// The models are split across the job system and their commands written directly into the mapped staging buffer
+	auto *commands = reinterpret_cast<VkDrawIndexedIndirectCommand *>(cpu_staging_buffer->map());
+	model_bounds.cull_draws(planes.data(), planes.size(), cpu_draws.data(), commands, &vkb::JobSystem::get());
 	cpu_staging_buffer->flush();
+	cpu_staging_buffer->unmap();
 
 	auto &transfer_cmd = get_device().get_command_pool().request_command_buffer();
 	transfer_cmd.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, VK_NULL_HANDLE);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "api_vulkan_sample.h"
+#include "geometry/bounding_sphere_batch.h"
 
 /**
  * @brief Offloading processes from CPU to GPU
@@ -131,6 +132,8 @@ class MultiDrawIndirect : public ApiVulkanSample
 	// CPU Draw Calls
 	void                                      cpu_cull();
 	std::vector<VkDrawIndexedIndirectCommand> cpu_commands;
+	std::vector<VkDrawIndexedIndirectCommand> cpu_draws;
+	vkb::BoundingSphereBatch                  model_bounds;
 	std::unique_ptr<vkb::core::BufferC>       cpu_staging_buffer;
 	std::unique_ptr<vkb::core::BufferC>       indirect_call_buffer;
 
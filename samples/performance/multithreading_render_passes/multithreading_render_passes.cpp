@@ -18,6 +18,7 @@
 #include "multithreading_render_passes.h"
 
 #include "common/vk_common.h"
+#include "core/util/job_system.hpp"
 #include "filesystem/legacy.h"
 #include "gltf_loader.h"
 #include "gui.h"
@@ -37,6 +38,8 @@ MultithreadingRenderPasses::MultithreadingRenderPasses()
 	config.insert<vkb::IntSetting>(1, multithreading_mode, 1);
 
 	config.insert<vkb::IntSetting>(2, multithreading_mode, 2);
+
+	config.insert<vkb::IntSetting>(3, multithreading_mode, 3);
 }
 
 void MultithreadingRenderPasses::request_gpu_features(vkb::PhysicalDevice &gpu)
@@ -91,7 +94,8 @@ bool MultithreadingRenderPasses::prepare(const vkb::ApplicationOptions &options)
 
 void MultithreadingRenderPasses::prepare_render_context()
 {
-	get_render_context().prepare(2);
+	// One thread per render pass, the main pass splits its draws between all of them in the ParallelDraws mode
+	get_render_context().prepare(4);
 }
 
 std::unique_ptr<vkb::RenderTarget> MultithreadingRenderPasses::create_shadow_render_target(uint32_t size)
@@ -135,6 +139,8 @@ std::unique_ptr<vkb::RenderPipeline> MultithreadingRenderPasses::create_main_ren
 	auto scene_subpass = std::make_unique<MainSubpass>(
 	    get_render_context(), std::move(main_vs), std::move(main_fs), get_scene(), *camera, *shadowmap_camera, shadow_render_targets);
 
+	main_subpass = scene_subpass.get();
+
 	// Main pipeline
 	auto main_render_pipeline = std::make_unique<vkb::RenderPipeline>();
 	main_render_pipeline->add_subpass(std::move(scene_subpass));
@@ -163,7 +169,7 @@ void MultithreadingRenderPasses::update(float delta_time)
 void MultithreadingRenderPasses::draw_gui()
 {
 	const bool landscape = reinterpret_cast<vkb::sg::PerspectiveCamera *>(camera)->get_aspect_ratio() > 1.0f;
-	uint32_t   lines     = landscape ? 2 : 4;
+	uint32_t   lines     = landscape ? 2 : 5;
 
 	get_gui().show_options_window(
 	    [this, landscape]() {
@@ -182,6 +188,11 @@ void MultithreadingRenderPasses::draw_gui()
 			    ImGui::SameLine();
 		    }
 		    ImGui::RadioButton("Secondary Buffers", &multithreading_mode, static_cast<int>(MultithreadingMode::SecondaryCommandBuffers));
+		    if (landscape)
+		    {
+			    ImGui::SameLine();
+		    }
+		    ImGui::RadioButton("Parallel Draws", &multithreading_mode, static_cast<int>(MultithreadingMode::ParallelDraws));
 	    },
 	    lines);
 }
@@ -193,14 +204,14 @@ std::vector<vkb::CommandBuffer *> MultithreadingRenderPasses::record_command_buf
 
 	std::vector<vkb::CommandBuffer *> command_buffers;
 
-	// Resources are requested from pools for thread #1 in shadow pass if multithreading is used
-	auto use_multithreading = multithreading_mode != static_cast<int>(MultithreadingMode::None);
+	// Resources are requested from pools for thread #1 in shadow pass if the passes are recorded in parallel
+	auto parallel_draws     = multithreading_mode == static_cast<int>(MultithreadingMode::ParallelDraws);
+	auto use_multithreading = multithreading_mode != static_cast<int>(MultithreadingMode::None) && !parallel_draws;
 	shadow_subpass->set_thread_index(use_multithreading ? 1 : 0);
 
-	if (use_multithreading && thread_pool.size() < 1)
-	{
-		thread_pool.resize(1);
-	}
+	// The main pass records its draws into secondary command buffers with the pools of all the threads,
+	// so the shadow pass is recorded before it
+	main_subpass->set_parallel_recording(parallel_draws);
 
 	switch (multithreading_mode)
 	{
@@ -234,12 +245,15 @@ void MultithreadingRenderPasses::record_separate_primary_command_buffers(std::ve
 	                                                                                             1);
 
 	// Recording shadow command buffer
-	auto shadow_buffer_future = thread_pool.push(
-	    [this, &shadow_command_buffer](size_t thread_id) {
+	auto           &jobs = vkb::JobSystem::get();
+	vkb::JobCounter shadow_recording;
+	jobs.schedule(
+	    [this, &shadow_command_buffer]() {
 		    shadow_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 		    draw_shadow_pass(shadow_command_buffer);
 		    shadow_command_buffer.end();
-	    });
+	    },
+	    &shadow_recording);
 
 	// Recording scene command buffer
 	main_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
@@ -250,7 +264,7 @@ void MultithreadingRenderPasses::record_separate_primary_command_buffers(std::ve
 	command_buffers.push_back(&main_command_buffer);
 
 	// Wait for recording
-	shadow_buffer_future.get();
+	jobs.wait(shadow_recording);
 }
 
 void MultithreadingRenderPasses::record_separate_secondary_command_buffers(std::vector<vkb::CommandBuffer *> &command_buffers, vkb::CommandBuffer &main_command_buffer)
@@ -281,12 +295,15 @@ void MultithreadingRenderPasses::record_separate_secondary_command_buffers(std::
 	auto &scene_framebuffer   = get_device().get_resource_cache().RequestFramebuffer(scene_render_target, scene_render_pass);
 
 	// Recording shadow command buffer
-	auto shadow_buffer_future = thread_pool.push(
-	    [this, &shadow_command_buffer, &shadow_render_pass, &shadow_framebuffer](size_t thread_id) {
+	auto           &jobs = vkb::JobSystem::get();
+	vkb::JobCounter shadow_recording;
+	jobs.schedule(
+	    [this, &shadow_command_buffer, &shadow_render_pass, &shadow_framebuffer]() {
 		    shadow_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &shadow_render_pass, &shadow_framebuffer, 0);
 		    draw_shadow_pass(shadow_command_buffer);
 		    shadow_command_buffer.end();
-	    });
+	    },
+	    &shadow_recording);
 
 	// Recording scene command buffer
 	vkb::ColorBlendState scene_color_blend_state;
@@ -298,7 +315,7 @@ void MultithreadingRenderPasses::record_separate_secondary_command_buffers(std::
 	scene_command_buffer.end();
 
 	// Wait for recording
-	shadow_buffer_future.get();
+	jobs.wait(shadow_recording);
 
 	// Recording main command buffer
 	main_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
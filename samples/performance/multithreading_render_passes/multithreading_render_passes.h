@@ -17,8 +17,6 @@
 
 #pragma once
 
-#include <ctpl_stl.h>
-
 #include "core/command_buffer.h"
 #include "rendering/render_pipeline.h"
 #include "rendering/subpasses/forward_subpass.h"
@@ -43,6 +41,7 @@ class MultithreadingRenderPasses : public vkb::VulkanSampleC
 		None                    = 0,
 		PrimaryCommandBuffers   = 1,
 		SecondaryCommandBuffers = 2,
+		ParallelDraws           = 3,
 	};
 
 	MultithreadingRenderPasses();
@@ -138,6 +137,11 @@ class MultithreadingRenderPasses : public vkb::VulkanSampleC
 	 */
 	ShadowSubpass *shadow_subpass{};
 
+	/**
+	 * @brief Subpass for scene rendering, which records its draws in parallel in the ParallelDraws mode
+	 */
+	MainSubpass *main_subpass{};
+
 	/**
 	 * @brief Camera for shadowmap rendering (view from the light source)
 	 */
@@ -148,8 +152,6 @@ class MultithreadingRenderPasses : public vkb::VulkanSampleC
 	 */
 	vkb::sg::Camera *camera{};
 
-	ctpl::thread_pool thread_pool;
-
 	uint32_t swapchain_attachment_index{0};
 
 	uint32_t depth_attachment_index{1};
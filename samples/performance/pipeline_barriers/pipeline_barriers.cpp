@@ -33,6 +33,9 @@
 
 PipelineBarriers::PipelineBarriers()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	auto &config = get_configuration();
 
 	config.insert<vkb::IntSetting>(0, reinterpret_cast<int &>(dependency_type), DependencyType::BOTTOM_TO_TOP);
@@ -88,6 +91,7 @@ bool PipelineBarriers::prepare(const vkb::ApplicationOptions &options)
 	auto geometry_fs = vkb::ShaderSource{"deferred/geometry.frag"};
 
 	auto gbuffer_pass = std::make_unique<vkb::GeometrySubpass>(get_render_context(), std::move(geometry_vs), std::move(geometry_fs), get_scene(), *camera);
+	gbuffer_pass->set_frustum_culling(true);
 	gbuffer_pass->set_output_attachments({1, 2, 3});
 	gbuffer_pipeline.add_subpass(std::move(gbuffer_pass));
 	gbuffer_pipeline.set_load_store(vkb::gbuffer::get_clear_store_all());
@@ -17,10 +17,13 @@
 
 #include "pipeline_cache.h"
 
+#include <thread>
+
 #include <imgui_internal.h>
 
 #include "core/device.h"
 #include "core/util/logging.hpp"
+#include "filesystem/filesystem.hpp"
 #include "filesystem/legacy.h"
 #include "gui.h"
 #include "platform/window.h"
@@ -39,6 +42,9 @@ PipelineCache::PipelineCache()
 
 PipelineCache::~PipelineCache()
 {
+	// Stores the recorded resources together with the pipeline cache data, keyed by the driver
+	get_device().get_resource_cache().SaveToFile(vkb::filesystem::get()->temp_directory() / "resource_cache.bin");
+
 	if (pipeline_cache != VK_NULL_HANDLE)
 	{
 		/* Get size of pipeline cache */
@@ -69,8 +75,6 @@ PipelineCache::~PipelineCache()
 		/* Destroy Vulkan pipeline cache */
 		vkDestroyPipelineCache(get_device().get_handle(), pipeline_cache, nullptr);
 	}
-
-	vkb::fs::write_temp(get_device().get_resource_cache().Serialize(), "cache.data");
 }
 
 bool PipelineCache::prepare(const vkb::ApplicationOptions &options)
@@ -105,19 +109,9 @@ bool PipelineCache::prepare(const vkb::ApplicationOptions &options)
 	// Use pipeline cache to store pipelines
 	resource_cache.SetPipelineCache(pipeline_cache);
 
-	std::vector<uint8_t> data_cache;
-
-	try
-	{
-		data_cache = vkb::fs::read_temp("cache.data");
-	}
-	catch (std::runtime_error &ex)
-	{
-		LOGW("No data cache found. {}", ex.what());
-	}
-
-	// Build all pipelines from a previous run
-	resource_cache.Warmup(data_cache);
+	// Build all pipelines from a previous run, independent pipelines are created in parallel
+	resource_cache.SetWarmupThreadCount(std::thread::hardware_concurrency());
+	resource_cache.LoadFromFile(vkb::filesystem::get()->temp_directory() / "resource_cache.bin");
 
 	get_stats().request_stats({vkb::StatIndex::frame_times});
 
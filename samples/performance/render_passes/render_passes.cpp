@@ -27,6 +27,9 @@
 
 RenderPassesSample::RenderPassesSample()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	auto &config = get_configuration();
 
 	config.insert<vkb::BoolSetting>(0, cmd_clear, false);
@@ -117,6 +120,7 @@ bool RenderPassesSample::prepare(const vkb::ApplicationOptions &options)
 	vkb::ShaderSource vert_shader("base.vert");
 	vkb::ShaderSource frag_shader("base.frag");
 	auto              scene_subpass = std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(vert_shader), std::move(frag_shader), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	auto render_pipeline = std::make_unique<vkb::RenderPipeline>();
 	render_pipeline->add_subpass(std::move(scene_subpass));
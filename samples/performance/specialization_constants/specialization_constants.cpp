@@ -28,6 +28,9 @@
 
 SpecializationConstants::SpecializationConstants()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	auto &config = get_configuration();
 
 	config.insert<vkb::IntSetting>(0, specialization_constants_enabled, 0);
@@ -109,6 +112,7 @@ std::unique_ptr<vkb::RenderPipeline> SpecializationConstants::create_specializat
 	vkb::ShaderSource frag_shader{"specialization_constants/specialization_constants.frag"};
 	auto              scene_subpass =
 	    std::make_unique<ForwardSubpassCustomLights>(get_render_context(), std::move(vert_shader), std::move(frag_shader), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	// Create specialization constants pipeline
 	std::vector<std::unique_ptr<vkb::rendering::SubpassC>> scene_subpasses{};
@@ -126,6 +130,7 @@ std::unique_ptr<vkb::RenderPipeline> SpecializationConstants::create_standard_re
 	vkb::ShaderSource frag_shader{"specialization_constants/UBOs.frag"};
 	auto              scene_subpass =
 	    std::make_unique<ForwardSubpassCustomLights>(get_render_context(), std::move(vert_shader), std::move(frag_shader), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	// Create base pipeline
 	std::vector<std::unique_ptr<vkb::rendering::SubpassC>> scene_subpasses{};
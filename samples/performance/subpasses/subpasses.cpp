@@ -25,10 +25,14 @@
 #include "rendering/render_pipeline.h"
 #include "rendering/subpasses/geometry_subpass.h"
 #include "rendering/subpasses/lighting_subpass.h"
+#include "rendering/subpasses/tiled_lighting_subpass.h"
 #include "scene_graph/node.h"
 
 Subpasses::Subpasses()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	auto &config = get_configuration();
 
 	// Good settings
@@ -50,6 +54,11 @@ Subpasses::Subpasses()
 	config.insert<vkb::IntSetting>(3, configs[Config::RenderTechnique].value, 0);
 	config.insert<vkb::IntSetting>(3, configs[Config::TransientAttachments].value, 0);
 	config.insert<vkb::IntSetting>(3, configs[Config::GBufferSize].value, 1);
+
+	// Let a render graph schedule the passes
+	config.insert<vkb::IntSetting>(4, configs[Config::RenderTechnique].value, 3);
+	config.insert<vkb::IntSetting>(4, configs[Config::TransientAttachments].value, 0);
+	config.insert<vkb::IntSetting>(4, configs[Config::GBufferSize].value, 0);
 }
 
 std::unique_ptr<vkb::RenderTarget> Subpasses::create_render_target(vkb::core::Image &&swapchain_image)
@@ -63,22 +72,30 @@ std::unique_ptr<vkb::RenderTarget> Subpasses::create_render_target(vkb::core::Im
 	// Albedo                  RGBA8_UNORM   (32-bit)
 	// Normal                  RGB10A2_UNORM (32-bit)
 
+	// The tiled compute technique samples the G-buffer after the render pass, it can't be transient
+	auto usage_flags = rt_usage_flags;
+	if (configs[Config::RenderTechnique].value == 2)
+	{
+		usage_flags &= ~VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		usage_flags |= VK_IMAGE_USAGE_SAMPLED_BIT;
+	}
+
 	vkb::core::Image depth_image{device,
 	                             extent,
 	                             vkb::get_suitable_depth_format(swapchain_image.get_device().get_gpu().get_handle()),
-	                             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | rt_usage_flags,
+	                             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | usage_flags,
 	                             VMA_MEMORY_USAGE_GPU_ONLY};
 
 	vkb::core::Image albedo_image{device,
 	                              extent,
 	                              albedo_format,
-	                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | rt_usage_flags,
+	                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | usage_flags,
 	                              VMA_MEMORY_USAGE_GPU_ONLY};
 
 	vkb::core::Image normal_image{device,
 	                              extent,
 	                              normal_format,
-	                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | rt_usage_flags,
+	                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | usage_flags,
 	                              VMA_MEMORY_USAGE_GPU_ONLY};
 
 	std::vector<vkb::core::Image> images;
@@ -155,6 +172,10 @@ bool Subpasses::prepare(const vkb::ApplicationOptions &options)
 	geometry_render_pipeline = create_geometry_renderpass();
 	lighting_render_pipeline = create_lighting_renderpass();
 
+	tiled_lighting_render_pipeline = create_tiled_lighting_renderpass();
+
+	graph_render_pipeline = create_one_renderpass_two_subpasses();
+
 	// Enable stats
 	get_stats().request_stats({vkb::StatIndex::frame_times,
 	                           vkb::StatIndex::gpu_fragment_jobs,
@@ -174,6 +195,10 @@ void Subpasses::update(float delta_time)
 	if (configs[Config::RenderTechnique].value != last_render_technique)
 	{
 		LOGI("Changing render technique");
+
+		// Only the tiled compute technique samples the G-buffer
+		bool sampled_changed = (configs[Config::RenderTechnique].value == 2) != (last_render_technique == 2);
+
 		last_render_technique = configs[Config::RenderTechnique].value;
 
 		// Reset frames, their synchronization objects and their command buffers
@@ -181,6 +206,12 @@ void Subpasses::update(float delta_time)
 		{
 			frame->Reset();
 		}
+
+		if (sampled_changed)
+		{
+			LOGI("Recreating render target");
+			get_render_context().recreate();
+		}
 	}
 
 	// Check whether the user switched the attachment or the G-buffer option
@@ -287,6 +318,7 @@ std::unique_ptr<vkb::RenderPipeline> Subpasses::create_one_renderpass_two_subpas
 	auto geometry_vs   = vkb::ShaderSource{"deferred/geometry.vert"};
 	auto geometry_fs   = vkb::ShaderSource{"deferred/geometry.frag"};
 	auto scene_subpass = std::make_unique<vkb::GeometrySubpass>(get_render_context(), std::move(geometry_vs), std::move(geometry_fs), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	// Outputs are depth, albedo, and normal
 	scene_subpass->set_output_attachments({1, 2, 3});
@@ -319,6 +351,7 @@ std::unique_ptr<vkb::RenderPipeline> Subpasses::create_geometry_renderpass()
 	auto geometry_vs   = vkb::ShaderSource{"deferred/geometry.vert"};
 	auto geometry_fs   = vkb::ShaderSource{"deferred/geometry.frag"};
 	auto scene_subpass = std::make_unique<vkb::GeometrySubpass>(get_render_context(), std::move(geometry_vs), std::move(geometry_fs), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	// Outputs are depth, albedo, and normal
 	scene_subpass->set_output_attachments({1, 2, 3});
@@ -358,6 +391,28 @@ std::unique_ptr<vkb::RenderPipeline> Subpasses::create_lighting_renderpass()
 	return lighting_render_pipeline;
 }
 
+std::unique_ptr<vkb::RenderPipeline> Subpasses::create_tiled_lighting_renderpass()
+{
+	// The lighting is computed before the render pass, the subpass copies it to the swapchain image
+	auto composite_vs     = vkb::ShaderSource{"deferred/lighting.vert"};
+	auto composite_fs     = vkb::ShaderSource{"deferred/tiled_composite.frag"};
+	auto lighting_subpass = std::make_unique<vkb::TiledLightingSubpass>(get_render_context(), std::move(composite_vs), std::move(composite_fs), *camera, get_scene());
+
+	// Depth, albedo, and normal from the geometry render pass are sampled
+	lighting_subpass->set_gbuffer_attachments({1, 2, 3});
+
+	std::vector<std::unique_ptr<vkb::rendering::SubpassC>> lighting_subpasses{};
+	lighting_subpasses.push_back(std::move(lighting_subpass));
+
+	auto tiled_lighting_render_pipeline = std::make_unique<vkb::RenderPipeline>(std::move(lighting_subpasses));
+
+	tiled_lighting_render_pipeline->set_load_store(vkb::gbuffer::get_clear_all_store_swapchain());
+
+	tiled_lighting_render_pipeline->set_clear_value(vkb::gbuffer::get_clear_value());
+
+	return tiled_lighting_render_pipeline;
+}
+
 void draw_pipeline(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target, vkb::RenderPipeline &render_pipeline, vkb::Gui *gui = nullptr)
 {
 	auto &extent = render_target.get_extent();
@@ -427,6 +482,88 @@ void Subpasses::draw_renderpasses(vkb::CommandBuffer &command_buffer, vkb::Rende
 	draw_pipeline(command_buffer, render_target, *lighting_render_pipeline, &get_gui());
 }
 
+void Subpasses::draw_tiled_compute(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
+{
+	// The G-buffer is stored by the first render pass
+	draw_pipeline(command_buffer, render_target, *geometry_render_pipeline);
+
+	// The tiled lighting subpass transitions the G-buffer for its compute shader before the render pass
+	draw_pipeline(command_buffer, render_target, *tiled_lighting_render_pipeline, &get_gui());
+}
+
+void Subpasses::create_render_graph(vkb::RenderTarget &render_target)
+{
+	render_graph = std::make_unique<vkb::RenderGraph>(get_device());
+
+	graph_extent        = render_target.get_extent();
+	graph_albedo_format = albedo_format;
+	graph_normal_format = normal_format;
+
+	// VulkanSample transitions the swapchain image before the graph, and presents it from the layout the graph leaves
+	vkb::RenderGraphResourceState swapchain_state{VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+	                                              VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR};
+	graph_swapchain = render_graph->import_texture("swapchain", render_target.get_views()[0], swapchain_state);
+
+	// Only read by the lighting pass, the graph makes them transient
+	auto depth  = render_graph->create_texture("depth", {graph_extent, vkb::get_suitable_depth_format(get_device().get_gpu().get_handle())});
+	auto albedo = render_graph->create_texture("albedo", {graph_extent, albedo_format});
+	auto normal = render_graph->create_texture("normal", {graph_extent, normal_format});
+
+	auto &subpasses = graph_render_pipeline->get_subpasses();
+
+	render_graph->add_pass("geometry")
+	    .write_depth_stencil(depth)
+	    .write_color(albedo)
+	    .write_color(normal)
+	    .set_execute([&subpasses](vkb::CommandBuffer &command_buffer) { subpasses[0]->draw(command_buffer); });
+
+	render_graph->add_pass("lighting")
+	    .read_input_attachment(depth)
+	    .read_input_attachment(albedo)
+	    .read_input_attachment(normal)
+	    .write_color(graph_swapchain)
+	    .set_execute([this, &subpasses](vkb::CommandBuffer &command_buffer) {
+		    subpasses[1]->draw(command_buffer);
+		    get_gui().draw(command_buffer);
+	    });
+
+	render_graph->compile();
+
+	auto &lighting_subpass = static_cast<vkb::LightingSubpass &>(*subpasses[1]);
+	lighting_subpass.set_gbuffer_views(render_graph->get_view(depth), render_graph->get_view(albedo), render_graph->get_view(normal));
+}
+
+void Subpasses::draw_render_graph(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
+{
+	auto &extent = render_target.get_extent();
+	if (!render_graph || extent.width != graph_extent.width || extent.height != graph_extent.height ||
+	    albedo_format != graph_albedo_format || normal_format != graph_normal_format)
+	{
+		// The previous graph retires its G-buffer, which the frames in flight may still use
+		create_render_graph(render_target);
+	}
+
+	render_graph->bind_texture(graph_swapchain, render_target.get_views()[0]);
+
+	VkViewport viewport{};
+	viewport.width    = static_cast<float>(extent.width);
+	viewport.height   = static_cast<float>(extent.height);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	command_buffer.set_viewport(0, {viewport});
+
+	VkRect2D scissor{};
+	scissor.extent = extent;
+	command_buffer.set_scissor(0, {scissor});
+
+	for (auto &subpass : graph_render_pipeline->get_subpasses())
+	{
+		subpass->draw_before_render_pass(command_buffer);
+	}
+
+	render_graph->execute(command_buffer);
+}
+
 void Subpasses::draw_renderpass(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
 {
 	if (configs[Config::RenderTechnique].value == 0)
@@ -434,11 +571,21 @@ void Subpasses::draw_renderpass(vkb::CommandBuffer &command_buffer, vkb::RenderT
 		// Efficient way
 		draw_subpasses(command_buffer, render_target);
 	}
-	else
+	else if (configs[Config::RenderTechnique].value == 1)
 	{
 		// Inefficient way
 		draw_renderpasses(command_buffer, render_target);
 	}
+	else if (configs[Config::RenderTechnique].value == 2)
+	{
+		// Compute lighting, for GPUs without tile memory
+		draw_tiled_compute(command_buffer, render_target);
+	}
+	else
+	{
+		// Same passes as the subpasses, the render graph derives the render pass, the barriers and the transient G-buffer
+		draw_render_graph(command_buffer, render_target);
+	}
 }
 
 std::unique_ptr<vkb::VulkanSampleC> create_subpasses()
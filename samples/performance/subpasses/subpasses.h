@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "rendering/render_graph.h"
 #include "rendering/render_pipeline.h"
 #include "scene_graph/components/perspective_camera.h"
 #include "vulkan_sample.h"
@@ -65,6 +66,11 @@ class Subpasses : public vkb::VulkanSampleC
 	 */
 	std::unique_ptr<vkb::RenderPipeline> create_lighting_renderpass();
 
+	/**
+	 * @return A lighting render pass which lights the G-buffer with a compute shader before it begins
+	 */
+	std::unique_ptr<vkb::RenderPipeline> create_tiled_lighting_renderpass();
+
 	/**
 	 * @brief Draws using the good pipeline: one render pass with two subpasses
 	 */
@@ -75,6 +81,23 @@ class Subpasses : public vkb::VulkanSampleC
 	 */
 	void draw_renderpasses(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target);
 
+	/**
+	 * @brief Draws the geometry render pass, then lights it per tile in a compute shader
+	 *        The G-buffer is stored and sampled, as on desktop GPUs without tile memory.
+	 */
+	void draw_tiled_compute(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target);
+
+	/**
+	 * @brief Draws the subpasses of the render graph pipeline through a RenderGraph, which merges them into one render pass
+	 *        and creates the G-buffer itself. The graph is compiled again when the extent or the G-buffer formats change.
+	 */
+	void draw_render_graph(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target);
+
+	/**
+	 * @brief Declares the G-buffer and the passes of the render graph, and compiles it
+	 */
+	void create_render_graph(vkb::RenderTarget &render_target);
+
 	std::unique_ptr<vkb::RenderTarget> create_render_target(vkb::core::Image &&swapchain_image);
 
 	/// Good pipeline with two subpasses within one render pass
@@ -86,6 +109,24 @@ class Subpasses : public vkb::VulkanSampleC
 	/// 2. Bad pipeline with a lighting subpass in the second render pass
 	std::unique_ptr<vkb::RenderPipeline> lighting_render_pipeline{};
 
+	/// Lighting pipeline of the tiled compute technique, after the geometry render pass
+	std::unique_ptr<vkb::RenderPipeline> tiled_lighting_render_pipeline{};
+
+	/// Subpasses of the render graph technique, their G-buffer is created by the graph
+	std::unique_ptr<vkb::RenderPipeline> graph_render_pipeline{};
+
+	std::unique_ptr<vkb::RenderGraph> render_graph{};
+
+	/// The swapchain image the lighting pass writes, bound to the one of the frame
+	vkb::RenderGraphTexture graph_swapchain{};
+
+	/// Extent and G-buffer formats the render graph was compiled with
+	VkExtent2D graph_extent{};
+
+	VkFormat graph_albedo_format{VK_FORMAT_UNDEFINED};
+
+	VkFormat graph_normal_format{VK_FORMAT_UNDEFINED};
+
 	vkb::sg::PerspectiveCamera *camera{};
 
 	/**
@@ -125,7 +166,7 @@ class Subpasses : public vkb::VulkanSampleC
 	std::vector<Config> configs = {
 	    {/* config      = */ Config::RenderTechnique,
 	     /* description = */ "Render technique",
-	     /* options     = */ {"Subpasses", "Renderpasses"},
+	     /* options     = */ {"Subpasses", "Renderpasses", "Tiled compute", "Render graph"},
 	     /* value       = */ 0},
 	    {/* config      = */ Config::TransientAttachments,
 	     /* description = */ "Transient attachments",
@@ -17,6 +17,7 @@
 
 #include "swapchain_images.h"
 
+#include "common/strings.h"
 #include "core/device.h"
 #include "core/pipeline_layout.h"
 #include "core/shader_module.h"
@@ -31,6 +32,9 @@
 
 SwapchainImages::SwapchainImages()
 {
+	// Loaded while the render context is set up
+	preload_scene("scenes/sponza/Sponza01.gltf");
+
 	auto &config = get_configuration();
 
 	config.insert<vkb::IntSetting>(0, swapchain_image_count, 3);
@@ -52,6 +56,7 @@ bool SwapchainImages::prepare(const vkb::ApplicationOptions &options)
 	vkb::ShaderSource vert_shader("base.vert");
 	vkb::ShaderSource frag_shader("base.frag");
 	auto              scene_subpass = std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(vert_shader), std::move(frag_shader), get_scene(), *camera);
+	scene_subpass->set_frustum_culling(true);
 
 	auto render_pipeline = std::make_unique<vkb::RenderPipeline>();
 	render_pipeline->add_subpass(std::move(scene_subpass));
@@ -71,8 +76,18 @@ void SwapchainImages::update(float delta_time)
 	{
 		get_device().wait_idle();
 
-		// Create a new swapchain with a new swapchain image count
-		get_render_context().update_swapchain(swapchain_image_count);
+		if (swapchain_image_count == AdaptiveImageCount)
+		{
+			// The render context picks the image count and present mode with the lowest latency that holds the frame rate
+			get_render_context().enable_adaptive_swapchain(TargetFrameTime);
+		}
+		else
+		{
+			get_render_context().disable_adaptive_swapchain();
+
+			// Create a new swapchain with a new swapchain image count
+			get_render_context().update_swapchain(static_cast<uint32_t>(swapchain_image_count));
+		}
 
 		last_swapchain_image_count = swapchain_image_count;
 	}
@@ -88,8 +103,12 @@ void SwapchainImages::draw_gui()
 		    ImGui::SameLine();
 		    ImGui::RadioButton("Triple buffering", &swapchain_image_count, 3);
 		    ImGui::SameLine();
+		    ImGui::RadioButton("Adaptive", &swapchain_image_count, AdaptiveImageCount);
+
+		    const auto &swapchain = get_render_context().get_swapchain();
+		    ImGui::Text("%zu images, %s", swapchain.get_images().size(), vkb::to_string(swapchain.get_present_mode()).c_str());
 	    },
-	    /* lines = */ 1);
+	    /* lines = */ 2);
 }
 
 std::unique_ptr<vkb::VulkanSampleC> create_swapchain_images()
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include "common/utils.h"
 #include "rendering/render_pipeline.h"
 #include "scene_graph/components/camera.h"
@@ -41,6 +43,12 @@ class SwapchainImages : public vkb::VulkanSampleC
 
 	virtual void draw_gui() override;
 
+	/// Selects the adaptive swapchain in the options, instead of an image count
+	static constexpr int AdaptiveImageCount = 0;
+
+	/// Frame rate the adaptive swapchain holds
+	static constexpr std::chrono::duration<float> TargetFrameTime{1.0f / 60.0f};
+
 	int swapchain_image_count{3};
 
 	int last_swapchain_image_count{3};
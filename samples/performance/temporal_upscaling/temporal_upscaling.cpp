@@ -0,0 +1,292 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "temporal_upscaling.h"
+
+#include "common/utils.h"
+#include "common/vk_common.h"
+#include "gui.h"
+#include "rendering/postprocessing_renderpass.h"
+#include "rendering/subpasses/forward_subpass.h"
+#include "stats/stats.h"
+
+namespace
+{
+/// Fractions of the swapchain extent the scene can be rendered at
+constexpr float render_scales[] = {1.0f, 0.75f, 0.5f};
+
+constexpr const char *render_scale_names[] = {"100%", "75%", "50%"};
+
+/// The motion is an offset in texture coordinates, signed and below a texel on most fragments
+constexpr VkFormat motion_format = VK_FORMAT_R16G16_SFLOAT;
+}        // namespace
+
+TemporalUpscaling::TemporalUpscaling()
+{
+	auto &config = get_configuration();
+
+	config.insert<vkb::BoolSetting>(0, temporal, true);
+	config.insert<vkb::BoolSetting>(1, temporal, true);
+	config.insert<vkb::BoolSetting>(2, temporal, false);
+
+	config.insert<vkb::IntSetting>(0, render_scale_index, 0);
+	config.insert<vkb::IntSetting>(1, render_scale_index, 2);
+	config.insert<vkb::IntSetting>(2, render_scale_index, 2);
+}
+
+bool TemporalUpscaling::prepare(const vkb::ApplicationOptions &options)
+{
+	if (!VulkanSample::prepare(options))
+	{
+		return false;
+	}
+
+	load_scene("scenes/sponza/Sponza01.gltf");
+
+	auto &camera_node = vkb::add_free_camera(get_scene(), "main_camera", get_render_context().get_surface_extent());
+	camera            = dynamic_cast<vkb::sg::PerspectiveCamera *>(&camera_node.get_component<vkb::sg::Camera>());
+
+	vkb::ShaderSource scene_vs("base.vert");
+	vkb::ShaderSource scene_fs("base.frag");
+	auto              scene_subpass = std::make_unique<vkb::ForwardSubpass>(get_render_context(), std::move(scene_vs), std::move(scene_fs), get_scene(), *camera);
+
+	// The motion is written to the second color output
+	scene_subpass->enable_motion_vectors();
+	scene_subpass->set_output_attachments({Attachments::Color, Attachments::Motion});
+
+	auto render_pipeline = std::make_unique<vkb::RenderPipeline>();
+	render_pipeline->add_subpass(std::move(scene_subpass));
+
+	// The color, depth and motion are all read by the post-processing
+	render_pipeline->set_load_store({{VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE},
+	                                 {VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE},
+	                                 {VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE}});
+
+	std::vector<VkClearValue> clear_values(3);
+	clear_values[Attachments::Color].color        = {0.0f, 0.0f, 0.0f, 1.0f};
+	clear_values[Attachments::Depth].depthStencil = {0.0f, ~0U};
+	clear_values[Attachments::Motion].color       = {0.0f, 0.0f, 0.0f, 0.0f};
+	render_pipeline->set_clear_value(clear_values);
+
+	set_render_pipeline(std::move(render_pipeline));
+
+	// The sources are set to the scene render target of the frame before every draw
+	temporal_pipeline = std::make_unique<vkb::PostProcessingPipeline>(get_render_context(), vkb::ShaderSource{"postprocessing/postprocessing.vert"});
+	temporal_pass     = &temporal_pipeline->add_pass<vkb::PostProcessingTemporalPass>(vkb::core::SampledImage{Attachments::Color},
+	                                                                                    vkb::core::SampledImage{Attachments::Motion},
+	                                                                                    vkb::core::SampledImage{Attachments::Depth});
+
+	present_pipeline = std::make_unique<vkb::PostProcessingPipeline>(get_render_context(), vkb::ShaderSource{"postprocessing/postprocessing.vert"});
+	present_pipeline->add_pass().add_subpass(vkb::ShaderSource{"postprocessing/copy.frag"});
+
+	scene_render_targets.resize(get_render_context().get_render_frames().size());
+
+	last_temporal           = temporal;
+	last_render_scale_index = render_scale_index;
+
+	get_stats().request_stats({vkb::StatIndex::frame_times, vkb::StatIndex::gpu_cycles});
+
+	create_gui(*window, &get_stats());
+
+	return true;
+}
+
+void TemporalUpscaling::prepare_render_context()
+{
+	get_render_context().prepare(1, std::bind(&TemporalUpscaling::create_render_target, this, std::placeholders::_1));
+}
+
+std::unique_ptr<vkb::RenderTarget> TemporalUpscaling::create_render_target(vkb::core::Image &&swapchain_image)
+{
+	std::vector<vkb::core::Image> images;
+	images.push_back(std::move(swapchain_image));
+
+	return std::make_unique<vkb::RenderTarget>(std::move(images));
+}
+
+VkExtent2D TemporalUpscaling::get_render_extent() const
+{
+	const auto &surface_extent = get_render_context().get_surface_extent();
+	const float scale          = render_scales[render_scale_index];
+
+	return {std::max(1u, static_cast<uint32_t>(surface_extent.width * scale)),
+	        std::max(1u, static_cast<uint32_t>(surface_extent.height * scale))};
+}
+
+vkb::RenderTarget &TemporalUpscaling::get_scene_render_target(const VkExtent2D &extent)
+{
+	// The previous submission of the frame has completed, its render target can be replaced
+	auto &scene_render_target = scene_render_targets[get_render_context().get_active_frame_index()];
+
+	if (scene_render_target && scene_render_target->get_extent().width == extent.width && scene_render_target->get_extent().height == extent.height)
+	{
+		return *scene_render_target;
+	}
+
+	const VkExtent3D image_extent{extent.width, extent.height, 1};
+
+	std::vector<vkb::core::Image> images;
+
+	// Rendered to the format of the swapchain, as without post-processing
+	images.emplace_back(get_device(), vkb::core::ImageBuilder(image_extent)
+	                                      .with_format(get_render_context().get_format())
+	                                      .with_usage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+	                                      .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY));
+
+	// Sampled by the temporal pass, so without stencil
+	images.emplace_back(get_device(), vkb::core::ImageBuilder(image_extent)
+	                                      .with_format(vkb::get_suitable_depth_format(get_device().get_gpu().get_handle(), /*depth_only=*/true))
+	                                      .with_usage(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+	                                      .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY));
+
+	images.emplace_back(get_device(), vkb::core::ImageBuilder(image_extent)
+	                                      .with_format(motion_format)
+	                                      .with_usage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+	                                      .with_vma_usage(VMA_MEMORY_USAGE_GPU_ONLY));
+
+	scene_render_target = std::make_unique<vkb::RenderTarget>(std::move(images));
+
+	return *scene_render_target;
+}
+
+void TemporalUpscaling::update(float delta_time)
+{
+	if (temporal != last_temporal || render_scale_index != last_render_scale_index)
+	{
+		// The history holds frames of another extent or without jitter
+		temporal_pass->reset_history();
+
+		last_temporal           = temporal;
+		last_render_scale_index = render_scale_index;
+	}
+
+	// The jitter is applied to the frame about to be drawn
+	if (temporal)
+	{
+		temporal_pass->jitter_camera(*camera, get_render_extent());
+	}
+	else
+	{
+		camera->set_jitter(glm::vec2(0.0f));
+	}
+
+	VulkanSample::update(delta_time);
+}
+
+void TemporalUpscaling::draw(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target)
+{
+	auto &scene_render_target = get_scene_render_target(get_render_extent());
+	auto &scene_views         = scene_render_target.get_views();
+
+	{
+		vkb::ImageMemoryBarrier memory_barrier{};
+		memory_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+		memory_barrier.new_layout      = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		memory_barrier.src_access_mask = 0;
+		memory_barrier.dst_access_mask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+		// The color and motion may still be read by the post-processing of the previous use of the frame
+		for (uint32_t i : {Attachments::Color, Attachments::Motion})
+		{
+			command_buffer.image_memory_barrier(scene_views[i], memory_barrier);
+			scene_render_target.set_layout(i, memory_barrier.new_layout);
+		}
+
+		// The swapchain is written by the present pipeline
+		memory_barrier.src_stage_mask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		command_buffer.image_memory_barrier(render_target.get_views()[0], memory_barrier);
+		render_target.set_layout(0, memory_barrier.new_layout);
+	}
+
+	{
+		vkb::ImageMemoryBarrier memory_barrier{};
+		memory_barrier.old_layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+		memory_barrier.new_layout      = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		memory_barrier.src_access_mask = 0;
+		memory_barrier.dst_access_mask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+		command_buffer.image_memory_barrier(scene_views[Attachments::Depth], memory_barrier);
+		scene_render_target.set_layout(Attachments::Depth, memory_barrier.new_layout);
+	}
+
+	set_viewport_and_scissor(command_buffer, scene_render_target.get_extent());
+	get_render_pipeline().draw(command_buffer, scene_render_target);
+	command_buffer.end_render_pass();
+
+	auto &present_subpass = present_pipeline->get_pass(0).get_subpass(0);
+
+	if (temporal)
+	{
+		temporal_pass->set_sources(vkb::core::SampledImage{Attachments::Color, &scene_render_target},
+		                           vkb::core::SampledImage{Attachments::Motion, &scene_render_target},
+		                           vkb::core::SampledImage{Attachments::Depth, &scene_render_target});
+
+		// The output has the extent of the swapchain
+		temporal_pipeline->draw(command_buffer, render_target);
+
+		present_subpass.bind_sampled_image("color_sampler", vkb::core::SampledImage{temporal_pass->get_output_view()});
+	}
+	else
+	{
+		present_subpass.bind_sampled_image("color_sampler", vkb::core::SampledImage{Attachments::Color, &scene_render_target});
+	}
+
+	// The render pass of the present pipeline is left open for the gui
+	set_viewport_and_scissor(command_buffer, render_target.get_extent());
+	present_pipeline->draw(command_buffer, render_target);
+
+	if (has_gui())
+	{
+		get_gui().draw(command_buffer);
+	}
+
+	command_buffer.end_render_pass();
+
+	{
+		vkb::ImageMemoryBarrier memory_barrier{};
+		memory_barrier.old_layout      = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		memory_barrier.new_layout      = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		memory_barrier.src_access_mask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		memory_barrier.src_stage_mask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		memory_barrier.dst_stage_mask  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+		command_buffer.image_memory_barrier(render_target.get_views()[0], memory_barrier);
+		render_target.set_layout(0, memory_barrier.new_layout);
+	}
+}
+
+void TemporalUpscaling::draw_gui()
+{
+	get_gui().show_options_window(
+	    /* body = */ [this]() {
+		    ImGui::Checkbox("Temporal upscaling", &temporal);
+		    ImGui::SameLine();
+		    ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.3f);
+		    ImGui::Combo("Render scale", &render_scale_index, render_scale_names, IM_ARRAYSIZE(render_scale_names));
+		    ImGui::PopItemWidth();
+	    },
+	    /* lines = */ 1);
+}
+
+std::unique_ptr<vkb::VulkanSampleC> create_temporal_upscaling()
+{
+	return std::make_unique<TemporalUpscaling>();
+}
@@ -0,0 +1,100 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "rendering/postprocessing_pipeline.h"
+#include "rendering/postprocessing_temporalpass.h"
+#include "rendering/render_pipeline.h"
+#include "scene_graph/components/perspective_camera.h"
+#include "vulkan_sample.h"
+
+/**
+ * @brief Renders the scene at a fraction of the swapchain extent and upscales it with a temporal pass
+ *
+ * The geometry subpass writes the motion of the opaque fragments next to the jittered color, and a
+ * vkb::PostProcessingTemporalPass accumulates the frames at the extent of the swapchain. Without it,
+ * the color is stretched to the swapchain with a bilinear filter instead, for comparison.
+ */
+class TemporalUpscaling : public vkb::VulkanSampleC
+{
+  public:
+	TemporalUpscaling();
+
+	virtual ~TemporalUpscaling() = default;
+
+	virtual bool prepare(const vkb::ApplicationOptions &options) override;
+
+	virtual void update(float delta_time) override;
+
+  private:
+	/**
+	 * @brief Attachments of the render targets the scene is drawn to
+	 */
+	enum Attachments : uint32_t
+	{
+		Color  = 0,
+		Depth  = 1,
+		Motion = 2,
+	};
+
+	virtual void prepare_render_context() override;
+
+	virtual void draw(vkb::CommandBuffer &command_buffer, vkb::RenderTarget &render_target) override;
+
+	virtual void draw_gui() override;
+
+	/**
+	 * @brief The swapchain render targets only hold the swapchain image, written by the post-processing
+	 */
+	std::unique_ptr<vkb::RenderTarget> create_render_target(vkb::core::Image &&swapchain_image);
+
+	/**
+	 * @brief Returns the scene render target of the active frame, created again if the extent changed
+	 * @param extent The extent of the swapchain, scaled by the render scale
+	 */
+	vkb::RenderTarget &get_scene_render_target(const VkExtent2D &extent);
+
+	/**
+	 * @return The extent of the swapchain scaled by the selected render scale
+	 */
+	VkExtent2D get_render_extent() const;
+
+	vkb::sg::PerspectiveCamera *camera{nullptr};
+
+	/// Scene render targets, one per render frame
+	std::vector<std::unique_ptr<vkb::RenderTarget>> scene_render_targets;
+
+	/// Accumulates the jittered frames, with its pass
+	std::unique_ptr<vkb::PostProcessingPipeline> temporal_pipeline;
+
+	vkb::PostProcessingTemporalPass *temporal_pass{nullptr};
+
+	/// Copies the temporal output or the scene color to the swapchain
+	std::unique_ptr<vkb::PostProcessingPipeline> present_pipeline;
+
+	/// Index of the render scale in the options
+	int render_scale_index{0};
+
+	int last_render_scale_index{0};
+
+	bool temporal{true};
+
+	bool last_temporal{true};
+};
+
+std::unique_ptr<vkb::VulkanSampleC> create_temporal_upscaling();
@@ -16,6 +16,8 @@
  */
 
 #include "texture_compression_comparison.h"
+#include "core/allocated.h"
+#include "filesystem/filesystem.hpp"
 #include "rendering/subpasses/forward_subpass.h"
 #include "scene_graph/components/camera.h"
 #include "scene_graph/components/image.h"
@@ -50,6 +52,26 @@ std::string get_sponza_texture_filename(const std::string &short_name)
 {
 	return vkb::fs::path::get(vkb::fs::path::Type::Assets) + "scenes/sponza/ktx2/" + short_name + "2";
 }
+
+/**
+ * @return The newest value of a stat, negative if it isn't available
+ */
+float get_latest_stat(const vkb::Stats &stats, vkb::StatIndex index)
+{
+	if (!stats.is_available(index))
+	{
+		return -1.f;
+	}
+
+	const auto &history = stats.get_data(index);
+	const auto &values  = history.get_values();
+	return values.empty() ? -1.f : values[(history.get_head() + values.size() - 1) % values.size()];
+}
+
+std::string format_value(float value)
+{
+	return value < 0.f ? "" : fmt::format("{:.3f}", value);
+}
 }        // namespace
 
 #define KTX_CHECK(x)                                                                              \
@@ -78,9 +100,17 @@ bool TextureCompressionComparison::prepare(const vkb::ApplicationOptions &option
 
 	create_subpass();
 
-	get_stats().request_stats({vkb::StatIndex::frame_times, vkb::StatIndex::gpu_ext_read_bytes});
+	// The GPU time of the formats in the matrix
+	get_render_context().enable_gpu_frame_timing();
+
+	get_stats().request_stats({vkb::StatIndex::frame_times, vkb::StatIndex::gpu_time, vkb::StatIndex::gpu_ext_read_bytes});
 	create_gui(*window, &get_stats());
 
+	if (options.benchmark_enabled)
+	{
+		start_matrix();
+	}
+
 	return true;
 }
 
@@ -94,6 +124,127 @@ void TextureCompressionComparison::update(float delta_time)
 		current_benchmark = update_textures(formats[current_format]);
 	}
 	VulkanSample::update(delta_time);
+
+	if (matrix_running)
+	{
+		update_matrix(delta_time);
+	}
+}
+
+void TextureCompressionComparison::start_matrix()
+{
+	matrix_results.clear();
+	matrix_format  = 0;
+	matrix_frame   = 0;
+	matrix_running = true;
+
+	LOGI("Running the texture format matrix, {} frames per format", MatrixWarmupFrames + MatrixMeasuredFrames);
+}
+
+void TextureCompressionComparison::update_matrix(float delta_time)
+{
+	const auto &formats = get_texture_formats();
+
+	// Switches to the next supported format once the current one is measured
+	if (matrix_frame == 0 || matrix_frame == MatrixWarmupFrames + MatrixMeasuredFrames)
+	{
+		if (matrix_frame != 0)
+		{
+			++matrix_format;
+		}
+
+		while (matrix_format < formats.size() && !is_texture_format_supported(formats[matrix_format]))
+		{
+			LOGI("Skipping {} in the texture format matrix, not supported", formats[matrix_format].short_name);
+			++matrix_format;
+		}
+
+		if (matrix_format == formats.size())
+		{
+			matrix_running = false;
+			write_matrix();
+			return;
+		}
+
+		// The textures are transcoded and uploaded before the next frame
+		current_format     = static_cast<int>(matrix_format);
+		current_gui_format = current_format;
+		require_redraw     = true;
+		matrix_frame       = 0;
+
+		matrix_results.push_back({matrix_format});
+	}
+
+	++matrix_frame;
+
+	auto &result = matrix_results.back();
+	if (matrix_frame == 1)
+	{
+		result.benchmark = current_benchmark;
+	}
+
+	if (matrix_frame <= MatrixWarmupFrames)
+	{
+		return;
+	}
+
+	// Running averages over the measured frames
+	float gpu_time = get_latest_stat(get_stats(), vkb::StatIndex::gpu_time);
+	float ext_read = get_latest_stat(get_stats(), vkb::StatIndex::gpu_ext_read_bytes);
+
+	++result.frame_count;
+	auto average = [&result](float &average, float value) {
+		if (value >= 0.f)
+		{
+			average = average < 0.f ? value : average + (value - average) / static_cast<float>(result.frame_count);
+		}
+	};
+	average(result.gpu_time_ms, gpu_time);
+	average(result.ext_read_mibs, ext_read < 0.f ? ext_read : ext_read / (1024.f * 1024.f));
+}
+
+void TextureCompressionComparison::write_matrix() const
+{
+	const auto &formats    = get_texture_formats();
+	auto       &properties = get_device().get_gpu().get_properties();
+
+	std::string json = "{\n";
+	json += fmt::format("\t\"device\": \"{}\",\n", properties.deviceName);
+	json += fmt::format("\t\"warmup_frames\": {},\n", MatrixWarmupFrames);
+	json += "\t\"formats\": [";
+
+	std::string csv = "format,vk_format,transcode_time_ms,upload_time_ms,file_bytes,vram_bytes,gpu_time_ms,ext_read_mib_per_s,frames\n";
+
+	for (size_t i = 0; i < matrix_results.size(); ++i)
+	{
+		auto &result = matrix_results[i];
+		auto &format = formats[result.format_index];
+
+		json += fmt::format("{}\n\t\t{{\"format\": \"{}\", \"vk_format\": \"{}\", \"transcode_time_ms\": {:.3f}, \"upload_time_ms\": {:.3f}, "
+		                    "\"file_bytes\": {}, \"vram_bytes\": {}, \"gpu_time_ms\": {}, \"ext_read_mib_per_s\": {}, \"frames\": {}}}",
+		                    i == 0 ? "" : ",", format.short_name, vkb::to_string(format.format), result.benchmark.compress_time_ms,
+		                    result.benchmark.upload_time_ms, result.benchmark.total_bytes, result.benchmark.vram_bytes,
+		                    result.gpu_time_ms < 0.f ? "null" : format_value(result.gpu_time_ms),
+		                    result.ext_read_mibs < 0.f ? "null" : format_value(result.ext_read_mibs), result.frame_count);
+
+		csv += fmt::format("{},{},{:.3f},{:.3f},{},{},{},{},{}\n", format.short_name, vkb::to_string(format.format), result.benchmark.compress_time_ms,
+		                   result.benchmark.upload_time_ms, result.benchmark.total_bytes, result.benchmark.vram_bytes,
+		                   format_value(result.gpu_time_ms), format_value(result.ext_read_mibs), result.frame_count);
+
+		LOGI("{:>10}: transcode {:8.2f} ms, upload {:8.2f} ms, {:7.2f} MiB in memory, GPU {} ms", format.short_name, result.benchmark.compress_time_ms,
+		     result.benchmark.upload_time_ms, static_cast<float>(result.benchmark.vram_bytes) / (1024.f * 1024.f), format_value(result.gpu_time_ms));
+	}
+
+	json += matrix_results.empty() ? "]\n" : "\n\t]\n";
+	json += "}\n";
+
+	std::string path = vkb::fs::path::get(vkb::fs::path::Type::Logs) + "texture_compression_comparison-matrix";
+
+	auto fs = vkb::filesystem::get();
+	fs->write_file(path + ".json", json);
+	fs->write_file(path + ".csv", csv);
+
+	LOGI("Texture format matrix written to {}.json and {}.csv", path, path);
 }
 
 void TextureCompressionComparison::draw_gui()
@@ -113,6 +264,15 @@ void TextureCompressionComparison::draw_gui()
 	});
 
 	get_gui().show_options_window([this, &name_pointers]() {
+		if (matrix_running)
+		{
+			ImGui::Text("Format matrix: %s, frame %u", get_texture_formats()[matrix_format].short_name, matrix_frame);
+		}
+		else if (ImGui::Button("Run format matrix"))
+		{
+			start_matrix();
+		}
+
 		if (ImGui::Combo("Compressed Format", &current_gui_format, name_pointers.data(), static_cast<int>(name_pointers.size())))
 		{
 			require_redraw     = true;
@@ -128,12 +288,15 @@ void TextureCompressionComparison::draw_gui()
 			ImGui::Text("Format name: %s", format.format_name);
 			ImGui::Text("Bytes: %f MB", static_cast<float>(current_benchmark.total_bytes) / 1024.f / 1024.f);
 			ImGui::Text("Compression Time: %f (ms)", current_benchmark.compress_time_ms);
+			ImGui::Text("Upload Time: %f (ms)", current_benchmark.upload_time_ms);
+			ImGui::Text("Memory: %f MB", static_cast<float>(current_benchmark.vram_bytes) / 1024.f / 1024.f);
 		}
 		else
 		{
 			ImGui::Text("%s not supported on this GPU.", format.short_name);
 		}
-	});
+	},
+	                              /* lines = */ 6);
 }
 
 const std::vector<TextureCompressionComparison::CompressedTexture_t> &TextureCompressionComparison::get_texture_formats()
@@ -158,6 +321,12 @@ const std::vector<TextureCompressionComparison::CompressedTexture_t> &TextureCom
 	                        KTX_TTF_BC3_RGBA,
 	                        "KTX_TTF_BC3_RGBA",
 	                        "BC3"},
+	    CompressedTexture_t{&VkPhysicalDeviceFeatures::textureCompressionBC,
+	                        "",
+	                        VK_FORMAT_BC1_RGB_SRGB_BLOCK,
+	                        KTX_TTF_BC1_RGB,
+	                        "KTX_TTF_BC1_RGB",
+	                        "BC1"},
 	    CompressedTexture_t{&VkPhysicalDeviceFeatures::textureCompressionASTC_LDR,
 	                        "",
 	                        VK_FORMAT_ASTC_4x4_SRGB_BLOCK,
@@ -169,7 +338,13 @@ const std::vector<TextureCompressionComparison::CompressedTexture_t> &TextureCom
 	                        VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,
 	                        KTX_TTF_ETC2_RGBA,
 	                        "KTX_TTF_ETC2_RGBA",
-	                        "ETC2"}};
+	                        "ETC2"},
+	    CompressedTexture_t{&VkPhysicalDeviceFeatures::textureCompressionETC2,
+	                        "",
+	                        VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,
+	                        KTX_TTF_ETC1_RGB,
+	                        "KTX_TTF_ETC1_RGB",
+	                        "ETC2 RGB"}};
 	return formats;
 }
 
@@ -332,9 +507,17 @@ std::pair<std::unique_ptr<vkb::sg::Image>, TextureCompressionComparison::Texture
 		benchmark.compress_time_ms = static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) / 1000.f;
 	}
 	benchmark.total_bytes = ktx_texture->dataSize;
-	auto image            = create_image(ktx_texture, name);
+
+	const auto upload_start  = std::chrono::high_resolution_clock::now();
+	auto       image         = create_image(ktx_texture, name);
+	const auto upload_end    = std::chrono::high_resolution_clock::now();
+	benchmark.upload_time_ms = static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(upload_end - upload_start).count()) / 1000.f;
 	ktxTexture_Destroy((ktxTexture *) ktx_texture);
 
+	VmaAllocationInfo allocation_info{};
+	vmaGetAllocationInfo(vkb::allocated::get_memory_allocator(), image->get_vk_image().get_allocation(), &allocation_info);
+	benchmark.vram_bytes = allocation_info.size;
+
 	return {std::move(image), benchmark};
 }
 
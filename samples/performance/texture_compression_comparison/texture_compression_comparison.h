@@ -22,6 +22,13 @@
 #include "api_vulkan_sample.h"
 #include "scene_graph/components/camera.h"
 
+/**
+ * @brief Compares the transcoding, upload, memory and rendering costs of the textures of a scene in different formats
+ *
+ * The formats are switched interactively, or all of the supported ones are measured in turn by the format matrix,
+ * started from the options window or when the sample runs with --benchmark. The matrix is written as a table to
+ * <logs>/texture_compression_comparison-matrix.json and .csv.
+ */
 class TextureCompressionComparison : public vkb::VulkanSampleC
 {
   public:
@@ -48,15 +55,34 @@ class TextureCompressionComparison : public vkb::VulkanSampleC
 		TextureBenchmark &operator+=(const TextureBenchmark &other)
 		{
 			total_bytes += other.total_bytes;
+			vram_bytes += other.vram_bytes;
 			compress_time_ms += other.compress_time_ms;
+			upload_time_ms += other.upload_time_ms;
 			frame_time_ms += other.frame_time_ms;
 			return *this;
 		}
 		VkDeviceSize total_bytes      = 0;
+		VkDeviceSize vram_bytes       = 0;
 		float        compress_time_ms = 0.f;
+		float        upload_time_ms   = 0.f;
 		float        frame_time_ms    = 0.f;
 	};
 
+	/// A format measured by the format matrix, the times are averaged over the measured frames
+	struct MatrixResult
+	{
+		size_t           format_index  = 0;
+		TextureBenchmark benchmark     = {};
+		float            gpu_time_ms   = -1.f;
+		float            ext_read_mibs = -1.f;
+		uint32_t         frame_count   = 0;
+	};
+
+	/// Frames drawn after switching the format of the matrix before measuring, so that the GPU times are the new format's
+	static constexpr uint32_t MatrixWarmupFrames = 30;
+
+	static constexpr uint32_t MatrixMeasuredFrames = 120;
+
 	struct SampleTexture
 	{
 		std::vector<uint8_t>            raw_bytes;
@@ -72,6 +98,9 @@ class TextureCompressionComparison : public vkb::VulkanSampleC
 	TextureBenchmark                                             update_textures(const CompressedTexture_t &new_format);
 	std::unique_ptr<vkb::sg::Image>                              create_image(ktxTexture2 *ktx_texture, const std::string &name);
 	std::pair<std::unique_ptr<vkb::sg::Image>, TextureBenchmark> compress(const std::string &filename, CompressedTexture_t texture_format, const std::string &name);
+	void                                                         start_matrix();
+	void                                                         update_matrix(float delta_time);
+	void                                                         write_matrix() const;
 	std::vector<std::string>                                     gui_texture_names;
 	std::unordered_map<std::string, SampleTexture>               texture_raw_data;
 	std::vector<std::pair<vkb::sg::Texture *, std::string>>      textures;
@@ -79,6 +108,10 @@ class TextureCompressionComparison : public vkb::VulkanSampleC
 	TextureBenchmark                                             current_benchmark{};
 	int                                                          current_format = 0, current_gui_format = 0;
 	bool                                                         require_redraw = true;
+	bool                                                         matrix_running = false;
+	size_t                                                       matrix_format  = 0;
+	uint32_t                                                     matrix_frame   = 0;
+	std::vector<MatrixResult>                                    matrix_results;
 };
 
 std::unique_ptr<TextureCompressionComparison> create_texture_compression_comparison();
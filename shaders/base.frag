@@ -18,7 +18,10 @@
 
 precision highp float;
 
-#ifdef HAS_BASE_COLOR_TEXTURE
+#ifdef BINDLESS
+// Textures of the whole scene, indexed with the push constants
+layout(set = 1, binding = 0) uniform sampler2D bindless_textures[BINDLESS_TEXTURE_COUNT];
+#elif defined(HAS_BASE_COLOR_TEXTURE)
 layout(set = 0, binding = 0) uniform sampler2D base_color_texture;
 #endif
 
@@ -26,8 +29,20 @@ layout(location = 0) in vec4 in_pos;
 layout(location = 1) in vec2 in_uv;
 layout(location = 2) in vec3 in_normal;
 
+#ifdef MOTION_VECTORS
+layout(location = 3) in vec4 in_clip_pos;
+layout(location = 4) in vec4 in_previous_clip_pos;
+#endif
+
 layout(location = 0) out vec4 o_color;
+#ifdef MOTION_VECTORS
+// Offset in texture coordinates to the fragment in the previous frame
+layout(location = 1) out vec2 o_motion;
+#endif
 
+#ifdef GLOBAL_PUSH_CONSTANTS
+#include "draw_constants.h"
+#else
 layout(set = 0, binding = 1) uniform GlobalUniform
 {
 	mat4 model;
@@ -43,11 +58,18 @@ layout(push_constant, std430) uniform PBRMaterialUniform
 	vec4  base_color_factor;
 	float metallic_factor;
 	float roughness_factor;
+#ifdef BINDLESS
+	uint base_color_texture_index;
+#endif
 }
 pbr_material_uniform;
+#endif
 
 #include "lighting.h"
 
+#ifdef CLUSTERED_LIGHTING
+#include "clustered/clustered_lighting.h"
+#else
 layout(set = 0, binding = 4) uniform LightsInfo
 {
 	Light directional_lights[MAX_LIGHT_COUNT];
@@ -59,11 +81,19 @@ lights_info;
 layout(constant_id = 0) const uint DIRECTIONAL_LIGHT_COUNT = 0U;
 layout(constant_id = 1) const uint POINT_LIGHT_COUNT       = 0U;
 layout(constant_id = 2) const uint SPOT_LIGHT_COUNT        = 0U;
+#endif
+
+#ifdef OIT_KBUFFER
+#include "oit/store_fragment.h"
+#endif
 
 void main(void)
 {
 	vec3 normal = normalize(in_normal);
 
+#ifdef CLUSTERED_LIGHTING
+	vec3 light_contribution = apply_clustered_lights(in_pos.xyz, normal);
+#else
 	vec3 light_contribution = vec3(0.0);
 
 	for (uint i = 0U; i < DIRECTIONAL_LIGHT_COUNT; ++i)
@@ -80,10 +110,13 @@ void main(void)
 	{
 		light_contribution += apply_spot_light(lights_info.spot_lights[i], in_pos.xyz, normal);
 	}
+#endif
 
 	vec4 base_color = vec4(1.0, 0.0, 0.0, 1.0);
 
-#ifdef HAS_BASE_COLOR_TEXTURE
+#if defined(HAS_BASE_COLOR_TEXTURE) && defined(BINDLESS)
+	base_color = texture(bindless_textures[pbr_material_uniform.base_color_texture_index], in_uv);
+#elif defined(HAS_BASE_COLOR_TEXTURE)
 	base_color = texture(base_color_texture, in_uv);
 #else
 	base_color = pbr_material_uniform.base_color_factor;
@@ -91,5 +124,15 @@ void main(void)
 
 	vec3 ambient_color = vec3(0.2) * base_color.xyz;
 
-	o_color = vec4(ambient_color + light_contribution * base_color.xyz, base_color.w);
+	vec4 color = vec4(ambient_color + light_contribution * base_color.xyz, base_color.w);
+
+#ifdef OIT_KBUFFER
+	oit_store_fragment(color);
+#else
+	o_color = color;
+#endif
+
+#ifdef MOTION_VECTORS
+	o_motion = (in_previous_clip_pos.xy / in_previous_clip_pos.w - in_clip_pos.xy / in_clip_pos.w) * 0.5;
+#endif
 }
@@ -16,27 +16,113 @@
  * limitations under the License.
  */
 
+#ifdef VERTEX_PULLING
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_buffer_reference_uvec2 : require
+
+#include "vertex_pulling.h"
+#else
+#ifdef PACKED_POSITION
+layout(location = 0) in vec4 position;
+#else
 layout(location = 0) in vec3 position;
+#endif
 layout(location = 1) in vec2 texcoord_0;
+#ifdef PACKED_NORMAL
+layout(location = 2) in vec2 normal;
+#else
 layout(location = 2) in vec3 normal;
+#endif
+#endif
+
+#ifdef PACKED_NORMAL
+#include "vertex_packing.h"
+#endif
 
+#ifdef GLOBAL_PUSH_CONSTANTS
+#include "draw_constants.h"
+#else
 layout(set = 0, binding = 1) uniform GlobalUniform {
     mat4 model;
     mat4 view_proj;
     vec3 camera_position;
+#ifdef PACKED_POSITION
+    // Bounds the positions are normalized in
+    vec3 position_offset;
+    vec3 position_scale;
+#endif
 } global_uniform;
+#endif
+
+#ifdef INSTANCING
+// World matrices of the instances, indexed from the first instance of the draw
+layout(std430, set = 0, binding = 5) readonly buffer InstanceBuffer {
+    mat4 models[];
+} instance_buffer;
+#endif
+
+#ifdef GPU_SCENE
+// World matrices of the nodes, indexed from the first instance of the draw
+layout(std430, set = 0, binding = 8) readonly buffer SceneBuffer {
+    mat4 models[];
+} scene_buffer;
+#endif
+
+#ifdef MOTION_VECTORS
+// Unjittered matrices of this frame and the previous one, see vkb::GeometrySubpass::enable_motion_vectors
+layout(set = 0, binding = 19) uniform MotionUniform {
+    mat4 view_proj;
+    mat4 previous_view_proj;
+    mat4 world_motion;
+} motion_uniform;
+#endif
 
 layout (location = 0) out vec4 o_pos;
 layout (location = 1) out vec2 o_uv;
 layout (location = 2) out vec3 o_normal;
+#ifdef MOTION_VECTORS
+layout (location = 3) out vec4 o_clip_pos;
+layout (location = 4) out vec4 o_previous_clip_pos;
+#endif
 
 void main(void)
 {
-    o_pos = global_uniform.model * vec4(position, 1.0);
+#ifdef VERTEX_PULLING
+    vec3 position   = fetch_position();
+    vec2 texcoord_0 = fetch_texcoord_0();
+    vec3 normal     = fetch_normal();
+#endif
+
+#ifdef PACKED_POSITION
+    vec3 object_position = global_uniform.position_offset + position.xyz * global_uniform.position_scale;
+#else
+    vec3 object_position = position;
+#endif
+
+#ifdef PACKED_NORMAL
+    vec3 object_normal = decode_octahedral_normal(normal);
+#else
+    vec3 object_normal = normal;
+#endif
+
+#if defined(INSTANCING)
+    mat4 model = instance_buffer.models[gl_InstanceIndex];
+#elif defined(GPU_SCENE)
+    mat4 model = scene_buffer.models[gl_InstanceIndex];
+#else
+    mat4 model = global_uniform.model;
+#endif
+
+    o_pos = model * vec4(object_position, 1.0);
 
     o_uv = texcoord_0;
 
-    o_normal = mat3(global_uniform.model) * normal;
+    o_normal = mat3(model) * object_normal;
 
     gl_Position = global_uniform.view_proj * o_pos;
+
+#ifdef MOTION_VECTORS
+    o_clip_pos          = motion_uniform.view_proj * o_pos;
+    o_previous_clip_pos = motion_uniform.previous_view_proj * (motion_uniform.world_motion * o_pos);
+#endif
 }
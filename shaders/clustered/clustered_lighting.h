@@ -0,0 +1,85 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reads the lights assigned to the clusters by assign_lights.comp, lighting.h must be included first
+
+#include "clustered/light_clusters.h"
+
+// Global lights followed by the clustered lights
+layout(std430, set = 0, binding = 4) readonly buffer Lights
+{
+	Light lights[];
+}
+lights_buffer;
+
+layout(std430, set = 0, binding = 7) readonly buffer ClusterLights
+{
+	uint data[];
+}
+cluster_lights;
+
+vec3 apply_light(Light light, vec3 pos, vec3 normal)
+{
+	if (light.position.w == DIRECTIONAL_LIGHT)
+	{
+		return apply_directional_light(light, normal);
+	}
+	else if (light.position.w == POINT_LIGHT)
+	{
+		return apply_point_light(light, pos, normal);
+	}
+	else
+	{
+		return apply_spot_light(light, pos, normal);
+	}
+}
+
+// The first directional light is scaled by its visibility
+vec3 apply_clustered_lights(vec3 pos, vec3 normal, float directional_visibility)
+{
+	vec3 light_contribution = vec3(0.0);
+
+	for (uint i = 0U; i < cluster_uniform.global_light_count; ++i)
+	{
+		Light light = lights_buffer.lights[i];
+		if (light.position.w == DIRECTIONAL_LIGHT)
+		{
+			light_contribution += directional_visibility * apply_directional_light(light, normal);
+			directional_visibility = 1.0;
+		}
+		else
+		{
+			light_contribution += apply_light(light, pos, normal);
+		}
+	}
+
+	uint offset      = get_cluster_index(pos) * cluster_stride;
+	uint light_count = cluster_lights.data[offset];
+
+	for (uint i = 0U; i < light_count; ++i)
+	{
+		uint light_index = cluster_uniform.global_light_count + cluster_lights.data[offset + 1U + i];
+		light_contribution += apply_light(lights_buffer.lights[light_index], pos, normal);
+	}
+
+	return light_contribution;
+}
+
+vec3 apply_clustered_lights(vec3 pos, vec3 normal)
+{
+	return apply_clustered_lights(pos, normal, 1.0);
+}
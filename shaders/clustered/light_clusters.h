@@ -0,0 +1,68 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Matches vkb::ClusterUniform
+layout(set = 0, binding = 6) uniform ClusterUniform
+{
+	mat4  view;
+	vec2  projection_scale;
+	float near_plane;
+	float slice_scale;
+	uint  global_light_count;
+	uint  clustered_light_count;
+}
+cluster_uniform;
+
+const uint cluster_grid_width  = uint(CLUSTER_GRID_WIDTH);
+const uint cluster_grid_height = uint(CLUSTER_GRID_HEIGHT);
+const uint cluster_grid_depth  = uint(CLUSTER_GRID_DEPTH);
+const uint cluster_count       = cluster_grid_width * cluster_grid_height * cluster_grid_depth;
+
+const vec2 cluster_grid = vec2(CLUSTER_GRID_WIDTH, CLUSTER_GRID_HEIGHT);
+
+// Each cluster list holds a count followed by the indices of its lights
+const uint max_lights_per_cluster = uint(MAX_LIGHTS_PER_CLUSTER);
+const uint cluster_stride         = max_lights_per_cluster + 1U;
+
+uint get_cluster_index(vec3 world_position)
+{
+	vec3  view_position = (cluster_uniform.view * vec4(world_position, 1.0)).xyz;
+	float depth         = max(-view_position.z, cluster_uniform.near_plane);
+
+	vec2  ndc   = cluster_uniform.projection_scale * view_position.xy / depth;
+	uvec2 tile  = uvec2(clamp((ndc * 0.5 + 0.5) * cluster_grid, vec2(0.0), cluster_grid - 1.0));
+	uint  slice = uint(clamp(log(depth / cluster_uniform.near_plane) * cluster_uniform.slice_scale, 0.0, float(CLUSTER_GRID_DEPTH - 1)));
+
+	return (slice * cluster_grid_height + tile.y) * cluster_grid_width + tile.x;
+}
+
+// View space bounds of a cluster, the slices are spaced exponentially between the near and far planes
+void get_cluster_bounds(uint cluster, out vec3 bounds_min, out vec3 bounds_max)
+{
+	uvec2 tile  = uvec2(cluster % cluster_grid_width, (cluster / cluster_grid_width) % cluster_grid_height);
+	uint  slice = cluster / (cluster_grid_width * cluster_grid_height);
+
+	float near_depth = cluster_uniform.near_plane * exp(float(slice) / cluster_uniform.slice_scale);
+	float far_depth  = cluster_uniform.near_plane * exp(float(slice + 1U) / cluster_uniform.slice_scale);
+
+	// Position on the plane at depth 1 of the corners of the tile, the frustum widens with the depth
+	vec2 corner_min = (vec2(tile) / cluster_grid * 2.0 - 1.0) / cluster_uniform.projection_scale;
+	vec2 corner_max = (vec2(tile + 1U) / cluster_grid * 2.0 - 1.0) / cluster_uniform.projection_scale;
+
+	bounds_min = vec3(min(corner_min * near_depth, corner_min * far_depth), -far_depth);
+	bounds_max = vec3(max(corner_max * near_depth, corner_max * far_depth), -near_depth);
+}
@@ -50,15 +50,15 @@ groupshared float4 sharedData[MAX_SHARED_DATA_SIZE];
 void main(uint3 GlobalInvocationID : SV_DispatchThreadID, uint3 LocalInvocationID : SV_GroupThreadID)
 {
 	// Current SSBO index
+	// Threads past the last particle still load their part of the tiles, as all threads must reach the barriers
     uint index = GlobalInvocationID.x;
-    if (index >= ubo.particleCount)
-        return;
+    bool active = index < ubo.particleCount;
 
-    float4 position = particles[index].pos;
-    float4 velocity = particles[index].vel;
+    float4 position = active ? particles[index].pos : float4(0, 0, 0, 0);
     float4 acceleration = float4(0, 0, 0, 0);
 
-    for (int i = 0; i < ubo.particleCount; i += SHARED_DATA_SIZE)
+    // Each tile of 256 positions is loaded once to shared memory and read by all threads of the group
+    for (uint i = 0; i < ubo.particleCount; i += 256)
     {
         if (i + LocalInvocationID.x < ubo.particleCount)
         {
@@ -66,6 +66,7 @@ void main(uint3 GlobalInvocationID : SV_DispatchThreadID, uint3 LocalInvocationI
         }
         else
         {
+            // Zero mass, so the padding of the last tile doesn't contribute
             sharedData[LocalInvocationID.x] = float4(0, 0, 0, 0);
         }
 
@@ -81,6 +82,11 @@ void main(uint3 GlobalInvocationID : SV_DispatchThreadID, uint3 LocalInvocationI
         GroupMemoryBarrierWithGroupSync();
     }
 
+    if (!active)
+    {
+        return;
+    }
+
     particles[index].vel.xyz += ubo.deltaT * TIME_FACTOR * acceleration.xyz;
 
 	// Gradient texture position
@@ -37,6 +37,11 @@ ConstantBuffer<UBO> ubo : register(b1);
 void main(uint3 GlobalInvocationID : SV_DispatchThreadID)
 {
     int index = int(GlobalInvocationID.x);
+    // The last thread group may extend past the last particle
+    if (index >= ubo.particleCount)
+    {
+        return;
+    }
     float4 position = particles[index].pos;
     float4 velocity = particles[index].vel;
     position += ubo.deltaT * TIME_FACTOR * velocity;
@@ -29,6 +29,9 @@ layout (location = 2) in vec3 in_normal;
 layout (location = 0) out vec4 o_albedo;
 layout (location = 1) out vec4 o_normal;
 
+#ifdef GLOBAL_PUSH_CONSTANTS
+#include "draw_constants.h"
+#else
 layout(set = 0, binding = 1) uniform GlobalUniform {
     mat4 model;
     mat4 view_proj;
@@ -40,6 +43,7 @@ layout(push_constant, std430) uniform PBRMaterialUniform {
     float metallic_factor;
     float roughness_factor;
 } pbr_material_uniform;
+#endif
 
 void main(void)
 {
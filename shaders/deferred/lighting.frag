@@ -20,6 +20,10 @@ precision highp float;
 layout(input_attachment_index = 0, binding = 0) uniform subpassInput i_depth;
 layout(input_attachment_index = 1, binding = 1) uniform subpassInput i_albedo;
 layout(input_attachment_index = 2, binding = 2) uniform subpassInput i_normal;
+#ifdef RAY_QUERY_OCCLUSION
+// Visibility of the first directional light in red, ambient occlusion in green
+layout(input_attachment_index = 3, binding = 19) uniform subpassInput i_occlusion;
+#endif
 
 layout(location = 0) in vec2 in_uv;
 layout(location = 0) out vec4 o_color;
@@ -33,6 +37,9 @@ global_uniform;
 
 #include "lighting.h"
 
+#ifdef CLUSTERED_LIGHTING
+#include "clustered/clustered_lighting.h"
+#else
 layout(set = 0, binding = 4) uniform LightsInfo
 {
 	Light directional_lights[MAX_LIGHT_COUNT];
@@ -44,6 +51,7 @@ lights_info;
 layout(constant_id = 0) const uint DIRECTIONAL_LIGHT_COUNT = 0U;
 layout(constant_id = 1) const uint POINT_LIGHT_COUNT       = 0U;
 layout(constant_id = 2) const uint SPOT_LIGHT_COUNT        = 0U;
+#endif
 
 void main()
 {
@@ -55,11 +63,19 @@ void main()
 	// Transform from [0,1] to [-1,1]
 	vec3 normal = subpassLoad(i_normal).xyz;
 	normal      = normalize(2.0 * normal - 1.0);
+#ifdef RAY_QUERY_OCCLUSION
+	vec2 occlusion = subpassLoad(i_occlusion).rg;
+#else
+	vec2 occlusion = vec2(1.0);
+#endif
 	// Calculate lighting
+#ifdef CLUSTERED_LIGHTING
+	vec3 L = apply_clustered_lights(pos, normal, occlusion.r);
+#else
 	vec3 L = vec3(0.0);
 	for (uint i = 0U; i < DIRECTIONAL_LIGHT_COUNT; ++i)
 	{
-		L += apply_directional_light(lights_info.directional_lights[i], normal);
+		L += (i == 0U ? occlusion.r : 1.0) * apply_directional_light(lights_info.directional_lights[i], normal);
 	}
 	for (uint i = 0U; i < POINT_LIGHT_COUNT; ++i)
 	{
@@ -69,7 +85,8 @@ void main()
 	{
 		L += apply_spot_light(lights_info.spot_lights[i], pos, normal);
 	}
-	vec3 ambient_color = vec3(0.2) * albedo.xyz;
+#endif
+	vec3 ambient_color = vec3(0.2) * occlusion.g * albedo.xyz;
 	
 	o_color = vec4(ambient_color + L * albedo.xyz, 1.0);
 }
\ No newline at end of file
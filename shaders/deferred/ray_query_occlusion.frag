@@ -0,0 +1,194 @@
+#version 460
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Traces the visibility of the surfaces of the G-buffer with ray queries, see RayQueryOcclusionSubpass
+
+#extension GL_EXT_ray_query : require
+#ifdef HALF_RESOLUTION
+#extension GL_KHR_shader_subgroup_quad : require
+#endif
+
+precision highp float;
+
+layout(input_attachment_index = 0, binding = 0) uniform subpassInput i_depth;
+layout(input_attachment_index = 1, binding = 2) uniform subpassInput i_normal;
+
+layout(location = 0) in vec2 in_uv;
+layout(location = 0) out vec4 o_visibility;
+
+layout(set = 0, binding = 3) uniform OcclusionUniform
+{
+	mat4  inv_view_proj;
+	vec4  camera_position;
+	vec4  light_direction;
+	vec2  inv_resolution;
+	uvec2 top_level_structure;
+	float ray_length;
+	float bias;
+	uint  rays_per_pixel;
+}
+occlusion_uniform;
+
+const float PI = 3.14159265359;
+
+float trace_ray(vec3 origin, vec3 direction)
+{
+	rayQueryEXT ray_query;
+	rayQueryInitializeEXT(ray_query, accelerationStructureEXT(occlusion_uniform.top_level_structure),
+	                      gl_RayFlagsTerminateOnFirstHitEXT | gl_RayFlagsOpaqueEXT, 0xFF,
+	                      origin, 0.0, direction, occlusion_uniform.ray_length);
+
+	// Every geometry is traced as opaque, so the query doesn't stop for candidates
+	while (rayQueryProceedEXT(ray_query))
+	{
+	}
+
+	return rayQueryGetIntersectionTypeEXT(ray_query, true) == gl_RayQueryCommittedIntersectionNoneEXT ? 1.0 : 0.0;
+}
+
+#ifdef RAY_QUERY_SHADOWS
+vec3 get_ray_direction(uint ray, vec3 normal, float rotation)
+{
+	return normalize(-occlusion_uniform.light_direction.xyz);
+}
+#else
+// Cosine-weighted directions of the hemisphere around the normal, on a spiral rotated per quad
+vec3 get_ray_direction(uint ray, vec3 normal, float rotation)
+{
+	float u     = (float(ray) + 0.5) / float(occlusion_uniform.rays_per_pixel);
+	float phi   = float(ray) * 2.39996323 + rotation;
+	float r     = sqrt(u);
+	vec3  local = vec3(r * cos(phi), r * sin(phi), sqrt(1.0 - u));
+
+	vec3 up        = abs(normal.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+	vec3 tangent   = normalize(cross(up, normal));
+	vec3 bitangent = cross(normal, tangent);
+	return tangent * local.x + bitangent * local.y + normal * local.z;
+}
+#endif
+
+// Traces the rays of index first, first + stride, ..., returning the sum of their visibility
+float trace_rays(vec3 origin, vec3 normal, float rotation, uint first, uint stride, out float count)
+{
+	float visibility = 0.0;
+	count            = 0.0;
+
+	for (uint ray = first; ray < occlusion_uniform.rays_per_pixel; ray += stride)
+	{
+		vec3 direction = get_ray_direction(ray, normal, rotation);
+#ifdef RAY_QUERY_SHADOWS
+		// Facing away from the light, the lighting is zero whatever the visibility
+		visibility += dot(normal, direction) > 0.0 ? trace_ray(origin, direction) : 1.0;
+#else
+		visibility += trace_ray(origin, direction);
+#endif
+		count += 1.0;
+	}
+
+	return visibility;
+}
+
+#ifdef HALF_RESOLUTION
+// Weight of the rays of another pixel of the quad, negligible if it is on another surface
+float bilateral_weight(float dist, vec3 normal, float other_dist, vec3 other_normal)
+{
+	float depth_weight  = exp(-abs(other_dist - dist) / (0.02 * dist));
+	float normal_weight = pow(max(dot(normal, other_normal), 0.0), 16.0);
+	return depth_weight * normal_weight;
+}
+#endif
+
+void main()
+{
+	// Retrieve position from depth
+	float depth        = subpassLoad(i_depth).x;
+	vec4  clip         = vec4(in_uv * 2.0 - 1.0, depth, 1.0);
+	highp vec4 world_w = occlusion_uniform.inv_view_proj * clip;
+	highp vec3 pos     = world_w.xyz / world_w.w;
+
+	// Transform from [0,1] to [-1,1]
+	vec3 normal = normalize(2.0 * subpassLoad(i_normal).xyz - 1.0);
+
+	// The depth is reversed, the background is at zero
+	bool  background = depth == 0.0;
+	float dist       = distance(pos, occlusion_uniform.camera_position.xyz);
+	vec3  origin     = pos + normal * occlusion_uniform.bias * dist;
+
+	// Interleaved gradient noise, the same for the four pixels of a quad
+	vec2  quad     = floor(gl_FragCoord.xy * 0.5);
+	float rotation = 2.0 * PI * fract(52.9829189 * fract(dot(quad, vec2(0.06711056, 0.00583715))));
+
+#ifdef HALF_RESOLUTION
+	// Each pixel of the quad traces a quarter of the rays
+	uint  lane  = gl_SubgroupInvocationID & 3U;
+	float count = 0.0;
+	float sum   = background ? 0.0 : trace_rays(origin, normal, rotation, lane, 4U, count);
+	count       = background ? 0.0 : count;
+
+	// Quad operations must be reached by the four pixels, the background ones included
+	vec4 own             = vec4(normal, dist);
+	vec2 own_rays        = vec2(sum, count);
+	vec4 horizontal      = subgroupQuadSwapHorizontal(own);
+	vec2 horizontal_rays = subgroupQuadSwapHorizontal(own_rays);
+	vec4 vertical        = subgroupQuadSwapVertical(own);
+	vec2 vertical_rays   = subgroupQuadSwapVertical(own_rays);
+	vec4 diagonal        = subgroupQuadSwapDiagonal(own);
+	vec2 diagonal_rays   = subgroupQuadSwapDiagonal(own_rays);
+
+	if (background)
+	{
+		o_visibility = vec4(1.0);
+		return;
+	}
+
+	float horizontal_weight = bilateral_weight(dist, normal, horizontal.w, horizontal.xyz);
+	float vertical_weight   = bilateral_weight(dist, normal, vertical.w, vertical.xyz);
+	float diagonal_weight   = bilateral_weight(dist, normal, diagonal.w, diagonal.xyz);
+
+	vec2 neighbour_rays = horizontal_weight * horizontal_rays + vertical_weight * vertical_rays + diagonal_weight * diagonal_rays;
+
+	// With less than half of the rays of the quad from the same surface, the pixel traces the rays of the other pixels itself
+	float quad_count = float(min(occlusion_uniform.rays_per_pixel, 4U));
+	if (count + neighbour_rays.y < 0.5 * quad_count)
+	{
+		for (uint other = 1U; other < 4U; ++other)
+		{
+			float other_count;
+			sum += trace_rays(origin, normal, rotation, (lane + other) & 3U, 4U, other_count);
+			count += other_count;
+		}
+	}
+	else
+	{
+		sum += neighbour_rays.x;
+		count += neighbour_rays.y;
+	}
+
+	o_visibility = vec4(count > 0.0 ? sum / count : 1.0);
+#else
+	if (background)
+	{
+		o_visibility = vec4(1.0);
+		return;
+	}
+
+	float count;
+	float sum    = trace_rays(origin, normal, rotation, 0U, 1U, count);
+	o_visibility = vec4(sum / count);
+#endif
+}
@@ -0,0 +1,39 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Global uniform and material of a draw in one push constant range, see vkb::GeometrySubpass::set_constant_delivery
+// The members follow vkb::GlobalUniform then vkb::PBRMaterialUniform or vkb::BindlessMaterialUniform
+
+layout(push_constant, std430) uniform DrawConstants
+{
+	mat4 model;
+	mat4 view_proj;
+	vec3 camera_position;
+	// Declared even without PACKED_POSITION, to keep the offset of the material
+	vec3 position_offset;
+	vec3 position_scale;
+	vec4  base_color_factor;
+	float metallic_factor;
+	float roughness_factor;
+#ifdef BINDLESS
+	uint base_color_texture_index;
+#endif
+}
+draw_constants;
+
+#define global_uniform draw_constants
+#define pbr_material_uniform draw_constants
@@ -0,0 +1,52 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Matches vkb::GpuDrivenDraw
+struct Draw
+{
+	vec4 base_color_factor;
+	vec3 bounds_min;
+	uint first_index;
+	vec3 bounds_max;
+	uint index_count;
+	int  vertex_offset;
+	uint transform_index;
+	uint base_color_texture_index;
+	uint group;
+	uint first_lod;
+	uint lod_count;
+	uvec2 padding;
+};
+
+// Matches vkb::GpuDrivenSubpass::DrawGroup
+#define DRAW_GROUP_SINGLE_SIDED 0U
+#define DRAW_GROUP_SINGLE_SIDED_FLIPPED 1U
+#define DRAW_GROUP_DOUBLE_SIDED 2U
+
+#define NO_TEXTURE 0xFFFFFFFFU
+
+layout(std430, set = 0, binding = 1) readonly buffer DrawBuffer
+{
+	Draw draws[];
+}
+draw_buffer;
+
+layout(std430, set = 0, binding = 2) readonly buffer TransformBuffer
+{
+	mat4 transforms[];
+}
+transform_buffer;
@@ -0,0 +1,32 @@
+#version 450
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A flat color, so that the fill rate is bound by the output of the pixels
+
+layout(location = 0) out vec4 o_color;
+
+layout(push_constant) uniform Registers
+{
+	vec4 color;
+}
+registers;
+
+void main()
+{
+	o_color = registers.color;
+}
@@ -15,6 +15,17 @@
  * limitations under the License.
  */
 
+#ifdef HALF_PRECISION
+// The directions, cosines and colors of the lights in 16-bit floats, the positions, distances and intensities stay
+// in 32-bit floats as they exceed the range of 16 bits
+#extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+#define lfloat float16_t
+#define lvec3 f16vec3
+#else
+#define lfloat float
+#define lvec3 vec3
+#endif
+
 struct Light
 {
 	vec4 position;         // position.w represents type of light
@@ -25,28 +36,26 @@ struct Light
 
 vec3 apply_directional_light(Light light, vec3 normal)
 {
-	vec3 world_to_light = -light.direction.xyz;
-	world_to_light      = normalize(world_to_light);
-	float ndotl         = clamp(dot(normal, world_to_light), 0.0, 1.0);
-	return ndotl * light.color.w * light.color.rgb;
+	lvec3  world_to_light = lvec3(normalize(-light.direction.xyz));
+	lfloat ndotl          = clamp(dot(lvec3(normal), world_to_light), lfloat(0.0), lfloat(1.0));
+	return vec3(ndotl * lvec3(light.color.rgb)) * light.color.w;
 }
 
 vec3 apply_point_light(Light light, vec3 pos, vec3 normal)
 {
-	vec3  world_to_light = light.position.xyz - pos;
-	float dist           = length(world_to_light) * 0.005;
-	float atten          = 1.0 / (dist * dist);
-	world_to_light       = normalize(world_to_light);
-	float ndotl          = clamp(dot(normal, world_to_light), 0.0, 1.0);
-	return ndotl * light.color.w * atten * light.color.rgb;
+	vec3   world_to_light = light.position.xyz - pos;
+	float  dist           = length(world_to_light) * 0.005;
+	float  atten          = 1.0 / (dist * dist);
+	lfloat ndotl          = clamp(dot(lvec3(normal), lvec3(normalize(world_to_light))), lfloat(0.0), lfloat(1.0));
+	return vec3(ndotl * lvec3(light.color.rgb)) * light.color.w * atten;
 }
 
 vec3 apply_spot_light(Light light, vec3 pos, vec3 normal)
 {
-	vec3  light_to_pixel   = normalize(pos - light.position.xyz);
-	float theta            = dot(light_to_pixel, normalize(light.direction.xyz));
-	float inner_cone_angle = light.info.x;
-	float outer_cone_angle = light.info.y;
-	float intensity        = (theta - outer_cone_angle) / (inner_cone_angle - outer_cone_angle);
-	return smoothstep(0.0, 1.0, intensity) * light.color.w * light.color.rgb;
-}
\ No newline at end of file
+	lvec3  light_to_pixel   = lvec3(normalize(pos - light.position.xyz));
+	lfloat theta            = dot(light_to_pixel, lvec3(normalize(light.direction.xyz)));
+	lfloat inner_cone_angle = lfloat(light.info.x);
+	lfloat outer_cone_angle = lfloat(light.info.y);
+	lfloat intensity        = (theta - outer_cone_angle) / (inner_cone_angle - outer_cone_angle);
+	return vec3(smoothstep(lfloat(0.0), lfloat(1.0), intensity) * lvec3(light.color.rgb)) * light.color.w;
+}
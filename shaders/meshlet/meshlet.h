@@ -0,0 +1,51 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Matches vkb::mesh_optimizer::Meshlet
+struct Meshlet
+{
+	vec3 center;
+	float radius;
+	vec3 cone_axis;
+	float cone_cutoff;
+	uint vertex_offset;
+	uint triangle_offset;
+	uint vertex_count;
+	uint triangle_count;
+};
+
+// Meshlets tested by a task shader workgroup, matches vkb::MeshletSubpass::TaskGroupSize
+#define TASK_GROUP_SIZE 32
+
+struct TaskPayload
+{
+	uint meshlet_indices[TASK_GROUP_SIZE];
+};
+
+layout(set = 0, binding = 1) uniform GlobalUniform
+{
+	mat4 model;
+	mat4 view_proj;
+	vec3 camera_position;
+}
+global_uniform;
+
+layout(std430, set = 0, binding = 8) readonly buffer MeshletBuffer
+{
+	Meshlet meshlets[];
+}
+meshlet_buffer;
@@ -0,0 +1,28 @@
+#version 460
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Copies the colors evaluated by mlp.comp to the swapchain, before the UI is drawn
+
+layout(binding = 0) uniform sampler2D mlpOutput;
+
+layout(location = 0) out vec4 o_color;
+
+void main()
+{
+	o_color = texelFetch(mlpOutput, ivec2(gl_FragCoord.xy), 0);
+}
@@ -26,6 +26,9 @@
  * Contributor: (Qualcomm) Rodrigo Holztrattner - quic_rholztra@quicinc.com
  */
 #version 460
+#ifdef MLP_FP16
+#extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+#endif
 
 layout (input_attachment_index = 0, binding = 0) uniform subpassInput inputFeature_0;
 layout (input_attachment_index = 1, binding = 1) uniform subpassInput inputFeature_1;
@@ -45,29 +48,54 @@ precision highp float;
 #define BIAS_1_COUNT (16)
 // The third layer bias' size is changed from 3 to 4 to make sure a 16 bytes alignement
 #define BIAS_2_COUNT (4)
+#ifdef MLP_FP16
+// The weights are packed as half floats, two vec4 of weights in each uvec4
+layout(binding = 3) uniform mlp_weights
+{
+	uvec4 data[(WEIGHTS_0_COUNT + WEIGHTS_1_COUNT + WEIGHTS_2_COUNT +
+                BIAS_0_COUNT + BIAS_1_COUNT + BIAS_2_COUNT + 7)/8];        // Array of half floats
+} weights;
+
+#define mlp_vec4 f16vec4
+#define mlp_float float16_t
+
+f16vec4 unpack_weights(uvec4 packed_weights, int index)
+{
+	uvec2 half_weights = (index & 1) == 0 ? packed_weights.xy : packed_weights.zw;
+	return f16vec4(unpackFloat2x16(half_weights.x), unpackFloat2x16(half_weights.y));
+}
+
+#define WEIGHTS(index) unpack_weights(weights.data[(index)/2], index)
+#else
 layout(binding = 3) uniform mlp_weights
 {
 	vec4 data[(WEIGHTS_0_COUNT + WEIGHTS_1_COUNT + WEIGHTS_2_COUNT +
                BIAS_0_COUNT + BIAS_1_COUNT + BIAS_2_COUNT)/4];        // Array of floats
 } weights;
 
+#define mlp_vec4 vec4
+#define mlp_float float
+
+#define WEIGHTS(index) weights.data[index]
+#endif
+
 vec3 evaluateNetwork(  vec4 f0,  vec4 f1,  vec4 viewdir) {
 
         vec3 res;
 
         int bias_0_ind = WEIGHTS_0_COUNT + WEIGHTS_1_COUNT + WEIGHTS_2_COUNT;
-        vec4 intermediate_one[4] = vec4[](
-           weights.data[bias_0_ind/4],
-           weights.data[bias_0_ind/4 + 1],
-           weights.data[bias_0_ind/4 + 2],
-           weights.data[bias_0_ind/4 + 3]
+        mlp_vec4 intermediate_one[4] = mlp_vec4[](
+           WEIGHTS(bias_0_ind/4),
+           WEIGHTS(bias_0_ind/4 + 1),
+           WEIGHTS(bias_0_ind/4 + 2),
+           WEIGHTS(bias_0_ind/4 + 3)
         );
 
 #define  APPLY_WEIGHTS_0(multiplier, weightFirstInd) \
-        intermediate_one[ 0] += (multiplier) * weights.data[ weightFirstInd/4]; \
-        intermediate_one[ 1] += (multiplier) * weights.data[ weightFirstInd/4 + 1]; \
-        intermediate_one[ 2] += (multiplier) * weights.data[ weightFirstInd/4 + 2]; \
-        intermediate_one[ 3] += (multiplier) * weights.data[ weightFirstInd/4 + 3];
+        intermediate_one[ 0] += mlp_float(multiplier) * WEIGHTS(weightFirstInd/4); \
+        intermediate_one[ 1] += mlp_float(multiplier) * WEIGHTS(weightFirstInd/4 + 1); \
+        intermediate_one[ 2] += mlp_float(multiplier) * WEIGHTS(weightFirstInd/4 + 2); \
+        intermediate_one[ 3] += mlp_float(multiplier) * WEIGHTS(weightFirstInd/4 + 3);
 
          APPLY_WEIGHTS_0( f0.r,         0)
          APPLY_WEIGHTS_0( f0.g,        16)
@@ -84,19 +112,19 @@ vec3 evaluateNetwork(  vec4 f0,  vec4 f1,  vec4 viewdir) {
 
         int bias_1_ind = WEIGHTS_0_COUNT + WEIGHTS_1_COUNT + WEIGHTS_2_COUNT +
                          BIAS_0_COUNT;
-        vec4 intermediate_two[4] = vec4[](
-           weights.data[bias_1_ind/4],
-           weights.data[bias_1_ind/4 + 1],
-           weights.data[bias_1_ind/4 + 2],
-           weights.data[bias_1_ind/4 + 3]
+        mlp_vec4 intermediate_two[4] = mlp_vec4[](
+           WEIGHTS(bias_1_ind/4),
+           WEIGHTS(bias_1_ind/4 + 1),
+           WEIGHTS(bias_1_ind/4 + 2),
+           WEIGHTS(bias_1_ind/4 + 3)
         );
 
 #define  APPLY_WEIGHTS_1(intermediate, oneInd) \
          if(intermediate > 0.0f){ \
-            intermediate_two[ 0] += intermediate * weights.data[ WEIGHTS_0_COUNT/4 + oneInd * 4 + 0]; \
-            intermediate_two[ 1] += intermediate * weights.data[ WEIGHTS_0_COUNT/4 + oneInd * 4 + 1]; \
-            intermediate_two[ 2] += intermediate * weights.data[ WEIGHTS_0_COUNT/4 + oneInd * 4 + 2]; \
-            intermediate_two[ 3] += intermediate * weights.data[ WEIGHTS_0_COUNT/4 + oneInd * 4 + 3]; \
+            intermediate_two[ 0] += intermediate * WEIGHTS(WEIGHTS_0_COUNT/4 + oneInd * 4 + 0); \
+            intermediate_two[ 1] += intermediate * WEIGHTS(WEIGHTS_0_COUNT/4 + oneInd * 4 + 1); \
+            intermediate_two[ 2] += intermediate * WEIGHTS(WEIGHTS_0_COUNT/4 + oneInd * 4 + 2); \
+            intermediate_two[ 3] += intermediate * WEIGHTS(WEIGHTS_0_COUNT/4 + oneInd * 4 + 3); \
          }
 
          APPLY_WEIGHTS_1( intermediate_one[0].r, 0)
@@ -118,11 +146,11 @@ vec3 evaluateNetwork(  vec4 f0,  vec4 f1,  vec4 viewdir) {
 
         int bias_2_ind = WEIGHTS_0_COUNT + WEIGHTS_1_COUNT + WEIGHTS_2_COUNT +
                          BIAS_0_COUNT + BIAS_1_COUNT;
-        vec4 result = weights.data[bias_2_ind/4];
+        mlp_vec4 result = WEIGHTS(bias_2_ind/4);
 
 #define  APPLY_WEIGHTS_2(intermediate, oneInd) \
          if(intermediate > 0.0f){ \
-            result += intermediate * weights.data[ WEIGHTS_0_COUNT/4 + WEIGHTS_1_COUNT/4 + oneInd]; \
+            result += intermediate * WEIGHTS(WEIGHTS_0_COUNT/4 + WEIGHTS_1_COUNT/4 + oneInd); \
          }
 
          APPLY_WEIGHTS_2(intermediate_two[0].r, 0)
@@ -142,8 +170,8 @@ vec3 evaluateNetwork(  vec4 f0,  vec4 f1,  vec4 viewdir) {
          APPLY_WEIGHTS_2(intermediate_two[3].b,14)
          APPLY_WEIGHTS_2(intermediate_two[3].a,15)
 
-		 result = 1.0 / (1.0 + exp(-result));
-         return vec3(result * viewdir.a+(1.0-viewdir.a));
+		 vec4 color = 1.0 / (1.0 + exp(-vec4(result)));
+         return vec3(color * viewdir.a+(1.0-viewdir.a));
       }
 
 //////////////////////////////////////////////////////////////
@@ -0,0 +1,81 @@
+#version 450
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+precision highp float;
+
+#include "oit/kbuffer.h"
+
+layout(set = 0, binding = 18, std430) buffer OITStats
+{
+	uint fragment_count;
+	uint overflow_fragment_count;
+	uint overflow_pixel_count;
+}
+oit_stats;
+
+layout(location = 0) out vec4 o_color;
+
+void main()
+{
+	uint pixel_index = oit_pixel_index();
+	uint count       = oit_counts.counts[pixel_index];
+	if (count == 0U)
+	{
+		discard;
+	}
+
+	atomicAdd(oit_stats.fragment_count, count);
+	if (count > OIT_FRAGMENT_COUNT)
+	{
+		atomicAdd(oit_stats.overflow_fragment_count, count - OIT_FRAGMENT_COUNT);
+		atomicAdd(oit_stats.overflow_pixel_count, 1U);
+		count = OIT_FRAGMENT_COUNT;
+	}
+
+	uvec2 fragments[OIT_FRAGMENT_COUNT];
+	for (uint i = 0U; i < count; ++i)
+	{
+		fragments[i] = oit_fragments.fragments[oit_fragment_index(pixel_index, i)];
+	}
+
+	// Insertion sort from the nearest fragment, with a reversed depth buffer. The depth bits
+	// of positive floats order like the floats themselves.
+	for (uint i = 1U; i < count; ++i)
+	{
+		uvec2 fragment = fragments[i];
+		uint  j        = i;
+		for (; j > 0U && fragments[j - 1U].y < fragment.y; --j)
+		{
+			fragments[j] = fragments[j - 1U];
+		}
+		fragments[j] = fragment;
+	}
+
+	// Front-to-back blending, the transmittance of the fragments attenuating the opaque color
+	vec3  color         = vec3(0.0);
+	float transmittance = 1.0;
+	for (uint i = 0U; i < count; ++i)
+	{
+		vec4 fragment_color = unpackUnorm4x8(fragments[i].x);
+		color += transmittance * fragment_color.a * fragment_color.rgb;
+		transmittance *= 1.0 - fragment_color.a;
+	}
+
+	// Blended with ONE and ONE_MINUS_SRC_ALPHA
+	o_color = vec4(color, 1.0 - transmittance);
+}
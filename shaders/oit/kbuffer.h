@@ -0,0 +1,49 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Per-pixel arrays of the k-buffer, see OrderIndependentTransparency
+
+layout(set = 0, binding = 15) uniform OITUniform
+{
+	uvec2 extent;
+}
+oit_uniform;
+
+// Fragments of each pixel, including the ones which didn't fit
+layout(set = 0, binding = 16, std430) buffer OITCounts
+{
+	uint counts[];
+}
+oit_counts;
+
+// OIT_FRAGMENT_COUNT layers of one fragment per pixel, holding the packed color and the depth bits
+layout(set = 0, binding = 17, std430) buffer OITFragments
+{
+	uvec2 fragments[];
+}
+oit_fragments;
+
+uint oit_pixel_index()
+{
+	uvec2 pixel = uvec2(gl_FragCoord.xy);
+	return pixel.y * oit_uniform.extent.x + pixel.x;
+}
+
+uint oit_fragment_index(uint pixel_index, uint layer)
+{
+	return layer * oit_uniform.extent.x * oit_uniform.extent.y + pixel_index;
+}
@@ -0,0 +1,35 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Stores the transparent fragments in the k-buffer instead of blending them
+
+#include "oit/kbuffer.h"
+
+// Fragments hidden by the opaque geometry are not stored
+layout(early_fragment_tests) in;
+
+void oit_store_fragment(vec4 color)
+{
+	uint pixel_index = oit_pixel_index();
+	uint layer       = atomicAdd(oit_counts.counts[pixel_index], 1U);
+
+	// The composite counts the fragments which didn't fit
+	if (layer < OIT_FRAGMENT_COUNT)
+	{
+		oit_fragments.fragments[oit_fragment_index(pixel_index, layer)] = uvec2(packUnorm4x8(color), floatBitsToUint(gl_FragCoord.z));
+	}
+}
@@ -0,0 +1,95 @@
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Vertex attributes fetched through buffer device addresses instead of the vertex input state,
+// the shader must enable GL_EXT_buffer_reference and GL_EXT_buffer_reference_uvec2
+
+// Matches vkb::VertexPullingFormat
+#define VERTEX_FORMAT_FLOAT 0u
+#define VERTEX_FORMAT_HALF 1u
+
+// Matches vkb::VertexStreamUniform, a zero address marks a missing attribute
+layout(set = 0, binding = 14) uniform VertexStreamUniform {
+    uvec2 position_address;
+    uvec2 normal_address;
+    uvec2 texcoord_address;
+    uint position_stride;
+    uint normal_stride;
+    uint texcoord_stride;
+    uint position_format;
+    uint normal_format;
+} vertex_streams;
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexWords {
+    uint words[];
+};
+
+uvec2 offset_address(uvec2 address, uint offset)
+{
+    uint carry;
+    uint low = uaddCarry(address.x, offset, carry);
+    return uvec2(low, address.y + carry);
+}
+
+bool has_stream(uvec2 address)
+{
+    return address.x != 0u || address.y != 0u;
+}
+
+vec3 fetch_vec3(uvec2 address, uint stride, uint format, uint vertex)
+{
+    if (!has_stream(address))
+    {
+        return vec3(0.0);
+    }
+
+    VertexWords data = VertexWords(offset_address(address, vertex * stride));
+
+    if (format == VERTEX_FORMAT_HALF)
+    {
+        return vec3(unpackHalf2x16(data.words[0]), unpackHalf2x16(data.words[1]).x);
+    }
+
+    return uintBitsToFloat(uvec3(data.words[0], data.words[1], data.words[2]));
+}
+
+vec2 fetch_vec2(uvec2 address, uint stride, uint vertex)
+{
+    if (!has_stream(address))
+    {
+        return vec2(0.0);
+    }
+
+    VertexWords data = VertexWords(offset_address(address, vertex * stride));
+
+    return uintBitsToFloat(uvec2(data.words[0], data.words[1]));
+}
+
+vec3 fetch_position()
+{
+    return fetch_vec3(vertex_streams.position_address, vertex_streams.position_stride, vertex_streams.position_format, uint(gl_VertexIndex));
+}
+
+vec3 fetch_normal()
+{
+    return fetch_vec3(vertex_streams.normal_address, vertex_streams.normal_stride, vertex_streams.normal_format, uint(gl_VertexIndex));
+}
+
+vec2 fetch_texcoord_0()
+{
+    return fetch_vec2(vertex_streams.texcoord_address, vertex_streams.texcoord_stride, uint(gl_VertexIndex));
+}
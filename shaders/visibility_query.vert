@@ -0,0 +1,44 @@
+#version 320 es
+/* Copyright (c) 2024, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Bounds of a node drawn by the occlusion queries of vkb::GeometrySubpass, see enable_conditional_rendering()
+
+layout(push_constant, std430) uniform VisibilityQueryUniform
+{
+	mat4 view_proj;
+	vec4 bounds_min;
+	vec4 bounds_max;
+}
+visibility_query;
+
+// Corners of the 12 triangles of the box, bit 0 selecting the maximum x, bit 1 y and bit 2 z
+const uint corners[36] = uint[](0u, 2u, 6u, 0u, 6u, 4u,
+                                1u, 3u, 7u, 1u, 7u, 5u,
+                                0u, 1u, 5u, 0u, 5u, 4u,
+                                2u, 3u, 7u, 2u, 7u, 6u,
+                                0u, 1u, 3u, 0u, 3u, 2u,
+                                4u, 5u, 7u, 4u, 7u, 6u);
+
+void main(void)
+{
+	uint corner = corners[gl_VertexIndex];
+
+	vec3 position = mix(visibility_query.bounds_min.xyz, visibility_query.bounds_max.xyz, vec3(uvec3(corner, corner >> 1u, corner >> 2u) & 1u));
+
+	gl_Position = visibility_query.view_proj * vec4(position, 1.0);
+}